@@ -0,0 +1,159 @@
+// Copyright 2021 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__ALLOCATION_TRACKING_HPP_
+#define RCLCPP__ALLOCATION_TRACKING_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "rclcpp/visibility_control.hpp"
+
+namespace rclcpp
+{
+/// Instrumentation counting the heap allocations made by the callbacks executed by executors.
+/**
+ * Once enabled, through rclcpp::InitOptions::allocation_tracking() or
+ * enable(), the allocations made while an executor executes a callback are
+ * counted, and optionally backtraced, per callback.
+ * The allocations observed are the ones of the rcl allocators made from
+ * rclcpp allocators by rclcpp::allocator::get_rcl_allocator(), the ones of
+ * the rclcpp allocators falling back to the heap, and the ones of the
+ * global operator new, if rclcpp/allocation_tracking_global_operator_new.hpp
+ * is included in one source file of the program.
+ * The default rcl allocator, used with std::allocator, calls malloc directly
+ * and is not tracked.
+ *
+ * Allocations made by the executors themselves, while they wait for work,
+ * are attributed to the "executor" callback.
+ */
+namespace allocation_tracking
+{
+
+/// Options of the allocation tracking.
+struct AllocationTrackingOptions
+{
+  /// If true, the allocations of the callbacks are counted.
+  bool enabled = false;
+  /// Number of allocations backtraced per callback, none by default.
+  size_t max_backtraces_per_callback = 0;
+};
+
+/// Allocations made by a callback since the tracking was enabled or reset.
+struct CallbackAllocations
+{
+  /// Kind of the callback, like "subscription", followed by its topic name for instance.
+  std::string callback;
+  uint64_t allocation_count = 0;
+  uint64_t allocated_bytes = 0;
+  /// Return addresses of the first allocations, see format_backtrace().
+  std::vector<std::vector<void *>> backtraces;
+};
+
+/// Start tracking the allocations of the callbacks.
+RCLCPP_PUBLIC
+void
+enable(const AllocationTrackingOptions & options = {true, 0});
+
+/// Stop tracking the allocations, the allocations already tracked are kept.
+RCLCPP_PUBLIC
+void
+disable();
+
+RCLCPP_PUBLIC
+bool
+is_enabled();
+
+/// Return the allocations tracked per callback.
+RCLCPP_PUBLIC
+std::vector<CallbackAllocations>
+get_callback_allocations();
+
+/// Return the number of allocations tracked, all callbacks included.
+RCLCPP_PUBLIC
+uint64_t
+get_allocation_count();
+
+/// Forget the allocations tracked.
+RCLCPP_PUBLIC
+void
+reset();
+
+/// Return the symbols of a backtrace, one per line.
+RCLCPP_PUBLIC
+std::string
+format_backtrace(const std::vector<void *> & backtrace);
+
+/// Record an allocation of size bytes, if made by a callback while the tracking is enabled.
+/**
+ * This does not allocate memory if the allocation is not tracked, and
+ * allocations made by the tracking itself are ignored, so that it can be
+ * called by the global operator new.
+ */
+RCLCPP_PUBLIC
+void
+record_allocation(size_t size);
+
+/// Record an allocation for the lifetime of the object, but not the allocations it makes.
+/**
+ * Allocators record their allocations with it rather than with
+ * record_allocation(), so that the memory they allocate with the global
+ * operator new, or with another allocator, is not recorded a second time.
+ */
+class TrackedAllocation
+{
+public:
+  RCLCPP_PUBLIC
+  explicit TrackedAllocation(size_t size);
+
+  RCLCPP_PUBLIC
+  ~TrackedAllocation();
+
+  TrackedAllocation(const TrackedAllocation &) = delete;
+  TrackedAllocation & operator=(const TrackedAllocation &) = delete;
+
+private:
+  bool outermost_;
+};
+
+/// Attribute the allocations made by this thread to a callback, as long as the scope exists.
+/**
+ * Scopes can be nested, the allocations are attributed to the innermost callback.
+ * The strings must outlive the scope, they are only copied when an
+ * allocation of the callback is tracked.
+ */
+class CallbackScope
+{
+public:
+  RCLCPP_PUBLIC
+  CallbackScope(const char * kind, const char * name = nullptr);
+
+  RCLCPP_PUBLIC
+  ~CallbackScope();
+
+  CallbackScope(const CallbackScope &) = delete;
+  CallbackScope & operator=(const CallbackScope &) = delete;
+
+private:
+  bool active_;
+  const char * previous_kind_;
+  const char * previous_name_;
+};
+
+}  // namespace allocation_tracking
+}  // namespace rclcpp
+
+#endif  // RCLCPP__ALLOCATION_TRACKING_HPP_
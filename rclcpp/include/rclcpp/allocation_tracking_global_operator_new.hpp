@@ -0,0 +1,82 @@
+// Copyright 2021 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__ALLOCATION_TRACKING_GLOBAL_OPERATOR_NEW_HPP_
+#define RCLCPP__ALLOCATION_TRACKING_GLOBAL_OPERATOR_NEW_HPP_
+
+// Replace the global operator new of the program to track its allocations.
+// This header defines the replacement functions: include it in exactly one
+// source file of the program, and only in one, for instance the one of main().
+// The aligned versions of the operators are not replaced.
+
+#include <cstdlib>
+#include <new>
+
+#include "rclcpp/allocation_tracking.hpp"
+
+void *
+operator new(std::size_t size)
+{
+  rclcpp::allocation_tracking::record_allocation(size);
+  void * pointer = std::malloc(size == 0 ? 1 : size);
+  if (nullptr == pointer) {
+    throw std::bad_alloc();
+  }
+  return pointer;
+}
+
+void *
+operator new[](std::size_t size)
+{
+  return ::operator new(size);
+}
+
+void *
+operator new(std::size_t size, const std::nothrow_t &) noexcept
+{
+  rclcpp::allocation_tracking::record_allocation(size);
+  return std::malloc(size == 0 ? 1 : size);
+}
+
+void *
+operator new[](std::size_t size, const std::nothrow_t & tag) noexcept
+{
+  return ::operator new(size, tag);
+}
+
+void
+operator delete(void * pointer) noexcept
+{
+  std::free(pointer);
+}
+
+void
+operator delete[](void * pointer) noexcept
+{
+  std::free(pointer);
+}
+
+void
+operator delete(void * pointer, std::size_t) noexcept
+{
+  std::free(pointer);
+}
+
+void
+operator delete[](void * pointer, std::size_t) noexcept
+{
+  std::free(pointer);
+}
+
+#endif  // RCLCPP__ALLOCATION_TRACKING_GLOBAL_OPERATOR_NEW_HPP_
@@ -19,6 +19,7 @@
 
 #include "rcl/allocator.h"
 
+#include "rclcpp/allocation_tracking.hpp"
 #include "rclcpp/allocator/allocator_deleter.hpp"
 
 namespace rclcpp
@@ -36,6 +37,7 @@ void * retyped_allocate(size_t size, void * untyped_allocator)
   if (!typed_allocator) {
     throw std::runtime_error("Received incorrect allocator type");
   }
+  rclcpp::allocation_tracking::TrackedAllocation tracked_allocation(size);
   return std::allocator_traits<Alloc>::allocate(*typed_allocator, size);
 }
 
@@ -59,6 +61,7 @@ void * retyped_reallocate(void * untyped_pointer, size_t size, void * untyped_al
   }
   auto typed_ptr = static_cast<T *>(untyped_pointer);
   std::allocator_traits<Alloc>::deallocate(*typed_allocator, typed_ptr, 1);
+  rclcpp::allocation_tracking::TrackedAllocation tracked_allocation(size);
   return std::allocator_traits<Alloc>::allocate(*typed_allocator, size);
 }
 
@@ -0,0 +1,267 @@
+// Copyright 2021 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__ALLOCATOR__ARENA_HPP_
+#define RCLCPP__ALLOCATOR__ARENA_HPP_
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+
+#include "rcl/allocator.h"
+
+#include "rclcpp/allocation_tracking.hpp"
+#include "rclcpp/macros.hpp"
+
+namespace rclcpp
+{
+namespace allocator
+{
+
+/// Bounded monotonic memory arena, allocated once and released as a whole.
+/**
+ * Memory is taken from the arena by bumping an offset, which is thread-safe
+ * and does not lock, so that allocations are contiguous and cheap.
+ * Deallocated memory is not reused: the arena is meant for the memory
+ * allocated once, while creating a node and its entities, and for the
+ * memory of bounded pools.
+ *
+ * Once the arena is exhausted, memory is allocated with the global operator
+ * new instead, and released when deallocated, so that an undersized arena
+ * degrades gracefully; get_fallback_count() tells how often it happened.
+ */
+class Arena
+{
+public:
+  RCLCPP_SMART_PTR_DEFINITIONS_NOT_COPYABLE(Arena)
+
+  /// Allocate an arena of capacity bytes.
+  explicit Arena(size_t capacity)
+  : storage_((capacity + sizeof(std::max_align_t) - 1) / sizeof(std::max_align_t)),
+    capacity_(capacity),
+    used_size_(0),
+    fallback_count_(0)
+  {}
+
+  /// Return memory of the arena, or of the global operator new once the arena is exhausted.
+  void *
+  allocate(size_t size, size_t alignment = alignof(std::max_align_t))
+  {
+    const auto first = reinterpret_cast<uintptr_t>(storage_.data());
+    size_t offset = used_size_.load(std::memory_order_relaxed);
+    size_t aligned_offset;
+    do {
+      aligned_offset = (first + offset + alignment - 1) / alignment * alignment - first;
+      if (aligned_offset > capacity_ || size > capacity_ - aligned_offset) {
+        fallback_count_.fetch_add(1, std::memory_order_relaxed);
+        rclcpp::allocation_tracking::TrackedAllocation tracked_allocation(size);
+        return ::operator new(size, std::align_val_t(alignment));
+      }
+    } while (!used_size_.compare_exchange_weak(
+      offset, aligned_offset + size, std::memory_order_relaxed));
+    return reinterpret_cast<unsigned char *>(storage_.data()) + aligned_offset;
+  }
+
+  /// Release memory allocated once the arena was exhausted, the memory of the arena is kept.
+  void
+  deallocate(void * pointer, size_t alignment = alignof(std::max_align_t))
+  {
+    if (nullptr != pointer && !contains(pointer)) {
+      ::operator delete(pointer, std::align_val_t(alignment));
+    }
+  }
+
+  /// Return true if the memory is part of the arena.
+  bool
+  contains(const void * pointer) const
+  {
+    auto first = reinterpret_cast<const unsigned char *>(storage_.data());
+    auto address = static_cast<const unsigned char *>(pointer);
+    return address >= first && address < first + capacity_;
+  }
+
+  size_t
+  get_capacity() const
+  {
+    return capacity_;
+  }
+
+  /// Return the number of bytes taken from the arena, including the padding for alignment.
+  size_t
+  get_used_size() const
+  {
+    return used_size_.load(std::memory_order_relaxed);
+  }
+
+  /// Return the number of allocations made with the global operator new, the arena exhausted.
+  size_t
+  get_fallback_count() const
+  {
+    return fallback_count_.load(std::memory_order_relaxed);
+  }
+
+  /// Return an rcl allocator allocating from the arena.
+  /**
+   * The arena must outlive the memory allocated by rcl with it.
+   */
+  rcl_allocator_t
+  get_rcl_allocator()
+  {
+    rcl_allocator_t rcl_allocator = rcl_get_default_allocator();
+    rcl_allocator.allocate = &Arena::rcl_allocate;
+    rcl_allocator.deallocate = &Arena::rcl_deallocate;
+    rcl_allocator.reallocate = &Arena::rcl_reallocate;
+    rcl_allocator.zero_allocate = &Arena::rcl_zero_allocate;
+    rcl_allocator.state = this;
+    return rcl_allocator;
+  }
+
+private:
+  // The memory given to rcl is preceded by its size, needed to reallocate it.
+  static constexpr size_t rcl_header_size = sizeof(std::max_align_t);
+
+  static void *
+  rcl_allocate(size_t size, void * state)
+  {
+    try {
+      auto block = static_cast<unsigned char *>(
+        static_cast<Arena *>(state)->allocate(rcl_header_size + size));
+      std::memcpy(block, &size, sizeof(size));
+      return block + rcl_header_size;
+    } catch (const std::bad_alloc &) {
+      return nullptr;
+    }
+  }
+
+  static void
+  rcl_deallocate(void * pointer, void * state)
+  {
+    if (nullptr != pointer) {
+      auto block = static_cast<unsigned char *>(pointer) - rcl_header_size;
+      static_cast<Arena *>(state)->deallocate(block);
+    }
+  }
+
+  static void *
+  rcl_reallocate(void * pointer, size_t size, void * state)
+  {
+    void * new_pointer = rcl_allocate(size, state);
+    if (nullptr != new_pointer && nullptr != pointer) {
+      size_t previous_size;
+      std::memcpy(
+        &previous_size, static_cast<unsigned char *>(pointer) - rcl_header_size,
+        sizeof(previous_size));
+      std::memcpy(new_pointer, pointer, std::min(size, previous_size));
+      rcl_deallocate(pointer, state);
+    }
+    return new_pointer;
+  }
+
+  static void *
+  rcl_zero_allocate(size_t number_of_elements, size_t size_of_element, void * state)
+  {
+    const size_t size = number_of_elements * size_of_element;
+    if (size_of_element != 0 && size / size_of_element != number_of_elements) {
+      return nullptr;
+    }
+    void * pointer = rcl_allocate(size, state);
+    if (nullptr != pointer) {
+      std::memset(pointer, 0, size);
+    }
+    return pointer;
+  }
+
+  std::vector<std::max_align_t> storage_;
+  const size_t capacity_;
+  std::atomic<size_t> used_size_;
+  std::atomic<size_t> fallback_count_;
+};
+
+/// Allocator taking memory from an Arena, for the entities and the messages of a node.
+/**
+ * Without an arena, memory is allocated with the global operator new.
+ * All the copies of an allocator, including the rebound ones, share its arena.
+ */
+template<typename T>
+class ArenaAllocator
+{
+public:
+  using value_type = T;
+
+  ArenaAllocator() noexcept = default;
+
+  explicit ArenaAllocator(Arena::SharedPtr arena) noexcept
+  : arena_(std::move(arena))
+  {}
+
+  template<typename U>
+  ArenaAllocator(const ArenaAllocator<U> & other) noexcept  // NOLINT
+  : arena_(other.get_arena())
+  {}
+
+  T *
+  allocate(size_t n)
+  {
+    if (!arena_) {
+      rclcpp::allocation_tracking::TrackedAllocation tracked_allocation(n * sizeof(T));
+      return static_cast<T *>(::operator new(n * sizeof(T), std::align_val_t(alignof(T))));
+    }
+    return static_cast<T *>(arena_->allocate(n * sizeof(T), alignof(T)));
+  }
+
+  void
+  deallocate(T * pointer, size_t n)
+  {
+    (void)n;
+    if (!arena_) {
+      ::operator delete(pointer, std::align_val_t(alignof(T)));
+      return;
+    }
+    arena_->deallocate(pointer, alignof(T));
+  }
+
+  const Arena::SharedPtr &
+  get_arena() const
+  {
+    return arena_;
+  }
+
+  template<typename U>
+  bool
+  operator==(const ArenaAllocator<U> & other) const
+  {
+    return arena_ == other.get_arena();
+  }
+
+  template<typename U>
+  bool
+  operator!=(const ArenaAllocator<U> & other) const
+  {
+    return arena_ != other.get_arena();
+  }
+
+private:
+  Arena::SharedPtr arena_;
+};
+
+}  // namespace allocator
+}  // namespace rclcpp
+
+#endif  // RCLCPP__ALLOCATOR__ARENA_HPP_
@@ -0,0 +1,233 @@
+// Copyright 2021 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__ALLOCATOR__MESSAGE_POOL_ALLOCATOR_HPP_
+#define RCLCPP__ALLOCATOR__MESSAGE_POOL_ALLOCATOR_HPP_
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+#include "rclcpp/allocation_tracking.hpp"
+
+namespace rclcpp
+{
+namespace allocator
+{
+namespace detail
+{
+
+/// Fixed number of blocks of a fixed size, allocated up front and recycled.
+/**
+ * Taking and returning blocks is thread-safe and does not allocate memory.
+ */
+class MessagePool
+{
+public:
+  MessagePool(size_t block_size, size_t block_count)
+  : block_size_(round_up_to_alignment(block_size)),
+    block_count_(block_size_ == 0 ? 0 : block_count),
+    storage_(
+      (block_count_ * block_size_ + sizeof(std::max_align_t) - 1) / sizeof(std::max_align_t))
+  {
+    free_blocks_.reserve(block_count_);
+    auto first = reinterpret_cast<unsigned char *>(storage_.data());
+    // Blocks are handed out from the front of the storage first.
+    for (size_t i = block_count_; i > 0; --i) {
+      free_blocks_.push_back(first + (i - 1) * block_size_);
+    }
+  }
+
+  /// Return a free block of at least size bytes, or null if there is none.
+  void *
+  allocate(size_t size)
+  {
+    if (size > block_size_) {
+      return nullptr;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (free_blocks_.empty()) {
+      return nullptr;
+    }
+    void * block = free_blocks_.back();
+    free_blocks_.pop_back();
+    return block;
+  }
+
+  /// Give back a block, return false if the memory is not a block of the pool.
+  bool
+  deallocate(void * pointer)
+  {
+    if (!contains(pointer)) {
+      return false;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    free_blocks_.push_back(pointer);
+    return true;
+  }
+
+  bool
+  contains(const void * pointer) const
+  {
+    auto first = reinterpret_cast<const unsigned char *>(storage_.data());
+    auto address = static_cast<const unsigned char *>(pointer);
+    return address >= first && address < first + block_count_ * block_size_;
+  }
+
+  size_t
+  get_block_size() const
+  {
+    return block_size_;
+  }
+
+  size_t
+  get_block_count() const
+  {
+    return block_count_;
+  }
+
+  size_t
+  get_number_of_free_blocks() const
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return free_blocks_.size();
+  }
+
+private:
+  static size_t
+  round_up_to_alignment(size_t size)
+  {
+    constexpr size_t alignment = alignof(std::max_align_t);
+    return (size + alignment - 1) / alignment * alignment;
+  }
+
+  const size_t block_size_;
+  const size_t block_count_;
+  std::vector<std::max_align_t> storage_;
+  std::vector<void *> free_blocks_;
+  mutable std::mutex mutex_;
+};
+
+}  // namespace detail
+
+/// Allocator taking memory from a pool of preallocated blocks, recycled once deallocated.
+/**
+ * Used as the allocator of a rclcpp::Publisher, the copies of the messages
+ * the intra-process manager makes for the subscriptions requiring ownership
+ * are taken from the pool, and given back to it when the subscriptions
+ * release them, so that publishing to several owning subscriptions does not
+ * allocate memory once the pool is created.
+ *
+ * The subscriptions must use the same allocator type, which is required
+ * by intra-process communication anyway.
+ * Only the message itself comes from the pool: the memory of its strings and
+ * sequences is still allocated by their own allocator.
+ *
+ * Allocations larger than the blocks, or made when all the blocks are in use,
+ * fall back to the global operator new, as do the allocations of bytes, which
+ * are the ones of rcl through rclcpp::allocator::get_rcl_allocator().
+ * All the copies of an allocator, including the rebound ones, share its pool.
+ */
+template<typename T>
+class MessagePoolAllocator
+{
+public:
+  using value_type = T;
+
+  /// Number of blocks of a pool when it is not specified.
+  static constexpr size_t default_block_count = 16;
+
+  /// Create an allocator without a pool, which always falls back to the global operator new.
+  MessagePoolAllocator()
+  : MessagePoolAllocator(0, 0)
+  {}
+
+  /// Create an allocator with a pool of block_count blocks of block_size bytes.
+  /**
+   * \param[in] block_size size of the blocks, typically the size of the message.
+   * \param[in] block_count number of blocks, typically the number of messages owned
+   *   at the same time by the subscriptions, e.g. the sum of their queue depths.
+   */
+  MessagePoolAllocator(size_t block_size, size_t block_count)
+  : pool_(std::make_shared<detail::MessagePool>(block_size, block_count))
+  {}
+
+  template<typename U>
+  MessagePoolAllocator(const MessagePoolAllocator<U> & other) noexcept  // NOLINT
+  : pool_(other.get_pool())
+  {}
+
+  /// Create an allocator with a pool of blocks of the size of MessageT.
+  template<typename MessageT>
+  static MessagePoolAllocator
+  for_message(size_t block_count = default_block_count)
+  {
+    return MessagePoolAllocator(sizeof(MessageT), block_count);
+  }
+
+  T *
+  allocate(size_t n)
+  {
+    void * pointer = nullptr;
+    if constexpr (!std::is_same_v<T, char> && alignof(T) <= alignof(std::max_align_t)) {
+      pointer = pool_->allocate(n * sizeof(T));
+    }
+    if (nullptr == pointer) {
+      rclcpp::allocation_tracking::TrackedAllocation tracked_allocation(n * sizeof(T));
+      pointer = ::operator new(n * sizeof(T));
+    }
+    return static_cast<T *>(pointer);
+  }
+
+  void
+  deallocate(T * pointer, size_t n)
+  {
+    // The size is not used, rcl allocators give the count of elements as 1.
+    (void)n;
+    if (!pool_->deallocate(pointer)) {
+      ::operator delete(pointer);
+    }
+  }
+
+  const std::shared_ptr<detail::MessagePool> &
+  get_pool() const
+  {
+    return pool_;
+  }
+
+  template<typename U>
+  bool
+  operator==(const MessagePoolAllocator<U> & other) const
+  {
+    return pool_ == other.get_pool();
+  }
+
+  template<typename U>
+  bool
+  operator!=(const MessagePoolAllocator<U> & other) const
+  {
+    return pool_ != other.get_pool();
+  }
+
+private:
+  std::shared_ptr<detail::MessagePool> pool_;
+};
+
+}  // namespace allocator
+}  // namespace rclcpp
+
+#endif  // RCLCPP__ALLOCATOR__MESSAGE_POOL_ALLOCATOR_HPP_
@@ -0,0 +1,107 @@
+// Copyright 2021 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__ALLOCATOR__TLSF_ALLOCATOR_HPP_
+#define RCLCPP__ALLOCATOR__TLSF_ALLOCATOR_HPP_
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <utility>
+
+#include "rclcpp/allocator/tlsf_pool.hpp"
+
+namespace rclcpp
+{
+namespace allocator
+{
+
+/// Allocator taking memory from a TLSFPool, in bounded time.
+/**
+ * Used as the allocator of the memory strategy of an executor, and of the
+ * publishers and subscriptions, it keeps the allocations of the executor,
+ * of the messages and of their intra-process copies out of the heap.
+ *
+ * Default-constructed allocators share the default pool,
+ * rclcpp::allocator::TLSFPool::get_default_pool(), and copies of an
+ * allocator, including the rebound ones, share its pool.
+ */
+template<typename T>
+class TLSFAllocator
+{
+public:
+  using value_type = T;
+
+  /// Create an allocator using the default pool.
+  TLSFAllocator()
+  : pool_(TLSFPool::get_default_pool())
+  {}
+
+  /// Create an allocator using the given pool.
+  explicit TLSFAllocator(TLSFPool::SharedPtr pool) noexcept
+  : pool_(std::move(pool))
+  {}
+
+  template<typename U>
+  TLSFAllocator(const TLSFAllocator<U> & other) noexcept  // NOLINT
+  : pool_(other.get_pool())
+  {}
+
+  T *
+  allocate(size_t n)
+  {
+    static_assert(
+      alignof(T) <= alignof(std::max_align_t), "TLSF pools do not support over-aligned types");
+    if (n > static_cast<size_t>(-1) / sizeof(T)) {
+      throw std::bad_alloc();
+    }
+    return static_cast<T *>(pool_->allocate(n * sizeof(T)));
+  }
+
+  void
+  deallocate(T * pointer, size_t n)
+  {
+    // The pool knows the size of its blocks.
+    (void)n;
+    pool_->deallocate(pointer);
+  }
+
+  const TLSFPool::SharedPtr &
+  get_pool() const
+  {
+    return pool_;
+  }
+
+  template<typename U>
+  bool
+  operator==(const TLSFAllocator<U> & other) const
+  {
+    return pool_ == other.get_pool();
+  }
+
+  template<typename U>
+  bool
+  operator!=(const TLSFAllocator<U> & other) const
+  {
+    return pool_ != other.get_pool();
+  }
+
+private:
+  TLSFPool::SharedPtr pool_;
+};
+
+}  // namespace allocator
+}  // namespace rclcpp
+
+#endif  // RCLCPP__ALLOCATOR__TLSF_ALLOCATOR_HPP_
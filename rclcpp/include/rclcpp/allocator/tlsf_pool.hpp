@@ -0,0 +1,137 @@
+// Copyright 2021 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__ALLOCATOR__TLSF_POOL_HPP_
+#define RCLCPP__ALLOCATOR__TLSF_POOL_HPP_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+#include "rclcpp/macros.hpp"
+#include "rclcpp/visibility_control.hpp"
+
+namespace rclcpp
+{
+namespace allocator
+{
+namespace detail
+{
+
+struct TLSFBlock;
+
+}  // namespace detail
+
+/// Memory pool allocating and deallocating in bounded time, with the TLSF algorithm.
+/**
+ * The Two-Level Segregated Fit algorithm keeps the free blocks in lists
+ * indexed by their size class, found with a couple of bit scans, and merges
+ * adjacent free blocks immediately, so that both allocating and deallocating
+ * take a constant time, whatever the number and the sizes of the blocks.
+ *
+ * The memory of the pool is allocated once, when the pool is created, and
+ * allocating more than what is free throws std::bad_alloc rather than
+ * allocating from the heap.
+ * Allocations are aligned as std::max_align_t.
+ *
+ * Allocating and deallocating is thread-safe.
+ */
+class TLSFPool
+{
+public:
+  RCLCPP_SMART_PTR_DEFINITIONS_NOT_COPYABLE(TLSFPool)
+
+  /// Default size of a pool, in bytes.
+  static constexpr size_t default_pool_size = 4 * 1024 * 1024;
+
+  /// Allocate the memory of the pool.
+  /**
+   * \param[in] pool_size size of the memory of the pool, including the headers of the blocks.
+   * \throws std::invalid_argument if the pool is too small to hold a block.
+   */
+  RCLCPP_PUBLIC
+  explicit TLSFPool(size_t pool_size = default_pool_size);
+
+  RCLCPP_PUBLIC
+  ~TLSFPool();
+
+  /// Allocate size bytes from the pool.
+  /**
+   * \throws std::bad_alloc if the pool has no free block large enough.
+   */
+  RCLCPP_PUBLIC
+  void *
+  allocate(size_t size);
+
+  /// Give back memory allocated from the pool, null or memory of other pools is ignored.
+  RCLCPP_PUBLIC
+  void
+  deallocate(void * pointer);
+
+  /// Return true if the memory is part of the pool.
+  RCLCPP_PUBLIC
+  bool
+  contains(const void * pointer) const;
+
+  /// Return the size of the memory of the pool.
+  RCLCPP_PUBLIC
+  size_t
+  get_pool_size() const;
+
+  /// Return the number of bytes used by the allocated blocks, including their headers.
+  RCLCPP_PUBLIC
+  size_t
+  get_used_size() const;
+
+  /// Return the pool used by default-constructed TLSF allocators, of the default size.
+  RCLCPP_PUBLIC
+  static
+  SharedPtr
+  get_default_pool();
+
+private:
+  using Block = detail::TLSFBlock;
+
+  // Size classes: the first level is the power of two of the size, the
+  // second one splits each power of two in second_level_count ranges.
+  static constexpr size_t second_level_count_log2 = 5;
+  static constexpr size_t second_level_count = size_t(1) << second_level_count_log2;
+  static constexpr size_t first_level_count = 64;
+
+  void
+  insert_free_block(Block * block);
+
+  void
+  remove_free_block(Block * block);
+
+  /// Remove and return a free block of at least size bytes, or null.
+  Block *
+  take_free_block(size_t size);
+
+  std::vector<std::max_align_t> storage_;
+  size_t used_size_;
+
+  uint64_t first_level_bitmap_;
+  std::array<uint32_t, first_level_count> second_level_bitmaps_;
+  std::array<std::array<Block *, second_level_count>, first_level_count> free_blocks_;
+
+  mutable std::mutex mutex_;
+};
+
+}  // namespace allocator
+}  // namespace rclcpp
+
+#endif  // RCLCPP__ALLOCATOR__TLSF_POOL_HPP_
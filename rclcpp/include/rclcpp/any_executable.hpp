@@ -15,6 +15,7 @@
 #ifndef RCLCPP__ANY_EXECUTABLE_HPP_
 #define RCLCPP__ANY_EXECUTABLE_HPP_
 
+#include <chrono>
 #include <memory>
 
 #include "rclcpp/callback_group.hpp"
@@ -38,6 +39,14 @@ struct AnyExecutable
   RCLCPP_PUBLIC
   virtual ~AnyExecutable();
 
+  AnyExecutable(const AnyExecutable &) = default;
+  AnyExecutable & operator=(const AnyExecutable &) = default;
+
+  // Moving leaves the source without a callback group, so destroying it does not reset the
+  // `can_be_taken_from` flag of a group the moved-to AnyExecutable is still holding.
+  AnyExecutable(AnyExecutable &&) = default;
+  AnyExecutable & operator=(AnyExecutable &&) = default;
+
   // Only one of the following pointers will be set.
   rclcpp::SubscriptionBase::SharedPtr subscription;
   rclcpp::TimerBase::SharedPtr timer;
@@ -48,6 +57,9 @@ struct AnyExecutable
   rclcpp::CallbackGroup::SharedPtr callback_group;
   rclcpp::node_interfaces::NodeBaseInterface::SharedPtr node_base;
   std::shared_ptr<void> data;
+  // Return time of the wait which found the executable ready, only set when the executor
+  // collects statistics.
+  std::chrono::steady_clock::time_point ready_time;
 };
 
 }  // namespace rclcpp
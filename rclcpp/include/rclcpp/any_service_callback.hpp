@@ -21,6 +21,7 @@
 #include <stdexcept>
 #include <type_traits>
 #include <utility>
+#include <vector>
 
 #include "rclcpp/function_traits.hpp"
 #include "rclcpp/visibility_control.hpp"
@@ -92,6 +93,13 @@ public:
       >::value)
     {
       callback_.template emplace<SharedPtrDeferResponseCallbackWithServiceHandle>(callback);
+    } else if constexpr (  // NOLINT
+      rclcpp::function_traits::same_arguments<
+        CallbackT,
+        SharedPtrBatchCallback
+      >::value)
+    {
+      callback_.template emplace<SharedPtrBatchCallback>(callback);
     } else {
       // the else clause is not needed, but anyways we should only be doing this instead
       // of all the above workaround ...
@@ -137,6 +145,13 @@ public:
       >::value)
     {
       callback_.template emplace<SharedPtrDeferResponseCallbackWithServiceHandle>(callback);
+    } else if constexpr (  // NOLINT
+      rclcpp::function_traits::same_arguments<
+        CallbackT,
+        SharedPtrBatchCallback
+      >::value)
+    {
+      callback_.template emplace<SharedPtrBatchCallback>(callback);
     } else {
       // the else clause is not needed, but anyways we should only be doing this instead
       // of all the above workaround ...
@@ -144,12 +159,17 @@ public:
     }
   }
 
-  // template<typename Allocator = std::allocator<typename ServiceT::Response>>
+  /// Give the request to the callback, and return its response unless it defers it.
+  /**
+   * \param[in] response the default response given to the callback, or nullptr
+   *   for a new one to be allocated.
+   */
   std::shared_ptr<typename ServiceT::Response>
   dispatch(
     const std::shared_ptr<rclcpp::Service<ServiceT>> & service_handle,
     const std::shared_ptr<rmw_request_id_t> & request_header,
-    std::shared_ptr<typename ServiceT::Request> request)
+    std::shared_ptr<typename ServiceT::Request> request,
+    std::shared_ptr<typename ServiceT::Response> response = nullptr)
   {
     TRACEPOINT(callback_start, static_cast<const void *>(this), false);
     if (std::holds_alternative<std::monostate>(callback_)) {
@@ -167,9 +187,17 @@ public:
       cb(service_handle, request_header, std::move(request));
       return nullptr;
     }
-    // auto response = allocate_shared<typename ServiceT::Response, Allocator>();
-    auto response = std::make_shared<typename ServiceT::Response>();
-    if (std::holds_alternative<SharedPtrCallback>(callback_)) {
+    if (!response) {
+      response = std::make_shared<typename ServiceT::Response>();
+    }
+    if (std::holds_alternative<SharedPtrBatchCallback>(callback_)) {
+      // A request received alone is a batch of one.
+      (void)request_header;
+      std::vector<std::shared_ptr<typename ServiceT::Request>> requests{std::move(request)};
+      std::vector<std::shared_ptr<typename ServiceT::Response>> responses{response};
+      const auto & cb = std::get<SharedPtrBatchCallback>(callback_);
+      cb(requests, responses);
+    } else if (std::holds_alternative<SharedPtrCallback>(callback_)) {
       (void)request_header;
       const auto & cb = std::get<SharedPtrCallback>(callback_);
       cb(std::move(request), response);
@@ -181,6 +209,41 @@ public:
     return response;
   }
 
+  /// Return true if the callback takes the request header and sends the response itself.
+  bool
+  defers_response() const
+  {
+    return std::holds_alternative<SharedPtrDeferResponseCallback>(callback_) ||
+           std::holds_alternative<SharedPtrDeferResponseCallbackWithServiceHandle>(callback_);
+  }
+
+  /// Return true if the callback handles the requests in batches.
+  bool
+  is_batch_callback() const
+  {
+    return std::holds_alternative<SharedPtrBatchCallback>(callback_);
+  }
+
+  /// Give a batch of requests to the callback, which fills their responses.
+  /**
+   * \param[in] requests the requests, in the order they were received.
+   * \param[in,out] responses the default constructed responses of the
+   *   requests, of the same size and order.
+   * \throws std::runtime_error if the callback does not handle batches.
+   */
+  void
+  dispatch_batch(
+    const std::vector<std::shared_ptr<typename ServiceT::Request>> & requests,
+    std::vector<std::shared_ptr<typename ServiceT::Response>> & responses)
+  {
+    if (!is_batch_callback()) {
+      throw std::runtime_error{"the service callback does not handle batches of requests"};
+    }
+    TRACEPOINT(callback_start, static_cast<const void *>(this), false);
+    std::get<SharedPtrBatchCallback>(callback_)(requests, responses);
+    TRACEPOINT(callback_end, static_cast<const void *>(this));
+  }
+
   void register_callback_for_tracing()
   {
 #ifndef TRACETOOLS_DISABLED
@@ -218,12 +281,19 @@ private:
       std::shared_ptr<typename ServiceT::Request>
     )>;
 
+  using SharedPtrBatchCallback = std::function<
+    void (
+      const std::vector<std::shared_ptr<typename ServiceT::Request>> &,
+      std::vector<std::shared_ptr<typename ServiceT::Response>> &
+    )>;
+
   std::variant<
     std::monostate,
     SharedPtrCallback,
     SharedPtrWithRequestHeaderCallback,
     SharedPtrDeferResponseCallback,
-    SharedPtrDeferResponseCallbackWithServiceHandle> callback_;
+    SharedPtrDeferResponseCallbackWithServiceHandle,
+    SharedPtrBatchCallback> callback_;
 };
 
 }  // namespace rclcpp
@@ -474,6 +474,28 @@ public:
     }
   }
 
+  /// Return the custom message wrapping the ROS message, see TypeAdapter::wrap_ros_message().
+  std::shared_ptr<const SubscribedType>
+  wrap_ros_message_as_custom_type(std::shared_ptr<const ROSMessageType> msg)
+  {
+    return rclcpp::TypeAdapter<MessageT>::wrap_ros_message(std::move(msg));
+  }
+
+  std::unique_ptr<ROSMessageType, ROSMessageTypeDeleter>
+  convert_custom_type_to_ros_message_unique_ptr(const SubscribedType & msg)
+  {
+    if constexpr (rclcpp::TypeAdapter<MessageT>::is_specialized::value) {
+      auto ptr = ROSMessageTypeAllocatorTraits::allocate(ros_message_type_allocator_, 1);
+      ROSMessageTypeAllocatorTraits::construct(ros_message_type_allocator_, ptr);
+      rclcpp::TypeAdapter<MessageT>::convert_to_ros_message(msg, *ptr);
+      return std::unique_ptr<ROSMessageType, ROSMessageTypeDeleter>(ptr, ros_message_type_deleter_);
+    } else {
+      throw std::runtime_error(
+              "convert_custom_type_to_ros_message_unique_ptr "
+              "unexpectedly called without TypeAdapter");
+    }
+  }
+
   // Dispatch when input is a ros message and the output could be anything.
   void
   dispatch(
@@ -493,6 +515,9 @@ public:
       [&message, &message_info, this](auto && callback) {
         using T = std::decay_t<decltype(callback)>;
         static constexpr bool is_ta = rclcpp::TypeAdapter<MessageT>::is_specialized::value;
+        // The custom message given to the callbacks taking it as const may wrap the ROS message.
+        static constexpr bool wraps =
+          is_ta && rclcpp::detail::has_wrap_ros_message<rclcpp::TypeAdapter<MessageT>>::value;
 
         // conditions for output is custom message
         if constexpr (is_ta && std::is_same_v<T, ConstRefCallback>) {
@@ -501,11 +526,19 @@ public:
           // if constexpr (rosidl_generator_traits::has_fixed_size<T> && sizeof(T) < N) {
           //   ... on stack
           // }
-          auto local_message = convert_ros_message_to_custom_type_unique_ptr(*message);
-          callback(*local_message);
+          if constexpr (wraps) {
+            callback(*wrap_ros_message_as_custom_type(message));
+          } else {
+            auto local_message = convert_ros_message_to_custom_type_unique_ptr(*message);
+            callback(*local_message);
+          }
         } else if constexpr (is_ta && std::is_same_v<T, ConstRefWithInfoCallback>) {  // NOLINT
-          auto local_message = convert_ros_message_to_custom_type_unique_ptr(*message);
-          callback(*local_message, message_info);
+          if constexpr (wraps) {
+            callback(*wrap_ros_message_as_custom_type(message), message_info);
+          } else {
+            auto local_message = convert_ros_message_to_custom_type_unique_ptr(*message);
+            callback(*local_message, message_info);
+          }
         } else if constexpr (is_ta && std::is_same_v<T, UniquePtrCallback>) {
           callback(convert_ros_message_to_custom_type_unique_ptr(*message));
         } else if constexpr (is_ta && std::is_same_v<T, UniquePtrWithInfoCallback>) {
@@ -513,18 +546,28 @@ public:
         } else if constexpr (  // NOLINT[readability/braces]
           is_ta && (
             std::is_same_v<T, SharedConstPtrCallback>||
-            std::is_same_v<T, ConstRefSharedConstPtrCallback>||
-            std::is_same_v<T, SharedPtrCallback>
+            std::is_same_v<T, ConstRefSharedConstPtrCallback>
         ))
         {
+          if constexpr (wraps) {
+            callback(wrap_ros_message_as_custom_type(message));
+          } else {
+            callback(convert_ros_message_to_custom_type_unique_ptr(*message));
+          }
+        } else if constexpr (is_ta && std::is_same_v<T, SharedPtrCallback>) {
           callback(convert_ros_message_to_custom_type_unique_ptr(*message));
         } else if constexpr (  // NOLINT[readability/braces]
           is_ta && (
             std::is_same_v<T, SharedConstPtrWithInfoCallback>||
-            std::is_same_v<T, ConstRefSharedConstPtrWithInfoCallback>||
-            std::is_same_v<T, SharedPtrWithInfoCallback>
+            std::is_same_v<T, ConstRefSharedConstPtrWithInfoCallback>
         ))
         {
+          if constexpr (wraps) {
+            callback(wrap_ros_message_as_custom_type(message), message_info);
+          } else {
+            callback(convert_ros_message_to_custom_type_unique_ptr(*message), message_info);
+          }
+        } else if constexpr (is_ta && std::is_same_v<T, SharedPtrWithInfoCallback>) {
           callback(convert_ros_message_to_custom_type_unique_ptr(*message), message_info);
         }
         // conditions for output is ros message
@@ -574,6 +617,27 @@ public:
     TRACEPOINT(callback_end, static_cast<const void *>(this));
   }
 
+  // Dispatch when input is a ros message owned by the subscription, to a const reference callback.
+  void
+  dispatch_const_ref(
+    const ROSMessageType & message,
+    const rclcpp::MessageInfo & message_info)
+  {
+    TRACEPOINT(callback_start, static_cast<const void *>(this), false);
+    if (auto callback = std::get_if<ConstRefROSMessageCallback>(&callback_variant_)) {
+      (*callback)(message);
+    } else if (  // NOLINT[readability/braces]
+      auto callback_with_info = std::get_if<ConstRefWithInfoROSMessageCallback>(&callback_variant_))
+    {
+      (*callback_with_info)(message, message_info);
+    } else {
+      throw std::runtime_error(
+              "dispatch_const_ref called on an AnySubscriptionCallback not taking "
+              "the ROS message by const reference");
+    }
+    TRACEPOINT(callback_end, static_cast<const void *>(this));
+  }
+
   // Dispatch when input is a serialized message and the output could be anything.
   void
   dispatch(
@@ -672,14 +736,25 @@ public:
       [&message, &message_info, this](auto && callback) {
         using T = std::decay_t<decltype(callback)>;
         static constexpr bool is_ta = rclcpp::TypeAdapter<MessageT>::is_specialized::value;
+        // The custom message given to the callbacks taking it as const may wrap the ROS message.
+        static constexpr bool wraps =
+          is_ta && rclcpp::detail::has_wrap_ros_message<rclcpp::TypeAdapter<MessageT>>::value;
 
         // conditions for custom type
         if constexpr (is_ta && std::is_same_v<T, ConstRefCallback>) {
-          auto local_message = convert_ros_message_to_custom_type_unique_ptr(*message);
-          callback(*local_message);
+          if constexpr (wraps) {
+            callback(*wrap_ros_message_as_custom_type(message));
+          } else {
+            auto local_message = convert_ros_message_to_custom_type_unique_ptr(*message);
+            callback(*local_message);
+          }
         } else if constexpr (is_ta && std::is_same_v<T, ConstRefWithInfoCallback>) {  // NOLINT
-          auto local_message = convert_ros_message_to_custom_type_unique_ptr(*message);
-          callback(*local_message, message_info);
+          if constexpr (wraps) {
+            callback(*wrap_ros_message_as_custom_type(message), message_info);
+          } else {
+            auto local_message = convert_ros_message_to_custom_type_unique_ptr(*message);
+            callback(*local_message, message_info);
+          }
         } else if constexpr (  // NOLINT[readability/braces]
           is_ta && (
             std::is_same_v<T, UniquePtrCallback>||
@@ -700,14 +775,22 @@ public:
             std::is_same_v<T, ConstRefSharedConstPtrCallback>
         ))
         {
-          callback(convert_ros_message_to_custom_type_unique_ptr(*message));
+          if constexpr (wraps) {
+            callback(wrap_ros_message_as_custom_type(message));
+          } else {
+            callback(convert_ros_message_to_custom_type_unique_ptr(*message));
+          }
         } else if constexpr (  // NOLINT[readability/braces]
           is_ta && (
             std::is_same_v<T, SharedConstPtrWithInfoCallback>||
             std::is_same_v<T, ConstRefSharedConstPtrWithInfoCallback>
         ))
         {
-          callback(convert_ros_message_to_custom_type_unique_ptr(*message), message_info);
+          if constexpr (wraps) {
+            callback(wrap_ros_message_as_custom_type(message), message_info);
+          } else {
+            callback(convert_ros_message_to_custom_type_unique_ptr(*message), message_info);
+          }
         }
         // conditions for ros message type
         else if constexpr (std::is_same_v<T, ConstRefROSMessageCallback>) {  // NOLINT
@@ -866,17 +949,230 @@ public:
     TRACEPOINT(callback_end, static_cast<const void *>(this));
   }
 
+  /// Dispatch an intra-process message of the custom type of the TypeAdapter.
+  /**
+   * The callbacks taking the custom type get the message without any
+   * conversion, which only happens for the callbacks taking the ROS message.
+   */
+  template<typename T = SubscribedType>
+  std::enable_if_t<
+    rclcpp::TypeAdapter<MessageT>::is_specialized::value &&
+    std::is_same_v<T, SubscribedType>
+  >
+  dispatch_intra_process(
+    std::shared_ptr<const T> message,
+    const rclcpp::MessageInfo & message_info)
+  {
+    TRACEPOINT(callback_start, static_cast<const void *>(this), true);
+    // Check if the variant is "unset", throw if it is.
+    if (callback_variant_.index() == 0) {
+      if (std::get<0>(callback_variant_) == nullptr) {
+        // This can happen if it is default initialized, or if it is assigned nullptr.
+        throw std::runtime_error("dispatch called on an unset AnySubscriptionCallback");
+      }
+    }
+    // Dispatch.
+    std::visit(
+      [&message, &message_info, this](auto && callback) {
+        using CallbackT = std::decay_t<decltype(callback)>;
+
+        // conditions for custom type
+        if constexpr (std::is_same_v<CallbackT, ConstRefCallback>) {
+          callback(*message);
+        } else if constexpr (std::is_same_v<CallbackT, ConstRefWithInfoCallback>) {
+          callback(*message, message_info);
+        } else if constexpr (  // NOLINT[readability/braces]
+          std::is_same_v<CallbackT, UniquePtrCallback>||
+          std::is_same_v<CallbackT, SharedPtrCallback>)
+        {
+          callback(create_custom_unique_ptr_from_custom_shared_ptr_message(message));
+        } else if constexpr (  // NOLINT[readability/braces]
+          std::is_same_v<CallbackT, UniquePtrWithInfoCallback>||
+          std::is_same_v<CallbackT, SharedPtrWithInfoCallback>)
+        {
+          callback(create_custom_unique_ptr_from_custom_shared_ptr_message(message), message_info);
+        } else if constexpr (  // NOLINT[readability/braces]
+          std::is_same_v<CallbackT, SharedConstPtrCallback>||
+          std::is_same_v<CallbackT, ConstRefSharedConstPtrCallback>)
+        {
+          callback(message);
+        } else if constexpr (  // NOLINT[readability/braces]
+          std::is_same_v<CallbackT, SharedConstPtrWithInfoCallback>||
+          std::is_same_v<CallbackT, ConstRefSharedConstPtrWithInfoCallback>)
+        {
+          callback(message, message_info);
+        }
+        // conditions for ros message type
+        else if constexpr (std::is_same_v<CallbackT, ConstRefROSMessageCallback>) {  // NOLINT
+          auto local_message = convert_custom_type_to_ros_message_unique_ptr(*message);
+          callback(*local_message);
+        } else if constexpr (std::is_same_v<CallbackT, ConstRefWithInfoROSMessageCallback>) {
+          auto local_message = convert_custom_type_to_ros_message_unique_ptr(*message);
+          callback(*local_message, message_info);
+        } else if constexpr (  // NOLINT[readability/braces]
+          std::is_same_v<CallbackT, UniquePtrROSMessageCallback>||
+          std::is_same_v<CallbackT, SharedPtrROSMessageCallback>||
+          std::is_same_v<CallbackT, SharedConstPtrROSMessageCallback>||
+          std::is_same_v<CallbackT, ConstRefSharedConstPtrROSMessageCallback>)
+        {
+          callback(convert_custom_type_to_ros_message_unique_ptr(*message));
+        } else if constexpr (  // NOLINT[readability/braces]
+          std::is_same_v<CallbackT, UniquePtrWithInfoROSMessageCallback>||
+          std::is_same_v<CallbackT, SharedPtrWithInfoROSMessageCallback>||
+          std::is_same_v<CallbackT, SharedConstPtrWithInfoROSMessageCallback>||
+          std::is_same_v<CallbackT, ConstRefSharedConstPtrWithInfoROSMessageCallback>)
+        {
+          callback(convert_custom_type_to_ros_message_unique_ptr(*message), message_info);
+        }
+        // condition to catch SerializedMessage types
+        else if constexpr (  // NOLINT[readability/braces]
+          std::is_same_v<CallbackT, ConstRefSerializedMessageCallback>||
+          std::is_same_v<CallbackT, ConstRefSerializedMessageWithInfoCallback>||
+          std::is_same_v<CallbackT, UniquePtrSerializedMessageCallback>||
+          std::is_same_v<CallbackT, UniquePtrSerializedMessageWithInfoCallback>||
+          std::is_same_v<CallbackT, SharedConstPtrSerializedMessageCallback>||
+          std::is_same_v<CallbackT, SharedConstPtrSerializedMessageWithInfoCallback>||
+          std::is_same_v<CallbackT, ConstRefSharedConstPtrSerializedMessageCallback>||
+          std::is_same_v<CallbackT, ConstRefSharedConstPtrSerializedMessageWithInfoCallback>||
+          std::is_same_v<CallbackT, SharedPtrSerializedMessageCallback>||
+          std::is_same_v<CallbackT, SharedPtrSerializedMessageWithInfoCallback>)
+        {
+          throw std::runtime_error(
+            "Cannot dispatch std::shared_ptr<const SubscribedType> message "
+            "to rclcpp::SerializedMessage");
+        }
+        // condition to catch unhandled callback types
+        else {  // NOLINT[readability/braces]
+          static_assert(always_false_v<CallbackT>, "unhandled callback type");
+        }
+      }, callback_variant_);
+    TRACEPOINT(callback_end, static_cast<const void *>(this));
+  }
+
+  /// Dispatch an owned intra-process message of the custom type of the TypeAdapter.
+  template<typename T = SubscribedType>
+  std::enable_if_t<
+    rclcpp::TypeAdapter<MessageT>::is_specialized::value &&
+    std::is_same_v<T, SubscribedType>
+  >
+  dispatch_intra_process(
+    std::unique_ptr<T, SubscribedTypeDeleter> message,
+    const rclcpp::MessageInfo & message_info)
+  {
+    TRACEPOINT(callback_start, static_cast<const void *>(this), true);
+    // Check if the variant is "unset", throw if it is.
+    if (callback_variant_.index() == 0) {
+      if (std::get<0>(callback_variant_) == nullptr) {
+        // This can happen if it is default initialized, or if it is assigned nullptr.
+        throw std::runtime_error("dispatch called on an unset AnySubscriptionCallback");
+      }
+    }
+    // Dispatch.
+    std::visit(
+      [&message, &message_info, this](auto && callback) {
+        using CallbackT = std::decay_t<decltype(callback)>;
+
+        // conditions for custom type
+        if constexpr (std::is_same_v<CallbackT, ConstRefCallback>) {
+          callback(*message);
+        } else if constexpr (std::is_same_v<CallbackT, ConstRefWithInfoCallback>) {
+          callback(*message, message_info);
+        } else if constexpr (  // NOLINT[readability/braces]
+          std::is_same_v<CallbackT, UniquePtrCallback>||
+          std::is_same_v<CallbackT, SharedPtrCallback>||
+          std::is_same_v<CallbackT, SharedConstPtrCallback>||
+          std::is_same_v<CallbackT, ConstRefSharedConstPtrCallback>)
+        {
+          callback(std::move(message));
+        } else if constexpr (  // NOLINT[readability/braces]
+          std::is_same_v<CallbackT, UniquePtrWithInfoCallback>||
+          std::is_same_v<CallbackT, SharedPtrWithInfoCallback>||
+          std::is_same_v<CallbackT, SharedConstPtrWithInfoCallback>||
+          std::is_same_v<CallbackT, ConstRefSharedConstPtrWithInfoCallback>)
+        {
+          callback(std::move(message), message_info);
+        }
+        // conditions for ros message type
+        else if constexpr (std::is_same_v<CallbackT, ConstRefROSMessageCallback>) {  // NOLINT
+          auto local_message = convert_custom_type_to_ros_message_unique_ptr(*message);
+          callback(*local_message);
+        } else if constexpr (std::is_same_v<CallbackT, ConstRefWithInfoROSMessageCallback>) {
+          auto local_message = convert_custom_type_to_ros_message_unique_ptr(*message);
+          callback(*local_message, message_info);
+        } else if constexpr (  // NOLINT[readability/braces]
+          std::is_same_v<CallbackT, UniquePtrROSMessageCallback>||
+          std::is_same_v<CallbackT, SharedPtrROSMessageCallback>||
+          std::is_same_v<CallbackT, SharedConstPtrROSMessageCallback>||
+          std::is_same_v<CallbackT, ConstRefSharedConstPtrROSMessageCallback>)
+        {
+          callback(convert_custom_type_to_ros_message_unique_ptr(*message));
+        } else if constexpr (  // NOLINT[readability/braces]
+          std::is_same_v<CallbackT, UniquePtrWithInfoROSMessageCallback>||
+          std::is_same_v<CallbackT, SharedPtrWithInfoROSMessageCallback>||
+          std::is_same_v<CallbackT, SharedConstPtrWithInfoROSMessageCallback>||
+          std::is_same_v<CallbackT, ConstRefSharedConstPtrWithInfoROSMessageCallback>)
+        {
+          callback(convert_custom_type_to_ros_message_unique_ptr(*message), message_info);
+        }
+        // condition to catch SerializedMessage types
+        else if constexpr (  // NOLINT[readability/braces]
+          std::is_same_v<CallbackT, ConstRefSerializedMessageCallback>||
+          std::is_same_v<CallbackT, ConstRefSerializedMessageWithInfoCallback>||
+          std::is_same_v<CallbackT, UniquePtrSerializedMessageCallback>||
+          std::is_same_v<CallbackT, UniquePtrSerializedMessageWithInfoCallback>||
+          std::is_same_v<CallbackT, SharedConstPtrSerializedMessageCallback>||
+          std::is_same_v<CallbackT, SharedConstPtrSerializedMessageWithInfoCallback>||
+          std::is_same_v<CallbackT, ConstRefSharedConstPtrSerializedMessageCallback>||
+          std::is_same_v<CallbackT, ConstRefSharedConstPtrSerializedMessageWithInfoCallback>||
+          std::is_same_v<CallbackT, SharedPtrSerializedMessageCallback>||
+          std::is_same_v<CallbackT, SharedPtrSerializedMessageWithInfoCallback>)
+        {
+          throw std::runtime_error(
+            "Cannot dispatch std::unique_ptr<SubscribedType, SubscribedTypeDeleter> message "
+            "to rclcpp::SerializedMessage");
+        }
+        // condition to catch unhandled callback types
+        else {  // NOLINT[readability/braces]
+          static_assert(always_false_v<CallbackT>, "unhandled callback type");
+        }
+      }, callback_variant_);
+    TRACEPOINT(callback_end, static_cast<const void *>(this));
+  }
+
+  /// Return true if the callback does not need to own the message.
+  /**
+   * Callbacks taking the message by const reference only read it, so they
+   * share the message with other subscriptions instead of getting a copy.
+   */
   constexpr
   bool
   use_take_shared_method() const
   {
     return
+      std::holds_alternative<ConstRefCallback>(callback_variant_) ||
+      std::holds_alternative<ConstRefWithInfoCallback>(callback_variant_) ||
+      std::holds_alternative<ConstRefROSMessageCallback>(callback_variant_) ||
+      std::holds_alternative<ConstRefWithInfoROSMessageCallback>(callback_variant_) ||
       std::holds_alternative<SharedConstPtrCallback>(callback_variant_) ||
       std::holds_alternative<SharedConstPtrWithInfoCallback>(callback_variant_) ||
       std::holds_alternative<ConstRefSharedConstPtrCallback>(callback_variant_) ||
       std::holds_alternative<ConstRefSharedConstPtrWithInfoCallback>(callback_variant_);
   }
 
+  /// Return true if the callback takes the ROS message by const reference.
+  /**
+   * Such a callback cannot keep the message, so the subscription may take
+   * every message into the same one.
+   */
+  constexpr
+  bool
+  is_const_ref_ros_message_callback() const
+  {
+    return
+      std::holds_alternative<ConstRefROSMessageCallback>(callback_variant_) ||
+      std::holds_alternative<ConstRefWithInfoROSMessageCallback>(callback_variant_);
+  }
+
   constexpr
   bool
   is_serialized_message_callback() const
@@ -889,6 +1185,31 @@ public:
       std::holds_alternative<SharedPtrSerializedMessageCallback>(callback_variant_);
   }
 
+  /// Return true if the callback takes the custom type of the TypeAdapter.
+  /**
+   * Intra-process, the messages of such a callback are stored as the custom
+   * type, so that they are not converted from and back to the ROS message.
+   */
+  bool
+  is_custom_type_callback() const
+  {
+    if constexpr (rclcpp::TypeAdapter<MessageT>::is_specialized::value) {
+      return
+        std::holds_alternative<ConstRefCallback>(callback_variant_) ||
+        std::holds_alternative<ConstRefWithInfoCallback>(callback_variant_) ||
+        std::holds_alternative<UniquePtrCallback>(callback_variant_) ||
+        std::holds_alternative<UniquePtrWithInfoCallback>(callback_variant_) ||
+        std::holds_alternative<SharedConstPtrCallback>(callback_variant_) ||
+        std::holds_alternative<SharedConstPtrWithInfoCallback>(callback_variant_) ||
+        std::holds_alternative<ConstRefSharedConstPtrCallback>(callback_variant_) ||
+        std::holds_alternative<ConstRefSharedConstPtrWithInfoCallback>(callback_variant_) ||
+        std::holds_alternative<SharedPtrCallback>(callback_variant_) ||
+        std::holds_alternative<SharedPtrWithInfoCallback>(callback_variant_);
+    } else {
+      return false;
+    }
+  }
+
   void
   register_callback_for_tracing()
   {
@@ -0,0 +1,90 @@
+// Copyright 2021 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__ASYNC_LOGGING_HPP_
+#define RCLCPP__ASYNC_LOGGING_HPP_
+
+#include <cstddef>
+#include <cstdint>
+
+#include "rclcpp/visibility_control.hpp"
+
+namespace rclcpp
+{
+/// Output of the log messages by a dedicated thread, instead of by the threads logging them.
+/**
+ * Once enabled, through rclcpp::InitOptions::async_logging(), the output
+ * handler installed by rclcpp formats each message on the calling thread into
+ * a slot of a bounded lock-free queue and returns, without taking the global
+ * logging mutex.
+ * A thread started with the logging system takes the messages out of the
+ * queue and gives them to the output handlers of rcl, the console, the log
+ * file and rosout, holding the global logging mutex.
+ * The messages left in the queue are output when the logging system is
+ * finalized, at the shutdown of the last context using it.
+ *
+ * When the queue is full and the policy is OverflowPolicy::Block, the logging
+ * thread outputs the queued messages itself if it can take the global logging
+ * mutex, and otherwise waits for the output thread to do it.
+ * Messages longer than AsyncLoggingOptions::max_message_size are truncated,
+ * as are very long logger, function and file names.
+ * Messages logged by the output handlers themselves are output synchronously.
+ */
+namespace async_logging
+{
+
+/// What a thread logging a message does when the queue is full.
+enum class OverflowPolicy
+{
+  /// Drop the message and count it, see get_dropped_count().
+  Drop,
+  /// Wait for room in the queue, see rclcpp::async_logging.
+  Block,
+};
+
+/// Options of the asynchronous logging.
+struct AsyncLoggingOptions
+{
+  /// If true, the messages are output by a dedicated thread.
+  bool enabled = false;
+  /// Number of messages the queue holds, rounded up to a power of two.
+  size_t capacity = 1024;
+  /// Size of the formatted messages, including the terminating null character.
+  size_t max_message_size = 1024;
+  /// What to do with a message when the queue is full.
+  OverflowPolicy overflow_policy = OverflowPolicy::Drop;
+};
+
+/// Return true if the messages are currently output by the dedicated thread.
+RCLCPP_PUBLIC
+bool
+is_enabled();
+
+/// Return the number of messages dropped because the queue was full, since the process started.
+RCLCPP_PUBLIC
+uint64_t
+get_dropped_count();
+
+/// Output the messages logged before the call, on the calling thread.
+/**
+ * Does nothing if the asynchronous logging is not enabled.
+ */
+RCLCPP_PUBLIC
+void
+flush();
+
+}  // namespace async_logging
+}  // namespace rclcpp
+
+#endif  // RCLCPP__ASYNC_LOGGING_HPP_
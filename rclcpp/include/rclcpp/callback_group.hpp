@@ -16,11 +16,13 @@
 #define RCLCPP__CALLBACK_GROUP_HPP_
 
 #include <atomic>
+#include <cstdint>
 #include <mutex>
 #include <string>
 #include <vector>
 
 #include "rclcpp/client.hpp"
+#include "rclcpp/detail/read_copy_update_pointer.hpp"
 #include "rclcpp/publisher_base.hpp"
 #include "rclcpp/service.hpp"
 #include "rclcpp/subscription_base.hpp"
@@ -48,6 +50,7 @@ enum class CallbackGroupType
 
 class CallbackGroup
 {
+  friend class rclcpp::ClientBase;
   friend class rclcpp::node_interfaces::NodeServices;
   friend class rclcpp::node_interfaces::NodeTimers;
   friend class rclcpp::node_interfaces::NodeTopics;
@@ -85,51 +88,80 @@ public:
    * group, or after, is irrelevant; the callback group will be automatically
    * added to the executor in either case.
    *
+   * Finally, callback groups have a priority.
+   * When entities of several callback groups are ready at the same time, the
+   * executor runs the ones of the group with the highest priority first,
+   * whatever their type.
+   * Groups with the same priority, 0 by default, are scheduled as usual.
+   *
    * \param[in] group_type The type of the callback group.
    * \param[in] automatically_add_to_executor_with_node A boolean that
    *   determines whether a callback group is automatically added to an executor
    *   with the node with which it is associated.
+   * \param[in] priority The scheduling priority of the callback group, higher
+   *   values are executed first.
    */
   RCLCPP_PUBLIC
   explicit CallbackGroup(
     CallbackGroupType group_type,
-    bool automatically_add_to_executor_with_node = true);
+    bool automatically_add_to_executor_with_node = true,
+    int priority = 0);
 
   template<typename Function>
   rclcpp::SubscriptionBase::SharedPtr
   find_subscription_ptrs_if(Function func) const
   {
-    return _find_ptrs_if_impl<rclcpp::SubscriptionBase, Function>(func, subscription_ptrs_);
+    auto entities = entities_snapshot_.read();
+    return _find_ptrs_if_impl<rclcpp::SubscriptionBase, Function>(func, entities->subscriptions);
   }
 
   template<typename Function>
   rclcpp::TimerBase::SharedPtr
   find_timer_ptrs_if(Function func) const
   {
-    return _find_ptrs_if_impl<rclcpp::TimerBase, Function>(func, timer_ptrs_);
+    auto entities = entities_snapshot_.read();
+    return _find_ptrs_if_impl<rclcpp::TimerBase, Function>(func, entities->timers);
   }
 
   template<typename Function>
   rclcpp::ServiceBase::SharedPtr
   find_service_ptrs_if(Function func) const
   {
-    return _find_ptrs_if_impl<rclcpp::ServiceBase, Function>(func, service_ptrs_);
+    auto entities = entities_snapshot_.read();
+    return _find_ptrs_if_impl<rclcpp::ServiceBase, Function>(func, entities->services);
   }
 
   template<typename Function>
   rclcpp::ClientBase::SharedPtr
   find_client_ptrs_if(Function func) const
   {
-    return _find_ptrs_if_impl<rclcpp::ClientBase, Function>(func, client_ptrs_);
+    auto entities = entities_snapshot_.read();
+    return _find_ptrs_if_impl<rclcpp::ClientBase, Function>(func, entities->clients);
   }
 
   template<typename Function>
   rclcpp::Waitable::SharedPtr
   find_waitable_ptrs_if(Function func) const
   {
-    return _find_ptrs_if_impl<rclcpp::Waitable, Function>(func, waitable_ptrs_);
+    auto entities = entities_snapshot_.read();
+    return _find_ptrs_if_impl<rclcpp::Waitable, Function>(func, entities->waitables);
   }
 
+  /// Return the version of the entities of this callback group.
+  /**
+   * The version changes each time an entity is added to or removed from the
+   * group, so that the entities collected from the group can be reused as
+   * long as it is the same.
+   * The entities which are destroyed without being removed do not change it.
+   *
+   * This function is thread-safe and lock-free.
+   *
+   * \return the version of the entities.
+   */
+  RCLCPP_PUBLIC
+  uint64_t
+  get_entities_version() const;
+
   RCLCPP_PUBLIC
   std::atomic_bool &
   can_be_taken_from();
@@ -138,6 +170,14 @@ public:
   const CallbackGroupType &
   type() const;
 
+  /// Return the scheduling priority of this callback group.
+  /**
+   * \return the priority given to the constructor, higher values are executed first.
+   */
+  RCLCPP_PUBLIC
+  int
+  priority() const;
+
   /// Return a reference to the 'associated with executor' atomic boolean.
   /**
    * When a callback group is added to an executor this boolean is checked
@@ -194,6 +234,11 @@ protected:
   void
   remove_waitable(const rclcpp::Waitable::SharedPtr waitable_ptr) noexcept;
 
+  /// Publish a snapshot of the entities, must be called with mutex_ locked after changing them.
+  RCLCPP_PUBLIC
+  void
+  publish_entities();
+
   CallbackGroupType type_;
   // Mutex to protect the subsequent vectors of pointers.
   mutable std::mutex mutex_;
@@ -205,13 +250,23 @@ protected:
   std::vector<rclcpp::Waitable::WeakPtr> waitable_ptrs_;
   std::atomic_bool can_be_taken_from_;
   const bool automatically_add_to_executor_with_node_;
+  const int priority_;
 
 private:
+  /// Entities of the group, as they were when they last changed.
+  struct EntitiesSnapshot
+  {
+    std::vector<rclcpp::SubscriptionBase::WeakPtr> subscriptions;
+    std::vector<rclcpp::TimerBase::WeakPtr> timers;
+    std::vector<rclcpp::ServiceBase::WeakPtr> services;
+    std::vector<rclcpp::ClientBase::WeakPtr> clients;
+    std::vector<rclcpp::Waitable::WeakPtr> waitables;
+  };
+
   template<typename TypeT, typename Function>
-  typename TypeT::SharedPtr _find_ptrs_if_impl(
-    Function func, const std::vector<typename TypeT::WeakPtr> & vect_ptrs) const
+  static typename TypeT::SharedPtr _find_ptrs_if_impl(
+    Function func, const std::vector<typename TypeT::WeakPtr> & vect_ptrs)
   {
-    std::lock_guard<std::mutex> lock(mutex_);
     for (auto & weak_ptr : vect_ptrs) {
       auto ref_ptr = weak_ptr.lock();
       if (ref_ptr && func(ref_ptr)) {
@@ -220,6 +275,10 @@ private:
     }
     return typename TypeT::SharedPtr();
   }
+
+  std::atomic<uint64_t> entities_version_{0};
+  /// Read by the find functions without locking, so that they do not contend with each other.
+  rclcpp::detail::ReadCopyUpdatePointer<EntitiesSnapshot> entities_snapshot_;
 };
 
 }  // namespace rclcpp
@@ -15,7 +15,10 @@
 #ifndef RCLCPP__CLIENT_HPP_
 #define RCLCPP__CLIENT_HPP_
 
+#include <algorithm>
 #include <atomic>
+#include <chrono>
+#include <functional>
 #include <future>
 #include <map>
 #include <memory>
@@ -23,15 +26,25 @@
 #include <string>
 #include <tuple>
 #include <utility>
+#include <vector>
 
 #include "rcl/client.h"
 #include "rcl/error_handling.h"
 #include "rcl/wait.h"
 
+#include "rclcpp/detail/future_waiters.hpp"
+#include "rclcpp/detail/pending_request_ring.hpp"
+#include "rclcpp/detail/resolve_rcl_entity_name.hpp"
+#include "rclcpp/detail/shared_object_pool.hpp"
 #include "rclcpp/exceptions.hpp"
+#include "rclcpp/experimental/client_intra_process.hpp"
+#include "rclcpp/experimental/client_intra_process_base.hpp"
+#include "rclcpp/experimental/service_intra_process.hpp"
+#include "rclcpp/experimental/service_intra_process_base.hpp"
 #include "rclcpp/function_traits.hpp"
 #include "rclcpp/macros.hpp"
 #include "rclcpp/node_interfaces/node_graph_interface.hpp"
+#include "rclcpp/timer.hpp"
 #include "rclcpp/type_support_decl.hpp"
 #include "rclcpp/utilities.hpp"
 #include "rclcpp/expand_topic_or_service_name.hpp"
@@ -45,11 +58,22 @@
 namespace rclcpp
 {
 
+class CallbackGroup;
+
 namespace node_interfaces
 {
 class NodeBaseInterface;
 }  // namespace node_interfaces
 
+namespace experimental
+{
+/**
+ * IntraProcessManager is forward declared here, avoiding a circular inclusion between
+ * `intra_process_manager.hpp` and `client.hpp`.
+ */
+class IntraProcessManager;
+}  // namespace experimental
+
 class ClientBase
 {
 public:
@@ -150,9 +174,85 @@ public:
   bool
   exchange_in_use_by_wait_set_state(bool in_use_state);
 
+  /// Return the waitable for intra-process responses, or nullptr if intra-process is disabled.
+  RCLCPP_PUBLIC
+  rclcpp::Waitable::SharedPtr
+  get_intra_process_waitable() const;
+
+  /// Return the timer expiring the requests, or nullptr until a request is sent with a timeout.
+  RCLCPP_PUBLIC
+  rclcpp::TimerBase::SharedPtr
+  get_request_timeout_timer() const;
+
+  /// Set the maximum number of requests waiting for a response at a time.
+  /**
+   * When as many requests are pending, sending another one throws.
+   *
+   * \param[in] max_pending_requests the maximum number of pending requests, or
+   *   0, the default, for no limit.
+   */
+  RCLCPP_PUBLIC
+  void
+  set_max_pending_requests(size_t max_pending_requests);
+
+  /// Return the maximum number of pending requests, 0 meaning no limit.
+  RCLCPP_PUBLIC
+  size_t
+  get_max_pending_requests() const;
+
 protected:
   RCLCPP_DISABLE_COPY(ClientBase)
 
+  /// Keep the intra-process part of the client and the intra-process manager of its context.
+  RCLCPP_PUBLIC
+  void
+  setup_intra_process(
+    rclcpp::experimental::ClientIntraProcessBase::SharedPtr client_intra_process);
+
+  /// Return the intra-process service with the name of this client, or nullptr.
+  RCLCPP_PUBLIC
+  rclcpp::experimental::ServiceIntraProcessBase::SharedPtr
+  find_intra_process_service() const;
+
+  /// Keep the node and the callback group of the client, to enable the request timeouts.
+  RCLCPP_PUBLIC
+  void
+  setup_request_timeouts(
+    std::weak_ptr<rclcpp::node_interfaces::NodeBaseInterface> node_base,
+    std::weak_ptr<rclcpp::CallbackGroup> group);
+
+  /// Return whether the requests can be sent with a timeout.
+  RCLCPP_PUBLIC
+  bool
+  request_timeouts_enabled() const;
+
+  /// Add the timer expiring the requests to the callback group of the client.
+  /**
+   * \throws std::runtime_error if the callback group no longer exists.
+   */
+  RCLCPP_PUBLIC
+  void
+  add_request_timeout_timer(rclcpp::TimerBase::SharedPtr request_timeout_timer);
+
+  /// Make the request timeout timer fire after the given delay.
+  /**
+   * \param[in] delay time until the next request expires.
+   * \param[in] wake_executor whether to wake up the executor of the node, so
+   *   that it stops waiting for the previous expiry, which it does not need from
+   *   the callback of the timer.
+   */
+  RCLCPP_PUBLIC
+  void
+  schedule_request_timeout(std::chrono::nanoseconds delay, bool wake_executor);
+
+  /// Throw if as many requests as allowed are pending already.
+  /**
+   * \throws rclcpp::exceptions::TooManyPendingRequestsError if the limit is reached.
+   */
+  RCLCPP_PUBLIC
+  void
+  check_pending_requests_limit(size_t number_of_pending_requests) const;
+
   RCLCPP_PUBLIC
   bool
   wait_for_service_nanoseconds(std::chrono::nanoseconds timeout);
@@ -172,10 +272,20 @@ protected:
   std::shared_ptr<rcl_client_t> client_handle_;
 
   std::atomic<bool> in_use_by_wait_set_{false};
+
+  std::weak_ptr<rclcpp::experimental::IntraProcessManager> weak_ipm_;
+  rclcpp::experimental::ClientIntraProcessBase::SharedPtr client_intra_process_base_;
+
+  rclcpp::TimerBase::SharedPtr request_timeout_timer_;
+  std::weak_ptr<rclcpp::node_interfaces::NodeBaseInterface> weak_node_base_;
+  std::weak_ptr<rclcpp::CallbackGroup> weak_group_;
+  std::atomic<size_t> max_pending_requests_{0};
 };
 
 template<typename ServiceT>
-class Client : public ClientBase
+class Client
+  : public ClientBase,
+  public std::enable_shared_from_this<Client<ServiceT>>
 {
 public:
   using SharedRequest = typename ServiceT::Request::SharedPtr;
@@ -192,9 +302,13 @@ public:
 
   using CallbackType = std::function<void (SharedFuture)>;
   using CallbackWithRequestType = std::function<void (SharedFutureWithRequest)>;
+  using ResponseCallbackType = std::function<void (SharedResponse)>;
 
   RCLCPP_SMART_PTR_DEFINITIONS(Client)
 
+  using ClientIntraProcessT = rclcpp::experimental::ClientIntraProcess<ServiceT>;
+  using ServiceIntraProcessT = rclcpp::experimental::ServiceIntraProcess<ServiceT>;
+
   /// Default constructor.
   /**
    * The constructor for a Client is almost never called directly.
@@ -216,11 +330,13 @@ public:
     using rosidl_typesupport_cpp::get_service_type_support_handle;
     auto service_type_support_handle =
       get_service_type_support_handle<ServiceT>();
+    const std::string rcl_service_name =
+      rclcpp::detail::resolve_rcl_entity_name(*node_base, service_name, true);
     rcl_ret_t ret = rcl_client_init(
       this->get_client_handle().get(),
       this->get_rcl_node_handle(),
       service_type_support_handle,
-      service_name.c_str(),
+      rcl_service_name.c_str(),
       &client_options);
     if (ret != RCL_RET_OK) {
       if (ret == RCL_RET_SERVICE_NAME_INVALID) {
@@ -260,6 +376,59 @@ public:
     return this->take_type_erased_response(&response_out, request_header_out);
   }
 
+  /// Reuse the requests, the responses and the request headers once they are dropped.
+  /**
+   * They are then borrowed from pools of objects allocated here, instead of
+   * being allocated for each request: the responses and their headers are
+   * overwritten by the responses taken into them, and the requests created
+   * with create_request() are reset to their default value.
+   * An object is borrowed again once the futures, the callbacks and the
+   * middleware drop their references to it, when all of them are referenced a
+   * new one is allocated.
+   * The responses of the intra-process services are not taken from the pools.
+   *
+   * The pools can only be enabled once, for instance right after the creation
+   * of the client, and are kept until it is destroyed.
+   *
+   * \param[in] pool_size number of objects of each pool, at least the number of
+   *   requests pending at a time plus the number of responses the callbacks keep.
+   * \throws std::invalid_argument if pool_size is 0.
+   * \throws std::runtime_error if the pools are already enabled.
+   */
+  void
+  enable_object_pools(size_t pool_size)
+  {
+    auto object_pools = std::make_unique<ObjectPools>(pool_size);
+    ObjectPools * expected = nullptr;
+    if (!object_pools_.compare_exchange_strong(expected, object_pools.get())) {
+      throw std::runtime_error("the object pools of the client are already enabled");
+    }
+    object_pools_owner_ = std::move(object_pools);
+  }
+
+  /// Return true if the requests, the responses and the request headers are pooled.
+  bool
+  has_object_pools() const
+  {
+    return object_pools_.load(std::memory_order_acquire) != nullptr;
+  }
+
+  /// Create a default request, to be sent with async_send_request().
+  /**
+   * \return shared pointer to the request, from the pool if enabled.
+   */
+  SharedRequest
+  create_request()
+  {
+    ObjectPools * object_pools = object_pools_.load(std::memory_order_acquire);
+    if (object_pools) {
+      auto request = object_pools->requests.borrow();
+      *request = typename ServiceT::Request();
+      return request;
+    }
+    return std::make_shared<typename ServiceT::Request>();
+  }
+
   /// Create a shared pointer with the response type
   /**
    * \return shared pointer with the response type
@@ -267,6 +436,10 @@ public:
   std::shared_ptr<void>
   create_response() override
   {
+    ObjectPools * object_pools = object_pools_.load(std::memory_order_acquire);
+    if (object_pools) {
+      return object_pools->responses.borrow();
+    }
     return std::shared_ptr<void>(new typename ServiceT::Response());
   }
 
@@ -277,6 +450,10 @@ public:
   std::shared_ptr<rmw_request_id_t>
   create_request_header() override
   {
+    ObjectPools * object_pools = object_pools_.load(std::memory_order_acquire);
+    if (object_pools) {
+      return object_pools->request_headers.borrow();
+    }
     // TODO(wjwwood): This should probably use rmw_request_id's allocator.
     //                (since it is a C type)
     return std::shared_ptr<rmw_request_id_t>(new rmw_request_id_t);
@@ -295,6 +472,13 @@ public:
     std::unique_lock<std::mutex> lock(pending_requests_mutex_);
     auto typed_response = std::static_pointer_cast<typename ServiceT::Response>(response);
     int64_t sequence_number = request_header->sequence_number;
+    ResponseCallbackType response_callback;
+    if (pending_response_callbacks_.take(sequence_number, response_callback)) {
+      lock.unlock();
+      response_callback(std::move(typed_response));
+      rclcpp::detail::wake_future_waiters();
+      return;
+    }
     // TODO(esteve) this should throw instead since it is not expected to happen in the first place
     if (this->pending_requests_.count(sequence_number) == 0) {
       RCUTILS_LOG_ERROR_NAMED(
@@ -312,6 +496,54 @@ public:
 
     call_promise->set_value(typed_response);
     callback(future);
+    // The future may be awaited by an executor other than the one executing this client.
+    rclcpp::detail::wake_future_waiters();
+  }
+
+  /// Enable the requests to be sent by pointer to the intra-process services.
+  /**
+   * When a service with intra-process enabled exists in the same context and
+   * with the same service name, the requests are passed to it by pointer and
+   * its responses are received by pointer, instead of through the middleware.
+   * A request must then not be modified after being sent.
+   *
+   * This is called by rclcpp::create_client(), before the client is added to
+   * its callback group.
+   */
+  void
+  enable_intra_process()
+  {
+    std::weak_ptr<Client> weak_this = this->shared_from_this();
+    client_intra_process_ = std::make_shared<ClientIntraProcessT>(
+      context_,
+      [weak_this](std::shared_ptr<rmw_request_id_t> request_header, SharedResponse response)
+      {
+        auto client = weak_this.lock();
+        if (client) {
+          client->handle_response(request_header, std::move(response));
+        }
+      });
+    this->setup_intra_process(client_intra_process_);
+  }
+
+  /// Enable the requests to be sent with a timeout.
+  /**
+   * With the first request sent with a timeout, a timer is added to the
+   * callback group of the client to expire the requests which are not
+   * answered in time, and is executed like the other timers of the group.
+   *
+   * This is called by rclcpp::create_client().
+   *
+   * \param[in] node_base the node of the client, whose executor is woken up
+   *   when a request expires before the ones sent previously.
+   * \param[in] group the callback group of the client.
+   */
+  void
+  enable_request_timeouts(
+    std::weak_ptr<rclcpp::node_interfaces::NodeBaseInterface> node_base,
+    std::weak_ptr<rclcpp::CallbackGroup> group)
+  {
+    this->setup_request_timeouts(std::move(node_base), std::move(group));
   }
 
   SharedFuture
@@ -320,6 +552,19 @@ public:
     return async_send_request(request, [](SharedFuture) {});
   }
 
+  /// Send a request, whose response is given to the future and then to the callback.
+  /**
+   * \param[in] request the request to send.
+   * \param[in] cb the callback called with the future, from the executor.
+   * \param[in] timeout time after which the request expires, or 0 for no timeout.
+   *   The future of an expired request throws rclcpp::exceptions::RequestTimeoutError.
+   * \return the future of the response.
+   * \throws rclcpp::exceptions::RCLError based exceptions if the request cannot be sent.
+   * \throws rclcpp::exceptions::TooManyPendingRequestsError if as many requests
+   *   as set with ClientBase::set_max_pending_requests() are pending already.
+   * \throws std::runtime_error if a timeout is given but the request timeouts
+   *   are not enabled.
+   */
   template<
     typename CallbackT,
     typename std::enable_if<
@@ -330,15 +575,12 @@ public:
     >::type * = nullptr
   >
   SharedFuture
-  async_send_request(SharedRequest request, CallbackT && cb)
+  async_send_request(
+    SharedRequest request, CallbackT && cb,
+    std::chrono::nanoseconds timeout = std::chrono::nanoseconds(0))
   {
     std::lock_guard<std::mutex> lock(pending_requests_mutex_);
-    int64_t sequence_number;
-    rcl_ret_t ret = rcl_send_request(get_client_handle().get(), request.get(), &sequence_number);
-    if (RCL_RET_OK != ret) {
-      rclcpp::exceptions::throw_from_rcl_error(ret, "failed to send request");
-    }
-
+    int64_t sequence_number = send_request(request, timeout);
     SharedPromise call_promise = std::make_shared<Promise>();
     SharedFuture f(call_promise->get_future());
     pending_requests_[sequence_number] =
@@ -356,28 +598,230 @@ public:
     >::type * = nullptr
   >
   SharedFutureWithRequest
-  async_send_request(SharedRequest request, CallbackT && cb)
+  async_send_request(
+    SharedRequest request, CallbackT && cb,
+    std::chrono::nanoseconds timeout = std::chrono::nanoseconds(0))
   {
     SharedPromiseWithRequest promise = std::make_shared<PromiseWithRequest>();
     SharedFutureWithRequest future_with_request(promise->get_future());
 
     auto wrapping_cb = [future_with_request, promise, request,
         cb = std::forward<CallbackWithRequestType>(cb)](SharedFuture future) {
-        auto response = future.get();
-        promise->set_value(std::make_pair(request, response));
+        try {
+          auto response = future.get();
+          promise->set_value(std::make_pair(request, response));
+        } catch (const rclcpp::exceptions::RequestTimeoutError &) {
+          promise->set_exception(std::current_exception());
+        }
         cb(future_with_request);
       };
 
-    async_send_request(request, wrapping_cb);
+    async_send_request(request, wrapping_cb, timeout);
 
     return future_with_request;
   }
 
+  /// Send a request whose response is only given to a callback.
+  /**
+   * Unlike with the other overloads, no promise nor future is created: the
+   * callback is stored in a ring of slots indexed by the sequence number of
+   * the request, allocated once for as many requests as are pending at a time.
+   *
+   * \param[in] request the request to send.
+   * \param[in] cb the callback called with the response, from the executor,
+   *   or with nullptr if the request timed out.
+   * \param[in] timeout time after which the request expires, or 0 for no timeout.
+   * \return the sequence number of the request.
+   * \throws rclcpp::exceptions::RCLError based exceptions if the request cannot be sent.
+   * \throws rclcpp::exceptions::TooManyPendingRequestsError if as many requests
+   *   as set with ClientBase::set_max_pending_requests() are pending already.
+   * \throws std::runtime_error if a timeout is given but the request timeouts
+   *   are not enabled.
+   */
+  template<
+    typename CallbackT,
+    typename std::enable_if<
+      rclcpp::function_traits::same_arguments<
+        CallbackT,
+        ResponseCallbackType
+      >::value
+    >::type * = nullptr
+  >
+  int64_t
+  async_send_request(
+    SharedRequest request, CallbackT && cb,
+    std::chrono::nanoseconds timeout = std::chrono::nanoseconds(0))
+  {
+    std::lock_guard<std::mutex> lock(pending_requests_mutex_);
+    int64_t sequence_number = send_request(request, timeout);
+    pending_response_callbacks_.insert(
+      sequence_number, ResponseCallbackType(std::forward<CallbackT>(cb)));
+    return sequence_number;
+  }
+
 private:
   RCLCPP_DISABLE_COPY(Client)
 
+  /// Send the request, with pending_requests_mutex_ locked, and return its sequence number.
+  int64_t
+  send_request(const SharedRequest & request, std::chrono::nanoseconds timeout)
+  {
+    if (timeout > std::chrono::nanoseconds(0)) {
+      if (!request_timeouts_enabled()) {
+        throw std::runtime_error("request timeouts are not enabled for this client");
+      }
+      if (!request_timeout_timer_) {
+        create_request_timeout_timer();
+      }
+    }
+    check_pending_requests_limit(pending_requests_.size() + pending_response_callbacks_.size());
+    int64_t sequence_number;
+    auto intra_process_service = get_intra_process_service();
+    if (intra_process_service) {
+      // Negative sequence numbers do not collide with the ones given by the middleware.
+      sequence_number = --intra_process_sequence_number_;
+      intra_process_service->store_intra_process_request(
+        sequence_number, request, client_intra_process_);
+    } else {
+      rcl_ret_t ret = rcl_send_request(get_client_handle().get(), request.get(), &sequence_number);
+      if (RCL_RET_OK != ret) {
+        rclcpp::exceptions::throw_from_rcl_error(ret, "failed to send request");
+      }
+    }
+    if (timeout > std::chrono::nanoseconds(0)) {
+      add_request_deadline(sequence_number, std::chrono::steady_clock::now() + timeout);
+    }
+    return sequence_number;
+  }
+
+  /// Create the timer expiring the requests, canceled until a deadline is added.
+  void
+  create_request_timeout_timer()
+  {
+    std::weak_ptr<Client> weak_this = this->shared_from_this();
+    auto expire_requests = [weak_this]() {
+        auto client = weak_this.lock();
+        if (client) {
+          client->expire_timed_out_requests();
+        }
+      };
+    auto timer = rclcpp::WallTimer<decltype(expire_requests)>::make_shared(
+      std::chrono::hours(1), std::move(expire_requests), context_);
+    timer->cancel();
+    this->add_request_timeout_timer(std::move(timer));
+  }
+
+  using RequestDeadline = std::pair<std::chrono::steady_clock::time_point, int64_t>;
+
+  /// Keep when the request expires, with pending_requests_mutex_ locked.
+  void
+  add_request_deadline(int64_t sequence_number, std::chrono::steady_clock::time_point deadline)
+  {
+    request_deadlines_.emplace_back(deadline, sequence_number);
+    std::push_heap(
+      request_deadlines_.begin(), request_deadlines_.end(), std::greater<RequestDeadline>());
+    if (deadline < next_request_expiry_) {
+      next_request_expiry_ = deadline;
+      schedule_request_timeout(deadline - std::chrono::steady_clock::now(), true);
+    }
+  }
+
+  /// Complete the requests whose deadline has passed, called by the request timeout timer.
+  /**
+   * The deadlines of the requests answered in time are left in the heap and
+   * skipped once they pass, rather than searched for with each response.
+   */
+  void
+  expire_timed_out_requests()
+  {
+    using rclcpp::exceptions::RequestTimeoutError;
+    std::unique_lock<std::mutex> lock(pending_requests_mutex_);
+    auto now = std::chrono::steady_clock::now();
+    while (!request_deadlines_.empty() && request_deadlines_.front().first <= now) {
+      int64_t sequence_number = request_deadlines_.front().second;
+      std::pop_heap(
+        request_deadlines_.begin(), request_deadlines_.end(), std::greater<RequestDeadline>());
+      request_deadlines_.pop_back();
+
+      ResponseCallbackType response_callback;
+      if (pending_response_callbacks_.take(sequence_number, response_callback)) {
+        lock.unlock();
+        response_callback(nullptr);
+        lock.lock();
+        continue;
+      }
+      auto it = pending_requests_.find(sequence_number);
+      if (it == pending_requests_.end()) {
+        continue;
+      }
+      auto tuple = std::move(it->second);
+      pending_requests_.erase(it);
+      // Unlock here to allow the service to be called again from the callback.
+      lock.unlock();
+      std::get<0>(tuple)->set_exception(
+        std::make_exception_ptr(
+          RequestTimeoutError(
+            std::string("request ") + std::to_string(sequence_number) + " to service '" +
+            this->get_service_name() + "' timed out")));
+      std::get<1>(tuple)(std::get<2>(tuple));
+      rclcpp::detail::wake_future_waiters();
+      lock.lock();
+    }
+    if (request_deadlines_.empty()) {
+      next_request_expiry_ = std::chrono::steady_clock::time_point::max();
+      request_timeout_timer_->cancel();
+    } else {
+      next_request_expiry_ = request_deadlines_.front().first;
+      schedule_request_timeout(next_request_expiry_ - std::chrono::steady_clock::now(), false);
+    }
+  }
+
+  /// Return the intra-process service the requests are sent to, or nullptr.
+  typename ServiceIntraProcessT::SharedPtr
+  get_intra_process_service()
+  {
+    if (!client_intra_process_) {
+      return nullptr;
+    }
+    auto intra_process_service = intra_process_service_.lock();
+    if (!intra_process_service) {
+      // A service of another type with the same name is reached through the middleware.
+      intra_process_service =
+        std::dynamic_pointer_cast<ServiceIntraProcessT>(find_intra_process_service());
+      intra_process_service_ = intra_process_service;
+    }
+    return intra_process_service;
+  }
+
   std::map<int64_t, std::tuple<SharedPromise, CallbackType, SharedFuture>> pending_requests_;
+  /// Callbacks of the requests sent without a future, guarded by pending_requests_mutex_.
+  rclcpp::detail::PendingRequestRing<ResponseCallbackType> pending_response_callbacks_;
+  /// Min-heap of the deadlines of the requests, guarded by pending_requests_mutex_.
+  std::vector<RequestDeadline> request_deadlines_;
+  /// When the request timeout timer fires, guarded by pending_requests_mutex_.
+  std::chrono::steady_clock::time_point next_request_expiry_ =
+    std::chrono::steady_clock::time_point::max();
   std::mutex pending_requests_mutex_;
+
+  typename ClientIntraProcessT::SharedPtr client_intra_process_;
+  /// Intra-process service found by the last request, guarded by pending_requests_mutex_.
+  typename ServiceIntraProcessT::WeakPtr intra_process_service_;
+  int64_t intra_process_sequence_number_ = 0;
+
+  struct ObjectPools
+  {
+    explicit ObjectPools(size_t pool_size)
+    : requests(pool_size), responses(pool_size), request_headers(pool_size)
+    {}
+
+    rclcpp::detail::SharedObjectPool<typename ServiceT::Request> requests;
+    rclcpp::detail::SharedObjectPool<typename ServiceT::Response> responses;
+    rclcpp::detail::SharedObjectPool<rmw_request_id_t> request_headers;
+  };
+
+  /// Pools set once by enable_object_pools(), owned by object_pools_owner_.
+  std::atomic<ObjectPools *> object_pools_{nullptr};
+  std::unique_ptr<ObjectPools> object_pools_owner_;
 };
 
 }  // namespace rclcpp
@@ -19,6 +19,8 @@
 #include <memory>
 #include <mutex>
 
+#include "rclcpp/contexts/default_context.hpp"
+#include "rclcpp/duration.hpp"
 #include "rclcpp/macros.hpp"
 #include "rclcpp/time.hpp"
 #include "rclcpp/visibility_control.hpp"
@@ -78,6 +80,49 @@ public:
   Time
   now();
 
+  /// Sleep until a time of this clock, or until the context is shut down.
+  /**
+   * The steady and system clocks wait on a condition variable until the
+   * corresponding std::chrono time, which shutting down the context notifies.
+   *
+   * A clock of the type `RCL_ROS_TIME` waits like the system clock while ROS
+   * time is not active.
+   * Once it is, it wakes up on each update of the clock, like on each message
+   * received on "/clock" by the time source, and may sleep forever if the time
+   * `until` is never reached.
+   * Activating or deactivating ROS time during the sleep ends it, as `until`
+   * does not mean the same time anymore.
+   *
+   * \param[in] until time of this clock to sleep until.
+   * \param[in] context the context whose shutdown interrupts the sleep.
+   * \return true once `until` is reached, immediately if it is in the past.
+   * \return false if the context was shut down, or ROS time was activated or
+   *   deactivated, before `until` was reached.
+   * \throws std::runtime_error if the context is invalid, or if `until` does not
+   *   have the clock type of this clock.
+   * \throws anything rclcpp::exceptions::throw_from_rcl_error can throw.
+   */
+  RCLCPP_PUBLIC
+  bool
+  sleep_until(
+    Time until,
+    Context::SharedPtr context = contexts::get_global_default_context());
+
+  /// Sleep for a duration of this clock, or until the context is shut down.
+  /**
+   * Equivalent to calling sleep_until() with `now() + rel_time`.
+   *
+   * \param[in] rel_time duration of this clock to sleep for.
+   * \param[in] context the context whose shutdown interrupts the sleep.
+   * \return the return value of sleep_until().
+   * \throws anything sleep_until() can throw.
+   */
+  RCLCPP_PUBLIC
+  bool
+  sleep_for(
+    Duration rel_time,
+    Context::SharedPtr context = contexts::get_global_default_context());
+
   /**
    * Returns the clock of the type `RCL_ROS_TIME` is active.
    *
@@ -0,0 +1,77 @@
+// Copyright 2021 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__CONTENT_FILTER_OPTIONS_HPP_
+#define RCLCPP__CONTENT_FILTER_OPTIONS_HPP_
+
+#include <functional>
+#include <typeinfo>
+#include <utility>
+
+#include "rclcpp/serialized_message.hpp"
+
+namespace rclcpp
+{
+
+/// Predicates selecting the messages of a subscription which are given to its callback.
+/**
+ * The messages a predicate rejects are dropped before the callback is called.
+ *
+ * The predicate on the serialized message is evaluated before the message is
+ * deserialized: a subscription with such a predicate takes its messages
+ * serialized from the middleware, and only deserializes those it accepts.
+ * A rclcpp::SerializedMessageReader reads the fields it compares.
+ * The predicate on the message is evaluated on the taken message, and on the
+ * messages of the intra-process publishers, which are never serialized.
+ *
+ * The messages are filtered by the subscription: they are still sent to it by
+ * the publishers.
+ */
+struct ContentFilterOptions
+{
+  /// Predicate on a serialized message, true to give the message to the callback.
+  std::function<bool (const rclcpp::SerializedMessage &)> serialized_message_filter;
+
+  /// Predicate on a pointer to a message, true to give the message to the callback.
+  /**
+   * See set_message_filter().
+   */
+  std::function<bool (const void *)> message_filter;
+
+  /// Type of the messages of message_filter.
+  const std::type_info * message_filter_type = nullptr;
+
+  /// Set the predicate on the messages, which are of type MessageT.
+  /**
+   * The messages are the ROS messages, even when the subscription uses a
+   * rclcpp::TypeAdapter, in which case the messages of the intra-process
+   * publishers of the custom type are not filtered.
+   *
+   * \param[in] filter callable taking a const MessageT & and returning a bool.
+   */
+  template<typename MessageT, typename FilterT>
+  void
+  set_message_filter(FilterT filter)
+  {
+    message_filter =
+      [filter = std::move(filter)](const void * message) {
+        return filter(*static_cast<const MessageT *>(message));
+      };
+    message_filter_type = &typeid(MessageT);
+  }
+};
+
+}  // namespace rclcpp
+
+#endif  // RCLCPP__CONTENT_FILTER_OPTIONS_HPP_
@@ -15,6 +15,7 @@
 #ifndef RCLCPP__CONTEXT_HPP_
 #define RCLCPP__CONTEXT_HPP_
 
+#include <atomic>
 #include <condition_variable>
 #include <functional>
 #include <memory>
@@ -33,6 +34,7 @@
 #include "rclcpp/init_options.hpp"
 #include "rclcpp/macros.hpp"
 #include "rclcpp/visibility_control.hpp"
+#include "rclcpp/worker_pool.hpp"
 
 namespace rclcpp
 {
@@ -109,6 +111,13 @@ public:
    * This allows derived entities to hold on to shard pointers to the first
    * context object until they are done.
    *
+   * If this context was shutdown with rclcpp::InitOptions::reusable_context()
+   * set, and init_options sets it and the same domain id, the underlying rcl
+   * context and the middleware it initialized are reused, only parsing the
+   * arguments again.
+   * The arguments which configure the middleware, like the enclave, are then
+   * ignored.
+   *
    * This function is thread-safe.
    *
    * \param[in] argc number of arguments
@@ -156,6 +165,22 @@ public:
   size_t
   get_domain_id() const;
 
+  /// Return the pool of threads to offload work to, creating it on the first call.
+  /**
+   * The pool is configured by rclcpp::InitOptions::worker_pool(), and is shut
+   * down by shutdown(), after the on_shutdown callbacks are called, dropping
+   * the work not started yet and waiting for the work being done.
+   * The next init() of a reusable context gets a new pool.
+   *
+   * This function is thread-safe.
+   *
+   * \return the worker pool of the context.
+   * \throws std::runtime_error if the context is not valid.
+   */
+  RCLCPP_PUBLIC
+  rclcpp::WorkerPool::SharedPtr
+  get_worker_pool();
+
   /// Return the shutdown reason, or empty string if not shutdown.
   /**
    * This function is thread-safe.
@@ -170,7 +195,8 @@ public:
    *
    * - acquires a lock to prevent race conditions with init, on_shutdown, etc.
    * - if the context is not initialized, return false
-   * - rcl_shutdown() is called on the internal rcl_context_t instance
+   * - rcl_shutdown() is called on the internal rcl_context_t instance, unless
+   *   the context is reusable, see rclcpp::InitOptions::reusable_context()
    * - the shutdown reason is set
    * - each on_shutdown callback is called, in the order that they were added
    * - interrupt blocking sleep_for() calls, so they return early due to shutdown
@@ -324,9 +350,14 @@ private:
   // between is_initialized and shutdown.
   mutable std::recursive_mutex init_mutex_;
   std::shared_ptr<rcl_context_t> rcl_context_;
+  // True when the rcl context was kept valid by the shutdown of a reusable context.
+  std::atomic_bool rcl_context_kept_{false};
   rclcpp::InitOptions init_options_;
   std::string shutdown_reason_;
 
+  // Created by get_worker_pool(), protected by init_mutex_.
+  rclcpp::WorkerPool::SharedPtr worker_pool_;
+
   // Keep shared ownership of the global logging mutex.
   std::shared_ptr<std::recursive_mutex> logging_mutex_;
 
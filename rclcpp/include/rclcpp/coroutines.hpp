@@ -0,0 +1,361 @@
+// Copyright 2021 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__COROUTINES_HPP_
+#define RCLCPP__COROUTINES_HPP_
+
+// rclcpp itself is built as C++17, the coroutines are only available to the
+// code including this header which is compiled with coroutines enabled, as C++20.
+#if defined(__has_include)
+# if __has_include(<coroutine>) && defined(__cpp_impl_coroutine)
+#  define RCLCPP_HAS_COROUTINES 1
+# endif
+#endif
+
+#ifdef RCLCPP_HAS_COROUTINES
+
+#include <chrono>
+#include <coroutine>
+#include <exception>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+
+#include "rclcpp/client.hpp"
+#include "rclcpp/qos.hpp"
+#include "rclcpp/subscription.hpp"
+#include "rclcpp/timer.hpp"
+
+namespace rclcpp
+{
+/// Awaitables to write sequential logic as C++20 coroutines, resumed by the executors.
+/**
+ * A coroutine returning rclcpp::coroutines::Task starts running when it is
+ * called, and each co_await suspends it without blocking the thread, until
+ * the awaited response, timer or message comes.
+ * The coroutine is then resumed by the callback of the client, timer or
+ * subscription, on the executor thread executing the callback group of the
+ * entity, like any other callback:
+ *
+ * ```cpp
+ * rclcpp::coroutines::Task
+ * call_twice(rclcpp::Node::SharedPtr node, rclcpp::Client<ServiceT>::SharedPtr client)
+ * {
+ *   auto response = co_await rclcpp::coroutines::async_send_request(client, request);
+ *   co_await rclcpp::coroutines::sleep_for(node, std::chrono::seconds(1));
+ *   response = co_await rclcpp::coroutines::async_send_request(client, request);
+ * }
+ * ```
+ *
+ * The entities awaited must outlive the coroutine, which must not be
+ * resumed while the executor of the entity is not spinning.
+ */
+namespace coroutines
+{
+
+/// Return type of the coroutines started detached, which run until their end.
+/**
+ * An exception escaping the coroutine calls std::terminate(), like one
+ * escaping the function of a std::thread.
+ */
+class Task
+{
+public:
+  struct promise_type
+  {
+    Task
+    get_return_object() noexcept
+    {
+      return Task();
+    }
+
+    std::suspend_never
+    initial_suspend() noexcept
+    {
+      return {};
+    }
+
+    std::suspend_never
+    final_suspend() noexcept
+    {
+      return {};
+    }
+
+    void
+    return_void() noexcept
+    {
+    }
+
+    void
+    unhandled_exception() noexcept
+    {
+      std::terminate();
+    }
+  };
+};
+
+/// Awaitable response of a request sent by a client, see async_send_request().
+template<typename ServiceT>
+class ResponseAwaiter
+{
+public:
+  using ClientT = rclcpp::Client<ServiceT>;
+
+  ResponseAwaiter(
+    typename ClientT::SharedPtr client,
+    typename ClientT::SharedRequest request,
+    std::chrono::nanoseconds timeout)
+  : client_(std::move(client)), request_(std::move(request)), timeout_(timeout)
+  {
+  }
+
+  bool
+  await_ready() const noexcept
+  {
+    return false;
+  }
+
+  void
+  await_suspend(std::coroutine_handle<> handle)
+  {
+    // The response may be handled by another thread before this returns.
+    client_->async_send_request(
+      request_,
+      [this, handle](typename ClientT::SharedFuture future) {
+        future_ = std::move(future);
+        handle.resume();
+      },
+      timeout_);
+  }
+
+  /// Return the response.
+  /**
+   * \throws rclcpp::exceptions::RequestTimeoutError if the request timed out.
+   */
+  typename ClientT::SharedResponse
+  await_resume()
+  {
+    return future_.get();
+  }
+
+private:
+  typename ClientT::SharedPtr client_;
+  typename ClientT::SharedRequest request_;
+  std::chrono::nanoseconds timeout_;
+  typename ClientT::SharedFuture future_;
+};
+
+/// Send a request, resuming the coroutine with its response.
+/**
+ * The coroutine is resumed by the executor executing the client.
+ *
+ * \param[in] client the client sending the request.
+ * \param[in] request the request.
+ * \param[in] timeout time after which the request is completed with a
+ *   rclcpp::exceptions::RequestTimeoutError, 0 to never time out,
+ *   see rclcpp::Client::async_send_request().
+ */
+template<typename ServiceT>
+ResponseAwaiter<ServiceT>
+async_send_request(
+  std::shared_ptr<rclcpp::Client<ServiceT>> client,
+  typename rclcpp::Client<ServiceT>::SharedRequest request,
+  std::chrono::nanoseconds timeout = std::chrono::nanoseconds(0))
+{
+  return ResponseAwaiter<ServiceT>(std::move(client), std::move(request), timeout);
+}
+
+/// Awaitable expiry of a one shot timer, see sleep_for().
+template<typename NodeT>
+class TimerAwaiter
+{
+public:
+  TimerAwaiter(NodeT node, std::chrono::nanoseconds duration)
+  : node_(std::move(node)), duration_(duration)
+  {
+  }
+
+  bool
+  await_ready() const noexcept
+  {
+    return false;
+  }
+
+  void
+  await_suspend(std::coroutine_handle<> handle)
+  {
+    // The timer keeps itself alive until it expires, the coroutine may be
+    // resumed and this destroyed before the timer is created.
+    struct State
+    {
+      std::mutex mutex;
+      rclcpp::TimerBase::SharedPtr timer;
+    };
+    auto state = std::make_shared<State>();
+    std::lock_guard<std::mutex> lock(state->mutex);
+    state->timer = node_->create_wall_timer(
+      duration_,
+      [state, handle](rclcpp::TimerBase & timer) {
+        {
+          std::lock_guard<std::mutex> lock(state->mutex);
+          if (!state->timer) {
+            return;
+          }
+          // The executor holds the timer while executing it.
+          state->timer.reset();
+        }
+        timer.cancel();
+        handle.resume();
+      });
+  }
+
+  void
+  await_resume() const noexcept
+  {
+  }
+
+private:
+  NodeT node_;
+  std::chrono::nanoseconds duration_;
+};
+
+/// Suspend the coroutine for a duration of the steady clock.
+/**
+ * The coroutine is resumed by the executor executing the default callback
+ * group of the node, from the callback of a one shot wall timer.
+ *
+ * \param[in] node the node creating the timer, like a rclcpp::Node::SharedPtr.
+ * \param[in] duration the duration.
+ */
+template<typename NodeT>
+TimerAwaiter<NodeT>
+sleep_for(NodeT node, std::chrono::nanoseconds duration)
+{
+  return TimerAwaiter<NodeT>(std::move(node), duration);
+}
+
+/// Awaitable next message of a topic, see wait_for_message().
+template<typename MessageT, typename NodeT>
+class MessageAwaiter
+{
+public:
+  MessageAwaiter(
+    NodeT node, std::string topic, const rclcpp::QoS & qos, std::chrono::nanoseconds timeout)
+  : node_(std::move(node)), topic_(std::move(topic)), qos_(qos), timeout_(timeout)
+  {
+  }
+
+  bool
+  await_ready() const noexcept
+  {
+    return false;
+  }
+
+  void
+  await_suspend(std::coroutine_handle<> handle)
+  {
+    state_ = std::make_shared<State>();
+    state_->handle = handle;
+    // The callbacks wait for the entities to be created, this may be
+    // destroyed once they are.
+    auto state = state_;
+    std::lock_guard<std::mutex> lock(state->mutex);
+    state->subscription = node_->template create_subscription<MessageT>(
+      topic_, qos_,
+      [state](std::shared_ptr<MessageT> message) {
+        complete(state, std::move(message));
+      });
+    if (timeout_ >= std::chrono::nanoseconds::zero()) {
+      state->timer = node_->create_wall_timer(
+        timeout_,
+        [state]() {
+          complete(state, nullptr);
+        });
+    }
+  }
+
+  /// Return the message, or nullptr if the timeout elapsed first.
+  std::shared_ptr<MessageT>
+  await_resume()
+  {
+    return std::move(state_->message);
+  }
+
+private:
+  struct State
+  {
+    std::mutex mutex;
+    std::coroutine_handle<> handle;
+    std::shared_ptr<MessageT> message;
+    typename rclcpp::Subscription<MessageT>::SharedPtr subscription;
+    rclcpp::TimerBase::SharedPtr timer;
+  };
+
+  static void
+  complete(const std::shared_ptr<State> & state, std::shared_ptr<MessageT> message)
+  {
+    {
+      std::lock_guard<std::mutex> lock(state->mutex);
+      if (!state->subscription) {
+        return;
+      }
+      state->message = std::move(message);
+      // The executor holds the entity it is executing, the other one is released.
+      state->subscription.reset();
+      if (state->timer) {
+        state->timer->cancel();
+        state->timer.reset();
+      }
+    }
+    state->handle.resume();
+  }
+
+  NodeT node_;
+  std::string topic_;
+  rclcpp::QoS qos_;
+  std::chrono::nanoseconds timeout_;
+  std::shared_ptr<State> state_;
+};
+
+/// Wait for the next message of a topic, resuming the coroutine with it.
+/**
+ * A subscription is created for the wait, like rclcpp::wait_for_message()
+ * does, and the coroutine is resumed by the executor executing the default
+ * callback group of the node.
+ *
+ * \param[in] node the node creating the subscription, like a rclcpp::Node::SharedPtr.
+ * \param[in] topic the topic.
+ * \param[in] timeout time after which the coroutine is resumed without a message,
+ *   negative to wait forever.
+ * \param[in] qos the quality of service of the subscription.
+ */
+template<typename MessageT, typename NodeT>
+MessageAwaiter<MessageT, NodeT>
+wait_for_message(
+  NodeT node,
+  std::string topic,
+  std::chrono::nanoseconds timeout = std::chrono::nanoseconds(-1),
+  const rclcpp::QoS & qos = rclcpp::QoS(1))
+{
+  return MessageAwaiter<MessageT, NodeT>(std::move(node), std::move(topic), qos, timeout);
+}
+
+}  // namespace coroutines
+}  // namespace rclcpp
+
+#endif  // RCLCPP_HAS_COROUTINES
+
+#endif  // RCLCPP__COROUTINES_HPP_
@@ -18,8 +18,11 @@
 #include <memory>
 #include <string>
 
+#include "rclcpp/detail/resolve_use_intra_process.hpp"
+#include "rclcpp/intra_process_setting.hpp"
 #include "rclcpp/node_interfaces/node_base_interface.hpp"
 #include "rclcpp/node_interfaces/node_services_interface.hpp"
+#include "rclcpp/startup_profiling.hpp"
 #include "rmw/rmw.h"
 
 namespace rclcpp
@@ -35,8 +38,10 @@ create_client(
   std::shared_ptr<node_interfaces::NodeServicesInterface> node_services,
   const std::string & service_name,
   const rmw_qos_profile_t & qos_profile,
-  rclcpp::CallbackGroup::SharedPtr group)
+  rclcpp::CallbackGroup::SharedPtr group,
+  rclcpp::IntraProcessSetting use_intra_process_comm = rclcpp::IntraProcessSetting::NodeDefault)
 {
+  rclcpp::startup_profiling::ScopedPhase profiled_phase("client", service_name.c_str());
   rcl_client_options_t options = rcl_client_get_default_options();
   options.qos = qos_profile;
 
@@ -45,6 +50,11 @@ create_client(
     node_graph,
     service_name,
     options);
+  if (rclcpp::detail::resolve_use_intra_process(use_intra_process_comm, *node_base)) {
+    cli->enable_intra_process();
+  }
+  cli->enable_request_timeouts(
+    node_base, group ? group : node_base->get_default_callback_group());
 
   auto cli_base_ptr = std::dynamic_pointer_cast<rclcpp::ClientBase>(cli);
   node_services->add_client(cli_base_ptr, group);
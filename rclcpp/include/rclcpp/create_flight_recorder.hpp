@@ -0,0 +1,84 @@
+// Copyright 2021 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef RCLCPP__CREATE_FLIGHT_RECORDER_HPP_
+#define RCLCPP__CREATE_FLIGHT_RECORDER_HPP_
+
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "rclcpp/create_generic_subscription.hpp"
+#include "rclcpp/flight_recorder.hpp"
+#include "rclcpp/intra_process_setting.hpp"
+#include "rclcpp/node_interfaces/get_node_topics_interface.hpp"
+#include "rclcpp/qos.hpp"
+#include "rclcpp/serialized_message.hpp"
+#include "rclcpp/subscription_options.hpp"
+
+namespace rclcpp
+{
+
+/// Create a FlightRecorder and subscribe it to its topics with generic subscriptions.
+/**
+ * The messages are recorded with the system time they are received at.
+ *
+ * \param[in] node the node, or an object exposing its interfaces, subscribing to the topics.
+ * \param[in] topics the recorded topics and the types of their messages.
+ * \param[in] qos QoS of the subscriptions of the topics.
+ * \param[in] options capacity of the ring, duration of the dumps, file of the ring and options
+ *   of the subscriptions.
+ * \return the recorder, which owns the subscriptions of the topics.
+ * \throws anything the FlightRecorder constructor and rclcpp::create_generic_subscription() can
+ *   throw.
+ */
+template<typename NodeT>
+FlightRecorder::SharedPtr
+create_flight_recorder(
+  NodeT && node,
+  const std::vector<FlightRecorderTopic> & topics,
+  const rclcpp::QoS & qos,
+  const FlightRecorderOptions & options = FlightRecorderOptions())
+{
+  auto recorder = FlightRecorder::make_shared(topics, options);
+
+  rclcpp::SubscriptionOptions subscription_options = options.subscription_options;
+  subscription_options.use_intra_process_comm = rclcpp::IntraProcessSetting::Disable;
+  auto node_topics = rclcpp::node_interfaces::get_node_topics_interface(node);
+  std::weak_ptr<FlightRecorder> weak_recorder = recorder;
+  std::vector<rclcpp::SubscriptionBase::SharedPtr> subscriptions;
+  for (size_t i = 0; i < topics.size(); ++i) {
+    subscriptions.push_back(
+      rclcpp::create_generic_subscription(
+        node_topics, topics[i].name, topics[i].type, qos,
+        [weak_recorder, i](std::shared_ptr<rclcpp::SerializedMessage> message) {
+          auto recorder = weak_recorder.lock();
+          if (recorder) {
+            const auto receive_time = std::chrono::duration_cast<std::chrono::nanoseconds>(
+              std::chrono::system_clock::now().time_since_epoch());
+            recorder->record(i, message->get_rcl_serialized_message(), receive_time.count());
+          }
+        },
+        subscription_options));
+  }
+  recorder->set_subscriptions(std::move(subscriptions));
+  return recorder;
+}
+
+}  // namespace rclcpp
+
+#endif  // RCLCPP__CREATE_FLIGHT_RECORDER_HPP_
@@ -0,0 +1,80 @@
+// Copyright 2021 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__CREATE_GRAPH_CHANGE_SUBSCRIPTION_HPP_
+#define RCLCPP__CREATE_GRAPH_CHANGE_SUBSCRIPTION_HPP_
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "rclcpp/callback_group.hpp"
+#include "rclcpp/graph_change_subscription.hpp"
+#include "rclcpp/node_interfaces/get_node_graph_interface.hpp"
+#include "rclcpp/node_interfaces/get_node_waitables_interface.hpp"
+#include "rclcpp/node_interfaces/node_graph_interface.hpp"
+#include "rclcpp/node_interfaces/node_waitables_interface.hpp"
+
+namespace rclcpp
+{
+
+/// Create a GraphChangeSubscription and add it to the node, to be executed by its executor.
+/**
+ * \param[in] node_graph graph interface of the node.
+ * \param[in] node_waitables waitables interface of the node.
+ * \param[in] topic_names the topics whose publishers and subscriptions are watched.
+ * \param[in] watch_nodes whether the nodes appearing and disappearing are watched.
+ * \param[in] callback called with the changes of the watched part of the graph.
+ * \param[in] group callback group of the subscription, or nullptr for the default one.
+ * \return the subscription, which stops delivering changes once removed from the node.
+ */
+inline
+GraphChangeSubscription::SharedPtr
+create_graph_change_subscription(
+  rclcpp::node_interfaces::NodeGraphInterface::SharedPtr node_graph,
+  rclcpp::node_interfaces::NodeWaitablesInterface::SharedPtr node_waitables,
+  const std::vector<std::string> & topic_names,
+  bool watch_nodes,
+  GraphChangeSubscription::CallbackType callback,
+  rclcpp::CallbackGroup::SharedPtr group = nullptr)
+{
+  auto subscription = GraphChangeSubscription::make_shared(
+    std::move(node_graph), topic_names, watch_nodes, std::move(callback));
+  node_waitables->add_waitable(subscription, group);
+  return subscription;
+}
+
+/// Create a GraphChangeSubscription and add it to a "Node like" object.
+template<typename NodeT>
+GraphChangeSubscription::SharedPtr
+create_graph_change_subscription(
+  NodeT && node,
+  const std::vector<std::string> & topic_names,
+  bool watch_nodes,
+  GraphChangeSubscription::CallbackType callback,
+  rclcpp::CallbackGroup::SharedPtr group = nullptr)
+{
+  return create_graph_change_subscription(
+    rclcpp::node_interfaces::get_node_graph_interface(node),
+    rclcpp::node_interfaces::get_node_waitables_interface(node),
+    topic_names,
+    watch_nodes,
+    std::move(callback),
+    group);
+}
+
+}  // namespace rclcpp
+
+#endif  // RCLCPP__CREATE_GRAPH_CHANGE_SUBSCRIPTION_HPP_
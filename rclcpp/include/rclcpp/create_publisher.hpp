@@ -26,6 +26,7 @@
 #include "rclcpp/publisher_options.hpp"
 #include "rclcpp/qos.hpp"
 #include "rclcpp/qos_overriding_options.hpp"
+#include "rclcpp/startup_profiling.hpp"
 #include "rclcpp/detail/qos_parameters.hpp"
 
 #include "rmw/qos_profiles.h"
@@ -53,6 +54,7 @@ create_publisher(
   )
 )
 {
+  rclcpp::startup_profiling::ScopedPhase profiled_phase("publisher", topic_name.c_str());
   auto node_topics_interface = rclcpp::node_interfaces::get_node_topics_interface(node_topics);
   const rclcpp::QoS & actual_qos = options.qos_overriding_options.get_policy_kinds().size() ?
     rclcpp::detail::declare_qos_parameters(
@@ -19,8 +19,12 @@
 #include <string>
 #include <utility>
 
+#include "rclcpp/detail/resolve_rcl_entity_name.hpp"
+#include "rclcpp/detail/resolve_use_intra_process.hpp"
+#include "rclcpp/intra_process_setting.hpp"
 #include "rclcpp/node_interfaces/node_base_interface.hpp"
 #include "rclcpp/node_interfaces/node_services_interface.hpp"
+#include "rclcpp/startup_profiling.hpp"
 #include "rclcpp/visibility_control.hpp"
 #include "rmw/rmw.h"
 
@@ -37,8 +41,10 @@ create_service(
   const std::string & service_name,
   CallbackT && callback,
   const rmw_qos_profile_t & qos_profile,
-  rclcpp::CallbackGroup::SharedPtr group)
+  rclcpp::CallbackGroup::SharedPtr group,
+  rclcpp::IntraProcessSetting use_intra_process_comm = rclcpp::IntraProcessSetting::NodeDefault)
 {
+  rclcpp::startup_profiling::ScopedPhase profiled_phase("service", service_name.c_str());
   rclcpp::AnyServiceCallback<ServiceT> any_service_callback;
   any_service_callback.set(std::forward<CallbackT>(callback));
 
@@ -47,7 +53,11 @@ create_service(
 
   auto serv = Service<ServiceT>::make_shared(
     node_base->get_shared_rcl_node_handle(),
-    service_name, any_service_callback, service_options);
+    rclcpp::detail::resolve_rcl_entity_name(*node_base, service_name, true),
+    any_service_callback, service_options);
+  if (rclcpp::detail::resolve_use_intra_process(use_intra_process_comm, *node_base)) {
+    serv->enable_intra_process(node_base->get_context());
+  }
   auto serv_base_ptr = std::dynamic_pointer_cast<ServiceBase>(serv);
   node_services->add_service(serv_base_ptr, group);
   return serv;
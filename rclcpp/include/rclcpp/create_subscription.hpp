@@ -32,6 +32,7 @@
 #include "rclcpp/create_publisher.hpp"
 #include "rclcpp/create_timer.hpp"
 #include "rclcpp/qos.hpp"
+#include "rclcpp/startup_profiling.hpp"
 #include "rclcpp/subscription_factory.hpp"
 #include "rclcpp/subscription_options.hpp"
 #include "rclcpp/timer.hpp"
@@ -67,6 +68,7 @@ create_subscription(
   )
 )
 {
+  rclcpp::startup_profiling::ScopedPhase profiled_phase("subscription", topic_name.c_str());
   using rclcpp::node_interfaces::get_node_topics_interface;
   auto node_topics_interface = get_node_topics_interface(node_topics);
 
@@ -83,6 +85,10 @@ create_subscription(
               std::to_string(options.topic_stats_options.publish_period.count()) +
               " ms");
     }
+    if (0u == options.topic_stats_options.message_sampling_interval) {
+      throw std::invalid_argument(
+              "topic_stats_options.message_sampling_interval must be greater than 0");
+    }
 
     std::shared_ptr<Publisher<statistics_msgs::msg::MetricsMessage>>
     publisher = rclcpp::detail::create_publisher<statistics_msgs::msg::MetricsMessage>(
@@ -93,7 +99,9 @@ create_subscription(
 
     subscription_topic_stats = std::make_shared<
       rclcpp::topic_statistics::SubscriptionTopicStatistics<ROSMessageType>
-      >(node_topics_interface->get_node_base_interface()->get_name(), publisher);
+      >(
+      node_topics_interface->get_node_base_interface()->get_name(), publisher,
+      options.topic_stats_options.message_sampling_interval);
 
     std::weak_ptr<
       rclcpp::topic_statistics::SubscriptionTopicStatistics<ROSMessageType>
@@ -0,0 +1,117 @@
+// Copyright 2021 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef RCLCPP__CREATE_SYNCHRONIZED_SUBSCRIPTION_HPP_
+#define RCLCPP__CREATE_SYNCHRONIZED_SUBSCRIPTION_HPP_
+
+#include <array>
+#include <memory>
+#include <string>
+#include <tuple>
+#include <utility>
+
+#include "rclcpp/create_subscription.hpp"
+#include "rclcpp/node_interfaces/get_node_base_interface.hpp"
+#include "rclcpp/node_interfaces/get_node_waitables_interface.hpp"
+#include "rclcpp/qos.hpp"
+#include "rclcpp/subscription_options.hpp"
+#include "rclcpp/synchronized_subscription.hpp"
+
+namespace rclcpp
+{
+
+namespace detail
+{
+
+/// Subscribe to the topic of index I, giving its messages to the synchronized subscription.
+template<size_t I, typename SynchronizedSubscriptionT, typename NodeT>
+rclcpp::SubscriptionBase::SharedPtr
+create_synchronized_topic_subscription(
+  NodeT & node,
+  const std::shared_ptr<SynchronizedSubscriptionT> & synchronized_subscription,
+  const std::string & topic_name,
+  const rclcpp::QoS & qos,
+  const rclcpp::SubscriptionOptions & options)
+{
+  using MessageT = typename SynchronizedSubscriptionT::template MessageType<I>;
+  std::weak_ptr<SynchronizedSubscriptionT> weak_synchronized_subscription =
+    synchronized_subscription;
+  return rclcpp::create_subscription<MessageT>(
+    node, topic_name, qos,
+    [weak_synchronized_subscription](std::shared_ptr<const MessageT> message)
+    {
+      auto synchronized_subscription = weak_synchronized_subscription.lock();
+      if (synchronized_subscription) {
+        synchronized_subscription->template add_message<I>(std::move(message));
+      }
+    },
+    options);
+}
+
+template<typename SynchronizedSubscriptionT, typename NodeT, size_t ... Is>
+std::array<rclcpp::SubscriptionBase::SharedPtr, sizeof...(Is)>
+create_synchronized_topic_subscriptions(
+  NodeT & node,
+  const std::shared_ptr<SynchronizedSubscriptionT> & synchronized_subscription,
+  const std::array<std::string, sizeof...(Is)> & topic_names,
+  const rclcpp::QoS & qos,
+  const rclcpp::SubscriptionOptions & options,
+  std::index_sequence<Is...>)
+{
+  return {create_synchronized_topic_subscription<Is>(
+      node, synchronized_subscription, topic_names[Is], qos, options)...};
+}
+
+}  // namespace detail
+
+/// Create a SynchronizedSubscription, subscribe to its topics and add it to a "Node like" object.
+/**
+ * \param[in] node the node, or an object exposing its interfaces, subscribing to the topics.
+ * \param[in] topic_names the topics, one per message type.
+ * \param[in] qos QoS of the subscriptions of the topics.
+ * \param[in] callback called with each set of messages whose stamps match.
+ * \param[in] options policy, sizes of the queues and options of the subscriptions.
+ * \return the synchronized subscription, which owns the subscriptions of the topics.
+ * \throws std::invalid_argument if the callback or options are invalid.
+ * \throws anything rclcpp::create_subscription() can throw.
+ */
+template<typename ... MessageTs, typename NodeT>
+typename SynchronizedSubscription<MessageTs...>::SharedPtr
+create_synchronized_subscription(
+  NodeT && node,
+  const std::array<std::string, sizeof...(MessageTs)> & topic_names,
+  const rclcpp::QoS & qos,
+  typename SynchronizedSubscription<MessageTs...>::CallbackType callback,
+  const SynchronizedSubscriptionOptions & options = SynchronizedSubscriptionOptions())
+{
+  auto node_base = rclcpp::node_interfaces::get_node_base_interface(node);
+  auto synchronized_subscription = SynchronizedSubscription<MessageTs...>::make_shared(
+    node_base->get_context(), std::move(callback), options);
+
+  rclcpp::SubscriptionOptions subscription_options = options.subscription_options;
+  subscription_options.deliver_intra_process_inline = true;
+  synchronized_subscription->set_subscriptions(
+    detail::create_synchronized_topic_subscriptions(
+      node, synchronized_subscription, topic_names, qos, subscription_options,
+      std::index_sequence_for<MessageTs...>{}));
+
+  rclcpp::node_interfaces::get_node_waitables_interface(node)->add_waitable(
+    synchronized_subscription, subscription_options.callback_group);
+  return synchronized_subscription;
+}
+
+}  // namespace rclcpp
+
+#endif  // RCLCPP__CREATE_SYNCHRONIZED_SUBSCRIPTION_HPP_
@@ -81,9 +81,10 @@ create_timer(
  * \param group
  * \param node_base
  * \param node_timers
+ * \param slack how late the timer may fire so that it is coalesced with other timers
  * \return
  * \throws std::invalid argument if either node_base or node_timers
- * are null, or period is negative or too large
+ * are null, or period or slack is negative or period is too large
  */
 template<typename DurationRepT, typename DurationT, typename CallbackT>
 typename rclcpp::WallTimer<CallbackT>::SharedPtr
@@ -92,7 +93,8 @@ create_wall_timer(
   CallbackT callback,
   rclcpp::CallbackGroup::SharedPtr group,
   node_interfaces::NodeBaseInterface * node_base,
-  node_interfaces::NodeTimersInterface * node_timers)
+  node_interfaces::NodeTimersInterface * node_timers,
+  std::chrono::nanoseconds slack = std::chrono::nanoseconds(0))
 {
   if (node_base == nullptr) {
     throw std::invalid_argument{"input node_base cannot be null"};
@@ -133,7 +135,7 @@ create_wall_timer(
   }
 
   auto timer = rclcpp::WallTimer<CallbackT>::make_shared(
-    period_ns, std::move(callback), node_base->get_context());
+    period_ns, std::move(callback), node_base->get_context(), slack);
   node_timers->add_timer(timer, group);
   return timer;
 }
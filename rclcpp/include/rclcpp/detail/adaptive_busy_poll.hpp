@@ -0,0 +1,110 @@
+// Copyright 2021 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__DETAIL__ADAPTIVE_BUSY_POLL_HPP_
+#define RCLCPP__DETAIL__ADAPTIVE_BUSY_POLL_HPP_
+
+#include <chrono>
+#include <cstdint>
+
+namespace rclcpp
+{
+namespace detail
+{
+
+/// Time to busy poll for work before blocking, adapted to how often work arrives.
+/**
+ * While work arrives within the maximum budget on average, the whole budget
+ * is polled.
+ * As the average time until work arrives grows past it, the budget shrinks in
+ * proportion, down to no polling at all when work arrives on average more
+ * than 16 times later than the maximum budget, so that idle executors stop
+ * burning their core.
+ * The blocking waits keep measuring the arrivals, and polling resumes as soon
+ * as work comes in quickly again.
+ *
+ * Not thread-safe, it is used by the thread waiting for work.
+ */
+class AdaptiveBusyPoll
+{
+public:
+  /// Constructor.
+  /**
+   * \param[in] max_budget maximum time to poll before blocking, 0 or negative to never poll.
+   */
+  explicit AdaptiveBusyPoll(std::chrono::nanoseconds max_budget = std::chrono::nanoseconds(0))
+  : max_budget_(max_budget.count() > 0 ? max_budget.count() : 0)
+  {}
+
+  /// Return true if polling is enabled at all.
+  bool
+  is_enabled() const
+  {
+    return max_budget_ > 0;
+  }
+
+  /// Return the maximum time to poll before blocking.
+  std::chrono::nanoseconds
+  get_max_budget() const
+  {
+    return std::chrono::nanoseconds(max_budget_);
+  }
+
+  /// Return the time to poll before the next blocking wait.
+  std::chrono::nanoseconds
+  get_budget() const
+  {
+    if (max_budget_ <= 0 || average_wait_ <= max_budget_) {
+      return std::chrono::nanoseconds(max_budget_);
+    }
+    if (average_wait_ / 16 > max_budget_) {
+      return std::chrono::nanoseconds(0);
+    }
+    // max_budget_ * max_budget_ / average_wait_, without overflowing.
+    const double budget =
+      static_cast<double>(max_budget_) * static_cast<double>(max_budget_) /
+      static_cast<double>(average_wait_);
+    return std::chrono::nanoseconds(static_cast<int64_t>(budget));
+  }
+
+  /// Record how long a wait took, polling and blocking included.
+  /**
+   * \param[in] wait_duration time from the start of the wait until work was found, or until
+   *   the wait timed out, which is then a lower bound of the time until work arrives.
+   */
+  void
+  record_wait(std::chrono::nanoseconds wait_duration)
+  {
+    const int64_t duration = wait_duration.count() > 0 ? wait_duration.count() : 0;
+    // Exponential moving average, each wait weighing for an eighth.
+    average_wait_ = average_wait_ + (duration - average_wait_) / 8;
+  }
+
+  /// Return the average duration of the recorded waits.
+  std::chrono::nanoseconds
+  get_average_wait() const
+  {
+    return std::chrono::nanoseconds(average_wait_);
+  }
+
+private:
+  int64_t max_budget_;
+  // Starts at 0 so that the whole budget is polled until waits are measured.
+  int64_t average_wait_ = 0;
+};
+
+}  // namespace detail
+}  // namespace rclcpp
+
+#endif  // RCLCPP__DETAIL__ADAPTIVE_BUSY_POLL_HPP_
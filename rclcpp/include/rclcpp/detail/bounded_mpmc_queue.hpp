@@ -0,0 +1,176 @@
+// Copyright 2021 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__DETAIL__BOUNDED_MPMC_QUEUE_HPP_
+#define RCLCPP__DETAIL__BOUNDED_MPMC_QUEUE_HPP_
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+
+#include "rclcpp/macros.hpp"
+
+namespace rclcpp
+{
+namespace detail
+{
+
+/// Lock-free bounded queue for multiple producers and multiple consumers.
+/**
+ * Each slot of the ring buffer carries a sequence number which tells producers whether the slot
+ * is free and consumers whether it holds a value, so pushing and popping only contend on one
+ * atomic position each and never block.
+ * The capacity is rounded up to the next power of two.
+ *
+ * Values are moved in and out of the queue, the slot of a popped value is reset to a default
+ * constructed T so that the resources it holds are released right away.
+ */
+template<typename T>
+class BoundedMPMCQueue
+{
+public:
+  RCLCPP_SMART_PTR_DEFINITIONS_NOT_COPYABLE(BoundedMPMCQueue<T>)
+
+  /// Constructor.
+  /**
+   * \param[in] capacity minimum number of values the queue can hold, must not be 0.
+   * \throws std::invalid_argument if capacity is 0.
+   */
+  explicit BoundedMPMCQueue(size_t capacity)
+  {
+    if (0u == capacity) {
+      throw std::invalid_argument("BoundedMPMCQueue capacity must be positive");
+    }
+    capacity_ = 1u;
+    while (capacity_ < capacity) {
+      capacity_ <<= 1u;
+    }
+    mask_ = capacity_ - 1u;
+    cells_.reset(new Cell[capacity_]);
+    for (size_t i = 0; i < capacity_; ++i) {
+      cells_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+    enqueue_position_.store(0u, std::memory_order_relaxed);
+    dequeue_position_.store(0u, std::memory_order_relaxed);
+  }
+
+  /// Move a value at the back of the queue.
+  /**
+   * \param[in] value the value to push, left untouched if the queue is full.
+   * \return true if the value was pushed, false if the queue was full.
+   */
+  bool
+  try_push(T && value)
+  {
+    Cell * cell = nullptr;
+    size_t position = enqueue_position_.load(std::memory_order_relaxed);
+    while (true) {
+      cell = &cells_[position & mask_];
+      const size_t sequence = cell->sequence.load(std::memory_order_acquire);
+      const auto diff =
+        static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(position);
+      if (0 == diff) {
+        if (enqueue_position_.compare_exchange_weak(
+            position, position + 1u, std::memory_order_relaxed))
+        {
+          break;
+        }
+      } else if (diff < 0) {
+        // The slot still holds a value from the previous lap, the queue is full.
+        return false;
+      } else {
+        position = enqueue_position_.load(std::memory_order_relaxed);
+      }
+    }
+    cell->data = std::move(value);
+    cell->sequence.store(position + 1u, std::memory_order_release);
+    return true;
+  }
+
+  /// Move the value at the front of the queue out.
+  /**
+   * \param[out] value the popped value, untouched if the queue was empty.
+   * \return true if a value was popped, false if the queue was empty.
+   */
+  bool
+  try_pop(T & value)
+  {
+    Cell * cell = nullptr;
+    size_t position = dequeue_position_.load(std::memory_order_relaxed);
+    while (true) {
+      cell = &cells_[position & mask_];
+      const size_t sequence = cell->sequence.load(std::memory_order_acquire);
+      const auto diff =
+        static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(position + 1u);
+      if (0 == diff) {
+        if (dequeue_position_.compare_exchange_weak(
+            position, position + 1u, std::memory_order_relaxed))
+        {
+          break;
+        }
+      } else if (diff < 0) {
+        // Nothing was published in this slot yet, the queue is empty.
+        return false;
+      } else {
+        position = dequeue_position_.load(std::memory_order_relaxed);
+      }
+    }
+    value = std::move(cell->data);
+    cell->data = T();
+    cell->sequence.store(position + mask_ + 1u, std::memory_order_release);
+    return true;
+  }
+
+  /// Return true if the queue looks empty.
+  /**
+   * The result is only a hint when other threads push or pop concurrently.
+   */
+  bool
+  empty() const
+  {
+    return dequeue_position_.load(std::memory_order_acquire) >=
+           enqueue_position_.load(std::memory_order_acquire);
+  }
+
+  /// Return the number of values the queue can hold.
+  size_t
+  capacity() const
+  {
+    return capacity_;
+  }
+
+private:
+  RCLCPP_DISABLE_COPY(BoundedMPMCQueue)
+
+  struct Cell
+  {
+    std::atomic<size_t> sequence;
+    T data;
+  };
+
+  size_t capacity_;
+  size_t mask_;
+  std::unique_ptr<Cell[]> cells_;
+
+  // Producers and consumers each update their own position, keep them on separate cache lines.
+  alignas(64) std::atomic<size_t> enqueue_position_;
+  alignas(64) std::atomic<size_t> dequeue_position_;
+};
+
+}  // namespace detail
+}  // namespace rclcpp
+
+#endif  // RCLCPP__DETAIL__BOUNDED_MPMC_QUEUE_HPP_
@@ -0,0 +1,46 @@
+// Copyright 2021 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__DETAIL__EXTENDED_TRACEPOINTS_HPP_
+#define RCLCPP__DETAIL__EXTENDED_TRACEPOINTS_HPP_
+
+#include "tracetools/tracetools.h"
+
+/// Call a tracepoint of the intra-process buffers or of the executors.
+/**
+ * These tracepoints follow the message from its intra-process publication to
+ * the buffers of the subscriptions, and the executors from their waits to the
+ * executions:
+ *
+ * - rclcpp_construct_ring_buffer(buffer, capacity)
+ * - rclcpp_buffer_to_ipb(buffer, ipb) and rclcpp_ipb_to_subscription(ipb, subscription)
+ * - rclcpp_intra_publish(publisher_handle, message)
+ * - rclcpp_ring_buffer_enqueue(buffer, index, size, overwritten), where overwritten is true if
+ *   the oldest message was dropped, rclcpp_ring_buffer_dequeue(buffer, index, size) and
+ *   rclcpp_ring_buffer_clear(buffer)
+ * - rclcpp_executor_wait_for_work(timeout), before waiting, rclcpp_executor_get_next_ready(),
+ *   when looking for the next executable after the wait, and rclcpp_executor_execute(handle),
+ *   before executing it, in the thread which executes it
+ *
+ * They are only called when rclcpp is built with RCLCPP_ENABLE_EXTENDED_TRACEPOINTS, which
+ * needs a version of tracetools defining them, and otherwise compile to nothing without
+ * evaluating their arguments.
+ */
+#ifdef RCLCPP_ENABLE_EXTENDED_TRACEPOINTS
+#define RCLCPP_EXTENDED_TRACEPOINT(...) TRACEPOINT(__VA_ARGS__)
+#else
+#define RCLCPP_EXTENDED_TRACEPOINT(...) ((void)0)
+#endif
+
+#endif  // RCLCPP__DETAIL__EXTENDED_TRACEPOINTS_HPP_
@@ -0,0 +1,62 @@
+// Copyright 2021 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__DETAIL__FUTURE_WAITERS_HPP_
+#define RCLCPP__DETAIL__FUTURE_WAITERS_HPP_
+
+#include "rclcpp/visibility_control.hpp"
+
+namespace rclcpp
+{
+
+class Executor;
+
+namespace detail
+{
+
+/// \internal Register an executor spinning until a future is complete, for the scope lifetime.
+/**
+ * Used by rclcpp::Executor::spin_until_future_complete().
+ */
+class FutureWaiterScope
+{
+public:
+  RCLCPP_PUBLIC
+  explicit FutureWaiterScope(rclcpp::Executor * executor);
+
+  RCLCPP_PUBLIC
+  ~FutureWaiterScope();
+
+  FutureWaiterScope(const FutureWaiterScope &) = delete;
+  FutureWaiterScope & operator=(const FutureWaiterScope &) = delete;
+
+private:
+  rclcpp::Executor * executor_;
+};
+
+/// \internal Wake the executors spinning until a future is complete, to check their future.
+/**
+ * Called after completing the promises of rclcpp, like the ones of the
+ * requests of the clients, which may be awaited by an executor other than the
+ * one completing them.
+ * When no executor is waiting, this is a single atomic load.
+ */
+RCLCPP_PUBLIC
+void
+wake_future_waiters();
+
+}  // namespace detail
+}  // namespace rclcpp
+
+#endif  // RCLCPP__DETAIL__FUTURE_WAITERS_HPP_
@@ -0,0 +1,88 @@
+// Copyright 2021 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__DETAIL__MIN_PERIOD_LIMITER_HPP_
+#define RCLCPP__DETAIL__MIN_PERIOD_LIMITER_HPP_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <limits>
+
+namespace rclcpp
+{
+namespace detail
+{
+
+/// Let at most one event through per period of the steady clock.
+/**
+ * Concurrent events are told apart with a compare and swap of the time of the
+ * last event let through, without locking.
+ */
+class MinPeriodLimiter
+{
+public:
+  /// Constructor.
+  /**
+   * \param[in] min_period minimum time between two events let through, 0 to let all through.
+   */
+  explicit MinPeriodLimiter(std::chrono::nanoseconds min_period = std::chrono::nanoseconds(0))
+  : min_period_(min_period.count())
+  {}
+
+  /// Set the minimum time between two events, before any event happens.
+  void
+  set_min_period(std::chrono::nanoseconds min_period)
+  {
+    min_period_ = min_period.count();
+  }
+
+  /// Return true if the limiter lets events through at a limited rate.
+  bool
+  is_enabled() const
+  {
+    return min_period_ > 0;
+  }
+
+  /// Return true if the event is let through, the period then starting again.
+  bool
+  try_pass()
+  {
+    if (min_period_ <= 0) {
+      return true;
+    }
+    const int64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now().time_since_epoch()).count();
+    int64_t last_pass_time = last_pass_time_.load(std::memory_order_relaxed);
+    do {
+      if (last_pass_time != never && now - last_pass_time < min_period_) {
+        return false;
+      }
+    } while (!last_pass_time_.compare_exchange_weak(
+      last_pass_time, now, std::memory_order_relaxed));
+    return true;
+  }
+
+private:
+  static constexpr int64_t never = std::numeric_limits<int64_t>::min();
+
+  int64_t min_period_;
+  // Steady time in nanoseconds of the last event let through.
+  std::atomic<int64_t> last_pass_time_{never};
+};
+
+}  // namespace detail
+}  // namespace rclcpp
+
+#endif  // RCLCPP__DETAIL__MIN_PERIOD_LIMITER_HPP_
@@ -0,0 +1,168 @@
+// Copyright 2021 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__DETAIL__PENDING_REQUEST_RING_HPP_
+#define RCLCPP__DETAIL__PENDING_REQUEST_RING_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace rclcpp
+{
+namespace detail
+{
+
+/// Callbacks of the pending requests of a client, indexed by their sequence number.
+/**
+ * The sequence numbers of the requests of a client follow each other, so a
+ * request is stored in the slot of its sequence number modulo the number of
+ * slots, and the slots are only reallocated when more requests are pending
+ * than there are slots.
+ * It is not thread-safe.
+ *
+ * \tparam CallbackT type of the callbacks, default constructible and movable.
+ */
+template<typename CallbackT>
+class PendingRequestRing
+{
+public:
+  /// Constructor.
+  /**
+   * \param[in] initial_capacity number of slots allocated with the first request,
+   *   rounded up to a power of two.
+   */
+  explicit PendingRequestRing(size_t initial_capacity = 16)
+  : initial_capacity_(1)
+  {
+    while (initial_capacity_ < initial_capacity) {
+      initial_capacity_ *= 2;
+    }
+  }
+
+  /// Store the callback of a request.
+  /**
+   * \param[in] sequence_number sequence number of the request, not pending already.
+   * \param[in] callback callback of the request.
+   */
+  void
+  insert(int64_t sequence_number, CallbackT callback)
+  {
+    if (slots_.empty()) {
+      slots_.resize(initial_capacity_);
+    }
+    while (slots_[index_of(sequence_number, slots_.size())].pending) {
+      grow();
+    }
+    Slot & slot = slots_[index_of(sequence_number, slots_.size())];
+    slot.sequence_number = sequence_number;
+    slot.callback = std::move(callback);
+    slot.pending = true;
+    ++size_;
+  }
+
+  /// Take the callback of a request, which is no longer pending.
+  /**
+   * \param[in] sequence_number sequence number of the request.
+   * \param[out] callback_out callback of the request, if it was pending.
+   * \return true if the request was pending.
+   */
+  bool
+  take(int64_t sequence_number, CallbackT & callback_out)
+  {
+    if (slots_.empty()) {
+      return false;
+    }
+    Slot & slot = slots_[index_of(sequence_number, slots_.size())];
+    if (!slot.pending || slot.sequence_number != sequence_number) {
+      return false;
+    }
+    callback_out = std::move(slot.callback);
+    // Release what the callback captured now rather than when the slot is reused.
+    slot.callback = CallbackT();
+    slot.pending = false;
+    --size_;
+    return true;
+  }
+
+  /// Return the number of pending requests.
+  size_t
+  size() const
+  {
+    return size_;
+  }
+
+  /// Return the number of slots.
+  size_t
+  capacity() const
+  {
+    return slots_.size();
+  }
+
+private:
+  struct Slot
+  {
+    int64_t sequence_number = 0;
+    bool pending = false;
+    CallbackT callback;
+  };
+
+  static size_t
+  index_of(int64_t sequence_number, size_t capacity)
+  {
+    // The intra-process requests have negative sequence numbers, which wrap around as well.
+    return static_cast<size_t>(static_cast<uint64_t>(sequence_number) & (capacity - 1));
+  }
+
+  void
+  grow()
+  {
+    // Requests far apart may still collide once the slots are doubled, then they are doubled again.
+    size_t capacity = slots_.size();
+    bool fits = false;
+    while (!fits) {
+      capacity *= 2;
+      std::vector<bool> taken(capacity, false);
+      fits = true;
+      for (const Slot & slot : slots_) {
+        if (!slot.pending) {
+          continue;
+        }
+        const size_t index = index_of(slot.sequence_number, capacity);
+        if (taken[index]) {
+          fits = false;
+          break;
+        }
+        taken[index] = true;
+      }
+    }
+    std::vector<Slot> slots(capacity);
+    for (Slot & slot : slots_) {
+      if (slot.pending) {
+        slots[index_of(slot.sequence_number, capacity)] = std::move(slot);
+      }
+    }
+    slots_ = std::move(slots);
+  }
+
+  size_t initial_capacity_;
+  std::vector<Slot> slots_;
+  size_t size_ = 0;
+};
+
+}  // namespace detail
+}  // namespace rclcpp
+
+#endif  // RCLCPP__DETAIL__PENDING_REQUEST_RING_HPP_
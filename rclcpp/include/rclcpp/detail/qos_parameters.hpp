@@ -104,6 +104,31 @@ declare_parameter_or_get(
   }
 }
 
+/// \internal Return the override of the parameter if any, or else the default value.
+/**
+ * Like declare_parameter_or_get() for a statically typed parameter, without declaring it.
+ * \throws rclcpp::exceptions::InvalidParameterTypeException if the override is of another type.
+ */
+inline
+rclcpp::ParameterValue
+get_parameter_override_or_default(
+  const std::map<std::string, rclcpp::ParameterValue> & parameter_overrides,
+  const std::string & param_name,
+  rclcpp::ParameterValue param_value)
+{
+  auto it = parameter_overrides.find(param_name);
+  if (it == parameter_overrides.end()) {
+    return param_value;
+  }
+  if (it->second.get_type() != param_value.get_type()) {
+    throw rclcpp::exceptions::InvalidParameterTypeException(
+            param_name,
+            "expected " + rclcpp::to_string(param_value.get_type()) +
+            " override, got " + rclcpp::to_string(it->second.get_type()));
+  }
+  return it->second;
+}
+
 /// \internal Declare QoS parameters for the given entity.
 /**
  * \tparam NodeT Node pointer or reference type.
@@ -111,6 +136,7 @@ declare_parameter_or_get(
  *  `allowed_policies()`. See `PublisherQosParametersTraits` and `SubscriptionQosParametersTraits`.
  * \param options User provided options that indicate if QoS parameter overrides should be
  *  declared or not, which policy can have overrides, and optionally a callback to validate the profile.
+ *  If the options do not declare the parameters, the profile is only based on the overrides.
  * \param node Parameters will be declared using this node.
  * \param topic_name Name of the topic of the entity.
  * \param default_qos User provided qos. It will be used as a default for the parameters declared.
@@ -158,6 +184,13 @@ declare_qos_parameters(
     {
       std::ostringstream param_name{param_prefix, std::ios::ate};
       param_name << qos_policy_kind_to_cstr(policy);
+      if (!options.get_declare_parameters()) {
+        auto value = get_parameter_override_or_default(
+          parameters_interface.get_parameter_overrides(), param_name.str(),
+          get_default_qos_param_value(policy, qos));
+        ::rclcpp::detail::apply_qos_override(policy, value, qos);
+        continue;
+      }
       std::ostringstream param_desciption{"qos policy {", std::ios::ate};
       param_desciption << qos_policy_kind_to_cstr(policy) << param_description_suffix;
       rcl_interfaces::msg::ParameterDescriptor descriptor{};
@@ -0,0 +1,181 @@
+// Copyright 2021 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__DETAIL__READ_COPY_UPDATE_POINTER_HPP_
+#define RCLCPP__DETAIL__READ_COPY_UPDATE_POINTER_HPP_
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <thread>
+#include <utility>
+
+#include "rclcpp/macros.hpp"
+
+namespace rclcpp
+{
+namespace detail
+{
+
+/// Pointer to an immutable snapshot which readers access without locking.
+/**
+ * Readers pin the current snapshot with a ReadGuard, which only increments a
+ * counter shared with the few other threads mapped to the same cache line, so
+ * that concurrent readers do not contend with each other.
+ * Writers replace the snapshot with a new one and wait until no reader can
+ * still access the previous snapshot before deleting it.
+ *
+ * Readers are counted by the parity of an epoch number, which a writer
+ * increments before waiting for the readers of the previous parity, so that
+ * new readers never keep it waiting.
+ */
+template<typename T>
+class ReadCopyUpdatePointer
+{
+  struct alignas(64) ReaderCounters
+  {
+    std::atomic<size_t> count[2];
+  };
+
+public:
+  RCLCPP_SMART_PTR_DEFINITIONS_NOT_COPYABLE(ReadCopyUpdatePointer<T>)
+
+  /// Keeps the snapshot read through it alive until it is destroyed.
+  /**
+   * A guard must be destroyed by the thread which created it, before the
+   * ReadCopyUpdatePointer is destroyed.
+   */
+  class ReadGuard
+  {
+  public:
+    explicit ReadGuard(const ReadCopyUpdatePointer & pointer)
+    : counters_(&pointer.counters_[get_counters_index()])
+    {
+      parity_ = pointer.epoch_.load(std::memory_order_seq_cst) & 1u;
+      counters_->count[parity_].fetch_add(1u, std::memory_order_seq_cst);
+      // Loaded after being counted, a writer either waits for this guard or already replaced it.
+      snapshot_ = pointer.snapshot_.load(std::memory_order_seq_cst);
+    }
+
+    ~ReadGuard()
+    {
+      counters_->count[parity_].fetch_sub(1u, std::memory_order_release);
+    }
+
+    const T *
+    get() const
+    {
+      return snapshot_;
+    }
+
+    const T &
+    operator*() const
+    {
+      return *snapshot_;
+    }
+
+    const T *
+    operator->() const
+    {
+      return snapshot_;
+    }
+
+  private:
+    RCLCPP_DISABLE_COPY(ReadGuard)
+
+    ReaderCounters * counters_;
+    size_t parity_;
+    const T * snapshot_;
+  };
+
+  /// Constructor.
+  /**
+   * \param[in] snapshot the initial snapshot, must not be null.
+   */
+  explicit ReadCopyUpdatePointer(std::unique_ptr<const T> snapshot)
+  : snapshot_(snapshot.release())
+  {
+    for (auto & counters : counters_) {
+      counters.count[0].store(0u, std::memory_order_relaxed);
+      counters.count[1].store(0u, std::memory_order_relaxed);
+    }
+  }
+
+  ~ReadCopyUpdatePointer()
+  {
+    delete snapshot_.load(std::memory_order_relaxed);
+  }
+
+  /// Pin the current snapshot, see ReadGuard.
+  /**
+   * This member function is thread-safe and lock-free.
+   */
+  ReadGuard
+  read() const
+  {
+    return ReadGuard(*this);
+  }
+
+  /// Replace the snapshot and delete the previous one once no reader can access it.
+  /**
+   * This member function must not be called concurrently with itself, nor by a
+   * thread holding a ReadGuard of this pointer.
+   *
+   * \param[in] snapshot the new snapshot, must not be null.
+   */
+  void
+  update(std::unique_ptr<const T> snapshot)
+  {
+    const T * previous_snapshot =
+      snapshot_.exchange(snapshot.release(), std::memory_order_seq_cst);
+    // A reader may have loaded the epoch before the previous update, wait for both parities.
+    wait_for_readers();
+    wait_for_readers();
+    delete previous_snapshot;
+  }
+
+private:
+  /// Wait for the readers counted in the current parity, new readers use the other one.
+  void
+  wait_for_readers()
+  {
+    const size_t parity = epoch_.fetch_add(1u, std::memory_order_seq_cst) & 1u;
+    for (auto & counters : counters_) {
+      while (counters.count[parity].load(std::memory_order_seq_cst) != 0u) {
+        std::this_thread::yield();
+      }
+    }
+  }
+
+  /// Return the index of the counters used by the calling thread.
+  static size_t
+  get_counters_index()
+  {
+    static std::atomic<size_t> next_index{0u};
+    static thread_local const size_t index =
+      next_index.fetch_add(1u, std::memory_order_relaxed) % number_of_counters;
+    return index;
+  }
+
+  static constexpr size_t number_of_counters = 16u;
+
+  mutable ReaderCounters counters_[number_of_counters];
+  alignas(64) std::atomic<size_t> epoch_{0u};
+  std::atomic<const T *> snapshot_;
+};
+
+}  // namespace detail
+}  // namespace rclcpp
+
+#endif  // RCLCPP__DETAIL__READ_COPY_UPDATE_POINTER_HPP_
@@ -0,0 +1,150 @@
+// Copyright 2021 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__DETAIL__READY_BITMAP_HPP_
+#define RCLCPP__DETAIL__READY_BITMAP_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace rclcpp
+{
+namespace detail
+{
+
+/// Bitmap of the ready slots of one of the arrays of a rcl_wait_set_t.
+/**
+ * rcl_wait() leaves the ready entities in their slot and sets the others to
+ * nullptr.
+ * The slots are folded into 64 bit words in one tight pass, after which the
+ * ready indices are visited with word-level bit operations, skipping the
+ * words without ready slots, instead of testing every slot of the entities
+ * which were not ready.
+ */
+class ReadyBitmap
+{
+public:
+  /// Rebuild the bitmap from the slots of a wait set array, bit i is set if slot i is not null.
+  /**
+   * The memory of the words is kept between calls.
+   *
+   * \param[in] slots the array of the wait set, like rcl_wait_set_t::subscriptions.
+   * \param[in] size the number of slots, like rcl_wait_set_t::size_of_subscriptions.
+   */
+  template<typename T>
+  void
+  assign(T * const * slots, size_t size)
+  {
+    size_ = size;
+    words_.resize((size + 63u) / 64u);
+    for (size_t word = 0; word < words_.size(); ++word) {
+      const size_t begin = word * 64u;
+      const size_t end = begin + 64u < size ? begin + 64u : size;
+      uint64_t bits = 0u;
+      for (size_t i = begin; i < end; ++i) {
+        bits |= static_cast<uint64_t>(slots[i] != nullptr) << (i - begin);
+      }
+      words_[word] = bits;
+    }
+  }
+
+  /// Return the number of slots of the bitmap.
+  size_t
+  size() const
+  {
+    return size_;
+  }
+
+  /// Return true if any slot at index begin or after is ready.
+  bool
+  any(size_t begin = 0u) const
+  {
+    if (begin >= size_) {
+      return false;
+    }
+    size_t word = begin / 64u;
+    if (words_[word] >> (begin % 64u)) {
+      return true;
+    }
+    for (++word; word < words_.size(); ++word) {
+      if (words_[word]) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  /// Call a function with each ready index before end, in increasing order.
+  /**
+   * \param[in] end the index to stop at, like the number of entities of the executable list.
+   * \param[in] function called with the index, returns false to stop visiting.
+   * \return false if the function stopped the visit.
+   */
+  template<typename FunctionT>
+  bool
+  for_each(size_t end, FunctionT && function) const
+  {
+    if (end > size_) {
+      end = size_;
+    }
+    for (size_t word = 0; word * 64u < end; ++word) {
+      uint64_t bits = words_[word];
+      while (bits) {
+        const size_t i = word * 64u + count_trailing_zeros(bits);
+        if (i >= end) {
+          return true;
+        }
+        if (!function(i)) {
+          return false;
+        }
+        // Clear the lowest set bit.
+        bits &= bits - 1u;
+      }
+    }
+    return true;
+  }
+
+private:
+  static size_t
+  count_trailing_zeros(uint64_t bits)
+  {
+#if defined(__GNUC__) || defined(__clang__)
+    return static_cast<size_t>(__builtin_ctzll(bits));
+#elif defined(_MSC_VER) && defined(_WIN64)
+    unsigned long index;
+    _BitScanForward64(&index, bits);
+    return static_cast<size_t>(index);
+#else
+    size_t count = 0u;
+    while (!(bits & 1u)) {
+      bits >>= 1u;
+      ++count;
+    }
+    return count;
+#endif
+  }
+
+  std::vector<uint64_t> words_;
+  size_t size_ = 0u;
+};
+
+}  // namespace detail
+}  // namespace rclcpp
+
+#endif  // RCLCPP__DETAIL__READY_BITMAP_HPP_
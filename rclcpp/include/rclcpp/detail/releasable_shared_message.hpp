@@ -0,0 +1,101 @@
+// Copyright 2021 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__DETAIL__RELEASABLE_SHARED_MESSAGE_HPP_
+#define RCLCPP__DETAIL__RELEASABLE_SHARED_MESSAGE_HPP_
+
+#include <atomic>
+#include <memory>
+#include <utility>
+
+namespace rclcpp
+{
+namespace detail
+{
+
+/// Deleter of a shared message which can give the message up instead of deleting it.
+/**
+ * It keeps the deleter of the unique pointer the message was shared from, so
+ * that the message can be given back to a unique pointer of the same type.
+ */
+template<typename MessageT, typename Deleter>
+class ReleasableMessageDeleter
+{
+public:
+  explicit ReleasableMessageDeleter(Deleter deleter)
+  : deleter_(std::move(deleter))
+  {}
+
+  void
+  operator()(MessageT * message)
+  {
+    if (!released_) {
+      deleter_(message);
+    }
+  }
+
+  /// Keep the message alive when the last shared pointer goes away, and return its deleter.
+  Deleter
+  release()
+  {
+    released_ = true;
+    return deleter_;
+  }
+
+private:
+  Deleter deleter_;
+  bool released_ = false;
+};
+
+/// Share a unique message so that it can be taken back by try_release_shared_message().
+template<typename MessageT, typename Deleter>
+std::shared_ptr<MessageT>
+make_releasable_shared_message(std::unique_ptr<MessageT, Deleter> message)
+{
+  ReleasableMessageDeleter<MessageT, Deleter> deleter(message.get_deleter());
+  return std::shared_ptr<MessageT>(message.release(), std::move(deleter));
+}
+
+/// Take the ownership of a shared message back without copying it, if it is no longer shared.
+/**
+ * This is only possible if the message was shared by
+ * make_releasable_shared_message() with the same deleter type, and if the
+ * given shared pointer is the last one to the message.
+ * The message must not be observed through weak pointers, which could share
+ * it again concurrently.
+ *
+ * \param[inout] message the shared message, reset if its ownership was taken.
+ * \return the message, or null if it is still shared or cannot be released.
+ */
+template<typename MessageT, typename Deleter>
+std::unique_ptr<MessageT, Deleter>
+try_release_shared_message(std::shared_ptr<const MessageT> & message)
+{
+  using DeleterT = ReleasableMessageDeleter<MessageT, Deleter>;
+  auto releasable_deleter = std::get_deleter<DeleterT, const MessageT>(message);
+  if (!releasable_deleter || message.use_count() != 1) {
+    return nullptr;
+  }
+  // Synchronize with the release of the message by the other threads which shared it.
+  std::atomic_thread_fence(std::memory_order_acquire);
+  std::unique_ptr<MessageT, Deleter> unique_message(
+    const_cast<MessageT *>(message.get()), releasable_deleter->release());
+  message.reset();
+  return unique_message;
+}
+
+}  // namespace detail
+}  // namespace rclcpp
+
+#endif  // RCLCPP__DETAIL__RELEASABLE_SHARED_MESSAGE_HPP_
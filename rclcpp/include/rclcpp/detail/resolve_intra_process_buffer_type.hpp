@@ -26,27 +26,54 @@ namespace rclcpp
 namespace detail
 {
 
-/// Return the buffer type, resolving the "CallbackDefault" type to an actual type if needed.
-template<typename CallbackMessageT, typename AllocatorT>
+/// Return the buffer type, resolving the "CallbackDefault" types to an actual type if needed.
+/**
+ * \param[in] buffer_type the buffer type of the subscription options.
+ * \param[in] use_take_shared_method whether the callback can share the messages.
+ */
+inline
 rclcpp::IntraProcessBufferType
 resolve_intra_process_buffer_type(
   const rclcpp::IntraProcessBufferType buffer_type,
-  const rclcpp::AnySubscriptionCallback<CallbackMessageT, AllocatorT> & any_subscription_callback)
+  bool use_take_shared_method)
 {
   rclcpp::IntraProcessBufferType resolved_buffer_type = buffer_type;
 
   // If the user has not specified a type for the intra-process buffer, use the callback's type.
   if (resolved_buffer_type == IntraProcessBufferType::CallbackDefault) {
-    if (any_subscription_callback.use_take_shared_method()) {
+    if (use_take_shared_method) {
       resolved_buffer_type = IntraProcessBufferType::SharedPtr;
     } else {
       resolved_buffer_type = IntraProcessBufferType::UniquePtr;
     }
+  } else if (resolved_buffer_type == IntraProcessBufferType::LockFreeCallbackDefault) {
+    if (use_take_shared_method) {
+      resolved_buffer_type = IntraProcessBufferType::LockFreeSharedPtr;
+    } else {
+      resolved_buffer_type = IntraProcessBufferType::LockFreeUniquePtr;
+    }
+  } else if (resolved_buffer_type == IntraProcessBufferType::LockFreeMultiProducerCallbackDefault) {
+    if (use_take_shared_method) {
+      resolved_buffer_type = IntraProcessBufferType::LockFreeMultiProducerSharedPtr;
+    } else {
+      resolved_buffer_type = IntraProcessBufferType::LockFreeMultiProducerUniquePtr;
+    }
   }
 
   return resolved_buffer_type;
 }
 
+/// Return the buffer type, resolving the "CallbackDefault" types to the callback's type.
+template<typename CallbackMessageT, typename AllocatorT>
+rclcpp::IntraProcessBufferType
+resolve_intra_process_buffer_type(
+  const rclcpp::IntraProcessBufferType buffer_type,
+  const rclcpp::AnySubscriptionCallback<CallbackMessageT, AllocatorT> & any_subscription_callback)
+{
+  return resolve_intra_process_buffer_type(
+    buffer_type, any_subscription_callback.use_take_shared_method());
+}
+
 }  // namespace detail
 
 }  // namespace rclcpp
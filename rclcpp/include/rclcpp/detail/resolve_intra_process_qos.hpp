@@ -0,0 +1,76 @@
+// Copyright 2021 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__DETAIL__RESOLVE_INTRA_PROCESS_QOS_HPP_
+#define RCLCPP__DETAIL__RESOLVE_INTRA_PROCESS_QOS_HPP_
+
+#include <stdexcept>
+
+#include "rclcpp/intra_process_keep_all_options.hpp"
+#include "rclcpp/qos.hpp"
+#include "rclcpp/subscription_options.hpp"
+
+namespace rclcpp
+{
+
+namespace detail
+{
+
+/// Return the QoS of the intraprocess buffer of a subscription, checking that it is supported.
+/**
+ * The depth of a keep all history is set to the maximum size of its buffer,
+ * as the structures following the messages of the buffer are sized from it.
+ *
+ * \throws std::invalid_argument if intraprocess communication does not support the QoS
+ *   with these options.
+ */
+inline rclcpp::QoS
+resolve_intra_process_qos(rclcpp::QoS qos, const rclcpp::SubscriptionOptionsBase & options)
+{
+  if (qos.history() == rclcpp::HistoryPolicy::KeepAll) {
+    const rclcpp::IntraProcessKeepAllOptions & keep_all = options.intra_process_keep_all;
+    if (keep_all.max_messages == 0) {
+      throw std::invalid_argument(
+              "intraprocess communication with keep all history qos policy requires a "
+              "positive intra_process_keep_all.max_messages");
+    }
+    if (
+      keep_all.backpressure == rclcpp::IntraProcessBackpressurePolicy::Block &&
+      options.intra_process_message_info)
+    {
+      throw std::invalid_argument(
+              "intraprocess message info is not supported with the Block backpressure policy");
+    }
+    qos.get_rmw_qos_profile().depth = keep_all.max_messages;
+  } else if (qos.history() != rclcpp::HistoryPolicy::KeepLast) {
+    throw std::invalid_argument(
+            "intraprocess communication allowed only with keep last or keep all history "
+            "qos policy");
+  }
+  if (qos.depth() == 0) {
+    throw std::invalid_argument(
+            "intraprocess communication is not allowed with 0 depth qos policy");
+  }
+  if (qos.durability() != rclcpp::DurabilityPolicy::Volatile) {
+    throw std::invalid_argument(
+            "intraprocess communication allowed only with volatile durability");
+  }
+  return qos;
+}
+
+}  // namespace detail
+
+}  // namespace rclcpp
+
+#endif  // RCLCPP__DETAIL__RESOLVE_INTRA_PROCESS_QOS_HPP_
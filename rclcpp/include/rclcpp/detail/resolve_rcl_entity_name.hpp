@@ -0,0 +1,56 @@
+// Copyright 2021 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__DETAIL__RESOLVE_RCL_ENTITY_NAME_HPP_
+#define RCLCPP__DETAIL__RESOLVE_RCL_ENTITY_NAME_HPP_
+
+#include <cstring>
+#include <string>
+
+#include "rcl/node.h"
+
+namespace rclcpp
+{
+
+namespace detail
+{
+
+/// Return the topic or service name to give to rcl when creating an entity of the node.
+/**
+ * rcl expands the relative and private names with the name of its node, which
+ * is not the name of the node when it shares its rcl node handle, see
+ * rclcpp::NodeOptions::shared_rcl_node_handle().
+ * The name is then expanded with the name of the node beforehand, and
+ * otherwise returned as is.
+ */
+template<typename NodeBaseT>
+std::string
+resolve_rcl_entity_name(
+  const NodeBaseT & node_base, const std::string & name, bool is_service)
+{
+  const char * rcl_node_name =
+    rcl_node_get_fully_qualified_name(node_base.get_rcl_node_handle());
+  if (nullptr == rcl_node_name ||
+    0 == std::strcmp(rcl_node_name, node_base.get_fully_qualified_name()))
+  {
+    return name;
+  }
+  return node_base.resolve_topic_or_service_name(name, is_service, true);
+}
+
+}  // namespace detail
+
+}  // namespace rclcpp
+
+#endif  // RCLCPP__DETAIL__RESOLVE_RCL_ENTITY_NAME_HPP_
@@ -26,12 +26,12 @@ namespace detail
 {
 
 /// Return whether or not intra process is enabled, resolving "NodeDefault" if needed.
-template<typename OptionsT, typename NodeBaseT>
+template<typename NodeBaseT>
 bool
-resolve_use_intra_process(const OptionsT & options, const NodeBaseT & node_base)
+resolve_use_intra_process(IntraProcessSetting use_intra_process_comm, const NodeBaseT & node_base)
 {
   bool use_intra_process;
-  switch (options.use_intra_process_comm) {
+  switch (use_intra_process_comm) {
     case IntraProcessSetting::Enable:
       use_intra_process = true;
       break;
@@ -49,6 +49,14 @@ resolve_use_intra_process(const OptionsT & options, const NodeBaseT & node_base)
   return use_intra_process;
 }
 
+/// Return whether or not intra process is enabled in the options, resolving "NodeDefault".
+template<typename OptionsT, typename NodeBaseT>
+bool
+resolve_use_intra_process(const OptionsT & options, const NodeBaseT & node_base)
+{
+  return resolve_use_intra_process(options.use_intra_process_comm, node_base);
+}
+
 }  // namespace detail
 
 }  // namespace rclcpp
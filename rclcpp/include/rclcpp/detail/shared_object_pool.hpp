@@ -0,0 +1,111 @@
+// Copyright 2021 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__DETAIL__SHARED_OBJECT_POOL_HPP_
+#define RCLCPP__DETAIL__SHARED_OBJECT_POOL_HPP_
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+namespace rclcpp
+{
+namespace detail
+{
+
+/// Thread-safe pool of objects shared with their users and reused once they drop them.
+/**
+ * The objects are allocated when the pool is created.
+ * An object of the pool is borrowed again once the last reference of its
+ * users to it is dropped, which takes neither an allocation nor a lock, as
+ * with rclcpp::strategies::shared_message_pool_memory_strategy::SharedMessagePoolMemoryStrategy.
+ * When all the objects are referenced, a new one is allocated.
+ *
+ * A reused object keeps the value it was given by its previous user.
+ *
+ * \tparam T type of the objects, default constructible.
+ */
+template<typename T>
+class SharedObjectPool
+{
+public:
+  /// Allocate the objects of the pool.
+  /**
+   * \param[in] pool_size number of objects of the pool.
+   * \throws std::invalid_argument if the pool is empty.
+   */
+  explicit SharedObjectPool(size_t pool_size)
+  : pool_(pool_size),
+    claimed_(pool_size),
+    next_index_(0)
+  {
+    if (0 == pool_size) {
+      throw std::invalid_argument("the object pool must not be empty");
+    }
+    for (size_t i = 0; i < pool_size; ++i) {
+      pool_[i] = std::make_shared<T>();
+      claimed_[i].store(false, std::memory_order_relaxed);
+    }
+  }
+
+  /// Borrow an object of the pool no longer referenced, or allocate one if there is none.
+  /** \return Shared pointer to the borrowed object. */
+  std::shared_ptr<T>
+  borrow()
+  {
+    const size_t pool_size = pool_.size();
+    // Start after the object borrowed last, which is the most likely to still be referenced.
+    const size_t first = next_index_.fetch_add(1, std::memory_order_relaxed);
+    for (size_t i = 0; i < pool_size; ++i) {
+      const size_t index = (first + i) % pool_size;
+      if (
+        pool_[index].use_count() != 1 ||
+        claimed_[index].exchange(true, std::memory_order_acquire))
+      {
+        continue;
+      }
+      // Only a claimed object gets new references, so it cannot be borrowed twice.
+      std::shared_ptr<T> object;
+      if (pool_[index].use_count() == 1) {
+        // Synchronize with the release of the last other reference, whose writes are then visible.
+        std::atomic_thread_fence(std::memory_order_acquire);
+        object = pool_[index];
+      }
+      claimed_[index].store(false, std::memory_order_release);
+      if (object) {
+        return object;
+      }
+    }
+    return std::make_shared<T>();
+  }
+
+  /// Return the number of objects of the pool.
+  size_t
+  size() const
+  {
+    return pool_.size();
+  }
+
+private:
+  std::vector<std::shared_ptr<T>> pool_;
+  std::vector<std::atomic<bool>> claimed_;
+  std::atomic<size_t> next_index_;
+};
+
+}  // namespace detail
+}  // namespace rclcpp
+
+#endif  // RCLCPP__DETAIL__SHARED_OBJECT_POOL_HPP_
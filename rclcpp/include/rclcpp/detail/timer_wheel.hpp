@@ -0,0 +1,362 @@
+// Copyright 2021 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__DETAIL__TIMER_WHEEL_HPP_
+#define RCLCPP__DETAIL__TIMER_WHEEL_HPP_
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "rclcpp/macros.hpp"
+
+namespace rclcpp
+{
+namespace detail
+{
+
+/// Hierarchical timer wheel holding values until a deadline.
+/**
+ * Time is divided in ticks of a fixed resolution and deadlines are rounded up
+ * to the next tick.
+ * The wheel has one level of 64 slots for each 6 bits of the tick count: a
+ * value is stored at the level of the highest 6 bits in which its expiry tick
+ * differs from the current tick, so each slot of a level covers 64 slots of
+ * the level below.
+ * When time advances, the slots which were crossed are emptied, their values
+ * are moved to the expired list if they are due, or to a lower level otherwise.
+ *
+ * Inserting, rescheduling and erasing a value is O(1), and advancing the wheel
+ * visits at most 64 slots per level, however long it has been since the last
+ * advance.
+ * Values are kept in a pool of nodes, so once the pool is large enough the
+ * wheel does not allocate memory.
+ */
+template<typename T>
+class TimerWheel
+{
+public:
+  RCLCPP_SMART_PTR_DEFINITIONS_NOT_COPYABLE(TimerWheel<T>)
+
+  using Clock = std::chrono::steady_clock;
+  /// Identifies a value of the wheel until it is erased.
+  using Handle = size_t;
+
+  static constexpr Handle invalid_handle = std::numeric_limits<Handle>::max();
+
+  /// Constructor.
+  /**
+   * \param[in] resolution duration of a tick, must be positive.
+   * \param[in] start time of the first tick.
+   * \throws std::invalid_argument if resolution is not positive.
+   */
+  explicit TimerWheel(std::chrono::nanoseconds resolution, Clock::time_point start = Clock::now())
+  : resolution_(resolution), origin_(start)
+  {
+    if (resolution_ <= std::chrono::nanoseconds(0)) {
+      throw std::invalid_argument("TimerWheel resolution must be positive");
+    }
+    heads_.fill(invalid_handle);
+  }
+
+  /// Insert a value which expires at the given deadline.
+  /**
+   * \return the handle of the value.
+   */
+  Handle
+  insert(T value, Clock::time_point deadline)
+  {
+    Handle handle = free_head_;
+    if (invalid_handle != handle) {
+      free_head_ = nodes_[handle].next;
+    } else {
+      handle = nodes_.size();
+      nodes_.emplace_back();
+    }
+    nodes_[handle].value = std::move(value);
+    nodes_[handle].location = detached_location;
+    link(handle, to_tick(deadline));
+    ++size_;
+    return handle;
+  }
+
+  /// Move a value to a new deadline, including a value popped with pop_expired().
+  void
+  reschedule(Handle handle, Clock::time_point deadline)
+  {
+    unlink(handle);
+    link(handle, to_tick(deadline));
+  }
+
+  /// Remove a value from the wheel, its handle must not be used anymore.
+  void
+  erase(Handle handle)
+  {
+    unlink(handle);
+    nodes_[handle].value = T();
+    nodes_[handle].location = free_location;
+    nodes_[handle].next = free_head_;
+    free_head_ = handle;
+    --size_;
+  }
+
+  /// Remove all the values from the wheel.
+  void
+  clear()
+  {
+    nodes_.clear();
+    heads_.fill(invalid_handle);
+    free_head_ = invalid_handle;
+    size_ = 0;
+  }
+
+  /// Return the value of a handle.
+  T &
+  get(Handle handle)
+  {
+    return nodes_[handle].value;
+  }
+
+  /// Return the value of a handle.
+  const T &
+  get(Handle handle) const
+  {
+    return nodes_[handle].value;
+  }
+
+  /// Advance the wheel to the given time and move the values which are due to the expired list.
+  void
+  advance(Clock::time_point now)
+  {
+    const uint64_t target = to_elapsed_ticks(now);
+    if (target <= current_tick_) {
+      return;
+    }
+    const uint64_t previous = current_tick_;
+    // Values are linked relatively to the new tick while the crossed slots are emptied.
+    current_tick_ = target;
+    for (size_t level = 0; level < levels; ++level) {
+      const size_t shift = bits_per_level * level;
+      const size_t previous_index = (previous >> shift) & slot_mask;
+      const size_t target_index = (target >> shift) & slot_mask;
+      if (level + 1 < levels &&
+        (previous >> (shift + bits_per_level)) != (target >> (shift + bits_per_level)))
+      {
+        // A slot of an upper level was crossed, every slot of this level was crossed too.
+        for (size_t index = 0; index < slots_per_level; ++index) {
+          empty_slot(level * slots_per_level + index);
+        }
+        continue;
+      }
+      for (size_t index = previous_index + 1; index <= target_index; ++index) {
+        empty_slot(level * slots_per_level + index);
+      }
+      // The upper levels did not move.
+      break;
+    }
+  }
+
+  /// Remove a value from the expired list.
+  /**
+   * The value stays in the wheel, it has to be rescheduled or erased.
+   * \return the handle of the value, or invalid_handle if no value expired.
+   */
+  Handle
+  pop_expired()
+  {
+    const Handle handle = heads_[expired_location];
+    if (invalid_handle != handle) {
+      unlink(handle);
+    }
+    return handle;
+  }
+
+  /// Return the earliest time at which the wheel needs to be advanced.
+  /**
+   * The time is exact for values expiring within 64 ticks, a lower bound otherwise.
+   * \return the time, Clock::time_point::max() if no value waits for a deadline.
+   */
+  Clock::time_point
+  next_expiry() const
+  {
+    if (invalid_handle != heads_[expired_location]) {
+      return tick_to_time(current_tick_);
+    }
+    for (size_t level = 0; level < levels; ++level) {
+      const size_t shift = bits_per_level * level;
+      const size_t current_index = (current_tick_ >> shift) & slot_mask;
+      for (size_t index = current_index + 1; index < slots_per_level; ++index) {
+        if (invalid_handle != heads_[level * slots_per_level + index]) {
+          uint64_t upper_ticks = 0;
+          if (level + 1 < levels) {
+            const size_t upper_shift = shift + bits_per_level;
+            upper_ticks = (current_tick_ >> upper_shift) << upper_shift;
+          }
+          return tick_to_time(upper_ticks | (static_cast<uint64_t>(index) << shift));
+        }
+      }
+    }
+    return Clock::time_point::max();
+  }
+
+  /// Return the number of values in the wheel.
+  size_t
+  size() const
+  {
+    return size_;
+  }
+
+  /// Return true if there are no values in the wheel.
+  bool
+  empty() const
+  {
+    return 0u == size_;
+  }
+
+  /// Return the duration of a tick.
+  std::chrono::nanoseconds
+  resolution() const
+  {
+    return resolution_;
+  }
+
+private:
+  RCLCPP_DISABLE_COPY(TimerWheel)
+
+  static constexpr size_t bits_per_level = 6;
+  static constexpr size_t slots_per_level = 1u << bits_per_level;
+  static constexpr uint64_t slot_mask = slots_per_level - 1u;
+  static constexpr size_t levels = (64 + bits_per_level - 1) / bits_per_level;
+  static constexpr size_t expired_location = levels * slots_per_level;
+  static constexpr size_t detached_location = expired_location + 1u;
+  static constexpr size_t free_location = expired_location + 2u;
+
+  struct Node
+  {
+    T value;
+    uint64_t expiry = 0;
+    Handle previous = invalid_handle;
+    Handle next = invalid_handle;
+    size_t location = free_location;
+  };
+
+  /// Return the number of ticks elapsed at the given time.
+  uint64_t
+  to_elapsed_ticks(Clock::time_point time) const
+  {
+    if (time <= origin_) {
+      return 0;
+    }
+    const auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(time - origin_);
+    return static_cast<uint64_t>(elapsed.count()) / static_cast<uint64_t>(resolution_.count());
+  }
+
+  /// Return the first tick at or after the given deadline.
+  uint64_t
+  to_tick(Clock::time_point deadline) const
+  {
+    if (deadline <= origin_) {
+      return 0;
+    }
+    const auto elapsed = static_cast<uint64_t>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(deadline - origin_).count());
+    const auto resolution = static_cast<uint64_t>(resolution_.count());
+    return elapsed / resolution + (elapsed % resolution != 0u ? 1u : 0u);
+  }
+
+  Clock::time_point
+  tick_to_time(uint64_t tick) const
+  {
+    return origin_ + std::chrono::nanoseconds(static_cast<int64_t>(tick) * resolution_.count());
+  }
+
+  /// Link a detached node in the list its expiry belongs to.
+  void
+  link(Handle handle, uint64_t expiry)
+  {
+    Node & node = nodes_[handle];
+    node.expiry = expiry;
+    size_t location = expired_location;
+    if (expiry > current_tick_) {
+      // Find the highest group of bits in which the expiry differs from the current tick.
+      const uint64_t difference = expiry ^ current_tick_;
+      size_t level = 0;
+      while (level + 1 < levels && (difference >> (bits_per_level * (level + 1))) != 0u) {
+        ++level;
+      }
+      location = level * slots_per_level + ((expiry >> (bits_per_level * level)) & slot_mask);
+    }
+    node.location = location;
+    node.previous = invalid_handle;
+    node.next = heads_[location];
+    if (invalid_handle != node.next) {
+      nodes_[node.next].previous = handle;
+    }
+    heads_[location] = handle;
+  }
+
+  /// Detach a node from the list it is linked in, if any.
+  void
+  unlink(Handle handle)
+  {
+    Node & node = nodes_[handle];
+    if (node.location >= detached_location) {
+      return;
+    }
+    if (invalid_handle != node.previous) {
+      nodes_[node.previous].next = node.next;
+    } else {
+      heads_[node.location] = node.next;
+    }
+    if (invalid_handle != node.next) {
+      nodes_[node.next].previous = node.previous;
+    }
+    node.previous = invalid_handle;
+    node.next = invalid_handle;
+    node.location = detached_location;
+  }
+
+  /// Link the nodes of a crossed slot again, relatively to the current tick.
+  void
+  empty_slot(size_t location)
+  {
+    Handle handle = heads_[location];
+    heads_[location] = invalid_handle;
+    while (invalid_handle != handle) {
+      const Handle next = nodes_[handle].next;
+      nodes_[handle].location = detached_location;
+      link(handle, nodes_[handle].expiry);
+      handle = next;
+    }
+  }
+
+  std::chrono::nanoseconds resolution_;
+  Clock::time_point origin_;
+  uint64_t current_tick_ = 0;
+
+  std::vector<Node> nodes_;
+  /// Heads of the list of every slot, followed by the head of the expired list.
+  std::array<Handle, expired_location + 1u> heads_;
+  Handle free_head_ = invalid_handle;
+  size_t size_ = 0;
+};
+
+}  // namespace detail
+}  // namespace rclcpp
+
+#endif  // RCLCPP__DETAIL__TIMER_WHEEL_HPP_
@@ -0,0 +1,209 @@
+// Copyright 2021 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__DIRECT_CALLBACK_SUBSCRIPTION_HPP_
+#define RCLCPP__DIRECT_CALLBACK_SUBSCRIPTION_HPP_
+
+#include <memory>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "rclcpp/any_subscription_callback.hpp"
+#include "rclcpp/function_traits.hpp"
+#include "rclcpp/macros.hpp"
+#include "rclcpp/message_info.hpp"
+#include "rclcpp/node_interfaces/node_base_interface.hpp"
+#include "rclcpp/qos.hpp"
+#include "rclcpp/subscription.hpp"
+#include "rclcpp/subscription_options.hpp"
+#include "rclcpp/subscription_traits.hpp"
+#include "rclcpp/topic_statistics/subscription_topic_statistics.hpp"
+#include "tracetools/tracetools.h"
+
+namespace rclcpp
+{
+
+namespace detail
+{
+
+/// Return a function with the arguments of the callback which calls the shared callback.
+template<typename CallbackT, typename ... Args>
+auto
+make_shared_callback_forwarder(std::shared_ptr<CallbackT> callback, std::tuple<Args...> *)
+{
+  return [callback = std::move(callback)](Args... args) {
+           (*callback)(std::forward<Args>(args)...);
+         };
+}
+
+}  // namespace detail
+
+/// Subscription calling its callback directly, with the type of the callback known.
+/**
+ * The messages taken from the middleware are given to the callback without
+ * going through the std::function and the variant of the
+ * AnySubscriptionCallback, so the call can be inlined.
+ * It is created by rclcpp::create_subscription() for the callbacks which
+ * rclcpp::subscription_traits::is_direct_callback accepts, and is otherwise
+ * used as the Subscription<MessageT, AllocatorT> it derives from.
+ *
+ * The callback is shared with the AnySubscriptionCallback, which still calls
+ * it for the messages delivered through intra-process or shared memory.
+ *
+ * \tparam MessageT type of the messages, not a TypeAdapter.
+ * \tparam CallbackT type of the callback.
+ * \tparam AllocatorT allocator of the subscription.
+ */
+template<
+  typename MessageT,
+  typename CallbackT,
+  typename AllocatorT = std::allocator<void>>
+class DirectCallbackSubscription : public Subscription<MessageT, AllocatorT>
+{
+  using SubscriptionT = Subscription<MessageT, AllocatorT>;
+  using CallbackArguments = typename rclcpp::function_traits::function_traits<CallbackT>::arguments;
+  using MessageArgument = std::tuple_element_t<0, CallbackArguments>;
+
+  static_assert(
+    !rclcpp::TypeAdapter<MessageT>::is_specialized::value,
+    "the messages of a DirectCallbackSubscription cannot be adapted");
+  static_assert(
+    rclcpp::subscription_traits::is_direct_callback<
+      CallbackT, typename SubscriptionT::ROSMessageType>::value,
+    "the callback of a DirectCallbackSubscription must take a message by constant reference "
+    "or by shared pointer");
+
+public:
+  RCLCPP_SMART_PTR_DEFINITIONS(DirectCallbackSubscription)
+
+  using ROSMessageType = typename SubscriptionT::ROSMessageType;
+  using MessageMemoryStrategyType = typename SubscriptionT::MessageMemoryStrategyType;
+
+  /// Default constructor.
+  /**
+   * \param[in] node_base NodeBaseInterface pointer that is used in part of the setup.
+   * \param[in] type_support_handle rosidl type support struct, for the Message type of the topic.
+   * \param[in] topic_name Name of the topic to subscribe to.
+   * \param[in] qos QoS profile for Subcription.
+   * \param[in] callback User defined callback to call when a message is received.
+   * \param[in] options Options for the subscription.
+   * \param[in] message_memory_strategy The memory strategy to be used for managing message memory.
+   * \param[in] subscription_topic_statistics Optional pointer to a topic statistics subcription.
+   * \throws std::invalid_argument in the same cases as the constructor of Subscription.
+   */
+  DirectCallbackSubscription(
+    rclcpp::node_interfaces::NodeBaseInterface * node_base,
+    const rosidl_message_type_support_t & type_support_handle,
+    const std::string & topic_name,
+    const rclcpp::QoS & qos,
+    std::shared_ptr<CallbackT> callback,
+    const rclcpp::SubscriptionOptionsWithAllocator<AllocatorT> & options,
+    typename MessageMemoryStrategyType::SharedPtr message_memory_strategy,
+    std::shared_ptr<rclcpp::topic_statistics::SubscriptionTopicStatistics<ROSMessageType>>
+    subscription_topic_statistics = nullptr)
+  : SubscriptionT(
+      node_base,
+      type_support_handle,
+      topic_name,
+      qos,
+      make_any_subscription_callback(callback, options),
+      options,
+      message_memory_strategy,
+      subscription_topic_statistics),
+    callback_(std::move(callback))
+  {}
+
+  void
+  handle_message(
+    std::shared_ptr<void> & message,
+    const rclcpp::MessageInfo & message_info) override
+  {
+    auto typed_message = std::static_pointer_cast<ROSMessageType>(message);
+    this->handle_message_with(
+      *typed_message, message_info,
+      [this, &typed_message, &message_info]() {
+        const void * callback_id =
+          static_cast<const void *>(&this->get_any_subscription_callback());
+        TRACEPOINT(callback_start, callback_id, false);
+        call_callback(typed_message, message_info);
+        TRACEPOINT(callback_end, callback_id);
+      });
+  }
+
+  void
+  handle_reusable_message(
+    void * message,
+    const rclcpp::MessageInfo & message_info) override
+  {
+    if constexpr (std::is_same<MessageArgument, const ROSMessageType &>::value) {
+      const auto & typed_message = *static_cast<ROSMessageType *>(message);
+      this->handle_message_with(
+        typed_message, message_info,
+        [this, &typed_message, &message_info]() {
+          const void * callback_id =
+            static_cast<const void *>(&this->get_any_subscription_callback());
+          TRACEPOINT(callback_start, callback_id, false);
+          if constexpr (std::tuple_size<CallbackArguments>::value == 2) {
+            (*callback_)(typed_message, message_info);
+          } else {
+            (*callback_)(typed_message);
+          }
+          TRACEPOINT(callback_end, callback_id);
+        });
+    } else {
+      SubscriptionT::handle_reusable_message(message, message_info);
+    }
+  }
+
+private:
+  RCLCPP_DISABLE_COPY(DirectCallbackSubscription)
+
+  static AnySubscriptionCallback<MessageT, AllocatorT>
+  make_any_subscription_callback(
+    const std::shared_ptr<CallbackT> & callback,
+    const rclcpp::SubscriptionOptionsWithAllocator<AllocatorT> & options)
+  {
+    AnySubscriptionCallback<MessageT, AllocatorT> any_callback(*options.get_allocator());
+    any_callback.set(
+      detail::make_shared_callback_forwarder(
+        callback, static_cast<CallbackArguments *>(nullptr)));
+    return any_callback;
+  }
+
+  void
+  call_callback(std::shared_ptr<ROSMessageType> & message, const rclcpp::MessageInfo & info)
+  {
+    if constexpr (std::is_same<MessageArgument, const ROSMessageType &>::value) {
+      if constexpr (std::tuple_size<CallbackArguments>::value == 2) {
+        (*callback_)(*message, info);
+      } else {
+        (*callback_)(*message);
+      }
+    } else {
+      if constexpr (std::tuple_size<CallbackArguments>::value == 2) {
+        (*callback_)(message, info);
+      } else {
+        (*callback_)(message);
+      }
+    }
+  }
+
+  std::shared_ptr<CallbackT> callback_;
+};
+
+}  // namespace rclcpp
+
+#endif  // RCLCPP__DIRECT_CALLBACK_SUBSCRIPTION_HPP_
@@ -16,6 +16,7 @@
 #define RCLCPP__DURATION_HPP_
 
 #include <chrono>
+#include <cstddef>
 
 #include "builtin_interfaces/msg/duration.hpp"
 #include "rcl/time.h"
@@ -158,6 +159,37 @@ private:
   Duration() = default;
 };
 
+/// Convert duration messages to nanoseconds, like rclcpp::Duration(msg).nanoseconds().
+/**
+ * Bulk version of the conversion, for arrays of durations, without branches.
+ *
+ * \param[in] durations the durations to convert.
+ * \param[in] count the number of durations.
+ * \param[out] nanoseconds array of count values receiving the result.
+ */
+RCLCPP_PUBLIC
+void
+durations_to_nanoseconds(
+  const builtin_interfaces::msg::Duration * durations,
+  size_t count,
+  rcl_duration_value_t * nanoseconds);
+
+/// Convert nanoseconds to duration messages, like rclcpp::Duration's conversion operator.
+/**
+ * Bulk version of the conversion, for arrays of durations, without branches.
+ * Durations out of the range of the message saturate like for one duration.
+ *
+ * \param[in] nanoseconds the durations to convert.
+ * \param[in] count the number of durations.
+ * \param[out] durations array of count messages receiving the result.
+ */
+RCLCPP_PUBLIC
+void
+nanoseconds_to_durations(
+  const rcl_duration_value_t * nanoseconds,
+  size_t count,
+  builtin_interfaces::msg::Duration * durations);
+
 }  // namespace rclcpp
 
 #endif  // RCLCPP__DURATION_HPP_
@@ -0,0 +1,144 @@
+// Copyright 2021 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__DURATION_HISTOGRAM_HPP_
+#define RCLCPP__DURATION_HISTOGRAM_HPP_
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "rclcpp/macros.hpp"
+#include "rclcpp/visibility_control.hpp"
+
+namespace rclcpp
+{
+
+/// Lock-free histogram of durations with log-linear buckets, shared by the statistics of rclcpp.
+/**
+ * The durations below 8 nanoseconds each have their bucket, and every power
+ * of two range above is split in 8 buckets of equal width, like HDR
+ * histograms do, so the bucket of a duration is within 12.5% of it.
+ * The memory of the histogram is allocated once, when it is constructed.
+ *
+ * Recording a duration is a handful of relaxed atomic operations and never
+ * blocks nor allocates.
+ * The histogram can be split in shards, each thread recording in the shard
+ * picked from its index, so that the threads of a multi threaded executor do
+ * not contend on the same cache lines.
+ * Snapshots merge the shards.
+ * Negative durations are recorded as zero.
+ */
+class DurationHistogram
+{
+public:
+  /// Number of buckets each power of two range is split in, as a power of two.
+  static constexpr size_t sub_bucket_bits = 3;
+  static constexpr size_t sub_buckets_per_range = size_t(1) << sub_bucket_bits;
+  /// One bucket per duration below sub_buckets_per_range nanoseconds, then
+  /// sub_buckets_per_range buckets per power of two range up to the maximum duration.
+  static constexpr size_t number_of_buckets =
+    sub_buckets_per_range + (63 - sub_bucket_bits) * sub_buckets_per_range;
+
+  /// Copy of the content of a histogram.
+  /**
+   * Durations recorded while the snapshot is taken may be only partially included.
+   */
+  struct Snapshot
+  {
+    std::array<uint64_t, number_of_buckets> bucket_counts{};
+    uint64_t count = 0;
+    std::chrono::nanoseconds min{0};
+    std::chrono::nanoseconds max{0};
+    /// Average of the durations in nanoseconds, 0 if there are none.
+    double mean = 0.0;
+    /// Standard deviation of the durations in nanoseconds, 0 if there are none.
+    double standard_deviation = 0.0;
+
+    /// Return an upper bound of the given percentile of the durations.
+    /**
+     * \param[in] percentile the percentile, between 0 and 100.
+     * \return the upper bound of the bucket holding the percentile, capped by the maximum,
+     *   or 0 if there are no durations.
+     */
+    RCLCPP_PUBLIC
+    std::chrono::nanoseconds
+    get_percentile(double percentile) const;
+
+    /// Add the durations of another snapshot, like the one of another histogram.
+    RCLCPP_PUBLIC
+    void
+    merge(const Snapshot & other);
+  };
+
+  /// Construct an empty histogram.
+  /**
+   * \param[in] number_of_shards number of shards the durations are recorded in,
+   *   1 for histograms which are seldom recorded in concurrently.
+   * \throws std::invalid_argument if the number of shards is 0.
+   */
+  RCLCPP_PUBLIC
+  explicit DurationHistogram(size_t number_of_shards = 1);
+
+  RCLCPP_PUBLIC
+  ~DurationHistogram();
+
+  /// Record a duration.
+  RCLCPP_PUBLIC
+  void
+  record(std::chrono::nanoseconds duration);
+
+  /// Return a copy of the content of the histogram, with its shards merged.
+  RCLCPP_PUBLIC
+  Snapshot
+  get_snapshot() const;
+
+  /// Drop all the recorded durations.
+  RCLCPP_PUBLIC
+  void
+  reset();
+
+  RCLCPP_PUBLIC
+  size_t
+  get_number_of_shards() const;
+
+  /// Return the size of the memory allocated for the shards, in bytes.
+  RCLCPP_PUBLIC
+  size_t
+  get_allocated_memory_size() const;
+
+  /// Return the index of the bucket a duration is counted in.
+  RCLCPP_PUBLIC
+  static size_t
+  get_bucket(std::chrono::nanoseconds duration);
+
+  /// Return the smallest duration which is not counted in a bucket.
+  RCLCPP_PUBLIC
+  static std::chrono::nanoseconds
+  get_bucket_upper_bound(size_t bucket);
+
+private:
+  RCLCPP_DISABLE_COPY(DurationHistogram)
+
+  struct Shard;
+
+  const size_t number_of_shards_;
+  std::unique_ptr<Shard[]> shards_;
+};
+
+}  // namespace rclcpp
+
+#endif  // RCLCPP__DURATION_HISTOGRAM_HPP_
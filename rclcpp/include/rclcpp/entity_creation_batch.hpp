@@ -0,0 +1,105 @@
+// Copyright 2021 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__ENTITY_CREATION_BATCH_HPP_
+#define RCLCPP__ENTITY_CREATION_BATCH_HPP_
+
+#include <exception>
+#include <utility>
+
+#include "rcutils/logging_macros.h"
+
+#include "rclcpp/macros.hpp"
+#include "rclcpp/node_interfaces/node_base_interface.hpp"
+
+namespace rclcpp
+{
+
+/// Scope in which the entities created with a node notify the executors once, at its end.
+/**
+ * Each publisher, subscription, timer, service, client or waitable added to
+ * a node notifies the executors spinning it, which collect the entities of
+ * the node again.
+ * While a batch exists, these notifications are deferred, and the executors
+ * are notified once when the last batch of the node ends, so that setting up
+ * many entities makes them collect the entities once.
+ *
+ * Batches of the same node may be nested.
+ *
+ * \code{.cpp}
+ * {
+ *   rclcpp::EntityCreationBatch batch(node->get_node_base_interface());
+ *   for (const auto & topic : topics) {
+ *     subscriptions.push_back(node->create_subscription<MessageT>(topic, qos, callback));
+ *   }
+ * }  // The executors are notified here.
+ * \endcode
+ */
+class EntityCreationBatch
+{
+public:
+  /// Start deferring the entity notifications of the node.
+  explicit EntityCreationBatch(rclcpp::node_interfaces::NodeBaseInterface::SharedPtr node_base)
+  : node_base_(std::move(node_base))
+  {
+    node_base_->start_deferring_entity_notifications();
+  }
+
+  EntityCreationBatch(EntityCreationBatch && other) noexcept
+  : node_base_(std::move(other.node_base_))
+  {
+    other.node_base_.reset();
+  }
+
+  EntityCreationBatch &
+  operator=(EntityCreationBatch && other) = delete;
+
+  /// End the batch if end() was not called, logging the errors instead of throwing them.
+  ~EntityCreationBatch()
+  {
+    try {
+      end();
+    } catch (const std::exception & exception) {
+      RCUTILS_LOG_ERROR_NAMED(
+        "rclcpp",
+        "Error in destruction of EntityCreationBatch: %s", exception.what());
+    }
+  }
+
+  /// End the batch, notifying the executors if it was the last one of the node.
+  /**
+   * Calling it again does nothing.
+   *
+   * \throws rclcpp::exceptions::RCLError if the notify guard condition cannot be triggered.
+   */
+  void
+  end()
+  {
+    if (!node_base_) {
+      return;
+    }
+    auto node_base = std::move(node_base_);
+    node_base_.reset();
+    node_base->stop_deferring_entity_notifications();
+  }
+
+private:
+  RCLCPP_DISABLE_COPY(EntityCreationBatch)
+
+  rclcpp::node_interfaces::NodeBaseInterface::SharedPtr node_base_;
+};
+
+}  // namespace rclcpp
+
+#endif  // RCLCPP__ENTITY_CREATION_BATCH_HPP_
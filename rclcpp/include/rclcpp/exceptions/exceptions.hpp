@@ -310,6 +310,31 @@ class QoSCheckCompatibleException : public std::runtime_error
   using std::runtime_error::runtime_error;
 };
 
+/// Thrown by the future of a request to a service which did not respond in time.
+class RequestTimeoutError : public std::runtime_error
+{
+public:
+  // Inherit constructors from runtime_error.
+  using std::runtime_error::runtime_error;
+};
+
+/// Thrown when a request is sent while as many requests as allowed are pending.
+class TooManyPendingRequestsError : public std::runtime_error
+{
+public:
+  // Inherit constructors from runtime_error.
+  using std::runtime_error::runtime_error;
+};
+
+/// Thrown when a message is published while the intraprocess buffer of a keep all
+/// subscription is full, see rclcpp::IntraProcessBackpressurePolicy.
+class IntraProcessBufferFullError : public std::runtime_error
+{
+public:
+  // Inherit constructors from runtime_error.
+  using std::runtime_error::runtime_error;
+};
+
 }  // namespace exceptions
 }  // namespace rclcpp
 
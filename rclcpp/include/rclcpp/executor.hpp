@@ -16,6 +16,7 @@
 #define RCLCPP__EXECUTOR_HPP_
 
 #include <algorithm>
+#include <atomic>
 #include <cassert>
 #include <chrono>
 #include <cstdlib>
@@ -25,6 +26,7 @@
 #include <memory>
 #include <mutex>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include "rcl/guard_condition.h"
@@ -33,8 +35,13 @@
 
 #include "rclcpp/context.hpp"
 #include "rclcpp/contexts/default_context.hpp"
+#include "rclcpp/detail/adaptive_busy_poll.hpp"
+#include "rclcpp/detail/future_waiters.hpp"
 #include "rclcpp/guard_condition.hpp"
 #include "rclcpp/executor_options.hpp"
+#include "rclcpp/executor_statistics.hpp"
+#include "rclcpp/executor_watchdog.hpp"
+#include "rclcpp/executors/shared_waiter.hpp"
 #include "rclcpp/future_return_code.hpp"
 #include "rclcpp/memory_strategies.hpp"
 #include "rclcpp/memory_strategy.hpp"
@@ -319,6 +326,12 @@ public:
 
   /// Spin (blocking) until the future is complete, it times out waiting, or rclcpp is interrupted.
   /**
+   * The future is checked after each executed callback, and whenever the wait is woken.
+   * The wait is woken as soon as the promises of rclcpp, like the ones of the
+   * requests of the clients, are completed, even by another executor.
+   * A future completed from another thread must be followed by a call to
+   * wake() for this to return without waiting for the next callback or the timeout.
+   *
    * \param[in] future The future to wait on. If this function returns SUCCESS, the future can be
    *   accessed without blocking (though it may still throw an exception).
    * \param[in] timeout Optional timeout parameter, which gets passed to Executor::spin_node_once.
@@ -336,6 +349,9 @@ public:
     // TODO(wjwwood): does not work recursively; can't call spin_node_until_future_complete
     // inside a callback executed by an executor.
 
+    // Registered before checking the future, for its completion to wake the wait.
+    rclcpp::detail::FutureWaiterScope future_waiter_scope(this);
+
     // Check the future before entering the while loop.
     // If the future is already complete, don't try to spin.
     std::future_status status = future.wait_for(std::chrono::seconds(0));
@@ -356,7 +372,7 @@ public:
     }
     RCPPUTILS_SCOPE_EXIT(this->spinning.store(false); );
     while (rclcpp::ok(this->context_) && spinning.load()) {
-      // Do one item of work.
+      // Do one item of work, or wait until woken.
       spin_once_impl(timeout_left);
 
       // Check if the future is set, return SUCCESS if it is.
@@ -390,6 +406,21 @@ public:
   void
   cancel();
 
+  /// Wake the current or next wait of the executor, without canceling its spin.
+  /**
+   * This function can be called asynchonously from any thread, like after
+   * completing a future awaited by spin_until_future_complete().
+   * \throws std::runtime_error if there is an issue triggering the guard condition
+   */
+  RCLCPP_PUBLIC
+  void
+  wake();
+
+  /// Return true if a spin* function is running, until it is canceled.
+  RCLCPP_PUBLIC
+  bool
+  is_spinning();
+
   /// Support dynamic switching of the memory strategy.
   /**
    * Switching the memory strategy while the executor is spinning in another threading could have
@@ -401,6 +432,52 @@ public:
   void
   set_memory_strategy(memory_strategy::MemoryStrategy::SharedPtr memory_strategy);
 
+  /// Start collecting statistics about the executions of this executor.
+  /**
+   * Collecting statistics cannot be disabled, calling this again returns the
+   * same statistics.
+   * Only the executables found ready after a wait of this executor are measured,
+   * not the ones executed by the events executor or the static single threaded executor.
+   *
+   * \return the statistics of the executor.
+   */
+  RCLCPP_PUBLIC
+  ExecutorStatistics::SharedPtr
+  enable_statistics();
+
+  /// Return the statistics of this executor, nullptr if enable_statistics() was not called.
+  RCLCPP_PUBLIC
+  ExecutorStatistics::SharedPtr
+  get_statistics() const;
+
+  /// Start a watchdog thread reporting the executions which take longer than the threshold.
+  /**
+   * The watchdog cannot be disabled, calling this again returns the same watchdog,
+   * with the threshold it was started with.
+   * Only the executables found ready after a wait of this executor are watched,
+   * as for enable_statistics().
+   *
+   * \param[in] threshold the duration of the executions reported as stalls, must be positive.
+   * \return the watchdog of the executor.
+   * \throws std::invalid_argument if threshold is not positive.
+   */
+  RCLCPP_PUBLIC
+  ExecutorWatchdog::SharedPtr
+  enable_watchdog(std::chrono::nanoseconds threshold);
+
+  /// Return the watchdog of this executor, nullptr if enable_watchdog() was not called.
+  RCLCPP_PUBLIC
+  ExecutorWatchdog::SharedPtr
+  get_watchdog() const;
+
+  /// Return the approximate size of the memory used by the memory strategy, in bytes.
+  /**
+   * \sa rclcpp::memory_strategy::MemoryStrategy::get_memory_size()
+   */
+  RCLCPP_PUBLIC
+  size_t
+  get_memory_strategy_size() const;
+
 protected:
   RCLCPP_PUBLIC
   void
@@ -425,19 +502,19 @@ protected:
   RCLCPP_PUBLIC
   static void
   execute_subscription(
-    rclcpp::SubscriptionBase::SharedPtr subscription);
+    const rclcpp::SubscriptionBase::SharedPtr & subscription);
 
   RCLCPP_PUBLIC
   static void
-  execute_timer(rclcpp::TimerBase::SharedPtr timer);
+  execute_timer(const rclcpp::TimerBase::SharedPtr & timer);
 
   RCLCPP_PUBLIC
   static void
-  execute_service(rclcpp::ServiceBase::SharedPtr service);
+  execute_service(const rclcpp::ServiceBase::SharedPtr & service);
 
   RCLCPP_PUBLIC
   static void
-  execute_client(rclcpp::ClientBase::SharedPtr client);
+  execute_client(const rclcpp::ClientBase::SharedPtr & client);
 
   /**
    * \throws std::runtime_error if the wait set can be cleared
@@ -450,7 +527,7 @@ protected:
   rclcpp::node_interfaces::NodeBaseInterface::SharedPtr
   get_node_by_group(
     const WeakCallbackGroupsToNodesMap & weak_groups_to_nodes,
-    rclcpp::CallbackGroup::SharedPtr group);
+    const rclcpp::CallbackGroup::SharedPtr & group);
 
   /// Return true if the node has been added to this executor.
   /**
@@ -465,7 +542,7 @@ protected:
 
   RCLCPP_PUBLIC
   rclcpp::CallbackGroup::SharedPtr
-  get_group_by_timer(rclcpp::TimerBase::SharedPtr timer);
+  get_group_by_timer(const rclcpp::TimerBase::SharedPtr & timer);
 
   /// Add a callback group to an executor
   /**
@@ -500,12 +577,34 @@ protected:
     AnyExecutable & any_executable,
     const WeakCallbackGroupsToNodesMap & weak_groups_to_nodes);
 
+  /// Take all the executables which are ready after the last wait at once.
+  /**
+   * This has the same effect as calling get_next_ready_executable() until it returns false,
+   * but the ready list is built in a single pass with the memory strategy locked only once,
+   * so the executables found by one wait can then be executed in sequence.
+   * A mutually exclusive callback group contributes at most one executable, the others are left
+   * in the memory strategy for the next call.
+   *
+   * \param[out] ready_executables the ready executables are appended to this vector.
+   * \return the number of executables which were appended.
+   */
+  RCLCPP_PUBLIC
+  size_t
+  get_all_ready_executables(std::vector<AnyExecutable> & ready_executables);
+
   RCLCPP_PUBLIC
   bool
   get_next_executable(
     AnyExecutable & any_executable,
     std::chrono::nanoseconds timeout = std::chrono::nanoseconds(-1));
 
+  /// Take the first ready executable, with the memory strategy already locked.
+  RCLCPP_PUBLIC
+  bool
+  take_next_ready_executable(
+    AnyExecutable & any_executable,
+    const WeakCallbackGroupsToNodesMap & weak_groups_to_nodes) RCPPUTILS_TSA_REQUIRES(mutex_);
+
   /// Add all callback groups that can be automatically added from associated nodes.
   /**
    * The executor, before collecting entities, verifies if any callback group from
@@ -521,6 +620,18 @@ protected:
   virtual void
   add_callback_groups_from_nodes_associated_to_executor() RCPPUTILS_TSA_REQUIRES(mutex_);
 
+  /// Collect the entities of all the callback groups into the memory strategy.
+  /**
+   * Callback groups of associated nodes that were not added yet are added first, and the
+   * callback groups or nodes that were destroyed are removed from the executor.
+   *
+   * \param[in] cache_entities if true the memory strategy keeps the collected handles so they can
+   *   be reused by the next waits, otherwise the entities will be collected again next time.
+   */
+  RCLCPP_PUBLIC
+  void
+  collect_entities_for_wait(bool cache_entities) RCPPUTILS_TSA_REQUIRES(mutex_);
+
   /// Spinning state, used to prevent multi threaded calls to spin and to cancel blocking spins.
   std::atomic_bool spinning;
 
@@ -573,6 +684,81 @@ protected:
   std::list<rclcpp::node_interfaces::NodeBaseInterface::WeakPtr>
   weak_nodes_ RCPPUTILS_TSA_GUARDED_BY(mutex_);
 
+  /// What the executor holds of a node, for adding and removing it without scanning the maps.
+  struct NodeMembership
+  {
+    /// Tells a node from another one allocated at the same address once it is gone.
+    rclcpp::node_interfaces::NodeBaseInterface::WeakPtr node;
+    /// Number of callback groups of the node in the executor, however they were added.
+    size_t number_of_groups = 0;
+    /// Callback groups of the node in weak_groups_to_nodes_associated_with_executor_.
+    std::vector<rclcpp::CallbackGroup::WeakPtr> groups_added_with_node;
+    /// True if the node was added with add_node(), it is then at weak_node_it in weak_nodes_.
+    bool added_as_node = false;
+    std::list<rclcpp::node_interfaces::NodeBaseInterface::WeakPtr>::iterator weak_node_it;
+  };
+
+  /// Return the membership of a node, or nullptr if none of it is in the executor.
+  RCLCPP_PUBLIC
+  NodeMembership *
+  find_node_membership(const rclcpp::node_interfaces::NodeBaseInterface::SharedPtr & node_ptr)
+  RCPPUTILS_TSA_REQUIRES(mutex_);
+
+  /// Forget a callback group of a node, and the node too if nothing else of it is left.
+  RCLCPP_PUBLIC
+  void
+  remove_group_from_node_membership(
+    const rclcpp::node_interfaces::NodeBaseInterface::SharedPtr & node_ptr,
+    const rclcpp::CallbackGroup::WeakPtr & weak_group_ptr,
+    bool added_with_node) RCPPUTILS_TSA_REQUIRES(mutex_);
+
+  /// Nodes with callback groups in the executor or added with add_node(), by address.
+  std::unordered_map<const rclcpp::node_interfaces::NodeBaseInterface *, NodeMembership>
+  node_memberships_ RCPPUTILS_TSA_GUARDED_BY(mutex_);
+
+  /// True when the entities have to be collected again by the next wait_for_work().
+  /**
+   * Set when callback groups or nodes are added or removed, or when the notify guard condition
+   * of a node wakes up the wait set, meaning that one of its entities was added or removed.
+   * While it is false the handles cached by the memory strategy and the size of the wait set are
+   * reused.
+   */
+  std::atomic_bool entities_need_rebuild_{true};
+
+  /// True when the callback groups don't all have the same priority, updated on collection.
+  bool callback_group_priorities_in_use_ RCPPUTILS_TSA_GUARDED_BY(mutex_) = false;
+
+  /// How the next ready executable is chosen, from the ExecutorOptions.
+  const rclcpp::ExecutorSchedulingPolicy scheduling_policy_;
+
+  /// Scheduling attributes of the thread spinning the executor, from the ExecutorOptions.
+  const rclcpp::ThreadAttributes thread_attributes_;
+
+  /// Capacities reserved in the wait set, from the ExecutorOptions, none by default.
+  const rclcpp::WaitSetCapacities wait_set_capacities_;
+
+  /// Busy polling before the blocking waits, from the ExecutorOptions, disabled by default.
+  /**
+   * Only used by the thread in wait_for_work().
+   */
+  rclcpp::detail::AdaptiveBusyPoll busy_poll_;
+
+  /// Waiter making the blocking waits, from the ExecutorOptions, none by default.
+  const std::shared_ptr<rclcpp::executors::SharedWaiter> shared_waiter_;
+
+  /// Statistics of the executor if enabled, owned by statistics_owner_.
+  std::atomic<ExecutorStatistics *> statistics_{nullptr};
+
+  /// Return time of the last wait, only measured when statistics are collected.
+  std::chrono::steady_clock::time_point last_wait_end_ RCPPUTILS_TSA_GUARDED_BY(mutex_);
+
+  mutable std::mutex statistics_mutex_;
+  ExecutorStatistics::SharedPtr statistics_owner_;
+
+  /// Watchdog of the executor if enabled, owned by watchdog_owner_.
+  std::atomic<ExecutorWatchdog *> watchdog_{nullptr};
+  ExecutorWatchdog::SharedPtr watchdog_owner_;
+
   /// shutdown callback handle registered to Context
   rclcpp::OnShutdownCallbackHandle shutdown_callback_handle_;
 };
@@ -15,27 +15,116 @@
 #ifndef RCLCPP__EXECUTOR_OPTIONS_HPP_
 #define RCLCPP__EXECUTOR_OPTIONS_HPP_
 
+#include <chrono>
+#include <memory>
+#include <vector>
+
 #include "rclcpp/context.hpp"
 #include "rclcpp/contexts/default_context.hpp"
+#include "rclcpp/executors/shared_waiter.hpp"
 #include "rclcpp/memory_strategies.hpp"
 #include "rclcpp/memory_strategy.hpp"
+#include "rclcpp/thread_attributes.hpp"
 #include "rclcpp/visibility_control.hpp"
 
 namespace rclcpp
 {
 
+/// How an executor picks the next entity to execute among the ready ones.
+enum class ExecutorSchedulingPolicy
+{
+  /// Timers first, then subscriptions, services, clients and waitables.
+  FixedOrder,
+  /// The ready timer or subscription with the closest deadline first.
+  /**
+   * \sa rclcpp::memory_strategy::MemoryStrategy::get_next_executable_by_deadline()
+   */
+  EarliestDeadlineFirst,
+  /// The ready entity executed the least recently first.
+  /**
+   * An entity which is always ready, like a subscription to a high rate topic, is only
+   * executed again once the other ready entities were, even across calls to spin_some() or
+   * spin_all() which run out of time before executing them all.
+   *
+   * \sa rclcpp::memory_strategy::MemoryStrategy::get_next_executable_round_robin()
+   */
+  RoundRobin
+};
+
+/// Numbers of entities of each kind a wait set can hold.
+struct WaitSetCapacities
+{
+  size_t subscriptions = 0;
+  /// Including the guard conditions of the executor itself and of its nodes.
+  size_t guard_conditions = 0;
+  size_t timers = 0;
+  size_t clients = 0;
+  size_t services = 0;
+  size_t events = 0;
+
+  /// Return true if no capacity is reserved.
+  bool
+  empty() const
+  {
+    return 0 == subscriptions && 0 == guard_conditions && 0 == timers && 0 == clients &&
+           0 == services && 0 == events;
+  }
+};
+
 /// Options to be passed to the executor constructor.
 struct ExecutorOptions
 {
   ExecutorOptions()
   : memory_strategy(rclcpp::memory_strategies::create_default_strategy()),
     context(rclcpp::contexts::get_global_default_context()),
-    max_conditions(0)
+    max_conditions(0),
+    scheduling_policy(ExecutorSchedulingPolicy::FixedOrder)
   {}
 
   rclcpp::memory_strategy::MemoryStrategy::SharedPtr memory_strategy;
   rclcpp::Context::SharedPtr context;
   size_t max_conditions;
+  ExecutorSchedulingPolicy scheduling_policy;
+  /// Scheduling attributes of the threads spinning the executor.
+  /**
+   * The thread which calls spin() gets back its own attributes when spin() returns.
+   */
+  rclcpp::ThreadAttributes thread_attributes;
+  /// Scheduling attributes of each thread of a MultiThreadedExecutor, by thread index.
+  /**
+   * Threads without an entry use thread_attributes.
+   * The last thread is the one which calls spin().
+   */
+  std::vector<rclcpp::ThreadAttributes> worker_thread_attributes;
+  /// Capacities of the wait set of the executor, allocated once when it is constructed.
+  /**
+   * By default the wait set is resized to the entities to wait on whenever they change.
+   * With reserved capacities, the wait set is only cleared and reused, and waiting on more
+   * entities of a kind than reserved throws std::runtime_error.
+   * The entities of the waitables, like the events of publishers and subscriptions, count in
+   * the capacities.
+   */
+  WaitSetCapacities wait_set_capacities;
+  /// Maximum time to busy poll the wait set before blocking in each wait for work.
+  /**
+   * The wait set is polled without blocking until work is found or the budget is spent, and
+   * only then does the executor block in rcl_wait(), which avoids the latency of being woken up
+   * by the kernel at the cost of keeping a core busy.
+   * The budget adapts to how soon work arrives on average, and polling stops while work arrives
+   * much later than the budget, see rclcpp::detail::AdaptiveBusyPoll.
+   * Used by the SingleThreadedExecutor and the MultiThreadedExecutor, 0 to never poll.
+   */
+  std::chrono::nanoseconds busy_poll_budget{0};
+  /// Waiter shared with other executors, blocking in a single rcl_wait() for all of them.
+  /**
+   * The blocking waits for work of the executor are made by the thread of the waiter, on the
+   * union of the entities of the executors using it, and only wake up the executor when its
+   * own entities are ready, see rclcpp::executors::SharedWaiter.
+   * The executor still executes its callbacks in its own threads.
+   * Used by the SingleThreadedExecutor and the MultiThreadedExecutor, nullptr, the default, for
+   * the executor to wait on its own.
+   */
+  std::shared_ptr<rclcpp::executors::SharedWaiter> shared_waiter;
 };
 
 }  // namespace rclcpp
@@ -0,0 +1,195 @@
+// Copyright 2021 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__EXECUTOR_STATISTICS_HPP_
+#define RCLCPP__EXECUTOR_STATISTICS_HPP_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "rclcpp/any_executable.hpp"
+#include "rclcpp/callback_group.hpp"
+#include "rclcpp/macros.hpp"
+#include "rclcpp/node_interfaces/node_base_interface.hpp"
+#include "rclcpp/duration_histogram.hpp"
+#include "rclcpp/visibility_control.hpp"
+
+namespace rclcpp
+{
+
+/// Statistics about how long the executables of an executor wait and take to execute.
+/**
+ * Statistics are only collected by executors on which
+ * rclcpp::Executor::enable_statistics() was called, for the executables they
+ * find ready after a wait, like the single and multi threaded executors do.
+ *
+ * The dispatch latency of an executable is the time from the return of the
+ * wait which found it ready to the start of its execution.
+ * It includes the time spent executing the executables taken before it, and
+ * with a multi threaded executor the time the threads took to take it.
+ * The queueing delay of a callback group is the dispatch latency of its executables.
+ *
+ * The dispatch latencies and execution durations are recorded without
+ * locking, in histograms sharded for the threads of multi threaded executors,
+ * the callback group of an executable is looked up under a mutex.
+ */
+class ExecutorStatistics
+{
+public:
+  RCLCPP_SMART_PTR_DEFINITIONS_NOT_COPYABLE(ExecutorStatistics)
+
+  /// Queueing delays of the executables of a callback group.
+  struct CallbackGroupQueueingDelay
+  {
+    /// Fully qualified name of the node of the group, followed by "/default_callback_group"
+    /// for its default callback group, or by "/callback_group_<n>", numbered in the order
+    /// the groups were first executed.
+    std::string name;
+    DurationHistogram::Snapshot queueing_delay;
+  };
+
+  /// CPU time consumed by the executions of an entity.
+  struct EntityCpuTime
+  {
+    /// Fully qualified name of the node of the entity, followed by "/subscription:<topic>",
+    /// "/service:<service>", "/client:<service>", "/timer_<n>" or "/waitable_<n>", numbered
+    /// in the order the entities of the kind were first executed.
+    std::string name;
+    uint64_t executions = 0;
+    std::chrono::nanoseconds total{0};
+    std::chrono::nanoseconds min{0};
+    std::chrono::nanoseconds max{0};
+  };
+
+  RCLCPP_PUBLIC
+  ExecutorStatistics();
+
+  /// Start measuring the CPU time of the calling thread around each execution.
+  /**
+   * The CPU time is accounted to the entity executed, see get_entity_cpu_times().
+   * Unlike the execution duration, it excludes the time the thread was not running, like
+   * while it was preempted or blocked.
+   * Measuring it reads the CPU clock of the thread twice per execution, which is usually a
+   * system call, so it is disabled by default.
+   */
+  RCLCPP_PUBLIC
+  void
+  enable_cpu_time_accounting();
+
+  /// Return true if the CPU time of the executions is measured.
+  RCLCPP_PUBLIC
+  bool
+  accounts_cpu_time() const;
+
+  /// Return the CPU time consumed by the calling thread.
+  /**
+   * It is read from CLOCK_THREAD_CPUTIME_ID on POSIX systems and from GetThreadTimes() on
+   * Windows.
+   *
+   * \throws std::system_error if the clock cannot be read.
+   */
+  RCLCPP_PUBLIC
+  static std::chrono::nanoseconds
+  get_thread_cpu_time();
+
+  /// Record the start of the execution of an executable.
+  /**
+   * \param[in] group the callback group of the executable.
+   * \param[in] node the node of the callback group, used to name it.
+   * \param[in] dispatch_latency the time since the wait which found the executable ready.
+   */
+  RCLCPP_PUBLIC
+  void
+  record_dispatch_latency(
+    const rclcpp::CallbackGroup::SharedPtr & group,
+    const rclcpp::node_interfaces::NodeBaseInterface::SharedPtr & node,
+    std::chrono::nanoseconds dispatch_latency);
+
+  /// Record how long the execution of an executable took.
+  RCLCPP_PUBLIC
+  void
+  record_execution_duration(std::chrono::nanoseconds duration);
+
+  /// Record the CPU time an execution of an executable consumed.
+  /**
+   * \param[in] any_exec the executable, whose entity the CPU time is accounted to.
+   * \param[in] cpu_time the CPU time consumed by the thread which executed it.
+   */
+  RCLCPP_PUBLIC
+  void
+  record_cpu_time(const rclcpp::AnyExecutable & any_exec, std::chrono::nanoseconds cpu_time);
+
+  /// Return the histogram of the delays between the waits and the start of the executions.
+  RCLCPP_PUBLIC
+  DurationHistogram::Snapshot
+  get_dispatch_latency() const;
+
+  /// Return the histogram of the durations of the executions.
+  RCLCPP_PUBLIC
+  DurationHistogram::Snapshot
+  get_execution_duration() const;
+
+  /// Return the queueing delays of each callback group executed since the last reset.
+  RCLCPP_PUBLIC
+  std::vector<CallbackGroupQueueingDelay>
+  get_callback_group_queueing_delays() const;
+
+  /// Return the CPU time of each entity executed since the last reset, the largest first.
+  RCLCPP_PUBLIC
+  std::vector<EntityCpuTime>
+  get_entity_cpu_times() const;
+
+  /// Drop all the collected statistics, and forget the entities and callback groups which
+  /// were destroyed.
+  RCLCPP_PUBLIC
+  void
+  reset();
+
+private:
+  struct CallbackGroupEntry
+  {
+    rclcpp::CallbackGroup::WeakPtr group;
+    std::string name;
+    std::unique_ptr<DurationHistogram> queueing_delay;
+  };
+
+  struct EntityEntry
+  {
+    std::weak_ptr<void> entity;
+    EntityCpuTime cpu_time;
+  };
+
+  DurationHistogram dispatch_latency_;
+  DurationHistogram execution_duration_;
+
+  std::atomic_bool accounts_cpu_time_{false};
+  mutable std::mutex entities_mutex_;
+  std::map<const void *, EntityEntry> entities_;
+  size_t number_of_named_timers_ = 0;
+  size_t number_of_named_waitables_ = 0;
+
+  mutable std::mutex callback_groups_mutex_;
+  std::map<const rclcpp::CallbackGroup *, CallbackGroupEntry> callback_groups_;
+  size_t number_of_named_callback_groups_ = 0;
+};
+
+}  // namespace rclcpp
+
+#endif  // RCLCPP__EXECUTOR_STATISTICS_HPP_
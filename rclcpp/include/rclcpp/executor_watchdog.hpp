@@ -0,0 +1,126 @@
+// Copyright 2021 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__EXECUTOR_WATCHDOG_HPP_
+#define RCLCPP__EXECUTOR_WATCHDOG_HPP_
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+#include "rclcpp/any_executable.hpp"
+#include "rclcpp/macros.hpp"
+#include "rclcpp/visibility_control.hpp"
+
+namespace rclcpp
+{
+
+/// Thread reporting the executions of an executor which take longer than a threshold.
+/**
+ * The executor marks the start and the end of each execution, and the
+ * watchdog thread checks the executions in flight a few times per threshold.
+ * An execution running for longer than the threshold is a stall: it is logged
+ * once with its entity, callback group and node, at the warning level of the
+ * "rclcpp.executor_watchdog" logger, and counted.
+ * Its end is logged too, with how long it ran.
+ *
+ * Only the executables found ready after a wait are watched, as for
+ * rclcpp::ExecutorStatistics.
+ * Marking an execution takes a mutex shared with the watchdog thread, which
+ * only holds it briefly to check the executions.
+ */
+class ExecutorWatchdog
+{
+public:
+  RCLCPP_SMART_PTR_DEFINITIONS_NOT_COPYABLE(ExecutorWatchdog)
+
+  /// Start the watchdog thread.
+  /**
+   * \param[in] threshold the duration of the executions reported as stalls, must be positive.
+   * \throws std::invalid_argument if threshold is not positive.
+   */
+  RCLCPP_PUBLIC
+  explicit ExecutorWatchdog(std::chrono::nanoseconds threshold);
+
+  /// Stop the watchdog thread.
+  RCLCPP_PUBLIC
+  ~ExecutorWatchdog();
+
+  /// Mark the start of the execution of an executable by the calling thread.
+  /**
+   * The executable must stay alive until end_execution() is called.
+   */
+  RCLCPP_PUBLIC
+  void
+  begin_execution(const rclcpp::AnyExecutable & any_exec);
+
+  /// Mark the end of the execution started by the calling thread.
+  RCLCPP_PUBLIC
+  void
+  end_execution();
+
+  /// Return the duration of the executions reported as stalls.
+  RCLCPP_PUBLIC
+  std::chrono::nanoseconds
+  get_threshold() const;
+
+  /// Return the number of executions which ran longer than the threshold.
+  RCLCPP_PUBLIC
+  uint64_t
+  get_stall_count() const;
+
+  /// Return the longest duration of the stalled executions which ended.
+  RCLCPP_PUBLIC
+  std::chrono::nanoseconds
+  get_longest_stall() const;
+
+private:
+  /// Execution in flight on a thread of the executor.
+  struct Execution
+  {
+    const rclcpp::AnyExecutable * any_exec = nullptr;
+    std::chrono::steady_clock::time_point start;
+    bool reported = false;
+  };
+
+  void
+  run();
+
+  const std::chrono::nanoseconds threshold_;
+
+  mutable std::mutex mutex_;
+  std::condition_variable stop_condition_;
+  bool stopped_ = false;
+  /// Executions by thread, an entry is kept for each thread which executed.
+  std::unordered_map<std::thread::id, Execution> executions_;
+
+  std::atomic<uint64_t> stall_count_{0};
+  std::atomic<int64_t> longest_stall_ns_{0};
+
+  std::thread thread_;
+};
+
+/// Return a description of the executable, its callback group and its node, for logging.
+RCLCPP_PUBLIC
+std::string
+describe_executable(const rclcpp::AnyExecutable & any_exec);
+
+}  // namespace rclcpp
+
+#endif  // RCLCPP__EXECUTOR_WATCHDOG_HPP_
@@ -18,9 +18,14 @@
 #include <future>
 #include <memory>
 
+#include "rclcpp/executors/cyclic_executor.hpp"
+#include "rclcpp/executors/events_executor.hpp"
 #include "rclcpp/executors/multi_threaded_executor.hpp"
+#include "rclcpp/executors/shared_waiter.hpp"
 #include "rclcpp/executors/single_threaded_executor.hpp"
+#include "rclcpp/executors/static_multi_threaded_executor.hpp"
 #include "rclcpp/executors/static_single_threaded_executor.hpp"
+#include "rclcpp/executors/static_wait_set_executor.hpp"
 #include "rclcpp/node.hpp"
 #include "rclcpp/utilities.hpp"
 #include "rclcpp/visibility_control.hpp"
@@ -51,6 +56,7 @@ spin(rclcpp::Node::SharedPtr node_ptr);
 namespace executors
 {
 
+using rclcpp::executors::EventsExecutor;
 using rclcpp::executors::MultiThreadedExecutor;
 using rclcpp::executors::SingleThreadedExecutor;
 
@@ -0,0 +1,249 @@
+// Copyright 2021 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__EXECUTORS__CYCLIC_EXECUTOR_HPP_
+#define RCLCPP__EXECUTORS__CYCLIC_EXECUTOR_HPP_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "rclcpp/executor.hpp"
+#include "rclcpp/macros.hpp"
+#include "rclcpp/message_info.hpp"
+#include "rclcpp/serialized_message.hpp"
+#include "rclcpp/subscription_base.hpp"
+#include "rclcpp/visibility_control.hpp"
+#include "rclcpp/wait_set.hpp"
+#include "rclcpp/waitable.hpp"
+
+namespace rclcpp
+{
+namespace executors
+{
+
+/// Counters of the cycles executed by a CyclicExecutor.
+struct CyclicExecutorStatistics
+{
+  /// Number of cycles executed.
+  uint64_t cycles = 0;
+  /// Number of cycles which took longer than the cycle time, making the next ones be skipped.
+  uint64_t overruns = 0;
+  /// Longest time a cycle took to execute.
+  std::chrono::nanoseconds max_execution_time{0};
+};
+
+/// Single-threaded executor running a fixed schedule of steps once per cycle.
+/**
+ * The cycles start at a fixed period of the steady clock, and execute the
+ * steps of the schedule in the order they were added, whether or not new
+ * messages arrived, instead of reacting to the arrival of the messages.
+ * This gives a bounded and predictable latency to fixed-schedule control
+ * loops.
+ *
+ * At the start of each cycle, the latest message available is taken for each
+ * subscription step, before any step is executed, so that all the steps of a
+ * cycle see the inputs sampled at the same time.
+ * The callback of a subscription step is only called if a message was taken,
+ * the intra-process messages being taken from the intra-process buffer of the
+ * subscription and given to the callback first.
+ *
+ * A cycle which takes longer than the cycle time is an overrun: the cycles
+ * which should have started meanwhile are skipped, and the next cycle starts
+ * at the next period.
+ *
+ * Nodes and callback groups cannot be added to this executor: only the steps
+ * of its schedule are executed, so the entities they use should not be added
+ * to other executors.
+ * The shutdown guard condition and the interrupt guard condition of the
+ * executor are waited on between the cycles, so that shutting down the context
+ * and cancel() stop it without waiting for the next cycle.
+ */
+class CyclicExecutor : public rclcpp::Executor
+{
+public:
+  RCLCPP_SMART_PTR_DEFINITIONS(CyclicExecutor)
+
+  /// Constructor.
+  /**
+   * \param[in] cycle_time period of the cycles, must be positive.
+   * \param[in] options common options for all executors.
+   * \throws std::invalid_argument if cycle_time is not positive.
+   */
+  RCLCPP_PUBLIC
+  explicit CyclicExecutor(
+    std::chrono::nanoseconds cycle_time,
+    const rclcpp::ExecutorOptions & options = rclcpp::ExecutorOptions());
+
+  RCLCPP_PUBLIC
+  virtual ~CyclicExecutor();
+
+  /// Append a step calling the callback of the subscription with the message taken this cycle.
+  /**
+   * \param[in] subscription the subscription, not used with other executors.
+   * \throws std::invalid_argument if subscription is nullptr.
+   * \throws std::runtime_error if the executor is spinning.
+   */
+  RCLCPP_PUBLIC
+  void
+  add_subscription_step(rclcpp::SubscriptionBase::SharedPtr subscription);
+
+  /// Append a step calling the function.
+  /**
+   * \param[in] function the function, called once per cycle.
+   * \throws std::invalid_argument if function is empty.
+   * \throws std::runtime_error if the executor is spinning.
+   */
+  RCLCPP_PUBLIC
+  void
+  add_function_step(std::function<void()> function);
+
+  /// Return the period of the cycles.
+  RCLCPP_PUBLIC
+  std::chrono::nanoseconds
+  get_cycle_time() const;
+
+  /// Return the counters of the cycles executed so far.
+  /**
+   * This member function is thread-safe, the counters are read independently of each other.
+   */
+  RCLCPP_PUBLIC
+  CyclicExecutorStatistics
+  get_statistics() const;
+
+  /// Execute the cycles until canceled or until the context is shut down.
+  /**
+   * The first cycle starts immediately.
+   *
+   * \throws std::runtime_error if the executor is already spinning.
+   */
+  RCLCPP_PUBLIC
+  void
+  spin() override;
+
+  /// Execute one cycle now, without waiting for its start.
+  /**
+   * The following cycles are scheduled from this one.
+   *
+   * \param[in] max_duration unused, the cycle is executed once.
+   * \throws std::runtime_error if the executor is already spinning.
+   */
+  RCLCPP_PUBLIC
+  void
+  spin_some(std::chrono::nanoseconds max_duration = std::chrono::nanoseconds(0)) override;
+
+  /// Execute one cycle now, as spin_some() does.
+  /**
+   * \param[in] max_duration must be positive.
+   * \throws std::invalid_argument if max_duration is not positive.
+   * \throws std::runtime_error if the executor is already spinning.
+   */
+  RCLCPP_PUBLIC
+  void
+  spin_all(std::chrono::nanoseconds max_duration) override;
+
+  /// Not supported, the entities are given in the steps of the schedule.
+  /**
+   * \throws std::runtime_error always.
+   */
+  RCLCPP_PUBLIC
+  void
+  add_callback_group(
+    rclcpp::CallbackGroup::SharedPtr group_ptr,
+    rclcpp::node_interfaces::NodeBaseInterface::SharedPtr node_ptr,
+    bool notify = true) override;
+
+  /// Not supported, the entities are given in the steps of the schedule.
+  /**
+   * \throws std::runtime_error always.
+   */
+  RCLCPP_PUBLIC
+  void
+  add_node(
+    rclcpp::node_interfaces::NodeBaseInterface::SharedPtr node_ptr, bool notify = true) override;
+
+  /// Not supported, the entities are given in the steps of the schedule.
+  /**
+   * \throws std::runtime_error always.
+   */
+  RCLCPP_PUBLIC
+  void
+  add_node(std::shared_ptr<rclcpp::Node> node_ptr, bool notify = true) override;
+
+protected:
+  /// Wait for the start of the next cycle, up to timeout, and execute it.
+  RCLCPP_PUBLIC
+  void
+  spin_once_impl(std::chrono::nanoseconds timeout) override;
+
+private:
+  RCLCPP_DISABLE_COPY(CyclicExecutor)
+
+  /// Step of the schedule, with the input taken for it at the start of the cycle.
+  struct Step
+  {
+    rclcpp::SubscriptionBase::SharedPtr subscription;
+    rclcpp::Waitable::SharedPtr intra_process_waitable;
+    std::function<void()> function;
+
+    std::shared_ptr<void> message;
+    std::shared_ptr<rclcpp::SerializedMessage> serialized_message;
+    rclcpp::MessageInfo message_info;
+    bool message_taken = false;
+    std::shared_ptr<void> intra_process_data;
+  };
+
+  /// The shutdown guard condition and the interrupt guard condition of the executor.
+  using WaitSetType = rclcpp::StaticWaitSet<0, 1, 0, 0, 0, 1>;
+
+  /// Wait until the start of the next cycle or the deadline, whichever comes first.
+  /**
+   * \return true if the cycle starts, false if the deadline passed or the executor stopped.
+   */
+  bool
+  wait_for_cycle_start(std::chrono::steady_clock::time_point deadline);
+
+  /// Execute a cycle, record it, and schedule the next one.
+  void
+  execute_cycle();
+
+  void
+  take_input(Step & step);
+
+  void
+  execute_step(Step & step);
+
+  void
+  throw_if_spinning() const;
+
+  const std::chrono::nanoseconds cycle_time_;
+  std::vector<Step> schedule_;
+  /// Start of the next cycle, unset until the first one.
+  std::chrono::steady_clock::time_point next_cycle_start_{};
+
+  std::atomic<uint64_t> cycles_{0};
+  std::atomic<uint64_t> overruns_{0};
+  std::atomic<int64_t> max_execution_time_ns_{0};
+
+  const rclcpp::Waitable::SharedPtr interrupt_waitable_;
+  WaitSetType wait_set_;
+};
+
+}  // namespace executors
+}  // namespace rclcpp
+
+#endif  // RCLCPP__EXECUTORS__CYCLIC_EXECUTOR_HPP_
@@ -0,0 +1,266 @@
+// Copyright 2021 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__EXECUTORS__EVENTS_EXECUTOR_HPP_
+#define RCLCPP__EXECUTORS__EVENTS_EXECUTOR_HPP_
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "rclcpp/executor.hpp"
+#include "rclcpp/executors/events_queue.hpp"
+#include "rclcpp/executors/static_executor_entities_collector.hpp"
+#include "rclcpp/experimental/timers_manager.hpp"
+#include "rclcpp/macros.hpp"
+#include "rclcpp/node.hpp"
+#include "rclcpp/visibility_control.hpp"
+
+namespace rclcpp
+{
+namespace executors
+{
+
+/// Event-driven single-threaded executor.
+/**
+ * This executor does not collect the entities of its nodes and callback groups
+ * on every iteration.
+ * Entities are collected once, when spinning starts, and then again only when
+ * a node notifies that one of its entities was added or removed, or when a
+ * node or callback group is added to or removed from the executor.
+ * In between, the wait set keeps its size and entities are not looked up
+ * through the callback groups again.
+ *
+ * Every time the wait set wakes up, one ExecutorEvent is pushed into an
+ * EventsQueue for each ready entity.
+ * Events are then popped and dispatched one by one, looking the entity up by
+ * the address of its handle, so the cost of dispatching an event does not
+ * depend on how many entities the executor holds.
+ *
+ * Optionally, the timers with a steady clock are run by a
+ * rclcpp::experimental::TimersManager while spin() is running.
+ * They are then left out of the wait set, and the manager thread sleeps until
+ * the nearest deadline, calls the timers which are due and pushes an event for
+ * each of them, so that their callbacks still run on the executor thread.
+ *
+ * To run this executor instead of SingleThreadedExecutor replace:
+ * rclcpp::executors::SingleThreadedExecutor exec;
+ * by
+ * rclcpp::executors::EventsExecutor exec;
+ * in your source code.
+ */
+class EventsExecutor : public rclcpp::Executor
+{
+public:
+  RCLCPP_SMART_PTR_DEFINITIONS(EventsExecutor)
+
+  /// Default constructor. See the default constructor for Executor.
+  /**
+   * \param[in] options common options for all executors
+   * \param[in] use_timers_manager true to run the steady timers from a TimersManager thread
+   *   while spin() is running, instead of waiting for them in the wait set.
+   * \param[in] timers_manager_resolution tick of the timer wheel of the TimersManager, or 0 to
+   *   keep its timers in a min-heap, see rclcpp::experimental::TimersManager.
+   */
+  RCLCPP_PUBLIC
+  explicit EventsExecutor(
+    const rclcpp::ExecutorOptions & options = rclcpp::ExecutorOptions(),
+    bool use_timers_manager = false,
+    std::chrono::nanoseconds timers_manager_resolution = std::chrono::nanoseconds(0));
+
+  /// Default destructor.
+  RCLCPP_PUBLIC
+  virtual ~EventsExecutor();
+
+  /// Events executor implementation of spin.
+  /**
+   * This function will block until work comes in, execute it, and keep blocking.
+   * It will only be interrupted by a call to cancel() or by ctrl-c.
+   * \throws std::runtime_error when spin() called while already spinning
+   */
+  RCLCPP_PUBLIC
+  void
+  spin() override;
+
+  /// Events executor implementation of spin some.
+  /**
+   * This non-blocking function will execute the entities that were ready when
+   * it was called, until max_duration expires or no more work is available.
+   *
+   * \param[in] max_duration The maximum amount of time to spend executing work,
+   *   or 0 for no limit.
+   */
+  RCLCPP_PUBLIC
+  void
+  spin_some(std::chrono::nanoseconds max_duration = std::chrono::nanoseconds(0)) override;
+
+  /// Events executor implementation of spin all.
+  /**
+   * This non-blocking function will execute entities until max_duration
+   * expires or no more work is available, including entities that became ready
+   * while work was being executed.
+   *
+   * \param[in] max_duration The maximum amount of time to spend executing work.
+   *   Must be positive.
+   */
+  RCLCPP_PUBLIC
+  void
+  spin_all(std::chrono::nanoseconds max_duration) override;
+
+  /// Add a callback group to an executor.
+  /**
+   * \sa rclcpp::Executor::add_callback_group
+   */
+  RCLCPP_PUBLIC
+  void
+  add_callback_group(
+    rclcpp::CallbackGroup::SharedPtr group_ptr,
+    rclcpp::node_interfaces::NodeBaseInterface::SharedPtr node_ptr,
+    bool notify = true) override;
+
+  /// Remove callback group from the executor
+  /**
+   * \sa rclcpp::Executor::remove_callback_group
+   */
+  RCLCPP_PUBLIC
+  void
+  remove_callback_group(
+    rclcpp::CallbackGroup::SharedPtr group_ptr,
+    bool notify = true) override;
+
+  /// Add a node to the executor.
+  /**
+   * \sa rclcpp::Executor::add_node
+   */
+  RCLCPP_PUBLIC
+  void
+  add_node(
+    rclcpp::node_interfaces::NodeBaseInterface::SharedPtr node_ptr,
+    bool notify = true) override;
+
+  /// Convenience function which takes Node and forwards NodeBaseInterface.
+  /**
+   * \sa rclcpp::EventsExecutor::add_node
+   */
+  RCLCPP_PUBLIC
+  void
+  add_node(std::shared_ptr<rclcpp::Node> node_ptr, bool notify = true) override;
+
+  /// Remove a node from the executor.
+  /**
+   * \sa rclcpp::Executor::remove_node
+   */
+  RCLCPP_PUBLIC
+  void
+  remove_node(
+    rclcpp::node_interfaces::NodeBaseInterface::SharedPtr node_ptr,
+    bool notify = true) override;
+
+  /// Convenience function which takes Node and forwards NodeBaseInterface.
+  /**
+   * \sa rclcpp::Executor::remove_node
+   */
+  RCLCPP_PUBLIC
+  void
+  remove_node(std::shared_ptr<rclcpp::Node> node_ptr, bool notify = true) override;
+
+  RCLCPP_PUBLIC
+  std::vector<rclcpp::CallbackGroup::WeakPtr>
+  get_all_callback_groups() override;
+
+  /// Get callback groups that belong to executor.
+  /**
+   * \sa rclcpp::Executor::get_manually_added_callback_groups()
+   */
+  RCLCPP_PUBLIC
+  std::vector<rclcpp::CallbackGroup::WeakPtr>
+  get_manually_added_callback_groups() override;
+
+  /// Get callback groups that belong to executor.
+  /**
+   * \sa rclcpp::Executor::get_automatically_added_callback_groups_from_nodes()
+   */
+  RCLCPP_PUBLIC
+  std::vector<rclcpp::CallbackGroup::WeakPtr>
+  get_automatically_added_callback_groups_from_nodes() override;
+
+protected:
+  /// Wait for ready entities and push one event per ready entity in the queue.
+  /**
+   * \param[in] timeout how long to wait for work, -1 blocks indefinitely.
+   * \return the number of events pushed into the queue.
+   */
+  RCLCPP_PUBLIC
+  size_t
+  wait_for_events(std::chrono::nanoseconds timeout);
+
+  /// Execute the entity an event refers to.
+  /**
+   * \param[in] event the event to dispatch.
+   * \return true if an entity was executed, false if the event was stale.
+   */
+  RCLCPP_PUBLIC
+  bool
+  execute_event(const ExecutorEvent & event);
+
+  RCLCPP_PUBLIC
+  void
+  spin_some_impl(std::chrono::nanoseconds max_duration, bool exhaustive);
+
+  RCLCPP_PUBLIC
+  void
+  spin_once_impl(std::chrono::nanoseconds timeout) override;
+
+private:
+  RCLCPP_DISABLE_COPY(EventsExecutor)
+
+  /// Initialize the entities collector if needed and re-collect if it was invalidated.
+  void
+  refresh_entities();
+
+  /// Rebuild the handle to entity lookup tables from the entities collector.
+  void
+  rebuild_entity_maps();
+
+  /// Mark the collected entities as outdated and optionally wake up the executor.
+  void
+  invalidate_entities(bool notify);
+
+  StaticExecutorEntitiesCollector::SharedPtr entities_collector_;
+
+  EventsQueue events_queue_;
+
+  /// True when the entities have to be collected again before the next wait.
+  std::atomic_bool entities_need_rebuild_{true};
+
+  std::unordered_map<const void *, rclcpp::SubscriptionBase::WeakPtr> subscriptions_;
+  std::unordered_map<const void *, rclcpp::TimerBase::WeakPtr> timers_;
+  std::unordered_map<const void *, rclcpp::ServiceBase::WeakPtr> services_;
+  std::unordered_map<const void *, rclcpp::ClientBase::WeakPtr> clients_;
+  std::unordered_map<const void *, rclcpp::Waitable::WeakPtr> waitables_;
+  std::vector<rclcpp::Waitable::WeakPtr> waitables_list_;
+
+  /// Runs the steady timers while spin() is running, nullptr if not used.
+  rclcpp::experimental::TimersManager::SharedPtr timers_manager_;
+  /// Handles of the timers given to timers_manager_, left out of the wait set while it runs.
+  std::unordered_set<const void *> managed_timers_;
+};
+
+}  // namespace executors
+}  // namespace rclcpp
+
+#endif  // RCLCPP__EXECUTORS__EVENTS_EXECUTOR_HPP_
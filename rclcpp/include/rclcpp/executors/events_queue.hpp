@@ -0,0 +1,126 @@
+// Copyright 2021 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__EXECUTORS__EVENTS_QUEUE_HPP_
+#define RCLCPP__EXECUTORS__EVENTS_QUEUE_HPP_
+
+#include <deque>
+#include <mutex>
+
+#include "rclcpp/macros.hpp"
+
+namespace rclcpp
+{
+namespace executors
+{
+
+/// Kind of entity an ExecutorEvent refers to.
+enum class ExecutorEventType
+{
+  SUBSCRIPTION_EVENT,
+  SERVICE_EVENT,
+  CLIENT_EVENT,
+  TIMER_EVENT,
+  /// A timer which was already called by a TimersManager, only its callback is left to execute.
+  CALLED_TIMER_EVENT,
+  WAITABLE_EVENT
+};
+
+/// Notification that an entity is ready to be executed.
+/**
+ * The entity is identified by an opaque key: the address of its rcl handle
+ * for subscriptions, services, clients and timers, or the address of the
+ * Waitable itself for waitables.
+ * The key is only used for lookup and is never dereferenced, so an event
+ * that outlives its entity is simply discarded by the consumer.
+ */
+struct ExecutorEvent
+{
+  const void * entity_key = nullptr;
+  ExecutorEventType type = ExecutorEventType::WAITABLE_EVENT;
+};
+
+/// Thread-safe FIFO of ExecutorEvent.
+/**
+ * Producers push one event per ready entity and the executor pops them in
+ * order, so dispatching a single event does not depend on the total number of
+ * entities associated with the executor.
+ */
+class EventsQueue
+{
+public:
+  RCLCPP_SMART_PTR_DEFINITIONS_NOT_COPYABLE(EventsQueue)
+
+  EventsQueue() = default;
+
+  /// Push an event at the back of the queue.
+  void
+  push(const ExecutorEvent & event)
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    queue_.push_back(event);
+  }
+
+  /// Pop the event at the front of the queue.
+  /**
+   * \param[out] event the popped event, untouched if the queue was empty.
+   * \return true if an event was popped, false if the queue was empty.
+   */
+  bool
+  pop(ExecutorEvent & event)
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (queue_.empty()) {
+      return false;
+    }
+    event = queue_.front();
+    queue_.pop_front();
+    return true;
+  }
+
+  /// Return true if there are no events in the queue.
+  bool
+  empty() const
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return queue_.empty();
+  }
+
+  /// Return the number of events in the queue.
+  size_t
+  size() const
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return queue_.size();
+  }
+
+  /// Drop all the events in the queue.
+  void
+  clear()
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    queue_.clear();
+  }
+
+private:
+  RCLCPP_DISABLE_COPY(EventsQueue)
+
+  mutable std::mutex mutex_;
+  std::deque<ExecutorEvent> queue_;
+};
+
+}  // namespace executors
+}  // namespace rclcpp
+
+#endif  // RCLCPP__EXECUTORS__EVENTS_QUEUE_HPP_
@@ -15,16 +15,25 @@
 #ifndef RCLCPP__EXECUTORS__MULTI_THREADED_EXECUTOR_HPP_
 #define RCLCPP__EXECUTORS__MULTI_THREADED_EXECUTOR_HPP_
 
+#include <atomic>
 #include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <exception>
 #include <memory>
 #include <mutex>
 #include <set>
 #include <thread>
 #include <unordered_map>
+#include <vector>
 
+#include "rclcpp/any_executable.hpp"
+#include "rclcpp/detail/bounded_mpmc_queue.hpp"
 #include "rclcpp/executor.hpp"
 #include "rclcpp/macros.hpp"
 #include "rclcpp/memory_strategies.hpp"
+#include "rclcpp/numa.hpp"
+#include "rclcpp/thread_attributes.hpp"
 #include "rclcpp/visibility_control.hpp"
 
 namespace rclcpp
@@ -37,6 +46,28 @@ class MultiThreadedExecutor : public rclcpp::Executor
 public:
   RCLCPP_SMART_PTR_DEFINITIONS(MultiThreadedExecutor)
 
+  /// How the threads of the pool find work to execute.
+  enum class SchedulingMode
+  {
+    /// Threads take turns, one at a time, to wait for work and take one executable.
+    SharedWait,
+    /// One thread waits for work and hands off all the ready executables to the other threads.
+    /**
+     * The waiting thread pushes every executable that is ready after a wake up into a
+     * lock-free queue, from which the other threads pop and execute them in parallel.
+     * It then helps executing what is still queued before waiting again.
+     */
+    HandOff,
+    /// Each thread owns a deque of ready executables and steals from the others when idle.
+    /**
+     * An idle thread which finds nothing to steal becomes the one waiting for work, and pushes
+     * every executable that is ready after the wake up into its own deque.
+     * Executables of mutually exclusive callback groups are still handed out one at a time, as
+     * with the other modes, through CallbackGroup::can_be_taken_from().
+     */
+    WorkStealing
+  };
+
   /// Constructor for MultiThreadedExecutor.
   /**
    * For the yield_before_execute option, when true std::this_thread::yield()
@@ -50,13 +81,18 @@ public:
    *   the default 0 will use the number of cpu cores found instead
    * \param yield_before_execute if true std::this_thread::yield() is called
    * \param timeout maximum time to wait
+   * \param scheduling_mode how the threads find work, see SchedulingMode
+   *
+   * Each thread of the pool gets the scheduling attributes of its index in
+   * options.worker_thread_attributes, or else options.thread_attributes.
    */
   RCLCPP_PUBLIC
   MultiThreadedExecutor(
     const rclcpp::ExecutorOptions & options = rclcpp::ExecutorOptions(),
     size_t number_of_threads = 0,
     bool yield_before_execute = false,
-    std::chrono::nanoseconds timeout = std::chrono::nanoseconds(-1));
+    std::chrono::nanoseconds timeout = std::chrono::nanoseconds(-1),
+    SchedulingMode scheduling_mode = SchedulingMode::SharedWait);
 
   RCLCPP_PUBLIC
   virtual ~MultiThreadedExecutor();
@@ -64,6 +100,8 @@ public:
   /**
    * \sa rclcpp::Executor:spin() for more details
    * \throws std::runtime_error when spin() called while already spinning
+   * \throws std::system_error if the attributes of a thread could not be applied, the other
+   *   threads are stopped first.
    */
   RCLCPP_PUBLIC
   void
@@ -73,18 +111,163 @@ public:
   size_t
   get_number_of_threads();
 
+  RCLCPP_PUBLIC
+  SchedulingMode
+  get_scheduling_mode() const;
+
+  /// Only execute the callbacks of a callback group on some of the threads of the pool.
+  /**
+   * The executables of a pinned callback group are queued for the pinned thread with the fewest
+   * executables waiting, other callback groups are still executed by any thread.
+   * This keeps the data touched by the callbacks of a group in the caches of the same cores,
+   * when the threads are also bound to CPUs through ExecutorOptions::worker_thread_attributes.
+   *
+   * \param[in] group the callback group to pin.
+   * \param[in] thread_numbers indices of the threads allowed to execute its callbacks, the last
+   *   thread being the one which calls spin(), or empty to unpin the group.
+   * \throws std::invalid_argument if group is null or a thread number is out of range.
+   * \throws std::runtime_error if called while spinning.
+   */
+  RCLCPP_PUBLIC
+  void
+  pin_callback_group(
+    const rclcpp::CallbackGroup::SharedPtr & group,
+    const std::vector<size_t> & thread_numbers);
+
+  /// Only execute the callbacks of a callback group on the threads bound to a NUMA node.
+  /**
+   * The group is pinned with pin_callback_group() to the threads whose CPU affinity, from
+   * ExecutorOptions::worker_thread_attributes or ExecutorOptions::thread_attributes, only has
+   * CPUs of the node, see rclcpp::make_numa_thread_attributes().
+   * The messages the callbacks take, and the memory they first touch, are then allocated on
+   * the node.
+   *
+   * \param[in] group the callback group to pin.
+   * \param[in] node_id id of the NUMA node.
+   * \param[in] nodes the NUMA nodes of the host.
+   * \throws std::invalid_argument if group is null, the node is unknown or no thread is bound
+   *   to it.
+   * \throws std::runtime_error if called while spinning.
+   */
+  RCLCPP_PUBLIC
+  void
+  pin_callback_group_to_numa_node(
+    const rclcpp::CallbackGroup::SharedPtr & group,
+    size_t node_id,
+    const std::vector<rclcpp::NumaNode> & nodes = rclcpp::get_numa_nodes());
+
+  /// Return the threads a callback group is pinned to, empty if it is not pinned.
+  RCLCPP_PUBLIC
+  std::vector<size_t>
+  get_callback_group_threads(const rclcpp::CallbackGroup::SharedPtr & group) const;
+
 protected:
   RCLCPP_PUBLIC
   void
   run(size_t this_thread_number);
 
+  /// Wait for work and hand off the ready executables, used by SchedulingMode::HandOff.
+  RCLCPP_PUBLIC
+  void
+  run_hand_off_waiter();
+
+  /// Take turns waiting for work, used by SchedulingMode::SharedWait with pinned groups.
+  RCLCPP_PUBLIC
+  void
+  run_shared_wait_with_pinning(size_t this_thread_number);
+
+  /// Execute the executables handed off by the waiting thread, used by SchedulingMode::HandOff.
+  RCLCPP_PUBLIC
+  void
+  run_hand_off_worker(size_t this_thread_number);
+
+  /// Execute, steal or wait for work, used by SchedulingMode::WorkStealing.
+  RCLCPP_PUBLIC
+  void
+  run_work_stealing(size_t this_thread_number);
+
 private:
   RCLCPP_DISABLE_COPY(MultiThreadedExecutor)
 
+  /// Queue an executable for the workers, or execute it right away if the queue is full.
+  void
+  hand_off(rclcpp::AnyExecutable & any_exec);
+
+  /// Execute an executable taken from the queue or from the memory strategy.
+  void
+  execute_taken_executable(rclcpp::AnyExecutable & any_exec);
+
+  /// Pop from the front of the deque of this thread, or else steal from the back of another one.
+  bool
+  pop_or_steal(size_t this_thread_number, rclcpp::AnyExecutable & any_exec);
+
+  /// Wake up the threads sleeping until work is available.
+  void
+  notify_idle_threads();
+
+  /// Queue an executable for one of the threads its callback group is pinned to.
+  /**
+   * \param[in] this_thread_number the thread which took the executable.
+   * \param[in] any_exec the executable, moved from if it was queued.
+   * \param[in] can_execute_here true if this thread is the one to execute the executable when it
+   *   is not queued, so that it is not queued if this thread is one of the pinned threads.
+   * \return true if the executable was queued, false if its group is not pinned or if this
+   *   thread can execute it.
+   */
+  bool
+  dispatch_to_pinned_thread(
+    size_t this_thread_number, rclcpp::AnyExecutable & any_exec, bool can_execute_here);
+
+  /// Pop an executable queued for this thread by dispatch_to_pinned_thread().
+  bool
+  pop_pinned(size_t this_thread_number, rclcpp::AnyExecutable & any_exec);
+
   std::mutex wait_mutex_;
   size_t number_of_threads_;
   bool yield_before_execute_;
   std::chrono::nanoseconds next_exec_timeout_;
+  SchedulingMode scheduling_mode_;
+
+  /// Scheduling attributes of each thread, by thread index.
+  std::vector<rclcpp::ThreadAttributes> thread_attributes_by_index_;
+  /// First error raised while applying the attributes of a spawned thread.
+  std::exception_ptr thread_attributes_error_;
+  std::mutex thread_attributes_error_mutex_;
+
+  /// Executables handed off by the waiting thread, only used by SchedulingMode::HandOff.
+  rclcpp::detail::BoundedMPMCQueue<rclcpp::AnyExecutable> ready_executables_;
+  /// Used by idle workers to sleep until executables are handed off or spinning stops.
+  std::mutex hand_off_mutex_;
+  std::condition_variable hand_off_cv_;
+
+  struct WorkStealingDeque
+  {
+    std::mutex mutex;
+    std::deque<rclcpp::AnyExecutable> executables;
+  };
+
+  /// One deque per thread, only used by SchedulingMode::WorkStealing.
+  std::vector<std::unique_ptr<WorkStealingDeque>> work_stealing_deques_;
+  /// Number of executables in all the deques.
+  std::atomic_size_t work_stealing_queued_{0};
+  /// Incremented every time work may be available, so sleeping threads can tell.
+  std::atomic_size_t idle_generation_{0};
+
+  struct PinnedCallbackGroup
+  {
+    rclcpp::CallbackGroup::WeakPtr group;
+    std::vector<size_t> thread_numbers;
+  };
+
+  /// Callback groups which only run on some threads, only modified while not spinning.
+  std::unordered_map<const rclcpp::CallbackGroup *, PinnedCallbackGroup> pinned_callback_groups_;
+  /// Executables waiting for the thread they are pinned to, by thread index.
+  /**
+   * Guarded by hand_off_mutex_, so idle threads check them in the same wait predicate.
+   */
+  std::vector<std::deque<rclcpp::AnyExecutable>> pinned_executables_;
+  /// Number of executables in all the pinned queues.
+  std::atomic_size_t pinned_queued_{0};
 };
 
 }  // namespace executors
@@ -0,0 +1,134 @@
+// Copyright 2021 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef RCLCPP__EXECUTORS__SHARED_WAITER_HPP_
+#define RCLCPP__EXECUTORS__SHARED_WAITER_HPP_
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "rcl/wait.h"
+
+#include "rclcpp/context.hpp"
+#include "rclcpp/contexts/default_context.hpp"
+#include "rclcpp/guard_condition.hpp"
+#include "rclcpp/macros.hpp"
+#include "rclcpp/visibility_control.hpp"
+
+namespace rclcpp
+{
+namespace executors
+{
+
+/// Thread blocking in a single rcl_wait() on behalf of several executors.
+/**
+ * Executors isolated from one another, e.g. to run subsystems at different priorities, each
+ * block in rcl_wait() on their own wait set, which multiplies the wakeups and the system calls.
+ * Executors given the same waiter in rclcpp::ExecutorOptions::shared_waiter hand their wait set
+ * to its thread instead, which waits on the union of their entities at once.
+ * When some entities are ready, only the executors owning them are woken up, with the ready
+ * entities set in their own wait set as rcl_wait() would have, and they execute the work in
+ * their own thread as usual, so that the callbacks of an executor never run in another thread.
+ * The other executors keep waiting, until their own entities are ready or their timeout expires.
+ *
+ * Non-blocking waits are still made by the executors themselves.
+ * The thread is started by the constructor and stopped by the destructor, which the executors
+ * using the waiter delay by owning it.
+ */
+class SharedWaiter
+{
+public:
+  RCLCPP_SMART_PTR_DEFINITIONS(SharedWaiter)
+
+  /// Create the waiter and start its thread.
+  /**
+   * \param[in] context context of the wait set of the waiter.
+   * \throws rclcpp::exceptions::RCLError if the wait set could not be initialized.
+   */
+  RCLCPP_PUBLIC
+  explicit SharedWaiter(
+    rclcpp::Context::SharedPtr context = rclcpp::contexts::get_global_default_context());
+
+  /// Stop the thread of the waiter.
+  RCLCPP_PUBLIC
+  ~SharedWaiter();
+
+  /// Wait until the entities of a wait set are ready, along with those of the other executors.
+  /**
+   * Blocks the calling thread like rcl_wait() on the wait set, which must not be changed
+   * until this function returns.
+   *
+   * \param[inout] wait_set filled wait set, whose entities which are not ready are set to null.
+   * \param[in] timeout maximum time to wait, negative to wait until an entity is ready.
+   * \return RCL_RET_OK if an entity is ready, or RCL_RET_TIMEOUT.
+   * \throws rclcpp::exceptions::RCLError if the wait failed.
+   */
+  RCLCPP_PUBLIC
+  rcl_ret_t
+  wait(rcl_wait_set_t * wait_set, std::chrono::nanoseconds timeout);
+
+  /// Return the number of times the thread of the waiter returned from rcl_wait().
+  RCLCPP_PUBLIC
+  uint64_t
+  get_wait_count() const;
+
+private:
+  RCLCPP_DISABLE_COPY(SharedWaiter)
+
+  struct Request;
+  /// Slot of an entity of the wait set of a request, in the wait set of the waiter.
+  struct Slot;
+
+  void
+  run_();
+
+  void
+  fill_wait_set_();
+
+  void
+  finish_requests_();
+
+  void
+  fail_requests_(std::exception_ptr error);
+
+  std::mutex mutex_;
+  std::condition_variable requests_changed_;
+  /// Wait sets of the executors waiting, guarded by mutex_.
+  std::vector<Request *> requests_;
+  /// Requests waited on by the thread, only used by it.
+  std::vector<Request *> waited_requests_;
+  /// Entities of the waited requests, only used by the thread.
+  std::vector<Slot> slots_;
+  /// True while the thread is in rcl_wait(), guarded by mutex_.
+  bool in_wait_ = false;
+  bool stop_ = false;
+
+  rclcpp::GuardCondition wake_guard_condition_;
+  rcl_wait_set_t wait_set_ = rcl_get_zero_initialized_wait_set();
+  std::atomic<uint64_t> wait_count_{0};
+  std::thread thread_;
+};
+
+}  // namespace executors
+}  // namespace rclcpp
+
+#endif  // RCLCPP__EXECUTORS__SHARED_WAITER_HPP_
@@ -24,6 +24,7 @@
 #include "rcl/guard_condition.h"
 #include "rcl/wait.h"
 
+#include "rclcpp/executor_options.hpp"
 #include "rclcpp/experimental/executable_list.hpp"
 #include "rclcpp/macros.hpp"
 #include "rclcpp/memory_strategy.hpp"
@@ -58,6 +59,7 @@ public:
    * \param p_wait_set A reference to the wait set to be used in the executor
    * \param memory_strategy Shared pointer to the memory strategy to set.
    * \param executor_guard_condition executor's guard condition
+   * \param wait_set_capacities capacities reserved in the wait set, if any
    * \throws std::runtime_error if memory strategy is null
    */
   RCLCPP_PUBLIC
@@ -65,7 +67,8 @@ public:
   init(
     rcl_wait_set_t * p_wait_set,
     rclcpp::memory_strategy::MemoryStrategy::SharedPtr memory_strategy,
-    rcl_guard_condition_t * executor_guard_condition);
+    rcl_guard_condition_t * executor_guard_condition,
+    const rclcpp::WaitSetCapacities & wait_set_capacities = rclcpp::WaitSetCapacities());
 
   /// Finalize StaticExecutorEntitiesCollector to clear resources
   RCLCPP_PUBLIC
@@ -285,6 +288,51 @@ public:
   rclcpp::Waitable::SharedPtr
   get_waitable(size_t i) {return exec_list_.waitable[i];}
 
+  /// Return the callback group of the subscription at an index, see get_subscription().
+  /**
+   * \param[in] i The index of the subscription
+   * \return the callback group, or nullptr if it was destroyed
+   */
+  RCLCPP_PUBLIC
+  rclcpp::CallbackGroup::SharedPtr
+  get_subscription_callback_group(size_t i) {return subscription_groups_[i].lock();}
+
+  /// Return the callback group of the timer at an index, see get_timer().
+  /**
+   * \param[in] i The index of the timer
+   * \return the callback group, or nullptr if it was destroyed
+   */
+  RCLCPP_PUBLIC
+  rclcpp::CallbackGroup::SharedPtr
+  get_timer_callback_group(size_t i) {return timer_groups_[i].lock();}
+
+  /// Return the callback group of the service at an index, see get_service().
+  /**
+   * \param[in] i The index of the service
+   * \return the callback group, or nullptr if it was destroyed
+   */
+  RCLCPP_PUBLIC
+  rclcpp::CallbackGroup::SharedPtr
+  get_service_callback_group(size_t i) {return service_groups_[i].lock();}
+
+  /// Return the callback group of the client at an index, see get_client().
+  /**
+   * \param[in] i The index of the client
+   * \return the callback group, or nullptr if it was destroyed
+   */
+  RCLCPP_PUBLIC
+  rclcpp::CallbackGroup::SharedPtr
+  get_client_callback_group(size_t i) {return client_groups_[i].lock();}
+
+  /// Return the callback group of the waitable at an index, see get_waitable().
+  /**
+   * \param[in] i The index of the waitable
+   * \return the callback group, or nullptr for the collector itself, which is the last waitable
+   */
+  RCLCPP_PUBLIC
+  rclcpp::CallbackGroup::SharedPtr
+  get_waitable_callback_group(size_t i) {return waitable_groups_[i].lock();}
+
 private:
   /// Function to reallocate space for entities in the wait set.
   /**
@@ -321,9 +369,16 @@ private:
   void
   fill_executable_list_from_map(const WeakCallbackGroupsToNodesMap & weak_groups_to_nodes);
 
+  /// Clear the callback groups of the entities of the executable list.
+  void
+  clear_callback_groups();
+
   /// Memory strategy: an interface for handling user-defined memory allocation strategies.
   rclcpp::memory_strategy::MemoryStrategy::SharedPtr memory_strategy_;
 
+  /// Capacities reserved in the wait set, which is resized if there are none.
+  rclcpp::WaitSetCapacities wait_set_capacities_;
+
   // maps callback groups to nodes.
   WeakCallbackGroupsToNodesMap weak_groups_associated_with_executor_to_nodes_;
   // maps callback groups to nodes.
@@ -344,6 +399,13 @@ private:
   /// Executable list: timers, subscribers, clients, services and waitables
   rclcpp::experimental::ExecutableList exec_list_;
 
+  /// Callback groups of the entities of exec_list_, at the same indices
+  std::vector<rclcpp::CallbackGroup::WeakPtr> subscription_groups_;
+  std::vector<rclcpp::CallbackGroup::WeakPtr> timer_groups_;
+  std::vector<rclcpp::CallbackGroup::WeakPtr> service_groups_;
+  std::vector<rclcpp::CallbackGroup::WeakPtr> client_groups_;
+  std::vector<rclcpp::CallbackGroup::WeakPtr> waitable_groups_;
+
   /// Bool to check if the entities collector has been initialized
   bool initialized_ = false;
 };
@@ -0,0 +1,155 @@
+// Copyright 2021 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__EXECUTORS__STATIC_MULTI_THREADED_EXECUTOR_HPP_
+#define RCLCPP__EXECUTORS__STATIC_MULTI_THREADED_EXECUTOR_HPP_
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <vector>
+
+#include "rclcpp/any_executable.hpp"
+#include "rclcpp/executors/static_single_threaded_executor.hpp"
+#include "rclcpp/macros.hpp"
+#include "rclcpp/thread_attributes.hpp"
+#include "rclcpp/visibility_control.hpp"
+
+namespace rclcpp
+{
+namespace executors
+{
+
+/// Static executor spinning with a pool of threads.
+/**
+ * Like the StaticSingleThreadedExecutor, the executable list is only rebuilt
+ * when entities are added or removed.
+ * During spin(), one thread at a time waits for work, and queues every
+ * executable which is ready after the wait, from which all the threads of the
+ * pool take and execute them in parallel, before waiting again.
+ * Executables of a mutually exclusive callback group are still executed one
+ * at a time, through CallbackGroup::can_be_taken_from().
+ *
+ * spin_some(), spin_all() and spin_once() are the ones of the
+ * StaticSingleThreadedExecutor, they only use the calling thread.
+ *
+ * To run this executor instead of MultiThreadedExecutor replace:
+ * rclcpp::executors::MultiThreadedExecutor exec;
+ * by
+ * rclcpp::executors::StaticMultiThreadedExecutor exec;
+ */
+class StaticMultiThreadedExecutor : public StaticSingleThreadedExecutor
+{
+public:
+  RCLCPP_SMART_PTR_DEFINITIONS(StaticMultiThreadedExecutor)
+
+  /// Constructor for StaticMultiThreadedExecutor.
+  /**
+   * \param options common options for all executors
+   * \param number_of_threads number of threads to have in the thread pool,
+   *   the default 0 will use the number of cpu cores found instead
+   * \param timeout maximum time to wait
+   *
+   * Each thread of the pool gets the scheduling attributes of its index in
+   * options.worker_thread_attributes, or else options.thread_attributes.
+   */
+  RCLCPP_PUBLIC
+  explicit StaticMultiThreadedExecutor(
+    const rclcpp::ExecutorOptions & options = rclcpp::ExecutorOptions(),
+    size_t number_of_threads = 0,
+    std::chrono::nanoseconds timeout = std::chrono::nanoseconds(-1));
+
+  RCLCPP_PUBLIC
+  virtual ~StaticMultiThreadedExecutor();
+
+  /**
+   * \sa rclcpp::Executor:spin() for more details
+   * \throws std::runtime_error when spin() called while already spinning
+   * \throws std::system_error if the attributes of a thread could not be applied, the other
+   *   threads are stopped first.
+   */
+  RCLCPP_PUBLIC
+  void
+  spin() override;
+
+  RCLCPP_PUBLIC
+  size_t
+  get_number_of_threads() const;
+
+protected:
+  RCLCPP_PUBLIC
+  void
+  run();
+
+private:
+  RCLCPP_DISABLE_COPY(StaticMultiThreadedExecutor)
+
+  /// An executable found ready by the last wait, not taken by any thread yet.
+  struct ReadyExecutable
+  {
+    /// The executable, without its callback group until it is taken.
+    rclcpp::AnyExecutable any_exec;
+    rclcpp::CallbackGroup::SharedPtr callback_group;
+  };
+
+  /// Take the first queued executable whose callback group can be taken from.
+  /**
+   * \return false if none was queued or all of them are in busy mutually exclusive groups.
+   */
+  bool
+  take_ready_executable(rclcpp::AnyExecutable & any_exec);
+
+  /// Wait for work and queue the executables which are ready.
+  void
+  wait_for_ready_executables();
+
+  /// Wait for an executable to complete, the queued ones may then be taken.
+  /**
+   * \param[in] completed_executions the number of executions completed before the queued
+   *   executables were found busy.
+   */
+  void
+  wait_for_completed_executable(uint64_t completed_executions);
+
+  /// Notify the thread waiting in wait_for_completed_executable().
+  void
+  notify_completed_executable();
+
+  /// Taken by the thread waiting for work or taking a queued executable.
+  std::mutex wait_mutex_;
+  std::deque<ReadyExecutable> ready_executables_;
+
+  /// Used to wait for busy mutually exclusive callback groups to become available.
+  std::mutex completion_mutex_;
+  std::condition_variable completion_cv_;
+  uint64_t completed_executions_ = 0;
+  size_t executions_in_progress_ = 0;
+
+  size_t number_of_threads_;
+  std::chrono::nanoseconds next_exec_timeout_;
+
+  /// Scheduling attributes of each thread, by thread index.
+  std::vector<rclcpp::ThreadAttributes> thread_attributes_by_index_;
+  /// First error raised while applying the attributes of a spawned thread.
+  std::exception_ptr thread_attributes_error_;
+  std::mutex thread_attributes_error_mutex_;
+};
+
+}  // namespace executors
+}  // namespace rclcpp
+
+#endif  // RCLCPP__EXECUTORS__STATIC_MULTI_THREADED_EXECUTOR_HPP_
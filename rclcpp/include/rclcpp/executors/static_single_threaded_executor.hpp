@@ -24,6 +24,7 @@
 
 #include "rmw/rmw.h"
 
+#include "rclcpp/detail/ready_bitmap.hpp"
 #include "rclcpp/executor.hpp"
 #include "rclcpp/executors/static_executor_entities_collector.hpp"
 #include "rclcpp/experimental/executable_list.hpp"
@@ -202,6 +203,20 @@ protected:
   bool
   execute_ready_executables(bool spin_once = false);
 
+  /// Fold the slots of wait_set_ into the ready bitmaps, after a wait.
+  RCLCPP_PUBLIC
+  void
+  update_ready_bitmaps();
+
+  /// Return true if any waitable may be ready, according to the ready bitmaps.
+  /**
+   * The waitables check their own slots of the wait set, which is skipped when
+   * none of the slots beyond the ones of the executable list is ready.
+   */
+  RCLCPP_PUBLIC
+  bool
+  waitables_may_be_ready() const;
+
   RCLCPP_PUBLIC
   void
   spin_some_impl(std::chrono::nanoseconds max_duration, bool exhaustive);
@@ -210,10 +225,18 @@ protected:
   void
   spin_once_impl(std::chrono::nanoseconds timeout) override;
 
+  StaticExecutorEntitiesCollector::SharedPtr entities_collector_;
+
+  /// Ready slots of wait_set_, updated by update_ready_bitmaps().
+  rclcpp::detail::ReadyBitmap ready_subscriptions_;
+  rclcpp::detail::ReadyBitmap ready_timers_;
+  rclcpp::detail::ReadyBitmap ready_services_;
+  rclcpp::detail::ReadyBitmap ready_clients_;
+  rclcpp::detail::ReadyBitmap ready_guard_conditions_;
+  rclcpp::detail::ReadyBitmap ready_events_;
+
 private:
   RCLCPP_DISABLE_COPY(StaticSingleThreadedExecutor)
-
-  StaticExecutorEntitiesCollector::SharedPtr entities_collector_;
 };
 
 }  // namespace executors
@@ -0,0 +1,411 @@
+// Copyright 2021 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__EXECUTORS__STATIC_WAIT_SET_EXECUTOR_HPP_
+#define RCLCPP__EXECUTORS__STATIC_WAIT_SET_EXECUTOR_HPP_
+
+#include <array>
+#include <chrono>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+#include "rcl/guard_condition.h"
+#include "rcl/wait.h"
+#include "rcpputils/scope_exit.hpp"
+
+#include "rclcpp/client.hpp"
+#include "rclcpp/exceptions.hpp"
+#include "rclcpp/executor.hpp"
+#include "rclcpp/guard_condition.hpp"
+#include "rclcpp/macros.hpp"
+#include "rclcpp/service.hpp"
+#include "rclcpp/subscription_base.hpp"
+#include "rclcpp/thread_attributes.hpp"
+#include "rclcpp/timer.hpp"
+#include "rclcpp/utilities.hpp"
+#include "rclcpp/wait_set.hpp"
+#include "rclcpp/waitable.hpp"
+
+namespace rclcpp
+{
+namespace executors
+{
+namespace detail
+{
+
+/// Waitable which only adds a rcl guard condition of an executor to the wait set.
+/**
+ * Used to wait on the interrupt guard condition of the executor, which is not
+ * a rclcpp::GuardCondition, from a static wait set.
+ */
+class ExecutorGuardConditionWaitable : public rclcpp::Waitable
+{
+public:
+  explicit ExecutorGuardConditionWaitable(const rcl_guard_condition_t * guard_condition)
+  : guard_condition_(guard_condition)
+  {}
+
+  size_t
+  get_number_of_ready_guard_conditions() override
+  {
+    return 1u;
+  }
+
+  bool
+  add_to_wait_set(rcl_wait_set_t * wait_set) override
+  {
+    rcl_ret_t ret = rcl_wait_set_add_guard_condition(wait_set, guard_condition_, nullptr);
+    if (RCL_RET_OK != ret) {
+      rclcpp::exceptions::throw_from_rcl_error(ret, "failed to add guard condition to wait set");
+    }
+    return true;
+  }
+
+  /// Never ready, the guard condition only wakes up the wait.
+  bool
+  is_ready(rcl_wait_set_t *) override
+  {
+    return false;
+  }
+
+  std::shared_ptr<void>
+  take_data() override
+  {
+    return nullptr;
+  }
+
+  void
+  execute(std::shared_ptr<void> & data) override
+  {
+    (void)data;
+  }
+
+private:
+  const rcl_guard_condition_t * guard_condition_;
+};
+
+}  // namespace detail
+
+/// Single-threaded executor over a rclcpp::StaticWaitSet sized at compile time.
+/**
+ * The entities are given once at construction and their numbers are template
+ * parameters, so the wait set is allocated once and is never resized or
+ * collected again, and no memory is allocated by spinning besides what the
+ * entities themselves allocate.
+ * This is meant for deployments with a fixed topology, like embedded systems.
+ *
+ * Nodes and callback groups cannot be added to this executor, the entities
+ * are executed in the order of their kind and of their index, without
+ * considering their callback groups.
+ * The timers are executed first, then the subscriptions, services, clients and
+ * waitables.
+ * Subscriptions using intra-process communication also need their
+ * intra-process waitable to be given with the waitables.
+ *
+ * The shutdown guard condition and the interrupt guard condition of the
+ * executor are added to the wait set, so that shutting down the context and
+ * cancel() wake up the executor.
+ */
+template<
+  std::size_t NumberOfSubscriptions,
+  std::size_t NumberOfGuardConditions,
+  std::size_t NumberOfTimers,
+  std::size_t NumberOfClients,
+  std::size_t NumberOfServices,
+  std::size_t NumberOfWaitables
+>
+class StaticWaitSetExecutor : public rclcpp::Executor
+{
+public:
+  RCLCPP_SMART_PTR_DEFINITIONS(StaticWaitSetExecutor)
+
+  using SubscriptionsArray =
+    std::array<rclcpp::SubscriptionBase::SharedPtr, NumberOfSubscriptions>;
+  using GuardConditionsArray =
+    std::array<rclcpp::GuardCondition::SharedPtr, NumberOfGuardConditions>;
+  using TimersArray = std::array<rclcpp::TimerBase::SharedPtr, NumberOfTimers>;
+  using ClientsArray = std::array<rclcpp::ClientBase::SharedPtr, NumberOfClients>;
+  using ServicesArray = std::array<rclcpp::ServiceBase::SharedPtr, NumberOfServices>;
+  using WaitablesArray = std::array<rclcpp::Waitable::SharedPtr, NumberOfWaitables>;
+
+  /// The wait set, with the guard conditions and the waitable of the executor.
+  using WaitSetType = rclcpp::StaticWaitSet<
+    NumberOfSubscriptions,
+    NumberOfGuardConditions + 1,
+    NumberOfTimers,
+    NumberOfClients,
+    NumberOfServices,
+    NumberOfWaitables + 1
+  >;
+
+  /// Constructor.
+  /**
+   * \param[in] subscriptions subscriptions to execute.
+   * \param[in] guard_conditions guard conditions which wake up the executor.
+   * \param[in] timers timers to execute.
+   * \param[in] clients clients to execute.
+   * \param[in] services services to execute.
+   * \param[in] waitables waitables to execute.
+   * \param[in] options common options for all executors.
+   * \throws std::invalid_argument if one of the entities is nullptr.
+   */
+  explicit StaticWaitSetExecutor(
+    const SubscriptionsArray & subscriptions = {},
+    const GuardConditionsArray & guard_conditions = {},
+    const TimersArray & timers = {},
+    const ClientsArray & clients = {},
+    const ServicesArray & services = {},
+    const WaitablesArray & waitables = {},
+    const rclcpp::ExecutorOptions & options = rclcpp::ExecutorOptions())
+  : rclcpp::Executor(options),
+    subscriptions_(check_entities(subscriptions, "subscription")),
+    timers_(check_entities(timers, "timer")),
+    clients_(check_entities(clients, "client")),
+    services_(check_entities(services, "service")),
+    waitables_(check_entities(waitables, "waitable")),
+    interrupt_waitable_(
+      std::make_shared<detail::ExecutorGuardConditionWaitable>(&interrupt_guard_condition_)),
+    wait_set_(
+      make_subscription_entries(subscriptions_),
+      make_guard_conditions(check_entities(guard_conditions, "guard condition")),
+      timers_,
+      clients_,
+      services_,
+      make_waitable_entries(waitables_),
+      options.context)
+  {}
+
+  virtual ~StaticWaitSetExecutor() = default;
+
+  /// Execute the ready entities until canceled or until the context is shut down.
+  void
+  spin() override
+  {
+    if (spinning.exchange(true)) {
+      throw std::runtime_error("spin() called while already spinning");
+    }
+    RCPPUTILS_SCOPE_EXIT(this->spinning.store(false); );
+    rclcpp::ScopedThreadAttributes thread_attributes(thread_attributes_);
+    while (rclcpp::ok(this->context_) && spinning.load()) {
+      execute_ready_entities(std::chrono::nanoseconds(-1));
+    }
+  }
+
+  /// Execute the entities which are ready now, without waiting.
+  /**
+   * \param[in] max_duration unused, all the ready entities are executed once.
+   */
+  void
+  spin_some(std::chrono::nanoseconds max_duration = std::chrono::nanoseconds(0)) override
+  {
+    (void)max_duration;
+    if (spinning.exchange(true)) {
+      throw std::runtime_error("spin_some() called while already spinning");
+    }
+    RCPPUTILS_SCOPE_EXIT(this->spinning.store(false); );
+    if (rclcpp::ok(this->context_)) {
+      execute_ready_entities(std::chrono::nanoseconds(0));
+    }
+  }
+
+  /// Execute the ready entities until none is ready or max_duration has passed.
+  /**
+   * \param[in] max_duration the maximum time to spin for, must be positive.
+   * \throws std::invalid_argument if max_duration is not positive.
+   */
+  void
+  spin_all(std::chrono::nanoseconds max_duration) override
+  {
+    if (max_duration <= std::chrono::nanoseconds(0)) {
+      throw std::invalid_argument("max_duration must be positive");
+    }
+    if (spinning.exchange(true)) {
+      throw std::runtime_error("spin_all() called while already spinning");
+    }
+    RCPPUTILS_SCOPE_EXIT(this->spinning.store(false); );
+    const auto start = std::chrono::steady_clock::now();
+    while (rclcpp::ok(this->context_) && spinning.load() &&
+      std::chrono::steady_clock::now() - start < max_duration)
+    {
+      if (!execute_ready_entities(std::chrono::nanoseconds(0))) {
+        break;
+      }
+    }
+  }
+
+  /// Not supported, the entities are given at construction.
+  /**
+   * \throws std::runtime_error always.
+   */
+  void
+  add_callback_group(
+    rclcpp::CallbackGroup::SharedPtr group_ptr,
+    rclcpp::node_interfaces::NodeBaseInterface::SharedPtr node_ptr,
+    bool notify = true) override
+  {
+    (void)group_ptr;
+    (void)node_ptr;
+    (void)notify;
+    throw_entities_are_fixed();
+  }
+
+  /// Not supported, the entities are given at construction.
+  /**
+   * \throws std::runtime_error always.
+   */
+  void
+  add_node(
+    rclcpp::node_interfaces::NodeBaseInterface::SharedPtr node_ptr, bool notify = true) override
+  {
+    (void)node_ptr;
+    (void)notify;
+    throw_entities_are_fixed();
+  }
+
+  /// Not supported, the entities are given at construction.
+  /**
+   * \throws std::runtime_error always.
+   */
+  void
+  add_node(std::shared_ptr<rclcpp::Node> node_ptr, bool notify = true) override
+  {
+    (void)node_ptr;
+    (void)notify;
+    throw_entities_are_fixed();
+  }
+
+protected:
+  void
+  spin_once_impl(std::chrono::nanoseconds timeout) override
+  {
+    execute_ready_entities(timeout);
+  }
+
+  /// Wait for the entities to be ready, then execute all the ready ones.
+  /**
+   * \param[in] timeout how long to wait, -1 to block until an entity is ready.
+   * \return true if an entity was executed.
+   */
+  bool
+  execute_ready_entities(std::chrono::nanoseconds timeout)
+  {
+    auto wait_result = wait_set_.wait(timeout);
+    if (wait_result.kind() != rclcpp::WaitResultKind::Ready) {
+      return false;
+    }
+    // The static storage adds every entity in the order of the arrays, before the entities of the
+    // waitables, so the slots of the wait set match the indices of the arrays.
+    auto & rcl_wait_set = const_cast<rcl_wait_set_t &>(wait_set_.get_rcl_wait_set());
+    bool executed = false;
+    for (size_t i = 0; i < NumberOfTimers; ++i) {
+      if (rcl_wait_set.timers[i] && timers_[i]->call()) {
+        execute_timer(timers_[i]);
+        executed = true;
+      }
+    }
+    for (size_t i = 0; i < NumberOfSubscriptions; ++i) {
+      if (rcl_wait_set.subscriptions[i]) {
+        execute_subscription(subscriptions_[i]);
+        executed = true;
+      }
+    }
+    for (size_t i = 0; i < NumberOfServices; ++i) {
+      if (rcl_wait_set.services[i]) {
+        execute_service(services_[i]);
+        executed = true;
+      }
+    }
+    for (size_t i = 0; i < NumberOfClients; ++i) {
+      if (rcl_wait_set.clients[i]) {
+        execute_client(clients_[i]);
+        executed = true;
+      }
+    }
+    for (size_t i = 0; i < NumberOfWaitables; ++i) {
+      if (waitables_[i]->is_ready(&rcl_wait_set)) {
+        auto data = waitables_[i]->take_data();
+        waitables_[i]->execute(data);
+        executed = true;
+      }
+    }
+    return executed;
+  }
+
+private:
+  RCLCPP_DISABLE_COPY(StaticWaitSetExecutor)
+
+  template<typename ArrayT>
+  static const ArrayT &
+  check_entities(const ArrayT & entities, const char * kind)
+  {
+    for (const auto & entity : entities) {
+      if (!entity) {
+        throw std::invalid_argument(std::string("the ") + kind + " is nullptr");
+      }
+    }
+    return entities;
+  }
+
+  static std::array<typename WaitSetType::SubscriptionEntry, NumberOfSubscriptions>
+  make_subscription_entries(const SubscriptionsArray & subscriptions)
+  {
+    std::array<typename WaitSetType::SubscriptionEntry, NumberOfSubscriptions> entries;
+    for (size_t i = 0; i < NumberOfSubscriptions; ++i) {
+      entries[i] = subscriptions[i];
+    }
+    return entries;
+  }
+
+  std::array<rclcpp::GuardCondition::SharedPtr, NumberOfGuardConditions + 1>
+  make_guard_conditions(const GuardConditionsArray & guard_conditions) const
+  {
+    std::array<rclcpp::GuardCondition::SharedPtr, NumberOfGuardConditions + 1> all;
+    for (size_t i = 0; i < NumberOfGuardConditions; ++i) {
+      all[i] = guard_conditions[i];
+    }
+    all[NumberOfGuardConditions] = shutdown_guard_condition_;
+    return all;
+  }
+
+  std::array<typename WaitSetType::WaitableEntry, NumberOfWaitables + 1>
+  make_waitable_entries(const WaitablesArray & waitables) const
+  {
+    std::array<typename WaitSetType::WaitableEntry, NumberOfWaitables + 1> entries;
+    for (size_t i = 0; i < NumberOfWaitables; ++i) {
+      entries[i] = waitables[i];
+    }
+    entries[NumberOfWaitables] = interrupt_waitable_;
+    return entries;
+  }
+
+  [[noreturn]] static void
+  throw_entities_are_fixed()
+  {
+    throw std::runtime_error("the entities of a StaticWaitSetExecutor are given at construction");
+  }
+
+  const SubscriptionsArray subscriptions_;
+  const TimersArray timers_;
+  const ClientsArray clients_;
+  const ServicesArray services_;
+  const WaitablesArray waitables_;
+  const rclcpp::Waitable::SharedPtr interrupt_waitable_;
+  WaitSetType wait_set_;
+};
+
+}  // namespace executors
+}  // namespace rclcpp
+
+#endif  // RCLCPP__EXECUTORS__STATIC_WAIT_SET_EXECUTOR_HPP_
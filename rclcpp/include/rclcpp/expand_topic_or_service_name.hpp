@@ -35,7 +35,8 @@ namespace rclcpp
  * The node name and namespace are used to expand it if necessary while
  * validating it.
  *
- * Expansion is done with rcl_expand_topic_name.
+ * Expansion is done with rcl_expand_topic_name, except for the fully
+ * qualified names without substitution, which are left as is.
  * The validation is doen with rcl_validate_topic_name and
  * rmw_validate_full_topic_name, so details about failures can be found in the
  * documentation for those functions.
@@ -15,6 +15,10 @@
 #ifndef RCLCPP__EXPERIMENTAL__BUFFERS__BUFFER_IMPLEMENTATION_BASE_HPP_
 #define RCLCPP__EXPERIMENTAL__BUFFERS__BUFFER_IMPLEMENTATION_BASE_HPP_
 
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
 namespace rclcpp
 {
 namespace experimental
@@ -22,6 +26,31 @@ namespace experimental
 namespace buffers
 {
 
+/// Counters of the elements which went through a buffer, see StatisticsBufferImplementation.
+struct BufferStatistics
+{
+  /// True if the buffer collects statistics, all the counters stay at zero otherwise.
+  bool enabled = false;
+  /// Number of elements enqueued.
+  uint64_t enqueued_count = 0;
+  /// Number of elements dequeued.
+  uint64_t dequeued_count = 0;
+  /// Number of elements dropped because they were overwritten while the buffer was full.
+  /**
+   * For an intraprocess subscription, it includes the messages it dropped instead,
+   * see rclcpp::SubscriptionOptionsBase::intra_process_drop_new_when_full.
+   */
+  uint64_t dropped_count = 0;
+  /// Number of elements currently stored.
+  size_t size = 0;
+  /// Largest number of elements stored at the same time.
+  size_t high_water_mark = 0;
+  /// Sum of the time the dequeued elements spent in the buffer.
+  std::chrono::nanoseconds total_time_in_queue{0};
+  /// Longest time a dequeued element spent in the buffer.
+  std::chrono::nanoseconds max_time_in_queue{0};
+};
+
 template<typename BufferT>
 class BufferImplementationBase
 {
@@ -33,6 +62,18 @@ public:
 
   virtual void clear() = 0;
   virtual bool has_data() const = 0;
+
+  /// Return true if enqueuing an element now would drop or block, false if it is unknown.
+  virtual bool is_full() const
+  {
+    return false;
+  }
+
+  /// Return the statistics of the buffer, disabled unless the buffer collects them.
+  virtual BufferStatistics get_statistics() const
+  {
+    return BufferStatistics();
+  }
 };
 
 }  // namespace buffers
@@ -15,12 +15,15 @@
 #ifndef RCLCPP__EXPERIMENTAL__BUFFERS__INTRA_PROCESS_BUFFER_HPP_
 #define RCLCPP__EXPERIMENTAL__BUFFERS__INTRA_PROCESS_BUFFER_HPP_
 
+#include <atomic>
 #include <memory>
 #include <type_traits>
 #include <utility>
 
 #include "rclcpp/allocator/allocator_common.hpp"
 #include "rclcpp/allocator/allocator_deleter.hpp"
+#include "rclcpp/detail/extended_tracepoints.hpp"
+#include "rclcpp/detail/releasable_shared_message.hpp"
 #include "rclcpp/experimental/buffers/buffer_implementation_base.hpp"
 #include "rclcpp/macros.hpp"
 
@@ -41,7 +44,11 @@ public:
   virtual void clear() = 0;
 
   virtual bool has_data() const = 0;
+  /// Return true if adding a message now would drop the oldest one or block.
+  virtual bool is_full() const = 0;
   virtual bool use_take_shared_method() const = 0;
+
+  virtual BufferStatistics get_statistics() const = 0;
 };
 
 template<
@@ -63,6 +70,46 @@ public:
 
   virtual MessageSharedPtr consume_shared() = 0;
   virtual MessageUniquePtr consume_unique() = 0;
+
+  /// Return true if add_shared() keeps the message shared until it is consumed, without a copy.
+  /**
+   * The buffers of unique messages copy a shared message when it is added,
+   * unless they store messages in both forms.
+   */
+  virtual bool stores_shared_messages() const
+  {
+    return false;
+  }
+};
+
+/// Element of a buffer storing each message in the form it was added in.
+/**
+ * A message added shared stays shared until it is consumed, so that it is
+ * only copied if it is consumed as unique while still shared with others, and
+ * its content is moved instead if the other owners released it meanwhile.
+ * A message added unique stays unique, and is promoted without a copy if it
+ * is consumed as shared.
+ */
+template<
+  typename MessageT,
+  typename MessageDeleter = std::default_delete<MessageT>>
+struct IntraProcessMessage
+{
+  IntraProcessMessage() = default;
+
+  /// Conversion constructor from a unique message, which is intentionally not marked explicit.
+  IntraProcessMessage(std::unique_ptr<MessageT, MessageDeleter> unique_msg_in)  // NOLINT
+  : unique_msg(std::move(unique_msg_in))
+  {}
+
+  /// Conversion constructor from a shared message, which is intentionally not marked explicit.
+  IntraProcessMessage(std::shared_ptr<const MessageT> shared_msg_in)  // NOLINT
+  : shared_msg(std::move(shared_msg_in))
+  {}
+
+  /// Only one of them is set.
+  std::unique_ptr<MessageT, MessageDeleter> unique_msg;
+  std::shared_ptr<const MessageT> shared_msg;
 };
 
 template<
@@ -79,6 +126,7 @@ public:
   using MessageAlloc = typename MessageAllocTraits::allocator_type;
   using MessageUniquePtr = std::unique_ptr<MessageT, MessageDeleter>;
   using MessageSharedPtr = std::shared_ptr<const MessageT>;
+  using StoredMessage = IntraProcessMessage<MessageT, MessageDeleter>;
 
   explicit
   TypedIntraProcessBuffer(
@@ -86,12 +134,17 @@ public:
     std::shared_ptr<Alloc> allocator = nullptr)
   {
     bool valid_type = (std::is_same<BufferT, MessageSharedPtr>::value ||
-      std::is_same<BufferT, MessageUniquePtr>::value);
+      std::is_same<BufferT, MessageUniquePtr>::value ||
+      std::is_same<BufferT, StoredMessage>::value);
     if (!valid_type) {
       throw std::runtime_error("Creating TypedIntraProcessBuffer with not valid BufferT");
     }
 
     buffer_ = std::move(buffer_impl);
+    RCLCPP_EXTENDED_TRACEPOINT(
+      rclcpp_buffer_to_ipb,
+      static_cast<const void *>(buffer_.get()),
+      static_cast<const void *>(this));
 
     if (!allocator) {
       message_allocator_ = std::make_shared<MessageAlloc>();
@@ -109,6 +162,7 @@ public:
 
   void add_unique(MessageUniquePtr msg) override
   {
+    // Promoted to shared by the shared buffers.
     buffer_->enqueue(std::move(msg));
   }
 
@@ -127,6 +181,11 @@ public:
     return buffer_->has_data();
   }
 
+  bool is_full() const override
+  {
+    return buffer_->is_full();
+  }
+
   void clear() override
   {
     buffer_->clear();
@@ -137,6 +196,16 @@ public:
     return std::is_same<BufferT, MessageSharedPtr>::value;
   }
 
+  bool stores_shared_messages() const override
+  {
+    return !std::is_same<BufferT, MessageUniquePtr>::value;
+  }
+
+  BufferStatistics get_statistics() const override
+  {
+    return buffer_->get_statistics();
+  }
+
 private:
   std::unique_ptr<BufferImplementationBase<BufferT>> buffer_;
 
@@ -161,18 +230,18 @@ private:
   {
     // This should not happen: here a copy is unconditionally made, while the intra-process manager
     // can decide whether a copy is needed depending on the number and the type of buffers
+    buffer_->enqueue(unique_from_shared(std::move(shared_msg)));
+  }
 
-    MessageUniquePtr unique_msg;
-    MessageDeleter * deleter = std::get_deleter<MessageDeleter, const MessageT>(shared_msg);
-    auto ptr = MessageAllocTraits::allocate(*message_allocator_.get(), 1);
-    MessageAllocTraits::construct(*message_allocator_.get(), ptr, *shared_msg);
-    if (deleter) {
-      unique_msg = MessageUniquePtr(ptr, *deleter);
-    } else {
-      unique_msg = MessageUniquePtr(ptr);
-    }
-
-    buffer_->enqueue(std::move(unique_msg));
+  // MessageSharedPtr to StoredMessage
+  template<typename DestinationT>
+  typename std::enable_if<
+    std::is_same<DestinationT, StoredMessage>::value
+  >::type
+  add_shared_impl(MessageSharedPtr shared_msg)
+  {
+    // Kept shared, it is only copied if still shared when consumed as unique.
+    buffer_->enqueue(StoredMessage(std::move(shared_msg)));
   }
 
   // MessageSharedPtr to MessageSharedPtr
@@ -198,6 +267,21 @@ private:
     return buffer_->dequeue();
   }
 
+  // StoredMessage to MessageSharedPtr
+  template<typename OriginT>
+  typename std::enable_if<
+    (std::is_same<OriginT, StoredMessage>::value),
+    MessageSharedPtr
+  >::type
+  consume_shared_impl()
+  {
+    StoredMessage buffer_msg = buffer_->dequeue();
+    if (buffer_msg.unique_msg) {
+      return std::move(buffer_msg.unique_msg);
+    }
+    return std::move(buffer_msg.shared_msg);
+  }
+
   // MessageSharedPtr to MessageUniquePtr
   template<typename OriginT>
   typename std::enable_if<
@@ -206,12 +290,45 @@ private:
   >::type
   consume_unique_impl()
   {
-    MessageSharedPtr buffer_msg = buffer_->dequeue();
+    return unique_from_shared(buffer_->dequeue());
+  }
+
+  // StoredMessage to MessageUniquePtr
+  template<typename OriginT>
+  typename std::enable_if<
+    (std::is_same<OriginT, StoredMessage>::value),
+    MessageUniquePtr
+  >::type
+  consume_unique_impl()
+  {
+    StoredMessage buffer_msg = buffer_->dequeue();
+    if (buffer_msg.unique_msg) {
+      return std::move(buffer_msg.unique_msg);
+    }
+    return unique_from_shared(std::move(buffer_msg.shared_msg));
+  }
 
-    MessageUniquePtr unique_msg;
+  // Return a unique message with the content of a shared one, moved if it is no longer shared.
+  MessageUniquePtr
+  unique_from_shared(MessageSharedPtr buffer_msg)
+  {
+    // Shared by the intra process manager from a unique message, it is taken back as is.
+    MessageUniquePtr unique_msg =
+      rclcpp::detail::try_release_shared_message<MessageT, MessageDeleter>(buffer_msg);
+    if (unique_msg) {
+      return unique_msg;
+    }
     MessageDeleter * deleter = std::get_deleter<MessageDeleter, const MessageT>(buffer_msg);
     auto ptr = MessageAllocTraits::allocate(*message_allocator_.get(), 1);
-    MessageAllocTraits::construct(*message_allocator_.get(), ptr, *buffer_msg);
+    if (buffer_msg.use_count() == 1) {
+      // Nobody else shares the message anymore, its content can be moved instead of copied.
+      // Synchronize with the release of the message by the other threads which shared it.
+      std::atomic_thread_fence(std::memory_order_acquire);
+      MessageAllocTraits::construct(
+        *message_allocator_.get(), ptr, std::move(*const_cast<MessageT *>(buffer_msg.get())));
+    } else {
+      MessageAllocTraits::construct(*message_allocator_.get(), ptr, *buffer_msg);
+    }
     if (deleter) {
       unique_msg = MessageUniquePtr(ptr, *deleter);
     } else {
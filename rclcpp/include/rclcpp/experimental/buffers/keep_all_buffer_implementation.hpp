@@ -0,0 +1,288 @@
+// Copyright 2021 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__EXPERIMENTAL__BUFFERS__KEEP_ALL_BUFFER_IMPLEMENTATION_HPP_
+#define RCLCPP__EXPERIMENTAL__BUFFERS__KEEP_ALL_BUFFER_IMPLEMENTATION_HPP_
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "rclcpp/exceptions/exceptions.hpp"
+#include "rclcpp/experimental/buffers/buffer_implementation_base.hpp"
+#include "rclcpp/intra_process_keep_all_options.hpp"
+#include "rclcpp/logger.hpp"
+#include "rclcpp/logging.hpp"
+#include "rclcpp/macros.hpp"
+
+namespace rclcpp
+{
+namespace experimental
+{
+namespace buffers
+{
+
+/// Store elements in a FIFO buffer growing up to a maximum size, for a keep all history
+/**
+ * The storage is a ring which doubles its capacity when it is full, up to the
+ * maximum number of messages of the options, and is kept once grown, so that
+ * a buffer which reached its working size no longer allocates.
+ * When the maximum size is reached, enqueue() blocks, throws or drops the
+ * oldest element according to the backpressure policy of the options.
+ *
+ * The buffer collects its own statistics if requested, rather than being
+ * wrapped in a StatisticsBufferImplementation, which would keep its mutex
+ * locked while a publisher blocks.
+ *
+ * All public member functions are thread-safe.
+ */
+template<typename BufferT>
+class KeepAllBufferImplementation : public BufferImplementationBase<BufferT>
+{
+public:
+  /// Create an empty buffer.
+  /**
+   * \param[in] options maximum size and backpressure policy of the buffer.
+   * \param[in] collect_statistics true to collect the statistics of the buffer.
+   * \throws std::invalid_argument if the maximum size is 0 or the blocking time is negative.
+   */
+  explicit KeepAllBufferImplementation(
+    const rclcpp::IntraProcessKeepAllOptions & options,
+    bool collect_statistics = false)
+  : options_(options),
+    read_index_(0),
+    size_(0)
+  {
+    if (options.max_messages == 0) {
+      throw std::invalid_argument("max_messages must be a positive, non-zero value");
+    }
+    if (options.max_blocking_time < std::chrono::nanoseconds(0)) {
+      throw std::invalid_argument("max_blocking_time must not be negative");
+    }
+    statistics_.enabled = collect_statistics;
+    storage_.resize(std::min(options_.max_messages, initial_capacity));
+  }
+
+  virtual ~KeepAllBufferImplementation() {}
+
+  /// Add a new element to the buffer, applying the backpressure policy if it is full
+  /**
+   * This member function is thread-safe.
+   *
+   * \param request the element to be stored in the buffer
+   * \throws rclcpp::exceptions::IntraProcessBufferFullError if the buffer is full
+   *   with the Fail policy, or stayed full for the maximum blocking time with the Block policy.
+   */
+  void enqueue(BufferT request) override
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    if (size_ == options_.max_messages) {
+      switch (options_.backpressure) {
+        case rclcpp::IntraProcessBackpressurePolicy::DropOldest:
+          drop_oldest_();
+          break;
+        case rclcpp::IntraProcessBackpressurePolicy::Block:
+          if (
+            !not_full_.wait_for(
+              lock, options_.max_blocking_time,
+              [this]() {return size_ < options_.max_messages;}))
+          {
+            throw_full_();
+          }
+          break;
+        case rclcpp::IntraProcessBackpressurePolicy::Fail:
+        default:
+          throw_full_();
+      }
+    }
+    if (size_ == storage_.size()) {
+      grow_();
+    }
+
+    Entry & entry = storage_[index_(size_)];
+    entry.request = std::move(request);
+    ++size_;
+    if (statistics_.enabled) {
+      entry.enqueue_time = std::chrono::steady_clock::now();
+      ++statistics_.enqueued_count;
+      statistics_.size = size_;
+      statistics_.high_water_mark = std::max(statistics_.high_water_mark, size_);
+    }
+  }
+
+  /// Remove the oldest element from the buffer, waking up a blocked publisher
+  /**
+   * This member function is thread-safe.
+   *
+   * \return the element that is being removed from the buffer
+   */
+  BufferT dequeue() override
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    if (size_ == 0) {
+      RCLCPP_ERROR(rclcpp::get_logger("rclcpp"), "Calling dequeue on empty intra-process buffer");
+      throw std::runtime_error("Calling dequeue on empty intra-process buffer");
+    }
+
+    Entry & entry = storage_[read_index_];
+    BufferT request = std::move(entry.request);
+    entry.request = BufferT();
+    if (statistics_.enabled) {
+      const auto time_in_queue = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - entry.enqueue_time);
+      ++statistics_.dequeued_count;
+      statistics_.size = size_ - 1;
+      statistics_.total_time_in_queue += time_in_queue;
+      statistics_.max_time_in_queue = std::max(statistics_.max_time_in_queue, time_in_queue);
+    }
+    read_index_ = index_(1);
+    --size_;
+
+    lock.unlock();
+    if (options_.backpressure == rclcpp::IntraProcessBackpressurePolicy::Block) {
+      not_full_.notify_one();
+    }
+    return request;
+  }
+
+  /// Drop all the elements of the buffer, waking up the blocked publishers
+  void clear() override
+  {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      for (size_t i = 0; i < size_; ++i) {
+        storage_[index_(i)].request = BufferT();
+      }
+      read_index_ = 0;
+      size_ = 0;
+      statistics_.size = 0;
+    }
+    not_full_.notify_all();
+  }
+
+  bool has_data() const override
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return size_ != 0;
+  }
+
+  /// Return true if the buffer holds its maximum number of elements
+  bool is_full() const override
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return size_ == options_.max_messages;
+  }
+
+  /// Return the number of elements stored
+  size_t size() const
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return size_;
+  }
+
+  /// Return the number of elements the buffer can store before it grows again
+  size_t capacity() const
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return storage_.size();
+  }
+
+  /// Return a copy of the statistics collected since the buffer was created
+  BufferStatistics get_statistics() const override
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return statistics_;
+  }
+
+private:
+  RCLCPP_DISABLE_COPY(KeepAllBufferImplementation)
+
+  /// Elements stored by a buffer which has not grown yet.
+  static constexpr size_t initial_capacity = 16;
+
+  struct Entry
+  {
+    BufferT request;
+    std::chrono::steady_clock::time_point enqueue_time;
+  };
+
+  /// Get the index of the element at the given position from the oldest one
+  /**
+   * This member function is not thread-safe.
+   */
+  inline size_t index_(size_t position) const
+  {
+    const size_t index = read_index_ + position;
+    return index < storage_.size() ? index : index - storage_.size();
+  }
+
+  /// Double the capacity of the full storage, up to the maximum size
+  /**
+   * This member function is not thread-safe.
+   */
+  void grow_()
+  {
+    std::vector<Entry> storage(std::min(options_.max_messages, 2 * storage_.size()));
+    for (size_t i = 0; i < size_; ++i) {
+      storage[i] = std::move(storage_[index_(i)]);
+    }
+    storage_.swap(storage);
+    read_index_ = 0;
+  }
+
+  /// Drop the oldest element of the buffer
+  /**
+   * This member function is not thread-safe.
+   */
+  void drop_oldest_()
+  {
+    storage_[read_index_].request = BufferT();
+    read_index_ = index_(1);
+    --size_;
+    if (statistics_.enabled) {
+      ++statistics_.dropped_count;
+    }
+  }
+
+  [[noreturn]] void throw_full_() const
+  {
+    throw rclcpp::exceptions::IntraProcessBufferFullError(
+            "intra-process buffer is full with " + std::to_string(size_) + " messages");
+  }
+
+  const rclcpp::IntraProcessKeepAllOptions options_;
+
+  std::vector<Entry> storage_;
+  size_t read_index_;
+  size_t size_;
+
+  BufferStatistics statistics_;
+
+  mutable std::mutex mutex_;
+  std::condition_variable not_full_;
+};
+
+}  // namespace buffers
+}  // namespace experimental
+}  // namespace rclcpp
+
+#endif  // RCLCPP__EXPERIMENTAL__BUFFERS__KEEP_ALL_BUFFER_IMPLEMENTATION_HPP_
@@ -0,0 +1,220 @@
+// Copyright 2021 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__EXPERIMENTAL__BUFFERS__LOCK_FREE_MULTI_PRODUCER_RING_BUFFER_IMPLEMENTATION_HPP_
+#define RCLCPP__EXPERIMENTAL__BUFFERS__LOCK_FREE_MULTI_PRODUCER_RING_BUFFER_IMPLEMENTATION_HPP_
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+
+#include "rclcpp/experimental/buffers/buffer_implementation_base.hpp"
+#include "rclcpp/logger.hpp"
+#include "rclcpp/logging.hpp"
+#include "rclcpp/macros.hpp"
+#include "rclcpp/visibility_control.hpp"
+
+namespace rclcpp
+{
+namespace experimental
+{
+namespace buffers
+{
+
+/// Store elements in a fixed-size, FIFO buffer without locking, for several enqueuing threads
+/**
+ * It behaves like RingBufferImplementation, enqueuing in a full buffer drops
+ * the oldest element, and all public member functions are thread-safe.
+ * Unlike LockFreeRingBufferImplementation, several threads may enqueue at the
+ * same time, each one claiming a slot by incrementing the write index.
+ *
+ * The slots are allocated in a power of two number to index them with a mask,
+ * and each slot carries a sequence number telling whether it holds an element,
+ * so that an enqueuing thread can drop the oldest element while another
+ * thread dequeues it.
+ */
+template<typename BufferT>
+class LockFreeMultiProducerRingBufferImplementation : public BufferImplementationBase<BufferT>
+{
+public:
+  explicit LockFreeMultiProducerRingBufferImplementation(size_t capacity)
+  : capacity_(capacity)
+  {
+    if (capacity == 0) {
+      throw std::invalid_argument("capacity must be a positive, non-zero value");
+    }
+    size_t number_of_slots = 1u;
+    while (number_of_slots < capacity) {
+      number_of_slots <<= 1u;
+    }
+    mask_ = number_of_slots - 1u;
+    slots_.reset(new Slot[number_of_slots]);
+    for (size_t i = 0; i < number_of_slots; ++i) {
+      slots_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+    write_index_.store(0u, std::memory_order_relaxed);
+    read_index_.store(0u, std::memory_order_relaxed);
+  }
+
+  virtual ~LockFreeMultiProducerRingBufferImplementation() {}
+
+  /// Add a new element to store in the ring buffer
+  /**
+   * This member function is thread-safe.
+   *
+   * \param request the element to be stored in the ring buffer
+   */
+  void enqueue(BufferT request)
+  {
+    size_t write_index = write_index_.load(std::memory_order_relaxed);
+    while (true) {
+      const size_t read_index = read_index_.load(std::memory_order_acquire);
+      if (write_index < read_index) {
+        // Other threads enqueued and dequeued since the write index was loaded.
+        write_index = write_index_.load(std::memory_order_relaxed);
+        continue;
+      }
+      if (write_index - read_index >= capacity_) {
+        // Drop the oldest element, unless it is dequeued in the meantime or not written yet.
+        BufferT dropped_request;
+        if (!try_dequeue_(dropped_request)) {
+          std::this_thread::yield();
+        }
+        write_index = write_index_.load(std::memory_order_relaxed);
+        continue;
+      }
+      // The buffer cannot become fuller for this index, the read index only grows.
+      if (write_index_.compare_exchange_weak(
+          write_index, write_index + 1u, std::memory_order_acq_rel, std::memory_order_relaxed))
+      {
+        break;
+      }
+    }
+
+    Slot & slot = slots_[write_index & mask_];
+    // A dequeue which claimed this slot in the previous lap may still be moving the element out.
+    while (slot.sequence.load(std::memory_order_acquire) != write_index) {
+      std::this_thread::yield();
+    }
+    slot.data = std::move(request);
+    slot.sequence.store(write_index + 1u, std::memory_order_release);
+  }
+
+  /// Remove the oldest element from ring buffer
+  /**
+   * This member function is thread-safe.
+   *
+   * \return the element that is being removed from the ring buffer
+   */
+  BufferT dequeue()
+  {
+    BufferT request;
+    // An element may be enqueued but not written yet, wait for it.
+    while (!try_dequeue_(request)) {
+      if (!has_data()) {
+        RCLCPP_ERROR(
+          rclcpp::get_logger("rclcpp"), "Calling dequeue on empty intra-process buffer");
+        throw std::runtime_error("Calling dequeue on empty intra-process buffer");
+      }
+      std::this_thread::yield();
+    }
+    return request;
+  }
+
+  /// Get if the ring buffer has at least one element stored
+  /**
+   * This member function is thread-safe.
+   *
+   * \return `true` if there is data and `false` otherwise
+   */
+  inline bool has_data() const
+  {
+    return write_index_.load(std::memory_order_acquire) !=
+           read_index_.load(std::memory_order_acquire);
+  }
+
+  /// Get if the size of the buffer is equal to its capacity
+  /**
+   * This member function is thread-safe.
+   *
+   * \return `true` if the size of the buffer is equal is capacity
+   * and `false` otherwise
+   */
+  inline bool is_full() const
+  {
+    const size_t read_index = read_index_.load(std::memory_order_acquire);
+    return write_index_.load(std::memory_order_acquire) - read_index >= capacity_;
+  }
+
+  void clear()
+  {
+    BufferT request;
+    while (has_data()) {
+      try_dequeue_(request);
+    }
+  }
+
+private:
+  RCLCPP_DISABLE_COPY(LockFreeMultiProducerRingBufferImplementation)
+
+  /// Try once to move the oldest element out of the ring buffer
+  /**
+   * This member function is thread-safe.
+   *
+   * \param[out] request the element removed from the ring buffer, untouched on failure
+   * \return `false` if the buffer is empty or another thread removed the oldest element first
+   */
+  bool try_dequeue_(BufferT & request)
+  {
+    size_t read_index = read_index_.load(std::memory_order_relaxed);
+    Slot & slot = slots_[read_index & mask_];
+    if (slot.sequence.load(std::memory_order_acquire) != read_index + 1u) {
+      // Nothing was written in this slot yet, or it was dequeued by another thread.
+      return false;
+    }
+    if (!read_index_.compare_exchange_strong(read_index, read_index + 1u,
+      std::memory_order_acq_rel))
+    {
+      return false;
+    }
+    request = std::move(slot.data);
+    slot.data = BufferT();
+    slot.sequence.store(read_index + mask_ + 1u, std::memory_order_release);
+    return true;
+  }
+
+  struct Slot
+  {
+    std::atomic<size_t> sequence;
+    BufferT data;
+  };
+
+  size_t capacity_;
+  size_t mask_;
+  std::unique_ptr<Slot[]> slots_;
+
+  // The enqueuing and dequeuing threads each update their own index, keep them on separate
+  // cache lines.
+  alignas(64) std::atomic<size_t> write_index_;
+  alignas(64) std::atomic<size_t> read_index_;
+};
+
+}  // namespace buffers
+}  // namespace experimental
+}  // namespace rclcpp
+
+#endif  // RCLCPP__EXPERIMENTAL__BUFFERS__LOCK_FREE_MULTI_PRODUCER_RING_BUFFER_IMPLEMENTATION_HPP_
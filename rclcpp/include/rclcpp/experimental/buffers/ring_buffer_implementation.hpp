@@ -24,6 +24,7 @@
 #include <utility>
 #include <vector>
 
+#include "rclcpp/detail/extended_tracepoints.hpp"
 #include "rclcpp/experimental/buffers/buffer_implementation_base.hpp"
 #include "rclcpp/logger.hpp"
 #include "rclcpp/logging.hpp"
@@ -55,6 +56,8 @@ public:
     if (capacity == 0) {
       throw std::invalid_argument("capacity must be a positive, non-zero value");
     }
+    RCLCPP_EXTENDED_TRACEPOINT(
+      rclcpp_construct_ring_buffer, static_cast<const void *>(this), capacity_);
   }
 
   virtual ~RingBufferImplementation() {}
@@ -72,11 +75,15 @@ public:
     write_index_ = next_(write_index_);
     ring_buffer_[write_index_] = std::move(request);
 
-    if (is_full_()) {
+    const bool overwritten = is_full_();
+    if (overwritten) {
       read_index_ = next_(read_index_);
     } else {
       size_++;
     }
+    RCLCPP_EXTENDED_TRACEPOINT(
+      rclcpp_ring_buffer_enqueue, static_cast<const void *>(this), write_index_, size_,
+      overwritten);
   }
 
   /// Remove the oldest element from ring buffer
@@ -95,6 +102,8 @@ public:
     }
 
     auto request = std::move(ring_buffer_[read_index_]);
+    RCLCPP_EXTENDED_TRACEPOINT(
+      rclcpp_ring_buffer_dequeue, static_cast<const void *>(this), read_index_, size_ - 1);
     read_index_ = next_(read_index_);
 
     size_--;
@@ -140,7 +149,10 @@ public:
     return is_full_();
   }
 
-  void clear() {}
+  void clear()
+  {
+    RCLCPP_EXTENDED_TRACEPOINT(rclcpp_ring_buffer_clear, static_cast<const void *>(this));
+  }
 
 private:
   /// Get the next index value for the ring buffer
@@ -152,7 +164,7 @@ private:
    */
   inline size_t next_(size_t val)
   {
-    return (val + 1) % capacity_;
+    return (val + 1 == capacity_) ? 0 : val + 1;
   }
 
   /// Get if the ring buffer has at least one element stored
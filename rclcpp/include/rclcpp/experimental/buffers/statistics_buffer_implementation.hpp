@@ -0,0 +1,178 @@
+// Copyright 2021 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__EXPERIMENTAL__BUFFERS__STATISTICS_BUFFER_IMPLEMENTATION_HPP_
+#define RCLCPP__EXPERIMENTAL__BUFFERS__STATISTICS_BUFFER_IMPLEMENTATION_HPP_
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "rclcpp/experimental/buffers/buffer_implementation_base.hpp"
+#include "rclcpp/macros.hpp"
+
+namespace rclcpp
+{
+namespace experimental
+{
+namespace buffers
+{
+
+/// Collect the statistics of another fixed-size, FIFO buffer
+/**
+ * The wrapped buffer is expected to drop its oldest element when an element
+ * is enqueued while it holds capacity elements, like RingBufferImplementation.
+ * The time each element spends in the buffer is tracked in a ring of
+ * enqueue times following the elements of the wrapped buffer.
+ *
+ * All public member functions are thread-safe, they are serialized by a mutex
+ * also around the calls to the wrapped buffer, which makes the lock-free
+ * buffers lock.
+ */
+template<typename BufferT>
+class StatisticsBufferImplementation : public BufferImplementationBase<BufferT>
+{
+public:
+  StatisticsBufferImplementation(
+    std::unique_ptr<BufferImplementationBase<BufferT>> buffer_impl,
+    size_t capacity)
+  : buffer_impl_(std::move(buffer_impl)),
+    capacity_(capacity),
+    enqueue_times_(capacity),
+    write_index_(0),
+    read_index_(0)
+  {
+    if (!buffer_impl_) {
+      throw std::invalid_argument("buffer implementation must not be null");
+    }
+    if (capacity == 0) {
+      throw std::invalid_argument("capacity must be a positive, non-zero value");
+    }
+    statistics_.enabled = true;
+  }
+
+  virtual ~StatisticsBufferImplementation() {}
+
+  /// Add a new element to the wrapped buffer, counting the element it drops if it is full
+  /**
+   * This member function is thread-safe.
+   *
+   * \param request the element to be stored in the buffer
+   */
+  void enqueue(BufferT request) override
+  {
+    const auto now = std::chrono::steady_clock::now();
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    buffer_impl_->enqueue(std::move(request));
+
+    ++statistics_.enqueued_count;
+    if (statistics_.size == capacity_) {
+      // The oldest element was overwritten.
+      ++statistics_.dropped_count;
+      read_index_ = next_(read_index_);
+    } else {
+      ++statistics_.size;
+      statistics_.high_water_mark = std::max(statistics_.high_water_mark, statistics_.size);
+    }
+    enqueue_times_[write_index_] = now;
+    write_index_ = next_(write_index_);
+  }
+
+  /// Remove the oldest element from the wrapped buffer, measuring the time it was stored
+  /**
+   * This member function is thread-safe.
+   *
+   * \return the element that is being removed from the buffer
+   */
+  BufferT dequeue() override
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    // Throws, without changing the statistics, if the buffer is empty.
+    BufferT request = buffer_impl_->dequeue();
+
+    const auto time_in_queue = std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now() - enqueue_times_[read_index_]);
+    read_index_ = next_(read_index_);
+    --statistics_.size;
+    ++statistics_.dequeued_count;
+    statistics_.total_time_in_queue += time_in_queue;
+    statistics_.max_time_in_queue = std::max(statistics_.max_time_in_queue, time_in_queue);
+
+    return request;
+  }
+
+  void clear() override
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    buffer_impl_->clear();
+    if (!buffer_impl_->has_data()) {
+      statistics_.size = 0;
+      read_index_ = write_index_;
+    }
+  }
+
+  bool has_data() const override
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return buffer_impl_->has_data();
+  }
+
+  bool is_full() const override
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return buffer_impl_->is_full();
+  }
+
+  /// Return a copy of the statistics collected since the buffer was created
+  /**
+   * This member function is thread-safe.
+   */
+  BufferStatistics get_statistics() const override
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return statistics_;
+  }
+
+private:
+  RCLCPP_DISABLE_COPY(StatisticsBufferImplementation)
+
+  inline size_t next_(size_t val) const
+  {
+    return (val + 1 == capacity_) ? 0 : val + 1;
+  }
+
+  std::unique_ptr<BufferImplementationBase<BufferT>> buffer_impl_;
+  size_t capacity_;
+
+  std::vector<std::chrono::steady_clock::time_point> enqueue_times_;
+  size_t write_index_;
+  size_t read_index_;
+
+  BufferStatistics statistics_;
+
+  mutable std::mutex mutex_;
+};
+
+}  // namespace buffers
+}  // namespace experimental
+}  // namespace rclcpp
+
+#endif  // RCLCPP__EXPERIMENTAL__BUFFERS__STATISTICS_BUFFER_IMPLEMENTATION_HPP_
@@ -0,0 +1,114 @@
+// Copyright 2021 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#ifndef RCLCPP__EXPERIMENTAL__CLIENT_INTRA_PROCESS_HPP_
+#define RCLCPP__EXPERIMENTAL__CLIENT_INTRA_PROCESS_HPP_
+
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <utility>
+
+#include "rmw/types.h"
+
+#include "rclcpp/context.hpp"
+#include "rclcpp/experimental/client_intra_process_base.hpp"
+#include "rclcpp/macros.hpp"
+
+namespace rclcpp
+{
+namespace experimental
+{
+
+/// Intra-process part of a client, executing the responses of intra-process services.
+template<typename ServiceT>
+class ClientIntraProcess : public ClientIntraProcessBase
+{
+public:
+  RCLCPP_SMART_PTR_DEFINITIONS(ClientIntraProcess)
+
+  using SharedResponse = typename ServiceT::Response::SharedPtr;
+
+  /// Callback handling a response, with the sequence number of its request in the header.
+  using ResponseCallback =
+    std::function<void (std::shared_ptr<rmw_request_id_t>, SharedResponse)>;
+
+  ClientIntraProcess(
+    rclcpp::Context::SharedPtr context,
+    ResponseCallback callback)
+  : ClientIntraProcessBase(context), callback_(std::move(callback))
+  {}
+
+  virtual ~ClientIntraProcess() = default;
+
+  /// Queue the response to the request with the given sequence number.
+  /**
+   * The response is handed over by pointer, without being copied.
+   * This member function is thread-safe.
+   */
+  void
+  store_intra_process_response(int64_t sequence_number, SharedResponse response)
+  {
+    {
+      std::lock_guard<std::mutex> lock(responses_mutex_);
+      responses_.emplace_back(sequence_number, std::move(response));
+    }
+    trigger_guard_condition();
+  }
+
+  bool
+  is_ready(rcl_wait_set_t * wait_set) override
+  {
+    (void) wait_set;
+    std::lock_guard<std::mutex> lock(responses_mutex_);
+    return !responses_.empty();
+  }
+
+  std::shared_ptr<void>
+  take_data() override
+  {
+    std::lock_guard<std::mutex> lock(responses_mutex_);
+    if (responses_.empty()) {
+      return nullptr;
+    }
+    auto response = std::make_shared<PendingResponse>(std::move(responses_.front()));
+    responses_.pop_front();
+    return response;
+  }
+
+  void
+  execute(std::shared_ptr<void> & data) override
+  {
+    if (!data) {
+      throw std::runtime_error("'data' is empty");
+    }
+    auto pending_response = std::static_pointer_cast<PendingResponse>(data);
+    auto request_header = std::make_shared<rmw_request_id_t>();
+    request_header->sequence_number = pending_response->first;
+    callback_(request_header, std::move(pending_response->second));
+  }
+
+private:
+  using PendingResponse = std::pair<int64_t, SharedResponse>;
+
+  ResponseCallback callback_;
+  std::deque<PendingResponse> responses_;
+  std::mutex responses_mutex_;
+};
+
+}  // namespace experimental
+}  // namespace rclcpp
+
+#endif  // RCLCPP__EXPERIMENTAL__CLIENT_INTRA_PROCESS_HPP_
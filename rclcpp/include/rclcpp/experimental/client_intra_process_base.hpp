@@ -0,0 +1,66 @@
+// Copyright 2021 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__EXPERIMENTAL__CLIENT_INTRA_PROCESS_BASE_HPP_
+#define RCLCPP__EXPERIMENTAL__CLIENT_INTRA_PROCESS_BASE_HPP_
+
+#include <memory>
+#include <mutex>
+
+#include "rcl/guard_condition.h"
+#include "rcl/wait.h"
+
+#include "rclcpp/context.hpp"
+#include "rclcpp/macros.hpp"
+#include "rclcpp/visibility_control.hpp"
+#include "rclcpp/waitable.hpp"
+
+namespace rclcpp
+{
+namespace experimental
+{
+
+/// Waitable through which a client receives the responses of intra-process services.
+class ClientIntraProcessBase : public rclcpp::Waitable
+{
+public:
+  RCLCPP_SMART_PTR_ALIASES_ONLY(ClientIntraProcessBase)
+
+  RCLCPP_PUBLIC
+  explicit ClientIntraProcessBase(rclcpp::Context::SharedPtr context);
+
+  RCLCPP_PUBLIC
+  virtual ~ClientIntraProcessBase();
+
+  RCLCPP_PUBLIC
+  size_t
+  get_number_of_ready_guard_conditions() override {return 1;}
+
+  RCLCPP_PUBLIC
+  bool
+  add_to_wait_set(rcl_wait_set_t * wait_set) override;
+
+protected:
+  RCLCPP_PUBLIC
+  void
+  trigger_guard_condition();
+
+  std::recursive_mutex reentrant_mutex_;
+  rcl_guard_condition_t gc_;
+};
+
+}  // namespace experimental
+}  // namespace rclcpp
+
+#endif  // RCLCPP__EXPERIMENTAL__CLIENT_INTRA_PROCESS_BASE_HPP_
@@ -22,8 +22,13 @@
 #include "rcl/subscription.h"
 
 #include "rclcpp/experimental/buffers/intra_process_buffer.hpp"
+#include "rclcpp/experimental/buffers/keep_all_buffer_implementation.hpp"
+#include "rclcpp/experimental/buffers/lock_free_multi_producer_ring_buffer_implementation.hpp"
+#include "rclcpp/experimental/buffers/lock_free_ring_buffer_implementation.hpp"
 #include "rclcpp/experimental/buffers/ring_buffer_implementation.hpp"
+#include "rclcpp/experimental/buffers/statistics_buffer_implementation.hpp"
 #include "rclcpp/intra_process_buffer_type.hpp"
+#include "rclcpp/intra_process_keep_all_options.hpp"
 #include "rclcpp/qos.hpp"
 
 namespace rclcpp
@@ -31,6 +36,60 @@ namespace rclcpp
 namespace experimental
 {
 
+namespace detail
+{
+
+/// Wrap the buffer implementation to collect its statistics, if requested.
+template<typename BufferT>
+std::unique_ptr<rclcpp::experimental::buffers::BufferImplementationBase<BufferT>>
+collect_buffer_statistics(
+  std::unique_ptr<rclcpp::experimental::buffers::BufferImplementationBase<BufferT>> buffer_impl,
+  size_t buffer_size,
+  bool collect_statistics)
+{
+  if (!collect_statistics) {
+    return buffer_impl;
+  }
+  return std::make_unique<rclcpp::experimental::buffers::StatisticsBufferImplementation<BufferT>>(
+    std::move(buffer_impl),
+    buffer_size);
+}
+
+/// Create the growable buffer of a keep all history, storing elements of the given type.
+template<
+  typename MessageT,
+  typename Alloc,
+  typename Deleter,
+  typename BufferT>
+typename rclcpp::experimental::buffers::IntraProcessBuffer<MessageT, Alloc, Deleter>::UniquePtr
+create_keep_all_intra_process_buffer(
+  const rclcpp::IntraProcessKeepAllOptions & keep_all_options,
+  std::shared_ptr<Alloc> allocator,
+  bool collect_statistics)
+{
+  auto buffer_implementation =
+    std::make_unique<rclcpp::experimental::buffers::KeepAllBufferImplementation<BufferT>>(
+    keep_all_options, collect_statistics);
+
+  return std::make_unique<rclcpp::experimental::buffers::TypedIntraProcessBuffer<MessageT, Alloc,
+           Deleter, BufferT>>(std::move(buffer_implementation), allocator);
+}
+
+}  // namespace detail
+
+/// Create the intra-process buffer of a subscription.
+/**
+ * A keep all history gets a rclcpp::experimental::buffers::KeepAllBufferImplementation,
+ * storing shared or owned messages as the buffer type does.
+ *
+ * \param buffer_type the type of the elements stored and the implementation of the buffer.
+ * \param qos the history depth of which is the capacity of the buffer, for a keep last history.
+ * \param allocator the allocator used to copy the messages.
+ * \param collect_statistics true to collect the buffer statistics, see
+ *   rclcpp::experimental::buffers::StatisticsBufferImplementation.
+ * \param keep_all_options maximum size and backpressure policy of the buffer of a keep
+ *   all history.
+ */
 template<
   typename MessageT,
   typename Alloc = std::allocator<void>,
@@ -39,10 +98,33 @@ typename rclcpp::experimental::buffers::IntraProcessBuffer<MessageT, Alloc, Dele
 create_intra_process_buffer(
   IntraProcessBufferType buffer_type,
   const rclcpp::QoS & qos,
-  std::shared_ptr<Alloc> allocator)
+  std::shared_ptr<Alloc> allocator,
+  bool collect_statistics = false,
+  const rclcpp::IntraProcessKeepAllOptions & keep_all_options =
+  rclcpp::IntraProcessKeepAllOptions())
 {
   using MessageSharedPtr = std::shared_ptr<const MessageT>;
-  using MessageUniquePtr = std::unique_ptr<MessageT, Deleter>;
+  // The buffers of owning subscriptions keep the shared messages shared until they are taken.
+  using MessageStorageT = rclcpp::experimental::buffers::IntraProcessMessage<MessageT, Deleter>;
+
+  if (qos.history() == rclcpp::HistoryPolicy::KeepAll) {
+    switch (buffer_type) {
+      case IntraProcessBufferType::SharedPtr:
+      case IntraProcessBufferType::LockFreeSharedPtr:
+      case IntraProcessBufferType::LockFreeMultiProducerSharedPtr:
+        return detail::create_keep_all_intra_process_buffer<
+          MessageT, Alloc, Deleter, MessageSharedPtr>(
+          keep_all_options, allocator, collect_statistics);
+      case IntraProcessBufferType::UniquePtr:
+      case IntraProcessBufferType::LockFreeUniquePtr:
+      case IntraProcessBufferType::LockFreeMultiProducerUniquePtr:
+        return detail::create_keep_all_intra_process_buffer<
+          MessageT, Alloc, Deleter, MessageStorageT>(
+          keep_all_options, allocator, collect_statistics);
+      default:
+        throw std::runtime_error("Unrecognized IntraProcessBufferType value");
+    }
+  }
 
   size_t buffer_size = qos.depth();
 
@@ -62,14 +144,15 @@ create_intra_process_buffer(
         buffer =
           std::make_unique<rclcpp::experimental::buffers::TypedIntraProcessBuffer<MessageT, Alloc,
             Deleter, BufferT>>(
-          std::move(buffer_implementation),
+          detail::collect_buffer_statistics<BufferT>(
+            std::move(buffer_implementation), buffer_size, collect_statistics),
           allocator);
 
         break;
       }
     case IntraProcessBufferType::UniquePtr:
       {
-        using BufferT = MessageUniquePtr;
+        using BufferT = MessageStorageT;
 
         auto buffer_implementation =
           std::make_unique<rclcpp::experimental::buffers::RingBufferImplementation<BufferT>>(
@@ -79,7 +162,80 @@ create_intra_process_buffer(
         buffer =
           std::make_unique<rclcpp::experimental::buffers::TypedIntraProcessBuffer<MessageT, Alloc,
             Deleter, BufferT>>(
-          std::move(buffer_implementation),
+          detail::collect_buffer_statistics<BufferT>(
+            std::move(buffer_implementation), buffer_size, collect_statistics),
+          allocator);
+
+        break;
+      }
+    case IntraProcessBufferType::LockFreeSharedPtr:
+      {
+        using BufferT = MessageSharedPtr;
+
+        auto buffer_implementation =
+          std::make_unique<rclcpp::experimental::buffers::LockFreeRingBufferImplementation<
+              BufferT>>(buffer_size);
+
+        // Construct the intra_process_buffer
+        buffer =
+          std::make_unique<rclcpp::experimental::buffers::TypedIntraProcessBuffer<MessageT, Alloc,
+            Deleter, BufferT>>(
+          detail::collect_buffer_statistics<BufferT>(
+            std::move(buffer_implementation), buffer_size, collect_statistics),
+          allocator);
+
+        break;
+      }
+    case IntraProcessBufferType::LockFreeUniquePtr:
+      {
+        using BufferT = MessageStorageT;
+
+        auto buffer_implementation =
+          std::make_unique<rclcpp::experimental::buffers::LockFreeRingBufferImplementation<
+              BufferT>>(buffer_size);
+
+        // Construct the intra_process_buffer
+        buffer =
+          std::make_unique<rclcpp::experimental::buffers::TypedIntraProcessBuffer<MessageT, Alloc,
+            Deleter, BufferT>>(
+          detail::collect_buffer_statistics<BufferT>(
+            std::move(buffer_implementation), buffer_size, collect_statistics),
+          allocator);
+
+        break;
+      }
+    case IntraProcessBufferType::LockFreeMultiProducerSharedPtr:
+      {
+        using BufferT = MessageSharedPtr;
+
+        auto buffer_implementation = std::make_unique<
+          rclcpp::experimental::buffers::LockFreeMultiProducerRingBufferImplementation<BufferT>>(
+          buffer_size);
+
+        // Construct the intra_process_buffer
+        buffer =
+          std::make_unique<rclcpp::experimental::buffers::TypedIntraProcessBuffer<MessageT, Alloc,
+            Deleter, BufferT>>(
+          detail::collect_buffer_statistics<BufferT>(
+            std::move(buffer_implementation), buffer_size, collect_statistics),
+          allocator);
+
+        break;
+      }
+    case IntraProcessBufferType::LockFreeMultiProducerUniquePtr:
+      {
+        using BufferT = MessageStorageT;
+
+        auto buffer_implementation = std::make_unique<
+          rclcpp::experimental::buffers::LockFreeMultiProducerRingBufferImplementation<BufferT>>(
+          buffer_size);
+
+        // Construct the intra_process_buffer
+        buffer =
+          std::make_unique<rclcpp::experimental::buffers::TypedIntraProcessBuffer<MessageT, Alloc,
+            Deleter, BufferT>>(
+          detail::collect_buffer_statistics<BufferT>(
+            std::move(buffer_implementation), buffer_size, collect_statistics),
           allocator);
 
         break;
@@ -0,0 +1,97 @@
+// Copyright 2021 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#ifndef RCLCPP__EXPERIMENTAL__GENERIC_SUBSCRIPTION_INTRA_PROCESS_HPP_
+#define RCLCPP__EXPERIMENTAL__GENERIC_SUBSCRIPTION_INTRA_PROCESS_HPP_
+
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#include "rclcpp/context.hpp"
+#include "rclcpp/experimental/subscription_intra_process_buffer.hpp"
+#include "rclcpp/intra_process_buffer_type.hpp"
+#include "rclcpp/intra_process_keep_all_options.hpp"
+#include "rclcpp/macros.hpp"
+#include "rclcpp/qos.hpp"
+#include "rclcpp/serialized_message.hpp"
+
+namespace rclcpp
+{
+namespace experimental
+{
+
+/// Intra-process part of a GenericSubscription, receiving serialized messages by pointer.
+/**
+ * It only communicates with the publishers of serialized messages, i.e.
+ * rclcpp::GenericPublisher, as the messages are neither serialized nor
+ * deserialized intra-process.
+ */
+class GenericSubscriptionIntraProcess
+  : public SubscriptionIntraProcessBuffer<rclcpp::SerializedMessage>
+{
+public:
+  RCLCPP_SMART_PTR_DEFINITIONS(GenericSubscriptionIntraProcess)
+
+  using CallbackT = std::function<void (std::shared_ptr<rclcpp::SerializedMessage>)>;
+
+  GenericSubscriptionIntraProcess(
+    CallbackT callback,
+    rclcpp::Context::SharedPtr context,
+    const std::string & topic_name,
+    const rclcpp::QoS & qos_profile,
+    rclcpp::IntraProcessBufferType buffer_type,
+    const rclcpp::IntraProcessKeepAllOptions & keep_all_options =
+    rclcpp::IntraProcessKeepAllOptions())
+  : SubscriptionIntraProcessBuffer<rclcpp::SerializedMessage>(
+      std::make_shared<std::allocator<void>>(),
+      context,
+      topic_name,
+      qos_profile,
+      buffer_type,
+      false,
+      false,
+      keep_all_options),
+    callback_(std::move(callback))
+  {}
+
+  virtual ~GenericSubscriptionIntraProcess() = default;
+
+  std::shared_ptr<void>
+  take_data() override
+  {
+    // The callback takes a mutable message, so it gets one it owns.
+    std::shared_ptr<rclcpp::SerializedMessage> message(this->buffer_->consume_unique());
+    this->rearm_guard_condition();
+    return message;
+  }
+
+  void
+  execute(std::shared_ptr<void> & data) override
+  {
+    if (!data) {
+      throw std::runtime_error("'data' is empty");
+    }
+    callback_(std::static_pointer_cast<rclcpp::SerializedMessage>(data));
+  }
+
+private:
+  CallbackT callback_;
+};
+
+}  // namespace experimental
+}  // namespace rclcpp
+
+#endif  // RCLCPP__EXPERIMENTAL__GENERIC_SUBSCRIPTION_INTRA_PROCESS_HPP_
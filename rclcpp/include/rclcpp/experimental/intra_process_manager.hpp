@@ -21,6 +21,7 @@
 
 #include <algorithm>
 #include <atomic>
+#include <chrono>
 #include <cstdint>
 #include <exception>
 #include <map>
@@ -31,13 +32,18 @@
 #include <vector>
 
 #include "rclcpp/allocator/allocator_deleter.hpp"
+#include "rclcpp/detail/read_copy_update_pointer.hpp"
+#include "rclcpp/detail/releasable_shared_message.hpp"
+#include "rclcpp/experimental/service_intra_process_base.hpp"
 #include "rclcpp/experimental/subscription_intra_process.hpp"
 #include "rclcpp/experimental/subscription_intra_process_base.hpp"
 #include "rclcpp/experimental/subscription_intra_process_buffer.hpp"
+#include "rclcpp/experimental/subscription_intra_process_input.hpp"
 #include "rclcpp/logger.hpp"
 #include "rclcpp/logging.hpp"
 #include "rclcpp/macros.hpp"
 #include "rclcpp/publisher_base.hpp"
+#include "rclcpp/type_adapter.hpp"
 #include "rclcpp/visibility_control.hpp"
 
 namespace rclcpp
@@ -46,6 +52,16 @@ namespace rclcpp
 namespace experimental
 {
 
+/// A publisher and a subscription communicating intra-process.
+struct IntraProcessConnection
+{
+  std::string topic_name;
+  uint64_t publisher_id;
+  uint64_t subscription_id;
+  /// True if the subscription shares the messages, false if it takes their ownership.
+  bool take_shared;
+};
+
 /// This class performs intra process communication between nodes.
 /**
  * This class is used in the creation of publishers and subscriptions.
@@ -97,6 +113,11 @@ private:
 public:
   RCLCPP_SMART_PTR_DEFINITIONS(IntraProcessManager)
 
+  /// Deleter of the messages of type T allocated with Alloc, as used by rclcpp::Publisher.
+  template<typename T, typename Alloc>
+  using TypeAdaptedDeleter =
+    allocator::Deleter<typename allocator::AllocRebind<T, Alloc>::allocator_type, T>;
+
   RCLCPP_PUBLIC
   IntraProcessManager();
 
@@ -141,6 +162,52 @@ public:
   uint64_t
   add_publisher(rclcpp::PublisherBase::SharedPtr publisher);
 
+  /// Register a publisher of the given message type with the manager.
+  /**
+   * Same as add_publisher(), but the subscriptions the publisher communicates
+   * with are cast to the buffer type matching the publisher when they are
+   * matched with it, instead of every time a message is published.
+   *
+   * \param publisher publisher to be registered with the manager.
+   * \return an unsigned 64-bit integer which is the publisher's unique id.
+   */
+  template<
+    typename MessageT,
+    typename Alloc = std::allocator<void>,
+    typename Deleter = std::default_delete<MessageT>>
+  uint64_t
+  add_publisher(rclcpp::PublisherBase::SharedPtr publisher)
+  {
+    return add_publisher(
+      std::move(publisher), &IntraProcessManager::cast_subscription<MessageT, Alloc, Deleter>);
+  }
+
+  /// Register a publisher of the custom type of a rclcpp::TypeAdapter with the manager.
+  /**
+   * Same as add_publisher() for the ROS message of the TypeAdapter, but the
+   * subscriptions taking the custom type are also matched, so that
+   * do_intra_process_publish_type_adapted() can give them the messages of the
+   * custom type without converting them.
+   *
+   * \param publisher publisher to be registered with the manager.
+   * \return an unsigned 64-bit integer which is the publisher's unique id.
+   */
+  template<
+    typename TypeAdapterT,
+    typename Alloc = std::allocator<void>>
+  uint64_t
+  add_type_adapted_publisher(rclcpp::PublisherBase::SharedPtr publisher)
+  {
+    using CustomT = typename TypeAdapterT::custom_type;
+    using ROSMessageT = typename TypeAdapterT::ros_message_type;
+    return add_publisher(
+      std::move(publisher),
+      &IntraProcessManager::cast_subscription<
+        ROSMessageT, Alloc, TypeAdaptedDeleter<ROSMessageT, Alloc>>,
+      &IntraProcessManager::cast_subscription<
+        CustomT, Alloc, TypeAdaptedDeleter<CustomT, Alloc>>);
+  }
+
   /// Unregister a publisher using the publisher's unique id.
   /**
    * This method does not allocate memory.
@@ -151,6 +218,26 @@ public:
   void
   remove_publisher(uint64_t intra_process_publisher_id);
 
+  /// Register a service with the manager, returns the service unique id.
+  /**
+   * The intra-process clients of the same service name can then find it with
+   * find_service_intra_process() and pass their requests to it by pointer.
+   *
+   * \param service the ServiceIntraProcess to register.
+   * \return an unsigned 64-bit integer which is the service's unique id.
+   */
+  RCLCPP_PUBLIC
+  uint64_t
+  add_service(rclcpp::experimental::ServiceIntraProcessBase::SharedPtr service);
+
+  /// Unregister a service using the service's unique id.
+  /**
+   * \param intra_process_service_id id of the service to remove.
+   */
+  RCLCPP_PUBLIC
+  void
+  remove_service(uint64_t intra_process_service_id);
+
   /// Publishes an intra-process message, passed as a unique pointer.
   /**
    * This is one of the two methods for publishing intra-process.
@@ -184,110 +271,284 @@ public:
     std::unique_ptr<MessageT, Deleter> message,
     typename allocator::AllocRebind<MessageT, Alloc>::allocator_type & allocator)
   {
-    using MessageAllocTraits = allocator::AllocRebind<MessageT, Alloc>;
-    using MessageAllocatorT = typename MessageAllocTraits::allocator_type;
-
-    std::shared_lock<std::shared_timed_mutex> lock(mutex_);
+    // Publishing only reads an immutable snapshot of the routing, it takes no lock.
+    auto routing_table = routing_snapshot_.read();
 
-    auto publisher_it = pub_to_subs_.find(intra_process_publisher_id);
-    if (publisher_it == pub_to_subs_.end()) {
+    auto publisher_it = routing_table->find(intra_process_publisher_id);
+    if (publisher_it == routing_table->end()) {
       // Publisher is either invalid or no longer exists.
       RCLCPP_WARN(
         rclcpp::get_logger("rclcpp"),
         "Calling do_intra_process_publish for invalid or no longer existing publisher id");
       return;
     }
-    const auto & sub_ids = publisher_it->second;
-
-    if (sub_ids.take_ownership_subscriptions.empty()) {
-      // None of the buffers require ownership, so we promote the pointer
-      std::shared_ptr<MessageT> msg = std::move(message);
+    const PublisherRouting & routing = *publisher_it->second;
+    IntraProcessMessageInfo message_info;
+    this->template publish_unique_to_subscriptions<MessageT, Alloc, Deleter>(
+      routing, std::move(message), allocator, make_message_info(routing, message_info));
+  }
 
-      this->template add_shared_msg_to_buffers<MessageT, Alloc, Deleter>(
-        msg, sub_ids.take_shared_subscriptions);
-    } else if (!sub_ids.take_ownership_subscriptions.empty() && // NOLINT
-      sub_ids.take_shared_subscriptions.size() <= 1)
-    {
-      // There is at maximum 1 buffer that does not require ownership.
-      // So this case is equivalent to all the buffers requiring ownership
+  template<
+    typename MessageT,
+    typename Alloc = std::allocator<void>,
+    typename Deleter = std::default_delete<MessageT>>
+  std::shared_ptr<const MessageT>
+  do_intra_process_publish_and_return_shared(
+    uint64_t intra_process_publisher_id,
+    std::unique_ptr<MessageT, Deleter> message,
+    typename allocator::AllocRebind<MessageT, Alloc>::allocator_type & allocator)
+  {
+    // Publishing only reads an immutable snapshot of the routing, it takes no lock.
+    auto routing_table = routing_snapshot_.read();
 
-      // Merge the two vector of ids into a unique one
-      std::vector<uint64_t> concatenated_vector(sub_ids.take_shared_subscriptions);
-      concatenated_vector.insert(
-        concatenated_vector.end(),
-        sub_ids.take_ownership_subscriptions.begin(),
-        sub_ids.take_ownership_subscriptions.end());
+    auto publisher_it = routing_table->find(intra_process_publisher_id);
+    if (publisher_it == routing_table->end()) {
+      // Publisher is either invalid or no longer exists.
+      RCLCPP_WARN(
+        rclcpp::get_logger("rclcpp"),
+        "Calling do_intra_process_publish for invalid or no longer existing publisher id");
+      return nullptr;
+    }
+    const PublisherRouting & routing = *publisher_it->second;
+    IntraProcessMessageInfo message_info;
+    return this->template share_unique_with_subscriptions<MessageT, Alloc, Deleter>(
+      routing, std::move(message), allocator, make_message_info(routing, message_info));
+  }
 
-      this->template add_owned_msg_to_buffers<MessageT, Alloc, Deleter>(
-        std::move(message),
-        concatenated_vector,
-        allocator);
-    } else if (!sub_ids.take_ownership_subscriptions.empty() && // NOLINT
-      sub_ids.take_shared_subscriptions.size() > 1)
-    {
-      // Construct a new shared pointer from the message
-      // for the buffers that do not require ownership
-      auto shared_msg = std::allocate_shared<MessageT, MessageAllocatorT>(allocator, *message);
+  /// Publish a batch of intra-process messages, passed as unique pointers.
+  /**
+   * Same as calling do_intra_process_publish() for each message, or
+   * do_intra_process_publish_and_return_shared() if shared_messages is given,
+   * but the routing of the publisher is looked up once for the whole batch.
+   *
+   * The messages are moved from, in order.
+   *
+   * \param intra_process_publisher_id the id of the publisher of the messages.
+   * \param first iterator to the first unique pointer to the messages, none may be null.
+   * \param last iterator past the last unique pointer to the messages.
+   * \param allocator allocator of the copies of the messages.
+   * \param shared_messages if not null, the shared messages are appended to it, e.g. to be
+   *   published inter-process.
+   */
+  template<
+    typename MessageT,
+    typename Alloc = std::allocator<void>,
+    typename Deleter = std::default_delete<MessageT>,
+    typename UniquePtrIterator>
+  void
+  do_intra_process_publish_batch(
+    uint64_t intra_process_publisher_id,
+    UniquePtrIterator first,
+    UniquePtrIterator last,
+    typename allocator::AllocRebind<MessageT, Alloc>::allocator_type & allocator,
+    std::vector<std::shared_ptr<const MessageT>> * shared_messages = nullptr)
+  {
+    // Publishing only reads an immutable snapshot of the routing, it takes no lock.
+    auto routing_table = routing_snapshot_.read();
 
-      this->template add_shared_msg_to_buffers<MessageT, Alloc, Deleter>(
-        shared_msg, sub_ids.take_shared_subscriptions);
-      this->template add_owned_msg_to_buffers<MessageT, Alloc, Deleter>(
-        std::move(message), sub_ids.take_ownership_subscriptions, allocator);
+    auto publisher_it = routing_table->find(intra_process_publisher_id);
+    if (publisher_it == routing_table->end()) {
+      // Publisher is either invalid or no longer exists.
+      RCLCPP_WARN(
+        rclcpp::get_logger("rclcpp"),
+        "Calling do_intra_process_publish for invalid or no longer existing publisher id");
+      return;
+    }
+    const PublisherRouting & routing = *publisher_it->second;
+    IntraProcessMessageInfo message_info;
+    for (; first != last; ++first) {
+      if (shared_messages) {
+        shared_messages->push_back(
+          this->template share_unique_with_subscriptions<MessageT, Alloc, Deleter>(
+            routing, std::move(*first), allocator, make_message_info(routing, message_info)));
+      } else {
+        this->template publish_unique_to_subscriptions<MessageT, Alloc, Deleter>(
+          routing, std::move(*first), allocator, make_message_info(routing, message_info));
+      }
     }
   }
 
+  /// Publish a message which is already shared, e.g. a message loaned from the middleware.
+  /**
+   * The subscriptions which do not require ownership share the message
+   * without copying it, what releases the message is up to its deleter.
+   * The subscriptions requiring ownership get copies of the message, made
+   * with the given allocator and deleter.
+   *
+   * This method does allocate memory if a subscription requires ownership.
+   *
+   * \param intra_process_publisher_id the id of the publisher of this message.
+   * \param message the message that is being stored.
+   * \param allocator allocator of the copies given to the subscriptions requiring ownership.
+   * \param deleter deleter of the copies given to the subscriptions requiring ownership.
+   */
   template<
     typename MessageT,
     typename Alloc = std::allocator<void>,
     typename Deleter = std::default_delete<MessageT>>
-  std::shared_ptr<const MessageT>
-  do_intra_process_publish_and_return_shared(
+  void
+  do_intra_process_publish_shared(
     uint64_t intra_process_publisher_id,
-    std::unique_ptr<MessageT, Deleter> message,
-    typename allocator::AllocRebind<MessageT, Alloc>::allocator_type & allocator)
+    std::shared_ptr<const MessageT> message,
+    typename allocator::AllocRebind<MessageT, Alloc>::allocator_type & allocator,
+    const Deleter & deleter = Deleter())
   {
-    using MessageAllocTraits = allocator::AllocRebind<MessageT, Alloc>;
-    using MessageAllocatorT = typename MessageAllocTraits::allocator_type;
+    // Publishing only reads an immutable snapshot of the routing, it takes no lock.
+    auto routing_table = routing_snapshot_.read();
 
-    std::shared_lock<std::shared_timed_mutex> lock(mutex_);
+    auto publisher_it = routing_table->find(intra_process_publisher_id);
+    if (publisher_it == routing_table->end()) {
+      // Publisher is either invalid or no longer exists.
+      RCLCPP_WARN(
+        rclcpp::get_logger("rclcpp"),
+        "Calling do_intra_process_publish for invalid or no longer existing publisher id");
+      return;
+    }
+    const PublisherRouting & routing = *publisher_it->second;
+    IntraProcessMessageInfo message_info;
+    this->template publish_shared_to_subscriptions<MessageT, Alloc, Deleter>(
+      routing, std::move(message), allocator, deleter, make_message_info(routing, message_info));
+  }
 
-    auto publisher_it = pub_to_subs_.find(intra_process_publisher_id);
-    if (publisher_it == pub_to_subs_.end()) {
+  /// Publish a message of the custom type of a rclcpp::TypeAdapter.
+  /**
+   * The publisher must have been registered with add_type_adapted_publisher().
+   *
+   * The subscriptions taking the custom type get the message without it
+   * being converted, as with do_intra_process_publish().
+   * The message is converted to the ROS message only if a subscription takes
+   * the ROS message, which is then shared by all of them, or if the ROS
+   * message is to be returned, e.g. to be published inter-process.
+   *
+   * \param intra_process_publisher_id the id of the publisher of this message.
+   * \param message the message that is being stored.
+   * \param allocator allocator of the copies of the message of the custom type.
+   * \param ros_message_allocator allocator of the ROS message.
+   * \param ros_message_deleter deleter of the copies of the ROS message.
+   * \param return_ros_message true to get the ROS message even if no subscription takes it.
+   * \return the ROS message, null if it was not needed.
+   */
+  template<
+    typename TypeAdapterT,
+    typename Alloc = std::allocator<void>>
+  std::shared_ptr<const typename TypeAdapterT::ros_message_type>
+  do_intra_process_publish_type_adapted(
+    uint64_t intra_process_publisher_id,
+    std::unique_ptr<
+      typename TypeAdapterT::custom_type,
+      TypeAdaptedDeleter<typename TypeAdapterT::custom_type, Alloc>> message,
+    typename allocator::AllocRebind<typename TypeAdapterT::custom_type, Alloc>::allocator_type &
+    allocator,
+    typename allocator::AllocRebind<typename TypeAdapterT::ros_message_type, Alloc>::allocator_type
+    & ros_message_allocator,
+    const TypeAdaptedDeleter<typename TypeAdapterT::ros_message_type, Alloc> & ros_message_deleter,
+    bool return_ros_message)
+  {
+    using CustomT = typename TypeAdapterT::custom_type;
+    using ROSMessageT = typename TypeAdapterT::ros_message_type;
+
+    // Publishing only reads an immutable snapshot of the routing, it takes no lock.
+    auto routing_table = routing_snapshot_.read();
+
+    auto publisher_it = routing_table->find(intra_process_publisher_id);
+    if (publisher_it == routing_table->end()) {
       // Publisher is either invalid or no longer exists.
       RCLCPP_WARN(
         rclcpp::get_logger("rclcpp"),
         "Calling do_intra_process_publish for invalid or no longer existing publisher id");
       return nullptr;
     }
-    const auto & sub_ids = publisher_it->second;
+    const PublisherRouting & routing = *publisher_it->second;
+    IntraProcessMessageInfo message_info;
+    const IntraProcessMessageInfo * message_info_ptr = make_message_info(routing, message_info);
 
-    if (sub_ids.take_ownership_subscriptions.empty()) {
-      // If there are no owning, just convert to shared.
-      std::shared_ptr<MessageT> shared_msg = std::move(message);
-      if (!sub_ids.take_shared_subscriptions.empty()) {
-        this->template add_shared_msg_to_buffers<MessageT, Alloc, Deleter>(
-          shared_msg, sub_ids.take_shared_subscriptions);
-      }
-      return shared_msg;
-    } else {
-      // Construct a new shared pointer from the message for the buffers that
-      // do not require ownership and to return.
-      auto shared_msg = std::allocate_shared<MessageT, MessageAllocatorT>(allocator, *message);
+    // Converted before the message is given away.
+    std::shared_ptr<ROSMessageT> ros_message;
+    if (return_ros_message || !routing.ros_message_subscriptions.empty()) {
+      ros_message = std::allocate_shared<ROSMessageT>(ros_message_allocator);
+      TypeAdapterT::convert_to_ros_message(*message, *ros_message);
+    }
+    if (!routing.custom_type_subscriptions.empty()) {
+      this->template publish_unique_to_subscriptions<
+        CustomT, Alloc, TypeAdaptedDeleter<CustomT, Alloc>>(
+        routing.custom_type_subscriptions, std::move(message), allocator, message_info_ptr);
+    }
+    if (!routing.ros_message_subscriptions.empty()) {
+      this->template publish_shared_to_subscriptions<
+        ROSMessageT, Alloc, TypeAdaptedDeleter<ROSMessageT, Alloc>>(
+        routing.ros_message_subscriptions, ros_message, ros_message_allocator,
+        ros_message_deleter, message_info_ptr);
+    }
+    return ros_message;
+  }
 
-      if (!sub_ids.take_shared_subscriptions.empty()) {
-        this->template add_shared_msg_to_buffers<MessageT, Alloc, Deleter>(
-          shared_msg,
-          sub_ids.take_shared_subscriptions);
-      }
-      if (!sub_ids.take_ownership_subscriptions.empty()) {
-        this->template add_owned_msg_to_buffers<MessageT, Alloc, Deleter>(
-          std::move(message),
-          sub_ids.take_ownership_subscriptions,
-          allocator);
-      }
+  /// Publish a shared message of the custom type of a rclcpp::TypeAdapter.
+  /**
+   * Same as do_intra_process_publish_type_adapted(), but the subscriptions
+   * taking the custom type share the message as with
+   * do_intra_process_publish_shared(), only the ones requiring its ownership
+   * get a copy.
+   *
+   * \param intra_process_publisher_id the id of the publisher of this message.
+   * \param message the message that is being stored.
+   * \param allocator allocator of the copies of the message of the custom type.
+   * \param deleter deleter of the copies of the message of the custom type.
+   * \param ros_message_allocator allocator of the ROS message.
+   * \param ros_message_deleter deleter of the copies of the ROS message.
+   * \param return_ros_message true to get the ROS message even if no subscription takes it.
+   * \return the ROS message, null if it was not needed.
+   */
+  template<
+    typename TypeAdapterT,
+    typename Alloc = std::allocator<void>>
+  std::shared_ptr<const typename TypeAdapterT::ros_message_type>
+  do_intra_process_publish_type_adapted_shared(
+    uint64_t intra_process_publisher_id,
+    std::shared_ptr<const typename TypeAdapterT::custom_type> message,
+    typename allocator::AllocRebind<typename TypeAdapterT::custom_type, Alloc>::allocator_type &
+    allocator,
+    const TypeAdaptedDeleter<typename TypeAdapterT::custom_type, Alloc> & deleter,
+    typename allocator::AllocRebind<typename TypeAdapterT::ros_message_type, Alloc>::allocator_type
+    & ros_message_allocator,
+    const TypeAdaptedDeleter<typename TypeAdapterT::ros_message_type, Alloc> & ros_message_deleter,
+    bool return_ros_message)
+  {
+    using CustomT = typename TypeAdapterT::custom_type;
+    using ROSMessageT = typename TypeAdapterT::ros_message_type;
 
-      return shared_msg;
+    // Publishing only reads an immutable snapshot of the routing, it takes no lock.
+    auto routing_table = routing_snapshot_.read();
+
+    auto publisher_it = routing_table->find(intra_process_publisher_id);
+    if (publisher_it == routing_table->end()) {
+      // Publisher is either invalid or no longer exists.
+      RCLCPP_WARN(
+        rclcpp::get_logger("rclcpp"),
+        "Calling do_intra_process_publish for invalid or no longer existing publisher id");
+      return nullptr;
+    }
+    const PublisherRouting & routing = *publisher_it->second;
+    IntraProcessMessageInfo message_info;
+    const IntraProcessMessageInfo * message_info_ptr = make_message_info(routing, message_info);
+
+    std::shared_ptr<ROSMessageT> ros_message;
+    if (return_ros_message || !routing.ros_message_subscriptions.empty()) {
+      ros_message = std::allocate_shared<ROSMessageT>(ros_message_allocator);
+      TypeAdapterT::convert_to_ros_message(*message, *ros_message);
     }
+    if (!routing.custom_type_subscriptions.empty()) {
+      this->template publish_shared_to_subscriptions<
+        CustomT, Alloc, TypeAdaptedDeleter<CustomT, Alloc>>(
+        routing.custom_type_subscriptions, std::move(message), allocator, deleter,
+        message_info_ptr);
+    }
+    if (!routing.ros_message_subscriptions.empty()) {
+      this->template publish_shared_to_subscriptions<
+        ROSMessageT, Alloc, TypeAdaptedDeleter<ROSMessageT, Alloc>>(
+        routing.ros_message_subscriptions, ros_message, ros_message_allocator,
+        ros_message_deleter, message_info_ptr);
+    }
+    return ros_message;
   }
 
   /// Return true if the given rmw_gid_t matches any stored Publishers.
@@ -295,20 +556,142 @@ public:
   bool
   matches_any_publishers(const rmw_gid_t * id) const;
 
+  /// Return true if the given rmw_gid_t matches a stored Publisher delivering to the subscription.
+  /**
+   * A subscription uses it to ignore the middleware copies of the messages
+   * it receives intra-process.
+   */
+  RCLCPP_PUBLIC
+  bool
+  matches_any_publishers(const rmw_gid_t * id, uint64_t intra_process_subscription_id) const;
+
   /// Return the number of intraprocess subscriptions that are matched with a given publisher id.
   RCLCPP_PUBLIC
   size_t
   get_subscription_count(uint64_t intra_process_publisher_id) const;
 
+  /// Return the number of intraprocess subscriptions of a publisher accepting messages now.
+  /**
+   * The publishes skip the subscriptions which do not accept messages, see
+   * SubscriptionIntraProcessBase::is_accepting_messages(), without copying the
+   * message for them, so that a publisher without other subscriptions may skip
+   * producing a message none of them would get.
+   * Like publishing, it takes no lock.
+   */
+  RCLCPP_PUBLIC
+  size_t
+  get_accepting_subscription_count(uint64_t intra_process_publisher_id) const;
+
+  /// Return the publisher and subscription pairs which communicate intra-process.
+  /**
+   * The pairs are sorted by topic name, publisher id and subscription id.
+   */
+  RCLCPP_PUBLIC
+  std::vector<IntraProcessConnection>
+  get_connections() const;
+
   RCLCPP_PUBLIC
   rclcpp::experimental::SubscriptionIntraProcessBase::SharedPtr
   get_subscription_intra_process(uint64_t intra_process_subscription_id);
 
+  RCLCPP_PUBLIC
+  rclcpp::experimental::ServiceIntraProcessBase::SharedPtr
+  get_service_intra_process(uint64_t intra_process_service_id) const;
+
+  /// Return the first registered service with the given fully qualified name, or null.
+  RCLCPP_PUBLIC
+  rclcpp::experimental::ServiceIntraProcessBase::SharedPtr
+  find_service_intra_process(const std::string & service_name) const;
+
 private:
+  /// Function casting a subscription to the buffer type matching a publisher, or returning null.
+  using SubscriptionCaster =
+    void * (*)(rclcpp::experimental::SubscriptionIntraProcessBase * subscription);
+
+  /// Subscription a publisher communicates with.
+  struct CachedSubscription
+  {
+    /// Owned until the subscription is removed, so that it can be used without locking it.
+    rclcpp::experimental::SubscriptionIntraProcessBase::SharedPtr subscription;
+    /// The subscription cast by the caster of the publisher, null if there is none.
+    void * typed_subscription;
+  };
+
+  /// Contiguous range of cached subscriptions.
+  struct CachedSubscriptionRange
+  {
+    const CachedSubscription * first;
+    const CachedSubscription * last;
+
+    const CachedSubscription * begin() const {return first;}
+    const CachedSubscription * end() const {return last;}
+    size_t size() const {return static_cast<size_t>(last - first);}
+    bool empty() const {return first == last;}
+  };
+
   struct SplittedSubscriptions
   {
     std::vector<uint64_t> take_shared_subscriptions;
     std::vector<uint64_t> take_ownership_subscriptions;
+
+    /// Casts the subscriptions to the buffer type of the publisher, may be null.
+    SubscriptionCaster caster = nullptr;
+    /// Casts the subscriptions to the custom type of a type adapted publisher, may be null.
+    SubscriptionCaster custom_type_caster = nullptr;
+  };
+
+  /// Subscriptions a publisher gives the messages of one type to.
+  struct SubscriptionGroup
+  {
+    SubscriptionCaster caster = nullptr;
+    /// The subscriptions taking shared messages then the ones taking ownership.
+    std::vector<CachedSubscription> cached_subscriptions;
+    size_t number_of_take_shared_subscriptions = 0;
+
+    bool
+    empty() const
+    {
+      return cached_subscriptions.empty();
+    }
+
+    CachedSubscriptionRange
+    get_subscriptions() const
+    {
+      const CachedSubscription * first = cached_subscriptions.data();
+      return {first, first + cached_subscriptions.size()};
+    }
+
+    CachedSubscriptionRange
+    get_take_shared_subscriptions() const
+    {
+      const CachedSubscription * first = cached_subscriptions.data();
+      return {first, first + number_of_take_shared_subscriptions};
+    }
+
+    CachedSubscriptionRange
+    get_take_ownership_subscriptions() const
+    {
+      const CachedSubscription * first = cached_subscriptions.data();
+      return {first + number_of_take_shared_subscriptions, first + cached_subscriptions.size()};
+    }
+  };
+
+  /// Subscriptions a publisher communicates with, never modified once published.
+  /**
+   * Rebuilt whenever the subscription ids of the publisher change, so that
+   * publishing neither looks up the subscriptions nor casts them.
+   *
+   * The routing itself is the group of all the subscriptions.
+   * For a type adapted publisher, they are also split between the ones taking the custom type
+   * and the ones only taking the ROS message.
+   */
+  struct PublisherRouting : public SubscriptionGroup
+  {
+    SubscriptionGroup custom_type_subscriptions;
+    SubscriptionGroup ros_message_subscriptions;
+    /// True if one of the subscriptions records the origin of the messages.
+    bool message_info_requested = false;
+    rmw_gid_t publisher_gid{};
   };
 
   using SubscriptionMap =
@@ -317,54 +700,356 @@ private:
   using PublisherMap =
     std::unordered_map<uint64_t, rclcpp::PublisherBase::WeakPtr>;
 
+  using ServiceMap =
+    std::map<uint64_t, rclcpp::experimental::ServiceIntraProcessBase::WeakPtr>;
+
   using PublisherToSubscriptionIdsMap =
     std::unordered_map<uint64_t, SplittedSubscriptions>;
 
+  /// Ids of the publishers and subscriptions of a topic, which are the only ones to match.
+  struct TopicEntities
+  {
+    std::vector<uint64_t> publisher_ids;
+    std::vector<uint64_t> subscription_ids;
+  };
+
+  using TopicIndex =
+    std::unordered_map<std::string, TopicEntities>;
+
+  using RoutingTable =
+    std::unordered_map<uint64_t, std::shared_ptr<const PublisherRouting>>;
+
   RCLCPP_PUBLIC
   static
   uint64_t
   get_next_unique_id();
 
+  RCLCPP_PUBLIC
+  uint64_t
+  add_publisher(
+    rclcpp::PublisherBase::SharedPtr publisher,
+    SubscriptionCaster caster,
+    SubscriptionCaster custom_type_caster = nullptr);
+
+  /// Index the publisher or subscription id under its topic name.
+  RCLCPP_PUBLIC
+  TopicEntities &
+  index_entity(uint64_t entity_id, const std::string & topic_name);
+
+  /// Remove the publisher or subscription id from the index, returning its topic entities.
+  /** \return the entities of its topic, or nullptr if it was not indexed. */
+  RCLCPP_PUBLIC
+  TopicEntities *
+  unindex_entity(uint64_t entity_id);
+
   RCLCPP_PUBLIC
   void
   insert_sub_id_for_pub(uint64_t sub_id, uint64_t pub_id, bool use_take_shared_method);
 
+  /// Rebuild the routing of a publisher from its subscription ids.
+  /**
+   * The change is only seen by publishers once publish_routing() is called.
+   */
+  RCLCPP_PUBLIC
+  void
+  update_routing(uint64_t pub_id);
+
+  /// Make the routing of all the publishers visible to the publishing threads.
+  /**
+   * Waits until no publishing thread uses the previous routing anymore before releasing it.
+   */
+  RCLCPP_PUBLIC
+  void
+  publish_routing();
+
   RCLCPP_PUBLIC
   bool
   can_communicate(
     rclcpp::PublisherBase::SharedPtr pub,
     rclcpp::experimental::SubscriptionIntraProcessBase::SharedPtr sub) const;
 
+  template<
+    typename MessageT,
+    typename Alloc,
+    typename Deleter>
+  static void *
+  cast_subscription(rclcpp::experimental::SubscriptionIntraProcessBase * subscription)
+  {
+    return dynamic_cast<
+      rclcpp::experimental::SubscriptionIntraProcessInput<MessageT, Alloc, Deleter> *>(
+      subscription);
+  }
+
+  /// Return the origin of a message published now, null if no subscription records it.
+  static const IntraProcessMessageInfo *
+  make_message_info(const PublisherRouting & routing, IntraProcessMessageInfo & message_info)
+  {
+    if (!routing.message_info_requested) {
+      return nullptr;
+    }
+    message_info.publisher_gid = routing.publisher_gid;
+    message_info.source_timestamp = std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::system_clock::now().time_since_epoch()).count();
+    return &message_info;
+  }
+
+  /// Give an owned message to a subscription, with its origin if it is recorded.
+  template<
+    typename MessageT,
+    typename Alloc,
+    typename Deleter>
+  static void
+  provide_owned_message(
+    rclcpp::experimental::SubscriptionIntraProcessInput<MessageT, Alloc, Deleter> * subscription,
+    std::unique_ptr<MessageT, Deleter> message,
+    const IntraProcessMessageInfo * message_info)
+  {
+    if (message_info) {
+      subscription->provide_intra_process_message(std::move(message), *message_info);
+    } else {
+      subscription->provide_intra_process_message(std::move(message));
+    }
+  }
+
+  /// Return the input of a subscription for the given message type.
+  /**
+   * The subscription cast when it was matched with the publisher is used if
+   * the publisher was registered for this message type, otherwise it is cast now.
+   *
+   * A subscription of a rclcpp::TypeAdapter has an input for both the custom
+   * type and the ROS message.
+   *
+   * \throws std::runtime_error if the subscription has no input of this type.
+   */
+  template<
+    typename MessageT,
+    typename Alloc,
+    typename Deleter>
+  static rclcpp::experimental::SubscriptionIntraProcessInput<MessageT, Alloc, Deleter> *
+  get_typed_subscription(
+    const SubscriptionGroup & routing,
+    const CachedSubscription & cached_subscription)
+  {
+    using SubscriptionIntraProcessInputT =
+      rclcpp::experimental::SubscriptionIntraProcessInput<MessageT, Alloc, Deleter>;
+
+    SubscriptionIntraProcessInputT * subscription = nullptr;
+    if (routing.caster == &IntraProcessManager::cast_subscription<MessageT, Alloc, Deleter>) {
+      subscription =
+        static_cast<SubscriptionIntraProcessInputT *>(cached_subscription.typed_subscription);
+    } else {
+      subscription =
+        dynamic_cast<SubscriptionIntraProcessInputT *>(cached_subscription.subscription.get());
+    }
+    if (nullptr == subscription) {
+      throw std::runtime_error(
+              "failed to dynamic cast SubscriptionIntraProcessBase to "
+              "SubscriptionIntraProcessInput<MessageT, Alloc, Deleter>, which "
+              "can happen when the publisher and subscription use different "
+              "allocator types, which is not supported");
+    }
+    return subscription;
+  }
+
+  /// Give a message to the subscriptions, promoting it or copying it as few times as possible.
   template<
     typename MessageT,
     typename Alloc,
     typename Deleter>
   void
-  add_shared_msg_to_buffers(
+  publish_unique_to_subscriptions(
+    const SubscriptionGroup & routing,
+    std::unique_ptr<MessageT, Deleter> message,
+    typename allocator::AllocRebind<MessageT, Alloc>::allocator_type & allocator,
+    const IntraProcessMessageInfo * message_info)
+  {
+    using MessageAllocTraits = allocator::AllocRebind<MessageT, Alloc>;
+    using MessageAllocatorT = typename MessageAllocTraits::allocator_type;
+
+    const auto take_shared_subscriptions = routing.get_take_shared_subscriptions();
+    const auto take_ownership_subscriptions = routing.get_take_ownership_subscriptions();
+
+    if (take_ownership_subscriptions.empty()) {
+      // None of the buffers require ownership, so we promote the pointer
+      std::shared_ptr<MessageT> msg = std::move(message);
+
+      this->template add_shared_msg_to_buffers<MessageT, Alloc, Deleter>(
+        msg, routing, take_shared_subscriptions, message_info);
+    } else if (!take_ownership_subscriptions.empty() && // NOLINT
+      take_shared_subscriptions.size() <= 1)
+    {
+      // There is at maximum 1 buffer that does not require ownership.
+      // So this case is equivalent to all the buffers requiring ownership
+      this->template add_owned_msg_to_buffers<MessageT, Alloc, Deleter>(
+        std::move(message),
+        routing,
+        routing.get_subscriptions(),
+        allocator,
+        message_info);
+    } else if (!take_ownership_subscriptions.empty() && // NOLINT
+      take_shared_subscriptions.size() > 1)
+    {
+      // Construct a new shared pointer from the message
+      // for the buffers that do not require ownership
+      auto shared_msg = std::allocate_shared<MessageT, MessageAllocatorT>(allocator, *message);
+
+      this->template add_shared_msg_to_buffers<MessageT, Alloc, Deleter>(
+        shared_msg, routing, take_shared_subscriptions, message_info);
+      this->template add_owned_msg_to_buffers<MessageT, Alloc, Deleter>(
+        std::move(message), routing, take_ownership_subscriptions, allocator, message_info);
+    }
+  }
+
+  /// Give a message to the subscriptions and return it shared, copying it only if owned.
+  template<
+    typename MessageT,
+    typename Alloc,
+    typename Deleter>
+  std::shared_ptr<const MessageT>
+  share_unique_with_subscriptions(
+    const SubscriptionGroup & routing,
+    std::unique_ptr<MessageT, Deleter> message,
+    typename allocator::AllocRebind<MessageT, Alloc>::allocator_type & allocator,
+    const IntraProcessMessageInfo * message_info)
+  {
+    using MessageAllocTraits = allocator::AllocRebind<MessageT, Alloc>;
+    using MessageAllocatorT = typename MessageAllocTraits::allocator_type;
+
+    const auto take_shared_subscriptions = routing.get_take_shared_subscriptions();
+    const auto take_ownership_subscriptions = routing.get_take_ownership_subscriptions();
+
+    if (take_ownership_subscriptions.empty()) {
+      // If there are no owning, just convert to shared.
+      std::shared_ptr<MessageT> shared_msg = std::move(message);
+      if (!take_shared_subscriptions.empty()) {
+        this->template add_shared_msg_to_buffers<MessageT, Alloc, Deleter>(
+          shared_msg, routing, take_shared_subscriptions, message_info);
+      }
+      return shared_msg;
+    } else if (all_store_shared_messages<MessageT, Alloc, Deleter>(
+        routing, take_ownership_subscriptions))
+    {
+      // The owning subscriptions take the message back from the shared pointer when
+      // they consume it, without a copy if it is no longer shared by then, e.g. once the
+      // inter-process publish is done with it.
+      std::shared_ptr<MessageT> shared_msg =
+        rclcpp::detail::make_releasable_shared_message(std::move(message));
+      this->template add_shared_msg_to_buffers<MessageT, Alloc, Deleter>(
+        shared_msg, routing, routing.get_subscriptions(), message_info);
+      return shared_msg;
+    } else {
+      // Construct a new shared pointer from the message for the buffers that
+      // do not require ownership and to return.
+      auto shared_msg = std::allocate_shared<MessageT, MessageAllocatorT>(allocator, *message);
+
+      if (!take_shared_subscriptions.empty()) {
+        this->template add_shared_msg_to_buffers<MessageT, Alloc, Deleter>(
+          shared_msg,
+          routing,
+          take_shared_subscriptions,
+          message_info);
+      }
+      if (!take_ownership_subscriptions.empty()) {
+        this->template add_owned_msg_to_buffers<MessageT, Alloc, Deleter>(
+          std::move(message),
+          routing,
+          take_ownership_subscriptions,
+          allocator,
+        message_info);
+      }
+
+      return shared_msg;
+    }
+  }
+
+  /// Give a shared message to the subscriptions, copying it for the owning ones which need it.
+  template<
+    typename MessageT,
+    typename Alloc,
+    typename Deleter>
+  void
+  publish_shared_to_subscriptions(
+    const SubscriptionGroup & routing,
     std::shared_ptr<const MessageT> message,
-    std::vector<uint64_t> subscription_ids)
+    typename allocator::AllocRebind<MessageT, Alloc>::allocator_type & allocator,
+    const Deleter & deleter,
+    const IntraProcessMessageInfo * message_info)
   {
-    for (auto id : subscription_ids) {
-      auto subscription_it = subscriptions_.find(id);
-      if (subscription_it == subscriptions_.end()) {
-        throw std::runtime_error("subscription has unexpectedly gone out of scope");
+    using MessageAllocTraits = allocator::AllocRebind<MessageT, Alloc>;
+
+    const auto take_shared_subscriptions = routing.get_take_shared_subscriptions();
+    const auto take_ownership_subscriptions = routing.get_take_ownership_subscriptions();
+
+    if (!take_shared_subscriptions.empty()) {
+      this->template add_shared_msg_to_buffers<MessageT, Alloc, Deleter>(
+        message, routing, take_shared_subscriptions, message_info);
+    }
+    for (const auto & cached_subscription : take_ownership_subscriptions) {
+      if (!cached_subscription.subscription->is_accepting_messages()) {
+        // Not copied for a subscription which would drop it.
+        cached_subscription.subscription->note_dropped_message();
+        continue;
       }
-      auto subscription_base = subscription_it->second.lock();
-      if (subscription_base) {
-        auto subscription = std::dynamic_pointer_cast<
-          rclcpp::experimental::SubscriptionIntraProcessBuffer<MessageT, Alloc, Deleter>
-          >(subscription_base);
-        if (nullptr == subscription) {
-          throw std::runtime_error(
-                  "failed to dynamic cast SubscriptionIntraProcessBase to "
-                  "SubscriptionIntraProcessBuffer<MessageT, Alloc, Deleter>, which "
-                  "can happen when the publisher and subscription use different "
-                  "allocator types, which is not supported");
+      auto subscription =
+        get_typed_subscription<MessageT, Alloc, Deleter>(routing, cached_subscription);
+      if (subscription->stores_shared_messages()) {
+        // Copied when taken only if still shared then, the message is moved otherwise.
+        if (message_info) {
+          subscription->provide_intra_process_message(message, *message_info);
+        } else {
+          subscription->provide_intra_process_message(message);
         }
+        continue;
+      }
+      auto ptr = MessageAllocTraits::allocate(allocator, 1);
+      MessageAllocTraits::construct(allocator, ptr, *message);
+      provide_owned_message(
+        subscription, std::unique_ptr<MessageT, Deleter>(ptr, deleter), message_info);
+    }
+  }
 
-        subscription->provide_intra_process_message(message);
+  /// Return true if all the given subscriptions keep the shared messages they are given.
+  template<
+    typename MessageT,
+    typename Alloc,
+    typename Deleter>
+  static bool
+  all_store_shared_messages(
+    const SubscriptionGroup & routing,
+    CachedSubscriptionRange subscriptions)
+  {
+    for (const auto & cached_subscription : subscriptions) {
+      auto subscription =
+        get_typed_subscription<MessageT, Alloc, Deleter>(routing, cached_subscription);
+      if (!subscription->stores_shared_messages()) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  template<
+    typename MessageT,
+    typename Alloc,
+    typename Deleter>
+  void
+  add_shared_msg_to_buffers(
+    std::shared_ptr<const MessageT> message,
+    const SubscriptionGroup & routing,
+    CachedSubscriptionRange subscriptions,
+    const IntraProcessMessageInfo * message_info)
+  {
+    for (const auto & cached_subscription : subscriptions) {
+      if (!cached_subscription.subscription->is_accepting_messages()) {
+        cached_subscription.subscription->note_dropped_message();
+        continue;
+      }
+      auto subscription =
+        get_typed_subscription<MessageT, Alloc, Deleter>(routing, cached_subscription);
+      if (message_info) {
+        subscription->provide_intra_process_message(message, *message_info);
       } else {
-        subscriptions_.erase(id);
+        subscription->provide_intra_process_message(message);
       }
     }
   }
@@ -376,54 +1061,70 @@ private:
   void
   add_owned_msg_to_buffers(
     std::unique_ptr<MessageT, Deleter> message,
-    std::vector<uint64_t> subscription_ids,
-    typename allocator::AllocRebind<MessageT, Alloc>::allocator_type & allocator)
+    const SubscriptionGroup & routing,
+    CachedSubscriptionRange subscriptions,
+    typename allocator::AllocRebind<MessageT, Alloc>::allocator_type & allocator,
+    const IntraProcessMessageInfo * message_info)
   {
     using MessageAllocTraits = allocator::AllocRebind<MessageT, Alloc>;
     using MessageUniquePtr = std::unique_ptr<MessageT, Deleter>;
 
-    for (auto it = subscription_ids.begin(); it != subscription_ids.end(); it++) {
-      auto subscription_it = subscriptions_.find(*it);
-      if (subscription_it == subscriptions_.end()) {
-        throw std::runtime_error("subscription has unexpectedly gone out of scope");
+    // The subscriptions which would drop the message are skipped without a copy,
+    // the last one accepting it gets the ownership.
+    const CachedSubscription * last = subscriptions.end();
+    for (auto it = subscriptions.begin(); it != subscriptions.end(); it++) {
+      if (it->subscription->is_accepting_messages()) {
+        last = it;
       }
-      auto subscription_base = subscription_it->second.lock();
-      if (subscription_base) {
-        auto subscription = std::dynamic_pointer_cast<
-          rclcpp::experimental::SubscriptionIntraProcessBuffer<MessageT, Alloc, Deleter>
-          >(subscription_base);
-        if (nullptr == subscription) {
-          throw std::runtime_error(
-                  "failed to dynamic cast SubscriptionIntraProcessBase to "
-                  "SubscriptionIntraProcessBuffer<MessageT, Alloc, Deleter>, which "
-                  "can happen when the publisher and subscription use different "
-                  "allocator types, which is not supported");
-        }
+    }
+    if (last == subscriptions.end()) {
+      for (const auto & cached_subscription : subscriptions) {
+        cached_subscription.subscription->note_dropped_message();
+      }
+      return;
+    }
 
-        if (std::next(it) == subscription_ids.end()) {
-          // If this is the last subscription, give up ownership
-          subscription->provide_intra_process_message(std::move(message));
-        } else {
-          // Copy the message since we have additional subscriptions to serve
-          MessageUniquePtr copy_message;
-          Deleter deleter = message.get_deleter();
-          auto ptr = MessageAllocTraits::allocate(allocator, 1);
-          MessageAllocTraits::construct(allocator, ptr, *message);
-          copy_message = MessageUniquePtr(ptr, deleter);
-
-          subscription->provide_intra_process_message(std::move(copy_message));
-        }
-      } else {
-        subscriptions_.erase(subscription_it);
+    for (auto it = subscriptions.begin(); it != last; it++) {
+      if (!it->subscription->is_accepting_messages()) {
+        it->subscription->note_dropped_message();
+        continue;
       }
+      auto subscription = get_typed_subscription<MessageT, Alloc, Deleter>(routing, *it);
+
+      // Copy the message since we have additional subscriptions to serve
+      MessageUniquePtr copy_message;
+      Deleter deleter = message.get_deleter();
+      auto ptr = MessageAllocTraits::allocate(allocator, 1);
+      MessageAllocTraits::construct(allocator, ptr, *message);
+      copy_message = MessageUniquePtr(ptr, deleter);
+
+      provide_owned_message(subscription, std::move(copy_message), message_info);
+    }
+    // The ones after the last accepting subscription did not accept the message.
+    for (auto it = std::next(last); it != subscriptions.end(); it++) {
+      it->subscription->note_dropped_message();
     }
+    // The last subscription gets the ownership
+    provide_owned_message(
+      get_typed_subscription<MessageT, Alloc, Deleter>(routing, *last),
+      std::move(message), message_info);
   }
 
   PublisherToSubscriptionIdsMap pub_to_subs_;
   SubscriptionMap subscriptions_;
   PublisherMap publishers_;
+  /// Publishers and subscriptions by topic name, so that matching only looks at their topic.
+  TopicIndex topics_;
+  /// Topic name of each publisher and subscription id, even once the entity is destroyed.
+  std::unordered_map<uint64_t, std::string> entity_topics_;
+  ServiceMap services_;
+  /// Routing of the publishers being updated, copied to routing_snapshot_ when published.
+  RoutingTable routing_;
 
+  /// Serializes the changes of the publishers, subscriptions and services.
+  /** Publishing does not take it. */
   mutable std::shared_timed_mutex mutex_;
+  rclcpp::detail::ReadCopyUpdatePointer<RoutingTable> routing_snapshot_;
 };
 
 }  // namespace experimental
@@ -0,0 +1,194 @@
+// Copyright 2021 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#ifndef RCLCPP__EXPERIMENTAL__SERVICE_INTRA_PROCESS_HPP_
+#define RCLCPP__EXPERIMENTAL__SERVICE_INTRA_PROCESS_HPP_
+
+#include <algorithm>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+#include "rmw/types.h"
+
+#include "rclcpp/context.hpp"
+#include "rclcpp/experimental/client_intra_process.hpp"
+#include "rclcpp/experimental/service_intra_process_base.hpp"
+#include "rclcpp/macros.hpp"
+#include "rcutils/logging_macros.h"
+
+namespace rclcpp
+{
+namespace experimental
+{
+
+/// Intra-process part of a service, executing the requests of intra-process clients.
+/**
+ * The request headers given to the service callback for intra-process
+ * requests have a zeroed writer guid, which no middleware request has, and a
+ * sequence number local to this service.
+ */
+template<typename ServiceT>
+class ServiceIntraProcess : public ServiceIntraProcessBase
+{
+public:
+  RCLCPP_SMART_PTR_DEFINITIONS(ServiceIntraProcess)
+
+  using SharedRequest = typename ServiceT::Request::SharedPtr;
+  using SharedResponse = typename ServiceT::Response::SharedPtr;
+  using ClientIntraProcessT = rclcpp::experimental::ClientIntraProcess<ServiceT>;
+
+  /// Callback handling a request, its response is given back with send_response().
+  using RequestCallback =
+    std::function<void (std::shared_ptr<rmw_request_id_t>, SharedRequest)>;
+
+  ServiceIntraProcess(
+    rclcpp::Context::SharedPtr context,
+    const std::string & service_name,
+    RequestCallback callback)
+  : ServiceIntraProcessBase(context, service_name), callback_(std::move(callback))
+  {}
+
+  virtual ~ServiceIntraProcess() = default;
+
+  /// Queue a request of an intra-process client.
+  /**
+   * The request is handed over by pointer, without being copied.
+   * This member function is thread-safe.
+   *
+   * \param[in] client_sequence_number sequence number identifying the request for the client.
+   * \param[in] request the request.
+   * \param[in] client the client to which the response is given.
+   */
+  void
+  store_intra_process_request(
+    int64_t client_sequence_number,
+    SharedRequest request,
+    typename ClientIntraProcessT::WeakPtr client)
+  {
+    {
+      std::lock_guard<std::mutex> lock(requests_mutex_);
+      requests_.push_back({client_sequence_number, std::move(request), std::move(client)});
+    }
+    trigger_guard_condition();
+  }
+
+  /// Return true if the request header is the one of an intra-process request.
+  static bool
+  is_intra_process_request(const rmw_request_id_t & request_header)
+  {
+    return std::all_of(
+      std::begin(request_header.writer_guid), std::end(request_header.writer_guid),
+      [](auto byte) {return 0 == byte;});
+  }
+
+  /// Give the response to the intra-process client which sent the request.
+  /**
+   * The response is handed over by pointer, without being copied.
+   * This member function is thread-safe.
+   *
+   * \param[in] request_header header of an intra-process request.
+   * \param[in] response the response.
+   */
+  void
+  send_response(const rmw_request_id_t & request_header, SharedResponse response)
+  {
+    PendingResponse pending_response;
+    {
+      std::lock_guard<std::mutex> lock(requests_mutex_);
+      auto it = pending_responses_.find(request_header.sequence_number);
+      if (it == pending_responses_.end()) {
+        RCUTILS_LOG_ERROR_NAMED(
+          "rclcpp",
+          "Response to an unknown intra-process request. Ignoring...");
+        return;
+      }
+      pending_response = std::move(it->second);
+      pending_responses_.erase(it);
+    }
+    // The client may have been destroyed while the request was being handled.
+    auto client = pending_response.client.lock();
+    if (client) {
+      client->store_intra_process_response(
+        pending_response.client_sequence_number, std::move(response));
+    }
+  }
+
+  bool
+  is_ready(rcl_wait_set_t * wait_set) override
+  {
+    (void) wait_set;
+    std::lock_guard<std::mutex> lock(requests_mutex_);
+    return !requests_.empty();
+  }
+
+  std::shared_ptr<void>
+  take_data() override
+  {
+    std::lock_guard<std::mutex> lock(requests_mutex_);
+    if (requests_.empty()) {
+      return nullptr;
+    }
+    auto request = std::make_shared<PendingRequest>(std::move(requests_.front()));
+    requests_.pop_front();
+    return request;
+  }
+
+  void
+  execute(std::shared_ptr<void> & data) override
+  {
+    if (!data) {
+      throw std::runtime_error("'data' is empty");
+    }
+    auto pending_request = std::static_pointer_cast<PendingRequest>(data);
+    auto request_header = std::make_shared<rmw_request_id_t>();
+    {
+      std::lock_guard<std::mutex> lock(requests_mutex_);
+      request_header->sequence_number = ++sequence_number_;
+      pending_responses_[sequence_number_] =
+        {pending_request->client_sequence_number, std::move(pending_request->client)};
+    }
+    callback_(request_header, std::move(pending_request->request));
+  }
+
+private:
+  struct PendingRequest
+  {
+    int64_t client_sequence_number;
+    SharedRequest request;
+    typename ClientIntraProcessT::WeakPtr client;
+  };
+
+  struct PendingResponse
+  {
+    int64_t client_sequence_number;
+    typename ClientIntraProcessT::WeakPtr client;
+  };
+
+  RequestCallback callback_;
+  std::deque<PendingRequest> requests_;
+  /// Requests being handled by the callback, or whose response is deferred.
+  std::unordered_map<int64_t, PendingResponse> pending_responses_;
+  int64_t sequence_number_ = 0;
+  std::mutex requests_mutex_;
+};
+
+}  // namespace experimental
+}  // namespace rclcpp
+
+#endif  // RCLCPP__EXPERIMENTAL__SERVICE_INTRA_PROCESS_HPP_
@@ -0,0 +1,82 @@
+// Copyright 2021 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__EXPERIMENTAL__SERVICE_INTRA_PROCESS_BASE_HPP_
+#define RCLCPP__EXPERIMENTAL__SERVICE_INTRA_PROCESS_BASE_HPP_
+
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include "rcl/guard_condition.h"
+#include "rcl/wait.h"
+
+#include "rclcpp/context.hpp"
+#include "rclcpp/macros.hpp"
+#include "rclcpp/visibility_control.hpp"
+#include "rclcpp/waitable.hpp"
+
+namespace rclcpp
+{
+namespace experimental
+{
+
+/// Waitable through which a service executes the requests of intra-process clients.
+/**
+ * It is registered with the IntraProcessManager under the name of its
+ * service, so that clients of the same service in the same context can pass
+ * their requests to it by pointer, instead of through the middleware.
+ */
+class ServiceIntraProcessBase : public rclcpp::Waitable
+{
+public:
+  RCLCPP_SMART_PTR_ALIASES_ONLY(ServiceIntraProcessBase)
+
+  RCLCPP_PUBLIC
+  ServiceIntraProcessBase(
+    rclcpp::Context::SharedPtr context,
+    const std::string & service_name);
+
+  RCLCPP_PUBLIC
+  virtual ~ServiceIntraProcessBase();
+
+  RCLCPP_PUBLIC
+  size_t
+  get_number_of_ready_guard_conditions() override {return 1;}
+
+  RCLCPP_PUBLIC
+  bool
+  add_to_wait_set(rcl_wait_set_t * wait_set) override;
+
+  /// Return the fully qualified name of the service.
+  RCLCPP_PUBLIC
+  const char *
+  get_service_name() const;
+
+protected:
+  RCLCPP_PUBLIC
+  void
+  trigger_guard_condition();
+
+  std::recursive_mutex reentrant_mutex_;
+  rcl_guard_condition_t gc_;
+
+private:
+  std::string service_name_;
+};
+
+}  // namespace experimental
+}  // namespace rclcpp
+
+#endif  // RCLCPP__EXPERIMENTAL__SERVICE_INTRA_PROCESS_BASE_HPP_
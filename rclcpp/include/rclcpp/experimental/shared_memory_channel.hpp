@@ -0,0 +1,206 @@
+// Copyright 2021 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__EXPERIMENTAL__SHARED_MEMORY_CHANNEL_HPP_
+#define RCLCPP__EXPERIMENTAL__SHARED_MEMORY_CHANNEL_HPP_
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "rclcpp/macros.hpp"
+#include "rclcpp/visibility_control.hpp"
+#include "rmw/types.h"
+
+namespace rclcpp
+{
+namespace experimental
+{
+
+/// Ring of messages of a topic in a shared memory segment of the host.
+/**
+ * The processes of the host opening the channel of the same topic map the
+ * same segment, named after the topic and the domain, which is created by the first one
+ * and removed when the last one closes it.
+ * The segment holds a fixed number of slots of a fixed size, the pool the
+ * messages are copied into, used as a ring: once it is full, writing a
+ * message overwrites the oldest one.
+ * The size and the number of slots are the ones given by the process which
+ * created the segment.
+ *
+ * Writing a message wakes up the readers waiting in wait_for_notification(),
+ * with a futex on Linux, by polling elsewhere.
+ *
+ * Writing and reading do not lock, a slot being overwritten while it is read
+ * is detected and the message is reported as lost.
+ *
+ * The readers register themselves in the segment and keep their registration
+ * alive by calling keep_reader_alive(), at least every reader_timeout, so
+ * that the readers of a process which crashed stop being counted.
+ */
+class SharedMemoryChannel
+{
+public:
+  RCLCPP_SMART_PTR_DEFINITIONS_NOT_COPYABLE(SharedMemoryChannel)
+
+  /// Maximum number of readers and writers of a channel.
+  static constexpr size_t max_endpoints = 64;
+
+  /// Time after which a reader which was not kept alive is not counted anymore.
+  static constexpr std::chrono::milliseconds reader_timeout{1000};
+
+  /// Open the channel of a topic, creating its segment if it does not exist.
+  /**
+   * \param[in] topic_name fully qualified name of the topic.
+   * \param[in] domain_id domain of the endpoints of the topic.
+   * \param[in] slot_size maximum size of a message, if the segment is created.
+   * \param[in] slot_count number of messages of the ring, if the segment is created.
+   * \throws std::invalid_argument if slot_size or slot_count is zero.
+   * \throws std::runtime_error if the segment cannot be opened or created,
+   *   or if shared memory is not supported on this platform.
+   */
+  RCLCPP_PUBLIC
+  SharedMemoryChannel(
+    const std::string & topic_name,
+    size_t domain_id,
+    size_t slot_size,
+    size_t slot_count);
+
+  RCLCPP_PUBLIC
+  virtual ~SharedMemoryChannel();
+
+  /// Return the name of the shared memory segment of a topic.
+  RCLCPP_PUBLIC
+  static std::string
+  get_segment_name(const std::string & topic_name, size_t domain_id);
+
+  RCLCPP_PUBLIC
+  size_t
+  get_slot_size() const;
+
+  RCLCPP_PUBLIC
+  size_t
+  get_slot_count() const;
+
+  /// Register a publisher writing to the channel, so that readers can recognise its messages.
+  /**
+   * \throws std::runtime_error if the channel has max_endpoints writers already.
+   */
+  RCLCPP_PUBLIC
+  void
+  add_writer(const rmw_gid_t & writer_gid);
+
+  RCLCPP_PUBLIC
+  void
+  remove_writer(const rmw_gid_t & writer_gid);
+
+  /// Return true if the publisher with the given gid is registered as a writer.
+  RCLCPP_PUBLIC
+  bool
+  is_writer(const rmw_gid_t & writer_gid) const;
+
+  /// Copy a message in the next slot of the ring and wake up the readers.
+  /**
+   * \param[in] data the bytes of the message.
+   * \param[in] size the number of bytes of the message.
+   * \param[in] writer_gid gid of the publisher of the message.
+   * \throws std::length_error if the message is larger than the slot size.
+   */
+  RCLCPP_PUBLIC
+  void
+  write(const uint8_t * data, size_t size, const rmw_gid_t & writer_gid);
+
+  /// Return the sequence number the next written message will get.
+  RCLCPP_PUBLIC
+  uint64_t
+  get_write_sequence() const;
+
+  /// Copy the message with the given sequence number, if it was written.
+  /**
+   * If the message was overwritten, the oldest message still in the ring is
+   * read instead and lost_count is increased by the number of skipped messages.
+   *
+   * \param[inout] sequence sequence number of the message to read, set to
+   *   the number of the next message if one is read.
+   * \param[out] data the bytes of the message.
+   * \param[out] writer_gid gid data of the publisher of the message,
+   *   RMW_GID_STORAGE_SIZE bytes.
+   * \param[inout] lost_count number of messages lost by the reader.
+   * \return true if a message was read, false if it is not written yet.
+   */
+  RCLCPP_PUBLIC
+  bool
+  read(
+    uint64_t & sequence,
+    std::vector<uint8_t> & data,
+    uint8_t * writer_gid,
+    uint64_t & lost_count) const;
+
+  /// Register a reader of the channel.
+  /**
+   * \throws std::runtime_error if the channel has max_endpoints readers already.
+   */
+  RCLCPP_PUBLIC
+  void
+  add_reader();
+
+  RCLCPP_PUBLIC
+  void
+  remove_reader();
+
+  /// Renew the registration of the reader added by this object.
+  RCLCPP_PUBLIC
+  void
+  keep_reader_alive();
+
+  /// Return the number of readers of the host alive, including the one of this object.
+  RCLCPP_PUBLIC
+  size_t
+  get_reader_count() const;
+
+  /// Return a counter increased each time a message is written.
+  RCLCPP_PUBLIC
+  uint32_t
+  get_notification() const;
+
+  /// Wait until a message is written, if none was since the given notification.
+  /**
+   * \param[in] notification value of get_notification() before checking for messages.
+   * \param[in] timeout maximum time to wait.
+   */
+  RCLCPP_PUBLIC
+  void
+  wait_for_notification(uint32_t notification, std::chrono::nanoseconds timeout) const;
+
+  /// Wake up the threads of this process waiting for a notification, e.g. to stop them.
+  RCLCPP_PUBLIC
+  void
+  notify() const;
+
+private:
+  struct Segment;
+
+  std::string segment_name_;
+  Segment * segment_;
+  size_t mapped_size_;
+  /// Index of the registration of the reader of this object, max_endpoints if none.
+  size_t reader_index_;
+};
+
+}  // namespace experimental
+}  // namespace rclcpp
+
+#endif  // RCLCPP__EXPERIMENTAL__SHARED_MEMORY_CHANNEL_HPP_
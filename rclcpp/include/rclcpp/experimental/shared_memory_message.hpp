@@ -0,0 +1,97 @@
+// Copyright 2021 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__EXPERIMENTAL__SHARED_MEMORY_MESSAGE_HPP_
+#define RCLCPP__EXPERIMENTAL__SHARED_MEMORY_MESSAGE_HPP_
+
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+#include "rcl/allocator.h"
+#include "rclcpp/exceptions.hpp"
+#include "rclcpp/experimental/shared_memory_channel.hpp"
+#include "rclcpp/serialization.hpp"
+#include "rclcpp/serialized_message.hpp"
+#include "rmw/rmw.h"
+#include "rmw/serialized_message.h"
+#include "rosidl_typesupport_cpp/message_type_support.hpp"
+
+namespace rclcpp
+{
+namespace experimental
+{
+
+/// Write a ROS message to a shared memory channel.
+/**
+ * Messages which are trivially copyable, without strings nor sequences, are
+ * written as they are, the others are serialized.
+ *
+ * \throws std::length_error if the message is larger than the slots of the channel.
+ */
+template<typename MessageT>
+void
+write_to_shared_memory(
+  SharedMemoryChannel & channel,
+  const MessageT & message,
+  const rmw_gid_t & publisher_gid)
+{
+  if constexpr (std::is_trivially_copyable_v<MessageT>) {
+    channel.write(reinterpret_cast<const uint8_t *>(&message), sizeof(MessageT), publisher_gid);
+  } else {
+    rclcpp::SerializedMessage serialized_message;
+    rclcpp::Serialization<MessageT> serialization;
+    serialization.serialize_message(&message, &serialized_message);
+    const auto & rcl_serialized_message = serialized_message.get_rcl_serialized_message();
+    channel.write(
+      rcl_serialized_message.buffer, rcl_serialized_message.buffer_length, publisher_gid);
+  }
+}
+
+/// Read a ROS message written by write_to_shared_memory().
+/**
+ * \throws std::runtime_error if the data is not a message of this type.
+ */
+template<typename MessageT>
+void
+read_from_shared_memory(const std::vector<uint8_t> & data, MessageT & message)
+{
+  if constexpr (std::is_trivially_copyable_v<MessageT>) {
+    if (data.size() != sizeof(MessageT)) {
+      throw std::runtime_error("shared memory message has an unexpected size");
+    }
+    std::memcpy(&message, data.data(), sizeof(MessageT));
+  } else {
+    // Deserialize from the data directly, without copying it into a serialized message.
+    rmw_serialized_message_t serialized_message = rmw_get_zero_initialized_serialized_message();
+    serialized_message.buffer = const_cast<uint8_t *>(data.data());
+    serialized_message.buffer_length = data.size();
+    serialized_message.buffer_capacity = data.size();
+    serialized_message.allocator = rcl_get_default_allocator();
+    const auto ret = rmw_deserialize(
+      &serialized_message,
+      rosidl_typesupport_cpp::get_message_type_support_handle<MessageT>(),
+      &message);
+    if (RMW_RET_OK != ret) {
+      rclcpp::exceptions::throw_from_rcl_error(ret, "failed to deserialize shared memory message");
+    }
+  }
+}
+
+}  // namespace experimental
+}  // namespace rclcpp
+
+#endif  // RCLCPP__EXPERIMENTAL__SHARED_MEMORY_MESSAGE_HPP_
@@ -17,12 +17,17 @@
 
 #include <rmw/rmw.h>
 
+#include <array>
+#include <atomic>
 #include <functional>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <stdexcept>
 #include <string>
+#include <type_traits>
 #include <utility>
+#include <vector>
 
 #include "rcl/error_handling.h"
 
@@ -31,6 +36,7 @@
 #include "rclcpp/experimental/create_intra_process_buffer.hpp"
 #include "rclcpp/experimental/subscription_intra_process_base.hpp"
 #include "rclcpp/experimental/subscription_intra_process_buffer.hpp"
+#include "rclcpp/intra_process_keep_all_options.hpp"
 #include "rclcpp/qos.hpp"
 #include "rclcpp/type_support_decl.hpp"
 #include "rclcpp/waitable.hpp"
@@ -41,22 +47,32 @@ namespace rclcpp
 namespace experimental
 {
 
+/// Subscription delivering the intra-process messages of its buffer to its callback.
+/**
+ * MessageT is the type stored in the buffer.
+ * With a rclcpp::TypeAdapter given as CallbackMessageT, it is the custom type
+ * if the callback takes the custom type, ROSMessageT being the ROS message,
+ * otherwise it is the ROS message.
+ */
 template<
   typename MessageT,
   typename Alloc = std::allocator<void>,
   typename Deleter = std::default_delete<MessageT>,
-  typename CallbackMessageT = MessageT>
+  typename CallbackMessageT = MessageT,
+  typename ROSMessageT = MessageT>
 class SubscriptionIntraProcess
   : public SubscriptionIntraProcessBuffer<
     MessageT,
     Alloc,
-    Deleter
+    Deleter,
+    ROSMessageT
   >
 {
   using SubscriptionIntraProcessBufferT = SubscriptionIntraProcessBuffer<
     MessageT,
     Alloc,
-    Deleter
+    Deleter,
+    ROSMessageT
   >;
 
 public:
@@ -68,21 +84,53 @@ public:
   using MessageUniquePtr = typename SubscriptionIntraProcessBufferT::MessageUniquePtr;
   using BufferUniquePtr = typename SubscriptionIntraProcessBufferT::BufferUniquePtr;
 
+  /// Messages taken out of the buffer for one execution of the subscription.
+  struct TakenData
+  {
+    std::vector<ConstMessageSharedPtr> shared_messages;
+    std::vector<MessageUniquePtr> unique_messages;
+    /// Origins of the messages, only if the subscription records them.
+    std::vector<rmw_message_info_t> message_infos;
+  };
+
+  /**
+   * \param max_batch_size maximum number of messages delivered in one
+   *   execution, 0 to deliver all the messages queued in the buffer.
+   * \param collect_buffer_statistics true to collect the statistics of the buffer.
+   * \param record_message_info true to give the callback the origin of the messages.
+   */
   SubscriptionIntraProcess(
     AnySubscriptionCallback<CallbackMessageT, Alloc> callback,
     std::shared_ptr<Alloc> allocator,
     rclcpp::Context::SharedPtr context,
     const std::string & topic_name,
     const rclcpp::QoS & qos_profile,
-    rclcpp::IntraProcessBufferType buffer_type)
-  : SubscriptionIntraProcessBuffer<MessageT, Alloc, Deleter>(
+    rclcpp::IntraProcessBufferType buffer_type,
+    size_t max_batch_size = 1,
+    bool collect_buffer_statistics = false,
+    bool record_message_info = false,
+    const rclcpp::IntraProcessKeepAllOptions & keep_all_options =
+    rclcpp::IntraProcessKeepAllOptions())
+  : SubscriptionIntraProcessBufferT(
       allocator,
       context,
       topic_name,
       qos_profile,
-      buffer_type),
-    any_callback_(callback)
+      buffer_type,
+      collect_buffer_statistics,
+      record_message_info,
+      keep_all_options),
+    any_callback_(callback),
+    max_batch_size_(max_batch_size)
   {
+    // The buffer holds at most depth messages, so a batch never grows the preallocated holders.
+    batch_capacity_ = qos_profile.depth();
+    if (max_batch_size_ != 0 && max_batch_size_ < batch_capacity_) {
+      batch_capacity_ = max_batch_size_;
+    }
+    for (auto & taken_data : taken_data_pool_) {
+      taken_data = make_taken_data();
+    }
     TRACEPOINT(
       rclcpp_subscription_callback_added,
       static_cast<const void *>(this),
@@ -97,22 +145,39 @@ public:
 
   virtual ~SubscriptionIntraProcess() = default;
 
+  /// Take the next messages out of the buffer, up to the maximum batch size.
+  /**
+   * The messages are handed to the executor in one of a few preallocated
+   * holders, so that taking messages does not allocate as long as the
+   * executor does not hold more than taken_data_pool_size of them at a time.
+   *
+   * Taking a batch lets a burst of queued messages be delivered in a single
+   * execution, instead of one wait of the executor per message.
+   */
   std::shared_ptr<void>
   take_data()
   {
-    ConstMessageSharedPtr shared_msg;
-    MessageUniquePtr unique_msg;
+    std::shared_ptr<TakenData> taken_data = get_free_taken_data();
 
-    if (any_callback_.use_take_shared_method()) {
-      shared_msg = this->buffer_->consume_shared();
-    } else {
-      unique_msg = this->buffer_->consume_unique();
+    std::unique_lock<std::mutex> message_info_lock;
+    if (this->record_message_info_) {
+      message_info_lock = std::unique_lock<std::mutex>(this->message_info_mutex_);
     }
-    return std::static_pointer_cast<void>(
-      std::make_shared<std::pair<ConstMessageSharedPtr, MessageUniquePtr>>(
-        std::pair<ConstMessageSharedPtr, MessageUniquePtr>(
-          shared_msg, std::move(unique_msg)))
-    );
+    size_t taken = 0;
+    do {
+      if (any_callback_.use_take_shared_method()) {
+        taken_data->shared_messages.push_back(this->buffer_->consume_shared());
+      } else {
+        taken_data->unique_messages.push_back(this->buffer_->consume_unique());
+      }
+      if (this->record_message_info_) {
+        taken_data->message_infos.push_back(this->pop_message_info());
+      }
+      ++taken;
+    } while ((max_batch_size_ == 0 || taken < max_batch_size_) && this->buffer_->has_data());
+    // The messages left in the buffer, or added meanwhile, wake the executor again.
+    this->rearm_guard_condition();
+    return taken_data;
   }
 
   void execute(std::shared_ptr<void> & data)
@@ -120,7 +185,124 @@ public:
     execute_impl<MessageT>(data);
   }
 
+  using SubscriptionIntraProcessBufferT::provide_intra_process_message;
+
+  void
+  provide_intra_process_message(ConstMessageSharedPtr message) override
+  {
+    if (!try_deliver_inline(message, nullptr)) {
+      SubscriptionIntraProcessBufferT::provide_intra_process_message(std::move(message));
+    }
+  }
+
+  void
+  provide_intra_process_message(MessageUniquePtr message) override
+  {
+    if (!try_deliver_inline(message, nullptr)) {
+      SubscriptionIntraProcessBufferT::provide_intra_process_message(std::move(message));
+    }
+  }
+
+  void
+  provide_intra_process_message(
+    ConstMessageSharedPtr message,
+    const IntraProcessMessageInfo & message_info) override
+  {
+    if (!try_deliver_inline(message, &message_info)) {
+      SubscriptionIntraProcessBufferT::provide_intra_process_message(
+        std::move(message), message_info);
+    }
+  }
+
+  void
+  provide_intra_process_message(
+    MessageUniquePtr message,
+    const IntraProcessMessageInfo & message_info) override
+  {
+    if (!try_deliver_inline(message, &message_info)) {
+      SubscriptionIntraProcessBufferT::provide_intra_process_message(
+        std::move(message), message_info);
+    }
+  }
+
+  /// Set the predicate given a pointer to each message, true to give it to the callback.
+  /**
+   * See rclcpp::ContentFilterOptions::message_filter.
+   * It must be set before the subscription is executed.
+   */
+  void
+  set_message_filter(std::function<bool (const void *)> message_filter)
+  {
+    message_filter_ = std::move(message_filter);
+  }
+
+  /// Set whether only the latest message of each batch is given to the callback.
+  /**
+   * See rclcpp::SubscriptionOptionsBase::take_latest_only.
+   * It must be set before the subscription is executed.
+   */
+  void
+  set_dispatch_latest_only(bool dispatch_latest_only)
+  {
+    dispatch_latest_only_ = dispatch_latest_only;
+  }
+
+  /// Set whether the messages are given to the callback by the thread publishing them.
+  /**
+   * See rclcpp::SubscriptionOptionsBase::deliver_intra_process_inline.
+   * It must be set before any message is published to the subscription.
+   */
+  void
+  set_deliver_inline(bool deliver_inline)
+  {
+    deliver_inline_ = deliver_inline;
+  }
+
+  bool
+  is_accepting_messages() const override
+  {
+    // The messages delivered inline do not wait in the buffer.
+    return deliver_inline_ || SubscriptionIntraProcessBufferT::is_accepting_messages();
+  }
+
 protected:
+  /// Give the message to the callback in the calling thread, if delivered inline.
+  /**
+   * \param[inout] message the message, moved from only if it was delivered.
+   * \param[in] message_info the origin of the message, or null if unknown.
+   * \return false if the message must be buffered instead, see InlineDeliveryScope.
+   */
+  template<typename MessagePtrT>
+  bool
+  try_deliver_inline(MessagePtrT & message, const IntraProcessMessageInfo * message_info)
+  {
+    if constexpr (std::is_same<MessageT, rcl_serialized_message_t>::value) {
+      (void)message;
+      (void)message_info;
+      return false;
+    } else {
+      if (!deliver_inline_) {
+        return false;
+      }
+      SubscriptionIntraProcessBase::InlineDeliveryScope scope(this);
+      if (!scope.is_entered()) {
+        return false;
+      }
+      if (message_filter_ && !message_filter_(message.get())) {
+        return true;
+      }
+      rmw_message_info_t msg_info;
+      if (this->record_message_info_ && message_info) {
+        msg_info = SubscriptionIntraProcessBufferT::make_message_info(*message_info);
+      } else {
+        msg_info = rmw_get_zero_initialized_message_info();
+        msg_info.from_intra_process = true;
+      }
+      any_callback_.dispatch_intra_process(std::move(message), msg_info);
+      return true;
+    }
+  }
+
   template<typename T>
   typename std::enable_if<std::is_same<T, rcl_serialized_message_t>::value, void>::type
   execute_impl(std::shared_ptr<void> & data)
@@ -137,24 +319,99 @@ protected:
       throw std::runtime_error("'data' is empty");
     }
 
-    rmw_message_info_t msg_info;
-    msg_info.publisher_gid = {0, {0}};
+    rmw_message_info_t msg_info = rmw_get_zero_initialized_message_info();
     msg_info.from_intra_process = true;
 
-    auto shared_ptr = std::static_pointer_cast<std::pair<ConstMessageSharedPtr, MessageUniquePtr>>(
-      data);
+    auto shared_ptr = std::static_pointer_cast<TakenData>(data);
+    auto & message_infos = shared_ptr->message_infos;
 
+    // Move the messages out, the holder may be reused before the executor releases it.
+    // Clearing keeps the capacity of the holder for the next batch.
     if (any_callback_.use_take_shared_method()) {
-      ConstMessageSharedPtr shared_msg = shared_ptr->first;
-      any_callback_.dispatch_intra_process(shared_msg, msg_info);
+      auto & shared_messages = shared_ptr->shared_messages;
+      if (dispatch_latest_only_ && !shared_messages.empty()) {
+        shared_messages.erase(shared_messages.begin(), shared_messages.end() - 1);
+        if (!message_infos.empty()) {
+          message_infos.erase(message_infos.begin(), message_infos.end() - 1);
+        }
+      }
+      for (size_t i = 0; i < shared_messages.size(); ++i) {
+        auto & message = shared_messages[i];
+        if (message_filter_ && !message_filter_(message.get())) {
+          continue;
+        }
+        ConstMessageSharedPtr shared_msg = std::move(message);
+        any_callback_.dispatch_intra_process(
+          shared_msg, i < message_infos.size() ? message_infos[i] : msg_info);
+      }
+      shared_messages.clear();
     } else {
-      MessageUniquePtr unique_msg = std::move(shared_ptr->second);
-      any_callback_.dispatch_intra_process(std::move(unique_msg), msg_info);
+      auto & unique_messages = shared_ptr->unique_messages;
+      if (dispatch_latest_only_ && !unique_messages.empty()) {
+        unique_messages.erase(unique_messages.begin(), unique_messages.end() - 1);
+        if (!message_infos.empty()) {
+          message_infos.erase(message_infos.begin(), message_infos.end() - 1);
+        }
+      }
+      for (size_t i = 0; i < unique_messages.size(); ++i) {
+        auto & message = unique_messages[i];
+        if (message_filter_ && !message_filter_(message.get())) {
+          continue;
+        }
+        MessageUniquePtr unique_msg = std::move(message);
+        any_callback_.dispatch_intra_process(
+          std::move(unique_msg), i < message_infos.size() ? message_infos[i] : msg_info);
+      }
+      unique_messages.clear();
     }
+    message_infos.clear();
     shared_ptr.reset();
   }
 
+  /// Return a new holder of taken messages, with room for a full batch.
+  std::shared_ptr<TakenData>
+  make_taken_data() const
+  {
+    auto taken_data = std::make_shared<TakenData>();
+    if (any_callback_.use_take_shared_method()) {
+      taken_data->shared_messages.reserve(batch_capacity_);
+    } else {
+      taken_data->unique_messages.reserve(batch_capacity_);
+    }
+    if (this->record_message_info_) {
+      taken_data->message_infos.reserve(batch_capacity_);
+    }
+    return taken_data;
+  }
+
+  /// Return a holder of taken messages which the executor does not hold anymore.
+  /**
+   * Allocate a new one if all the preallocated holders are held.
+   */
+  std::shared_ptr<TakenData>
+  get_free_taken_data()
+  {
+    for (const auto & taken_data : taken_data_pool_) {
+      // Only the pool owns the holder once the executor released it.
+      if (taken_data.use_count() == 1) {
+        // Synchronize with the release of the holder by the thread which executed it.
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return taken_data;
+      }
+    }
+    return make_taken_data();
+  }
+
   AnySubscriptionCallback<CallbackMessageT, Alloc> any_callback_;
+  std::function<bool (const void *)> message_filter_;
+  bool dispatch_latest_only_ = false;
+  bool deliver_inline_ = false;
+  size_t max_batch_size_;
+  size_t batch_capacity_;
+
+  /// Number of preallocated holders of taken messages.
+  static constexpr size_t taken_data_pool_size = 4;
+  std::array<std::shared_ptr<TakenData>, taken_data_pool_size> taken_data_pool_;
 };
 
 }  // namespace experimental
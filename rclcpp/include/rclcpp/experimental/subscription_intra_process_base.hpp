@@ -25,6 +25,7 @@
 
 #include "rcl/error_handling.h"
 
+#include "rclcpp/experimental/buffers/buffer_implementation_base.hpp"
 #include "rclcpp/qos.hpp"
 #include "rclcpp/type_support_decl.hpp"
 #include "rclcpp/waitable.hpp"
@@ -69,6 +70,58 @@ public:
   virtual bool
   use_take_shared_method() const = 0;
 
+  /// Return true if the messages are rclcpp::SerializedMessage, see rclcpp::GenericSubscription.
+  virtual bool
+  is_serialized() const = 0;
+
+  /// Return the statistics of the buffer of the messages waiting to be delivered.
+  /**
+   * They are only collected if requested when the subscription is created,
+   * see rclcpp::SubscriptionOptionsBase::collect_intra_process_buffer_statistics.
+   */
+  virtual rclcpp::experimental::buffers::BufferStatistics
+  get_buffer_statistics() const = 0;
+
+  /// Return true if the origin of the messages is recorded and given to the callback.
+  /**
+   * See rclcpp::SubscriptionOptionsBase::intra_process_message_info.
+   */
+  virtual bool
+  records_message_info() const
+  {
+    return false;
+  }
+
+  /// Return false if a message given now would be dropped instead of being queued.
+  /**
+   * The publishers skip the subscription, without copying the message for it,
+   * while it returns false, see
+   * rclcpp::SubscriptionOptionsBase::intra_process_drop_new_when_full.
+   * It may change as soon as it returned, if the subscription takes its messages
+   * or other publishers fill its buffer.
+   */
+  virtual bool
+  is_accepting_messages() const
+  {
+    return true;
+  }
+
+  /// Count a message a publisher skipped the subscription for, as it did not accept messages.
+  /**
+   * See is_accepting_messages() and get_buffer_statistics().
+   */
+  virtual void
+  note_dropped_message()
+  {
+  }
+
+  /// Return the approximate size of the messages the buffer may hold, in bytes.
+  virtual size_t
+  get_buffer_memory_size() const
+  {
+    return 0;
+  }
+
   RCLCPP_PUBLIC
   const char *
   get_topic_name() const;
@@ -78,6 +131,37 @@ public:
   get_actual_qos() const;
 
 protected:
+  /// Scope in which the calling thread delivers a message inline to a subscription.
+  /**
+   * The message must be buffered instead if the scope is not entered, which
+   * happens if the thread is already delivering a message inline to the same
+   * subscription, e.g. if its callback publishes on its own topic, or if more
+   * than max_inline_delivery_depth inline deliveries are nested in the thread.
+   */
+  class InlineDeliveryScope
+  {
+  public:
+    RCLCPP_PUBLIC
+    explicit InlineDeliveryScope(const SubscriptionIntraProcessBase * subscription);
+
+    RCLCPP_PUBLIC
+    ~InlineDeliveryScope();
+
+    bool
+    is_entered() const
+    {
+      return entered_;
+    }
+
+  private:
+    RCLCPP_DISABLE_COPY(InlineDeliveryScope)
+
+    bool entered_;
+  };
+
+  /// Maximum number of inline deliveries nested in a thread.
+  static constexpr size_t max_inline_delivery_depth = 8;
+
   std::recursive_mutex reentrant_mutex_;
   rcl_guard_condition_t gc_;
 
@@ -17,20 +17,33 @@
 
 #include <rmw/rmw.h>
 
+#include <atomic>
+#include <chrono>
+#include <cstdint>
 #include <functional>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <stdexcept>
 #include <string>
+#include <type_traits>
 #include <utility>
+#include <vector>
 
 #include "rcl/error_handling.h"
 
+#include "rclcpp/allocator/allocator_common.hpp"
+#include "rclcpp/allocator/allocator_deleter.hpp"
 #include "rclcpp/any_subscription_callback.hpp"
+#include "rclcpp/detail/extended_tracepoints.hpp"
 #include "rclcpp/experimental/buffers/intra_process_buffer.hpp"
 #include "rclcpp/experimental/create_intra_process_buffer.hpp"
 #include "rclcpp/experimental/subscription_intra_process_base.hpp"
+#include "rclcpp/experimental/subscription_intra_process_input.hpp"
+#include "rclcpp/intra_process_keep_all_options.hpp"
 #include "rclcpp/qos.hpp"
+#include "rclcpp/serialized_message.hpp"
+#include "rclcpp/type_adapter.hpp"
 #include "rclcpp/type_support_decl.hpp"
 #include "rclcpp/waitable.hpp"
 #include "tracetools/tracetools.h"
@@ -40,13 +53,125 @@ namespace rclcpp
 namespace experimental
 {
 
+namespace detail
+{
+
+/// Input of the ROS message of a rclcpp::TypeAdapter, nothing if there is none.
+template<
+  typename MessageT,
+  typename Alloc,
+  typename Deleter,
+  typename ROSMessageT,
+  typename Enable = void>
+class ROSMessageIntraProcessInput
+{
+public:
+  explicit ROSMessageIntraProcessInput(const std::shared_ptr<Alloc> & allocator)
+  {
+    (void)allocator;
+  }
+};
+
+/// Receive the ROS messages of a rclcpp::TypeAdapter, converting them to the custom type.
+template<
+  typename MessageT,
+  typename Alloc,
+  typename Deleter,
+  typename ROSMessageT>
+class ROSMessageIntraProcessInput<
+  MessageT, Alloc, Deleter, ROSMessageT,
+  std::enable_if_t<!std::is_same<MessageT, ROSMessageT>::value>>
+  : public SubscriptionIntraProcessInput<
+    ROSMessageT,
+    Alloc,
+    allocator::Deleter<typename allocator::AllocRebind<ROSMessageT, Alloc>::allocator_type,
+    ROSMessageT>>
+{
+  using MessageAllocTraits = allocator::AllocRebind<MessageT, Alloc>;
+  using MessageAlloc = typename MessageAllocTraits::allocator_type;
+  using MessageUniquePtr = std::unique_ptr<MessageT, Deleter>;
+  using ROSMessageDeleter = allocator::Deleter<
+    typename allocator::AllocRebind<ROSMessageT, Alloc>::allocator_type,
+    ROSMessageT>;
+
+public:
+  explicit ROSMessageIntraProcessInput(const std::shared_ptr<Alloc> & allocator)
+  : message_allocator_(*allocator)
+  {}
+
+  void
+  provide_intra_process_message(std::shared_ptr<const ROSMessageT> message) override
+  {
+    provide_intra_process_message(convert_to_custom(*message));
+  }
+
+  void
+  provide_intra_process_message(std::unique_ptr<ROSMessageT, ROSMessageDeleter> message) override
+  {
+    provide_intra_process_message(convert_to_custom(*message));
+  }
+
+  void
+  provide_intra_process_message(
+    std::shared_ptr<const ROSMessageT> message,
+    const IntraProcessMessageInfo & message_info) override
+  {
+    provide_intra_process_message(convert_to_custom(*message), message_info);
+  }
+
+  void
+  provide_intra_process_message(
+    std::unique_ptr<ROSMessageT, ROSMessageDeleter> message,
+    const IntraProcessMessageInfo & message_info) override
+  {
+    provide_intra_process_message(convert_to_custom(*message), message_info);
+  }
+
+  /// Store a message of the custom type, implemented by the buffer.
+  virtual void
+  provide_intra_process_message(MessageUniquePtr message) = 0;
+
+  /// Store a message of the custom type with its origin, implemented by the buffer.
+  virtual void
+  provide_intra_process_message(
+    MessageUniquePtr message,
+    const IntraProcessMessageInfo & message_info) = 0;
+
+private:
+  MessageUniquePtr
+  convert_to_custom(const ROSMessageT & message)
+  {
+    auto ptr = MessageAllocTraits::allocate(message_allocator_, 1);
+    MessageAllocTraits::construct(message_allocator_, ptr);
+    rclcpp::TypeAdapter<MessageT, ROSMessageT>::convert_to_custom(message, *ptr);
+    return MessageUniquePtr(ptr);
+  }
+
+  MessageAlloc message_allocator_;
+};
+
+}  // namespace detail
+
+/// Subscription storing the intra-process messages it receives in a buffer.
+/**
+ * If MessageT is the custom type of a rclcpp::TypeAdapter, ROSMessageT is its
+ * ROS message: the messages of both types are received, the ROS messages
+ * being converted to the custom type.
+ */
 template<
   typename MessageT,
   typename Alloc = std::allocator<void>,
-  typename Deleter = std::default_delete<MessageT>
+  typename Deleter = std::default_delete<MessageT>,
+  typename ROSMessageT = MessageT
 >
-class SubscriptionIntraProcessBuffer : public SubscriptionIntraProcessBase
+class SubscriptionIntraProcessBuffer
+  : public SubscriptionIntraProcessBase,
+  public SubscriptionIntraProcessInput<MessageT, Alloc, Deleter>,
+  public detail::ROSMessageIntraProcessInput<MessageT, Alloc, Deleter, ROSMessageT>
 {
+  using ROSMessageInputT =
+    detail::ROSMessageIntraProcessInput<MessageT, Alloc, Deleter, ROSMessageT>;
+
 public:
   RCLCPP_SMART_PTR_DEFINITIONS(SubscriptionIntraProcessBuffer)
 
@@ -66,14 +191,31 @@ public:
     rclcpp::Context::SharedPtr context,
     const std::string & topic_name,
     const rclcpp::QoS & qos_profile,
-    rclcpp::IntraProcessBufferType buffer_type)
-  : SubscriptionIntraProcessBase(topic_name, qos_profile)
+    rclcpp::IntraProcessBufferType buffer_type,
+    bool collect_buffer_statistics = false,
+    bool record_message_info = false,
+    const rclcpp::IntraProcessKeepAllOptions & keep_all_options =
+    rclcpp::IntraProcessKeepAllOptions())
+  : SubscriptionIntraProcessBase(topic_name, qos_profile),
+    ROSMessageInputT(allocator),
+    record_message_info_(record_message_info)
   {
+    if (record_message_info_) {
+      // The buffer holds at most depth messages, dropping the oldest ones as the ring does.
+      message_infos_.resize(qos_profile.depth());
+    }
+
     // Create the intra-process buffer.
     buffer_ = rclcpp::experimental::create_intra_process_buffer<MessageT, Alloc, Deleter>(
       buffer_type,
       qos_profile,
-      allocator);
+      allocator,
+      collect_buffer_statistics,
+      keep_all_options);
+    RCLCPP_EXTENDED_TRACEPOINT(
+      rclcpp_ipb_to_subscription,
+      static_cast<const void *>(buffer_.get()),
+      static_cast<const void *>(this));
 
     // Create the guard condition.
     rcl_guard_condition_options_t guard_condition_options =
@@ -99,6 +241,14 @@ public:
     }
   }
 
+  bool
+  add_to_wait_set(rcl_wait_set_t * wait_set) override
+  {
+    // The previous wait may have consumed the trigger of messages not taken since.
+    rearm_guard_condition();
+    return SubscriptionIntraProcessBase::add_to_wait_set(wait_set);
+  }
+
   bool
   is_ready(rcl_wait_set_t * wait_set)
   {
@@ -107,34 +257,252 @@ public:
   }
 
   void
-  provide_intra_process_message(ConstMessageSharedPtr message)
+  provide_intra_process_message(ConstMessageSharedPtr message) override
   {
+    if (record_message_info_) {
+      // Keep the origins in step with the messages of the buffer.
+      provide_intra_process_message(std::move(message), IntraProcessMessageInfo{{}, 0});
+      return;
+    }
+    if (drop_new_message()) {
+      return;
+    }
     buffer_->add_shared(std::move(message));
     trigger_guard_condition();
   }
 
   void
-  provide_intra_process_message(MessageUniquePtr message)
+  provide_intra_process_message(MessageUniquePtr message) override
   {
+    if (record_message_info_) {
+      // Keep the origins in step with the messages of the buffer.
+      provide_intra_process_message(std::move(message), IntraProcessMessageInfo{{}, 0});
+      return;
+    }
+    if (drop_new_message()) {
+      return;
+    }
     buffer_->add_unique(std::move(message));
     trigger_guard_condition();
   }
 
+  void
+  provide_intra_process_message(
+    ConstMessageSharedPtr message,
+    const IntraProcessMessageInfo & message_info) override
+  {
+    if (!record_message_info_) {
+      provide_intra_process_message(std::move(message));
+      return;
+    }
+    {
+      std::lock_guard<std::mutex> lock(message_info_mutex_);
+      if (drop_new_message()) {
+        return;
+      }
+      // Added first, as a full keep all buffer may reject the message.
+      buffer_->add_shared(std::move(message));
+      push_message_info(message_info);
+    }
+    trigger_guard_condition();
+  }
+
+  void
+  provide_intra_process_message(
+    MessageUniquePtr message,
+    const IntraProcessMessageInfo & message_info) override
+  {
+    if (!record_message_info_) {
+      provide_intra_process_message(std::move(message));
+      return;
+    }
+    {
+      std::lock_guard<std::mutex> lock(message_info_mutex_);
+      if (drop_new_message()) {
+        return;
+      }
+      // Added first, as a full keep all buffer may reject the message.
+      buffer_->add_unique(std::move(message));
+      push_message_info(message_info);
+    }
+    trigger_guard_condition();
+  }
+
+  bool
+  records_message_info() const override
+  {
+    return record_message_info_;
+  }
+
+  bool
+  is_accepting_messages() const override
+  {
+    return !drop_new_when_full_ || !buffer_->is_full();
+  }
+
+  void
+  note_dropped_message() override
+  {
+    dropped_new_count_.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  /// Set whether the messages given while the buffer is full are dropped instead of the oldest.
+  /**
+   * See rclcpp::SubscriptionOptionsBase::intra_process_drop_new_when_full.
+   * It is ignored with a keep all history, whose buffer has its own backpressure policy.
+   * It must be set before any message is published to the subscription.
+   */
+  void
+  set_drop_new_when_full(bool drop_new_when_full)
+  {
+    drop_new_when_full_ =
+      drop_new_when_full && get_actual_qos().history() != rclcpp::HistoryPolicy::KeepAll;
+  }
+
   bool
   use_take_shared_method() const
   {
     return buffer_->use_take_shared_method();
   }
 
+  bool
+  stores_shared_messages() const override
+  {
+    return buffer_->stores_shared_messages();
+  }
+
+  rclcpp::experimental::buffers::BufferStatistics
+  get_buffer_statistics() const override
+  {
+    auto statistics = buffer_->get_statistics();
+    if (statistics.enabled) {
+      statistics.dropped_count += dropped_new_count_.load(std::memory_order_relaxed);
+    }
+    return statistics;
+  }
+
+  size_t
+  get_buffer_memory_size() const override
+  {
+    // Each element of the buffer holds a pointer to a message until it is delivered.
+    return get_actual_qos().depth() * (sizeof(ConstMessageSharedPtr) + sizeof(MessageT));
+  }
+
+  bool
+  is_serialized() const
+  {
+    return std::is_same<MessageT, rclcpp::SerializedMessage>::value;
+  }
+
 protected:
+  /// Trigger the guard condition, unless it was triggered since the messages were last taken.
+  /**
+   * Messages added while the executor has not taken the previous ones are
+   * seen when it does, so that a burst of messages triggers it once.
+   */
   void
   trigger_guard_condition()
   {
+    if (wakeup_pending_.exchange(true, std::memory_order_acq_rel)) {
+      return;
+    }
     rcl_ret_t ret = rcl_trigger_guard_condition(&gc_);
     (void)ret;
   }
 
+  /// Let the next message trigger the guard condition, triggering it now if messages are left.
+  /**
+   * Called after taking messages out of the buffer, and when waiting again.
+   */
+  void
+  rearm_guard_condition()
+  {
+    wakeup_pending_.exchange(false, std::memory_order_acq_rel);
+    if (buffer_->has_data()) {
+      trigger_guard_condition();
+    }
+  }
+
+  /// Return true and count the message if it must be dropped as the buffer is full.
+  bool
+  drop_new_message()
+  {
+    // Not the virtual check, which accepts the messages delivered inline.
+    if (!drop_new_when_full_ || !buffer_->is_full()) {
+      return false;
+    }
+    note_dropped_message();
+    return true;
+  }
+
+  /// Record the origin of the message just added to the buffer.
+  /**
+   * Must be called holding message_info_mutex_.
+   */
+  void
+  push_message_info(const IntraProcessMessageInfo & message_info)
+  {
+    const size_t capacity = message_infos_.size();
+    if (0u == capacity) {
+      return;
+    }
+    if (message_info_count_ == capacity) {
+      // The buffer drops its oldest message.
+      message_info_head_ = (message_info_head_ + 1) % capacity;
+      --message_info_count_;
+    }
+    message_infos_[(message_info_head_ + message_info_count_) % capacity] =
+      make_message_info(message_info);
+    ++message_info_count_;
+  }
+
+  /// Return the message info given to the callback for a message received now.
+  static rmw_message_info_t
+  make_message_info(const IntraProcessMessageInfo & message_info)
+  {
+    rmw_message_info_t info = rmw_get_zero_initialized_message_info();
+    info.publisher_gid = message_info.publisher_gid;
+    info.source_timestamp = message_info.source_timestamp;
+    info.received_timestamp = std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::system_clock::now().time_since_epoch()).count();
+    info.from_intra_process = true;
+    return info;
+  }
+
+  /// Return the origin of the message just consumed from the buffer.
+  /**
+   * Must be called holding message_info_mutex_.
+   */
+  rmw_message_info_t
+  pop_message_info()
+  {
+    if (0u == message_info_count_) {
+      rmw_message_info_t info = rmw_get_zero_initialized_message_info();
+      info.from_intra_process = true;
+      return info;
+    }
+    rmw_message_info_t info = message_infos_[message_info_head_];
+    message_info_head_ = (message_info_head_ + 1) % message_infos_.size();
+    --message_info_count_;
+    return info;
+  }
+
   BufferUniquePtr buffer_;
+  /// True if the guard condition was triggered since the messages were last taken.
+  std::atomic_bool wakeup_pending_{false};
+  /// True to drop the messages given while the buffer is full, see set_drop_new_when_full().
+  bool drop_new_when_full_ = false;
+  /// Number of messages dropped as they were given while the buffer was full.
+  std::atomic<uint64_t> dropped_new_count_{0};
+
+  /// True to record the origin of the messages, see records_message_info().
+  const bool record_message_info_;
+  /// Serializes adding a message with its origin and consuming it, when recording them.
+  std::mutex message_info_mutex_;
+  /// Ring of the origins of the messages in the buffer, oldest first.
+  std::vector<rmw_message_info_t> message_infos_;
+  size_t message_info_head_ = 0;
+  size_t message_info_count_ = 0;
 };
 
 }  // namespace experimental
@@ -0,0 +1,102 @@
+// Copyright 2021 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__EXPERIMENTAL__SUBSCRIPTION_INTRA_PROCESS_INPUT_HPP_
+#define RCLCPP__EXPERIMENTAL__SUBSCRIPTION_INTRA_PROCESS_INPUT_HPP_
+
+#include <memory>
+#include <utility>
+
+#include "rcutils/time.h"
+#include "rmw/types.h"
+
+namespace rclcpp
+{
+namespace experimental
+{
+
+/// Origin of an intra-process message.
+/**
+ * Only given to the subscriptions which record it, see
+ * rclcpp::SubscriptionOptionsBase::intra_process_message_info.
+ */
+struct IntraProcessMessageInfo
+{
+  /// Gid of the publisher of the message.
+  rmw_gid_t publisher_gid;
+  /// System time the message was published at, in nanoseconds.
+  rcutils_time_point_value_t source_timestamp;
+};
+
+/// Interface of a subscription receiving intra-process messages of the given type.
+/**
+ * The intra process manager gives the messages of a publisher to the
+ * subscriptions through this interface.
+ * A subscription can receive messages of more than one type, e.g. both the
+ * custom type and the ROS message of a rclcpp::TypeAdapter, by implementing
+ * it for each of them.
+ */
+template<
+  typename MessageT,
+  typename Alloc = std::allocator<void>,
+  typename Deleter = std::default_delete<MessageT>>
+class SubscriptionIntraProcessInput
+{
+public:
+  virtual ~SubscriptionIntraProcessInput() = default;
+
+  virtual void
+  provide_intra_process_message(std::shared_ptr<const MessageT> message) = 0;
+
+  virtual void
+  provide_intra_process_message(std::unique_ptr<MessageT, Deleter> message) = 0;
+
+  /// Give a message with its origin, which is dropped by default.
+  virtual void
+  provide_intra_process_message(
+    std::shared_ptr<const MessageT> message,
+    const IntraProcessMessageInfo & message_info)
+  {
+    (void)message_info;
+    provide_intra_process_message(std::move(message));
+  }
+
+  /// Give a message with its origin, which is dropped by default.
+  virtual void
+  provide_intra_process_message(
+    std::unique_ptr<MessageT, Deleter> message,
+    const IntraProcessMessageInfo & message_info)
+  {
+    (void)message_info;
+    provide_intra_process_message(std::move(message));
+  }
+
+  /// Return true if a message given shared is kept shared until it is taken, false by default.
+  /**
+   * The intra process manager then gives the shared message to the
+   * subscription even if it takes the ownership of the messages, instead of a
+   * copy made right away, so that the message is only copied if it is still
+   * shared when it is taken.
+   */
+  virtual bool
+  stores_shared_messages() const
+  {
+    return false;
+  }
+};
+
+}  // namespace experimental
+}  // namespace rclcpp
+
+#endif  // RCLCPP__EXPERIMENTAL__SUBSCRIPTION_INTRA_PROCESS_INPUT_HPP_
@@ -0,0 +1,122 @@
+// Copyright 2021 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__EXPERIMENTAL__SUBSCRIPTION_SHARED_MEMORY_HPP_
+#define RCLCPP__EXPERIMENTAL__SUBSCRIPTION_SHARED_MEMORY_HPP_
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "rcl/wait.h"
+
+#include "rclcpp/context.hpp"
+#include "rclcpp/experimental/shared_memory_channel.hpp"
+#include "rclcpp/guard_condition.hpp"
+#include "rclcpp/macros.hpp"
+#include "rclcpp/visibility_control.hpp"
+#include "rclcpp/waitable.hpp"
+#include "rmw/types.h"
+
+namespace rclcpp
+{
+namespace experimental
+{
+
+/// Waitable delivering the messages of a shared memory channel to a subscription.
+/**
+ * Only the messages written after its creation are delivered.
+ * A thread waits for the messages to be written and triggers a guard
+ * condition to wake up the executor, which calls the handler for each
+ * message written since it last executed the waitable.
+ * The thread also keeps the reader of the channel alive.
+ */
+class SubscriptionSharedMemory : public rclcpp::Waitable
+{
+public:
+  RCLCPP_SMART_PTR_DEFINITIONS_NOT_COPYABLE(SubscriptionSharedMemory)
+
+  /// Called with the data of each message and the gid of its publisher.
+  using MessageHandler =
+    std::function<void (const std::vector<uint8_t> & data, const rmw_gid_t & publisher_gid)>;
+
+  /// Register a reader of the channel and start waiting for its messages.
+  RCLCPP_PUBLIC
+  SubscriptionSharedMemory(
+    SharedMemoryChannel::SharedPtr channel,
+    rclcpp::Context::SharedPtr context,
+    MessageHandler handler);
+
+  /// Stop waiting for messages and remove the reader of the channel.
+  RCLCPP_PUBLIC
+  ~SubscriptionSharedMemory() override;
+
+  RCLCPP_PUBLIC
+  size_t
+  get_number_of_ready_guard_conditions() override;
+
+  RCLCPP_PUBLIC
+  bool
+  add_to_wait_set(rcl_wait_set_t * wait_set) override;
+
+  /// Return true if messages were written which were not delivered yet.
+  RCLCPP_PUBLIC
+  bool
+  is_ready(rcl_wait_set_t * wait_set) override;
+
+  /// The messages are read by execute(), nothing is taken.
+  RCLCPP_PUBLIC
+  std::shared_ptr<void>
+  take_data() override;
+
+  /// Call the handler for each message written since the last execution.
+  RCLCPP_PUBLIC
+  void
+  execute(std::shared_ptr<void> & data) override;
+
+  /// Return the number of messages overwritten in the channel before they were delivered.
+  RCLCPP_PUBLIC
+  uint64_t
+  get_lost_message_count() const;
+
+  RCLCPP_PUBLIC
+  SharedMemoryChannel::SharedPtr
+  get_channel() const;
+
+private:
+  void
+  listen();
+
+  SharedMemoryChannel::SharedPtr channel_;
+  rclcpp::GuardCondition guard_condition_;
+  MessageHandler handler_;
+
+  /// Serializes the executions, which read the messages.
+  std::mutex execute_mutex_;
+  std::atomic<uint64_t> next_sequence_;
+  std::atomic<uint64_t> lost_message_count_;
+  std::vector<uint8_t> data_;
+
+  std::atomic<bool> stop_listening_;
+  std::thread listener_thread_;
+};
+
+}  // namespace experimental
+}  // namespace rclcpp
+
+#endif  // RCLCPP__EXPERIMENTAL__SUBSCRIPTION_SHARED_MEMORY_HPP_
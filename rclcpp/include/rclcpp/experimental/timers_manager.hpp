@@ -0,0 +1,233 @@
+// Copyright 2021 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__EXPERIMENTAL__TIMERS_MANAGER_HPP_
+#define RCLCPP__EXPERIMENTAL__TIMERS_MANAGER_HPP_
+
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "rclcpp/detail/timer_wheel.hpp"
+#include "rclcpp/macros.hpp"
+#include "rclcpp/timer.hpp"
+#include "rclcpp/visibility_control.hpp"
+
+namespace rclcpp
+{
+namespace experimental
+{
+
+/// Run timers from a dedicated thread, without going through a wait set.
+/**
+ * The timers are kept in a min-heap ordered by the steady time of their next
+ * call, so the thread only sleeps on a single condition variable until the
+ * nearest deadline and only looks at the timers which are due when it wakes up.
+ * Adding or removing a timer wakes the thread up so that it can sleep again
+ * until the new nearest deadline.
+ *
+ * For very large numbers of coarse timers, such as watchdogs which are
+ * mostly reset before they fire, the timers can be kept in a hierarchical
+ * timer wheel instead, by giving a resolution to the constructor.
+ * Adding, removing and rescheduling a timer is then O(1) instead of
+ * O(log n), at the cost of calling timers up to one resolution late.
+ * Resetting a timer does not touch the manager at all: the timer is only
+ * moved to its new deadline when its previous one is reached.
+ *
+ * When a timer is due, the manager calls TimerBase::call() on it and then
+ * either executes its callback on the manager thread, or, if an on ready
+ * callback was given, hands the timer to that callback so that an executor
+ * can execute it later with TimerBase::execute_callback().
+ *
+ * Timers with a slack, see TimerBase::get_slack(), are called at the latest
+ * at their deadline plus their slack.
+ * With the min-heap, a timer which is already due when another timer wakes
+ * the thread up is called in the same wakeup, so nearby expirations share
+ * one wakeup. With the timer wheel, they share the ticks they are rounded to.
+ *
+ * Deadlines are computed from the steady clock, so the manager is meant for
+ * timers with a steady clock.
+ * A canceled timer stays in the manager and is checked again periodically, so
+ * resetting it resumes its calls.
+ */
+class TimersManager
+{
+public:
+  RCLCPP_SMART_PTR_DEFINITIONS_NOT_COPYABLE(TimersManager)
+
+  /// Function called from the manager with a timer which was called and is ready to execute.
+  using OnReadyCallback = std::function<void (const rclcpp::TimerBase::SharedPtr &)>;
+
+  /// How often canceled timers are checked again to find out if they were reset.
+  static constexpr std::chrono::milliseconds canceled_timer_poll_period{100};
+
+  /// Constructor.
+  /**
+   * \param[in] on_ready_callback function called with every timer which is ready, if empty the
+   *   callbacks of the timers are executed by the manager itself.
+   * \param[in] resolution tick of the timer wheel holding the timers, or 0 to hold them in a
+   *   min-heap with exact deadlines.
+   * \throws std::invalid_argument if resolution is negative.
+   */
+  RCLCPP_PUBLIC
+  explicit TimersManager(
+    OnReadyCallback on_ready_callback = nullptr,
+    std::chrono::nanoseconds resolution = std::chrono::nanoseconds(0));
+
+  /// Destructor, stops the thread of the manager if it is running.
+  RCLCPP_PUBLIC
+  ~TimersManager();
+
+  /// Add a timer to the manager, nothing is done if it was already added.
+  /**
+   * The manager only holds a weak reference to the timer.
+   *
+   * \param[in] timer the timer to add.
+   * \throws std::invalid_argument if the timer is nullptr.
+   */
+  RCLCPP_PUBLIC
+  void
+  add_timer(const rclcpp::TimerBase::SharedPtr & timer);
+
+  /// Remove a timer from the manager, nothing is done if it was not added.
+  RCLCPP_PUBLIC
+  void
+  remove_timer(const rclcpp::TimerBase::SharedPtr & timer);
+
+  /// Remove all the timers from the manager.
+  RCLCPP_PUBLIC
+  void
+  clear();
+
+  /// Return the number of timers in the manager, including the ones which were destroyed.
+  RCLCPP_PUBLIC
+  size_t
+  size() const;
+
+  /// Start the thread which runs the timers.
+  /**
+   * \throws std::runtime_error if the thread is already running.
+   */
+  RCLCPP_PUBLIC
+  void
+  start();
+
+  /// Stop the thread which runs the timers and wait for it to exit.
+  /**
+   * Nothing is done if the thread is not running.
+   * Must not be called from the on ready callback or from a timer callback run by the manager.
+   */
+  RCLCPP_PUBLIC
+  void
+  stop();
+
+  /// Return true if the thread which runs the timers is running.
+  RCLCPP_PUBLIC
+  bool
+  is_running() const;
+
+  /// Return how long until a timer has to be called, or std::chrono::nanoseconds::max() if none.
+  /**
+   * The duration is negative if a timer is already late.
+   */
+  RCLCPP_PUBLIC
+  std::chrono::nanoseconds
+  get_head_timeout();
+
+  /// Run the timers which are due from the calling thread.
+  /**
+   * \return the number of timers which were ready.
+   * \throws std::runtime_error if the thread of the manager is running.
+   */
+  RCLCPP_PUBLIC
+  size_t
+  execute_ready_timers();
+
+private:
+  RCLCPP_DISABLE_COPY(TimersManager)
+
+  struct TimerEntry
+  {
+    /// When the timer becomes ready.
+    std::chrono::steady_clock::time_point deadline;
+    /// When the timer has to be called, the deadline plus the slack of the timer.
+    std::chrono::steady_clock::time_point latest_deadline;
+    const rclcpp::TimerBase * key = nullptr;
+    rclcpp::TimerBase::WeakPtr timer;
+  };
+
+  /// Order the heap so that its front is the entry with the nearest latest deadline.
+  static bool
+  later_deadline(const TimerEntry & lhs, const TimerEntry & rhs)
+  {
+    return lhs.latest_deadline > rhs.latest_deadline;
+  }
+
+  using TimerWheel = rclcpp::detail::TimerWheel<TimerEntry>;
+
+  /// Body of the thread of the manager.
+  void
+  run();
+
+  /// Return the nearest time at which a timer has to be called, mutex_ must be held.
+  std::chrono::steady_clock::time_point
+  get_head_deadline() const;
+
+  /// Move the timers which are due to due_entries_, mutex_ must be held.
+  void
+  pop_due_entries(std::chrono::steady_clock::time_point now);
+
+  /// Store the entries of due_entries_ again with their new deadline, mutex_ must be held.
+  void
+  push_due_entries();
+
+  /// Call the timers which are due and move them in ready_timers, mutex_ must be held.
+  void
+  collect_ready_timers(std::vector<rclcpp::TimerBase::SharedPtr> & ready_timers);
+
+  /// Hand the ready timers to the on ready callback or execute them, mutex_ must not be held.
+  void
+  dispatch_ready_timers(const std::vector<rclcpp::TimerBase::SharedPtr> & ready_timers);
+
+  OnReadyCallback on_ready_callback_;
+
+  mutable std::mutex mutex_;
+  std::condition_variable timers_updated_cv_;
+  /// True when the timers changed or the thread was asked to stop, guarded by mutex_.
+  bool timers_updated_ = false;
+  /// True while the thread should keep running, guarded by mutex_.
+  bool running_ = false;
+  /// Min-heap of the timers ordered by later_deadline if there is no wheel, guarded by mutex_.
+  std::vector<TimerEntry> heap_;
+  /// Timer wheel holding the timers if a resolution was given, guarded by mutex_.
+  std::unique_ptr<TimerWheel> wheel_;
+  /// Handles of the timers in wheel_, guarded by mutex_.
+  std::unordered_map<const rclcpp::TimerBase *, TimerWheel::Handle> wheel_handles_;
+  /// Entries which were due, reused from one collection to the next, guarded by mutex_.
+  std::vector<TimerEntry> due_entries_;
+  /// Wheel handles of due_entries_, guarded by mutex_.
+  std::vector<TimerWheel::Handle> due_handles_;
+
+  std::thread thread_;
+};
+
+}  // namespace experimental
+}  // namespace rclcpp
+
+#endif  // RCLCPP__EXPERIMENTAL__TIMERS_MANAGER_HPP_
@@ -0,0 +1,223 @@
+// Copyright 2021 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef RCLCPP__FLIGHT_RECORDER_HPP_
+#define RCLCPP__FLIGHT_RECORDER_HPP_
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "rcl/types.h"
+
+#include "rclcpp/macros.hpp"
+#include "rclcpp/serialized_message.hpp"
+#include "rclcpp/subscription_base.hpp"
+#include "rclcpp/subscription_options.hpp"
+#include "rclcpp/visibility_control.hpp"
+
+namespace rclcpp
+{
+
+namespace detail
+{
+struct FlightRecordingHeader;
+}  // namespace detail
+
+/// A topic recorded by a FlightRecorder.
+struct FlightRecorderTopic
+{
+  /// Name of the topic, as given to the subscription.
+  std::string name;
+  /// Type of the messages, e.g. "std_msgs/msg/String".
+  std::string type;
+};
+
+/// Options of a FlightRecorder.
+struct FlightRecorderOptions
+{
+  /// Bytes of the ring the messages are recorded in, which is allocated once.
+  /**
+   * Each message takes its serialized size plus 16 bytes, rounded up to 16 bytes.
+   * Once the ring is full, the oldest messages are overwritten.
+   */
+  size_t capacity = 64 * 1024 * 1024;
+
+  /// Age of the oldest messages written by FlightRecorder::dump().
+  std::chrono::nanoseconds duration{std::chrono::seconds(10)};
+
+  /// File the ring is mapped to, or empty to keep it in the memory of the process only.
+  /**
+   * The file is created, or truncated, and sized once.
+   * As the messages are written to the page cache of the file, the messages recorded before a
+   * crash of the process are still in the file, which can be read with
+   * FlightRecorder::read_recording().
+   * Only supported on POSIX systems.
+   */
+  std::string file_path;
+
+  /// Options of the subscriptions of the recorded topics.
+  /**
+   * Intraprocess communication is disabled for them: generic subscriptions only communicate
+   * intraprocess with generic publishers, and the other local publishers also publish to
+   * subscriptions outside of intraprocess communication.
+   */
+  rclcpp::SubscriptionOptions subscription_options;
+};
+
+/// A message read back from a recording.
+struct RecordedMessage
+{
+  /// Name of the topic the message was received on.
+  std::string topic_name;
+  /// Type of the message.
+  std::string topic_type;
+  /// System time the message was recorded at.
+  rcl_time_point_value_t receive_time;
+  /// The serialized message.
+  rclcpp::SerializedMessage serialized_message;
+};
+
+/// Keep the latest serialized messages of some topics in a ring of constant size.
+/**
+ * The messages are copied into a ring allocated when the recorder is created, optionally
+ * mapped to a file, so that recording a message does not allocate.
+ * They are recorded by the callbacks of generic subscriptions, so that the publishers of the
+ * topics never wait for the recorder, and the recording of concurrent callbacks is serialized
+ * by a mutex held while a message is copied.
+ *
+ * The recorded messages of the last FlightRecorderOptions::duration are written on demand by
+ * dump(), and the messages in a file mapped ring survive a crash of the process.
+ * Both the dumps and the mapped rings are read by read_recording().
+ *
+ * Use rclcpp::create_flight_recorder() to create one and subscribe to the topics.
+ */
+class FlightRecorder
+{
+public:
+  RCLCPP_SMART_PTR_DEFINITIONS_NOT_COPYABLE(FlightRecorder)
+
+  /// Allocate the ring, which does not subscribe to the topics.
+  /**
+   * \param[in] topics the recorded topics, whose indices are given to record().
+   * \param[in] options capacity of the ring, duration of the dumps and file of the ring.
+   * \throws std::invalid_argument if there is no topic, the capacity cannot hold a message or the
+   *   duration is not positive.
+   * \throws std::runtime_error if the file cannot be created and mapped.
+   */
+  RCLCPP_PUBLIC
+  FlightRecorder(
+    const std::vector<FlightRecorderTopic> & topics,
+    const FlightRecorderOptions & options);
+
+  /// Unmap the ring, the file keeps the messages recorded.
+  RCLCPP_PUBLIC
+  ~FlightRecorder();
+
+  /// Copy a serialized message of a topic into the ring, overwriting the oldest messages.
+  /**
+   * A message larger than the ring is dropped.
+   * This member function is thread-safe.
+   *
+   * \param[in] topic_index index of the topic in the topics given to the constructor.
+   * \param[in] serialized_message the message to copy.
+   * \param[in] receive_time system time the message was received at.
+   * \throws std::out_of_range if the topic index is out of range.
+   */
+  RCLCPP_PUBLIC
+  void
+  record(
+    size_t topic_index,
+    const rcl_serialized_message_t & serialized_message,
+    rcl_time_point_value_t receive_time);
+
+  /// Write the messages recorded within the last duration of the options to a file.
+  /**
+   * The recording of messages waits for the dump to be written.
+   *
+   * \param[in] file_path path of the file, created or truncated.
+   * \return the number of messages written.
+   * \throws std::runtime_error if the file cannot be written.
+   */
+  RCLCPP_PUBLIC
+  size_t
+  dump(const std::string & file_path) const;
+
+  /// Read the messages of a dump or of a file mapped ring, oldest first.
+  /**
+   * \param[in] file_path path of the file.
+   * \throws std::runtime_error if the file cannot be read, or is not a valid recording.
+   */
+  RCLCPP_PUBLIC
+  static std::vector<RecordedMessage>
+  read_recording(const std::string & file_path);
+
+  /// Return the recorded topics.
+  RCLCPP_PUBLIC
+  const std::vector<FlightRecorderTopic> &
+  get_topics() const;
+
+  /// Return the number of messages in the ring.
+  RCLCPP_PUBLIC
+  size_t
+  get_number_of_messages() const;
+
+  /// Return the number of messages recorded since the recorder was created.
+  RCLCPP_PUBLIC
+  uint64_t
+  get_recorded_message_count() const;
+
+  /// Return the number of messages dropped as they were larger than the ring.
+  RCLCPP_PUBLIC
+  uint64_t
+  get_dropped_message_count() const;
+
+  /// Keep the subscriptions of the topics alive as long as the recorder.
+  RCLCPP_PUBLIC
+  void
+  set_subscriptions(std::vector<rclcpp::SubscriptionBase::SharedPtr> subscriptions);
+
+private:
+  /// Free the oldest messages until size bytes follow the newest one.
+  void
+  reserve(uint64_t size);
+
+  const std::vector<FlightRecorderTopic> topics_;
+  const std::chrono::nanoseconds duration_;
+
+  /// The memory of the ring when it is not mapped to a file.
+  std::vector<uint8_t> memory_;
+  /// Start of the header, followed by the topic table and the ring.
+  uint8_t * base_;
+  size_t mapped_size_;
+  detail::FlightRecordingHeader * header_;
+  uint8_t * ring_;
+  uint64_t capacity_;
+
+  mutable std::mutex mutex_;
+  size_t number_of_messages_;
+  uint64_t recorded_message_count_;
+  uint64_t dropped_message_count_;
+
+  std::vector<rclcpp::SubscriptionBase::SharedPtr> subscriptions_;
+};
+
+}  // namespace rclcpp
+
+#endif  // RCLCPP__FLIGHT_RECORDER_HPP_
@@ -16,12 +16,17 @@
 #ifndef RCLCPP__GENERIC_PUBLISHER_HPP_
 #define RCLCPP__GENERIC_PUBLISHER_HPP_
 
+#include <cstddef>
+#include <cstdint>
+#include <functional>
 #include <memory>
 #include <string>
 
 #include "rcpputils/shared_library.hpp"
 
 #include "rclcpp/callback_group.hpp"
+#include "rclcpp/detail/resolve_use_intra_process.hpp"
+#include "rclcpp/experimental/intra_process_manager.hpp"
 #include "rclcpp/macros.hpp"
 #include "rclcpp/node_interfaces/node_base_interface.hpp"
 #include "rclcpp/node_interfaces/node_topics_interface.hpp"
@@ -39,7 +44,9 @@ namespace rclcpp
  * Since the type is not known at compile time, this is not a template, and the dynamic library
  * containing type support information has to be identified and loaded based on the type name.
  *
- * It does not support intra-process handling.
+ * With intra-process enabled, it delivers its serialized messages by pointer to the
+ * rclcpp::GenericSubscription instances of the same process, but not to typed subscriptions,
+ * which receive them through the middleware.
  */
 class GenericPublisher : public rclcpp::PublisherBase
 {
@@ -47,6 +54,13 @@ public:
   // cppcheck-suppress unknownMacro
   RCLCPP_SMART_PTR_DEFINITIONS(GenericPublisher)
 
+  /// Function writing the next chunk of a serialized message into chunk.
+  /**
+   * It writes at most capacity bytes, the size of the rest of the message,
+   * and returns the number of bytes written.
+   */
+  using ChunkWriter = std::function<size_t (uint8_t * chunk, size_t capacity)>;
+
   /// Constructor.
   /**
    * In order to properly publish to a topic, this publisher needs to be added to
@@ -63,7 +77,8 @@ public:
    * \param callback Callback for new messages of serialized form
    * \param options %Publisher options.
    * Not all publisher options are currently respected, the only relevant options for this
-   * publisher are `event_callbacks`, `use_default_callbacks`, and `%callback_group`.
+   * publisher are `event_callbacks`, `use_default_callbacks`, `use_intra_process_comm`,
+   * `%callback_group`, `throttling` and `skip_publish_without_subscribers`.
    */
   template<typename AllocatorT = std::allocator<void>>
   GenericPublisher(
@@ -80,6 +95,8 @@ public:
       options.template to_rcl_publisher_options<rclcpp::SerializedMessage>(qos)),
     ts_lib_(ts_lib)
   {
+    this->set_throttling(options.throttling);
+    this->set_skip_publish_without_subscribers(options.skip_publish_without_subscribers);
     // This is unfortunately duplicated with the code in publisher.hpp.
     // TODO(nnmm): Deduplicate by moving this into PublisherBase.
     if (options.event_callbacks.deadline_callback) {
@@ -108,16 +125,108 @@ public:
         // pass
       }
     }
+    // Setup continues in the post construction method, post_init_setup().
+  }
+
+  /// Called post construction, so that construction may continue after shared_from_this() works.
+  template<typename AllocatorT = std::allocator<void>>
+  void
+  post_init_setup(
+    rclcpp::node_interfaces::NodeBaseInterface * node_base,
+    const rclcpp::QoS & qos,
+    const rclcpp::PublisherOptionsWithAllocator<AllocatorT> & options)
+  {
+    // If needed, setup intra process communication.
+    if (rclcpp::detail::resolve_use_intra_process(options, *node_base)) {
+      auto context = node_base->get_context();
+      // Get the intra process manager instance for this context.
+      auto ipm = context->get_sub_context<rclcpp::experimental::IntraProcessManager>();
+      // Register the publisher with the intra process manager.
+      // The subscriptions with a keep all history bound their own buffers.
+      if (qos.history() == rclcpp::HistoryPolicy::KeepLast) {
+        if (qos.depth() == 0) {
+          throw std::invalid_argument(
+                  "intraprocess communication is not allowed with a zero qos history depth value");
+        }
+      } else if (qos.history() != rclcpp::HistoryPolicy::KeepAll) {
+        throw std::invalid_argument(
+                "intraprocess communication allowed only with keep last or keep all history "
+                "qos policy");
+      }
+      if (qos.durability() != rclcpp::DurabilityPolicy::Volatile) {
+        throw std::invalid_argument(
+                "intraprocess communication allowed only with volatile durability");
+      }
+      uint64_t intra_process_publisher_id =
+        ipm->template add_publisher<rclcpp::SerializedMessage>(this->shared_from_this());
+      this->setup_intra_process(intra_process_publisher_id, ipm);
+    }
   }
 
   RCLCPP_PUBLIC
   virtual ~GenericPublisher() = default;
 
   /// Publish a rclcpp::SerializedMessage.
+  /**
+   * The intra-process subscriptions receive a copy of the message.
+   */
   RCLCPP_PUBLIC
   void publish(const rclcpp::SerializedMessage & message);
 
+  /// Publish a shared rclcpp::SerializedMessage.
+  /**
+   * The intra-process subscriptions which do not require ownership of the
+   * message share it without copying its buffer, e.g. when relaying the
+   * messages of a rclcpp::GenericSubscription.
+   * The message must not be modified after being published.
+   */
+  RCLCPP_PUBLIC
+  void publish(std::shared_ptr<const rclcpp::SerializedMessage> message);
+
+  /// Return true, the messages of this publisher are serialized.
+  /// Publish a serialized message written chunk by chunk, e.g. while it is read from a file.
+  /**
+   * The chunks are written in place into the buffer of the message, allocated
+   * once with its size, so that only the serialized form of a large message
+   * is ever in memory, rather than also the message it is serialized from.
+   * The middleware sends the message once it is complete.
+   *
+   * \param[in] message_size the size of the serialized message, CDR encapsulation included.
+   * \param[in] write_chunk the function writing the chunks, in order, until the message is full.
+   * \throws std::runtime_error if write_chunk writes nothing before the message is complete.
+   */
+  RCLCPP_PUBLIC
+  void
+  publish_chunks(size_t message_size, const ChunkWriter & write_chunk);
+
+  /// Publish the serialized message stored in a buffer, e.g. a memory mapped file region.
+  /**
+   * The middleware reads the message from the buffer, which is not copied
+   * into a rclcpp::SerializedMessage first; only the intra-process
+   * subscriptions, which keep the messages, receive a copy of it.
+   *
+   * \param[in] buffer the serialized message, CDR encapsulation included.
+   * \param[in] size the size of the serialized message.
+   * \throws std::runtime_error if buffer is a null pointer.
+   */
+  RCLCPP_PUBLIC
+  void
+  publish_buffer(const uint8_t * buffer, size_t size);
+
+  RCLCPP_PUBLIC
+  bool
+  is_serialized() const override;
+
 private:
+  void
+  do_shared_publish(std::shared_ptr<const rclcpp::SerializedMessage> message);
+
+  void
+  do_inter_process_publish(const rclcpp::SerializedMessage & message);
+
+  void
+  do_inter_process_publish(const rcl_serialized_message_t & message);
+
   // The type support library should stay loaded, so it is stored in the GenericPublisher
   std::shared_ptr<rcpputils::SharedLibrary> ts_lib_;
 };
@@ -16,6 +16,8 @@
 #ifndef RCLCPP__GENERIC_SUBSCRIPTION_HPP_
 #define RCLCPP__GENERIC_SUBSCRIPTION_HPP_
 
+#include <cstddef>
+#include <cstdint>
 #include <functional>
 #include <memory>
 #include <string>
@@ -23,11 +25,17 @@
 #include "rcpputils/shared_library.hpp"
 
 #include "rclcpp/callback_group.hpp"
+#include "rclcpp/detail/resolve_intra_process_buffer_type.hpp"
+#include "rclcpp/detail/resolve_intra_process_qos.hpp"
+#include "rclcpp/detail/resolve_use_intra_process.hpp"
+#include "rclcpp/experimental/generic_subscription_intra_process.hpp"
+#include "rclcpp/experimental/intra_process_manager.hpp"
 #include "rclcpp/macros.hpp"
 #include "rclcpp/node_interfaces/node_base_interface.hpp"
 #include "rclcpp/node_interfaces/node_topics_interface.hpp"
 #include "rclcpp/qos.hpp"
 #include "rclcpp/serialized_message.hpp"
+#include "rclcpp/serialized_message_pool.hpp"
 #include "rclcpp/subscription_base.hpp"
 #include "rclcpp/typesupport_helpers.hpp"
 #include "rclcpp/visibility_control.hpp"
@@ -40,7 +48,9 @@ namespace rclcpp
  * Since the type is not known at compile time, this is not a template, and the dynamic library
  * containing type support information has to be identified and loaded based on the type name.
  *
- * It does not support intra-process handling.
+ * With intra-process enabled, it receives by pointer the serialized messages of the
+ * rclcpp::GenericPublisher instances of the same process, but not the messages of typed
+ * publishers, which it receives through the middleware.
  */
 class GenericSubscription : public rclcpp::SubscriptionBase
 {
@@ -48,6 +58,29 @@ public:
   // cppcheck-suppress unknownMacro
   RCLCPP_SMART_PTR_DEFINITIONS(GenericSubscription)
 
+  /// Function reading a chunk of a serialized message received.
+  /**
+   * The chunks of a message are given in order; the last one ends at
+   * message_size.
+   */
+  using ChunkCallback = std::function<void (
+        const uint8_t * chunk, size_t size, size_t offset, size_t message_size)>;
+
+  /// Return a callback giving the serialized messages received chunk by chunk to chunk_callback.
+  /**
+   * It is passed to the constructor, e.g. through
+   * rclcpp::Node::create_generic_subscription(), so that a large message,
+   * e.g. written to a file as it is read, is never copied as a whole.
+   * The message is recycled for the next one taken once its last chunk is read.
+   *
+   * \param[in] chunk_callback the function reading the chunks.
+   * \param[in] chunk_size the maximum size of the chunks.
+   * \throws std::invalid_argument if chunk_size is 0.
+   */
+  RCLCPP_PUBLIC
+  static std::function<void(std::shared_ptr<rclcpp::SerializedMessage>)>
+  make_chunk_callback(ChunkCallback chunk_callback, size_t chunk_size);
+
   /// Constructor.
   /**
    * In order to properly subscribe to a topic, this subscription needs to be added to
@@ -64,8 +97,10 @@ public:
    * \param callback Callback for new messages of serialized form
    * \param options %Subscription options.
    * Not all subscription options are currently respected, the only relevant options for this
-   * subscription are `event_callbacks`, `use_default_callbacks`, `ignore_local_publications`, and
-   * `%callback_group`.
+   * subscription are `event_callbacks`, `use_default_callbacks`, `ignore_local_publications`,
+   * `use_intra_process_comm`, `intra_process_buffer_type`, `%callback_group`, and the
+   * `serialized_message_filter` of `content_filter`, which also filters the intra-process
+   * messages.
    */
   template<typename AllocatorT = std::allocator<void>>
   GenericSubscription(
@@ -83,7 +118,7 @@ public:
       topic_name,
       options.template to_rcl_subscription_options<rclcpp::SerializedMessage>(qos),
       true),
-    callback_(callback),
+    callback_(filter_callback(callback, options.content_filter.serialized_message_filter)),
     ts_lib_(ts_lib)
   {
     // This is unfortunately duplicated with the code in subscription.hpp.
@@ -119,6 +154,32 @@ public:
         options.event_callbacks.message_lost_callback,
         RCL_SUBSCRIPTION_MESSAGE_LOST);
     }
+
+    // Setup intra process subscribing if requested.
+    if (rclcpp::detail::resolve_use_intra_process(options, *node_base)) {
+      using rclcpp::detail::resolve_intra_process_buffer_type;
+
+      // Check if the QoS is compatible with intra-process.
+      auto qos_profile = rclcpp::detail::resolve_intra_process_qos(get_actual_qos(), options);
+
+      auto context = node_base->get_context();
+      // The callback takes ownership of the messages, it cannot share them.
+      using rclcpp::experimental::GenericSubscriptionIntraProcess;
+      subscription_intra_process_ = std::make_shared<GenericSubscriptionIntraProcess>(
+        callback_,
+        context,
+        this->get_topic_name(),  // important to get like this, as it has the fully-qualified name
+        qos_profile,
+        resolve_intra_process_buffer_type(options.intra_process_buffer_type, false),
+        options.intra_process_keep_all);
+      subscription_intra_process_->set_drop_new_when_full(
+        options.intra_process_drop_new_when_full);
+
+      using rclcpp::experimental::IntraProcessManager;
+      auto ipm = context->get_sub_context<IntraProcessManager>();
+      uint64_t intra_process_subscription_id = ipm->add_subscription(subscription_intra_process_);
+      this->setup_intra_process(intra_process_subscription_id, ipm);
+    }
   }
 
   RCLCPP_PUBLIC
@@ -128,6 +189,7 @@ public:
   RCLCPP_PUBLIC
   std::shared_ptr<void> create_message() override;
 
+  /// Borrow a message of the pool of serialized messages, sized from the previous ones.
   RCLCPP_PUBLIC
   std::shared_ptr<rclcpp::SerializedMessage> create_serialized_message() override;
 
@@ -158,7 +220,17 @@ public:
 private:
   RCLCPP_DISABLE_COPY(GenericSubscription)
 
+  /// Return the callback, called only with the messages the filter accepts if there is one.
+  RCLCPP_PUBLIC
+  static std::function<void(std::shared_ptr<rclcpp::SerializedMessage>)>
+  filter_callback(
+    std::function<void(std::shared_ptr<rclcpp::SerializedMessage>)> callback,
+    std::function<bool(const rclcpp::SerializedMessage &)> filter);
+
   std::function<void(std::shared_ptr<rclcpp::SerializedMessage>)> callback_;
+  rclcpp::experimental::GenericSubscriptionIntraProcess::SharedPtr subscription_intra_process_;
+  // Recycles the messages taken from the middleware and their buffers.
+  rclcpp::SerializedMessagePool serialized_message_pool_;
   // The type support library should stay loaded, so it is stored in the GenericSubscription
   std::shared_ptr<rcpputils::SharedLibrary> ts_lib_;
 };
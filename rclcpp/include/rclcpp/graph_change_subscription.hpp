@@ -0,0 +1,155 @@
+// Copyright 2021 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__GRAPH_CHANGE_SUBSCRIPTION_HPP_
+#define RCLCPP__GRAPH_CHANGE_SUBSCRIPTION_HPP_
+
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "rcl/wait.h"
+#include "rmw/types.h"
+
+#include "rclcpp/event.hpp"
+#include "rclcpp/macros.hpp"
+#include "rclcpp/node_interfaces/node_graph_interface.hpp"
+#include "rclcpp/visibility_control.hpp"
+#include "rclcpp/waitable.hpp"
+
+namespace rclcpp
+{
+
+/// Kind of a change of the ROS graph.
+enum class GraphChangeType
+{
+  NodeAdded,
+  NodeRemoved,
+  EndpointAdded,
+  EndpointRemoved,
+};
+
+/// A change of the ROS graph, delivered by a GraphChangeSubscription.
+struct GraphChange
+{
+  /// What changed.
+  GraphChangeType type;
+
+  /// Name of the node which appeared or disappeared, or which owns the endpoint.
+  std::string node_name;
+
+  /// Namespace of the node which appeared or disappeared, or which owns the endpoint.
+  std::string node_namespace;
+
+  /// Topic of the endpoint as given to the subscription, empty for node changes.
+  std::string topic_name;
+
+  /// The endpoint added or removed, with its type, gid and QoS, empty for node changes.
+  std::optional<rclcpp::TopicEndpointInfo> endpoint_info;
+};
+
+/// Waitable delivering the changes of a part of the ROS graph to a callback.
+/**
+ * Instead of waiting on a graph event and querying the whole graph again, this
+ * keeps a snapshot of the nodes of the graph, if watched, and of the endpoints
+ * of the watched topics only.
+ * When the graph listener notifies the node of a graph change, which also
+ * wakes up the executors of the node, the snapshot is taken again and its
+ * differences with the previous one are given to the callback.
+ * Changes of the graph which do not concern the watched part are not delivered.
+ *
+ * Use rclcpp::create_graph_change_subscription() to create one and add it to a node.
+ */
+class GraphChangeSubscription : public rclcpp::Waitable
+{
+public:
+  RCLCPP_SMART_PTR_DEFINITIONS(GraphChangeSubscription)
+
+  using CallbackType = std::function<void (const std::vector<GraphChange> &)>;
+
+  /// Constructor, taking the first snapshot of the watched part of the graph.
+  /**
+   * \param[in] node_graph graph interface of the node whose graph events are used.
+   * \param[in] topic_names the topics whose publishers and subscriptions are watched,
+   *   expanded and remapped like in Node::get_publishers_info_by_topic().
+   * \param[in] watch_nodes whether the nodes appearing and disappearing are watched.
+   * \param[in] callback called with the changes of the watched part of the graph.
+   * \throws std::invalid_argument if node_graph is null or callback is empty.
+   * \throws anything the graph queries of node_graph can throw.
+   */
+  RCLCPP_PUBLIC
+  GraphChangeSubscription(
+    rclcpp::node_interfaces::NodeGraphInterface::SharedPtr node_graph,
+    const std::vector<std::string> & topic_names,
+    bool watch_nodes,
+    CallbackType callback);
+
+  RCLCPP_PUBLIC
+  ~GraphChangeSubscription() override = default;
+
+  /// Add nothing to the wait set, as the node's notify guard condition wakes it up instead.
+  RCLCPP_PUBLIC
+  bool
+  add_to_wait_set(rcl_wait_set_t * wait_set) override;
+
+  /// Return true if the graph changed since the last snapshot.
+  RCLCPP_PUBLIC
+  bool
+  is_ready(rcl_wait_set_t * wait_set) override;
+
+  /// Take a new snapshot and return its changes, or nullptr if the graph did not change.
+  RCLCPP_PUBLIC
+  std::shared_ptr<void>
+  take_data() override;
+
+  /// Call the callback with the changes, if any of them concerns the watched part of the graph.
+  RCLCPP_PUBLIC
+  void
+  execute(std::shared_ptr<void> & data) override;
+
+private:
+  RCLCPP_DISABLE_COPY(GraphChangeSubscription)
+
+  using Gid = std::array<uint8_t, RMW_GID_STORAGE_SIZE>;
+
+  struct Snapshot
+  {
+    std::set<std::pair<std::string, std::string>> nodes;
+    std::map<Gid, std::pair<std::string, rclcpp::TopicEndpointInfo>> endpoints;
+  };
+
+  Snapshot
+  take_snapshot() const;
+
+  rclcpp::node_interfaces::NodeGraphInterface::SharedPtr node_graph_;
+  std::vector<std::string> topic_names_;
+  bool watch_nodes_;
+  CallbackType callback_;
+  rclcpp::Event::SharedPtr graph_event_;
+
+  std::mutex snapshot_mutex_;
+  Snapshot snapshot_;
+};
+
+}  // namespace rclcpp
+
+#endif  // RCLCPP__GRAPH_CHANGE_SUBSCRIPTION_HPP_
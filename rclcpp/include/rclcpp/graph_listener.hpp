@@ -16,9 +16,11 @@
 #define RCLCPP__GRAPH_LISTENER_HPP_
 
 #include <atomic>
+#include <cstdint>
 #include <memory>
 #include <mutex>
 #include <thread>
+#include <utility>
 #include <vector>
 
 #include "rcl/guard_condition.h"
@@ -148,6 +150,24 @@ public:
   bool
   is_shutdown();
 
+  /// Return a value which changes each time a graph change is noticed.
+  /**
+   * Graph changes are only noticed while the listening thread waits on the
+   * graph guard condition of a node, i.e. while a node has graph users.
+   * As the middleware notifies every node of all the graph changes, a value
+   * which did not change means that the graph did not change since, with the
+   * delay the listening thread takes to wake up.
+   *
+   * This function is thread-safe and lock-free.
+   *
+   * \return the generation of the graph, or 0 if graph changes are not noticed.
+   */
+  uint64_t
+  get_graph_generation() const
+  {
+    return graph_generation_.load(std::memory_order_acquire);
+  }
+
 protected:
   /// Main function for the listening thread.
   RCLCPP_PUBLIC
@@ -186,6 +206,15 @@ private:
   mutable std::mutex node_graph_interfaces_barrier_mutex_;
   mutable std::mutex node_graph_interfaces_mutex_;
   std::vector<rclcpp::node_interfaces::NodeGraphInterface *> node_graph_interfaces_;
+  /// Graph guard condition of each node of node_graph_interfaces_, at the same position.
+  std::vector<const rcl_guard_condition_t *> graph_guard_conditions_;
+  /// Index in the wait set of the graph guard condition of each node put in it.
+  std::vector<std::pair<size_t, rclcpp::node_interfaces::NodeGraphInterface *>> wait_set_nodes_;
+
+  /// See get_graph_generation(), only changed by the listening thread.
+  std::atomic<uint64_t> graph_generation_{0};
+  /// Last generation stored in graph_generation_, other than 0.
+  uint64_t graph_change_count_ = 0;
 
   rcl_guard_condition_t interrupt_guard_condition_ = rcl_get_zero_initialized_guard_condition();
   rcl_wait_set_t wait_set_ = rcl_get_zero_initialized_wait_set();
@@ -15,11 +15,15 @@
 #ifndef RCLCPP__INIT_OPTIONS_HPP_
 #define RCLCPP__INIT_OPTIONS_HPP_
 
+#include <chrono>
 #include <memory>
 #include <mutex>
 
 #include "rcl/init_options.h"
+#include "rclcpp/allocation_tracking.hpp"
+#include "rclcpp/async_logging.hpp"
 #include "rclcpp/visibility_control.hpp"
+#include "rclcpp/worker_pool.hpp"
 
 namespace rclcpp
 {
@@ -63,6 +67,109 @@ public:
   InitOptions &
   auto_initialize_logging(bool initialize_logging);
 
+  /// Return the options of the tracking of the allocations made by the callbacks.
+  RCLCPP_PUBLIC
+  const allocation_tracking::AllocationTrackingOptions &
+  allocation_tracking() const;
+
+  /// Set the options of the tracking of the allocations made by the callbacks.
+  /**
+   * If enabled, the tracking starts when `rclcpp::Context::init` is called,
+   * see rclcpp::allocation_tracking.
+   */
+  RCLCPP_PUBLIC
+  InitOptions &
+  allocation_tracking(const allocation_tracking::AllocationTrackingOptions & options);
+
+  /// Return true if the phases of the startup are measured, false by default.
+  RCLCPP_PUBLIC
+  bool
+  startup_profiling() const;
+
+  /// Set the flag indicating if the phases of the startup are measured, return this.
+  /**
+   * If true, the measurements start when `rclcpp::Context::init` is called,
+   * and include the time of the init itself, see rclcpp::startup_profiling.
+   */
+  RCLCPP_PUBLIC
+  InitOptions &
+  startup_profiling(bool startup_profiling);
+
+  /// Return the options of the asynchronous logging.
+  RCLCPP_PUBLIC
+  const async_logging::AsyncLoggingOptions &
+  async_logging() const;
+
+  /// Set the options of the asynchronous logging.
+  /**
+   * If enabled, the messages are output by a dedicated thread from when
+   * `rclcpp::Context::init` configures the logging system, see rclcpp::async_logging.
+   * It has no effect if the logging is not initialized by this context, see
+   * auto_initialize_logging(), or was already initialized by another context.
+   * \throws std::invalid_argument if the capacity or the maximum message size is zero.
+   */
+  RCLCPP_PUBLIC
+  InitOptions &
+  async_logging(const async_logging::AsyncLoggingOptions & options);
+
+  /// Return the options of the worker pool of the context.
+  RCLCPP_PUBLIC
+  const WorkerPoolOptions &
+  worker_pool() const;
+
+  /// Set the options of the worker pool of the context, return this.
+  /**
+   * The pool is created by the first call of `rclcpp::Context::get_worker_pool`
+   * after `rclcpp::Context::init`, see rclcpp::WorkerPool.
+   */
+  RCLCPP_PUBLIC
+  InitOptions &
+  worker_pool(const WorkerPoolOptions & options);
+
+  /// Return true if the context is reusable.
+  RCLCPP_PUBLIC
+  bool
+  reusable_context() const;
+
+  /// Set the flag indicating if the context is reusable, return this.
+  /**
+   * If true, `rclcpp::Context::shutdown` keeps the underlying rcl context,
+   * and the middleware it initialized, like the DDS participant.
+   * The entities derived from the context, like nodes, are then not
+   * invalidated, and they must be destroyed by the user, but `rclcpp::ok()`
+   * returns false and the executors and the waits are interrupted.
+   * The next `rclcpp::Context::init` with this flag set and the same domain id
+   * reuses them, which is much faster than initializing the middleware again.
+   * This is meant for test suites and short lived tools initializing and
+   * shutting down rclcpp many times.
+   * The rcl context is finalized by the destructor of the context, or by
+   * an init without this flag or with another domain id.
+   */
+  RCLCPP_PUBLIC
+  InitOptions &
+  reusable_context(bool reusable_context);
+
+  /// Return the time the signal handler waits for the shutdown of the context, zero by default.
+  RCLCPP_PUBLIC
+  std::chrono::nanoseconds
+  sigint_shutdown_deadline() const;
+
+  /// Set the time the signal handler waits for the shutdown of the context on SIGINT, return this.
+  /**
+   * If greater than zero, the signal handler shuts the context down on a
+   * thread of its own, in parallel with the other contexts with a deadline,
+   * and waits for it up to the deadline only.
+   * Past the deadline, it logs an error and stops waiting for the shutdown,
+   * which goes on in the background, so that a context whose shutdown
+   * callbacks are slow does not delay the others or the next signal.
+   * Otherwise, the signal handler shuts the context down itself, waiting for
+   * it, once the contexts with a deadline are being shut down.
+   * It has no effect if shutdown_on_sigint is false.
+   */
+  RCLCPP_PUBLIC
+  InitOptions &
+  sigint_shutdown_deadline(std::chrono::nanoseconds sigint_shutdown_deadline);
+
   /// Assignment operator.
   RCLCPP_PUBLIC
   InitOptions &
@@ -107,6 +214,12 @@ private:
   mutable std::mutex init_options_mutex_;
   std::unique_ptr<rcl_init_options_t> init_options_;
   bool initialize_logging_{true};
+  bool reusable_context_{false};
+  std::chrono::nanoseconds sigint_shutdown_deadline_{0};
+  bool startup_profiling_{false};
+  allocation_tracking::AllocationTrackingOptions allocation_tracking_;
+  async_logging::AsyncLoggingOptions async_logging_;
+  WorkerPoolOptions worker_pool_;
 };
 
 }  // namespace rclcpp
@@ -23,11 +23,39 @@ namespace rclcpp
 enum class IntraProcessBufferType
 {
   /// Set the data type used in the intra-process buffer as std::shared_ptr<MessageT>
+  /**
+   * The message is shared with the other subscriptions until it is taken.
+   * A callback which owns the message then receives a copy only if it is
+   * still shared, otherwise the content of the message is moved to it.
+   */
   SharedPtr,
   /// Set the data type used in the intra-process buffer as std::unique_ptr<MessageT>
   UniquePtr,
   /// Set the data type used in the intra-process buffer as the same used in the callback
-  CallbackDefault
+  /**
+   * Callbacks taking the message by const reference share it, as SharedPtr.
+   */
+  CallbackDefault,
+  /// Same as SharedPtr, with a lock-free buffer which requires a single publishing thread
+  /**
+   * The buffer does not lock when messages are added or taken, but messages
+   * must not be published on the topic from several threads at the same time.
+   */
+  LockFreeSharedPtr,
+  /// Same as UniquePtr, with a lock-free buffer which requires a single publishing thread
+  LockFreeUniquePtr,
+  /// Same as CallbackDefault, with a lock-free buffer which requires a single publishing thread
+  LockFreeCallbackDefault,
+  /// Same as SharedPtr, with a lock-free buffer which several threads may publish to
+  /**
+   * Suited to topics with many publishers and a single subscription, where
+   * publishers would otherwise contend on the buffer mutex.
+   */
+  LockFreeMultiProducerSharedPtr,
+  /// Same as UniquePtr, with a lock-free buffer which several threads may publish to
+  LockFreeMultiProducerUniquePtr,
+  /// Same as CallbackDefault, with a lock-free buffer which several threads may publish to
+  LockFreeMultiProducerCallbackDefault
 };
 
 }  // namespace rclcpp
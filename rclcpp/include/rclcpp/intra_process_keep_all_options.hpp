@@ -0,0 +1,65 @@
+// Copyright 2021 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__INTRA_PROCESS_KEEP_ALL_OPTIONS_HPP_
+#define RCLCPP__INTRA_PROCESS_KEEP_ALL_OPTIONS_HPP_
+
+#include <chrono>
+#include <cstddef>
+
+namespace rclcpp
+{
+
+/// What publishing does when the intraprocess buffer of a keep all subscription is full
+enum class IntraProcessBackpressurePolicy
+{
+  /// Wait for the subscription to take a message, up to the maximum blocking time
+  /**
+   * The publisher then fails as with Fail.
+   * The subscription must be executed by another thread than the publishing one.
+   */
+  Block,
+  /// Throw rclcpp::exceptions::IntraProcessBufferFullError from the publish call
+  /**
+   * The subscriptions given the message before the full one keep it.
+   */
+  Fail,
+  /// Drop the oldest message of the buffer, as the buffers of a keep last history do
+  DropOldest
+};
+
+/// Options of the intraprocess buffer of a subscription with a keep all history.
+/**
+ * The buffer grows as messages are queued, up to max_messages, and keeps its
+ * storage once grown.
+ * It is mutex based whatever the IntraProcessBufferType, which only selects
+ * whether the messages are stored shared or owned.
+ *
+ * See rclcpp::experimental::buffers::KeepAllBufferImplementation.
+ */
+struct IntraProcessKeepAllOptions
+{
+  /// Maximum number of messages queued, which must be positive.
+  size_t max_messages = 1000;
+
+  /// What publishing does when max_messages messages are queued.
+  IntraProcessBackpressurePolicy backpressure = IntraProcessBackpressurePolicy::Block;
+
+  /// Longest time a publisher waits for room in the buffer with the Block policy.
+  std::chrono::nanoseconds max_blocking_time{std::chrono::seconds(1)};
+};
+
+}  // namespace rclcpp
+
+#endif  // RCLCPP__INTRA_PROCESS_KEEP_ALL_OPTIONS_HPP_
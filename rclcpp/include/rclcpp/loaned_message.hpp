@@ -103,6 +103,24 @@ public:
    * \param[in] allocator Allocator instance in case middleware can not allocate messages
    * \throws anything rclcpp::exceptions::throw_from_rcl_error can throw.
    */
+  /// Constructor of the LoanedMessage class, with a message borrowed from a pool.
+  /**
+   * This is used when the middleware cannot loan messages, instead of
+   * allocating a message: the message is kept by the pool while referenced,
+   * and reused once the reference of this instance, or the one of the message
+   * it released, is dropped.
+   *
+   * \param[in] pub rclcpp::Publisher instance to which the memory belongs
+   * \param[in] pooled_message the message borrowed from the pool
+   */
+  LoanedMessage(
+    const rclcpp::PublisherBase & pub,
+    std::shared_ptr<MessageT> pooled_message)
+  : pub_(pub),
+    message_(pooled_message.get()),
+    pooled_message_(std::move(pooled_message))
+  {}
+
   [[
     deprecated("used the LoanedMessage constructor that does not use a shared_ptr to the allocator")
   ]]
@@ -116,8 +134,11 @@ public:
   LoanedMessage(LoanedMessage<MessageT> && other)
   : pub_(std::move(other.pub_)),
     message_(std::move(other.message_)),
-    message_allocator_(std::move(other.message_allocator_))
-  {}
+    message_allocator_(std::move(other.message_allocator_)),
+    pooled_message_(std::move(other.pooled_message_))
+  {
+    other.message_ = nullptr;
+  }
 
   /// Destructor of the LoanedMessage class.
   /**
@@ -148,6 +169,9 @@ public:
           error_logger, "rcl_deallocate_loaned_message failed: %s", rcl_get_error_string().str);
         rcl_reset_error();
       }
+    } else if (pooled_message_) {
+      // the pool reuses the message once no longer referenced
+      pooled_message_.reset();
     } else {
       // call destructor before deallocating
       message_->~MessageT();
@@ -203,6 +227,14 @@ public:
       return std::unique_ptr<MessageT, std::function<void(MessageT *)>>(msg, [](MessageT *) {});
     }
 
+    if (pooled_message_) {
+      return std::unique_ptr<MessageT, std::function<void(MessageT *)>>(
+        msg,
+        [pooled_message = std::move(pooled_message_)](MessageT *) mutable {
+          pooled_message.reset();
+        });
+    }
+
     return std::unique_ptr<MessageT, std::function<void(MessageT *)>>(
       msg,
       [allocator = message_allocator_](MessageT * msg_ptr) mutable {
@@ -219,6 +251,9 @@ protected:
 
   MessageAllocator message_allocator_;
 
+  /// Message borrowed from the pool of the publisher, if it was not allocated nor loaned.
+  std::shared_ptr<MessageT> pooled_message_;
+
   /// Deleted copy constructor to preserve memory integrity.
   LoanedMessage(const LoanedMessage<MessageT> & other) = delete;
 };
@@ -15,6 +15,8 @@
 #ifndef RCLCPP__LOGGER_HPP_
 #define RCLCPP__LOGGER_HPP_
 
+#include <atomic>
+#include <cstdint>
 #include <memory>
 #include <string>
 
@@ -49,6 +51,18 @@ class NodeLogging;
 
 class Logger;
 
+namespace detail
+{
+/// \internal Generation of the logger levels, incremented when they may have changed.
+/**
+ * The loggers cache their effective level along with the generation it was
+ * computed for, see reset_logger_level_caches().
+ * It starts at 1, so that a cache which was never filled is invalid.
+ */
+RCLCPP_PUBLIC
+extern std::atomic<uint32_t> logger_levels_generation;
+}  // namespace detail
+
 /// Return a named logger.
 /**
  * The returned logger's name will include any naming conventions, such as a
@@ -88,6 +102,19 @@ RCLCPP_PUBLIC
 rcpputils::fs::path
 get_logging_directory();
 
+/// Invalidate the effective levels cached by the loggers.
+/**
+ * The loggers cache their effective level, so that the logging macros skip
+ * the disabled messages with a single comparison.
+ * The caches are invalidated by rclcpp::Logger::set_level(), and when a
+ * context configures or finalizes the logging system.
+ * This must be called after changing the logger levels through rcutils
+ * directly, like with rcutils_logging_set_default_logger_level().
+ */
+RCLCPP_PUBLIC
+void
+reset_logger_level_caches();
+
 class Logger
 {
 public:
@@ -112,16 +139,32 @@ private:
    * This cannot be called directly, see `rclcpp::get_logger` instead.
    */
   Logger()
-  : name_(nullptr) {}
+  : state_(nullptr) {}
 
   /// Constructor of a named logger.
   /**
    * This cannot be called directly, see `rclcpp::get_logger` instead.
    */
   explicit Logger(const std::string & name)
-  : name_(new std::string(name)) {}
+  : state_(std::make_shared<State>(name)) {}
 
-  std::shared_ptr<const std::string> name_;
+  /// Name and cached effective level, shared by the copies of a logger.
+  struct State
+  {
+    explicit State(const std::string & name)
+    : name(name) {}
+
+    const std::string name;
+    /// Generation in the upper 32 bits, effective level in the lower ones.
+    std::atomic<uint64_t> level_cache{0};
+  };
+
+  /// Compute the effective level and cache it, return if the severity is enabled.
+  RCLCPP_PUBLIC
+  bool
+  update_level_cache(int severity) const;
+
+  std::shared_ptr<State> state_;
 
 public:
   RCLCPP_PUBLIC
@@ -137,10 +180,36 @@ public:
   const char *
   get_name() const
   {
-    if (!name_) {
+    if (!state_) {
       return nullptr;
     }
-    return name_->c_str();
+    return state_->name.c_str();
+  }
+
+  /// Return true if the messages of the given severity are output by this logger.
+  /**
+   * The effective level of the logger is cached, until the cache is
+   * invalidated, see rclcpp::reset_logger_level_caches().
+   * The logging macros check it first, so that a disabled message costs a
+   * comparison with the cached level.
+   *
+   * \param[in] severity the severity of the message, like RCUTILS_LOG_SEVERITY_DEBUG
+   * \return true if the message would be output, or if this logger is
+   *   invalid, leaving the decision to rcutils.
+   */
+  bool
+  is_enabled_for(int severity) const
+  {
+    if (!state_) {
+      return true;
+    }
+    uint64_t cache = state_->level_cache.load(std::memory_order_relaxed);
+    if (static_cast<uint32_t>(cache >> 32) ==
+      detail::logger_levels_generation.load(std::memory_order_relaxed))
+    {
+      return severity >= static_cast<int>(cache & 0xffffffffu);
+    }
+    return update_level_cache(severity);
   }
 
   /// Return a logger that is a descendant of this logger.
@@ -159,10 +228,10 @@ public:
   Logger
   get_child(const std::string & suffix)
   {
-    if (!name_) {
+    if (!state_) {
       return Logger();
     }
-    return Logger(*name_ + "." + suffix);
+    return Logger(state_->name + "." + suffix);
   }
 
   /// Set level for current logger.
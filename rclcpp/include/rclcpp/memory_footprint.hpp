@@ -0,0 +1,104 @@
+// Copyright 2021 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__MEMORY_FOOTPRINT_HPP_
+#define RCLCPP__MEMORY_FOOTPRINT_HPP_
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "rclcpp/visibility_control.hpp"
+
+namespace rclcpp
+{
+
+namespace node_interfaces
+{
+class NodeBaseInterface;
+class NodeParametersInterface;
+}  // namespace node_interfaces
+
+/// Approximate memory used by an entity of a node, in bytes.
+/**
+ * Only the memory rclcpp allocates for the entity up front, or may fill up
+ * to a bound, is accounted for: the memory used by the middleware is not, and
+ * messages are counted with their size only, without the content of their
+ * sequences and strings.
+ */
+struct EntityMemoryFootprint
+{
+  /// Kind of the entity, like "subscription" or "parameters".
+  std::string kind;
+  /// Name of the entity, like the topic of a subscription.
+  std::string name;
+  /// Messages the intra-process buffers may hold, their capacity times the message size.
+  size_t intra_process_buffers = 0;
+  /// Messages preallocated by the message memory strategy.
+  size_t message_pools = 0;
+  /// Topic statistics collectors.
+  size_t topic_statistics = 0;
+  /// Names, values and descriptors of the parameters.
+  size_t parameters = 0;
+
+  /// Return the sum of the sizes.
+  RCLCPP_PUBLIC
+  size_t
+  get_total_size() const;
+};
+
+/// Approximate memory used by the entities of a node, see EntityMemoryFootprint.
+struct NodeMemoryFootprint
+{
+  /// Fully qualified name of the node.
+  std::string node_name;
+  std::vector<EntityMemoryFootprint> entities;
+
+  /// Return the sum of the sizes of the entities.
+  RCLCPP_PUBLIC
+  size_t
+  get_total_size() const;
+};
+
+/// Report the approximate memory used by the entities of the node.
+/**
+ * The subscriptions are found through the callback groups of the node, and
+ * the parameters through the parameters interface, if any.
+ *
+ * \param[in] node_base the node.
+ * \param[in] node_parameters the parameters of the node, may be null.
+ */
+RCLCPP_PUBLIC
+NodeMemoryFootprint
+get_memory_footprint(
+  node_interfaces::NodeBaseInterface & node_base,
+  node_interfaces::NodeParametersInterface * node_parameters = nullptr);
+
+/// Report the approximate memory used by the entities of a Node or a similar node type.
+template<typename NodeT>
+NodeMemoryFootprint
+get_memory_footprint(NodeT & node)
+{
+  return get_memory_footprint(
+    *node.get_node_base_interface(), node.get_node_parameters_interface().get());
+}
+
+/// Return the sizes of the footprint, a line per entity.
+RCLCPP_PUBLIC
+std::string
+to_string(const NodeMemoryFootprint & footprint);
+
+}  // namespace rclcpp
+
+#endif  // RCLCPP__MEMORY_FOOTPRINT_HPP_
@@ -15,6 +15,7 @@
 #ifndef RCLCPP__MEMORY_STRATEGIES_HPP_
 #define RCLCPP__MEMORY_STRATEGIES_HPP_
 
+#include "rclcpp/allocator/tlsf_pool.hpp"
 #include "rclcpp/memory_strategy.hpp"
 #include "rclcpp/visibility_control.hpp"
 
@@ -31,6 +32,20 @@ RCLCPP_PUBLIC
 memory_strategy::MemoryStrategy::SharedPtr
 create_default_strategy();
 
+/// Create a memory strategy allocating in bounded time from a TLSF pool.
+/**
+ * The strategy is an AllocatorMemoryStrategy using an
+ * rclcpp::allocator::TLSFAllocator, which also allocates the memory of the wait sets.
+ * To keep the messages and their intra-process copies out of the heap as
+ * well, give the publishers and subscriptions a TLSFAllocator of the same pool.
+ *
+ * \param[in] pool Pool to allocate from, a new pool of the default size if null.
+ * \return a MemoryStrategy sharedPtr
+ */
+RCLCPP_PUBLIC
+memory_strategy::MemoryStrategy::SharedPtr
+create_realtime_memory_strategy(rclcpp::allocator::TLSFPool::SharedPtr pool = nullptr);
+
 }  // namespace memory_strategies
 }  // namespace rclcpp
 
@@ -64,6 +64,22 @@ public:
   virtual void clear_handles() = 0;
   virtual void remove_null_handles(rcl_wait_set_t * wait_set) = 0;
 
+  /// Remember the handles gathered by the last call to collect_entities().
+  /**
+   * The executor calls this after a full collection so that, as long as no entity is added to
+   * or removed from its callback groups, the next waits can call restore_collected_handles()
+   * instead of walking all the callback groups again.
+   * Memory strategies that do not support this can keep the default, which does nothing.
+   */
+  virtual void cache_collected_handles() {}
+
+  /// Fill the handles with the ones remembered by cache_collected_handles().
+  /**
+   * \return true if the handles were restored, false if nothing was cached or if one of the
+   *   cached entities was destroyed, in which case collect_entities() has to be called instead.
+   */
+  virtual bool restore_collected_handles() {return false;}
+
   virtual void add_guard_condition(const rcl_guard_condition_t * guard_condition) = 0;
 
   virtual void remove_guard_condition(const rcl_guard_condition_t * guard_condition) = 0;
@@ -93,57 +109,106 @@ public:
     rclcpp::AnyExecutable & any_exec,
     const WeakCallbackGroupsToNodesMap & weak_groups_to_nodes) = 0;
 
+  /// Take the next ready entity, preferring the callback groups with a higher priority.
+  /**
+   * The entities of the callback group with the highest CallbackGroup::priority() are taken
+   * first, whatever their type.
+   * Between groups of the same priority, timers come first, then subscriptions, services,
+   * clients and waitables, as when calling the get_next_* functions in that order.
+   *
+   * The default implementation ignores the priorities and does just that.
+   */
+  virtual void
+  get_next_executable_by_priority(
+    rclcpp::AnyExecutable & any_exec,
+    const WeakCallbackGroupsToNodesMap & weak_groups_to_nodes);
+
+  /// Take the next ready entity, preferring the one whose deadline is the closest.
+  /**
+   * A timer is due at the end of its current period, its next call time plus its period.
+   * A subscription with a QoS deadline is due that deadline after it is considered, since the
+   * time its message arrived is not known.
+   * Other entities have no deadline and come after the ones which have one.
+   * Callback group priorities take precedence over deadlines, and the entities with the same
+   * deadline are taken in the order of get_next_executable_by_priority().
+   *
+   * The default implementation ignores the deadlines and calls
+   * get_next_executable_by_priority().
+   */
+  virtual void
+  get_next_executable_by_deadline(
+    rclcpp::AnyExecutable & any_exec,
+    const WeakCallbackGroupsToNodesMap & weak_groups_to_nodes);
+
+  /// Take the next ready entity, preferring the one taken the least recently.
+  /**
+   * The entities never taken come first, in the order of get_next_executable_by_priority().
+   * Callback group priorities take precedence over the order in which the entities were taken.
+   *
+   * The default implementation does not track the entities taken and calls
+   * get_next_executable_by_priority().
+   */
+  virtual void
+  get_next_executable_round_robin(
+    rclcpp::AnyExecutable & any_exec,
+    const WeakCallbackGroupsToNodesMap & weak_groups_to_nodes);
+
   virtual rcl_allocator_t
   get_allocator() = 0;
 
+  /// Return the approximate size of the memory reserved by the handles collected, in bytes.
+  /** Memory strategies that do not report it can keep the default, which returns 0. */
+  virtual size_t
+  get_memory_size() const {return 0;}
+
   static rclcpp::SubscriptionBase::SharedPtr
   get_subscription_by_handle(
-    std::shared_ptr<const rcl_subscription_t> subscriber_handle,
+    const std::shared_ptr<const rcl_subscription_t> & subscriber_handle,
     const WeakCallbackGroupsToNodesMap & weak_groups_to_nodes);
 
   static rclcpp::ServiceBase::SharedPtr
   get_service_by_handle(
-    std::shared_ptr<const rcl_service_t> service_handle,
+    const std::shared_ptr<const rcl_service_t> & service_handle,
     const WeakCallbackGroupsToNodesMap & weak_groups_to_nodes);
 
   static rclcpp::ClientBase::SharedPtr
   get_client_by_handle(
-    std::shared_ptr<const rcl_client_t> client_handle,
+    const std::shared_ptr<const rcl_client_t> & client_handle,
     const WeakCallbackGroupsToNodesMap & weak_groups_to_nodes);
 
   static rclcpp::TimerBase::SharedPtr
   get_timer_by_handle(
-    std::shared_ptr<const rcl_timer_t> timer_handle,
+    const std::shared_ptr<const rcl_timer_t> & timer_handle,
     const WeakCallbackGroupsToNodesMap & weak_groups_to_nodes);
 
   static rclcpp::node_interfaces::NodeBaseInterface::SharedPtr
   get_node_by_group(
-    rclcpp::CallbackGroup::SharedPtr group,
+    const rclcpp::CallbackGroup::SharedPtr & group,
     const WeakCallbackGroupsToNodesMap & weak_groups_to_nodes);
 
   static rclcpp::CallbackGroup::SharedPtr
   get_group_by_subscription(
-    rclcpp::SubscriptionBase::SharedPtr subscription,
+    const rclcpp::SubscriptionBase::SharedPtr & subscription,
     const WeakCallbackGroupsToNodesMap & weak_groups_to_nodes);
 
   static rclcpp::CallbackGroup::SharedPtr
   get_group_by_service(
-    rclcpp::ServiceBase::SharedPtr service,
+    const rclcpp::ServiceBase::SharedPtr & service,
     const WeakCallbackGroupsToNodesMap & weak_groups_to_nodes);
 
   static rclcpp::CallbackGroup::SharedPtr
   get_group_by_client(
-    rclcpp::ClientBase::SharedPtr client,
+    const rclcpp::ClientBase::SharedPtr & client,
     const WeakCallbackGroupsToNodesMap & weak_groups_to_nodes);
 
   static rclcpp::CallbackGroup::SharedPtr
   get_group_by_timer(
-    rclcpp::TimerBase::SharedPtr timer,
+    const rclcpp::TimerBase::SharedPtr & timer,
     const WeakCallbackGroupsToNodesMap & weak_groups_to_nodes);
 
   static rclcpp::CallbackGroup::SharedPtr
   get_group_by_waitable(
-    rclcpp::Waitable::SharedPtr waitable,
+    const rclcpp::Waitable::SharedPtr & waitable,
     const WeakCallbackGroupsToNodesMap & weak_groups_to_nodes);
 };
 
@@ -24,6 +24,7 @@
 #include "rclcpp/exceptions.hpp"
 #include "rclcpp/macros.hpp"
 #include "rclcpp/serialized_message.hpp"
+#include "rclcpp/serialized_message_pool.hpp"
 #include "rclcpp/visibility_control.hpp"
 
 #include "rcutils/logging_macros.h"
@@ -87,9 +88,10 @@ public:
     return std::allocate_shared<MessageT, MessageAlloc>(*message_allocator_.get());
   }
 
+  /// By default, reuse a serialized message of the pool, which has at least the given capacity.
   virtual std::shared_ptr<rclcpp::SerializedMessage> borrow_serialized_message(size_t capacity)
   {
-    return std::make_shared<rclcpp::SerializedMessage>(capacity);
+    return serialized_message_pool_->borrow_serialized_message(capacity);
   }
 
   virtual std::shared_ptr<rclcpp::SerializedMessage> borrow_serialized_message()
@@ -109,10 +111,18 @@ public:
     msg.reset();
   }
 
+  /// Return the approximate size of the messages preallocated by the strategy, in bytes.
+  /** By default, none is preallocated. */
+  virtual size_t get_pool_memory_size() const
+  {
+    return 0;
+  }
+
+  /// Give the serialized message back to the pool for reuse.
   virtual void return_serialized_message(
     std::shared_ptr<rclcpp::SerializedMessage> & serialized_msg)
   {
-    serialized_msg.reset();
+    serialized_message_pool_->return_serialized_message(serialized_msg);
   }
 
   std::shared_ptr<MessageAlloc> message_allocator_;
@@ -124,6 +134,8 @@ public:
   std::shared_ptr<BufferAlloc> buffer_allocator_;
   BufferDeleter buffer_deleter_;
   size_t default_buffer_capacity_ = 0;
+  std::shared_ptr<rclcpp::SerializedMessagePool> serialized_message_pool_ =
+    std::make_shared<rclcpp::SerializedMessagePool>();
 
   rcutils_allocator_t rcutils_allocator_;
 };
@@ -41,9 +41,11 @@
 #include "rclcpp/client.hpp"
 #include "rclcpp/clock.hpp"
 #include "rclcpp/context.hpp"
+#include "rclcpp/entity_creation_batch.hpp"
 #include "rclcpp/event.hpp"
 #include "rclcpp/generic_publisher.hpp"
 #include "rclcpp/generic_subscription.hpp"
+#include "rclcpp/intra_process_setting.hpp"
 #include "rclcpp/logger.hpp"
 #include "rclcpp/macros.hpp"
 #include "rclcpp/message_memory_strategy.hpp"
@@ -59,6 +61,7 @@
 #include "rclcpp/node_interfaces/node_waitables_interface.hpp"
 #include "rclcpp/node_options.hpp"
 #include "rclcpp/parameter.hpp"
+#include "rclcpp/parameter_handle.hpp"
 #include "rclcpp/publisher.hpp"
 #include "rclcpp/publisher_options.hpp"
 #include "rclcpp/qos.hpp"
@@ -142,11 +145,21 @@ public:
   get_logger() const;
 
   /// Create and return a callback group.
+  /**
+   * \param[in] group_type callback group type to create by this method.
+   * \param[in] automatically_add_to_executor_with_node A boolean that
+   *   determines whether a callback group is automatically added to an executor
+   *   with the node with which it is associated.
+   * \param[in] priority scheduling priority of the callback group, the ready
+   *   entities of groups with a higher priority are executed first.
+   * \return a callback group
+   */
   RCLCPP_PUBLIC
   rclcpp::CallbackGroup::SharedPtr
   create_callback_group(
     rclcpp::CallbackGroupType group_type,
-    bool automatically_add_to_executor_with_node = true);
+    bool automatically_add_to_executor_with_node = true,
+    int priority = 0);
 
   /// Iterate over the callback groups in the node, calling the given function on each valid one.
   /**
@@ -159,6 +172,17 @@ public:
   void
   for_each_callback_group(const node_interfaces::NodeBaseInterface::CallbackGroupFunction & func);
 
+  /// Defer the notifications of the entities created until the returned batch ends.
+  /**
+   * The executors spinning the node then collect its entities once for all
+   * the entities created during the batch, see rclcpp::EntityCreationBatch.
+   *
+   * \return the batch, which ends when it is destroyed.
+   */
+  RCLCPP_PUBLIC
+  rclcpp::EntityCreationBatch
+  create_entity_creation_batch();
+
   /// Create and return a Publisher.
   /**
    * The rclcpp::QoS has several convenient constructors, including a
@@ -232,19 +256,24 @@ public:
    * \param[in] period Time interval between triggers of the callback.
    * \param[in] callback User-defined callback function.
    * \param[in] group Callback group to execute this timer's callback in.
+   * \param[in] slack How late the timer may fire so that it is coalesced with other timers,
+   *   see rclcpp::TimerBase::get_slack().
    */
   template<typename DurationRepT = int64_t, typename DurationT = std::milli, typename CallbackT>
   typename rclcpp::WallTimer<CallbackT>::SharedPtr
   create_wall_timer(
     std::chrono::duration<DurationRepT, DurationT> period,
     CallbackT callback,
-    rclcpp::CallbackGroup::SharedPtr group = nullptr);
+    rclcpp::CallbackGroup::SharedPtr group = nullptr,
+    std::chrono::nanoseconds slack = std::chrono::nanoseconds(0));
 
   /// Create and return a Client.
   /**
    * \param[in] service_name The topic to service on.
    * \param[in] qos_profile rmw_qos_profile_t Quality of service profile for client.
    * \param[in] group Callback group to call the service.
+   * \param[in] use_intra_process_comm Whether to send the requests by pointer to the services
+   *   of the same process which use intra-process as well, defaults to the node setting.
    * \return Shared pointer to the created client.
    */
   template<typename ServiceT>
@@ -252,7 +281,8 @@ public:
   create_client(
     const std::string & service_name,
     const rmw_qos_profile_t & qos_profile = rmw_qos_profile_services_default,
-    rclcpp::CallbackGroup::SharedPtr group = nullptr);
+    rclcpp::CallbackGroup::SharedPtr group = nullptr,
+    rclcpp::IntraProcessSetting use_intra_process_comm = rclcpp::IntraProcessSetting::NodeDefault);
 
   /// Create and return a Service.
   /**
@@ -260,6 +290,8 @@ public:
    * \param[in] callback User-defined callback function.
    * \param[in] qos_profile rmw_qos_profile_t Quality of service profile for client.
    * \param[in] group Callback group to call the service.
+   * \param[in] use_intra_process_comm Whether to receive by pointer the requests of the clients
+   *   of the same process which use intra-process as well, defaults to the node setting.
    * \return Shared pointer to the created service.
    */
   template<typename ServiceT, typename CallbackT>
@@ -268,7 +300,8 @@ public:
     const std::string & service_name,
     CallbackT && callback,
     const rmw_qos_profile_t & qos_profile = rmw_qos_profile_services_default,
-    rclcpp::CallbackGroup::SharedPtr group = nullptr);
+    rclcpp::CallbackGroup::SharedPtr group = nullptr,
+    rclcpp::IntraProcessSetting use_intra_process_comm = rclcpp::IntraProcessSetting::NodeDefault);
 
   /// Create and return a GenericPublisher.
   /**
@@ -496,6 +529,28 @@ public:
     const std::map<std::string, ParameterT> & parameters,
     bool ignore_overrides = false);
 
+  /// Declare and initialize several parameters at once.
+  /**
+   * The parameters are declared in order, each with its default value and descriptor as
+   * with declare_parameter(), while locking the parameters of the node once.
+   * A single parameter event is published for all of them, instead of one per parameter.
+   *
+   * If a parameter fails to be declared, the parameters declared before it are undeclared,
+   * no event is published and the exception of declare_parameter() is thrown.
+   *
+   * \param[in] parameters The parameters with their default value and their descriptor.
+   * \param[in] ignore_overrides When `true`, the parameters overrides are ignored.
+   *    Default to `false`.
+   * \return The values of the parameters, in order.
+   * \throws the exceptions of declare_parameter().
+   */
+  RCLCPP_PUBLIC
+  std::vector<rclcpp::ParameterValue>
+  declare_parameters(
+    const std::vector<std::pair<rclcpp::Parameter, rcl_interfaces::msg::ParameterDescriptor>> &
+    parameters,
+    bool ignore_overrides = false);
+
   /// Declare and initialize several parameters with the same namespace and type.
   /**
    * This version will take a map where the value is a pair, with the default
@@ -662,6 +717,37 @@ public:
   rclcpp::Parameter
   get_parameter(const std::string & name) const;
 
+  /// Return a handle reading the value of a parameter without locking.
+  /**
+   * The handle is looked up by name once, then it reads the latest value of the
+   * parameter without locking the parameters of the node, see rclcpp::ParameterHandle.
+   * It is meant for the parameters read in callbacks at high rates.
+   *
+   * The value of the handle is not set while the parameter is not declared.
+   * Handles of the same parameter are shared while they are in use.
+   *
+   * \param[in] name The name of the parameter.
+   * \return The handle of the parameter.
+   * \throws rclcpp::exceptions::ParameterNotDeclaredException if the parameter
+   *   has not been declared and undeclared parameters are not allowed.
+   */
+  RCLCPP_PUBLIC
+  rclcpp::ParameterHandle::SharedPtr
+  get_parameter_handle(const std::string & name);
+
+  /// Return the declared parameters and the parameter overrides of the node.
+  /**
+   * The snapshot can be written to a file with rclcpp::write_parameter_snapshot(),
+   * and given to the node when it is started again, in
+   * rclcpp::NodeOptions::parameter_snapshot(), for the node to skip resolving its
+   * parameter overrides and validating its parameters, see rclcpp::ParameterSnapshot.
+   *
+   * \return The snapshot of the parameters of the node.
+   */
+  RCLCPP_PUBLIC
+  rclcpp::ParameterSnapshot
+  get_parameter_snapshot() const;
+
   /// Get the value of a parameter by the given name, and return true if it was set.
   /**
    * This method will never throw the
@@ -1296,16 +1382,44 @@ protected:
 private:
   RCLCPP_DISABLE_COPY(Node)
 
+  /// Return the graph interface, creating it on first use.
+  RCLCPP_PUBLIC
+  const rclcpp::node_interfaces::NodeGraphInterface::SharedPtr &
+  graph_interface() const;
+
+  /// Return the clock interface, creating it with the parameters on first use.
+  RCLCPP_PUBLIC
+  const rclcpp::node_interfaces::NodeClockInterface::SharedPtr &
+  clock_interface() const;
+
+  /// Return the parameters interface, creating it with the clock on first use.
+  RCLCPP_PUBLIC
+  const rclcpp::node_interfaces::NodeParametersInterface::SharedPtr &
+  parameters_interface() const;
+
+  /// Return the time source interface, creating it with the clock on first use.
+  RCLCPP_PUBLIC
+  const rclcpp::node_interfaces::NodeTimeSourceInterface::SharedPtr &
+  time_source_interface() const;
+
+  /// Create the clock, parameters and time source interfaces, which depend on each other.
+  RCLCPP_LOCAL
+  void
+  create_time_interfaces() const;
+
   rclcpp::node_interfaces::NodeBaseInterface::SharedPtr node_base_;
-  rclcpp::node_interfaces::NodeGraphInterface::SharedPtr node_graph_;
+  // Created on first use with NodeOptions::lazy_node_interfaces(), see the accessors above.
+  mutable rclcpp::node_interfaces::NodeGraphInterface::SharedPtr node_graph_;
   rclcpp::node_interfaces::NodeLoggingInterface::SharedPtr node_logging_;
   rclcpp::node_interfaces::NodeTimersInterface::SharedPtr node_timers_;
   rclcpp::node_interfaces::NodeTopicsInterface::SharedPtr node_topics_;
   rclcpp::node_interfaces::NodeServicesInterface::SharedPtr node_services_;
-  rclcpp::node_interfaces::NodeClockInterface::SharedPtr node_clock_;
-  rclcpp::node_interfaces::NodeParametersInterface::SharedPtr node_parameters_;
-  rclcpp::node_interfaces::NodeTimeSourceInterface::SharedPtr node_time_source_;
+  mutable rclcpp::node_interfaces::NodeClockInterface::SharedPtr node_clock_;
+  mutable rclcpp::node_interfaces::NodeParametersInterface::SharedPtr node_parameters_;
+  mutable rclcpp::node_interfaces::NodeTimeSourceInterface::SharedPtr node_time_source_;
   rclcpp::node_interfaces::NodeWaitablesInterface::SharedPtr node_waitables_;
+  mutable std::once_flag graph_created_;
+  mutable std::once_flag time_interfaces_created_;
 
   const rclcpp::NodeOptions node_options_;
   const std::string sub_namespace_;
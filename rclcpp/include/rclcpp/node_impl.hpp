@@ -110,14 +110,16 @@ typename rclcpp::WallTimer<CallbackT>::SharedPtr
 Node::create_wall_timer(
   std::chrono::duration<DurationRepT, DurationT> period,
   CallbackT callback,
-  rclcpp::CallbackGroup::SharedPtr group)
+  rclcpp::CallbackGroup::SharedPtr group,
+  std::chrono::nanoseconds slack)
 {
   return rclcpp::create_wall_timer(
     period,
     std::move(callback),
     group,
     this->node_base_.get(),
-    this->node_timers_.get());
+    this->node_timers_.get(),
+    slack);
 }
 
 template<typename ServiceT>
@@ -125,15 +127,17 @@ typename Client<ServiceT>::SharedPtr
 Node::create_client(
   const std::string & service_name,
   const rmw_qos_profile_t & qos_profile,
-  rclcpp::CallbackGroup::SharedPtr group)
+  rclcpp::CallbackGroup::SharedPtr group,
+  rclcpp::IntraProcessSetting use_intra_process_comm)
 {
   return rclcpp::create_client<ServiceT>(
     node_base_,
-    node_graph_,
+    graph_interface(),
     node_services_,
     extend_name_with_sub_namespace(service_name, this->get_sub_namespace()),
     qos_profile,
-    group);
+    group,
+    use_intra_process_comm);
 }
 
 template<typename ServiceT, typename CallbackT>
@@ -142,7 +146,8 @@ Node::create_service(
   const std::string & service_name,
   CallbackT && callback,
   const rmw_qos_profile_t & qos_profile,
-  rclcpp::CallbackGroup::SharedPtr group)
+  rclcpp::CallbackGroup::SharedPtr group,
+  rclcpp::IntraProcessSetting use_intra_process_comm)
 {
   return rclcpp::create_service<ServiceT, CallbackT>(
     node_base_,
@@ -150,7 +155,8 @@ Node::create_service(
     extend_name_with_sub_namespace(service_name, this->get_sub_namespace()),
     std::forward<CallbackT>(callback),
     qos_profile,
-    group);
+    group,
+    use_intra_process_comm);
 }
 
 template<typename AllocatorT>
@@ -228,6 +234,31 @@ Node::declare_parameter(
   ).get<ParameterT>();
 }
 
+namespace detail
+{
+
+/// Get the values of a batch of declared parameters as ParameterT, like declare_parameter().
+template<typename ParameterT>
+std::vector<ParameterT>
+get_declared_values(
+  const std::vector<std::pair<rclcpp::Parameter, rcl_interfaces::msg::ParameterDescriptor>> &
+  declarations,
+  const std::vector<rclcpp::ParameterValue> & values)
+{
+  std::vector<ParameterT> result;
+  result.reserve(values.size());
+  for (size_t i = 0; i < values.size(); ++i) {
+    try {
+      result.push_back(static_cast<ParameterT>(values[i].get<ParameterT>()));
+    } catch (const ParameterTypeException & ex) {
+      throw exceptions::InvalidParameterTypeException(declarations[i].first.get_name(), ex.what());
+    }
+  }
+  return result;
+}
+
+}  // namespace detail
+
 template<typename ParameterT>
 std::vector<ParameterT>
 Node::declare_parameters(
@@ -235,19 +266,17 @@ Node::declare_parameters(
   const std::map<std::string, ParameterT> & parameters,
   bool ignore_overrides)
 {
-  std::vector<ParameterT> result;
   std::string normalized_namespace = namespace_.empty() ? "" : (namespace_ + ".");
-  std::transform(
-    parameters.begin(), parameters.end(), std::back_inserter(result),
-    [this, &normalized_namespace, ignore_overrides](auto element) {
-      return this->declare_parameter(
-        normalized_namespace + element.first,
-        element.second,
-        rcl_interfaces::msg::ParameterDescriptor(),
-        ignore_overrides);
-    }
-  );
-  return result;
+  std::vector<std::pair<rclcpp::Parameter, rcl_interfaces::msg::ParameterDescriptor>>
+  declarations;
+  declarations.reserve(parameters.size());
+  for (const auto & element : parameters) {
+    declarations.emplace_back(
+      rclcpp::Parameter(normalized_namespace + element.first, element.second),
+      rcl_interfaces::msg::ParameterDescriptor());
+  }
+  return detail::get_declared_values<ParameterT>(
+    declarations, this->declare_parameters(declarations, ignore_overrides));
 }
 
 template<typename ParameterT>
@@ -260,21 +289,17 @@ Node::declare_parameters(
   > & parameters,
   bool ignore_overrides)
 {
-  std::vector<ParameterT> result;
   std::string normalized_namespace = namespace_.empty() ? "" : (namespace_ + ".");
-  std::transform(
-    parameters.begin(), parameters.end(), std::back_inserter(result),
-    [this, &normalized_namespace, ignore_overrides](auto element) {
-      return static_cast<ParameterT>(
-        this->declare_parameter(
-          normalized_namespace + element.first,
-          element.second.first,
-          element.second.second,
-          ignore_overrides)
-      );
-    }
-  );
-  return result;
+  std::vector<std::pair<rclcpp::Parameter, rcl_interfaces::msg::ParameterDescriptor>>
+  declarations;
+  declarations.reserve(parameters.size());
+  for (const auto & element : parameters) {
+    declarations.emplace_back(
+      rclcpp::Parameter(normalized_namespace + element.first, element.second.first),
+      element.second.second);
+  }
+  return detail::get_declared_values<ParameterT>(
+    declarations, this->declare_parameters(declarations, ignore_overrides));
 }
 
 template<typename ParameterT>
@@ -319,7 +344,7 @@ Node::get_parameters(
   std::map<std::string, ParameterT> & values) const
 {
   std::map<std::string, rclcpp::Parameter> params;
-  bool result = node_parameters_->get_parameters_by_prefix(prefix, params);
+  bool result = parameters_interface()->get_parameters_by_prefix(prefix, params);
   if (result) {
     for (const auto & param : params) {
       values[param.first] = static_cast<ParameterT>(param.second.get_value<ParameterT>());
@@ -15,10 +15,12 @@
 #ifndef RCLCPP__NODE_INTERFACES__NODE_BASE_HPP_
 #define RCLCPP__NODE_INTERFACES__NODE_BASE_HPP_
 
+#include <chrono>
 #include <functional>
 #include <memory>
 #include <mutex>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include "rcl/node.h"
@@ -30,6 +32,11 @@
 
 namespace rclcpp
 {
+namespace detail
+{
+class RosoutBatcher;
+}  // namespace detail
+
 namespace node_interfaces
 {
 
@@ -39,6 +46,18 @@ class NodeBase : public NodeBaseInterface
 public:
   RCLCPP_SMART_PTR_ALIASES_ONLY(NodeBase)
 
+  /**
+   * \param[in] rcl_allocator_state owner of the state of the allocator of the rcl node
+   *   options, like an rclcpp::allocator::Arena, kept alive as long as the rcl node handle.
+   * \param[in] rosout_batch_period if greater than zero and rosout is enabled in the rcl
+   *   node options, the records are published on /rosout in batches by rclcpp instead of
+   *   one by one by rcl, see rclcpp::NodeOptions::rosout_batch_period().
+   * \param[in] rosout_max_batch_size maximum number of records in a batch.
+   * \param[in] shared_rcl_node_handle if not null, the rcl node used instead of creating one,
+   *   see rclcpp::NodeOptions::shared_rcl_node_handle(); the rcl node options, allocator
+   *   state and rosout batching are then ignored.
+   * \throws std::invalid_argument if the shared rcl node handle is of another context.
+   */
   RCLCPP_PUBLIC
   NodeBase(
     const std::string & node_name,
@@ -46,7 +65,11 @@ public:
     rclcpp::Context::SharedPtr context,
     const rcl_node_options_t & rcl_node_options,
     bool use_intra_process_default,
-    bool enable_topic_statistics_default);
+    bool enable_topic_statistics_default,
+    std::shared_ptr<void> rcl_allocator_state = nullptr,
+    std::chrono::nanoseconds rosout_batch_period = std::chrono::nanoseconds::zero(),
+    size_t rosout_max_batch_size = 64,
+    std::shared_ptr<rcl_node_t> shared_rcl_node_handle = nullptr);
 
   RCLCPP_PUBLIC
   virtual
@@ -88,7 +111,8 @@ public:
   rclcpp::CallbackGroup::SharedPtr
   create_callback_group(
     rclcpp::CallbackGroupType group_type,
-    bool automatically_add_to_executor_with_node = true) override;
+    bool automatically_add_to_executor_with_node = true,
+    int priority = 0) override;
 
   RCLCPP_PUBLIC
   rclcpp::CallbackGroup::SharedPtr
@@ -121,6 +145,18 @@ public:
   std::unique_lock<std::recursive_mutex>
   acquire_notify_guard_condition_lock() const override;
 
+  RCLCPP_PUBLIC
+  void
+  start_deferring_entity_notifications() override;
+
+  RCLCPP_PUBLIC
+  void
+  stop_deferring_entity_notifications() override;
+
+  RCLCPP_PUBLIC
+  bool
+  defer_entity_notification() override;
+
   RCLCPP_PUBLIC
   bool
   get_use_intra_process_default() const override;
@@ -128,6 +164,11 @@ public:
   bool
   get_enable_topic_statistics_default() const override;
 
+  /// Expand and remap a given topic or service name.
+  /**
+   * The names resolved are cached per node, the remapping rules of a node
+   * being fixed once it is created.
+   */
   std::string
   resolve_topic_or_service_name(
     const std::string & name, bool is_service, bool only_expand = false) const override;
@@ -135,11 +176,32 @@ public:
 private:
   RCLCPP_DISABLE_COPY(NodeBase)
 
+  /// Create the rcl node of this node, and the batcher of its rosout records if needed.
+  RCLCPP_LOCAL
+  void
+  create_rcl_node(
+    const std::string & node_name,
+    const std::string & namespace_,
+    const rcl_node_options_t & rcl_node_options,
+    std::shared_ptr<void> rcl_allocator_state,
+    std::chrono::nanoseconds rosout_batch_period,
+    size_t rosout_max_batch_size);
+
   rclcpp::Context::SharedPtr context_;
   bool use_intra_process_default_;
   bool enable_topic_statistics_default_;
 
   std::shared_ptr<rcl_node_t> node_handle_;
+  /// Set if node_handle_ is shared with other nodes, whose names are then kept here.
+  bool rcl_node_handle_is_shared_ = false;
+  std::string node_name_;
+  std::string node_namespace_;
+  std::string fully_qualified_name_;
+  std::shared_ptr<rclcpp::detail::RosoutBatcher> rosout_batcher_;
+
+  /// Names resolved by resolve_topic_or_service_name(), by is_service and only_expand.
+  mutable std::mutex resolved_names_mutex_;
+  mutable std::unordered_map<std::string, std::string> resolved_names_[2][2];
 
   rclcpp::CallbackGroup::SharedPtr default_callback_group_;
   std::mutex callback_groups_mutex_;
@@ -151,6 +213,10 @@ private:
   mutable std::recursive_mutex notify_guard_condition_mutex_;
   rcl_guard_condition_t notify_guard_condition_ = rcl_get_zero_initialized_guard_condition();
   bool notify_guard_condition_is_valid_;
+  /// Deferrals of the entity notifications in progress, guarded by the notify mutex.
+  size_t entity_notification_deferrals_ = 0;
+  /// True if an entity notification was deferred, guarded by the notify mutex.
+  bool entity_notification_pending_ = false;
 };
 
 }  // namespace node_interfaces
@@ -103,12 +103,16 @@ public:
   get_shared_rcl_node_handle() const = 0;
 
   /// Create and return a callback group.
+  /**
+   * \sa rclcpp::CallbackGroup::CallbackGroup
+   */
   RCLCPP_PUBLIC
   virtual
   rclcpp::CallbackGroup::SharedPtr
   create_callback_group(
     rclcpp::CallbackGroupType group_type,
-    bool automatically_add_to_executor_with_node = true) = 0;
+    bool automatically_add_to_executor_with_node = true,
+    int priority = 0) = 0;
 
   /// Return the default callback group.
   RCLCPP_PUBLIC
@@ -160,6 +164,45 @@ public:
   std::unique_lock<std::recursive_mutex>
   acquire_notify_guard_condition_lock() const = 0;
 
+  /// Start deferring the notifications of the entities added to the node.
+  /**
+   * Until as many calls to stop_deferring_entity_notifications() are made,
+   * adding entities to the node does not notify the executors, so that they
+   * collect the entities once for all of them.
+   * See rclcpp::EntityCreationBatch.
+   *
+   * The default implementation never defers the notifications.
+   */
+  RCLCPP_PUBLIC
+  virtual
+  void
+  start_deferring_entity_notifications() {}
+
+  /// Stop deferring the notifications, see start_deferring_entity_notifications().
+  /**
+   * Once no more deferral is in progress, the notify guard condition is
+   * triggered if entities were added in the meantime.
+   *
+   * \throws rclcpp::exceptions::RCLError if the guard condition cannot be triggered.
+   */
+  RCLCPP_PUBLIC
+  virtual
+  void
+  stop_deferring_entity_notifications() {}
+
+  /// Return true if the notification of an entity being added is to be deferred.
+  /**
+   * This should be called with the lock of acquire_notify_guard_condition_lock()
+   * held, the notify guard condition is not to be triggered if it returns true.
+   */
+  RCLCPP_PUBLIC
+  virtual
+  bool
+  defer_entity_notification()
+  {
+    return false;
+  }
+
   /// Return the default preference for using intra process communication.
   RCLCPP_PUBLIC
   virtual
@@ -16,6 +16,10 @@
 #define RCLCPP__NODE_INTERFACES__NODE_GRAPH_HPP_
 
 #include <chrono>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <list>
 #include <map>
 #include <memory>
 #include <mutex>
@@ -35,6 +39,11 @@
 namespace rclcpp
 {
 
+namespace detail
+{
+class GraphCache;
+}  // namespace detail
+
 namespace graph_listener
 {
 class GraphListener;
@@ -49,8 +58,16 @@ class NodeGraph : public NodeGraphInterface
 public:
   RCLCPP_SMART_PTR_ALIASES_ONLY(NodeGraph)
 
+  /// Constructor.
+  /**
+   * \param[in] node_base the base interface of the node.
+   * \param[in] use_graph_cache whether the results of the graph queries are
+   *   cached, see rclcpp::NodeOptions::use_graph_cache().
+   */
   RCLCPP_PUBLIC
-  explicit NodeGraph(rclcpp::node_interfaces::NodeBaseInterface * node_base);
+  explicit NodeGraph(
+    rclcpp::node_interfaces::NodeBaseInterface * node_base,
+    bool use_graph_cache = false);
 
   RCLCPP_PUBLIC
   virtual
@@ -108,6 +125,12 @@ public:
     rclcpp::Event::SharedPtr event,
     std::chrono::nanoseconds timeout) override;
 
+  RCLCPP_PUBLIC
+  bool
+  wait_for_graph_predicate(
+    std::function<bool()> predicate,
+    std::chrono::nanoseconds timeout) override;
+
   RCLCPP_PUBLIC
   size_t
   count_graph_users() const override;
@@ -144,6 +167,26 @@ private:
   /// Number of graph events out on loan, used to determine if the graph should be monitored.
   /** graph_users_count_ is atomic so that it can be accessed without acquiring the graph_mutex_ */
   std::atomic_size_t graph_users_count_;
+
+  /// A thread in wait_for_graph_predicate(), woken up once its predicate holds.
+  struct GraphPredicateWaiter
+  {
+    std::function<bool()> predicate;
+    bool satisfied = false;
+    std::exception_ptr exception;
+    std::condition_variable cv;
+  };
+  /// Threads in wait_for_graph_predicate(), guarded by graph_mutex_.
+  std::list<GraphPredicateWaiter *> graph_predicate_waiters_;
+
+  /// Return the graph cache if it is used and still invalidated by the graph listener.
+  rclcpp::detail::GraphCache *
+  get_graph_cache() const;
+
+  /// Graph query results shared across the nodes of the context, if the cache is used.
+  std::shared_ptr<rclcpp::detail::GraphCache> graph_cache_;
+  /// Graph event keeping the node watched by the graph listener while it uses the cache.
+  rclcpp::Event::SharedPtr graph_cache_event_;
 };
 
 }  // namespace node_interfaces
@@ -18,6 +18,7 @@
 #include <algorithm>
 #include <array>
 #include <chrono>
+#include <functional>
 #include <map>
 #include <string>
 #include <utility>
@@ -271,6 +272,26 @@ public:
     rclcpp::Event::SharedPtr event,
     std::chrono::nanoseconds timeout) = 0;
 
+  /// Wait for a condition on the graph to hold, checking it only when the graph changes.
+  /**
+   * The predicate is checked right away, and then by the graph listener on each
+   * change of the graph, so that the calling thread is only woken up once the
+   * predicate holds, rather than on every graph change like with
+   * wait_for_graph_change().
+   * It should therefore be quick, like checking whether a service is available.
+   *
+   * \param[in] predicate condition on the graph to wait for.
+   * \param[in] timeout maximum time to wait, or a negative value to wait forever.
+   * \return true if the predicate holds, false on timeout or if the context was shut down.
+   * \throws anything the predicate throws.
+   */
+  RCLCPP_PUBLIC
+  virtual
+  bool
+  wait_for_graph_predicate(
+    std::function<bool()> predicate,
+    std::chrono::nanoseconds timeout) = 0;
+
   /// Return the number of on loan graph events, see get_graph_event().
   /**
    * This is typically only used by the rclcpp::graph_listener::GraphListener.
@@ -16,6 +16,7 @@
 #define RCLCPP__NODE_INTERFACES__NODE_LOGGING_HPP_
 
 #include <memory>
+#include <string>
 
 #include "rclcpp/logger.hpp"
 #include "rclcpp/macros.hpp"
@@ -56,6 +57,7 @@ private:
   rclcpp::node_interfaces::NodeBaseInterface * node_base_;
 
   rclcpp::Logger logger_;
+  std::string logger_name_;
 };
 
 }  // namespace node_interfaces
@@ -15,10 +15,16 @@
 #ifndef RCLCPP__NODE_INTERFACES__NODE_PARAMETERS_HPP_
 #define RCLCPP__NODE_INTERFACES__NODE_PARAMETERS_HPP_
 
+#include <chrono>
+#include <condition_variable>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <list>
+#include <set>
 #include <string>
+#include <thread>
+#include <utility>
 #include <vector>
 
 #include "rcutils/macros.h"
@@ -35,7 +41,9 @@
 #include "rclcpp/node_interfaces/node_services_interface.hpp"
 #include "rclcpp/node_interfaces/node_topics_interface.hpp"
 #include "rclcpp/parameter.hpp"
+#include "rclcpp/parameter_handle.hpp"
 #include "rclcpp/parameter_service.hpp"
+#include "rclcpp/parameter_snapshot.hpp"
 #include "rclcpp/publisher.hpp"
 #include "rclcpp/visibility_control.hpp"
 
@@ -97,7 +105,9 @@ public:
     const rclcpp::QoS & parameter_event_qos,
     const rclcpp::PublisherOptionsBase & parameter_event_publisher_options,
     bool allow_undeclared_parameters,
-    bool automatically_declare_parameters_from_overrides);
+    bool automatically_declare_parameters_from_overrides,
+    std::chrono::nanoseconds parameter_event_coalescing_period = std::chrono::nanoseconds(0),
+    std::shared_ptr<const rclcpp::ParameterSnapshot> parameter_snapshot = nullptr);
 
   RCLCPP_PUBLIC
   virtual
@@ -140,6 +150,13 @@ public:
     rcl_interfaces::msg::ParameterDescriptor(),
     bool ignore_override = false) override;
 
+  RCLCPP_PUBLIC
+  std::vector<rclcpp::ParameterValue>
+  declare_parameters(
+    const std::vector<std::pair<rclcpp::Parameter, rcl_interfaces::msg::ParameterDescriptor>> &
+    parameters,
+    bool ignore_overrides = false) override;
+
   RCLCPP_PUBLIC
   void
   undeclare_parameter(const std::string & name) override;
@@ -172,6 +189,10 @@ public:
     const std::string & name,
     rclcpp::Parameter & parameter) const override;
 
+  RCLCPP_PUBLIC
+  rclcpp::ParameterHandle::SharedPtr
+  get_parameter_handle(const std::string & name) override;
+
   RCLCPP_PUBLIC
   bool
   get_parameters_by_prefix(
@@ -203,11 +224,27 @@ public:
   const std::map<std::string, rclcpp::ParameterValue> &
   get_parameter_overrides() const override;
 
+  RCLCPP_PUBLIC
+  rclcpp::ParameterSnapshot
+  get_parameter_snapshot() const override;
+
   using CallbacksContainerType = std::list<OnSetParametersCallbackHandle::WeakPtr>;
 
 private:
   RCLCPP_DISABLE_COPY(NodeParameters)
 
+  /// Publish the current value of a parameter to its handle, if it has one.
+  void
+  update_parameter_handle(const std::string & name);
+
+  /// Publish a parameter event, or merge it into the pending one if events are coalesced.
+  void
+  publish_parameter_event(rcl_interfaces::msg::ParameterEvent & parameter_event);
+
+  /// Publish the pending parameter event once per coalescing period.
+  void
+  run_coalesced_events();
+
   mutable std::recursive_mutex mutex_;
 
   // There are times when we don't want to allow modifications to parameters
@@ -221,12 +258,26 @@ private:
 
   std::map<std::string, ParameterInfo> parameters_;
 
+  // Handles of the parameters, which are released when no longer used
+  std::map<std::string, std::weak_ptr<rclcpp::ParameterHandle>> parameter_handles_;
+
   std::map<std::string, rclcpp::ParameterValue> parameter_overrides_;
 
+  // Parameters of the snapshot the node was constructed with, which were not declared again yet
+  std::set<std::string> restored_parameters_;
+
   bool allow_undeclared_ = false;
 
   Publisher<rcl_interfaces::msg::ParameterEvent>::SharedPtr events_publisher_;
 
+  // Parameter event coalescing, which is disabled with a period of zero
+  std::chrono::nanoseconds event_coalescing_period_;
+  rcl_interfaces::msg::ParameterEvent pending_event_;
+  std::mutex pending_event_mutex_;
+  std::condition_variable pending_event_cv_;
+  bool stop_coalesced_events_{false};
+  std::thread coalesced_events_thread_;
+
   std::shared_ptr<ParameterService> parameter_service_;
 
   std::string combined_name_;
@@ -18,6 +18,7 @@
 #include <map>
 #include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "rcl_interfaces/msg/list_parameters_result.hpp"
@@ -26,6 +27,8 @@
 
 #include "rclcpp/macros.hpp"
 #include "rclcpp/parameter.hpp"
+#include "rclcpp/parameter_handle.hpp"
+#include "rclcpp/parameter_snapshot.hpp"
 #include "rclcpp/visibility_control.hpp"
 
 namespace rclcpp
@@ -103,6 +106,18 @@ public:
     rcl_interfaces::msg::ParameterDescriptor(),
     bool ignore_override = false) = 0;
 
+  /// Declare several parameters at once, with a single parameter event.
+  /**
+   * \sa rclcpp::Node::declare_parameters
+   */
+  RCLCPP_PUBLIC
+  virtual
+  std::vector<rclcpp::ParameterValue>
+  declare_parameters(
+    const std::vector<std::pair<rclcpp::Parameter, rcl_interfaces::msg::ParameterDescriptor>> &
+    parameters,
+    bool ignore_overrides = false) = 0;
+
   /// Undeclare a parameter.
   /**
    * \sa rclcpp::Node::undeclare_parameter
@@ -176,6 +191,15 @@ public:
     const std::string & name,
     rclcpp::Parameter & parameter) const = 0;
 
+  /// Return a handle reading the value of a parameter without locking.
+  /**
+   * \sa rclcpp::Node::get_parameter_handle
+   */
+  RCLCPP_PUBLIC
+  virtual
+  rclcpp::ParameterHandle::SharedPtr
+  get_parameter_handle(const std::string & name) = 0;
+
   /// Get all parameters that have the specified prefix into the parameters map.
   /*
    * \param[in] prefix the name of the prefix to look for.
@@ -230,6 +254,15 @@ public:
   virtual
   const std::map<std::string, rclcpp::ParameterValue> &
   get_parameter_overrides() const = 0;
+
+  /// Return the declared parameters and the parameter overrides, to restart the node with.
+  /**
+   * \sa rclcpp::Node::get_parameter_snapshot
+   */
+  RCLCPP_PUBLIC
+  virtual
+  rclcpp::ParameterSnapshot
+  get_parameter_snapshot() const = 0;
 };
 
 }  // namespace node_interfaces
@@ -15,7 +15,11 @@
 #ifndef RCLCPP__NODE_INTERFACES__NODE_TOPICS_HPP_
 #define RCLCPP__NODE_INTERFACES__NODE_TOPICS_HPP_
 
+#include <memory>
+#include <mutex>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "rcl/publisher.h"
 #include "rcl/subscription.h"
@@ -26,6 +30,7 @@
 #include "rclcpp/node_interfaces/node_topics_interface.hpp"
 #include "rclcpp/publisher.hpp"
 #include "rclcpp/publisher_factory.hpp"
+#include "rclcpp/qos_event.hpp"
 #include "rclcpp/visibility_control.hpp"
 
 namespace rclcpp
@@ -88,8 +93,21 @@ public:
 private:
   RCLCPP_DISABLE_COPY(NodeTopics)
 
+  /// Add event handlers to the waitable multiplexing the event handlers of the callback group.
+  void
+  add_event_handlers(
+    const std::vector<std::shared_ptr<rclcpp::QOSEventHandlerBase>> & event_handlers,
+    const rclcpp::CallbackGroup::SharedPtr & callback_group);
+
   rclcpp::node_interfaces::NodeBaseInterface * node_base_;
   rclcpp::node_interfaces::NodeTimersInterface * node_timers_;
+
+  std::mutex event_handler_groups_mutex_;
+  /// One waitable for the event handlers of each callback group, the callback groups keep a
+  /// weak pointer to it.
+  std::vector<
+    std::pair<rclcpp::CallbackGroup::WeakPtr, rclcpp::QOSEventHandlerGroup::SharedPtr>
+  > event_handler_groups_;
 };
 
 }  // namespace node_interfaces
@@ -15,14 +15,17 @@
 #ifndef RCLCPP__NODE_OPTIONS_HPP_
 #define RCLCPP__NODE_OPTIONS_HPP_
 
+#include <chrono>
 #include <memory>
 #include <string>
 #include <vector>
 
 #include "rcl/node_options.h"
+#include "rclcpp/allocator/arena.hpp"
 #include "rclcpp/context.hpp"
 #include "rclcpp/contexts/default_context.hpp"
 #include "rclcpp/parameter.hpp"
+#include "rclcpp/parameter_snapshot.hpp"
 #include "rclcpp/publisher_options.hpp"
 #include "rclcpp/qos.hpp"
 #include "rclcpp/visibility_control.hpp"
@@ -44,16 +47,24 @@ public:
    *   - use_global_arguments = true
    *   - use_intra_process_comms = false
    *   - enable_topic_statistics = false
+   *   - use_graph_cache = false
    *   - start_parameter_services = true
    *   - start_parameter_event_publisher = true
    *   - clock_qos = rclcpp::ClockQoS()
    *   - use_clock_thread = true
+   *   - use_shared_clock_subscription = false
    *   - rosout_qos = rclcpp::RosoutQoS()
+   *   - rosout_batch_period = 0, publishing each log record right away
+   *   - rosout_max_batch_size = 64
    *   - parameter_event_qos = rclcpp::ParameterEventQoS
    *     - with history setting and depth from rmw_qos_profile_parameter_events
    *   - parameter_event_publisher_options = rclcpp::PublisherOptionsBase
+   *   - parameter_event_coalescing_period = 0, publishing each parameter event right away
+   *   - parameter_snapshot = nullptr
    *   - allow_undeclared_parameters = false
    *   - automatically_declare_parameters_from_overrides = false
+   *   - lazy_node_interfaces = false
+   *   - shared_rcl_node_handle = nullptr
    *   - allocator = rcl_get_default_allocator()
    *
    * \param[in] allocator allocator to use in construction of NodeOptions.
@@ -211,6 +222,28 @@ public:
   NodeOptions &
   enable_topic_statistics(bool enable_topic_statistics);
 
+  /// Return the use_graph_cache flag.
+  RCLCPP_PUBLIC
+  bool
+  use_graph_cache() const;
+
+  /// Set the use_graph_cache flag, return this for parameter idiom.
+  /**
+   * If true, the results of the graph queries of the node, like
+   * get_topic_names_and_types(), count_publishers() or
+   * get_publishers_info_by_topic(), are kept in a cache shared with the other
+   * nodes of the context using it, until the graph listener is notified of a
+   * graph change.
+   * Repeated queries are then answered from memory, but may lag behind the
+   * graph until the change is noticed, including the changes made by this
+   * process.
+   *
+   * Defaults to false.
+   */
+  RCLCPP_PUBLIC
+  NodeOptions &
+  use_graph_cache(bool use_graph_cache);
+
   /// Return the start_parameter_services flag.
   RCLCPP_PUBLIC
   bool
@@ -273,6 +306,26 @@ public:
   NodeOptions &
   use_clock_thread(bool use_clock_thread);
 
+  /// Return the use_shared_clock_subscription flag.
+  RCLCPP_PUBLIC
+  bool
+  use_shared_clock_subscription() const;
+
+  /// Set the use_shared_clock_subscription flag, return this for parameter idiom.
+  /**
+   * If true and `use_sim_time` is set, the time source of the node does not
+   * subscribe to "/clock" itself, but gets the clock messages from a
+   * subscription shared by all the nodes of the context using it.
+   * That subscription belongs to a hidden node of the context, spun by its own
+   * thread, so only the global remapping rules and parameter overrides of the
+   * context apply to it, and use_clock_thread() is ignored.
+   *
+   * Defaults to false.
+   */
+  RCLCPP_PUBLIC
+  NodeOptions &
+  use_shared_clock_subscription(bool use_shared_clock_subscription);
+
   /// Return a reference to the parameter_event_qos QoS.
   RCLCPP_PUBLIC
   const rclcpp::QoS &
@@ -299,6 +352,42 @@ public:
   NodeOptions &
   rosout_qos(const rclcpp::QoS & rosout_qos);
 
+  /// Return the period over which the log records published on /rosout are batched.
+  RCLCPP_PUBLIC
+  std::chrono::nanoseconds
+  rosout_batch_period() const;
+
+  /// Set the period over which the log records published on /rosout are batched, return this.
+  /**
+   * If greater than zero and rosout is enabled, the consecutive log records of
+   * the node with the same severity within this period after a first one are
+   * published together, in one rcl_interfaces::msg::Log whose message holds
+   * one line per record, and whose stamp and location are those of the first
+   * record.
+   * A batch is published early once it holds rosout_max_batch_size() records.
+   * This reduces the number of samples on the "/rosout" topic during log
+   * bursts, at the cost of delaying the records by up to the period.
+   * Otherwise, each log record is published right away.
+   */
+  RCLCPP_PUBLIC
+  NodeOptions &
+  rosout_batch_period(std::chrono::nanoseconds rosout_batch_period);
+
+  /// Return the maximum number of log records published in one /rosout message.
+  RCLCPP_PUBLIC
+  size_t
+  rosout_max_batch_size() const;
+
+  /// Set the maximum number of log records published in one /rosout message, return this.
+  /**
+   * Only used if rosout_batch_period() is greater than zero.
+   *
+   * \throws std::invalid_argument if zero.
+   */
+  RCLCPP_PUBLIC
+  NodeOptions &
+  rosout_max_batch_size(size_t rosout_max_batch_size);
+
   /// Return a reference to the parameter_event_publisher_options.
   RCLCPP_PUBLIC
   const rclcpp::PublisherOptionsBase &
@@ -317,6 +406,45 @@ public:
   parameter_event_publisher_options(
     const rclcpp::PublisherOptionsBase & parameter_event_publisher_options);
 
+  /// Return the period over which the parameter events are coalesced.
+  RCLCPP_PUBLIC
+  std::chrono::nanoseconds
+  parameter_event_coalescing_period() const;
+
+  /// Set the period over which the parameter events are coalesced, return this.
+  /**
+   * If greater than zero, the parameters declared, changed or deleted within
+   * this period after a first change are published together, in one
+   * ParameterEvent holding the last value of each of them, by a thread of the
+   * node parameters.
+   * This reduces the traffic on the "/parameter_events" topic when parameters
+   * are changed in bursts, at the cost of delaying the events by up to the
+   * period.
+   * Otherwise, each declaration or call setting parameters publishes its own
+   * event right away.
+   */
+  RCLCPP_PUBLIC
+  NodeOptions &
+  parameter_event_coalescing_period(std::chrono::nanoseconds parameter_event_coalescing_period);
+
+  /// Return the snapshot of the parameters the node is initialized with, if any.
+  RCLCPP_PUBLIC
+  std::shared_ptr<const rclcpp::ParameterSnapshot>
+  parameter_snapshot() const;
+
+  /// Set the snapshot of the parameters to initialize the node with, return this.
+  /**
+   * With a snapshot taken by rclcpp::Node::get_parameter_snapshot(), e.g. before
+   * a restart, the node takes its parameter overrides from the snapshot instead
+   * of resolving them from parameter_overrides, the arguments and the parameter
+   * files, and starts with the parameters of the snapshot declared, without
+   * validating them again, see rclcpp::ParameterSnapshot.
+   * nullptr, the default, to resolve and declare the parameters as usual.
+   */
+  RCLCPP_PUBLIC
+  NodeOptions &
+  parameter_snapshot(std::shared_ptr<const rclcpp::ParameterSnapshot> parameter_snapshot);
+
   /// Return the allow_undeclared_parameters flag.
   RCLCPP_PUBLIC
   bool
@@ -357,6 +485,68 @@ public:
   automatically_declare_parameters_from_overrides(
     bool automatically_declare_parameters_from_overrides);
 
+  /// Return the lazy_node_interfaces flag.
+  RCLCPP_PUBLIC
+  bool
+  lazy_node_interfaces() const;
+
+  /// Set the lazy_node_interfaces flag, return this for parameter idiom.
+  /**
+   * If true, rclcpp::Node creates its graph interface, and its clock,
+   * parameters and time source interfaces, on first use instead of in its
+   * constructor, making it cheaper to create large numbers of nodes which do
+   * not use all of them.
+   * Until the parameters interface is created, the parameter services are not
+   * offered, the parameter overrides, including `use_sim_time`, are not
+   * applied and no parameter event is published.
+   * Getting the clock, the time or any of these interfaces, declaring a
+   * parameter, or creating a client creates them.
+   *
+   * Combined with enable_rosout(false), start_parameter_services(false) and
+   * start_parameter_event_publisher(false), the node creates no entity in
+   * the middleware besides the rcl node itself.
+   */
+  RCLCPP_PUBLIC
+  NodeOptions &
+  lazy_node_interfaces(bool lazy_node_interfaces);
+
+  /// Return the rcl node handle shared by the node, null by default.
+  RCLCPP_PUBLIC
+  const std::shared_ptr<rcl_node_t> &
+  shared_rcl_node_handle() const;
+
+  /// Set the rcl node handle shared by the node, return this for parameter idiom.
+  /**
+   * If not null, the node uses this rcl node, typically the one of another node
+   * of the same context, instead of creating its own:
+   *
+   * ```cpp
+   * auto host = std::make_shared<rclcpp::Node>("host");
+   * auto options = rclcpp::NodeOptions().shared_rcl_node_handle(
+   *   host->get_node_base_interface()->get_shared_rcl_node_handle());
+   * auto node = std::make_shared<rclcpp::Node>("node", "ns", options);
+   * ```
+   *
+   * Many nodes of a process then appear as one to the middleware, which
+   * reduces the discovery traffic and the time needed to create them.
+   * The nodes keep their own name, namespace and logger, and the relative and
+   * private names of their topics and services are expanded with them.
+   * However, their entities are seen in the ROS graph as entities of the node
+   * of the shared handle, whose arguments, remapping rules and rosout
+   * publisher apply to them, and Node::get_node_names() does not list them.
+   * The arguments, allocator, rosout and arena of these options are then
+   * ignored, the parameter overrides of the arguments are still looked up
+   * with the name of the node.
+   *
+   * rclcpp_lifecycle::LifecycleNode does not support it, as the services of
+   * its state machine are created by rcl.
+   *
+   * \param[in] shared_rcl_node_handle rcl node of the same context as the node.
+   */
+  RCLCPP_PUBLIC
+  NodeOptions &
+  shared_rcl_node_handle(std::shared_ptr<rcl_node_t> shared_rcl_node_handle);
+
   /// Return the rcl_allocator_t to be used.
   RCLCPP_PUBLIC
   const rcl_allocator_t &
@@ -370,7 +560,36 @@ public:
   NodeOptions &
   allocator(rcl_allocator_t allocator);
 
+  /// Return the memory arena of the node, null by default.
+  RCLCPP_PUBLIC
+  const rclcpp::allocator::Arena::SharedPtr &
+  arena() const;
+
+  /// Set the memory arena of the node, kept alive as long as the node and its rcl handle.
+  /**
+   * The rcl allocator is set to allocate from the arena, or reset to the
+   * default one if the arena is null.
+   * This will cause the internal rcl_node_options_t struct to be invalidated.
+   *
+   * The publishers, subscriptions and message pools of the node can allocate
+   * from the same arena with an rclcpp::allocator::ArenaAllocator built from it:
+   *
+   * ```cpp
+   * rclcpp::PublisherOptionsWithAllocator<rclcpp::allocator::ArenaAllocator<void>> options;
+   * options.allocator = std::make_shared<rclcpp::allocator::ArenaAllocator<void>>(
+   *   node->get_node_options().arena());
+   * ```
+   *
+   * \param[in] arena Arena to allocate from.
+   */
+  RCLCPP_PUBLIC
+  NodeOptions &
+  arena(rclcpp::allocator::Arena::SharedPtr arena);
+
 private:
+  // Declared first to be destroyed last, the rcl node options may be allocated from it.
+  rclcpp::allocator::Arena::SharedPtr arena_;
+
   // This is mutable to allow for a const accessor which lazily creates the node options instance.
   /// Underlying rcl_node_options structure.
   mutable std::unique_ptr<rcl_node_options_t, void (*)(rcl_node_options_t *)> node_options_;
@@ -393,6 +612,8 @@ private:
 
   bool enable_topic_statistics_ {false};
 
+  bool use_graph_cache_ {false};
+
   bool start_parameter_services_ {true};
 
   bool start_parameter_event_publisher_ {true};
@@ -401,18 +622,32 @@ private:
 
   bool use_clock_thread_ {true};
 
+  bool use_shared_clock_subscription_ {false};
+
   rclcpp::QoS parameter_event_qos_ = rclcpp::ParameterEventsQoS(
     rclcpp::QoSInitialization::from_rmw(rmw_qos_profile_parameter_events)
   );
 
   rclcpp::QoS rosout_qos_ = rclcpp::RosoutQoS();
 
+  std::chrono::nanoseconds rosout_batch_period_ {0};
+
+  size_t rosout_max_batch_size_ {64};
+
   rclcpp::PublisherOptionsBase parameter_event_publisher_options_ = rclcpp::PublisherOptionsBase();
 
+  std::chrono::nanoseconds parameter_event_coalescing_period_ {0};
+
+  std::shared_ptr<const rclcpp::ParameterSnapshot> parameter_snapshot_;
+
   bool allow_undeclared_parameters_ {false};
 
   bool automatically_declare_parameters_from_overrides_ {false};
 
+  bool lazy_node_interfaces_ {false};
+
+  std::shared_ptr<rcl_node_t> shared_rcl_node_handle_;
+
   rcl_allocator_t allocator_ {rcl_get_default_allocator()};
 };
 
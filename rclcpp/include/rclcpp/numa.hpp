@@ -0,0 +1,81 @@
+// Copyright 2021 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef RCLCPP__NUMA_HPP_
+#define RCLCPP__NUMA_HPP_
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "rclcpp/thread_attributes.hpp"
+#include "rclcpp/visibility_control.hpp"
+
+namespace rclcpp
+{
+
+/// A NUMA node of the host, i.e. a set of CPUs sharing the same local memory.
+struct NumaNode
+{
+  /// Index of the node, as numbered by the operating system.
+  size_t id = 0;
+  /// Indices of the CPUs of the node, in increasing order.
+  std::vector<size_t> cpus;
+};
+
+/// Return the NUMA nodes of the host which have CPUs, in increasing order of id.
+/**
+ * On Linux the nodes are read from /sys/devices/system/node, and memory only nodes are left out.
+ * On other platforms, or if the topology cannot be read, a single node 0 is returned with the
+ * CPUs the calling thread may run on, or else with as many CPUs as there are hardware threads.
+ */
+RCLCPP_PUBLIC
+std::vector<NumaNode>
+get_numa_nodes();
+
+/// Parse a list of CPUs in the format of the kernel, e.g. "0-3,8,10-11".
+/**
+ * \param[in] cpu_list the list, whitespace around it is ignored and an empty list has no CPU.
+ * \return the indices of the CPUs, in increasing order without duplicates.
+ * \throws std::invalid_argument if the list is malformed.
+ */
+RCLCPP_PUBLIC
+std::vector<size_t>
+parse_cpu_list(const std::string & cpu_list);
+
+/// Return the attributes binding each thread of an executor to the CPUs of a NUMA node.
+/**
+ * The threads are split in contiguous blocks of about the same size, one per node, so that
+ * consecutive thread numbers share a node, and each thread may run on all the CPUs of its node.
+ * The result is meant for ExecutorOptions::worker_thread_attributes, along with
+ * MultiThreadedExecutor::pin_callback_group_to_numa_node().
+ *
+ * As memory is allocated on the node of the thread which first touches it, the messages
+ * taken by a callback bound to a node, and the sequences they grow, are then local to it.
+ *
+ * \param[in] number_of_threads number of threads of the executor.
+ * \param[in] nodes the NUMA nodes to spread the threads over.
+ * \return the attributes of each thread, by thread index.
+ * \throws std::invalid_argument if there is no node or a node has no CPU.
+ */
+RCLCPP_PUBLIC
+std::vector<ThreadAttributes>
+make_numa_thread_attributes(
+  size_t number_of_threads,
+  const std::vector<NumaNode> & nodes = get_numa_nodes());
+
+}  // namespace rclcpp
+
+#endif  // RCLCPP__NUMA_HPP_
@@ -15,8 +15,10 @@
 #ifndef RCLCPP__PARAMETER_CLIENT_HPP_
 #define RCLCPP__PARAMETER_CLIENT_HPP_
 
+#include <chrono>
 #include <functional>
 #include <future>
+#include <map>
 #include <memory>
 #include <string>
 #include <utility>
@@ -299,6 +301,124 @@ private:
   std::string remote_node_name_;
 };
 
+/// Client of the parameters of several remote nodes.
+/**
+ * Each request is sent to the parameter services of all of the remote nodes
+ * at once, without waiting for any response, and the returned future is
+ * completed once every node has responded, with the results of each of them.
+ * The responses are received by the executor spinning the node of the client,
+ * as for AsyncParametersClient.
+ */
+class MultiNodeParametersClient
+{
+public:
+  RCLCPP_SMART_PTR_DEFINITIONS(MultiNodeParametersClient)
+
+  /// Results of a request, by remote node name.
+  template<typename ResultT>
+  using ResultsByNode = std::map<std::string, ResultT>;
+
+  /// Create a client of the parameters of several remote nodes.
+  /**
+   * \param[in] node_base_interface The node base interface of the corresponding node.
+   * \param[in] node_topics_interface Node topic base interface.
+   * \param[in] node_graph_interface The node graph interface of the corresponding node.
+   * \param[in] node_services_interface Node service interface.
+   * \param[in] remote_node_names Names of the remote nodes.
+   * \param[in] qos_profile (optional) The rmw qos profile to use for the services.
+   * \param[in] group (optional) The clients will be added to this callback group.
+   */
+  RCLCPP_PUBLIC
+  MultiNodeParametersClient(
+    const rclcpp::node_interfaces::NodeBaseInterface::SharedPtr node_base_interface,
+    const rclcpp::node_interfaces::NodeTopicsInterface::SharedPtr node_topics_interface,
+    const rclcpp::node_interfaces::NodeGraphInterface::SharedPtr node_graph_interface,
+    const rclcpp::node_interfaces::NodeServicesInterface::SharedPtr node_services_interface,
+    const std::vector<std::string> & remote_node_names,
+    const rmw_qos_profile_t & qos_profile = rmw_qos_profile_parameters,
+    rclcpp::CallbackGroup::SharedPtr group = nullptr);
+
+  /// Constructor
+  /**
+   * \param[in] node The clients will be added to this node.
+   * \param[in] remote_node_names Names of the remote nodes.
+   * \param[in] qos_profile (optional) The rmw qos profile to use for the services.
+   * \param[in] group (optional) The clients will be added to this callback group.
+   */
+  template<typename NodeT>
+  MultiNodeParametersClient(
+    const std::shared_ptr<NodeT> node,
+    const std::vector<std::string> & remote_node_names,
+    const rmw_qos_profile_t & qos_profile = rmw_qos_profile_parameters,
+    rclcpp::CallbackGroup::SharedPtr group = nullptr)
+  : MultiNodeParametersClient(
+      node->get_node_base_interface(),
+      node->get_node_topics_interface(),
+      node->get_node_graph_interface(),
+      node->get_node_services_interface(),
+      remote_node_names,
+      qos_profile,
+      group)
+  {}
+
+  /// Return the names of the remote nodes.
+  RCLCPP_PUBLIC
+  std::vector<std::string>
+  get_remote_node_names() const;
+
+  /// Get the same parameters of all of the remote nodes.
+  RCLCPP_PUBLIC
+  std::shared_future<ResultsByNode<std::vector<rclcpp::Parameter>>>
+  get_parameters(const std::vector<std::string> & names);
+
+  /// Set the same parameters on all of the remote nodes.
+  RCLCPP_PUBLIC
+  std::shared_future<ResultsByNode<std::vector<rcl_interfaces::msg::SetParametersResult>>>
+  set_parameters(const std::vector<rclcpp::Parameter> & parameters);
+
+  /// Set different parameters on some of the remote nodes.
+  /**
+   * \param[in] parameters Parameters to set, by remote node name.
+   * \throws std::invalid_argument if a node is not one of the remote nodes of the client.
+   */
+  RCLCPP_PUBLIC
+  std::shared_future<ResultsByNode<std::vector<rcl_interfaces::msg::SetParametersResult>>>
+  set_parameters(const ResultsByNode<std::vector<rclcpp::Parameter>> & parameters);
+
+  /// List the parameters of all of the remote nodes.
+  RCLCPP_PUBLIC
+  std::shared_future<ResultsByNode<rcl_interfaces::msg::ListParametersResult>>
+  list_parameters(const std::vector<std::string> & prefixes, uint64_t depth);
+
+  /// Return if the parameter services of all of the remote nodes are ready.
+  RCLCPP_PUBLIC
+  bool
+  service_is_ready() const;
+
+  /// Wait for the services of all of the remote nodes to be ready.
+  /**
+   * \param timeout maximum time to wait, for all of the nodes
+   * \return `true` if the services are ready and the timeout is not over, `false` otherwise
+   */
+  template<typename RepT = int64_t, typename RatioT = std::milli>
+  bool
+  wait_for_service(
+    std::chrono::duration<RepT, RatioT> timeout = std::chrono::duration<RepT, RatioT>(-1))
+  {
+    return wait_for_service_nanoseconds(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(timeout)
+    );
+  }
+
+protected:
+  RCLCPP_PUBLIC
+  bool
+  wait_for_service_nanoseconds(std::chrono::nanoseconds timeout);
+
+private:
+  std::map<std::string, AsyncParametersClient::SharedPtr> clients_;
+};
+
 class SyncParametersClient
 {
 public:
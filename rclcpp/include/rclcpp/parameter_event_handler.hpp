@@ -326,6 +326,10 @@ protected:
     StringPairHash
   > parameter_callbacks_;
 
+  // Number of entries in parameter_callbacks_ for each node name, to discard the events of
+  // the other nodes without looking at their parameters
+  std::unordered_map<std::string, size_t> parameter_callbacks_nodes_;
+
   rclcpp::Subscription<rcl_interfaces::msg::ParameterEvent>::SharedPtr event_subscription_;
 
   std::list<ParameterEventCallbackHandle::WeakPtr> event_callbacks_;
@@ -0,0 +1,111 @@
+// Copyright 2021 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__PARAMETER_HANDLE_HPP_
+#define RCLCPP__PARAMETER_HANDLE_HPP_
+
+#include <string>
+#include <type_traits>
+#include <utility>
+
+#include "rclcpp/detail/read_copy_update_pointer.hpp"
+#include "rclcpp/macros.hpp"
+#include "rclcpp/parameter.hpp"
+#include "rclcpp/parameter_value.hpp"
+#include "rclcpp/visibility_control.hpp"
+
+namespace rclcpp
+{
+
+/// Handle to read the value of a parameter without locking the parameters of its node.
+/**
+ * A handle is looked up once by name with rclcpp::Node::get_parameter_handle(),
+ * then always reads the latest value of the parameter, which the node publishes
+ * to its handles as an immutable snapshot whenever the parameter is set,
+ * declared or undeclared.
+ *
+ * Reading is thread-safe and lock-free, readers never wait for each other nor
+ * for the threads setting parameters, so handles can be read in callbacks at
+ * high rates.
+ * A handle must not be read while it is being destroyed.
+ */
+class ParameterHandle
+{
+public:
+  RCLCPP_SMART_PTR_DEFINITIONS_NOT_COPYABLE(ParameterHandle)
+
+  /// Constructor.
+  /**
+   * \param[in] name the name of the parameter.
+   * \param[in] value the current value of the parameter, not set if it is not declared.
+   */
+  RCLCPP_PUBLIC
+  ParameterHandle(const std::string & name, const rclcpp::ParameterValue & value);
+
+  /// Return the name of the parameter.
+  RCLCPP_PUBLIC
+  const std::string &
+  get_name() const;
+
+  /// Return a copy of the current value of the parameter.
+  /**
+   * The value is not set if the parameter is not declared.
+   */
+  RCLCPP_PUBLIC
+  rclcpp::ParameterValue
+  get_parameter_value() const;
+
+  /// Return the current parameter, with its name and value.
+  RCLCPP_PUBLIC
+  rclcpp::Parameter
+  get_parameter() const;
+
+  /// Return the type of the current value of the parameter.
+  RCLCPP_PUBLIC
+  rclcpp::ParameterType
+  get_type() const;
+
+  /// Return a copy of the current value of the parameter, as the given type.
+  /**
+   * No memory is allocated for the values which are not strings nor arrays.
+   *
+   * \throws rclcpp::ParameterTypeException if the value does not have the given type.
+   */
+  template<typename ParameterT>
+  auto
+  get_value() const
+  -> std::decay_t<decltype(std::declval<const rclcpp::ParameterValue &>()
+    .template get<ParameterT>())>
+  {
+    auto snapshot = value_.read();
+    return snapshot->template get<ParameterT>();
+  }
+
+  /// Publish a new value of the parameter to the readers.
+  /**
+   * It is called by the node of the parameter, and must not be called concurrently with itself.
+   * It waits for the readers of the previous value to be done with it.
+   */
+  RCLCPP_PUBLIC
+  void
+  set_parameter_value(const rclcpp::ParameterValue & value);
+
+private:
+  const std::string name_;
+  rclcpp::detail::ReadCopyUpdatePointer<rclcpp::ParameterValue> value_;
+};
+
+}  // namespace rclcpp
+
+#endif  // RCLCPP__PARAMETER_HANDLE_HPP_
@@ -0,0 +1,103 @@
+// Copyright 2021 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef RCLCPP__PARAMETER_SNAPSHOT_HPP_
+#define RCLCPP__PARAMETER_SNAPSHOT_HPP_
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "rcl_interfaces/msg/parameter_descriptor.hpp"
+
+#include "rclcpp/parameter.hpp"
+#include "rclcpp/parameter_value.hpp"
+#include "rclcpp/visibility_control.hpp"
+
+namespace rclcpp
+{
+
+/// Resolved parameters of a node, to initialize the node with on a warm restart.
+/**
+ * A node constructed with a snapshot in rclcpp::NodeOptions::parameter_snapshot()
+ * takes its parameter overrides from it, instead of resolving them from the
+ * parameter files and the arguments again, and starts with the parameters of the
+ * snapshot already declared.
+ * Declaring one of them again returns its value from the snapshot, without
+ * applying the overrides, the range checks and the callbacks validating it,
+ * unless the declaration changes its type or its dynamic typing, in which case it
+ * is declared as usual.
+ * The snapshot is thus only meant for the same node, started again with the same
+ * parameters.
+ *
+ * \sa rclcpp::Node::get_parameter_snapshot(), write_parameter_snapshot(),
+ *   read_parameter_snapshot()
+ */
+struct ParameterSnapshot
+{
+  /// Declared parameters, with their descriptors.
+  std::vector<std::pair<rclcpp::Parameter, rcl_interfaces::msg::ParameterDescriptor>> parameters;
+
+  /// Resolved parameter overrides, by parameter name.
+  std::map<std::string, rclcpp::ParameterValue> parameter_overrides;
+};
+
+/// Encode a parameter snapshot in a compact binary format.
+/**
+ * The format is specific to the byte order of the host, it is meant to be read
+ * back on the same machine.
+ *
+ * \param[in] snapshot the snapshot to encode.
+ * \return the encoded snapshot.
+ */
+RCLCPP_PUBLIC
+std::vector<uint8_t>
+serialize_parameter_snapshot(const ParameterSnapshot & snapshot);
+
+/// Decode a parameter snapshot encoded by serialize_parameter_snapshot().
+/**
+ * \param[in] data the encoded snapshot.
+ * \return the decoded snapshot.
+ * \throws std::runtime_error if the data is not a valid snapshot of this host.
+ */
+RCLCPP_PUBLIC
+ParameterSnapshot
+deserialize_parameter_snapshot(const std::vector<uint8_t> & data);
+
+/// Write a parameter snapshot to a file, replacing it.
+/**
+ * \param[in] file_path path of the file.
+ * \param[in] snapshot the snapshot to write.
+ * \throws std::runtime_error if the file could not be written.
+ */
+RCLCPP_PUBLIC
+void
+write_parameter_snapshot(const std::string & file_path, const ParameterSnapshot & snapshot);
+
+/// Read a parameter snapshot written by write_parameter_snapshot().
+/**
+ * \param[in] file_path path of the file.
+ * \return the snapshot.
+ * \throws std::runtime_error if the file could not be read or is not a valid snapshot.
+ */
+RCLCPP_PUBLIC
+ParameterSnapshot
+read_parameter_snapshot(const std::string & file_path);
+
+}  // namespace rclcpp
+
+#endif  // RCLCPP__PARAMETER_SNAPSHOT_HPP_
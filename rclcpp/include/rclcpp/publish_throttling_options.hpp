@@ -0,0 +1,54 @@
+// Copyright 2021 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__PUBLISH_THROTTLING_OPTIONS_HPP_
+#define RCLCPP__PUBLISH_THROTTLING_OPTIONS_HPP_
+
+#include <chrono>
+#include <cstddef>
+
+namespace rclcpp
+{
+
+/// Options of the decimation of the messages given to a publisher.
+/**
+ * The messages the throttling drops are dropped by publish() before any
+ * intra-process or inter-process work is done: they are neither copied nor
+ * serialized.
+ * When both policies are set, a message is published only if both keep it.
+ *
+ * See rclcpp::PublisherBase::get_throttled_message_count().
+ */
+struct PublishThrottlingOptions
+{
+  /// Minimum time between two published messages, 0 to not limit the rate.
+  /**
+   * The time is the steady time, e.g. a period of 200ms publishes at most 5 messages per second.
+   */
+  std::chrono::nanoseconds min_period{0};
+
+  /// Publish only the first of every keep_every_nth messages, 0 or 1 to publish them all.
+  size_t keep_every_nth = 0;
+
+  /// Return true if the throttling drops messages.
+  bool
+  is_enabled() const
+  {
+    return min_period.count() > 0 || keep_every_nth > 1;
+  }
+};
+
+}  // namespace rclcpp
+
+#endif  // RCLCPP__PUBLISH_THROTTLING_OPTIONS_HPP_
@@ -17,10 +17,14 @@
 
 #include <functional>
 #include <iostream>
+#include <iterator>
 #include <memory>
+#include <mutex>
 #include <sstream>
 #include <string>
+#include <type_traits>
 #include <utility>
+#include <vector>
 
 #include "rcl/error_handling.h"
 #include "rcl/publisher.h"
@@ -29,15 +33,22 @@
 
 #include "rclcpp/allocator/allocator_common.hpp"
 #include "rclcpp/allocator/allocator_deleter.hpp"
+#include "rclcpp/detail/extended_tracepoints.hpp"
 #include "rclcpp/detail/resolve_use_intra_process.hpp"
+#include "rclcpp/detail/shared_object_pool.hpp"
 #include "rclcpp/experimental/intra_process_manager.hpp"
+#include "rclcpp/experimental/shared_memory_channel.hpp"
+#include "rclcpp/experimental/shared_memory_message.hpp"
 #include "rclcpp/get_message_type_support_handle.hpp"
 #include "rclcpp/is_ros_compatible_type.hpp"
 #include "rclcpp/loaned_message.hpp"
+#include "rclcpp/logging.hpp"
 #include "rclcpp/macros.hpp"
 #include "rclcpp/node_interfaces/node_base_interface.hpp"
 #include "rclcpp/publisher_base.hpp"
 #include "rclcpp/publisher_options.hpp"
+#include "rclcpp/serialization.hpp"
+#include "rclcpp/serialized_message.hpp"
 #include "rclcpp/type_adapter.hpp"
 #include "rclcpp/type_support_decl.hpp"
 #include "rclcpp/visibility_control.hpp"
@@ -137,6 +148,8 @@ public:
   {
     allocator::set_allocator_for_deleter(&published_type_deleter_, &published_type_allocator_);
     allocator::set_allocator_for_deleter(&ros_message_type_deleter_, &ros_message_type_allocator_);
+    this->set_throttling(options_.throttling);
+    this->set_skip_publish_without_subscribers(options_.skip_publish_without_subscribers);
 
     if (options_.event_callbacks.deadline_callback) {
       this->add_event_handler(
@@ -186,33 +199,70 @@ public:
       // Get the intra process manager instance for this context.
       auto ipm = context->get_sub_context<rclcpp::experimental::IntraProcessManager>();
       // Register the publisher with the intra process manager.
-      if (qos.history() != rclcpp::HistoryPolicy::KeepLast) {
-        throw std::invalid_argument(
-                "intraprocess communication allowed only with keep last history qos policy");
-      }
-      if (qos.depth() == 0) {
+      // The subscriptions with a keep all history bound their own buffers.
+      if (qos.history() == rclcpp::HistoryPolicy::KeepLast) {
+        if (qos.depth() == 0) {
+          throw std::invalid_argument(
+                  "intraprocess communication is not allowed with a zero qos history depth value");
+        }
+      } else if (qos.history() != rclcpp::HistoryPolicy::KeepAll) {
         throw std::invalid_argument(
-                "intraprocess communication is not allowed with a zero qos history depth value");
+                "intraprocess communication allowed only with keep last or keep all history "
+                "qos policy");
       }
       if (qos.durability() != rclcpp::DurabilityPolicy::Volatile) {
         throw std::invalid_argument(
                 "intraprocess communication allowed only with volatile durability");
       }
-      uint64_t intra_process_publisher_id = ipm->add_publisher(this->shared_from_this());
+      uint64_t intra_process_publisher_id = 0;
+      if constexpr (rclcpp::TypeAdapter<MessageT>::is_specialized::value) {
+        // The subscriptions taking the custom type get it without conversion.
+        intra_process_publisher_id = ipm->template add_type_adapted_publisher<
+          MessageT, AllocatorT>(this->shared_from_this());
+      } else {
+        intra_process_publisher_id = ipm->template add_publisher<
+          ROSMessageType, AllocatorT, ROSMessageTypeDeleter>(this->shared_from_this());
+      }
       this->setup_intra_process(
         intra_process_publisher_id,
         ipm);
     }
+
+    // Middlewares which loan messages have their own shared memory transport.
+    // Serialized messages are not written to it, their subscriptions must get them from rmw.
+    const auto & shared_memory_options = options_.shared_memory_transport;
+    if (shared_memory_options.enabled && !this->can_loan_messages() &&
+      !rclcpp::serialization_traits::is_serialized_message_class<ROSMessageType>::value)
+    {
+      shared_memory_channel_ = std::make_shared<rclcpp::experimental::SharedMemoryChannel>(
+        this->get_topic_name(),
+        node_base->get_context()->get_domain_id(),
+        shared_memory_options.slot_size,
+        shared_memory_options.slot_count ? shared_memory_options.slot_count : qos.depth());
+      shared_memory_channel_->add_writer(this->get_gid());
+    }
+
+    if (options_.loaned_message_pool_size > 0 && !this->can_loan_messages()) {
+      loaned_message_pool_ =
+        std::make_unique<rclcpp::detail::SharedObjectPool<ROSMessageType>>(
+        options_.loaned_message_pool_size);
+    }
   }
 
   virtual ~Publisher()
-  {}
+  {
+    if (shared_memory_channel_) {
+      shared_memory_channel_->remove_writer(this->get_gid());
+    }
+  }
 
   /// Borrow a loaned ROS message from the middleware.
   /**
    * If the middleware is capable of loaning memory for a ROS message instance,
    * the loaned message will be directly allocated in the middleware.
-   * If not, the message allocator of this rclcpp::Publisher instance is being used.
+   * If not, the message allocator of this rclcpp::Publisher instance is being used,
+   * or the message is borrowed from a pool if PublisherOptionsBase::loaned_message_pool_size
+   * is set.
    *
    * With a call to \sa `publish` the LoanedMessage instance is being returned to the middleware
    * or free'd accordingly to the allocator.
@@ -226,6 +276,11 @@ public:
   rclcpp::LoanedMessage<ROSMessageType, AllocatorT>
   borrow_loaned_message()
   {
+    if (loaned_message_pool_) {
+      return rclcpp::LoanedMessage<ROSMessageType, AllocatorT>(
+        *this,
+        loaned_message_pool_->borrow());
+    }
     return rclcpp::LoanedMessage<ROSMessageType, AllocatorT>(
       *this,
       this->get_ros_message_type_allocator());
@@ -249,24 +304,8 @@ public:
   >
   publish(std::unique_ptr<T, ROSMessageTypeDeleter> msg)
   {
-    if (!intra_process_is_enabled_) {
-      this->do_inter_process_publish(*msg);
-      return;
-    }
-    // If an interprocess subscription exist, then the unique_ptr is promoted
-    // to a shared_ptr and published.
-    // This allows doing the intraprocess publish first and then doing the
-    // interprocess publish, resulting in lower publish-to-subscribe latency.
-    // It's not possible to do that with an unique_ptr,
-    // as do_intra_process_publish takes the ownership of the message.
-    bool inter_process_publish_needed =
-      get_subscription_count() > get_intra_process_subscription_count();
-
-    if (inter_process_publish_needed) {
-      auto shared_msg = this->do_intra_process_publish_and_return_shared(std::move(msg));
-      this->do_inter_process_publish(*shared_msg);
-    } else {
-      this->do_intra_process_publish(std::move(msg));
+    if (this->should_publish()) {
+      this->do_unique_ros_message_publish(std::move(msg));
     }
   }
 
@@ -289,16 +328,103 @@ public:
   >
   publish(const T & msg)
   {
-    // Avoid allocating when not using intra process.
+    // The message is dropped before being copied.
+    if (this->should_publish()) {
+      this->do_ros_message_publish(msg);
+    }
+  }
+
+  /// Publish a shared message on the topic.
+  /**
+   * The intra-process subscriptions which do not require ownership of the
+   * message share it without copying it, the others get a copy.
+   * The message must not be modified after being published.
+   *
+   * If PublisherOptionsBase::cache_serialized_message is set, the
+   * serialization of the message is kept, so that publishing the same message
+   * again to the middleware does not serialize it again.
+   *
+   * \param[in] msg A shared pointer to the message to send.
+   * \throws std::runtime_error if the message is a null pointer.
+   */
+  void
+  publish(std::shared_ptr<const ROSMessageType> msg)
+  {
+    if (!msg) {
+      throw std::runtime_error("cannot publish msg which is a null pointer");
+    }
+    if (!this->should_publish()) {
+      return;
+    }
+    if (intra_process_is_enabled_) {
+      auto ipm = weak_ipm_.lock();
+      if (!ipm) {
+        throw std::runtime_error(
+                "intra process publish called after destruction of intra process manager");
+      }
+      bool inter_process_publish_needed = this->has_inter_process_subscriptions();
+
+      RCLCPP_EXTENDED_TRACEPOINT(
+        rclcpp_intra_publish,
+        static_cast<const void *>(publisher_handle_.get()),
+        static_cast<const void *>(msg.get()));
+      ipm->template do_intra_process_publish_shared<ROSMessageType, AllocatorT,
+        ROSMessageTypeDeleter>(
+        intra_process_publisher_id_,
+        msg,
+        ros_message_type_allocator_,
+        ros_message_type_deleter_);
+
+      if (!inter_process_publish_needed) {
+        return;
+      }
+    }
+    if (!options_.cache_serialized_message) {
+      this->do_inter_process_publish(*msg);
+      return;
+    }
+    std::lock_guard<std::mutex> lock(serialized_message_cache_mutex_);
+    if (serialized_message_source_.lock() != msg) {
+      // Not the message serialized last, or it was released meanwhile.
+      rclcpp::Serialization<ROSMessageType>().serialize_message(
+        msg.get(), &serialized_message_cache_);
+      serialized_message_source_ = msg;
+    }
+    this->do_serialized_inter_process_publish(*msg, serialized_message_cache_);
+  }
+
+  /// Publish a message along with its serialization, e.g. made once for several publishers.
+  /**
+   * The intra-process subscriptions get the message, as with publish(const T &),
+   * while the middleware gets the serialization, which is not made again.
+   *
+   * This signature is enabled if the object being published is the ROS message
+   * type given when creating the publisher.
+   *
+   * \param[in] msg A const reference to the message to send.
+   * \param[in] serialized_msg The serialization of the message.
+   */
+  template<typename T>
+  typename std::enable_if_t<
+    rosidl_generator_traits::is_message<T>::value &&
+    std::is_same<T, ROSMessageType>::value
+  >
+  publish(const T & msg, const rclcpp::SerializedMessage & serialized_msg)
+  {
+    if (!this->should_publish()) {
+      return;
+    }
     if (!intra_process_is_enabled_) {
-      // In this case we're not using intra process.
-      return this->do_inter_process_publish(msg);
+      return this->do_serialized_inter_process_publish(msg, serialized_msg);
+    }
+    const size_t intra_process_subscription_count =
+      this->get_cached_intra_process_subscription_count();
+    if (intra_process_subscription_count > 0) {
+      this->do_intra_process_publish(this->duplicate_ros_message_as_unique_ptr(msg));
+    }
+    if (this->get_cached_subscription_count() > intra_process_subscription_count) {
+      this->do_serialized_inter_process_publish(msg, serialized_msg);
     }
-    // Otherwise we have to allocate memory in a unique_ptr and pass it along.
-    // As the message is not const, a copy should be made.
-    // A shared_ptr<const MessageT> could also be constructed here.
-    auto unique_msg = this->duplicate_ros_message_as_unique_ptr(msg);
-    this->publish(std::move(unique_msg));
   }
 
   /// Publish a message on the topic.
@@ -319,13 +445,63 @@ public:
   >
   publish(std::unique_ptr<T, PublishedTypeDeleter> msg)
   {
-    // TODO(wjwwood): later update this to give the unique_ptr to the intra
-    // process manager and let it decide if it needs to be converted or not.
-    // For now, convert it unconditionally and pass it the ROSMessageType
-    // publish function specialization.
-    auto unique_ros_msg = this->create_ros_message_unique_ptr();
-    rclcpp::TypeAdapter<MessageT>::convert_to_ros_message(*msg, *unique_ros_msg);
-    this->publish(std::move(unique_ros_msg));
+    if (this->should_publish()) {
+      this->do_unique_custom_type_publish(std::move(msg));
+    }
+  }
+
+  /// Publish a shared message of the custom type on the topic.
+  /**
+   * This signature is enabled if this class was created with a TypeAdapter and
+   * the given type matches the custom_type of the TypeAdapter.
+   *
+   * The intra-process subscriptions taking the custom type without requiring
+   * its ownership share the message without copying it, the others get a copy.
+   * The message is converted to the ROS message only if a subscription takes
+   * the ROS message or if an inter-process subscription is matched.
+   * The message must not be modified after being published.
+   *
+   * \param[in] msg A shared pointer to the message to send.
+   * \throws std::runtime_error if the message is a null pointer.
+   */
+  template<typename T>
+  typename std::enable_if_t<
+    rclcpp::TypeAdapter<MessageT>::is_specialized::value &&
+    std::is_same<T, PublishedType>::value
+  >
+  publish(std::shared_ptr<const T> msg)
+  {
+    if (!msg) {
+      throw std::runtime_error("cannot publish msg which is a null pointer");
+    }
+    if (!this->should_publish()) {
+      return;
+    }
+    if (!intra_process_is_enabled_) {
+      return this->do_custom_type_inter_process_publish(*msg);
+    }
+    auto ipm = weak_ipm_.lock();
+    if (!ipm) {
+      throw std::runtime_error(
+              "intra process publish called after destruction of intra process manager");
+    }
+    bool inter_process_publish_needed = this->has_inter_process_subscriptions();
+
+    RCLCPP_EXTENDED_TRACEPOINT(
+      rclcpp_intra_publish,
+      static_cast<const void *>(publisher_handle_.get()),
+      static_cast<const void *>(msg.get()));
+    auto ros_msg = ipm->template do_intra_process_publish_type_adapted_shared<MessageT, AllocatorT>(
+      intra_process_publisher_id_,
+      std::move(msg),
+      published_type_allocator_,
+      published_type_deleter_,
+      ros_message_type_allocator_,
+      ros_message_type_deleter_,
+      inter_process_publish_needed);
+    if (inter_process_publish_needed) {
+      this->do_inter_process_publish(*ros_msg);
+    }
   }
 
   /// Publish a message on the topic.
@@ -346,38 +522,164 @@ public:
   >
   publish(const T & msg)
   {
-    // TODO(wjwwood): later update this to give the unique_ptr to the intra
-    // process manager and let it decide if it needs to be converted or not.
-    // For now, convert it unconditionally and pass it the ROSMessageType
-    // publish function specialization.
-
+    if (!this->should_publish()) {
+      return;
+    }
     // Avoid allocating when not using intra process.
     if (!intra_process_is_enabled_) {
       // Convert to the ROS message equivalent and publish it.
-      ROSMessageType ros_msg;
-      rclcpp::TypeAdapter<MessageT>::convert_to_ros_message(msg, ros_msg);
       // In this case we're not using intra process.
-      return this->do_inter_process_publish(ros_msg);
+      return this->do_custom_type_inter_process_publish(msg);
     }
-    // Otherwise we have to allocate memory in a unique_ptr, convert it,
-    // and pass it along.
+    // Otherwise we have to allocate memory in a unique_ptr and pass it along,
+    // it is converted to the ROS message only if needed.
     // As the message is not const, a copy should be made.
-    // A shared_ptr<const MessageT> could also be constructed here.
-    auto unique_ros_msg = this->create_ros_message_unique_ptr();
-    rclcpp::TypeAdapter<MessageT>::convert_to_ros_message(msg, *unique_ros_msg);
-    this->publish(std::move(unique_ros_msg));
+    auto unique_msg = this->duplicate_custom_type_as_unique_ptr(msg);
+    this->do_unique_custom_type_publish(std::move(unique_msg));
+  }
+
+  /// Publish a batch of messages on the topic, passed as unique pointers.
+  /**
+   * Same as calling publish() with each message in order, but the
+   * intra-process routing and the number of subscriptions are looked up once
+   * for the whole batch, instead of once per message.
+   *
+   * This signature is enabled if the iterators refer to unique pointers to
+   * the ROS message type of the publisher: the messages are moved from.
+   *
+   * \param[in] first iterator to the first message to send.
+   * \param[in] last iterator past the last message to send.
+   * \throws std::runtime_error if a message is a null pointer, before any is published.
+   */
+  template<typename Iterator>
+  typename std::enable_if_t<
+    std::is_same<
+      typename std::iterator_traits<Iterator>::value_type,
+      std::unique_ptr<ROSMessageType, ROSMessageTypeDeleter>
+    >::value
+  >
+  publish_batch(Iterator first, Iterator last)
+  {
+    for (auto it = first; it != last; ++it) {
+      if (!*it) {
+        throw std::runtime_error("cannot publish msg which is a null pointer");
+      }
+    }
+    if (this->should_skip_publish()) {
+      for (; first != last; ++first) {
+        first->reset();
+      }
+      return;
+    }
+    if (throttling_options_.is_enabled()) {
+      // The messages the throttling keeps are published one by one.
+      for (; first != last; ++first) {
+        if (this->should_publish()) {
+          this->do_unique_ros_message_publish(std::move(*first));
+        } else {
+          first->reset();
+        }
+      }
+      return;
+    }
+    if (!intra_process_is_enabled_) {
+      this->do_inter_process_publish_batch(first, last);
+      return;
+    }
+    auto ipm = weak_ipm_.lock();
+    if (!ipm) {
+      throw std::runtime_error(
+              "intra process publish called after destruction of intra process manager");
+    }
+    bool inter_process_publish_needed = this->has_inter_process_subscriptions();
+
+    for (auto it = first; it != last; ++it) {
+      RCLCPP_EXTENDED_TRACEPOINT(
+        rclcpp_intra_publish,
+        static_cast<const void *>(publisher_handle_.get()),
+        static_cast<const void *>(&get_ros_message(*it)));
+    }
+    if (inter_process_publish_needed) {
+      std::vector<std::shared_ptr<const ROSMessageType>> shared_msgs;
+      shared_msgs.reserve(std::distance(first, last));
+      ipm->template do_intra_process_publish_batch<ROSMessageType, AllocatorT>(
+        intra_process_publisher_id_, first, last, ros_message_type_allocator_, &shared_msgs);
+      this->do_inter_process_publish_batch(shared_msgs.begin(), shared_msgs.end());
+    } else {
+      ipm->template do_intra_process_publish_batch<ROSMessageType, AllocatorT>(
+        intra_process_publisher_id_, first, last, ros_message_type_allocator_);
+    }
+  }
+
+  /// Publish a batch of messages on the topic, passed by reference.
+  /**
+   * Same as calling publish() with each message in order, see the overload
+   * taking unique pointers.
+   *
+   * This signature is enabled if the iterators refer to the ROS message type
+   * of the publisher.
+   * The messages are copied only if intra-process communication is enabled.
+   *
+   * \param[in] first iterator to the first message to send.
+   * \param[in] last iterator past the last message to send.
+   */
+  template<typename Iterator>
+  typename std::enable_if_t<
+    std::is_same<typename std::iterator_traits<Iterator>::value_type, ROSMessageType>::value
+  >
+  publish_batch(Iterator first, Iterator last)
+  {
+    if (this->should_skip_publish()) {
+      return;
+    }
+    if (throttling_options_.is_enabled()) {
+      // The messages the throttling keeps are published one by one.
+      for (; first != last; ++first) {
+        if (this->should_publish()) {
+          this->do_ros_message_publish(*first);
+        }
+      }
+      return;
+    }
+    // Avoid allocating when not using intra process.
+    if (!intra_process_is_enabled_) {
+      return this->do_inter_process_publish_batch(first, last);
+    }
+    std::vector<std::unique_ptr<ROSMessageType, ROSMessageTypeDeleter>> unique_msgs;
+    unique_msgs.reserve(std::distance(first, last));
+    for (; first != last; ++first) {
+      unique_msgs.push_back(this->duplicate_ros_message_as_unique_ptr(*first));
+    }
+    this->publish_batch(unique_msgs.begin(), unique_msgs.end());
+  }
+
+  /// Publish a range of messages on the topic, see publish_batch(first, last).
+  /**
+   * \param[in] messages range of unique pointers to or of the messages to send, e.g. a
+   *   std::vector; unique pointers are moved from.
+   */
+  template<typename RangeT>
+  auto
+  publish_batch(RangeT && messages)
+  -> decltype(this->publish_batch(std::begin(messages), std::end(messages)))
+  {
+    return this->publish_batch(std::begin(messages), std::end(messages));
   }
 
   void
   publish(const rcl_serialized_message_t & serialized_msg)
   {
-    return this->do_serialized_publish(&serialized_msg);
+    if (this->should_publish()) {
+      this->do_serialized_publish(&serialized_msg);
+    }
   }
 
   void
   publish(const SerializedMessage & serialized_msg)
   {
-    return this->do_serialized_publish(&serialized_msg.get_rcl_serialized_message());
+    if (this->should_publish()) {
+      this->do_serialized_publish(&serialized_msg.get_rcl_serialized_message());
+    }
   }
 
   /// Publish an instance of a LoanedMessage.
@@ -386,6 +688,11 @@ public:
    * after being published.
    * The instance of the loaned message is no longer valid after this call.
    *
+   * If intra-process subscriptions are matched with this publisher, they share
+   * the loaned message without copying it, and it is returned to the middleware
+   * once the last of them released it.
+   * Inter-process subscriptions then get a copy of it through the middleware.
+   *
    * \param loaned_msg The LoanedMessage instance to be published.
    */
   void
@@ -394,9 +701,13 @@ public:
     if (!loaned_msg.is_valid()) {
       throw std::runtime_error("loaned message is not valid");
     }
-    if (intra_process_is_enabled_) {
-      // TODO(Karsten1987): support loaned message passed by intraprocess
-      throw std::runtime_error("storing loaned messages in intra process is not supported yet");
+    if (!this->should_publish()) {
+      // The loaned message is returned when the caller destroys it.
+      return;
+    }
+    if (intra_process_is_enabled_ && this->get_cached_intra_process_subscription_count() > 0) {
+      this->do_intra_process_loaned_message_publish(std::move(loaned_msg));
+      return;
     }
 
     // verify that publisher supports loaned messages
@@ -435,6 +746,98 @@ public:
   }
 
 protected:
+  /// Publish a message kept by the throttling, see publish(std::unique_ptr<T, ...>).
+  void
+  do_unique_ros_message_publish(std::unique_ptr<ROSMessageType, ROSMessageTypeDeleter> msg)
+  {
+    if (!intra_process_is_enabled_) {
+      this->do_inter_process_publish(*msg);
+      return;
+    }
+    // If an interprocess subscription exist, then the unique_ptr is promoted
+    // to a shared_ptr and published.
+    // This allows doing the intraprocess publish first and then doing the
+    // interprocess publish, resulting in lower publish-to-subscribe latency.
+    // It's not possible to do that with an unique_ptr,
+    // as do_intra_process_publish takes the ownership of the message.
+    bool inter_process_publish_needed = this->has_inter_process_subscriptions();
+
+    if (inter_process_publish_needed) {
+      auto shared_msg = this->do_intra_process_publish_and_return_shared(std::move(msg));
+      this->do_inter_process_publish(*shared_msg);
+    } else {
+      this->do_intra_process_publish(std::move(msg));
+    }
+  }
+
+  /// Publish a message kept by the throttling, see publish(const T &).
+  void
+  do_ros_message_publish(const ROSMessageType & msg)
+  {
+    // Avoid allocating when not using intra process.
+    if (!intra_process_is_enabled_) {
+      // In this case we're not using intra process.
+      return this->do_inter_process_publish(msg);
+    }
+    // Otherwise we have to allocate memory in a unique_ptr and pass it along.
+    // As the message is not const, a copy should be made.
+    // A shared_ptr<const MessageT> could also be constructed here.
+    auto unique_msg = this->duplicate_ros_message_as_unique_ptr(msg);
+    this->do_unique_ros_message_publish(std::move(unique_msg));
+  }
+
+  /// Publish a message of the custom type kept by the throttling.
+  template<typename T>
+  typename std::enable_if_t<
+    rclcpp::TypeAdapter<MessageT>::is_specialized::value &&
+    std::is_same<T, PublishedType>::value
+  >
+  do_unique_custom_type_publish(std::unique_ptr<T, PublishedTypeDeleter> msg)
+  {
+    if (!intra_process_is_enabled_) {
+      this->do_custom_type_inter_process_publish(*msg);
+      return;
+    }
+    // The intra-process subscriptions taking the custom type get it without
+    // conversion, the message is converted to the ROS message only if an
+    // intra-process subscription takes the ROS message or if an
+    // inter-process subscription is matched.
+    bool inter_process_publish_needed = this->has_inter_process_subscriptions();
+
+    auto ros_msg = this->do_intra_process_publish_type_adapted(
+      std::move(msg), inter_process_publish_needed);
+    if (inter_process_publish_needed) {
+      this->do_inter_process_publish(*ros_msg);
+    }
+  }
+
+  /// Convert a message of the custom type to the ROS message and publish it inter-process.
+  /**
+   * If the TypeAdapter can convert to a loaned message and the middleware can
+   * loan them, the message is converted directly into the loaned memory.
+   */
+  template<typename T>
+  void
+  do_custom_type_inter_process_publish(const T & msg)
+  {
+    using TypeAdapterT = rclcpp::TypeAdapter<MessageT>;
+    if constexpr (rclcpp::detail::has_convert_to_loaned_ros_message<TypeAdapterT>::value) {
+      if (this->can_loan_messages()) {
+        auto loaned_msg = this->borrow_loaned_message();
+        TypeAdapterT::convert_to_loaned_ros_message(msg, loaned_msg.get());
+        TRACEPOINT(
+          rclcpp_publish,
+          static_cast<const void *>(publisher_handle_.get()),
+          static_cast<const void *>(&loaned_msg.get()));
+        this->do_loaned_message_publish(loaned_msg.release());
+        return;
+      }
+    }
+    ROSMessageType ros_msg;
+    TypeAdapterT::convert_to_ros_message(msg, ros_msg);
+    this->do_inter_process_publish(ros_msg);
+  }
+
   void
   do_inter_process_publish(const ROSMessageType & msg)
   {
@@ -442,6 +845,51 @@ protected:
       rclcpp_publish,
       static_cast<const void *>(publisher_handle_.get()),
       static_cast<const void *>(&msg));
+    if (shared_memory_channel_) {
+      rclcpp::experimental::write_to_shared_memory(*shared_memory_channel_, msg, this->get_gid());
+      if (this->get_cached_subscription_count() <= shared_memory_channel_->get_reader_count()) {
+        // All the subscriptions are on this host and get the message through shared memory.
+        return;
+      }
+    }
+    this->do_rcl_publish(msg);
+  }
+
+  /// Publish inter-process the messages the iterators refer to, or point to.
+  template<typename Iterator>
+  void
+  do_inter_process_publish_batch(Iterator first, Iterator last)
+  {
+    for (auto it = first; it != last; ++it) {
+      TRACEPOINT(
+        rclcpp_publish,
+        static_cast<const void *>(publisher_handle_.get()),
+        static_cast<const void *>(&get_ros_message(*it)));
+    }
+    if (shared_memory_channel_) {
+      for (auto it = first; it != last; ++it) {
+        rclcpp::experimental::write_to_shared_memory(
+          *shared_memory_channel_, get_ros_message(*it), this->get_gid());
+      }
+      if (this->get_cached_subscription_count() <= shared_memory_channel_->get_reader_count()) {
+        // All the subscriptions are on this host and get the messages through shared memory.
+        return;
+      }
+    }
+    for (; first != last; ++first) {
+      if (!this->do_rcl_publish(get_ros_message(*first))) {
+        return;
+      }
+    }
+  }
+
+  /// Publish the message with rcl.
+  /**
+   * \return false if the message was not published because the context was shut down.
+   */
+  bool
+  do_rcl_publish(const ROSMessageType & msg)
+  {
     auto status = rcl_publish(publisher_handle_.get(), &msg, nullptr);
 
     if (RCL_RET_PUBLISHER_INVALID == status) {
@@ -450,13 +898,57 @@ protected:
         rcl_context_t * context = rcl_publisher_get_context(publisher_handle_.get());
         if (nullptr != context && !rcl_context_is_valid(context)) {
           // publisher is invalid due to context being shutdown
-          return;
+          return false;
         }
       }
     }
     if (RCL_RET_OK != status) {
       rclcpp::exceptions::throw_from_rcl_error(status, "failed to publish message");
     }
+    return true;
+  }
+
+  static const ROSMessageType &
+  get_ros_message(const ROSMessageType & msg)
+  {
+    return msg;
+  }
+
+  template<typename PointerT>
+  static const ROSMessageType &
+  get_ros_message(const PointerT & msg)
+  {
+    return *msg;
+  }
+
+  /// Publish the serialization of the message, or the message if it goes through shared memory.
+  void
+  do_serialized_inter_process_publish(
+    const ROSMessageType & msg, const rclcpp::SerializedMessage & serialized_msg)
+  {
+    if (shared_memory_channel_) {
+      return this->do_inter_process_publish(msg);
+    }
+    TRACEPOINT(
+      rclcpp_publish,
+      static_cast<const void *>(publisher_handle_.get()),
+      static_cast<const void *>(&msg));
+    auto status = rcl_publish_serialized_message(
+      publisher_handle_.get(), &serialized_msg.get_rcl_serialized_message(), nullptr);
+
+    if (RCL_RET_PUBLISHER_INVALID == status) {
+      rcl_reset_error();  // next call will reset error message if not context
+      if (rcl_publisher_is_valid_except_context(publisher_handle_.get())) {
+        rcl_context_t * context = rcl_publisher_get_context(publisher_handle_.get());
+        if (nullptr != context && !rcl_context_is_valid(context)) {
+          // publisher is invalid due to context being shutdown
+          return;
+        }
+      }
+    }
+    if (RCL_RET_OK != status) {
+      rclcpp::exceptions::throw_from_rcl_error(status, "failed to publish serialized message");
+    }
   }
 
   void
@@ -505,12 +997,92 @@ protected:
       throw std::runtime_error("cannot publish msg which is a null pointer");
     }
 
+    RCLCPP_EXTENDED_TRACEPOINT(
+      rclcpp_intra_publish,
+      static_cast<const void *>(publisher_handle_.get()),
+      static_cast<const void *>(msg.get()));
     ipm->template do_intra_process_publish<ROSMessageType, AllocatorT>(
       intra_process_publisher_id_,
       std::move(msg),
       ros_message_type_allocator_);
   }
 
+  std::shared_ptr<const ROSMessageType>
+  do_intra_process_publish_type_adapted(
+    std::unique_ptr<PublishedType, PublishedTypeDeleter> msg,
+    bool return_ros_message)
+  {
+    auto ipm = weak_ipm_.lock();
+    if (!ipm) {
+      throw std::runtime_error(
+              "intra process publish called after destruction of intra process manager");
+    }
+    if (!msg) {
+      throw std::runtime_error("cannot publish msg which is a null pointer");
+    }
+
+    RCLCPP_EXTENDED_TRACEPOINT(
+      rclcpp_intra_publish,
+      static_cast<const void *>(publisher_handle_.get()),
+      static_cast<const void *>(msg.get()));
+    return ipm->template do_intra_process_publish_type_adapted<MessageT, AllocatorT>(
+      intra_process_publisher_id_,
+      std::move(msg),
+      published_type_allocator_,
+      ros_message_type_allocator_,
+      ros_message_type_deleter_,
+      return_ros_message);
+  }
+
+  void
+  do_intra_process_loaned_message_publish(
+    rclcpp::LoanedMessage<ROSMessageType, AllocatorT> && loaned_msg)
+  {
+    auto ipm = weak_ipm_.lock();
+    if (!ipm) {
+      throw std::runtime_error(
+              "intra process publish called after destruction of intra process manager");
+    }
+
+    std::shared_ptr<const ROSMessageType> shared_msg;
+    if (this->can_loan_messages()) {
+      // The publisher handle is kept alive until the loan is returned.
+      std::shared_ptr<rcl_publisher_t> publisher_handle = publisher_handle_;
+      shared_msg = std::shared_ptr<const ROSMessageType>(
+        loaned_msg.release().release(),
+        [publisher_handle](const ROSMessageType * msg) {
+          auto ret = rcl_return_loaned_message_from_publisher(
+            publisher_handle.get(), const_cast<ROSMessageType *>(msg));
+          if (RCL_RET_OK != ret) {
+            RCLCPP_ERROR(
+              rclcpp::get_logger("rclcpp"),
+              "rcl_return_loaned_message_from_publisher failed: %s", rcl_get_error_string().str);
+            rcl_reset_error();
+          }
+        });
+    } else {
+      // The message was allocated locally, the deleter of the released message frees it.
+      shared_msg = loaned_msg.release();
+    }
+
+    bool inter_process_publish_needed = this->has_inter_process_subscriptions();
+
+    RCLCPP_EXTENDED_TRACEPOINT(
+      rclcpp_intra_publish,
+      static_cast<const void *>(publisher_handle_.get()),
+      static_cast<const void *>(shared_msg.get()));
+    ipm->template do_intra_process_publish_shared<ROSMessageType, AllocatorT,
+      ROSMessageTypeDeleter>(
+      intra_process_publisher_id_,
+      shared_msg,
+      ros_message_type_allocator_,
+      ros_message_type_deleter_);
+
+    if (inter_process_publish_needed) {
+      this->do_inter_process_publish(*shared_msg);
+    }
+  }
+
   std::shared_ptr<const ROSMessageType>
   do_intra_process_publish_and_return_shared(
     std::unique_ptr<ROSMessageType, ROSMessageTypeDeleter> msg)
@@ -524,6 +1096,10 @@ protected:
       throw std::runtime_error("cannot publish msg which is a null pointer");
     }
 
+    RCLCPP_EXTENDED_TRACEPOINT(
+      rclcpp_intra_publish,
+      static_cast<const void *>(publisher_handle_.get()),
+      static_cast<const void *>(msg.get()));
     return ipm->template do_intra_process_publish_and_return_shared<ROSMessageType,
              AllocatorT>(
       intra_process_publisher_id_,
@@ -549,6 +1125,15 @@ protected:
     return std::unique_ptr<ROSMessageType, ROSMessageTypeDeleter>(ptr, ros_message_type_deleter_);
   }
 
+  /// Duplicate a given custom type message as a unique_ptr.
+  std::unique_ptr<PublishedType, PublishedTypeDeleter>
+  duplicate_custom_type_as_unique_ptr(const PublishedType & msg)
+  {
+    auto ptr = PublishedTypeAllocatorTraits::allocate(published_type_allocator_, 1);
+    PublishedTypeAllocatorTraits::construct(published_type_allocator_, ptr, msg);
+    return std::unique_ptr<PublishedType, PublishedTypeDeleter>(ptr, published_type_deleter_);
+  }
+
   /// Copy of original options passed during construction.
   /**
    * It is important to save a copy of this so that the rmw payload which it
@@ -560,6 +1145,17 @@ protected:
   PublishedTypeDeleter published_type_deleter_;
   ROSMessageTypeAllocator ros_message_type_allocator_;
   ROSMessageTypeDeleter ros_message_type_deleter_;
+
+  /// Channel the messages are written to for the subscriptions of the host, if enabled.
+  std::shared_ptr<rclcpp::experimental::SharedMemoryChannel> shared_memory_channel_;
+
+  /// Messages borrowed by the loans when the middleware cannot loan, if enabled.
+  std::unique_ptr<rclcpp::detail::SharedObjectPool<ROSMessageType>> loaned_message_pool_;
+
+  /// Serialization of the last message published by shared pointer, if cached.
+  std::mutex serialized_message_cache_mutex_;
+  std::weak_ptr<const ROSMessageType> serialized_message_source_;
+  rclcpp::SerializedMessage serialized_message_cache_;
 };
 
 }  // namespace rclcpp
@@ -18,6 +18,8 @@
 #include <rmw/error_handling.h>
 #include <rmw/rmw.h>
 
+#include <atomic>
+#include <cstdint>
 #include <functional>
 #include <iostream>
 #include <memory>
@@ -27,8 +29,10 @@
 
 #include "rcl/publisher.h"
 
+#include "rclcpp/detail/min_period_limiter.hpp"
 #include "rclcpp/macros.hpp"
 #include "rclcpp/network_flow_endpoint.hpp"
+#include "rclcpp/publish_throttling_options.hpp"
 #include "rclcpp/qos.hpp"
 #include "rclcpp/qos_event.hpp"
 #include "rclcpp/type_support_decl.hpp"
@@ -53,9 +57,15 @@ namespace experimental
 class IntraProcessManager;
 }  // namespace experimental
 
+namespace graph_listener
+{
+class GraphListener;
+}  // namespace graph_listener
+
 class PublisherBase : public std::enable_shared_from_this<PublisherBase>
 {
   friend ::rclcpp::node_interfaces::NodeTopicsInterface;
+  friend ::rclcpp::experimental::IntraProcessManager;
 
 public:
   RCLCPP_SMART_PTR_DEFINITIONS(PublisherBase)
@@ -127,6 +137,27 @@ public:
   size_t
   get_intra_process_subscription_count() const;
 
+  /// Get the number of intraprocess subscriptions which would not drop a message published now
+  /**
+   * The subscriptions dropping the messages published while their buffer is full
+   * are skipped, see rclcpp::SubscriptionOptionsBase::intra_process_drop_new_when_full.
+   * \return The number of intraprocess subscriptions accepting messages.
+   */
+  RCLCPP_PUBLIC
+  size_t
+  get_intra_process_accepting_subscription_count() const;
+
+  /// Return true if the publisher publishes serialized messages.
+  /**
+   * Intra-process, serialized messages are only delivered to subscriptions of
+   * serialized messages, and typed messages to typed subscriptions.
+   * \sa rclcpp::GenericPublisher
+   */
+  RCLCPP_PUBLIC
+  virtual
+  bool
+  is_serialized() const;
+
   /// Manually assert that this Publisher is alive (for RMW_QOS_POLICY_LIVELINESS_MANUAL_BY_TOPIC).
   /**
    * If the rmw Liveliness policy is set to RMW_QOS_POLICY_LIVELINESS_MANUAL_BY_TOPIC, the creator
@@ -203,7 +234,91 @@ public:
   std::vector<rclcpp::NetworkFlowEndpoint>
   get_network_flow_endpoints() const;
 
+  /// Return the number of messages dropped by the throttling of the publisher.
+  /**
+   * \sa rclcpp::PublishThrottlingOptions
+   */
+  RCLCPP_PUBLIC
+  uint64_t
+  get_throttled_message_count() const;
+
+  /// Return true if a subscription is matched with the publisher.
+  /**
+   * This is cheap enough to be called before making each message, to skip
+   * building messages which nobody would receive.
+   * The subscription count is cached until the graph changes, see
+   * get_cached_subscription_count(), so a subscription may be reported a
+   * short time after it was matched.
+   */
+  bool
+  has_subscribers() const
+  {
+    return get_cached_intra_process_subscription_count() > 0 ||
+           get_cached_subscription_count() > 0;
+  }
+
 protected:
+  /// Set the decimation of the published messages, before any message is published.
+  RCLCPP_PUBLIC
+  void
+  set_throttling(const PublishThrottlingOptions & throttling_options);
+
+  /// Drop the published messages while no subscription is matched, if skip is true.
+  /**
+   * This is ignored for a transient local publisher.
+   * \sa rclcpp::PublisherOptionsBase::skip_publish_without_subscribers
+   */
+  RCLCPP_PUBLIC
+  void
+  set_skip_publish_without_subscribers(bool skip);
+
+  /// Return true if the message being published must be dropped as nobody would receive it.
+  bool
+  should_skip_publish() const
+  {
+    return skip_publish_without_subscribers_ && !has_subscribers();
+  }
+
+  /// Return true if the message being published is kept by the throttling, if any.
+  /**
+   * A message it drops is counted, it must not be published.
+   * A message dropped as no subscription is matched is not counted, see should_skip_publish().
+   */
+  bool
+  should_publish()
+  {
+    return !should_skip_publish() && (!throttling_options_.is_enabled() || throttle());
+  }
+
+  /// Apply the throttling to the message being published, see should_publish().
+  RCLCPP_PUBLIC
+  bool
+  throttle();
+
+  /// Return the number of subscriptions, queried again only if the graph changed.
+  /**
+   * The count is cached while the graph listener of the context watches the
+   * graph, and queried again once it noticed a graph change.
+   * Otherwise, this is the same as get_subscription_count().
+   */
+  RCLCPP_PUBLIC
+  size_t
+  get_cached_subscription_count() const;
+
+  /// Return the number of intra-process subscriptions, as updated by the intra process manager.
+  size_t
+  get_cached_intra_process_subscription_count() const
+  {
+    return intra_process_subscription_count_.load(std::memory_order_relaxed);
+  }
+
+  /// Return true if a subscription is matched which does not communicate intra-process.
+  bool
+  has_inter_process_subscriptions() const
+  {
+    return get_cached_subscription_count() > get_cached_intra_process_subscription_count();
+  }
+
   template<typename EventCallbackT>
   void
   add_event_handler(
@@ -233,8 +348,22 @@ protected:
   bool intra_process_is_enabled_;
   IntraProcessManagerWeakPtr weak_ipm_;
   uint64_t intra_process_publisher_id_;
+  /// Updated by the intra process manager when subscriptions are matched or unmatched.
+  std::atomic_size_t intra_process_subscription_count_{0};
+
+  std::shared_ptr<rclcpp::graph_listener::GraphListener> graph_listener_;
+  /// Subscription count from rmw in the low 32 bits, and the low 32 bits of the graph generation
+  /// it was queried at in the high ones, see GraphListener::get_graph_generation().
+  mutable std::atomic<uint64_t> cached_subscription_count_{0};
 
   rmw_gid_t rmw_gid_;
+
+  PublishThrottlingOptions throttling_options_;
+  std::atomic<uint64_t> throttling_message_count_{0};
+  rclcpp::detail::MinPeriodLimiter throttling_rate_limiter_;
+  std::atomic<uint64_t> throttled_message_count_{0};
+
+  bool skip_publish_without_subscribers_ = false;
 };
 
 }  // namespace rclcpp
@@ -25,9 +25,11 @@
 #include "rclcpp/allocator/allocator_common.hpp"
 #include "rclcpp/detail/rmw_implementation_specific_publisher_payload.hpp"
 #include "rclcpp/intra_process_setting.hpp"
+#include "rclcpp/publish_throttling_options.hpp"
 #include "rclcpp/qos.hpp"
 #include "rclcpp/qos_event.hpp"
 #include "rclcpp/qos_overriding_options.hpp"
+#include "rclcpp/shared_memory_transport_options.hpp"
 
 namespace rclcpp
 {
@@ -58,6 +60,43 @@ struct PublisherOptionsBase
   std::shared_ptr<rclcpp::detail::RMWImplementationSpecificPublisherPayload>
   rmw_implementation_payload = nullptr;
 
+  /// Transport of the messages to the subscriptions of other processes of the host.
+  SharedMemoryTransportOptions shared_memory_transport;
+
+  /// Keep the serialization of the last message published by shared pointer.
+  /**
+   * Publishing the same message again then publishes its serialization,
+   * without serializing it again: the message must not be modified once published.
+   */
+  bool cache_serialized_message = false;
+
+  /// Decimation of the published messages, by rate or by count, none by default.
+  PublishThrottlingOptions throttling;
+
+  /// Drop the published messages while no subscription is matched, before any conversion.
+  /**
+   * The messages are then neither converted from a TypeAdapter custom type
+   * nor serialized.
+   * This is ignored for a transient local publisher, whose late joining
+   * subscriptions get the messages published before they were matched.
+   * \sa rclcpp::PublisherBase::has_subscribers()
+   */
+  bool skip_publish_without_subscribers = false;
+
+  /// Number of messages of a pool the loaned messages are borrowed from without a middleware loan.
+  /**
+   * When the middleware cannot loan messages, Publisher::borrow_loaned_message()
+   * allocates a message, unless this is set: the messages are then borrowed
+   * from a pool of messages allocated with the publisher, and reused once
+   * published or dropped, so that borrowing a loaned message does not allocate.
+   * Like a message loaned by the middleware, a pooled message keeps the value
+   * it was given when last used, the fields are to be set before publishing it.
+   * It should be at least the number of loaned messages alive at a time, plus
+   * the number of messages kept by the intra-process subscriptions.
+   * 0, the default, allocates a message for each loan.
+   */
+  size_t loaned_message_pool_size = 0;
+
   QosOverridingOptions qos_overriding_options;
 };
 
@@ -17,8 +17,11 @@
 
 #include <functional>
 #include <memory>
+#include <mutex>
 #include <stdexcept>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "rcl/error_handling.h"
 #include "rmw/incompatible_qos_events_statuses.h"
@@ -27,6 +30,7 @@
 
 #include "rclcpp/exceptions.hpp"
 #include "rclcpp/function_traits.hpp"
+#include "rclcpp/macros.hpp"
 #include "rclcpp/waitable.hpp"
 
 namespace rclcpp
@@ -168,6 +172,71 @@ private:
   EventCallbackT event_callback_;
 };
 
+/// Waitable multiplexing the QoS event handlers of many entities.
+/**
+ * The executors handle it as a single waitable instead of one per event
+ * handler, so that the event handlers of many publishers and subscriptions
+ * do not add to the cost of collecting and checking the waitables at each
+ * wake up.
+ * Each event is still waited on in the rcl wait set.
+ *
+ * The event handlers are not owned, the ones which no longer exist are
+ * forgotten.
+ * The event handlers waited on are the ones which existed at the last call
+ * to get_number_of_ready_events(), which is what sizes the wait set, and
+ * they are kept alive until the next call.
+ */
+class QOSEventHandlerGroup : public Waitable
+{
+public:
+  RCLCPP_SMART_PTR_DEFINITIONS(QOSEventHandlerGroup)
+
+  /// Add an event handler to the group.
+  RCLCPP_PUBLIC
+  void
+  add_event_handler(const std::shared_ptr<QOSEventHandlerBase> & event_handler);
+
+  /// Get the number of event handlers of the group which still exist.
+  RCLCPP_PUBLIC
+  size_t
+  size() const;
+
+  /// Get the number of events of the event handlers to wait on.
+  RCLCPP_PUBLIC
+  size_t
+  get_number_of_ready_events() override;
+
+  /// Add the events of the event handlers to a wait set.
+  RCLCPP_PUBLIC
+  bool
+  add_to_wait_set(rcl_wait_set_t * wait_set) override;
+
+  /// Check if any of the event handlers is ready.
+  RCLCPP_PUBLIC
+  bool
+  is_ready(rcl_wait_set_t * wait_set) override;
+
+  /// Take the data of all the ready event handlers.
+  RCLCPP_PUBLIC
+  std::shared_ptr<void>
+  take_data() override;
+
+  /// Execute the callbacks of the event handlers whose data was taken.
+  RCLCPP_PUBLIC
+  void
+  execute(std::shared_ptr<void> & data) override;
+
+private:
+  using TakenEvents = std::vector<
+    std::pair<std::shared_ptr<QOSEventHandlerBase>, std::shared_ptr<void>>>;
+
+  mutable std::mutex event_handlers_mutex_;
+  std::vector<std::weak_ptr<QOSEventHandlerBase>> event_handlers_;
+  /// Event handlers waited on, only used by the thread waiting.
+  std::vector<std::shared_ptr<QOSEventHandlerBase>> waited_event_handlers_;
+  std::vector<std::shared_ptr<QOSEventHandlerBase>> ready_event_handlers_;
+};
+
 }  // namespace rclcpp
 
 #endif  // RCLCPP__QOS_EVENT_HPP_
@@ -70,6 +70,7 @@ class QosParameters;
  * - An optional callback, that will be called to validate the final qos profile.
  * - An optional id. In the case that different qos are desired for two publishers/subscriptions in
  *   the same topic, this id will allow disambiguating them.
+ * - Whether the parameters are declared, or only read from the parameter overrides.
  *
  * Example parameter file:
  *
@@ -129,6 +130,23 @@ public:
   const QosCallback &
   get_validation_callback() const;
 
+  /// Return true if the parameters of the policies are declared, true by default.
+  RCLCPP_PUBLIC
+  bool
+  get_declare_parameters() const;
+
+  /// Set if the parameters of the policies are declared, return this.
+  /**
+   * If false, the policies are overridden by the parameter overrides of the
+   * node, as if the parameters were declared, but the parameters are not
+   * declared, sparing the declarations and their parameter events.
+   * They are then not listed or described by the parameter services of the node.
+   * It is meant for the nodes with many entities whose QoS is configurable.
+   */
+  RCLCPP_PUBLIC
+  QosOverridingOptions &
+  set_declare_parameters(bool declare_parameters);
+
   /// Construct passing a list of QoS policies and a verification callback.
   /**
    * Same as `QosOverridingOptions` constructor, but only declares the default policies:
@@ -147,6 +165,8 @@ private:
   std::vector<QosPolicyKind> policy_kinds_;
   /// \internal Validation callback that will be called to verify the profile.
   QosCallback validation_callback_;
+  /// \internal Whether the parameters are declared, or only read from the overrides.
+  bool declare_parameters_{true};
 };
 
 }  // namespace rclcpp
@@ -15,9 +15,16 @@
 #ifndef RCLCPP__RATE_HPP_
 #define RCLCPP__RATE_HPP_
 
+#include <algorithm>
 #include <chrono>
+#include <cstdint>
 #include <memory>
 #include <thread>
+#include <type_traits>
+
+#if defined(__linux__)
+#include <time.h>
+#endif
 
 #include "rclcpp/macros.hpp"
 #include "rclcpp/utilities.hpp"
@@ -41,18 +48,90 @@ using std::chrono::duration;
 using std::chrono::duration_cast;
 using std::chrono::nanoseconds;
 
+/// Options changing how a GenericRate waits for the end of its period.
+struct RateOptions
+{
+  /// Sleep until the absolute end of the period instead of for the time remaining.
+  /**
+   * The wakeup time does not depend on how long it took to compute the time
+   * to sleep, and a loop which overran several periods keeps its phase
+   * instead of restarting its periods from the time it noticed the overrun.
+   */
+  bool use_absolute_deadlines = false;
+  /// Busy wait instead of sleeping for this last part of the period.
+  /**
+   * It trades CPU time for a wakeup which is not delayed by the scheduler,
+   * a few tens of microseconds are usually enough.
+   */
+  std::chrono::nanoseconds spin_threshold{0};
+};
+
+namespace detail
+{
+
+/// Sleep until the given time of Clock, waking up periodically to check for shutdown.
+/**
+ * On Linux, the steady and system clocks sleep with clock_nanosleep() on an
+ * absolute time, other clocks and platforms use std::this_thread::sleep_until().
+ *
+ * \return false if rclcpp was shut down before the time was reached, true otherwise.
+ */
+template<class Clock, class Duration>
+bool
+sleep_until(const std::chrono::time_point<Clock, Duration> & time)
+{
+  // Upper bound of how long a shutdown goes unnoticed.
+  constexpr std::chrono::milliseconds max_sleep_duration(100);
+  const bool was_ok = rclcpp::ok();
+  auto now = Clock::now();
+  while (now < time) {
+    if (was_ok && !rclcpp::ok()) {
+      return false;
+    }
+    const auto wakeup_time = std::min(
+      std::chrono::time_point_cast<Duration>(time),
+      std::chrono::time_point_cast<Duration>(now + max_sleep_duration));
+#if defined(__linux__)
+    constexpr bool is_posix_clock =
+      std::is_same<Clock, std::chrono::steady_clock>::value ||
+      std::is_same<Clock, std::chrono::system_clock>::value;
+    if (is_posix_clock) {
+      const clockid_t clock_id =
+        std::is_same<Clock, std::chrono::steady_clock>::value ? CLOCK_MONOTONIC : CLOCK_REALTIME;
+      const int64_t wakeup_time_ns =
+        duration_cast<nanoseconds>(wakeup_time.time_since_epoch()).count();
+      timespec wakeup_timespec;
+      wakeup_timespec.tv_sec = static_cast<time_t>(wakeup_time_ns / 1000000000);
+      wakeup_timespec.tv_nsec = static_cast<long>(wakeup_time_ns % 1000000000);  // NOLINT
+      // Being interrupted by a signal only means checking for shutdown earlier.
+      clock_nanosleep(clock_id, TIMER_ABSTIME, &wakeup_timespec, nullptr);
+    } else {
+      std::this_thread::sleep_until(wakeup_time);
+    }
+#else
+    std::this_thread::sleep_until(wakeup_time);
+#endif
+    now = Clock::now();
+  }
+  return true;
+}
+
+}  // namespace detail
+
 template<class Clock = std::chrono::high_resolution_clock>
 class GenericRate : public RateBase
 {
 public:
   RCLCPP_SMART_PTR_DEFINITIONS(GenericRate)
 
-  explicit GenericRate(double rate)
+  explicit GenericRate(double rate, const RateOptions & options = RateOptions())
   : GenericRate<Clock>(
-      duration_cast<nanoseconds>(duration<double>(1.0 / rate)))
+      duration_cast<nanoseconds>(duration<double>(1.0 / rate)), options)
   {}
-  explicit GenericRate(std::chrono::nanoseconds period)
-  : period_(period), last_interval_(Clock::now())
+  explicit GenericRate(
+    std::chrono::nanoseconds period,
+    const RateOptions & options = RateOptions())
+  : period_(period), options_(options), last_interval_(Clock::now())
   {}
 
   virtual bool
@@ -73,17 +152,37 @@ public:
     last_interval_ += period_;
     // If the time_to_sleep is negative or zero, don't sleep
     if (time_to_sleep <= std::chrono::seconds(0)) {
+      // Count the ends of periods which passed before sleep() was called.
+      const auto missed_cycles = 1 + (now - next_interval) / period_;
+      missed_cycles_ += static_cast<uint64_t>(missed_cycles);
       // If an entire cycle was missed then reset next interval.
       // This might happen if the loop took more than a cycle.
       // Or if time jumps forward.
       if (now > next_interval + period_) {
-        last_interval_ = now + period_;
+        if (options_.use_absolute_deadlines) {
+          // Stay in phase, the next interval is the first one ending after now.
+          last_interval_ = next_interval + (missed_cycles - 1) * period_;
+        } else {
+          last_interval_ = now + period_;
+        }
       }
       // Either way do not sleep and return false
       return false;
     }
-    // Sleep (will get interrupted by ctrl-c, may not sleep full time)
-    rclcpp::sleep_for(time_to_sleep);
+    const auto sleep_end = next_interval - options_.spin_threshold;
+    if (options_.use_absolute_deadlines) {
+      // Sleep (will get interrupted by ctrl-c, may not sleep full time)
+      if (!detail::sleep_until(sleep_end)) {
+        return true;
+      }
+    } else if (sleep_end > now) {
+      // Sleep (will get interrupted by ctrl-c, may not sleep full time)
+      if (!rclcpp::sleep_for(sleep_end - now)) {
+        return true;
+      }
+    }
+    while (options_.spin_threshold > nanoseconds(0) && Clock::now() < next_interval) {
+    }
     return true;
   }
 
@@ -104,10 +203,30 @@ public:
     return period_;
   }
 
+  /// Return the options the rate was constructed with.
+  const RateOptions &
+  get_options() const
+  {
+    return options_;
+  }
+
+  /// Return how many periods ended before sleep() was called since the construction.
+  /**
+   * Every call to sleep() which returned false counts the ends of periods
+   * which passed before it, at least one.
+   */
+  uint64_t
+  get_missed_cycles() const
+  {
+    return missed_cycles_;
+  }
+
 private:
   RCLCPP_DISABLE_COPY(GenericRate)
 
   std::chrono::nanoseconds period_;
+  RateOptions options_;
+  uint64_t missed_cycles_ = 0;
   using ClockDurationNano = std::chrono::duration<typename Clock::rep, std::nano>;
   std::chrono::time_point<Clock, ClockDurationNano> last_interval_;
 };
@@ -29,6 +29,10 @@
  *   - rclcpp::Node::create_subscription()
  *   - rclcpp::Subscription
  *   - rclcpp/subscription.hpp
+ * - Synchronized subscription (sets of messages of several topics with matching stamps):
+ *   - rclcpp::create_synchronized_subscription()
+ *   - rclcpp::SynchronizedSubscription
+ *   - rclcpp/synchronized_subscription.hpp
  * - Service Client
  *   - rclcpp::Node::create_client()
  *   - rclcpp::Client
@@ -95,6 +99,10 @@
  * - Get the number of publishers or subscribers on a topic:
  *   - rclcpp::Node::count_publishers()
  *   - rclcpp::Node::count_subscribers()
+ * - Graph changes (the nodes and endpoints added or removed, given to a callback):
+ *   - rclcpp::create_graph_change_subscription()
+ *   - rclcpp::GraphChangeSubscription
+ *   - rclcpp/graph_change_subscription.hpp
  *
  * And components related to logging:
  *
@@ -152,6 +160,8 @@
 #include <csignal>
 #include <memory>
 
+#include "rclcpp/create_graph_change_subscription.hpp"
+#include "rclcpp/create_synchronized_subscription.hpp"
 #include "rclcpp/executors.hpp"
 #include "rclcpp/guard_condition.hpp"
 #include "rclcpp/logging.hpp"
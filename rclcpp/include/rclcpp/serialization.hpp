@@ -60,12 +60,43 @@ public:
 
   /// Serialize a ROS2 message to a serialized stream
   /**
+   * The buffer of the serialized message is only grown, when the message
+   * does not fit in its capacity: reusing a serialized message for the
+   * messages of a topic allocates until it reached the size of the largest one.
+   *
    * \param[in] ros_message The ROS2 message which is read and serialized by rmw.
    * \param[out] serialized_message The serialized message.
    */
   void serialize_message(
     const void * ros_message, SerializedMessage * serialized_message) const;
 
+  /// Serialize a ROS2 message into memory owned by the caller, without allocating.
+  /**
+   * If the message does not fit, nothing is allocated and 0 is returned:
+   * required_size is then set to the capacity the middleware asked for, if it
+   * told, so that the caller can retry with a larger buffer.
+   *
+   * \param[in] ros_message The ROS2 message which is read and serialized by rmw.
+   * \param[out] buffer The memory the message is serialized into.
+   * \param[in] capacity The size of the buffer, in bytes.
+   * \param[out] required_size If not null, set to the capacity needed, or 0 if unknown.
+   * \return The size of the serialized message, or 0 if it did not fit in the buffer.
+   * \throws rclcpp::exceptions::RCLError if the serialization failed otherwise.
+   */
+  size_t serialize_message(
+    const void * ros_message, void * buffer, size_t capacity,
+    size_t * required_size = nullptr) const;
+
+  /// Return the size of the serialization of a ROS2 message, without allocating.
+  /**
+   * The size is the one the middleware asks for when serializing the message
+   * into an empty buffer.
+   *
+   * \param[in] ros_message The ROS2 message which is read by rmw.
+   * \return The size of the serialized message, or 0 if the middleware does not tell it.
+   */
+  size_t get_serialized_size(const void * ros_message) const;
+
   /// Deserialize a serialized stream to a ROS message
   /**
    * \param[in] serialized_message The serialized message to be converted to ROS2 by rmw.
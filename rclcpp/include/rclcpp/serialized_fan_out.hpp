@@ -0,0 +1,135 @@
+// Copyright 2021 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__SERIALIZED_FAN_OUT_HPP_
+#define RCLCPP__SERIALIZED_FAN_OUT_HPP_
+
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "rclcpp/generic_publisher.hpp"
+#include "rclcpp/macros.hpp"
+#include "rclcpp/publisher.hpp"
+#include "rclcpp/serialization.hpp"
+#include "rclcpp/serialized_message.hpp"
+
+namespace rclcpp
+{
+
+/// Publishes a message on several publishers, serializing it once.
+/**
+ * The message is serialized into a buffer kept from a publish to the next,
+ * so that it is only reallocated when a message is larger than all the
+ * previous ones, then the serialization is published by all the publishers,
+ * like the raw topic of a message, its relay and its recorder.
+ *
+ * The publishers of MessageT give the message itself to their intra-process
+ * subscriptions, the GenericPublishers give them the serialization.
+ *
+ * Publishing is thread-safe, the publishers should be added beforehand.
+ *
+ * \tparam MessageT ROS message type of the publishers
+ */
+template<typename MessageT>
+class SerializedFanOut
+{
+public:
+  RCLCPP_SMART_PTR_DEFINITIONS_NOT_COPYABLE(SerializedFanOut)
+
+  /// Create a fan-out without publishers.
+  /**
+   * \param[in] initial_capacity bytes allocated up front for the serialized messages.
+   */
+  explicit SerializedFanOut(size_t initial_capacity = 0)
+  : serialized_message_(initial_capacity)
+  {}
+
+  /// Add a publisher of the message type.
+  template<typename AllocatorT>
+  void
+  add_publisher(std::shared_ptr<rclcpp::Publisher<MessageT, AllocatorT>> publisher)
+  {
+    if (!publisher) {
+      throw std::invalid_argument("publisher argument must not be null");
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    publishers_.push_back(
+      [publisher](const MessageT & msg, const rclcpp::SerializedMessage & serialized_msg) {
+        publisher->publish(msg, serialized_msg);
+      });
+  }
+
+  /// Add a publisher of serialized messages, created for the type of the message.
+  void
+  add_publisher(rclcpp::GenericPublisher::SharedPtr publisher)
+  {
+    if (!publisher) {
+      throw std::invalid_argument("publisher argument must not be null");
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    publishers_.push_back(
+      [publisher](const MessageT &, const rclcpp::SerializedMessage & serialized_msg) {
+        publisher->publish(serialized_msg);
+      });
+  }
+
+  /// Return the number of publishers.
+  size_t
+  get_publisher_count() const
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return publishers_.size();
+  }
+
+  /// Serialize the message once and publish it with all the publishers, in order.
+  /**
+   * \param[in] msg the message to publish.
+   */
+  void
+  publish(const MessageT & msg)
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    serialization_.serialize_message(&msg, &serialized_message_);
+    for (const auto & publish_serialized : publishers_) {
+      publish_serialized(msg, serialized_message_);
+    }
+  }
+
+  /// Return the serialization of the message published last.
+  /**
+   * It is overwritten by the next call to publish().
+   */
+  const rclcpp::SerializedMessage &
+  get_serialized_message() const
+  {
+    return serialized_message_;
+  }
+
+private:
+  using PublishSerialized =
+    std::function<void (const MessageT &, const rclcpp::SerializedMessage &)>;
+
+  mutable std::mutex mutex_;
+  rclcpp::Serialization<MessageT> serialization_;
+  rclcpp::SerializedMessage serialized_message_;
+  std::vector<PublishSerialized> publishers_;
+};
+
+}  // namespace rclcpp
+
+#endif  // RCLCPP__SERIALIZED_FAN_OUT_HPP_
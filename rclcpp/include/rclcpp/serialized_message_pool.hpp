@@ -0,0 +1,105 @@
+// Copyright 2021 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__SERIALIZED_MESSAGE_POOL_HPP_
+#define RCLCPP__SERIALIZED_MESSAGE_POOL_HPP_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "rclcpp/macros.hpp"
+#include "rclcpp/serialized_message.hpp"
+#include "rclcpp/visibility_control.hpp"
+
+namespace rclcpp
+{
+
+/// Pool recycling serialized messages and the capacity of their buffers.
+/**
+ * The sizes of the returned messages are recorded, and borrowed messages are
+ * given a capacity covering the 99th percentile of the recent sizes, so that
+ * taking a serialized message into them does not allocate memory once the
+ * pool is warmed up.
+ * Returned messages with a much larger capacity are released rather than
+ * pooled, not to hold the memory of rare large messages.
+ *
+ * Borrowing and returning messages is thread-safe.
+ */
+class SerializedMessagePool
+{
+public:
+  RCLCPP_SMART_PTR_DEFINITIONS_NOT_COPYABLE(SerializedMessagePool)
+
+  /// Default maximum number of messages kept by the pool.
+  static constexpr size_t default_max_pooled_messages = 16;
+
+  /// Create an empty pool.
+  /**
+   * \param[in] max_pooled_messages maximum number of returned messages kept for reuse.
+   */
+  RCLCPP_PUBLIC
+  explicit SerializedMessagePool(size_t max_pooled_messages = default_max_pooled_messages);
+
+  /// Borrow a message of the pool, or create one if the pool is empty.
+  /**
+   * \param[in] minimum_capacity capacity the message has at least, in addition to the
+   *   percentile of the sizes.
+   * \return Shared pointer to an empty serialized message.
+   */
+  RCLCPP_PUBLIC
+  std::shared_ptr<rclcpp::SerializedMessage>
+  borrow_serialized_message(size_t minimum_capacity = 0);
+
+  /// Record the size of the message and keep it for reuse.
+  /**
+   * The message is released instead if it is still referenced elsewhere, if the
+   * pool is full, or if its capacity is much larger than the percentile of the sizes.
+   * \param[in] serialized_message Shared pointer to the message to return, reset.
+   */
+  RCLCPP_PUBLIC
+  void
+  return_serialized_message(std::shared_ptr<rclcpp::SerializedMessage> & serialized_message);
+
+  /// Return the capacity given to the borrowed messages, the 99th percentile of the sizes.
+  RCLCPP_PUBLIC
+  size_t
+  get_target_capacity() const;
+
+  /// Return the number of messages kept for reuse.
+  RCLCPP_PUBLIC
+  size_t
+  get_number_of_pooled_messages() const;
+
+private:
+  void
+  record_size(size_t size);
+
+  // Sizes in (2^(i-2), 2^(i-1)] are counted in bucket i > 0, empty messages in bucket 0.
+  static constexpr size_t bucket_count = sizeof(size_t) * 8 + 2;
+
+  const size_t max_pooled_messages_;
+  mutable std::mutex mutex_;
+  std::vector<std::shared_ptr<rclcpp::SerializedMessage>> pooled_messages_;
+  std::array<uint64_t, bucket_count> size_counts_;
+  uint64_t recorded_size_count_;
+  size_t target_capacity_;
+};
+
+}  // namespace rclcpp
+
+#endif  // RCLCPP__SERIALIZED_MESSAGE_POOL_HPP_
@@ -0,0 +1,181 @@
+// Copyright 2021 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__SERIALIZED_MESSAGE_READER_HPP_
+#define RCLCPP__SERIALIZED_MESSAGE_READER_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "rcl/types.h"
+
+#include "rcpputils/shared_library.hpp"
+
+#include "rosidl_runtime_c/message_type_support_struct.h"
+#include "rosidl_typesupport_introspection_cpp/field_types.hpp"
+
+#include "rclcpp/macros.hpp"
+#include "rclcpp/serialized_message.hpp"
+#include "rclcpp/visibility_control.hpp"
+
+namespace rclcpp
+{
+
+/// Reads fields of the serialized messages of a type, without deserializing the messages.
+/**
+ * The fields are read directly from the CDR buffer of the messages, e.g. the
+ * messages of a rclcpp::GenericSubscription, so that a relay filtering the
+ * messages on a field of their header does not need to materialize them.
+ *
+ * The layout of the messages is described by the introspection type support
+ * of their type.
+ * A field is looked up by name once, with get_field(), then read from any
+ * message with read().
+ * The fields which follow only fields of a fixed size, like the header stamp,
+ * are read at an offset computed once; the others are found by skipping
+ * the fields before them.
+ *
+ * The messages must be encoded in plain CDR, as by the middlewares of ROS 2;
+ * wide characters are expected on 4 bytes, as Fast-CDR encodes them.
+ */
+class SerializedMessageReader
+{
+public:
+  RCLCPP_SMART_PTR_DEFINITIONS(SerializedMessageReader)
+
+  /// A field of the messages, resolved by get_field().
+  struct Field
+  {
+    /// Index of the member in its message, for the field and for each message it is nested in.
+    std::vector<size_t> member_indices;
+    /// Type of the field, a rosidl_typesupport_introspection_cpp::ROS_TYPE_* value.
+    uint8_t type_id = 0;
+    /// True if the field is an array or a sequence.
+    bool is_array = false;
+    /// True if the field is found after the encapsulation at fixed_offset, in all the messages.
+    bool has_fixed_offset = false;
+    size_t fixed_offset = 0;
+  };
+
+  /// Load the introspection type support of the type.
+  /**
+   * \param[in] type the type of the messages, e.g. "std_msgs/msg/Header".
+   * \throws std::runtime_error if the type support cannot be loaded.
+   */
+  RCLCPP_PUBLIC
+  explicit SerializedMessageReader(const std::string & type);
+
+  /// Use the introspection type support the given type support provides.
+  /**
+   * \param[in] type_support a type support of the messages, e.g. the one of
+   *   rosidl_typesupport_cpp::get_message_type_support_handle<MessageT>().
+   * \throws std::runtime_error if it provides no introspection type support.
+   */
+  RCLCPP_PUBLIC
+  explicit SerializedMessageReader(const rosidl_message_type_support_t * type_support);
+
+  /// Resolve a field of the messages.
+  /**
+   * \param[in] path the names of the field and of the messages it is nested in,
+   *   separated by dots, e.g. "header.stamp.sec".
+   * \throws std::invalid_argument if there is no such field, or if a message of the
+   *   path is an array.
+   */
+  RCLCPP_PUBLIC
+  Field
+  get_field(const std::string & path) const;
+
+  /// Read a field of a message, which is neither an array nor a nested message.
+  /**
+   * \tparam T the C++ type of the field: bool, a fixed size integer type,
+   *   float, double or std::string.
+   * \throws std::invalid_argument if T is not the type of the field.
+   * \throws std::runtime_error if the message is shorter than its type tells.
+   */
+  template<typename T>
+  T
+  read(const SerializedMessage & message, const Field & field) const
+  {
+    T value{};
+    read_field(message.get_rcl_serialized_message(), field, get_type_id<T>(), &value);
+    return value;
+  }
+
+  /// Return the number of elements of an array or a sequence field of a message.
+  /**
+   * \throws std::invalid_argument if the field is not an array nor a sequence.
+   * \throws std::runtime_error if the message is shorter than its type tells.
+   */
+  RCLCPP_PUBLIC
+  size_t
+  get_size(const SerializedMessage & message, const Field & field) const;
+
+private:
+  template<typename T>
+  static constexpr uint8_t
+  get_type_id()
+  {
+    namespace introspection = rosidl_typesupport_introspection_cpp;
+    static_assert(
+      std::is_arithmetic<T>::value || std::is_same<T, std::string>::value,
+      "the field can only be read as a primitive type or a std::string");
+    if constexpr (std::is_same<T, bool>::value) {
+      return introspection::ROS_TYPE_BOOLEAN;
+    } else if constexpr (std::is_same<T, float>::value) {
+      return introspection::ROS_TYPE_FLOAT;
+    } else if constexpr (std::is_same<T, double>::value) {
+      return introspection::ROS_TYPE_DOUBLE;
+    } else if constexpr (std::is_same<T, std::string>::value) {
+      return introspection::ROS_TYPE_STRING;
+    } else if constexpr (std::is_same<T, uint8_t>::value) {
+      return introspection::ROS_TYPE_UINT8;
+    } else if constexpr (std::is_same<T, int8_t>::value) {
+      return introspection::ROS_TYPE_INT8;
+    } else if constexpr (std::is_same<T, uint16_t>::value) {
+      return introspection::ROS_TYPE_UINT16;
+    } else if constexpr (std::is_same<T, int16_t>::value) {
+      return introspection::ROS_TYPE_INT16;
+    } else if constexpr (std::is_same<T, uint32_t>::value) {
+      return introspection::ROS_TYPE_UINT32;
+    } else if constexpr (std::is_same<T, int32_t>::value) {
+      return introspection::ROS_TYPE_INT32;
+    } else if constexpr (std::is_same<T, uint64_t>::value) {
+      return introspection::ROS_TYPE_UINT64;
+    } else if constexpr (std::is_same<T, int64_t>::value) {
+      return introspection::ROS_TYPE_INT64;
+    } else {
+      static_assert(sizeof(T) == 0, "the field cannot be read as this type");
+    }
+  }
+
+  RCLCPP_PUBLIC
+  void
+  read_field(
+    const rcl_serialized_message_t & message,
+    const Field & field,
+    uint8_t type_id,
+    void * value) const;
+
+  std::shared_ptr<rcpputils::SharedLibrary> type_support_library_;
+  /// The rosidl_typesupport_introspection_cpp::MessageMembers of the type.
+  const void * members_;
+};
+
+}  // namespace rclcpp
+
+#endif  // RCLCPP__SERIALIZED_MESSAGE_READER_HPP_
@@ -19,14 +19,21 @@
 #include <functional>
 #include <iostream>
 #include <memory>
+#include <mutex>
 #include <sstream>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "rcl/error_handling.h"
 #include "rcl/service.h"
 
 #include "rclcpp/any_service_callback.hpp"
+#include "rclcpp/context.hpp"
+#include "rclcpp/detail/shared_object_pool.hpp"
 #include "rclcpp/exceptions.hpp"
+#include "rclcpp/experimental/service_intra_process.hpp"
+#include "rclcpp/experimental/service_intra_process_base.hpp"
 #include "rclcpp/macros.hpp"
 #include "rclcpp/type_support_decl.hpp"
 #include "rclcpp/expand_topic_or_service_name.hpp"
@@ -39,6 +46,15 @@
 namespace rclcpp
 {
 
+namespace experimental
+{
+/**
+ * IntraProcessManager is forward declared here, avoiding a circular inclusion between
+ * `intra_process_manager.hpp` and `service.hpp`.
+ */
+class IntraProcessManager;
+}  // namespace experimental
+
 class ServiceBase
 {
 public:
@@ -93,6 +109,21 @@ public:
   bool
   take_type_erased_request(void * request_out, rmw_request_id_t & request_id_out);
 
+  /// Send a response to a request taken by this service, as a type erased pointer.
+  /**
+   * The requests are taken and the responses are sent one at a time, so the
+   * response to a deferred request can be sent from any thread, while the
+   * executor keeps taking the next requests.
+   *
+   * \param[in] request_id the id of the request, as given by take_type_erased_request().
+   * \param[in] response The type erased pointer to the service response to send.
+   * \throws rclcpp::exceptions::RCLError based exceptions if the underlying
+   *   rcl calls fail.
+   */
+  RCLCPP_PUBLIC
+  void
+  send_type_erased_response(rmw_request_id_t & request_id, void * response);
+
   virtual
   std::shared_ptr<void>
   create_request() = 0;
@@ -107,6 +138,39 @@ public:
     std::shared_ptr<rmw_request_id_t> request_header,
     std::shared_ptr<void> request) = 0;
 
+  /// A type erased request and its header.
+  using TypeErasedRequest = std::pair<std::shared_ptr<rmw_request_id_t>, std::shared_ptr<void>>;
+
+  /// Handle the requests taken in one execution of the service.
+  /**
+   * By default, the requests are given to handle_request() one after the other.
+   *
+   * \param[in] requests the requests, in the order they were taken.
+   */
+  RCLCPP_PUBLIC
+  virtual
+  void
+  handle_requests(std::vector<TypeErasedRequest> & requests);
+
+  /// Set how many requests are taken at most each time the executor executes the service.
+  /**
+   * The requests received in a burst are then taken and handled together,
+   * rather than the executor waiting again for each of them.
+   * A callback handling batches of requests is given up to this number of
+   * requests at a time.
+   *
+   * \param[in] max_requests the maximum number of requests, 1 by default.
+   * \throws std::invalid_argument if max_requests is 0.
+   */
+  RCLCPP_PUBLIC
+  void
+  set_max_requests_per_execution(size_t max_requests);
+
+  /// Return how many requests are taken at most each time the service is executed.
+  RCLCPP_PUBLIC
+  size_t
+  get_max_requests_per_execution() const;
+
   /// Exchange the "in use by wait set" state for this service.
   /**
    * This is used to ensure this service is not used by multiple
@@ -121,9 +185,25 @@ public:
   bool
   exchange_in_use_by_wait_set_state(bool in_use_state);
 
+  /// Return the waitable for intra-process requests, or nullptr if intra-process is disabled.
+  RCLCPP_PUBLIC
+  rclcpp::Waitable::SharedPtr
+  get_intra_process_waitable() const;
+
 protected:
   RCLCPP_DISABLE_COPY(ServiceBase)
 
+  /// Register the intra-process part of the service with the intra-process manager.
+  /**
+   * \param[in] service_intra_process the waitable executing the intra-process requests.
+   * \param[in] context the context whose intra-process manager is used.
+   */
+  RCLCPP_PUBLIC
+  void
+  setup_intra_process(
+    rclcpp::experimental::ServiceIntraProcessBase::SharedPtr service_intra_process,
+    rclcpp::Context::SharedPtr context);
+
   RCLCPP_PUBLIC
   rcl_node_t *
   get_rcl_node_handle();
@@ -136,8 +216,15 @@ protected:
 
   std::shared_ptr<rcl_service_t> service_handle_;
   bool owns_rcl_handle_ = true;
+  /// Serializes the rcl calls on the service handle, which are not thread-safe.
+  std::mutex service_handle_mutex_;
 
   std::atomic<bool> in_use_by_wait_set_{false};
+  std::atomic<size_t> max_requests_per_execution_{1};
+
+  std::weak_ptr<rclcpp::experimental::IntraProcessManager> weak_ipm_;
+  uint64_t intra_process_service_id_ = 0;
+  rclcpp::experimental::ServiceIntraProcessBase::SharedPtr service_intra_process_base_;
 };
 
 template<typename ServiceT>
@@ -158,6 +245,8 @@ public:
       std::shared_ptr<typename ServiceT::Response>)>;
   RCLCPP_SMART_PTR_DEFINITIONS(Service)
 
+  using ServiceIntraProcessT = rclcpp::experimental::ServiceIntraProcess<ServiceT>;
+
   /// Default constructor.
   /**
    * The constructor for a Service is almost never called directly.
@@ -319,15 +408,59 @@ public:
     return this->take_type_erased_request(&request_out, request_id_out);
   }
 
+  /// Reuse the requests, the responses and the request headers once they are dropped.
+  /**
+   * They are then borrowed from pools of objects allocated here, instead of
+   * being allocated for each request: the requests and their headers are
+   * overwritten by the requests taken into them, and the responses are reset
+   * to their default value before being given to the callback.
+   * An object is borrowed again once the callback and the executor drop their
+   * references to it, when all of them are referenced a new one is allocated.
+   * The requests of the intra-process clients are not taken from the pools.
+   *
+   * The pools can only be enabled once, for instance right after the creation
+   * of the service, and are kept until it is destroyed.
+   *
+   * \param[in] pool_size number of objects of each pool, at least the number of
+   *   requests the callback keeps plus the number of requests taken at a time.
+   * \throws std::invalid_argument if pool_size is 0.
+   * \throws std::runtime_error if the pools are already enabled.
+   */
+  void
+  enable_object_pools(size_t pool_size)
+  {
+    auto object_pools = std::make_unique<ObjectPools>(pool_size);
+    ObjectPools * expected = nullptr;
+    if (!object_pools_.compare_exchange_strong(expected, object_pools.get())) {
+      throw std::runtime_error("the object pools of the service are already enabled");
+    }
+    object_pools_owner_ = std::move(object_pools);
+  }
+
+  /// Return true if the requests, the responses and the request headers are pooled.
+  bool
+  has_object_pools() const
+  {
+    return object_pools_.load(std::memory_order_acquire) != nullptr;
+  }
+
   std::shared_ptr<void>
   create_request() override
   {
+    ObjectPools * object_pools = object_pools_.load(std::memory_order_acquire);
+    if (object_pools) {
+      return object_pools->requests.borrow();
+    }
     return std::make_shared<typename ServiceT::Request>();
   }
 
   std::shared_ptr<rmw_request_id_t>
   create_request_header() override
   {
+    ObjectPools * object_pools = object_pools_.load(std::memory_order_acquire);
+    if (object_pools) {
+      return object_pools->request_headers.borrow();
+    }
     return std::make_shared<rmw_request_id_t>();
   }
 
@@ -337,26 +470,158 @@ public:
     std::shared_ptr<void> request) override
   {
     auto typed_request = std::static_pointer_cast<typename ServiceT::Request>(request);
-    auto response = any_callback_.dispatch(this->shared_from_this(), request_header, typed_request);
+    auto response = any_callback_.dispatch(
+      this->shared_from_this(), request_header, typed_request, create_response());
     if (response) {
       send_response(*request_header, *response);
     }
   }
 
+  /// Give the requests to the callback in one batch, if it handles batches.
+  void
+  handle_requests(std::vector<TypeErasedRequest> & requests) override
+  {
+    if (!any_callback_.is_batch_callback()) {
+      ServiceBase::handle_requests(requests);
+      return;
+    }
+    std::vector<std::shared_ptr<typename ServiceT::Request>> typed_requests;
+    std::vector<std::shared_ptr<typename ServiceT::Response>> responses;
+    typed_requests.reserve(requests.size());
+    responses.reserve(requests.size());
+    for (auto & request : requests) {
+      typed_requests.push_back(
+        std::static_pointer_cast<typename ServiceT::Request>(request.second));
+      responses.push_back(create_response());
+    }
+    any_callback_.dispatch_batch(typed_requests, responses);
+    for (size_t i = 0; i < requests.size(); ++i) {
+      send_response(*requests[i].first, *responses[i]);
+    }
+  }
+
+  /// Enable the requests of the intra-process clients to be received by pointer.
+  /**
+   * The clients with intra-process enabled, in the same context and with the
+   * same service name, then pass their requests to this service by pointer,
+   * and receive its responses by pointer, instead of through the middleware.
+   * The service still receives the requests of the other clients through the
+   * middleware.
+   *
+   * This is called by rclcpp::create_service(), before the service is added
+   * to its callback group.
+   *
+   * \param[in] context the context whose intra-process manager is used.
+   */
+  void
+  enable_intra_process(rclcpp::Context::SharedPtr context)
+  {
+    std::weak_ptr<Service> weak_this = this->shared_from_this();
+    service_intra_process_ = std::make_shared<ServiceIntraProcessT>(
+      context,
+      get_service_name(),
+      [weak_this](
+        std::shared_ptr<rmw_request_id_t> request_header,
+        std::shared_ptr<typename ServiceT::Request> request)
+      {
+        auto service = weak_this.lock();
+        if (service) {
+          service->handle_intra_process_request(request_header, std::move(request));
+        }
+      });
+    this->setup_intra_process(service_intra_process_, context);
+  }
+
+  /// Send the response to a request.
+  /**
+   * The callbacks which take the request header and not the response defer
+   * the response, which is then sent with this method when it is ready.
+   * It can be called from any thread, so the requests may be handed over to
+   * other threads while the service keeps receiving the next ones.
+   *
+   * \param[in] req_id the header of the request given to the callback.
+   * \param[in] response the response to the request.
+   * \throws rclcpp::exceptions::RCLError based exceptions if the response cannot be sent.
+   */
   void
   send_response(rmw_request_id_t & req_id, typename ServiceT::Response & response)
   {
-    rcl_ret_t ret = rcl_send_response(get_service_handle().get(), &req_id, &response);
+    if (service_intra_process_ && ServiceIntraProcessT::is_intra_process_request(req_id)) {
+      // A deferred response is only given by reference, hand over a copy of it.
+      service_intra_process_->send_response(
+        req_id, std::make_shared<typename ServiceT::Response>(response));
+      return;
+    }
+    this->send_type_erased_response(req_id, &response);
+  }
 
-    if (ret != RCL_RET_OK) {
-      rclcpp::exceptions::throw_from_rcl_error(ret, "failed to send response");
+  /// Send the response to a request, by pointer.
+  /**
+   * Unlike with the response given by reference, the response to an
+   * intra-process request is given to the client without being copied.
+   * The response must then not be modified after being sent.
+   *
+   * \sa send_response(rmw_request_id_t &, typename ServiceT::Response &)
+   */
+  void
+  send_response(
+    rmw_request_id_t & req_id,
+    std::shared_ptr<typename ServiceT::Response> response)
+  {
+    if (service_intra_process_ && ServiceIntraProcessT::is_intra_process_request(req_id)) {
+      service_intra_process_->send_response(req_id, std::move(response));
+      return;
     }
+    this->send_type_erased_response(req_id, response.get());
   }
 
 private:
   RCLCPP_DISABLE_COPY(Service)
 
+  void
+  handle_intra_process_request(
+    std::shared_ptr<rmw_request_id_t> request_header,
+    std::shared_ptr<typename ServiceT::Request> request)
+  {
+    auto response = any_callback_.dispatch(
+      this->shared_from_this(), request_header, std::move(request), create_response());
+    if (response) {
+      service_intra_process_->send_response(*request_header, std::move(response));
+    }
+  }
+
+  /// Return a default response, or nullptr if the callback defers the responses.
+  std::shared_ptr<typename ServiceT::Response>
+  create_response()
+  {
+    if (any_callback_.defers_response()) {
+      return nullptr;
+    }
+    ObjectPools * object_pools = object_pools_.load(std::memory_order_acquire);
+    if (object_pools) {
+      auto response = object_pools->responses.borrow();
+      *response = typename ServiceT::Response();
+      return response;
+    }
+    return std::make_shared<typename ServiceT::Response>();
+  }
+
+  struct ObjectPools
+  {
+    explicit ObjectPools(size_t pool_size)
+    : requests(pool_size), responses(pool_size), request_headers(pool_size)
+    {}
+
+    rclcpp::detail::SharedObjectPool<typename ServiceT::Request> requests;
+    rclcpp::detail::SharedObjectPool<typename ServiceT::Response> responses;
+    rclcpp::detail::SharedObjectPool<rmw_request_id_t> request_headers;
+  };
+
   AnyServiceCallback<ServiceT> any_callback_;
+  typename ServiceIntraProcessT::SharedPtr service_intra_process_;
+  /// Pools set once by enable_object_pools(), owned by object_pools_owner_.
+  std::atomic<ObjectPools *> object_pools_{nullptr};
+  std::unique_ptr<ObjectPools> object_pools_owner_;
 };
 
 }  // namespace rclcpp
@@ -0,0 +1,51 @@
+// Copyright 2021 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__SHARED_MEMORY_TRANSPORT_OPTIONS_HPP_
+#define RCLCPP__SHARED_MEMORY_TRANSPORT_OPTIONS_HPP_
+
+#include <cstddef>
+
+namespace rclcpp
+{
+
+/// Options of the transport of messages between the processes of the host through shared memory.
+/**
+ * When enabled on a publisher and on subscriptions of the same topic in other
+ * processes of the host, the messages are copied in a ring of the topic in a
+ * shared memory segment instead of being sent through the middleware.
+ * It is only used by publishers and subscriptions of middlewares which
+ * cannot loan messages, which have their own zero copy transport.
+ *
+ * See rclcpp::experimental::SharedMemoryChannel.
+ */
+struct SharedMemoryTransportOptions
+{
+  /// True to copy messages through shared memory to the subscriptions of the host.
+  bool enabled = false;
+
+  /// Maximum size in bytes of a message, serialized if it is not trivially copyable.
+  /**
+   * Larger messages make the publisher throw std::length_error.
+   * The size given by the first endpoint opening the topic is used.
+   */
+  size_t slot_size = 4 * 1024 * 1024;
+
+  /// Number of messages of the ring, 0 to use the depth of the QoS.
+  size_t slot_count = 0;
+};
+
+}  // namespace rclcpp
+
+#endif  // RCLCPP__SHARED_MEMORY_TRANSPORT_OPTIONS_HPP_
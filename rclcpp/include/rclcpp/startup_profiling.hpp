@@ -0,0 +1,114 @@
+// Copyright 2021 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__STARTUP_PROFILING_HPP_
+#define RCLCPP__STARTUP_PROFILING_HPP_
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "rclcpp/visibility_control.hpp"
+
+namespace rclcpp
+{
+/// Instrumentation measuring the wall time spent in the phases of the startup of a process.
+/**
+ * Once enabled, through rclcpp::InitOptions::startup_profiling() or
+ * enable(), the time spent in each of these phases is accumulated per phase:
+ * - "context init": rclcpp::Context::init(),
+ * - "node base": the construction of the rclcpp::node_interfaces::NodeBase of a node,
+ * - "parameter overrides": the resolution of the parameter overrides of a node,
+ * - "publisher", "subscription", "service" and "client": the creation of an entity,
+ *   including the declaration of its QoS parameters and its intra-process setup,
+ * - "component load": the loading of a component by a component manager.
+ *
+ * The phases nest, the time of a component load includes the time of the
+ * creation of its node and entities for instance.
+ * The item of the slowest occurrence of each phase, like the topic name of a
+ * publisher, is kept to find what to look at first.
+ */
+namespace startup_profiling
+{
+
+/// Time spent in a phase since the profiling was enabled or reset.
+struct PhaseTimes
+{
+  /// Name of the phase, like "publisher".
+  std::string phase;
+  uint64_t count = 0;
+  std::chrono::nanoseconds total{0};
+  std::chrono::nanoseconds max{0};
+  /// Item of the slowest occurrence, like the topic name of a publisher, if any.
+  std::string slowest;
+};
+
+/// Start measuring the phases.
+RCLCPP_PUBLIC
+void
+enable();
+
+/// Stop measuring the phases, the times already measured are kept.
+RCLCPP_PUBLIC
+void
+disable();
+
+RCLCPP_PUBLIC
+bool
+is_enabled();
+
+/// Return the times measured per phase, the longest total first.
+RCLCPP_PUBLIC
+std::vector<PhaseTimes>
+get_phase_times();
+
+/// Forget the times measured.
+RCLCPP_PUBLIC
+void
+reset();
+
+/// Return the times measured, one line per phase, the longest total first.
+RCLCPP_PUBLIC
+std::string
+format_report();
+
+/// Measure the time spent in a phase, from the construction to the destruction of the scope.
+/**
+ * Nothing is measured if the profiling is not enabled when the scope is created.
+ * The strings must outlive the scope, they are only copied when the
+ * occurrence is the slowest of its phase.
+ */
+class ScopedPhase
+{
+public:
+  RCLCPP_PUBLIC
+  explicit ScopedPhase(const char * phase, const char * item = nullptr);
+
+  RCLCPP_PUBLIC
+  ~ScopedPhase();
+
+  ScopedPhase(const ScopedPhase &) = delete;
+  ScopedPhase & operator=(const ScopedPhase &) = delete;
+
+private:
+  const char * phase_;
+  const char * item_;
+  std::chrono::steady_clock::time_point start_;
+};
+
+}  // namespace startup_profiling
+}  // namespace rclcpp
+
+#endif  // RCLCPP__STARTUP_PROFILING_HPP_
@@ -15,12 +15,21 @@
 #ifndef RCLCPP__STRATEGIES__ALLOCATOR_MEMORY_STRATEGY_HPP_
 #define RCLCPP__STRATEGIES__ALLOCATOR_MEMORY_STRATEGY_HPP_
 
+#include <chrono>
+#include <cstdint>
+#include <functional>
 #include <memory>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
 #include <vector>
 
 #include "rcl/allocator.h"
+#include "rcl/error_handling.h"
+#include "rcl/timer.h"
 
 #include "rclcpp/allocator/allocator_common.hpp"
+#include "rclcpp/exceptions.hpp"
 #include "rclcpp/memory_strategy.hpp"
 #include "rclcpp/node.hpp"
 #include "rclcpp/visibility_control.hpp"
@@ -83,75 +92,83 @@ public:
 
   void clear_handles() override
   {
-    subscription_handles_.clear();
-    service_handles_.clear();
-    client_handles_.clear();
-    timer_handles_.clear();
-    waitable_handles_.clear();
+    subscriptions_.clear();
+    services_.clear();
+    clients_.clear();
+    timers_.clear();
+    waitables_.clear();
+    groups_.clear();
+    group_versions_.clear();
+    handle_owners_.clear();
   }
 
   void remove_null_handles(rcl_wait_set_t * wait_set) override
   {
     // TODO(jacobperron): Check if wait set sizes are what we expect them to be?
-    //                    e.g. wait_set->size_of_clients == client_handles_.size()
+    //                    e.g. wait_set->size_of_clients == clients_.size()
 
-    // Important to use subscription_handles_.size() instead of wait set's size since
+    // The handles are in the order of the slots of the wait set, as long as nothing was removed
+    // since they were added to it, so that a single pass compares them.
+    // Important to use subscriptions_.size() instead of wait set's size since
     // there may be more subscriptions in the wait set due to Waitables added to the end.
     // The same logic applies for other entities.
-    for (size_t i = 0; i < subscription_handles_.size(); ++i) {
-      if (!wait_set->subscriptions[i]) {
-        subscription_handles_[i].reset();
-      }
-    }
-    for (size_t i = 0; i < service_handles_.size(); ++i) {
-      if (!wait_set->services[i]) {
-        service_handles_[i].reset();
-      }
-    }
-    for (size_t i = 0; i < client_handles_.size(); ++i) {
-      if (!wait_set->clients[i]) {
-        client_handles_[i].reset();
-      }
+    subscriptions_.remove_unready(
+      [wait_set](size_t i, const rcl_subscription_t *) {return wait_set->subscriptions[i];});
+    services_.remove_unready(
+      [wait_set](size_t i, const rcl_service_t *) {return wait_set->services[i];});
+    clients_.remove_unready(
+      [wait_set](size_t i, const rcl_client_t *) {return wait_set->clients[i];});
+    timers_.remove_unready(
+      [wait_set](size_t i, const rcl_timer_t *) {return wait_set->timers[i];});
+    waitables_.remove_unready(
+      [wait_set](size_t, rclcpp::Waitable * waitable) {return waitable->is_ready(wait_set);});
+  }
+
+  void cache_collected_handles() override
+  {
+    cached_handle_owners_.assign(handle_owners_.begin(), handle_owners_.end());
+    cached_groups_.assign(groups_.begin(), groups_.end());
+    cached_group_versions_.assign(group_versions_.begin(), group_versions_.end());
+    cached_subscriptions_.assign(subscriptions_);
+    cached_services_.assign(services_);
+    cached_clients_.assign(clients_);
+    cached_timers_.assign(timers_);
+    cached_waitables_.assign(waitables_);
+    has_cached_handles_ = true;
+  }
+
+  bool restore_collected_handles() override
+  {
+    if (!has_cached_handles_) {
+      return false;
     }
-    for (size_t i = 0; i < timer_handles_.size(); ++i) {
-      if (!wait_set->timers[i]) {
-        timer_handles_[i].reset();
-      }
+    clear_handles();
+    if (!lock_all(cached_handle_owners_, handle_owners_) || !lock_all(cached_groups_, groups_)) {
+      // One of the entities went away, the cache can't be used anymore.
+      clear_handles();
+      has_cached_handles_ = false;
+      return false;
     }
-    for (size_t i = 0; i < waitable_handles_.size(); ++i) {
-      if (!waitable_handles_[i]->is_ready(wait_set)) {
-        waitable_handles_[i].reset();
+    for (size_t i = 0; i < groups_.size(); ++i) {
+      if (groups_[i]->get_entities_version() != cached_group_versions_[i]) {
+        // Entities were added to or removed from the group since they were collected.
+        clear_handles();
+        has_cached_handles_ = false;
+        return false;
       }
     }
-
-    subscription_handles_.erase(
-      std::remove(subscription_handles_.begin(), subscription_handles_.end(), nullptr),
-      subscription_handles_.end()
-    );
-
-    service_handles_.erase(
-      std::remove(service_handles_.begin(), service_handles_.end(), nullptr),
-      service_handles_.end()
-    );
-
-    client_handles_.erase(
-      std::remove(client_handles_.begin(), client_handles_.end(), nullptr),
-      client_handles_.end()
-    );
-
-    timer_handles_.erase(
-      std::remove(timer_handles_.begin(), timer_handles_.end(), nullptr),
-      timer_handles_.end()
-    );
-
-    waitable_handles_.erase(
-      std::remove(waitable_handles_.begin(), waitable_handles_.end(), nullptr),
-      waitable_handles_.end()
-    );
+    group_versions_.assign(cached_group_versions_.begin(), cached_group_versions_.end());
+    subscriptions_.assign(cached_subscriptions_);
+    services_.assign(cached_services_);
+    clients_.assign(cached_clients_);
+    timers_.assign(cached_timers_);
+    waitables_.assign(cached_waitables_);
+    return true;
   }
 
   bool collect_entities(const WeakCallbackGroupsToNodesMap & weak_groups_to_nodes) override
   {
+    subscription_deadlines_.clear();
     bool has_invalid_weak_groups_or_nodes = false;
     for (const auto & pair : weak_groups_to_nodes) {
       auto group = pair.first.lock();
@@ -163,32 +180,53 @@ public:
       if (!group || !group->can_be_taken_from().load()) {
         continue;
       }
+      // The group is referenced by index along with each handle, so that finding the entity and
+      // the group of a ready handle doesn't have to search all the callback groups.
+      const size_t group_index = groups_.size();
+      groups_.push_back(group);
+      // Read before the entities, a change during the collection is then seen when restoring.
+      group_versions_.push_back(group->get_entities_version());
       group->find_subscription_ptrs_if(
-        [this](const rclcpp::SubscriptionBase::SharedPtr & subscription) {
-          subscription_handles_.push_back(subscription->get_subscription_handle());
+        [this, group_index](const rclcpp::SubscriptionBase::SharedPtr & subscription) {
+          add_handle(
+            subscriptions_, subscription->get_subscription_handle(), subscription, group_index);
           return false;
         });
       group->find_service_ptrs_if(
-        [this](const rclcpp::ServiceBase::SharedPtr & service) {
-          service_handles_.push_back(service->get_service_handle());
+        [this, group_index](const rclcpp::ServiceBase::SharedPtr & service) {
+          add_handle(services_, service->get_service_handle(), service, group_index);
           return false;
         });
       group->find_client_ptrs_if(
-        [this](const rclcpp::ClientBase::SharedPtr & client) {
-          client_handles_.push_back(client->get_client_handle());
+        [this, group_index](const rclcpp::ClientBase::SharedPtr & client) {
+          add_handle(clients_, client->get_client_handle(), client, group_index);
           return false;
         });
       group->find_timer_ptrs_if(
-        [this](const rclcpp::TimerBase::SharedPtr & timer) {
-          timer_handles_.push_back(timer->get_timer_handle());
+        [this, group_index](const rclcpp::TimerBase::SharedPtr & timer) {
+          add_handle(timers_, timer->get_timer_handle(), timer, group_index);
           return false;
         });
       group->find_waitable_ptrs_if(
-        [this](const rclcpp::Waitable::SharedPtr & waitable) {
-          waitable_handles_.push_back(waitable);
+        [this, group_index](const rclcpp::Waitable::SharedPtr & waitable) {
+          add_handle(waitables_, waitable, waitable, group_index);
           return false;
         });
     }
+    if (last_taken_.size() > handle_owners_.size()) {
+      // Forget when the entities which are gone were taken.
+      std::unordered_set<const void *> handles;
+      for (const auto & handle_owner : handle_owners_) {
+        handles.insert(handle_owner.get());
+      }
+      for (auto it = last_taken_.begin(); it != last_taken_.end(); ) {
+        if (handles.count(it->first)) {
+          ++it;
+        } else {
+          it = last_taken_.erase(it);
+        }
+      }
+    }
 
     return has_invalid_weak_groups_or_nodes;
   }
@@ -198,13 +236,14 @@ public:
     if (nullptr == waitable) {
       throw std::runtime_error("waitable object unexpectedly nullptr");
     }
-    waitable_handles_.push_back(waitable);
+    // Its callback group is searched for when it is ready.
+    add_handle(waitables_, waitable, waitable, no_group_index);
   }
 
   bool add_handles_to_wait_set(rcl_wait_set_t * wait_set) override
   {
-    for (auto subscription : subscription_handles_) {
-      if (rcl_wait_set_add_subscription(wait_set, subscription.get(), NULL) != RCL_RET_OK) {
+    for (const rcl_subscription_t * subscription : subscriptions_.handles) {
+      if (rcl_wait_set_add_subscription(wait_set, subscription, NULL) != RCL_RET_OK) {
         RCUTILS_LOG_ERROR_NAMED(
           "rclcpp",
           "Couldn't add subscription to wait set: %s", rcl_get_error_string().str);
@@ -212,8 +251,8 @@ public:
       }
     }
 
-    for (auto client : client_handles_) {
-      if (rcl_wait_set_add_client(wait_set, client.get(), NULL) != RCL_RET_OK) {
+    for (const rcl_client_t * client : clients_.handles) {
+      if (rcl_wait_set_add_client(wait_set, client, NULL) != RCL_RET_OK) {
         RCUTILS_LOG_ERROR_NAMED(
           "rclcpp",
           "Couldn't add client to wait set: %s", rcl_get_error_string().str);
@@ -221,8 +260,8 @@ public:
       }
     }
 
-    for (auto service : service_handles_) {
-      if (rcl_wait_set_add_service(wait_set, service.get(), NULL) != RCL_RET_OK) {
+    for (const rcl_service_t * service : services_.handles) {
+      if (rcl_wait_set_add_service(wait_set, service, NULL) != RCL_RET_OK) {
         RCUTILS_LOG_ERROR_NAMED(
           "rclcpp",
           "Couldn't add service to wait set: %s", rcl_get_error_string().str);
@@ -230,8 +269,8 @@ public:
       }
     }
 
-    for (auto timer : timer_handles_) {
-      if (rcl_wait_set_add_timer(wait_set, timer.get(), NULL) != RCL_RET_OK) {
+    for (const rcl_timer_t * timer : timers_.handles) {
+      if (rcl_wait_set_add_timer(wait_set, timer, NULL) != RCL_RET_OK) {
         RCUTILS_LOG_ERROR_NAMED(
           "rclcpp",
           "Couldn't add timer to wait set: %s", rcl_get_error_string().str);
@@ -249,7 +288,7 @@ public:
       }
     }
 
-    for (auto waitable : waitable_handles_) {
+    for (rclcpp::Waitable * waitable : waitables_.handles) {
       if (!waitable->add_to_wait_set(wait_set)) {
         RCUTILS_LOG_ERROR_NAMED(
           "rclcpp",
@@ -265,34 +304,12 @@ public:
     rclcpp::AnyExecutable & any_exec,
     const WeakCallbackGroupsToNodesMap & weak_groups_to_nodes) override
   {
-    auto it = subscription_handles_.begin();
-    while (it != subscription_handles_.end()) {
-      auto subscription = get_subscription_by_handle(*it, weak_groups_to_nodes);
-      if (subscription) {
-        // Find the group for this handle and see if it can be serviced
-        auto group = get_group_by_subscription(subscription, weak_groups_to_nodes);
-        if (!group) {
-          // Group was not found, meaning the subscription is not valid...
-          // Remove it from the ready list and continue looking
-          it = subscription_handles_.erase(it);
-          continue;
-        }
-        if (!group->can_be_taken_from().load()) {
-          // Group is mutually exclusive and is being used, so skip it for now
-          // Leave it to be checked next time, but continue searching
-          ++it;
-          continue;
-        }
-        // Otherwise it is safe to set and return the any_exec
+    take_next_ready(
+      subscriptions_, any_exec, weak_groups_to_nodes,
+      [&any_exec](const rclcpp::SubscriptionBase::SharedPtr & subscription) {
         any_exec.subscription = subscription;
-        any_exec.callback_group = group;
-        any_exec.node_base = get_node_by_group(group, weak_groups_to_nodes);
-        subscription_handles_.erase(it);
-        return;
-      }
-      // Else, the subscription is no longer valid, remove it and continue
-      it = subscription_handles_.erase(it);
-    }
+        return true;
+      });
   }
 
   void
@@ -300,34 +317,12 @@ public:
     rclcpp::AnyExecutable & any_exec,
     const WeakCallbackGroupsToNodesMap & weak_groups_to_nodes) override
   {
-    auto it = service_handles_.begin();
-    while (it != service_handles_.end()) {
-      auto service = get_service_by_handle(*it, weak_groups_to_nodes);
-      if (service) {
-        // Find the group for this handle and see if it can be serviced
-        auto group = get_group_by_service(service, weak_groups_to_nodes);
-        if (!group) {
-          // Group was not found, meaning the service is not valid...
-          // Remove it from the ready list and continue looking
-          it = service_handles_.erase(it);
-          continue;
-        }
-        if (!group->can_be_taken_from().load()) {
-          // Group is mutually exclusive and is being used, so skip it for now
-          // Leave it to be checked next time, but continue searching
-          ++it;
-          continue;
-        }
-        // Otherwise it is safe to set and return the any_exec
+    take_next_ready(
+      services_, any_exec, weak_groups_to_nodes,
+      [&any_exec](const rclcpp::ServiceBase::SharedPtr & service) {
         any_exec.service = service;
-        any_exec.callback_group = group;
-        any_exec.node_base = get_node_by_group(group, weak_groups_to_nodes);
-        service_handles_.erase(it);
-        return;
-      }
-      // Else, the service is no longer valid, remove it and continue
-      it = service_handles_.erase(it);
-    }
+        return true;
+      });
   }
 
   void
@@ -335,34 +330,12 @@ public:
     rclcpp::AnyExecutable & any_exec,
     const WeakCallbackGroupsToNodesMap & weak_groups_to_nodes) override
   {
-    auto it = client_handles_.begin();
-    while (it != client_handles_.end()) {
-      auto client = get_client_by_handle(*it, weak_groups_to_nodes);
-      if (client) {
-        // Find the group for this handle and see if it can be serviced
-        auto group = get_group_by_client(client, weak_groups_to_nodes);
-        if (!group) {
-          // Group was not found, meaning the service is not valid...
-          // Remove it from the ready list and continue looking
-          it = client_handles_.erase(it);
-          continue;
-        }
-        if (!group->can_be_taken_from().load()) {
-          // Group is mutually exclusive and is being used, so skip it for now
-          // Leave it to be checked next time, but continue searching
-          ++it;
-          continue;
-        }
-        // Otherwise it is safe to set and return the any_exec
+    take_next_ready(
+      clients_, any_exec, weak_groups_to_nodes,
+      [&any_exec](const rclcpp::ClientBase::SharedPtr & client) {
         any_exec.client = client;
-        any_exec.callback_group = group;
-        any_exec.node_base = get_node_by_group(group, weak_groups_to_nodes);
-        client_handles_.erase(it);
-        return;
-      }
-      // Else, the service is no longer valid, remove it and continue
-      it = client_handles_.erase(it);
-    }
+        return true;
+      });
   }
 
   void
@@ -370,39 +343,16 @@ public:
     rclcpp::AnyExecutable & any_exec,
     const WeakCallbackGroupsToNodesMap & weak_groups_to_nodes) override
   {
-    auto it = timer_handles_.begin();
-    while (it != timer_handles_.end()) {
-      auto timer = get_timer_by_handle(*it, weak_groups_to_nodes);
-      if (timer) {
-        // Find the group for this handle and see if it can be serviced
-        auto group = get_group_by_timer(timer, weak_groups_to_nodes);
-        if (!group) {
-          // Group was not found, meaning the timer is not valid...
-          // Remove it from the ready list and continue looking
-          it = timer_handles_.erase(it);
-          continue;
-        }
-        if (!group->can_be_taken_from().load()) {
-          // Group is mutually exclusive and is being used, so skip it for now
-          // Leave it to be checked next time, but continue searching
-          ++it;
-          continue;
-        }
+    take_next_ready(
+      timers_, any_exec, weak_groups_to_nodes,
+      [&any_exec](const rclcpp::TimerBase::SharedPtr & timer) {
         if (!timer->call()) {
           // timer was cancelled, skip it.
-          ++it;
-          continue;
+          return false;
         }
-        // Otherwise it is safe to set and return the any_exec
         any_exec.timer = timer;
-        any_exec.callback_group = group;
-        any_exec.node_base = get_node_by_group(group, weak_groups_to_nodes);
-        timer_handles_.erase(it);
-        return;
-      }
-      // Else, the timer is no longer valid, remove it and continue
-      it = timer_handles_.erase(it);
-    }
+        return true;
+      });
   }
 
   void
@@ -410,34 +360,36 @@ public:
     rclcpp::AnyExecutable & any_exec,
     const WeakCallbackGroupsToNodesMap & weak_groups_to_nodes) override
   {
-    auto it = waitable_handles_.begin();
-    while (it != waitable_handles_.end()) {
-      auto waitable = *it;
-      if (waitable) {
-        // Find the group for this handle and see if it can be serviced
-        auto group = get_group_by_waitable(waitable, weak_groups_to_nodes);
-        if (!group) {
-          // Group was not found, meaning the waitable is not valid...
-          // Remove it from the ready list and continue looking
-          it = waitable_handles_.erase(it);
-          continue;
-        }
-        if (!group->can_be_taken_from().load()) {
-          // Group is mutually exclusive and is being used, so skip it for now
-          // Leave it to be checked next time, but continue searching
-          ++it;
-          continue;
-        }
-        // Otherwise it is safe to set and return the any_exec
+    take_next_ready(
+      waitables_, any_exec, weak_groups_to_nodes,
+      [&any_exec](const rclcpp::Waitable::SharedPtr & waitable) {
         any_exec.waitable = waitable;
-        any_exec.callback_group = group;
-        any_exec.node_base = get_node_by_group(group, weak_groups_to_nodes);
-        waitable_handles_.erase(it);
-        return;
-      }
-      // Else, the waitable is no longer valid, remove it and continue
-      it = waitable_handles_.erase(it);
-    }
+        return true;
+      });
+  }
+
+  void
+  get_next_executable_by_priority(
+    rclcpp::AnyExecutable & any_exec,
+    const WeakCallbackGroupsToNodesMap & weak_groups_to_nodes) override
+  {
+    get_next_executable_by_key(any_exec, weak_groups_to_nodes, Ordering::Priority);
+  }
+
+  void
+  get_next_executable_by_deadline(
+    rclcpp::AnyExecutable & any_exec,
+    const WeakCallbackGroupsToNodesMap & weak_groups_to_nodes) override
+  {
+    get_next_executable_by_key(any_exec, weak_groups_to_nodes, Ordering::Deadline);
+  }
+
+  void
+  get_next_executable_round_robin(
+    rclcpp::AnyExecutable & any_exec,
+    const WeakCallbackGroupsToNodesMap & weak_groups_to_nodes) override
+  {
+    get_next_executable_by_key(any_exec, weak_groups_to_nodes, Ordering::LeastRecentlyTaken);
   }
 
   rcl_allocator_t get_allocator() override
@@ -445,10 +397,26 @@ public:
     return rclcpp::allocator::get_rcl_allocator<void *, VoidAlloc>(*allocator_.get());
   }
 
+  size_t get_memory_size() const override
+  {
+    return get_capacity_size(guard_conditions_) +
+           get_capacity_size(subscriptions_) + get_capacity_size(services_) +
+           get_capacity_size(clients_) + get_capacity_size(timers_) +
+           get_capacity_size(waitables_) + get_capacity_size(groups_) +
+           get_capacity_size(group_versions_) + get_capacity_size(cached_group_versions_) +
+           get_capacity_size(handle_owners_) + get_capacity_size(cached_handle_owners_) +
+           get_capacity_size(cached_groups_) + get_capacity_size(cached_subscriptions_) +
+           get_capacity_size(cached_services_) + get_capacity_size(cached_clients_) +
+           get_capacity_size(cached_timers_) + get_capacity_size(cached_waitables_) +
+           subscription_deadlines_.size() *
+           (sizeof(const rcl_subscription_t *) + sizeof(std::chrono::nanoseconds)) +
+           last_taken_.size() * (sizeof(const void *) + sizeof(uint64_t));
+  }
+
   size_t number_of_ready_subscriptions() const override
   {
-    size_t number_of_subscriptions = subscription_handles_.size();
-    for (auto waitable : waitable_handles_) {
+    size_t number_of_subscriptions = subscriptions_.size();
+    for (const rclcpp::Waitable * waitable : waitables_.handles) {
       number_of_subscriptions += waitable->get_number_of_ready_subscriptions();
     }
     return number_of_subscriptions;
@@ -456,8 +424,8 @@ public:
 
   size_t number_of_ready_services() const override
   {
-    size_t number_of_services = service_handles_.size();
-    for (auto waitable : waitable_handles_) {
+    size_t number_of_services = services_.size();
+    for (const rclcpp::Waitable * waitable : waitables_.handles) {
       number_of_services += waitable->get_number_of_ready_services();
     }
     return number_of_services;
@@ -466,7 +434,7 @@ public:
   size_t number_of_ready_events() const override
   {
     size_t number_of_events = 0;
-    for (auto waitable : waitable_handles_) {
+    for (const rclcpp::Waitable * waitable : waitables_.handles) {
       number_of_events += waitable->get_number_of_ready_events();
     }
     return number_of_events;
@@ -474,8 +442,8 @@ public:
 
   size_t number_of_ready_clients() const override
   {
-    size_t number_of_clients = client_handles_.size();
-    for (auto waitable : waitable_handles_) {
+    size_t number_of_clients = clients_.size();
+    for (const rclcpp::Waitable * waitable : waitables_.handles) {
       number_of_clients += waitable->get_number_of_ready_clients();
     }
     return number_of_clients;
@@ -484,7 +452,7 @@ public:
   size_t number_of_guard_conditions() const override
   {
     size_t number_of_guard_conditions = guard_conditions_.size();
-    for (auto waitable : waitable_handles_) {
+    for (const rclcpp::Waitable * waitable : waitables_.handles) {
       number_of_guard_conditions += waitable->get_number_of_ready_guard_conditions();
     }
     return number_of_guard_conditions;
@@ -492,8 +460,8 @@ public:
 
   size_t number_of_ready_timers() const override
   {
-    size_t number_of_timers = timer_handles_.size();
-    for (auto waitable : waitable_handles_) {
+    size_t number_of_timers = timers_.size();
+    for (const rclcpp::Waitable * waitable : waitables_.handles) {
       number_of_timers += waitable->get_number_of_ready_timers();
     }
     return number_of_timers;
@@ -501,7 +469,7 @@ public:
 
   size_t number_of_waitables() const override
   {
-    return waitable_handles_.size();
+    return waitables_.size();
   }
 
 private:
@@ -509,13 +477,533 @@ private:
   using VectorRebind =
     std::vector<T, typename std::allocator_traits<Alloc>::template rebind_alloc<T>>;
 
+  /// Index of the callback group of the waitables added with add_waitable_handle().
+  static constexpr size_t no_group_index = static_cast<size_t>(-1);
+
+  /// Handles of one kind of entity, in parallel with their entity and the index of their group.
+  /**
+   * The handles are plain pointers, kept alive by the handle owners of the strategy, so that
+   * adding them to the wait set and checking which ones are ready does not touch any reference
+   * count. The entities are only locked once ready and about to be executed.
+   */
+  template<typename HandleT, typename EntityT>
+  struct HandleArrays
+  {
+    VectorRebind<HandleT *> handles;
+    VectorRebind<std::weak_ptr<EntityT>> entities;
+    VectorRebind<size_t> group_indices;
+
+    size_t
+    size() const
+    {
+      return handles.size();
+    }
+
+    void
+    clear()
+    {
+      handles.clear();
+      entities.clear();
+      group_indices.clear();
+    }
+
+    void
+    assign(const HandleArrays & other)
+    {
+      handles.assign(other.handles.begin(), other.handles.end());
+      entities.assign(other.entities.begin(), other.entities.end());
+      group_indices.assign(other.group_indices.begin(), other.group_indices.end());
+    }
+
+    void
+    erase(size_t index)
+    {
+      handles.erase(handles.begin() + index);
+      entities.erase(entities.begin() + index);
+      group_indices.erase(group_indices.begin() + index);
+    }
+
+    /// Keep the handles for which is_ready(index, handle) is true, in order.
+    template<typename IsReadyT>
+    void
+    remove_unready(IsReadyT && is_ready)
+    {
+      size_t ready_count = 0;
+      for (size_t i = 0; i < handles.size(); ++i) {
+        if (!is_ready(i, handles[i])) {
+          continue;
+        }
+        if (ready_count != i) {
+          handles[ready_count] = handles[i];
+          entities[ready_count] = std::move(entities[i]);
+          group_indices[ready_count] = group_indices[i];
+        }
+        ++ready_count;
+      }
+      handles.resize(ready_count);
+      entities.resize(ready_count);
+      group_indices.resize(ready_count);
+    }
+  };
+
+  template<typename T>
+  static size_t
+  get_capacity_size(const VectorRebind<T> & vector)
+  {
+    return vector.capacity() * sizeof(T);
+  }
+
+  template<typename HandleT, typename EntityT>
+  static size_t
+  get_capacity_size(const HandleArrays<HandleT, EntityT> & arrays)
+  {
+    return get_capacity_size(arrays.handles) + get_capacity_size(arrays.entities) +
+           get_capacity_size(arrays.group_indices);
+  }
+
+  template<typename HandleT, typename EntityT, typename OwnerT>
+  void
+  add_handle(
+    HandleArrays<HandleT, EntityT> & arrays,
+    std::shared_ptr<OwnerT> handle,
+    const std::shared_ptr<EntityT> & entity,
+    size_t group_index)
+  {
+    arrays.handles.push_back(handle.get());
+    arrays.entities.push_back(entity);
+    arrays.group_indices.push_back(group_index);
+    handle_owners_.push_back(std::move(handle));
+  }
+
+  template<typename T>
+  static bool
+  lock_all(
+    const VectorRebind<std::weak_ptr<T>> & weak_pointers,
+    VectorRebind<std::shared_ptr<T>> & pointers)
+  {
+    for (const auto & weak_pointer : weak_pointers) {
+      auto pointer = weak_pointer.lock();
+      if (!pointer) {
+        return false;
+      }
+      pointers.push_back(std::move(pointer));
+    }
+    return true;
+  }
+
+  // Entities which were not collected, such as the waitables added with add_waitable_handle(),
+  // are searched for in all the callback groups.
+
+  static rclcpp::CallbackGroup::SharedPtr
+  search_group(
+    const rclcpp::SubscriptionBase::SharedPtr & subscription,
+    const WeakCallbackGroupsToNodesMap & weak_groups_to_nodes)
+  {
+    return get_group_by_subscription(subscription, weak_groups_to_nodes);
+  }
+
+  static rclcpp::CallbackGroup::SharedPtr
+  search_group(
+    const rclcpp::ServiceBase::SharedPtr & service,
+    const WeakCallbackGroupsToNodesMap & weak_groups_to_nodes)
+  {
+    return get_group_by_service(service, weak_groups_to_nodes);
+  }
+
+  static rclcpp::CallbackGroup::SharedPtr
+  search_group(
+    const rclcpp::ClientBase::SharedPtr & client,
+    const WeakCallbackGroupsToNodesMap & weak_groups_to_nodes)
+  {
+    return get_group_by_client(client, weak_groups_to_nodes);
+  }
+
+  static rclcpp::CallbackGroup::SharedPtr
+  search_group(
+    const rclcpp::TimerBase::SharedPtr & timer,
+    const WeakCallbackGroupsToNodesMap & weak_groups_to_nodes)
+  {
+    return get_group_by_timer(timer, weak_groups_to_nodes);
+  }
+
+  static rclcpp::CallbackGroup::SharedPtr
+  search_group(
+    const rclcpp::Waitable::SharedPtr & waitable,
+    const WeakCallbackGroupsToNodesMap & weak_groups_to_nodes)
+  {
+    return get_group_by_waitable(waitable, weak_groups_to_nodes);
+  }
+
+  /// Return the callback group of an entity and set its node, if both are still valid.
+  /**
+   * \param[in] group_index index of the group in the ones of the collection, or no_group_index.
+   * \param[in] entity the locked entity, whose group is searched for without an index.
+   * \param[in] weak_groups_to_nodes the group must still be in there with a valid node.
+   * \param[out] node the node of the group.
+   * \return the group, null if the group or the node is no longer valid.
+   */
+  template<typename EntityT>
+  rclcpp::CallbackGroup::SharedPtr
+  get_valid_group(
+    size_t group_index,
+    const std::shared_ptr<EntityT> & entity,
+    const WeakCallbackGroupsToNodesMap & weak_groups_to_nodes,
+    rclcpp::node_interfaces::NodeBaseInterface::SharedPtr & node) const
+  {
+    rclcpp::CallbackGroup::SharedPtr group = group_index == no_group_index ?
+      search_group(entity, weak_groups_to_nodes) : groups_[group_index];
+    if (!group) {
+      return nullptr;
+    }
+    auto it = weak_groups_to_nodes.find(rclcpp::CallbackGroup::WeakPtr(group));
+    if (it == weak_groups_to_nodes.end()) {
+      return nullptr;
+    }
+    node = it->second.lock();
+    return node ? group : nullptr;
+  }
+
+  /// Return false if the group of a handle is known to be busy.
+  bool
+  may_be_taken_from(size_t group_index) const
+  {
+    return group_index == no_group_index || groups_[group_index]->can_be_taken_from().load();
+  }
+
+  /// Take the first ready handle whose entity can be executed.
+  /**
+   * The handles whose entity or group is no longer valid are removed along the way.
+   * \param[in] take sets the entity in the any_exec, or returns false to skip it.
+   */
+  template<typename HandleT, typename EntityT, typename TakeT>
+  void
+  take_next_ready(
+    HandleArrays<HandleT, EntityT> & ready,
+    rclcpp::AnyExecutable & any_exec,
+    const WeakCallbackGroupsToNodesMap & weak_groups_to_nodes,
+    TakeT && take)
+  {
+    size_t i = 0;
+    while (i < ready.size()) {
+      if (!may_be_taken_from(ready.group_indices[i])) {
+        // Group is mutually exclusive and is being used, so skip it for now
+        // Leave it to be checked next time, but continue searching
+        ++i;
+        continue;
+      }
+      auto entity = ready.entities[i].lock();
+      rclcpp::node_interfaces::NodeBaseInterface::SharedPtr node;
+      auto group = entity ?
+        get_valid_group(ready.group_indices[i], entity, weak_groups_to_nodes, node) : nullptr;
+      if (!group) {
+        // The entity or its group is no longer valid...
+        // Remove it from the ready list and continue looking
+        ready.erase(i);
+        continue;
+      }
+      if (!group->can_be_taken_from().load() || !take(entity)) {
+        ++i;
+        continue;
+      }
+      // Otherwise it is safe to set and return the any_exec
+      any_exec.callback_group = group;
+      any_exec.node_base = node;
+      ready.erase(i);
+      return;
+    }
+  }
+
+  /// Take the ready handle at index if its entity and group are still valid.
+  /**
+   * \param[in] take sets the entity in the any_exec, or returns false to skip it.
+   * \return false if the entity or its group is no longer valid, the handle being removed.
+   */
+  template<typename HandleT, typename EntityT, typename TakeT>
+  bool
+  take_at(
+    HandleArrays<HandleT, EntityT> & ready,
+    size_t index,
+    rclcpp::AnyExecutable & any_exec,
+    const WeakCallbackGroupsToNodesMap & weak_groups_to_nodes,
+    TakeT && take)
+  {
+    auto entity = ready.entities[index].lock();
+    rclcpp::node_interfaces::NodeBaseInterface::SharedPtr node;
+    auto group =
+      entity ? get_valid_group(ready.group_indices[index], entity, weak_groups_to_nodes, node) :
+      nullptr;
+    if (!group) {
+      ready.erase(index);
+      return false;
+    }
+    if (take(entity)) {
+      any_exec.callback_group = group;
+      any_exec.node_base = node;
+      ready.erase(index);
+    }
+    return true;
+  }
+
+  /// How the ready entities of the groups with the same priority are ordered.
+  enum class Ordering
+  {
+    Priority,
+    Deadline,
+    LeastRecentlyTaken,
+  };
+
+  enum class EntityKind
+  {
+    Timer,
+    Subscription,
+    Service,
+    Client,
+    Waitable,
+  };
+
+  /// Take the ready entity of the available group with the highest priority.
+  /**
+   * Between groups of the same priority, the entity with the earliest deadline or the one taken
+   * the least recently is taken depending on the ordering, see
+   * MemoryStrategy::get_next_executable_by_deadline() and
+   * MemoryStrategy::get_next_executable_round_robin().
+   * The strict comparisons keep the first entity found, in the order of the get_next_*
+   * functions, when both the priorities and the keys are equal.
+   *
+   * The candidates are compared with their handle and group only: the entity of the best one is
+   * then locked, and the search starts over without it if it is no longer valid.
+   */
+  void
+  get_next_executable_by_key(
+    rclcpp::AnyExecutable & any_exec,
+    const WeakCallbackGroupsToNodesMap & weak_groups_to_nodes,
+    Ordering ordering)
+  {
+    constexpr auto no_deadline = std::chrono::nanoseconds::max();
+    auto get_no_deadline = []() {return no_deadline;};
+    const bool use_deadlines = Ordering::Deadline == ordering;
+    const bool use_last_taken = Ordering::LeastRecentlyTaken == ordering;
+    bool taken_or_skipped = false;
+    while (!taken_or_skipped) {
+      const rclcpp::CallbackGroup * best_group = nullptr;
+      // Keeps alive the best group when it was searched for rather than collected.
+      rclcpp::CallbackGroup::SharedPtr best_searched_group;
+      EntityKind best_kind = EntityKind::Timer;
+      size_t best_index = 0;
+      const void * best_handle = nullptr;
+      int64_t best_key = 0;
+      auto consider =
+        [&](
+        EntityKind kind, size_t index, const void * handle, const rclcpp::CallbackGroup * group,
+        const auto & get_deadline) -> bool {
+          if (!group->can_be_taken_from().load()) {
+            return false;
+          }
+          if (best_group && group->priority() < best_group->priority()) {
+            return false;
+          }
+          int64_t key = no_deadline.count();
+          if (use_deadlines) {
+            key = get_deadline().count();
+          } else if (use_last_taken) {
+            key = static_cast<int64_t>(get_last_taken(handle));
+          }
+          if (best_group && group->priority() == best_group->priority() && key >= best_key) {
+            return false;
+          }
+          best_group = group;
+          best_kind = kind;
+          best_index = index;
+          best_handle = handle;
+          best_key = key;
+          best_searched_group.reset();
+          return true;
+        };
+
+      for (size_t i = 0; i < timers_.size(); ++i) {
+        const rcl_timer_t * handle = timers_.handles[i];
+        if (!is_timer_canceled(handle)) {
+          consider(
+            EntityKind::Timer, i, handle, groups_[timers_.group_indices[i]].get(),
+            [handle]() {return get_timer_deadline(handle);});
+        }
+      }
+      for (size_t i = 0; i < subscriptions_.size(); ++i) {
+        consider(
+          EntityKind::Subscription, i, subscriptions_.handles[i],
+          groups_[subscriptions_.group_indices[i]].get(),
+          [this, i]() {return get_subscription_deadline(i);});
+      }
+      for (size_t i = 0; i < services_.size(); ++i) {
+        consider(
+          EntityKind::Service, i, services_.handles[i], groups_[services_.group_indices[i]].get(),
+          get_no_deadline);
+      }
+      for (size_t i = 0; i < clients_.size(); ++i) {
+        consider(
+          EntityKind::Client, i, clients_.handles[i], groups_[clients_.group_indices[i]].get(),
+          get_no_deadline);
+      }
+      for (size_t i = 0; i < waitables_.size(); ++i) {
+        const void * handle = waitables_.handles[i];
+        const size_t group_index = waitables_.group_indices[i];
+        if (group_index != no_group_index) {
+          consider(EntityKind::Waitable, i, handle, groups_[group_index].get(), get_no_deadline);
+          continue;
+        }
+        auto waitable = waitables_.entities[i].lock();
+        rclcpp::node_interfaces::NodeBaseInterface::SharedPtr node;
+        auto group =
+          waitable ? get_valid_group(no_group_index, waitable, weak_groups_to_nodes, node) :
+          nullptr;
+        if (group && consider(EntityKind::Waitable, i, handle, group.get(), get_no_deadline)) {
+          best_searched_group = std::move(group);
+        }
+      }
+
+      if (!best_group) {
+        return;
+      }
+      switch (best_kind) {
+        case EntityKind::Timer:
+          taken_or_skipped = take_at(
+            timers_, best_index, any_exec, weak_groups_to_nodes,
+            [&any_exec](const rclcpp::TimerBase::SharedPtr & timer) {
+              if (!timer->call()) {
+                // timer was cancelled in the meantime, skip it.
+                return false;
+              }
+              any_exec.timer = timer;
+              return true;
+            });
+          break;
+        case EntityKind::Subscription:
+          taken_or_skipped = take_at(
+            subscriptions_, best_index, any_exec, weak_groups_to_nodes,
+            [&any_exec](const rclcpp::SubscriptionBase::SharedPtr & subscription) {
+              any_exec.subscription = subscription;
+              return true;
+            });
+          break;
+        case EntityKind::Service:
+          taken_or_skipped = take_at(
+            services_, best_index, any_exec, weak_groups_to_nodes,
+            [&any_exec](const rclcpp::ServiceBase::SharedPtr & service) {
+              any_exec.service = service;
+              return true;
+            });
+          break;
+        case EntityKind::Client:
+          taken_or_skipped = take_at(
+            clients_, best_index, any_exec, weak_groups_to_nodes,
+            [&any_exec](const rclcpp::ClientBase::SharedPtr & client) {
+              any_exec.client = client;
+              return true;
+            });
+          break;
+        case EntityKind::Waitable:
+          taken_or_skipped = take_at(
+            waitables_, best_index, any_exec, weak_groups_to_nodes,
+            [&any_exec](const rclcpp::Waitable::SharedPtr & waitable) {
+              any_exec.waitable = waitable;
+              return true;
+            });
+          break;
+      }
+      if (use_last_taken && any_exec.callback_group) {
+        last_taken_[best_handle] = ++take_count_;
+      }
+    }
+  }
+
+  /// Return when the entity of a handle was last taken, 0 if it never was.
+  uint64_t
+  get_last_taken(const void * handle) const
+  {
+    auto it = last_taken_.find(handle);
+    return it == last_taken_.end() ? 0u : it->second;
+  }
+
+  static bool
+  is_timer_canceled(const rcl_timer_t * handle)
+  {
+    bool is_canceled = false;
+    rcl_ret_t ret = rcl_timer_is_canceled(handle, &is_canceled);
+    if (ret != RCL_RET_OK) {
+      rclcpp::exceptions::throw_from_rcl_error(ret, "Couldn't get timer cancelled state");
+    }
+    return is_canceled;
+  }
+
+  /// Return how long until a timer misses its deadline, the end of its current period.
+  static std::chrono::nanoseconds
+  get_timer_deadline(const rcl_timer_t * handle)
+  {
+    int64_t time_until_next_call = 0;
+    rcl_ret_t ret = rcl_timer_get_time_until_next_call(handle, &time_until_next_call);
+    if (ret != RCL_RET_OK) {
+      rclcpp::exceptions::throw_from_rcl_error(ret, "Timer could not get time until next call");
+    }
+    int64_t period = 0;
+    if (RCL_RET_OK != rcl_timer_get_period(handle, &period)) {
+      rcl_reset_error();
+      period = 0;
+    }
+    return std::chrono::nanoseconds(time_until_next_call + period);
+  }
+
+  /// Return how long until a ready subscription misses its QoS deadline, if it has one.
+  std::chrono::nanoseconds
+  get_subscription_deadline(size_t index)
+  {
+    // The QoS of a subscription does not change, only query the middleware once per collection.
+    const rcl_subscription_t * handle = subscriptions_.handles[index];
+    auto it = subscription_deadlines_.find(handle);
+    if (it == subscription_deadlines_.end()) {
+      auto subscription = subscriptions_.entities[index].lock();
+      if (!subscription) {
+        return std::chrono::nanoseconds::max();
+      }
+      const int64_t deadline = subscription->get_actual_qos().deadline().nanoseconds();
+      // A deadline of 0 is the default and means that the subscription has none.
+      const auto relative_deadline =
+        deadline > 0 ? std::chrono::nanoseconds(deadline) : std::chrono::nanoseconds::max();
+      it = subscription_deadlines_.emplace(handle, relative_deadline).first;
+    }
+    return it->second;
+  }
+
   VectorRebind<const rcl_guard_condition_t *> guard_conditions_;
 
-  VectorRebind<std::shared_ptr<const rcl_subscription_t>> subscription_handles_;
-  VectorRebind<std::shared_ptr<const rcl_service_t>> service_handles_;
-  VectorRebind<std::shared_ptr<const rcl_client_t>> client_handles_;
-  VectorRebind<std::shared_ptr<const rcl_timer_t>> timer_handles_;
-  VectorRebind<std::shared_ptr<Waitable>> waitable_handles_;
+  HandleArrays<const rcl_subscription_t, rclcpp::SubscriptionBase> subscriptions_;
+  HandleArrays<const rcl_service_t, rclcpp::ServiceBase> services_;
+  HandleArrays<const rcl_client_t, rclcpp::ClientBase> clients_;
+  HandleArrays<const rcl_timer_t, rclcpp::TimerBase> timers_;
+  HandleArrays<rclcpp::Waitable, rclcpp::Waitable> waitables_;
+  // Callback groups of the last collection, kept alive to check them through the handles.
+  VectorRebind<rclcpp::CallbackGroup::SharedPtr> groups_;
+  // Versions of the entities of the groups when they were collected.
+  VectorRebind<uint64_t> group_versions_;
+  // Keep the handles alive while they are waited on, whatever happens to their entity.
+  VectorRebind<std::shared_ptr<const void>> handle_owners_;
+
+  // Copies of the last full collection, whose weak owners do not keep destroyed entities alive.
+  VectorRebind<std::weak_ptr<const void>> cached_handle_owners_;
+  VectorRebind<rclcpp::CallbackGroup::WeakPtr> cached_groups_;
+  VectorRebind<uint64_t> cached_group_versions_;
+  HandleArrays<const rcl_subscription_t, rclcpp::SubscriptionBase> cached_subscriptions_;
+  HandleArrays<const rcl_service_t, rclcpp::ServiceBase> cached_services_;
+  HandleArrays<const rcl_client_t, rclcpp::ClientBase> cached_clients_;
+  HandleArrays<const rcl_timer_t, rclcpp::TimerBase> cached_timers_;
+  HandleArrays<rclcpp::Waitable, rclcpp::Waitable> cached_waitables_;
+  bool has_cached_handles_ = false;
+
+  // Relative QoS deadline of the subscriptions, by handle, reset at each collection.
+  std::unordered_map<const rcl_subscription_t *, std::chrono::nanoseconds> subscription_deadlines_;
+  // Number of the last take of the entities taken by get_next_executable_round_robin(),
+  // by handle.
+  std::unordered_map<const void *, uint64_t> last_taken_;
+  uint64_t take_count_ = 0;
 
   std::shared_ptr<VoidAlloc> allocator_;
 };
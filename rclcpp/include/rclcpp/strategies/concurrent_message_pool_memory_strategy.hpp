@@ -0,0 +1,205 @@
+// Copyright 2021 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__STRATEGIES__CONCURRENT_MESSAGE_POOL_MEMORY_STRATEGY_HPP_
+#define RCLCPP__STRATEGIES__CONCURRENT_MESSAGE_POOL_MEMORY_STRATEGY_HPP_
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <memory>
+
+#include "rclcpp/macros.hpp"
+#include "rclcpp/message_memory_strategy.hpp"
+#include "rclcpp/visibility_control.hpp"
+
+namespace rclcpp
+{
+namespace strategies
+{
+namespace concurrent_message_pool_memory_strategy
+{
+
+/// Thread-safe memory allocation strategy reusing a fixed number of preallocated messages.
+/**
+ * Unlike the MessagePoolMemoryStrategy, any free message of the pool can be
+ * borrowed, borrowing and returning a message take constant time without
+ * locking, so that the strategy can be shared by the threads of a
+ * MultiThreadedExecutor, and messages of any type can be pooled.
+ *
+ * The messages are not reset when borrowed: they keep the content of their
+ * previous take, which overwrites it, and above all the capacity of their
+ * sequences and strings.
+ * Messages with sequences of a bounded size, like images, can thus be
+ * pooled without allocating once the sequences are reserved by the
+ * initializer given to the constructor, which is called once for each
+ * message of the pool.
+ *
+ * A message is not borrowed again while it is still referenced, by a
+ * callback keeping it for instance.
+ * When no message of the pool is free, a new message is allocated with the
+ * message allocator, as the default memory strategy does.
+ *
+ * \tparam MessageT type of the messages
+ * \tparam Size number of messages of the pool, at least the largest number of concurrent
+ *   accesses to the subscription (usually the number of threads)
+ */
+template<typename MessageT, size_t Size>
+class ConcurrentMessagePoolMemoryStrategy
+  : public message_memory_strategy::MessageMemoryStrategy<MessageT>
+{
+  static_assert(Size > 0, "the message pool must not be empty");
+  static_assert(
+    Size < std::numeric_limits<uint32_t>::max(), "the message pool has too many messages");
+
+public:
+  RCLCPP_SMART_PTR_DEFINITIONS(ConcurrentMessagePoolMemoryStrategy)
+
+  /// Called once for each message of the pool, to reserve its sequences for instance.
+  using MessageInitializer = std::function<void (MessageT &)>;
+
+  /// Create the messages of the pool.
+  /**
+   * \param[in] initializer called once for each message of the pool, if not empty.
+   */
+  explicit ConcurrentMessagePoolMemoryStrategy(MessageInitializer initializer = nullptr)
+  : storage_(std::make_shared<Storage>())
+  {
+    auto storage = storage_;
+    for (size_t i = 0; i < Size; ++i) {
+      if (initializer) {
+        initializer(storage_->messages[i]);
+      }
+      // The messages keep the storage alive as long as they are referenced.
+      pool_[i] = std::shared_ptr<MessageT>(&storage_->messages[i], [storage](MessageT *) {});
+      retained_[i].store(false, std::memory_order_relaxed);
+      next_free_[i].store(
+        i + 1 < Size ? static_cast<uint32_t>(i + 1) : no_index, std::memory_order_relaxed);
+    }
+    free_head_.store(0, std::memory_order_release);
+  }
+
+  /// Borrow a free message of the message pool, or allocate one if there is none.
+  /** \return Shared pointer to the borrowed message. */
+  std::shared_ptr<MessageT> borrow_message() override
+  {
+    for (uint32_t index = pop_free(); index != no_index; index = pop_free()) {
+      if (is_unreferenced(index)) {
+        return pool_[index];
+      }
+      // Still referenced, only borrow it again once released.
+      retained_[index].store(true, std::memory_order_release);
+    }
+    for (size_t index = 0; index < Size; ++index) {
+      if (
+        retained_[index].load(std::memory_order_acquire) &&
+        is_unreferenced(index) &&
+        retained_[index].exchange(false, std::memory_order_acq_rel))
+      {
+        return pool_[index];
+      }
+    }
+    return message_memory_strategy::MessageMemoryStrategy<MessageT>::borrow_message();
+  }
+
+  /// Return a message to the message pool.
+  /**
+   * The message is borrowed again only once it is no longer referenced.
+   * Messages which were not borrowed from the pool are released.
+   * \param[in] msg Shared pointer to the message to return.
+   */
+  void return_message(std::shared_ptr<MessageT> & msg) override
+  {
+    const MessageT * first = storage_->messages.data();
+    const MessageT * pointer = msg.get();
+    msg.reset();
+    // Compare the addresses as integers, the message may not belong to the storage.
+    const auto address = reinterpret_cast<uintptr_t>(pointer);
+    const auto first_address = reinterpret_cast<uintptr_t>(first);
+    if (address < first_address || address >= first_address + Size * sizeof(MessageT)) {
+      return;
+    }
+    push_free(static_cast<uint32_t>((address - first_address) / sizeof(MessageT)));
+  }
+
+  size_t get_pool_memory_size() const override
+  {
+    return sizeof(Storage);
+  }
+
+protected:
+  struct Storage
+  {
+    std::array<MessageT, Size> messages;
+  };
+
+  static constexpr uint32_t no_index = std::numeric_limits<uint32_t>::max();
+
+  bool
+  is_unreferenced(size_t index) const
+  {
+    if (pool_[index].use_count() != 1) {
+      return false;
+    }
+    // Synchronize with the release of the last other reference, whose writes are then visible.
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return true;
+  }
+
+  // The head of the free list is tagged with a counter against the ABA problem.
+  uint32_t
+  pop_free()
+  {
+    uint64_t head = free_head_.load(std::memory_order_acquire);
+    while (true) {
+      const auto index = static_cast<uint32_t>(head);
+      if (index == no_index) {
+        return no_index;
+      }
+      const uint64_t next = next_free_[index].load(std::memory_order_relaxed);
+      const uint64_t new_head = (((head >> 32) + 1) << 32) | next;
+      if (free_head_.compare_exchange_weak(
+          head, new_head, std::memory_order_acq_rel, std::memory_order_acquire))
+      {
+        return index;
+      }
+    }
+  }
+
+  void
+  push_free(uint32_t index)
+  {
+    uint64_t head = free_head_.load(std::memory_order_relaxed);
+    uint64_t new_head;
+    do {
+      next_free_[index].store(static_cast<uint32_t>(head), std::memory_order_relaxed);
+      new_head = (((head >> 32) + 1) << 32) | index;
+    } while (!free_head_.compare_exchange_weak(
+      head, new_head, std::memory_order_release, std::memory_order_relaxed));
+  }
+
+  std::shared_ptr<Storage> storage_;
+  std::array<std::shared_ptr<MessageT>, Size> pool_;
+  std::array<std::atomic<bool>, Size> retained_;
+  std::array<std::atomic<uint32_t>, Size> next_free_;
+  std::atomic<uint64_t> free_head_;
+};
+
+}  // namespace concurrent_message_pool_memory_strategy
+}  // namespace strategies
+}  // namespace rclcpp
+
+#endif  // RCLCPP__STRATEGIES__CONCURRENT_MESSAGE_POOL_MEMORY_STRATEGY_HPP_
@@ -36,6 +36,7 @@ namespace message_pool_memory_strategy
  * Templating allows the program to determine the memory required for this object at compile time.
  * The size of the message pool should be at least the largest number of concurrent accesses to
  * the subscription (usually the number of threads).
+ * See ConcurrentMessagePoolMemoryStrategy for a thread-safe pool of messages of any type.
  */
 template<
   typename MessageT,
@@ -96,6 +97,11 @@ public:
     throw std::runtime_error("Unrecognized message ptr in return_message.");
   }
 
+  size_t get_pool_memory_size() const override
+  {
+    return Size * sizeof(MessageT);
+  }
+
 protected:
   struct PoolMember
   {
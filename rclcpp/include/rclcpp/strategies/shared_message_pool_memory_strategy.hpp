@@ -0,0 +1,146 @@
+// Copyright 2021 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__STRATEGIES__SHARED_MESSAGE_POOL_MEMORY_STRATEGY_HPP_
+#define RCLCPP__STRATEGIES__SHARED_MESSAGE_POOL_MEMORY_STRATEGY_HPP_
+
+#include <atomic>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+#include "rclcpp/macros.hpp"
+#include "rclcpp/message_memory_strategy.hpp"
+#include "rclcpp/visibility_control.hpp"
+
+namespace rclcpp
+{
+namespace strategies
+{
+namespace shared_message_pool_memory_strategy
+{
+
+/// Thread-safe pool of messages taken from the middleware and shared with the callbacks.
+/**
+ * The messages are allocated once, with the message allocator, when the pool
+ * is created, and the subscription takes the messages from the middleware
+ * directly into them.
+ * The pooled message itself is given to the callbacks taking a message by
+ * constant reference or by shared pointer: it is borrowed again once the
+ * last reference of the callbacks to it is dropped, which takes neither an
+ * allocation nor a lock.
+ * The number of messages of the pool is chosen at runtime: subscriptions
+ * whose SubscriptionOptionsBase::message_pool_size is set use this strategy
+ * instead of the default one.
+ *
+ * Like with the ConcurrentMessagePoolMemoryStrategy, the messages keep the
+ * capacity of their sequences from a take to the next, and when all the
+ * messages are referenced a new one is allocated.
+ *
+ * \tparam MessageT type of the messages
+ * \tparam Alloc allocator of the messages
+ */
+template<typename MessageT, typename Alloc = std::allocator<void>>
+class SharedMessagePoolMemoryStrategy
+  : public message_memory_strategy::MessageMemoryStrategy<MessageT, Alloc>
+{
+  using Base = message_memory_strategy::MessageMemoryStrategy<MessageT, Alloc>;
+
+public:
+  RCLCPP_SMART_PTR_DEFINITIONS(SharedMessagePoolMemoryStrategy)
+
+  /// Allocate the messages of the pool.
+  /**
+   * \param[in] pool_size number of messages of the pool, at least the number of messages
+   *   the callbacks keep plus the number of threads executing the subscription.
+   * \param[in] allocator allocator of the messages.
+   * \throws std::invalid_argument if the pool is empty.
+   */
+  explicit SharedMessagePoolMemoryStrategy(
+    size_t pool_size,
+    std::shared_ptr<Alloc> allocator = std::make_shared<Alloc>())
+  : Base(allocator),
+    pool_(pool_size),
+    claimed_(pool_size),
+    next_index_(0)
+  {
+    if (0 == pool_size) {
+      throw std::invalid_argument("the message pool must not be empty");
+    }
+    for (size_t i = 0; i < pool_size; ++i) {
+      pool_[i] = std::allocate_shared<MessageT>(*this->message_allocator_);
+      claimed_[i].store(false, std::memory_order_relaxed);
+    }
+  }
+
+  /// Borrow a message of the pool no longer referenced, or allocate one if there is none.
+  /** \return Shared pointer to the borrowed message. */
+  std::shared_ptr<MessageT> borrow_message() override
+  {
+    const size_t pool_size = pool_.size();
+    // Start after the message borrowed last, which is the most likely to still be referenced.
+    const size_t first = next_index_.fetch_add(1, std::memory_order_relaxed);
+    for (size_t i = 0; i < pool_size; ++i) {
+      const size_t index = (first + i) % pool_size;
+      if (
+        pool_[index].use_count() != 1 ||
+        claimed_[index].exchange(true, std::memory_order_acquire))
+      {
+        continue;
+      }
+      // Only a claimed message gets new references, so it cannot be borrowed twice.
+      std::shared_ptr<MessageT> message;
+      if (pool_[index].use_count() == 1) {
+        // Synchronize with the release of the last other reference, whose writes are then visible.
+        std::atomic_thread_fence(std::memory_order_acquire);
+        message = pool_[index];
+      }
+      claimed_[index].store(false, std::memory_order_release);
+      if (message) {
+        return message;
+      }
+    }
+    return Base::borrow_message();
+  }
+
+  /// Drop the reference to the message, which is borrowed again once no callback refers to it.
+  /** \param[in] msg Shared pointer to the message to return. */
+  void return_message(std::shared_ptr<MessageT> & msg) override
+  {
+    msg.reset();
+  }
+
+  size_t get_pool_memory_size() const override
+  {
+    return pool_.size() * sizeof(MessageT);
+  }
+
+  /// Return the number of messages of the pool.
+  size_t
+  get_pool_size() const
+  {
+    return pool_.size();
+  }
+
+private:
+  std::vector<std::shared_ptr<MessageT>> pool_;
+  std::vector<std::atomic<bool>> claimed_;
+  std::atomic<size_t> next_index_;
+};
+
+}  // namespace shared_message_pool_memory_strategy
+}  // namespace strategies
+}  // namespace rclcpp
+
+#endif  // RCLCPP__STRATEGIES__SHARED_MESSAGE_POOL_MEMORY_STRATEGY_HPP_
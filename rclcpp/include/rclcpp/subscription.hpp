@@ -24,23 +24,32 @@
 #include <memory>
 #include <sstream>
 #include <string>
+#include <typeinfo>
 #include <utility>
+#include <vector>
 
 #include "rcl/error_handling.h"
 #include "rcl/subscription.h"
 
 #include "rclcpp/any_subscription_callback.hpp"
+#include "rclcpp/detail/min_period_limiter.hpp"
 #include "rclcpp/detail/resolve_use_intra_process.hpp"
 #include "rclcpp/detail/resolve_intra_process_buffer_type.hpp"
+#include "rclcpp/detail/resolve_intra_process_qos.hpp"
 #include "rclcpp/exceptions.hpp"
 #include "rclcpp/expand_topic_or_service_name.hpp"
 #include "rclcpp/experimental/intra_process_manager.hpp"
+#include "rclcpp/experimental/shared_memory_channel.hpp"
+#include "rclcpp/experimental/shared_memory_message.hpp"
 #include "rclcpp/experimental/subscription_intra_process.hpp"
+#include "rclcpp/experimental/subscription_shared_memory.hpp"
 #include "rclcpp/logging.hpp"
 #include "rclcpp/macros.hpp"
 #include "rclcpp/message_info.hpp"
 #include "rclcpp/message_memory_strategy.hpp"
 #include "rclcpp/node_interfaces/node_base_interface.hpp"
+#include "rclcpp/serialization.hpp"
+#include "rclcpp/strategies/shared_message_pool_memory_strategy.hpp"
 #include "rclcpp/subscription_base.hpp"
 #include "rclcpp/subscription_options.hpp"
 #include "rclcpp/subscription_traits.hpp"
@@ -126,6 +135,8 @@ public:
    * \throws std::invalid_argument if the QoS is uncompatible with intra-process (if one
    *   of the following conditions are true: qos_profile.history == RMW_QOS_POLICY_HISTORY_KEEP_ALL,
    *   qos_profile.depth == 0 or qos_profile.durability != RMW_QOS_POLICY_DURABILITY_VOLATILE).
+   * \throws std::invalid_argument if the message filter of the options does not take
+   *   ROSMessageType.
    */
   Subscription(
     rclcpp::node_interfaces::NodeBaseInterface * node_base,
@@ -141,11 +152,51 @@ public:
       type_support_handle,
       topic_name,
       options.template to_rcl_subscription_options<ROSMessageType>(qos),
-      callback.is_serialized_message_callback()),
+      // Messages are taken serialized to be filtered before they are deserialized.
+      callback.is_serialized_message_callback() ||
+      static_cast<bool>(options.content_filter.serialized_message_filter)),
     any_callback_(callback),
     options_(options),
     message_memory_strategy_(message_memory_strategy)
   {
+    const auto & content_filter = options.content_filter;
+    if (
+      content_filter.message_filter && content_filter.message_filter_type &&
+      *content_filter.message_filter_type != typeid(ROSMessageType))
+    {
+      throw std::invalid_argument(
+              "the message filter of the subscription does not take its messages");
+    }
+    message_filter_ = content_filter.message_filter;
+    if (options.min_callback_period.count() > 0) {
+      // The rate is limited after filtering, so that rejected messages do not count.
+      callback_rate_limiter_ =
+        std::make_shared<rclcpp::detail::MinPeriodLimiter>(options.min_callback_period);
+      message_filter_ =
+        [filter = content_filter.message_filter, limiter = callback_rate_limiter_](
+        const void * message) {
+          return (!filter || filter(message)) && limiter->try_pass();
+        };
+    }
+    this->set_take_latest_only(options.take_latest_only);
+    // Take into a pool of messages shared with the callbacks, unless the strategy is custom.
+    using DefaultMessageMemoryStrategy =
+      message_memory_strategy::MessageMemoryStrategy<ROSMessageType, AllocatorT>;
+    if (
+      options.message_pool_size > 0 && message_memory_strategy_ &&
+      typeid(*message_memory_strategy_) == typeid(DefaultMessageMemoryStrategy))
+    {
+      message_memory_strategy_ = std::make_shared<
+        strategies::shared_message_pool_memory_strategy::SharedMessagePoolMemoryStrategy<
+          ROSMessageType, AllocatorT>>(options.message_pool_size, options.get_allocator());
+    }
+    // Callbacks taking the message by const reference get every message in the same one.
+    if (
+      callback.is_const_ref_ros_message_callback() && !options.take_latest_only &&
+      !this->is_serialized())
+    {
+      this->set_reusable_message(message_memory_strategy_->borrow_message());
+    }
     if (options.event_callbacks.deadline_callback) {
       this->add_event_handler(
         options.event_callbacks.deadline_callback,
@@ -180,32 +231,21 @@ public:
 
     // Setup intra process publishing if requested.
     if (rclcpp::detail::resolve_use_intra_process(options, *node_base)) {
-      using rclcpp::detail::resolve_intra_process_buffer_type;
-
       // Check if the QoS is compatible with intra-process.
-      auto qos_profile = get_actual_qos();
-      if (qos_profile.history() != rclcpp::HistoryPolicy::KeepLast) {
-        throw std::invalid_argument(
-                "intraprocess communication allowed only with keep last history qos policy");
-      }
-      if (qos_profile.depth() == 0) {
-        throw std::invalid_argument(
-                "intraprocess communication is not allowed with 0 depth qos policy");
-      }
-      if (qos_profile.durability() != rclcpp::DurabilityPolicy::Volatile) {
-        throw std::invalid_argument(
-                "intraprocess communication allowed only with volatile durability");
-      }
+      auto qos_profile = rclcpp::detail::resolve_intra_process_qos(get_actual_qos(), options);
 
       // First create a SubscriptionIntraProcess which will be given to the intra-process manager.
+      // A callback taking the custom type of a TypeAdapter gets the messages of the publishers
+      // of the custom type without them being converted to and back from the ROS message.
       auto context = node_base->get_context();
-      subscription_intra_process_ = std::make_shared<SubscriptionIntraProcessT>(
-        callback,
-        options.get_allocator(),
-        context,
-        this->get_topic_name(),  // important to get like this, as it has the fully-qualified name
-        qos_profile,
-        resolve_intra_process_buffer_type(options.intra_process_buffer_type, callback));
+      if (callback.is_custom_type_callback()) {
+        subscription_intra_process_ =
+          create_subscription_intra_process<CustomTypeSubscriptionIntraProcessT>(
+          callback, options, context, qos_profile);
+      } else {
+        subscription_intra_process_ = create_subscription_intra_process<SubscriptionIntraProcessT>(
+          callback, options, context, qos_profile);
+      }
       TRACEPOINT(
         rclcpp_subscription_init,
         static_cast<const void *>(get_subscription_handle().get()),
@@ -218,6 +258,26 @@ public:
       this->setup_intra_process(intra_process_subscription_id, ipm);
     }
 
+    // Middlewares which loan messages have their own shared memory transport.
+    if constexpr (
+      !rclcpp::serialization_traits::is_serialized_message_class<ROSMessageType>::value)
+    {
+      const auto & shared_memory_options = options.shared_memory_transport;
+      if (shared_memory_options.enabled && !callback.is_serialized_message_callback() &&
+        !this->can_loan_messages())
+      {
+        auto context = node_base->get_context();
+        auto channel = std::make_shared<rclcpp::experimental::SharedMemoryChannel>(
+          this->get_topic_name(),
+          context->get_domain_id(),
+          shared_memory_options.slot_size,
+          shared_memory_options.slot_count ? shared_memory_options.slot_count : qos.depth());
+        shared_memory_waitable_ =
+          std::make_shared<rclcpp::experimental::SubscriptionSharedMemory>(
+          channel, context, create_shared_memory_message_handler(callback));
+      }
+    }
+
     if (subscription_topic_statistics != nullptr) {
       this->subscription_topic_statistics_ = std::move(subscription_topic_statistics);
     }
@@ -274,6 +334,33 @@ public:
     return this->take_type_erased(static_cast<void *>(&message_out), message_info_out);
   }
 
+  /// Take up to count messages from the inter-process subscription, in one call.
+  /**
+   * The messages are taken into an array of count messages allocated by the caller, like
+   * a std::array or a std::vector, in the order they were received, and without calling the
+   * callback, for polling the subscription with a rclcpp::WaitSet for instance.
+   * Messages whose sequences were reserved can thus be reused from one batch to the next.
+   *
+   * When the middleware supports it, the messages are taken with a single rcl_take_sequence.
+   * Otherwise, or if the messages of intra-process publishers have to be dropped, they are
+   * taken one by one.
+   * Taking batches concurrently from the same subscription is thread-safe.
+   *
+   * \sa take(ROSMessageType &, rclcpp::MessageInfo &)
+   *
+   * \param[out] messages_out The messages into which take will copy the data, count of them.
+   * \param[out] message_infos_out The message infos of the taken messages, count of them.
+   * \param[in] count The largest number of messages to take.
+   * \returns the number of messages taken, which are the first ones of messages_out
+   * \throws any rcl errors from rcl_take_sequence, \sa rclcpp::exceptions::throw_from_rcl_error()
+   */
+  size_t
+  take_batch(ROSMessageType * messages_out, rclcpp::MessageInfo * message_infos_out, size_t count)
+  {
+    return this->take_type_erased_batch(
+      static_cast<void *>(messages_out), sizeof(ROSMessageType), message_infos_out, count);
+  }
+
   /// Take the next message from the inter-process subscription.
   /**
    * This verison takes a SubscribedType which is different frmo the
@@ -302,7 +389,8 @@ public:
   {
     /* The default message memory strategy provides a dynamically allocated message on each call to
      * create_message, though alternative memory strategies that re-use a preallocated message may be
-     * used (see rclcpp/strategies/message_pool_memory_strategy.hpp).
+     * used (see rclcpp/strategies/message_pool_memory_strategy.hpp, and
+     * SubscriptionOptionsBase::message_pool_size).
      */
     return message_memory_strategy_->borrow_message();
   }
@@ -318,27 +406,25 @@ public:
     std::shared_ptr<void> & message,
     const rclcpp::MessageInfo & message_info) override
   {
-    if (matches_any_intra_process_publishers(&message_info.get_rmw_message_info().publisher_gid)) {
-      // In this case, the message will be delivered via intra process and
-      // we should ignore this copy of the message.
-      return;
-    }
     auto typed_message = std::static_pointer_cast<ROSMessageType>(message);
+    handle_message_with(
+      *typed_message, message_info,
+      [this, &typed_message, &message_info]() {
+        any_callback_.dispatch(typed_message, message_info);
+      });
+  }
 
-    std::chrono::time_point<std::chrono::system_clock> now;
-    if (subscription_topic_statistics_) {
-      // get current time before executing callback to
-      // exclude callback duration from topic statistics result.
-      now = std::chrono::system_clock::now();
-    }
-
-    any_callback_.dispatch(typed_message, message_info);
-
-    if (subscription_topic_statistics_) {
-      const auto nanos = std::chrono::time_point_cast<std::chrono::nanoseconds>(now);
-      const auto time = rclcpp::Time(nanos.time_since_epoch().count());
-      subscription_topic_statistics_->handle_message(*typed_message, time);
-    }
+  void
+  handle_reusable_message(
+    void * message,
+    const rclcpp::MessageInfo & message_info) override
+  {
+    const auto & typed_message = *static_cast<ROSMessageType *>(message);
+    handle_message_with(
+      typed_message, message_info,
+      [this, &typed_message, &message_info]() {
+        any_callback_.dispatch_const_ref(typed_message, message_info);
+      });
   }
 
   void
@@ -346,8 +432,28 @@ public:
     const std::shared_ptr<rclcpp::SerializedMessage> & serialized_message,
     const rclcpp::MessageInfo & message_info) override
   {
-    // TODO(wjwwood): enable topic statistics for serialized messages
-    any_callback_.dispatch(serialized_message, message_info);
+    const auto & serialized_message_filter = options_.content_filter.serialized_message_filter;
+    if (serialized_message_filter && !serialized_message_filter(*serialized_message)) {
+      return;
+    }
+    if (any_callback_.is_serialized_message_callback()) {
+      if (callback_rate_limiter_ && !callback_rate_limiter_->try_pass()) {
+        return;
+      }
+      // TODO(wjwwood): enable topic statistics for serialized messages
+      any_callback_.dispatch(serialized_message, message_info);
+      return;
+    }
+    if constexpr (
+      !rclcpp::serialization_traits::is_serialized_message_class<ROSMessageType>::value)
+    {
+      // The message was only taken serialized to be filtered.
+      std::shared_ptr<void> message = create_message();
+      rclcpp::Serialization<ROSMessageType>().deserialize_message(
+        serialized_message.get(), message.get());
+      handle_message(message, message_info);
+      return_message(message);
+    }
   }
 
   void
@@ -357,11 +463,25 @@ public:
   {
     auto typed_message = static_cast<ROSMessageType *>(loaned_message);
     // message is loaned, so we have to make sure that the deleter does not deallocate the message
+    if (!accepts_message(*typed_message)) {
+      return;
+    }
     auto sptr = std::shared_ptr<ROSMessageType>(
       typed_message, [](ROSMessageType * msg) {(void) msg;});
     any_callback_.dispatch(sptr, message_info);
   }
 
+  rclcpp::EntityMemoryFootprint
+  get_memory_footprint() const override
+  {
+    rclcpp::EntityMemoryFootprint footprint = SubscriptionBase::get_memory_footprint();
+    footprint.message_pools = message_memory_strategy_->get_pool_memory_size();
+    if (subscription_topic_statistics_) {
+      footprint.topic_statistics = subscription_topic_statistics_->get_memory_size();
+    }
+    return footprint;
+  }
+
   /// Return the borrowed message.
   /**
    * \param[inout] message message to be returned
@@ -389,9 +509,139 @@ public:
     return any_callback_.use_take_shared_method();
   }
 
+protected:
+  /// Handle a message taken from the middleware, calling the callback with dispatch.
+  /**
+   * The copies of messages delivered through intra-process or shared memory
+   * are ignored, the message filter is applied and the topic statistics are
+   * collected, so that every way of calling the callback behaves the same.
+   *
+   * \param[in] message the message taken.
+   * \param[in] message_info the information of the message.
+   * \param[in] dispatch function calling the callback with the message and its information.
+   */
+  template<typename DispatchT>
+  void
+  handle_message_with(
+    const ROSMessageType & message,
+    const rclcpp::MessageInfo & message_info,
+    DispatchT && dispatch)
+  {
+    if (matches_any_intra_process_publishers(&message_info.get_rmw_message_info().publisher_gid)) {
+      // In this case, the message will be delivered via intra process and
+      // we should ignore this copy of the message.
+      return;
+    }
+    if (matches_any_shared_memory_publishers(&message_info.get_rmw_message_info().publisher_gid)) {
+      // The message is delivered through shared memory as well.
+      return;
+    }
+    if (!accepts_message(message)) {
+      return;
+    }
+
+    const bool measure_message =
+      subscription_topic_statistics_ && subscription_topic_statistics_->sample_next_message();
+    std::chrono::time_point<std::chrono::system_clock> now;
+    if (measure_message) {
+      // get current time before executing callback to
+      // exclude callback duration from topic statistics result.
+      now = std::chrono::system_clock::now();
+    }
+
+    dispatch();
+
+    if (measure_message) {
+      const auto nanos = std::chrono::time_point_cast<std::chrono::nanoseconds>(now);
+      const auto time = rclcpp::Time(nanos.time_since_epoch().count());
+      subscription_topic_statistics_->handle_message(message, time);
+    }
+  }
+
+  /// Return the callback of the subscription, whose address identifies it in the traces.
+  const AnySubscriptionCallback<MessageT, AllocatorT> &
+  get_any_subscription_callback() const
+  {
+    return any_callback_;
+  }
+
 private:
   RCLCPP_DISABLE_COPY(Subscription)
 
+  /// Return true if the message filter of the options, if any, accepts the message.
+  /**
+   * A message accepted counts for the rate of the callback, if it is limited.
+   */
+  bool
+  accepts_message(const ROSMessageType & message) const
+  {
+    return !message_filter_ || message_filter_(&message);
+  }
+
+  template<typename SubscriptionIntraProcessTypeT>
+  std::shared_ptr<rclcpp::experimental::SubscriptionIntraProcessBase>
+  create_subscription_intra_process(
+    const AnySubscriptionCallback<MessageT, AllocatorT> & callback,
+    const rclcpp::SubscriptionOptionsWithAllocator<AllocatorT> & options,
+    rclcpp::Context::SharedPtr context,
+    const rclcpp::QoS & qos_profile)
+  {
+    using rclcpp::detail::resolve_intra_process_buffer_type;
+    auto subscription_intra_process = std::make_shared<SubscriptionIntraProcessTypeT>(
+      callback,
+      options.get_allocator(),
+      context,
+      this->get_topic_name(),  // important to get like this, as it has the fully-qualified name
+      qos_profile,
+      resolve_intra_process_buffer_type(options.intra_process_buffer_type, callback),
+      // All the queued messages are taken to deliver only the latest.
+      options.take_latest_only ? 0 : options.intra_process_max_batch_size,
+      options.collect_intra_process_buffer_statistics,
+      options.intra_process_message_info,
+      options.intra_process_keep_all);
+    subscription_intra_process->set_dispatch_latest_only(options.take_latest_only);
+    subscription_intra_process->set_deliver_inline(options.deliver_intra_process_inline);
+    subscription_intra_process->set_drop_new_when_full(options.intra_process_drop_new_when_full);
+    // The buffer of a callback taking the custom type of a TypeAdapter holds the custom type.
+    if constexpr (std::is_same_v<SubscriptionIntraProcessTypeT, SubscriptionIntraProcessT>) {
+      subscription_intra_process->set_message_filter(message_filter_);
+    }
+    return subscription_intra_process;
+  }
+
+  /// Return the handler of the messages of the shared memory channel.
+  /**
+   * It is executed by the shared memory waitable, which may outlive the
+   * subscription, so it has its own copy of the callback.
+   */
+  rclcpp::experimental::SubscriptionSharedMemory::MessageHandler
+  create_shared_memory_message_handler(
+    const AnySubscriptionCallback<MessageT, AllocatorT> & callback) const
+  {
+    return
+      [callback, use_intra_process = use_intra_process_, weak_ipm = weak_ipm_,
+      intra_process_subscription_id = intra_process_subscription_id_,
+      message_filter = message_filter_](
+      const std::vector<uint8_t> & data, const rmw_gid_t & publisher_gid) mutable
+      {
+        if (use_intra_process) {
+          auto ipm = weak_ipm.lock();
+          if (ipm && ipm->matches_any_publishers(&publisher_gid, intra_process_subscription_id)) {
+            // The message is delivered via intra process.
+            return;
+          }
+        }
+        auto message = std::make_shared<ROSMessageType>();
+        rclcpp::experimental::read_from_shared_memory(data, *message);
+        if (message_filter && !message_filter(message.get())) {
+          return;
+        }
+        rmw_message_info_t rmw_message_info = rmw_get_zero_initialized_message_info();
+        rmw_message_info.publisher_gid = publisher_gid;
+        callback.dispatch(message, rclcpp::MessageInfo(rmw_message_info));
+      };
+  }
+
   AnySubscriptionCallback<MessageT, AllocatorT> any_callback_;
   /// Copy of original options passed during construction.
   /**
@@ -399,6 +649,9 @@ private:
    * may contain is kept alive for the duration of the subscription.
    */
   const rclcpp::SubscriptionOptionsWithAllocator<AllocatorT> options_;
+  /// Filter of the options, which also limits the rate of the callback if needed.
+  std::function<bool (const void *)> message_filter_;
+  std::shared_ptr<rclcpp::detail::MinPeriodLimiter> callback_rate_limiter_;
   typename message_memory_strategy::MessageMemoryStrategy<ROSMessageType, AllocatorT>::SharedPtr
     message_memory_strategy_;
 
@@ -410,7 +663,14 @@ private:
     AllocatorT,
     ROSMessageTypeDeleter,
     MessageT>;
-  std::shared_ptr<SubscriptionIntraProcessT> subscription_intra_process_;
+  /// Used instead if the callback takes the custom type of a TypeAdapter.
+  using CustomTypeSubscriptionIntraProcessT = rclcpp::experimental::SubscriptionIntraProcess<
+    SubscribedType,
+    AllocatorT,
+    SubscribedTypeDeleter,
+    MessageT,
+    ROSMessageType>;
+  std::shared_ptr<rclcpp::experimental::SubscriptionIntraProcessBase> subscription_intra_process_;
 };
 
 }  // namespace rclcpp
@@ -17,6 +17,7 @@
 
 #include <atomic>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -29,7 +30,9 @@
 #include "rclcpp/any_subscription_callback.hpp"
 #include "rclcpp/experimental/intra_process_manager.hpp"
 #include "rclcpp/experimental/subscription_intra_process_base.hpp"
+#include "rclcpp/experimental/subscription_shared_memory.hpp"
 #include "rclcpp/macros.hpp"
+#include "rclcpp/memory_footprint.hpp"
 #include "rclcpp/message_info.hpp"
 #include "rclcpp/network_flow_endpoint.hpp"
 #include "rclcpp/qos.hpp"
@@ -141,6 +144,26 @@ public:
   bool
   take_type_erased(void * message_out, rclcpp::MessageInfo & message_info_out);
 
+  /// Take up to count inter-process messages at once, into an array of type erased messages.
+  /**
+   * \sa Subscription::take_batch() for details on how this function works.
+   *
+   * \param[out] messages_out The first message of the array of count messages into which
+   *   take will copy the data.
+   * \param[in] message_size The size of the messages of the array.
+   * \param[out] message_infos_out The message infos of the taken messages, count of them.
+   * \param[in] count The largest number of messages to take.
+   * \returns the number of messages taken, which are the first ones of the array
+   * \throws any rcl errors from rcl_take_sequence, \sa rclcpp::exceptions::throw_from_rcl_error()
+   */
+  RCLCPP_PUBLIC
+  size_t
+  take_type_erased_batch(
+    void * messages_out,
+    size_t message_size,
+    rclcpp::MessageInfo * message_infos_out,
+    size_t count);
+
   /// Take the next inter-process message, in its serialized form, from the subscription.
   /**
    * For now, if data is taken (written) into the message_out and
@@ -159,6 +182,63 @@ public:
   bool
   take_serialized(rclcpp::SerializedMessage & message_out, rclcpp::MessageInfo & message_info_out);
 
+  /// Return true if only the latest of the messages available is given to the callback.
+  /**
+   * \sa SubscriptionOptionsBase::take_latest_only
+   */
+  RCLCPP_PUBLIC
+  bool
+  takes_latest_only() const;
+
+  /// Take the latest of the inter-process messages available, dropping the older ones.
+  /**
+   * The messages are taken into message and into another message borrowed with
+   * create_message(), which are swapped so that message holds the latest one.
+   * The other message is returned with return_message().
+   *
+   * \sa take_type_erased()
+   *
+   * \param[inout] message The message borrowed with create_message() into which take will copy
+   *   the data, which may be replaced by another borrowed message.
+   * \param[out] message_info The message info for the taken message.
+   * \returns true if data was taken and is valid, otherwise false
+   * \throws any rcl errors from rcl_take, \sa rclcpp::exceptions::throw_from_rcl_error()
+   */
+  RCLCPP_PUBLIC
+  bool
+  take_latest_type_erased(std::shared_ptr<void> & message, rclcpp::MessageInfo & message_info);
+
+  /// Take the latest of the inter-process messages available, in their serialized form.
+  /**
+   * \sa take_latest_type_erased()
+   */
+  RCLCPP_PUBLIC
+  bool
+  take_latest_serialized(
+    std::shared_ptr<rclcpp::SerializedMessage> & message,
+    rclcpp::MessageInfo & message_info);
+
+  /// Borrow the message the subscription takes every message into, if it has one.
+  /**
+   * Subscriptions whose callback takes the message by constant reference,
+   * which cannot keep it, take the messages into the same one, without
+   * allocating a message nor counting references to it for every message.
+   * The message is handled with handle_reusable_message() and given back with
+   * return_reusable_message().
+   * It is borrowed by a single thread at a time: the other threads executing
+   * the subscription meanwhile get nullptr and use create_message() instead.
+   *
+   * \return the message, of the type of the subscription, or nullptr.
+   */
+  RCLCPP_PUBLIC
+  void *
+  borrow_reusable_message();
+
+  /// Give back the message borrowed with borrow_reusable_message().
+  RCLCPP_PUBLIC
+  void
+  return_reusable_message();
+
   /// Borrow a new message.
   /** \return Shared pointer to the fresh message. */
   RCLCPP_PUBLIC
@@ -195,6 +275,20 @@ public:
   void
   handle_loaned_message(void * loaned_message, const rclcpp::MessageInfo & message_info) = 0;
 
+  /// Check if we need to handle the message borrowed with borrow_reusable_message().
+  /**
+   * The message stays the subscription's, so it is only given to the callback
+   * by constant reference.
+   *
+   * \param[in] message the message borrowed with borrow_reusable_message().
+   * \param[in] message_info Metadata associated with this message.
+   * \throws rclcpp::exceptions::UnimplementedError if the subscription has no reusable message.
+   */
+  RCLCPP_PUBLIC
+  virtual
+  void
+  handle_reusable_message(void * message, const rclcpp::MessageInfo & message_info);
+
   /// Return the message borrowed in create_message.
   /** \param[in] message Shared pointer to the returned message. */
   RCLCPP_PUBLIC
@@ -257,6 +351,15 @@ public:
   rclcpp::Waitable::SharedPtr
   get_intra_process_waitable() const;
 
+  /// Return the waitable delivering the messages of the publishers of the host through shared memory
+  /**
+   * \return the waitable, or nullptr if the shared memory transport is not used.
+   * \sa rclcpp::SharedMemoryTransportOptions
+   */
+  RCLCPP_PUBLIC
+  rclcpp::Waitable::SharedPtr
+  get_shared_memory_waitable() const;
+
   /// Exchange state of whether or not a part of the subscription is used by a wait set.
   /**
    * Used to ensure parts of the subscription are not used with multiple wait
@@ -283,6 +386,17 @@ public:
   std::vector<rclcpp::NetworkFlowEndpoint>
   get_network_flow_endpoints() const;
 
+  /// Return the approximate memory used by the subscription.
+  /**
+   * The base class accounts for the intra-process buffer, and Subscription for its message
+   * memory strategy and its topic statistics too.
+   * \sa rclcpp::get_memory_footprint()
+   */
+  RCLCPP_PUBLIC
+  virtual
+  rclcpp::EntityMemoryFootprint
+  get_memory_footprint() const;
+
 protected:
   template<typename EventCallbackT>
   void
@@ -303,10 +417,28 @@ protected:
   RCLCPP_PUBLIC
   void default_incompatible_qos_callback(QOSRequestedIncompatibleQoSInfo & info) const;
 
+  /// Set whether only the latest of the messages available is given to the callback.
+  RCLCPP_PUBLIC
+  void
+  set_take_latest_only(bool take_latest_only);
+
+  /// Set the message every message is taken into, or nullptr to allocate a message each time.
+  /**
+   * \sa borrow_reusable_message()
+   */
+  RCLCPP_PUBLIC
+  void
+  set_reusable_message(std::shared_ptr<void> message);
+
   RCLCPP_PUBLIC
   bool
   matches_any_intra_process_publishers(const rmw_gid_t * sender_gid) const;
 
+  /// Return true if the publisher also writes its messages to the shared memory channel.
+  RCLCPP_PUBLIC
+  bool
+  matches_any_shared_memory_publishers(const rmw_gid_t * sender_gid) const;
+
   rclcpp::node_interfaces::NodeBaseInterface * const node_base_;
 
   std::shared_ptr<rcl_node_t> node_handle_;
@@ -319,16 +451,28 @@ protected:
   IntraProcessManagerWeakPtr weak_ipm_;
   uint64_t intra_process_subscription_id_;
 
+  std::shared_ptr<rclcpp::experimental::SubscriptionSharedMemory> shared_memory_waitable_;
+
 private:
   RCLCPP_DISABLE_COPY(SubscriptionBase)
 
   rosidl_message_type_support_t type_support_;
   bool is_serialized_;
+  bool take_latest_only_ = false;
+  std::shared_ptr<void> reusable_message_;
+  std::atomic<bool> reusable_message_borrowed_{false};
 
   std::atomic<bool> subscription_in_use_by_wait_set_{false};
   std::atomic<bool> intra_process_subscription_waitable_in_use_by_wait_set_{false};
   std::unordered_map<rclcpp::QOSEventHandlerBase *,
     std::atomic<bool>> qos_events_in_use_by_wait_set_;
+
+  /// The sequences given to rcl_take_sequence, grown to the largest batch taken.
+  std::mutex take_batch_mutex_;
+  std::vector<void *> take_batch_messages_;
+  std::vector<rmw_message_info_t> take_batch_message_infos_;
+  /// False once the middleware failed to take a sequence, messages are then taken one by one.
+  bool take_sequence_supported_{true};
 };
 
 }  // namespace rclcpp
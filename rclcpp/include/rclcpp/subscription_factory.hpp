@@ -18,6 +18,7 @@
 #include <functional>
 #include <memory>
 #include <string>
+#include <type_traits>
 #include <utility>
 
 #include "rcl/subscription.h"
@@ -25,6 +26,7 @@
 #include "rosidl_typesupport_cpp/message_type_support.hpp"
 
 #include "rclcpp/any_subscription_callback.hpp"
+#include "rclcpp/direct_callback_subscription.hpp"
 #include "rclcpp/get_message_type_support_handle.hpp"
 #include "rclcpp/intra_process_buffer_type.hpp"
 #include "rclcpp/node_interfaces/node_base_interface.hpp"
@@ -66,6 +68,11 @@ struct SubscriptionFactory
 
 /// Return a SubscriptionFactory setup to create a SubscriptionT<MessageT, AllocatorT>.
 /**
+ * A DirectCallbackSubscription, which calls the callback without going
+ * through the AnySubscriptionCallback, is created instead when the messages
+ * are not adapted and rclcpp::subscription_traits::is_direct_callback
+ * accepts the callback.
+ *
  * \param[in] callback The user-defined callback function to receive a message
  * \param[in] options Additional options for the creation of the Subscription.
  * \param[in] msg_mem_strat The message memory strategy to use for allocating messages.
@@ -88,6 +95,37 @@ create_subscription_factory(
   subscription_topic_stats = nullptr
 )
 {
+  using DecayedCallbackT = std::decay_t<CallbackT>;
+  if constexpr (
+    !rclcpp::TypeAdapter<MessageT>::is_specialized::value &&
+    !rclcpp::serialization_traits::is_serialized_message_class<ROSMessageType>::value &&
+    rclcpp::subscription_traits::is_direct_callback<DecayedCallbackT, ROSMessageType>::value)
+  {
+    auto shared_callback = std::make_shared<DecayedCallbackT>(std::forward<CallbackT>(callback));
+
+    SubscriptionFactory factory {
+      [options, msg_mem_strat, shared_callback, subscription_topic_stats](
+        rclcpp::node_interfaces::NodeBaseInterface * node_base,
+        const std::string & topic_name,
+        const rclcpp::QoS & qos
+      ) -> rclcpp::SubscriptionBase::SharedPtr
+      {
+        auto sub = DirectCallbackSubscription<MessageT, DecayedCallbackT, AllocatorT>::make_shared(
+          node_base,
+          rclcpp::get_message_type_support_handle<MessageT>(),
+          topic_name,
+          qos,
+          shared_callback,
+          options,
+          msg_mem_strat,
+          subscription_topic_stats);
+        sub->post_init_setup(node_base, qos, options);
+        return std::dynamic_pointer_cast<rclcpp::SubscriptionBase>(sub);
+      }
+    };
+    return factory;
+  }
+
   auto allocator = options.get_allocator();
 
   using rclcpp::AnySubscriptionCallback;
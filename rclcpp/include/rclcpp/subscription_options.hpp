@@ -22,12 +22,15 @@
 #include <vector>
 
 #include "rclcpp/callback_group.hpp"
+#include "rclcpp/content_filter_options.hpp"
 #include "rclcpp/detail/rmw_implementation_specific_subscription_payload.hpp"
 #include "rclcpp/intra_process_buffer_type.hpp"
+#include "rclcpp/intra_process_keep_all_options.hpp"
 #include "rclcpp/intra_process_setting.hpp"
 #include "rclcpp/qos.hpp"
 #include "rclcpp/qos_event.hpp"
 #include "rclcpp/qos_overriding_options.hpp"
+#include "rclcpp/shared_memory_transport_options.hpp"
 #include "rclcpp/topic_statistics_state.hpp"
 #include "rclcpp/visibility_control.hpp"
 
@@ -60,10 +63,107 @@ struct SubscriptionOptionsBase
   /// Setting the data-type stored in the intraprocess buffer
   IntraProcessBufferType intra_process_buffer_type = IntraProcessBufferType::CallbackDefault;
 
+  /// Maximum size and backpressure policy of the intraprocess buffer of a keep all history.
+  /**
+   * The messages of the publishers are only dropped with the DropOldest policy.
+   * Unused with a keep last history, whose buffer holds depth messages. Block
+   * is not supported with intra_process_message_info.
+   */
+  IntraProcessKeepAllOptions intra_process_keep_all;
+
+  /// Maximum number of intraprocess messages delivered each time the subscription is executed.
+  /**
+   * The callback is called once per message, but a burst of queued messages is delivered
+   * without the executor waiting again in between. 0 delivers all the queued messages.
+   */
+  size_t intra_process_max_batch_size = 1;
+
+  /// True to count the intraprocess messages queued, dropped when the buffer is full, and
+  /// the time they wait.
+  /**
+   * See rclcpp::experimental::SubscriptionIntraProcessBase::get_buffer_statistics().
+   */
+  bool collect_intra_process_buffer_statistics = false;
+
+  /// True to give the callbacks the origin of the intraprocess messages.
+  /**
+   * The rclcpp::MessageInfo of an intraprocess message then has the gid of its publisher,
+   * the system time it was published at as source timestamp, and the time it was queued for
+   * the subscription as received timestamp, as for the messages of the middleware.
+   * Otherwise they are zero.
+   * Publishing then reads the clock, and queueing a message for the subscription takes a lock.
+   */
+  bool intra_process_message_info = false;
+
+  /// Number of messages of a pool the messages taken from the middleware are taken into.
+  /**
+   * The pooled messages are given to the callbacks taking a message by constant reference or
+   * by shared pointer without being copied, and are reused once the callbacks drop their
+   * references, so that receiving a message does not allocate.
+   * It should be at least the number of messages the callbacks keep plus the number of threads
+   * executing the subscription.
+   * 0, the default, allocates a message for each take.
+   * A custom MessageMemoryStrategy given when creating the subscription takes precedence.
+   * See rclcpp::strategies::shared_message_pool_memory_strategy::SharedMessagePoolMemoryStrategy.
+   */
+  size_t message_pool_size = 0;
+
+  /// Predicates selecting the messages given to the callback, none by default.
+  ContentFilterOptions content_filter;
+
+  /// True to only give the callback the latest of the messages queued when it is executed.
+  /**
+   * All the messages available are taken and the older ones are dropped, so that a callback
+   * slower than the publishers of the topic handles the newest message instead of falling
+   * behind.
+   * The intra-process messages are delivered in batches of all the queued messages, of which
+   * only the latest is given to the callback.
+   * Messages loaned by the middleware are not coalesced.
+   */
+  bool take_latest_only = false;
+
+  /// Minimum time between two calls of the callback, 0 to not limit their rate.
+  /**
+   * The messages taken earlier are dropped.
+   * The time is the steady time, e.g. a period of 200ms calls the callback at most 5 times
+   * per second.
+   */
+  std::chrono::nanoseconds min_callback_period{0};
+
+  /// True to call the callback in the thread publishing an intraprocess message.
+  /**
+   * The message is given to the callback during the publish call, without being queued in the
+   * buffer nor waiting for the executor, which saves a wake up of the executor per message.
+   * The callback then runs outside of the executor, concurrently with the other callbacks of
+   * its callback group and with itself if several threads publish on the topic, so it must be
+   * thread-safe, and it must not create or destroy intraprocess publishers or subscriptions.
+   * A message published by the callback which would be delivered inline to a subscription the
+   * thread is already delivering to, or too deeply nested, is queued in the buffer instead.
+   * The messages of the middleware are still delivered by the executor.
+   */
+  bool deliver_intra_process_inline = false;
+
+  /// True to drop the intraprocess messages published while the buffer is full, not the oldest.
+  /**
+   * With a keep last history, a subscription slower than its publishers then keeps the
+   * messages it did not handle yet instead of the newest ones, and the publishers skip it
+   * without copying the messages it would drop, which saves the copies of the messages
+   * of a full buffer for the subscriptions taking ownership of them.
+   * The dropped messages are counted as dropped in the buffer statistics.
+   * Whether the buffer is full is checked when publishing, so that a message may still
+   * be copied and then overwrite the oldest one if the buffer filled up in between.
+   * Unused with a keep all history, see intra_process_keep_all, and for the messages
+   * delivered inline, see deliver_intra_process_inline.
+   */
+  bool intra_process_drop_new_when_full = false;
+
   /// Optional RMW implementation specific payload to be used during creation of the subscription.
   std::shared_ptr<rclcpp::detail::RMWImplementationSpecificSubscriptionPayload>
   rmw_implementation_payload = nullptr;
 
+  /// Transport of the messages from the publishers of other processes of the host.
+  SharedMemoryTransportOptions shared_memory_transport;
+
   // Options to configure topic statistics collector in the subscription.
   struct TopicStatisticsOptions
   {
@@ -76,6 +176,11 @@ struct SubscriptionOptionsBase
     // Topic statistics publication period in ms. Defaults to one second.
     // Only values greater than zero are allowed.
     std::chrono::milliseconds publish_period{std::chrono::seconds(1)};
+
+    // Measure one received message out of this number, to lower the overhead
+    // on high rate topics. Defaults to 1, measuring every message.
+    // Only values greater than zero are allowed.
+    size_t message_sampling_interval{1};
   };
 
   TopicStatisticsOptions topic_stats_options;
@@ -16,8 +16,11 @@
 #define RCLCPP__SUBSCRIPTION_TRAITS_HPP_
 
 #include <memory>
+#include <tuple>
+#include <type_traits>
 
 #include "rclcpp/function_traits.hpp"
+#include "rclcpp/message_info.hpp"
 #include "rclcpp/serialized_message.hpp"
 #include "rclcpp/subscription_options.hpp"
 #include "rcl/types.h"
@@ -98,6 +101,41 @@ struct has_message_type : extract_message_type<
     typename rclcpp::function_traits::function_traits<CallbackT>::template argument_type<0>>
 {};
 
+template<typename ArgumentT, typename ROSMessageT>
+struct is_direct_callback_message_argument : std::integral_constant<
+    bool,
+    std::is_same<ArgumentT, const ROSMessageT &>::value ||
+    ((!std::is_lvalue_reference<ArgumentT>::value ||
+    std::is_const<std::remove_reference_t<ArgumentT>>::value) &&
+    (std::is_same<std::decay_t<ArgumentT>, std::shared_ptr<const ROSMessageT>>::value ||
+    std::is_same<std::decay_t<ArgumentT>, std::shared_ptr<ROSMessageT>>::value))>
+{};
+
+/// Tell if a subscription may call the callback directly rather than through the variant.
+/**
+ * Callbacks taking the message by constant reference or by shared pointer,
+ * with or without its information, can be called with the message taken
+ * from the middleware as it is.
+ */
+template<
+  typename CallbackT,
+  typename ROSMessageT,
+  typename ArgumentsT =
+  typename rclcpp::function_traits::function_traits<std::decay_t<CallbackT>>::arguments>
+struct is_direct_callback : std::false_type
+{};
+
+template<typename CallbackT, typename ROSMessageT, typename MessageArgumentT>
+struct is_direct_callback<CallbackT, ROSMessageT, std::tuple<MessageArgumentT>>
+  : is_direct_callback_message_argument<MessageArgumentT, ROSMessageT>
+{};
+
+template<typename CallbackT, typename ROSMessageT, typename MessageArgumentT>
+struct is_direct_callback<
+  CallbackT, ROSMessageT, std::tuple<MessageArgumentT, const rclcpp::MessageInfo &>>
+  : is_direct_callback_message_argument<MessageArgumentT, ROSMessageT>
+{};
+
 }  // namespace subscription_traits
 }  // namespace rclcpp
 
@@ -0,0 +1,362 @@
+// Copyright 2021 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef RCLCPP__SYNCHRONIZED_SUBSCRIPTION_HPP_
+#define RCLCPP__SYNCHRONIZED_SUBSCRIPTION_HPP_
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <tuple>
+#include <utility>
+
+#include "rcl/wait.h"
+
+#include "rclcpp/context.hpp"
+#include "rclcpp/guard_condition.hpp"
+#include "rclcpp/macros.hpp"
+#include "rclcpp/subscription_base.hpp"
+#include "rclcpp/subscription_options.hpp"
+#include "rclcpp/waitable.hpp"
+
+namespace rclcpp
+{
+
+/// How the stamps of the messages of a set delivered by a SynchronizedSubscription match.
+enum class SynchronizationPolicy
+{
+  /// The messages of a set have the same stamp.
+  ExactTime,
+  /// The stamps of the messages of a set differ by at most a maximum interval.
+  ApproximateTime
+};
+
+/// Options of a SynchronizedSubscription.
+struct SynchronizedSubscriptionOptions
+{
+  /// How the stamps of the messages of a set match.
+  SynchronizationPolicy policy = SynchronizationPolicy::ExactTime;
+
+  /// Largest difference between the stamps of the messages of a set, with ApproximateTime.
+  std::chrono::nanoseconds max_interval{std::chrono::milliseconds(10)};
+
+  /// Number of messages of each topic kept while waiting for the other topics to match them.
+  /**
+   * It also bounds the number of matched sets waiting for the executor, the oldest ones being
+   * dropped.
+   */
+  size_t queue_size = 10;
+
+  /// Options of the subscriptions of the topics.
+  /**
+   * Their callback group is also the one of the synchronized subscription, and
+   * deliver_intra_process_inline is set, so that intraprocess messages are matched in the
+   * publishing thread without being buffered by the subscriptions.
+   */
+  rclcpp::SubscriptionOptions subscription_options;
+};
+
+/// Return the stamp a SynchronizedSubscription matches a message on, in nanoseconds.
+/**
+ * By default the stamp of the header of the message.
+ * Specialize it for messages without a header or stamped otherwise.
+ */
+template<typename MessageT>
+struct MessageStampTraits
+{
+  static int64_t
+  nanoseconds(const MessageT & message)
+  {
+    return static_cast<int64_t>(message.header.stamp.sec) * 1000000000LL +
+           static_cast<int64_t>(message.header.stamp.nanosec);
+  }
+};
+
+/// Waitable giving a callback the sets of messages of several topics with matching stamps.
+/**
+ * The subscriptions of the topics give their messages to this waitable as shared pointers,
+ * so that the messages are not copied, and each message is matched against the messages of the
+ * other topics as soon as it is received.
+ * Intraprocess messages are delivered inline, see
+ * SubscriptionOptionsBase::deliver_intra_process_inline, so that they are matched in the
+ * publishing thread, without waking up the executor for each topic.
+ * A guard condition wakes up the executor once a set matches, and the callback is called with
+ * the set in the callback group of the subscriptions, one set per execution.
+ *
+ * The messages of each topic are expected with increasing stamps.
+ * A message which can no longer match, as the messages of another topic are all newer than it
+ * can match, is dropped.
+ *
+ * Use rclcpp::create_synchronized_subscription() to create one and subscribe to the topics.
+ *
+ * \tparam MessageTs types of the messages of each topic, whose stamps are given by
+ *   MessageStampTraits.
+ */
+template<typename ... MessageTs>
+class SynchronizedSubscription : public rclcpp::Waitable
+{
+  static_assert(sizeof...(MessageTs) >= 2, "at least two topics must be synchronized");
+
+public:
+  RCLCPP_SMART_PTR_DEFINITIONS_NOT_COPYABLE(SynchronizedSubscription)
+
+  /// Number of synchronized topics.
+  static constexpr size_t number_of_topics = sizeof...(MessageTs);
+
+  /// A set of matched messages, one per topic.
+  using MessageSet = std::tuple<std::shared_ptr<const MessageTs>...>;
+
+  /// Type of the messages of the topic of index I.
+  template<size_t I>
+  using MessageType = std::tuple_element_t<I, std::tuple<MessageTs...>>;
+
+  using CallbackType = std::function<void (const std::shared_ptr<const MessageTs> &...)>;
+
+  /// Constructor, which does not subscribe to the topics.
+  /**
+   * \param[in] context context of the guard condition waking up the executor.
+   * \param[in] callback called with each matched set.
+   * \param[in] options policy and sizes of the queues.
+   * \throws std::invalid_argument if callback is empty, the queue size is 0 or the maximum
+   *   interval is negative.
+   */
+  SynchronizedSubscription(
+    rclcpp::Context::SharedPtr context,
+    CallbackType callback,
+    const SynchronizedSubscriptionOptions & options)
+  : guard_condition_(std::move(context)),
+    callback_(std::move(callback)),
+    queue_size_(options.queue_size),
+    max_interval_(
+      options.policy == SynchronizationPolicy::ExactTime ? 0 : options.max_interval.count())
+  {
+    if (!callback_) {
+      throw std::invalid_argument("callback cannot be empty");
+    }
+    if (0 == queue_size_) {
+      throw std::invalid_argument("queue_size must be a positive, non-zero value");
+    }
+    if (max_interval_ < 0) {
+      throw std::invalid_argument("max_interval must not be negative");
+    }
+  }
+
+  ~SynchronizedSubscription() override = default;
+
+  size_t
+  get_number_of_ready_guard_conditions() override
+  {
+    return 1;
+  }
+
+  bool
+  add_to_wait_set(rcl_wait_set_t * wait_set) override
+  {
+    rcl_ret_t ret = rcl_wait_set_add_guard_condition(
+      wait_set, &guard_condition_.get_rcl_guard_condition(), NULL);
+    return RCL_RET_OK == ret;
+  }
+
+  /// Return true if a matched set waits for the callback.
+  bool
+  is_ready(rcl_wait_set_t * wait_set) override
+  {
+    (void)wait_set;
+    std::lock_guard<std::mutex> lock(mutex_);
+    return !matched_sets_.empty();
+  }
+
+  /// Take the oldest matched set, or nullptr if there is none.
+  std::shared_ptr<void>
+  take_data() override
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (matched_sets_.empty()) {
+      return nullptr;
+    }
+    auto message_set = std::make_shared<MessageSet>(std::move(matched_sets_.front()));
+    matched_sets_.pop_front();
+    const bool has_more_sets = !matched_sets_.empty();
+    lock.unlock();
+    if (has_more_sets) {
+      // Wake up the executor again for the next set.
+      guard_condition_.trigger();
+    }
+    return message_set;
+  }
+
+  /// Call the callback with the set taken.
+  void
+  execute(std::shared_ptr<void> & data) override
+  {
+    if (!data) {
+      return;
+    }
+    auto message_set = std::static_pointer_cast<MessageSet>(data);
+    std::apply(callback_, *message_set);
+  }
+
+  /// Match a message of the topic of index I against the messages of the other topics.
+  /**
+   * Called by the subscriptions of the topics, in the thread delivering the message.
+   * This member function is thread-safe.
+   */
+  template<size_t I>
+  void
+  add_message(std::shared_ptr<const MessageType<I>> message)
+  {
+    using MessageT = MessageType<I>;
+    if (!message) {
+      return;
+    }
+    bool matched = false;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      auto & queue = std::get<I>(queues_);
+      if (queue.size() == queue_size_) {
+        queue.pop_front();
+        ++dropped_message_count_;
+      }
+      // Messages usually arrive in order, and are then appended.
+      const int64_t stamp = MessageStampTraits<MessageT>::nanoseconds(*message);
+      auto position = queue.end();
+      while (position != queue.begin() &&
+        MessageStampTraits<MessageT>::nanoseconds(**std::prev(position)) > stamp)
+      {
+        --position;
+      }
+      queue.insert(position, std::move(message));
+      matched = match_();
+    }
+    if (matched) {
+      guard_condition_.trigger();
+    }
+  }
+
+  /// Return the number of messages dropped without being part of a matched set.
+  uint64_t
+  get_dropped_message_count() const
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return dropped_message_count_;
+  }
+
+  /// Keep the subscriptions of the topics alive as long as this waitable.
+  void
+  set_subscriptions(std::array<rclcpp::SubscriptionBase::SharedPtr, number_of_topics> subscriptions)
+  {
+    subscriptions_ = std::move(subscriptions);
+  }
+
+  /// Return the subscriptions of the topics, by topic index.
+  const std::array<rclcpp::SubscriptionBase::SharedPtr, number_of_topics> &
+  get_subscriptions() const
+  {
+    return subscriptions_;
+  }
+
+private:
+  /// Call f with the index of each topic, as an std::integral_constant.
+  template<typename FunctionT>
+  static void
+  for_each_topic_(FunctionT && f)
+  {
+    for_each_topic_impl_(std::forward<FunctionT>(f), std::index_sequence_for<MessageTs...>{});
+  }
+
+  template<typename FunctionT, size_t ... Is>
+  static void
+  for_each_topic_impl_(FunctionT && f, std::index_sequence<Is...>)
+  {
+    (f(std::integral_constant<size_t, Is>{}), ...);
+  }
+
+  /// Move the sets which match from the queues to the matched sets, return true if any did.
+  /**
+   * This member function is not thread-safe.
+   */
+  bool
+  match_()
+  {
+    bool matched = false;
+    while (true) {
+      bool has_empty_queue = false;
+      for_each_topic_([this, &has_empty_queue](auto index) {
+          has_empty_queue = has_empty_queue || std::get<index>(queues_).empty();
+        });
+      if (has_empty_queue) {
+        return matched;
+      }
+
+      std::array<int64_t, number_of_topics> stamps;
+      for_each_topic_([this, &stamps](auto index) {
+          using MessageT = MessageType<index>;
+          stamps[index] = MessageStampTraits<MessageT>::nanoseconds(
+            *std::get<index>(queues_).front());
+        });
+      const auto oldest = std::min_element(stamps.begin(), stamps.end());
+      const int64_t newest_stamp = *std::max_element(stamps.begin(), stamps.end());
+
+      if (newest_stamp - *oldest > max_interval_) {
+        // The other topics have no older message left, the oldest one can no longer match.
+        const size_t oldest_index = static_cast<size_t>(oldest - stamps.begin());
+        for_each_topic_([this, oldest_index](auto index) {
+            if (index == oldest_index) {
+              std::get<index>(queues_).pop_front();
+            }
+          });
+        ++dropped_message_count_;
+        continue;
+      }
+
+      if (matched_sets_.size() == queue_size_) {
+        matched_sets_.pop_front();
+        dropped_message_count_ += number_of_topics;
+      }
+      matched_sets_.emplace_back();
+      MessageSet & message_set = matched_sets_.back();
+      for_each_topic_([this, &message_set](auto index) {
+          auto & queue = std::get<index>(queues_);
+          std::get<index>(message_set) = std::move(queue.front());
+          queue.pop_front();
+        });
+      matched = true;
+    }
+  }
+
+  rclcpp::GuardCondition guard_condition_;
+  CallbackType callback_;
+  const size_t queue_size_;
+  const int64_t max_interval_;
+
+  mutable std::mutex mutex_;
+  std::tuple<std::deque<std::shared_ptr<const MessageTs>>...> queues_;
+  std::deque<MessageSet> matched_sets_;
+  uint64_t dropped_message_count_ = 0;
+
+  std::array<rclcpp::SubscriptionBase::SharedPtr, number_of_topics> subscriptions_;
+};
+
+}  // namespace rclcpp
+
+#endif  // RCLCPP__SYNCHRONIZED_SUBSCRIPTION_HPP_
@@ -0,0 +1,112 @@
+// Copyright 2021 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__THREAD_ATTRIBUTES_HPP_
+#define RCLCPP__THREAD_ATTRIBUTES_HPP_
+
+#include <cstddef>
+#include <vector>
+
+#include "rclcpp/macros.hpp"
+#include "rclcpp/visibility_control.hpp"
+
+namespace rclcpp
+{
+
+/// Scheduling policy of a thread.
+enum class ThreadSchedulingPolicy
+{
+  /// Keep the policy and priority the thread already has.
+  Inherit,
+  /// The default time-sharing policy, SCHED_OTHER.
+  Other,
+  /// Real-time first in, first out policy, SCHED_FIFO.
+  Fifo,
+  /// Real-time round-robin policy, SCHED_RR.
+  RoundRobin
+};
+
+/// Scheduling attributes of a thread running an executor.
+/**
+ * The default attributes leave the thread as it is.
+ */
+struct ThreadAttributes
+{
+  /// Indices of the CPUs the thread may run on, empty to keep the current affinity.
+  std::vector<size_t> cpu_affinity;
+  /// Scheduling policy of the thread.
+  ThreadSchedulingPolicy scheduling_policy = ThreadSchedulingPolicy::Inherit;
+  /// Priority of the thread, only used by the Fifo and RoundRobin policies.
+  int priority = 0;
+
+  /// Return true if applying these attributes leaves the thread as it is.
+  RCLCPP_PUBLIC
+  bool
+  is_default() const;
+};
+
+/// Apply scheduling attributes to the calling thread.
+/**
+ * CPU affinity is only supported on Linux and scheduling policies on POSIX systems.
+ * Real-time policies usually require privileges, such as CAP_SYS_NICE or an RLIMIT_RTPRIO limit.
+ *
+ * \param[in] attributes the attributes to apply, nothing is done if they are the default ones.
+ * \throws std::system_error if the attributes could not be applied.
+ * \throws std::runtime_error if the attributes are not supported on this platform.
+ */
+RCLCPP_PUBLIC
+void
+apply_thread_attributes(const ThreadAttributes & attributes);
+
+/// Return the scheduling attributes of the calling thread.
+/**
+ * The CPU affinity is left empty on platforms which do not support it, and the scheduling
+ * policy is Inherit when it is not one of the policies of ThreadSchedulingPolicy.
+ *
+ * \throws std::system_error if the attributes could not be read.
+ */
+RCLCPP_PUBLIC
+ThreadAttributes
+get_thread_attributes();
+
+/// Apply scheduling attributes to the calling thread for the lifetime of this object.
+/**
+ * The previous attributes of the thread are restored on destruction.
+ * Nothing is done if the attributes are the default ones.
+ */
+class ScopedThreadAttributes
+{
+public:
+  /// Apply the attributes to the calling thread.
+  /**
+   * \throws std::system_error if the attributes could not be applied.
+   * \throws std::runtime_error if the attributes are not supported on this platform.
+   */
+  RCLCPP_PUBLIC
+  explicit ScopedThreadAttributes(const ThreadAttributes & attributes);
+
+  /// Restore the attributes the thread had, errors are logged.
+  RCLCPP_PUBLIC
+  ~ScopedThreadAttributes();
+
+private:
+  RCLCPP_DISABLE_COPY(ScopedThreadAttributes)
+
+  bool applied_ = false;
+  ThreadAttributes previous_attributes_;
+};
+
+}  // namespace rclcpp
+
+#endif  // RCLCPP__THREAD_ATTRIBUTES_HPP_
@@ -15,6 +15,8 @@
 #ifndef RCLCPP__TIME_HPP_
 #define RCLCPP__TIME_HPP_
 
+#include <cstddef>
+
 #include "builtin_interfaces/msg/time.hpp"
 
 #include "rclcpp/visibility_control.hpp"
@@ -222,6 +224,39 @@ RCLCPP_PUBLIC
 Time
 operator+(const rclcpp::Duration & lhs, const rclcpp::Time & rhs);
 
+/// Convert time stamps to nanoseconds since the epoch, like rclcpp::Time(stamp).nanoseconds().
+/**
+ * Bulk version of the conversion, for arrays of stamps.
+ * All the stamps are converted before checking them, so that the loop has no
+ * branch and can be vectorized by the compiler.
+ *
+ * \param[in] stamps the stamps to convert.
+ * \param[in] count the number of stamps.
+ * \param[out] nanoseconds array of count values receiving the result.
+ * \throws std::runtime_error if the seconds of a stamp are negative, after the conversion.
+ */
+RCLCPP_PUBLIC
+void
+stamps_to_nanoseconds(
+  const builtin_interfaces::msg::Time * stamps,
+  size_t count,
+  rcl_time_point_value_t * nanoseconds);
+
+/// Convert nanoseconds since the epoch to time stamps, like rclcpp::Time's conversion operator.
+/**
+ * Bulk version of the conversion, for arrays of stamps, without branches.
+ *
+ * \param[in] nanoseconds the times to convert.
+ * \param[in] count the number of times.
+ * \param[out] stamps array of count stamps receiving the result.
+ */
+RCLCPP_PUBLIC
+void
+nanoseconds_to_stamps(
+  const rcl_time_point_value_t * nanoseconds,
+  size_t count,
+  builtin_interfaces::msg::Time * stamps);
+
 }  // namespace rclcpp
 
 #endif  // RCLCPP__TIME_HPP_
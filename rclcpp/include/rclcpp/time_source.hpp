@@ -15,6 +15,7 @@
 #ifndef RCLCPP__TIME_SOURCE_HPP_
 #define RCLCPP__TIME_SOURCE_HPP_
 
+#include <cstdint>
 #include <memory>
 #include <vector>
 
@@ -33,6 +34,11 @@ namespace rclcpp
 {
 class Clock;
 
+namespace detail
+{
+class ClockDistributor;
+}  // namespace detail
+
 /**
  * Time source that will drive the attached clocks.
  *
@@ -46,6 +52,10 @@ class Clock;
  * - qos_overrides./clock.durability
  * - qos_overrides./clock.history
  * - qos_overrides./clock.reliability
+ *
+ * If use_shared_clock_subscription is true, the time source gets the clock
+ * messages from a subscription shared by all the time sources of the context
+ * doing so, see rclcpp::NodeOptions::use_shared_clock_subscription().
  */
 class TimeSource
 {
@@ -56,23 +66,29 @@ public:
    *
    * \param node std::shared pointer to a initialized node
    * \param qos QoS that will be used when creating a `/clock` subscription.
+   * \param use_clock_thread whether a dedicated thread spins the `/clock` subscription.
+   * \param use_shared_clock_subscription whether the `/clock` subscription of the context is used.
    */
   RCLCPP_PUBLIC
   explicit TimeSource(
     rclcpp::Node::SharedPtr node,
     const rclcpp::QoS & qos = rclcpp::ClockQoS(),
-    bool use_clock_thread = true);
+    bool use_clock_thread = true,
+    bool use_shared_clock_subscription = false);
 
   /// Empty constructor
   /**
    * An Empty TimeSource class
    *
    * \param qos QoS that will be used when creating a `/clock` subscription.
+   * \param use_clock_thread whether a dedicated thread spins the `/clock` subscription.
+   * \param use_shared_clock_subscription whether the `/clock` subscription of the context is used.
    */
   RCLCPP_PUBLIC
   explicit TimeSource(
     const rclcpp::QoS & qos = rclcpp::ClockQoS(),
-    bool use_clock_thread = true);
+    bool use_clock_thread = true,
+    bool use_shared_clock_subscription = false);
 
   /// Attach node to the time source.
   /**
@@ -129,6 +145,9 @@ protected:
   bool use_clock_thread_;
   std::thread clock_executor_thread_;
 
+  // Whether the clock subscription of the context is used instead of an own one.
+  bool use_shared_clock_subscription_;
+
 private:
   // Preserve the node reference
   rclcpp::node_interfaces::NodeBaseInterface::SharedPtr node_base_;
@@ -154,6 +173,9 @@ private:
   rclcpp::CallbackGroup::SharedPtr clock_callback_group_;
   rclcpp::executors::SingleThreadedExecutor::SharedPtr clock_executor_;
   std::promise<void> cancel_clock_executor_promise_;
+  // The shared clock subscription, and the id of clock_cb in it, if attached to it.
+  std::shared_ptr<detail::ClockDistributor> clock_distributor_;
+  uint64_t clock_distributor_id_{0};
 
   // The clock callback itself
   void clock_cb(std::shared_ptr<const rosgraph_msgs::msg::Clock> msg);
@@ -182,10 +204,14 @@ private:
   void disable_ros_time();
 
   // Internal helper functions used inside iterators
+  // The time is given in nanoseconds, so that updating the clocks allocates nothing.
   static void set_clock(
-    const builtin_interfaces::msg::Time::SharedPtr msg,
+    rcl_time_point_value_t nanoseconds,
     bool set_ros_time_enabled,
-    rclcpp::Clock::SharedPtr clock);
+    const rclcpp::Clock::SharedPtr & clock);
+
+  // Time of the last set message in nanoseconds, or zero if none was received
+  rcl_time_point_value_t last_msg_nanoseconds() const;
 
   // Local storage of validity of ROS time
   // This is needed when new clocks are added.
@@ -17,8 +17,10 @@
 
 #include <atomic>
 #include <chrono>
+#include <cstdint>
 #include <functional>
 #include <memory>
+#include <mutex>
 #include <sstream>
 #include <thread>
 #include <type_traits>
@@ -29,6 +31,7 @@
 #include "rclcpp/function_traits.hpp"
 #include "rclcpp/macros.hpp"
 #include "rclcpp/rate.hpp"
+#include "rclcpp/timer_statistics.hpp"
 #include "rclcpp/utilities.hpp"
 #include "rclcpp/visibility_control.hpp"
 #include "tracetools/tracetools.h"
@@ -43,6 +46,33 @@
 namespace rclcpp
 {
 
+/// Current times of the steady and the system clocks, each read at most once.
+/**
+ * Checking the timers ready after a wakeup against a single snapshot, with
+ * TimerBase::is_ready(TimerClockSnapshot &), reads each clock once instead of
+ * once per timer.
+ */
+class TimerClockSnapshot
+{
+public:
+  /// Return the current time of a steady or system clock, read on the first call for it.
+  /**
+   * \param[in] clock_type RCL_STEADY_TIME or RCL_SYSTEM_TIME.
+   * \return the time, in nanoseconds since the epoch of the clock.
+   * \throws std::invalid_argument for the other clock types.
+   * \throws std::runtime_error if the clock could not be read.
+   */
+  RCLCPP_PUBLIC
+  int64_t
+  now(rcl_clock_type_t clock_type);
+
+private:
+  int64_t steady_time_ = 0;
+  int64_t system_time_ = 0;
+  bool has_steady_time_ = false;
+  bool has_system_time_ = false;
+};
+
 class TimerBase
 {
 public:
@@ -53,12 +83,15 @@ public:
    * \param clock A clock to use for time and sleeping
    * \param period The interval at which the timer fires
    * \param context node context
+   * \param slack how late the timer may fire so that its expiration is coalesced with others
+   * \throws std::invalid_argument if slack is negative
    */
   RCLCPP_PUBLIC
   explicit TimerBase(
     Clock::SharedPtr clock,
     std::chrono::nanoseconds period,
-    rclcpp::Context::SharedPtr context);
+    rclcpp::Context::SharedPtr context,
+    std::chrono::nanoseconds slack = std::chrono::nanoseconds(0));
 
   /// TimerBase destructor
   RCLCPP_PUBLIC
@@ -120,6 +153,17 @@ public:
   std::chrono::nanoseconds
   time_until_trigger();
 
+  /// Return how late the timer may fire so that its expiration is coalesced with others.
+  /**
+   * Within the slack, a timer may be called together with other timers in a
+   * single wakeup instead of waking the process up on its own.
+   * Only executors which run their timers with an rclcpp::experimental::TimersManager
+   * make use of it, the others call the timer as soon as it is ready.
+   */
+  RCLCPP_PUBLIC
+  std::chrono::nanoseconds
+  get_slack() const;
+
   /// Is the clock steady (i.e. is the time between ticks constant?)
   /** \return True if the clock used by this timer is steady. */
   virtual bool is_steady() = 0;
@@ -134,6 +178,22 @@ public:
   RCLCPP_PUBLIC
   bool is_ready();
 
+  /// Check if the timer is ready to trigger the callback, against a snapshot of the time.
+  /**
+   * rclcpp keeps a lower bound of the next call time of the timers using the
+   * steady or the system time, advanced by call() and dropped by reset(), so
+   * that a timer which is not due by it is known not to be ready without
+   * reading the clock nor the rcl timer.
+   * A timer which is due by it, or uses the ROS time, is checked as by is_ready().
+   * Like is_ready(), it expects its caller to immediately trigger the callback.
+   *
+   * \param[in] snapshot the current time, shared by the checks of the timers of a wakeup.
+   * \return True if the timer needs to trigger.
+   * \throws std::runtime_error if it failed to check timer
+   */
+  RCLCPP_PUBLIC
+  bool is_ready(TimerClockSnapshot & snapshot);
+
   /// Exchange the "in use by wait set" state for this timer.
   /**
    * This is used to ensure this timer is not used by multiple
@@ -148,11 +208,64 @@ public:
   bool
   exchange_in_use_by_wait_set_state(bool in_use_state);
 
+  /// Start collecting statistics about the calls of this timer.
+  /**
+   * Once enabled, every call records how late the timer was called and how
+   * many periods it missed, and every execution of the callback records how
+   * long it took.
+   * Collecting statistics cannot be disabled, calling this again returns the
+   * same statistics.
+   *
+   * \return the statistics of the timer.
+   */
+  RCLCPP_PUBLIC
+  TimerStatistics::SharedPtr
+  enable_statistics();
+
+  /// Return the statistics of this timer, nullptr if enable_statistics() was not called.
+  RCLCPP_PUBLIC
+  TimerStatistics::SharedPtr
+  get_statistics() const;
+
 protected:
+  /// Notify the rcl timer that the callback is about to be executed.
+  /**
+   * This advances the next call time kept for is_ready(TimerClockSnapshot &).
+   *
+   * \return `true` if the callback should be executed, `false` if the timer was canceled.
+   * \throws std::runtime_error if the rcl timer could not be notified.
+   */
+  RCLCPP_PUBLIC
+  bool
+  call_timer_handle();
+
+  /// Record the lateness of the call which is about to be made.
+  RCLCPP_PUBLIC
+  void
+  record_call_statistics(TimerStatistics & statistics);
+
   Clock::SharedPtr clock_;
   std::shared_ptr<rcl_timer_t> timer_handle_;
+  const std::chrono::nanoseconds slack_;
 
   std::atomic<bool> in_use_by_wait_set_{false};
+
+  /// Statistics of the timer if enabled, owned by statistics_owner_.
+  std::atomic<TimerStatistics *> statistics_{nullptr};
+
+private:
+  mutable std::mutex statistics_mutex_;
+  TimerStatistics::SharedPtr statistics_owner_;
+
+  /// Wakes the wait sets up when an update of the ROS time makes the timer ready.
+  JumpHandler::SharedPtr clock_jump_handler_;
+
+  /// True if the clock is the steady or the system time, whose next call time is kept.
+  bool keeps_next_call_time_ = false;
+  /// Lower bound of the next call time in the time of the clock, 0 if unknown.
+  std::atomic<int64_t> next_call_time_{0};
+  /// Orders the updates of next_call_time_ with the changes of the rcl timer.
+  std::mutex next_call_time_mutex_;
 };
 
 
@@ -178,12 +291,14 @@ public:
    * \param[in] period The interval at which the timer fires.
    * \param[in] callback User-specified callback function.
    * \param[in] context custom context to be used.
+   * \param[in] slack how late the timer may fire, see TimerBase::get_slack().
    */
   explicit GenericTimer(
     Clock::SharedPtr clock, std::chrono::nanoseconds period, FunctorT && callback,
-    rclcpp::Context::SharedPtr context
+    rclcpp::Context::SharedPtr context,
+    std::chrono::nanoseconds slack = std::chrono::nanoseconds(0)
   )
-  : TimerBase(clock, period, context), callback_(std::forward<FunctorT>(callback))
+  : TimerBase(clock, period, context, slack), callback_(std::forward<FunctorT>(callback))
   {
     TRACEPOINT(
       rclcpp_timer_callback_added,
@@ -209,14 +324,11 @@ public:
   bool
   call() override
   {
-    rcl_ret_t ret = rcl_timer_call(timer_handle_.get());
-    if (ret == RCL_RET_TIMER_CANCELED) {
-      return false;
+    TimerStatistics * statistics = statistics_.load(std::memory_order_acquire);
+    if (statistics) {
+      record_call_statistics(*statistics);
     }
-    if (ret != RCL_RET_OK) {
-      throw std::runtime_error("Failed to notify timer that callback occurred");
-    }
-    return true;
+    return call_timer_handle();
   }
 
   /**
@@ -225,9 +337,15 @@ public:
   void
   execute_callback() override
   {
+    TimerStatistics * statistics = statistics_.load(std::memory_order_acquire);
+    const auto start = statistics ?
+      std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point();
     TRACEPOINT(callback_start, static_cast<const void *>(&callback_), false);
     execute_callback_delegate<>();
     TRACEPOINT(callback_end, static_cast<const void *>(&callback_));
+    if (statistics) {
+      statistics->record_callback_duration(std::chrono::steady_clock::now() - start);
+    }
   }
 
   // void specialization
@@ -286,13 +404,15 @@ public:
    * \param period The interval at which the timer fires
    * \param callback The callback function to execute every interval
    * \param context node context
+   * \param slack how late the timer may fire, see TimerBase::get_slack()
    */
   WallTimer(
     std::chrono::nanoseconds period,
     FunctorT && callback,
-    rclcpp::Context::SharedPtr context)
+    rclcpp::Context::SharedPtr context,
+    std::chrono::nanoseconds slack = std::chrono::nanoseconds(0))
   : GenericTimer<FunctorT>(
-      std::make_shared<Clock>(RCL_STEADY_TIME), period, std::move(callback), context)
+      std::make_shared<Clock>(RCL_STEADY_TIME), period, std::move(callback), context, slack)
   {}
 
 protected:
@@ -0,0 +1,92 @@
+// Copyright 2021 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__TIMER_STATISTICS_HPP_
+#define RCLCPP__TIMER_STATISTICS_HPP_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+#include "rclcpp/duration_histogram.hpp"
+#include "rclcpp/macros.hpp"
+#include "rclcpp/visibility_control.hpp"
+
+namespace rclcpp
+{
+
+/// Statistics about how late a timer is called and how long its callback takes.
+/**
+ * Statistics are only collected for timers on which
+ * rclcpp::TimerBase::enable_statistics() was called.
+ * They are recorded from the threads executing the timer without locking,
+ * and can be read or reset at any time from any thread.
+ */
+class TimerStatistics
+{
+public:
+  RCLCPP_SMART_PTR_DEFINITIONS_NOT_COPYABLE(TimerStatistics)
+
+  RCLCPP_PUBLIC
+  TimerStatistics() = default;
+
+  /// Record a call of the timer.
+  /**
+   * \param[in] wakeup_latency how long after its scheduled time the timer was called.
+   * \param[in] missed_periods number of whole periods which elapsed without a call.
+   */
+  RCLCPP_PUBLIC
+  void
+  record_call(std::chrono::nanoseconds wakeup_latency, uint64_t missed_periods);
+
+  /// Record how long an execution of the callback of the timer took.
+  RCLCPP_PUBLIC
+  void
+  record_callback_duration(std::chrono::nanoseconds duration);
+
+  /// Return the histogram of the delays between the scheduled and the actual calls.
+  RCLCPP_PUBLIC
+  DurationHistogram::Snapshot
+  get_wakeup_latency() const;
+
+  /// Return the histogram of the durations of the callback.
+  RCLCPP_PUBLIC
+  DurationHistogram::Snapshot
+  get_callback_duration() const;
+
+  /// Return the total number of periods which elapsed without a call.
+  RCLCPP_PUBLIC
+  uint64_t
+  get_missed_periods() const;
+
+  /// Return the largest number of periods missed before a single call.
+  RCLCPP_PUBLIC
+  uint64_t
+  get_max_missed_periods() const;
+
+  /// Drop all the collected statistics.
+  RCLCPP_PUBLIC
+  void
+  reset();
+
+private:
+  DurationHistogram wakeup_latency_;
+  DurationHistogram callback_duration_;
+  std::atomic<uint64_t> missed_periods_{0};
+  std::atomic<uint64_t> max_missed_periods_{0};
+};
+
+}  // namespace rclcpp
+
+#endif  // RCLCPP__TIMER_STATISTICS_HPP_
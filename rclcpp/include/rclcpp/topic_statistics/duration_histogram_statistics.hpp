@@ -0,0 +1,81 @@
+// Copyright 2021 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__TOPIC_STATISTICS__DURATION_HISTOGRAM_STATISTICS_HPP_
+#define RCLCPP__TOPIC_STATISTICS__DURATION_HISTOGRAM_STATISTICS_HPP_
+
+#include <string>
+
+#include "libstatistics_collector/collector/generate_statistics_message.hpp"
+#include "libstatistics_collector/moving_average_statistics/types.hpp"
+#include "libstatistics_collector/topic_statistics_collector/constants.hpp"
+
+#include "rclcpp/duration_histogram.hpp"
+#include "rclcpp/time.hpp"
+
+#include "statistics_msgs/msg/metrics_message.hpp"
+
+namespace rclcpp
+{
+namespace topic_statistics
+{
+
+using libstatistics_collector::collector::GenerateStatisticMessage;
+using statistics_msgs::msg::MetricsMessage;
+using libstatistics_collector::moving_average_statistics::StatisticData;
+
+/// Convert a histogram of durations to statistics in milliseconds.
+inline
+StatisticData
+to_milliseconds(const rclcpp::DurationHistogram::Snapshot & snapshot)
+{
+  constexpr double nanoseconds_per_millisecond = 1e6;
+  StatisticData data;
+  data.sample_count = snapshot.count;
+  if (snapshot.count > 0u) {
+    data.average = snapshot.mean / nanoseconds_per_millisecond;
+    data.min = static_cast<double>(snapshot.min.count()) / nanoseconds_per_millisecond;
+    data.max = static_cast<double>(snapshot.max.count()) / nanoseconds_per_millisecond;
+    data.standard_deviation = snapshot.standard_deviation / nanoseconds_per_millisecond;
+  }
+  return data;
+}
+
+/// Generate the statistics message of a histogram of durations, in milliseconds.
+/**
+ * \param source_name the measurement source of the message, like the name of a node
+ * \param metric_name the name of the measured durations
+ * \param window_start the start of the window the durations were recorded in
+ * \param window_stop the end of the window the durations were recorded in
+ * \param snapshot the content of the histogram
+ */
+inline
+MetricsMessage
+generate_duration_statistic_message(
+  const std::string & source_name,
+  const std::string & metric_name,
+  const rclcpp::Time & window_start,
+  const rclcpp::Time & window_stop,
+  const rclcpp::DurationHistogram::Snapshot & snapshot)
+{
+  return GenerateStatisticMessage(
+    source_name, metric_name,
+    libstatistics_collector::topic_statistics_collector::kMillisecondUnitName,
+    window_start, window_stop, to_milliseconds(snapshot));
+}
+
+}  // namespace topic_statistics
+}  // namespace rclcpp
+
+#endif  // RCLCPP__TOPIC_STATISTICS__DURATION_HISTOGRAM_STATISTICS_HPP_
@@ -0,0 +1,217 @@
+// Copyright 2021 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__TOPIC_STATISTICS__EXECUTOR_TOPIC_STATISTICS_HPP_
+#define RCLCPP__TOPIC_STATISTICS__EXECUTOR_TOPIC_STATISTICS_HPP_
+
+#include <chrono>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#include "libstatistics_collector/collector/generate_statistics_message.hpp"
+
+#include "rclcpp/executor.hpp"
+#include "rclcpp/executor_statistics.hpp"
+#include "rclcpp/publisher.hpp"
+#include "rclcpp/qos.hpp"
+#include "rclcpp/time.hpp"
+#include "rclcpp/timer.hpp"
+#include "rclcpp/topic_statistics/duration_histogram_statistics.hpp"
+#include "rclcpp/topic_statistics/subscription_topic_statistics.hpp"
+
+#include "statistics_msgs/msg/metrics_message.hpp"
+
+namespace rclcpp
+{
+namespace topic_statistics
+{
+
+constexpr const char kExecutorDispatchLatencyMetricName[]{"executor_dispatch_latency"};
+constexpr const char kExecutorExecutionDurationMetricName[]{"executor_execution_duration"};
+constexpr const char kExecutorQueueingDelayMetricName[]{"executor_queueing_delay"};
+constexpr const char kExecutorCpuTimeMetricName[]{"executor_cpu_time"};
+
+/**
+ * Class used to publish the statistics collected by an executor, see rclcpp::ExecutorStatistics.
+ * The dispatch latency and execution duration of all the executables are published in
+ * milliseconds, from the node, followed by the queueing delay of each callback group which
+ * was executed, from the callback group.
+ * If the CPU time of the executions is accounted, see
+ * rclcpp::ExecutorStatistics::enable_cpu_time_accounting(), the CPU time of each entity which
+ * was executed is published too, from the entity, without its standard deviation.
+ */
+class ExecutorTopicStatistics
+{
+public:
+  RCLCPP_SMART_PTR_DEFINITIONS_NOT_COPYABLE(ExecutorTopicStatistics)
+
+  /// Construct an ExecutorTopicStatistics object.
+  /**
+   * Collecting statistics is enabled on the executor.
+   *
+   * \param node_name the name of the node, used as the measurement source of the messages
+   * \param executor the executor to publish the statistics of
+   * \param publisher instance constructed by the node in order to publish statistics data.
+   * This class owns the publisher.
+   * \throws std::invalid_argument if the executor or publisher pointer is nullptr
+   */
+  ExecutorTopicStatistics(
+    const std::string & node_name,
+    rclcpp::Executor * executor,
+    rclcpp::Publisher<statistics_msgs::msg::MetricsMessage>::SharedPtr publisher)
+  : node_name_(node_name),
+    publisher_(std::move(publisher))
+  {
+    if (nullptr == executor) {
+      throw std::invalid_argument("executor pointer is nullptr");
+    }
+    if (nullptr == publisher_) {
+      throw std::invalid_argument("publisher pointer is nullptr");
+    }
+    statistics_ = executor->enable_statistics();
+    window_start_ = rclcpp::Time(get_current_nanoseconds_since_epoch());
+  }
+
+  virtual ~ExecutorTopicStatistics()
+  {
+    if (publisher_timer_) {
+      publisher_timer_->cancel();
+      publisher_timer_.reset();
+    }
+  }
+
+  /// Set the timer used to publish statistics messages.
+  /**
+   * \param publisher_timer the timer to fire the publisher, created by the node
+   */
+  void set_publisher_timer(rclcpp::TimerBase::SharedPtr publisher_timer)
+  {
+    publisher_timer_ = publisher_timer;
+  }
+
+  /// Publish the collected statistics and reset them.
+  virtual void publish_message_and_reset_measurements()
+  {
+    rclcpp::Time window_end{get_current_nanoseconds_since_epoch()};
+
+    const auto dispatch_latency = statistics_->get_dispatch_latency();
+    const auto execution_duration = statistics_->get_execution_duration();
+    const auto queueing_delays = statistics_->get_callback_group_queueing_delays();
+    const auto cpu_times = statistics_->get_entity_cpu_times();
+    statistics_->reset();
+
+    publisher_->publish(
+      generate_duration_statistic_message(
+        node_name_, kExecutorDispatchLatencyMetricName,
+        window_start_, window_end, dispatch_latency));
+    publisher_->publish(
+      generate_duration_statistic_message(
+        node_name_, kExecutorExecutionDurationMetricName,
+        window_start_, window_end, execution_duration));
+    for (const auto & group : queueing_delays) {
+      publisher_->publish(
+        generate_duration_statistic_message(
+          group.name, kExecutorQueueingDelayMetricName,
+          window_start_, window_end, group.queueing_delay));
+    }
+    for (const auto & entity : cpu_times) {
+      publisher_->publish(generate_cpu_time_statistic_message(entity, window_start_, window_end));
+    }
+    window_start_ = window_end;
+  }
+
+private:
+  /// Generate the statistics message of the CPU time of an entity, in milliseconds.
+  static MetricsMessage
+  generate_cpu_time_statistic_message(
+    const rclcpp::ExecutorStatistics::EntityCpuTime & cpu_time,
+    const rclcpp::Time & window_start,
+    const rclcpp::Time & window_stop)
+  {
+    constexpr double nanoseconds_per_millisecond = 1e6;
+    StatisticData data;
+    data.sample_count = cpu_time.executions;
+    data.average = static_cast<double>(cpu_time.total.count()) /
+      static_cast<double>(cpu_time.executions) / nanoseconds_per_millisecond;
+    data.min = static_cast<double>(cpu_time.min.count()) / nanoseconds_per_millisecond;
+    data.max = static_cast<double>(cpu_time.max.count()) / nanoseconds_per_millisecond;
+    return GenerateStatisticMessage(
+      cpu_time.name, kExecutorCpuTimeMetricName,
+      libstatistics_collector::topic_statistics_collector::kMillisecondUnitName,
+      window_start, window_stop, data);
+  }
+
+  /// Return the current nanoseconds (count) since epoch.
+  int64_t get_current_nanoseconds_since_epoch() const
+  {
+    const auto now = std::chrono::system_clock::now();
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(now.time_since_epoch()).count();
+  }
+
+  /// Node name used to generate topic statistics messages to be published
+  const std::string node_name_;
+  /// Statistics of the executor
+  rclcpp::ExecutorStatistics::SharedPtr statistics_;
+  /// Publisher, created by the node, used to publish topic statistics messages
+  rclcpp::Publisher<statistics_msgs::msg::MetricsMessage>::SharedPtr publisher_;
+  /// Timer which fires the publisher
+  rclcpp::TimerBase::SharedPtr publisher_timer_;
+  /// The start of the collection window, used in the published topic statistics message
+  rclcpp::Time window_start_;
+};
+
+/// Periodically publish the statistics of an executor.
+/**
+ * The statistics are published by the executor spinning the node, usually the
+ * executor measured itself.
+ *
+ * \param node the node which creates the publisher and the publishing timer
+ * \param executor the executor to publish the statistics of, it must outlive the returned object
+ * \param publish_period how often the statistics are published and reset
+ * \param topic_name the topic the statistics are published on
+ * \return the object publishing the statistics, publishing stops when it is destroyed
+ * \throws std::invalid_argument if the executor is nullptr
+ */
+template<typename NodeT>
+ExecutorTopicStatistics::SharedPtr
+create_executor_topic_statistics(
+  NodeT && node,
+  rclcpp::Executor * executor,
+  std::chrono::nanoseconds publish_period = kDefaultPublishingPeriod,
+  const std::string & topic_name = kDefaultPublishTopicName)
+{
+  auto publisher = node->template create_publisher<statistics_msgs::msg::MetricsMessage>(
+    topic_name, rclcpp::QoS(10));
+  auto executor_topic_stats = std::make_shared<ExecutorTopicStatistics>(
+    node->get_name(), executor, publisher);
+
+  std::weak_ptr<ExecutorTopicStatistics> weak_executor_topic_stats(executor_topic_stats);
+  auto publisher_timer = node->create_wall_timer(
+    publish_period,
+    [weak_executor_topic_stats]() {
+      auto executor_topic_stats = weak_executor_topic_stats.lock();
+      if (executor_topic_stats) {
+        executor_topic_stats->publish_message_and_reset_measurements();
+      }
+    });
+  executor_topic_stats->set_publisher_timer(publisher_timer);
+  return executor_topic_stats;
+}
+
+}  // namespace topic_statistics
+}  // namespace rclcpp
+
+#endif  // RCLCPP__TOPIC_STATISTICS__EXECUTOR_TOPIC_STATISTICS_HPP_
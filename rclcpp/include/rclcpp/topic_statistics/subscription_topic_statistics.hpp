@@ -15,7 +15,12 @@
 #ifndef RCLCPP__TOPIC_STATISTICS__SUBSCRIPTION_TOPIC_STATISTICS_HPP_
 #define RCLCPP__TOPIC_STATISTICS__SUBSCRIPTION_TOPIC_STATISTICS_HPP_
 
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
 #include <memory>
+#include <stdexcept>
 #include <string>
 #include <utility>
 #include <vector>
@@ -24,12 +29,12 @@
 #include "libstatistics_collector/moving_average_statistics/types.hpp"
 #include "libstatistics_collector/topic_statistics_collector/constants.hpp"
 #include "libstatistics_collector/topic_statistics_collector/received_message_age.hpp"
-#include "libstatistics_collector/topic_statistics_collector/received_message_period.hpp"
 
 #include "rcl/time.h"
 #include "rclcpp/time.hpp"
 #include "rclcpp/publisher.hpp"
 #include "rclcpp/timer.hpp"
+#include "rclcpp/topic_statistics/duration_histogram_statistics.hpp"
 
 #include "statistics_msgs/msg/metrics_message.hpp"
 
@@ -41,53 +46,55 @@ namespace topic_statistics
 constexpr const char kDefaultPublishTopicName[]{"/statistics"};
 constexpr const std::chrono::milliseconds kDefaultPublishingPeriod{std::chrono::seconds(1)};
 
-using libstatistics_collector::collector::GenerateStatisticMessage;
-using statistics_msgs::msg::MetricsMessage;
-using libstatistics_collector::moving_average_statistics::StatisticData;
-
 /**
  * Class used to collect, measure, and publish topic statistics data. Current statistics
  * supported for subscribers are received message age and received message period.
  *
+ * The measurements are recorded without locking in lock-free histograms, by
+ * any number of threads handling messages, and read and reset by
+ * publish_message_and_reset_measurements().
+ * Received message ages are only measured for messages with a header, a negative
+ * age, with clocks out of sync, is counted as zero.
+ *
  * \tparam CallbackMessageT the subscribed message type
  */
 template<typename CallbackMessageT>
 class SubscriptionTopicStatistics
 {
-  using TopicStatsCollector =
-    libstatistics_collector::topic_statistics_collector::TopicStatisticsCollector<
-    CallbackMessageT>;
-  using ReceivedMessageAge =
-    libstatistics_collector::topic_statistics_collector::ReceivedMessageAgeCollector<
-    CallbackMessageT>;
-  using ReceivedMessagePeriod =
-    libstatistics_collector::topic_statistics_collector::ReceivedMessagePeriodCollector<
-    CallbackMessageT>;
+  using TimeStamp =
+    libstatistics_collector::topic_statistics_collector::TimeStamp<CallbackMessageT>;
 
 public:
   /// Construct a SubscriptionTopicStatistics object.
   /**
-   * This object wraps utilities, defined in libstatistics_collector, to collect,
-   * measure, and publish topic statistics data. This throws an invalid_argument
+   * This object measures the received messages, and publishes the statistics
+   * with utilities defined in libstatistics_collector. This throws an invalid_argument
    * if the input publisher is null.
    *
    * \param node_name the name of the node, which created this instance, in order to denote
    * topic source
    * \param publisher instance constructed by the node in order to publish statistics data.
    * This class owns the publisher.
-   * \throws std::invalid_argument if publisher pointer is nullptr
+   * \param message_sampling_interval measure one message out of this number, see
+   * sample_next_message()
+   * \throws std::invalid_argument if publisher pointer is nullptr or the interval is zero
    */
   SubscriptionTopicStatistics(
     const std::string & node_name,
-    rclcpp::Publisher<statistics_msgs::msg::MetricsMessage>::SharedPtr publisher)
+    rclcpp::Publisher<statistics_msgs::msg::MetricsMessage>::SharedPtr publisher,
+    size_t message_sampling_interval = 1)
   : node_name_(node_name),
-    publisher_(std::move(publisher))
+    publisher_(std::move(publisher)),
+    message_sampling_interval_(message_sampling_interval)
   {
     // TODO(dbbonnie): ros-tooling/aws-roadmap/issues/226, received message age
 
     if (nullptr == publisher_) {
       throw std::invalid_argument("publisher pointer is nullptr");
     }
+    if (0u == message_sampling_interval_) {
+      throw std::invalid_argument("message sampling interval must be greater than 0");
+    }
 
     bring_up();
   }
@@ -97,9 +104,26 @@ public:
     tear_down();
   }
 
+  /// Return true if the next message received is to be measured.
+  /**
+   * Called by the subscription for each message received, before reading the
+   * time, so that the messages which are not measured cost a single atomic increment.
+   * With an interval N greater than 1, one message out of N is measured, and
+   * the period measured is the average period of the last N messages.
+   */
+  bool sample_next_message()
+  {
+    if (1u == message_sampling_interval_) {
+      return true;
+    }
+    return 0u ==
+           received_message_count_.fetch_add(1, std::memory_order_relaxed) %
+           message_sampling_interval_;
+  }
+
   /// Handle a message received by the subscription to collect statistics.
   /**
-   * This method acquires a lock to prevent race conditions to collectors list.
+   * This method does not lock, it can be called concurrently by several threads.
    *
    * \param received_message the message received by the subscription
    * \param now_nanoseconds current time in nanoseconds
@@ -108,9 +132,17 @@ public:
     const CallbackMessageT & received_message,
     const rclcpp::Time now_nanoseconds) const
   {
-    std::lock_guard<std::mutex> lock(mutex_);
-    for (const auto & collector : subscriber_statistics_collectors_) {
-      collector->OnMessageReceived(received_message, now_nanoseconds.nanoseconds());
+    const int64_t now = now_nanoseconds.nanoseconds();
+    const auto timestamp_from_header = TimeStamp::value(received_message);
+    // Only compare if non-zero, like the age collector of libstatistics_collector.
+    if (timestamp_from_header.first && timestamp_from_header.second && now) {
+      message_age_.record(std::chrono::nanoseconds(now - timestamp_from_header.second));
+    }
+    const int64_t last_message_time = last_message_time_.exchange(now, std::memory_order_relaxed);
+    if (0 != last_message_time) {
+      message_period_.record(
+        std::chrono::nanoseconds(
+          (now - last_message_time) / static_cast<int64_t>(message_sampling_interval_)));
     }
   }
 
@@ -125,89 +157,60 @@ public:
 
   /// Publish a populated MetricsStatisticsMessage.
   /**
-   * This method acquires a lock to prevent race conditions to collectors list.
+   * The measurements are reset after they are read, the ones recorded
+   * meanwhile may be counted in the current or in the next window.
    */
   virtual void publish_message_and_reset_measurements()
   {
-    std::vector<MetricsMessage> msgs;
-    rclcpp::Time window_end{get_current_nanoseconds_since_epoch()};
+    using libstatistics_collector::topic_statistics_collector::kMsgAgeStatName;
+    using libstatistics_collector::topic_statistics_collector::kMsgPeriodStatName;
+    using libstatistics_collector::topic_statistics_collector::kMillisecondUnitName;
 
-    {
-      std::lock_guard<std::mutex> lock(mutex_);
-      for (auto & collector : subscriber_statistics_collectors_) {
-        const auto collected_stats = collector->GetStatisticsResults();
-        collector->ClearCurrentMeasurements();
-
-        auto message = libstatistics_collector::collector::GenerateStatisticMessage(
-          node_name_,
-          collector->GetMetricName(),
-          collector->GetMetricUnit(),
-          window_start_,
-          window_end,
-          collected_stats);
-        msgs.push_back(message);
-      }
-    }
-
-    for (auto & msg : msgs) {
-      publisher_->publish(msg);
-    }
+    rclcpp::Time window_end{get_current_nanoseconds_since_epoch()};
+    const auto collected_stats = get_current_collector_data();
+    message_age_.reset();
+    message_period_.reset();
+
+    publisher_->publish(
+      GenerateStatisticMessage(
+        node_name_, kMsgAgeStatName, kMillisecondUnitName, window_start_, window_end,
+        collected_stats[0]));
+    publisher_->publish(
+      GenerateStatisticMessage(
+        node_name_, kMsgPeriodStatName, kMillisecondUnitName, window_start_, window_end,
+        collected_stats[1]));
     window_start_ = window_end;
   }
 
+  /// Return the approximate size of the memory of the collectors, in bytes.
+  size_t get_memory_size() const
+  {
+    return sizeof(*this) + node_name_.capacity() +
+      message_age_.get_allocated_memory_size() + message_period_.get_allocated_memory_size();
+  }
+
 protected:
   /// Return a vector of all the currently collected data.
   /**
-   * This method acquires a lock to prevent race conditions to collectors list.
-   *
-   * \return a vector of all the collected data
+   * \return the received message age and period statistics, in milliseconds
    */
   std::vector<StatisticData> get_current_collector_data() const
   {
-    std::vector<StatisticData> data;
-    std::lock_guard<std::mutex> lock(mutex_);
-    for (const auto & collector : subscriber_statistics_collectors_) {
-      data.push_back(collector->GetStatisticsResults());
-    }
-    return data;
+    return {
+      to_milliseconds(message_age_.get_snapshot()),
+      to_milliseconds(message_period_.get_snapshot())};
   }
 
 private:
-  /// Construct and start all collectors and set window_start_.
-  /**
-   * This method acquires a lock to prevent race conditions to collectors list.
-   */
+  /// Set window_start_.
   void bring_up()
   {
-    auto received_message_age = std::make_unique<ReceivedMessageAge>();
-    received_message_age->Start();
-    subscriber_statistics_collectors_.emplace_back(std::move(received_message_age));
-
-    auto received_message_period = std::make_unique<ReceivedMessagePeriod>();
-    received_message_period->Start();
-    {
-      std::lock_guard<std::mutex> lock(mutex_);
-      subscriber_statistics_collectors_.emplace_back(std::move(received_message_period));
-    }
-
     window_start_ = rclcpp::Time(get_current_nanoseconds_since_epoch());
   }
 
-  /// Stop all collectors, clear measurements, stop publishing timer, and reset publisher.
-  /**
-   * This method acquires a lock to prevent race conditions to collectors list.
-   */
+  /// Stop publishing timer, and reset publisher.
   void tear_down()
   {
-    {
-      std::lock_guard<std::mutex> lock(mutex_);
-      for (auto & collector : subscriber_statistics_collectors_) {
-        collector->Stop();
-      }
-
-      subscriber_statistics_collectors_.clear();
-    }
-
     if (publisher_timer_) {
       publisher_timer_->cancel();
       publisher_timer_.reset();
@@ -226,10 +229,6 @@ private:
     return std::chrono::duration_cast<std::chrono::nanoseconds>(now.time_since_epoch()).count();
   }
 
-  /// Mutex to protect the subsequence vectors
-  mutable std::mutex mutex_;
-  /// Collection of statistics collectors
-  std::vector<std::unique_ptr<TopicStatsCollector>> subscriber_statistics_collectors_{};
   /// Node name used to generate topic statistics messages to be published
   const std::string node_name_;
   /// Publisher, created by the node, used to publish topic statistics messages
@@ -238,6 +237,16 @@ private:
   rclcpp::TimerBase::SharedPtr publisher_timer_;
   /// The start of the collection window, used in the published topic statistics message
   rclcpp::Time window_start_;
+  /// One message out of this number is measured
+  const size_t message_sampling_interval_;
+  /// Number of messages received, counted to sample them
+  std::atomic<uint64_t> received_message_count_{0};
+  /// Received message ages
+  mutable rclcpp::DurationHistogram message_age_;
+  /// Received message periods
+  mutable rclcpp::DurationHistogram message_period_;
+  /// Time the last message measured was received, zero before the first one
+  mutable std::atomic<int64_t> last_message_time_{0};
 };
 }  // namespace topic_statistics
 }  // namespace rclcpp
@@ -0,0 +1,192 @@
+// Copyright 2021 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__TOPIC_STATISTICS__TIMER_TOPIC_STATISTICS_HPP_
+#define RCLCPP__TOPIC_STATISTICS__TIMER_TOPIC_STATISTICS_HPP_
+
+#include <chrono>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#include "libstatistics_collector/collector/generate_statistics_message.hpp"
+#include "libstatistics_collector/moving_average_statistics/types.hpp"
+
+#include "rclcpp/publisher.hpp"
+#include "rclcpp/qos.hpp"
+#include "rclcpp/time.hpp"
+#include "rclcpp/timer.hpp"
+#include "rclcpp/timer_statistics.hpp"
+#include "rclcpp/topic_statistics/duration_histogram_statistics.hpp"
+#include "rclcpp/topic_statistics/subscription_topic_statistics.hpp"
+
+#include "statistics_msgs/msg/metrics_message.hpp"
+
+namespace rclcpp
+{
+namespace topic_statistics
+{
+
+constexpr const char kTimerWakeupLatencyMetricName[]{"timer_wakeup_latency"};
+constexpr const char kTimerCallbackDurationMetricName[]{"timer_callback_duration"};
+constexpr const char kTimerMissedPeriodsMetricName[]{"timer_missed_periods"};
+
+/**
+ * Class used to publish the statistics collected on a timer, see rclcpp::TimerStatistics.
+ * The wakeup latency and callback duration of the timer are published in milliseconds,
+ * and the number of missed periods per call with its average and maximum.
+ */
+class TimerTopicStatistics
+{
+public:
+  RCLCPP_SMART_PTR_DEFINITIONS_NOT_COPYABLE(TimerTopicStatistics)
+
+  /// Construct a TimerTopicStatistics object.
+  /**
+   * Collecting statistics is enabled on the timer.
+   *
+   * \param node_name the name of the node, used as the measurement source of the messages
+   * \param timer the timer to publish the statistics of
+   * \param publisher instance constructed by the node in order to publish statistics data.
+   * This class owns the publisher.
+   * \throws std::invalid_argument if the timer or publisher pointer is nullptr
+   */
+  TimerTopicStatistics(
+    const std::string & node_name,
+    const rclcpp::TimerBase::SharedPtr & timer,
+    rclcpp::Publisher<statistics_msgs::msg::MetricsMessage>::SharedPtr publisher)
+  : node_name_(node_name),
+    publisher_(std::move(publisher))
+  {
+    if (nullptr == timer) {
+      throw std::invalid_argument("timer pointer is nullptr");
+    }
+    if (nullptr == publisher_) {
+      throw std::invalid_argument("publisher pointer is nullptr");
+    }
+    statistics_ = timer->enable_statistics();
+    window_start_ = rclcpp::Time(get_current_nanoseconds_since_epoch());
+  }
+
+  virtual ~TimerTopicStatistics()
+  {
+    if (publisher_timer_) {
+      publisher_timer_->cancel();
+      publisher_timer_.reset();
+    }
+  }
+
+  /// Set the timer used to publish statistics messages.
+  /**
+   * \param publisher_timer the timer to fire the publisher, created by the node
+   */
+  void set_publisher_timer(rclcpp::TimerBase::SharedPtr publisher_timer)
+  {
+    publisher_timer_ = publisher_timer;
+  }
+
+  /// Publish the collected statistics and reset them.
+  virtual void publish_message_and_reset_measurements()
+  {
+    rclcpp::Time window_end{get_current_nanoseconds_since_epoch()};
+
+    const auto wakeup_latency = statistics_->get_wakeup_latency();
+    const auto callback_duration = statistics_->get_callback_duration();
+    const uint64_t missed_periods = statistics_->get_missed_periods();
+    const uint64_t max_missed_periods = statistics_->get_max_missed_periods();
+    statistics_->reset();
+
+    StatisticData missed_periods_data;
+    missed_periods_data.sample_count = wakeup_latency.count;
+    if (wakeup_latency.count > 0u) {
+      missed_periods_data.average =
+        static_cast<double>(missed_periods) / static_cast<double>(wakeup_latency.count);
+      missed_periods_data.max = static_cast<double>(max_missed_periods);
+    }
+
+    publisher_->publish(
+      generate_duration_statistic_message(
+        node_name_, kTimerWakeupLatencyMetricName,
+        window_start_, window_end, wakeup_latency));
+    publisher_->publish(
+      generate_duration_statistic_message(
+        node_name_, kTimerCallbackDurationMetricName,
+        window_start_, window_end, callback_duration));
+    publisher_->publish(
+      GenerateStatisticMessage(
+        node_name_, kTimerMissedPeriodsMetricName, "count", window_start_, window_end,
+        missed_periods_data));
+    window_start_ = window_end;
+  }
+
+private:
+  /// Return the current nanoseconds (count) since epoch.
+  int64_t get_current_nanoseconds_since_epoch() const
+  {
+    const auto now = std::chrono::system_clock::now();
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(now.time_since_epoch()).count();
+  }
+
+  /// Node name used to generate topic statistics messages to be published
+  const std::string node_name_;
+  /// Statistics of the timer
+  rclcpp::TimerStatistics::SharedPtr statistics_;
+  /// Publisher, created by the node, used to publish topic statistics messages
+  rclcpp::Publisher<statistics_msgs::msg::MetricsMessage>::SharedPtr publisher_;
+  /// Timer which fires the publisher
+  rclcpp::TimerBase::SharedPtr publisher_timer_;
+  /// The start of the collection window, used in the published topic statistics message
+  rclcpp::Time window_start_;
+};
+
+/// Periodically publish the statistics of a timer.
+/**
+ * \param node the node which creates the publisher and the publishing timer
+ * \param timer the timer to publish the statistics of
+ * \param publish_period how often the statistics are published and reset
+ * \param topic_name the topic the statistics are published on
+ * \return the object publishing the statistics, publishing stops when it is destroyed
+ * \throws std::invalid_argument if the timer is nullptr
+ */
+template<typename NodeT>
+TimerTopicStatistics::SharedPtr
+create_timer_topic_statistics(
+  NodeT && node,
+  const rclcpp::TimerBase::SharedPtr & timer,
+  std::chrono::nanoseconds publish_period = kDefaultPublishingPeriod,
+  const std::string & topic_name = kDefaultPublishTopicName)
+{
+  auto publisher = node->template create_publisher<statistics_msgs::msg::MetricsMessage>(
+    topic_name, rclcpp::QoS(10));
+  auto timer_topic_stats = std::make_shared<TimerTopicStatistics>(
+    node->get_name(), timer, publisher);
+
+  std::weak_ptr<TimerTopicStatistics> weak_timer_topic_stats(timer_topic_stats);
+  auto publisher_timer = node->create_wall_timer(
+    publish_period,
+    [weak_timer_topic_stats]() {
+      auto timer_topic_stats = weak_timer_topic_stats.lock();
+      if (timer_topic_stats) {
+        timer_topic_stats->publish_message_and_reset_measurements();
+      }
+    });
+  timer_topic_stats->set_publisher_timer(publisher_timer);
+  return timer_topic_stats;
+}
+
+}  // namespace topic_statistics
+}  // namespace rclcpp
+
+#endif  // RCLCPP__TOPIC_STATISTICS__TIMER_TOPIC_STATISTICS_HPP_
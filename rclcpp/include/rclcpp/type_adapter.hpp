@@ -15,7 +15,9 @@
 #ifndef RCLCPP__TYPE_ADAPTER_HPP_
 #define RCLCPP__TYPE_ADAPTER_HPP_
 
+#include <memory>
 #include <type_traits>
+#include <utility>
 
 namespace rclcpp
 {
@@ -93,6 +95,29 @@ namespace rclcpp
  *     // Then you can create things with just the custom type, and the ROS
  *     // message type is implied based on the previous statement.
  *     auto pub = node->create_publisher<std::string>(...);
+ *
+ * Two optional static functions let the adapted types avoid copies where the
+ * middleware allows it:
+ *
+ *   - static void convert_to_loaned_ros_message(const custom_type &, ros_message_type &)
+ *
+ *     If the middleware can loan messages of the ROS type, the publishers
+ *     publishing inter-process convert the custom message with it directly
+ *     into the loaned memory, instead of into a separate ROS message which the
+ *     middleware then copies.
+ *     The destination is not cleared beforehand, the function must set all of
+ *     its fields.
+ *
+ *   - static std::shared_ptr<const custom_type>
+ *     wrap_ros_message(std::shared_ptr<const ros_message_type>)
+ *
+ *     The subscriptions taking the custom type by const reference or by
+ *     shared pointer to const get the custom message it returns, which may
+ *     refer to the data of the ROS message instead of copying it, and keep
+ *     the ROS message alive.
+ *     The ROS message may be loaned by the middleware, in which case it is
+ *     only valid during the callback, as for the callbacks taking the ROS
+ *     message itself.
  */
 template<typename CustomType, typename ROSMessageType = void, class Enable = void>
 struct TypeAdapter
@@ -119,6 +144,29 @@ struct TypeAdapter<T, void, std::enable_if_t<is_type_adapter<T>::value>>: T {};
 namespace detail
 {
 
+/// True if the TypeAdapter has a convert_to_loaned_ros_message() function, see TypeAdapter.
+template<typename TypeAdapterT, typename = void>
+struct has_convert_to_loaned_ros_message : std::false_type {};
+
+template<typename TypeAdapterT>
+struct has_convert_to_loaned_ros_message<
+  TypeAdapterT,
+  std::void_t<decltype(TypeAdapterT::convert_to_loaned_ros_message(
+    std::declval<const typename TypeAdapterT::custom_type &>(),
+    std::declval<typename TypeAdapterT::ros_message_type &>()))>>
+  : std::true_type {};
+
+/// True if the TypeAdapter has a wrap_ros_message() function, see TypeAdapter.
+template<typename TypeAdapterT, typename = void>
+struct has_wrap_ros_message : std::false_type {};
+
+template<typename TypeAdapterT>
+struct has_wrap_ros_message<
+  TypeAdapterT,
+  std::void_t<decltype(TypeAdapterT::wrap_ros_message(
+    std::declval<std::shared_ptr<const typename TypeAdapterT::ros_message_type>>()))>>
+  : std::true_type {};
+
 template<typename CustomType, typename ROSMessageType>
 struct assert_type_pair_is_specialized_type_adapter
 {
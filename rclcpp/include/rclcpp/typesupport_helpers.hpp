@@ -29,6 +29,10 @@ namespace rclcpp
 {
 /// Load the type support library for the given type.
 /**
+ * The libraries are cached process-wide and stay loaded, the types of a package
+ * and type support share the same library, without searching for it again.
+ * This function is thread-safe.
+ *
  * \param[in] type The topic type, e.g. "std_msgs/msg/String"
  * \param[in] typesupport_identifier Type support identifier, typically "rosidl_typesupport_cpp"
  * \return A shared library
@@ -40,6 +44,9 @@ get_typesupport_library(const std::string & type, const std::string & typesuppor
 /// Extract the type support handle from the library.
 /**
  * The library needs to match the topic type. The shared library must stay loaded for the lifetime of the result.
+ * The handles extracted from the libraries returned by get_typesupport_library() are cached,
+ * the symbol is only looked up on the first call for a type.
+ * This function is thread-safe.
  * \param[in] type The topic type, e.g. "std_msgs/msg/String"
  * \param[in] typesupport_identifier Type support identifier, typically "rosidl_typesupport_cpp"
  * \param[in] library The shared type support library
@@ -52,6 +59,23 @@ get_typesupport_handle(
   const std::string & typesupport_identifier,
   rcpputils::SharedLibrary & library);
 
+/// Load the type support libraries needed to communicate the messages of the given type.
+/**
+ * The type support libraries of a type, such as the one of the middleware, are
+ * otherwise opened the first time a publisher, a subscription or a serialization
+ * uses the type, which takes a dlopen() each.
+ * They are opened by serializing a default-initialized message of the type,
+ * and stay loaded, like those of get_typesupport_library().
+ * This function is thread-safe.
+ *
+ * \param[in] type The topic type, e.g. "std_msgs/msg/String"
+ * \throws std::runtime_error if a type support library could not be loaded.
+ * \throws rclcpp::exceptions::RCLError if the message could not be serialized.
+ */
+RCLCPP_PUBLIC
+void
+preload_typesupport(const std::string & type);
+
 }  // namespace rclcpp
 
 #endif  // RCLCPP__TYPESUPPORT_HELPERS_HPP_
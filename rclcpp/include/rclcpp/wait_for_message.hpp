@@ -17,7 +17,9 @@
 
 #include <memory>
 #include <string>
+#include <utility>
 
+#include "rclcpp/macros.hpp"
 #include "rclcpp/node.hpp"
 #include "rclcpp/visibility_control.hpp"
 #include "rclcpp/wait_set.hpp"
@@ -82,6 +84,7 @@ bool wait_for_message(
  * \param[in] time_to_wait parameter specifying the timeout before returning.
  * \return true if a message was successfully received, false if message could not
  * be obtained or shutdown was triggered asynchronously on the context.
+ * \sa MessageWaiter to wait for messages repeatedly, without creating a subscription each time.
  */
 template<class MsgT, class Rep = int64_t, class Period = std::milli>
 bool wait_for_message(
@@ -95,6 +98,173 @@ bool wait_for_message(
     out, sub, node->get_node_options().context(), time_to_wait);
 }
 
+/// Subscription and wait set kept to wait for the messages of a topic repeatedly.
+/**
+ * Unlike rclcpp::wait_for_message() given a node and a topic, which creates a
+ * subscription and a wait set for each call, and so is discovered and matched
+ * with the publishers each time, the subscription and the wait set of the
+ * waiter are created once and kept until it is destroyed.
+ * The messages received between the calls are queued by the subscription, up
+ * to the depth of its QoS, so that the latest of them is returned without
+ * waiting.
+ *
+ * The subscription is created in a callback group which is not added to the
+ * executors of the node, so that they do not take the messages of the waiter.
+ * A waiter is not thread-safe, it is used by one thread at a time.
+ *
+ * \tparam MsgT type of the messages.
+ */
+template<class MsgT>
+class MessageWaiter
+{
+public:
+  RCLCPP_SMART_PTR_DEFINITIONS_NOT_COPYABLE(MessageWaiter)
+
+  /// Subscribe to the topic.
+  /**
+   * \param[in] node the node to create the subscription on.
+   * \param[in] topic the topic to wait for messages on.
+   * \param[in] qos the QoS of the subscription, whose depth is the number of
+   *   messages queued between the calls.
+   */
+  MessageWaiter(
+    rclcpp::Node::SharedPtr node,
+    const std::string & topic,
+    const rclcpp::QoS & qos = rclcpp::QoS(1))
+  : callback_group_(
+      node->create_callback_group(rclcpp::CallbackGroupType::MutuallyExclusive, false)),
+    context_(node->get_node_options().context())
+  {
+    rclcpp::SubscriptionOptions options;
+    options.callback_group = callback_group_;
+    subscription_ = node->create_subscription<MsgT>(
+      topic, qos, [](const std::shared_ptr<MsgT>) {}, options);
+    initialize();
+  }
+
+  /// Wait for the messages of an already initialized subscription.
+  /**
+   * The subscription should not be executed by an executor, which would take
+   * its messages.
+   *
+   * \param[in] subscription shared pointer to a previously initialized subscription.
+   * \param[in] context shared pointer to a context to watch for SIGINT requests.
+   */
+  MessageWaiter(
+    std::shared_ptr<rclcpp::Subscription<MsgT>> subscription,
+    std::shared_ptr<rclcpp::Context> context)
+  : subscription_(std::move(subscription)),
+    context_(std::move(context))
+  {
+    initialize();
+  }
+
+  ~MessageWaiter()
+  {
+    context_->remove_on_shutdown_callback(shutdown_callback_handle_);
+  }
+
+  /// Return the latest message received since the last call, or wait for the next one.
+  /**
+   * The older messages queued are dropped.
+   *
+   * \param[out] out is the message to be filled.
+   * \param[in] time_to_wait the timeout of the wait, negative to wait indefinitely.
+   * \return true if a message was received, false if no message could be obtained
+   *   before the timeout or shutdown was triggered on the context.
+   */
+  template<class Rep = int64_t, class Period = std::milli>
+  bool
+  wait_for_message(
+    MsgT & out,
+    std::chrono::duration<Rep, Period> time_to_wait = std::chrono::duration<Rep, Period>(-1))
+  {
+    if (take_latest(out)) {
+      return true;
+    }
+    return wait_and_take(out, time_to_wait);
+  }
+
+  /// Wait for the next message, dropping the messages received since the last call.
+  /**
+   * \param[out] out is the message to be filled.
+   * \param[in] time_to_wait the timeout of the wait, negative to wait indefinitely.
+   * \return true if a message was received, false if no message could be obtained
+   *   before the timeout or shutdown was triggered on the context.
+   */
+  template<class Rep = int64_t, class Period = std::milli>
+  bool
+  wait_for_next_message(
+    MsgT & out,
+    std::chrono::duration<Rep, Period> time_to_wait = std::chrono::duration<Rep, Period>(-1))
+  {
+    take_latest(dropped_message_);
+    return wait_and_take(out, time_to_wait);
+  }
+
+  /// Return the subscription of the waiter.
+  std::shared_ptr<rclcpp::Subscription<MsgT>>
+  get_subscription() const
+  {
+    return subscription_;
+  }
+
+private:
+  void
+  initialize()
+  {
+    shutdown_guard_condition_ = std::make_shared<rclcpp::GuardCondition>(context_);
+    shutdown_callback_handle_ = context_->add_on_shutdown_callback(
+      [weak_gc = std::weak_ptr<rclcpp::GuardCondition>{shutdown_guard_condition_}]() {
+        auto strong_gc = weak_gc.lock();
+        if (strong_gc) {
+          strong_gc->trigger();
+        }
+      });
+    wait_set_.add_subscription(subscription_);
+    wait_set_.add_guard_condition(shutdown_guard_condition_);
+  }
+
+  /// Take the queued messages into out, the latest one last.
+  bool
+  take_latest(MsgT & out)
+  {
+    rclcpp::MessageInfo info;
+    bool taken = false;
+    while (subscription_->take(out, info)) {
+      taken = true;
+    }
+    return taken;
+  }
+
+  template<class Rep, class Period>
+  bool
+  wait_and_take(MsgT & out, std::chrono::duration<Rep, Period> time_to_wait)
+  {
+    if (!rclcpp::ok(context_)) {
+      return false;
+    }
+    auto ret = wait_set_.wait(time_to_wait);
+    if (ret.kind() != rclcpp::WaitResultKind::Ready) {
+      return false;
+    }
+    if (wait_set_.get_rcl_wait_set().guard_conditions[0]) {
+      return false;
+    }
+    return take_latest(out);
+  }
+
+  /// Callback group of the subscription created by the waiter, not added to the executors.
+  rclcpp::CallbackGroup::SharedPtr callback_group_;
+  std::shared_ptr<rclcpp::Subscription<MsgT>> subscription_;
+  std::shared_ptr<rclcpp::Context> context_;
+  rclcpp::GuardCondition::SharedPtr shutdown_guard_condition_;
+  rclcpp::OnShutdownCallbackHandle shutdown_callback_handle_;
+  rclcpp::WaitSet wait_set_;
+  /// Message the queued messages are dropped into, keeping its capacity from a call to the next.
+  MsgT dropped_message_;
+};
+
 }  // namespace rclcpp
 
 #endif  // RCLCPP__WAIT_FOR_MESSAGE_HPP_
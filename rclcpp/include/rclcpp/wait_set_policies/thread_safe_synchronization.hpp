@@ -15,6 +15,7 @@
 #ifndef RCLCPP__WAIT_SET_POLICIES__THREAD_SAFE_SYNCHRONIZATION_HPP_
 #define RCLCPP__WAIT_SET_POLICIES__THREAD_SAFE_SYNCHRONIZATION_HPP_
 
+#include <atomic>
 #include <chrono>
 #include <functional>
 #include <memory>
@@ -63,13 +64,32 @@ namespace wait_set_policies
  * The write activities will try to interrupt the wait() method by triggering
  * a guard condition, but they have no way of causing the WaitResult to release
  * its lock.
+ *
+ * The interruptions can be disabled with sync_set_interrupt_on_modification(),
+ * for wait sets which are changed often, like control loops adding and
+ * removing timers.
+ * rcl_wait() runs without holding the lock, so the changes are then made
+ * while a wait is in progress, without interrupting it, and are published to
+ * the next wait, which rebuilds the rcl wait set from them.
+ * The wait in progress keeps the removed entities alive and may still report
+ * them as ready.
+ * A wait can still be interrupted on request with sync_interrupt_wait(), it
+ * then rebuilds the rcl wait set with the changes and keeps waiting.
+ * In this mode a WaitResult does not hold the lock either, since the changes
+ * only affect the rcl wait set when the next wait rebuilds it, so adding and
+ * removing entities never blocks for long.
  */
 class ThreadSafeSynchronization : public detail::SynchronizationPolicyCommon
 {
 protected:
   explicit ThreadSafeSynchronization(rclcpp::Context::SharedPtr context)
   : extra_guard_conditions_{{std::make_shared<rclcpp::GuardCondition>(context)}},
-    wprw_lock_([this]() {this->interrupt_waiting_wait_set();})
+    wprw_lock_(
+      [this]() {
+        if (this->interrupt_on_modification_) {
+          this->interrupt_waiting_wait_set();
+        }
+      })
   {}
   ~ThreadSafeSynchronization() = default;
 
@@ -94,6 +114,27 @@ protected:
     extra_guard_conditions_[0]->trigger();
   }
 
+  /// Set whether adding and removing entities interrupts the wait in progress, true by default.
+  void
+  sync_set_interrupt_on_modification(bool interrupt_on_modification)
+  {
+    interrupt_on_modification_ = interrupt_on_modification;
+  }
+
+  /// Return true if adding and removing entities interrupts the wait in progress.
+  bool
+  sync_get_interrupt_on_modification() const
+  {
+    return interrupt_on_modification_;
+  }
+
+  /// Interrupt the wait in progress, so that it waits on the latest entities.
+  void
+  sync_interrupt_wait()
+  {
+    this->interrupt_waiting_wait_set();
+  }
+
   /// Add subscription.
   void
   sync_add_subscription(
@@ -359,17 +400,26 @@ protected:
   void
   sync_wait_result_acquire()
   {
-    wprw_lock_.get_read_mutex().lock();
+    // Without interruptions the changes only reach the rcl wait set at the next wait, so the
+    // WaitResult does not need to block them.
+    wait_result_holds_lock_ = interrupt_on_modification_;
+    if (wait_result_holds_lock_) {
+      wprw_lock_.get_read_mutex().lock();
+    }
   }
 
   void
   sync_wait_result_release()
   {
-    wprw_lock_.get_read_mutex().unlock();
+    if (wait_result_holds_lock_) {
+      wprw_lock_.get_read_mutex().unlock();
+    }
   }
 
 protected:
   std::array<std::shared_ptr<rclcpp::GuardCondition>, 1> extra_guard_conditions_;
+  std::atomic_bool interrupt_on_modification_{true};
+  bool wait_result_holds_lock_ = false;
   rclcpp::wait_set_policies::detail::WritePreferringReadWriteLock wprw_lock_;
 };
 
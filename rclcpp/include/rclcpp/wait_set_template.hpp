@@ -42,6 +42,18 @@ namespace rclcpp
 /**
  * This class uses the rcl_wait_set_t as storage, but it also helps manage the
  * ownership of associated rclcpp types.
+ *
+ * The cost of each wait() grows with the number of entities, ready or not:
+ * the rcl wait set is cleared and every entity is added again before waiting,
+ * since rcl_wait() marks the entities which are not ready by clearing their
+ * slot, and the middleware checks each of them for readiness.
+ * The rcl and rmw layers in use do not expose a file descriptor or a
+ * notification callback per entity, so the entities cannot be registered once
+ * with an event mechanism like epoll.
+ * For thousands of entities of which only a few are active, prefer few large
+ * wait sets over many calls on small ones, or the
+ * rclcpp::executors::EventsExecutor, which dispatches the ready entities
+ * without looking up the other ones.
  */
 template<class SynchronizationPolicy, class StoragePolicy>
 class WaitSetTemplate final : private SynchronizationPolicy, private StoragePolicy
@@ -607,6 +619,39 @@ public:
       });
   }
 
+  /// Set whether adding and removing entities interrupts a wait() in progress.
+  /**
+   * When disabled, the changes are made without interrupting the wait() in
+   * progress and are published to the next wait() instead, and a WaitResult
+   * in scope does not block them.
+   * The wait() in progress may still report removed entities as ready.
+   * Interrupting is enabled by default.
+   *
+   * Only available with the rclcpp::wait_set_policies::ThreadSafeSynchronization policy.
+   *
+   * \param[in] interrupt_on_modification false to publish the changes to the next wait().
+   */
+  void
+  set_interrupt_on_modification(bool interrupt_on_modification)
+  {
+    // this method comes from the SynchronizationPolicy
+    this->sync_set_interrupt_on_modification(interrupt_on_modification);
+  }
+
+  /// Interrupt a wait() in progress, so that it resumes waiting on the latest entities.
+  /**
+   * Used to request that the changes made when set_interrupt_on_modification()
+   * is disabled are waited on right away.
+   *
+   * Only available with the rclcpp::wait_set_policies::ThreadSafeSynchronization policy.
+   */
+  void
+  interrupt_wait()
+  {
+    // this method comes from the SynchronizationPolicy
+    this->sync_interrupt_wait();
+  }
+
   /// Wait for any of the entities in the wait set to be ready, or a period of time to pass.
   /**
    * This function will return when either one of the entities within this wait
@@ -634,7 +679,8 @@ public:
    * that is used.
    * With the rclcpp::wait_set_policies::ThreadSafeSynchronization policy this
    * function will stop waiting to allow add or remove of an entity, and then
-   * resume waiting, so long as the timeout has not been reached.
+   * resume waiting, so long as the timeout has not been reached, unless this
+   * was disabled with set_interrupt_on_modification().
    *
    * \param[in] time_to_wait If > 0, time to wait for entities to be ready,
    *   if == 0, check if anything is ready without blocking, or
@@ -0,0 +1,146 @@
+// Copyright 2021 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef RCLCPP__WORKER_POOL_HPP_
+#define RCLCPP__WORKER_POOL_HPP_
+
+#include <cstddef>
+#include <functional>
+#include <future>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "rclcpp/macros.hpp"
+#include "rclcpp/thread_attributes.hpp"
+#include "rclcpp/visibility_control.hpp"
+
+namespace rclcpp
+{
+
+/// Options of a rclcpp::WorkerPool.
+struct WorkerPoolOptions
+{
+  /// Maximum number of threads of the pool, 0 for the number of hardware threads.
+  size_t max_threads = 0;
+  /// Scheduling attributes of the threads, by thread index.
+  /**
+   * The threads beyond the size of the vector are left as they are, e.g.
+   * rclcpp::make_numa_thread_attributes() spreads the threads over the NUMA nodes.
+   */
+  std::vector<ThreadAttributes> thread_attributes;
+};
+
+/// Bounded pool of threads running the work offloaded from callbacks.
+/**
+ * The threads are started on demand, when work is queued while none of them
+ * is idle, up to the maximum number of threads, and then kept until the pool
+ * is shut down, so that the features offloading work share a bounded set of
+ * threads instead of each starting its own.
+ * The work is run in the order it was queued.
+ *
+ * Each context has a pool, configured by rclcpp::InitOptions::worker_pool()
+ * and shut down with the context, see rclcpp::Context::get_worker_pool().
+ *
+ * All public member functions are thread-safe.
+ */
+class WorkerPool
+{
+public:
+  RCLCPP_SMART_PTR_DEFINITIONS_NOT_COPYABLE(WorkerPool)
+
+  /// Create a pool, without starting any thread yet.
+  /**
+   * \param[in] options the options of the pool.
+   */
+  RCLCPP_PUBLIC
+  explicit WorkerPool(const WorkerPoolOptions & options = WorkerPoolOptions());
+
+  /// Shut the pool down, see shutdown().
+  RCLCPP_PUBLIC
+  virtual ~WorkerPool();
+
+  /// Queue a function to be called by a thread of the pool.
+  /**
+   * \param[in] function the function to call, whose exceptions are given to the future.
+   * \return the future of the result of the function, whose promise is broken,
+   *   i.e. `get()` throws a `std::future_error`, if the pool is shut down before
+   *   the function is called.
+   * \throws std::runtime_error if the pool is shut down.
+   */
+  template<typename FunctionT>
+  std::future<std::invoke_result_t<std::decay_t<FunctionT>>>
+  submit(FunctionT && function)
+  {
+    using ResultT = std::invoke_result_t<std::decay_t<FunctionT>>;
+    auto task = std::make_shared<std::packaged_task<ResultT()>>(
+      std::forward<FunctionT>(function));
+    std::future<ResultT> future = task->get_future();
+    post([task]() {(*task)();});
+    return future;
+  }
+
+  /// Queue a function to be called by a thread of the pool, without a future.
+  /**
+   * The exceptions thrown by the function are logged.
+   *
+   * \param[in] function the function to call.
+   * \throws std::runtime_error if the pool is shut down.
+   */
+  RCLCPP_PUBLIC
+  void
+  post(std::function<void()> function);
+
+  /// Stop the threads of the pool, dropping the functions which were not called yet.
+  /**
+   * It waits for the functions being called to return, except for the one
+   * calling shutdown() if it is called by a thread of the pool, and the pool
+   * then rejects any new function.
+   * Calling it again has no effect.
+   */
+  RCLCPP_PUBLIC
+  void
+  shutdown();
+
+  /// Return true if the pool is shut down.
+  RCLCPP_PUBLIC
+  bool
+  is_shutdown() const;
+
+  /// Return the maximum number of threads of the pool.
+  RCLCPP_PUBLIC
+  size_t
+  get_max_threads() const;
+
+  /// Return the number of threads started by the pool, 0 once it is shut down.
+  RCLCPP_PUBLIC
+  size_t
+  get_number_of_threads() const;
+
+  /// Return the number of functions queued which were not called yet.
+  RCLCPP_PUBLIC
+  size_t
+  get_pending_count() const;
+
+private:
+  struct State;
+
+  std::shared_ptr<State> state_;
+};
+
+}  // namespace rclcpp
+
+#endif  // RCLCPP__WORKER_POOL_HPP_
@@ -128,6 +128,9 @@ def get_rclcpp_suffix_from_features(features):
       ::std::is_same<typename std::remove_cv<typename std::remove_reference<decltype(logger)>::type>::type, \
       typename ::rclcpp::Logger>::value, \
       "First argument to logging macros must be an rclcpp::Logger"); \
+    if (!(logger).is_enabled_for(RCUTILS_LOG_SEVERITY_@(severity))) { \
+      break; \
+    } \
 @[ if 'throttle' in feature_combination]@ \
     auto get_time_point = [&c=clock](rcutils_time_point_value_t * time_point) -> rcutils_ret_t { \
       try { \
@@ -0,0 +1,219 @@
+// Copyright 2021 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "rclcpp/allocation_tracking.hpp"
+
+#include <atomic>
+#include <cstdlib>
+#include <map>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#if defined(__GLIBC__)
+#include <execinfo.h>
+#endif
+
+namespace
+{
+
+constexpr int max_backtrace_depth = 32;
+
+struct TrackedAllocations
+{
+  uint64_t allocation_count = 0;
+  uint64_t allocated_bytes = 0;
+  std::vector<std::vector<void *>> backtraces;
+};
+
+struct Tracker
+{
+  std::mutex mutex;
+  std::map<std::string, TrackedAllocations> allocations;
+  size_t max_backtraces_per_callback = 0;
+};
+
+std::atomic<bool> g_enabled{false};
+std::atomic<uint64_t> g_allocation_count{0};
+
+// Never destroyed, the allocations made while exiting must still find it.
+Tracker &
+get_tracker()
+{
+  static Tracker * tracker = new Tracker();
+  return *tracker;
+}
+
+thread_local const char * t_callback_kind = nullptr;
+thread_local const char * t_callback_name = nullptr;
+// Set while tracking an allocation, whose own allocations are not tracked.
+thread_local bool t_recording = false;
+
+}  // namespace
+
+namespace rclcpp
+{
+namespace allocation_tracking
+{
+
+void
+enable(const AllocationTrackingOptions & options)
+{
+  Tracker & tracker = get_tracker();
+  {
+    std::lock_guard<std::mutex> lock(tracker.mutex);
+    tracker.max_backtraces_per_callback = options.max_backtraces_per_callback;
+  }
+  g_enabled.store(options.enabled, std::memory_order_release);
+}
+
+void
+disable()
+{
+  g_enabled.store(false, std::memory_order_release);
+}
+
+bool
+is_enabled()
+{
+  return g_enabled.load(std::memory_order_acquire);
+}
+
+std::vector<CallbackAllocations>
+get_callback_allocations()
+{
+  std::vector<CallbackAllocations> result;
+  Tracker & tracker = get_tracker();
+  std::lock_guard<std::mutex> lock(tracker.mutex);
+  result.reserve(tracker.allocations.size());
+  for (const auto & entry : tracker.allocations) {
+    CallbackAllocations callback_allocations;
+    callback_allocations.callback = entry.first;
+    callback_allocations.allocation_count = entry.second.allocation_count;
+    callback_allocations.allocated_bytes = entry.second.allocated_bytes;
+    callback_allocations.backtraces = entry.second.backtraces;
+    result.push_back(std::move(callback_allocations));
+  }
+  return result;
+}
+
+uint64_t
+get_allocation_count()
+{
+  return g_allocation_count.load(std::memory_order_relaxed);
+}
+
+void
+reset()
+{
+  Tracker & tracker = get_tracker();
+  std::map<std::string, TrackedAllocations> allocations;
+  std::lock_guard<std::mutex> lock(tracker.mutex);
+  tracker.allocations.swap(allocations);
+  g_allocation_count.store(0, std::memory_order_relaxed);
+}
+
+std::string
+format_backtrace(const std::vector<void *> & backtrace)
+{
+  std::string result;
+#if defined(__GLIBC__)
+  char ** symbols = backtrace_symbols(backtrace.data(), static_cast<int>(backtrace.size()));
+  if (nullptr != symbols) {
+    for (size_t i = 0; i < backtrace.size(); ++i) {
+      result += symbols[i];
+      result += '\n';
+    }
+    std::free(symbols);
+    return result;
+  }
+#endif
+  for (void * address : backtrace) {
+    result += std::to_string(reinterpret_cast<uintptr_t>(address));
+    result += '\n';
+  }
+  return result;
+}
+
+void
+record_allocation(size_t size)
+{
+  if (
+    nullptr == t_callback_kind || t_recording ||
+    !g_enabled.load(std::memory_order_relaxed))
+  {
+    return;
+  }
+  t_recording = true;
+  g_allocation_count.fetch_add(1, std::memory_order_relaxed);
+  std::string callback = t_callback_kind;
+  if (nullptr != t_callback_name) {
+    callback += ' ';
+    callback += t_callback_name;
+  }
+  Tracker & tracker = get_tracker();
+  std::lock_guard<std::mutex> lock(tracker.mutex);
+  TrackedAllocations & allocations = tracker.allocations[callback];
+  ++allocations.allocation_count;
+  allocations.allocated_bytes += size;
+  if (allocations.backtraces.size() < tracker.max_backtraces_per_callback) {
+    std::vector<void *> addresses(max_backtrace_depth);
+#if defined(__GLIBC__)
+    addresses.resize(static_cast<size_t>(::backtrace(addresses.data(), max_backtrace_depth)));
+#else
+    addresses.clear();
+#endif
+    allocations.backtraces.push_back(std::move(addresses));
+  }
+  t_recording = false;
+}
+
+TrackedAllocation::TrackedAllocation(size_t size)
+: outermost_(!t_recording)
+{
+  if (outermost_) {
+    record_allocation(size);
+    t_recording = true;
+  }
+}
+
+TrackedAllocation::~TrackedAllocation()
+{
+  if (outermost_) {
+    t_recording = false;
+  }
+}
+
+CallbackScope::CallbackScope(const char * kind, const char * name)
+: active_(g_enabled.load(std::memory_order_relaxed)),
+  previous_kind_(t_callback_kind),
+  previous_name_(t_callback_name)
+{
+  if (active_) {
+    t_callback_kind = kind;
+    t_callback_name = name;
+  }
+}
+
+CallbackScope::~CallbackScope()
+{
+  if (active_) {
+    t_callback_kind = previous_kind_;
+    t_callback_name = previous_name_;
+  }
+}
+
+}  // namespace allocation_tracking
+}  // namespace rclcpp
@@ -0,0 +1,379 @@
+// Copyright 2021 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "rclcpp/allocator/tlsf_pool.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <stdexcept>
+
+namespace rclcpp
+{
+namespace allocator
+{
+namespace detail
+{
+
+/// Header of a block of the pool, followed by the memory of the block.
+struct TLSFBlock
+{
+  /// Previous block in memory, only valid if it is free.
+  TLSFBlock * prev_physical;
+  /// Size of the memory of the block after its header, with the flags of the block.
+  size_t size_and_flags;
+  /// Links of the list of free blocks of the size class, in the memory of free blocks only.
+  TLSFBlock * next_free;
+  TLSFBlock * prev_free;
+};
+
+}  // namespace detail
+}  // namespace allocator
+}  // namespace rclcpp
+
+using rclcpp::allocator::TLSFPool;
+using rclcpp::allocator::detail::TLSFBlock;
+
+namespace
+{
+
+constexpr size_t alignment = alignof(std::max_align_t);
+constexpr size_t alignment_log2 =
+  alignment == 32 ? 5 : alignment == 16 ? 4 : alignment == 8 ? 3 : 2;
+static_assert((size_t(1) << alignment_log2) == alignment, "unexpected alignment");
+
+constexpr size_t
+align_up(size_t size)
+{
+  return (size + alignment - 1) & ~(alignment - 1);
+}
+
+// The links of a free block are in its memory, which is at least min_block_size.
+constexpr size_t header_size = align_up(offsetof(TLSFBlock, next_free));
+constexpr size_t min_block_size = sizeof(TLSFBlock) > header_size ?
+  align_up(sizeof(TLSFBlock) - header_size) : alignment;
+
+constexpr size_t free_flag = 1;
+constexpr size_t prev_free_flag = 2;
+constexpr size_t flags_mask = free_flag | prev_free_flag;
+
+constexpr size_t second_level_count_log2 = 5;
+// Sizes below it are in the first first-level list, split linearly by the second level.
+constexpr size_t small_block_size = size_t(1) << (second_level_count_log2 + alignment_log2);
+
+size_t
+find_last_set(uint64_t value)
+{
+#if defined(__GNUC__) || defined(__clang__)
+  return 63 - static_cast<size_t>(__builtin_clzll(value));
+#else
+  size_t bit = 0;
+  while (value >>= 1) {
+    ++bit;
+  }
+  return bit;
+#endif
+}
+
+size_t
+find_first_set(uint64_t value)
+{
+#if defined(__GNUC__) || defined(__clang__)
+  return static_cast<size_t>(__builtin_ctzll(value));
+#else
+  size_t bit = 0;
+  while (!(value & 1)) {
+    value >>= 1;
+    ++bit;
+  }
+  return bit;
+#endif
+}
+
+struct SizeClass
+{
+  size_t first_level;
+  size_t second_level;
+};
+
+SizeClass
+get_size_class(size_t size)
+{
+  if (size < small_block_size) {
+    return {0, size / alignment};
+  }
+  const size_t last_set = find_last_set(size);
+  return {
+    last_set - (second_level_count_log2 + alignment_log2) + 1,
+    (size >> (last_set - second_level_count_log2)) ^ (size_t(1) << second_level_count_log2)};
+}
+
+// Round the size up to the next size class, whose blocks are all large enough.
+size_t
+round_up_to_size_class(size_t size)
+{
+  if (size < small_block_size) {
+    return size;
+  }
+  return size + (size_t(1) << (find_last_set(size) - second_level_count_log2)) - 1;
+}
+
+size_t
+get_size(const TLSFBlock * block)
+{
+  return block->size_and_flags & ~flags_mask;
+}
+
+void
+set_size(TLSFBlock * block, size_t size)
+{
+  block->size_and_flags = size | (block->size_and_flags & flags_mask);
+}
+
+bool
+is_free(const TLSFBlock * block)
+{
+  return block->size_and_flags & free_flag;
+}
+
+void
+set_free(TLSFBlock * block, bool free)
+{
+  block->size_and_flags = free ?
+    block->size_and_flags | free_flag : block->size_and_flags & ~free_flag;
+}
+
+bool
+is_prev_free(const TLSFBlock * block)
+{
+  return block->size_and_flags & prev_free_flag;
+}
+
+void
+set_prev_free(TLSFBlock * block, bool prev_free)
+{
+  block->size_and_flags = prev_free ?
+    block->size_and_flags | prev_free_flag : block->size_and_flags & ~prev_free_flag;
+}
+
+unsigned char *
+get_memory(TLSFBlock * block)
+{
+  return reinterpret_cast<unsigned char *>(block) + header_size;
+}
+
+TLSFBlock *
+get_block(void * memory)
+{
+  return reinterpret_cast<TLSFBlock *>(static_cast<unsigned char *>(memory) - header_size);
+}
+
+TLSFBlock *
+get_next_physical(TLSFBlock * block)
+{
+  return reinterpret_cast<TLSFBlock *>(get_memory(block) + get_size(block));
+}
+
+}  // namespace
+
+TLSFPool::TLSFPool(size_t pool_size)
+: storage_(pool_size / sizeof(std::max_align_t)),
+  used_size_(0),
+  first_level_bitmap_(0)
+{
+  static_assert(
+    second_level_count_log2 == TLSFPool::second_level_count_log2,
+    "inconsistent size classes");
+  const size_t storage_size = storage_.size() * sizeof(std::max_align_t);
+  // A first block and the sentinel block ending the pool.
+  if (storage_size < 2 * header_size + min_block_size) {
+    throw std::invalid_argument("TLSF pool is too small");
+  }
+  second_level_bitmaps_.fill(0);
+  for (auto & free_blocks : free_blocks_) {
+    free_blocks.fill(nullptr);
+  }
+
+  auto first = reinterpret_cast<Block *>(storage_.data());
+  first->size_and_flags = 0;
+  set_size(first, storage_size - 2 * header_size);
+  set_free(first, true);
+  auto sentinel = get_next_physical(first);
+  sentinel->size_and_flags = 0;
+  sentinel->prev_physical = first;
+  set_prev_free(sentinel, true);
+  insert_free_block(first);
+}
+
+TLSFPool::~TLSFPool()
+{}
+
+void *
+TLSFPool::allocate(size_t size)
+{
+  const size_t storage_size = storage_.size() * sizeof(std::max_align_t);
+  if (size > storage_size) {
+    throw std::bad_alloc();
+  }
+  size = std::max(align_up(size), min_block_size);
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  Block * block = take_free_block(size);
+  if (nullptr == block) {
+    throw std::bad_alloc();
+  }
+
+  // Give back the end of the block if it can be a block on its own.
+  const size_t block_size = get_size(block);
+  if (block_size >= size + header_size + min_block_size) {
+    auto remainder = reinterpret_cast<Block *>(get_memory(block) + size);
+    remainder->size_and_flags = 0;
+    set_size(remainder, block_size - size - header_size);
+    set_free(remainder, true);
+    set_size(block, size);
+    get_next_physical(remainder)->prev_physical = remainder;
+    insert_free_block(remainder);
+  } else {
+    set_prev_free(get_next_physical(block), false);
+  }
+  set_free(block, false);
+  used_size_ += header_size + get_size(block);
+  return get_memory(block);
+}
+
+void
+TLSFPool::deallocate(void * pointer)
+{
+  if (nullptr == pointer || !contains(pointer)) {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  Block * block = get_block(pointer);
+  used_size_ -= header_size + get_size(block);
+  set_free(block, true);
+
+  // Merge with the adjacent free blocks.
+  if (is_prev_free(block)) {
+    Block * prev = block->prev_physical;
+    remove_free_block(prev);
+    set_size(prev, get_size(prev) + header_size + get_size(block));
+    block = prev;
+  }
+  Block * next = get_next_physical(block);
+  if (is_free(next)) {
+    remove_free_block(next);
+    set_size(block, get_size(block) + header_size + get_size(next));
+    next = get_next_physical(block);
+  }
+  next->prev_physical = block;
+  set_prev_free(next, true);
+  insert_free_block(block);
+}
+
+bool
+TLSFPool::contains(const void * pointer) const
+{
+  auto first = reinterpret_cast<const unsigned char *>(storage_.data());
+  auto address = static_cast<const unsigned char *>(pointer);
+  return address >= first && address < first + storage_.size() * sizeof(std::max_align_t);
+}
+
+size_t
+TLSFPool::get_pool_size() const
+{
+  return storage_.size() * sizeof(std::max_align_t);
+}
+
+size_t
+TLSFPool::get_used_size() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return used_size_;
+}
+
+TLSFPool::SharedPtr
+TLSFPool::get_default_pool()
+{
+  static auto default_pool = std::make_shared<TLSFPool>();
+  return default_pool;
+}
+
+void
+TLSFPool::insert_free_block(Block * block)
+{
+  const SizeClass size_class = get_size_class(get_size(block));
+  Block *& head = free_blocks_[size_class.first_level][size_class.second_level];
+  block->prev_free = nullptr;
+  block->next_free = head;
+  if (nullptr != head) {
+    head->prev_free = block;
+  }
+  head = block;
+  first_level_bitmap_ |= uint64_t(1) << size_class.first_level;
+  second_level_bitmaps_[size_class.first_level] |= uint32_t(1) << size_class.second_level;
+}
+
+void
+TLSFPool::remove_free_block(Block * block)
+{
+  const SizeClass size_class = get_size_class(get_size(block));
+  if (nullptr != block->prev_free) {
+    block->prev_free->next_free = block->next_free;
+  }
+  if (nullptr != block->next_free) {
+    block->next_free->prev_free = block->prev_free;
+  }
+  Block *& head = free_blocks_[size_class.first_level][size_class.second_level];
+  if (head == block) {
+    head = block->next_free;
+    if (nullptr == head) {
+      auto & second_level_bitmap = second_level_bitmaps_[size_class.first_level];
+      second_level_bitmap &= ~(uint32_t(1) << size_class.second_level);
+      if (0 == second_level_bitmap) {
+        first_level_bitmap_ &= ~(uint64_t(1) << size_class.first_level);
+      }
+    }
+  }
+}
+
+TLSFPool::Block *
+TLSFPool::take_free_block(size_t size)
+{
+  const SizeClass size_class = get_size_class(round_up_to_size_class(size));
+  if (size_class.first_level >= first_level_count) {
+    return nullptr;
+  }
+  size_t first_level = size_class.first_level;
+  // Look for the first non-empty class in this first level, from the second level.
+  uint32_t second_level_bitmap =
+    second_level_bitmaps_[first_level] & (~uint32_t(0) << size_class.second_level);
+  if (0 == second_level_bitmap) {
+    // Otherwise, in the next non-empty first level.
+    if (first_level + 1 >= first_level_count) {
+      return nullptr;
+    }
+    const uint64_t first_level_bitmap = first_level_bitmap_ & (~uint64_t(0) << (first_level + 1));
+    if (0 == first_level_bitmap) {
+      return nullptr;
+    }
+    first_level = find_first_set(first_level_bitmap);
+    second_level_bitmap = second_level_bitmaps_[first_level];
+  }
+  Block * block = free_blocks_[first_level][find_first_set(second_level_bitmap)];
+  remove_free_block(block);
+  return block;
+}
@@ -0,0 +1,386 @@
+// Copyright 2021 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "rclcpp/async_logging.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "rcl/logging.h"
+
+#include "./async_logging_pipeline.hpp"
+#include "./detail/rosout_batcher.hpp"
+#include "./logging_mutex.hpp"
+
+namespace
+{
+
+using namespace std::chrono_literals;
+
+/// A message in the queue, with copies of what the output handlers need.
+struct Record
+{
+  std::atomic<size_t> sequence{0};
+  int severity = 0;
+  rcutils_time_point_value_t timestamp = 0;
+  bool has_location = false;
+  bool has_name = false;
+  size_t line_number = 0;
+  char function_name[128];
+  char file_name[256];
+  char name[256];
+};
+
+template<size_t N>
+void
+copy_truncated(char (&destination)[N], const char * source)
+{
+  size_t length = strnlen(source, N - 1);
+  std::memcpy(destination, source, length);
+  destination[length] = '\0';
+}
+
+void
+output(
+  const rcutils_log_location_t * location,
+  int severity, const char * name, rcutils_time_point_value_t timestamp,
+  const char * format, ...)
+{
+  va_list args;
+  va_start(args, format);
+  rclcpp::detail::batch_rosout_record(location, severity, name, timestamp, format, &args);
+  rcl_logging_multiple_output_handler(location, severity, name, timestamp, format, &args);
+  va_end(args);
+}
+
+/// Set on the threads outputting the queued messages, whose messages are output synchronously.
+thread_local bool is_outputting = false;
+
+/// Bounded multiple producers queue of messages, emptied by whoever holds the logging mutex.
+/**
+ * The producers claim a slot by incrementing the tail, and publish it through
+ * the sequence number of the slot, see
+ * https://www.1024cores.net/home/lock-free-algorithms/queues/bounded-mpmc-queue.
+ * Taking the messages out of the queue is serialized by the global logging
+ * mutex, which the output handlers need anyway.
+ */
+class Pipeline
+{
+public:
+  ~Pipeline()
+  {
+    // The last context was not shut down, just stop the thread.
+    if (thread_.joinable()) {
+      {
+        std::lock_guard<std::mutex> lock(wake_mutex_);
+        stopping_ = true;
+      }
+      wake_cv_.notify_all();
+      thread_.join();
+    }
+  }
+
+  void
+  start(const rclcpp::async_logging::AsyncLoggingOptions & options)
+  {
+    if (running_.load()) {
+      return;
+    }
+    size_t capacity = 1;
+    while (capacity < options.capacity) {
+      capacity <<= 1;
+    }
+    mask_ = capacity - 1;
+    max_message_size_ = options.max_message_size;
+    overflow_policy_ = options.overflow_policy;
+    records_.reset(new Record[capacity]);
+    for (size_t i = 0; i < capacity; ++i) {
+      records_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+    messages_.assign(capacity * max_message_size_, '\0');
+    head_.store(0, std::memory_order_relaxed);
+    tail_.store(0, std::memory_order_relaxed);
+    logging_mutex_ = get_global_logging_mutex();
+    stopping_ = false;
+    thread_ = std::thread(&Pipeline::run, this);
+    running_.store(true);
+  }
+
+  void
+  stop()
+  {
+    if (!running_.exchange(false)) {
+      return;
+    }
+    {
+      std::lock_guard<std::mutex> lock(wake_mutex_);
+      stopping_ = true;
+    }
+    wake_cv_.notify_all();
+    thread_.join();
+    // The caller holds the logging mutex, output what is left, including the
+    // messages of the threads which saw the pipeline running.
+    is_outputting = true;
+    while (in_flight_.load() != 0) {
+      drain();
+      std::this_thread::yield();
+    }
+    drain();
+    is_outputting = false;
+  }
+
+  bool
+  log(
+    const rcutils_log_location_t * location,
+    int severity, const char * name, rcutils_time_point_value_t timestamp,
+    const char * format, va_list * args)
+  {
+    if (is_outputting) {
+      return false;
+    }
+    // Counted before checking running_, so that stop() waits for the message.
+    in_flight_.fetch_add(1);
+    if (!running_.load()) {
+      in_flight_.fetch_sub(1);
+      return false;
+    }
+    size_t position;
+    Record * record;
+    while (!claim(position, record)) {
+      if (rclcpp::async_logging::OverflowPolicy::Drop == overflow_policy_) {
+        dropped_count.fetch_add(1, std::memory_order_relaxed);
+        in_flight_.fetch_sub(1);
+        return true;
+      }
+      if (!running_.load()) {
+        in_flight_.fetch_sub(1);
+        return false;
+      }
+      std::unique_lock<std::recursive_mutex> lock(*logging_mutex_, std::try_to_lock);
+      if (lock.owns_lock()) {
+        is_outputting = true;
+        drain();
+        is_outputting = false;
+      } else {
+        std::this_thread::yield();
+      }
+    }
+
+    record->severity = severity;
+    record->timestamp = timestamp;
+    record->has_location = location != nullptr;
+    if (location) {
+      copy_truncated(record->function_name, location->function_name);
+      copy_truncated(record->file_name, location->file_name);
+      record->line_number = location->line_number;
+    }
+    record->has_name = name != nullptr;
+    if (name) {
+      copy_truncated(record->name, name);
+    }
+    va_list args_copy;
+    va_copy(args_copy, *args);
+    vsnprintf(message(position), max_message_size_, format, args_copy);
+    va_end(args_copy);
+
+    record->sequence.store(position + 1, std::memory_order_release);
+    in_flight_.fetch_sub(1);
+    wake_cv_.notify_one();
+    return true;
+  }
+
+  bool
+  is_running() const
+  {
+    return running_.load();
+  }
+
+  void
+  flush()
+  {
+    if (!running_.load()) {
+      return;
+    }
+    std::lock_guard<std::recursive_mutex> lock(*logging_mutex_);
+    // Checked again, as stop() drains the queue before releasing the mutex.
+    if (running_.load()) {
+      bool was_outputting = is_outputting;
+      is_outputting = true;
+      drain();
+      is_outputting = was_outputting;
+    }
+  }
+
+  std::atomic<uint64_t> dropped_count{0};
+
+private:
+  bool
+  claim(size_t & position, Record *& record)
+  {
+    position = tail_.load(std::memory_order_relaxed);
+    while (true) {
+      record = &records_[position & mask_];
+      size_t sequence = record->sequence.load(std::memory_order_acquire);
+      if (sequence == position) {
+        if (tail_.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+          return true;
+        }
+      } else if (sequence < position) {
+        // The slot still holds the message of the previous round, the queue is full.
+        return false;
+      } else {
+        position = tail_.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  char *
+  message(size_t position)
+  {
+    return &messages_[(position & mask_) * max_message_size_];
+  }
+
+  bool
+  empty() const
+  {
+    size_t position = head_.load(std::memory_order_relaxed);
+    return records_[position & mask_].sequence.load(std::memory_order_acquire) != position + 1;
+  }
+
+  /// Output the published messages, holding the logging mutex.
+  void
+  drain()
+  {
+    size_t position = head_.load(std::memory_order_relaxed);
+    while (true) {
+      Record & record = records_[position & mask_];
+      if (record.sequence.load(std::memory_order_acquire) != position + 1) {
+        break;
+      }
+      rcutils_log_location_t location = {
+        record.function_name, record.file_name, record.line_number};
+      output(
+        record.has_location ? &location : nullptr, record.severity,
+        record.has_name ? record.name : nullptr, record.timestamp, "%s", message(position));
+      record.sequence.store(position + mask_ + 1, std::memory_order_release);
+      ++position;
+      head_.store(position, std::memory_order_relaxed);
+    }
+  }
+
+  void
+  run()
+  {
+    is_outputting = true;
+    while (true) {
+      {
+        std::unique_lock<std::mutex> lock(wake_mutex_);
+        // The producers notify without the lock, a missed notification delays the output a bit.
+        wake_cv_.wait_for(lock, 10ms, [this]() {return stopping_ || !empty();});
+        if (stopping_) {
+          return;
+        }
+      }
+      // stop() joins this thread holding the logging mutex, do not block on it.
+      std::unique_lock<std::recursive_mutex> lock(*logging_mutex_, std::try_to_lock);
+      if (!lock.owns_lock()) {
+        std::this_thread::sleep_for(100us);
+        continue;
+      }
+      drain();
+    }
+  }
+
+  std::atomic<bool> running_{false};
+  std::atomic<size_t> in_flight_{0};
+  std::atomic<size_t> tail_{0};
+  // Only written holding the logging mutex, atomic to be read by the output thread without it.
+  std::atomic<size_t> head_{0};
+  size_t mask_ = 0;
+  size_t max_message_size_ = 0;
+  rclcpp::async_logging::OverflowPolicy overflow_policy_ =
+    rclcpp::async_logging::OverflowPolicy::Drop;
+  std::unique_ptr<Record[]> records_;
+  std::vector<char> messages_;
+  std::shared_ptr<std::recursive_mutex> logging_mutex_;
+
+  std::mutex wake_mutex_;
+  std::condition_variable wake_cv_;
+  bool stopping_ = false;
+  std::thread thread_;
+};
+
+Pipeline &
+get_pipeline()
+{
+  static Pipeline pipeline;
+  return pipeline;
+}
+
+}  // namespace
+
+void
+start_async_logging(const rclcpp::async_logging::AsyncLoggingOptions & options)
+{
+  get_pipeline().start(options);
+}
+
+void
+stop_async_logging()
+{
+  get_pipeline().stop();
+}
+
+bool
+async_log(
+  const rcutils_log_location_t * location,
+  int severity, const char * name, rcutils_time_point_value_t timestamp,
+  const char * format, va_list * args)
+{
+  return get_pipeline().log(location, severity, name, timestamp, format, args);
+}
+
+namespace rclcpp
+{
+namespace async_logging
+{
+
+bool
+is_enabled()
+{
+  return get_pipeline().is_running();
+}
+
+uint64_t
+get_dropped_count()
+{
+  return get_pipeline().dropped_count.load(std::memory_order_relaxed);
+}
+
+void
+flush()
+{
+  get_pipeline().flush();
+}
+
+}  // namespace async_logging
+}  // namespace rclcpp
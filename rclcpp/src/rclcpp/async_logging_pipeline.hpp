@@ -0,0 +1,54 @@
+// Copyright 2021 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__ASYNC_LOGGING_PIPELINE_HPP_
+#define RCLCPP__ASYNC_LOGGING_PIPELINE_HPP_
+
+#include <cstdarg>
+
+#include "rcutils/logging.h"
+#include "rcutils/time.h"
+
+#include "rclcpp/async_logging.hpp"
+#include "rclcpp/visibility_control.hpp"
+
+/// Start the output thread of the asynchronous logging.
+/**
+ * Called when the logging system is configured, holding the global logging mutex.
+ */
+RCLCPP_LOCAL
+void
+start_async_logging(const rclcpp::async_logging::AsyncLoggingOptions & options);
+
+/// Output the messages left, and stop the output thread of the asynchronous logging.
+/**
+ * Called before the logging system is finalized, holding the global logging mutex.
+ */
+RCLCPP_LOCAL
+void
+stop_async_logging();
+
+/// Queue a message to be output by the output thread.
+/**
+ * \return false if the message must be output synchronously instead, because
+ *   the asynchronous logging is not enabled or the caller is the output thread.
+ */
+RCLCPP_LOCAL
+bool
+async_log(
+  const rcutils_log_location_t * location,
+  int severity, const char * name, rcutils_time_point_value_t timestamp,
+  const char * format, va_list * args);
+
+#endif  // RCLCPP__ASYNC_LOGGING_PIPELINE_HPP_
@@ -14,6 +14,7 @@
 
 #include "rclcpp/callback_group.hpp"
 
+#include <memory>
 #include <vector>
 
 using rclcpp::CallbackGroup;
@@ -21,10 +22,13 @@ using rclcpp::CallbackGroupType;
 
 CallbackGroup::CallbackGroup(
   CallbackGroupType group_type,
-  bool automatically_add_to_executor_with_node)
+  bool automatically_add_to_executor_with_node,
+  int priority)
 : type_(group_type), associated_with_executor_(false),
   can_be_taken_from_(true),
-  automatically_add_to_executor_with_node_(automatically_add_to_executor_with_node)
+  automatically_add_to_executor_with_node_(automatically_add_to_executor_with_node),
+  priority_(priority),
+  entities_snapshot_(std::make_unique<EntitiesSnapshot>())
 {}
 
 
@@ -40,12 +44,24 @@ CallbackGroup::type() const
   return type_;
 }
 
+int
+CallbackGroup::priority() const
+{
+  return priority_;
+}
+
 std::atomic_bool &
 CallbackGroup::get_associated_with_executor_atomic()
 {
   return associated_with_executor_;
 }
 
+uint64_t
+CallbackGroup::get_entities_version() const
+{
+  return entities_version_.load(std::memory_order_acquire);
+}
+
 bool
 CallbackGroup::automatically_add_to_executor_with_node() const
 {
@@ -64,6 +80,7 @@ CallbackGroup::add_subscription(
       subscription_ptrs_.end(),
       [](rclcpp::SubscriptionBase::WeakPtr x) {return x.expired();}),
     subscription_ptrs_.end());
+  publish_entities();
 }
 
 void
@@ -77,6 +94,7 @@ CallbackGroup::add_timer(const rclcpp::TimerBase::SharedPtr timer_ptr)
       timer_ptrs_.end(),
       [](rclcpp::TimerBase::WeakPtr x) {return x.expired();}),
     timer_ptrs_.end());
+  publish_entities();
 }
 
 void
@@ -90,6 +108,7 @@ CallbackGroup::add_service(const rclcpp::ServiceBase::SharedPtr service_ptr)
       service_ptrs_.end(),
       [](rclcpp::ServiceBase::WeakPtr x) {return x.expired();}),
     service_ptrs_.end());
+  publish_entities();
 }
 
 void
@@ -103,6 +122,7 @@ CallbackGroup::add_client(const rclcpp::ClientBase::SharedPtr client_ptr)
       client_ptrs_.end(),
       [](rclcpp::ClientBase::WeakPtr x) {return x.expired();}),
     client_ptrs_.end());
+  publish_entities();
 }
 
 void
@@ -116,6 +136,7 @@ CallbackGroup::add_waitable(const rclcpp::Waitable::SharedPtr waitable_ptr)
       waitable_ptrs_.end(),
       [](rclcpp::Waitable::WeakPtr x) {return x.expired();}),
     waitable_ptrs_.end());
+  publish_entities();
 }
 
 void
@@ -126,7 +147,23 @@ CallbackGroup::remove_waitable(const rclcpp::Waitable::SharedPtr waitable_ptr) n
     const auto shared_ptr = iter->lock();
     if (shared_ptr.get() == waitable_ptr.get()) {
       waitable_ptrs_.erase(iter);
+      publish_entities();
       break;
     }
   }
 }
+
+void
+CallbackGroup::publish_entities()
+{
+  auto snapshot = std::make_unique<EntitiesSnapshot>();
+  snapshot->subscriptions = subscription_ptrs_;
+  snapshot->timers = timer_ptrs_;
+  snapshot->services = service_ptrs_;
+  snapshot->clients = client_ptrs_;
+  snapshot->waitables = waitable_ptrs_;
+  entities_snapshot_.update(std::move(snapshot));
+  // Changed once the snapshot is published, so that what is collected after reading a version
+  // includes at least the entities of that version.
+  entities_version_.fetch_add(1u, std::memory_order_release);
+}
@@ -19,11 +19,16 @@
 #include <cstdio>
 #include <memory>
 #include <string>
+#include <utility>
 
 #include "rcl/graph.h"
+#include "rcl/guard_condition.h"
 #include "rcl/node.h"
+#include "rcl/timer.h"
 #include "rcl/wait.h"
+#include "rclcpp/callback_group.hpp"
 #include "rclcpp/exceptions.hpp"
+#include "rclcpp/experimental/intra_process_manager.hpp"
 #include "rclcpp/node_interfaces/node_base_interface.hpp"
 #include "rclcpp/node_interfaces/node_graph_interface.hpp"
 #include "rclcpp/utilities.hpp"
@@ -127,58 +132,15 @@ ClientBase::service_is_ready() const
 bool
 ClientBase::wait_for_service_nanoseconds(std::chrono::nanoseconds timeout)
 {
-  auto start = std::chrono::steady_clock::now();
-  // make an event to reuse, rather than create a new one each time
   auto node_ptr = node_graph_.lock();
   if (!node_ptr) {
     throw InvalidNodeError();
   }
-  // check to see if the server is ready immediately
-  if (this->service_is_ready()) {
-    return true;
-  }
-  if (timeout == std::chrono::nanoseconds(0)) {
-    // check was non-blocking, return immediately
-    return false;
-  }
-  auto event = node_ptr->get_graph_event();
-  // update the time even on the first loop to account for time spent in the first call
-  // to this->server_is_ready()
-  std::chrono::nanoseconds time_to_wait =
-    timeout > std::chrono::nanoseconds(0) ?
-    timeout - (std::chrono::steady_clock::now() - start) :
-    std::chrono::nanoseconds::max();
-  if (time_to_wait < std::chrono::nanoseconds(0)) {
-    // Do not allow the time_to_wait to become negative when timeout was originally positive.
-    // Setting time_to_wait to 0 will allow one non-blocking wait because of the do-while.
-    time_to_wait = std::chrono::nanoseconds(0);
-  }
-  do {
-    if (!rclcpp::ok(this->context_)) {
-      return false;
-    }
-    // Limit each wait to 100ms to workaround an issue specific to the Connext RMW implementation.
-    // A race condition means that graph changes for services becoming available may trigger the
-    // wait set to wake up, but then not be reported as ready immediately after the wake up
-    // (see https://github.com/ros2/rmw_connext/issues/201)
-    // If no other graph events occur, the wait set will not be triggered again until the timeout
-    // has been reached, despite the service being available, so we artificially limit the wait
-    // time to limit the delay.
-    node_ptr->wait_for_graph_change(
-      event, std::min(time_to_wait, std::chrono::nanoseconds(RCL_MS_TO_NS(100))));
-    // Because of the aforementioned race condition, we check if the service is ready even if the
-    // graph event wasn't triggered.
-    event->check_and_clear();
-    if (this->service_is_ready()) {
-      return true;
-    }
-    // server is not ready, loop if there is time left
-    if (timeout > std::chrono::nanoseconds(0)) {
-      time_to_wait = timeout - (std::chrono::steady_clock::now() - start);
-    }
-    // if timeout is negative, time_to_wait will never reach zero
-  } while (time_to_wait > std::chrono::nanoseconds(0));
-  return false;  // timeout exceeded while waiting for the server to be ready
+  // The graph listener checks whether the server is ready on each graph change, so that this
+  // thread is only woken up once it is, instead of on every change of the graph.
+  return node_ptr->wait_for_graph_predicate(
+    [this]() {return this->service_is_ready();},
+    timeout);
 }
 
 rcl_node_t *
@@ -198,3 +160,111 @@ ClientBase::exchange_in_use_by_wait_set_state(bool in_use_state)
 {
   return in_use_by_wait_set_.exchange(in_use_state);
 }
+
+rclcpp::Waitable::SharedPtr
+ClientBase::get_intra_process_waitable() const
+{
+  return client_intra_process_base_;
+}
+
+void
+ClientBase::setup_intra_process(
+  rclcpp::experimental::ClientIntraProcessBase::SharedPtr client_intra_process)
+{
+  using rclcpp::experimental::IntraProcessManager;
+  weak_ipm_ = context_->get_sub_context<IntraProcessManager>();
+  client_intra_process_base_ = std::move(client_intra_process);
+}
+
+rclcpp::experimental::ServiceIntraProcessBase::SharedPtr
+ClientBase::find_intra_process_service() const
+{
+  auto ipm = weak_ipm_.lock();
+  if (!ipm) {
+    return nullptr;
+  }
+  return ipm->find_service_intra_process(get_service_name());
+}
+
+rclcpp::TimerBase::SharedPtr
+ClientBase::get_request_timeout_timer() const
+{
+  return request_timeout_timer_;
+}
+
+void
+ClientBase::set_max_pending_requests(size_t max_pending_requests)
+{
+  max_pending_requests_.store(max_pending_requests);
+}
+
+size_t
+ClientBase::get_max_pending_requests() const
+{
+  return max_pending_requests_.load();
+}
+
+void
+ClientBase::setup_request_timeouts(
+  std::weak_ptr<rclcpp::node_interfaces::NodeBaseInterface> node_base,
+  std::weak_ptr<rclcpp::CallbackGroup> group)
+{
+  weak_node_base_ = std::move(node_base);
+  weak_group_ = std::move(group);
+}
+
+bool
+ClientBase::request_timeouts_enabled() const
+{
+  return !weak_group_.expired();
+}
+
+void
+ClientBase::add_request_timeout_timer(rclcpp::TimerBase::SharedPtr request_timeout_timer)
+{
+  auto group = weak_group_.lock();
+  if (!group) {
+    throw std::runtime_error("cannot add the request timeout timer, callback group is gone");
+  }
+  group->add_timer(request_timeout_timer);
+  request_timeout_timer_ = std::move(request_timeout_timer);
+}
+
+void
+ClientBase::schedule_request_timeout(std::chrono::nanoseconds delay, bool wake_executor)
+{
+  // A period of 0 would make the timer fire continuously.
+  int64_t period = std::max<int64_t>(delay.count(), 1);
+  int64_t old_period;
+  rcl_ret_t ret = rcl_timer_exchange_period(
+    request_timeout_timer_->get_timer_handle().get(), period, &old_period);
+  if (ret != RCL_RET_OK) {
+    throw_from_rcl_error(ret, "failed to set the period of the request timeout timer");
+  }
+  // Resetting the timer makes the new period start now, and uncancels it.
+  request_timeout_timer_->reset();
+  if (!wake_executor) {
+    return;
+  }
+  // The executor computed how long to wait with the previous expiry.
+  auto node_base = weak_node_base_.lock();
+  if (!node_base) {
+    return;
+  }
+  auto notify_guard_condition_lock = node_base->acquire_notify_guard_condition_lock();
+  ret = rcl_trigger_guard_condition(node_base->get_notify_guard_condition());
+  if (ret != RCL_RET_OK) {
+    throw_from_rcl_error(ret, "failed to wake up the executor for a request timeout");
+  }
+}
+
+void
+ClientBase::check_pending_requests_limit(size_t number_of_pending_requests) const
+{
+  size_t max_pending_requests = max_pending_requests_.load();
+  if (max_pending_requests != 0 && number_of_pending_requests >= max_pending_requests) {
+    throw rclcpp::exceptions::TooManyPendingRequestsError(
+            std::string("cannot send a request to service '") + get_service_name() + "', " +
+            std::to_string(number_of_pending_requests) + " requests are pending already");
+  }
+}
@@ -14,10 +14,19 @@
 
 #include "rclcpp/clock.hpp"
 
+#include <chrono>
+#include <condition_variable>
 #include <memory>
+#include <mutex>
+#include <stdexcept>
 #include <thread>
 
+#if defined(__linux__)
+#include <time.h>
+#endif
+
 #include "rclcpp/exceptions.hpp"
+#include "rcpputils/scope_exit.hpp"
 
 #include "rcutils/logging_macros.h"
 
@@ -66,6 +75,21 @@ Clock::~Clock() {}
 Time
 Clock::now()
 {
+#if defined(__linux__)
+  // The steady and system clocks of rcl read these POSIX clocks, which goes
+  // through the vDSO, so read them directly rather than through the checks and
+  // indirections of rcl_clock_get_now(), the clock being valid since its construction.
+  const rcl_clock_type_t clock_type = impl_->rcl_clock_.type;
+  if (RCL_STEADY_TIME == clock_type || RCL_SYSTEM_TIME == clock_type) {
+    timespec now_timespec;
+    clock_gettime(
+      RCL_STEADY_TIME == clock_type ? CLOCK_MONOTONIC : CLOCK_REALTIME, &now_timespec);
+    return Time(
+      RCUTILS_S_TO_NS(static_cast<int64_t>(now_timespec.tv_sec)) + now_timespec.tv_nsec,
+      clock_type);
+  }
+#endif
+  // ROS time is read from atomics by rcl, without any lock.
   Time now(0, 0, impl_->rcl_clock_.type);
 
   auto ret = rcl_clock_get_now(&impl_->rcl_clock_, &now.rcl_time_.nanoseconds);
@@ -76,6 +100,105 @@ Clock::now()
   return now;
 }
 
+bool
+Clock::sleep_until(Time until, Context::SharedPtr context)
+{
+  if (!context || !context->is_valid()) {
+    throw std::runtime_error("context cannot be slept with because it's invalid");
+  }
+  const auto this_clock_type = get_clock_type();
+  if (until.get_clock_type() != this_clock_type) {
+    throw std::runtime_error("until's clock type does not match this clock's type");
+  }
+
+  std::mutex mutex;
+  std::condition_variable cv;
+  bool time_source_changed = false;
+
+  // Wake this thread up if the context is shut down.
+  // The callback locks the mutex, so that the notification is not lost between
+  // checking the context and waiting.
+  auto shutdown_callback_handle = context->add_on_shutdown_callback(
+    [&mutex, &cv]() {
+      std::lock_guard<std::mutex> lock(mutex);
+      cv.notify_one();
+    });
+  auto remove_shutdown_callback = rcpputils::make_scope_exit(
+    [&context, &shutdown_callback_handle]() {
+      context->remove_on_shutdown_callback(shutdown_callback_handle);
+    });
+
+  if (this_clock_type == RCL_STEADY_TIME) {
+    // The epoch of the rcl steady clock may differ from the one of std::chrono::steady_clock.
+    const Time rcl_entry = now();
+    const auto chrono_entry = std::chrono::steady_clock::now();
+    const auto chrono_until = chrono_entry +
+      std::chrono::nanoseconds((until - rcl_entry).nanoseconds());
+    std::unique_lock<std::mutex> lock(mutex);
+    while (now() < until && context->is_valid()) {
+      cv.wait_until(lock, chrono_until);
+    }
+  } else if (this_clock_type == RCL_SYSTEM_TIME) {
+    const auto system_until = std::chrono::system_clock::time_point(
+      std::chrono::duration_cast<std::chrono::system_clock::duration>(
+        std::chrono::nanoseconds(until.nanoseconds())));
+    std::unique_lock<std::mutex> lock(mutex);
+    while (now() < until && context->is_valid()) {
+      cv.wait_until(lock, system_until);
+    }
+  } else if (this_clock_type == RCL_ROS_TIME) {
+    // Be called back on any change of the time, to check whether until was
+    // reached while ROS time is active, and on ROS time being (de)activated.
+    rcl_jump_threshold_t threshold;
+    threshold.on_clock_change = true;
+    // Zero disables them, so these are the smallest changes of time noticed.
+    threshold.min_backward.nanoseconds = -1;
+    threshold.min_forward.nanoseconds = 1;
+    // Created before locking the mutex and destroyed after unlocking it, as
+    // both take the mutex of this clock, which is held while calling back.
+    auto jump_handler = create_jump_callback(
+      nullptr,
+      [&mutex, &cv, &time_source_changed](const rcl_time_jump_t & jump) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (jump.clock_change != RCL_ROS_TIME_NO_CHANGE) {
+          time_source_changed = true;
+        }
+        cv.notify_one();
+      },
+      threshold);
+    std::unique_lock<std::mutex> lock(mutex);
+    if (!ros_time_is_active()) {
+      const auto system_until = std::chrono::system_clock::time_point(
+        std::chrono::duration_cast<std::chrono::system_clock::duration>(
+          std::chrono::nanoseconds(until.nanoseconds())));
+      while (now() < until && context->is_valid() && !time_source_changed) {
+        cv.wait_until(lock, system_until);
+      }
+    } else {
+      // Every update of the time notifies the condition variable.
+      while (now() < until && context->is_valid() && !time_source_changed) {
+        cv.wait(lock);
+      }
+    }
+    if (time_source_changed) {
+      return false;
+    }
+  } else {
+    throw std::runtime_error("cannot sleep with a clock of an unknown type");
+  }
+
+  if (!context->is_valid()) {
+    return false;
+  }
+  return now() >= until;
+}
+
+bool
+Clock::sleep_for(Duration rel_time, Context::SharedPtr context)
+{
+  return sleep_until(now() + rel_time, context);
+}
+
 bool
 Clock::ros_time_is_active()
 {
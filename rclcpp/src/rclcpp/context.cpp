@@ -17,22 +17,28 @@
 #include <memory>
 #include <mutex>
 #include <sstream>
+#include <stdexcept>
 #include <string>
 #include <vector>
 #include <utility>
 
+#include "rcl/arguments.h"
 #include "rcl/init.h"
 #include "rcl/logging.h"
 
+#include "rclcpp/allocation_tracking.hpp"
 #include "rclcpp/detail/utilities.hpp"
 #include "rclcpp/exceptions.hpp"
 #include "rclcpp/logging.hpp"
+#include "rclcpp/startup_profiling.hpp"
 
 #include "rcutils/error_handling.h"
 #include "rcutils/macros.h"
 
 #include "rmw/impl/cpp/demangle.hpp"
 
+#include "./async_logging_pipeline.hpp"
+#include "./detail/rosout_batcher.hpp"
 #include "./logging_mutex.hpp"
 
 using rclcpp::Context;
@@ -129,9 +135,13 @@ rclcpp_logging_output_handler(
   const char * format, va_list * args)
 {
   try {
+    if (async_log(location, severity, name, timestamp, format, args)) {
+      return;
+    }
     std::shared_ptr<std::recursive_mutex> logging_mutex;
     logging_mutex = get_global_logging_mutex();
     std::lock_guard<std::recursive_mutex> guard(*logging_mutex);
+    rclcpp::detail::batch_rosout_record(location, severity, name, timestamp, format, args);
     return rcl_logging_multiple_output_handler(
       location, severity, name, timestamp, format, args);
   } catch (std::exception & ex) {
@@ -198,18 +208,44 @@ Context::init(
   if (this->is_valid()) {
     throw rclcpp::ContextAlreadyInitialized();
   }
-  this->clean_up();
-  rcl_context_t * context = new rcl_context_t;
-  if (!context) {
-    throw std::runtime_error("failed to allocate memory for rcl context");
+  if (init_options.startup_profiling()) {
+    startup_profiling::enable();
   }
-  *context = rcl_get_zero_initialized_context();
-  rcl_ret_t ret = rcl_init(argc, argv, init_options.get_rcl_init_options(), context);
-  if (RCL_RET_OK != ret) {
-    delete context;
-    rclcpp::exceptions::throw_from_rcl_error(ret, "failed to initialize rcl");
+  startup_profiling::ScopedPhase profiled_phase("context init");
+  rcl_ret_t ret;
+  if (
+    rcl_context_kept_ && init_options.reusable_context() &&
+    init_options.get_domain_id() == init_options_.get_domain_id())
+  {
+    // Reuse the rcl context kept by the last shutdown, only parsing the arguments again.
+    shutdown_reason_ = "";
+    sub_contexts_.clear();
+    ret = rcl_arguments_fini(&rcl_context_->global_arguments);
+    if (RCL_RET_OK == ret) {
+      rcl_context_->global_arguments = rcl_get_zero_initialized_arguments();
+      ret = rcl_parse_arguments(
+        argc, argv, *rcl_init_options_get_allocator(init_options.get_rcl_init_options()),
+        &rcl_context_->global_arguments);
+    }
+    if (RCL_RET_OK != ret) {
+      this->clean_up();
+      rclcpp::exceptions::throw_from_rcl_error(ret, "failed to parse the arguments again");
+    }
+    rcl_context_kept_ = false;
+  } else {
+    this->clean_up();
+    rcl_context_t * context = new rcl_context_t;
+    if (!context) {
+      throw std::runtime_error("failed to allocate memory for rcl context");
+    }
+    *context = rcl_get_zero_initialized_context();
+    ret = rcl_init(argc, argv, init_options.get_rcl_init_options(), context);
+    if (RCL_RET_OK != ret) {
+      delete context;
+      rclcpp::exceptions::throw_from_rcl_error(ret, "failed to initialize rcl");
+    }
+    rcl_context_.reset(context, __delete_context);
   }
-  rcl_context_.reset(context, __delete_context);
 
   if (init_options.auto_initialize_logging()) {
     logging_mutex_ = get_global_logging_mutex();
@@ -224,6 +260,11 @@ Context::init(
         rcl_context_.reset();
         rclcpp::exceptions::throw_from_rcl_error(ret, "failed to configure logging");
       }
+      // The levels may have been set by the command line arguments.
+      rclcpp::reset_logger_level_caches();
+      if (init_options.async_logging().enabled) {
+        start_async_logging(init_options.async_logging());
+      }
     } else {
       RCLCPP_WARN(
         rclcpp::get_logger("rclcpp"),
@@ -241,6 +282,10 @@ Context::init(
 
     init_options_ = init_options;
 
+    if (init_options.allocation_tracking().enabled) {
+      allocation_tracking::enable(init_options.allocation_tracking());
+    }
+
     weak_contexts_ = get_weak_contexts();
     weak_contexts_->add_context(this->shared_from_this());
   } catch (const std::exception & e) {
@@ -261,7 +306,7 @@ Context::is_valid() const
 {
   // Take a local copy of the shared pointer to avoid it getting nulled under our feet.
   auto local_rcl_context = rcl_context_;
-  if (!local_rcl_context) {
+  if (!local_rcl_context || rcl_context_kept_) {
     return false;
   }
   return rcl_context_is_valid(local_rcl_context.get());
@@ -279,6 +324,19 @@ Context::get_init_options()
   return init_options_;
 }
 
+rclcpp::WorkerPool::SharedPtr
+Context::get_worker_pool()
+{
+  std::lock_guard<std::recursive_mutex> lock(init_mutex_);
+  if (!worker_pool_) {
+    if (!this->is_valid()) {
+      throw std::runtime_error("context is not valid, it has no worker pool");
+    }
+    worker_pool_ = std::make_shared<rclcpp::WorkerPool>(init_options_.worker_pool());
+  }
+  return worker_pool_;
+}
+
 size_t
 Context::get_domain_id() const
 {
@@ -301,16 +359,21 @@ bool
 Context::shutdown(const std::string & reason)
 {
   // prevent races
-  std::lock_guard<std::recursive_mutex> init_lock(init_mutex_);
+  std::unique_lock<std::recursive_mutex> init_lock(init_mutex_);
   // ensure validity
   if (!this->is_valid()) {
     // if it is not valid, then it cannot be shutdown
     return false;
   }
-  // rcl shutdown
-  rcl_ret_t ret = rcl_shutdown(rcl_context_.get());
-  if (RCL_RET_OK != ret) {
-    rclcpp::exceptions::throw_from_rcl_error(ret);
+  if (init_options_.reusable_context()) {
+    // Kept for the next init(), it is shutdown by clean_up() otherwise.
+    rcl_context_kept_ = true;
+  } else {
+    // rcl shutdown
+    rcl_ret_t ret = rcl_shutdown(rcl_context_.get());
+    if (RCL_RET_OK != ret) {
+      rclcpp::exceptions::throw_from_rcl_error(ret);
+    }
   }
   // set shutdown reason
   shutdown_reason_ = reason;
@@ -332,6 +395,7 @@ Context::shutdown(const std::string & reason)
     std::lock_guard<std::recursive_mutex> guard(*logging_mutex_);
     size_t & count = get_logging_reference_count();
     if (0u == --count) {
+      stop_async_logging();
       rcl_ret_t rcl_ret = rcl_logging_fini();
       if (RCL_RET_OK != rcl_ret) {
         RCUTILS_SAFE_FWRITE_TO_STDERR(
@@ -340,8 +404,15 @@ Context::shutdown(const std::string & reason)
           " failed to fini logging");
         rcl_reset_error();
       }
+      rclcpp::reset_logger_level_caches();
     }
   }
+  // stop the worker pool without the lock, the work it waits for may use the context
+  rclcpp::WorkerPool::SharedPtr worker_pool = std::move(worker_pool_);
+  init_lock.unlock();
+  if (worker_pool) {
+    worker_pool->shutdown();
+  }
   return true;
 }
 
@@ -426,6 +497,16 @@ void
 Context::clean_up()
 {
   shutdown_reason_ = "";
+  if (rcl_context_kept_) {
+    rcl_context_kept_ = false;
+    rcl_ret_t ret = rcl_shutdown(rcl_context_.get());
+    if (RCL_RET_OK != ret) {
+      RCLCPP_ERROR(
+        rclcpp::get_logger("rclcpp"),
+        "failed to shutdown the kept rcl context: %s", rcl_get_error_string().str);
+      rcl_reset_error();
+    }
+  }
   rcl_context_.reset();
   sub_contexts_.clear();
 }
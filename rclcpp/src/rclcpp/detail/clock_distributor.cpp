@@ -0,0 +1,140 @@
+// Copyright 2021 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "./clock_distributor.hpp"
+
+#include <memory>
+#include <mutex>
+#include <utility>
+
+#include "rclcpp/create_subscription.hpp"
+#include "rclcpp/node_options.hpp"
+#include "rclcpp/qos.hpp"
+#include "rclcpp/subscription_options.hpp"
+
+using rclcpp::detail::ClockDistributor;
+
+ClockDistributor::~ClockDistributor()
+{
+  std::lock_guard<std::mutex> state_lock(state_mutex_);
+  stop();
+}
+
+uint64_t
+ClockDistributor::attach(const rclcpp::Context::SharedPtr & context, CallbackT callback)
+{
+  std::lock_guard<std::mutex> state_lock(state_mutex_);
+  uint64_t id;
+  {
+    std::lock_guard<std::mutex> callbacks_lock(callbacks_mutex_);
+    id = next_id_++;
+    callbacks_.emplace(id, std::move(callback));
+  }
+  if (!node_) {
+    try {
+      start(context);
+    } catch (...) {
+      stop();
+      std::lock_guard<std::mutex> callbacks_lock(callbacks_mutex_);
+      callbacks_.erase(id);
+      throw;
+    }
+  }
+  return id;
+}
+
+void
+ClockDistributor::detach(uint64_t id)
+{
+  std::lock_guard<std::mutex> state_lock(state_mutex_);
+  bool empty;
+  {
+    std::lock_guard<std::mutex> callbacks_lock(callbacks_mutex_);
+    callbacks_.erase(id);
+    empty = callbacks_.empty();
+  }
+  // The callbacks lock must not be held here, as the executor thread may be waiting for it.
+  if (empty) {
+    stop();
+  }
+}
+
+void
+ClockDistributor::start(const rclcpp::Context::SharedPtr & context)
+{
+  // The hidden node only subscribes to "/clock", and must not get a time source
+  // subscribing to it as well from a global use_sim_time override.
+  rclcpp::NodeOptions options;
+  options
+  .context(context)
+  .start_parameter_services(false)
+  .start_parameter_event_publisher(false)
+  .enable_rosout(false)
+  .use_clock_thread(false)
+  .parameter_overrides({rclcpp::Parameter("use_sim_time", false)});
+  node_ = std::make_shared<rclcpp::Node>("_clock_distributor", options);
+
+  rclcpp::SubscriptionOptions subscription_options;
+  subscription_options.qos_overriding_options = rclcpp::QosOverridingOptions(
+    {
+      rclcpp::QosPolicyKind::Depth,
+      rclcpp::QosPolicyKind::Durability,
+      rclcpp::QosPolicyKind::History,
+      rclcpp::QosPolicyKind::Reliability,
+    });
+  subscription_ = rclcpp::create_subscription<rosgraph_msgs::msg::Clock>(
+    node_,
+    "/clock",
+    rclcpp::QoS(KeepLast(1)).best_effort(),
+    [this](std::shared_ptr<const rosgraph_msgs::msg::Clock> msg) {
+      clock_cb(std::move(msg));
+    },
+    subscription_options);
+
+  rclcpp::ExecutorOptions executor_options;
+  executor_options.context = context;
+  executor_ = std::make_shared<rclcpp::executors::SingleThreadedExecutor>(executor_options);
+  executor_->add_node(node_);
+  cancel_executor_promise_ = std::promise<void>{};
+  executor_thread_ = std::thread(
+    [this]() {
+      auto future = cancel_executor_promise_.get_future();
+      executor_->spin_until_future_complete(future);
+    });
+}
+
+void
+ClockDistributor::stop()
+{
+  if (executor_thread_.joinable()) {
+    cancel_executor_promise_.set_value();
+    executor_->cancel();
+    executor_thread_.join();
+  }
+  if (executor_ && node_) {
+    executor_->remove_node(node_);
+  }
+  executor_.reset();
+  subscription_.reset();
+  node_.reset();
+}
+
+void
+ClockDistributor::clock_cb(std::shared_ptr<const rosgraph_msgs::msg::Clock> msg)
+{
+  std::lock_guard<std::mutex> callbacks_lock(callbacks_mutex_);
+  for (const auto & id_and_callback : callbacks_) {
+    id_and_callback.second(msg);
+  }
+}
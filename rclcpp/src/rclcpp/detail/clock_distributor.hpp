@@ -0,0 +1,95 @@
+// Copyright 2021 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__DETAIL__CLOCK_DISTRIBUTOR_HPP_
+#define RCLCPP__DETAIL__CLOCK_DISTRIBUTOR_HPP_
+
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include "rosgraph_msgs/msg/clock.hpp"
+
+#include "rclcpp/context.hpp"
+#include "rclcpp/executors/single_threaded_executor.hpp"
+#include "rclcpp/node.hpp"
+#include "rclcpp/subscription.hpp"
+
+namespace rclcpp
+{
+namespace detail
+{
+
+/// \internal Single "/clock" subscription of a context, forwarding the messages to time sources.
+/**
+ * This is a sub context, used by the time sources of the nodes created with
+ * rclcpp::NodeOptions::use_shared_clock_subscription().
+ * While at least one callback is attached, a hidden node of the context
+ * subscribes to "/clock" and is spun by a dedicated thread, which calls every
+ * attached callback with each message.
+ */
+class ClockDistributor
+{
+public:
+  using CallbackT = std::function<void (std::shared_ptr<const rosgraph_msgs::msg::Clock>)>;
+
+  ~ClockDistributor();
+
+  /// \internal Attach a callback, creating the subscription if it is the first one.
+  /**
+   * \return an id to give to detach().
+   */
+  uint64_t
+  attach(const rclcpp::Context::SharedPtr & context, CallbackT callback);
+
+  /// \internal Detach a callback, destroying the subscription if it was the last one.
+  /**
+   * Once this returns, the callback is not called anymore.
+   * It must not be called from a callback of this distributor.
+   */
+  void
+  detach(uint64_t id);
+
+private:
+  void
+  start(const rclcpp::Context::SharedPtr & context);
+
+  void
+  stop();
+
+  void
+  clock_cb(std::shared_ptr<const rosgraph_msgs::msg::Clock> msg);
+
+  // Serializes attach() and detach(), so that start() and stop() do not overlap.
+  std::mutex state_mutex_;
+  rclcpp::Node::SharedPtr node_;
+  rclcpp::Subscription<rosgraph_msgs::msg::Clock>::SharedPtr subscription_;
+  rclcpp::executors::SingleThreadedExecutor::SharedPtr executor_;
+  std::promise<void> cancel_executor_promise_;
+  std::thread executor_thread_;
+
+  // Protects the callbacks, held while calling them.
+  std::mutex callbacks_mutex_;
+  uint64_t next_id_ = 0;
+  std::map<uint64_t, CallbackT> callbacks_;
+};
+
+}  // namespace detail
+}  // namespace rclcpp
+
+#endif  // RCLCPP__DETAIL__CLOCK_DISTRIBUTOR_HPP_
@@ -0,0 +1,84 @@
+// Copyright 2021 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__DETAIL__GRAPH_CACHE_HPP_
+#define RCLCPP__DETAIL__GRAPH_CACHE_HPP_
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace rclcpp
+{
+namespace detail
+{
+
+/// \internal Results of the graph queries of the nodes of a context, until the graph changes.
+/**
+ * This is a sub context, shared by the nodes of a context which use the graph cache.
+ * As those nodes are all watched by the graph listener, any change of the graph
+ * notifies at least one of them, which invalidates the cache.
+ */
+class GraphCache
+{
+public:
+  /// \internal Return the cached result of a query, running the query on a miss.
+  /**
+   * The key identifies both the query and its arguments, so that a key is
+   * always used with the same ValueT.
+   * The query runs without holding the lock, and its result is only cached if
+   * the graph did not change in the meantime.
+   */
+  template<typename ValueT, typename QueryT>
+  ValueT
+  get(const std::string & key, QueryT && query)
+  {
+    uint64_t generation;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      auto it = results_.find(key);
+      if (it != results_.end()) {
+        return *std::static_pointer_cast<const ValueT>(it->second);
+      }
+      generation = generation_;
+    }
+    ValueT value = query();
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (generation == generation_) {
+      results_[key] = std::make_shared<const ValueT>(value);
+    }
+    return value;
+  }
+
+  /// \internal Drop all the cached results, as the graph changed.
+  void
+  invalidate()
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    ++generation_;
+    results_.clear();
+  }
+
+private:
+  std::mutex mutex_;
+  uint64_t generation_ = 0;
+  std::map<std::string, std::shared_ptr<const void>> results_;
+};
+
+}  // namespace detail
+}  // namespace rclcpp
+
+#endif  // RCLCPP__DETAIL__GRAPH_CACHE_HPP_
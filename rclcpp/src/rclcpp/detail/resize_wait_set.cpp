@@ -0,0 +1,64 @@
+// Copyright 2021 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "./resize_wait_set.hpp"
+
+#include <stdexcept>
+#include <string>
+
+#include "rclcpp/exceptions.hpp"
+
+namespace
+{
+
+void
+check_capacity(const char * kind, size_t count, size_t capacity)
+{
+  if (count > capacity) {
+    throw std::runtime_error(
+            "Couldn't fit " + std::to_string(count) + " " + kind +
+            " in the wait set, whose reserved capacity is " + std::to_string(capacity));
+  }
+}
+
+}  // namespace
+
+void
+rclcpp::detail::resize_wait_set(
+  rcl_wait_set_t * wait_set,
+  const rclcpp::memory_strategy::MemoryStrategy & memory_strategy,
+  const rclcpp::WaitSetCapacities & reserved_capacities)
+{
+  const size_t subscriptions = memory_strategy.number_of_ready_subscriptions();
+  const size_t guard_conditions = memory_strategy.number_of_guard_conditions();
+  const size_t timers = memory_strategy.number_of_ready_timers();
+  const size_t clients = memory_strategy.number_of_ready_clients();
+  const size_t services = memory_strategy.number_of_ready_services();
+  const size_t events = memory_strategy.number_of_ready_events();
+
+  if (reserved_capacities.empty()) {
+    rcl_ret_t ret = rcl_wait_set_resize(
+      wait_set, subscriptions, guard_conditions, timers, clients, services, events);
+    if (RCL_RET_OK != ret) {
+      rclcpp::exceptions::throw_from_rcl_error(ret, "Couldn't resize the wait set");
+    }
+    return;
+  }
+  check_capacity("subscriptions", subscriptions, reserved_capacities.subscriptions);
+  check_capacity("guard conditions", guard_conditions, reserved_capacities.guard_conditions);
+  check_capacity("timers", timers, reserved_capacities.timers);
+  check_capacity("clients", clients, reserved_capacities.clients);
+  check_capacity("services", services, reserved_capacities.services);
+  check_capacity("events", events, reserved_capacities.events);
+}
@@ -0,0 +1,45 @@
+// Copyright 2021 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__DETAIL__RESIZE_WAIT_SET_HPP_
+#define RCLCPP__DETAIL__RESIZE_WAIT_SET_HPP_
+
+#include "rcl/wait.h"
+
+#include "rclcpp/executor_options.hpp"
+#include "rclcpp/memory_strategy.hpp"
+#include "rclcpp/visibility_control.hpp"
+
+namespace rclcpp
+{
+namespace detail
+{
+/// \internal Make the wait set fit the entities of the memory strategy.
+/**
+ * Without reserved capacities, the wait set is resized to the numbers of entities.
+ * Otherwise it was allocated with the reserved capacities, which the entities must not exceed.
+ * The size of waitables are accounted for in size of the other entities.
+ * \throws std::runtime_error if there are more entities than reserved, or if resizing fails.
+ */
+RCLCPP_LOCAL
+void
+resize_wait_set(
+  rcl_wait_set_t * wait_set,
+  const rclcpp::memory_strategy::MemoryStrategy & memory_strategy,
+  const rclcpp::WaitSetCapacities & reserved_capacities);
+
+}  // namespace detail
+}  // namespace rclcpp
+
+#endif  // RCLCPP__DETAIL__RESIZE_WAIT_SET_HPP_
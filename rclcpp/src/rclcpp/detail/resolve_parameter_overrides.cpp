@@ -14,22 +14,63 @@
 
 #include "./resolve_parameter_overrides.hpp"
 
-#include <string>
+#include <array>
 #include <map>
+#include <memory>
+#include <mutex>
+#include <string>
 #include <vector>
 
 #include "rcl_yaml_param_parser/parser.h"
 #include "rcpputils/scope_exit.hpp"
 
 #include "rclcpp/parameter_map.hpp"
+#include "rclcpp/startup_profiling.hpp"
+
+namespace
+{
+
+rclcpp::ParameterMap
+get_parameter_map(const rcl_arguments_t * args)
+{
+  rcl_params_t * params = NULL;
+  rcl_ret_t ret = rcl_arguments_get_param_overrides(args, &params);
+  if (RCL_RET_OK != ret) {
+    rclcpp::exceptions::throw_from_rcl_error(ret);
+  }
+  if (!params) {
+    return rclcpp::ParameterMap();
+  }
+  auto cleanup_params = rcpputils::make_scope_exit(
+    [params]() {
+      rcl_yaml_node_struct_fini(params);
+    });
+  return rclcpp::parameter_map_from(params);
+}
+
+}  // namespace
+
+std::shared_ptr<const rclcpp::ParameterMap>
+rclcpp::detail::GlobalParameterOverrides::get_parameter_map(const rcl_arguments_t * global_args)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!parameter_map_ || global_args_ != global_args) {
+    parameter_map_ = std::make_shared<const rclcpp::ParameterMap>(
+      ::get_parameter_map(global_args));
+    global_args_ = global_args;
+  }
+  return parameter_map_;
+}
 
 std::map<std::string, rclcpp::ParameterValue>
 rclcpp::detail::resolve_parameter_overrides(
   const std::string & node_fqn,
   const std::vector<rclcpp::Parameter> & parameter_overrides,
   const rcl_arguments_t * local_args,
-  const rcl_arguments_t * global_args)
+  const rcl_arguments_t * global_args,
+  GlobalParameterOverrides * global_args_cache)
 {
+  rclcpp::startup_profiling::ScopedPhase profiled_phase("parameter overrides", node_fqn.c_str());
   std::map<std::string, rclcpp::ParameterValue> result;
 
   // global before local so that local overwrites global
@@ -41,28 +82,23 @@ rclcpp::detail::resolve_parameter_overrides(
     if (!source) {
       continue;
     }
-    rcl_params_t * params = NULL;
-    rcl_ret_t ret = rcl_arguments_get_param_overrides(source, &params);
-    if (RCL_RET_OK != ret) {
-      rclcpp::exceptions::throw_from_rcl_error(ret);
+    std::shared_ptr<const rclcpp::ParameterMap> initial_map;
+    if (source == global_args && global_args_cache) {
+      initial_map = global_args_cache->get_parameter_map(global_args);
+    } else {
+      initial_map = std::make_shared<const rclcpp::ParameterMap>(::get_parameter_map(source));
     }
-    if (params) {
-      auto cleanup_params = rcpputils::make_scope_exit(
-        [params]() {
-          rcl_yaml_node_struct_fini(params);
-        });
-      rclcpp::ParameterMap initial_map = rclcpp::parameter_map_from(params);
 
-      // Enforce wildcard matching precedence
-      // TODO(cottsay) implement further wildcard matching
-      const std::array<std::string, 2> node_matching_names{"/**", node_fqn};
-      for (const auto & node_name : node_matching_names) {
-        if (initial_map.count(node_name) > 0) {
-          // Combine parameter yaml files, overwriting values in older ones
-          for (const rclcpp::Parameter & param : initial_map.at(node_name)) {
-            result[param.get_name()] =
-              rclcpp::ParameterValue(param.get_value_message());
-          }
+    // Enforce wildcard matching precedence
+    // TODO(cottsay) implement further wildcard matching
+    const std::array<std::string, 2> node_matching_names{"/**", node_fqn};
+    for (const auto & node_name : node_matching_names) {
+      auto it = initial_map->find(node_name);
+      if (it != initial_map->end()) {
+        // Combine parameter yaml files, overwriting values in older ones
+        for (const rclcpp::Parameter & param : it->second) {
+          result[param.get_name()] =
+            rclcpp::ParameterValue(param.get_value_message());
         }
       }
     }
@@ -17,11 +17,14 @@
 
 #include <string>
 #include <map>
+#include <memory>
+#include <mutex>
 #include <vector>
 
 #include "rcl/arguments.h"
 
 #include "rclcpp/parameter.hpp"
+#include "rclcpp/parameter_map.hpp"
 #include "rclcpp/parameter_value.hpp"
 #include "rclcpp/visibility_control.hpp"
 
@@ -29,14 +32,45 @@ namespace rclcpp
 {
 namespace detail
 {
+
+/// \internal Parameter map of the global arguments of a context, converted once.
+/**
+ * The global arguments are parsed once by rcl, including their parameter
+ * files, but getting their parameter overrides copies them and converting the
+ * copy goes through the parameters of every node in the files.
+ * As the global arguments do not change until the context is shut down, which
+ * clears its sub contexts, the converted map is shared by all of its nodes.
+ */
+class GlobalParameterOverrides
+{
+public:
+  /// \internal Get the parameter map of the arguments, converted on the first call.
+  /**
+   * \throws rclcpp::exceptions::RCLError if the parameter overrides could not be copied.
+   */
+  RCLCPP_LOCAL
+  std::shared_ptr<const rclcpp::ParameterMap>
+  get_parameter_map(const rcl_arguments_t * global_args);
+
+private:
+  std::mutex mutex_;
+  const rcl_arguments_t * global_args_ = nullptr;
+  std::shared_ptr<const rclcpp::ParameterMap> parameter_map_;
+};
+
 /// \internal Get the parameter overrides from the arguments.
+/**
+ * If global_args_cache is not null, the parameter map of the global arguments
+ * is taken from it instead of being converted again.
+ */
 RCLCPP_LOCAL
 std::map<std::string, rclcpp::ParameterValue>
 resolve_parameter_overrides(
   const std::string & node_name,
   const std::vector<rclcpp::Parameter> & parameter_overrides,
   const rcl_arguments_t * local_args,
-  const rcl_arguments_t * global_args);
+  const rcl_arguments_t * global_args,
+  GlobalParameterOverrides * global_args_cache = nullptr);
 
 }  // namespace detail
 }  // namespace rclcpp
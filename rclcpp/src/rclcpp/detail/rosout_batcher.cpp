@@ -0,0 +1,223 @@
+// Copyright 2021 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "./rosout_batcher.hpp"
+
+#include <cstdio>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+
+#include "rcl/error_handling.h"
+#include "rcutils/logging_macros.h"
+#include "rosidl_typesupport_cpp/message_type_support.hpp"
+
+#include "rclcpp/exceptions.hpp"
+
+#include "../logging_mutex.hpp"
+
+using rclcpp::detail::RosoutBatcher;
+
+namespace
+{
+
+/// Batchers by logger name, guarded by the global logging mutex.
+std::map<std::string, RosoutBatcher *, std::less<>> &
+get_batchers()
+{
+  static std::map<std::string, RosoutBatcher *, std::less<>> batchers;
+  return batchers;
+}
+
+/// Set while publishing, the records logged by the middleware then are not batched.
+thread_local bool is_batching = false;
+
+}  // namespace
+
+RosoutBatcher::RosoutBatcher(
+  std::shared_ptr<rcl_node_t> node_handle,
+  const rmw_qos_profile_t & qos,
+  std::chrono::nanoseconds period,
+  size_t max_batch_size)
+: node_handle_(std::move(node_handle)),
+  publisher_(rcl_get_zero_initialized_publisher()),
+  logger_name_(rcl_node_get_logger_name(node_handle_.get())),
+  logging_mutex_(get_global_logging_mutex()),
+  period_(period),
+  max_batch_size_(max_batch_size)
+{
+  rcl_publisher_options_t publisher_options = rcl_publisher_get_default_options();
+  publisher_options.qos = qos;
+  rcl_ret_t ret = rcl_publisher_init(
+    &publisher_, node_handle_.get(),
+    rosidl_typesupport_cpp::get_message_type_support_handle<rcl_interfaces::msg::Log>(),
+    "/rosout", &publisher_options);
+  if (RCL_RET_OK != ret) {
+    rclcpp::exceptions::throw_from_rcl_error(ret, "failed to create rosout publisher");
+  }
+  thread_ = std::thread(&RosoutBatcher::run, this);
+
+  {
+    std::lock_guard<std::recursive_mutex> guard(*logging_mutex_);
+    is_registered_ = get_batchers().emplace(logger_name_, this).second;
+  }
+  if (!is_registered_) {
+    // Like rcl, the records of the nodes with the same name go through the first one.
+    RCUTILS_LOG_WARN_NAMED(
+      "rclcpp",
+      "rosout publisher already registered for logger '%s', "
+      "its records are published by the first node with that name", logger_name_.c_str());
+  }
+}
+
+RosoutBatcher::~RosoutBatcher()
+{
+  if (is_registered_) {
+    std::lock_guard<std::recursive_mutex> guard(*logging_mutex_);
+    get_batchers().erase(logger_name_);
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  cv_.notify_all();
+  thread_.join();
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    publish_batch();
+  }
+  if (RCL_RET_OK != rcl_publisher_fini(&publisher_, node_handle_.get())) {
+    RCUTILS_LOG_ERROR_NAMED(
+      "rclcpp",
+      "failed to destroy rosout publisher: %s", rcl_get_error_string().str);
+    rcl_reset_error();
+  }
+}
+
+void
+RosoutBatcher::add(
+  const rcutils_log_location_t * location,
+  int severity, const char * name, rcutils_time_point_value_t timestamp,
+  const char * message)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (batch_size_ > 0 && batch_.level != severity) {
+    publish_batch();
+  }
+  if (0u == batch_size_) {
+    batch_.stamp.sec = static_cast<int32_t>(RCUTILS_NS_TO_S(timestamp));
+    batch_.stamp.nanosec = static_cast<uint32_t>(timestamp % (1000LL * 1000LL * 1000LL));
+    batch_.level = static_cast<uint8_t>(severity);
+    batch_.name = name;
+    batch_.msg = message;
+    if (location) {
+      batch_.file = location->file_name;
+      batch_.function = location->function_name;
+      batch_.line = static_cast<uint32_t>(location->line_number);
+    } else {
+      batch_.file.clear();
+      batch_.function.clear();
+      batch_.line = 0;
+    }
+    batch_start_ = std::chrono::steady_clock::now();
+    cv_.notify_one();
+  } else {
+    batch_.msg += '\n';
+    batch_.msg += message;
+  }
+  if (++batch_size_ >= max_batch_size_) {
+    publish_batch();
+  }
+}
+
+void
+RosoutBatcher::publish_batch()
+{
+  if (0u == batch_size_) {
+    return;
+  }
+  is_batching = true;
+  rcl_ret_t ret = rcl_publish(&publisher_, &batch_, nullptr);
+  is_batching = false;
+  if (RCL_RET_OK != ret) {
+    // Not logged, as it would come back here.
+    RCUTILS_SAFE_FWRITE_TO_STDERR("failed to publish batched rosout records: ");
+    RCUTILS_SAFE_FWRITE_TO_STDERR(rcl_get_error_string().str);
+    RCUTILS_SAFE_FWRITE_TO_STDERR("\n");
+    rcl_reset_error();
+  }
+  batch_size_ = 0;
+  // The capacity is kept for the next batch.
+  batch_.msg.clear();
+}
+
+void
+RosoutBatcher::run()
+{
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      cv_.wait(lock, [this]() {return stop_ || batch_size_ > 0;});
+      auto deadline = batch_start_ + period_;
+      if (stop_ || cv_.wait_until(lock, deadline, [this]() {return stop_;})) {
+        return;
+      }
+    }
+    // Taken first like in add(), as the middleware may log while publishing.
+    std::lock_guard<std::recursive_mutex> guard(*logging_mutex_);
+    std::lock_guard<std::mutex> lock(mutex_);
+    // The batch may have been published early, and another one started since.
+    if (batch_size_ > 0 && std::chrono::steady_clock::now() >= batch_start_ + period_) {
+      publish_batch();
+    }
+  }
+}
+
+void
+rclcpp::detail::batch_rosout_record(
+  const rcutils_log_location_t * location,
+  int severity, const char * name, rcutils_time_point_value_t timestamp,
+  const char * format, va_list * args)
+{
+  const auto & batchers = get_batchers();
+  if (batchers.empty() || !name || is_batching) {
+    return;
+  }
+  auto it = batchers.find(name);
+  if (it == batchers.end()) {
+    return;
+  }
+
+  char static_message[1024];
+  va_list args_copy;
+  va_copy(args_copy, *args);
+  int length = vsnprintf(static_message, sizeof(static_message), format, args_copy);
+  va_end(args_copy);
+  if (length < 0) {
+    return;
+  }
+  if (static_cast<size_t>(length) < sizeof(static_message)) {
+    it->second->add(location, severity, name, timestamp, static_message);
+    return;
+  }
+  std::string message(static_cast<size_t>(length) + 1, '\0');
+  va_copy(args_copy, *args);
+  vsnprintf(&message[0], message.size(), format, args_copy);
+  va_end(args_copy);
+  message.resize(static_cast<size_t>(length));
+  it->second->add(location, severity, name, timestamp, message.c_str());
+}
@@ -0,0 +1,111 @@
+// Copyright 2021 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__DETAIL__ROSOUT_BATCHER_HPP_
+#define RCLCPP__DETAIL__ROSOUT_BATCHER_HPP_
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdarg>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "rcl/node.h"
+#include "rcl/publisher.h"
+#include "rcl_interfaces/msg/log.hpp"
+#include "rcutils/logging.h"
+#include "rcutils/time.h"
+#include "rmw/types.h"
+
+#include "rclcpp/visibility_control.hpp"
+
+namespace rclcpp
+{
+namespace detail
+{
+
+/// \internal Publisher on "/rosout" of the log records of a node, batching them.
+/**
+ * Used instead of the rosout publisher of rcl by the nodes created with
+ * rclcpp::NodeOptions::rosout_batch_period().
+ * The records given by the output handler of rclcpp to batch_rosout_record()
+ * are gathered in one message, published once it holds the maximum number of
+ * records, when a record of another severity comes, or by a dedicated thread
+ * once the period after the first record has elapsed.
+ */
+class RosoutBatcher
+{
+public:
+  /// \internal Create the publisher and start receiving the records of the node logger.
+  /**
+   * \throws anything rclcpp::exceptions::throw_from_rcl_error can throw.
+   */
+  RosoutBatcher(
+    std::shared_ptr<rcl_node_t> node_handle,
+    const rmw_qos_profile_t & qos,
+    std::chrono::nanoseconds period,
+    size_t max_batch_size);
+
+  /// \internal Stop receiving the records, and publish the pending ones.
+  ~RosoutBatcher();
+
+  /// \internal Add a record to the batch, called holding the global logging mutex.
+  void
+  add(
+    const rcutils_log_location_t * location,
+    int severity, const char * name, rcutils_time_point_value_t timestamp,
+    const char * message);
+
+private:
+  /// Publish the pending records, holding mutex_.
+  void
+  publish_batch();
+
+  void
+  run();
+
+  std::shared_ptr<rcl_node_t> node_handle_;
+  rcl_publisher_t publisher_;
+  std::string logger_name_;
+  std::shared_ptr<std::recursive_mutex> logging_mutex_;
+  bool is_registered_ = false;
+  const std::chrono::nanoseconds period_;
+  const size_t max_batch_size_;
+
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  rcl_interfaces::msg::Log batch_;
+  size_t batch_size_ = 0;
+  std::chrono::steady_clock::time_point batch_start_;
+  bool stop_ = false;
+  std::thread thread_;
+};
+
+/// \internal Give a log record to the batcher of its logger, if any.
+/**
+ * Called by the output handler of rclcpp, holding the global logging mutex.
+ */
+RCLCPP_LOCAL
+void
+batch_rosout_record(
+  const rcutils_log_location_t * location,
+  int severity, const char * name, rcutils_time_point_value_t timestamp,
+  const char * format, va_list * args);
+
+}  // namespace detail
+}  // namespace rclcpp
+
+#endif  // RCLCPP__DETAIL__ROSOUT_BATCHER_HPP_
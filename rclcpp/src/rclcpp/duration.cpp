@@ -300,4 +300,41 @@ Duration::from_nanoseconds(rcl_duration_value_t nanoseconds)
   return ret;
 }
 
+void
+durations_to_nanoseconds(
+  const builtin_interfaces::msg::Duration * durations,
+  size_t count,
+  rcl_duration_value_t * nanoseconds)
+{
+  for (size_t i = 0; i < count; ++i) {
+    nanoseconds[i] = RCL_S_TO_NS(static_cast<rcl_duration_value_t>(durations[i].sec)) +
+      static_cast<rcl_duration_value_t>(durations[i].nanosec);
+  }
+}
+
+void
+nanoseconds_to_durations(
+  const rcl_duration_value_t * nanoseconds,
+  size_t count,
+  builtin_interfaces::msg::Duration * durations)
+{
+  constexpr rcl_duration_value_t kDivisor = RCL_S_TO_NS(1);
+  constexpr int32_t max_s = std::numeric_limits<int32_t>::max();
+  constexpr int32_t min_s = std::numeric_limits<int32_t>::min();
+  constexpr uint32_t max_ns = std::numeric_limits<uint32_t>::max();
+  for (size_t i = 0; i < count; ++i) {
+    const rcl_duration_value_t quotient = nanoseconds[i] / kDivisor;
+    const rcl_duration_value_t remainder = nanoseconds[i] % kDivisor;
+    // Round towards negative infinity, so that the nanoseconds are positive.
+    const rcl_duration_value_t borrow = remainder < 0 ? 1 : 0;
+    // Saturate like the conversion operator of Duration.
+    const bool overflow = borrow == 0 && quotient > max_s;
+    const bool underflow = borrow == 1 && quotient <= min_s;
+    const auto seconds = static_cast<int32_t>(quotient - borrow);
+    const auto nanosec = static_cast<uint32_t>(remainder + borrow * kDivisor);
+    durations[i].sec = overflow ? max_s : (underflow ? min_s : seconds);
+    durations[i].nanosec = overflow ? max_ns : (underflow ? 0u : nanosec);
+  }
+}
+
 }  // namespace rclcpp
@@ -0,0 +1,257 @@
+// Copyright 2021 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "rclcpp/duration_histogram.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+using rclcpp::DurationHistogram;
+
+namespace
+{
+
+void
+atomic_add(std::atomic<double> & value, double increment)
+{
+  double expected = value.load(std::memory_order_relaxed);
+  while (!value.compare_exchange_weak(expected, expected + increment, std::memory_order_relaxed)) {
+  }
+}
+
+void
+atomic_min(std::atomic<uint64_t> & value, uint64_t candidate)
+{
+  uint64_t expected = value.load(std::memory_order_relaxed);
+  while (candidate < expected &&
+    !value.compare_exchange_weak(expected, candidate, std::memory_order_relaxed))
+  {
+  }
+}
+
+void
+atomic_max(std::atomic<uint64_t> & value, uint64_t candidate)
+{
+  uint64_t expected = value.load(std::memory_order_relaxed);
+  while (candidate > expected &&
+    !value.compare_exchange_weak(expected, candidate, std::memory_order_relaxed))
+  {
+  }
+}
+
+/// Return the index of the most significant bit of a non zero value.
+size_t
+get_most_significant_bit(uint64_t value)
+{
+  // Found by halving the search range.
+  size_t bit = 0u;
+  for (size_t shift = 32u; shift > 0u; shift /= 2u) {
+    if ((value >> shift) != 0u) {
+      value >>= shift;
+      bit += shift;
+    }
+  }
+  return bit;
+}
+
+std::atomic<size_t> g_next_thread_index{0};
+
+/// Return an index unique to the calling thread, used to pick its shard.
+size_t
+get_thread_index()
+{
+  thread_local const size_t thread_index =
+    g_next_thread_index.fetch_add(1u, std::memory_order_relaxed);
+  return thread_index;
+}
+
+}  // namespace
+
+// On its own cache lines, so that the threads recording in different shards do not contend.
+struct alignas(64) DurationHistogram::Shard
+{
+  std::array<std::atomic<uint64_t>, number_of_buckets> bucket_counts;
+  std::atomic<uint64_t> count;
+  std::atomic<uint64_t> min;
+  std::atomic<uint64_t> max;
+  std::atomic<double> sum;
+  std::atomic<double> sum_of_squares;
+};
+
+DurationHistogram::DurationHistogram(size_t number_of_shards)
+: number_of_shards_(number_of_shards)
+{
+  if (0u == number_of_shards) {
+    throw std::invalid_argument("the number of shards of a histogram must not be 0");
+  }
+  shards_.reset(new Shard[number_of_shards]);
+  reset();
+}
+
+DurationHistogram::~DurationHistogram() = default;
+
+void
+DurationHistogram::record(std::chrono::nanoseconds duration)
+{
+  Shard & shard = shards_[1u == number_of_shards_ ? 0u : get_thread_index() % number_of_shards_];
+  const uint64_t value = duration.count() > 0 ? static_cast<uint64_t>(duration.count()) : 0u;
+  shard.bucket_counts[get_bucket(duration)].fetch_add(1u, std::memory_order_relaxed);
+  shard.count.fetch_add(1u, std::memory_order_relaxed);
+  atomic_min(shard.min, value);
+  atomic_max(shard.max, value);
+  const double value_as_double = static_cast<double>(value);
+  atomic_add(shard.sum, value_as_double);
+  atomic_add(shard.sum_of_squares, value_as_double * value_as_double);
+}
+
+DurationHistogram::Snapshot
+DurationHistogram::get_snapshot() const
+{
+  Snapshot snapshot;
+  uint64_t min = std::numeric_limits<uint64_t>::max();
+  uint64_t max = 0u;
+  double sum = 0.0;
+  double sum_of_squares = 0.0;
+  for (size_t i = 0; i < number_of_shards_; ++i) {
+    const Shard & shard = shards_[i];
+    for (size_t j = 0; j < number_of_buckets; ++j) {
+      snapshot.bucket_counts[j] += shard.bucket_counts[j].load(std::memory_order_relaxed);
+    }
+    snapshot.count += shard.count.load(std::memory_order_relaxed);
+    min = std::min(min, shard.min.load(std::memory_order_relaxed));
+    max = std::max(max, shard.max.load(std::memory_order_relaxed));
+    sum += shard.sum.load(std::memory_order_relaxed);
+    sum_of_squares += shard.sum_of_squares.load(std::memory_order_relaxed);
+  }
+  if (0u == snapshot.count) {
+    return snapshot;
+  }
+  snapshot.min = std::chrono::nanoseconds(static_cast<int64_t>(min));
+  snapshot.max = std::chrono::nanoseconds(static_cast<int64_t>(max));
+  const double count = static_cast<double>(snapshot.count);
+  snapshot.mean = sum / count;
+  const double variance = sum_of_squares / count - snapshot.mean * snapshot.mean;
+  // Rounding errors can make the variance slightly negative.
+  snapshot.standard_deviation = std::sqrt(std::max(variance, 0.0));
+  return snapshot;
+}
+
+void
+DurationHistogram::reset()
+{
+  for (size_t i = 0; i < number_of_shards_; ++i) {
+    Shard & shard = shards_[i];
+    for (auto & bucket_count : shard.bucket_counts) {
+      bucket_count.store(0u, std::memory_order_relaxed);
+    }
+    shard.count.store(0u, std::memory_order_relaxed);
+    shard.min.store(std::numeric_limits<uint64_t>::max(), std::memory_order_relaxed);
+    shard.max.store(0u, std::memory_order_relaxed);
+    shard.sum.store(0.0, std::memory_order_relaxed);
+    shard.sum_of_squares.store(0.0, std::memory_order_relaxed);
+  }
+}
+
+size_t
+DurationHistogram::get_number_of_shards() const
+{
+  return number_of_shards_;
+}
+
+size_t
+DurationHistogram::get_allocated_memory_size() const
+{
+  return number_of_shards_ * sizeof(Shard);
+}
+
+size_t
+DurationHistogram::get_bucket(std::chrono::nanoseconds duration)
+{
+  if (duration.count() < static_cast<int64_t>(sub_buckets_per_range)) {
+    return duration.count() > 0 ? static_cast<size_t>(duration.count()) : 0u;
+  }
+  // The bits below the most significant one pick the bucket within its power of two range.
+  const uint64_t value = static_cast<uint64_t>(duration.count());
+  const size_t shift = get_most_significant_bit(value) - sub_bucket_bits;
+  const size_t sub_bucket = static_cast<size_t>(value >> shift) & (sub_buckets_per_range - 1u);
+  return (shift + 1u) * sub_buckets_per_range + sub_bucket;
+}
+
+std::chrono::nanoseconds
+DurationHistogram::get_bucket_upper_bound(size_t bucket)
+{
+  if (bucket >= number_of_buckets - 1u) {
+    return std::chrono::nanoseconds::max();
+  }
+  if (bucket < sub_buckets_per_range) {
+    return std::chrono::nanoseconds(static_cast<int64_t>(bucket) + 1);
+  }
+  const size_t shift = bucket / sub_buckets_per_range - 1u;
+  const size_t sub_bucket = bucket % sub_buckets_per_range;
+  return std::chrono::nanoseconds(
+    static_cast<int64_t>(sub_buckets_per_range + sub_bucket + 1u) << shift);
+}
+
+std::chrono::nanoseconds
+DurationHistogram::Snapshot::get_percentile(double percentile) const
+{
+  if (0u == count) {
+    return std::chrono::nanoseconds(0);
+  }
+  const double clamped_percentile = std::min(std::max(percentile, 0.0), 100.0);
+  const auto rank = static_cast<uint64_t>(
+    std::ceil(clamped_percentile / 100.0 * static_cast<double>(count)));
+  uint64_t cumulated_count = 0;
+  for (size_t i = 0; i < number_of_buckets; ++i) {
+    cumulated_count += bucket_counts[i];
+    if (cumulated_count >= rank && cumulated_count > 0u) {
+      return std::min(get_bucket_upper_bound(i), max);
+    }
+  }
+  return max;
+}
+
+void
+DurationHistogram::Snapshot::merge(const Snapshot & other)
+{
+  if (0u == other.count) {
+    return;
+  }
+  if (0u == count) {
+    *this = other;
+    return;
+  }
+  for (size_t i = 0; i < number_of_buckets; ++i) {
+    bucket_counts[i] += other.bucket_counts[i];
+  }
+  const double this_count = static_cast<double>(count);
+  const double other_count = static_cast<double>(other.count);
+  const double merged_count = this_count + other_count;
+  const double merged_mean = (mean * this_count + other.mean * other_count) / merged_count;
+  // Merged through the averages of the squares of each snapshot.
+  const double this_mean_of_squares = standard_deviation * standard_deviation + mean * mean;
+  const double other_mean_of_squares =
+    other.standard_deviation * other.standard_deviation + other.mean * other.mean;
+  const double variance =
+    (this_mean_of_squares * this_count + other_mean_of_squares * other_count) / merged_count -
+    merged_mean * merged_mean;
+  count += other.count;
+  min = std::min(min, other.min);
+  max = std::max(max, other.max);
+  mean = merged_mean;
+  standard_deviation = std::sqrt(std::max(variance, 0.0));
+}
@@ -13,10 +13,16 @@
 // limitations under the License.
 
 #include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <iterator>
 #include <memory>
 #include <map>
+#include <mutex>
 #include <string>
 #include <type_traits>
+#include <typeinfo>
 #include <utility>
 #include <vector>
 
@@ -24,6 +30,8 @@
 #include "rcl/error_handling.h"
 #include "rcpputils/scope_exit.hpp"
 
+#include "rclcpp/allocation_tracking.hpp"
+#include "rclcpp/detail/extended_tracepoints.hpp"
 #include "rclcpp/exceptions.hpp"
 #include "rclcpp/executor.hpp"
 #include "rclcpp/guard_condition.hpp"
@@ -33,8 +41,31 @@
 
 #include "rcutils/logging_macros.h"
 
+#include "./detail/resize_wait_set.hpp"
+
 using namespace std::chrono_literals;
 
+namespace
+{
+
+/// Executors spinning until a future is complete.
+struct FutureWaiters
+{
+  std::atomic<size_t> size{0};
+  std::mutex mutex;
+  std::vector<rclcpp::Executor *> executors;
+};
+
+// Never destroyed, the promises completed while exiting must still find it.
+FutureWaiters &
+get_future_waiters()
+{
+  static FutureWaiters * future_waiters = new FutureWaiters();
+  return *future_waiters;
+}
+
+}  // namespace
+
 using rclcpp::exceptions::throw_from_rcl_error;
 using rclcpp::AnyExecutable;
 using rclcpp::Executor;
@@ -44,7 +75,12 @@ using rclcpp::FutureReturnCode;
 Executor::Executor(const rclcpp::ExecutorOptions & options)
 : spinning(false),
   shutdown_guard_condition_(std::make_shared<rclcpp::GuardCondition>(options.context)),
-  memory_strategy_(options.memory_strategy)
+  memory_strategy_(options.memory_strategy),
+  scheduling_policy_(options.scheduling_policy),
+  thread_attributes_(options.thread_attributes),
+  wait_set_capacities_(options.wait_set_capacities),
+  busy_poll_(options.busy_poll_budget),
+  shared_waiter_(options.shared_waiter)
 {
   // Store the context for later use.
   context_ = options.context;
@@ -72,9 +108,12 @@ Executor::Executor(const rclcpp::ExecutorOptions & options)
   memory_strategy_->add_guard_condition(&interrupt_guard_condition_);
   rcl_allocator_t allocator = memory_strategy_->get_allocator();
 
+  // Reserved capacities are allocated once, otherwise the wait set is resized before waiting.
   ret = rcl_wait_set_init(
     &wait_set_,
-    0, 2, 0, 0, 0, 0,
+    wait_set_capacities_.subscriptions, std::max<size_t>(2, wait_set_capacities_.guard_conditions),
+    wait_set_capacities_.timers, wait_set_capacities_.clients, wait_set_capacities_.services,
+    wait_set_capacities_.events,
     context_->get_rcl_context().get(),
     allocator);
   if (RCL_RET_OK != ret) {
@@ -113,6 +152,7 @@ Executor::~Executor()
       }
     });
   weak_nodes_.clear();
+  node_memberships_.clear();
   weak_groups_associated_with_executor_to_nodes_.clear();
   weak_groups_to_nodes_associated_with_executor_.clear();
   weak_groups_to_nodes_.clear();
@@ -220,8 +260,8 @@ Executor::add_callback_group_to_map(
   if (has_executor.exchange(true)) {
     throw std::runtime_error("Callback group has already been added to an executor.");
   }
-  bool is_new_node = !has_node(node_ptr, weak_groups_to_nodes_associated_with_executor_) &&
-    !has_node(node_ptr, weak_groups_associated_with_executor_to_nodes_);
+  NodeMembership * membership = find_node_membership(node_ptr);
+  bool is_new_node = !membership || 0u == membership->number_of_groups;
   rclcpp::CallbackGroup::WeakPtr weak_group_ptr = group_ptr;
   auto insert_info =
     weak_groups_to_nodes.insert(std::make_pair(weak_group_ptr, node_ptr));
@@ -231,6 +271,15 @@ Executor::add_callback_group_to_map(
   }
   // Also add to the map that contains all callback groups
   weak_groups_to_nodes_.insert(std::make_pair(weak_group_ptr, node_ptr));
+  if (!membership) {
+    membership = &node_memberships_[node_ptr.get()];
+    membership->node = node_ptr;
+  }
+  ++membership->number_of_groups;
+  if (&weak_groups_to_nodes == &weak_groups_to_nodes_associated_with_executor_) {
+    membership->groups_added_with_node.push_back(weak_group_ptr);
+  }
+  entities_need_rebuild_.store(true);
   if (is_new_node) {
     rclcpp::node_interfaces::NodeBaseInterface::WeakPtr node_weak_ptr(node_ptr);
     weak_nodes_to_guard_conditions_[node_weak_ptr] = node_ptr->get_notify_guard_condition();
@@ -286,6 +335,13 @@ Executor::add_node(rclcpp::node_interfaces::NodeBaseInterface::SharedPtr node_pt
     });
 
   weak_nodes_.push_back(node_ptr);
+  NodeMembership * membership = find_node_membership(node_ptr);
+  if (!membership) {
+    membership = &node_memberships_[node_ptr.get()];
+    membership->node = node_ptr;
+  }
+  membership->added_as_node = true;
+  membership->weak_node_it = std::prev(weak_nodes_.end());
 }
 
 void
@@ -304,15 +360,18 @@ Executor::remove_callback_group_from_map(
     }
     weak_groups_to_nodes.erase(iter);
     weak_groups_to_nodes_.erase(group_ptr);
+    entities_need_rebuild_.store(true);
     std::atomic_bool & has_executor = group_ptr->get_associated_with_executor_atomic();
     has_executor.store(false);
   } else {
     throw std::runtime_error("Callback group needs to be associated with executor.");
   }
+  remove_group_from_node_membership(
+    node_ptr, weak_group_ptr,
+    &weak_groups_to_nodes == &weak_groups_to_nodes_associated_with_executor_);
   // If the node was matched and removed, interrupt waiting.
-  if (!has_node(node_ptr, weak_groups_to_nodes_associated_with_executor_) &&
-    !has_node(node_ptr, weak_groups_associated_with_executor_to_nodes_))
-  {
+  NodeMembership * membership = find_node_membership(node_ptr);
+  if (!membership || 0u == membership->number_of_groups) {
     rclcpp::node_interfaces::NodeBaseInterface::WeakPtr node_weak_ptr(node_ptr);
     weak_nodes_to_guard_conditions_.erase(node_weak_ptr);
     if (notify) {
@@ -351,31 +410,22 @@ Executor::remove_node(rclcpp::node_interfaces::NodeBaseInterface::SharedPtr node
   }
 
   std::lock_guard<std::mutex> guard{mutex_};
-  bool found_node = false;
-  auto node_it = weak_nodes_.begin();
-  while (node_it != weak_nodes_.end()) {
-    bool matched = (node_it->lock() == node_ptr);
-    if (matched) {
-      found_node = true;
-      node_it = weak_nodes_.erase(node_it);
-    } else {
-      ++node_it;
-    }
-  }
-  if (!found_node) {
+  NodeMembership * membership = find_node_membership(node_ptr);
+  if (!membership || !membership->added_as_node) {
     throw std::runtime_error("Node needs to be associated with this executor.");
   }
-
-  for (auto it = weak_groups_to_nodes_associated_with_executor_.begin();
-    it != weak_groups_to_nodes_associated_with_executor_.end(); )
-  {
-    auto weak_node_ptr = it->second;
-    auto shared_node_ptr = weak_node_ptr.lock();
-    auto group_ptr = it->first.lock();
-
-    // Increment iterator before removing in case it's invalidated
-    it++;
-    if (shared_node_ptr == node_ptr) {
+  weak_nodes_.erase(membership->weak_node_it);
+  membership->added_as_node = false;
+  // Only the groups of this node are visited, the membership may go away with the last one.
+  const std::vector<rclcpp::CallbackGroup::WeakPtr> groups =
+    std::move(membership->groups_added_with_node);
+  membership->groups_added_with_node.clear();
+  if (0u == membership->number_of_groups) {
+    node_memberships_.erase(node_ptr.get());
+  }
+  for (const auto & weak_group_ptr : groups) {
+    auto group_ptr = weak_group_ptr.lock();
+    if (group_ptr) {
       remove_callback_group_from_map(
         group_ptr,
         weak_groups_to_nodes_associated_with_executor_,
@@ -498,6 +548,21 @@ Executor::cancel()
   }
 }
 
+void
+Executor::wake()
+{
+  rcl_ret_t ret = rcl_trigger_guard_condition(&interrupt_guard_condition_);
+  if (ret != RCL_RET_OK) {
+    throw_from_rcl_error(ret, "Failed to trigger guard condition in wake");
+  }
+}
+
+bool
+Executor::is_spinning()
+{
+  return spinning;
+}
+
 void
 Executor::set_memory_strategy(rclcpp::memory_strategy::MemoryStrategy::SharedPtr memory_strategy)
 {
@@ -506,6 +571,50 @@ Executor::set_memory_strategy(rclcpp::memory_strategy::MemoryStrategy::SharedPtr
   }
   std::lock_guard<std::mutex> guard{mutex_};
   memory_strategy_ = memory_strategy;
+  entities_need_rebuild_.store(true);
+}
+
+size_t
+Executor::get_memory_strategy_size() const
+{
+  std::lock_guard<std::mutex> guard{mutex_};
+  return memory_strategy_->get_memory_size();
+}
+
+rclcpp::ExecutorStatistics::SharedPtr
+Executor::enable_statistics()
+{
+  std::lock_guard<std::mutex> lock(statistics_mutex_);
+  if (!statistics_owner_) {
+    statistics_owner_ = std::make_shared<ExecutorStatistics>();
+    statistics_.store(statistics_owner_.get(), std::memory_order_release);
+  }
+  return statistics_owner_;
+}
+
+rclcpp::ExecutorStatistics::SharedPtr
+Executor::get_statistics() const
+{
+  std::lock_guard<std::mutex> lock(statistics_mutex_);
+  return statistics_owner_;
+}
+
+rclcpp::ExecutorWatchdog::SharedPtr
+Executor::enable_watchdog(std::chrono::nanoseconds threshold)
+{
+  std::lock_guard<std::mutex> lock(statistics_mutex_);
+  if (!watchdog_owner_) {
+    watchdog_owner_ = std::make_shared<ExecutorWatchdog>(threshold);
+    watchdog_.store(watchdog_owner_.get(), std::memory_order_release);
+  }
+  return watchdog_owner_;
+}
+
+rclcpp::ExecutorWatchdog::SharedPtr
+Executor::get_watchdog() const
+{
+  std::lock_guard<std::mutex> lock(statistics_mutex_);
+  return watchdog_owner_;
 }
 
 void
@@ -514,21 +623,61 @@ Executor::execute_any_executable(AnyExecutable & any_exec)
   if (!spinning.load()) {
     return;
   }
+  ExecutorWatchdog * watchdog = watchdog_.load(std::memory_order_acquire);
+  if (watchdog) {
+    watchdog->begin_execution(any_exec);
+  }
+  RCPPUTILS_SCOPE_EXIT(if (watchdog) {watchdog->end_execution();});
+  ExecutorStatistics * statistics = statistics_.load(std::memory_order_acquire);
+  std::chrono::steady_clock::time_point start;
+  const bool account_cpu_time = statistics && statistics->accounts_cpu_time();
+  std::chrono::nanoseconds cpu_time_start{0};
+  if (account_cpu_time) {
+    cpu_time_start = ExecutorStatistics::get_thread_cpu_time();
+  }
+  if (statistics) {
+    start = std::chrono::steady_clock::now();
+    // Not set if the statistics were enabled after the wait.
+    if (any_exec.ready_time != std::chrono::steady_clock::time_point()) {
+      statistics->record_dispatch_latency(
+        any_exec.callback_group, any_exec.node_base, start - any_exec.ready_time);
+    }
+  }
   if (any_exec.timer) {
+    RCLCPP_EXTENDED_TRACEPOINT(
+      rclcpp_executor_execute,
+      static_cast<const void *>(any_exec.timer->get_timer_handle().get()));
     execute_timer(any_exec.timer);
   }
   if (any_exec.subscription) {
+    RCLCPP_EXTENDED_TRACEPOINT(
+      rclcpp_executor_execute,
+      static_cast<const void *>(any_exec.subscription->get_subscription_handle().get()));
     execute_subscription(any_exec.subscription);
   }
   if (any_exec.service) {
+    RCLCPP_EXTENDED_TRACEPOINT(
+      rclcpp_executor_execute,
+      static_cast<const void *>(any_exec.service->get_service_handle().get()));
     execute_service(any_exec.service);
   }
   if (any_exec.client) {
+    RCLCPP_EXTENDED_TRACEPOINT(
+      rclcpp_executor_execute,
+      static_cast<const void *>(any_exec.client->get_client_handle().get()));
     execute_client(any_exec.client);
   }
   if (any_exec.waitable) {
+    allocation_tracking::CallbackScope scope("waitable", typeid(*any_exec.waitable).name());
     any_exec.waitable->execute(any_exec.data);
   }
+  if (statistics) {
+    statistics->record_execution_duration(std::chrono::steady_clock::now() - start);
+    if (account_cpu_time) {
+      statistics->record_cpu_time(
+        any_exec, ExecutorStatistics::get_thread_cpu_time() - cpu_time_start);
+    }
+  }
   // Reset the callback_group, regardless of type
   any_exec.callback_group->can_be_taken_from().store(true);
   // Wake the wait, because it may need to be recalculated or work that
@@ -539,13 +688,16 @@ Executor::execute_any_executable(AnyExecutable & any_exec)
   }
 }
 
+// The actions are templates rather than std::function, which would allocate to store lambdas
+// capturing more than a couple of references for every message taken.
+template<typename TakeActionT, typename HandleActionT>
 static
 void
 take_and_do_error_handling(
   const char * action_description,
   const char * topic_or_service_name,
-  std::function<bool()> take_action,
-  std::function<void()> handle_action)
+  TakeActionT && take_action,
+  HandleActionT && handle_action)
 {
   bool taken = false;
   try {
@@ -576,8 +728,9 @@ take_and_do_error_handling(
 }
 
 void
-Executor::execute_subscription(rclcpp::SubscriptionBase::SharedPtr subscription)
+Executor::execute_subscription(const rclcpp::SubscriptionBase::SharedPtr & subscription)
 {
+  allocation_tracking::CallbackScope scope("subscription", subscription->get_topic_name());
   rclcpp::MessageInfo message_info;
   message_info.get_rmw_message_info().from_intra_process = false;
 
@@ -588,7 +741,13 @@ Executor::execute_subscription(rclcpp::SubscriptionBase::SharedPtr subscription)
     take_and_do_error_handling(
       "taking a serialized message from topic",
       subscription->get_topic_name(),
-      [&]() {return subscription->take_serialized(*serialized_msg.get(), message_info);},
+      [&]()
+      {
+        if (subscription->takes_latest_only()) {
+          return subscription->take_latest_serialized(serialized_msg, message_info);
+        }
+        return subscription->take_serialized(*serialized_msg.get(), message_info);
+      },
       [&]()
       {
         subscription->handle_serialized_message(serialized_msg, message_info);
@@ -631,6 +790,17 @@ Executor::execute_subscription(rclcpp::SubscriptionBase::SharedPtr subscription)
       }
       loaned_msg = nullptr;
     }
+  } else if (void * reusable_msg = subscription->borrow_reusable_message()) {
+    // This is the case where the message is taken into the one the subscription
+    // keeps for its callback taking it by const reference, which is not
+    // allocated nor reference counted for every message.
+    auto return_reusable_msg = rcpputils::make_scope_exit(
+      [&subscription]() {subscription->return_reusable_message();});
+    take_and_do_error_handling(
+      "taking a message from topic",
+      subscription->get_topic_name(),
+      [&]() {return subscription->take_type_erased(reusable_msg, message_info);},
+      [&]() {subscription->handle_reusable_message(reusable_msg, message_info);});
   } else {
     // This case is taking a copy of the message data from the middleware via
     // inter-process communication.
@@ -638,34 +808,67 @@ Executor::execute_subscription(rclcpp::SubscriptionBase::SharedPtr subscription)
     take_and_do_error_handling(
       "taking a message from topic",
       subscription->get_topic_name(),
-      [&]() {return subscription->take_type_erased(message.get(), message_info);},
+      [&]()
+      {
+        if (subscription->takes_latest_only()) {
+          return subscription->take_latest_type_erased(message, message_info);
+        }
+        return subscription->take_type_erased(message.get(), message_info);
+      },
       [&]() {subscription->handle_message(message, message_info);});
     subscription->return_message(message);
   }
 }
 
 void
-Executor::execute_timer(rclcpp::TimerBase::SharedPtr timer)
+Executor::execute_timer(const rclcpp::TimerBase::SharedPtr & timer)
 {
+  allocation_tracking::CallbackScope scope("timer");
   timer->execute_callback();
 }
 
 void
-Executor::execute_service(rclcpp::ServiceBase::SharedPtr service)
+Executor::execute_service(const rclcpp::ServiceBase::SharedPtr & service)
 {
-  auto request_header = service->create_request_header();
-  std::shared_ptr<void> request = service->create_request();
-  take_and_do_error_handling(
-    "taking a service server request from service",
-    service->get_service_name(),
-    [&]() {return service->take_type_erased_request(request.get(), *request_header);},
-    [&]() {service->handle_request(request_header, request);});
+  allocation_tracking::CallbackScope scope("service", service->get_service_name());
+  const size_t max_requests = service->get_max_requests_per_execution();
+  if (max_requests <= 1u) {
+    auto request_header = service->create_request_header();
+    std::shared_ptr<void> request = service->create_request();
+    take_and_do_error_handling(
+      "taking a service server request from service",
+      service->get_service_name(),
+      [&]() {return service->take_type_erased_request(request.get(), *request_header);},
+      [&]() {service->handle_request(request_header, request);});
+    return;
+  }
+  // Take the requests already received, until none is left or the batch is full.
+  std::vector<rclcpp::ServiceBase::TypeErasedRequest> requests;
+  requests.reserve(max_requests);
+  bool taken = true;
+  while (taken && requests.size() < max_requests) {
+    auto request_header = service->create_request_header();
+    std::shared_ptr<void> request = service->create_request();
+    taken = false;
+    take_and_do_error_handling(
+      "taking a service server request from service",
+      service->get_service_name(),
+      [&]() {
+        taken = service->take_type_erased_request(request.get(), *request_header);
+        return taken;
+      },
+      [&]() {requests.emplace_back(std::move(request_header), std::move(request));});
+  }
+  if (!requests.empty()) {
+    service->handle_requests(requests);
+  }
 }
 
 void
 Executor::execute_client(
-  rclcpp::ClientBase::SharedPtr client)
+  const rclcpp::ClientBase::SharedPtr & client)
 {
+  allocation_tracking::CallbackScope scope("client", client->get_service_name());
   auto request_header = client->create_request_header();
   std::shared_ptr<void> response = client->create_response();
   take_and_do_error_handling(
@@ -678,50 +881,28 @@ Executor::execute_client(
 void
 Executor::wait_for_work(std::chrono::nanoseconds timeout)
 {
+  RCLCPP_EXTENDED_TRACEPOINT(rclcpp_executor_wait_for_work, timeout.count());
+  allocation_tracking::CallbackScope scope("executor");
   {
     std::lock_guard<std::mutex> guard(mutex_);
 
-    // Check weak_nodes_ to find any callback group that is not owned
-    // by an executor and add it to the list of callbackgroups for
-    // collect entities. Also exchange to false so it is not
-    // allowed to add to another executor
-    add_callback_groups_from_nodes_associated_to_executor();
+    // collect_entities() skips the callback groups that are being executed, so a collection
+    // made while one of them is busy (or gone) can be neither reused nor cached.
+    bool all_groups_can_be_taken_from = true;
+    for (const auto & pair : weak_groups_to_nodes_) {
+      auto group = pair.first.lock();
+      if (!group || pair.second.expired() || !group->can_be_taken_from().load()) {
+        all_groups_can_be_taken_from = false;
+        break;
+      }
+    }
 
-    // Collect the subscriptions and timers to be waited on
     memory_strategy_->clear_handles();
-    bool has_invalid_weak_groups_or_nodes =
-      memory_strategy_->collect_entities(weak_groups_to_nodes_);
-
-    if (has_invalid_weak_groups_or_nodes) {
-      std::vector<rclcpp::CallbackGroup::WeakPtr> invalid_group_ptrs;
-      for (auto pair : weak_groups_to_nodes_) {
-        auto weak_group_ptr = pair.first;
-        auto weak_node_ptr = pair.second;
-        if (weak_group_ptr.expired() || weak_node_ptr.expired()) {
-          invalid_group_ptrs.push_back(weak_group_ptr);
-          auto node_guard_pair = weak_nodes_to_guard_conditions_.find(weak_node_ptr);
-          if (node_guard_pair != weak_nodes_to_guard_conditions_.end()) {
-            auto guard_condition = node_guard_pair->second;
-            weak_nodes_to_guard_conditions_.erase(weak_node_ptr);
-            memory_strategy_->remove_guard_condition(guard_condition);
-          }
-        }
-      }
-      std::for_each(
-        invalid_group_ptrs.begin(), invalid_group_ptrs.end(),
-        [this](rclcpp::CallbackGroup::WeakPtr group_ptr) {
-          if (weak_groups_to_nodes_associated_with_executor_.find(group_ptr) !=
-          weak_groups_to_nodes_associated_with_executor_.end())
-          {
-            weak_groups_to_nodes_associated_with_executor_.erase(group_ptr);
-          }
-          if (weak_groups_associated_with_executor_to_nodes_.find(group_ptr) !=
-          weak_groups_associated_with_executor_to_nodes_.end())
-          {
-            weak_groups_associated_with_executor_to_nodes_.erase(group_ptr);
-          }
-          weak_groups_to_nodes_.erase(group_ptr);
-        });
+    const bool entities_restored =
+      all_groups_can_be_taken_from && !entities_need_rebuild_.exchange(false) &&
+      memory_strategy_->restore_collected_handles();
+    if (!entities_restored) {
+      collect_entities_for_wait(all_groups_can_be_taken_from);
     }
 
     // clear wait set
@@ -730,14 +911,10 @@ Executor::wait_for_work(std::chrono::nanoseconds timeout)
       throw_from_rcl_error(ret, "Couldn't clear wait set");
     }
 
+    // Reused entities still fit in the wait set, only resize it after a new collection.
     // The size of waitables are accounted for in size of the other entities
-    ret = rcl_wait_set_resize(
-      &wait_set_, memory_strategy_->number_of_ready_subscriptions(),
-      memory_strategy_->number_of_guard_conditions(), memory_strategy_->number_of_ready_timers(),
-      memory_strategy_->number_of_ready_clients(), memory_strategy_->number_of_ready_services(),
-      memory_strategy_->number_of_ready_events());
-    if (RCL_RET_OK != ret) {
-      throw_from_rcl_error(ret, "Couldn't resize the wait set");
+    if (!entities_restored) {
+      detail::resize_wait_set(&wait_set_, *memory_strategy_, wait_set_capacities_);
     }
 
     if (!memory_strategy_->add_handles_to_wait_set(&wait_set_)) {
@@ -745,8 +922,58 @@ Executor::wait_for_work(std::chrono::nanoseconds timeout)
     }
   }
 
-  rcl_ret_t status =
-    rcl_wait(&wait_set_, std::chrono::duration_cast<std::chrono::nanoseconds>(timeout).count());
+  // The shared waiter only makes the blocking waits, the polls are cheaper made here.
+  auto blocking_wait = [this](std::chrono::nanoseconds wait_timeout) {
+      if (shared_waiter_ && wait_timeout != std::chrono::nanoseconds::zero()) {
+        return shared_waiter_->wait(&wait_set_, wait_timeout);
+      }
+      return rcl_wait(&wait_set_, wait_timeout.count());
+    };
+  rcl_ret_t status;
+  const std::chrono::nanoseconds poll_budget =
+    timeout == std::chrono::nanoseconds::zero() ? timeout : busy_poll_.get_budget();
+  // Non-blocking waits say nothing about how soon work arrives.
+  const bool measure_wait = busy_poll_.is_enabled() && timeout != std::chrono::nanoseconds::zero();
+  std::chrono::steady_clock::time_point wait_start;
+  if (measure_wait) {
+    wait_start = std::chrono::steady_clock::now();
+  }
+  if (poll_budget > std::chrono::nanoseconds::zero()) {
+    const auto poll_end = wait_start +
+      (timeout > std::chrono::nanoseconds::zero() ? std::min(timeout, poll_budget) : poll_budget);
+    while (true) {
+      status = rcl_wait(&wait_set_, 0);
+      if (status != RCL_RET_TIMEOUT) {
+        break;
+      }
+      // rcl_wait() cleared the slots of the entities which were not ready, that is all of them.
+      {
+        std::lock_guard<std::mutex> guard(mutex_);
+        rcl_ret_t ret = rcl_wait_set_clear(&wait_set_);
+        if (ret != RCL_RET_OK) {
+          throw_from_rcl_error(ret, "Couldn't clear wait set");
+        }
+        if (!memory_strategy_->add_handles_to_wait_set(&wait_set_)) {
+          throw std::runtime_error("Couldn't fill wait set");
+        }
+      }
+      const auto now = std::chrono::steady_clock::now();
+      if (now >= poll_end) {
+        // Block for what is left of the timeout.
+        if (timeout > std::chrono::nanoseconds::zero()) {
+          timeout -= std::chrono::duration_cast<std::chrono::nanoseconds>(now - wait_start);
+          timeout = std::max(timeout, std::chrono::nanoseconds::zero());
+        }
+        status = blocking_wait(timeout);
+        break;
+      }
+    }
+  } else {
+    status = blocking_wait(timeout);
+  }
+  if (measure_wait) {
+    busy_poll_.record_wait(std::chrono::steady_clock::now() - wait_start);
+  }
   if (status == RCL_RET_WAIT_SET_EMPTY) {
     RCUTILS_LOG_WARN_NAMED(
       "rclcpp",
@@ -755,18 +982,123 @@ Executor::wait_for_work(std::chrono::nanoseconds timeout)
     using rclcpp::exceptions::throw_from_rcl_error;
     throw_from_rcl_error(status, "rcl_wait() failed");
   }
+  std::chrono::steady_clock::time_point wait_end;
+  if (statistics_.load(std::memory_order_acquire)) {
+    wait_end = std::chrono::steady_clock::now();
+  }
 
   // check the null handles in the wait set and remove them from the handles in memory strategy
   // for callback-based entities
   std::lock_guard<std::mutex> guard(mutex_);
+  last_wait_end_ = wait_end;
   memory_strategy_->remove_null_handles(&wait_set_);
+
+  // A node triggers its notify guard condition when one of its entities is added or removed.
+  // The interrupt guard condition is triggered after every execution and does not imply that.
+  for (size_t i = 0; i < wait_set_.size_of_guard_conditions; ++i) {
+    const rcl_guard_condition_t * guard_condition = wait_set_.guard_conditions[i];
+    if (!guard_condition || guard_condition == &interrupt_guard_condition_) {
+      continue;
+    }
+    for (const auto & pair : weak_nodes_to_guard_conditions_) {
+      if (pair.second == guard_condition) {
+        entities_need_rebuild_.store(true);
+        return;
+      }
+    }
+  }
+}
+
+void
+Executor::collect_entities_for_wait(bool cache_entities)
+{
+  // Check weak_nodes_ to find any callback group that is not owned
+  // by an executor and add it to the list of callbackgroups for
+  // collect entities. Also exchange to false so it is not
+  // allowed to add to another executor
+  add_callback_groups_from_nodes_associated_to_executor();
+
+  // Collect the subscriptions and timers to be waited on
+  bool has_invalid_weak_groups_or_nodes =
+    memory_strategy_->collect_entities(weak_groups_to_nodes_);
+
+  // Only pay for the priority aware selection when the groups don't all have the same priority
+  callback_group_priorities_in_use_ = false;
+  bool has_first_priority = false;
+  int first_priority = 0;
+  for (const auto & pair : weak_groups_to_nodes_) {
+    auto group = pair.first.lock();
+    if (!group) {
+      continue;
+    }
+    if (!has_first_priority) {
+      has_first_priority = true;
+      first_priority = group->priority();
+    } else if (group->priority() != first_priority) {
+      callback_group_priorities_in_use_ = true;
+      break;
+    }
+  }
+
+  if (cache_entities) {
+    memory_strategy_->cache_collected_handles();
+  } else {
+    // The entities of busy callback groups were left out, collect again next time.
+    entities_need_rebuild_.store(true);
+  }
+
+  if (has_invalid_weak_groups_or_nodes) {
+    std::vector<rclcpp::CallbackGroup::WeakPtr> invalid_group_ptrs;
+    for (auto pair : weak_groups_to_nodes_) {
+      auto weak_group_ptr = pair.first;
+      auto weak_node_ptr = pair.second;
+      if (weak_group_ptr.expired() || weak_node_ptr.expired()) {
+        invalid_group_ptrs.push_back(weak_group_ptr);
+        auto node_ptr = weak_node_ptr.lock();
+        if (node_ptr) {
+          remove_group_from_node_membership(
+            node_ptr, weak_group_ptr,
+            weak_groups_to_nodes_associated_with_executor_.count(weak_group_ptr) != 0u);
+        }
+        auto node_guard_pair = weak_nodes_to_guard_conditions_.find(weak_node_ptr);
+        if (node_guard_pair != weak_nodes_to_guard_conditions_.end()) {
+          auto guard_condition = node_guard_pair->second;
+          weak_nodes_to_guard_conditions_.erase(weak_node_ptr);
+          memory_strategy_->remove_guard_condition(guard_condition);
+        }
+      }
+    }
+    std::for_each(
+      invalid_group_ptrs.begin(), invalid_group_ptrs.end(),
+      [this](rclcpp::CallbackGroup::WeakPtr group_ptr) {
+        if (weak_groups_to_nodes_associated_with_executor_.find(group_ptr) !=
+        weak_groups_to_nodes_associated_with_executor_.end())
+        {
+          weak_groups_to_nodes_associated_with_executor_.erase(group_ptr);
+        }
+        if (weak_groups_associated_with_executor_to_nodes_.find(group_ptr) !=
+        weak_groups_associated_with_executor_to_nodes_.end())
+        {
+          weak_groups_associated_with_executor_to_nodes_.erase(group_ptr);
+        }
+        weak_groups_to_nodes_.erase(group_ptr);
+      });
+    // The nodes which are gone are forgotten with all their groups.
+    for (auto it = node_memberships_.begin(); it != node_memberships_.end(); ) {
+      if (it->second.node.expired()) {
+        it = node_memberships_.erase(it);
+      } else {
+        ++it;
+      }
+    }
+  }
 }
 
 rclcpp::node_interfaces::NodeBaseInterface::SharedPtr
 Executor::get_node_by_group(
   const rclcpp::memory_strategy::MemoryStrategy::WeakCallbackGroupsToNodesMap &
   weak_groups_to_nodes,
-  rclcpp::CallbackGroup::SharedPtr group)
+  const rclcpp::CallbackGroup::SharedPtr & group)
 {
   if (!group) {
     return nullptr;
@@ -781,7 +1113,7 @@ Executor::get_node_by_group(
 }
 
 rclcpp::CallbackGroup::SharedPtr
-Executor::get_group_by_timer(rclcpp::TimerBase::SharedPtr timer)
+Executor::get_group_by_timer(const rclcpp::TimerBase::SharedPtr & timer)
 {
   std::lock_guard<std::mutex> guard{mutex_};
   for (const auto & pair : weak_groups_associated_with_executor_to_nodes_) {
@@ -790,7 +1122,7 @@ Executor::get_group_by_timer(rclcpp::TimerBase::SharedPtr timer)
       continue;
     }
     auto timer_ref = group->find_timer_ptrs_if(
-      [timer](const rclcpp::TimerBase::SharedPtr & timer_ptr) -> bool {
+      [&timer](const rclcpp::TimerBase::SharedPtr & timer_ptr) -> bool {
         return timer_ptr == timer;
       });
     if (timer_ref) {
@@ -804,7 +1136,7 @@ Executor::get_group_by_timer(rclcpp::TimerBase::SharedPtr timer)
       continue;
     }
     auto timer_ref = group->find_timer_ptrs_if(
-      [timer](const rclcpp::TimerBase::SharedPtr & timer_ptr) -> bool {
+      [&timer](const rclcpp::TimerBase::SharedPtr & timer_ptr) -> bool {
         return timer_ptr == timer;
       });
     if (timer_ref) {
@@ -817,6 +1149,7 @@ Executor::get_group_by_timer(rclcpp::TimerBase::SharedPtr timer)
 bool
 Executor::get_next_ready_executable(AnyExecutable & any_executable)
 {
+  RCLCPP_EXTENDED_TRACEPOINT(rclcpp_executor_get_next_ready);
   bool success = get_next_ready_executable_from_map(any_executable, weak_groups_to_nodes_);
   return success;
 }
@@ -827,41 +1160,87 @@ Executor::get_next_ready_executable_from_map(
   const rclcpp::memory_strategy::MemoryStrategy::WeakCallbackGroupsToNodesMap &
   weak_groups_to_nodes)
 {
-  bool success = false;
   std::lock_guard<std::mutex> guard{mutex_};
-  // Check the timers to see if there are any that are ready
-  memory_strategy_->get_next_timer(any_executable, weak_groups_to_nodes);
-  if (any_executable.timer) {
-    success = true;
-  }
-  if (!success) {
-    // Check the subscriptions to see if there are any that are ready
-    memory_strategy_->get_next_subscription(any_executable, weak_groups_to_nodes);
-    if (any_executable.subscription) {
-      success = true;
-    }
-  }
-  if (!success) {
-    // Check the services to see if there are any that are ready
-    memory_strategy_->get_next_service(any_executable, weak_groups_to_nodes);
-    if (any_executable.service) {
-      success = true;
+  return take_next_ready_executable(any_executable, weak_groups_to_nodes);
+}
+
+size_t
+Executor::get_all_ready_executables(std::vector<AnyExecutable> & ready_executables)
+{
+  size_t number_of_ready_executables = 0;
+  std::lock_guard<std::mutex> guard{mutex_};
+  while (true) {
+    AnyExecutable any_executable;
+    if (!take_next_ready_executable(any_executable, weak_groups_to_nodes_)) {
+      break;
     }
+    ready_executables.emplace_back(std::move(any_executable));
+    ++number_of_ready_executables;
   }
-  if (!success) {
-    // Check the clients to see if there are any that are ready
-    memory_strategy_->get_next_client(any_executable, weak_groups_to_nodes);
-    if (any_executable.client) {
-      success = true;
+  return number_of_ready_executables;
+}
+
+bool
+Executor::take_next_ready_executable(
+  AnyExecutable & any_executable,
+  const rclcpp::memory_strategy::MemoryStrategy::WeakCallbackGroupsToNodesMap &
+  weak_groups_to_nodes)
+{
+  bool success = false;
+  if (
+    rclcpp::ExecutorSchedulingPolicy::FixedOrder != scheduling_policy_ ||
+    callback_group_priorities_in_use_)
+  {
+    if (rclcpp::ExecutorSchedulingPolicy::EarliestDeadlineFirst == scheduling_policy_) {
+      // The entities which are the closest to missing their deadline go first
+      memory_strategy_->get_next_executable_by_deadline(any_executable, weak_groups_to_nodes);
+    } else if (rclcpp::ExecutorSchedulingPolicy::RoundRobin == scheduling_policy_) {
+      // The entities which waited the longest since they were last executed go first
+      memory_strategy_->get_next_executable_round_robin(any_executable, weak_groups_to_nodes);
+    } else {
+      // Entities of the callback groups with a higher priority go first, whatever their type
+      memory_strategy_->get_next_executable_by_priority(any_executable, weak_groups_to_nodes);
     }
-  }
-  if (!success) {
-    // Check the waitables to see if there are any that are ready
-    memory_strategy_->get_next_waitable(any_executable, weak_groups_to_nodes);
     if (any_executable.waitable) {
       any_executable.data = any_executable.waitable->take_data();
+    }
+    success = any_executable.timer || any_executable.subscription || any_executable.service ||
+      any_executable.client || any_executable.waitable;
+  } else {
+    // Check the timers to see if there are any that are ready
+    memory_strategy_->get_next_timer(any_executable, weak_groups_to_nodes);
+    if (any_executable.timer) {
       success = true;
     }
+    if (!success) {
+      // Check the subscriptions to see if there are any that are ready
+      memory_strategy_->get_next_subscription(any_executable, weak_groups_to_nodes);
+      if (any_executable.subscription) {
+        success = true;
+      }
+    }
+    if (!success) {
+      // Check the services to see if there are any that are ready
+      memory_strategy_->get_next_service(any_executable, weak_groups_to_nodes);
+      if (any_executable.service) {
+        success = true;
+      }
+    }
+    if (!success) {
+      // Check the clients to see if there are any that are ready
+      memory_strategy_->get_next_client(any_executable, weak_groups_to_nodes);
+      if (any_executable.client) {
+        success = true;
+      }
+    }
+    if (!success) {
+      // Check the waitables to see if there are any that are ready
+      memory_strategy_->get_next_waitable(any_executable, weak_groups_to_nodes);
+      if (any_executable.waitable) {
+        any_executable.data = any_executable.waitable->take_data();
+        success = true;
+      }
+    }
   }
   // At this point any_executable should be valid with either a valid subscription
   // or a valid timer, or it should be a null shared_ptr
@@ -874,6 +1253,7 @@ Executor::get_next_ready_executable_from_map(
   }
 
   if (success) {
+    any_executable.ready_time = last_wait_end_;
     // If it is valid, check to see if the group is mutually exclusive or
     // not, then mark it accordingly ..Check if the callback_group belongs to this executor
     if (any_executable.callback_group && any_executable.callback_group->type() == \
@@ -911,6 +1291,52 @@ Executor::get_next_executable(AnyExecutable & any_executable, std::chrono::nanos
   return success;
 }
 
+Executor::NodeMembership *
+Executor::find_node_membership(
+  const rclcpp::node_interfaces::NodeBaseInterface::SharedPtr & node_ptr)
+{
+  auto it = node_memberships_.find(node_ptr.get());
+  if (it == node_memberships_.end()) {
+    return nullptr;
+  }
+  if (it->second.node.lock() != node_ptr) {
+    // The node at this address is gone, and was never removed from the executor.
+    node_memberships_.erase(it);
+    return nullptr;
+  }
+  return &it->second;
+}
+
+void
+Executor::remove_group_from_node_membership(
+  const rclcpp::node_interfaces::NodeBaseInterface::SharedPtr & node_ptr,
+  const rclcpp::CallbackGroup::WeakPtr & weak_group_ptr,
+  bool added_with_node)
+{
+  NodeMembership * membership = find_node_membership(node_ptr);
+  if (!membership) {
+    return;
+  }
+  if (added_with_node) {
+    auto & groups = membership->groups_added_with_node;
+    auto it = std::find_if(
+      groups.begin(), groups.end(),
+      [&weak_group_ptr](const rclcpp::CallbackGroup::WeakPtr & other) {
+        return !weak_group_ptr.owner_before(other) && !other.owner_before(weak_group_ptr);
+      });
+    if (it != groups.end()) {
+      *it = std::move(groups.back());
+      groups.pop_back();
+    }
+  }
+  if (membership->number_of_groups > 0u) {
+    --membership->number_of_groups;
+  }
+  if (0u == membership->number_of_groups && !membership->added_as_node) {
+    node_memberships_.erase(node_ptr.get());
+  }
+}
+
 // Returns true iff the weak_groups_to_nodes map has node_ptr as the value in any of its entry.
 bool
 Executor::has_node(
@@ -926,3 +1352,41 @@ Executor::has_node(
       return other_ptr == node_ptr;
     }) != weak_groups_to_nodes.end();
 }
+
+rclcpp::detail::FutureWaiterScope::FutureWaiterScope(rclcpp::Executor * executor)
+: executor_(executor)
+{
+  FutureWaiters & future_waiters = get_future_waiters();
+  std::lock_guard<std::mutex> lock(future_waiters.mutex);
+  future_waiters.executors.push_back(executor_);
+  future_waiters.size.store(future_waiters.executors.size(), std::memory_order_release);
+}
+
+rclcpp::detail::FutureWaiterScope::~FutureWaiterScope()
+{
+  FutureWaiters & future_waiters = get_future_waiters();
+  std::lock_guard<std::mutex> lock(future_waiters.mutex);
+  auto & executors = future_waiters.executors;
+  executors.erase(std::find(executors.begin(), executors.end(), executor_));
+  future_waiters.size.store(executors.size(), std::memory_order_release);
+}
+
+void
+rclcpp::detail::wake_future_waiters()
+{
+  FutureWaiters & future_waiters = get_future_waiters();
+  if (0u == future_waiters.size.load(std::memory_order_acquire)) {
+    return;
+  }
+  // Held while waking, for the executors not to be destroyed meanwhile.
+  std::lock_guard<std::mutex> lock(future_waiters.mutex);
+  for (rclcpp::Executor * executor : future_waiters.executors) {
+    try {
+      executor->wake();
+    } catch (const std::exception & exception) {
+      RCUTILS_LOG_ERROR_NAMED(
+        "rclcpp",
+        "failed to wake an executor spinning until a future is complete: %s", exception.what());
+    }
+  }
+}
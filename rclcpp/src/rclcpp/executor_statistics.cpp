@@ -0,0 +1,264 @@
+// Copyright 2021 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "rclcpp/executor_statistics.hpp"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+#include <algorithm>
+#include <cerrno>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <utility>
+#include <vector>
+
+using rclcpp::DurationHistogram;
+using rclcpp::ExecutorStatistics;
+
+namespace
+{
+
+/// Return the number of shards of the histograms recorded in by all the threads of an executor.
+size_t
+get_number_of_shards()
+{
+  // hardware_concurrency() returns 0 when it is not known.
+  return std::min<size_t>(std::max(std::thread::hardware_concurrency(), 1u), 8u);
+}
+
+}  // namespace
+
+ExecutorStatistics::ExecutorStatistics()
+: dispatch_latency_(get_number_of_shards()),
+  execution_duration_(get_number_of_shards())
+{
+}
+
+void
+ExecutorStatistics::record_dispatch_latency(
+  const rclcpp::CallbackGroup::SharedPtr & group,
+  const rclcpp::node_interfaces::NodeBaseInterface::SharedPtr & node,
+  std::chrono::nanoseconds dispatch_latency)
+{
+  dispatch_latency_.record(dispatch_latency);
+  if (!group) {
+    return;
+  }
+  DurationHistogram * queueing_delay;
+  {
+    std::lock_guard<std::mutex> lock(callback_groups_mutex_);
+    auto it = callback_groups_.find(group.get());
+    // A group destroyed and another one allocated at the same address is a new group.
+    if (it != callback_groups_.end() && it->second.group.lock() != group) {
+      callback_groups_.erase(it);
+      it = callback_groups_.end();
+    }
+    if (it == callback_groups_.end()) {
+      CallbackGroupEntry entry;
+      entry.group = group;
+      if (node) {
+        entry.name = node->get_fully_qualified_name();
+      }
+      if (node && node->get_default_callback_group() == group) {
+        entry.name += "/default_callback_group";
+      } else {
+        entry.name += "/callback_group_" + std::to_string(++number_of_named_callback_groups_);
+      }
+      entry.queueing_delay = std::make_unique<DurationHistogram>();
+      it = callback_groups_.emplace(group.get(), std::move(entry)).first;
+    }
+    queueing_delay = it->second.queueing_delay.get();
+  }
+  queueing_delay->record(dispatch_latency);
+}
+
+void
+ExecutorStatistics::record_execution_duration(std::chrono::nanoseconds duration)
+{
+  execution_duration_.record(duration);
+}
+
+void
+ExecutorStatistics::enable_cpu_time_accounting()
+{
+  accounts_cpu_time_.store(true, std::memory_order_relaxed);
+}
+
+bool
+ExecutorStatistics::accounts_cpu_time() const
+{
+  return accounts_cpu_time_.load(std::memory_order_relaxed);
+}
+
+std::chrono::nanoseconds
+ExecutorStatistics::get_thread_cpu_time()
+{
+#ifdef _WIN32
+  FILETIME creation_time, exit_time, kernel_time, user_time;
+  if (!GetThreadTimes(GetCurrentThread(), &creation_time, &exit_time, &kernel_time, &user_time)) {
+    throw std::system_error(
+            static_cast<int>(GetLastError()), std::system_category(),
+            "failed to get the CPU time of the thread");
+  }
+  auto to_100ns = [](const FILETIME & time) {
+      return (static_cast<uint64_t>(time.dwHighDateTime) << 32) | time.dwLowDateTime;
+    };
+  return std::chrono::nanoseconds((to_100ns(kernel_time) + to_100ns(user_time)) * 100);
+#else
+  struct timespec time;
+  if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &time) != 0) {
+    throw std::system_error(errno, std::generic_category(), "failed to read the thread CPU clock");
+  }
+  return std::chrono::seconds(time.tv_sec) + std::chrono::nanoseconds(time.tv_nsec);
+#endif
+}
+
+void
+ExecutorStatistics::record_cpu_time(
+  const rclcpp::AnyExecutable & any_exec,
+  std::chrono::nanoseconds cpu_time)
+{
+  std::shared_ptr<void> entity;
+  if (any_exec.subscription) {
+    entity = any_exec.subscription;
+  } else if (any_exec.timer) {
+    entity = any_exec.timer;
+  } else if (any_exec.service) {
+    entity = any_exec.service;
+  } else if (any_exec.client) {
+    entity = any_exec.client;
+  } else if (any_exec.waitable) {
+    entity = any_exec.waitable;
+  } else {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(entities_mutex_);
+  auto it = entities_.find(entity.get());
+  // An entity destroyed and another one allocated at the same address is a new entity.
+  if (it != entities_.end() && it->second.entity.lock() != entity) {
+    entities_.erase(it);
+    it = entities_.end();
+  }
+  if (it == entities_.end()) {
+    EntityEntry entry;
+    entry.entity = entity;
+    if (any_exec.node_base) {
+      entry.cpu_time.name = any_exec.node_base->get_fully_qualified_name();
+    }
+    if (any_exec.subscription) {
+      entry.cpu_time.name += std::string("/subscription:") +
+        any_exec.subscription->get_topic_name();
+    } else if (any_exec.timer) {
+      entry.cpu_time.name += "/timer_" + std::to_string(++number_of_named_timers_);
+    } else if (any_exec.service) {
+      entry.cpu_time.name += std::string("/service:") + any_exec.service->get_service_name();
+    } else if (any_exec.client) {
+      entry.cpu_time.name += std::string("/client:") + any_exec.client->get_service_name();
+    } else {
+      entry.cpu_time.name += "/waitable_" + std::to_string(++number_of_named_waitables_);
+    }
+    it = entities_.emplace(entity.get(), std::move(entry)).first;
+  }
+  EntityCpuTime & entity_cpu_time = it->second.cpu_time;
+  if (entity_cpu_time.executions == 0u || cpu_time < entity_cpu_time.min) {
+    entity_cpu_time.min = cpu_time;
+  }
+  if (cpu_time > entity_cpu_time.max) {
+    entity_cpu_time.max = cpu_time;
+  }
+  entity_cpu_time.total += cpu_time;
+  ++entity_cpu_time.executions;
+}
+
+DurationHistogram::Snapshot
+ExecutorStatistics::get_dispatch_latency() const
+{
+  return dispatch_latency_.get_snapshot();
+}
+
+DurationHistogram::Snapshot
+ExecutorStatistics::get_execution_duration() const
+{
+  return execution_duration_.get_snapshot();
+}
+
+std::vector<ExecutorStatistics::CallbackGroupQueueingDelay>
+ExecutorStatistics::get_callback_group_queueing_delays() const
+{
+  std::vector<CallbackGroupQueueingDelay> queueing_delays;
+  std::lock_guard<std::mutex> lock(callback_groups_mutex_);
+  queueing_delays.reserve(callback_groups_.size());
+  for (const auto & pair : callback_groups_) {
+    const auto snapshot = pair.second.queueing_delay->get_snapshot();
+    if (snapshot.count > 0u) {
+      queueing_delays.push_back({pair.second.name, snapshot});
+    }
+  }
+  return queueing_delays;
+}
+
+std::vector<ExecutorStatistics::EntityCpuTime>
+ExecutorStatistics::get_entity_cpu_times() const
+{
+  std::vector<EntityCpuTime> cpu_times;
+  {
+    std::lock_guard<std::mutex> lock(entities_mutex_);
+    cpu_times.reserve(entities_.size());
+    for (const auto & pair : entities_) {
+      if (pair.second.cpu_time.executions > 0u) {
+        cpu_times.push_back(pair.second.cpu_time);
+      }
+    }
+  }
+  std::sort(
+    cpu_times.begin(), cpu_times.end(),
+    [](const EntityCpuTime & a, const EntityCpuTime & b) {return a.total > b.total;});
+  return cpu_times;
+}
+
+void
+ExecutorStatistics::reset()
+{
+  dispatch_latency_.reset();
+  execution_duration_.reset();
+  {
+    std::lock_guard<std::mutex> lock(entities_mutex_);
+    for (auto it = entities_.begin(); it != entities_.end(); ) {
+      if (it->second.entity.expired()) {
+        it = entities_.erase(it);
+      } else {
+        EntityCpuTime & cpu_time = it->second.cpu_time;
+        cpu_time.executions = 0;
+        cpu_time.total = cpu_time.min = cpu_time.max = std::chrono::nanoseconds(0);
+        ++it;
+      }
+    }
+  }
+  std::lock_guard<std::mutex> lock(callback_groups_mutex_);
+  for (auto it = callback_groups_.begin(); it != callback_groups_.end(); ) {
+    if (it->second.group.expired()) {
+      it = callback_groups_.erase(it);
+    } else {
+      it->second.queueing_delay->reset();
+      ++it;
+    }
+  }
+}
@@ -0,0 +1,190 @@
+// Copyright 2021 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "rclcpp/executor_watchdog.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <typeinfo>
+
+#include "rclcpp/logging.hpp"
+
+using rclcpp::ExecutorWatchdog;
+
+namespace
+{
+
+std::chrono::nanoseconds
+check_threshold(std::chrono::nanoseconds threshold)
+{
+  if (threshold <= std::chrono::nanoseconds(0)) {
+    throw std::invalid_argument("threshold must be positive");
+  }
+  return threshold;
+}
+
+double
+to_seconds(std::chrono::nanoseconds duration)
+{
+  return std::chrono::duration<double>(duration).count();
+}
+
+rclcpp::Logger
+get_watchdog_logger()
+{
+  return rclcpp::get_logger("rclcpp.executor_watchdog");
+}
+
+}  // namespace
+
+std::string
+rclcpp::describe_executable(const rclcpp::AnyExecutable & any_exec)
+{
+  std::string description;
+  if (any_exec.timer) {
+    description = "timer";
+  } else if (any_exec.subscription) {
+    description = std::string("subscription on '") + any_exec.subscription->get_topic_name() + "'";
+  } else if (any_exec.service) {
+    description = std::string("service '") + any_exec.service->get_service_name() + "'";
+  } else if (any_exec.client) {
+    description = std::string("client of '") + any_exec.client->get_service_name() + "'";
+  } else if (any_exec.waitable) {
+    description = std::string("waitable of type '") + typeid(*any_exec.waitable).name() + "'";
+  } else {
+    description = "executable";
+  }
+  if (any_exec.callback_group) {
+    char group[64];
+    std::snprintf(
+      group, sizeof(group), " in %s callback group %p",
+      any_exec.callback_group->type() == rclcpp::CallbackGroupType::Reentrant ?
+      "reentrant" : "mutually exclusive",
+      static_cast<const void *>(any_exec.callback_group.get()));
+    description += group;
+  }
+  if (any_exec.node_base) {
+    description += std::string(" of node '") + any_exec.node_base->get_fully_qualified_name() +
+      "'";
+  }
+  return description;
+}
+
+ExecutorWatchdog::ExecutorWatchdog(std::chrono::nanoseconds threshold)
+: threshold_(check_threshold(threshold))
+{
+  thread_ = std::thread([this]() {run();});
+}
+
+ExecutorWatchdog::~ExecutorWatchdog()
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopped_ = true;
+  }
+  stop_condition_.notify_all();
+  thread_.join();
+}
+
+void
+ExecutorWatchdog::begin_execution(const rclcpp::AnyExecutable & any_exec)
+{
+  const auto start = std::chrono::steady_clock::now();
+  std::lock_guard<std::mutex> lock(mutex_);
+  Execution & execution = executions_[std::this_thread::get_id()];
+  execution.any_exec = &any_exec;
+  execution.start = start;
+  execution.reported = false;
+}
+
+void
+ExecutorWatchdog::end_execution()
+{
+  const auto end = std::chrono::steady_clock::now();
+  std::string description;
+  std::chrono::nanoseconds duration;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = executions_.find(std::this_thread::get_id());
+    if (it == executions_.end() || !it->second.any_exec) {
+      return;
+    }
+    Execution & execution = it->second;
+    if (execution.reported) {
+      description = describe_executable(*execution.any_exec);
+      duration = end - execution.start;
+    }
+    execution.any_exec = nullptr;
+  }
+  if (description.empty()) {
+    return;
+  }
+  const int64_t duration_ns = duration.count();
+  int64_t longest = longest_stall_ns_.load(std::memory_order_relaxed);
+  while (duration_ns > longest &&
+    !longest_stall_ns_.compare_exchange_weak(longest, duration_ns, std::memory_order_relaxed))
+  {
+  }
+  RCLCPP_WARN(
+    get_watchdog_logger(), "stalled %s finished after %.3f s",
+    description.c_str(), to_seconds(duration));
+}
+
+std::chrono::nanoseconds
+ExecutorWatchdog::get_threshold() const
+{
+  return threshold_;
+}
+
+uint64_t
+ExecutorWatchdog::get_stall_count() const
+{
+  return stall_count_.load(std::memory_order_relaxed);
+}
+
+std::chrono::nanoseconds
+ExecutorWatchdog::get_longest_stall() const
+{
+  return std::chrono::nanoseconds(longest_stall_ns_.load(std::memory_order_relaxed));
+}
+
+void
+ExecutorWatchdog::run()
+{
+  // A stall is reported at most a quarter of the threshold after it happens.
+  const auto period = std::max<std::chrono::nanoseconds>(
+    threshold_ / 4, std::chrono::milliseconds(1));
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (!stop_condition_.wait_for(lock, period, [this]() {return stopped_;})) {
+    const auto now = std::chrono::steady_clock::now();
+    for (auto & thread_and_execution : executions_) {
+      Execution & execution = thread_and_execution.second;
+      if (!execution.any_exec || execution.reported || now - execution.start < threshold_) {
+        continue;
+      }
+      execution.reported = true;
+      stall_count_.fetch_add(1u, std::memory_order_relaxed);
+      // Logged under the lock, which keeps the executable alive, the stalls are rare.
+      RCLCPP_WARN(
+        get_watchdog_logger(), "%s has been running for %.3f s, longer than %.3f s",
+        describe_executable(*execution.any_exec).c_str(),
+        to_seconds(now - execution.start), to_seconds(threshold_));
+    }
+  }
+}
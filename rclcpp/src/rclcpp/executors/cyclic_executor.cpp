@@ -0,0 +1,323 @@
+// Copyright 2021 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "rclcpp/executors/cyclic_executor.hpp"
+
+#include <algorithm>
+#include <array>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+
+#include "rcpputils/scope_exit.hpp"
+
+#include "rclcpp/exceptions.hpp"
+#include "rclcpp/executors/static_wait_set_executor.hpp"
+#include "rclcpp/logging.hpp"
+#include "rclcpp/thread_attributes.hpp"
+#include "rclcpp/utilities.hpp"
+
+using rclcpp::executors::CyclicExecutor;
+using rclcpp::executors::CyclicExecutorStatistics;
+
+namespace
+{
+
+std::chrono::nanoseconds
+check_cycle_time(std::chrono::nanoseconds cycle_time)
+{
+  if (cycle_time <= std::chrono::nanoseconds(0)) {
+    throw std::invalid_argument("cycle_time must be positive");
+  }
+  return cycle_time;
+}
+
+[[noreturn]] void
+throw_entities_are_in_steps()
+{
+  throw std::runtime_error(
+          "the entities of a CyclicExecutor are given in the steps of its schedule");
+}
+
+}  // namespace
+
+CyclicExecutor::CyclicExecutor(
+  std::chrono::nanoseconds cycle_time,
+  const rclcpp::ExecutorOptions & options)
+: rclcpp::Executor(options),
+  cycle_time_(check_cycle_time(cycle_time)),
+  interrupt_waitable_(
+    std::make_shared<detail::ExecutorGuardConditionWaitable>(&interrupt_guard_condition_)),
+  wait_set_(
+    {},
+    std::array<rclcpp::GuardCondition::SharedPtr, 1>{shutdown_guard_condition_},
+    {},
+    {},
+    {},
+    [this]() {
+      std::array<WaitSetType::WaitableEntry, 1> waitables;
+      waitables[0] = interrupt_waitable_;
+      return waitables;
+    }(),
+    options.context)
+{}
+
+CyclicExecutor::~CyclicExecutor()
+{
+  for (auto & step : schedule_) {
+    if (step.message) {
+      step.subscription->return_message(step.message);
+    }
+    if (step.serialized_message) {
+      step.subscription->return_serialized_message(step.serialized_message);
+    }
+  }
+}
+
+void
+CyclicExecutor::add_subscription_step(rclcpp::SubscriptionBase::SharedPtr subscription)
+{
+  if (!subscription) {
+    throw std::invalid_argument("the subscription is nullptr");
+  }
+  throw_if_spinning();
+  Step step;
+  // The messages are taken into the same one every cycle, unless the callback keeps it.
+  if (subscription->is_serialized()) {
+    step.serialized_message = subscription->create_serialized_message();
+  } else {
+    step.message = subscription->create_message();
+  }
+  step.intra_process_waitable = subscription->get_intra_process_waitable();
+  step.subscription = std::move(subscription);
+  schedule_.push_back(std::move(step));
+}
+
+void
+CyclicExecutor::add_function_step(std::function<void()> function)
+{
+  if (!function) {
+    throw std::invalid_argument("the function is empty");
+  }
+  throw_if_spinning();
+  Step step;
+  step.function = std::move(function);
+  schedule_.push_back(std::move(step));
+}
+
+std::chrono::nanoseconds
+CyclicExecutor::get_cycle_time() const
+{
+  return cycle_time_;
+}
+
+CyclicExecutorStatistics
+CyclicExecutor::get_statistics() const
+{
+  CyclicExecutorStatistics statistics;
+  statistics.cycles = cycles_.load(std::memory_order_relaxed);
+  statistics.overruns = overruns_.load(std::memory_order_relaxed);
+  statistics.max_execution_time =
+    std::chrono::nanoseconds(max_execution_time_ns_.load(std::memory_order_relaxed));
+  return statistics;
+}
+
+void
+CyclicExecutor::spin()
+{
+  if (spinning.exchange(true)) {
+    throw std::runtime_error("spin() called while already spinning");
+  }
+  RCPPUTILS_SCOPE_EXIT(this->spinning.store(false); );
+  rclcpp::ScopedThreadAttributes thread_attributes(thread_attributes_);
+  while (rclcpp::ok(this->context_) && spinning.load()) {
+    if (wait_for_cycle_start(std::chrono::steady_clock::time_point::max())) {
+      execute_cycle();
+    }
+  }
+}
+
+void
+CyclicExecutor::spin_some(std::chrono::nanoseconds max_duration)
+{
+  (void)max_duration;
+  if (spinning.exchange(true)) {
+    throw std::runtime_error("spin_some() called while already spinning");
+  }
+  RCPPUTILS_SCOPE_EXIT(this->spinning.store(false); );
+  if (rclcpp::ok(this->context_)) {
+    next_cycle_start_ = std::chrono::steady_clock::now();
+    execute_cycle();
+  }
+}
+
+void
+CyclicExecutor::spin_all(std::chrono::nanoseconds max_duration)
+{
+  if (max_duration <= std::chrono::nanoseconds(0)) {
+    throw std::invalid_argument("max_duration must be positive");
+  }
+  spin_some(max_duration);
+}
+
+void
+CyclicExecutor::add_callback_group(
+  rclcpp::CallbackGroup::SharedPtr group_ptr,
+  rclcpp::node_interfaces::NodeBaseInterface::SharedPtr node_ptr,
+  bool notify)
+{
+  (void)group_ptr;
+  (void)node_ptr;
+  (void)notify;
+  throw_entities_are_in_steps();
+}
+
+void
+CyclicExecutor::add_node(
+  rclcpp::node_interfaces::NodeBaseInterface::SharedPtr node_ptr, bool notify)
+{
+  (void)node_ptr;
+  (void)notify;
+  throw_entities_are_in_steps();
+}
+
+void
+CyclicExecutor::add_node(std::shared_ptr<rclcpp::Node> node_ptr, bool notify)
+{
+  (void)node_ptr;
+  (void)notify;
+  throw_entities_are_in_steps();
+}
+
+void
+CyclicExecutor::spin_once_impl(std::chrono::nanoseconds timeout)
+{
+  auto deadline = std::chrono::steady_clock::time_point::max();
+  if (timeout >= std::chrono::nanoseconds(0)) {
+    deadline = std::chrono::steady_clock::now() + timeout;
+  }
+  if (wait_for_cycle_start(deadline)) {
+    execute_cycle();
+  }
+}
+
+bool
+CyclicExecutor::wait_for_cycle_start(std::chrono::steady_clock::time_point deadline)
+{
+  auto now = std::chrono::steady_clock::now();
+  if (next_cycle_start_ == std::chrono::steady_clock::time_point{}) {
+    next_cycle_start_ = now;
+  }
+  while (now < next_cycle_start_) {
+    if (!rclcpp::ok(this->context_) || !spinning.load() || now >= deadline) {
+      return false;
+    }
+    // Only woken early by cancel(), by the shutdown of the context, or by a notification.
+    wait_set_.wait(std::min(next_cycle_start_, deadline) - now);
+    now = std::chrono::steady_clock::now();
+  }
+  return rclcpp::ok(this->context_) && spinning.load();
+}
+
+void
+CyclicExecutor::execute_cycle()
+{
+  const auto start = std::chrono::steady_clock::now();
+  for (auto & step : schedule_) {
+    if (step.subscription) {
+      take_input(step);
+    }
+  }
+  for (auto & step : schedule_) {
+    execute_step(step);
+  }
+  const auto end = std::chrono::steady_clock::now();
+
+  const int64_t execution_time_ns =
+    std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+  if (execution_time_ns > max_execution_time_ns_.load(std::memory_order_relaxed)) {
+    max_execution_time_ns_.store(execution_time_ns, std::memory_order_relaxed);
+  }
+  cycles_.fetch_add(1u, std::memory_order_relaxed);
+
+  next_cycle_start_ += cycle_time_;
+  if (end > next_cycle_start_) {
+    // The cycles which should have started meanwhile are skipped.
+    overruns_.fetch_add(1u, std::memory_order_relaxed);
+    next_cycle_start_ += ((end - next_cycle_start_) / cycle_time_ + 1) * cycle_time_;
+  }
+}
+
+void
+CyclicExecutor::take_input(Step & step)
+{
+  if (step.intra_process_waitable && step.intra_process_waitable->is_ready(nullptr)) {
+    step.intra_process_data = step.intra_process_waitable->take_data();
+  }
+  step.message_info.get_rmw_message_info().from_intra_process = false;
+  try {
+    if (step.serialized_message) {
+      step.message_taken =
+        step.subscription->take_latest_serialized(step.serialized_message, step.message_info);
+    } else {
+      step.message_taken =
+        step.subscription->take_latest_type_erased(step.message, step.message_info);
+    }
+  } catch (const rclcpp::exceptions::RCLError & rcl_error) {
+    RCLCPP_ERROR(
+      rclcpp::get_logger("rclcpp"),
+      "executor taking a message from topic '%s' unexpectedly failed: %s",
+      step.subscription->get_topic_name(),
+      rcl_error.what());
+    step.message_taken = false;
+  }
+}
+
+void
+CyclicExecutor::execute_step(Step & step)
+{
+  if (step.function) {
+    step.function();
+    return;
+  }
+  if (step.intra_process_data) {
+    step.intra_process_waitable->execute(step.intra_process_data);
+    step.intra_process_data.reset();
+  }
+  if (!step.message_taken) {
+    return;
+  }
+  step.message_taken = false;
+  if (step.serialized_message) {
+    step.subscription->handle_serialized_message(step.serialized_message, step.message_info);
+    if (step.serialized_message.use_count() != 1) {
+      step.subscription->return_serialized_message(step.serialized_message);
+      step.serialized_message = step.subscription->create_serialized_message();
+    }
+  } else {
+    step.subscription->handle_message(step.message, step.message_info);
+    if (step.message.use_count() != 1) {
+      step.subscription->return_message(step.message);
+      step.message = step.subscription->create_message();
+    }
+  }
+}
+
+void
+CyclicExecutor::throw_if_spinning() const
+{
+  if (spinning.load()) {
+    throw std::runtime_error("the schedule of a CyclicExecutor cannot change while it spins");
+  }
+}
@@ -0,0 +1,466 @@
+// Copyright 2021 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "rclcpp/executors/events_executor.hpp"
+
+#include <chrono>
+#include <memory>
+#include <stdexcept>
+#include <typeinfo>
+#include <vector>
+
+#include "rcl/error_handling.h"
+#include "rcpputils/scope_exit.hpp"
+
+#include "rclcpp/allocation_tracking.hpp"
+#include "rclcpp/exceptions.hpp"
+#include "rclcpp/thread_attributes.hpp"
+#include "rclcpp/utilities.hpp"
+
+#include "rcutils/logging_macros.h"
+
+using rclcpp::exceptions::throw_from_rcl_error;
+using rclcpp::executors::EventsExecutor;
+using rclcpp::executors::ExecutorEvent;
+using rclcpp::executors::ExecutorEventType;
+
+EventsExecutor::EventsExecutor(
+  const rclcpp::ExecutorOptions & options,
+  bool use_timers_manager,
+  std::chrono::nanoseconds timers_manager_resolution)
+: rclcpp::Executor(options)
+{
+  entities_collector_ = std::make_shared<StaticExecutorEntitiesCollector>();
+  if (use_timers_manager) {
+    timers_manager_ = std::make_shared<rclcpp::experimental::TimersManager>(
+      [this](const rclcpp::TimerBase::SharedPtr & timer) {
+        events_queue_.push(
+          {timer->get_timer_handle().get(), ExecutorEventType::CALLED_TIMER_EVENT});
+        // The interrupt guard condition only wakes up the wait, entities are not collected again.
+        rcl_ret_t ret = rcl_trigger_guard_condition(&interrupt_guard_condition_);
+        if (ret != RCL_RET_OK) {
+          RCUTILS_LOG_ERROR_NAMED(
+            "rclcpp",
+            "failed to wake up the events executor for a ready timer: %s",
+            rcl_get_error_string().str);
+          rcl_reset_error();
+        }
+      },
+      timers_manager_resolution);
+  }
+}
+
+EventsExecutor::~EventsExecutor()
+{
+  if (timers_manager_) {
+    timers_manager_->stop();
+  }
+  if (entities_collector_->is_init()) {
+    entities_collector_->fini();
+  }
+}
+
+void
+EventsExecutor::spin()
+{
+  if (spinning.exchange(true)) {
+    throw std::runtime_error("spin() called while already spinning");
+  }
+  RCPPUTILS_SCOPE_EXIT(this->spinning.store(false); );
+  rclcpp::ScopedThreadAttributes thread_attributes(thread_attributes_);
+  if (timers_manager_) {
+    timers_manager_->start();
+  }
+  RCPPUTILS_SCOPE_EXIT(
+    if (timers_manager_) {
+      timers_manager_->stop();
+    });
+
+  while (rclcpp::ok(this->context_) && spinning.load()) {
+    ExecutorEvent event;
+    if (!events_queue_.pop(event)) {
+      wait_for_events(std::chrono::nanoseconds(-1));
+      continue;
+    }
+    execute_event(event);
+  }
+}
+
+void
+EventsExecutor::spin_some(std::chrono::nanoseconds max_duration)
+{
+  return this->spin_some_impl(max_duration, false);
+}
+
+void
+EventsExecutor::spin_all(std::chrono::nanoseconds max_duration)
+{
+  if (max_duration <= std::chrono::nanoseconds(0)) {
+    throw std::invalid_argument("max_duration must be positive");
+  }
+  return this->spin_some_impl(max_duration, true);
+}
+
+void
+EventsExecutor::spin_some_impl(std::chrono::nanoseconds max_duration, bool exhaustive)
+{
+  auto start = std::chrono::steady_clock::now();
+  auto max_duration_not_elapsed = [max_duration, start]() {
+      if (std::chrono::nanoseconds(0) == max_duration) {
+        // told to spin forever if need be
+        return true;
+      } else if (std::chrono::steady_clock::now() - start < max_duration) {
+        // told to spin only for some maximum amount of time
+        return true;
+      }
+      // spun too long
+      return false;
+    };
+
+  if (spinning.exchange(true)) {
+    throw std::runtime_error("spin_some() called while already spinning");
+  }
+  RCPPUTILS_SCOPE_EXIT(this->spinning.store(false); );
+
+  // Collect what is ready right now, without blocking.
+  if (events_queue_.empty()) {
+    wait_for_events(std::chrono::nanoseconds(0));
+  }
+
+  while (rclcpp::ok(context_) && spinning.load() && max_duration_not_elapsed()) {
+    ExecutorEvent event;
+    if (events_queue_.pop(event)) {
+      execute_event(event);
+      continue;
+    }
+    // All the work that was ready has been done, only look again if exhaustive.
+    if (!exhaustive || wait_for_events(std::chrono::nanoseconds(0)) == 0) {
+      break;
+    }
+  }
+}
+
+void
+EventsExecutor::spin_once_impl(std::chrono::nanoseconds timeout)
+{
+  if (!rclcpp::ok(context_) || !spinning.load()) {
+    return;
+  }
+
+  if (events_queue_.empty()) {
+    wait_for_events(timeout);
+  }
+
+  // Skip over stale events, so that one call executes at most one entity.
+  ExecutorEvent event;
+  while (spinning.load() && events_queue_.pop(event)) {
+    if (execute_event(event)) {
+      return;
+    }
+  }
+}
+
+size_t
+EventsExecutor::wait_for_events(std::chrono::nanoseconds timeout)
+{
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+
+    refresh_entities();
+
+    // Only re-add the handles, the wait set keeps the size it got when entities were collected.
+    if (rcl_wait_set_clear(&wait_set_) != RCL_RET_OK) {
+      throw std::runtime_error("Couldn't clear wait set");
+    }
+    if (!memory_strategy_->add_handles_to_wait_set(&wait_set_)) {
+      throw std::runtime_error("Couldn't fill wait set");
+    }
+    if (timers_manager_ && timers_manager_->is_running()) {
+      // rcl_wait() skips null entries, the manager wakes the wait up when these timers are due.
+      for (size_t i = 0; i < wait_set_.size_of_timers; ++i) {
+        if (managed_timers_.count(wait_set_.timers[i]) != 0) {
+          wait_set_.timers[i] = nullptr;
+        }
+      }
+    }
+  }
+
+  rcl_ret_t status = rcl_wait(&wait_set_, timeout.count());
+  if (status == RCL_RET_WAIT_SET_EMPTY) {
+    RCUTILS_LOG_WARN_NAMED(
+      "rclcpp",
+      "empty wait set received in rcl_wait(). This should never happen.");
+  } else if (status == RCL_RET_TIMEOUT) {
+    return 0;
+  } else if (status != RCL_RET_OK) {
+    throw_from_rcl_error(status, "rcl_wait() failed");
+  }
+
+  std::lock_guard<std::mutex> guard(mutex_);
+  size_t number_of_events = 0;
+  auto push_if_known =
+    [this, &number_of_events](const void * key, const auto & map, ExecutorEventType type) {
+      if (key && map.find(key) != map.end()) {
+        events_queue_.push({key, type});
+        ++number_of_events;
+      }
+    };
+  for (size_t i = 0; i < wait_set_.size_of_timers; ++i) {
+    push_if_known(wait_set_.timers[i], timers_, ExecutorEventType::TIMER_EVENT);
+  }
+  for (size_t i = 0; i < wait_set_.size_of_subscriptions; ++i) {
+    push_if_known(
+      wait_set_.subscriptions[i], subscriptions_, ExecutorEventType::SUBSCRIPTION_EVENT);
+  }
+  for (size_t i = 0; i < wait_set_.size_of_services; ++i) {
+    push_if_known(wait_set_.services[i], services_, ExecutorEventType::SERVICE_EVENT);
+  }
+  for (size_t i = 0; i < wait_set_.size_of_clients; ++i) {
+    push_if_known(wait_set_.clients[i], clients_, ExecutorEventType::CLIENT_EVENT);
+  }
+  for (const auto & weak_waitable : waitables_list_) {
+    auto waitable = weak_waitable.lock();
+    if (waitable && waitable->is_ready(&wait_set_)) {
+      events_queue_.push({waitable.get(), ExecutorEventType::WAITABLE_EVENT});
+      ++number_of_events;
+    }
+  }
+  return number_of_events;
+}
+
+bool
+EventsExecutor::execute_event(const ExecutorEvent & event)
+{
+  switch (event.type) {
+    case ExecutorEventType::SUBSCRIPTION_EVENT:
+      {
+        auto it = subscriptions_.find(event.entity_key);
+        auto subscription = it != subscriptions_.end() ? it->second.lock() : nullptr;
+        if (!subscription) {
+          return false;
+        }
+        execute_subscription(subscription);
+        return true;
+      }
+    case ExecutorEventType::TIMER_EVENT:
+      {
+        auto it = timers_.find(event.entity_key);
+        auto timer = it != timers_.end() ? it->second.lock() : nullptr;
+        // call() returns false if the timer was canceled after the wait set woke up.
+        if (!timer || !timer->call()) {
+          return false;
+        }
+        execute_timer(timer);
+        return true;
+      }
+    case ExecutorEventType::CALLED_TIMER_EVENT:
+      {
+        auto it = timers_.find(event.entity_key);
+        auto timer = it != timers_.end() ? it->second.lock() : nullptr;
+        if (!timer) {
+          return false;
+        }
+        execute_timer(timer);
+        return true;
+      }
+    case ExecutorEventType::SERVICE_EVENT:
+      {
+        auto it = services_.find(event.entity_key);
+        auto service = it != services_.end() ? it->second.lock() : nullptr;
+        if (!service) {
+          return false;
+        }
+        execute_service(service);
+        return true;
+      }
+    case ExecutorEventType::CLIENT_EVENT:
+      {
+        auto it = clients_.find(event.entity_key);
+        auto client = it != clients_.end() ? it->second.lock() : nullptr;
+        if (!client) {
+          return false;
+        }
+        execute_client(client);
+        return true;
+      }
+    case ExecutorEventType::WAITABLE_EVENT:
+      {
+        auto it = waitables_.find(event.entity_key);
+        auto waitable = it != waitables_.end() ? it->second.lock() : nullptr;
+        if (!waitable) {
+          return false;
+        }
+        if (waitable == entities_collector_) {
+          // A node notified that its entities changed, collect them before waiting again.
+          invalidate_entities(false);
+          return true;
+        }
+        allocation_tracking::CallbackScope scope("waitable", typeid(*waitable).name());
+        auto data = waitable->take_data();
+        waitable->execute(data);
+        return true;
+      }
+  }
+  return false;
+}
+
+void
+EventsExecutor::refresh_entities()
+{
+  if (!entities_collector_->is_init()) {
+    // init() collects the entities and sizes the wait set.
+    entities_collector_->init(
+      &wait_set_, memory_strategy_, &interrupt_guard_condition_, wait_set_capacities_);
+  } else if (entities_need_rebuild_.load()) {
+    std::shared_ptr<void> data;
+    entities_collector_->execute(data);
+  } else {
+    return;
+  }
+  entities_need_rebuild_.store(false);
+  rebuild_entity_maps();
+}
+
+void
+EventsExecutor::rebuild_entity_maps()
+{
+  subscriptions_.clear();
+  timers_.clear();
+  services_.clear();
+  clients_.clear();
+  waitables_.clear();
+  waitables_list_.clear();
+
+  for (size_t i = 0; i < entities_collector_->get_number_of_subscriptions(); ++i) {
+    auto subscription = entities_collector_->get_subscription(i);
+    subscriptions_.emplace(subscription->get_subscription_handle().get(), subscription);
+  }
+  for (size_t i = 0; i < entities_collector_->get_number_of_timers(); ++i) {
+    auto timer = entities_collector_->get_timer(i);
+    timers_.emplace(timer->get_timer_handle().get(), timer);
+  }
+  if (timers_manager_) {
+    timers_manager_->clear();
+    managed_timers_.clear();
+    for (const auto & pair : timers_) {
+      auto timer = pair.second.lock();
+      // Deadlines of the manager are steady, other clocks are left to the wait set.
+      if (timer && timer->is_steady()) {
+        timers_manager_->add_timer(timer);
+        managed_timers_.insert(pair.first);
+      }
+    }
+  }
+  for (size_t i = 0; i < entities_collector_->get_number_of_services(); ++i) {
+    auto service = entities_collector_->get_service(i);
+    services_.emplace(service->get_service_handle().get(), service);
+  }
+  for (size_t i = 0; i < entities_collector_->get_number_of_clients(); ++i) {
+    auto client = entities_collector_->get_client(i);
+    clients_.emplace(client->get_client_handle().get(), client);
+  }
+  for (size_t i = 0; i < entities_collector_->get_number_of_waitables(); ++i) {
+    auto waitable = entities_collector_->get_waitable(i);
+    waitables_.emplace(waitable.get(), waitable);
+    waitables_list_.push_back(waitable);
+  }
+}
+
+void
+EventsExecutor::invalidate_entities(bool notify)
+{
+  entities_need_rebuild_.store(true);
+  if (notify) {
+    // Interrupt waiting so that the entities are collected again
+    rcl_ret_t ret = rcl_trigger_guard_condition(&interrupt_guard_condition_);
+    if (ret != RCL_RET_OK) {
+      throw_from_rcl_error(ret, "Failed to trigger guard condition on entities change");
+    }
+  }
+}
+
+void
+EventsExecutor::add_callback_group(
+  rclcpp::CallbackGroup::SharedPtr group_ptr,
+  rclcpp::node_interfaces::NodeBaseInterface::SharedPtr node_ptr,
+  bool notify)
+{
+  std::lock_guard<std::mutex> guard(mutex_);
+  entities_collector_->add_callback_group(group_ptr, node_ptr);
+  invalidate_entities(notify);
+}
+
+void
+EventsExecutor::remove_callback_group(
+  rclcpp::CallbackGroup::SharedPtr group_ptr,
+  bool notify)
+{
+  std::lock_guard<std::mutex> guard(mutex_);
+  entities_collector_->remove_callback_group(group_ptr);
+  invalidate_entities(notify);
+}
+
+void
+EventsExecutor::add_node(
+  rclcpp::node_interfaces::NodeBaseInterface::SharedPtr node_ptr, bool notify)
+{
+  std::lock_guard<std::mutex> guard(mutex_);
+  entities_collector_->add_node(node_ptr);
+  invalidate_entities(notify);
+}
+
+void
+EventsExecutor::add_node(std::shared_ptr<rclcpp::Node> node_ptr, bool notify)
+{
+  this->add_node(node_ptr->get_node_base_interface(), notify);
+}
+
+void
+EventsExecutor::remove_node(
+  rclcpp::node_interfaces::NodeBaseInterface::SharedPtr node_ptr, bool notify)
+{
+  std::lock_guard<std::mutex> guard(mutex_);
+  bool node_removed = entities_collector_->remove_node(node_ptr);
+  if (!node_removed) {
+    throw std::runtime_error("Node needs to be associated with this executor.");
+  }
+  invalidate_entities(notify);
+}
+
+void
+EventsExecutor::remove_node(std::shared_ptr<rclcpp::Node> node_ptr, bool notify)
+{
+  this->remove_node(node_ptr->get_node_base_interface(), notify);
+}
+
+std::vector<rclcpp::CallbackGroup::WeakPtr>
+EventsExecutor::get_all_callback_groups()
+{
+  std::lock_guard<std::mutex> guard(mutex_);
+  return entities_collector_->get_all_callback_groups();
+}
+
+std::vector<rclcpp::CallbackGroup::WeakPtr>
+EventsExecutor::get_manually_added_callback_groups()
+{
+  std::lock_guard<std::mutex> guard(mutex_);
+  return entities_collector_->get_manually_added_callback_groups();
+}
+
+std::vector<rclcpp::CallbackGroup::WeakPtr>
+EventsExecutor::get_automatically_added_callback_groups_from_nodes()
+{
+  std::lock_guard<std::mutex> guard(mutex_);
+  return entities_collector_->get_automatically_added_callback_groups_from_nodes();
+}
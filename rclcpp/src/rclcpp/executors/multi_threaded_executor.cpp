@@ -14,9 +14,14 @@
 
 #include "rclcpp/executors/multi_threaded_executor.hpp"
 
+#include <algorithm>
 #include <chrono>
-#include <functional>
+#include <exception>
 #include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <utility>
 #include <vector>
 
 #include "rcpputils/scope_exit.hpp"
@@ -25,19 +30,37 @@
 
 using rclcpp::executors::MultiThreadedExecutor;
 
+// Executables that don't fit in the hand off queue are executed by the waiting thread.
+static constexpr size_t kHandOffQueueCapacity = 1024;
+
 MultiThreadedExecutor::MultiThreadedExecutor(
   const rclcpp::ExecutorOptions & options,
   size_t number_of_threads,
   bool yield_before_execute,
-  std::chrono::nanoseconds next_exec_timeout)
+  std::chrono::nanoseconds next_exec_timeout,
+  SchedulingMode scheduling_mode)
 : rclcpp::Executor(options),
   yield_before_execute_(yield_before_execute),
-  next_exec_timeout_(next_exec_timeout)
+  next_exec_timeout_(next_exec_timeout),
+  scheduling_mode_(scheduling_mode),
+  ready_executables_(
+    scheduling_mode == SchedulingMode::HandOff ? kHandOffQueueCapacity : 1u)
 {
   number_of_threads_ = number_of_threads ? number_of_threads : std::thread::hardware_concurrency();
   if (number_of_threads_ == 0) {
     number_of_threads_ = 1;
   }
+  for (size_t i = 0; i < number_of_threads_; ++i) {
+    thread_attributes_by_index_.push_back(
+      i < options.worker_thread_attributes.size() ?
+      options.worker_thread_attributes[i] : options.thread_attributes);
+  }
+  pinned_executables_.resize(number_of_threads_);
+  if (scheduling_mode_ == SchedulingMode::WorkStealing) {
+    for (size_t i = 0; i < number_of_threads_; ++i) {
+      work_stealing_deques_.emplace_back(std::make_unique<WorkStealingDeque>());
+    }
+  }
 }
 
 MultiThreadedExecutor::~MultiThreadedExecutor() {}
@@ -51,11 +74,30 @@ MultiThreadedExecutor::spin()
   RCPPUTILS_SCOPE_EXIT(this->spinning.store(false); );
   std::vector<std::thread> threads;
   size_t thread_id = 0;
+  // The calling thread is the last one, it gets its own attributes back when spin() returns.
+  rclcpp::ScopedThreadAttributes thread_attributes(
+    thread_attributes_by_index_[number_of_threads_ - 1]);
+  thread_attributes_error_ = nullptr;
   {
     std::lock_guard wait_lock{wait_mutex_};
     for (; thread_id < number_of_threads_ - 1; ++thread_id) {
-      auto func = std::bind(&MultiThreadedExecutor::run, this, thread_id);
-      threads.emplace_back(func);
+      threads.emplace_back(
+        [this, thread_id]() {
+          try {
+            rclcpp::apply_thread_attributes(thread_attributes_by_index_[thread_id]);
+          } catch (...) {
+            {
+              std::lock_guard<std::mutex> lock(thread_attributes_error_mutex_);
+              if (!thread_attributes_error_) {
+                thread_attributes_error_ = std::current_exception();
+              }
+            }
+            // Stop the whole pool rather than spinning with fewer threads than requested.
+            cancel();
+            return;
+          }
+          run(thread_id);
+        });
     }
   }
 
@@ -63,6 +105,31 @@ MultiThreadedExecutor::spin()
   for (auto & thread : threads) {
     thread.join();
   }
+
+  // Drop what was handed off but not executed, the AnyExecutable destructor resets the
+  // callback groups.
+  while (true) {
+    rclcpp::AnyExecutable discarded;
+    if (!ready_executables_.try_pop(discarded)) {
+      break;
+    }
+  }
+  for (auto & deque : work_stealing_deques_) {
+    std::lock_guard<std::mutex> lock(deque->mutex);
+    deque->executables.clear();
+  }
+  work_stealing_queued_.store(0);
+  {
+    std::lock_guard<std::mutex> lock(hand_off_mutex_);
+    for (auto & executables : pinned_executables_) {
+      executables.clear();
+    }
+  }
+  pinned_queued_.store(0);
+
+  if (thread_attributes_error_) {
+    std::rethrow_exception(thread_attributes_error_);
+  }
 }
 
 size_t
@@ -71,9 +138,109 @@ MultiThreadedExecutor::get_number_of_threads()
   return number_of_threads_;
 }
 
+MultiThreadedExecutor::SchedulingMode
+MultiThreadedExecutor::get_scheduling_mode() const
+{
+  return scheduling_mode_;
+}
+
+void
+MultiThreadedExecutor::pin_callback_group(
+  const rclcpp::CallbackGroup::SharedPtr & group,
+  const std::vector<size_t> & thread_numbers)
+{
+  if (!group) {
+    throw std::invalid_argument("cannot pin a null callback group");
+  }
+  if (spinning.load()) {
+    throw std::runtime_error("cannot pin a callback group while spinning");
+  }
+  for (size_t thread_number : thread_numbers) {
+    if (thread_number >= number_of_threads_) {
+      throw std::invalid_argument(
+              "thread number " + std::to_string(thread_number) + " is out of range, there are " +
+              std::to_string(number_of_threads_) + " threads");
+    }
+  }
+  // Drop the entries of groups which were destroyed in the meantime.
+  for (auto it = pinned_callback_groups_.begin(); it != pinned_callback_groups_.end(); ) {
+    if (it->second.group.expired()) {
+      it = pinned_callback_groups_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+  if (thread_numbers.empty()) {
+    pinned_callback_groups_.erase(group.get());
+    return;
+  }
+  pinned_callback_groups_[group.get()] = PinnedCallbackGroup{group, thread_numbers};
+}
+
+void
+MultiThreadedExecutor::pin_callback_group_to_numa_node(
+  const rclcpp::CallbackGroup::SharedPtr & group,
+  size_t node_id,
+  const std::vector<rclcpp::NumaNode> & nodes)
+{
+  auto node = std::find_if(
+    nodes.begin(), nodes.end(),
+    [node_id](const rclcpp::NumaNode & candidate) {return candidate.id == node_id;});
+  if (node == nodes.end()) {
+    throw std::invalid_argument("unknown NUMA node " + std::to_string(node_id));
+  }
+  std::vector<size_t> thread_numbers;
+  for (size_t i = 0; i < number_of_threads_; ++i) {
+    const std::vector<size_t> & cpu_affinity = thread_attributes_by_index_[i].cpu_affinity;
+    const bool is_bound_to_node = !cpu_affinity.empty() && std::all_of(
+      cpu_affinity.begin(), cpu_affinity.end(),
+      [&node](size_t cpu) {
+        return std::binary_search(node->cpus.begin(), node->cpus.end(), cpu);
+      });
+    if (is_bound_to_node) {
+      thread_numbers.push_back(i);
+    }
+  }
+  if (thread_numbers.empty()) {
+    throw std::invalid_argument(
+            "no thread of the executor is bound to NUMA node " + std::to_string(node_id));
+  }
+  pin_callback_group(group, thread_numbers);
+}
+
+std::vector<size_t>
+MultiThreadedExecutor::get_callback_group_threads(
+  const rclcpp::CallbackGroup::SharedPtr & group) const
+{
+  auto it = pinned_callback_groups_.find(group.get());
+  if (it == pinned_callback_groups_.end() || it->second.group.lock() != group) {
+    return {};
+  }
+  return it->second.thread_numbers;
+}
+
 void
-MultiThreadedExecutor::run(size_t)
+MultiThreadedExecutor::run(size_t this_thread_number)
 {
+  if (scheduling_mode_ == SchedulingMode::HandOff) {
+    // The thread which called spin() is the last one and does the waiting.
+    if (this_thread_number == number_of_threads_ - 1) {
+      run_hand_off_waiter();
+    } else {
+      run_hand_off_worker(this_thread_number);
+    }
+    return;
+  }
+  if (scheduling_mode_ == SchedulingMode::WorkStealing) {
+    run_work_stealing(this_thread_number);
+    return;
+  }
+
+  if (!pinned_callback_groups_.empty()) {
+    run_shared_wait_with_pinning(this_thread_number);
+    return;
+  }
+
   while (rclcpp::ok(this->context_) && spinning.load()) {
     rclcpp::AnyExecutable any_exec;
     {
@@ -85,14 +252,290 @@ MultiThreadedExecutor::run(size_t)
         continue;
       }
     }
-    if (yield_before_execute_) {
+    execute_taken_executable(any_exec);
+  }
+}
+
+void
+MultiThreadedExecutor::run_shared_wait_with_pinning(size_t this_thread_number)
+{
+  // Make sure the sleeping threads notice that spinning stopped.
+  RCPPUTILS_SCOPE_EXIT(this->notify_idle_threads(); );
+
+  while (rclcpp::ok(this->context_) && spinning.load()) {
+    rclcpp::AnyExecutable any_exec;
+    if (pop_pinned(this_thread_number, any_exec)) {
+      execute_taken_executable(any_exec);
+      continue;
+    }
+
+    // A thread blocked on the wait mutex would not see the executables queued for it, so sleep
+    // until the waiting thread is done or queues something instead.
+    const size_t generation = idle_generation_.load();
+    bool found_work = false;
+    {
+      std::unique_lock<std::mutex> wait_lock(wait_mutex_, std::try_to_lock);
+      if (!wait_lock.owns_lock()) {
+        std::unique_lock<std::mutex> lock(hand_off_mutex_);
+        hand_off_cv_.wait(
+          lock, [this, this_thread_number, generation]() {
+            return idle_generation_.load() != generation ||
+            !pinned_executables_[this_thread_number].empty() ||
+            !rclcpp::ok(this->context_) || !spinning.load();
+          });
+        continue;
+      }
+      if (!rclcpp::ok(this->context_) || !spinning.load()) {
+        return;
+      }
+      found_work = get_next_executable(any_exec, next_exec_timeout_);
+    }
+    // Let a sleeping thread take its turn to wait for work.
+    notify_idle_threads();
+
+    if (found_work && !dispatch_to_pinned_thread(this_thread_number, any_exec, true)) {
+      execute_taken_executable(any_exec);
+    }
+  }
+}
+
+void
+MultiThreadedExecutor::run_hand_off_waiter()
+{
+  RCPPUTILS_SCOPE_EXIT(
+  {
+    // Wake up the workers so they notice that spinning stopped.
+    {
+      std::lock_guard<std::mutex> lock(hand_off_mutex_);
+    }
+    hand_off_cv_.notify_all();
+  });
+
+  while (rclcpp::ok(this->context_) && spinning.load()) {
+    rclcpp::AnyExecutable any_exec;
+    if (!get_next_executable(any_exec, next_exec_timeout_)) {
+      continue;
+    }
+    // Hand off everything which is ready after this wake up, not only the first executable.
+    const size_t this_thread_number = number_of_threads_ - 1;
+    size_t handed_off = 0;
+    do {
+      // Executables of pinned groups can't go through the queue shared by all the workers.
+      if (!dispatch_to_pinned_thread(this_thread_number, any_exec, false)) {
+        hand_off(any_exec);
+      }
+      ++handed_off;
+      any_exec = rclcpp::AnyExecutable();
+    } while (get_next_ready_executable(any_exec));
+
+    {
+      std::lock_guard<std::mutex> lock(hand_off_mutex_);
+    }
+    if (handed_off > 1u) {
+      hand_off_cv_.notify_all();
+    } else {
+      hand_off_cv_.notify_one();
+    }
+
+    // Waiting again while executables are still queued would find the same entities ready,
+    // so help the workers instead.
+    while (true) {
+      rclcpp::AnyExecutable queued_exec;
+      if (!pop_pinned(this_thread_number, queued_exec) &&
+        !ready_executables_.try_pop(queued_exec))
+      {
+        break;
+      }
+      execute_taken_executable(queued_exec);
+    }
+  }
+}
+
+void
+MultiThreadedExecutor::run_hand_off_worker(size_t this_thread_number)
+{
+  while (true) {
+    rclcpp::AnyExecutable any_exec;
+    if (pop_pinned(this_thread_number, any_exec) || ready_executables_.try_pop(any_exec)) {
+      execute_taken_executable(any_exec);
+      continue;
+    }
+    std::unique_lock<std::mutex> lock(hand_off_mutex_);
+    if (!rclcpp::ok(this->context_) || !spinning.load()) {
+      return;
+    }
+    hand_off_cv_.wait(
+      lock, [this, this_thread_number]() {
+        return !ready_executables_.empty() || !pinned_executables_[this_thread_number].empty() ||
+        !rclcpp::ok(this->context_) || !spinning.load();
+      });
+  }
+}
+
+void
+MultiThreadedExecutor::run_work_stealing(size_t this_thread_number)
+{
+  // Make sure the sleeping threads notice that spinning stopped.
+  RCPPUTILS_SCOPE_EXIT(this->notify_idle_threads(); );
+
+  WorkStealingDeque & own_deque = *work_stealing_deques_[this_thread_number];
+  while (rclcpp::ok(this->context_) && spinning.load()) {
+    const size_t generation = idle_generation_.load();
+    rclcpp::AnyExecutable any_exec;
+    if (pop_pinned(this_thread_number, any_exec) || pop_or_steal(this_thread_number, any_exec)) {
+      execute_taken_executable(any_exec);
+      continue;
+    }
+
+    // Waiting while executables are still queued would find the same entities ready again,
+    // so only become the waiting thread once everything was taken.
+    if (work_stealing_queued_.load() > 0u) {
       std::this_thread::yield();
+      continue;
     }
 
-    execute_any_executable(any_exec);
+    std::unique_lock<std::mutex> wait_lock(wait_mutex_, std::try_to_lock);
+    if (wait_lock.owns_lock()) {
+      bool found_work = false;
+      while (!found_work && rclcpp::ok(this->context_) && spinning.load()) {
+        found_work = get_next_executable(any_exec, next_exec_timeout_);
+      }
+      if (!found_work) {
+        return;
+      }
+      {
+        std::lock_guard<std::mutex> lock(own_deque.mutex);
+        do {
+          // Executables in the deques can be stolen by any thread, so not the pinned ones.
+          if (!dispatch_to_pinned_thread(this_thread_number, any_exec, false)) {
+            own_deque.executables.emplace_back(std::move(any_exec));
+            ++work_stealing_queued_;
+          }
+          any_exec = rclcpp::AnyExecutable();
+        } while (get_next_ready_executable(any_exec));
+      }
+      wait_lock.unlock();
+      notify_idle_threads();
+      continue;
+    }
 
-    // Clear the callback_group to prevent the AnyExecutable destructor from
-    // resetting the callback group `can_be_taken_from`
-    any_exec.callback_group.reset();
+    // Another thread is waiting for work, sleep until it pushes some.
+    std::unique_lock<std::mutex> lock(hand_off_mutex_);
+    hand_off_cv_.wait(
+      lock, [this, generation]() {
+        return idle_generation_.load() != generation ||
+        !rclcpp::ok(this->context_) || !spinning.load();
+      });
+  }
+}
+
+bool
+MultiThreadedExecutor::pop_or_steal(size_t this_thread_number, rclcpp::AnyExecutable & any_exec)
+{
+  if (work_stealing_queued_.load() == 0u) {
+    return false;
   }
+  // The own deque is consumed from the front to keep the order in which executables were found,
+  // the others are stolen from the back to contend as little as possible with their owner.
+  for (size_t offset = 0; offset < number_of_threads_; ++offset) {
+    WorkStealingDeque & deque =
+      *work_stealing_deques_[(this_thread_number + offset) % number_of_threads_];
+    std::lock_guard<std::mutex> lock(deque.mutex);
+    if (deque.executables.empty()) {
+      continue;
+    }
+    if (0u == offset) {
+      any_exec = std::move(deque.executables.front());
+      deque.executables.pop_front();
+    } else {
+      any_exec = std::move(deque.executables.back());
+      deque.executables.pop_back();
+    }
+    --work_stealing_queued_;
+    return true;
+  }
+  return false;
+}
+
+void
+MultiThreadedExecutor::notify_idle_threads()
+{
+  ++idle_generation_;
+  {
+    std::lock_guard<std::mutex> lock(hand_off_mutex_);
+  }
+  hand_off_cv_.notify_all();
+}
+
+bool
+MultiThreadedExecutor::dispatch_to_pinned_thread(
+  size_t this_thread_number, rclcpp::AnyExecutable & any_exec, bool can_execute_here)
+{
+  if (pinned_callback_groups_.empty() || !any_exec.callback_group) {
+    return false;
+  }
+  auto it = pinned_callback_groups_.find(any_exec.callback_group.get());
+  if (it == pinned_callback_groups_.end() || it->second.group.lock() != any_exec.callback_group) {
+    return false;
+  }
+  const std::vector<size_t> & thread_numbers = it->second.thread_numbers;
+  const bool pinned_here = std::find(
+    thread_numbers.begin(), thread_numbers.end(), this_thread_number) != thread_numbers.end();
+  if (can_execute_here && pinned_here) {
+    return false;
+  }
+  {
+    std::lock_guard<std::mutex> lock(hand_off_mutex_);
+    // Prefer this thread on ties, then the pinned thread with the fewest executables waiting.
+    size_t target = pinned_here ? this_thread_number : thread_numbers.front();
+    for (size_t thread_number : thread_numbers) {
+      if (pinned_executables_[thread_number].size() < pinned_executables_[target].size()) {
+        target = thread_number;
+      }
+    }
+    pinned_executables_[target].emplace_back(std::move(any_exec));
+    ++pinned_queued_;
+    ++idle_generation_;
+  }
+  hand_off_cv_.notify_all();
+  return true;
+}
+
+bool
+MultiThreadedExecutor::pop_pinned(size_t this_thread_number, rclcpp::AnyExecutable & any_exec)
+{
+  if (pinned_queued_.load() == 0u) {
+    return false;
+  }
+  std::lock_guard<std::mutex> lock(hand_off_mutex_);
+  auto & executables = pinned_executables_[this_thread_number];
+  if (executables.empty()) {
+    return false;
+  }
+  any_exec = std::move(executables.front());
+  executables.pop_front();
+  --pinned_queued_;
+  return true;
+}
+
+void
+MultiThreadedExecutor::hand_off(rclcpp::AnyExecutable & any_exec)
+{
+  if (!ready_executables_.try_push(std::move(any_exec))) {
+    execute_taken_executable(any_exec);
+  }
+}
+
+void
+MultiThreadedExecutor::execute_taken_executable(rclcpp::AnyExecutable & any_exec)
+{
+  if (yield_before_execute_) {
+    std::this_thread::yield();
+  }
+
+  execute_any_executable(any_exec);
+
+  // Clear the callback_group to prevent the AnyExecutable destructor from
+  // resetting the callback group `can_be_taken_from`
+  any_exec.callback_group.reset();
 }
@@ -0,0 +1,400 @@
+// Copyright 2021 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "rclcpp/executors/shared_waiter.hpp"
+
+#include <algorithm>
+#include <array>
+#include <memory>
+
+#include "rcl/error_handling.h"
+#include "rcutils/logging_macros.h"
+
+#include "rclcpp/exceptions.hpp"
+
+using rclcpp::executors::SharedWaiter;
+
+namespace
+{
+
+enum class Kind : size_t
+{
+  Subscription,
+  GuardCondition,
+  Timer,
+  Client,
+  Service,
+  Event
+};
+
+constexpr size_t kind_count = 6;
+
+constexpr std::array<Kind, kind_count> kinds = {
+  Kind::Subscription, Kind::GuardCondition, Kind::Timer, Kind::Client, Kind::Service, Kind::Event};
+
+size_t
+get_size(const rcl_wait_set_t & wait_set, Kind kind)
+{
+  switch (kind) {
+    case Kind::Subscription:
+      return wait_set.size_of_subscriptions;
+    case Kind::GuardCondition:
+      return wait_set.size_of_guard_conditions;
+    case Kind::Timer:
+      return wait_set.size_of_timers;
+    case Kind::Client:
+      return wait_set.size_of_clients;
+    case Kind::Service:
+      return wait_set.size_of_services;
+    case Kind::Event:
+    default:
+      return wait_set.size_of_events;
+  }
+}
+
+const void *
+get_entity(const rcl_wait_set_t & wait_set, Kind kind, size_t index)
+{
+  switch (kind) {
+    case Kind::Subscription:
+      return wait_set.subscriptions[index];
+    case Kind::GuardCondition:
+      return wait_set.guard_conditions[index];
+    case Kind::Timer:
+      return wait_set.timers[index];
+    case Kind::Client:
+      return wait_set.clients[index];
+    case Kind::Service:
+      return wait_set.services[index];
+    case Kind::Event:
+    default:
+      return wait_set.events[index];
+  }
+}
+
+void
+clear_entity(rcl_wait_set_t & wait_set, Kind kind, size_t index)
+{
+  switch (kind) {
+    case Kind::Subscription:
+      wait_set.subscriptions[index] = nullptr;
+      break;
+    case Kind::GuardCondition:
+      wait_set.guard_conditions[index] = nullptr;
+      break;
+    case Kind::Timer:
+      wait_set.timers[index] = nullptr;
+      break;
+    case Kind::Client:
+      wait_set.clients[index] = nullptr;
+      break;
+    case Kind::Service:
+      wait_set.services[index] = nullptr;
+      break;
+    case Kind::Event:
+    default:
+      wait_set.events[index] = nullptr;
+      break;
+  }
+}
+
+rcl_ret_t
+add_entity(
+  rcl_wait_set_t & wait_set, const rcl_wait_set_t & from, Kind kind, size_t index,
+  size_t * shared_index)
+{
+  switch (kind) {
+    case Kind::Subscription:
+      return rcl_wait_set_add_subscription(&wait_set, from.subscriptions[index], shared_index);
+    case Kind::GuardCondition:
+      return rcl_wait_set_add_guard_condition(
+        &wait_set, from.guard_conditions[index], shared_index);
+    case Kind::Timer:
+      return rcl_wait_set_add_timer(&wait_set, from.timers[index], shared_index);
+    case Kind::Client:
+      return rcl_wait_set_add_client(&wait_set, from.clients[index], shared_index);
+    case Kind::Service:
+      return rcl_wait_set_add_service(&wait_set, from.services[index], shared_index);
+    case Kind::Event:
+    default:
+      return rcl_wait_set_add_event(&wait_set, from.events[index], shared_index);
+  }
+}
+
+}  // namespace
+
+struct SharedWaiter::Request
+{
+  rcl_wait_set_t * wait_set;
+  std::chrono::steady_clock::time_point deadline;
+  /// True once the executor can return, set by the thread of the waiter.
+  bool done = false;
+  /// True when one of the entities is ready, only used by the thread of the waiter.
+  bool ready = false;
+  rcl_ret_t status = RCL_RET_TIMEOUT;
+  std::exception_ptr error;
+  std::condition_variable finished;
+};
+
+struct SharedWaiter::Slot
+{
+  Request * request;
+  Kind kind;
+  /// Index of the entity in the wait set of the request.
+  size_t index;
+  /// Index of the entity in the wait set of the waiter.
+  size_t shared_index;
+};
+
+SharedWaiter::SharedWaiter(rclcpp::Context::SharedPtr context)
+: wake_guard_condition_(context)
+{
+  rcl_ret_t ret = rcl_wait_set_init(
+    &wait_set_, 0, 1, 0, 0, 0, 0, context->get_rcl_context().get(),
+    rcl_get_default_allocator());
+  if (RCL_RET_OK != ret) {
+    rclcpp::exceptions::throw_from_rcl_error(ret, "failed to create the shared wait set");
+  }
+  thread_ = std::thread([this]() {run_();});
+}
+
+SharedWaiter::~SharedWaiter()
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+    if (in_wait_) {
+      try {
+        wake_guard_condition_.trigger();
+      } catch (const std::exception & exception) {
+        RCUTILS_LOG_ERROR_NAMED(
+          "rclcpp",
+          "failed to wake up the shared waiter: %s", exception.what());
+      }
+    }
+  }
+  requests_changed_.notify_one();
+  thread_.join();
+
+  if (rcl_wait_set_fini(&wait_set_) != RCL_RET_OK) {
+    RCUTILS_LOG_ERROR_NAMED(
+      "rclcpp",
+      "failed to destroy wait set: %s", rcl_get_error_string().str);
+    rcl_reset_error();
+  }
+}
+
+rcl_ret_t
+SharedWaiter::wait(rcl_wait_set_t * wait_set, std::chrono::nanoseconds timeout)
+{
+  if (timeout == std::chrono::nanoseconds::zero()) {
+    return rcl_wait(wait_set, 0);
+  }
+  Request request;
+  request.wait_set = wait_set;
+  const auto now = std::chrono::steady_clock::now();
+  if (timeout < std::chrono::nanoseconds::zero() ||
+    timeout > std::chrono::steady_clock::time_point::max() - now)
+  {
+    request.deadline = std::chrono::steady_clock::time_point::max();
+  } else {
+    request.deadline = now + timeout;
+  }
+
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    requests_.push_back(&request);
+    // The thread only looks at the requests again once rcl_wait() returns.
+    if (in_wait_) {
+      wake_guard_condition_.trigger();
+    } else {
+      requests_changed_.notify_one();
+    }
+    request.finished.wait(lock, [&request]() {return request.done;});
+  }
+  if (request.error) {
+    std::rethrow_exception(request.error);
+  }
+  return request.status;
+}
+
+uint64_t
+SharedWaiter::get_wait_count() const
+{
+  return wait_count_.load(std::memory_order_relaxed);
+}
+
+void
+SharedWaiter::run_()
+{
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    requests_changed_.wait(lock, [this]() {return stop_ || !requests_.empty();});
+    if (stop_) {
+      break;
+    }
+    waited_requests_.assign(requests_.begin(), requests_.end());
+    try {
+      fill_wait_set_();
+    } catch (...) {
+      fail_requests_(std::current_exception());
+      continue;
+    }
+
+    auto deadline = std::chrono::steady_clock::time_point::max();
+    for (const Request * request : waited_requests_) {
+      deadline = std::min(deadline, request->deadline);
+    }
+    int64_t timeout = -1;
+    if (deadline != std::chrono::steady_clock::time_point::max()) {
+      timeout = std::max<int64_t>(
+        0, std::chrono::duration_cast<std::chrono::nanoseconds>(
+          deadline - std::chrono::steady_clock::now()).count());
+    }
+
+    in_wait_ = true;
+    lock.unlock();
+    rcl_ret_t status = rcl_wait(&wait_set_, timeout);
+    std::exception_ptr error;
+    if (status != RCL_RET_OK && status != RCL_RET_TIMEOUT) {
+      try {
+        rclcpp::exceptions::throw_from_rcl_error(status, "rcl_wait() failed");
+      } catch (...) {
+        error = std::current_exception();
+      }
+    }
+    wait_count_.fetch_add(1, std::memory_order_relaxed);
+    lock.lock();
+    in_wait_ = false;
+
+    if (error) {
+      fail_requests_(error);
+    } else {
+      finish_requests_();
+    }
+  }
+}
+
+void
+SharedWaiter::fill_wait_set_()
+{
+  // The guard condition waking up the thread takes the first slot.
+  std::array<size_t, kind_count> sizes{};
+  sizes[static_cast<size_t>(Kind::GuardCondition)] = 1;
+  slots_.clear();
+  for (Request * request : waited_requests_) {
+    for (Kind kind : kinds) {
+      const size_t size = get_size(*request->wait_set, kind);
+      for (size_t index = 0; index < size; ++index) {
+        // Reserved slots of the wait set may be left empty.
+        if (get_entity(*request->wait_set, kind, index)) {
+          slots_.push_back({request, kind, index, 0});
+          ++sizes[static_cast<size_t>(kind)];
+        }
+      }
+    }
+  }
+
+  // The wait set only grows, so that it stops allocating once it holds all the entities.
+  bool fits = true;
+  for (Kind kind : kinds) {
+    fits = fits && sizes[static_cast<size_t>(kind)] <= get_size(wait_set_, kind);
+  }
+  rcl_ret_t ret;
+  if (fits) {
+    ret = rcl_wait_set_clear(&wait_set_);
+  } else {
+    for (Kind kind : kinds) {
+      sizes[static_cast<size_t>(kind)] =
+        std::max(sizes[static_cast<size_t>(kind)], get_size(wait_set_, kind));
+    }
+    ret = rcl_wait_set_resize(
+      &wait_set_,
+      sizes[static_cast<size_t>(Kind::Subscription)],
+      sizes[static_cast<size_t>(Kind::GuardCondition)],
+      sizes[static_cast<size_t>(Kind::Timer)],
+      sizes[static_cast<size_t>(Kind::Client)],
+      sizes[static_cast<size_t>(Kind::Service)],
+      sizes[static_cast<size_t>(Kind::Event)]);
+  }
+  if (ret != RCL_RET_OK) {
+    rclcpp::exceptions::throw_from_rcl_error(ret, "Couldn't prepare the shared wait set");
+  }
+
+  ret = rcl_wait_set_add_guard_condition(
+    &wait_set_, &wake_guard_condition_.get_rcl_guard_condition(), NULL);
+  if (ret != RCL_RET_OK) {
+    rclcpp::exceptions::throw_from_rcl_error(ret, "Couldn't fill the shared wait set");
+  }
+  for (Slot & slot : slots_) {
+    ret = add_entity(wait_set_, *slot.request->wait_set, slot.kind, slot.index, &slot.shared_index);
+    if (ret != RCL_RET_OK) {
+      rclcpp::exceptions::throw_from_rcl_error(ret, "Couldn't fill the shared wait set");
+    }
+  }
+}
+
+void
+SharedWaiter::finish_requests_()
+{
+  for (Request * request : waited_requests_) {
+    request->ready = false;
+  }
+  for (const Slot & slot : slots_) {
+    if (get_entity(wait_set_, slot.kind, slot.shared_index)) {
+      slot.request->ready = true;
+    }
+  }
+  const auto now = std::chrono::steady_clock::now();
+  for (Request * request : waited_requests_) {
+    if (request->ready || now >= request->deadline) {
+      request->done = true;
+      request->status = request->ready ? RCL_RET_OK : RCL_RET_TIMEOUT;
+    }
+  }
+
+  // Only the wait sets of the executors woken up are changed, the others are waited on again.
+  for (const Slot & slot : slots_) {
+    if (slot.request->done && !get_entity(wait_set_, slot.kind, slot.shared_index)) {
+      clear_entity(*slot.request->wait_set, slot.kind, slot.index);
+    }
+  }
+  requests_.erase(
+    std::remove_if(
+      requests_.begin(), requests_.end(), [](const Request * request) {return request->done;}),
+    requests_.end());
+  // The requests are destroyed by their executors once they get the lock back.
+  for (Request * request : waited_requests_) {
+    if (request->done) {
+      request->finished.notify_one();
+    }
+  }
+  waited_requests_.clear();
+}
+
+void
+SharedWaiter::fail_requests_(std::exception_ptr error)
+{
+  for (Request * request : waited_requests_) {
+    request->error = error;
+    request->done = true;
+    request->finished.notify_one();
+  }
+  requests_.erase(
+    std::remove_if(
+      requests_.begin(), requests_.end(), [](const Request * request) {return request->done;}),
+    requests_.end());
+  waited_requests_.clear();
+}
@@ -12,10 +12,13 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <vector>
+
 #include "rcpputils/scope_exit.hpp"
 
 #include "rclcpp/executors/single_threaded_executor.hpp"
 #include "rclcpp/any_executable.hpp"
+#include "rclcpp/thread_attributes.hpp"
 
 using rclcpp::executors::SingleThreadedExecutor;
 
@@ -31,10 +34,21 @@ SingleThreadedExecutor::spin()
     throw std::runtime_error("spin() called while already spinning");
   }
   RCPPUTILS_SCOPE_EXIT(this->spinning.store(false); );
+  rclcpp::ScopedThreadAttributes thread_attributes(thread_attributes_);
+  // Execute everything that one wait found ready before looking for work again, instead of
+  // scanning the ready entities from the start for each executable.
+  std::vector<rclcpp::AnyExecutable> ready_executables;
   while (rclcpp::ok(this->context_) && spinning.load()) {
-    rclcpp::AnyExecutable any_executable;
-    if (get_next_executable(any_executable)) {
+    if (0u == get_all_ready_executables(ready_executables)) {
+      wait_for_work();
+      if (!spinning.load() || 0u == get_all_ready_executables(ready_executables)) {
+        continue;
+      }
+    }
+    for (auto & any_executable : ready_executables) {
       execute_any_executable(any_executable);
     }
+    // Executables left over when spinning stopped reset their callback group when destroyed.
+    ready_executables.clear();
   }
 }
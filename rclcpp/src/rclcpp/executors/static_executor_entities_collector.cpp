@@ -24,6 +24,8 @@
 #include "rclcpp/memory_strategy.hpp"
 #include "rclcpp/executors/static_single_threaded_executor.hpp"
 
+#include "../detail/resize_wait_set.hpp"
+
 using rclcpp::executors::StaticExecutorEntitiesCollector;
 
 StaticExecutorEntitiesCollector::~StaticExecutorEntitiesCollector()
@@ -62,12 +64,14 @@ void
 StaticExecutorEntitiesCollector::init(
   rcl_wait_set_t * p_wait_set,
   rclcpp::memory_strategy::MemoryStrategy::SharedPtr memory_strategy,
-  rcl_guard_condition_t * executor_guard_condition)
+  rcl_guard_condition_t * executor_guard_condition,
+  const rclcpp::WaitSetCapacities & wait_set_capacities)
 {
   // Empty initialize executable list
   exec_list_ = rclcpp::experimental::ExecutableList();
   // Get executor's wait_set_ pointer
   p_wait_set_ = p_wait_set;
+  wait_set_capacities_ = wait_set_capacities;
   // Get executor's memory strategy ptr
   if (memory_strategy == nullptr) {
     throw std::runtime_error("Received NULL memory strategy in executor waitable.");
@@ -90,6 +94,7 @@ StaticExecutorEntitiesCollector::fini()
 {
   memory_strategy_->clear_handles();
   exec_list_.clear();
+  clear_callback_groups();
 }
 
 std::shared_ptr<void>
@@ -159,12 +164,25 @@ void
 StaticExecutorEntitiesCollector::fill_executable_list()
 {
   exec_list_.clear();
+  clear_callback_groups();
   add_callback_groups_from_nodes_associated_to_executor();
   fill_executable_list_from_map(weak_groups_associated_with_executor_to_nodes_);
   fill_executable_list_from_map(weak_groups_to_nodes_associated_with_executor_);
   // Add the executor's waitable to the executable list
   exec_list_.add_waitable(shared_from_this());
+  waitable_groups_.emplace_back();
+}
+
+void
+StaticExecutorEntitiesCollector::clear_callback_groups()
+{
+  subscription_groups_.clear();
+  timer_groups_.clear();
+  service_groups_.clear();
+  client_groups_.clear();
+  waitable_groups_.clear();
 }
+
 void
 StaticExecutorEntitiesCollector::fill_executable_list_from_map(
   const rclcpp::memory_strategy::MemoryStrategy::WeakCallbackGroupsToNodesMap &
@@ -177,37 +195,42 @@ StaticExecutorEntitiesCollector::fill_executable_list_from_map(
       continue;
     }
     group->find_timer_ptrs_if(
-      [this](const rclcpp::TimerBase::SharedPtr & timer) {
+      [this, &group](const rclcpp::TimerBase::SharedPtr & timer) {
         if (timer) {
           exec_list_.add_timer(timer);
+          timer_groups_.push_back(group);
         }
         return false;
       });
     group->find_subscription_ptrs_if(
-      [this](const rclcpp::SubscriptionBase::SharedPtr & subscription) {
+      [this, &group](const rclcpp::SubscriptionBase::SharedPtr & subscription) {
         if (subscription) {
           exec_list_.add_subscription(subscription);
+          subscription_groups_.push_back(group);
         }
         return false;
       });
     group->find_service_ptrs_if(
-      [this](const rclcpp::ServiceBase::SharedPtr & service) {
+      [this, &group](const rclcpp::ServiceBase::SharedPtr & service) {
         if (service) {
           exec_list_.add_service(service);
+          service_groups_.push_back(group);
         }
         return false;
       });
     group->find_client_ptrs_if(
-      [this](const rclcpp::ClientBase::SharedPtr & client) {
+      [this, &group](const rclcpp::ClientBase::SharedPtr & client) {
         if (client) {
           exec_list_.add_client(client);
+          client_groups_.push_back(group);
         }
         return false;
       });
     group->find_waitable_ptrs_if(
-      [this](const rclcpp::Waitable::SharedPtr & waitable) {
+      [this, &group](const rclcpp::Waitable::SharedPtr & waitable) {
         if (waitable) {
           exec_list_.add_waitable(waitable);
+          waitable_groups_.push_back(group);
         }
         return false;
       });
@@ -222,17 +245,7 @@ StaticExecutorEntitiesCollector::prepare_wait_set()
     throw std::runtime_error("Couldn't clear wait set");
   }
 
-  // The size of waitables are accounted for in size of the other entities
-  rcl_ret_t ret = rcl_wait_set_resize(
-    p_wait_set_, memory_strategy_->number_of_ready_subscriptions(),
-    memory_strategy_->number_of_guard_conditions(), memory_strategy_->number_of_ready_timers(),
-    memory_strategy_->number_of_ready_clients(), memory_strategy_->number_of_ready_services(),
-    memory_strategy_->number_of_ready_events());
-
-  if (RCL_RET_OK != ret) {
-    throw std::runtime_error(
-            std::string("Couldn't resize the wait set: ") + rcl_get_error_string().str);
-  }
+  rclcpp::detail::resize_wait_set(p_wait_set_, *memory_strategy_, wait_set_capacities_);
 }
 
 void
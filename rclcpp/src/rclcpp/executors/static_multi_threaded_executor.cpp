@@ -0,0 +1,284 @@
+// Copyright 2021 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "rclcpp/executors/static_multi_threaded_executor.hpp"
+
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "rcpputils/scope_exit.hpp"
+
+#include "rclcpp/utilities.hpp"
+
+using rclcpp::executors::StaticMultiThreadedExecutor;
+
+StaticMultiThreadedExecutor::StaticMultiThreadedExecutor(
+  const rclcpp::ExecutorOptions & options,
+  size_t number_of_threads,
+  std::chrono::nanoseconds next_exec_timeout)
+: StaticSingleThreadedExecutor(options),
+  next_exec_timeout_(next_exec_timeout)
+{
+  number_of_threads_ = number_of_threads ? number_of_threads : std::thread::hardware_concurrency();
+  if (number_of_threads_ == 0) {
+    number_of_threads_ = 1;
+  }
+  for (size_t i = 0; i < number_of_threads_; ++i) {
+    thread_attributes_by_index_.push_back(
+      i < options.worker_thread_attributes.size() ?
+      options.worker_thread_attributes[i] : options.thread_attributes);
+  }
+}
+
+StaticMultiThreadedExecutor::~StaticMultiThreadedExecutor() {}
+
+void
+StaticMultiThreadedExecutor::spin()
+{
+  if (spinning.exchange(true)) {
+    throw std::runtime_error("spin() called while already spinning");
+  }
+  RCPPUTILS_SCOPE_EXIT(this->spinning.store(false); );
+  // The calling thread is the last one, it gets its own attributes back when spin() returns.
+  rclcpp::ScopedThreadAttributes thread_attributes(
+    thread_attributes_by_index_[number_of_threads_ - 1]);
+  thread_attributes_error_ = nullptr;
+
+  // Set memory_strategy_ and exec_list_ based on weak_nodes_
+  // Prepare wait_set_ based on memory_strategy_
+  entities_collector_->init(
+    &wait_set_, memory_strategy_, &interrupt_guard_condition_, wait_set_capacities_);
+
+  std::vector<std::thread> threads;
+  for (size_t thread_id = 0; thread_id < number_of_threads_ - 1; ++thread_id) {
+    threads.emplace_back(
+      [this, thread_id]() {
+        try {
+          rclcpp::apply_thread_attributes(thread_attributes_by_index_[thread_id]);
+        } catch (...) {
+          {
+            std::lock_guard<std::mutex> lock(thread_attributes_error_mutex_);
+            if (!thread_attributes_error_) {
+              thread_attributes_error_ = std::current_exception();
+            }
+          }
+          // Stop the whole pool rather than spinning with fewer threads than requested.
+          cancel();
+          return;
+        }
+        run();
+      });
+  }
+
+  run();
+  for (auto & thread : threads) {
+    thread.join();
+  }
+
+  // Drop what was queued but not taken, the callback groups were not taken from yet.
+  ready_executables_.clear();
+
+  if (thread_attributes_error_) {
+    std::rethrow_exception(thread_attributes_error_);
+  }
+}
+
+size_t
+StaticMultiThreadedExecutor::get_number_of_threads() const
+{
+  return number_of_threads_;
+}
+
+void
+StaticMultiThreadedExecutor::run()
+{
+  while (rclcpp::ok(this->context_) && spinning.load()) {
+    {
+      rclcpp::AnyExecutable any_exec;
+      {
+        std::lock_guard<std::mutex> wait_lock(wait_mutex_);
+        while (true) {
+          if (!rclcpp::ok(this->context_) || !spinning.load()) {
+            return;
+          }
+          uint64_t completed_executions;
+          {
+            std::lock_guard<std::mutex> lock(completion_mutex_);
+            completed_executions = completed_executions_;
+          }
+          if (take_ready_executable(any_exec)) {
+            break;
+          }
+          if (ready_executables_.empty()) {
+            wait_for_ready_executables();
+          } else {
+            // The static wait set would report the queued executables ready again right away.
+            wait_for_completed_executable(completed_executions);
+          }
+        }
+      }
+      execute_any_executable(any_exec);
+    }
+    // The callback group was released along with the executable, even if spinning was
+    // stopped before it was executed.
+    notify_completed_executable();
+  }
+}
+
+bool
+StaticMultiThreadedExecutor::take_ready_executable(rclcpp::AnyExecutable & any_exec)
+{
+  for (auto it = ready_executables_.begin(); it != ready_executables_.end(); ++it) {
+    auto & group = it->callback_group;
+    if (group->type() == rclcpp::CallbackGroupType::MutuallyExclusive &&
+      !group->can_be_taken_from().exchange(false))
+    {
+      continue;
+    }
+    any_exec = std::move(it->any_exec);
+    any_exec.callback_group = std::move(group);
+    ready_executables_.erase(it);
+    {
+      std::lock_guard<std::mutex> lock(completion_mutex_);
+      ++executions_in_progress_;
+    }
+    return true;
+  }
+  return false;
+}
+
+void
+StaticMultiThreadedExecutor::wait_for_ready_executables()
+{
+  entities_collector_->refresh_wait_set(next_exec_timeout_);
+  std::chrono::steady_clock::time_point ready_time;
+  if (statistics_.load(std::memory_order_acquire)) {
+    ready_time = std::chrono::steady_clock::now();
+  }
+  auto queue = [this, ready_time](ReadyExecutable && ready) {
+      // The group was destroyed since the executable list was built.
+      if (!ready.callback_group) {
+        return;
+      }
+      ready.any_exec.ready_time = ready_time;
+      ready_executables_.push_back(std::move(ready));
+    };
+
+  update_ready_bitmaps();
+  auto & collector = *entities_collector_;
+  ready_subscriptions_.for_each(
+    collector.get_number_of_subscriptions(),
+    [&collector, &queue](size_t i) {
+      ReadyExecutable ready;
+      ready.any_exec.subscription = collector.get_subscription(i);
+      ready.callback_group = collector.get_subscription_callback_group(i);
+      queue(std::move(ready));
+      return true;
+    });
+  rclcpp::TimerClockSnapshot clock_snapshot;
+  ready_timers_.for_each(
+    collector.get_number_of_timers(),
+    [&collector, &queue, &clock_snapshot](size_t i) {
+      auto timer = collector.get_timer(i);
+      // Calling the timer now keeps a later wait from reporting it ready again,
+      // call() returns false if the timer was canceled after the wait.
+      if (!timer->is_ready(clock_snapshot) || !timer->call()) {
+        return true;
+      }
+      ReadyExecutable ready;
+      ready.any_exec.timer = std::move(timer);
+      ready.callback_group = collector.get_timer_callback_group(i);
+      queue(std::move(ready));
+      return true;
+    });
+  ready_services_.for_each(
+    collector.get_number_of_services(),
+    [&collector, &queue](size_t i) {
+      ReadyExecutable ready;
+      ready.any_exec.service = collector.get_service(i);
+      ready.callback_group = collector.get_service_callback_group(i);
+      queue(std::move(ready));
+      return true;
+    });
+  ready_clients_.for_each(
+    collector.get_number_of_clients(),
+    [&collector, &queue](size_t i) {
+      ReadyExecutable ready;
+      ready.any_exec.client = collector.get_client(i);
+      ready.callback_group = collector.get_client_callback_group(i);
+      queue(std::move(ready));
+      return true;
+    });
+  if (!waitables_may_be_ready()) {
+    return;
+  }
+  bool entities_changed = false;
+  for (size_t i = 0; i < collector.get_number_of_waitables(); ++i) {
+    auto waitable = collector.get_waitable(i);
+    if (!waitable->is_ready(&wait_set_)) {
+      continue;
+    }
+    if (waitable == entities_collector_) {
+      entities_changed = true;
+      continue;
+    }
+    auto group = collector.get_waitable_callback_group(i);
+    if (!group) {
+      continue;
+    }
+    ReadyExecutable ready;
+    // The data is taken now, for the same reason the timers are called.
+    ready.any_exec.data = waitable->take_data();
+    ready.any_exec.waitable = std::move(waitable);
+    ready.callback_group = std::move(group);
+    queue(std::move(ready));
+  }
+
+  if (entities_changed) {
+    // The memory strategy leaves out the groups which cannot be taken from, wait for the
+    // executions in progress so that no entity is missing from the rebuilt executable list.
+    {
+      std::unique_lock<std::mutex> lock(completion_mutex_);
+      completion_cv_.wait(lock, [this]() {return executions_in_progress_ == 0;});
+    }
+    std::shared_ptr<void> data = entities_collector_->take_data();
+    entities_collector_->execute(data);
+  }
+}
+
+void
+StaticMultiThreadedExecutor::wait_for_completed_executable(uint64_t completed_executions)
+{
+  std::unique_lock<std::mutex> lock(completion_mutex_);
+  completion_cv_.wait(
+    lock, [this, completed_executions]() {
+      return completed_executions_ != completed_executions;
+    });
+}
+
+void
+StaticMultiThreadedExecutor::notify_completed_executable()
+{
+  {
+    std::lock_guard<std::mutex> lock(completion_mutex_);
+    ++completed_executions_;
+    --executions_in_progress_;
+  }
+  completion_cv_.notify_all();
+}
@@ -16,10 +16,14 @@
 
 #include <chrono>
 #include <memory>
+#include <typeinfo>
 #include <vector>
 
 #include "rcpputils/scope_exit.hpp"
 
+#include "rclcpp/allocation_tracking.hpp"
+#include "rclcpp/thread_attributes.hpp"
+
 using rclcpp::executors::StaticSingleThreadedExecutor;
 using rclcpp::experimental::ExecutableList;
 
@@ -44,10 +48,12 @@ StaticSingleThreadedExecutor::spin()
     throw std::runtime_error("spin() called while already spinning");
   }
   RCPPUTILS_SCOPE_EXIT(this->spinning.store(false); );
+  rclcpp::ScopedThreadAttributes thread_attributes(thread_attributes_);
 
   // Set memory_strategy_ and exec_list_ based on weak_nodes_
   // Prepare wait_set_ based on memory_strategy_
-  entities_collector_->init(&wait_set_, memory_strategy_, &interrupt_guard_condition_);
+  entities_collector_->init(
+    &wait_set_, memory_strategy_, &interrupt_guard_condition_, wait_set_capacities_);
 
   while (rclcpp::ok(this->context_) && spinning.load()) {
     // Refresh wait set and wait for work
@@ -81,7 +87,8 @@ StaticSingleThreadedExecutor::spin_some_impl(std::chrono::nanoseconds max_durati
 {
   // Make sure the entities collector has been initialized
   if (!entities_collector_->is_init()) {
-    entities_collector_->init(&wait_set_, memory_strategy_, &interrupt_guard_condition_);
+    entities_collector_->init(
+      &wait_set_, memory_strategy_, &interrupt_guard_condition_, wait_set_capacities_);
   }
 
   auto start = std::chrono::steady_clock::now();
@@ -118,7 +125,8 @@ StaticSingleThreadedExecutor::spin_once_impl(std::chrono::nanoseconds timeout)
 {
   // Make sure the entities collector has been initialized
   if (!entities_collector_->is_init()) {
-    entities_collector_->init(&wait_set_, memory_strategy_, &interrupt_guard_condition_);
+    entities_collector_->init(
+      &wait_set_, memory_strategy_, &interrupt_guard_condition_, wait_set_capacities_);
   }
 
   if (rclcpp::ok(context_) && spinning.load()) {
@@ -216,63 +224,94 @@ StaticSingleThreadedExecutor::remove_node(std::shared_ptr<rclcpp::Node> node_ptr
   this->remove_node(node_ptr->get_node_base_interface(), notify);
 }
 
+void
+StaticSingleThreadedExecutor::update_ready_bitmaps()
+{
+  ready_subscriptions_.assign(wait_set_.subscriptions, wait_set_.size_of_subscriptions);
+  ready_timers_.assign(wait_set_.timers, wait_set_.size_of_timers);
+  ready_services_.assign(wait_set_.services, wait_set_.size_of_services);
+  ready_clients_.assign(wait_set_.clients, wait_set_.size_of_clients);
+  ready_guard_conditions_.assign(wait_set_.guard_conditions, wait_set_.size_of_guard_conditions);
+  ready_events_.assign(wait_set_.events, wait_set_.size_of_events);
+}
+
+bool
+StaticSingleThreadedExecutor::waitables_may_be_ready() const
+{
+  // The memory strategy adds the entities of the waitables after the ones of the
+  // executable list, and all the guard conditions and events belong to waitables but
+  // for the interrupt guard condition.
+  return ready_guard_conditions_.any() || ready_events_.any() ||
+         ready_subscriptions_.any(entities_collector_->get_number_of_subscriptions()) ||
+         ready_timers_.any(entities_collector_->get_number_of_timers()) ||
+         ready_services_.any(entities_collector_->get_number_of_services()) ||
+         ready_clients_.any(entities_collector_->get_number_of_clients());
+}
+
 bool
 StaticSingleThreadedExecutor::execute_ready_executables(bool spin_once)
 {
   bool any_ready_executable = false;
+  update_ready_bitmaps();
+  // Return false from the visits to stop after the first executable when spinning once.
+  auto executed = [&any_ready_executable, spin_once]() {
+      any_ready_executable = true;
+      return !spin_once;
+    };
 
   // Execute all the ready subscriptions
-  for (size_t i = 0; i < wait_set_.size_of_subscriptions; ++i) {
-    if (i < entities_collector_->get_number_of_subscriptions()) {
-      if (wait_set_.subscriptions[i]) {
+  if (!ready_subscriptions_.for_each(
+      entities_collector_->get_number_of_subscriptions(),
+      [this, &executed](size_t i) {
         execute_subscription(entities_collector_->get_subscription(i));
-        if (spin_once) {
-          return true;
-        }
-        any_ready_executable = true;
-      }
-    }
+        return executed();
+      }))
+  {
+    return true;
   }
-  // Execute all the ready timers
-  for (size_t i = 0; i < wait_set_.size_of_timers; ++i) {
-    if (i < entities_collector_->get_number_of_timers()) {
-      if (wait_set_.timers[i] && entities_collector_->get_timer(i)->is_ready()) {
-        execute_timer(entities_collector_->get_timer(i));
-        if (spin_once) {
+  // Execute all the ready timers, checked against a single read of their clocks
+  rclcpp::TimerClockSnapshot clock_snapshot;
+  if (!ready_timers_.for_each(
+      entities_collector_->get_number_of_timers(),
+      [this, &executed, &clock_snapshot](size_t i) {
+        const auto & timer = entities_collector_->get_timer(i);
+        if (!timer->is_ready(clock_snapshot)) {
           return true;
         }
-        any_ready_executable = true;
-      }
-    }
+        execute_timer(timer);
+        return executed();
+      }))
+  {
+    return true;
   }
   // Execute all the ready services
-  for (size_t i = 0; i < wait_set_.size_of_services; ++i) {
-    if (i < entities_collector_->get_number_of_services()) {
-      if (wait_set_.services[i]) {
+  if (!ready_services_.for_each(
+      entities_collector_->get_number_of_services(),
+      [this, &executed](size_t i) {
         execute_service(entities_collector_->get_service(i));
-        if (spin_once) {
-          return true;
-        }
-        any_ready_executable = true;
-      }
-    }
+        return executed();
+      }))
+  {
+    return true;
   }
   // Execute all the ready clients
-  for (size_t i = 0; i < wait_set_.size_of_clients; ++i) {
-    if (i < entities_collector_->get_number_of_clients()) {
-      if (wait_set_.clients[i]) {
+  if (!ready_clients_.for_each(
+      entities_collector_->get_number_of_clients(),
+      [this, &executed](size_t i) {
         execute_client(entities_collector_->get_client(i));
-        if (spin_once) {
-          return true;
-        }
-        any_ready_executable = true;
-      }
-    }
+        return executed();
+      }))
+  {
+    return true;
+  }
+  // Execute all the ready waitables, none of them is ready if none of their entities is
+  if (!waitables_may_be_ready()) {
+    return any_ready_executable;
   }
-  // Execute all the ready waitables
   for (size_t i = 0; i < entities_collector_->get_number_of_waitables(); ++i) {
     auto waitable = entities_collector_->get_waitable(i);
     if (waitable->is_ready(&wait_set_)) {
+      allocation_tracking::CallbackScope scope("waitable", typeid(*waitable).name());
       auto data = waitable->take_data();
       waitable->execute(data);
       if (spin_once) {
@@ -28,8 +28,90 @@
 
 using rclcpp::exceptions::throw_from_rcl_error;
 
+namespace
+{
+
+/// Throw InvalidTopicNameError, or InvalidServiceNameError, if the name is not valid.
+void
+throw_if_invalid_topic_name(const std::string & name, bool is_service)
+{
+  int validation_result;
+  size_t invalid_index;
+  rcl_ret_t ret = rcl_validate_topic_name(name.c_str(), &validation_result, &invalid_index);
+  if (ret != RCL_RET_OK) {
+    throw_from_rcl_error(ret);
+  }
+
+  if (validation_result != RCL_TOPIC_NAME_VALID) {
+    const char * validation_message =
+      rcl_topic_name_validation_result_string(validation_result);
+    if (is_service) {
+      using rclcpp::exceptions::InvalidServiceNameError;
+      throw InvalidServiceNameError(name.c_str(), validation_message, invalid_index);
+    } else {
+      using rclcpp::exceptions::InvalidTopicNameError;
+      throw InvalidTopicNameError(name.c_str(), validation_message, invalid_index);
+    }
+  }
+}
+
+/// Throw rclcpp::exceptions::InvalidNodeNameError if the node name is not valid.
+void
+throw_if_invalid_node_name(const std::string & node_name)
+{
+  int validation_result;
+  size_t invalid_index;
+  rmw_ret_t rmw_ret =
+    rmw_validate_node_name(node_name.c_str(), &validation_result, &invalid_index);
+  if (rmw_ret != RMW_RET_OK) {
+    if (rmw_ret == RMW_RET_INVALID_ARGUMENT) {
+      throw_from_rcl_error(
+        RCL_RET_INVALID_ARGUMENT, "failed to validate node name",
+        rmw_get_error_state(), rmw_reset_error);
+    }
+    throw_from_rcl_error(
+      RCL_RET_ERROR, "failed to validate node name",
+      rmw_get_error_state(), rmw_reset_error);
+  }
+
+  if (validation_result != RMW_NODE_NAME_VALID) {
+    throw rclcpp::exceptions::InvalidNodeNameError(
+            node_name.c_str(),
+            rmw_node_name_validation_result_string(validation_result),
+            invalid_index);
+  }
+}
+
+/// Throw rclcpp::exceptions::InvalidNamespaceError if the namespace is not valid.
+void
+throw_if_invalid_namespace(const std::string & namespace_)
+{
+  int validation_result;
+  size_t invalid_index;
+  rmw_ret_t rmw_ret =
+    rmw_validate_namespace(namespace_.c_str(), &validation_result, &invalid_index);
+  if (rmw_ret != RMW_RET_OK) {
+    if (rmw_ret == RMW_RET_INVALID_ARGUMENT) {
+      throw_from_rcl_error(
+        RCL_RET_INVALID_ARGUMENT, "failed to validate namespace",
+        rmw_get_error_state(), rmw_reset_error);
+    }
+    throw_from_rcl_error(
+      RCL_RET_ERROR, "failed to validate namespace",
+      rmw_get_error_state(), rmw_reset_error);
+  }
+
+  if (validation_result != RMW_NAMESPACE_VALID) {
+    throw rclcpp::exceptions::InvalidNamespaceError(
+            namespace_.c_str(),
+            rmw_namespace_validation_result_string(validation_result),
+            invalid_index);
+  }
+}
+
+/// Expand the name with rcl, with the default substitutions.
 std::string
-rclcpp::expand_topic_or_service_name(
+expand_with_substitutions(
   const std::string & name,
   const std::string & node_name,
   const std::string & namespace_,
@@ -88,85 +170,45 @@ rclcpp::expand_topic_or_service_name(
     // if invalid topic or unknown substitution
     if (ret == RCL_RET_TOPIC_NAME_INVALID || ret == RCL_RET_UNKNOWN_SUBSTITUTION) {
       rcl_reset_error();  // explicitly discard error from rcl_expand_topic_name()
-      int validation_result;
-      size_t invalid_index;
-      rcl_ret_t ret = rcl_validate_topic_name(name.c_str(), &validation_result, &invalid_index);
-      if (ret != RCL_RET_OK) {
-        throw_from_rcl_error(ret);
-      }
-
-      if (validation_result != RCL_TOPIC_NAME_VALID) {
-        const char * validation_message =
-          rcl_topic_name_validation_result_string(validation_result);
-        if (is_service) {
-          using rclcpp::exceptions::InvalidServiceNameError;
-          throw InvalidServiceNameError(name.c_str(), validation_message, invalid_index);
-        } else {
-          using rclcpp::exceptions::InvalidTopicNameError;
-          throw InvalidTopicNameError(name.c_str(), validation_message, invalid_index);
-        }
-      } else {
-        throw std::runtime_error("topic name unexpectedly valid");
-      }
-
+      throw_if_invalid_topic_name(name, is_service);
+      throw std::runtime_error("topic name unexpectedly valid");
       // if invalid node name
     } else if (ret == RCL_RET_NODE_INVALID_NAME) {
       rcl_reset_error();  // explicitly discard error from rcl_expand_topic_name()
-      int validation_result;
-      size_t invalid_index;
-      rmw_ret_t rmw_ret =
-        rmw_validate_node_name(node_name.c_str(), &validation_result, &invalid_index);
-      if (rmw_ret != RMW_RET_OK) {
-        if (rmw_ret == RMW_RET_INVALID_ARGUMENT) {
-          throw_from_rcl_error(
-            RCL_RET_INVALID_ARGUMENT, "failed to validate node name",
-            rmw_get_error_state(), rmw_reset_error);
-        }
-        throw_from_rcl_error(
-          RCL_RET_ERROR, "failed to validate node name",
-          rmw_get_error_state(), rmw_reset_error);
-      }
-
-      if (validation_result != RMW_NODE_NAME_VALID) {
-        throw rclcpp::exceptions::InvalidNodeNameError(
-                node_name.c_str(),
-                rmw_node_name_validation_result_string(validation_result),
-                invalid_index);
-      } else {
-        throw std::runtime_error("invalid rcl node name but valid rmw node name");
-      }
-
+      throw_if_invalid_node_name(node_name);
+      throw std::runtime_error("invalid rcl node name but valid rmw node name");
       // if invalid namespace
     } else if (ret == RCL_RET_NODE_INVALID_NAMESPACE) {
       rcl_reset_error();  // explicitly discard error from rcl_expand_topic_name()
-      int validation_result;
-      size_t invalid_index;
-      rmw_ret_t rmw_ret =
-        rmw_validate_namespace(namespace_.c_str(), &validation_result, &invalid_index);
-      if (rmw_ret != RMW_RET_OK) {
-        if (rmw_ret == RMW_RET_INVALID_ARGUMENT) {
-          throw_from_rcl_error(
-            RCL_RET_INVALID_ARGUMENT, "failed to validate namespace",
-            rmw_get_error_state(), rmw_reset_error);
-        }
-        throw_from_rcl_error(
-          RCL_RET_ERROR, "failed to validate namespace",
-          rmw_get_error_state(), rmw_reset_error);
-      }
-
-      if (validation_result != RMW_NAMESPACE_VALID) {
-        throw rclcpp::exceptions::InvalidNamespaceError(
-                namespace_.c_str(),
-                rmw_namespace_validation_result_string(validation_result),
-                invalid_index);
-      } else {
-        throw std::runtime_error("invalid rcl namespace but valid rmw namespace");
-      }
+      throw_if_invalid_namespace(namespace_);
+      throw std::runtime_error("invalid rcl namespace but valid rmw namespace");
       // something else happened
     } else {
       throw_from_rcl_error(ret);
     }
   }
+  return result;
+}
+
+}  // namespace
+
+std::string
+rclcpp::expand_topic_or_service_name(
+  const std::string & name,
+  const std::string & node_name,
+  const std::string & namespace_,
+  bool is_service)
+{
+  std::string result;
+  if (!name.empty() && '/' == name[0] && std::string::npos == name.find_first_of("{}~")) {
+    // Fully qualified without substitution, expanding it would copy it, only validate like rcl.
+    throw_if_invalid_topic_name(name, is_service);
+    throw_if_invalid_node_name(node_name);
+    throw_if_invalid_namespace(namespace_);
+    result = name;
+  } else {
+    result = expand_with_substitutions(name, node_name, namespace_, is_service);
+  }
 
   // expand succeeded, but full name validation may fail still
   int validation_result;
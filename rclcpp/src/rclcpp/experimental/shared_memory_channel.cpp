@@ -0,0 +1,498 @@
+// Copyright 2021 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "rclcpp/experimental/shared_memory_channel.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#if defined(__linux__)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <climits>
+#include <ctime>
+#endif
+
+using rclcpp::experimental::SharedMemoryChannel;
+
+namespace
+{
+
+constexpr uint32_t segment_magic = 0x52434d53;  // "RCMS"
+constexpr uint32_t segment_version = 1;
+constexpr size_t slot_alignment = 64;
+constexpr uint32_t writer_free = 0;
+constexpr uint32_t writer_claimed = 1;
+constexpr uint32_t writer_used = 2;
+
+int64_t
+steady_now_ns()
+{
+  // The steady clock is the monotonic clock of the host, shared by its processes.
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+    std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+}  // namespace
+
+/// Header of the segment, followed by the slots.
+struct SharedMemoryChannel::Segment
+{
+  struct Writer
+  {
+    std::atomic<uint32_t> state;
+    uint8_t gid[RMW_GID_STORAGE_SIZE];
+  };
+
+  struct Slot
+  {
+    /// 2 * sequence + 1 while the message is written, 2 * sequence + 2 once written.
+    std::atomic<uint64_t> sequence;
+    uint64_t size;
+    uint8_t writer_gid[RMW_GID_STORAGE_SIZE];
+  };
+
+  /// Set to segment_magic by the creator once the segment is initialized.
+  std::atomic<uint32_t> magic;
+  uint32_t version;
+  uint64_t slot_size;
+  uint64_t slot_count;
+  uint64_t slot_stride;
+  std::atomic<uint32_t> attach_count;
+  /// Futex word, increased each time a message is written.
+  std::atomic<uint32_t> notification;
+  std::atomic<uint64_t> write_sequence;
+  Writer writers[SharedMemoryChannel::max_endpoints];
+  /// Steady time of the last sign of life of the readers, 0 if the entry is free.
+  std::atomic<int64_t> reader_heartbeats[SharedMemoryChannel::max_endpoints];
+
+  static size_t
+  header_size()
+  {
+    return (sizeof(Segment) + slot_alignment - 1) / slot_alignment * slot_alignment;
+  }
+
+  Slot *
+  get_slot(uint64_t sequence)
+  {
+    auto base = reinterpret_cast<uint8_t *>(this) + header_size();
+    return reinterpret_cast<Slot *>(base + (sequence % slot_count) * slot_stride);
+  }
+
+  static uint8_t *
+  get_slot_data(Slot * slot)
+  {
+    return reinterpret_cast<uint8_t *>(slot) + sizeof(Slot);
+  }
+};
+
+static_assert(
+  sizeof(std::atomic<uint32_t>) == sizeof(uint32_t) && std::atomic<uint32_t>::is_always_lock_free,
+  "the notification must be usable as a futex word");
+static_assert(
+  std::atomic<uint64_t>::is_always_lock_free && std::atomic<int64_t>::is_always_lock_free,
+  "the atomics of the segment must be lock free to be shared between processes");
+
+SharedMemoryChannel::SharedMemoryChannel(
+  const std::string & topic_name,
+  size_t domain_id,
+  size_t slot_size,
+  size_t slot_count)
+: segment_name_(get_segment_name(topic_name, domain_id)),
+  segment_(nullptr),
+  mapped_size_(0),
+  reader_index_(max_endpoints)
+{
+  if (slot_size == 0) {
+    throw std::invalid_argument("slot_size must be a positive, non-zero value");
+  }
+  if (slot_count == 0) {
+    throw std::invalid_argument("slot_count must be a positive, non-zero value");
+  }
+#if defined(_WIN32)
+  throw std::runtime_error("shared memory transport is not supported on this platform");
+#else
+  const size_t slot_stride =
+    (sizeof(Segment::Slot) + slot_size + slot_alignment - 1) / slot_alignment * slot_alignment;
+
+  bool creator = true;
+  int fd = shm_open(segment_name_.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+  if (fd < 0 && errno == EEXIST) {
+    creator = false;
+    fd = shm_open(segment_name_.c_str(), O_RDWR, 0600);
+  }
+  if (fd < 0) {
+    throw std::runtime_error(
+            "failed to open shared memory segment '" + segment_name_ + "': " +
+            std::strerror(errno));
+  }
+
+  if (creator) {
+    mapped_size_ = Segment::header_size() + slot_count * slot_stride;
+    if (ftruncate(fd, static_cast<off_t>(mapped_size_)) != 0) {
+      const int error = errno;
+      close(fd);
+      shm_unlink(segment_name_.c_str());
+      throw std::runtime_error(
+              "failed to size shared memory segment '" + segment_name_ + "': " +
+              std::strerror(error));
+    }
+  } else {
+    // The creator may not have sized the segment yet.
+    struct stat segment_stat;
+    const auto deadline = std::chrono::steady_clock::now() + reader_timeout;
+    while (fstat(fd, &segment_stat) == 0 &&
+      static_cast<size_t>(segment_stat.st_size) < Segment::header_size() &&
+      std::chrono::steady_clock::now() < deadline)
+    {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    mapped_size_ = static_cast<size_t>(segment_stat.st_size);
+    if (mapped_size_ < Segment::header_size()) {
+      close(fd);
+      throw std::runtime_error(
+              "shared memory segment '" + segment_name_ + "' was not initialized");
+    }
+  }
+
+  void * address = mmap(nullptr, mapped_size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (MAP_FAILED == address) {
+    const int error = errno;
+    if (creator) {
+      shm_unlink(segment_name_.c_str());
+    }
+    throw std::runtime_error(
+            "failed to map shared memory segment '" + segment_name_ + "': " +
+            std::strerror(error));
+  }
+  segment_ = static_cast<Segment *>(address);
+
+  if (creator) {
+    // The segment is zero filled, which is the initial state of all the atomics.
+    segment_->version = segment_version;
+    segment_->slot_size = slot_size;
+    segment_->slot_count = slot_count;
+    segment_->slot_stride = slot_stride;
+    segment_->attach_count.store(1, std::memory_order_relaxed);
+    segment_->magic.store(segment_magic, std::memory_order_release);
+    return;
+  }
+
+  const auto deadline = std::chrono::steady_clock::now() + reader_timeout;
+  while (segment_->magic.load(std::memory_order_acquire) != segment_magic &&
+    std::chrono::steady_clock::now() < deadline)
+  {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  if (segment_->magic.load(std::memory_order_acquire) != segment_magic ||
+    segment_->version != segment_version ||
+    Segment::header_size() + segment_->slot_count * segment_->slot_stride > mapped_size_)
+  {
+    munmap(segment_, mapped_size_);
+    segment_ = nullptr;
+    throw std::runtime_error(
+            "shared memory segment '" + segment_name_ + "' is invalid or was not initialized");
+  }
+  segment_->attach_count.fetch_add(1, std::memory_order_relaxed);
+#endif
+}
+
+SharedMemoryChannel::~SharedMemoryChannel()
+{
+#if !defined(_WIN32)
+  if (!segment_) {
+    return;
+  }
+  remove_reader();
+  if (segment_->attach_count.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+    shm_unlink(segment_name_.c_str());
+  }
+  munmap(segment_, mapped_size_);
+#endif
+}
+
+std::string
+SharedMemoryChannel::get_segment_name(const std::string & topic_name, size_t domain_id)
+{
+  // Segment names have a single leading slash and a limited length.
+  constexpr size_t max_name_length = 200;
+  std::string name = "/rclcpp_shm_" + std::to_string(domain_id);
+  for (char c : topic_name) {
+    name += ('/' == c) ? '.' : c;
+  }
+  if (name.size() > max_name_length) {
+    name = name.substr(0, max_name_length) + "_" +
+      std::to_string(std::hash<std::string>{}(topic_name));
+  }
+  return name;
+}
+
+size_t
+SharedMemoryChannel::get_slot_size() const
+{
+  return static_cast<size_t>(segment_->slot_size);
+}
+
+size_t
+SharedMemoryChannel::get_slot_count() const
+{
+  return static_cast<size_t>(segment_->slot_count);
+}
+
+void
+SharedMemoryChannel::add_writer(const rmw_gid_t & writer_gid)
+{
+  for (auto & writer : segment_->writers) {
+    uint32_t expected = writer_free;
+    if (writer.state.compare_exchange_strong(expected, writer_claimed)) {
+      std::memcpy(writer.gid, writer_gid.data, RMW_GID_STORAGE_SIZE);
+      writer.state.store(writer_used, std::memory_order_release);
+      return;
+    }
+  }
+  throw std::runtime_error(
+          "shared memory segment '" + segment_name_ + "' has too many writers");
+}
+
+void
+SharedMemoryChannel::remove_writer(const rmw_gid_t & writer_gid)
+{
+  for (auto & writer : segment_->writers) {
+    if (writer.state.load(std::memory_order_acquire) == writer_used &&
+      std::memcmp(writer.gid, writer_gid.data, RMW_GID_STORAGE_SIZE) == 0)
+    {
+      writer.state.store(writer_free, std::memory_order_release);
+      return;
+    }
+  }
+}
+
+bool
+SharedMemoryChannel::is_writer(const rmw_gid_t & writer_gid) const
+{
+  for (const auto & writer : segment_->writers) {
+    if (writer.state.load(std::memory_order_acquire) == writer_used &&
+      std::memcmp(writer.gid, writer_gid.data, RMW_GID_STORAGE_SIZE) == 0)
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
+void
+SharedMemoryChannel::write(const uint8_t * data, size_t size, const rmw_gid_t & writer_gid)
+{
+  if (size > segment_->slot_size) {
+    throw std::length_error(
+            "message of " + std::to_string(size) + " bytes does not fit in a shared memory slot of " +
+            std::to_string(segment_->slot_size) + " bytes");
+  }
+  const uint64_t sequence = segment_->write_sequence.fetch_add(1, std::memory_order_acq_rel);
+  Segment::Slot * slot = segment_->get_slot(sequence);
+
+  // Claim the slot, waiting for a writer a ring behind to finish with it.
+  uint64_t current = slot->sequence.load(std::memory_order_acquire);
+  while (true) {
+    if (current > 2 * sequence) {
+      // A writer a ring ahead took the slot already, this message is overwritten.
+      return;
+    }
+    if (current & 1u) {
+      std::this_thread::yield();
+      current = slot->sequence.load(std::memory_order_acquire);
+      continue;
+    }
+    if (slot->sequence.compare_exchange_weak(
+        current, 2 * sequence + 1, std::memory_order_acquire))
+    {
+      break;
+    }
+  }
+  std::atomic_thread_fence(std::memory_order_release);
+
+  slot->size = size;
+  std::memcpy(slot->writer_gid, writer_gid.data, RMW_GID_STORAGE_SIZE);
+  std::memcpy(Segment::get_slot_data(slot), data, size);
+  slot->sequence.store(2 * sequence + 2, std::memory_order_release);
+
+  segment_->notification.fetch_add(1, std::memory_order_release);
+#if defined(__linux__)
+  syscall(
+    SYS_futex, reinterpret_cast<uint32_t *>(&segment_->notification),
+    FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+#endif
+}
+
+uint64_t
+SharedMemoryChannel::get_write_sequence() const
+{
+  return segment_->write_sequence.load(std::memory_order_acquire);
+}
+
+bool
+SharedMemoryChannel::read(
+  uint64_t & sequence,
+  std::vector<uint8_t> & data,
+  uint8_t * writer_gid,
+  uint64_t & lost_count) const
+{
+  while (true) {
+    const uint64_t write_sequence = segment_->write_sequence.load(std::memory_order_acquire);
+    if (sequence >= write_sequence) {
+      return false;
+    }
+    if (write_sequence - sequence > segment_->slot_count) {
+      const uint64_t oldest = write_sequence - segment_->slot_count;
+      lost_count += oldest - sequence;
+      sequence = oldest;
+    }
+
+    Segment::Slot * slot = segment_->get_slot(sequence);
+    const uint64_t before = slot->sequence.load(std::memory_order_acquire);
+    if (before < 2 * sequence + 2) {
+      // The message is still being written.
+      return false;
+    }
+    if (before == 2 * sequence + 2) {
+      const size_t size = static_cast<size_t>(
+        std::min<uint64_t>(slot->size, segment_->slot_size));
+      data.resize(size);
+      std::memcpy(data.data(), Segment::get_slot_data(slot), size);
+      std::memcpy(writer_gid, slot->writer_gid, RMW_GID_STORAGE_SIZE);
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (slot->sequence.load(std::memory_order_relaxed) == before) {
+        ++sequence;
+        return true;
+      }
+    }
+    // The message was overwritten, before or while it was copied.
+    ++lost_count;
+    ++sequence;
+  }
+}
+
+void
+SharedMemoryChannel::add_reader()
+{
+  if (reader_index_ != max_endpoints) {
+    keep_reader_alive();
+    return;
+  }
+  const int64_t now = steady_now_ns();
+  const int64_t timeout = std::chrono::nanoseconds(reader_timeout).count();
+  for (size_t i = 0; i < max_endpoints; ++i) {
+    int64_t heartbeat = segment_->reader_heartbeats[i].load(std::memory_order_acquire);
+    // Take a free entry, or the one of a reader which stopped without removing itself.
+    if ((0 == heartbeat || now - heartbeat > timeout) &&
+      segment_->reader_heartbeats[i].compare_exchange_strong(heartbeat, now))
+    {
+      reader_index_ = i;
+      return;
+    }
+  }
+  throw std::runtime_error(
+          "shared memory segment '" + segment_name_ + "' has too many readers");
+}
+
+void
+SharedMemoryChannel::remove_reader()
+{
+  if (reader_index_ == max_endpoints) {
+    return;
+  }
+  segment_->reader_heartbeats[reader_index_].store(0, std::memory_order_release);
+  reader_index_ = max_endpoints;
+}
+
+void
+SharedMemoryChannel::keep_reader_alive()
+{
+  if (reader_index_ == max_endpoints) {
+    return;
+  }
+  segment_->reader_heartbeats[reader_index_].store(steady_now_ns(), std::memory_order_release);
+}
+
+size_t
+SharedMemoryChannel::get_reader_count() const
+{
+  const int64_t now = steady_now_ns();
+  const int64_t timeout = std::chrono::nanoseconds(reader_timeout).count();
+  size_t count = 0;
+  for (const auto & reader_heartbeat : segment_->reader_heartbeats) {
+    const int64_t heartbeat = reader_heartbeat.load(std::memory_order_acquire);
+    if (0 != heartbeat && now - heartbeat <= timeout) {
+      ++count;
+    }
+  }
+  return count;
+}
+
+uint32_t
+SharedMemoryChannel::get_notification() const
+{
+  return segment_->notification.load(std::memory_order_acquire);
+}
+
+void
+SharedMemoryChannel::wait_for_notification(
+  uint32_t notification, std::chrono::nanoseconds timeout) const
+{
+#if defined(__linux__)
+  if (timeout < std::chrono::nanoseconds::zero()) {
+    timeout = std::chrono::nanoseconds::zero();
+  }
+  struct timespec relative_timeout;
+  relative_timeout.tv_sec = static_cast<time_t>(timeout.count() / 1000000000LL);
+  relative_timeout.tv_nsec = static_cast<long>(timeout.count() % 1000000000LL);  // NOLINT
+  // Returns at once if a message was written since the notification was read.
+  syscall(
+    SYS_futex, reinterpret_cast<uint32_t *>(&segment_->notification),
+    FUTEX_WAIT, notification, &relative_timeout, nullptr, 0);
+#else
+  const auto deadline = std::chrono::steady_clock::now() + timeout;
+  while (get_notification() == notification && std::chrono::steady_clock::now() < deadline) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+#endif
+}
+
+void
+SharedMemoryChannel::notify() const
+{
+  // Waiters compare the notification with the value they read, so it has to change.
+  segment_->notification.fetch_add(1, std::memory_order_release);
+#if defined(__linux__)
+  syscall(
+    SYS_futex, reinterpret_cast<uint32_t *>(&segment_->notification),
+    FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+#endif
+}
@@ -0,0 +1,153 @@
+// Copyright 2021 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "rclcpp/experimental/subscription_shared_memory.hpp"
+
+#include <chrono>
+#include <cstring>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "rclcpp/logging.hpp"
+#include "rmw/rmw.h"
+
+using rclcpp::experimental::SharedMemoryChannel;
+using rclcpp::experimental::SubscriptionSharedMemory;
+
+SubscriptionSharedMemory::SubscriptionSharedMemory(
+  SharedMemoryChannel::SharedPtr channel,
+  rclcpp::Context::SharedPtr context,
+  MessageHandler handler)
+: channel_(std::move(channel)),
+  guard_condition_(std::move(context)),
+  handler_(std::move(handler)),
+  lost_message_count_(0),
+  stop_listening_(false)
+{
+  if (!channel_) {
+    throw std::invalid_argument("shared memory channel must not be null");
+  }
+  if (!handler_) {
+    throw std::invalid_argument("shared memory message handler must not be empty");
+  }
+  channel_->add_reader();
+  next_sequence_.store(channel_->get_write_sequence());
+  listener_thread_ = std::thread(&SubscriptionSharedMemory::listen, this);
+}
+
+SubscriptionSharedMemory::~SubscriptionSharedMemory()
+{
+  stop_listening_.store(true);
+  channel_->notify();
+  listener_thread_.join();
+  channel_->remove_reader();
+}
+
+size_t
+SubscriptionSharedMemory::get_number_of_ready_guard_conditions()
+{
+  return 1;
+}
+
+bool
+SubscriptionSharedMemory::add_to_wait_set(rcl_wait_set_t * wait_set)
+{
+  rcl_ret_t ret = rcl_wait_set_add_guard_condition(
+    wait_set, &guard_condition_.get_rcl_guard_condition(), NULL);
+  return RCL_RET_OK == ret;
+}
+
+bool
+SubscriptionSharedMemory::is_ready(rcl_wait_set_t * wait_set)
+{
+  (void)wait_set;
+  return channel_->get_write_sequence() > next_sequence_.load();
+}
+
+std::shared_ptr<void>
+SubscriptionSharedMemory::take_data()
+{
+  return nullptr;
+}
+
+void
+SubscriptionSharedMemory::execute(std::shared_ptr<void> & data)
+{
+  (void)data;
+  std::lock_guard<std::mutex> lock(execute_mutex_);
+
+  rmw_gid_t publisher_gid;
+  std::memset(&publisher_gid, 0, sizeof(publisher_gid));
+  // Publishers of the host use the same middleware, gids of other ones would not match anyway.
+  publisher_gid.implementation_identifier = rmw_get_implementation_identifier();
+
+  uint64_t sequence = next_sequence_.load();
+  uint64_t lost_count = 0;
+  while (channel_->read(sequence, data_, publisher_gid.data, lost_count)) {
+    // Skip the message even if the handler throws.
+    next_sequence_.store(sequence);
+    handler_(data_, publisher_gid);
+  }
+  next_sequence_.store(sequence);
+  lost_message_count_ += lost_count;
+}
+
+uint64_t
+SubscriptionSharedMemory::get_lost_message_count() const
+{
+  return lost_message_count_.load();
+}
+
+SharedMemoryChannel::SharedPtr
+SubscriptionSharedMemory::get_channel() const
+{
+  return channel_;
+}
+
+void
+SubscriptionSharedMemory::listen()
+{
+  // Renew the reader well before it times out.
+  const auto period = std::chrono::duration_cast<std::chrono::nanoseconds>(
+    SharedMemoryChannel::reader_timeout / 4);
+  auto last_heartbeat = std::chrono::steady_clock::now();
+  uint64_t observed_sequence = next_sequence_.load();
+
+  while (!stop_listening_.load()) {
+    const uint32_t notification = channel_->get_notification();
+    const uint64_t write_sequence = channel_->get_write_sequence();
+    if (write_sequence != observed_sequence) {
+      observed_sequence = write_sequence;
+      try {
+        guard_condition_.trigger();
+      } catch (const std::exception & exception) {
+        RCLCPP_ERROR(
+          rclcpp::get_logger("rclcpp"),
+          "failed to notify shared memory messages, stop waiting for them: %s",
+          exception.what());
+        return;
+      }
+    }
+    const auto now = std::chrono::steady_clock::now();
+    if (now - last_heartbeat >= period) {
+      channel_->keep_reader_alive();
+      last_heartbeat = now;
+    }
+    channel_->wait_for_notification(notification, period);
+  }
+}
@@ -0,0 +1,332 @@
+// Copyright 2021 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "rclcpp/experimental/timers_manager.hpp"
+
+#include <algorithm>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "rcl/timer.h"
+
+#include "rclcpp/exceptions.hpp"
+
+using rclcpp::experimental::TimersManager;
+
+namespace
+{
+
+/// Return the steady time of the next call of the timer, or of its next check if it is canceled.
+std::chrono::steady_clock::time_point
+get_next_deadline(rclcpp::TimerBase & timer, std::chrono::steady_clock::time_point now)
+{
+  int64_t time_until_next_call = 0;
+  // Query rcl directly, the timer may be canceled by another thread at any time.
+  rcl_ret_t ret = rcl_timer_get_time_until_next_call(
+    timer.get_timer_handle().get(), &time_until_next_call);
+  if (RCL_RET_TIMER_CANCELED == ret) {
+    return now + TimersManager::canceled_timer_poll_period;
+  }
+  if (RCL_RET_OK != ret) {
+    rclcpp::exceptions::throw_from_rcl_error(ret, "Timer could not get time until next call");
+  }
+  return now + std::chrono::nanoseconds(time_until_next_call);
+}
+
+}  // namespace
+
+TimersManager::TimersManager(
+  OnReadyCallback on_ready_callback,
+  std::chrono::nanoseconds resolution)
+: on_ready_callback_(std::move(on_ready_callback))
+{
+  if (resolution < std::chrono::nanoseconds(0)) {
+    throw std::invalid_argument("TimersManager resolution must not be negative");
+  }
+  if (resolution > std::chrono::nanoseconds(0)) {
+    wheel_ = std::make_unique<TimerWheel>(resolution);
+  }
+}
+
+TimersManager::~TimersManager()
+{
+  stop();
+}
+
+void
+TimersManager::add_timer(const rclcpp::TimerBase::SharedPtr & timer)
+{
+  if (!timer) {
+    throw std::invalid_argument("timer is nullptr");
+  }
+  const auto deadline = get_next_deadline(*timer, std::chrono::steady_clock::now());
+  const auto latest_deadline = deadline + timer->get_slack();
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (wheel_) {
+      if (wheel_handles_.count(timer.get()) != 0) {
+        return;
+      }
+      wheel_handles_[timer.get()] = wheel_->insert(
+        {deadline, latest_deadline, timer.get(), timer}, latest_deadline);
+    } else {
+      auto it = std::find_if(
+        heap_.begin(), heap_.end(),
+        [&timer](const TimerEntry & entry) {return entry.key == timer.get();});
+      if (it != heap_.end()) {
+        return;
+      }
+      heap_.push_back({deadline, latest_deadline, timer.get(), timer});
+      std::push_heap(heap_.begin(), heap_.end(), later_deadline);
+    }
+    timers_updated_ = true;
+  }
+  timers_updated_cv_.notify_one();
+}
+
+void
+TimersManager::remove_timer(const rclcpp::TimerBase::SharedPtr & timer)
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (wheel_) {
+      auto it = wheel_handles_.find(timer.get());
+      if (it == wheel_handles_.end()) {
+        return;
+      }
+      wheel_->erase(it->second);
+      wheel_handles_.erase(it);
+    } else {
+      auto it = std::find_if(
+        heap_.begin(), heap_.end(),
+        [&timer](const TimerEntry & entry) {return entry.key == timer.get();});
+      if (it == heap_.end()) {
+        return;
+      }
+      heap_.erase(it);
+      std::make_heap(heap_.begin(), heap_.end(), later_deadline);
+    }
+    timers_updated_ = true;
+  }
+  timers_updated_cv_.notify_one();
+}
+
+void
+TimersManager::clear()
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    heap_.clear();
+    if (wheel_) {
+      wheel_->clear();
+      wheel_handles_.clear();
+    }
+    timers_updated_ = true;
+  }
+  timers_updated_cv_.notify_one();
+}
+
+size_t
+TimersManager::size() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return wheel_ ? wheel_->size() : heap_.size();
+}
+
+void
+TimersManager::start()
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (running_) {
+    throw std::runtime_error("TimersManager::start() called while already running");
+  }
+  running_ = true;
+  thread_ = std::thread([this]() {run();});
+}
+
+void
+TimersManager::stop()
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!running_) {
+      return;
+    }
+    running_ = false;
+    timers_updated_ = true;
+  }
+  timers_updated_cv_.notify_one();
+  if (thread_.joinable()) {
+    thread_.join();
+  }
+}
+
+bool
+TimersManager::is_running() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return running_;
+}
+
+std::chrono::nanoseconds
+TimersManager::get_head_timeout()
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  const auto deadline = get_head_deadline();
+  if (std::chrono::steady_clock::time_point::max() == deadline) {
+    return std::chrono::nanoseconds::max();
+  }
+  return deadline - std::chrono::steady_clock::now();
+}
+
+size_t
+TimersManager::execute_ready_timers()
+{
+  std::vector<rclcpp::TimerBase::SharedPtr> ready_timers;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (running_) {
+      throw std::runtime_error(
+              "TimersManager::execute_ready_timers() called while the manager is running");
+    }
+    collect_ready_timers(ready_timers);
+  }
+  dispatch_ready_timers(ready_timers);
+  return ready_timers.size();
+}
+
+void
+TimersManager::run()
+{
+  std::vector<rclcpp::TimerBase::SharedPtr> ready_timers;
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (running_) {
+    auto timers_updated = [this]() {return timers_updated_;};
+    // Copy the deadline, the timers may change while the lock is released.
+    const auto deadline = get_head_deadline();
+    if (std::chrono::steady_clock::time_point::max() == deadline) {
+      timers_updated_cv_.wait(lock, timers_updated);
+    } else {
+      timers_updated_cv_.wait_until(lock, deadline, timers_updated);
+    }
+    timers_updated_ = false;
+    if (!running_) {
+      break;
+    }
+    collect_ready_timers(ready_timers);
+    if (ready_timers.empty()) {
+      continue;
+    }
+    // Timers may be added or removed from the callbacks.
+    lock.unlock();
+    dispatch_ready_timers(ready_timers);
+    ready_timers.clear();
+    lock.lock();
+  }
+}
+
+std::chrono::steady_clock::time_point
+TimersManager::get_head_deadline() const
+{
+  if (wheel_) {
+    return wheel_->next_expiry();
+  }
+  if (heap_.empty()) {
+    return std::chrono::steady_clock::time_point::max();
+  }
+  return heap_.front().latest_deadline;
+}
+
+void
+TimersManager::pop_due_entries(std::chrono::steady_clock::time_point now)
+{
+  if (wheel_) {
+    wheel_->advance(now);
+    for (auto handle = wheel_->pop_expired(); TimerWheel::invalid_handle != handle;
+      handle = wheel_->pop_expired())
+    {
+      due_handles_.push_back(handle);
+      due_entries_.push_back(wheel_->get(handle));
+    }
+    return;
+  }
+  // Keep popping while the next timer is due, so that timers whose slack is not used up yet
+  // share this wakeup.
+  while (!heap_.empty() && heap_.front().deadline <= now) {
+    std::pop_heap(heap_.begin(), heap_.end(), later_deadline);
+    due_entries_.push_back(std::move(heap_.back()));
+    heap_.pop_back();
+  }
+}
+
+void
+TimersManager::push_due_entries()
+{
+  for (size_t i = 0; i < due_entries_.size(); ++i) {
+    TimerEntry & entry = due_entries_[i];
+    // Destroyed timers are dropped.
+    if (wheel_) {
+      if (entry.timer.expired()) {
+        wheel_handles_.erase(entry.key);
+        wheel_->erase(due_handles_[i]);
+      } else {
+        wheel_->get(due_handles_[i]) = entry;
+        wheel_->reschedule(due_handles_[i], entry.latest_deadline);
+      }
+    } else if (!entry.timer.expired()) {
+      heap_.push_back(std::move(entry));
+      std::push_heap(heap_.begin(), heap_.end(), later_deadline);
+    }
+  }
+  due_entries_.clear();
+  due_handles_.clear();
+}
+
+void
+TimersManager::collect_ready_timers(std::vector<rclcpp::TimerBase::SharedPtr> & ready_timers)
+{
+  const auto now = std::chrono::steady_clock::now();
+  // Due entries are stored again only once all of them were popped, so that an entry which is
+  // still due when it is stored again is not popped again.
+  pop_due_entries(now);
+  rclcpp::TimerClockSnapshot clock_snapshot;
+  for (auto & entry : due_entries_) {
+    auto timer = entry.timer.lock();
+    if (!timer) {
+      continue;
+    }
+    // The deadline may be early if the clock of the timer drifted from the steady clock.
+    if (timer->is_ready(clock_snapshot) && timer->call()) {
+      ready_timers.push_back(timer);
+    }
+    entry.deadline = get_next_deadline(*timer, now);
+    entry.latest_deadline = entry.deadline + timer->get_slack();
+  }
+  push_due_entries();
+}
+
+void
+TimersManager::dispatch_ready_timers(
+  const std::vector<rclcpp::TimerBase::SharedPtr> & ready_timers)
+{
+  for (const auto & timer : ready_timers) {
+    if (on_ready_callback_) {
+      on_ready_callback_(timer);
+    } else {
+      timer->execute_callback();
+    }
+  }
+}
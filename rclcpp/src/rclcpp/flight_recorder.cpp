@@ -0,0 +1,479 @@
+// Copyright 2021 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "rclcpp/flight_recorder.hpp"
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include <mutex>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+using rclcpp::FlightRecorder;
+using rclcpp::FlightRecorderTopic;
+using rclcpp::RecordedMessage;
+
+namespace rclcpp
+{
+namespace detail
+{
+
+/// Start of a recording, followed by the topic table and the ring of the messages.
+struct FlightRecordingHeader
+{
+  char magic[8];
+  uint32_t version;
+  uint32_t topic_count;
+  /// Offset of the ring from the start of the recording.
+  uint64_t ring_offset;
+  /// Bytes of the ring.
+  uint64_t capacity;
+  /// Logical offset following the newest message, the ring offset modulo the capacity.
+  std::atomic<uint64_t> head;
+  /// Logical offset of the oldest message.
+  std::atomic<uint64_t> tail;
+};
+
+}  // namespace detail
+}  // namespace rclcpp
+
+using rclcpp::detail::FlightRecordingHeader;
+
+namespace
+{
+
+constexpr char recording_magic[8] = {'R', 'C', 'L', 'F', 'R', 'E', 'C', '\0'};
+constexpr uint32_t recording_version = 1;
+constexpr uint64_t record_alignment = 16;
+/// Topic index of the records filling the end of the ring, which a message did not fit in.
+constexpr uint32_t padding_topic_index = std::numeric_limits<uint32_t>::max();
+
+static_assert(
+  std::atomic<uint64_t>::is_always_lock_free,
+  "the atomics of the header must be lock free to be mapped to a file");
+
+/// Start of each record of the ring, followed by the serialized message.
+struct RecordHeader
+{
+  uint32_t size;
+  uint32_t topic_index;
+  rcl_time_point_value_t receive_time;
+};
+
+static_assert(sizeof(RecordHeader) == record_alignment, "records must stay aligned");
+
+uint64_t
+align(uint64_t size)
+{
+  return (size + record_alignment - 1) / record_alignment * record_alignment;
+}
+
+/// Bytes taken in the ring by a message of the given size.
+uint64_t
+record_stride(uint64_t size)
+{
+  return sizeof(RecordHeader) + align(size);
+}
+
+/// Bytes taken by the header and the topic table, where the ring starts.
+uint64_t
+get_ring_offset(const std::vector<FlightRecorderTopic> & topics)
+{
+  uint64_t size = sizeof(FlightRecordingHeader);
+  for (const FlightRecorderTopic & topic : topics) {
+    size += 2 * sizeof(uint32_t) + topic.name.size() + topic.type.size();
+  }
+  return align(size);
+}
+
+void
+write_topic_table(const std::vector<FlightRecorderTopic> & topics, uint8_t * table)
+{
+  for (const FlightRecorderTopic & topic : topics) {
+    const uint32_t sizes[2] = {
+      static_cast<uint32_t>(topic.name.size()), static_cast<uint32_t>(topic.type.size())};
+    std::memcpy(table, sizes, sizeof(sizes));
+    table += sizeof(sizes);
+    std::memcpy(table, topic.name.data(), topic.name.size());
+    table += topic.name.size();
+    std::memcpy(table, topic.type.data(), topic.type.size());
+    table += topic.type.size();
+  }
+}
+
+[[noreturn]] void
+throw_invalid_recording(const std::string & file_path, const char * reason)
+{
+  throw std::runtime_error("'" + file_path + "' is not a valid recording: " + reason);
+}
+
+}  // namespace
+
+FlightRecorder::FlightRecorder(
+  const std::vector<FlightRecorderTopic> & topics,
+  const FlightRecorderOptions & options)
+: topics_(topics),
+  duration_(options.duration),
+  base_(nullptr),
+  mapped_size_(0),
+  header_(nullptr),
+  ring_(nullptr),
+  capacity_(options.capacity / record_alignment * record_alignment),
+  number_of_messages_(0),
+  recorded_message_count_(0),
+  dropped_message_count_(0)
+{
+  if (topics_.empty()) {
+    throw std::invalid_argument("at least one topic must be recorded");
+  }
+  for (const FlightRecorderTopic & topic : topics_) {
+    if (
+      topic.name.size() > std::numeric_limits<uint32_t>::max() ||
+      topic.type.size() > std::numeric_limits<uint32_t>::max())
+    {
+      throw std::invalid_argument("topic names and types must be shorter than 4GiB");
+    }
+  }
+  if (capacity_ < 2 * sizeof(RecordHeader)) {
+    throw std::invalid_argument(
+            "capacity must be at least " + std::to_string(2 * sizeof(RecordHeader)) + " bytes");
+  }
+  if (duration_ <= std::chrono::nanoseconds(0)) {
+    throw std::invalid_argument("duration must be positive");
+  }
+
+  const uint64_t ring_offset = get_ring_offset(topics_);
+  mapped_size_ = static_cast<size_t>(ring_offset + capacity_);
+  if (options.file_path.empty()) {
+    // Zero filled, so that all the pages are allocated now.
+    memory_.resize(mapped_size_);
+    base_ = memory_.data();
+  } else {
+#if defined(_WIN32)
+    throw std::runtime_error(
+            "mapping a flight recorder to a file is not supported on this platform");
+#else
+    int fd = open(options.file_path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+      throw std::runtime_error(
+              "failed to create file '" + options.file_path + "': " + std::strerror(errno));
+    }
+    if (ftruncate(fd, static_cast<off_t>(mapped_size_)) != 0) {
+      const int error = errno;
+      close(fd);
+      throw std::runtime_error(
+              "failed to size file '" + options.file_path + "': " + std::strerror(error));
+    }
+    void * address = mmap(nullptr, mapped_size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (MAP_FAILED == address) {
+      throw std::runtime_error(
+              "failed to map file '" + options.file_path + "': " + std::strerror(errno));
+    }
+    base_ = static_cast<uint8_t *>(address);
+    // Allocate the pages of the file now rather than when recording.
+    std::memset(base_, 0, mapped_size_);
+#endif
+  }
+
+  header_ = new (base_) FlightRecordingHeader();
+  std::memcpy(header_->magic, recording_magic, sizeof(recording_magic));
+  header_->version = recording_version;
+  header_->topic_count = static_cast<uint32_t>(topics_.size());
+  header_->ring_offset = ring_offset;
+  header_->capacity = capacity_;
+  header_->head.store(0);
+  header_->tail.store(0);
+  write_topic_table(topics_, base_ + sizeof(FlightRecordingHeader));
+  ring_ = base_ + ring_offset;
+}
+
+FlightRecorder::~FlightRecorder()
+{
+#if !defined(_WIN32)
+  if (memory_.empty() && base_) {
+    munmap(base_, mapped_size_);
+  }
+#endif
+}
+
+void
+FlightRecorder::record(
+  size_t topic_index,
+  const rcl_serialized_message_t & serialized_message,
+  rcl_time_point_value_t receive_time)
+{
+  if (topic_index >= topics_.size()) {
+    throw std::out_of_range("topic index " + std::to_string(topic_index) + " is out of range");
+  }
+  const uint64_t size = serialized_message.buffer_length;
+  const uint64_t stride = record_stride(size);
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (size > std::numeric_limits<uint32_t>::max() || stride > capacity_) {
+    ++dropped_message_count_;
+    return;
+  }
+  uint64_t head = header_->head.load(std::memory_order_relaxed);
+  uint64_t position = head % capacity_;
+  if (position + stride > capacity_) {
+    // Fill the end of the ring, a record is never split.
+    const uint64_t padding = capacity_ - position;
+    reserve(padding);
+    const RecordHeader padding_record{
+      static_cast<uint32_t>(padding - sizeof(RecordHeader)), padding_topic_index, 0};
+    std::memcpy(ring_ + position, &padding_record, sizeof(padding_record));
+    head += padding;
+    header_->head.store(head, std::memory_order_release);
+    position = 0;
+  }
+  reserve(stride);
+  const RecordHeader record{
+    static_cast<uint32_t>(size), static_cast<uint32_t>(topic_index), receive_time};
+  std::memcpy(ring_ + position, &record, sizeof(record));
+  if (size > 0) {
+    std::memcpy(ring_ + position + sizeof(record), serialized_message.buffer, size);
+  }
+  // The record is complete before it is published, also for a reader after a crash.
+  header_->head.store(head + stride, std::memory_order_release);
+  ++number_of_messages_;
+  ++recorded_message_count_;
+}
+
+void
+FlightRecorder::reserve(uint64_t size)
+{
+  const uint64_t head = header_->head.load(std::memory_order_relaxed);
+  uint64_t tail = header_->tail.load(std::memory_order_relaxed);
+  while (head + size - tail > capacity_) {
+    RecordHeader record;
+    std::memcpy(&record, ring_ + tail % capacity_, sizeof(record));
+    tail += record_stride(record.size);
+    if (record.topic_index != padding_topic_index) {
+      --number_of_messages_;
+    }
+  }
+  // The records are dropped before they are overwritten.
+  header_->tail.store(tail, std::memory_order_release);
+}
+
+size_t
+FlightRecorder::dump(const std::string & file_path) const
+{
+  const rcl_time_point_value_t oldest_receive_time =
+    std::chrono::duration_cast<std::chrono::nanoseconds>(
+    std::chrono::system_clock::now().time_since_epoch() - duration_).count();
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  const uint64_t head = header_->head.load(std::memory_order_relaxed);
+  const uint64_t tail = header_->tail.load(std::memory_order_relaxed);
+
+  // The records older than the duration are skipped, the others are written in order.
+  auto is_dumped = [oldest_receive_time](const RecordHeader & record) {
+      return record.topic_index != padding_topic_index &&
+             record.receive_time >= oldest_receive_time;
+    };
+  uint64_t dump_size = 0;
+  size_t number_of_messages = 0;
+  for (uint64_t offset = tail; offset != head; ) {
+    RecordHeader record;
+    std::memcpy(&record, ring_ + offset % capacity_, sizeof(record));
+    const uint64_t stride = record_stride(record.size);
+    if (is_dumped(record)) {
+      dump_size += stride;
+      ++number_of_messages;
+    }
+    offset += stride;
+  }
+
+  std::ofstream file(file_path, std::ios::binary | std::ios::trunc);
+  if (!file) {
+    throw std::runtime_error("failed to create file '" + file_path + "'");
+  }
+  FlightRecordingHeader dump_header;
+  std::memcpy(dump_header.magic, recording_magic, sizeof(recording_magic));
+  dump_header.version = recording_version;
+  dump_header.topic_count = header_->topic_count;
+  dump_header.ring_offset = header_->ring_offset;
+  dump_header.capacity = dump_size;
+  dump_header.head.store(dump_size);
+  dump_header.tail.store(0);
+  file.write(reinterpret_cast<const char *>(&dump_header), sizeof(dump_header));
+  file.write(
+    reinterpret_cast<const char *>(base_ + sizeof(FlightRecordingHeader)),
+    static_cast<std::streamsize>(header_->ring_offset - sizeof(FlightRecordingHeader)));
+  for (uint64_t offset = tail; offset != head; ) {
+    RecordHeader record;
+    std::memcpy(&record, ring_ + offset % capacity_, sizeof(record));
+    const uint64_t stride = record_stride(record.size);
+    if (is_dumped(record)) {
+      file.write(
+        reinterpret_cast<const char *>(ring_ + offset % capacity_),
+        static_cast<std::streamsize>(stride));
+    }
+    offset += stride;
+  }
+  file.flush();
+  if (!file) {
+    throw std::runtime_error("failed to write file '" + file_path + "'");
+  }
+  return number_of_messages;
+}
+
+std::vector<RecordedMessage>
+FlightRecorder::read_recording(const std::string & file_path)
+{
+  std::ifstream file(file_path, std::ios::binary);
+  if (!file) {
+    throw std::runtime_error("failed to open file '" + file_path + "'");
+  }
+  const std::vector<char> bytes(
+    (std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+  if (bytes.size() < sizeof(FlightRecordingHeader)) {
+    throw_invalid_recording(file_path, "it is too short");
+  }
+
+  // Copy the fields one by one, the atomics of the header are not copyable.
+  const char * data = bytes.data();
+  char magic[sizeof(recording_magic)];
+  uint32_t version;
+  uint32_t topic_count;
+  uint64_t ring_offset;
+  uint64_t capacity;
+  uint64_t head;
+  uint64_t tail;
+  std::memcpy(magic, data + offsetof(FlightRecordingHeader, magic), sizeof(magic));
+  std::memcpy(&version, data + offsetof(FlightRecordingHeader, version), sizeof(version));
+  std::memcpy(
+    &topic_count, data + offsetof(FlightRecordingHeader, topic_count), sizeof(topic_count));
+  std::memcpy(
+    &ring_offset, data + offsetof(FlightRecordingHeader, ring_offset), sizeof(ring_offset));
+  std::memcpy(&capacity, data + offsetof(FlightRecordingHeader, capacity), sizeof(capacity));
+  std::memcpy(&head, data + offsetof(FlightRecordingHeader, head), sizeof(head));
+  std::memcpy(&tail, data + offsetof(FlightRecordingHeader, tail), sizeof(tail));
+  if (std::memcmp(magic, recording_magic, sizeof(magic)) != 0) {
+    throw_invalid_recording(file_path, "wrong magic number");
+  }
+  if (version != recording_version) {
+    throw_invalid_recording(file_path, "unsupported version");
+  }
+  if (
+    ring_offset > bytes.size() || capacity > bytes.size() - ring_offset ||
+    capacity % record_alignment != 0 || head < tail || head - tail > capacity)
+  {
+    throw_invalid_recording(file_path, "the ring is out of the file");
+  }
+
+  std::vector<FlightRecorderTopic> topics;
+  uint64_t table_offset = sizeof(FlightRecordingHeader);
+  for (uint32_t i = 0; i < topic_count; ++i) {
+    uint32_t sizes[2];
+    if (sizeof(sizes) > ring_offset - table_offset) {
+      throw_invalid_recording(file_path, "the topic table is truncated");
+    }
+    std::memcpy(sizes, data + table_offset, sizeof(sizes));
+    table_offset += sizeof(sizes);
+    if (uint64_t{sizes[0]} + sizes[1] > ring_offset - table_offset) {
+      throw_invalid_recording(file_path, "the topic table is truncated");
+    }
+    FlightRecorderTopic topic;
+    topic.name.assign(data + table_offset, sizes[0]);
+    table_offset += sizes[0];
+    topic.type.assign(data + table_offset, sizes[1]);
+    table_offset += sizes[1];
+    topics.push_back(std::move(topic));
+  }
+
+  std::vector<RecordedMessage> messages;
+  const char * ring = data + ring_offset;
+  for (uint64_t offset = tail; offset != head; ) {
+    const uint64_t position = offset % capacity;
+    RecordHeader record;
+    if (sizeof(record) > capacity - position) {
+      throw_invalid_recording(file_path, "a record is truncated");
+    }
+    std::memcpy(&record, ring + position, sizeof(record));
+    const uint64_t stride = record_stride(record.size);
+    if (stride > capacity - position || stride > head - offset) {
+      throw_invalid_recording(file_path, "a record is truncated");
+    }
+    offset += stride;
+    if (record.topic_index == padding_topic_index) {
+      continue;
+    }
+    if (record.topic_index >= topics.size()) {
+      throw_invalid_recording(file_path, "a record has an unknown topic");
+    }
+    rclcpp::SerializedMessage serialized_message(record.size);
+    auto & rcl_serialized_message = serialized_message.get_rcl_serialized_message();
+    if (record.size > 0) {
+      std::memcpy(rcl_serialized_message.buffer, ring + position + sizeof(record), record.size);
+    }
+    rcl_serialized_message.buffer_length = record.size;
+    messages.push_back(
+      {topics[record.topic_index].name, topics[record.topic_index].type, record.receive_time,
+        std::move(serialized_message)});
+  }
+  return messages;
+}
+
+const std::vector<FlightRecorderTopic> &
+FlightRecorder::get_topics() const
+{
+  return topics_;
+}
+
+size_t
+FlightRecorder::get_number_of_messages() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return number_of_messages_;
+}
+
+uint64_t
+FlightRecorder::get_recorded_message_count() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return recorded_message_count_;
+}
+
+uint64_t
+FlightRecorder::get_dropped_message_count() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return dropped_message_count_;
+}
+
+void
+FlightRecorder::set_subscriptions(std::vector<rclcpp::SubscriptionBase::SharedPtr> subscriptions)
+{
+  subscriptions_ = std::move(subscriptions);
+}
@@ -15,16 +15,116 @@
 
 #include "rclcpp/generic_publisher.hpp"
 
+#include <algorithm>
 #include <memory>
+#include <stdexcept>
 #include <string>
+#include <utility>
+
+#include "rcl/allocator.h"
+#include "rmw/serialized_message.h"
 
 namespace rclcpp
 {
 
 void GenericPublisher::publish(const rclcpp::SerializedMessage & message)
+{
+  if (!should_publish()) {
+    return;
+  }
+  if (!intra_process_is_enabled_ || get_cached_intra_process_subscription_count() == 0) {
+    do_inter_process_publish(message);
+    return;
+  }
+  do_shared_publish(std::make_shared<const rclcpp::SerializedMessage>(message));
+}
+
+void GenericPublisher::publish(std::shared_ptr<const rclcpp::SerializedMessage> message)
+{
+  if (!message) {
+    throw std::runtime_error("cannot publish msg which is a null pointer");
+  }
+  if (should_publish()) {
+    do_shared_publish(std::move(message));
+  }
+}
+
+void GenericPublisher::do_shared_publish(std::shared_ptr<const rclcpp::SerializedMessage> message)
+{
+  if (!intra_process_is_enabled_) {
+    do_inter_process_publish(*message);
+    return;
+  }
+
+  auto ipm = weak_ipm_.lock();
+  if (!ipm) {
+    throw std::runtime_error(
+            "intra process publish called after destruction of intra process manager");
+  }
+  // The typed subscriptions of the topic still receive the message through the middleware.
+  bool inter_process_publish_needed = has_inter_process_subscriptions();
+  std::allocator<rclcpp::SerializedMessage> allocator;
+  ipm->do_intra_process_publish_shared<rclcpp::SerializedMessage>(
+    intra_process_publisher_id_, message, allocator);
+  if (inter_process_publish_needed) {
+    do_inter_process_publish(*message);
+  }
+}
+
+void GenericPublisher::publish_chunks(size_t message_size, const ChunkWriter & write_chunk)
+{
+  if (!should_publish()) {
+    return;
+  }
+  auto message = std::make_shared<rclcpp::SerializedMessage>(message_size);
+  rcl_serialized_message_t & rcl_message = message->get_rcl_serialized_message();
+  while (rcl_message.buffer_length < message_size) {
+    const size_t written = write_chunk(
+      rcl_message.buffer + rcl_message.buffer_length,
+      message_size - rcl_message.buffer_length);
+    if (0 == written) {
+      throw std::runtime_error("the chunks of the serialized message end before the message");
+    }
+    rcl_message.buffer_length += std::min(written, message_size - rcl_message.buffer_length);
+  }
+  do_shared_publish(std::move(message));
+}
+
+void GenericPublisher::publish_buffer(const uint8_t * buffer, size_t size)
+{
+  if (!buffer) {
+    throw std::runtime_error("cannot publish a buffer which is a null pointer");
+  }
+  if (!should_publish()) {
+    return;
+  }
+  // The middleware only reads the message, which stays owned by the caller.
+  rcl_serialized_message_t rcl_message = rmw_get_zero_initialized_serialized_message();
+  rcl_message.buffer = const_cast<uint8_t *>(buffer);
+  rcl_message.buffer_length = size;
+  rcl_message.buffer_capacity = size;
+  rcl_message.allocator = rcl_get_default_allocator();
+  if (!intra_process_is_enabled_ || get_cached_intra_process_subscription_count() == 0) {
+    do_inter_process_publish(rcl_message);
+    return;
+  }
+  do_shared_publish(std::make_shared<const rclcpp::SerializedMessage>(rcl_message));
+}
+
+bool GenericPublisher::is_serialized() const
+{
+  return true;
+}
+
+void GenericPublisher::do_inter_process_publish(const rclcpp::SerializedMessage & message)
+{
+  do_inter_process_publish(message.get_rcl_serialized_message());
+}
+
+void GenericPublisher::do_inter_process_publish(const rcl_serialized_message_t & message)
 {
   auto return_code = rcl_publish_serialized_message(
-    get_publisher_handle().get(), &message.get_rcl_serialized_message(), NULL);
+    get_publisher_handle().get(), &message, NULL);
 
   if (return_code != RCL_RET_OK) {
     rclcpp::exceptions::throw_from_rcl_error(return_code, "failed to publish serialized message");
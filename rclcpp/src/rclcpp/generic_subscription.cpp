@@ -15,8 +15,12 @@
 
 #include "rclcpp/generic_subscription.hpp"
 
+#include <algorithm>
+#include <functional>
 #include <memory>
+#include <stdexcept>
 #include <string>
+#include <utility>
 
 #include "rcl/subscription.h"
 
@@ -32,7 +36,7 @@ std::shared_ptr<void> GenericSubscription::create_message()
 
 std::shared_ptr<rclcpp::SerializedMessage> GenericSubscription::create_serialized_message()
 {
-  return std::make_shared<rclcpp::SerializedMessage>(0);
+  return serialized_message_pool_.borrow_serialized_message();
 }
 
 void GenericSubscription::handle_message(
@@ -51,6 +55,44 @@ GenericSubscription::handle_serialized_message(
   callback_(message);
 }
 
+std::function<void(std::shared_ptr<rclcpp::SerializedMessage>)>
+GenericSubscription::filter_callback(
+  std::function<void(std::shared_ptr<rclcpp::SerializedMessage>)> callback,
+  std::function<bool(const rclcpp::SerializedMessage &)> filter)
+{
+  if (!filter) {
+    return callback;
+  }
+  return
+    [callback = std::move(callback), filter = std::move(filter)](
+    std::shared_ptr<rclcpp::SerializedMessage> message)
+    {
+      if (filter(*message)) {
+        callback(std::move(message));
+      }
+    };
+}
+
+std::function<void(std::shared_ptr<rclcpp::SerializedMessage>)>
+GenericSubscription::make_chunk_callback(ChunkCallback chunk_callback, size_t chunk_size)
+{
+  if (0 == chunk_size) {
+    throw std::invalid_argument("the chunks of the messages must not be empty");
+  }
+  return
+    [chunk_callback = std::move(chunk_callback), chunk_size](
+    std::shared_ptr<rclcpp::SerializedMessage> message)
+    {
+      const rcl_serialized_message_t & rcl_message = message->get_rcl_serialized_message();
+      const size_t message_size = rcl_message.buffer_length;
+      for (size_t offset = 0; offset < message_size; offset += chunk_size) {
+        chunk_callback(
+          rcl_message.buffer + offset, std::min(chunk_size, message_size - offset),
+          offset, message_size);
+      }
+    };
+}
+
 void GenericSubscription::handle_loaned_message(
   void * message, const rclcpp::MessageInfo & message_info)
 {
@@ -69,7 +111,7 @@ void GenericSubscription::return_message(std::shared_ptr<void> & message)
 void GenericSubscription::return_serialized_message(
   std::shared_ptr<rclcpp::SerializedMessage> & message)
 {
-  message.reset();
+  serialized_message_pool_.return_serialized_message(message);
 }
 
 }  // namespace rclcpp
@@ -0,0 +1,137 @@
+// Copyright 2021 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "rclcpp/graph_change_subscription.hpp"
+
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+using rclcpp::GraphChange;
+using rclcpp::GraphChangeSubscription;
+using rclcpp::GraphChangeType;
+
+GraphChangeSubscription::GraphChangeSubscription(
+  rclcpp::node_interfaces::NodeGraphInterface::SharedPtr node_graph,
+  const std::vector<std::string> & topic_names,
+  bool watch_nodes,
+  CallbackType callback)
+: node_graph_(std::move(node_graph)),
+  topic_names_(topic_names),
+  watch_nodes_(watch_nodes),
+  callback_(std::move(callback))
+{
+  if (!node_graph_) {
+    throw std::invalid_argument("node_graph cannot be null");
+  }
+  if (!callback_) {
+    throw std::invalid_argument("callback cannot be empty");
+  }
+  // Get the graph event first, so that no change is missed after the first snapshot.
+  graph_event_ = node_graph_->get_graph_event();
+  snapshot_ = take_snapshot();
+}
+
+bool
+GraphChangeSubscription::add_to_wait_set(rcl_wait_set_t * wait_set)
+{
+  (void) wait_set;
+  return true;
+}
+
+bool
+GraphChangeSubscription::is_ready(rcl_wait_set_t * wait_set)
+{
+  (void) wait_set;
+  return graph_event_->check();
+}
+
+std::shared_ptr<void>
+GraphChangeSubscription::take_data()
+{
+  std::lock_guard<std::mutex> lock(snapshot_mutex_);
+  if (!graph_event_->check_and_clear()) {
+    return nullptr;
+  }
+  Snapshot snapshot = take_snapshot();
+  auto changes = std::make_shared<std::vector<GraphChange>>();
+
+  for (const auto & node : snapshot.nodes) {
+    if (snapshot_.nodes.count(node) == 0) {
+      changes->push_back({GraphChangeType::NodeAdded, node.second, node.first, "", std::nullopt});
+    }
+  }
+  for (const auto & endpoint : snapshot.endpoints) {
+    if (snapshot_.endpoints.count(endpoint.first) == 0) {
+      const auto & info = endpoint.second.second;
+      changes->push_back(
+        {GraphChangeType::EndpointAdded, info.node_name(), info.node_namespace(),
+          endpoint.second.first, info});
+    }
+  }
+  for (const auto & endpoint : snapshot_.endpoints) {
+    if (snapshot.endpoints.count(endpoint.first) == 0) {
+      const auto & info = endpoint.second.second;
+      changes->push_back(
+        {GraphChangeType::EndpointRemoved, info.node_name(), info.node_namespace(),
+          endpoint.second.first, info});
+    }
+  }
+  for (const auto & node : snapshot_.nodes) {
+    if (snapshot.nodes.count(node) == 0) {
+      changes->push_back({GraphChangeType::NodeRemoved, node.second, node.first, "", std::nullopt});
+    }
+  }
+
+  snapshot_ = std::move(snapshot);
+  return changes;
+}
+
+void
+GraphChangeSubscription::execute(std::shared_ptr<void> & data)
+{
+  if (!data) {
+    return;
+  }
+  auto changes = std::static_pointer_cast<std::vector<GraphChange>>(data);
+  if (!changes->empty()) {
+    callback_(*changes);
+  }
+}
+
+GraphChangeSubscription::Snapshot
+GraphChangeSubscription::take_snapshot() const
+{
+  Snapshot snapshot;
+  if (watch_nodes_) {
+    for (const auto & name_and_namespace : node_graph_->get_node_names_and_namespaces()) {
+      // Keyed by namespace first, so that the nodes of a namespace are next to each other.
+      snapshot.nodes.emplace(name_and_namespace.second, name_and_namespace.first);
+    }
+  }
+  for (const auto & topic_name : topic_names_) {
+    for (auto && info : node_graph_->get_publishers_info_by_topic(topic_name)) {
+      Gid gid = info.endpoint_gid();
+      snapshot.endpoints.emplace(gid, std::make_pair(topic_name, std::move(info)));
+    }
+    for (auto && info : node_graph_->get_subscriptions_info_by_topic(topic_name)) {
+      Gid gid = info.endpoint_gid();
+      snapshot.endpoints.emplace(gid, std::make_pair(topic_name, std::move(info)));
+    }
+  }
+  return snapshot;
+}
@@ -14,6 +14,7 @@
 
 #include "rclcpp/graph_listener.hpp"
 
+#include <algorithm>
 #include <cstdio>
 #include <exception>
 #include <memory>
@@ -165,22 +166,42 @@ GraphListener::run_loop()
     }
 
     // Put graph guard conditions for each node into the wait set.
-    std::vector<size_t> graph_gc_indexes(node_graph_interfaces_size, 0u);
+    // The guard conditions were looked up when the nodes were added, and
+    // wait_set_nodes_ keeps its capacity, so nothing is allocated here.
+    // They still need to be added on every iteration, as rcl_wait() sets the
+    // entries which were not triggered to NULL, and as a node may gain or lose
+    // graph users at any time.
+    wait_set_nodes_.clear();
     for (size_t i = 0u; i < node_graph_interfaces_size; ++i) {
       auto node_ptr = node_graph_interfaces_[i];
       // Only wait on graph changes if some user of the node is watching.
       if (node_ptr->count_graph_users() == 0) {
         continue;
       }
-      // Add the graph guard condition for the node to the wait set.
-      auto graph_gc = node_ptr->get_graph_guard_condition();
-      if (!graph_gc) {
-        throw_from_rcl_error(RCL_RET_ERROR, "failed to get graph guard condition");
-      }
-      ret = rcl_wait_set_add_guard_condition(&wait_set_, graph_gc, &graph_gc_indexes[i]);
-      if (RCL_RET_OK != ret) {
-        throw_from_rcl_error(ret, "failed to add graph guard condition to wait set");
+      // Add the graph guard condition for the node to the wait set, once for
+      // the nodes sharing their rcl node handle, see NodeOptions::shared_rcl_node_handle().
+      size_t index = 0u;
+      auto added = std::find_if(
+        wait_set_nodes_.begin(), wait_set_nodes_.end(),
+        [this, i](const auto & index_and_node) {
+          return wait_set_.guard_conditions[index_and_node.first] == graph_guard_conditions_[i];
+        });
+      if (added != wait_set_nodes_.end()) {
+        index = added->first;
+      } else {
+        ret = rcl_wait_set_add_guard_condition(&wait_set_, graph_guard_conditions_[i], &index);
+        if (RCL_RET_OK != ret) {
+          throw_from_rcl_error(ret, "failed to add graph guard condition to wait set");
+        }
       }
+      wait_set_nodes_.emplace_back(index, node_ptr);
+    }
+
+    // Graph changes are noticed only while waiting on the graph guard condition of a node.
+    if (wait_set_nodes_.empty()) {
+      graph_generation_.store(0, std::memory_order_release);
+    } else if (graph_generation_.load(std::memory_order_relaxed) == 0) {
+      graph_generation_.store(++graph_change_count_, std::memory_order_release);
     }
 
     // Wait for: graph changes, interrupt, or shutdown/SIGINT
@@ -192,18 +213,21 @@ GraphListener::run_loop()
       throw_from_rcl_error(ret, "failed to wait on wait set");
     }
 
-    // Notify nodes who's guard conditions are set (triggered).
-    for (size_t i = 0u; i < node_graph_interfaces_size; ++i) {
-      const auto node_ptr = node_graph_interfaces_[i];
-      auto graph_gc = node_ptr->get_graph_guard_condition();
-      if (!graph_gc) {
-        throw_from_rcl_error(RCL_RET_ERROR, "failed to get graph guard condition");
-      }
-      if (graph_gc == wait_set_.guard_conditions[graph_gc_indexes[i]]) {
-        node_ptr->notify_graph_change();
+    // Notify nodes who's guard conditions are set (triggered), only looking at
+    // the entries of the nodes which were put in the wait set.
+    bool graph_changed = false;
+    for (const auto & index_and_node : wait_set_nodes_) {
+      if (wait_set_.guard_conditions[index_and_node.first]) {
+        graph_changed = true;
+        index_and_node.second->notify_graph_change();
       }
-      if (is_shutdown_) {
-        // If shutdown, then notify the node of this as well.
+    }
+    if (graph_changed) {
+      graph_generation_.store(++graph_change_count_, std::memory_order_release);
+    }
+    if (is_shutdown_) {
+      // If shutdown, then notify the nodes of this as well.
+      for (const auto node_ptr : node_graph_interfaces_) {
         node_ptr->notify_shutdown();
       }
     }
@@ -287,7 +311,14 @@ GraphListener::add_node(rclcpp::node_interfaces::NodeGraphInterface * node_graph
   if (has_node_(&node_graph_interfaces_, node_graph)) {
     throw NodeAlreadyAddedError();
   }
+  // Look up the graph guard condition once, rather than on each iteration of the run loop.
+  auto graph_gc = node_graph->get_graph_guard_condition();
+  if (!graph_gc) {
+    throw_from_rcl_error(RCL_RET_ERROR, "failed to get graph guard condition");
+  }
   node_graph_interfaces_.push_back(node_graph);
+  graph_guard_conditions_.push_back(graph_gc);
+  wait_set_nodes_.reserve(node_graph_interfaces_.size());
   // The run loop has already been interrupted by acquire_nodes_lock_() and
   // will evaluate the new node when nodes_lock releases the node_graph_interfaces_mutex_.
 }
@@ -295,13 +326,15 @@ GraphListener::add_node(rclcpp::node_interfaces::NodeGraphInterface * node_graph
 static void
 remove_node_(
   std::vector<rclcpp::node_interfaces::NodeGraphInterface *> * node_graph_interfaces,
+  std::vector<const rcl_guard_condition_t *> * graph_guard_conditions,
   rclcpp::node_interfaces::NodeGraphInterface * node_graph)
 {
   // Remove the node if it is found.
-  for (auto it = node_graph_interfaces->begin(); it != node_graph_interfaces->end(); ++it) {
-    if (node_graph == *it) {
-      // Found the node, remove it.
-      node_graph_interfaces->erase(it);
+  for (size_t i = 0u; i < node_graph_interfaces->size(); ++i) {
+    if (node_graph == (*node_graph_interfaces)[i]) {
+      // Found the node, remove it and its graph guard condition.
+      node_graph_interfaces->erase(node_graph_interfaces->begin() + i);
+      graph_guard_conditions->erase(graph_guard_conditions->begin() + i);
       // Now trigger the interrupt guard condition to make sure
       return;
     }
@@ -319,7 +352,7 @@ GraphListener::remove_node(rclcpp::node_interfaces::NodeGraphInterface * node_gr
   std::lock_guard<std::mutex> shutdown_lock(shutdown_mutex_);
   if (is_shutdown()) {
     // If shutdown, then the run loop has been joined, so we can remove them directly.
-    return remove_node_(&node_graph_interfaces_, node_graph);
+    return remove_node_(&node_graph_interfaces_, &graph_guard_conditions_, node_graph);
   }
   // Otherwise, first interrupt and lock against the run loop to safely remove the node.
   // Acquire the nodes mutex using the barrier to prevent the run loop from
@@ -330,7 +363,7 @@ GraphListener::remove_node(rclcpp::node_interfaces::NodeGraphInterface * node_gr
     &interrupt_guard_condition_);
   // Store the now acquired node_graph_interfaces_mutex_ in the scoped lock using adopt_lock.
   std::lock_guard<std::mutex> nodes_lock(node_graph_interfaces_mutex_, std::adopt_lock);
-  remove_node_(&node_graph_interfaces_, node_graph);
+  remove_node_(&node_graph_interfaces_, &graph_guard_conditions_, node_graph);
 }
 
 void
@@ -350,6 +383,8 @@ GraphListener::__shutdown()
     if (is_started_) {
       interrupt_(&interrupt_guard_condition_);
       listener_thread_.join();
+      // Graph changes are not noticed anymore.
+      graph_generation_.store(0, std::memory_order_release);
     }
     rcl_ret_t ret = rcl_guard_condition_fini(&interrupt_guard_condition_);
     if (RCL_RET_OK != ret) {
@@ -14,6 +14,8 @@
 
 #include "rclcpp/init_options.hpp"
 
+#include <stdexcept>
+
 #include "rclcpp/exceptions.hpp"
 #include "rclcpp/logging.hpp"
 
@@ -45,6 +47,12 @@ InitOptions::InitOptions(const InitOptions & other)
 {
   shutdown_on_sigint = other.shutdown_on_sigint;
   initialize_logging_ = other.initialize_logging_;
+  reusable_context_ = other.reusable_context_;
+  sigint_shutdown_deadline_ = other.sigint_shutdown_deadline_;
+  startup_profiling_ = other.startup_profiling_;
+  allocation_tracking_ = other.allocation_tracking_;
+  async_logging_ = other.async_logging_;
+  worker_pool_ = other.worker_pool_;
 }
 
 bool
@@ -60,6 +68,87 @@ InitOptions::auto_initialize_logging(bool initialize_logging)
   return *this;
 }
 
+bool
+InitOptions::reusable_context() const
+{
+  return reusable_context_;
+}
+
+InitOptions &
+InitOptions::reusable_context(bool reusable_context)
+{
+  reusable_context_ = reusable_context;
+  return *this;
+}
+
+std::chrono::nanoseconds
+InitOptions::sigint_shutdown_deadline() const
+{
+  return sigint_shutdown_deadline_;
+}
+
+InitOptions &
+InitOptions::sigint_shutdown_deadline(std::chrono::nanoseconds sigint_shutdown_deadline)
+{
+  sigint_shutdown_deadline_ = sigint_shutdown_deadline;
+  return *this;
+}
+
+const allocation_tracking::AllocationTrackingOptions &
+InitOptions::allocation_tracking() const
+{
+  return allocation_tracking_;
+}
+
+InitOptions &
+InitOptions::allocation_tracking(const allocation_tracking::AllocationTrackingOptions & options)
+{
+  allocation_tracking_ = options;
+  return *this;
+}
+
+bool
+InitOptions::startup_profiling() const
+{
+  return startup_profiling_;
+}
+
+InitOptions &
+InitOptions::startup_profiling(bool startup_profiling)
+{
+  startup_profiling_ = startup_profiling;
+  return *this;
+}
+
+const async_logging::AsyncLoggingOptions &
+InitOptions::async_logging() const
+{
+  return async_logging_;
+}
+
+InitOptions &
+InitOptions::async_logging(const async_logging::AsyncLoggingOptions & options)
+{
+  if (options.capacity == 0 || options.max_message_size == 0) {
+    throw std::invalid_argument("async logging capacity and max_message_size must be non zero");
+  }
+  async_logging_ = options;
+  return *this;
+}
+
+const rclcpp::WorkerPoolOptions &
+InitOptions::worker_pool() const
+{
+  return worker_pool_;
+}
+
+InitOptions &
+InitOptions::worker_pool(const WorkerPoolOptions & options)
+{
+  worker_pool_ = options;
+  return *this;
+}
+
 InitOptions &
 InitOptions::operator=(const InitOptions & other)
 {
@@ -72,6 +161,12 @@ InitOptions::operator=(const InitOptions & other)
     }
     this->shutdown_on_sigint = other.shutdown_on_sigint;
     this->initialize_logging_ = other.initialize_logging_;
+    this->reusable_context_ = other.reusable_context_;
+    this->sigint_shutdown_deadline_ = other.sigint_shutdown_deadline_;
+    this->startup_profiling_ = other.startup_profiling_;
+    this->allocation_tracking_ = other.allocation_tracking_;
+    this->async_logging_ = other.async_logging_;
+    this->worker_pool_ = other.worker_pool_;
   }
   return *this;
 }
@@ -14,9 +14,14 @@
 
 #include "rclcpp/experimental/intra_process_manager.hpp"
 
+#include <algorithm>
 #include <atomic>
 #include <memory>
 #include <mutex>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
 
 namespace rclcpp
 {
@@ -26,6 +31,7 @@ namespace experimental
 static std::atomic<uint64_t> _next_unique_id {1};
 
 IntraProcessManager::IntraProcessManager()
+: routing_snapshot_(std::make_unique<RoutingTable>())
 {}
 
 IntraProcessManager::~IntraProcessManager()
@@ -33,6 +39,15 @@ IntraProcessManager::~IntraProcessManager()
 
 uint64_t
 IntraProcessManager::add_publisher(rclcpp::PublisherBase::SharedPtr publisher)
+{
+  return add_publisher(std::move(publisher), nullptr);
+}
+
+uint64_t
+IntraProcessManager::add_publisher(
+  rclcpp::PublisherBase::SharedPtr publisher,
+  SubscriptionCaster caster,
+  SubscriptionCaster custom_type_caster)
 {
   std::unique_lock<std::shared_timed_mutex> lock(mutex_);
 
@@ -42,18 +57,27 @@ IntraProcessManager::add_publisher(rclcpp::PublisherBase::SharedPtr publisher)
 
   // Initialize the subscriptions storage for this publisher.
   pub_to_subs_[pub_id] = SplittedSubscriptions();
+  pub_to_subs_[pub_id].caster = caster;
+  pub_to_subs_[pub_id].custom_type_caster = custom_type_caster;
 
   // create an entry for the publisher id and populate with already existing subscriptions
-  for (auto & pair : subscriptions_) {
-    auto subscription = pair.second.lock();
+  TopicEntities & topic = index_entity(pub_id, publisher->get_topic_name());
+  topic.publisher_ids.push_back(pub_id);
+  for (uint64_t sub_id : topic.subscription_ids) {
+    auto subscription_it = subscriptions_.find(sub_id);
+    if (subscription_it == subscriptions_.end()) {
+      continue;
+    }
+    auto subscription = subscription_it->second.lock();
     if (!subscription) {
       continue;
     }
     if (can_communicate(publisher, subscription)) {
-      uint64_t sub_id = pair.first;
       insert_sub_id_for_pub(sub_id, pub_id, subscription->use_take_shared_method());
     }
   }
+  update_routing(pub_id);
+  publish_routing();
 
   return pub_id;
 }
@@ -67,17 +91,24 @@ IntraProcessManager::add_subscription(SubscriptionIntraProcessBase::SharedPtr su
 
   subscriptions_[sub_id] = subscription;
 
-  // adds the subscription id to all the matchable publishers
-  for (auto & pair : publishers_) {
-    auto publisher = pair.second.lock();
+  // adds the subscription id to all the matchable publishers, which are on the same topic
+  TopicEntities & topic = index_entity(sub_id, subscription->get_topic_name());
+  topic.subscription_ids.push_back(sub_id);
+  for (uint64_t pub_id : topic.publisher_ids) {
+    auto publisher_it = publishers_.find(pub_id);
+    if (publisher_it == publishers_.end()) {
+      continue;
+    }
+    auto publisher = publisher_it->second.lock();
     if (!publisher) {
       continue;
     }
     if (can_communicate(publisher, subscription)) {
-      uint64_t pub_id = pair.first;
       insert_sub_id_for_pub(sub_id, pub_id, subscription->use_take_shared_method());
+      update_routing(pub_id);
     }
   }
+  publish_routing();
 
   return sub_id;
 }
@@ -89,21 +120,47 @@ IntraProcessManager::remove_subscription(uint64_t intra_process_subscription_id)
 
   subscriptions_.erase(intra_process_subscription_id);
 
-  for (auto & pair : pub_to_subs_) {
-    pair.second.take_shared_subscriptions.erase(
+  // Only the publishers of its topic may have been matched with the subscription.
+  TopicEntities * topic = unindex_entity(intra_process_subscription_id);
+  if (!topic) {
+    return;
+  }
+  for (uint64_t pub_id : topic->publisher_ids) {
+    auto subscriptions_it = pub_to_subs_.find(pub_id);
+    if (subscriptions_it == pub_to_subs_.end()) {
+      continue;
+    }
+    auto & sub_ids = subscriptions_it->second;
+    const size_t previous_count =
+      sub_ids.take_shared_subscriptions.size() +
+      sub_ids.take_ownership_subscriptions.size();
+
+    sub_ids.take_shared_subscriptions.erase(
       std::remove(
-        pair.second.take_shared_subscriptions.begin(),
-        pair.second.take_shared_subscriptions.end(),
+        sub_ids.take_shared_subscriptions.begin(),
+        sub_ids.take_shared_subscriptions.end(),
         intra_process_subscription_id),
-      pair.second.take_shared_subscriptions.end());
+      sub_ids.take_shared_subscriptions.end());
 
-    pair.second.take_ownership_subscriptions.erase(
+    sub_ids.take_ownership_subscriptions.erase(
       std::remove(
-        pair.second.take_ownership_subscriptions.begin(),
-        pair.second.take_ownership_subscriptions.end(),
+        sub_ids.take_ownership_subscriptions.begin(),
+        sub_ids.take_ownership_subscriptions.end(),
         intra_process_subscription_id),
-      pair.second.take_ownership_subscriptions.end());
+      sub_ids.take_ownership_subscriptions.end());
+
+    const size_t count =
+      sub_ids.take_shared_subscriptions.size() +
+      sub_ids.take_ownership_subscriptions.size();
+    if (count != previous_count) {
+      update_routing(pub_id);
+    }
+  }
+  if (topic->publisher_ids.empty() && topic->subscription_ids.empty()) {
+    topics_.erase(entity_topics_.at(intra_process_subscription_id));
   }
+  entity_topics_.erase(intra_process_subscription_id);
+  publish_routing();
 }
 
 void
@@ -113,6 +170,13 @@ IntraProcessManager::remove_publisher(uint64_t intra_process_publisher_id)
 
   publishers_.erase(intra_process_publisher_id);
   pub_to_subs_.erase(intra_process_publisher_id);
+  routing_.erase(intra_process_publisher_id);
+  TopicEntities * topic = unindex_entity(intra_process_publisher_id);
+  if (topic && topic->publisher_ids.empty() && topic->subscription_ids.empty()) {
+    topics_.erase(entity_topics_.at(intra_process_publisher_id));
+  }
+  entity_topics_.erase(intra_process_publisher_id);
+  publish_routing();
 }
 
 bool
@@ -132,6 +196,33 @@ IntraProcessManager::matches_any_publishers(const rmw_gid_t * id) const
   return false;
 }
 
+bool
+IntraProcessManager::matches_any_publishers(
+  const rmw_gid_t * id,
+  uint64_t intra_process_subscription_id) const
+{
+  std::shared_lock<std::shared_timed_mutex> lock(mutex_);
+
+  for (auto & publisher_pair : publishers_) {
+    auto publisher = publisher_pair.second.lock();
+    if (!publisher || !(*publisher.get() == id)) {
+      continue;
+    }
+    auto subscriptions_it = pub_to_subs_.find(publisher_pair.first);
+    if (subscriptions_it == pub_to_subs_.end()) {
+      return false;
+    }
+    const auto & shared_ids = subscriptions_it->second.take_shared_subscriptions;
+    const auto & ownership_ids = subscriptions_it->second.take_ownership_subscriptions;
+    return
+      std::find(shared_ids.begin(), shared_ids.end(), intra_process_subscription_id) !=
+      shared_ids.end() ||
+      std::find(ownership_ids.begin(), ownership_ids.end(), intra_process_subscription_id) !=
+      ownership_ids.end();
+  }
+  return false;
+}
+
 size_t
 IntraProcessManager::get_subscription_count(uint64_t intra_process_publisher_id) const
 {
@@ -153,6 +244,106 @@ IntraProcessManager::get_subscription_count(uint64_t intra_process_publisher_id)
   return count;
 }
 
+size_t
+IntraProcessManager::get_accepting_subscription_count(uint64_t intra_process_publisher_id) const
+{
+  auto routing_table = routing_snapshot_.read();
+
+  auto publisher_it = routing_table->find(intra_process_publisher_id);
+  if (publisher_it == routing_table->end()) {
+    // Publisher is either invalid or no longer exists.
+    RCLCPP_WARN(
+      rclcpp::get_logger("rclcpp"),
+      "Calling get_accepting_subscription_count for invalid or no longer existing publisher id");
+    return 0;
+  }
+
+  size_t count = 0;
+  for (const auto & cached_subscription : publisher_it->second->get_subscriptions()) {
+    if (cached_subscription.subscription->is_accepting_messages()) {
+      ++count;
+    }
+  }
+  return count;
+}
+
+std::vector<IntraProcessConnection>
+IntraProcessManager::get_connections() const
+{
+  std::vector<IntraProcessConnection> connections;
+  {
+    std::shared_lock<std::shared_timed_mutex> lock(mutex_);
+    for (const auto & pub_subs : pub_to_subs_) {
+      auto publisher_it = publishers_.find(pub_subs.first);
+      if (publisher_it == publishers_.end()) {
+        continue;
+      }
+      auto publisher = publisher_it->second.lock();
+      if (!publisher) {
+        continue;
+      }
+      const std::string topic_name = publisher->get_topic_name();
+      for (uint64_t sub_id : pub_subs.second.take_shared_subscriptions) {
+        connections.push_back({topic_name, pub_subs.first, sub_id, true});
+      }
+      for (uint64_t sub_id : pub_subs.second.take_ownership_subscriptions) {
+        connections.push_back({topic_name, pub_subs.first, sub_id, false});
+      }
+    }
+  }
+  std::sort(
+    connections.begin(), connections.end(),
+    [](const IntraProcessConnection & a, const IntraProcessConnection & b) {
+      return std::tie(a.topic_name, a.publisher_id, a.subscription_id) <
+      std::tie(b.topic_name, b.publisher_id, b.subscription_id);
+    });
+  return connections;
+}
+
+uint64_t
+IntraProcessManager::add_service(ServiceIntraProcessBase::SharedPtr service)
+{
+  std::unique_lock<std::shared_timed_mutex> lock(mutex_);
+
+  uint64_t service_id = IntraProcessManager::get_next_unique_id();
+  services_[service_id] = service;
+  return service_id;
+}
+
+void
+IntraProcessManager::remove_service(uint64_t intra_process_service_id)
+{
+  std::unique_lock<std::shared_timed_mutex> lock(mutex_);
+
+  services_.erase(intra_process_service_id);
+}
+
+ServiceIntraProcessBase::SharedPtr
+IntraProcessManager::get_service_intra_process(uint64_t intra_process_service_id) const
+{
+  std::shared_lock<std::shared_timed_mutex> lock(mutex_);
+
+  auto service_it = services_.find(intra_process_service_id);
+  if (service_it == services_.end()) {
+    return nullptr;
+  }
+  return service_it->second.lock();
+}
+
+ServiceIntraProcessBase::SharedPtr
+IntraProcessManager::find_service_intra_process(const std::string & service_name) const
+{
+  std::shared_lock<std::shared_timed_mutex> lock(mutex_);
+
+  for (const auto & service_pair : services_) {
+    auto service = service_pair.second.lock();
+    if (service && service_name == service->get_service_name()) {
+      return service;
+    }
+  }
+  return nullptr;
+}
+
 SubscriptionIntraProcessBase::SharedPtr
 IntraProcessManager::get_subscription_intra_process(uint64_t intra_process_subscription_id)
 {
@@ -194,17 +385,106 @@ IntraProcessManager::get_next_unique_id()
   return next_id;
 }
 
+IntraProcessManager::TopicEntities &
+IntraProcessManager::index_entity(uint64_t entity_id, const std::string & topic_name)
+{
+  entity_topics_[entity_id] = topic_name;
+  return topics_[topic_name];
+}
+
+IntraProcessManager::TopicEntities *
+IntraProcessManager::unindex_entity(uint64_t entity_id)
+{
+  auto entity_topic_it = entity_topics_.find(entity_id);
+  if (entity_topic_it == entity_topics_.end()) {
+    return nullptr;
+  }
+  auto topic_it = topics_.find(entity_topic_it->second);
+  if (topic_it == topics_.end()) {
+    return nullptr;
+  }
+  auto remove_id = [entity_id](std::vector<uint64_t> & ids) {
+      ids.erase(std::remove(ids.begin(), ids.end(), entity_id), ids.end());
+    };
+  remove_id(topic_it->second.publisher_ids);
+  remove_id(topic_it->second.subscription_ids);
+  return &topic_it->second;
+}
+
 void
 IntraProcessManager::insert_sub_id_for_pub(
   uint64_t sub_id,
   uint64_t pub_id,
   bool use_take_shared_method)
 {
+  auto & sub_ids = pub_to_subs_[pub_id];
   if (use_take_shared_method) {
-    pub_to_subs_[pub_id].take_shared_subscriptions.push_back(sub_id);
+    sub_ids.take_shared_subscriptions.push_back(sub_id);
   } else {
-    pub_to_subs_[pub_id].take_ownership_subscriptions.push_back(sub_id);
+    sub_ids.take_ownership_subscriptions.push_back(sub_id);
+  }
+}
+
+void
+IntraProcessManager::update_routing(uint64_t pub_id)
+{
+  const auto & sub_ids = pub_to_subs_[pub_id];
+  auto routing = std::make_shared<PublisherRouting>();
+  routing->caster = sub_ids.caster;
+  routing->custom_type_subscriptions.caster = sub_ids.custom_type_caster;
+  routing->ros_message_subscriptions.caster = sub_ids.caster;
+  auto publisher_it = publishers_.find(pub_id);
+  if (publisher_it != publishers_.end()) {
+    auto publisher = publisher_it->second.lock();
+    if (publisher) {
+      routing->publisher_gid = publisher->get_gid();
+      // Read on the publish path without taking the lock of the intra process manager.
+      publisher->intra_process_subscription_count_.store(
+        sub_ids.take_shared_subscriptions.size() + sub_ids.take_ownership_subscriptions.size(),
+        std::memory_order_relaxed);
+    }
   }
+  auto cache_subscriptions =
+    [this, &routing, &sub_ids](const std::vector<uint64_t> & subscription_ids) {
+      for (auto id : subscription_ids) {
+        auto subscription_it = subscriptions_.find(id);
+        if (subscription_it == subscriptions_.end()) {
+          continue;
+        }
+        auto subscription = subscription_it->second.lock();
+        if (!subscription) {
+          continue;
+        }
+        void * typed_subscription = routing->caster ? routing->caster(subscription.get()) : nullptr;
+        if (sub_ids.custom_type_caster) {
+          void * custom_type_subscription = sub_ids.custom_type_caster(subscription.get());
+          if (custom_type_subscription) {
+            routing->custom_type_subscriptions.cached_subscriptions.push_back(
+              {subscription, custom_type_subscription});
+          } else {
+            routing->ros_message_subscriptions.cached_subscriptions.push_back(
+              {subscription, typed_subscription});
+          }
+        }
+        routing->message_info_requested |= subscription->records_message_info();
+        routing->cached_subscriptions.push_back({std::move(subscription), typed_subscription});
+      }
+    };
+  cache_subscriptions(sub_ids.take_shared_subscriptions);
+  routing->number_of_take_shared_subscriptions = routing->cached_subscriptions.size();
+  routing->custom_type_subscriptions.number_of_take_shared_subscriptions =
+    routing->custom_type_subscriptions.cached_subscriptions.size();
+  routing->ros_message_subscriptions.number_of_take_shared_subscriptions =
+    routing->ros_message_subscriptions.cached_subscriptions.size();
+  cache_subscriptions(sub_ids.take_ownership_subscriptions);
+  routing_[pub_id] = std::move(routing);
+}
+
+void
+IntraProcessManager::publish_routing()
+{
+  // The routing of each publisher is shared with the previous snapshot, only the table is copied.
+  routing_snapshot_.update(std::make_unique<RoutingTable>(routing_));
 }
 
 bool
@@ -217,6 +497,11 @@ IntraProcessManager::can_communicate(
     return false;
   }
 
+  // serialized messages are not deserialized, nor typed messages serialized, intra-process
+  if (pub->is_serialized() != sub->is_serialized()) {
+    return false;
+  }
+
   auto check_result = rclcpp::qos_check_compatible(pub->get_actual_qos(), sub->get_actual_qos());
   if (check_result.compatibility == rclcpp::QoSCompatibility::Error) {
     return false;
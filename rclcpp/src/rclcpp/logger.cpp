@@ -12,9 +12,12 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <atomic>
+#include <cstdint>
 #include <string>
 
 #include "rcl_logging_interface/rcl_logging_interface.h"
+#include "rcutils/error_handling.h"
 
 #include "rclcpp/exceptions.hpp"
 #include "rclcpp/logger.hpp"
@@ -23,6 +26,11 @@
 namespace rclcpp
 {
 
+namespace detail
+{
+std::atomic<uint32_t> logger_levels_generation{1};
+}  // namespace detail
+
 Logger
 get_logger(const std::string & name)
 {
@@ -62,6 +70,33 @@ get_logging_directory()
   return path;
 }
 
+void
+reset_logger_level_caches()
+{
+  // Skip 0 on overflow, as it is the generation of the empty caches.
+  if (0u == detail::logger_levels_generation.fetch_add(1) + 1u) {
+    detail::logger_levels_generation.fetch_add(1);
+  }
+}
+
+bool
+Logger::update_level_cache(int severity) const
+{
+  // Read before the level, so that a concurrent change invalidates what is cached.
+  uint32_t generation = detail::logger_levels_generation.load();
+  RCUTILS_LOGGING_AUTOINIT;
+  int level = rcutils_logging_get_logger_effective_level(get_name());
+  if (level < 0) {
+    // Let rcutils decide, and report the error.
+    rcutils_reset_error();
+    return true;
+  }
+  state_->level_cache.store(
+    (static_cast<uint64_t>(generation) << 32) | static_cast<uint32_t>(level),
+    std::memory_order_relaxed);
+  return severity >= level;
+}
+
 void
 Logger::set_level(Level level)
 {
@@ -78,6 +113,7 @@ Logger::set_level(Level level)
       RCL_RET_ERROR, "Couldn't set logger level",
       rcutils_get_error_state(), rcutils_reset_error);
   }
+  reset_logger_level_caches();
 }
 
 }  // namespace rclcpp
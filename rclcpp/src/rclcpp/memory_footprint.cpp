@@ -0,0 +1,153 @@
+// Copyright 2021 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "rclcpp/memory_footprint.hpp"
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "rclcpp/callback_group.hpp"
+#include "rclcpp/node_interfaces/node_base_interface.hpp"
+#include "rclcpp/node_interfaces/node_parameters.hpp"
+#include "rclcpp/node_interfaces/node_parameters_interface.hpp"
+#include "rclcpp/parameter_value.hpp"
+#include "rclcpp/subscription_base.hpp"
+
+namespace
+{
+
+size_t
+get_string_size(const std::string & string)
+{
+  return sizeof(std::string) + string.capacity();
+}
+
+// The memory the value allocates, besides the ParameterValue itself.
+size_t
+get_value_size(const rclcpp::ParameterValue & value)
+{
+  using rclcpp::ParameterType;
+  switch (value.get_type()) {
+    case ParameterType::PARAMETER_STRING:
+      return value.get<ParameterType::PARAMETER_STRING>().capacity();
+    case ParameterType::PARAMETER_BYTE_ARRAY:
+      return value.get<ParameterType::PARAMETER_BYTE_ARRAY>().capacity();
+    case ParameterType::PARAMETER_BOOL_ARRAY:
+      return value.get<ParameterType::PARAMETER_BOOL_ARRAY>().capacity() * sizeof(bool);
+    case ParameterType::PARAMETER_INTEGER_ARRAY:
+      return value.get<ParameterType::PARAMETER_INTEGER_ARRAY>().capacity() * sizeof(int64_t);
+    case ParameterType::PARAMETER_DOUBLE_ARRAY:
+      return value.get<ParameterType::PARAMETER_DOUBLE_ARRAY>().capacity() * sizeof(double);
+    case ParameterType::PARAMETER_STRING_ARRAY:
+      {
+        size_t size = 0;
+        for (const auto & string : value.get<ParameterType::PARAMETER_STRING_ARRAY>()) {
+          size += get_string_size(string);
+        }
+        return size;
+      }
+    default:
+      return 0;
+  }
+}
+
+size_t
+get_parameters_size(rclcpp::node_interfaces::NodeParametersInterface & node_parameters)
+{
+  const std::vector<std::string> names = node_parameters.list_parameters({}, 0).names;
+  const std::vector<rclcpp::Parameter> parameters = node_parameters.get_parameters(names);
+  const auto descriptors = node_parameters.describe_parameters(names);
+  size_t size = 0;
+  for (size_t i = 0; i < names.size(); ++i) {
+    size += get_string_size(names[i]) + sizeof(rclcpp::node_interfaces::ParameterInfo);
+    if (i < parameters.size()) {
+      size += get_value_size(parameters[i].get_parameter_value());
+    }
+    if (i < descriptors.size()) {
+      size += descriptors[i].name.capacity() + descriptors[i].description.capacity() +
+        descriptors[i].additional_constraints.capacity();
+    }
+  }
+  return size;
+}
+
+}  // namespace
+
+size_t
+rclcpp::EntityMemoryFootprint::get_total_size() const
+{
+  return intra_process_buffers + message_pools + topic_statistics + parameters;
+}
+
+size_t
+rclcpp::NodeMemoryFootprint::get_total_size() const
+{
+  size_t size = 0;
+  for (const auto & entity : entities) {
+    size += entity.get_total_size();
+  }
+  return size;
+}
+
+rclcpp::NodeMemoryFootprint
+rclcpp::get_memory_footprint(
+  node_interfaces::NodeBaseInterface & node_base,
+  node_interfaces::NodeParametersInterface * node_parameters)
+{
+  NodeMemoryFootprint footprint;
+  footprint.node_name = node_base.get_fully_qualified_name();
+  node_base.for_each_callback_group(
+    [&footprint](rclcpp::CallbackGroup::SharedPtr group) {
+      group->find_subscription_ptrs_if(
+        [&footprint](const rclcpp::SubscriptionBase::SharedPtr & subscription) {
+          footprint.entities.push_back(subscription->get_memory_footprint());
+          return false;
+        });
+    });
+  if (node_parameters) {
+    EntityMemoryFootprint parameters;
+    parameters.kind = "parameters";
+    parameters.parameters = get_parameters_size(*node_parameters);
+    footprint.entities.push_back(parameters);
+  }
+  return footprint;
+}
+
+std::string
+rclcpp::to_string(const NodeMemoryFootprint & footprint)
+{
+  std::ostringstream stream;
+  stream << footprint.node_name << ": " << footprint.get_total_size() << " bytes";
+  for (const auto & entity : footprint.entities) {
+    stream << "\n  " << entity.kind;
+    if (!entity.name.empty()) {
+      stream << " " << entity.name;
+    }
+    stream << ": " << entity.get_total_size() << " bytes";
+    if (entity.intra_process_buffers) {
+      stream << ", intra-process buffers " << entity.intra_process_buffers;
+    }
+    if (entity.message_pools) {
+      stream << ", message pools " << entity.message_pools;
+    }
+    if (entity.topic_statistics) {
+      stream << ", topic statistics " << entity.topic_statistics;
+    }
+    if (entity.parameters) {
+      stream << ", parameters " << entity.parameters;
+    }
+  }
+  return stream.str();
+}
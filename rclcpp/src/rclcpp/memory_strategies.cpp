@@ -16,6 +16,7 @@
 
 #include <memory>
 
+#include "rclcpp/allocator/tlsf_allocator.hpp"
 #include "rclcpp/strategies/allocator_memory_strategy.hpp"
 
 using rclcpp::memory_strategies::allocator_memory_strategy::AllocatorMemoryStrategy;
@@ -25,3 +26,16 @@ rclcpp::memory_strategies::create_default_strategy()
 {
   return std::make_shared<AllocatorMemoryStrategy<>>();
 }
+
+rclcpp::memory_strategy::MemoryStrategy::SharedPtr
+rclcpp::memory_strategies::create_realtime_memory_strategy(
+  rclcpp::allocator::TLSFPool::SharedPtr pool)
+{
+  using rclcpp::allocator::TLSFAllocator;
+  using rclcpp::allocator::TLSFPool;
+  if (!pool) {
+    pool = std::make_shared<TLSFPool>();
+  }
+  return std::make_shared<AllocatorMemoryStrategy<TLSFAllocator<void>>>(
+    std::make_shared<TLSFAllocator<void>>(pool));
+}
@@ -109,17 +109,20 @@ get_parameter_events_qos(
 {
   auto final_qos = options.parameter_event_qos();
   const rcl_arguments_t * global_args = nullptr;
+  std::shared_ptr<rclcpp::detail::GlobalParameterOverrides> global_args_cache;
   auto * rcl_options = options.get_rcl_node_options();
   if (rcl_options->use_global_arguments) {
-    auto context_ptr = node_base.get_context()->get_rcl_context();
-    global_args = &(context_ptr->global_arguments);
+    auto context = node_base.get_context();
+    global_args = &(context->get_rcl_context()->global_arguments);
+    global_args_cache = context->get_sub_context<rclcpp::detail::GlobalParameterOverrides>();
   }
 
   auto parameter_overrides = rclcpp::detail::resolve_parameter_overrides(
     node_base.get_fully_qualified_name(),
     options.parameter_overrides(),
     &rcl_options->arguments,
-    global_args);
+    global_args,
+    global_args_cache.get());
 
   auto final_topic_name = node_base.resolve_topic_or_service_name("/parameter_events", false);
   auto prefix = "qos_overrides." + final_topic_name + ".";
@@ -150,78 +153,136 @@ Node::Node(
       options.context(),
       *(options.get_rcl_node_options()),
       options.use_intra_process_comms(),
-      options.enable_topic_statistics())),
-  node_graph_(new rclcpp::node_interfaces::NodeGraph(node_base_.get())),
+      options.enable_topic_statistics(),
+      options.arena(),
+      options.rosout_batch_period(),
+      options.rosout_max_batch_size(),
+      options.shared_rcl_node_handle())),
   node_logging_(new rclcpp::node_interfaces::NodeLogging(node_base_.get())),
   node_timers_(new rclcpp::node_interfaces::NodeTimers(node_base_.get())),
   node_topics_(new rclcpp::node_interfaces::NodeTopics(node_base_.get(), node_timers_.get())),
   node_services_(new rclcpp::node_interfaces::NodeServices(node_base_.get())),
-  node_clock_(new rclcpp::node_interfaces::NodeClock(
-      node_base_,
-      node_topics_,
-      node_graph_,
-      node_services_,
-      node_logging_
-    )),
-  node_parameters_(new rclcpp::node_interfaces::NodeParameters(
-      node_base_,
-      node_logging_,
-      node_topics_,
-      node_services_,
-      node_clock_,
-      options.parameter_overrides(),
-      options.start_parameter_services(),
-      options.start_parameter_event_publisher(),
-      // This is needed in order to apply parameter overrides to the qos profile provided in
-      // options.
-      get_parameter_events_qos(*node_base_, options),
-      options.parameter_event_publisher_options(),
-      options.allow_undeclared_parameters(),
-      options.automatically_declare_parameters_from_overrides()
-    )),
-  node_time_source_(new rclcpp::node_interfaces::NodeTimeSource(
-      node_base_,
-      node_topics_,
-      node_graph_,
-      node_services_,
-      node_logging_,
-      node_clock_,
-      node_parameters_,
-      options.clock_qos(),
-      options.use_clock_thread()
-    )),
   node_waitables_(new rclcpp::node_interfaces::NodeWaitables(node_base_.get())),
   node_options_(options),
   sub_namespace_(""),
   effective_namespace_(create_effective_namespace(this->get_namespace(), sub_namespace_))
 {
-  // we have got what we wanted directly from the overrides,
-  // but declare the parameters anyway so they are visible.
-  rclcpp::detail::declare_qos_parameters(
-    rclcpp::QosOverridingOptions
-  {
-    QosPolicyKind::Depth,
-    QosPolicyKind::Durability,
-    QosPolicyKind::History,
-    QosPolicyKind::Reliability,
-  },
-    node_parameters_,
-    node_topics_->resolve_topic_name("/parameter_events"),
-    options.parameter_event_qos(),
-    rclcpp::detail::PublisherQosParametersTraits{});
+  if (!options.lazy_node_interfaces()) {
+    graph_interface();
+    parameters_interface();
+  }
+}
+
+const rclcpp::node_interfaces::NodeGraphInterface::SharedPtr &
+Node::graph_interface() const
+{
+  std::call_once(
+    graph_created_, [this]() {
+      // Already shared with a sub-node.
+      if (node_graph_) {
+        return;
+      }
+      node_graph_ = std::make_shared<rclcpp::node_interfaces::NodeGraph>(
+        node_base_.get(), node_options_.use_graph_cache());
+    });
+  return node_graph_;
+}
+
+void
+Node::create_time_interfaces() const
+{
+  std::call_once(
+    time_interfaces_created_, [this]() {
+      // Already shared with a sub-node.
+      if (node_parameters_) {
+        return;
+      }
+      const auto & node_graph = graph_interface();
+      node_clock_ = std::make_shared<rclcpp::node_interfaces::NodeClock>(
+        node_base_,
+        node_topics_,
+        node_graph,
+        node_services_,
+        node_logging_);
+      node_parameters_ = std::make_shared<rclcpp::node_interfaces::NodeParameters>(
+        node_base_,
+        node_logging_,
+        node_topics_,
+        node_services_,
+        node_clock_,
+        node_options_.parameter_overrides(),
+        node_options_.start_parameter_services(),
+        node_options_.start_parameter_event_publisher(),
+        // This is needed in order to apply parameter overrides to the qos profile provided in
+        // options.
+        get_parameter_events_qos(*node_base_, node_options_),
+        node_options_.parameter_event_publisher_options(),
+        node_options_.allow_undeclared_parameters(),
+        node_options_.automatically_declare_parameters_from_overrides(),
+        node_options_.parameter_event_coalescing_period(),
+        node_options_.parameter_snapshot());
+      node_time_source_ = std::make_shared<rclcpp::node_interfaces::NodeTimeSource>(
+        node_base_,
+        node_topics_,
+        node_graph,
+        node_services_,
+        node_logging_,
+        node_clock_,
+        node_parameters_,
+        node_options_.clock_qos(),
+        node_options_.use_clock_thread(),
+        node_options_.use_shared_clock_subscription());
+
+      // we have got what we wanted directly from the overrides,
+      // but declare the parameters anyway so they are visible.
+      rclcpp::detail::declare_qos_parameters(
+        rclcpp::QosOverridingOptions
+      {
+        QosPolicyKind::Depth,
+        QosPolicyKind::Durability,
+        QosPolicyKind::History,
+        QosPolicyKind::Reliability,
+      },
+        node_parameters_,
+        node_topics_->resolve_topic_name("/parameter_events"),
+        node_options_.parameter_event_qos(),
+        rclcpp::detail::PublisherQosParametersTraits{});
+    });
+}
+
+const rclcpp::node_interfaces::NodeClockInterface::SharedPtr &
+Node::clock_interface() const
+{
+  create_time_interfaces();
+  return node_clock_;
+}
+
+const rclcpp::node_interfaces::NodeParametersInterface::SharedPtr &
+Node::parameters_interface() const
+{
+  create_time_interfaces();
+  return node_parameters_;
+}
+
+const rclcpp::node_interfaces::NodeTimeSourceInterface::SharedPtr &
+Node::time_source_interface() const
+{
+  create_time_interfaces();
+  return node_time_source_;
 }
 
 Node::Node(
   const Node & other,
   const std::string & sub_namespace)
 : node_base_(other.node_base_),
-  node_graph_(other.node_graph_),
+  node_graph_(other.graph_interface()),
   node_logging_(other.node_logging_),
   node_timers_(other.node_timers_),
   node_topics_(other.node_topics_),
   node_services_(other.node_services_),
-  node_clock_(other.node_clock_),
-  node_parameters_(other.node_parameters_),
+  node_clock_(other.clock_interface()),
+  node_parameters_(other.parameters_interface()),
+  node_time_source_(other.time_source_interface()),
   node_options_(other.node_options_),
   sub_namespace_(extend_sub_namespace(other.get_sub_namespace(), sub_namespace)),
   effective_namespace_(create_effective_namespace(other.get_namespace(), sub_namespace_))
@@ -288,9 +349,17 @@ Node::get_logger() const
 rclcpp::CallbackGroup::SharedPtr
 Node::create_callback_group(
   rclcpp::CallbackGroupType group_type,
-  bool automatically_add_to_executor_with_node)
+  bool automatically_add_to_executor_with_node,
+  int priority)
 {
-  return node_base_->create_callback_group(group_type, automatically_add_to_executor_with_node);
+  return node_base_->create_callback_group(
+    group_type, automatically_add_to_executor_with_node, priority);
+}
+
+rclcpp::EntityCreationBatch
+Node::create_entity_creation_batch()
+{
+  return rclcpp::EntityCreationBatch(node_base_);
 }
 
 const rclcpp::ParameterValue &
@@ -303,7 +372,7 @@ Node::declare_parameter(const std::string & name)
 # pragma warning(push)
 # pragma warning(disable: 4996)
 #endif
-  return this->node_parameters_->declare_parameter(name);
+  return this->parameters_interface()->declare_parameter(name);
 #ifndef _WIN32
 # pragma GCC diagnostic pop
 #else
@@ -318,7 +387,7 @@ Node::declare_parameter(
   const rcl_interfaces::msg::ParameterDescriptor & parameter_descriptor,
   bool ignore_override)
 {
-  return this->node_parameters_->declare_parameter(
+  return this->parameters_interface()->declare_parameter(
     name,
     default_value,
     parameter_descriptor,
@@ -332,23 +401,32 @@ Node::declare_parameter(
   const rcl_interfaces::msg::ParameterDescriptor & parameter_descriptor,
   bool ignore_override)
 {
-  return this->node_parameters_->declare_parameter(
+  return this->parameters_interface()->declare_parameter(
     name,
     type,
     parameter_descriptor,
     ignore_override);
 }
 
+std::vector<rclcpp::ParameterValue>
+Node::declare_parameters(
+  const std::vector<std::pair<rclcpp::Parameter, rcl_interfaces::msg::ParameterDescriptor>> &
+  parameters,
+  bool ignore_overrides)
+{
+  return this->parameters_interface()->declare_parameters(parameters, ignore_overrides);
+}
+
 void
 Node::undeclare_parameter(const std::string & name)
 {
-  this->node_parameters_->undeclare_parameter(name);
+  this->parameters_interface()->undeclare_parameter(name);
 }
 
 bool
 Node::has_parameter(const std::string & name) const
 {
-  return this->node_parameters_->has_parameter(name);
+  return this->parameters_interface()->has_parameter(name);
 }
 
 rcl_interfaces::msg::SetParametersResult
@@ -360,38 +438,50 @@ Node::set_parameter(const rclcpp::Parameter & parameter)
 std::vector<rcl_interfaces::msg::SetParametersResult>
 Node::set_parameters(const std::vector<rclcpp::Parameter> & parameters)
 {
-  return node_parameters_->set_parameters(parameters);
+  return parameters_interface()->set_parameters(parameters);
 }
 
 rcl_interfaces::msg::SetParametersResult
 Node::set_parameters_atomically(const std::vector<rclcpp::Parameter> & parameters)
 {
-  return node_parameters_->set_parameters_atomically(parameters);
+  return parameters_interface()->set_parameters_atomically(parameters);
 }
 
 rclcpp::Parameter
 Node::get_parameter(const std::string & name) const
 {
-  return node_parameters_->get_parameter(name);
+  return parameters_interface()->get_parameter(name);
+}
+
+rclcpp::ParameterHandle::SharedPtr
+Node::get_parameter_handle(const std::string & name)
+{
+  return parameters_interface()->get_parameter_handle(name);
+}
+
+rclcpp::ParameterSnapshot
+Node::get_parameter_snapshot() const
+{
+  return parameters_interface()->get_parameter_snapshot();
 }
 
 bool
 Node::get_parameter(const std::string & name, rclcpp::Parameter & parameter) const
 {
-  return node_parameters_->get_parameter(name, parameter);
+  return parameters_interface()->get_parameter(name, parameter);
 }
 
 std::vector<rclcpp::Parameter>
 Node::get_parameters(
   const std::vector<std::string> & names) const
 {
-  return node_parameters_->get_parameters(names);
+  return parameters_interface()->get_parameters(names);
 }
 
 rcl_interfaces::msg::ParameterDescriptor
 Node::describe_parameter(const std::string & name) const
 {
-  auto result = node_parameters_->describe_parameters({name});
+  auto result = parameters_interface()->describe_parameters({name});
   if (0 == result.size()) {
     throw rclcpp::exceptions::ParameterNotDeclaredException(name);
   }
@@ -404,49 +494,49 @@ Node::describe_parameter(const std::string & name) const
 std::vector<rcl_interfaces::msg::ParameterDescriptor>
 Node::describe_parameters(const std::vector<std::string> & names) const
 {
-  return node_parameters_->describe_parameters(names);
+  return parameters_interface()->describe_parameters(names);
 }
 
 std::vector<uint8_t>
 Node::get_parameter_types(const std::vector<std::string> & names) const
 {
-  return node_parameters_->get_parameter_types(names);
+  return parameters_interface()->get_parameter_types(names);
 }
 
 rcl_interfaces::msg::ListParametersResult
 Node::list_parameters(const std::vector<std::string> & prefixes, uint64_t depth) const
 {
-  return node_parameters_->list_parameters(prefixes, depth);
+  return parameters_interface()->list_parameters(prefixes, depth);
 }
 
 rclcpp::Node::OnSetParametersCallbackHandle::SharedPtr
 Node::add_on_set_parameters_callback(OnParametersSetCallbackType callback)
 {
-  return node_parameters_->add_on_set_parameters_callback(callback);
+  return parameters_interface()->add_on_set_parameters_callback(callback);
 }
 
 void
 Node::remove_on_set_parameters_callback(const OnSetParametersCallbackHandle * const callback)
 {
-  return node_parameters_->remove_on_set_parameters_callback(callback);
+  return parameters_interface()->remove_on_set_parameters_callback(callback);
 }
 
 std::vector<std::string>
 Node::get_node_names() const
 {
-  return node_graph_->get_node_names();
+  return graph_interface()->get_node_names();
 }
 
 std::map<std::string, std::vector<std::string>>
 Node::get_topic_names_and_types() const
 {
-  return node_graph_->get_topic_names_and_types();
+  return graph_interface()->get_topic_names_and_types();
 }
 
 std::map<std::string, std::vector<std::string>>
 Node::get_service_names_and_types() const
 {
-  return node_graph_->get_service_names_and_types();
+  return graph_interface()->get_service_names_and_types();
 }
 
 std::map<std::string, std::vector<std::string>>
@@ -454,32 +544,32 @@ Node::get_service_names_and_types_by_node(
   const std::string & node_name,
   const std::string & namespace_) const
 {
-  return node_graph_->get_service_names_and_types_by_node(
+  return graph_interface()->get_service_names_and_types_by_node(
     node_name, namespace_);
 }
 
 size_t
 Node::count_publishers(const std::string & topic_name) const
 {
-  return node_graph_->count_publishers(topic_name);
+  return graph_interface()->count_publishers(topic_name);
 }
 
 size_t
 Node::count_subscribers(const std::string & topic_name) const
 {
-  return node_graph_->count_subscribers(topic_name);
+  return graph_interface()->count_subscribers(topic_name);
 }
 
 std::vector<rclcpp::TopicEndpointInfo>
 Node::get_publishers_info_by_topic(const std::string & topic_name, bool no_mangle) const
 {
-  return node_graph_->get_publishers_info_by_topic(topic_name, no_mangle);
+  return graph_interface()->get_publishers_info_by_topic(topic_name, no_mangle);
 }
 
 std::vector<rclcpp::TopicEndpointInfo>
 Node::get_subscriptions_info_by_topic(const std::string & topic_name, bool no_mangle) const
 {
-  return node_graph_->get_subscriptions_info_by_topic(topic_name, no_mangle);
+  return graph_interface()->get_subscriptions_info_by_topic(topic_name, no_mangle);
 }
 
 void
@@ -492,7 +582,7 @@ Node::for_each_callback_group(
 rclcpp::Event::SharedPtr
 Node::get_graph_event()
 {
-  return node_graph_->get_graph_event();
+  return graph_interface()->get_graph_event();
 }
 
 void
@@ -500,25 +590,25 @@ Node::wait_for_graph_change(
   rclcpp::Event::SharedPtr event,
   std::chrono::nanoseconds timeout)
 {
-  node_graph_->wait_for_graph_change(event, timeout);
+  graph_interface()->wait_for_graph_change(event, timeout);
 }
 
 rclcpp::Clock::SharedPtr
 Node::get_clock()
 {
-  return node_clock_->get_clock();
+  return clock_interface()->get_clock();
 }
 
 rclcpp::Clock::ConstSharedPtr
 Node::get_clock() const
 {
-  return node_clock_->get_clock();
+  return clock_interface()->get_clock();
 }
 
 rclcpp::Time
 Node::now() const
 {
-  return node_clock_->get_clock()->now();
+  return clock_interface()->get_clock()->now();
 }
 
 rclcpp::node_interfaces::NodeBaseInterface::SharedPtr
@@ -530,13 +620,13 @@ Node::get_node_base_interface()
 rclcpp::node_interfaces::NodeClockInterface::SharedPtr
 Node::get_node_clock_interface()
 {
-  return node_clock_;
+  return clock_interface();
 }
 
 rclcpp::node_interfaces::NodeGraphInterface::SharedPtr
 Node::get_node_graph_interface()
 {
-  return node_graph_;
+  return graph_interface();
 }
 
 rclcpp::node_interfaces::NodeLoggingInterface::SharedPtr
@@ -548,7 +638,7 @@ Node::get_node_logging_interface()
 rclcpp::node_interfaces::NodeTimeSourceInterface::SharedPtr
 Node::get_node_time_source_interface()
 {
-  return node_time_source_;
+  return time_source_interface();
 }
 
 rclcpp::node_interfaces::NodeTimersInterface::SharedPtr
@@ -572,7 +662,7 @@ Node::get_node_services_interface()
 rclcpp::node_interfaces::NodeParametersInterface::SharedPtr
 Node::get_node_parameters_interface()
 {
-  return node_parameters_;
+  return parameters_interface();
 }
 
 rclcpp::node_interfaces::NodeWaitablesInterface::SharedPtr
@@ -12,32 +12,96 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <chrono>
 #include <string>
 #include <limits>
 #include <memory>
+#include <stdexcept>
+#include <utility>
 #include <vector>
 
 #include "rclcpp/node_interfaces/node_base.hpp"
 
 #include "rcl/arguments.h"
 #include "rclcpp/exceptions.hpp"
+#include "rclcpp/expand_topic_or_service_name.hpp"
+#include "rclcpp/startup_profiling.hpp"
 #include "rcutils/logging_macros.h"
 #include "rmw/validate_namespace.h"
 #include "rmw/validate_node_name.h"
 
+#include "../detail/rosout_batcher.hpp"
 #include "../logging_mutex.hpp"
 
 using rclcpp::exceptions::throw_from_rcl_error;
 
 using rclcpp::node_interfaces::NodeBase;
 
+namespace
+{
+
+/// Number of names resolved cached per node and kind.
+constexpr size_t max_resolved_names = 1024;
+
+/// Throw rclcpp::exceptions::InvalidNodeNameError if the node name is not valid.
+void
+throw_if_invalid_node_name(const std::string & node_name)
+{
+  int validation_result;
+  size_t invalid_index;
+  rmw_ret_t rmw_ret =
+    rmw_validate_node_name(node_name.c_str(), &validation_result, &invalid_index);
+  if (rmw_ret != RMW_RET_OK) {
+    if (rmw_ret == RMW_RET_INVALID_ARGUMENT) {
+      throw_from_rcl_error(RCL_RET_INVALID_ARGUMENT, "failed to validate node name");
+    }
+    throw_from_rcl_error(RCL_RET_ERROR, "failed to validate node name");
+  }
+
+  if (validation_result != RMW_NODE_NAME_VALID) {
+    throw rclcpp::exceptions::InvalidNodeNameError(
+            node_name.c_str(),
+            rmw_node_name_validation_result_string(validation_result),
+            invalid_index);
+  }
+}
+
+/// Throw rclcpp::exceptions::InvalidNamespaceError if the namespace is not valid.
+void
+throw_if_invalid_namespace(const std::string & namespace_)
+{
+  int validation_result;
+  size_t invalid_index;
+  rmw_ret_t rmw_ret =
+    rmw_validate_namespace(namespace_.c_str(), &validation_result, &invalid_index);
+  if (rmw_ret != RMW_RET_OK) {
+    if (rmw_ret == RMW_RET_INVALID_ARGUMENT) {
+      throw_from_rcl_error(RCL_RET_INVALID_ARGUMENT, "failed to validate namespace");
+    }
+    throw_from_rcl_error(RCL_RET_ERROR, "failed to validate namespace");
+  }
+
+  if (validation_result != RMW_NAMESPACE_VALID) {
+    throw rclcpp::exceptions::InvalidNamespaceError(
+            namespace_.c_str(),
+            rmw_namespace_validation_result_string(validation_result),
+            invalid_index);
+  }
+}
+
+}  // namespace
+
 NodeBase::NodeBase(
   const std::string & node_name,
   const std::string & namespace_,
   rclcpp::Context::SharedPtr context,
   const rcl_node_options_t & rcl_node_options,
   bool use_intra_process_default,
-  bool enable_topic_statistics_default)
+  bool enable_topic_statistics_default,
+  std::shared_ptr<void> rcl_allocator_state,
+  std::chrono::nanoseconds rosout_batch_period,
+  size_t rosout_max_batch_size,
+  std::shared_ptr<rcl_node_t> shared_rcl_node_handle)
 : context_(context),
   use_intra_process_default_(use_intra_process_default),
   enable_topic_statistics_default_(enable_topic_statistics_default),
@@ -46,6 +110,7 @@ NodeBase::NodeBase(
   associated_with_executor_(false),
   notify_guard_condition_is_valid_(false)
 {
+  rclcpp::startup_profiling::ScopedPhase profiled_phase("node base", node_name.c_str());
   // Setup the guard condition that is notified when changes occur in the graph.
   rcl_guard_condition_options_t guard_condition_options = rcl_guard_condition_get_default_options();
   rcl_ret_t ret = rcl_guard_condition_init(
@@ -64,9 +129,72 @@ NodeBase::NodeBase(
       }
     };
 
+  if (shared_rcl_node_handle) {
+    if (shared_rcl_node_handle->context != context_->get_rcl_context().get()) {
+      finalize_notify_guard_condition();
+      throw std::invalid_argument("the shared rcl node handle belongs to another context");
+    }
+    // Normalized like rcl_node_init() does.
+    std::string node_namespace = namespace_;
+    if (node_namespace.empty() || node_namespace.front() != '/') {
+      node_namespace.insert(0, 1, '/');
+    }
+    try {
+      throw_if_invalid_node_name(node_name);
+      throw_if_invalid_namespace(node_namespace);
+    } catch (...) {
+      finalize_notify_guard_condition();
+      throw;
+    }
+    node_name_ = node_name;
+    node_namespace_ = node_namespace;
+    fully_qualified_name_ = node_namespace;
+    if (fully_qualified_name_.back() != '/') {
+      fully_qualified_name_ += '/';
+    }
+    fully_qualified_name_ += node_name;
+    rcl_node_handle_is_shared_ = true;
+    node_handle_ = std::move(shared_rcl_node_handle);
+  } else {
+    try {
+      create_rcl_node(
+        node_name, namespace_, rcl_node_options, rcl_allocator_state,
+        rosout_batch_period, rosout_max_batch_size);
+    } catch (...) {
+      finalize_notify_guard_condition();
+      throw;
+    }
+  }
+
+  // Create the default callback group.
+  using rclcpp::CallbackGroupType;
+  default_callback_group_ = create_callback_group(CallbackGroupType::MutuallyExclusive);
+
+  // Indicate the notify_guard_condition is now valid.
+  notify_guard_condition_is_valid_ = true;
+}
+
+void
+NodeBase::create_rcl_node(
+  const std::string & node_name,
+  const std::string & namespace_,
+  const rcl_node_options_t & rcl_node_options,
+  std::shared_ptr<void> rcl_allocator_state,
+  std::chrono::nanoseconds rosout_batch_period,
+  size_t rosout_max_batch_size)
+{
   // Create the rcl node and store it in a shared_ptr with a custom destructor.
   std::unique_ptr<rcl_node_t> rcl_node(new rcl_node_t(rcl_get_zero_initialized_node()));
 
+  // The records are published by the batcher instead of rcl.
+  bool batch_rosout =
+    rcl_node_options.enable_rosout && rosout_batch_period > std::chrono::nanoseconds::zero();
+  rcl_node_options_t node_options = rcl_node_options;
+  if (batch_rosout) {
+    node_options.enable_rosout = false;
+  }
+
+  rcl_ret_t ret;
   std::shared_ptr<std::recursive_mutex> logging_mutex = get_global_logging_mutex();
   {
     std::lock_guard<std::recursive_mutex> guard(*logging_mutex);
@@ -77,63 +205,27 @@ NodeBase::NodeBase(
     ret = rcl_node_init(
       rcl_node.get(),
       node_name.c_str(), namespace_.c_str(),
-      context_->get_rcl_context().get(), &rcl_node_options);
+      context_->get_rcl_context().get(), &node_options);
   }
   if (ret != RCL_RET_OK) {
-    // Finalize the interrupt guard condition.
-    finalize_notify_guard_condition();
-
     if (ret == RCL_RET_NODE_INVALID_NAME) {
       rcl_reset_error();  // discard rcl_node_init error
-      int validation_result;
-      size_t invalid_index;
-      rmw_ret_t rmw_ret =
-        rmw_validate_node_name(node_name.c_str(), &validation_result, &invalid_index);
-      if (rmw_ret != RMW_RET_OK) {
-        if (rmw_ret == RMW_RET_INVALID_ARGUMENT) {
-          throw_from_rcl_error(RCL_RET_INVALID_ARGUMENT, "failed to validate node name");
-        }
-        throw_from_rcl_error(RCL_RET_ERROR, "failed to validate node name");
-      }
-
-      if (validation_result != RMW_NODE_NAME_VALID) {
-        throw rclcpp::exceptions::InvalidNodeNameError(
-                node_name.c_str(),
-                rmw_node_name_validation_result_string(validation_result),
-                invalid_index);
-      } else {
-        throw std::runtime_error("valid rmw node name but invalid rcl node name");
-      }
+      throw_if_invalid_node_name(node_name);
+      throw std::runtime_error("valid rmw node name but invalid rcl node name");
     }
 
     if (ret == RCL_RET_NODE_INVALID_NAMESPACE) {
       rcl_reset_error();  // discard rcl_node_init error
-      int validation_result;
-      size_t invalid_index;
-      rmw_ret_t rmw_ret =
-        rmw_validate_namespace(namespace_.c_str(), &validation_result, &invalid_index);
-      if (rmw_ret != RMW_RET_OK) {
-        if (rmw_ret == RMW_RET_INVALID_ARGUMENT) {
-          throw_from_rcl_error(RCL_RET_INVALID_ARGUMENT, "failed to validate namespace");
-        }
-        throw_from_rcl_error(RCL_RET_ERROR, "failed to validate namespace");
-      }
-
-      if (validation_result != RMW_NAMESPACE_VALID) {
-        throw rclcpp::exceptions::InvalidNamespaceError(
-                namespace_.c_str(),
-                rmw_namespace_validation_result_string(validation_result),
-                invalid_index);
-      } else {
-        throw std::runtime_error("valid rmw node namespace but invalid rcl node namespace");
-      }
+      throw_if_invalid_namespace(namespace_);
+      throw std::runtime_error("valid rmw node namespace but invalid rcl node namespace");
     }
     throw_from_rcl_error(ret, "failed to initialize rcl node");
   }
 
+  // The state of the allocator is kept alive by the deleter, until the rcl node is finalized.
   node_handle_.reset(
     rcl_node.release(),
-    [logging_mutex](rcl_node_t * node) -> void {
+    [logging_mutex, rcl_allocator_state](rcl_node_t * node) -> void {
       std::lock_guard<std::recursive_mutex> guard(*logging_mutex);
       // TODO(ivanpauno): Instead of mutually excluding rcl_node_fini with the global logger mutex,
       // rcl_logging_rosout_fini_publisher_for_node could be decoupled from there and be called
@@ -146,16 +238,17 @@ NodeBase::NodeBase(
       delete node;
     });
 
-  // Create the default callback group.
-  using rclcpp::CallbackGroupType;
-  default_callback_group_ = create_callback_group(CallbackGroupType::MutuallyExclusive);
-
-  // Indicate the notify_guard_condition is now valid.
-  notify_guard_condition_is_valid_ = true;
+  if (batch_rosout) {
+    rosout_batcher_ = std::make_shared<rclcpp::detail::RosoutBatcher>(
+      node_handle_, rcl_node_options.rosout_qos, rosout_batch_period, rosout_max_batch_size);
+  }
 }
 
 NodeBase::~NodeBase()
 {
+  // Publish the pending records while the rcl node is still valid.
+  rosout_batcher_.reset();
+
   // Finalize the interrupt guard condition after removing self from graph listener.
   {
     std::lock_guard<std::recursive_mutex> notify_condition_lock(notify_guard_condition_mutex_);
@@ -171,18 +264,27 @@ NodeBase::~NodeBase()
 const char *
 NodeBase::get_name() const
 {
+  if (rcl_node_handle_is_shared_) {
+    return node_name_.c_str();
+  }
   return rcl_node_get_name(node_handle_.get());
 }
 
 const char *
 NodeBase::get_namespace() const
 {
+  if (rcl_node_handle_is_shared_) {
+    return node_namespace_.c_str();
+  }
   return rcl_node_get_namespace(node_handle_.get());
 }
 
 const char *
 NodeBase::get_fully_qualified_name() const
 {
+  if (rcl_node_handle_is_shared_) {
+    return fully_qualified_name_.c_str();
+  }
   return rcl_node_get_fully_qualified_name(node_handle_.get());
 }
 
@@ -219,11 +321,13 @@ NodeBase::get_shared_rcl_node_handle() const
 rclcpp::CallbackGroup::SharedPtr
 NodeBase::create_callback_group(
   rclcpp::CallbackGroupType group_type,
-  bool automatically_add_to_executor_with_node)
+  bool automatically_add_to_executor_with_node,
+  int priority)
 {
   auto group = std::make_shared<rclcpp::CallbackGroup>(
     group_type,
-    automatically_add_to_executor_with_node);
+    automatically_add_to_executor_with_node,
+    priority);
   std::lock_guard<std::mutex> lock(callback_groups_mutex_);
   callback_groups_.push_back(group);
   return group;
@@ -281,6 +385,44 @@ NodeBase::acquire_notify_guard_condition_lock() const
   return std::unique_lock<std::recursive_mutex>(notify_guard_condition_mutex_);
 }
 
+void
+NodeBase::start_deferring_entity_notifications()
+{
+  std::lock_guard<std::recursive_mutex> notify_condition_lock(notify_guard_condition_mutex_);
+  ++entity_notification_deferrals_;
+}
+
+void
+NodeBase::stop_deferring_entity_notifications()
+{
+  std::lock_guard<std::recursive_mutex> notify_condition_lock(notify_guard_condition_mutex_);
+  if (entity_notification_deferrals_ == 0) {
+    throw std::logic_error("entity notifications are not being deferred");
+  }
+  if (--entity_notification_deferrals_ != 0 || !entity_notification_pending_) {
+    return;
+  }
+  entity_notification_pending_ = false;
+  if (!notify_guard_condition_is_valid_) {
+    return;
+  }
+  rcl_ret_t ret = rcl_trigger_guard_condition(&notify_guard_condition_);
+  if (RCL_RET_OK != ret) {
+    throw_from_rcl_error(ret, "failed to notify wait set of the entities created in a batch");
+  }
+}
+
+bool
+NodeBase::defer_entity_notification()
+{
+  std::lock_guard<std::recursive_mutex> notify_condition_lock(notify_guard_condition_mutex_);
+  if (entity_notification_deferrals_ == 0) {
+    return false;
+  }
+  entity_notification_pending_ = true;
+  return true;
+}
+
 bool
 NodeBase::get_use_intra_process_default() const
 {
@@ -297,19 +439,46 @@ std::string
 NodeBase::resolve_topic_or_service_name(
   const std::string & name, bool is_service, bool only_expand) const
 {
-  char * output_cstr = NULL;
-  auto allocator = rcl_get_default_allocator();
-  rcl_ret_t ret = rcl_node_resolve_name(
-    node_handle_.get(),
-    name.c_str(),
-    allocator,
-    is_service,
-    only_expand,
-    &output_cstr);
-  if (RCL_RET_OK != ret) {
-    throw_from_rcl_error(ret, "failed to resolve name", rcl_get_error_state());
+  auto & resolved_names = resolved_names_[is_service][only_expand];
+  {
+    std::lock_guard<std::mutex> lock(resolved_names_mutex_);
+    auto it = resolved_names.find(name);
+    if (it != resolved_names.end()) {
+      return it->second;
+    }
+  }
+
+  std::string output;
+  std::string expanded_name;
+  if (rcl_node_handle_is_shared_) {
+    // Expanded with the name of this node, rcl would use the one of the shared handle.
+    expanded_name = rclcpp::expand_topic_or_service_name(
+      name, node_name_, node_namespace_, is_service);
+  }
+  if (rcl_node_handle_is_shared_ && only_expand) {
+    output = std::move(expanded_name);
+  } else {
+    char * output_cstr = NULL;
+    auto allocator = rcl_get_default_allocator();
+    rcl_ret_t ret = rcl_node_resolve_name(
+      node_handle_.get(),
+      rcl_node_handle_is_shared_ ? expanded_name.c_str() : name.c_str(),
+      allocator,
+      is_service,
+      only_expand,
+      &output_cstr);
+    if (RCL_RET_OK != ret) {
+      throw_from_rcl_error(ret, "failed to resolve name", rcl_get_error_state());
+    }
+    output = output_cstr;
+    allocator.deallocate(output_cstr, allocator.state);
+  }
+
+  std::lock_guard<std::mutex> lock(resolved_names_mutex_);
+  // Bounded, for the nodes resolving names made up on the fly.
+  if (resolved_names.size() >= max_resolved_names) {
+    resolved_names.clear();
   }
-  std::string output{output_cstr};
-  allocator.deallocate(output_cstr, allocator.state);
+  resolved_names.emplace(name, output);
   return output;
 }
@@ -15,7 +15,10 @@
 #include "rclcpp/node_interfaces/node_graph.hpp"
 
 #include <algorithm>
+#include <exception>
+#include <functional>
 #include <map>
+#include <stdexcept>
 #include <string>
 #include <utility>
 #include <vector>
@@ -28,18 +31,29 @@
 #include "rclcpp/graph_listener.hpp"
 #include "rclcpp/node_interfaces/node_graph_interface.hpp"
 
+#include "../detail/graph_cache.hpp"
+
 using rclcpp::node_interfaces::NodeGraph;
 using rclcpp::exceptions::throw_from_rcl_error;
 using rclcpp::graph_listener::GraphListener;
 
-NodeGraph::NodeGraph(rclcpp::node_interfaces::NodeBaseInterface * node_base)
+NodeGraph::NodeGraph(
+  rclcpp::node_interfaces::NodeBaseInterface * node_base,
+  bool use_graph_cache)
 : node_base_(node_base),
   graph_listener_(
     node_base->get_context()->get_sub_context<GraphListener>(node_base->get_context())
   ),
   should_add_to_graph_listener_(true),
   graph_users_count_(0)
-{}
+{
+  if (use_graph_cache) {
+    graph_cache_ = node_base->get_context()->get_sub_context<rclcpp::detail::GraphCache>();
+    // Holding a graph event keeps the graph listener notifying this node, which invalidates the
+    // cache, of all graph changes.
+    graph_cache_event_ = get_graph_event();
+  }
+}
 
 NodeGraph::~NodeGraph()
 {
@@ -52,14 +66,37 @@ NodeGraph::~NodeGraph()
   }
 }
 
+rclcpp::detail::GraphCache *
+NodeGraph::get_graph_cache() const
+{
+  // Once the graph listener is shut down, nothing invalidates the cache anymore.
+  if (!graph_cache_ || graph_listener_->is_shutdown()) {
+    return nullptr;
+  }
+  return graph_cache_.get();
+}
+
+template<typename ValueT, typename QueryT>
+static ValueT
+cached_query(rclcpp::detail::GraphCache * graph_cache, const std::string & key, QueryT && query)
+{
+  if (!graph_cache) {
+    return query();
+  }
+  return graph_cache->get<ValueT>(key, std::forward<QueryT>(query));
+}
+
+static
 std::map<std::string, std::vector<std::string>>
-NodeGraph::get_topic_names_and_types(bool no_demangle) const
+query_topic_names_and_types(
+  rclcpp::node_interfaces::NodeBaseInterface * node_base,
+  bool no_demangle)
 {
   rcl_names_and_types_t topic_names_and_types = rcl_get_zero_initialized_names_and_types();
 
   rcl_allocator_t allocator = rcl_get_default_allocator();
   auto ret = rcl_get_topic_names_and_types(
-    node_base_->get_rcl_node_handle(),
+    node_base->get_rcl_node_handle(),
     &allocator,
     no_demangle,
     &topic_names_and_types);
@@ -95,13 +132,25 @@ NodeGraph::get_topic_names_and_types(bool no_demangle) const
 }
 
 std::map<std::string, std::vector<std::string>>
-NodeGraph::get_service_names_and_types() const
+NodeGraph::get_topic_names_and_types(bool no_demangle) const
+{
+  return cached_query<std::map<std::string, std::vector<std::string>>>(
+    get_graph_cache(),
+    no_demangle ? "topic_names_and_types no_demangle" : "topic_names_and_types",
+    [this, no_demangle]() {
+      return query_topic_names_and_types(node_base_, no_demangle);
+    });
+}
+
+static
+std::map<std::string, std::vector<std::string>>
+query_service_names_and_types(rclcpp::node_interfaces::NodeBaseInterface * node_base)
 {
   rcl_names_and_types_t service_names_and_types = rcl_get_zero_initialized_names_and_types();
 
   rcl_allocator_t allocator = rcl_get_default_allocator();
   auto ret = rcl_get_service_names_and_types(
-    node_base_->get_rcl_node_handle(),
+    node_base->get_rcl_node_handle(),
     &allocator,
     &service_names_and_types);
   if (ret != RCL_RET_OK) {
@@ -136,6 +185,17 @@ NodeGraph::get_service_names_and_types() const
   return services_and_types;
 }
 
+std::map<std::string, std::vector<std::string>>
+NodeGraph::get_service_names_and_types() const
+{
+  return cached_query<std::map<std::string, std::vector<std::string>>>(
+    get_graph_cache(),
+    "service_names_and_types",
+    [this]() {
+      return query_service_names_and_types(node_base_);
+    });
+}
+
 std::map<std::string, std::vector<std::string>>
 NodeGraph::get_service_names_and_types_by_node(
   const std::string & node_name,
@@ -206,8 +266,9 @@ NodeGraph::get_node_names() const
   return nodes;
 }
 
+static
 std::vector<std::pair<std::string, std::string>>
-NodeGraph::get_node_names_and_namespaces() const
+query_node_names_and_namespaces(rclcpp::node_interfaces::NodeBaseInterface * node_base)
 {
   rcutils_string_array_t node_names_c =
     rcutils_get_zero_initialized_string_array();
@@ -216,7 +277,7 @@ NodeGraph::get_node_names_and_namespaces() const
 
   auto allocator = rcl_get_default_allocator();
   auto ret = rcl_get_node_names(
-    node_base_->get_rcl_node_handle(),
+    node_base->get_rcl_node_handle(),
     allocator,
     &node_names_c,
     &node_namespaces_c);
@@ -269,6 +330,17 @@ NodeGraph::get_node_names_and_namespaces() const
   return node_names;
 }
 
+std::vector<std::pair<std::string, std::string>>
+NodeGraph::get_node_names_and_namespaces() const
+{
+  return cached_query<std::vector<std::pair<std::string, std::string>>>(
+    get_graph_cache(),
+    "node_names_and_namespaces",
+    [this]() {
+      return query_node_names_and_namespaces(node_base_);
+    });
+}
+
 size_t
 NodeGraph::count_publishers(const std::string & topic_name) const
 {
@@ -276,19 +348,24 @@ NodeGraph::count_publishers(const std::string & topic_name) const
 
   auto fqdn = rclcpp::expand_topic_or_service_name(
     topic_name,
-    rcl_node_get_name(rcl_node_handle),
-    rcl_node_get_namespace(rcl_node_handle),
+    node_base_->get_name(),
+    node_base_->get_namespace(),
     false);    // false = not a service
 
-  size_t count;
-  auto ret = rcl_count_publishers(rcl_node_handle, fqdn.c_str(), &count);
-  if (ret != RMW_RET_OK) {
-    // *INDENT-OFF*
-    throw std::runtime_error(
-      std::string("could not count publishers: ") + rmw_get_error_string().str);
-    // *INDENT-ON*
-  }
-  return count;
+  return cached_query<size_t>(
+    get_graph_cache(),
+    "count_publishers " + fqdn,
+    [rcl_node_handle, &fqdn]() {
+      size_t count;
+      auto ret = rcl_count_publishers(rcl_node_handle, fqdn.c_str(), &count);
+      if (ret != RMW_RET_OK) {
+        // *INDENT-OFF*
+        throw std::runtime_error(
+          std::string("could not count publishers: ") + rmw_get_error_string().str);
+        // *INDENT-ON*
+      }
+      return count;
+    });
 }
 
 size_t
@@ -298,19 +375,24 @@ NodeGraph::count_subscribers(const std::string & topic_name) const
 
   auto fqdn = rclcpp::expand_topic_or_service_name(
     topic_name,
-    rcl_node_get_name(rcl_node_handle),
-    rcl_node_get_namespace(rcl_node_handle),
+    node_base_->get_name(),
+    node_base_->get_namespace(),
     false);    // false = not a service
 
-  size_t count;
-  auto ret = rcl_count_subscribers(rcl_node_handle, fqdn.c_str(), &count);
-  if (ret != RMW_RET_OK) {
-    // *INDENT-OFF*
-    throw std::runtime_error(
-      std::string("could not count subscribers: ") + rmw_get_error_string().str);
-    // *INDENT-ON*
-  }
-  return count;
+  return cached_query<size_t>(
+    get_graph_cache(),
+    "count_subscribers " + fqdn,
+    [rcl_node_handle, &fqdn]() {
+      size_t count;
+      auto ret = rcl_count_subscribers(rcl_node_handle, fqdn.c_str(), &count);
+      if (ret != RMW_RET_OK) {
+        // *INDENT-OFF*
+        throw std::runtime_error(
+          std::string("could not count subscribers: ") + rmw_get_error_string().str);
+        // *INDENT-ON*
+      }
+      return count;
+    });
 }
 
 const rcl_guard_condition_t *
@@ -322,6 +404,9 @@ NodeGraph::get_graph_guard_condition() const
 void
 NodeGraph::notify_graph_change()
 {
+  if (graph_cache_) {
+    graph_cache_->invalidate();
+  }
   {
     std::lock_guard<std::mutex> graph_changed_lock(graph_mutex_);
     bool bad_ptr_encountered = false;
@@ -346,6 +431,22 @@ NodeGraph::notify_graph_change()
       // update graph_users_count_
       graph_users_count_.store(graph_events_.size());
     }
+    // Only wake up the threads waiting for a predicate which now holds.
+    for (auto waiter : graph_predicate_waiters_) {
+      if (waiter->satisfied) {
+        continue;
+      }
+      try {
+        waiter->satisfied = waiter->predicate();
+      } catch (...) {
+        // Rethrown by the waiting thread rather than in the graph listener.
+        waiter->exception = std::current_exception();
+        waiter->satisfied = true;
+      }
+      if (waiter->satisfied) {
+        waiter->cv.notify_one();
+      }
+    }
   }
   graph_cv_.notify_all();
   {
@@ -362,6 +463,10 @@ NodeGraph::notify_shutdown()
 {
   // notify here anything that will not be woken up by ctrl-c or rclcpp::shutdown().
   graph_cv_.notify_all();
+  std::lock_guard<std::mutex> graph_lock(graph_mutex_);
+  for (auto waiter : graph_predicate_waiters_) {
+    waiter->cv.notify_one();
+  }
 }
 
 rclcpp::Event::SharedPtr
@@ -413,6 +518,47 @@ NodeGraph::wait_for_graph_change(
   }
 }
 
+bool
+NodeGraph::wait_for_graph_predicate(
+  std::function<bool()> predicate,
+  std::chrono::nanoseconds timeout)
+{
+  if (!predicate) {
+    throw std::invalid_argument("predicate cannot be empty");
+  }
+  if (predicate()) {
+    return true;
+  }
+  auto context = node_base_->get_context();
+  if (timeout == std::chrono::nanoseconds(0) || !rclcpp::ok(context)) {
+    return false;
+  }
+  // Holding a graph event keeps the graph listener notifying this node of graph changes.
+  auto event = get_graph_event();
+
+  GraphPredicateWaiter waiter;
+  waiter.predicate = std::move(predicate);
+  std::unique_lock<std::mutex> graph_lock(graph_mutex_);
+  // Check again, as the graph may have changed before the graph listener watched this node.
+  waiter.satisfied = waiter.predicate();
+  if (!waiter.satisfied) {
+    auto it = graph_predicate_waiters_.insert(graph_predicate_waiters_.end(), &waiter);
+    auto pred = [&waiter, &context]() {
+        return waiter.satisfied || !rclcpp::ok(context);
+      };
+    if (timeout < std::chrono::nanoseconds(0)) {
+      waiter.cv.wait(graph_lock, pred);
+    } else {
+      waiter.cv.wait_for(graph_lock, timeout, pred);
+    }
+    graph_predicate_waiters_.erase(it);
+  }
+  if (waiter.exception) {
+    std::rethrow_exception(waiter.exception);
+  }
+  return waiter.satisfied;
+}
+
 size_t
 NodeGraph::count_graph_users() const
 {
@@ -434,6 +580,7 @@ template<const char * EndpointType, typename FunctionT>
 static std::vector<rclcpp::TopicEndpointInfo>
 get_info_by_topic(
   rclcpp::node_interfaces::NodeBaseInterface * node_base,
+  rclcpp::detail::GraphCache * graph_cache,
   const std::string & topic_name,
   bool no_mangle,
   FunctionT rcl_get_info_by_topic)
@@ -446,8 +593,8 @@ get_info_by_topic(
   } else {
     fqdn = rclcpp::expand_topic_or_service_name(
       topic_name,
-      rcl_node_get_name(rcl_node_handle),
-      rcl_node_get_namespace(rcl_node_handle),
+      node_base->get_name(),
+      node_base->get_namespace(),
       false);    // false = not a service
 
     // Get the node options
@@ -477,34 +624,42 @@ get_info_by_topic(
     }
   }
 
-  rcutils_allocator_t allocator = rcutils_get_default_allocator();
-  rcl_topic_endpoint_info_array_t info_array = rcl_get_zero_initialized_topic_endpoint_info_array();
-  rcl_ret_t ret =
-    rcl_get_info_by_topic(rcl_node_handle, &allocator, fqdn.c_str(), no_mangle, &info_array);
-  if (RCL_RET_OK != ret) {
-    auto error_msg =
-      std::string("Failed to get information by topic for ") + EndpointType + std::string(":");
-    if (RCL_RET_UNSUPPORTED == ret) {
-      error_msg += std::string("function not supported by RMW_IMPLEMENTATION");
-    } else {
-      error_msg += rcl_get_error_string().str;
-    }
-    rcl_reset_error();
-    if (RCL_RET_OK != rcl_topic_endpoint_info_array_fini(&info_array, &allocator)) {
-      error_msg += std::string(", failed also to cleanup topic info array, leaking memory: ") +
-        rcl_get_error_string().str;
-      rcl_reset_error();
-    }
-    throw_from_rcl_error(ret, error_msg);
-  }
+  auto query = [rcl_node_handle, &fqdn, no_mangle, rcl_get_info_by_topic]() {
+      rcutils_allocator_t allocator = rcutils_get_default_allocator();
+      rcl_topic_endpoint_info_array_t info_array =
+        rcl_get_zero_initialized_topic_endpoint_info_array();
+      rcl_ret_t ret =
+        rcl_get_info_by_topic(rcl_node_handle, &allocator, fqdn.c_str(), no_mangle, &info_array);
+      if (RCL_RET_OK != ret) {
+        auto error_msg =
+          std::string("Failed to get information by topic for ") + EndpointType + std::string(":");
+        if (RCL_RET_UNSUPPORTED == ret) {
+          error_msg += std::string("function not supported by RMW_IMPLEMENTATION");
+        } else {
+          error_msg += rcl_get_error_string().str;
+        }
+        rcl_reset_error();
+        if (RCL_RET_OK != rcl_topic_endpoint_info_array_fini(&info_array, &allocator)) {
+          error_msg += std::string(", failed also to cleanup topic info array, leaking memory: ") +
+            rcl_get_error_string().str;
+          rcl_reset_error();
+        }
+        throw_from_rcl_error(ret, error_msg);
+      }
 
-  std::vector<rclcpp::TopicEndpointInfo> topic_info_list = convert_to_topic_info_list(info_array);
-  ret = rcl_topic_endpoint_info_array_fini(&info_array, &allocator);
-  if (RCL_RET_OK != ret) {
-    throw_from_rcl_error(ret, "rcl_topic_info_array_fini failed.");
-  }
+      std::vector<rclcpp::TopicEndpointInfo> topic_info_list =
+        convert_to_topic_info_list(info_array);
+      ret = rcl_topic_endpoint_info_array_fini(&info_array, &allocator);
+      if (RCL_RET_OK != ret) {
+        throw_from_rcl_error(ret, "rcl_topic_info_array_fini failed.");
+      }
 
-  return topic_info_list;
+      return topic_info_list;
+    };
+  return cached_query<std::vector<rclcpp::TopicEndpointInfo>>(
+    graph_cache,
+    std::string(EndpointType) + (no_mangle ? " no_mangle " : " ") + fqdn,
+    query);
 }
 
 static constexpr char kPublisherEndpointTypeName[] = "publishers";
@@ -515,6 +670,7 @@ NodeGraph::get_publishers_info_by_topic(
 {
   return get_info_by_topic<kPublisherEndpointTypeName>(
     node_base_,
+    get_graph_cache(),
     topic_name,
     no_mangle,
     rcl_get_publishers_info_by_topic);
@@ -528,6 +684,7 @@ NodeGraph::get_subscriptions_info_by_topic(
 {
   return get_info_by_topic<kSubscriptionEndpointTypeName>(
     node_base_,
+    get_graph_cache(),
     topic_name,
     no_mangle,
     rcl_get_subscriptions_info_by_topic);
@@ -14,12 +14,31 @@
 
 #include "rclcpp/node_interfaces/node_logging.hpp"
 
+#include <algorithm>
+#include <cstring>
+#include <string>
+
 using rclcpp::node_interfaces::NodeLogging;
 
 NodeLogging::NodeLogging(rclcpp::node_interfaces::NodeBaseInterface * node_base)
 : node_base_(node_base)
 {
-  logger_ = rclcpp::get_logger(this->get_logger_name());
+  const rcl_node_t * rcl_node = node_base_->get_rcl_node_handle();
+  if (0 == std::strcmp(
+      rcl_node_get_fully_qualified_name(rcl_node), node_base_->get_fully_qualified_name()))
+  {
+    logger_name_ = rcl_node_get_logger_name(rcl_node);
+  } else {
+    // The rcl node is shared with other nodes, named like rcl names the logger of a node.
+    logger_name_ = node_base_->get_namespace();
+    std::replace(logger_name_.begin(), logger_name_.end(), '/', '.');
+    logger_name_.erase(0, 1);
+    if (!logger_name_.empty()) {
+      logger_name_ += '.';
+    }
+    logger_name_ += node_base_->get_name();
+  }
+  logger_ = rclcpp::get_logger(logger_name_);
 }
 
 NodeLogging::~NodeLogging()
@@ -35,5 +54,5 @@ NodeLogging::get_logger() const
 const char *
 NodeLogging::get_logger_name() const
 {
-  return rcl_node_get_logger_name(node_base_->get_rcl_node_handle());
+  return logger_name_.c_str();
 }
@@ -16,7 +16,9 @@
 
 #include <rcl_yaml_param_parser/parser.h>
 
+#include <algorithm>
 #include <array>
+#include <chrono>
 #include <cmath>
 #include <cstdlib>
 #include <cstring>
@@ -24,8 +26,10 @@
 #include <limits>
 #include <map>
 #include <memory>
+#include <set>
 #include <sstream>
 #include <string>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 
@@ -51,9 +55,12 @@ NodeParameters::NodeParameters(
   const rclcpp::QoS & parameter_event_qos,
   const rclcpp::PublisherOptionsBase & parameter_event_publisher_options,
   bool allow_undeclared_parameters,
-  bool automatically_declare_parameters_from_overrides)
+  bool automatically_declare_parameters_from_overrides,
+  std::chrono::nanoseconds parameter_event_coalescing_period,
+  std::shared_ptr<const rclcpp::ParameterSnapshot> parameter_snapshot)
 : allow_undeclared_(allow_undeclared_parameters),
   events_publisher_(nullptr),
+  event_coalescing_period_(parameter_event_coalescing_period),
   node_logging_(node_logging),
   node_clock_(node_clock)
 {
@@ -88,15 +95,31 @@ NodeParameters::NodeParameters(
     throw std::runtime_error("Need valid node options in NodeParameters");
   }
 
-  const rcl_arguments_t * global_args = nullptr;
-  if (options->use_global_arguments) {
-    auto context_ptr = node_base->get_context()->get_rcl_context();
-    global_args = &(context_ptr->global_arguments);
-  }
   combined_name_ = node_base->get_fully_qualified_name();
 
-  parameter_overrides_ = rclcpp::detail::resolve_parameter_overrides(
-    combined_name_, parameter_overrides, &options->arguments, global_args);
+  if (parameter_snapshot) {
+    // The overrides were resolved and the parameters declared and validated by the
+    // node the snapshot was taken from.
+    parameter_overrides_ = parameter_snapshot->parameter_overrides;
+    for (const auto & parameter : parameter_snapshot->parameters) {
+      const std::string & name = parameter.first.get_name();
+      ParameterInfo & parameter_info = parameters_[name];
+      parameter_info.value = parameter.first.get_parameter_value();
+      parameter_info.descriptor = parameter.second;
+      restored_parameters_.insert(name);
+    }
+  } else {
+    const rcl_arguments_t * global_args = nullptr;
+    std::shared_ptr<rclcpp::detail::GlobalParameterOverrides> global_args_cache;
+    if (options->use_global_arguments) {
+      auto context = node_base->get_context();
+      global_args = &(context->get_rcl_context()->global_arguments);
+      global_args_cache = context->get_sub_context<rclcpp::detail::GlobalParameterOverrides>();
+    }
+    parameter_overrides_ = rclcpp::detail::resolve_parameter_overrides(
+      combined_name_, parameter_overrides, &options->arguments, global_args,
+      global_args_cache.get());
+  }
 
   // If asked, initialize any parameters that ended up in the initial parameter values,
   // but did not get declared explcitily by this point.
@@ -113,10 +136,138 @@ NodeParameters::NodeParameters(
       }
     }
   }
+
+  // Started last, for the destructor to join it, the events above are published by it too.
+  if (events_publisher_ && event_coalescing_period_ > std::chrono::nanoseconds::zero()) {
+    coalesced_events_thread_ = std::thread(&NodeParameters::run_coalesced_events, this);
+  }
 }
 
 NodeParameters::~NodeParameters()
-{}
+{
+  if (coalesced_events_thread_.joinable()) {
+    {
+      std::lock_guard<std::mutex> lock(pending_event_mutex_);
+      stop_coalesced_events_ = true;
+    }
+    pending_event_cv_.notify_one();
+    // The thread publishes the pending event before returning.
+    coalesced_events_thread_.join();
+  }
+}
+
+static
+bool
+__is_empty_parameter_event(const rcl_interfaces::msg::ParameterEvent & parameter_event)
+{
+  return parameter_event.new_parameters.empty() &&
+         parameter_event.changed_parameters.empty() &&
+         parameter_event.deleted_parameters.empty();
+}
+
+// Remove the parameter of the given name from the list, return true if it was in it.
+static
+bool
+__erase_parameter_msg(
+  std::vector<rcl_interfaces::msg::Parameter> & parameters,
+  const std::string & name)
+{
+  auto it = std::find_if(
+    parameters.begin(), parameters.end(),
+    [&name](const rcl_interfaces::msg::Parameter & p) {return p.name == name;});
+  if (it == parameters.end()) {
+    return false;
+  }
+  parameters.erase(it);
+  return true;
+}
+
+// Merge a parameter event into a pending one, which then holds the changes of both.
+static
+void
+__merge_parameter_event(
+  rcl_interfaces::msg::ParameterEvent & pending,
+  const rcl_interfaces::msg::ParameterEvent & parameter_event)
+{
+  for (const auto & parameter : parameter_event.new_parameters) {
+    if (__erase_parameter_msg(pending.deleted_parameters, parameter.name)) {
+      // Deleted and declared again, a change for whoever knew the previous value.
+      pending.changed_parameters.push_back(parameter);
+    } else {
+      pending.new_parameters.push_back(parameter);
+    }
+  }
+  for (const auto & parameter : parameter_event.changed_parameters) {
+    if (__erase_parameter_msg(pending.new_parameters, parameter.name)) {
+      pending.new_parameters.push_back(parameter);
+    } else {
+      __erase_parameter_msg(pending.changed_parameters, parameter.name);
+      pending.changed_parameters.push_back(parameter);
+    }
+  }
+  for (const auto & parameter : parameter_event.deleted_parameters) {
+    if (!__erase_parameter_msg(pending.new_parameters, parameter.name)) {
+      __erase_parameter_msg(pending.changed_parameters, parameter.name);
+      pending.deleted_parameters.push_back(parameter);
+    }
+  }
+}
+
+void
+NodeParameters::publish_parameter_event(rcl_interfaces::msg::ParameterEvent & parameter_event)
+{
+  // Publish if events_publisher_ is not nullptr, which may be if disabled in the constructor.
+  if (nullptr == events_publisher_) {
+    return;
+  }
+  if (event_coalescing_period_ <= std::chrono::nanoseconds::zero()) {
+    parameter_event.node = combined_name_;
+    parameter_event.stamp = node_clock_->get_clock()->now();
+    events_publisher_->publish(parameter_event);
+    return;
+  }
+  if (__is_empty_parameter_event(parameter_event)) {
+    return;
+  }
+  bool was_empty;
+  {
+    std::lock_guard<std::mutex> lock(pending_event_mutex_);
+    was_empty = __is_empty_parameter_event(pending_event_);
+    __merge_parameter_event(pending_event_, parameter_event);
+  }
+  if (was_empty) {
+    pending_event_cv_.notify_one();
+  }
+}
+
+void
+NodeParameters::run_coalesced_events()
+{
+  std::unique_lock<std::mutex> lock(pending_event_mutex_);
+  while (true) {
+    pending_event_cv_.wait(
+      lock, [this]() {
+        return stop_coalesced_events_ || !__is_empty_parameter_event(pending_event_);
+      });
+    if (!stop_coalesced_events_) {
+      // Gather the changes made within the period after the first one.
+      pending_event_cv_.wait_for(
+        lock, event_coalescing_period_, [this]() {return stop_coalesced_events_;});
+    }
+    if (!__is_empty_parameter_event(pending_event_)) {
+      rcl_interfaces::msg::ParameterEvent parameter_event;
+      std::swap(parameter_event, pending_event_);
+      lock.unlock();
+      parameter_event.node = combined_name_;
+      parameter_event.stamp = node_clock_->get_clock()->now();
+      events_publisher_->publish(parameter_event);
+      lock.lock();
+    }
+    if (stop_coalesced_events_) {
+      return;
+    }
+  }
+}
 
 RCLCPP_LOCAL
 bool
@@ -387,6 +538,33 @@ __declare_parameter_common(
   return result;
 }
 
+// Take a parameter restored from a snapshot as declared, return true if it was restored.
+static
+bool
+__claim_restored_parameter(
+  const std::string & name,
+  rclcpp::ParameterType type,
+  const rcl_interfaces::msg::ParameterDescriptor & parameter_descriptor,
+  std::map<std::string, rclcpp::node_interfaces::ParameterInfo> & parameters,
+  std::set<std::string> & restored_parameters)
+{
+  auto restored_it = restored_parameters.find(name);
+  if (restored_it == restored_parameters.end()) {
+    return false;
+  }
+  restored_parameters.erase(restored_it);
+  const auto & restored_descriptor = parameters.at(name).descriptor;
+  if (
+    restored_descriptor.dynamic_typing == parameter_descriptor.dynamic_typing &&
+    (parameter_descriptor.dynamic_typing || restored_descriptor.type == type))
+  {
+    return true;
+  }
+  // Declared differently than when the snapshot was taken, so declared again as usual.
+  parameters.erase(name);
+  return false;
+}
+
 static
 const rclcpp::ParameterValue &
 declare_parameter_helper(
@@ -399,9 +577,7 @@ declare_parameter_helper(
   const std::map<std::string, rclcpp::ParameterValue> & overrides,
   CallbacksContainerType & callback_container,
   const OnParametersSetCallbackType & callback,
-  rclcpp::Publisher<rcl_interfaces::msg::ParameterEvent> * events_publisher,
-  const std::string & combined_name,
-  rclcpp::node_interfaces::NodeClockInterface & node_clock)
+  rcl_interfaces::msg::ParameterEvent & parameter_event)
 {
   // TODO(sloretz) parameter name validation
   if (name.empty()) {
@@ -427,7 +603,6 @@ declare_parameter_helper(
     parameter_descriptor.type = static_cast<uint8_t>(type);
   }
 
-  rcl_interfaces::msg::ParameterEvent parameter_event;
   auto result = __declare_parameter_common(
     name,
     default_value,
@@ -454,13 +629,6 @@ declare_parameter_helper(
             "parameter '" + name + "' could not be set: " + result.reason);
   }
 
-  // Publish if events_publisher_ is not nullptr, which may be if disabled in the constructor.
-  if (nullptr != events_publisher) {
-    parameter_event.node = combined_name;
-    parameter_event.stamp = node_clock.get_clock()->now();
-    events_publisher->publish(parameter_event);
-  }
-
   return parameters.at(name).value;
 }
 
@@ -482,7 +650,15 @@ NodeParameters::declare_parameter(
   std::lock_guard<std::recursive_mutex> lock(mutex_);
   ParameterMutationRecursionGuard guard(parameter_modification_enabled_);
 
-  return declare_parameter_helper(
+  if (
+    __claim_restored_parameter(
+      name, default_value.get_type(), parameter_descriptor, parameters_, restored_parameters_))
+  {
+    return parameters_.at(name).value;
+  }
+
+  rcl_interfaces::msg::ParameterEvent parameter_event;
+  const rclcpp::ParameterValue & value = declare_parameter_helper(
     name,
     rclcpp::PARAMETER_NOT_SET,
     default_value,
@@ -492,9 +668,10 @@ NodeParameters::declare_parameter(
     parameter_overrides_,
     on_parameters_set_callback_container_,
     on_parameters_set_callback_,
-    events_publisher_.get(),
-    combined_name_,
-    *node_clock_);
+    parameter_event);
+  publish_parameter_event(parameter_event);
+  update_parameter_handle(name);
+  return value;
 }
 
 const rclcpp::ParameterValue &
@@ -518,7 +695,15 @@ NodeParameters::declare_parameter(
             "with `dynamic_typing=true`"};
   }
 
-  return declare_parameter_helper(
+  if (
+    __claim_restored_parameter(
+      name, type, parameter_descriptor, parameters_, restored_parameters_))
+  {
+    return parameters_.at(name).value;
+  }
+
+  rcl_interfaces::msg::ParameterEvent parameter_event;
+  const rclcpp::ParameterValue & value = declare_parameter_helper(
     name,
     type,
     rclcpp::ParameterValue{},
@@ -528,9 +713,66 @@ NodeParameters::declare_parameter(
     parameter_overrides_,
     on_parameters_set_callback_container_,
     on_parameters_set_callback_,
-    events_publisher_.get(),
-    combined_name_,
-    *node_clock_);
+    parameter_event);
+  publish_parameter_event(parameter_event);
+  update_parameter_handle(name);
+  return value;
+}
+
+std::vector<rclcpp::ParameterValue>
+NodeParameters::declare_parameters(
+  const std::vector<std::pair<rclcpp::Parameter, rcl_interfaces::msg::ParameterDescriptor>> &
+  parameters,
+  bool ignore_overrides)
+{
+  std::lock_guard<std::recursive_mutex> lock(mutex_);
+  ParameterMutationRecursionGuard guard(parameter_modification_enabled_);
+
+  std::vector<rclcpp::ParameterValue> values;
+  values.reserve(parameters.size());
+  std::vector<bool> restored;
+  restored.reserve(parameters.size());
+  rcl_interfaces::msg::ParameterEvent parameter_event;
+  try {
+    for (const auto & parameter : parameters) {
+      const std::string & name = parameter.first.get_name();
+      restored.push_back(
+        __claim_restored_parameter(
+          name, parameter.first.get_type(), parameter.second, parameters_,
+          restored_parameters_));
+      if (restored.back()) {
+        values.push_back(parameters_.at(name).value);
+        continue;
+      }
+      values.push_back(
+        declare_parameter_helper(
+          parameter.first.get_name(),
+          rclcpp::PARAMETER_NOT_SET,
+          parameter.first.get_parameter_value(),
+          parameter.second,
+          ignore_overrides,
+          parameters_,
+          parameter_overrides_,
+          on_parameters_set_callback_container_,
+          on_parameters_set_callback_,
+          parameter_event));
+    }
+  } catch (...) {
+    // Undeclare the parameters declared before the failure, none of them was published.
+    for (size_t i = 0; i < values.size(); ++i) {
+      if (restored[i]) {
+        restored_parameters_.insert(parameters[i].first.get_name());
+      } else {
+        parameters_.erase(parameters[i].first.get_name());
+      }
+    }
+    throw;
+  }
+  publish_parameter_event(parameter_event);
+  for (const auto & parameter : parameters) {
+    update_parameter_handle(parameter.first.get_name());
+  }
+  return values;
 }
 
 void
@@ -556,6 +798,8 @@ NodeParameters::undeclare_parameter(const std::string & name)
   }
 
   parameters_.erase(parameter_info);
+  restored_parameters_.erase(name);
+  update_parameter_handle(name);
 }
 
 bool
@@ -777,12 +1021,12 @@ NodeParameters::set_parameters_atomically(const std::vector<rclcpp::Parameter> &
     parameter_event_msg.changed_parameters.push_back(parameter.to_parameter_msg());
   }
 
-  // Publish if events_publisher_ is not nullptr, which may be if disabled in the constructor.
-  if (nullptr != events_publisher_) {
-    parameter_event_msg.stamp = node_clock_->get_clock()->now();
-    events_publisher_->publish(parameter_event_msg);
+  for (const auto & parameter : *parameters_to_be_set) {
+    update_parameter_handle(parameter.get_name());
   }
 
+  publish_parameter_event(parameter_event_msg);
+
   return result;
 }
 
@@ -849,6 +1093,45 @@ NodeParameters::get_parameter(
   }
 }
 
+rclcpp::ParameterHandle::SharedPtr
+NodeParameters::get_parameter_handle(const std::string & name)
+{
+  std::lock_guard<std::recursive_mutex> lock(mutex_);
+
+  auto handle_iter = parameter_handles_.find(name);
+  if (parameter_handles_.end() != handle_iter) {
+    if (auto handle = handle_iter->second.lock()) {
+      return handle;
+    }
+  }
+  auto param_iter = parameters_.find(name);
+  if (parameters_.end() == param_iter && !allow_undeclared_) {
+    throw rclcpp::exceptions::ParameterNotDeclaredException(name);
+  }
+  auto handle = std::make_shared<rclcpp::ParameterHandle>(
+    name,
+    parameters_.end() == param_iter ? rclcpp::ParameterValue{} : param_iter->second.value);
+  parameter_handles_[name] = handle;
+  return handle;
+}
+
+void
+NodeParameters::update_parameter_handle(const std::string & name)
+{
+  auto handle_iter = parameter_handles_.find(name);
+  if (parameter_handles_.end() == handle_iter) {
+    return;
+  }
+  auto handle = handle_iter->second.lock();
+  if (!handle) {
+    parameter_handles_.erase(handle_iter);
+    return;
+  }
+  auto param_iter = parameters_.find(name);
+  handle->set_parameter_value(
+    parameters_.end() == param_iter ? rclcpp::ParameterValue{} : param_iter->second.value);
+}
+
 bool
 NodeParameters::get_parameters_by_prefix(
   const std::string & prefix,
@@ -859,10 +1142,14 @@ NodeParameters::get_parameters_by_prefix(
   std::string prefix_with_dot = prefix.empty() ? prefix : prefix + ".";
   bool ret = false;
 
-  for (const auto & param : parameters_) {
-    if (param.first.find(prefix_with_dot) == 0 && param.first.length() > prefix_with_dot.length()) {
+  // The parameters with the prefix are contiguous in the sorted map
+  for (auto it = parameters_.lower_bound(prefix_with_dot);
+    it != parameters_.end() && 0 == it->first.compare(0, prefix_with_dot.length(), prefix_with_dot);
+    ++it)
+  {
+    if (it->first.length() > prefix_with_dot.length()) {
       // Found one!
-      parameters[param.first.substr(prefix_with_dot.length())] = rclcpp::Parameter(param.second);
+      parameters[it->first.substr(prefix_with_dot.length())] = rclcpp::Parameter(it->second);
       ret = true;
     }
   }
@@ -932,38 +1219,61 @@ NodeParameters::list_parameters(const std::vector<std::string> & prefixes, uint6
 
   // TODO(mikaelarguedas) define parameter separator different from "/" to avoid ambiguity
   // using "." for now
-  const char * separator = ".";
-  for (auto & kv : parameters_) {
-    bool get_all = (prefixes.size() == 0) &&
-      ((depth == rcl_interfaces::srv::ListParameters::Request::DEPTH_RECURSIVE) ||
-      (static_cast<uint64_t>(std::count(kv.first.begin(), kv.first.end(), *separator)) < depth));
-    bool prefix_matches = std::any_of(
-      prefixes.cbegin(), prefixes.cend(),
-      [&kv, &depth, &separator](const std::string & prefix) {
-        if (kv.first == prefix) {
-          return true;
-        } else if (kv.first.find(prefix + separator) == 0) {
-          size_t length = prefix.length();
-          std::string substr = kv.first.substr(length);
-          // Cast as unsigned integer to avoid warning
-          return (depth == rcl_interfaces::srv::ListParameters::Request::DEPTH_RECURSIVE) ||
-          (static_cast<uint64_t>(std::count(substr.begin(), substr.end(), *separator)) < depth);
-        }
-        return false;
-      });
-    if (get_all || prefix_matches) {
-      result.names.push_back(kv.first);
-      size_t last_separator = kv.first.find_last_of(separator);
-      if (std::string::npos != last_separator) {
-        std::string prefix = kv.first.substr(0, last_separator);
-        if (
-          std::find(result.prefixes.cbegin(), result.prefixes.cend(), prefix) ==
-          result.prefixes.cend())
-        {
-          result.prefixes.push_back(prefix);
+  const char separator = '.';
+  auto is_within_depth =
+    [depth, separator](const std::string & name, size_t offset) {
+      // Cast as unsigned integer to avoid warning
+      return (depth == rcl_interfaces::srv::ListParameters::Request::DEPTH_RECURSIVE) ||
+             (static_cast<uint64_t>(std::count(name.begin() + offset, name.end(), separator)) <
+             depth);
+    };
+
+  // Only the parameters under the prefixes are visited, the ones under a prefix being
+  // contiguous in the sorted map
+  using ParameterIterator = std::map<std::string, ParameterInfo>::const_iterator;
+  std::vector<ParameterIterator> matches;
+  if (prefixes.empty()) {
+    for (auto it = parameters_.cbegin(); it != parameters_.cend(); ++it) {
+      if (is_within_depth(it->first, 0u)) {
+        matches.push_back(it);
+      }
+    }
+  } else {
+    for (const std::string & prefix : prefixes) {
+      auto it = parameters_.find(prefix);
+      if (it != parameters_.cend()) {
+        matches.push_back(it);
+      }
+      const std::string prefix_with_separator = prefix + separator;
+      for (it = parameters_.lower_bound(prefix_with_separator);
+        it != parameters_.cend() &&
+        0 == it->first.compare(0, prefix_with_separator.length(), prefix_with_separator);
+        ++it)
+      {
+        if (is_within_depth(it->first, prefix.length())) {
+          matches.push_back(it);
         }
       }
     }
+    // Keep the order of the map and list the parameters under several prefixes once
+    auto by_name = [](const ParameterIterator & a, const ParameterIterator & b) {
+        return a->first < b->first;
+      };
+    std::sort(matches.begin(), matches.end(), by_name);
+    matches.erase(std::unique(matches.begin(), matches.end()), matches.end());
+  }
+
+  std::unordered_set<std::string> listed_prefixes;
+  result.names.reserve(matches.size());
+  for (const auto & it : matches) {
+    result.names.push_back(it->first);
+    size_t last_separator = it->first.find_last_of(separator);
+    if (std::string::npos != last_separator) {
+      std::string prefix = it->first.substr(0, last_separator);
+      if (listed_prefixes.insert(prefix).second) {
+        result.prefixes.push_back(std::move(prefix));
+      }
+    }
   }
   return result;
 }
@@ -1006,3 +1316,18 @@ NodeParameters::get_parameter_overrides() const
 {
   return parameter_overrides_;
 }
+
+rclcpp::ParameterSnapshot
+NodeParameters::get_parameter_snapshot() const
+{
+  std::lock_guard<std::recursive_mutex> lock(mutex_);
+
+  rclcpp::ParameterSnapshot snapshot;
+  snapshot.parameter_overrides = parameter_overrides_;
+  snapshot.parameters.reserve(parameters_.size());
+  for (const auto & parameter : parameters_) {
+    snapshot.parameters.emplace_back(
+      rclcpp::Parameter(parameter.first, parameter.second.value), parameter.second.descriptor);
+  }
+  return snapshot;
+}
@@ -41,10 +41,16 @@ NodeTimers::add_timer(
   } else {
     node_base_->get_default_callback_group()->add_timer(timer);
   }
-  if (rcl_trigger_guard_condition(node_base_->get_notify_guard_condition()) != RCL_RET_OK) {
-    throw std::runtime_error(
-            std::string("Failed to notify wait set on timer creation: ") +
-            rmw_get_error_string().str);
+  {
+    auto notify_guard_condition_lock = node_base_->acquire_notify_guard_condition_lock();
+    // Notified once for the whole batch of entities being created if it is deferred.
+    if (!node_base_->defer_entity_notification() &&
+      rcl_trigger_guard_condition(node_base_->get_notify_guard_condition()) != RCL_RET_OK)
+    {
+      throw std::runtime_error(
+              std::string("Failed to notify wait set on timer creation: ") +
+              rmw_get_error_string().str);
+    }
   }
   TRACEPOINT(
     rclcpp_timer_link_node,
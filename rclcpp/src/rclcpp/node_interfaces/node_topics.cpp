@@ -14,7 +14,11 @@
 
 #include "rclcpp/node_interfaces/node_topics.hpp"
 
+#include <algorithm>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <vector>
 
 #include "rclcpp/exceptions.hpp"
 
@@ -55,13 +59,15 @@ NodeTopics::add_publisher(
     callback_group = node_base_->get_default_callback_group();
   }
 
-  for (auto & publisher_event : publisher->get_event_handlers()) {
-    callback_group->add_waitable(publisher_event);
-  }
+  add_event_handlers(publisher->get_event_handlers(), callback_group);
 
   // Notify the executor that a new publisher was created using the parent Node.
   {
     auto notify_guard_condition_lock = node_base_->acquire_notify_guard_condition_lock();
+    if (node_base_->defer_entity_notification()) {
+      // Notified once for the whole batch of entities being created.
+      return;
+    }
     if (rcl_trigger_guard_condition(node_base_->get_notify_guard_condition()) != RCL_RET_OK) {
       throw std::runtime_error(
               std::string("Failed to notify wait set on publisher creation: ") +
@@ -97,9 +103,7 @@ NodeTopics::add_subscription(
 
   callback_group->add_subscription(subscription);
 
-  for (auto & subscription_event : subscription->get_event_handlers()) {
-    callback_group->add_waitable(subscription_event);
-  }
+  add_event_handlers(subscription->get_event_handlers(), callback_group);
 
   auto intra_process_waitable = subscription->get_intra_process_waitable();
   if (nullptr != intra_process_waitable) {
@@ -107,9 +111,19 @@ NodeTopics::add_subscription(
     callback_group->add_waitable(intra_process_waitable);
   }
 
+  auto shared_memory_waitable = subscription->get_shared_memory_waitable();
+  if (nullptr != shared_memory_waitable) {
+    // Add to the callback group to be notified about the messages of the host.
+    callback_group->add_waitable(shared_memory_waitable);
+  }
+
   // Notify the executor that a new subscription was created using the parent Node.
   {
     auto notify_guard_condition_lock = node_base_->acquire_notify_guard_condition_lock();
+    if (node_base_->defer_entity_notification()) {
+      // Notified once for the whole batch of entities being created.
+      return;
+    }
     auto ret = rcl_trigger_guard_condition(node_base_->get_notify_guard_condition());
     if (ret != RCL_RET_OK) {
       using rclcpp::exceptions::throw_from_rcl_error;
@@ -118,6 +132,42 @@ NodeTopics::add_subscription(
   }
 }
 
+void
+NodeTopics::add_event_handlers(
+  const std::vector<std::shared_ptr<rclcpp::QOSEventHandlerBase>> & event_handlers,
+  const rclcpp::CallbackGroup::SharedPtr & callback_group)
+{
+  if (event_handlers.empty()) {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(event_handler_groups_mutex_);
+  // Forget the waitables of the callback groups which no longer exist.
+  event_handler_groups_.erase(
+    std::remove_if(
+      event_handler_groups_.begin(), event_handler_groups_.end(),
+      [](const auto & event_handler_group) {
+        return event_handler_group.first.expired();
+      }),
+    event_handler_groups_.end());
+
+  auto it = std::find_if(
+    event_handler_groups_.begin(), event_handler_groups_.end(),
+    [&callback_group](const auto & event_handler_group) {
+      return event_handler_group.first.lock() == callback_group;
+    });
+  rclcpp::QOSEventHandlerGroup::SharedPtr event_handler_group;
+  if (it != event_handler_groups_.end()) {
+    event_handler_group = it->second;
+  } else {
+    event_handler_group = std::make_shared<rclcpp::QOSEventHandlerGroup>();
+    callback_group->add_waitable(event_handler_group);
+    event_handler_groups_.emplace_back(callback_group, event_handler_group);
+  }
+  for (const auto & event_handler : event_handlers) {
+    event_handler_group->add_event_handler(event_handler);
+  }
+}
+
 rclcpp::node_interfaces::NodeBaseInterface *
 NodeTopics::get_node_base_interface() const
 {
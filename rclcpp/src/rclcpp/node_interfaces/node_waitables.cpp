@@ -43,6 +43,10 @@ NodeWaitables::add_waitable(
   // Notify the executor that a new waitable was created using the parent Node.
   {
     auto notify_guard_condition_lock = node_base_->acquire_notify_guard_condition_lock();
+    if (node_base_->defer_entity_notification()) {
+      // Notified once for the whole batch of entities being created.
+      return;
+    }
     if (rcl_trigger_guard_condition(node_base_->get_notify_guard_condition()) != RCL_RET_OK) {
       throw std::runtime_error(
               std::string("Failed to notify wait set on waitable creation: ") +
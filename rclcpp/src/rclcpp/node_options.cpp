@@ -14,8 +14,10 @@
 
 #include "rclcpp/node_options.hpp"
 
+#include <chrono>
 #include <limits>
 #include <memory>
+#include <stdexcept>
 #include <string>
 #include <vector>
 #include <utility>
@@ -75,17 +77,26 @@ NodeOptions::operator=(const NodeOptions & other)
     this->enable_rosout_ = other.enable_rosout_;
     this->use_intra_process_comms_ = other.use_intra_process_comms_;
     this->enable_topic_statistics_ = other.enable_topic_statistics_;
+    this->use_graph_cache_ = other.use_graph_cache_;
     this->start_parameter_services_ = other.start_parameter_services_;
     this->start_parameter_event_publisher_ = other.start_parameter_event_publisher_;
     this->clock_qos_ = other.clock_qos_;
     this->use_clock_thread_ = other.use_clock_thread_;
+    this->use_shared_clock_subscription_ = other.use_shared_clock_subscription_;
     this->parameter_event_qos_ = other.parameter_event_qos_;
     this->rosout_qos_ = other.rosout_qos_;
+    this->rosout_batch_period_ = other.rosout_batch_period_;
+    this->rosout_max_batch_size_ = other.rosout_max_batch_size_;
     this->parameter_event_publisher_options_ = other.parameter_event_publisher_options_;
+    this->parameter_event_coalescing_period_ = other.parameter_event_coalescing_period_;
+    this->parameter_snapshot_ = other.parameter_snapshot_;
     this->allow_undeclared_parameters_ = other.allow_undeclared_parameters_;
     this->automatically_declare_parameters_from_overrides_ =
       other.automatically_declare_parameters_from_overrides_;
+    this->lazy_node_interfaces_ = other.lazy_node_interfaces_;
+    this->shared_rcl_node_handle_ = other.shared_rcl_node_handle_;
     this->allocator_ = other.allocator_;
+    this->arena_ = other.arena_;
   }
   return *this;
 }
@@ -234,6 +245,19 @@ NodeOptions::enable_topic_statistics(bool enable_topic_statistics)
   return *this;
 }
 
+bool
+NodeOptions::use_graph_cache() const
+{
+  return this->use_graph_cache_;
+}
+
+NodeOptions &
+NodeOptions::use_graph_cache(bool use_graph_cache)
+{
+  this->use_graph_cache_ = use_graph_cache;
+  return *this;
+}
+
 bool
 NodeOptions::start_parameter_services() const
 {
@@ -286,6 +310,19 @@ NodeOptions::use_clock_thread(bool use_clock_thread)
   return *this;
 }
 
+bool
+NodeOptions::use_shared_clock_subscription() const
+{
+  return this->use_shared_clock_subscription_;
+}
+
+NodeOptions &
+NodeOptions::use_shared_clock_subscription(bool use_shared_clock_subscription)
+{
+  this->use_shared_clock_subscription_ = use_shared_clock_subscription;
+  return *this;
+}
+
 const rclcpp::QoS &
 NodeOptions::parameter_event_qos() const
 {
@@ -313,6 +350,35 @@ NodeOptions::rosout_qos(const rclcpp::QoS & rosout_qos)
   return *this;
 }
 
+std::chrono::nanoseconds
+NodeOptions::rosout_batch_period() const
+{
+  return this->rosout_batch_period_;
+}
+
+NodeOptions &
+NodeOptions::rosout_batch_period(std::chrono::nanoseconds rosout_batch_period)
+{
+  this->rosout_batch_period_ = rosout_batch_period;
+  return *this;
+}
+
+size_t
+NodeOptions::rosout_max_batch_size() const
+{
+  return this->rosout_max_batch_size_;
+}
+
+NodeOptions &
+NodeOptions::rosout_max_batch_size(size_t rosout_max_batch_size)
+{
+  if (0u == rosout_max_batch_size) {
+    throw std::invalid_argument("rosout_max_batch_size must be greater than zero");
+  }
+  this->rosout_max_batch_size_ = rosout_max_batch_size;
+  return *this;
+}
+
 const rclcpp::PublisherOptionsBase &
 NodeOptions::parameter_event_publisher_options() const
 {
@@ -327,6 +393,34 @@ NodeOptions::parameter_event_publisher_options(
   return *this;
 }
 
+std::chrono::nanoseconds
+NodeOptions::parameter_event_coalescing_period() const
+{
+  return this->parameter_event_coalescing_period_;
+}
+
+NodeOptions &
+NodeOptions::parameter_event_coalescing_period(
+  std::chrono::nanoseconds parameter_event_coalescing_period)
+{
+  this->parameter_event_coalescing_period_ = parameter_event_coalescing_period;
+  return *this;
+}
+
+std::shared_ptr<const rclcpp::ParameterSnapshot>
+NodeOptions::parameter_snapshot() const
+{
+  return this->parameter_snapshot_;
+}
+
+NodeOptions &
+NodeOptions::parameter_snapshot(
+  std::shared_ptr<const rclcpp::ParameterSnapshot> parameter_snapshot)
+{
+  this->parameter_snapshot_ = parameter_snapshot;
+  return *this;
+}
+
 bool
 NodeOptions::allow_undeclared_parameters() const
 {
@@ -355,6 +449,32 @@ NodeOptions::automatically_declare_parameters_from_overrides(
   return *this;
 }
 
+bool
+NodeOptions::lazy_node_interfaces() const
+{
+  return this->lazy_node_interfaces_;
+}
+
+NodeOptions &
+NodeOptions::lazy_node_interfaces(bool lazy_node_interfaces)
+{
+  this->lazy_node_interfaces_ = lazy_node_interfaces;
+  return *this;
+}
+
+const std::shared_ptr<rcl_node_t> &
+NodeOptions::shared_rcl_node_handle() const
+{
+  return this->shared_rcl_node_handle_;
+}
+
+NodeOptions &
+NodeOptions::shared_rcl_node_handle(std::shared_ptr<rcl_node_t> shared_rcl_node_handle)
+{
+  this->shared_rcl_node_handle_ = std::move(shared_rcl_node_handle);
+  return *this;
+}
+
 const rcl_allocator_t &
 NodeOptions::allocator() const
 {
@@ -369,4 +489,20 @@ NodeOptions::allocator(rcl_allocator_t allocator)
   return *this;
 }
 
+const rclcpp::allocator::Arena::SharedPtr &
+NodeOptions::arena() const
+{
+  return this->arena_;
+}
+
+NodeOptions &
+NodeOptions::arena(rclcpp::allocator::Arena::SharedPtr arena)
+{
+  // Finalize the rcl node options before the arena they may be allocated from is released.
+  this->node_options_.reset();
+  this->arena_ = std::move(arena);
+  this->allocator_ = this->arena_ ? this->arena_->get_rcl_allocator() : rcl_get_default_allocator();
+  return *this;
+}
+
 }  // namespace rclcpp
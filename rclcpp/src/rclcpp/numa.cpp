@@ -0,0 +1,184 @@
+// Copyright 2021 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "rclcpp/numa.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "rclcpp/thread_attributes.hpp"
+
+using rclcpp::NumaNode;
+
+namespace
+{
+
+// Bounds the memory used for a malformed list, far above the number of CPUs of any host.
+constexpr size_t kMaxCpuIndex = 1 << 20;
+
+/// Read the first line of a file, return false if it cannot be read.
+bool
+read_line(const std::string & path, std::string & line)
+{
+  std::ifstream file(path);
+  return static_cast<bool>(std::getline(file, line));
+}
+
+/// Read the NUMA nodes from sysfs, return an empty list if they cannot be read.
+std::vector<NumaNode>
+read_sysfs_numa_nodes()
+{
+  std::vector<NumaNode> nodes;
+#if defined(__linux__)
+  const std::string node_directory = "/sys/devices/system/node/";
+  std::string line;
+  if (!read_line(node_directory + "online", line)) {
+    return nodes;
+  }
+  try {
+    for (size_t id : rclcpp::parse_cpu_list(line)) {
+      const std::string cpu_list_path = node_directory + "node" + std::to_string(id) + "/cpulist";
+      if (!read_line(cpu_list_path, line)) {
+        continue;
+      }
+      NumaNode node;
+      node.id = id;
+      node.cpus = rclcpp::parse_cpu_list(line);
+      if (!node.cpus.empty()) {
+        nodes.push_back(std::move(node));
+      }
+    }
+  } catch (const std::invalid_argument &) {
+    nodes.clear();
+  }
+#endif
+  return nodes;
+}
+
+/// Parse a non-negative decimal number at the given position, advancing it.
+size_t
+parse_index(const std::string & cpu_list, size_t & position)
+{
+  const size_t begin = position;
+  size_t value = 0;
+  for (; position < cpu_list.size(); ++position) {
+    const char digit = cpu_list[position];
+    if (!std::isdigit(static_cast<unsigned char>(digit))) {
+      break;
+    }
+    value = value * 10 + static_cast<size_t>(digit - '0');
+    if (value > kMaxCpuIndex) {
+      throw std::invalid_argument("CPU index out of range in CPU list '" + cpu_list + "'");
+    }
+  }
+  if (position == begin) {
+    throw std::invalid_argument("malformed CPU list '" + cpu_list + "'");
+  }
+  return value;
+}
+
+}  // namespace
+
+std::vector<size_t>
+rclcpp::parse_cpu_list(const std::string & cpu_list)
+{
+  const size_t first = cpu_list.find_first_not_of(" \t\r\n");
+  if (first == std::string::npos) {
+    return {};
+  }
+  const std::string trimmed =
+    cpu_list.substr(first, cpu_list.find_last_not_of(" \t\r\n") - first + 1);
+
+  std::vector<bool> is_listed;
+  size_t position = 0;
+  while (true) {
+    const size_t range_begin = parse_index(trimmed, position);
+    size_t range_end = range_begin;
+    if (position < trimmed.size() && trimmed[position] == '-') {
+      ++position;
+      range_end = parse_index(trimmed, position);
+      if (range_end < range_begin) {
+        throw std::invalid_argument("malformed CPU list '" + trimmed + "'");
+      }
+    }
+    if (range_end >= is_listed.size()) {
+      is_listed.resize(range_end + 1, false);
+    }
+    for (size_t cpu = range_begin; cpu <= range_end; ++cpu) {
+      is_listed[cpu] = true;
+    }
+    if (position == trimmed.size()) {
+      break;
+    }
+    if (trimmed[position] != ',') {
+      throw std::invalid_argument("malformed CPU list '" + trimmed + "'");
+    }
+    ++position;
+  }
+
+  std::vector<size_t> cpus;
+  for (size_t cpu = 0; cpu < is_listed.size(); ++cpu) {
+    if (is_listed[cpu]) {
+      cpus.push_back(cpu);
+    }
+  }
+  return cpus;
+}
+
+std::vector<NumaNode>
+rclcpp::get_numa_nodes()
+{
+  std::vector<NumaNode> nodes = read_sysfs_numa_nodes();
+  if (!nodes.empty()) {
+    return nodes;
+  }
+  // Without a known topology, all the CPUs are considered local to each other.
+  NumaNode node;
+  node.cpus = rclcpp::get_thread_attributes().cpu_affinity;
+  if (node.cpus.empty()) {
+    const size_t number_of_cpus = std::max(1u, std::thread::hardware_concurrency());
+    for (size_t cpu = 0; cpu < number_of_cpus; ++cpu) {
+      node.cpus.push_back(cpu);
+    }
+  }
+  nodes.push_back(std::move(node));
+  return nodes;
+}
+
+std::vector<rclcpp::ThreadAttributes>
+rclcpp::make_numa_thread_attributes(
+  size_t number_of_threads,
+  const std::vector<NumaNode> & nodes)
+{
+  if (nodes.empty()) {
+    throw std::invalid_argument("cannot spread the threads over no NUMA node");
+  }
+  for (const NumaNode & node : nodes) {
+    if (node.cpus.empty()) {
+      throw std::invalid_argument("NUMA node " + std::to_string(node.id) + " has no CPU");
+    }
+  }
+  std::vector<rclcpp::ThreadAttributes> thread_attributes(number_of_threads);
+  for (size_t i = 0; i < number_of_threads; ++i) {
+    thread_attributes[i].cpu_affinity = nodes[i * nodes.size() / number_of_threads].cpus;
+  }
+  return thread_attributes;
+}
@@ -19,14 +19,18 @@
 #include <functional>
 #include <future>
 #include <iterator>
+#include <map>
 #include <memory>
+#include <mutex>
 #include <stdexcept>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "./parameter_service_names.hpp"
 
 using rclcpp::AsyncParametersClient;
+using rclcpp::MultiNodeParametersClient;
 using rclcpp::SyncParametersClient;
 
 AsyncParametersClient::AsyncParametersClient(
@@ -390,6 +394,184 @@ AsyncParametersClient::wait_for_service_nanoseconds(std::chrono::nanoseconds tim
   return true;
 }
 
+namespace
+{
+
+using Targets = std::vector<std::pair<std::string, AsyncParametersClient::SharedPtr>>;
+
+// Results of a request sent to several nodes, gathered until the last one responds.
+template<typename ResultT>
+struct GatheredResults
+{
+  std::mutex mutex;
+  std::promise<std::map<std::string, ResultT>> promise;
+  std::map<std::string, ResultT> results;
+  size_t pending_responses;
+};
+
+// Send a request to each target with send(name, client, callback), not waiting for responses.
+template<typename ResultT, typename SendT>
+std::shared_future<std::map<std::string, ResultT>>
+fan_out(const Targets & targets, SendT send)
+{
+  auto gathered = std::make_shared<GatheredResults<ResultT>>();
+  auto future_result = gathered->promise.get_future().share();
+  gathered->pending_responses = targets.size();
+  if (targets.empty()) {
+    gathered->promise.set_value({});
+    return future_result;
+  }
+  for (const auto & target : targets) {
+    const std::string & node_name = target.first;
+    send(
+      node_name,
+      *target.second,
+      [gathered, node_name](std::shared_future<ResultT> future) {
+        std::lock_guard<std::mutex> lock(gathered->mutex);
+        gathered->results[node_name] = future.get();
+        if (--gathered->pending_responses == 0) {
+          gathered->promise.set_value(std::move(gathered->results));
+        }
+      });
+  }
+  return future_result;
+}
+
+}  // namespace
+
+MultiNodeParametersClient::MultiNodeParametersClient(
+  const rclcpp::node_interfaces::NodeBaseInterface::SharedPtr node_base_interface,
+  const rclcpp::node_interfaces::NodeTopicsInterface::SharedPtr node_topics_interface,
+  const rclcpp::node_interfaces::NodeGraphInterface::SharedPtr node_graph_interface,
+  const rclcpp::node_interfaces::NodeServicesInterface::SharedPtr node_services_interface,
+  const std::vector<std::string> & remote_node_names,
+  const rmw_qos_profile_t & qos_profile,
+  rclcpp::CallbackGroup::SharedPtr group)
+{
+  for (const auto & remote_node_name : remote_node_names) {
+    if (clients_.count(remote_node_name) != 0) {
+      continue;
+    }
+    clients_.emplace(
+      remote_node_name,
+      std::make_shared<AsyncParametersClient>(
+        node_base_interface,
+        node_topics_interface,
+        node_graph_interface,
+        node_services_interface,
+        remote_node_name,
+        qos_profile,
+        group));
+  }
+}
+
+std::vector<std::string>
+MultiNodeParametersClient::get_remote_node_names() const
+{
+  std::vector<std::string> names;
+  names.reserve(clients_.size());
+  for (const auto & client : clients_) {
+    names.push_back(client.first);
+  }
+  return names;
+}
+
+std::shared_future<
+  MultiNodeParametersClient::ResultsByNode<std::vector<rclcpp::Parameter>>>
+MultiNodeParametersClient::get_parameters(const std::vector<std::string> & names)
+{
+  using ResultT = std::vector<rclcpp::Parameter>;
+  return fan_out<ResultT>(
+    Targets(clients_.begin(), clients_.end()),
+    [&names](
+      const std::string &, AsyncParametersClient & client,
+      std::function<void(std::shared_future<ResultT>)> cb) {
+      client.get_parameters(names, cb);
+    });
+}
+
+std::shared_future<
+  MultiNodeParametersClient::ResultsByNode<std::vector<rcl_interfaces::msg::SetParametersResult>>>
+MultiNodeParametersClient::set_parameters(const std::vector<rclcpp::Parameter> & parameters)
+{
+  using ResultT = std::vector<rcl_interfaces::msg::SetParametersResult>;
+  return fan_out<ResultT>(
+    Targets(clients_.begin(), clients_.end()),
+    [&parameters](
+      const std::string &, AsyncParametersClient & client,
+      std::function<void(std::shared_future<ResultT>)> cb) {
+      client.set_parameters(parameters, cb);
+    });
+}
+
+std::shared_future<
+  MultiNodeParametersClient::ResultsByNode<std::vector<rcl_interfaces::msg::SetParametersResult>>>
+MultiNodeParametersClient::set_parameters(
+  const ResultsByNode<std::vector<rclcpp::Parameter>> & parameters)
+{
+  using ResultT = std::vector<rcl_interfaces::msg::SetParametersResult>;
+  Targets targets;
+  targets.reserve(parameters.size());
+  for (const auto & node_parameters : parameters) {
+    auto it = clients_.find(node_parameters.first);
+    if (it == clients_.end()) {
+      throw std::invalid_argument(
+              "node '" + node_parameters.first + "' is not a remote node of the client");
+    }
+    targets.emplace_back(*it);
+  }
+  return fan_out<ResultT>(
+    targets,
+    [&parameters](
+      const std::string & node_name, AsyncParametersClient & client,
+      std::function<void(std::shared_future<ResultT>)> cb) {
+      client.set_parameters(parameters.at(node_name), cb);
+    });
+}
+
+std::shared_future<
+  MultiNodeParametersClient::ResultsByNode<rcl_interfaces::msg::ListParametersResult>>
+MultiNodeParametersClient::list_parameters(
+  const std::vector<std::string> & prefixes,
+  uint64_t depth)
+{
+  using ResultT = rcl_interfaces::msg::ListParametersResult;
+  return fan_out<ResultT>(
+    Targets(clients_.begin(), clients_.end()),
+    [&prefixes, depth](
+      const std::string &, AsyncParametersClient & client,
+      std::function<void(std::shared_future<ResultT>)> cb) {
+      client.list_parameters(prefixes, depth, cb);
+    });
+}
+
+bool
+MultiNodeParametersClient::service_is_ready() const
+{
+  return std::all_of(
+    clients_.begin(), clients_.end(),
+    [](const auto & client) {return client.second->service_is_ready();});
+}
+
+bool
+MultiNodeParametersClient::wait_for_service_nanoseconds(std::chrono::nanoseconds timeout)
+{
+  for (auto & client : clients_) {
+    auto stamp = std::chrono::steady_clock::now();
+    if (!client.second->wait_for_service(timeout)) {
+      return false;
+    }
+    if (timeout > std::chrono::nanoseconds::zero()) {
+      timeout -= std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - stamp);
+      if (timeout < std::chrono::nanoseconds::zero()) {
+        timeout = std::chrono::nanoseconds::zero();
+      }
+    }
+  }
+  return true;
+}
+
 std::vector<rclcpp::Parameter>
 SyncParametersClient::get_parameters(
   const std::vector<std::string> & parameter_names,
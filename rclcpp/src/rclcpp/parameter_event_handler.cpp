@@ -69,7 +69,11 @@ ParameterEventHandler::add_parameter_callback(
   handle->parameter_name = parameter_name;
   handle->node_name = full_node_name;
   // the last callback registered is executed first.
-  parameter_callbacks_[{parameter_name, full_node_name}].emplace_front(handle);
+  auto & container = parameter_callbacks_[{parameter_name, full_node_name}];
+  if (container.empty()) {
+    ++parameter_callbacks_nodes_[full_node_name];
+  }
+  container.emplace_front(handle);
 
   return handle;
 }
@@ -91,6 +95,10 @@ ParameterEventHandler::remove_parameter_callback(
     container.erase(it);
     if (container.empty()) {
       parameter_callbacks_.erase({handle->parameter_name, handle->node_name});
+      auto node_it = parameter_callbacks_nodes_.find(handle->node_name);
+      if (node_it != parameter_callbacks_nodes_.end() && --node_it->second == 0) {
+        parameter_callbacks_nodes_.erase(node_it);
+      }
     }
   } else {
     throw std::runtime_error("Callback doesn't exist");
@@ -162,24 +170,34 @@ ParameterEventHandler::event_callback(const rcl_interfaces::msg::ParameterEvent
 {
   std::lock_guard<std::recursive_mutex> lock(mutex_);
 
-  for (auto it = parameter_callbacks_.begin(); it != parameter_callbacks_.end(); ++it) {
-    rclcpp::Parameter p;
-    if (get_parameter_from_event(event, p, it->first.first, it->first.second)) {
-      for (auto cb = it->second.begin(); cb != it->second.end(); ++cb) {
-        auto shared_handle = cb->lock();
-        if (nullptr != shared_handle) {
-          shared_handle->callback(p);
-        } else {
-          cb = it->second.erase(cb);
+  // Only the parameters of the event are looked up, and only if a callback is registered
+  // for a parameter of its node.
+  if (parameter_callbacks_nodes_.count(event.node) != 0) {
+    for (const auto * parameters : {&event.new_parameters, &event.changed_parameters}) {
+      for (const auto & parameter_msg : *parameters) {
+        auto it = parameter_callbacks_.find({parameter_msg.name, event.node});
+        if (it == parameter_callbacks_.end()) {
+          continue;
+        }
+        const auto p = rclcpp::Parameter::from_parameter_msg(parameter_msg);
+        for (auto cb = it->second.begin(); cb != it->second.end(); ) {
+          auto shared_handle = cb->lock();
+          if (nullptr != shared_handle) {
+            shared_handle->callback(p);
+            ++cb;
+          } else {
+            cb = it->second.erase(cb);
+          }
         }
       }
     }
   }
 
-  for (auto event_cb = event_callbacks_.begin(); event_cb != event_callbacks_.end(); ++event_cb) {
+  for (auto event_cb = event_callbacks_.begin(); event_cb != event_callbacks_.end(); ) {
     auto shared_event_handle = event_cb->lock();
     if (nullptr != shared_event_handle) {
       shared_event_handle->callback(event);
+      ++event_cb;
     } else {
       event_cb = event_callbacks_.erase(event_cb);
     }
@@ -0,0 +1,57 @@
+// Copyright 2021 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "rclcpp/parameter_handle.hpp"
+
+#include <memory>
+#include <string>
+
+using rclcpp::ParameterHandle;
+
+ParameterHandle::ParameterHandle(const std::string & name, const rclcpp::ParameterValue & value)
+: name_(name),
+  value_(std::make_unique<const rclcpp::ParameterValue>(value))
+{}
+
+const std::string &
+ParameterHandle::get_name() const
+{
+  return name_;
+}
+
+rclcpp::ParameterValue
+ParameterHandle::get_parameter_value() const
+{
+  auto snapshot = value_.read();
+  return *snapshot;
+}
+
+rclcpp::Parameter
+ParameterHandle::get_parameter() const
+{
+  return rclcpp::Parameter(name_, get_parameter_value());
+}
+
+rclcpp::ParameterType
+ParameterHandle::get_type() const
+{
+  auto snapshot = value_.read();
+  return snapshot->get_type();
+}
+
+void
+ParameterHandle::set_parameter_value(const rclcpp::ParameterValue & value)
+{
+  value_.update(std::make_unique<const rclcpp::ParameterValue>(value));
+}
@@ -0,0 +1,379 @@
+// Copyright 2021 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "rclcpp/parameter_snapshot.hpp"
+
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace
+{
+
+// "RCLPSNAP", followed by the version and a marker of the byte order.
+constexpr char snapshot_magic[8] = {'R', 'C', 'L', 'P', 'S', 'N', 'A', 'P'};
+constexpr uint32_t snapshot_version = 1;
+constexpr uint32_t byte_order_marker = 0x01020304;
+
+class Writer
+{
+public:
+  template<typename T>
+  void
+  write(T value)
+  {
+    static_assert(std::is_arithmetic<T>::value, "only arithmetic values are written as is");
+    const auto * bytes = reinterpret_cast<const uint8_t *>(&value);
+    data.insert(data.end(), bytes, bytes + sizeof(T));
+  }
+
+  void
+  write_size(size_t size)
+  {
+    write(static_cast<uint64_t>(size));
+  }
+
+  void
+  write(const std::string & value)
+  {
+    write_size(value.size());
+    data.insert(data.end(), value.begin(), value.end());
+  }
+
+  template<typename T>
+  void
+  write_array(const std::vector<T> & values)
+  {
+    write_size(values.size());
+    for (const auto & value : values) {
+      write(value);
+    }
+  }
+
+  void
+  write(const rclcpp::ParameterValue & value)
+  {
+    write(static_cast<uint8_t>(value.get_type()));
+    switch (value.get_type()) {
+      case rclcpp::PARAMETER_NOT_SET:
+        break;
+      case rclcpp::PARAMETER_BOOL:
+        write(static_cast<uint8_t>(value.get<bool>()));
+        break;
+      case rclcpp::PARAMETER_INTEGER:
+        write(value.get<int64_t>());
+        break;
+      case rclcpp::PARAMETER_DOUBLE:
+        write(value.get<double>());
+        break;
+      case rclcpp::PARAMETER_STRING:
+        write(value.get<std::string>());
+        break;
+      case rclcpp::PARAMETER_BYTE_ARRAY:
+        write_array(value.get<std::vector<uint8_t>>());
+        break;
+      case rclcpp::PARAMETER_BOOL_ARRAY:
+        write_size(value.get<std::vector<bool>>().size());
+        for (bool element : value.get<std::vector<bool>>()) {
+          write(static_cast<uint8_t>(element));
+        }
+        break;
+      case rclcpp::PARAMETER_INTEGER_ARRAY:
+        write_array(value.get<std::vector<int64_t>>());
+        break;
+      case rclcpp::PARAMETER_DOUBLE_ARRAY:
+        write_array(value.get<std::vector<double>>());
+        break;
+      case rclcpp::PARAMETER_STRING_ARRAY:
+        write_array(value.get<std::vector<std::string>>());
+        break;
+      default:
+        throw std::runtime_error("unknown parameter type");
+    }
+  }
+
+  void
+  write(const rcl_interfaces::msg::ParameterDescriptor & descriptor)
+  {
+    write(descriptor.name);
+    write(descriptor.type);
+    write(descriptor.description);
+    write(descriptor.additional_constraints);
+    write(static_cast<uint8_t>(descriptor.read_only));
+    write(static_cast<uint8_t>(descriptor.dynamic_typing));
+    write_size(descriptor.floating_point_range.size());
+    for (const auto & range : descriptor.floating_point_range) {
+      write(range.from_value);
+      write(range.to_value);
+      write(range.step);
+    }
+    write_size(descriptor.integer_range.size());
+    for (const auto & range : descriptor.integer_range) {
+      write(range.from_value);
+      write(range.to_value);
+      write(range.step);
+    }
+  }
+
+  std::vector<uint8_t> data;
+};
+
+class Reader
+{
+public:
+  explicit Reader(const std::vector<uint8_t> & data)
+  : data_(data)
+  {}
+
+  template<typename T>
+  T
+  read()
+  {
+    static_assert(std::is_arithmetic<T>::value, "only arithmetic values are read as is");
+    T value;
+    std::memcpy(&value, take(sizeof(T)), sizeof(T));
+    return value;
+  }
+
+  bool
+  read_bool()
+  {
+    return read<uint8_t>() != 0;
+  }
+
+  /// Read the number of elements of an array of elements of at least the given size.
+  size_t
+  read_size(size_t element_size)
+  {
+    const uint64_t size = read<uint64_t>();
+    // Checked against what is left, so that corrupted data doesn't allocate arbitrary sizes.
+    if (element_size > 0 && size > (data_.size() - offset_) / element_size) {
+      throw_invalid();
+    }
+    return static_cast<size_t>(size);
+  }
+
+  std::string
+  read_string()
+  {
+    const size_t size = read_size(1);
+    const auto * begin = reinterpret_cast<const char *>(take(size));
+    return std::string(begin, begin + size);
+  }
+
+  template<typename T>
+  std::vector<T>
+  read_array()
+  {
+    std::vector<T> values(read_size(sizeof(T)));
+    for (auto & value : values) {
+      value = read<T>();
+    }
+    return values;
+  }
+
+  rclcpp::ParameterValue
+  read_value()
+  {
+    switch (read<uint8_t>()) {
+      case rclcpp::PARAMETER_NOT_SET:
+        return rclcpp::ParameterValue();
+      case rclcpp::PARAMETER_BOOL:
+        return rclcpp::ParameterValue(read_bool());
+      case rclcpp::PARAMETER_INTEGER:
+        return rclcpp::ParameterValue(read<int64_t>());
+      case rclcpp::PARAMETER_DOUBLE:
+        return rclcpp::ParameterValue(read<double>());
+      case rclcpp::PARAMETER_STRING:
+        return rclcpp::ParameterValue(read_string());
+      case rclcpp::PARAMETER_BYTE_ARRAY:
+        return rclcpp::ParameterValue(read_array<uint8_t>());
+      case rclcpp::PARAMETER_BOOL_ARRAY:
+        {
+          std::vector<bool> values(read_size(1));
+          for (size_t i = 0; i < values.size(); ++i) {
+            values[i] = read_bool();
+          }
+          return rclcpp::ParameterValue(values);
+        }
+      case rclcpp::PARAMETER_INTEGER_ARRAY:
+        return rclcpp::ParameterValue(read_array<int64_t>());
+      case rclcpp::PARAMETER_DOUBLE_ARRAY:
+        return rclcpp::ParameterValue(read_array<double>());
+      case rclcpp::PARAMETER_STRING_ARRAY:
+        {
+          std::vector<std::string> values(read_size(sizeof(uint64_t)));
+          for (auto & value : values) {
+            value = read_string();
+          }
+          return rclcpp::ParameterValue(values);
+        }
+      default:
+        throw_invalid();
+    }
+  }
+
+  rcl_interfaces::msg::ParameterDescriptor
+  read_descriptor()
+  {
+    rcl_interfaces::msg::ParameterDescriptor descriptor;
+    descriptor.name = read_string();
+    descriptor.type = read<uint8_t>();
+    descriptor.description = read_string();
+    descriptor.additional_constraints = read_string();
+    descriptor.read_only = read_bool();
+    descriptor.dynamic_typing = read_bool();
+    descriptor.floating_point_range.resize(read_size(3 * sizeof(double)));
+    for (auto & range : descriptor.floating_point_range) {
+      range.from_value = read<double>();
+      range.to_value = read<double>();
+      range.step = read<double>();
+    }
+    descriptor.integer_range.resize(read_size(3 * sizeof(int64_t)));
+    for (auto & range : descriptor.integer_range) {
+      range.from_value = read<int64_t>();
+      range.to_value = read<int64_t>();
+      range.step = read<uint64_t>();
+    }
+    return descriptor;
+  }
+
+  bool
+  at_end() const
+  {
+    return offset_ == data_.size();
+  }
+
+  [[noreturn]] static void
+  throw_invalid()
+  {
+    throw std::runtime_error("invalid parameter snapshot");
+  }
+
+private:
+  const uint8_t *
+  take(size_t size)
+  {
+    if (size > data_.size() - offset_) {
+      throw_invalid();
+    }
+    const uint8_t * bytes = data_.data() + offset_;
+    offset_ += size;
+    return bytes;
+  }
+
+  const std::vector<uint8_t> & data_;
+  size_t offset_ = 0;
+};
+
+}  // namespace
+
+namespace rclcpp
+{
+
+std::vector<uint8_t>
+serialize_parameter_snapshot(const ParameterSnapshot & snapshot)
+{
+  Writer writer;
+  writer.data.insert(writer.data.end(), std::begin(snapshot_magic), std::end(snapshot_magic));
+  writer.write(snapshot_version);
+  writer.write(byte_order_marker);
+  writer.write_size(snapshot.parameter_overrides.size());
+  for (const auto & parameter_override : snapshot.parameter_overrides) {
+    writer.write(parameter_override.first);
+    writer.write(parameter_override.second);
+  }
+  writer.write_size(snapshot.parameters.size());
+  for (const auto & parameter : snapshot.parameters) {
+    writer.write(parameter.first.get_name());
+    writer.write(parameter.first.get_parameter_value());
+    writer.write(parameter.second);
+  }
+  return std::move(writer.data);
+}
+
+ParameterSnapshot
+deserialize_parameter_snapshot(const std::vector<uint8_t> & data)
+{
+  if (data.size() < sizeof(snapshot_magic) ||
+    0 != std::memcmp(data.data(), snapshot_magic, sizeof(snapshot_magic)))
+  {
+    throw std::runtime_error("not a parameter snapshot");
+  }
+  Reader reader(data);
+  for (size_t i = 0; i < sizeof(snapshot_magic); ++i) {
+    reader.read<uint8_t>();
+  }
+  if (reader.read<uint32_t>() != snapshot_version) {
+    throw std::runtime_error("unsupported parameter snapshot version");
+  }
+  if (reader.read<uint32_t>() != byte_order_marker) {
+    throw std::runtime_error("parameter snapshot of a host with another byte order");
+  }
+
+  ParameterSnapshot snapshot;
+  // A name and a type take at least 9 bytes.
+  const size_t number_of_overrides = reader.read_size(9);
+  for (size_t i = 0; i < number_of_overrides; ++i) {
+    std::string name = reader.read_string();
+    snapshot.parameter_overrides.emplace(std::move(name), reader.read_value());
+  }
+  const size_t number_of_parameters = reader.read_size(9);
+  snapshot.parameters.reserve(number_of_parameters);
+  for (size_t i = 0; i < number_of_parameters; ++i) {
+    const std::string name = reader.read_string();
+    rclcpp::Parameter parameter(name, reader.read_value());
+    snapshot.parameters.emplace_back(std::move(parameter), reader.read_descriptor());
+  }
+  if (!reader.at_end()) {
+    Reader::throw_invalid();
+  }
+  return snapshot;
+}
+
+void
+write_parameter_snapshot(const std::string & file_path, const ParameterSnapshot & snapshot)
+{
+  const std::vector<uint8_t> data = serialize_parameter_snapshot(snapshot);
+  std::ofstream file(file_path, std::ios::binary | std::ios::trunc);
+  file.write(
+    reinterpret_cast<const char *>(data.data()), static_cast<std::streamsize>(data.size()));
+  file.close();
+  if (!file) {
+    throw std::runtime_error("failed to write the parameter snapshot '" + file_path + "'");
+  }
+}
+
+ParameterSnapshot
+read_parameter_snapshot(const std::string & file_path)
+{
+  std::ifstream file(file_path, std::ios::binary);
+  if (!file) {
+    throw std::runtime_error("failed to open the parameter snapshot '" + file_path + "'");
+  }
+  std::vector<uint8_t> data(
+    (std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+  if (file.bad()) {
+    throw std::runtime_error("failed to read the parameter snapshot '" + file_path + "'");
+  }
+  return deserialize_parameter_snapshot(data);
+}
+
+}  // namespace rclcpp
@@ -17,6 +17,7 @@
 #include <rmw/error_handling.h>
 #include <rmw/rmw.h>
 
+#include <cstdint>
 #include <iostream>
 #include <memory>
 #include <mutex>
@@ -29,9 +30,11 @@
 
 #include "rclcpp/allocator/allocator_common.hpp"
 #include "rclcpp/allocator/allocator_deleter.hpp"
+#include "rclcpp/detail/resolve_rcl_entity_name.hpp"
 #include "rclcpp/exceptions.hpp"
 #include "rclcpp/expand_topic_or_service_name.hpp"
 #include "rclcpp/experimental/intra_process_manager.hpp"
+#include "rclcpp/graph_listener.hpp"
 #include "rclcpp/logging.hpp"
 #include "rclcpp/macros.hpp"
 #include "rclcpp/network_flow_endpoint.hpp"
@@ -46,7 +49,10 @@ PublisherBase::PublisherBase(
   const rosidl_message_type_support_t & type_support,
   const rcl_publisher_options_t & publisher_options)
 : rcl_node_handle_(node_base->get_shared_rcl_node_handle()),
-  intra_process_is_enabled_(false), intra_process_publisher_id_(0)
+  intra_process_is_enabled_(false), intra_process_publisher_id_(0),
+  graph_listener_(
+    node_base->get_context()->get_sub_context<rclcpp::graph_listener::GraphListener>(
+      node_base->get_context()))
 {
   auto custom_deleter = [node_handle = this->rcl_node_handle_](rcl_publisher_t * rcl_pub)
     {
@@ -64,11 +70,12 @@ PublisherBase::PublisherBase(
     new rcl_publisher_t, custom_deleter);
   *publisher_handle_.get() = rcl_get_zero_initialized_publisher();
 
+  const std::string rcl_topic = rclcpp::detail::resolve_rcl_entity_name(*node_base, topic, false);
   rcl_ret_t ret = rcl_publisher_init(
     publisher_handle_.get(),
     rcl_node_handle_.get(),
     &type_support,
-    topic.c_str(),
+    rcl_topic.c_str(),
     &publisher_options);
   if (ret != RCL_RET_OK) {
     if (ret == RCL_RET_TOPIC_NAME_INVALID) {
@@ -185,6 +192,26 @@ PublisherBase::get_subscription_count() const
   return inter_process_subscription_count;
 }
 
+size_t
+PublisherBase::get_cached_subscription_count() const
+{
+  // Only the low 32 bits of the generation are kept with the count, 0 means there is no cache.
+  const auto generation = static_cast<uint32_t>(graph_listener_->get_graph_generation());
+  if (0u != generation) {
+    const uint64_t cached = cached_subscription_count_.load(std::memory_order_relaxed);
+    if (static_cast<uint32_t>(cached >> 32) == generation) {
+      return static_cast<size_t>(cached & UINT32_MAX);
+    }
+  }
+  // The generation is read before the query, so that a graph change during it queries again.
+  const size_t count = get_subscription_count();
+  if (0u != generation && count <= UINT32_MAX) {
+    cached_subscription_count_.store(
+      (static_cast<uint64_t>(generation) << 32) | count, std::memory_order_relaxed);
+  }
+  return count;
+}
+
 size_t
 PublisherBase::get_intra_process_subscription_count() const
 {
@@ -202,6 +229,27 @@ PublisherBase::get_intra_process_subscription_count() const
   return ipm->get_subscription_count(intra_process_publisher_id_);
 }
 
+size_t
+PublisherBase::get_intra_process_accepting_subscription_count() const
+{
+  auto ipm = weak_ipm_.lock();
+  if (!intra_process_is_enabled_) {
+    return 0;
+  }
+  if (!ipm) {
+    throw std::runtime_error(
+            "intra process accepting subscriber count called after "
+            "destruction of intra process manager");
+  }
+  return ipm->get_accepting_subscription_count(intra_process_publisher_id_);
+}
+
+bool
+PublisherBase::is_serialized() const
+{
+  return false;
+}
+
 rclcpp::QoS
 PublisherBase::get_actual_qos() const
 {
@@ -305,3 +353,42 @@ std::vector<rclcpp::NetworkFlowEndpoint> PublisherBase::get_network_flow_endpoin
 
   return network_flow_endpoint_vector;
 }
+
+uint64_t
+PublisherBase::get_throttled_message_count() const
+{
+  return throttled_message_count_.load(std::memory_order_relaxed);
+}
+
+void
+PublisherBase::set_skip_publish_without_subscribers(bool skip)
+{
+  // The late joining subscriptions of a transient local publisher get the messages it kept.
+  skip_publish_without_subscribers_ =
+    skip && get_actual_qos().durability() != rclcpp::DurabilityPolicy::TransientLocal;
+}
+
+void
+PublisherBase::set_throttling(const PublishThrottlingOptions & throttling_options)
+{
+  throttling_options_ = throttling_options;
+  throttling_rate_limiter_.set_min_period(throttling_options.min_period);
+}
+
+bool
+PublisherBase::throttle()
+{
+  const size_t keep_every_nth = throttling_options_.keep_every_nth;
+  if (
+    keep_every_nth > 1 &&
+    throttling_message_count_.fetch_add(1, std::memory_order_relaxed) % keep_every_nth != 0)
+  {
+    throttled_message_count_.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+  if (!throttling_rate_limiter_.try_pass()) {
+    throttled_message_count_.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+  return true;
+}
@@ -12,7 +12,12 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <algorithm>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "rclcpp/qos_event.hpp"
 
@@ -68,4 +73,97 @@ QOSEventHandlerBase::is_ready(rcl_wait_set_t * wait_set)
   return wait_set->events[wait_set_event_index_] == &event_handle_;
 }
 
+void
+QOSEventHandlerGroup::add_event_handler(
+  const std::shared_ptr<QOSEventHandlerBase> & event_handler)
+{
+  if (!event_handler) {
+    throw std::invalid_argument("event_handler is unexpectedly nullptr");
+  }
+  std::lock_guard<std::mutex> lock(event_handlers_mutex_);
+  // Forget the event handlers which no longer exist, so they do not pile up.
+  event_handlers_.erase(
+    std::remove_if(
+      event_handlers_.begin(), event_handlers_.end(),
+      [](const std::weak_ptr<QOSEventHandlerBase> & weak_event_handler) {
+        return weak_event_handler.expired();
+      }),
+    event_handlers_.end());
+  event_handlers_.push_back(event_handler);
+}
+
+size_t
+QOSEventHandlerGroup::size() const
+{
+  std::lock_guard<std::mutex> lock(event_handlers_mutex_);
+  return static_cast<size_t>(
+    std::count_if(
+      event_handlers_.begin(), event_handlers_.end(),
+      [](const std::weak_ptr<QOSEventHandlerBase> & weak_event_handler) {
+        return !weak_event_handler.expired();
+      }));
+}
+
+size_t
+QOSEventHandlerGroup::get_number_of_ready_events()
+{
+  waited_event_handlers_.clear();
+  std::lock_guard<std::mutex> lock(event_handlers_mutex_);
+  for (const auto & weak_event_handler : event_handlers_) {
+    auto event_handler = weak_event_handler.lock();
+    if (event_handler) {
+      waited_event_handlers_.push_back(std::move(event_handler));
+    }
+  }
+  return waited_event_handlers_.size();
+}
+
+bool
+QOSEventHandlerGroup::add_to_wait_set(rcl_wait_set_t * wait_set)
+{
+  for (const auto & event_handler : waited_event_handlers_) {
+    event_handler->add_to_wait_set(wait_set);
+  }
+  return true;
+}
+
+bool
+QOSEventHandlerGroup::is_ready(rcl_wait_set_t * wait_set)
+{
+  ready_event_handlers_.clear();
+  for (const auto & event_handler : waited_event_handlers_) {
+    if (event_handler->is_ready(wait_set)) {
+      ready_event_handlers_.push_back(event_handler);
+    }
+  }
+  return !ready_event_handlers_.empty();
+}
+
+std::shared_ptr<void>
+QOSEventHandlerGroup::take_data()
+{
+  auto taken_events = std::make_shared<TakenEvents>();
+  taken_events->reserve(ready_event_handlers_.size());
+  for (auto & event_handler : ready_event_handlers_) {
+    auto data = event_handler->take_data();
+    if (data) {
+      taken_events->emplace_back(std::move(event_handler), std::move(data));
+    }
+  }
+  ready_event_handlers_.clear();
+  return taken_events;
+}
+
+void
+QOSEventHandlerGroup::execute(std::shared_ptr<void> & data)
+{
+  if (!data) {
+    throw std::runtime_error("'data' is empty");
+  }
+  auto taken_events = std::static_pointer_cast<TakenEvents>(data);
+  for (auto & taken_event : *taken_events) {
+    taken_event.first->execute(taken_event.second);
+  }
+}
+
 }  // namespace rclcpp
@@ -81,4 +81,17 @@ QosOverridingOptions::get_validation_callback() const
   return validation_callback_;
 }
 
+bool
+QosOverridingOptions::get_declare_parameters() const
+{
+  return declare_parameters_;
+}
+
+QosOverridingOptions &
+QosOverridingOptions::set_declare_parameters(bool declare_parameters)
+{
+  declare_parameters_ = declare_parameters;
+  return *this;
+}
+
 }  // namespace rclcpp
@@ -22,8 +22,49 @@
 
 #include "rcpputils/asserts.hpp"
 
+#include "rcutils/error_handling.h"
+
 #include "rmw/rmw.h"
 
+namespace
+{
+
+// Allocator of a buffer owned by the caller: growing the buffer fails, recording the size asked.
+struct FixedBufferAllocatorState
+{
+  size_t requested_size = 0;
+};
+
+void *
+fixed_buffer_allocate(size_t size, void * state)
+{
+  static_cast<FixedBufferAllocatorState *>(state)->requested_size = size;
+  return nullptr;
+}
+
+void
+fixed_buffer_deallocate(void * pointer, void * state)
+{
+  // The buffer belongs to the caller.
+  (void)pointer;
+  (void)state;
+}
+
+void *
+fixed_buffer_reallocate(void * pointer, size_t size, void * state)
+{
+  (void)pointer;
+  return fixed_buffer_allocate(size, state);
+}
+
+void *
+fixed_buffer_zero_allocate(size_t number_of_elements, size_t size_of_element, void * state)
+{
+  return fixed_buffer_allocate(number_of_elements * size_of_element, state);
+}
+
+}  // namespace
+
 namespace rclcpp
 {
 
@@ -49,6 +90,49 @@ void SerializationBase::serialize_message(
   }
 }
 
+size_t SerializationBase::serialize_message(
+  const void * ros_message, void * buffer, size_t capacity, size_t * required_size) const
+{
+  rcpputils::check_true(nullptr != type_support_, "Typesupport is nullpointer.");
+  rcpputils::check_true(nullptr != ros_message, "ROS message is nullpointer.");
+  rcpputils::check_true(
+    nullptr != buffer || 0u == capacity, "Buffer is nullpointer, with a capacity.");
+
+  FixedBufferAllocatorState allocator_state;
+  rcl_serialized_message_t serialized_message = rmw_get_zero_initialized_serialized_message();
+  serialized_message.buffer = static_cast<uint8_t *>(buffer);
+  serialized_message.buffer_capacity = capacity;
+  serialized_message.allocator.allocate = &fixed_buffer_allocate;
+  serialized_message.allocator.deallocate = &fixed_buffer_deallocate;
+  serialized_message.allocator.reallocate = &fixed_buffer_reallocate;
+  serialized_message.allocator.zero_allocate = &fixed_buffer_zero_allocate;
+  serialized_message.allocator.state = &allocator_state;
+
+  const auto ret = rmw_serialize(ros_message, type_support_, &serialized_message);
+  if (required_size) {
+    *required_size = RMW_RET_OK == ret ? serialized_message.buffer_length : 0;
+  }
+  if (RMW_RET_OK == ret) {
+    return serialized_message.buffer_length;
+  }
+  if (allocator_state.requested_size > capacity) {
+    // The message did not fit, which is not an error of the middleware.
+    rcutils_reset_error();
+    if (required_size) {
+      *required_size = allocator_state.requested_size;
+    }
+    return 0;
+  }
+  rclcpp::exceptions::throw_from_rcl_error(ret, "Failed to serialize ROS message.");
+}
+
+size_t SerializationBase::get_serialized_size(const void * ros_message) const
+{
+  size_t required_size = 0;
+  const size_t size = serialize_message(ros_message, nullptr, 0, &required_size);
+  return 0 != size ? size : required_size;
+}
+
 void SerializationBase::deserialize_message(
   const SerializedMessage * serialized_message, void * ros_message) const
 {
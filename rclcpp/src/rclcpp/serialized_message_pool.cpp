@@ -0,0 +1,157 @@
+// Copyright 2021 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "rclcpp/serialized_message_pool.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+
+namespace rclcpp
+{
+
+namespace
+{
+
+/// Number of recorded sizes after which the counts are halved, to follow changes of the sizes.
+constexpr uint64_t size_history_length = 1024;
+/// Number of recorded sizes between two updates of the target capacity.
+constexpr uint64_t target_update_period = 64;
+/// Returned messages with a capacity larger than this factor of the target are released.
+constexpr size_t max_capacity_factor = 4;
+
+size_t
+get_bucket(size_t size)
+{
+  if (size == 0) {
+    return 0;
+  }
+  size_t bucket = 1;
+  for (size_t bits = size - 1; bits != 0; bits >>= 1) {
+    ++bucket;
+  }
+  return bucket;
+}
+
+}  // namespace
+
+SerializedMessagePool::SerializedMessagePool(size_t max_pooled_messages)
+: max_pooled_messages_(max_pooled_messages),
+  recorded_size_count_(0),
+  target_capacity_(0)
+{
+  pooled_messages_.reserve(max_pooled_messages_);
+  size_counts_.fill(0);
+}
+
+std::shared_ptr<rclcpp::SerializedMessage>
+SerializedMessagePool::borrow_serialized_message(size_t minimum_capacity)
+{
+  std::shared_ptr<rclcpp::SerializedMessage> serialized_message;
+  size_t capacity = minimum_capacity;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    capacity = std::max(capacity, target_capacity_);
+    if (!pooled_messages_.empty()) {
+      serialized_message = std::move(pooled_messages_.back());
+      pooled_messages_.pop_back();
+    }
+  }
+  if (!serialized_message) {
+    return std::make_shared<rclcpp::SerializedMessage>(capacity);
+  }
+  if (serialized_message->capacity() < capacity) {
+    serialized_message->reserve(capacity);
+  }
+  return serialized_message;
+}
+
+void
+SerializedMessagePool::return_serialized_message(
+  std::shared_ptr<rclcpp::SerializedMessage> & serialized_message)
+{
+  if (!serialized_message) {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  record_size(serialized_message->size());
+  const bool oversized = target_capacity_ > 0 &&
+    serialized_message->capacity() > max_capacity_factor * target_capacity_;
+  if (
+    serialized_message.use_count() == 1 && !oversized &&
+    pooled_messages_.size() < max_pooled_messages_)
+  {
+    serialized_message->get_rcl_serialized_message().buffer_length = 0;
+    pooled_messages_.push_back(std::move(serialized_message));
+  }
+  serialized_message.reset();
+}
+
+size_t
+SerializedMessagePool::get_target_capacity() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return target_capacity_;
+}
+
+size_t
+SerializedMessagePool::get_number_of_pooled_messages() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return pooled_messages_.size();
+}
+
+void
+SerializedMessagePool::record_size(size_t size)
+{
+  ++size_counts_[get_bucket(size)];
+  ++recorded_size_count_;
+  // Update the target for the first sizes, then periodically.
+  if (recorded_size_count_ > target_update_period &&
+    recorded_size_count_ % target_update_period != 0)
+  {
+    return;
+  }
+
+  uint64_t total = 0;
+  for (auto count : size_counts_) {
+    total += count;
+  }
+  // The 99th percentile, rounded up.
+  const uint64_t percentile_count = (total * 99 + 99) / 100;
+  uint64_t count = 0;
+  size_t bucket = 0;
+  for (; bucket < bucket_count; ++bucket) {
+    count += size_counts_[bucket];
+    if (count >= percentile_count) {
+      break;
+    }
+  }
+  if (bucket == 0) {
+    target_capacity_ = 0;
+  } else if (bucket - 1 >= sizeof(size_t) * 8) {
+    target_capacity_ = SIZE_MAX;
+  } else {
+    target_capacity_ = size_t(1) << (bucket - 1);
+  }
+
+  if (total >= size_history_length) {
+    for (auto & size_count : size_counts_) {
+      size_count /= 2;
+    }
+  }
+}
+
+}  // namespace rclcpp
@@ -0,0 +1,407 @@
+// Copyright 2021 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "rclcpp/serialized_message_reader.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "rclcpp/typesupport_helpers.hpp"
+
+#include "rcpputils/endian.hpp"
+#include "rcpputils/split.hpp"
+
+#include "rosidl_typesupport_introspection_cpp/identifier.hpp"
+#include "rosidl_typesupport_introspection_cpp/message_introspection.hpp"
+
+namespace
+{
+
+namespace introspection = rosidl_typesupport_introspection_cpp;
+
+// Size of the encapsulation preceding the CDR encoded message.
+constexpr size_t encapsulation_size = 4;
+
+const introspection::MessageMembers *
+get_members(const rosidl_message_type_support_t * type_support)
+{
+  const rosidl_message_type_support_t * introspection_type_support =
+    get_message_typesupport_handle(type_support, introspection::typesupport_identifier);
+  if (nullptr == introspection_type_support) {
+    throw std::runtime_error("the type has no introspection type support");
+  }
+  return static_cast<const introspection::MessageMembers *>(introspection_type_support->data);
+}
+
+std::string
+get_type_name(const introspection::MessageMembers & members)
+{
+  return std::string(members.message_namespace_) + "::" + members.message_name_;
+}
+
+// Size of a primitive in CDR, 0 for strings and messages.
+size_t
+get_primitive_size(uint8_t type_id)
+{
+  switch (type_id) {
+    case introspection::ROS_TYPE_BOOLEAN:
+    case introspection::ROS_TYPE_OCTET:
+    case introspection::ROS_TYPE_CHAR:
+    case introspection::ROS_TYPE_UINT8:
+    case introspection::ROS_TYPE_INT8:
+      return 1;
+    case introspection::ROS_TYPE_UINT16:
+    case introspection::ROS_TYPE_INT16:
+      return 2;
+    case introspection::ROS_TYPE_FLOAT:
+    case introspection::ROS_TYPE_WCHAR:
+    case introspection::ROS_TYPE_UINT32:
+    case introspection::ROS_TYPE_INT32:
+      return 4;
+    case introspection::ROS_TYPE_DOUBLE:
+    case introspection::ROS_TYPE_UINT64:
+    case introspection::ROS_TYPE_INT64:
+      return 8;
+    case introspection::ROS_TYPE_LONG_DOUBLE:
+      return 16;
+    default:
+      return 0;
+  }
+}
+
+size_t
+get_alignment(size_t primitive_size)
+{
+  return std::min<size_t>(primitive_size, 8);
+}
+
+bool
+is_sequence(const introspection::MessageMember & member)
+{
+  return member.is_array_ && (member.is_upper_bound_ || 0 == member.array_size_);
+}
+
+// Position in the CDR encoded message, after the encapsulation, to which alignment is relative.
+class Cursor
+{
+public:
+  explicit Cursor(const rcl_serialized_message_t & message)
+  {
+    if (nullptr == message.buffer || message.buffer_length < encapsulation_size) {
+      throw std::runtime_error("the serialized message has no CDR encapsulation");
+    }
+    // The second byte of the encapsulation is 1 for little endian, 0 for big endian.
+    const bool little_endian = 0 != (message.buffer[1] & 1);
+    swap_ = little_endian != (rcpputils::endian::native == rcpputils::endian::little);
+    data_ = message.buffer + encapsulation_size;
+    length_ = message.buffer_length - encapsulation_size;
+  }
+
+  void
+  seek(size_t position)
+  {
+    position_ = position;
+  }
+
+  void
+  align(size_t alignment)
+  {
+    position_ = (position_ + alignment - 1) / alignment * alignment;
+  }
+
+  const uint8_t *
+  advance(size_t size)
+  {
+    if (position_ > length_ || size > length_ - position_) {
+      throw std::runtime_error("the serialized message is shorter than its type tells");
+    }
+    const uint8_t * data = data_ + position_;
+    position_ += size;
+    return data;
+  }
+
+  void
+  read_primitive(size_t size, void * value)
+  {
+    align(get_alignment(size));
+    const uint8_t * data = advance(size);
+    auto bytes = static_cast<uint8_t *>(value);
+    if (swap_) {
+      std::reverse_copy(data, data + size, bytes);
+    } else {
+      std::memcpy(bytes, data, size);
+    }
+  }
+
+  uint32_t
+  read_length()
+  {
+    uint32_t length;
+    read_primitive(sizeof(length), &length);
+    return length;
+  }
+
+  void
+  skip_primitives(size_t size, size_t count)
+  {
+    if (0 == count) {
+      return;
+    }
+    align(get_alignment(size));
+    if (count > length_ / size) {
+      throw std::runtime_error("the serialized message is shorter than its type tells");
+    }
+    advance(size * count);
+  }
+
+  void
+  skip_message(const introspection::MessageMembers & members)
+  {
+    for (uint32_t i = 0; i < members.member_count_; ++i) {
+      skip_member(members.members_[i]);
+    }
+  }
+
+  void
+  skip_member(const introspection::MessageMember & member)
+  {
+    size_t count = 1;
+    if (is_sequence(member)) {
+      count = read_length();
+    } else if (member.is_array_) {
+      count = member.array_size_;
+    }
+    switch (member.type_id_) {
+      case introspection::ROS_TYPE_MESSAGE:
+        for (size_t i = 0; i < count; ++i) {
+          skip_message(*get_members(member.members_));
+        }
+        break;
+      case introspection::ROS_TYPE_STRING:
+        for (size_t i = 0; i < count; ++i) {
+          advance(read_length());
+        }
+        break;
+      case introspection::ROS_TYPE_WSTRING:
+        for (size_t i = 0; i < count; ++i) {
+          skip_primitives(4, read_length());
+        }
+        break;
+      default:
+        skip_primitives(get_primitive_size(member.type_id_), count);
+    }
+  }
+
+private:
+  const uint8_t * data_;
+  size_t length_;
+  size_t position_ = 0;
+  bool swap_;
+};
+
+// Advance position past the member, return false if its size depends on the message.
+bool
+skip_fixed_size_member(const introspection::MessageMember & member, size_t & position);
+
+bool
+skip_fixed_size_message(const introspection::MessageMembers & members, size_t & position)
+{
+  for (uint32_t i = 0; i < members.member_count_; ++i) {
+    if (!skip_fixed_size_member(members.members_[i], position)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool
+skip_fixed_size_member(const introspection::MessageMember & member, size_t & position)
+{
+  if (is_sequence(member)) {
+    return false;
+  }
+  const size_t count = member.is_array_ ? member.array_size_ : 1;
+  if (introspection::ROS_TYPE_MESSAGE == member.type_id_) {
+    const introspection::MessageMembers & members = *get_members(member.members_);
+    for (size_t i = 0; i < count; ++i) {
+      if (!skip_fixed_size_message(members, position)) {
+        return false;
+      }
+    }
+    return true;
+  }
+  const size_t size = get_primitive_size(member.type_id_);
+  if (0 == size) {
+    // A string.
+    return false;
+  }
+  const size_t alignment = get_alignment(size);
+  position = (position + alignment - 1) / alignment * alignment + size * count;
+  return true;
+}
+
+bool
+is_compatible(uint8_t field_type_id, uint8_t type_id)
+{
+  if (field_type_id == type_id) {
+    return true;
+  }
+  // Octets and chars are unsigned char in C++, like uint8.
+  return introspection::ROS_TYPE_UINT8 == type_id &&
+         (introspection::ROS_TYPE_OCTET == field_type_id ||
+         introspection::ROS_TYPE_CHAR == field_type_id);
+}
+
+// Move the cursor to the field, return its member.
+const introspection::MessageMember &
+seek_field(
+  Cursor & cursor,
+  const introspection::MessageMembers * members,
+  const rclcpp::SerializedMessageReader::Field & field)
+{
+  if (field.member_indices.empty()) {
+    throw std::invalid_argument("the field was not resolved by get_field()");
+  }
+  if (field.has_fixed_offset) {
+    for (size_t level = 0; level + 1 < field.member_indices.size(); ++level) {
+      members = get_members(members->members_[field.member_indices[level]].members_);
+    }
+    cursor.seek(field.fixed_offset);
+    return members->members_[field.member_indices.back()];
+  }
+  for (size_t level = 0;; ++level) {
+    const size_t index = field.member_indices[level];
+    for (size_t i = 0; i < index; ++i) {
+      cursor.skip_member(members->members_[i]);
+    }
+    if (level + 1 == field.member_indices.size()) {
+      return members->members_[index];
+    }
+    members = get_members(members->members_[index].members_);
+  }
+}
+
+}  // namespace
+
+namespace rclcpp
+{
+
+SerializedMessageReader::SerializedMessageReader(const std::string & type)
+: type_support_library_(
+    get_typesupport_library(type, introspection::typesupport_identifier))
+{
+  members_ = get_members(
+    get_typesupport_handle(type, introspection::typesupport_identifier, *type_support_library_));
+}
+
+SerializedMessageReader::SerializedMessageReader(
+  const rosidl_message_type_support_t * type_support)
+{
+  if (nullptr == type_support) {
+    throw std::invalid_argument("type_support argument must not be null");
+  }
+  members_ = get_members(type_support);
+}
+
+SerializedMessageReader::Field
+SerializedMessageReader::get_field(const std::string & path) const
+{
+  Field field;
+  auto members = static_cast<const introspection::MessageMembers *>(members_);
+  size_t position = 0;
+  bool has_fixed_offset = true;
+  const std::vector<std::string> names = rcpputils::split(path, '.');
+  if (names.empty()) {
+    throw std::invalid_argument("the path of the field must not be empty");
+  }
+  for (size_t level = 0; level < names.size(); ++level) {
+    const introspection::MessageMember * begin = members->members_;
+    const introspection::MessageMember * end = begin + members->member_count_;
+    const introspection::MessageMember * member = std::find_if(
+      begin, end, [&name = names[level]](const introspection::MessageMember & member) {
+        return name == member.name_;
+      });
+    if (member == end) {
+      throw std::invalid_argument(
+              "no field '" + names[level] + "' in message type " + get_type_name(*members));
+    }
+    for (const introspection::MessageMember * it = begin; has_fixed_offset && it != member; ++it) {
+      has_fixed_offset = skip_fixed_size_member(*it, position);
+    }
+    field.member_indices.push_back(static_cast<size_t>(member - begin));
+    field.type_id = member->type_id_;
+    field.is_array = member->is_array_;
+    if (level + 1 < names.size()) {
+      if (introspection::ROS_TYPE_MESSAGE != member->type_id_ || member->is_array_) {
+        throw std::invalid_argument(
+                "the field '" + names[level] + "' of message type " + get_type_name(*members) +
+                " is not a message, of which '" + names[level + 1] + "' would be a field");
+      }
+      members = get_members(member->members_);
+    }
+  }
+  if (has_fixed_offset) {
+    // Reading the field aligns the position as its type requires.
+    field.has_fixed_offset = true;
+    field.fixed_offset = position;
+  }
+  return field;
+}
+
+size_t
+SerializedMessageReader::get_size(const SerializedMessage & message, const Field & field) const
+{
+  if (!field.is_array) {
+    throw std::invalid_argument("the field is not an array nor a sequence");
+  }
+  Cursor cursor(message.get_rcl_serialized_message());
+  const introspection::MessageMember & member = seek_field(
+    cursor, static_cast<const introspection::MessageMembers *>(members_), field);
+  if (!is_sequence(member)) {
+    return member.array_size_;
+  }
+  return cursor.read_length();
+}
+
+void
+SerializedMessageReader::read_field(
+  const rcl_serialized_message_t & message,
+  const Field & field,
+  uint8_t type_id,
+  void * value) const
+{
+  if (field.is_array || introspection::ROS_TYPE_MESSAGE == field.type_id) {
+    throw std::invalid_argument("the field is an array, a sequence or a message");
+  }
+  if (!is_compatible(field.type_id, type_id)) {
+    throw std::invalid_argument("the field is not of the type it is read as");
+  }
+  Cursor cursor(message);
+  seek_field(cursor, static_cast<const introspection::MessageMembers *>(members_), field);
+  if (introspection::ROS_TYPE_STRING == type_id) {
+    const uint32_t length = cursor.read_length();
+    auto characters = reinterpret_cast<const char *>(cursor.advance(length));
+    // The length includes the terminating null character.
+    static_cast<std::string *>(value)->assign(characters, length > 0 ? length - 1 : 0);
+  } else if (introspection::ROS_TYPE_BOOLEAN == type_id) {
+    *static_cast<bool *>(value) = 0 != *cursor.advance(1);
+  } else {
+    cursor.read_primitive(get_primitive_size(type_id), value);
+  }
+}
+
+}  // namespace rclcpp
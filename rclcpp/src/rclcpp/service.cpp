@@ -17,10 +17,15 @@
 #include <functional>
 #include <iostream>
 #include <memory>
+#include <mutex>
 #include <sstream>
+#include <stdexcept>
 #include <string>
+#include <vector>
 
 #include "rclcpp/any_service_callback.hpp"
+#include "rclcpp/experimental/intra_process_manager.hpp"
+#include "rclcpp/logging.hpp"
 #include "rclcpp/macros.hpp"
 #include "rmw/error_handling.h"
 #include "rmw/rmw.h"
@@ -32,11 +37,24 @@ ServiceBase::ServiceBase(std::shared_ptr<rcl_node_t> node_handle)
 {}
 
 ServiceBase::~ServiceBase()
-{}
+{
+  if (!service_intra_process_base_) {
+    return;
+  }
+  auto ipm = weak_ipm_.lock();
+  if (!ipm) {
+    RCLCPP_WARN(
+      rclcpp::get_logger("rclcpp"),
+      "Intra process manager died before than a service.");
+    return;
+  }
+  ipm->remove_service(intra_process_service_id_);
+}
 
 bool
 ServiceBase::take_type_erased_request(void * request_out, rmw_request_id_t & request_id_out)
 {
+  std::lock_guard<std::mutex> lock(service_handle_mutex_);
   rcl_ret_t ret = rcl_take_request(
     this->get_service_handle().get(),
     &request_id_out,
@@ -49,6 +67,39 @@ ServiceBase::take_type_erased_request(void * request_out, rmw_request_id_t & req
   return true;
 }
 
+void
+ServiceBase::handle_requests(std::vector<TypeErasedRequest> & requests)
+{
+  for (auto & request : requests) {
+    this->handle_request(request.first, request.second);
+  }
+}
+
+void
+ServiceBase::set_max_requests_per_execution(size_t max_requests)
+{
+  if (0u == max_requests) {
+    throw std::invalid_argument("the maximum number of requests per execution must not be 0");
+  }
+  max_requests_per_execution_.store(max_requests);
+}
+
+size_t
+ServiceBase::get_max_requests_per_execution() const
+{
+  return max_requests_per_execution_.load();
+}
+
+void
+ServiceBase::send_type_erased_response(rmw_request_id_t & request_id, void * response)
+{
+  std::lock_guard<std::mutex> lock(service_handle_mutex_);
+  rcl_ret_t ret = rcl_send_response(this->get_service_handle().get(), &request_id, response);
+  if (RCL_RET_OK != ret) {
+    rclcpp::exceptions::throw_from_rcl_error(ret, "failed to send response");
+  }
+}
+
 const char *
 ServiceBase::get_service_name()
 {
@@ -84,3 +135,21 @@ ServiceBase::exchange_in_use_by_wait_set_state(bool in_use_state)
 {
   return in_use_by_wait_set_.exchange(in_use_state);
 }
+
+rclcpp::Waitable::SharedPtr
+ServiceBase::get_intra_process_waitable() const
+{
+  return service_intra_process_base_;
+}
+
+void
+ServiceBase::setup_intra_process(
+  rclcpp::experimental::ServiceIntraProcessBase::SharedPtr service_intra_process,
+  rclcpp::Context::SharedPtr context)
+{
+  using rclcpp::experimental::IntraProcessManager;
+  auto ipm = context->get_sub_context<IntraProcessManager>();
+  intra_process_service_id_ = ipm->add_service(service_intra_process);
+  weak_ipm_ = ipm;
+  service_intra_process_base_ = std::move(service_intra_process);
+}
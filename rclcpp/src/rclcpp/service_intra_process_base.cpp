@@ -0,0 +1,68 @@
+// Copyright 2021 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#include "rclcpp/experimental/service_intra_process_base.hpp"
+
+#include <string>
+
+#include "rclcpp/exceptions.hpp"
+#include "rclcpp/logging.hpp"
+
+using rclcpp::experimental::ServiceIntraProcessBase;
+
+ServiceIntraProcessBase::ServiceIntraProcessBase(
+  rclcpp::Context::SharedPtr context,
+  const std::string & service_name)
+: gc_(rcl_get_zero_initialized_guard_condition()), service_name_(service_name)
+{
+  rcl_guard_condition_options_t guard_condition_options = rcl_guard_condition_get_default_options();
+  rcl_ret_t ret = rcl_guard_condition_init(
+    &gc_, context->get_rcl_context().get(), guard_condition_options);
+  if (RCL_RET_OK != ret) {
+    rclcpp::exceptions::throw_from_rcl_error(
+      ret, "ServiceIntraProcessBase init error initializing guard condition");
+  }
+}
+
+ServiceIntraProcessBase::~ServiceIntraProcessBase()
+{
+  if (rcl_guard_condition_fini(&gc_) != RCL_RET_OK) {
+    RCLCPP_ERROR(
+      rclcpp::get_logger("rclcpp"),
+      "Failed to destroy guard condition: %s",
+      rcl_get_error_string().str);
+    rcl_reset_error();
+  }
+}
+
+bool
+ServiceIntraProcessBase::add_to_wait_set(rcl_wait_set_t * wait_set)
+{
+  std::lock_guard<std::recursive_mutex> lock(reentrant_mutex_);
+
+  rcl_ret_t ret = rcl_wait_set_add_guard_condition(wait_set, &gc_, NULL);
+  return RCL_RET_OK == ret;
+}
+
+const char *
+ServiceIntraProcessBase::get_service_name() const
+{
+  return service_name_.c_str();
+}
+
+void
+ServiceIntraProcessBase::trigger_guard_condition()
+{
+  rcl_ret_t ret = rcl_trigger_guard_condition(&gc_);
+  (void)ret;
+}
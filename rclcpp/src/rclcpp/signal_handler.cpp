@@ -15,10 +15,16 @@
 #include "./signal_handler.hpp"
 
 #include <atomic>
+#include <chrono>
 #include <csignal>
+#include <exception>
+#include <future>
+#include <memory>
 #include <mutex>
 #include <string>
 #include <thread>
+#include <utility>
+#include <vector>
 
 // includes for semaphore notification code
 #if defined(_WIN32)
@@ -237,16 +243,7 @@ SignalHandler::deferred_signal_handler()
   while (true) {
     if (signal_received_.exchange(false)) {
       RCLCPP_DEBUG(get_logger(), "deferred_signal_handler(): SIGINT received, shutting down");
-      for (auto context_ptr : rclcpp::get_contexts()) {
-        if (context_ptr->get_init_options().shutdown_on_sigint) {
-          RCLCPP_DEBUG(
-            get_logger(),
-            "deferred_signal_handler(): "
-            "shutting down rclcpp::Context @ %p, because it had shutdown_on_sigint == true",
-            static_cast<void *>(context_ptr.get()));
-          context_ptr->shutdown("signal handler");
-        }
-      }
+      shutdown_contexts();
     }
     if (!is_installed()) {
       RCLCPP_DEBUG(get_logger(), "deferred_signal_handler(): signal handling uninstalled");
@@ -258,6 +255,63 @@ SignalHandler::deferred_signal_handler()
   }
 }
 
+void
+SignalHandler::shutdown_contexts()
+{
+  struct PendingShutdown
+  {
+    rclcpp::Context::SharedPtr context;
+    std::chrono::steady_clock::time_point deadline;
+    std::future<void> done;
+  };
+  std::vector<PendingShutdown> pending_shutdowns;
+  std::vector<rclcpp::Context::SharedPtr> contexts;
+  const auto start = std::chrono::steady_clock::now();
+  for (auto context_ptr : rclcpp::get_contexts()) {
+    const rclcpp::InitOptions & init_options = context_ptr->get_init_options();
+    if (!init_options.shutdown_on_sigint) {
+      continue;
+    }
+    RCLCPP_DEBUG(
+      get_logger(),
+      "deferred_signal_handler(): "
+      "shutting down rclcpp::Context @ %p, because it had shutdown_on_sigint == true",
+      static_cast<void *>(context_ptr.get()));
+    if (init_options.sigint_shutdown_deadline() <= std::chrono::nanoseconds::zero()) {
+      contexts.push_back(context_ptr);
+      continue;
+    }
+    // Detached, so that a shutdown past its deadline does not block this thread.
+    std::packaged_task<void()> shutdown_task(
+      [context_ptr]() {context_ptr->shutdown("signal handler");});
+    pending_shutdowns.push_back(
+      {context_ptr, start + init_options.sigint_shutdown_deadline(), shutdown_task.get_future()});
+    std::thread(std::move(shutdown_task)).detach();
+  }
+
+  for (const auto & context_ptr : contexts) {
+    context_ptr->shutdown("signal handler");
+  }
+  for (auto & pending_shutdown : pending_shutdowns) {
+    if (std::future_status::ready != pending_shutdown.done.wait_until(pending_shutdown.deadline)) {
+      RCLCPP_ERROR(
+        get_logger(),
+        "deferred_signal_handler(): "
+        "rclcpp::Context @ %p not shut down by its deadline, no longer waiting for it",
+        static_cast<void *>(pending_shutdown.context.get()));
+      continue;
+    }
+    try {
+      pending_shutdown.done.get();
+    } catch (const std::exception & exception) {
+      RCLCPP_ERROR(
+        get_logger(),
+        "deferred_signal_handler(): failed to shut down rclcpp::Context @ %p: %s",
+        static_cast<void *>(pending_shutdown.context.get()), exception.what());
+    }
+  }
+}
+
 void
 SignalHandler::setup_wait_for_signal()
 {
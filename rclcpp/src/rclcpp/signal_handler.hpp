@@ -122,6 +122,10 @@ private:
   void
   deferred_signal_handler();
 
+  /// Shut down the contexts with shutdown_on_sigint, see InitOptions::sigint_shutdown_deadline().
+  void
+  shutdown_contexts();
+
   /// Setup anything that is necessary for wait_for_signal() or notify_signal_handler().
   /**
    * This must be called before wait_for_signal() or notify_signal_handler().
@@ -0,0 +1,152 @@
+// Copyright 2021 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "rclcpp/startup_profiling.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace
+{
+
+struct Profiler
+{
+  std::mutex mutex;
+  std::map<std::string, rclcpp::startup_profiling::PhaseTimes, std::less<>> phases;
+};
+
+std::atomic<bool> g_enabled{false};
+
+// Never destroyed, the phases measured while exiting must still find it.
+Profiler &
+get_profiler()
+{
+  static Profiler * profiler = new Profiler();
+  return *profiler;
+}
+
+void
+record_phase(const char * phase, const char * item, std::chrono::nanoseconds duration)
+{
+  Profiler & profiler = get_profiler();
+  std::lock_guard<std::mutex> lock(profiler.mutex);
+  auto it = profiler.phases.find(phase);
+  if (it == profiler.phases.end()) {
+    it = profiler.phases.emplace(phase, rclcpp::startup_profiling::PhaseTimes()).first;
+    it->second.phase = phase;
+  }
+  auto & times = it->second;
+  ++times.count;
+  times.total += duration;
+  if (duration >= times.max) {
+    times.max = duration;
+    times.slowest = item ? item : "";
+  }
+}
+
+}  // namespace
+
+namespace rclcpp
+{
+namespace startup_profiling
+{
+
+void
+enable()
+{
+  g_enabled.store(true, std::memory_order_release);
+}
+
+void
+disable()
+{
+  g_enabled.store(false, std::memory_order_release);
+}
+
+bool
+is_enabled()
+{
+  return g_enabled.load(std::memory_order_acquire);
+}
+
+std::vector<PhaseTimes>
+get_phase_times()
+{
+  std::vector<PhaseTimes> result;
+  {
+    Profiler & profiler = get_profiler();
+    std::lock_guard<std::mutex> lock(profiler.mutex);
+    result.reserve(profiler.phases.size());
+    for (const auto & entry : profiler.phases) {
+      result.push_back(entry.second);
+    }
+  }
+  std::stable_sort(
+    result.begin(), result.end(),
+    [](const PhaseTimes & a, const PhaseTimes & b) {return a.total > b.total;});
+  return result;
+}
+
+void
+reset()
+{
+  Profiler & profiler = get_profiler();
+  std::lock_guard<std::mutex> lock(profiler.mutex);
+  profiler.phases.clear();
+}
+
+std::string
+format_report()
+{
+  using std::chrono::duration_cast;
+  using microseconds = std::chrono::duration<double, std::micro>;
+
+  std::ostringstream report;
+  for (const auto & times : get_phase_times()) {
+    report << times.phase << ": " << times.count << " in " <<
+      duration_cast<microseconds>(times.total).count() << " us, max " <<
+      duration_cast<microseconds>(times.max).count() << " us";
+    if (!times.slowest.empty()) {
+      report << " (" << times.slowest << ")";
+    }
+    report << "\n";
+  }
+  return report.str();
+}
+
+ScopedPhase::ScopedPhase(const char * phase, const char * item)
+: phase_(is_enabled() ? phase : nullptr), item_(item)
+{
+  if (phase_) {
+    start_ = std::chrono::steady_clock::now();
+  }
+}
+
+ScopedPhase::~ScopedPhase()
+{
+  if (phase_) {
+    record_phase(phase_, item_, std::chrono::steady_clock::now() - start_);
+  }
+}
+
+}  // namespace startup_profiling
+}  // namespace rclcpp
@@ -17,8 +17,10 @@
 #include <cstdio>
 #include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
+#include "rclcpp/detail/resolve_rcl_entity_name.hpp"
 #include "rclcpp/exceptions.hpp"
 #include "rclcpp/expand_topic_or_service_name.hpp"
 #include "rclcpp/experimental/intra_process_manager.hpp"
@@ -60,11 +62,13 @@ SubscriptionBase::SubscriptionBase(
     new rcl_subscription_t, custom_deletor);
   *subscription_handle_.get() = rcl_get_zero_initialized_subscription();
 
+  const std::string rcl_topic_name =
+    rclcpp::detail::resolve_rcl_entity_name(*node_base_, topic_name, false);
   rcl_ret_t ret = rcl_subscription_init(
     subscription_handle_.get(),
     node_handle_.get(),
     &type_support_handle,
-    topic_name.c_str(),
+    rcl_topic_name.c_str(),
     &subscription_options);
   if (ret != RCL_RET_OK) {
     if (ret == RCL_RET_TOPIC_NAME_INVALID) {
@@ -158,6 +162,70 @@ SubscriptionBase::take_type_erased(void * message_out, rclcpp::MessageInfo & mes
   return true;
 }
 
+size_t
+SubscriptionBase::take_type_erased_batch(
+  void * messages_out,
+  size_t message_size,
+  rclcpp::MessageInfo * message_infos_out,
+  size_t count)
+{
+  if (0 == count) {
+    return 0;
+  }
+  auto message_at = [messages_out, message_size](size_t index) {
+      return static_cast<void *>(static_cast<char *>(messages_out) + index * message_size);
+    };
+  auto take_one_by_one = [&]() {
+      size_t taken = 0;
+      while (taken < count && take_type_erased(message_at(taken), message_infos_out[taken])) {
+        ++taken;
+      }
+      return taken;
+    };
+  std::lock_guard<std::mutex> lock(take_batch_mutex_);
+  // The messages of intra-process publishers are dropped, so that the taken messages would not
+  // be contiguous in a sequence: take them one by one, in order, instead.
+  if (use_intra_process_ || !take_sequence_supported_) {
+    return take_one_by_one();
+  }
+  if (take_batch_messages_.size() < count) {
+    take_batch_messages_.resize(count);
+    take_batch_message_infos_.resize(count);
+  }
+  for (size_t i = 0; i < count; ++i) {
+    take_batch_messages_[i] = message_at(i);
+  }
+  rmw_message_sequence_t message_sequence = rmw_get_zero_initialized_message_sequence();
+  message_sequence.data = take_batch_messages_.data();
+  message_sequence.capacity = count;
+  rmw_message_info_sequence_t message_info_sequence =
+    rmw_get_zero_initialized_message_info_sequence();
+  message_info_sequence.data = take_batch_message_infos_.data();
+  message_info_sequence.capacity = count;
+
+  rcl_ret_t ret = rcl_take_sequence(
+    this->get_subscription_handle().get(),
+    count,
+    &message_sequence,
+    &message_info_sequence,
+    nullptr  // rmw_subscription_allocation_t is unused here
+  );
+  if (RCL_RET_UNSUPPORTED == ret) {
+    rcl_reset_error();
+    take_sequence_supported_ = false;
+    return take_one_by_one();
+  }
+  if (RCL_RET_SUBSCRIPTION_TAKE_FAILED == ret) {
+    return 0;
+  } else if (RCL_RET_OK != ret) {
+    rclcpp::exceptions::throw_from_rcl_error(ret);
+  }
+  for (size_t i = 0; i < message_info_sequence.size; ++i) {
+    message_infos_out[i].get_rmw_message_info() = message_info_sequence.data[i];
+  }
+  return message_sequence.size;
+}
+
 bool
 SubscriptionBase::take_serialized(
   rclcpp::SerializedMessage & message_out,
@@ -173,6 +241,98 @@ SubscriptionBase::take_serialized(
   } else if (RCL_RET_OK != ret) {
     rclcpp::exceptions::throw_from_rcl_error(ret);
   }
+  if (
+    matches_any_intra_process_publishers(&message_info_out.get_rmw_message_info().publisher_gid))
+  {
+    // In this case, the message will be delivered via intra-process and
+    // we should ignore this copy of the message.
+    return false;
+  }
+  return true;
+}
+
+bool
+SubscriptionBase::takes_latest_only() const
+{
+  return take_latest_only_;
+}
+
+void
+SubscriptionBase::set_take_latest_only(bool take_latest_only)
+{
+  take_latest_only_ = take_latest_only;
+}
+
+void *
+SubscriptionBase::borrow_reusable_message()
+{
+  if (!reusable_message_ || reusable_message_borrowed_.exchange(true, std::memory_order_acquire)) {
+    return nullptr;
+  }
+  return reusable_message_.get();
+}
+
+void
+SubscriptionBase::return_reusable_message()
+{
+  reusable_message_borrowed_.store(false, std::memory_order_release);
+}
+
+void
+SubscriptionBase::set_reusable_message(std::shared_ptr<void> message)
+{
+  reusable_message_ = std::move(message);
+}
+
+void
+SubscriptionBase::handle_reusable_message(void * message, const rclcpp::MessageInfo & message_info)
+{
+  (void) message;
+  (void) message_info;
+  throw rclcpp::exceptions::UnimplementedError(
+          "handle_reusable_message is not implemented for this subscription");
+}
+
+bool
+SubscriptionBase::take_latest_type_erased(
+  std::shared_ptr<void> & message,
+  rclcpp::MessageInfo & message_info)
+{
+  if (!take_type_erased(message.get(), message_info)) {
+    return false;
+  }
+  std::shared_ptr<void> newer_message = create_message();
+  rclcpp::MessageInfo newer_message_info = message_info;
+  // A copy delivered intra-process as well ends the take, the next ones are taken next time.
+  while (take_type_erased(newer_message.get(), newer_message_info)) {
+    if (matches_any_shared_memory_publishers(
+        &newer_message_info.get_rmw_message_info().publisher_gid))
+    {
+      // The message is delivered through shared memory as well.
+      continue;
+    }
+    std::swap(message, newer_message);
+    std::swap(message_info, newer_message_info);
+  }
+  return_message(newer_message);
+  return true;
+}
+
+bool
+SubscriptionBase::take_latest_serialized(
+  std::shared_ptr<rclcpp::SerializedMessage> & message,
+  rclcpp::MessageInfo & message_info)
+{
+  if (!take_serialized(*message, message_info)) {
+    return false;
+  }
+  std::shared_ptr<rclcpp::SerializedMessage> newer_message = create_serialized_message();
+  rclcpp::MessageInfo newer_message_info = message_info;
+  while (take_serialized(*newer_message, newer_message_info)) {
+    std::swap(message, newer_message);
+    std::swap(message_info, newer_message_info);
+  }
+  return_serialized_message(newer_message);
   return true;
 }
 
@@ -238,6 +398,12 @@ SubscriptionBase::get_intra_process_waitable() const
   return ipm->get_subscription_intra_process(intra_process_subscription_id_);
 }
 
+rclcpp::Waitable::SharedPtr
+SubscriptionBase::get_shared_memory_waitable() const
+{
+  return shared_memory_waitable_;
+}
+
 void
 SubscriptionBase::default_incompatible_qos_callback(
   rclcpp::QOSRequestedIncompatibleQoSInfo & event) const
@@ -264,7 +430,16 @@ SubscriptionBase::matches_any_intra_process_publishers(const rmw_gid_t * sender_
             "intra process publisher check called "
             "after destruction of intra process manager");
   }
-  return ipm->matches_any_publishers(sender_gid);
+  return ipm->matches_any_publishers(sender_gid, intra_process_subscription_id_);
+}
+
+bool
+SubscriptionBase::matches_any_shared_memory_publishers(const rmw_gid_t * sender_gid) const
+{
+  if (!shared_memory_waitable_) {
+    return false;
+  }
+  return shared_memory_waitable_->get_channel()->is_writer(*sender_gid);
 }
 
 bool
@@ -325,3 +500,18 @@ std::vector<rclcpp::NetworkFlowEndpoint> SubscriptionBase::get_network_flow_endp
 
   return network_flow_endpoint_vector;
 }
+
+rclcpp::EntityMemoryFootprint
+SubscriptionBase::get_memory_footprint() const
+{
+  rclcpp::EntityMemoryFootprint footprint;
+  footprint.kind = "subscription";
+  footprint.name = get_topic_name();
+  auto intra_process_subscription =
+    std::dynamic_pointer_cast<rclcpp::experimental::SubscriptionIntraProcessBase>(
+    get_intra_process_waitable());
+  if (intra_process_subscription) {
+    footprint.intra_process_buffers = intra_process_subscription->get_buffer_memory_size();
+  }
+  return footprint;
+}
@@ -14,8 +14,43 @@
 
 #include "rclcpp/experimental/subscription_intra_process_base.hpp"
 
+#include <algorithm>
+#include <vector>
+
 using rclcpp::experimental::SubscriptionIntraProcessBase;
 
+namespace
+{
+
+/// Subscriptions the calling thread is delivering a message inline to, innermost last.
+thread_local std::vector<const SubscriptionIntraProcessBase *> inline_deliveries;
+
+}  // namespace
+
+SubscriptionIntraProcessBase::InlineDeliveryScope::InlineDeliveryScope(
+  const SubscriptionIntraProcessBase * subscription)
+: entered_(false)
+{
+  if (inline_deliveries.size() >= max_inline_delivery_depth) {
+    return;
+  }
+  if (std::find(
+      inline_deliveries.begin(), inline_deliveries.end(), subscription) !=
+    inline_deliveries.end())
+  {
+    return;
+  }
+  inline_deliveries.push_back(subscription);
+  entered_ = true;
+}
+
+SubscriptionIntraProcessBase::InlineDeliveryScope::~InlineDeliveryScope()
+{
+  if (entered_) {
+    inline_deliveries.pop_back();
+  }
+}
+
 bool
 SubscriptionIntraProcessBase::add_to_wait_set(rcl_wait_set_t * wait_set)
 {
@@ -0,0 +1,185 @@
+// Copyright 2021 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "rclcpp/thread_attributes.hpp"
+
+#if !defined(_WIN32)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include <exception>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+
+#include "rcutils/logging_macros.h"
+
+using rclcpp::ThreadAttributes;
+using rclcpp::ThreadSchedulingPolicy;
+
+namespace
+{
+
+#if !defined(_WIN32)
+void
+throw_if_error(int ret, const char * what)
+{
+  if (0 != ret) {
+    throw std::system_error(ret, std::generic_category(), what);
+  }
+}
+#endif
+
+void
+apply_cpu_affinity(const std::vector<size_t> & cpu_affinity)
+{
+  if (cpu_affinity.empty()) {
+    return;
+  }
+#if defined(__linux__)
+  cpu_set_t cpu_set;
+  CPU_ZERO(&cpu_set);
+  for (size_t cpu : cpu_affinity) {
+    if (cpu >= CPU_SETSIZE) {
+      throw std::invalid_argument("CPU index " + std::to_string(cpu) + " is out of range");
+    }
+    CPU_SET(cpu, &cpu_set);
+  }
+  throw_if_error(
+    pthread_setaffinity_np(pthread_self(), sizeof(cpu_set), &cpu_set),
+    "failed to set the CPU affinity of the thread");
+#else
+  throw std::runtime_error(
+          "setting the CPU affinity of a thread is not supported on this platform");
+#endif
+}
+
+void
+apply_scheduling_policy(ThreadSchedulingPolicy scheduling_policy, int priority)
+{
+  if (ThreadSchedulingPolicy::Inherit == scheduling_policy) {
+    return;
+  }
+#if !defined(_WIN32)
+  int policy = SCHED_OTHER;
+  if (ThreadSchedulingPolicy::Fifo == scheduling_policy) {
+    policy = SCHED_FIFO;
+  } else if (ThreadSchedulingPolicy::RoundRobin == scheduling_policy) {
+    policy = SCHED_RR;
+  } else {
+    // The time-sharing policy has no static priority.
+    priority = 0;
+  }
+  sched_param param{};
+  param.sched_priority = priority;
+  throw_if_error(
+    pthread_setschedparam(pthread_self(), policy, &param),
+    "failed to set the scheduling policy of the thread");
+#else
+  (void)priority;
+  throw std::runtime_error(
+          "setting the scheduling policy of a thread is not supported on this platform");
+#endif
+}
+
+}  // namespace
+
+bool
+ThreadAttributes::is_default() const
+{
+  return cpu_affinity.empty() && ThreadSchedulingPolicy::Inherit == scheduling_policy;
+}
+
+void
+rclcpp::apply_thread_attributes(const ThreadAttributes & attributes)
+{
+  apply_cpu_affinity(attributes.cpu_affinity);
+  apply_scheduling_policy(attributes.scheduling_policy, attributes.priority);
+}
+
+ThreadAttributes
+rclcpp::get_thread_attributes()
+{
+  ThreadAttributes attributes;
+#if defined(__linux__)
+  cpu_set_t cpu_set;
+  CPU_ZERO(&cpu_set);
+  throw_if_error(
+    pthread_getaffinity_np(pthread_self(), sizeof(cpu_set), &cpu_set),
+    "failed to get the CPU affinity of the thread");
+  for (size_t cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+    if (CPU_ISSET(cpu, &cpu_set)) {
+      attributes.cpu_affinity.push_back(cpu);
+    }
+  }
+#endif
+#if !defined(_WIN32)
+  int policy = SCHED_OTHER;
+  sched_param param{};
+  throw_if_error(
+    pthread_getschedparam(pthread_self(), &policy, &param),
+    "failed to get the scheduling policy of the thread");
+  if (SCHED_OTHER == policy) {
+    attributes.scheduling_policy = ThreadSchedulingPolicy::Other;
+  } else if (SCHED_FIFO == policy) {
+    attributes.scheduling_policy = ThreadSchedulingPolicy::Fifo;
+  } else if (SCHED_RR == policy) {
+    attributes.scheduling_policy = ThreadSchedulingPolicy::RoundRobin;
+  }
+  attributes.priority = param.sched_priority;
+#endif
+  return attributes;
+}
+
+rclcpp::ScopedThreadAttributes::ScopedThreadAttributes(const ThreadAttributes & attributes)
+{
+  if (attributes.is_default()) {
+    return;
+  }
+  // Only restore what is changed.
+  const ThreadAttributes current_attributes = get_thread_attributes();
+  if (!attributes.cpu_affinity.empty()) {
+    previous_attributes_.cpu_affinity = current_attributes.cpu_affinity;
+  }
+  if (ThreadSchedulingPolicy::Inherit != attributes.scheduling_policy) {
+    previous_attributes_.scheduling_policy = current_attributes.scheduling_policy;
+    previous_attributes_.priority = current_attributes.priority;
+  }
+  try {
+    apply_thread_attributes(attributes);
+  } catch (...) {
+    // Undo the affinity if only the scheduling policy failed.
+    try {
+      apply_thread_attributes(previous_attributes_);
+    } catch (...) {
+    }
+    throw;
+  }
+  applied_ = true;
+}
+
+rclcpp::ScopedThreadAttributes::~ScopedThreadAttributes()
+{
+  if (!applied_) {
+    return;
+  }
+  try {
+    apply_thread_attributes(previous_attributes_);
+  } catch (const std::exception & exception) {
+    RCUTILS_LOG_ERROR_NAMED(
+      "rclcpp",
+      "failed to restore the attributes of the thread: %s", exception.what());
+  }
+}
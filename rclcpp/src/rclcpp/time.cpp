@@ -282,4 +282,39 @@ Time::max()
 }
 
 
+void
+stamps_to_nanoseconds(
+  const builtin_interfaces::msg::Time * stamps,
+  size_t count,
+  rcl_time_point_value_t * nanoseconds)
+{
+  // Negative if the seconds of any stamp are.
+  int32_t all_seconds = 0;
+  for (size_t i = 0; i < count; ++i) {
+    all_seconds |= stamps[i].sec;
+    nanoseconds[i] = RCL_S_TO_NS(static_cast<rcl_time_point_value_t>(stamps[i].sec)) +
+      static_cast<rcl_time_point_value_t>(stamps[i].nanosec);
+  }
+  if (all_seconds < 0) {
+    throw std::runtime_error("cannot store a negative time point in rclcpp::Time");
+  }
+}
+
+void
+nanoseconds_to_stamps(
+  const rcl_time_point_value_t * nanoseconds,
+  size_t count,
+  builtin_interfaces::msg::Time * stamps)
+{
+  constexpr rcl_time_point_value_t kRemainder = RCL_S_TO_NS(1);
+  for (size_t i = 0; i < count; ++i) {
+    const rcl_time_point_value_t quotient = nanoseconds[i] / kRemainder;
+    const rcl_time_point_value_t remainder = nanoseconds[i] % kRemainder;
+    // Round towards negative infinity, so that the nanoseconds are positive.
+    const rcl_time_point_value_t borrow = remainder < 0 ? 1 : 0;
+    stamps[i].sec = static_cast<std::int32_t>(quotient - borrow);
+    stamps[i].nanosec = static_cast<std::uint32_t>(remainder + borrow * kRemainder);
+  }
+}
+
 }  // namespace rclcpp
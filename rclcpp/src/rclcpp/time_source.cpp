@@ -30,14 +30,18 @@
 #include "rclcpp/time.hpp"
 #include "rclcpp/time_source.hpp"
 
+#include "./detail/clock_distributor.hpp"
+
 namespace rclcpp
 {
 
 TimeSource::TimeSource(
   std::shared_ptr<rclcpp::Node> node,
   const rclcpp::QoS & qos,
-  bool use_clock_thread)
+  bool use_clock_thread,
+  bool use_shared_clock_subscription)
 : use_clock_thread_(use_clock_thread),
+  use_shared_clock_subscription_(use_shared_clock_subscription),
   logger_(rclcpp::get_logger("rclcpp")),
   qos_(qos)
 {
@@ -46,8 +50,10 @@ TimeSource::TimeSource(
 
 TimeSource::TimeSource(
   const rclcpp::QoS & qos,
-  bool use_clock_thread)
+  bool use_clock_thread,
+  bool use_shared_clock_subscription)
 : use_clock_thread_(use_clock_thread),
+  use_shared_clock_subscription_(use_shared_clock_subscription),
   logger_(rclcpp::get_logger("rclcpp")),
   qos_(qos)
 {
@@ -56,6 +62,7 @@ TimeSource::TimeSource(
 void TimeSource::attachNode(rclcpp::Node::SharedPtr node)
 {
   use_clock_thread_ = node->get_node_options().use_clock_thread();
+  use_shared_clock_subscription_ = node->get_node_options().use_shared_clock_subscription();
   attachNode(
     node->get_node_base_interface(),
     node->get_node_topics_interface(),
@@ -160,11 +167,7 @@ void TimeSource::attachClock(std::shared_ptr<rclcpp::Clock> clock)
   std::lock_guard<std::mutex> guard(clock_list_lock_);
   associated_clocks_.push_back(clock);
   // Set the clock to zero unless there's a recently received message
-  auto time_msg = std::make_shared<builtin_interfaces::msg::Time>();
-  if (last_msg_set_) {
-    time_msg = std::make_shared<builtin_interfaces::msg::Time>(last_msg_set_->clock);
-  }
-  set_clock(time_msg, ros_time_active_, clock);
+  set_clock(last_msg_nanoseconds(), ros_time_active_, clock);
 }
 
 void TimeSource::detachClock(std::shared_ptr<rclcpp::Clock> clock)
@@ -188,9 +191,17 @@ TimeSource::~TimeSource()
   }
 }
 
+rcl_time_point_value_t TimeSource::last_msg_nanoseconds() const
+{
+  if (!last_msg_set_) {
+    return 0;
+  }
+  return rclcpp::Time(last_msg_set_->clock).nanoseconds();
+}
+
 void TimeSource::set_clock(
-  const builtin_interfaces::msg::Time::SharedPtr msg, bool set_ros_time_enabled,
-  std::shared_ptr<rclcpp::Clock> clock)
+  rcl_time_point_value_t nanoseconds, bool set_ros_time_enabled,
+  const std::shared_ptr<rclcpp::Clock> & clock)
 {
   std::lock_guard<std::mutex> clock_guard(clock->get_clock_mutex());
 
@@ -209,7 +220,7 @@ void TimeSource::set_clock(
     }
   }
 
-  auto ret = rcl_set_ros_time_override(clock->get_clock_handle(), rclcpp::Time(*msg).nanoseconds());
+  auto ret = rcl_set_ros_time_override(clock->get_clock_handle(), nanoseconds);
   if (ret != RCL_RET_OK) {
     rclcpp::exceptions::throw_from_rcl_error(
       ret, "Failed to set ros_time_override_status");
@@ -223,12 +234,13 @@ void TimeSource::clock_cb(std::shared_ptr<const rosgraph_msgs::msg::Clock> msg)
   }
   // Cache the last message in case a new clock is attached.
   last_msg_set_ = msg;
-  auto time_msg = std::make_shared<builtin_interfaces::msg::Time>(msg->clock);
+  // Convert the time once for all the clocks.
+  const rcl_time_point_value_t nanoseconds = rclcpp::Time(msg->clock).nanoseconds();
 
   if (SET_TRUE == this->parameter_state_) {
     std::lock_guard<std::mutex> guard(clock_list_lock_);
-    for (auto it = associated_clocks_.begin(); it != associated_clocks_.end(); ++it) {
-      set_clock(time_msg, true, *it);
+    for (const auto & clock : associated_clocks_) {
+      set_clock(nanoseconds, true, clock);
     }
   }
 }
@@ -236,11 +248,20 @@ void TimeSource::clock_cb(std::shared_ptr<const rosgraph_msgs::msg::Clock> msg)
 void TimeSource::create_clock_sub()
 {
   std::lock_guard<std::mutex> guard(clock_sub_lock_);
-  if (clock_subscription_) {
+  if (clock_subscription_ || clock_distributor_) {
     // Subscription already created.
     return;
   }
 
+  if (use_shared_clock_subscription_) {
+    auto context = node_base_->get_context();
+    auto clock_distributor = context->get_sub_context<detail::ClockDistributor>();
+    clock_distributor_id_ = clock_distributor->attach(
+      context, std::bind(&TimeSource::clock_cb, this, std::placeholders::_1));
+    clock_distributor_ = clock_distributor;
+    return;
+  }
+
   rclcpp::SubscriptionOptions options;
   options.qos_overriding_options = rclcpp::QosOverridingOptions(
     {
@@ -285,6 +306,10 @@ void TimeSource::create_clock_sub()
 void TimeSource::destroy_clock_sub()
 {
   std::lock_guard<std::mutex> guard(clock_sub_lock_);
+  if (clock_distributor_) {
+    clock_distributor_->detach(clock_distributor_id_);
+    clock_distributor_.reset();
+  }
   if (clock_executor_thread_.joinable()) {
     cancel_clock_executor_promise_.set_value();
     clock_executor_->cancel();
@@ -342,12 +367,9 @@ void TimeSource::enable_ros_time()
 
   // Update all attached clocks to zero or last recorded time
   std::lock_guard<std::mutex> guard(clock_list_lock_);
-  auto time_msg = std::make_shared<builtin_interfaces::msg::Time>();
-  if (last_msg_set_) {
-    time_msg = std::make_shared<builtin_interfaces::msg::Time>(last_msg_set_->clock);
-  }
-  for (auto it = associated_clocks_.begin(); it != associated_clocks_.end(); ++it) {
-    set_clock(time_msg, true, *it);
+  const rcl_time_point_value_t nanoseconds = last_msg_nanoseconds();
+  for (const auto & clock : associated_clocks_) {
+    set_clock(nanoseconds, true, clock);
   }
 }
 
@@ -363,9 +385,8 @@ void TimeSource::disable_ros_time()
 
   // Update all attached clocks
   std::lock_guard<std::mutex> guard(clock_list_lock_);
-  for (auto it = associated_clocks_.begin(); it != associated_clocks_.end(); ++it) {
-    auto msg = std::make_shared<builtin_interfaces::msg::Time>();
-    set_clock(msg, false, *it);
+  for (const auto & clock : associated_clocks_) {
+    set_clock(0, false, clock);
   }
 }
 
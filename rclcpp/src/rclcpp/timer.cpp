@@ -14,24 +14,87 @@
 
 #include "rclcpp/timer.hpp"
 
+#include <algorithm>
 #include <chrono>
+#include <cstdint>
+#include <limits>
 #include <string>
 #include <memory>
+#include <stdexcept>
 #include <thread>
 
+#include "rcl/guard_condition.h"
+
 #include "rclcpp/contexts/default_context.hpp"
 #include "rclcpp/exceptions.hpp"
 
+#include "rcutils/error_handling.h"
 #include "rcutils/logging_macros.h"
+#include "rcutils/time.h"
 
 using rclcpp::TimerBase;
+using rclcpp::TimerClockSnapshot;
+
+namespace
+{
+
+/// Next call time kept for a canceled timer, which is never ready.
+constexpr int64_t canceled_next_call_time = std::numeric_limits<int64_t>::max();
+
+/// Read the time of the steady or the system clock, as the rcl clocks of these types do.
+int64_t
+read_clock(rcl_clock_type_t clock_type)
+{
+  rcutils_time_point_value_t now = 0;
+  rcutils_ret_t ret = RCUTILS_RET_OK;
+  if (clock_type == RCL_STEADY_TIME) {
+    ret = rcutils_steady_time_now(&now);
+  } else if (clock_type == RCL_SYSTEM_TIME) {
+    ret = rcutils_system_time_now(&now);
+  } else {
+    throw std::invalid_argument("only the steady and the system clocks can be snapshotted");
+  }
+  if (ret != RCUTILS_RET_OK) {
+    const std::string error = rcutils_get_error_string().str;
+    rcutils_reset_error();
+    throw std::runtime_error("Couldn't read the clock: " + error);
+  }
+  return now;
+}
+
+}  // namespace
+
+int64_t
+TimerClockSnapshot::now(rcl_clock_type_t clock_type)
+{
+  if (clock_type == RCL_STEADY_TIME) {
+    if (!has_steady_time_) {
+      steady_time_ = read_clock(clock_type);
+      has_steady_time_ = true;
+    }
+    return steady_time_;
+  }
+  if (clock_type == RCL_SYSTEM_TIME) {
+    if (!has_system_time_) {
+      system_time_ = read_clock(clock_type);
+      has_system_time_ = true;
+    }
+    return system_time_;
+  }
+  return read_clock(clock_type);
+}
 
 TimerBase::TimerBase(
   rclcpp::Clock::SharedPtr clock,
   std::chrono::nanoseconds period,
-  rclcpp::Context::SharedPtr context)
-: clock_(clock), timer_handle_(nullptr)
+  rclcpp::Context::SharedPtr context,
+  std::chrono::nanoseconds slack)
+: clock_(clock), timer_handle_(nullptr), slack_(slack)
 {
+  if (slack < std::chrono::nanoseconds(0)) {
+    throw std::invalid_argument("timer slack cannot be negative");
+  }
+
   if (nullptr == context) {
     context = rclcpp::contexts::get_global_default_context();
   }
@@ -68,18 +131,56 @@ TimerBase::TimerBase(
       rclcpp::exceptions::throw_from_rcl_error(ret, "Couldn't initialize rcl timer handle");
     }
   }
+
+  keeps_next_call_time_ =
+    clock_->get_clock_type() == RCL_STEADY_TIME || clock_->get_clock_type() == RCL_SYSTEM_TIME;
+
+  if (clock_->get_clock_type() == RCL_ROS_TIME) {
+    // rcl only wakes the wait sets of the timer up when ROS time jumps back or
+    // is (de)activated, otherwise they notice the timer at their timeout, which
+    // is computed in ROS time but waited in wall time, so late when ROS time
+    // runs faster than real time.
+    // Wake them up as soon as an update of the ROS time makes the timer ready.
+    rcl_jump_threshold_t threshold;
+    threshold.on_clock_change = false;
+    threshold.min_forward.nanoseconds = 1;
+    threshold.min_backward.nanoseconds = 0;
+    rcl_timer_t * timer = timer_handle_.get();
+    clock_jump_handler_ = clock_->create_jump_callback(
+      nullptr,
+      [timer](const rcl_time_jump_t &) {
+        bool ready = false;
+        if (RCL_RET_OK != rcl_timer_is_ready(timer, &ready)) {
+          rcl_reset_error();
+          return;
+        }
+        if (!ready) {
+          return;
+        }
+        rcl_guard_condition_t * guard_condition = rcl_timer_get_guard_condition(timer);
+        if (guard_condition && RCL_RET_OK != rcl_trigger_guard_condition(guard_condition)) {
+          rcl_reset_error();
+        }
+      },
+      threshold);
+  }
 }
 
 TimerBase::~TimerBase()
-{}
+{
+  // Remove the jump callback first, it uses the timer handle.
+  clock_jump_handler_.reset();
+}
 
 void
 TimerBase::cancel()
 {
+  std::lock_guard<std::mutex> lock(next_call_time_mutex_);
   rcl_ret_t ret = rcl_timer_cancel(timer_handle_.get());
   if (ret != RCL_RET_OK) {
     rclcpp::exceptions::throw_from_rcl_error(ret, "Couldn't cancel timer");
   }
+  next_call_time_.store(canceled_next_call_time, std::memory_order_release);
 }
 
 bool
@@ -96,10 +197,13 @@ TimerBase::is_canceled()
 void
 TimerBase::reset()
 {
+  std::lock_guard<std::mutex> lock(next_call_time_mutex_);
   rcl_ret_t ret = rcl_timer_reset(timer_handle_.get());
   if (ret != RCL_RET_OK) {
     rclcpp::exceptions::throw_from_rcl_error(ret, "Couldn't reset timer");
   }
+  // Read again from rcl by the next check.
+  next_call_time_.store(0, std::memory_order_release);
 }
 
 bool
@@ -113,6 +217,65 @@ TimerBase::is_ready()
   return ready;
 }
 
+bool
+TimerBase::is_ready(TimerClockSnapshot & snapshot)
+{
+  if (!keeps_next_call_time_) {
+    return is_ready();
+  }
+  // Read before rcl reads the clock, for the time kept below not to be late.
+  const int64_t now = snapshot.now(clock_->get_clock_type());
+  const int64_t next_call_time = next_call_time_.load(std::memory_order_acquire);
+  if (next_call_time != 0 && now < next_call_time) {
+    return false;
+  }
+
+  // Due by the kept time, which may be early, or unknown: ask rcl, and keep its answer.
+  std::lock_guard<std::mutex> lock(next_call_time_mutex_);
+  int64_t time_until_next_call = 0;
+  rcl_ret_t ret = rcl_timer_get_time_until_next_call(
+    timer_handle_.get(), &time_until_next_call);
+  if (ret == RCL_RET_TIMER_CANCELED) {
+    rcl_reset_error();
+    next_call_time_.store(canceled_next_call_time, std::memory_order_release);
+    return false;
+  }
+  if (ret != RCL_RET_OK) {
+    rclcpp::exceptions::throw_from_rcl_error(ret, "Failed to check timer");
+  }
+  next_call_time_.store(
+    std::max<int64_t>(now + time_until_next_call, 1), std::memory_order_release);
+  return time_until_next_call <= 0;
+}
+
+bool
+TimerBase::call_timer_handle()
+{
+  std::lock_guard<std::mutex> lock(next_call_time_mutex_);
+  rcl_ret_t ret = rcl_timer_call(timer_handle_.get());
+  if (ret == RCL_RET_TIMER_CANCELED) {
+    rcl_reset_error();
+    next_call_time_.store(canceled_next_call_time, std::memory_order_release);
+    return false;
+  }
+  if (ret != RCL_RET_OK) {
+    throw std::runtime_error("Failed to notify timer that callback occurred");
+  }
+  // rcl moves the next call time a period later at least, further if periods were missed.
+  const int64_t next_call_time = next_call_time_.load(std::memory_order_relaxed);
+  int64_t period = 0;
+  if (
+    next_call_time != 0 && next_call_time != canceled_next_call_time &&
+    rcl_timer_get_period(timer_handle_.get(), &period) == RCL_RET_OK)
+  {
+    next_call_time_.store(next_call_time + period, std::memory_order_release);
+  } else {
+    rcl_reset_error();
+    next_call_time_.store(0, std::memory_order_release);
+  }
+  return true;
+}
+
 std::chrono::nanoseconds
 TimerBase::time_until_trigger()
 {
@@ -125,6 +288,49 @@ TimerBase::time_until_trigger()
   return std::chrono::nanoseconds(time_until_next_call);
 }
 
+rclcpp::TimerStatistics::SharedPtr
+TimerBase::enable_statistics()
+{
+  std::lock_guard<std::mutex> lock(statistics_mutex_);
+  if (!statistics_owner_) {
+    statistics_owner_ = std::make_shared<TimerStatistics>();
+    statistics_.store(statistics_owner_.get(), std::memory_order_release);
+  }
+  return statistics_owner_;
+}
+
+rclcpp::TimerStatistics::SharedPtr
+TimerBase::get_statistics() const
+{
+  std::lock_guard<std::mutex> lock(statistics_mutex_);
+  return statistics_owner_;
+}
+
+void
+TimerBase::record_call_statistics(TimerStatistics & statistics)
+{
+  int64_t time_until_next_call = 0;
+  int64_t period = 0;
+  if (rcl_timer_get_time_until_next_call(timer_handle_.get(), &time_until_next_call) !=
+    RCL_RET_OK ||
+    rcl_timer_get_period(timer_handle_.get(), &period) != RCL_RET_OK)
+  {
+    // The timer was canceled, the call will not happen.
+    rcl_reset_error();
+    return;
+  }
+  // A negative time until the next call is how late the timer is.
+  const int64_t lateness = time_until_next_call < 0 ? -time_until_next_call : 0;
+  const uint64_t missed_periods = period > 0 ? static_cast<uint64_t>(lateness / period) : 0u;
+  statistics.record_call(std::chrono::nanoseconds(lateness), missed_periods);
+}
+
+std::chrono::nanoseconds
+TimerBase::get_slack() const
+{
+  return slack_;
+}
+
 std::shared_ptr<const rcl_timer_t>
 TimerBase::get_timer_handle()
 {
@@ -0,0 +1,85 @@
+// Copyright 2021 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "rclcpp/timer_statistics.hpp"
+
+#include <atomic>
+#include <cstdint>
+
+using rclcpp::DurationHistogram;
+using rclcpp::TimerStatistics;
+
+namespace
+{
+
+void
+atomic_max(std::atomic<uint64_t> & value, uint64_t candidate)
+{
+  uint64_t expected = value.load(std::memory_order_relaxed);
+  while (candidate > expected &&
+    !value.compare_exchange_weak(expected, candidate, std::memory_order_relaxed))
+  {
+  }
+}
+
+}  // namespace
+
+void
+TimerStatistics::record_call(std::chrono::nanoseconds wakeup_latency, uint64_t missed_periods)
+{
+  wakeup_latency_.record(wakeup_latency);
+  if (missed_periods > 0u) {
+    missed_periods_.fetch_add(missed_periods, std::memory_order_relaxed);
+    atomic_max(max_missed_periods_, missed_periods);
+  }
+}
+
+void
+TimerStatistics::record_callback_duration(std::chrono::nanoseconds duration)
+{
+  callback_duration_.record(duration);
+}
+
+DurationHistogram::Snapshot
+TimerStatistics::get_wakeup_latency() const
+{
+  return wakeup_latency_.get_snapshot();
+}
+
+DurationHistogram::Snapshot
+TimerStatistics::get_callback_duration() const
+{
+  return callback_duration_.get_snapshot();
+}
+
+uint64_t
+TimerStatistics::get_missed_periods() const
+{
+  return missed_periods_.load(std::memory_order_relaxed);
+}
+
+uint64_t
+TimerStatistics::get_max_missed_periods() const
+{
+  return max_missed_periods_.load(std::memory_order_relaxed);
+}
+
+void
+TimerStatistics::reset()
+{
+  wakeup_latency_.reset();
+  callback_duration_.reset();
+  missed_periods_.store(0u, std::memory_order_relaxed);
+  max_missed_periods_.store(0u, std::memory_order_relaxed);
+}
@@ -15,19 +15,30 @@
 
 #include "rclcpp/typesupport_helpers.hpp"
 
+#include <cstddef>
 #include <functional>
+#include <map>
 #include <memory>
+#include <mutex>
 #include <sstream>
 #include <stdexcept>
 #include <string>
 #include <tuple>
 #include <utility>
+#include <vector>
 
 #include "ament_index_cpp/get_package_prefix.hpp"
 #include "ament_index_cpp/get_resources.hpp"
 #include "rcpputils/shared_library.hpp"
 #include "rcpputils/find_library.hpp"
+#include "rcpputils/scope_exit.hpp"
+#include "rosidl_runtime_cpp/message_initialization.hpp"
 #include "rosidl_runtime_cpp/message_type_support_decl.hpp"
+#include "rosidl_typesupport_introspection_cpp/identifier.hpp"
+#include "rosidl_typesupport_introspection_cpp/message_introspection.hpp"
+
+#include "rclcpp/serialization.hpp"
+#include "rclcpp/serialized_message.hpp"
 
 namespace rclcpp
 {
@@ -91,14 +102,63 @@ extract_type_identifier(const std::string & full_type)
   return std::make_tuple(package_name, middle_module, type_name);
 }
 
+// Process-wide cache of the type support libraries and of the handles looked up in them.
+struct TypesupportCache
+{
+  struct CachedHandle
+  {
+    const rcpputils::SharedLibrary * library;
+    const rosidl_message_type_support_t * handle;
+  };
+
+  static TypesupportCache &
+  get_instance()
+  {
+    // Never destroyed, the handles may still be used while static objects are destroyed.
+    static TypesupportCache * instance = new TypesupportCache();
+    return *instance;
+  }
+
+  // Return true if the library is one of the cached ones, which stay loaded.
+  bool
+  is_cached(
+    const std::string & package_name,
+    const std::string & typesupport_identifier,
+    const rcpputils::SharedLibrary & library) const
+  {
+    auto it = libraries.find(std::make_pair(package_name, typesupport_identifier));
+    return it != libraries.end() && it->second.get() == &library;
+  }
+
+  std::mutex mutex;
+  // Keyed by package name and type support identifier, a library holds all the types of a package.
+  std::map<std::pair<std::string, std::string>, std::shared_ptr<rcpputils::SharedLibrary>>
+  libraries;
+  // Keyed by type and type support identifier.
+  std::map<std::pair<std::string, std::string>, CachedHandle> handles;
+};
+
 }  // anonymous namespace
 
 std::shared_ptr<rcpputils::SharedLibrary>
 get_typesupport_library(const std::string & type, const std::string & typesupport_identifier)
 {
   auto package_name = std::get<0>(extract_type_identifier(type));
-  auto library_path = get_typesupport_library_path(package_name, typesupport_identifier);
-  return std::make_shared<rcpputils::SharedLibrary>(library_path);
+
+  auto & cache = TypesupportCache::get_instance();
+  std::lock_guard<std::mutex> lock(cache.mutex);
+  auto & library = cache.libraries[std::make_pair(package_name, typesupport_identifier)];
+  if (!library) {
+    try {
+      auto library_path = get_typesupport_library_path(package_name, typesupport_identifier);
+      library = std::make_shared<rcpputils::SharedLibrary>(library_path);
+    } catch (...) {
+      // Don't cache the failure, the library may be installed later.
+      cache.libraries.erase(std::make_pair(package_name, typesupport_identifier));
+      throw;
+    }
+  }
+  return library;
 }
 
 const rosidl_message_type_support_t *
@@ -120,6 +180,14 @@ get_typesupport_handle(
       return rcutils_dynamic_loading_error.str();
     };
 
+  auto & cache = TypesupportCache::get_instance();
+  std::lock_guard<std::mutex> lock(cache.mutex);
+  const auto handle_key = std::make_pair(type, typesupport_identifier);
+  auto cached = cache.handles.find(handle_key);
+  if (cached != cache.handles.end() && cached->second.library == &library) {
+    return cached->second.handle;
+  }
+
   try {
     std::string symbol_name = typesupport_identifier + "__get_message_type_support_handle__" +
       package_name + "__" + (middle_module.empty() ? "msg" : middle_module) + "__" + type_name;
@@ -127,10 +195,42 @@ get_typesupport_handle(
     const rosidl_message_type_support_t * (* get_ts)() = nullptr;
     // This will throw runtime_error if the symbol was not found.
     get_ts = reinterpret_cast<decltype(get_ts)>(library.get_symbol(symbol_name));
-    return get_ts();
+    const rosidl_message_type_support_t * handle = get_ts();
+    // Only the handles of the cached libraries are cached, the other libraries may be unloaded.
+    if (cache.is_cached(package_name, typesupport_identifier, library)) {
+      cache.handles[handle_key] = {&library, handle};
+    }
+    return handle;
   } catch (std::runtime_error &) {
     throw std::runtime_error{mk_error("Library could not be found.")};
   }
 }
 
+void
+preload_typesupport(const std::string & type)
+{
+  namespace introspection = rosidl_typesupport_introspection_cpp;
+
+  auto library = get_typesupport_library(type, "rosidl_typesupport_cpp");
+  const rosidl_message_type_support_t * type_support =
+    get_typesupport_handle(type, "rosidl_typesupport_cpp", *library);
+  // Looking up the introspection type support opens its library.
+  const rosidl_message_type_support_t * introspection_type_support =
+    get_message_typesupport_handle(type_support, introspection::typesupport_identifier);
+  if (nullptr == introspection_type_support) {
+    throw std::runtime_error("the type " + type + " has no introspection type support");
+  }
+  const auto * members =
+    static_cast<const introspection::MessageMembers *>(introspection_type_support->data);
+
+  // The middleware opens its type support library to serialize the message.
+  std::vector<std::max_align_t> storage(
+    (members->size_of_ + sizeof(std::max_align_t) - 1) / sizeof(std::max_align_t));
+  void * message = storage.data();
+  members->init_function(message, rosidl_runtime_cpp::MessageInitialization::ALL);
+  RCPPUTILS_SCOPE_EXIT(members->fini_function(message); );
+  rclcpp::SerializedMessage serialized_message;
+  rclcpp::SerializationBase(type_support).serialize_message(message, &serialized_message);
+}
+
 }  // namespace rclcpp
@@ -0,0 +1,176 @@
+// Copyright 2021 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "rclcpp/worker_pool.hpp"
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "rclcpp/logging.hpp"
+
+using rclcpp::WorkerPool;
+
+// Shared with the threads, so that a thread detached by a shutdown called
+// from the pool does not outlive it.
+struct WorkerPool::State
+{
+  static void
+  run(std::shared_ptr<State> state, size_t thread_index)
+  {
+    if (thread_index < state->options.thread_attributes.size()) {
+      try {
+        rclcpp::apply_thread_attributes(state->options.thread_attributes[thread_index]);
+      } catch (const std::exception & exception) {
+        RCLCPP_ERROR(
+          rclcpp::get_logger("rclcpp"),
+          "failed to apply the attributes of worker thread %zu: %s",
+          thread_index, exception.what());
+      }
+    }
+
+    std::unique_lock<std::mutex> lock(state->mutex);
+    while (true) {
+      ++state->idle_threads;
+      state->condition.wait(lock, [&state]() {return state->stopped || !state->queue.empty();});
+      --state->idle_threads;
+      if (state->stopped) {
+        return;
+      }
+      std::function<void()> function = std::move(state->queue.front());
+      state->queue.pop_front();
+      lock.unlock();
+      try {
+        function();
+      } catch (const std::exception & exception) {
+        RCLCPP_ERROR(
+          rclcpp::get_logger("rclcpp"),
+          "exception in a function of the worker pool: %s", exception.what());
+      } catch (...) {
+        RCLCPP_ERROR(
+          rclcpp::get_logger("rclcpp"), "unknown exception in a function of the worker pool");
+      }
+      // Destroyed before the lock is taken, what it holds may use the pool.
+      function = nullptr;
+      lock.lock();
+    }
+  }
+
+  WorkerPoolOptions options;
+  size_t max_threads = 0;
+
+  mutable std::mutex mutex;
+  std::condition_variable condition;
+  std::deque<std::function<void()>> queue;
+  std::vector<std::thread> threads;
+  size_t idle_threads = 0;
+  bool stopped = false;
+};
+
+WorkerPool::WorkerPool(const WorkerPoolOptions & options)
+: state_(std::make_shared<State>())
+{
+  state_->options = options;
+  state_->max_threads = options.max_threads;
+  if (state_->max_threads == 0) {
+    state_->max_threads = std::max(1u, std::thread::hardware_concurrency());
+  }
+}
+
+WorkerPool::~WorkerPool()
+{
+  shutdown();
+}
+
+void
+WorkerPool::post(std::function<void()> function)
+{
+  {
+    std::lock_guard<std::mutex> lock(state_->mutex);
+    if (state_->stopped) {
+      throw std::runtime_error("worker pool is shut down");
+    }
+    state_->queue.push_back(std::move(function));
+    if (
+      state_->queue.size() > state_->idle_threads &&
+      state_->threads.size() < state_->max_threads)
+    {
+      state_->threads.emplace_back(&State::run, state_, state_->threads.size());
+      return;
+    }
+  }
+  state_->condition.notify_one();
+}
+
+void
+WorkerPool::shutdown()
+{
+  std::deque<std::function<void()>> queue;
+  std::vector<std::thread> threads;
+  {
+    std::lock_guard<std::mutex> lock(state_->mutex);
+    if (state_->stopped) {
+      return;
+    }
+    state_->stopped = true;
+    queue.swap(state_->queue);
+    threads.swap(state_->threads);
+  }
+  state_->condition.notify_all();
+  // Dropping the functions breaks the promises of their futures.
+  queue.clear();
+  for (std::thread & thread : threads) {
+    if (thread.get_id() == std::this_thread::get_id()) {
+      thread.detach();
+    } else {
+      thread.join();
+    }
+  }
+}
+
+bool
+WorkerPool::is_shutdown() const
+{
+  std::lock_guard<std::mutex> lock(state_->mutex);
+  return state_->stopped;
+}
+
+size_t
+WorkerPool::get_max_threads() const
+{
+  return state_->max_threads;
+}
+
+size_t
+WorkerPool::get_number_of_threads() const
+{
+  std::lock_guard<std::mutex> lock(state_->mutex);
+  return state_->threads.size();
+}
+
+size_t
+WorkerPool::get_pending_count() const
+{
+  std::lock_guard<std::mutex> lock(state_->mutex);
+  return state_->queue.size();
+}
@@ -0,0 +1,302 @@
+// Copyright 2021 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Scaling of the executors with the number of entities and of threads, as a shared yardstick
+// for the scheduling changes.
+//
+// The executor argument of the benchmarks selects the executor:
+// - 0: SingleThreadedExecutor
+// - 1: StaticSingleThreadedExecutor
+// - 2: EventsExecutor
+// - 3: MultiThreadedExecutor
+// - 4: StaticMultiThreadedExecutor
+//
+// The benchmarks are:
+// - wakeup: cost of waking up for one message, vs. the number of idle timers the executor
+//   also waits on.
+// - timer_dispatch: cost of executing a number of ready timers in one spin_some().
+// - throughput: messages processed per second by a pool of threads, vs. the number of threads.
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "performance_test_fixture/performance_test_fixture.hpp"
+#include "rclcpp/rclcpp.hpp"
+#include "test_msgs/msg/empty.hpp"
+
+using namespace std::chrono_literals;
+using performance_test_fixture::PerformanceTest;
+using test_msgs::msg::Empty;
+
+enum ExecutorKind : int64_t
+{
+  kSingleThreaded = 0,
+  kStaticSingleThreaded = 1,
+  kEvents = 2,
+  kMultiThreaded = 3,
+  kStaticMultiThreaded = 4,
+};
+
+static std::shared_ptr<rclcpp::Executor>
+make_executor(int64_t kind, size_t number_of_threads = 0)
+{
+  switch (kind) {
+    case kSingleThreaded:
+      return std::make_shared<rclcpp::executors::SingleThreadedExecutor>();
+    case kStaticSingleThreaded:
+      return std::make_shared<rclcpp::executors::StaticSingleThreadedExecutor>();
+    case kEvents:
+      return std::make_shared<rclcpp::executors::EventsExecutor>();
+    case kMultiThreaded:
+      return std::make_shared<rclcpp::executors::MultiThreadedExecutor>(
+        rclcpp::ExecutorOptions(), number_of_threads);
+    case kStaticMultiThreaded:
+      return std::make_shared<rclcpp::executors::StaticMultiThreadedExecutor>(
+        rclcpp::ExecutorOptions(), number_of_threads);
+    default:
+      return nullptr;
+  }
+}
+
+class ExecutorScalingPerformanceTest : public PerformanceTest
+{
+public:
+  void SetUp(benchmark::State & state)
+  {
+    rclcpp::init(0, nullptr);
+    // Without the parameter services, the node only has the entities of the benchmark.
+    auto options = rclcpp::NodeOptions()
+      .start_parameter_services(false)
+      .start_parameter_event_publisher(false);
+    node = std::make_shared<rclcpp::Node>("executor_scaling_node", "ns", options);
+
+    performance_test_fixture::PerformanceTest::SetUp(state);
+  }
+
+  void TearDown(benchmark::State & state)
+  {
+    performance_test_fixture::PerformanceTest::TearDown(state);
+
+    node.reset();
+    rclcpp::shutdown();
+  }
+
+protected:
+  /// Create timers which never expire during the benchmark.
+  std::vector<rclcpp::TimerBase::SharedPtr>
+  create_idle_timers(size_t number_of_timers)
+  {
+    std::vector<rclcpp::TimerBase::SharedPtr> timers;
+    timers.reserve(number_of_timers);
+    for (size_t i = 0; i < number_of_timers; ++i) {
+      timers.push_back(node->create_wall_timer(1h, []() {}));
+    }
+    return timers;
+  }
+
+  /// Spin once at a time until the count reaches the expected one.
+  static bool
+  spin_until_count(rclcpp::Executor & executor, const size_t & count, size_t expected)
+  {
+    auto start = std::chrono::steady_clock::now();
+    while (count < expected) {
+      if (std::chrono::steady_clock::now() - start > 5s) {
+        return false;
+      }
+      executor.spin_once(100ms);
+    }
+    return true;
+  }
+
+  rclcpp::Node::SharedPtr node;
+};
+
+BENCHMARK_DEFINE_F(ExecutorScalingPerformanceTest, wakeup)(benchmark::State & state)
+{
+  auto executor = make_executor(state.range(0));
+  const auto idle_timers = create_idle_timers(static_cast<size_t>(state.range(1)));
+
+  size_t count = 0;
+  auto subscription = node->create_subscription<Empty>(
+    "wakeup", rclcpp::QoS(10), [&count](Empty::ConstSharedPtr) {++count;});
+  auto publisher = node->create_publisher<Empty>("wakeup", rclcpp::QoS(10));
+  executor->add_node(node);
+
+  // Warm up, the entities are collected by the first waits.
+  publisher->publish(Empty());
+  if (!spin_until_count(*executor, count, 1u)) {
+    state.SkipWithError("Message was not received");
+    return;
+  }
+
+  reset_heap_counters();
+  for (auto _ : state) {
+    state.PauseTiming();
+    publisher->publish(Empty());
+    state.ResumeTiming();
+
+    if (!spin_until_count(*executor, count, count + 1u)) {
+      state.SkipWithError("Message was not received");
+      break;
+    }
+  }
+  executor->remove_node(node);
+}
+
+static void
+WakeupArguments(benchmark::internal::Benchmark * benchmark)
+{
+  benchmark->ArgNames({"executor", "idle_timers"});
+  for (int64_t executor : {kSingleThreaded, kStaticSingleThreaded, kEvents}) {
+    for (int64_t idle_timers : {10, 100, 1000, 10000}) {
+      benchmark->Args({executor, idle_timers});
+    }
+  }
+}
+
+BENCHMARK_REGISTER_F(ExecutorScalingPerformanceTest, wakeup)
+->Apply(WakeupArguments)
+->UseRealTime();
+
+BENCHMARK_DEFINE_F(ExecutorScalingPerformanceTest, timer_dispatch)(benchmark::State & state)
+{
+  auto executor = make_executor(state.range(0));
+  const auto number_of_timers = static_cast<size_t>(state.range(1));
+
+  // The timers are always ready, each spin_some() executes all of them once.
+  size_t count = 0;
+  std::vector<rclcpp::TimerBase::SharedPtr> timers;
+  timers.reserve(number_of_timers);
+  for (size_t i = 0; i < number_of_timers; ++i) {
+    timers.push_back(node->create_wall_timer(1ns, [&count]() {++count;}));
+  }
+  executor->add_node(node);
+
+  executor->spin_some();
+  if (count == 0u) {
+    state.SkipWithError("No timer was executed");
+    return;
+  }
+
+  count = 0;
+  reset_heap_counters();
+  for (auto _ : state) {
+    executor->spin_some();
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(count));
+  executor->remove_node(node);
+}
+
+static void
+TimerDispatchArguments(benchmark::internal::Benchmark * benchmark)
+{
+  benchmark->ArgNames({"executor", "timers"});
+  for (int64_t executor : {kSingleThreaded, kStaticSingleThreaded, kEvents}) {
+    for (int64_t timers : {10, 100, 1000, 10000}) {
+      benchmark->Args({executor, timers});
+    }
+  }
+}
+
+BENCHMARK_REGISTER_F(ExecutorScalingPerformanceTest, timer_dispatch)
+->Apply(TimerDispatchArguments);
+
+// Messages published per iteration of the throughput benchmark, spread over the topics.
+constexpr size_t throughput_topics = 16;
+constexpr size_t throughput_messages_per_topic = 8;
+
+BENCHMARK_DEFINE_F(ExecutorScalingPerformanceTest, throughput)(benchmark::State & state)
+{
+  const auto number_of_threads = static_cast<size_t>(state.range(1));
+  auto executor = make_executor(state.range(0), number_of_threads);
+
+  // The callbacks do some work, so that executing them in parallel pays off.
+  std::atomic_size_t count {0};
+  auto callback = [&count](Empty::ConstSharedPtr) {
+      auto start = std::chrono::steady_clock::now();
+      while (std::chrono::steady_clock::now() - start < 20us) {
+      }
+      ++count;
+    };
+  auto group = node->create_callback_group(rclcpp::CallbackGroupType::Reentrant);
+  rclcpp::SubscriptionOptions subscription_options;
+  subscription_options.callback_group = group;
+  std::vector<rclcpp::Subscription<Empty>::SharedPtr> subscriptions;
+  std::vector<rclcpp::Publisher<Empty>::SharedPtr> publishers;
+  for (size_t i = 0; i < throughput_topics; ++i) {
+    const std::string topic = "throughput_" + std::to_string(i);
+    subscriptions.push_back(
+      node->create_subscription<Empty>(
+        topic, rclcpp::QoS(throughput_messages_per_topic), callback, subscription_options));
+    publishers.push_back(
+      node->create_publisher<Empty>(topic, rclcpp::QoS(throughput_messages_per_topic)));
+  }
+  executor->add_node(node);
+  std::thread spin_thread([&executor]() {executor->spin();});
+
+  auto publish_and_wait = [&publishers, &count]() {
+      const size_t expected = count.load() + throughput_topics * throughput_messages_per_topic;
+      for (size_t i = 0; i < throughput_messages_per_topic; ++i) {
+        for (const auto & publisher : publishers) {
+          publisher->publish(Empty());
+        }
+      }
+      auto start = std::chrono::steady_clock::now();
+      while (count.load() < expected) {
+        if (std::chrono::steady_clock::now() - start > 5s) {
+          return false;
+        }
+        std::this_thread::yield();
+      }
+      return true;
+    };
+
+  // Warm up, until the publishers are matched.
+  if (!publish_and_wait()) {
+    state.SkipWithError("Messages were not received");
+  } else {
+    reset_heap_counters();
+    for (auto _ : state) {
+      if (!publish_and_wait()) {
+        state.SkipWithError("Messages were not received");
+        break;
+      }
+    }
+    state.SetItemsProcessed(
+      state.iterations() * static_cast<int64_t>(throughput_topics * throughput_messages_per_topic));
+  }
+
+  executor->cancel();
+  spin_thread.join();
+  executor->remove_node(node);
+}
+
+static void
+ThroughputArguments(benchmark::internal::Benchmark * benchmark)
+{
+  benchmark->ArgNames({"executor", "threads"});
+  for (int64_t executor : {kMultiThreaded, kStaticMultiThreaded}) {
+    for (int64_t threads : {1, 2, 4, 8}) {
+      benchmark->Args({executor, threads});
+    }
+  }
+}
+
+BENCHMARK_REGISTER_F(ExecutorScalingPerformanceTest, throughput)
+->Apply(ThroughputArguments)
+->UseRealTime();
@@ -0,0 +1,309 @@
+// Copyright 2021 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Queries of the ROS graph and wake ups of the graph listener on graph changes.
+//
+// The arguments of the query benchmarks are:
+// - nodes: the number of other nodes in the graph, each with a publisher and a
+//   subscription on a topic of its own.
+// - cached: 1 if the querying node uses the graph cache, see NodeOptions::use_graph_cache().
+//
+// The arguments of the graph change benchmark are:
+// - storm: 1 if another thread keeps creating and destroying publishers meanwhile.
+// Each iteration creates a publisher and waits for the querying node to see it.
+// The graph_changes_per_s counter is the rate of the changes noticed by the graph listener.
+// The allocations counted include the ones of the storm.
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "performance_test_fixture/performance_test_fixture.hpp"
+#include "rclcpp/graph_listener.hpp"
+#include "rclcpp/rclcpp.hpp"
+#include "test_msgs/msg/empty.hpp"
+#include "test_msgs/srv/empty.hpp"
+
+using performance_test_fixture::PerformanceTest;
+using test_msgs::msg::Empty;
+
+constexpr char graph_service_name[] = "graph_service";
+constexpr char first_topic_name[] = "topic_0";
+constexpr char wake_up_topic_name[] = "wake_up_topic";
+constexpr std::chrono::seconds discovery_timeout(10);
+
+namespace
+{
+
+rclcpp::NodeOptions
+get_peer_node_options()
+{
+  return rclcpp::NodeOptions()
+         .start_parameter_services(false)
+         .start_parameter_event_publisher(false);
+}
+
+/// Return the generation of the graph noticed by the graph listener of the context.
+uint64_t
+get_graph_generation(rclcpp::Node & node)
+{
+  auto context = node.get_node_base_interface()->get_context();
+  auto graph_listener =
+    context->get_sub_context<rclcpp::graph_listener::GraphListener>(context);
+  return graph_listener->get_graph_generation();
+}
+
+}  // namespace
+
+class GraphPerformanceTest : public PerformanceTest
+{
+public:
+  void SetUp(benchmark::State & state)
+  {
+    rclcpp::init(0, nullptr);
+    const auto number_of_nodes = static_cast<size_t>(state.range(0));
+    const bool cached = state.range(1) != 0;
+
+    for (size_t i = 0; i < number_of_nodes; ++i) {
+      auto node = std::make_shared<rclcpp::Node>(
+        "peer_node_" + std::to_string(i), "ns", get_peer_node_options());
+      const std::string topic_name = "topic_" + std::to_string(i);
+      publishers.push_back(node->create_publisher<Empty>(topic_name, 10));
+      subscriptions.push_back(
+        node->create_subscription<Empty>(topic_name, 10, [](Empty::ConstSharedPtr) {}));
+      peer_nodes.push_back(node);
+    }
+    service = peer_nodes.front()->create_service<test_msgs::srv::Empty>(
+      graph_service_name,
+      [](
+        const test_msgs::srv::Empty::Request::SharedPtr,
+        test_msgs::srv::Empty::Response::SharedPtr) {});
+
+    node = std::make_shared<rclcpp::Node>(
+      "query_node", "ns", get_peer_node_options().use_graph_cache(cached));
+    client = node->create_client<test_msgs::srv::Empty>(graph_service_name);
+
+    // Wait for the querying node to discover all the other nodes.
+    const auto deadline = std::chrono::steady_clock::now() + discovery_timeout;
+    discovered = false;
+    while (!discovered && std::chrono::steady_clock::now() < deadline) {
+      discovered =
+        node->get_node_names().size() > number_of_nodes &&
+        node->count_publishers("topic_" + std::to_string(number_of_nodes - 1)) > 0u &&
+        client->service_is_ready();
+      if (!discovered) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+      }
+    }
+
+    performance_test_fixture::PerformanceTest::SetUp(state);
+  }
+
+  void TearDown(benchmark::State & state)
+  {
+    performance_test_fixture::PerformanceTest::TearDown(state);
+
+    client.reset();
+    node.reset();
+    service.reset();
+    subscriptions.clear();
+    publishers.clear();
+    peer_nodes.clear();
+    rclcpp::shutdown();
+  }
+
+protected:
+  std::vector<rclcpp::Node::SharedPtr> peer_nodes;
+  std::vector<rclcpp::PublisherBase::SharedPtr> publishers;
+  std::vector<rclcpp::SubscriptionBase::SharedPtr> subscriptions;
+  rclcpp::ServiceBase::SharedPtr service;
+  rclcpp::Node::SharedPtr node;
+  rclcpp::Client<test_msgs::srv::Empty>::SharedPtr client;
+  bool discovered = false;
+};
+
+BENCHMARK_DEFINE_F(GraphPerformanceTest, get_topic_names_and_types)(benchmark::State & state)
+{
+  if (!discovered) {
+    state.SkipWithError("Graph was not discovered");
+    return;
+  }
+
+  reset_heap_counters();
+  for (auto _ : state) {
+    auto topic_names_and_types = node->get_topic_names_and_types();
+    benchmark::DoNotOptimize(topic_names_and_types);
+    benchmark::ClobberMemory();
+  }
+}
+
+BENCHMARK_DEFINE_F(GraphPerformanceTest, count_publishers)(benchmark::State & state)
+{
+  if (!discovered) {
+    state.SkipWithError("Graph was not discovered");
+    return;
+  }
+
+  reset_heap_counters();
+  for (auto _ : state) {
+    size_t count = node->count_publishers(first_topic_name);
+    benchmark::DoNotOptimize(count);
+    benchmark::ClobberMemory();
+  }
+}
+
+BENCHMARK_DEFINE_F(GraphPerformanceTest, get_publishers_info_by_topic)(benchmark::State & state)
+{
+  if (!discovered) {
+    state.SkipWithError("Graph was not discovered");
+    return;
+  }
+
+  reset_heap_counters();
+  for (auto _ : state) {
+    auto publishers_info = node->get_publishers_info_by_topic(first_topic_name);
+    benchmark::DoNotOptimize(publishers_info);
+    benchmark::ClobberMemory();
+  }
+}
+
+BENCHMARK_DEFINE_F(GraphPerformanceTest, wait_for_service)(benchmark::State & state)
+{
+  if (!discovered) {
+    state.SkipWithError("Graph was not discovered");
+    return;
+  }
+
+  reset_heap_counters();
+  for (auto _ : state) {
+    if (!client->wait_for_service(discovery_timeout)) {
+      state.SkipWithError("Service is not available");
+      break;
+    }
+  }
+}
+
+static void
+QueryArguments(benchmark::internal::Benchmark * benchmark)
+{
+  benchmark->ArgNames({"nodes", "cached"});
+  for (int64_t nodes : {1, 10, 100}) {
+    for (int64_t cached : {0, 1}) {
+      benchmark->Args({nodes, cached});
+    }
+  }
+}
+
+BENCHMARK_REGISTER_F(GraphPerformanceTest, get_topic_names_and_types)
+->Apply(QueryArguments);
+BENCHMARK_REGISTER_F(GraphPerformanceTest, count_publishers)
+->Apply(QueryArguments);
+BENCHMARK_REGISTER_F(GraphPerformanceTest, get_publishers_info_by_topic)
+->Apply(QueryArguments);
+BENCHMARK_REGISTER_F(GraphPerformanceTest, wait_for_service)
+->Apply(QueryArguments);
+
+class GraphChangePerformanceTest : public PerformanceTest
+{
+public:
+  void SetUp(benchmark::State & state)
+  {
+    rclcpp::init(0, nullptr);
+    node = std::make_shared<rclcpp::Node>("query_node", "ns", get_peer_node_options());
+    publishing_node = std::make_shared<rclcpp::Node>(
+      "publishing_node", "ns", get_peer_node_options());
+
+    if (state.range(0) != 0) {
+      storm_node = std::make_shared<rclcpp::Node>("storm_node", "ns", get_peer_node_options());
+      stopped.store(false);
+      storm_thread = std::thread(
+        [this]() {
+          size_t i = 0;
+          while (!stopped.load()) {
+            auto publisher = storm_node->create_publisher<Empty>(
+              "storm_topic_" + std::to_string(i++ % 100), 10);
+          }
+        });
+    }
+
+    performance_test_fixture::PerformanceTest::SetUp(state);
+  }
+
+  void TearDown(benchmark::State & state)
+  {
+    performance_test_fixture::PerformanceTest::TearDown(state);
+
+    if (storm_thread.joinable()) {
+      stopped.store(true);
+      storm_thread.join();
+    }
+    storm_node.reset();
+    publishing_node.reset();
+    node.reset();
+    rclcpp::shutdown();
+  }
+
+protected:
+  /// Wait for the querying node to see the given number of publishers on the topic.
+  bool
+  wait_for_publishers(size_t count)
+  {
+    return node->get_node_graph_interface()->wait_for_graph_predicate(
+      [this, count]() {return node->count_publishers(wake_up_topic_name) == count;},
+      discovery_timeout);
+  }
+
+  rclcpp::Node::SharedPtr node;
+  rclcpp::Node::SharedPtr publishing_node;
+  rclcpp::Node::SharedPtr storm_node;
+  std::thread storm_thread;
+  std::atomic<bool> stopped{true};
+};
+
+BENCHMARK_DEFINE_F(GraphChangePerformanceTest, wait_for_graph_change)(benchmark::State & state)
+{
+  const uint64_t first_generation = get_graph_generation(*node);
+  const auto start = std::chrono::steady_clock::now();
+
+  reset_heap_counters();
+  for (auto _ : state) {
+    auto publisher = publishing_node->create_publisher<Empty>(wake_up_topic_name, 10);
+    if (!wait_for_publishers(1u)) {
+      state.SkipWithError("Publisher was not discovered");
+      break;
+    }
+
+    // Ensure the removal of the publisher is not counted toward timing
+    state.PauseTiming();
+    publisher.reset();
+    const bool removed = wait_for_publishers(0u);
+    state.ResumeTiming();
+    if (!removed) {
+      state.SkipWithError("Publisher removal was not discovered");
+      break;
+    }
+  }
+
+  const double elapsed =
+    std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  state.counters["graph_changes_per_s"] =
+    static_cast<double>(get_graph_generation(*node) - first_generation) / elapsed;
+}
+
+BENCHMARK_REGISTER_F(GraphChangePerformanceTest, wait_for_graph_change)
+->ArgName("storm")->Arg(0)->Arg(1)
+->UseRealTime();
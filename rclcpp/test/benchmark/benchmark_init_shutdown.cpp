@@ -12,6 +12,8 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <memory>
+
 #include "performance_test_fixture/performance_test_fixture.hpp"
 
 #include "rclcpp/rclcpp.hpp"
@@ -51,3 +53,42 @@ BENCHMARK_F(PerformanceTest, rclcpp_shutdown)(benchmark::State & state)
     benchmark::ClobberMemory();
   }
 }
+
+BENCHMARK_F(PerformanceTest, rclcpp_init_shutdown_with_node)(benchmark::State & state)
+{
+  // Warmup and prime caches
+  rclcpp::init(0, nullptr);
+  rclcpp::shutdown();
+
+  reset_heap_counters();
+  for (auto _ : state) {
+    rclcpp::init(0, nullptr);
+    // Most middlewares create their participant with the first node.
+    auto node = std::make_shared<rclcpp::Node>("node");
+    node.reset();
+    rclcpp::shutdown();
+    benchmark::ClobberMemory();
+  }
+}
+
+BENCHMARK_F(PerformanceTest, rclcpp_init_shutdown_with_node_reusable)(benchmark::State & state)
+{
+  auto init_options = rclcpp::InitOptions().reusable_context(true);
+  // Warmup and prime caches, the middleware is initialized once.
+  rclcpp::init(0, nullptr, init_options);
+  std::make_shared<rclcpp::Node>("node").reset();
+  rclcpp::shutdown();
+
+  reset_heap_counters();
+  for (auto _ : state) {
+    rclcpp::init(0, nullptr, init_options);
+    auto node = std::make_shared<rclcpp::Node>("node");
+    node.reset();
+    rclcpp::shutdown();
+    benchmark::ClobberMemory();
+  }
+
+  // Finalize the kept rcl context.
+  rclcpp::init(0, nullptr);
+  rclcpp::shutdown();
+}
@@ -0,0 +1,264 @@
+// Copyright 2021 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Publication of messages to subscriptions of the same process, through the
+// intra-process manager and buffers.
+//
+// The arguments of the publish benchmark are:
+// - bytes: the size of the payload of the messages.
+// - subscriptions: the number of subscriptions to the topic.
+// - shared: 0 for callbacks taking a std::unique_ptr, 1 for a const std::shared_ptr.
+// - buffer: the index of the IntraProcessBufferType of the buffers, in buffer_types.
+// The subscriptions are not executed, their buffers overwrite the oldest messages.
+//
+// The latency benchmark also has:
+// - multi_threaded: 0 for a SingleThreadedExecutor, 1 for a MultiThreadedExecutor.
+// Each iteration publishes a message and waits for all the subscriptions to receive it.
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "performance_test_fixture/performance_test_fixture.hpp"
+#include "rclcpp/rclcpp.hpp"
+#include "test_msgs/msg/unbounded_sequences.hpp"
+
+using performance_test_fixture::PerformanceTest;
+using test_msgs::msg::UnboundedSequences;
+
+constexpr char intra_process_topic_name[] = "intra_process_topic";
+// Latencies recorded at most, allocated before the measurement.
+constexpr size_t max_latency_samples = 100000;
+
+constexpr rclcpp::IntraProcessBufferType buffer_types[] = {
+  rclcpp::IntraProcessBufferType::SharedPtr,
+  rclcpp::IntraProcessBufferType::UniquePtr,
+  rclcpp::IntraProcessBufferType::LockFreeSharedPtr,
+};
+
+class IntraProcessPerformanceTest : public PerformanceTest
+{
+public:
+  void SetUp(benchmark::State & state)
+  {
+    rclcpp::init(0, nullptr);
+    message_size = static_cast<size_t>(state.range(0));
+    const auto number_of_subscriptions = static_cast<size_t>(state.range(1));
+    const bool shared = state.range(2) != 0;
+    const auto buffer_type = buffer_types[state.range(3)];
+
+    auto options = rclcpp::NodeOptions()
+      .start_parameter_services(false)
+      .start_parameter_event_publisher(false)
+      .use_intra_process_comms(true);
+    node = std::make_shared<rclcpp::Node>("intra_process_node", "ns", options);
+    publisher = node->create_publisher<UnboundedSequences>(intra_process_topic_name, 10);
+
+    rclcpp::SubscriptionOptions subscription_options;
+    subscription_options.intra_process_buffer_type = buffer_type;
+    for (size_t i = 0; i < number_of_subscriptions; ++i) {
+      rclcpp::SubscriptionBase::SharedPtr subscription;
+      if (shared) {
+        subscription = node->create_subscription<UnboundedSequences>(
+          intra_process_topic_name, 10,
+          [this](const UnboundedSequences::ConstSharedPtr) {received();},
+          subscription_options);
+      } else {
+        subscription = node->create_subscription<UnboundedSequences>(
+          intra_process_topic_name, 10,
+          [this](UnboundedSequences::UniquePtr) {received();},
+          subscription_options);
+      }
+      subscriptions.push_back(subscription);
+    }
+    latencies.reserve(max_latency_samples);
+
+    performance_test_fixture::PerformanceTest::SetUp(state);
+  }
+
+  void TearDown(benchmark::State & state)
+  {
+    performance_test_fixture::PerformanceTest::TearDown(state);
+
+    if (executor) {
+      executor->cancel();
+      spin_thread.join();
+      executor.reset();
+    }
+    subscriptions.clear();
+    publisher.reset();
+    node.reset();
+    latencies.clear();
+    rclcpp::shutdown();
+  }
+
+protected:
+  std::unique_ptr<UnboundedSequences>
+  make_message() const
+  {
+    auto message = std::make_unique<UnboundedSequences>();
+    message->uint8_values.resize(message_size);
+    return message;
+  }
+
+  void
+  start_spinning(bool multi_threaded)
+  {
+    if (multi_threaded) {
+      executor = std::make_shared<rclcpp::executors::MultiThreadedExecutor>(
+        rclcpp::ExecutorOptions(), std::max<size_t>(2u, std::thread::hardware_concurrency()));
+    } else {
+      executor = std::make_shared<rclcpp::executors::SingleThreadedExecutor>();
+    }
+    executor->add_node(node);
+    spin_thread = std::thread([this]() {executor->spin();});
+  }
+
+  void
+  received()
+  {
+    std::lock_guard<std::mutex> lock(received_mutex);
+    if (pending_receptions > 0u && --pending_receptions == 0u) {
+      if (latencies.size() < max_latency_samples) {
+        latencies.push_back(std::chrono::steady_clock::now() - publish_time);
+      }
+      received_condition.notify_one();
+    }
+  }
+
+  /// Publish one message and wait for all the subscriptions to receive it.
+  bool
+  publish_and_wait()
+  {
+    auto message = make_message();
+    {
+      std::lock_guard<std::mutex> lock(received_mutex);
+      pending_receptions = subscriptions.size();
+      publish_time = std::chrono::steady_clock::now();
+    }
+    publisher->publish(std::move(message));
+    std::unique_lock<std::mutex> lock(received_mutex);
+    return received_condition.wait_for(
+      lock, std::chrono::seconds(5), [this]() {return pending_receptions == 0u;});
+  }
+
+  /// Report the percentiles of the latencies, in microseconds.
+  void
+  report_latencies(benchmark::State & state)
+  {
+    if (latencies.empty()) {
+      return;
+    }
+    std::sort(latencies.begin(), latencies.end());
+    auto percentile = [this](double fraction) {
+        size_t index = static_cast<size_t>(fraction * static_cast<double>(latencies.size() - 1));
+        return std::chrono::duration<double, std::micro>(latencies[index]).count();
+      };
+    state.counters["latency_p50_us"] = percentile(0.5);
+    state.counters["latency_p90_us"] = percentile(0.9);
+    state.counters["latency_p99_us"] = percentile(0.99);
+    state.counters["latency_max_us"] = percentile(1.0);
+  }
+
+  size_t message_size = 0;
+  std::shared_ptr<rclcpp::Node> node;
+  rclcpp::Publisher<UnboundedSequences>::SharedPtr publisher;
+  std::vector<rclcpp::SubscriptionBase::SharedPtr> subscriptions;
+  std::shared_ptr<rclcpp::Executor> executor;
+  std::thread spin_thread;
+
+  std::mutex received_mutex;
+  std::condition_variable received_condition;
+  size_t pending_receptions = 0;
+  std::chrono::steady_clock::time_point publish_time;
+  std::vector<std::chrono::steady_clock::duration> latencies;
+};
+
+BENCHMARK_DEFINE_F(IntraProcessPerformanceTest, publish)(benchmark::State & state)
+{
+  reset_heap_counters();
+  for (auto _ : state) {
+    // The allocation of the message is left out, only its publication is measured.
+    state.PauseTiming();
+    auto message = make_message();
+    state.ResumeTiming();
+    publisher->publish(std::move(message));
+  }
+  state.SetItemsProcessed(state.iterations());
+  state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(message_size));
+}
+
+BENCHMARK_DEFINE_F(IntraProcessPerformanceTest, latency)(benchmark::State & state)
+{
+  start_spinning(state.range(4) != 0);
+  // Warm up the communication before measuring.
+  if (!publish_and_wait()) {
+    state.SkipWithError("Message was not received");
+    return;
+  }
+  latencies.clear();
+
+  reset_heap_counters();
+  for (auto _ : state) {
+    if (!publish_and_wait()) {
+      state.SkipWithError("Message was not received");
+      break;
+    }
+  }
+  state.SetItemsProcessed(state.iterations());
+  report_latencies(state);
+}
+
+static void
+PublishArguments(benchmark::internal::Benchmark * benchmark)
+{
+  benchmark->ArgNames({"bytes", "subscriptions", "shared", "buffer"});
+  for (int64_t bytes : {64, 4 * 1024, 256 * 1024, 16 * 1024 * 1024}) {
+    for (int64_t subscriptions : {1, 4, 16}) {
+      for (int64_t shared : {0, 1}) {
+        for (int64_t buffer = 0; buffer < 3; ++buffer) {
+          benchmark->Args({bytes, subscriptions, shared, buffer});
+        }
+      }
+    }
+  }
+}
+
+static void
+LatencyArguments(benchmark::internal::Benchmark * benchmark)
+{
+  benchmark->ArgNames({"bytes", "subscriptions", "shared", "buffer", "multi_threaded"});
+  for (int64_t bytes : {64, 4 * 1024, 256 * 1024, 16 * 1024 * 1024}) {
+    for (int64_t subscriptions : {1, 4}) {
+      for (int64_t shared : {0, 1}) {
+        for (int64_t buffer = 0; buffer < 3; ++buffer) {
+          for (int64_t multi_threaded : {0, 1}) {
+            benchmark->Args({bytes, subscriptions, shared, buffer, multi_threaded});
+          }
+        }
+      }
+    }
+  }
+}
+
+BENCHMARK_REGISTER_F(IntraProcessPerformanceTest, publish)
+->Apply(PublishArguments);
+
+BENCHMARK_REGISTER_F(IntraProcessPerformanceTest, latency)
+->Apply(LatencyArguments)
+->UseRealTime();
@@ -79,3 +79,31 @@ BENCHMARK_F(NodePerformanceTest, destroy_node)(benchmark::State & state)
     node.reset();
   }
 }
+
+BENCHMARK_F(NodePerformanceTest, create_lightweight_node)(benchmark::State & state)
+{
+  auto options = rclcpp::NodeOptions()
+    .lazy_node_interfaces(true)
+    .enable_rosout(false)
+    .start_parameter_services(false)
+    .start_parameter_event_publisher(false);
+
+  // Warmup and prime caches
+  auto outer_node = std::make_shared<rclcpp::Node>("node", options);
+  outer_node.reset();
+
+  reset_heap_counters();
+  for (auto _ : state) {
+    // Using pointer to separate construction and destruction in timing
+    auto node = std::make_shared<rclcpp::Node>("node", options);
+#ifndef __clang_analyzer__
+    benchmark::DoNotOptimize(node);
+#endif
+    benchmark::ClobberMemory();
+
+    // Ensure destruction of node is not counted toward timing
+    state.PauseTiming();
+    node.reset();
+    state.ResumeTiming();
+  }
+}
@@ -0,0 +1,177 @@
+// Copyright 2021 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Construction of many nodes with their publishers and subscriptions, as in
+// the startup of a large system.
+//
+// The arguments of each benchmark are:
+// - nodes: the number of nodes constructed per iteration.
+// - entities: the number of publishers, and of subscriptions, of each node.
+// Each iteration also declares a parameter per entity on each node.
+// Besides the time and the allocations measured by the fixture, the counters
+// report the time, the growth of the resident memory and the memory footprint
+// of the entities per node.
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#ifdef __linux__
+#include <unistd.h>
+#endif
+
+#include "performance_test_fixture/performance_test_fixture.hpp"
+#include "rclcpp/memory_footprint.hpp"
+#include "rclcpp/rclcpp.hpp"
+#include "test_msgs/msg/empty.hpp"
+
+using performance_test_fixture::PerformanceTest;
+using test_msgs::msg::Empty;
+
+namespace
+{
+
+/// Return the resident memory of the process in kilobytes, 0 where it is not known.
+double
+get_resident_memory_kb()
+{
+#ifdef __linux__
+  std::ifstream statm("/proc/self/statm");
+  size_t size = 0;
+  size_t resident = 0;
+  if (statm >> size >> resident) {
+    return static_cast<double>(resident) * static_cast<double>(sysconf(_SC_PAGESIZE)) / 1024.0;
+  }
+#endif
+  return 0.0;
+}
+
+}  // namespace
+
+class NodeScalePerformanceTest : public PerformanceTest
+{
+public:
+  void SetUp(benchmark::State & state)
+  {
+    rclcpp::init(0, nullptr);
+    number_of_nodes = static_cast<size_t>(state.range(0));
+    number_of_entities = static_cast<size_t>(state.range(1));
+    nodes.reserve(number_of_nodes);
+    publishers.reserve(number_of_nodes * number_of_entities);
+    subscriptions.reserve(number_of_nodes * number_of_entities);
+    performance_test_fixture::PerformanceTest::SetUp(state);
+  }
+
+  void TearDown(benchmark::State & state)
+  {
+    performance_test_fixture::PerformanceTest::TearDown(state);
+    destroy_nodes();
+    rclcpp::shutdown();
+  }
+
+protected:
+  void
+  construct_nodes()
+  {
+    auto options = rclcpp::NodeOptions()
+      .start_parameter_services(false)
+      .start_parameter_event_publisher(false);
+    for (size_t i = 0; i < number_of_nodes; ++i) {
+      auto node = std::make_shared<rclcpp::Node>("node_" + std::to_string(i), "ns", options);
+      for (size_t j = 0; j < number_of_entities; ++j) {
+        const std::string topic_name = "topic_" + std::to_string(j);
+        publishers.push_back(node->create_publisher<Empty>(topic_name, 10));
+        subscriptions.push_back(
+          node->create_subscription<Empty>(topic_name, 10, [](Empty::ConstSharedPtr) {}));
+        node->declare_parameter("parameter_" + std::to_string(j), static_cast<int64_t>(j));
+      }
+      nodes.push_back(node);
+    }
+  }
+
+  void
+  destroy_nodes()
+  {
+    subscriptions.clear();
+    publishers.clear();
+    nodes.clear();
+  }
+
+  size_t number_of_nodes = 0;
+  size_t number_of_entities = 0;
+  std::vector<rclcpp::Node::SharedPtr> nodes;
+  std::vector<rclcpp::PublisherBase::SharedPtr> publishers;
+  std::vector<rclcpp::SubscriptionBase::SharedPtr> subscriptions;
+};
+
+BENCHMARK_DEFINE_F(NodeScalePerformanceTest, construct_nodes)(benchmark::State & state)
+{
+  // Warm up the middleware and prime the caches
+  construct_nodes();
+  destroy_nodes();
+
+  double max_resident_growth_kb = 0.0;
+  std::chrono::steady_clock::duration total_time{0};
+  reset_heap_counters();
+  for (auto _ : state) {
+    const double resident_before_kb = get_resident_memory_kb();
+    const auto start = std::chrono::steady_clock::now();
+    construct_nodes();
+    total_time += std::chrono::steady_clock::now() - start;
+    max_resident_growth_kb =
+      std::max(max_resident_growth_kb, get_resident_memory_kb() - resident_before_kb);
+
+    // Ensure destruction of the nodes is not counted toward timing
+    state.PauseTiming();
+    destroy_nodes();
+    state.ResumeTiming();
+  }
+
+  const double nodes_constructed =
+    static_cast<double>(state.iterations()) * static_cast<double>(number_of_nodes);
+  state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(number_of_nodes));
+  state.counters["time_per_node_us"] =
+    std::chrono::duration<double, std::micro>(total_time).count() / nodes_constructed;
+  state.counters["resident_kb_per_node"] =
+    max_resident_growth_kb / static_cast<double>(number_of_nodes);
+
+  // The footprint of the entities themselves, measured outside of the iterations.
+  construct_nodes();
+  size_t footprint = 0;
+  for (const auto & node : nodes) {
+    footprint += rclcpp::get_memory_footprint(*node).get_total_size();
+  }
+  destroy_nodes();
+  state.counters["footprint_kb_per_node"] =
+    static_cast<double>(footprint) / 1024.0 / static_cast<double>(number_of_nodes);
+}
+
+static void
+NodeScaleArguments(benchmark::internal::Benchmark * benchmark)
+{
+  benchmark->ArgNames({"nodes", "entities"});
+  for (int64_t nodes : {10, 100, 1000}) {
+    for (int64_t entities : {0, 10}) {
+      benchmark->Args({nodes, entities});
+    }
+  }
+}
+
+BENCHMARK_REGISTER_F(NodeScalePerformanceTest, construct_nodes)
+->Apply(NodeScaleArguments)
+->Unit(benchmark::kMillisecond)
+->UseRealTime();
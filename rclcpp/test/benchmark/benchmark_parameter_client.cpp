@@ -12,9 +12,11 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <chrono>
 #include <memory>
 #include <vector>
 #include <string>
+#include <thread>
 
 #include "benchmark/benchmark.h"
 
@@ -325,3 +327,110 @@ BENCHMARK_F(ParameterClientTest, list_parameters_miss)(benchmark::State & state)
     }
   }
 }
+
+class MultiNodeParameterClientTest : public benchmark::Fixture
+{
+public:
+  MultiNodeParameterClientTest()
+  : param_name("my_param")
+  {
+  }
+
+#ifdef __GNUC__
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Woverloaded-virtual"
+#endif
+  void SetUp(benchmark::State & state)
+  {
+    const auto number_of_nodes = static_cast<size_t>(state.range(0));
+
+    remote_context = std::make_shared<rclcpp::Context>();
+    remote_context->init(0, nullptr, rclcpp::InitOptions().auto_initialize_logging(false));
+    rclcpp::ExecutorOptions exec_options;
+    exec_options.context = remote_context;
+    remote_executor = std::make_shared<rclcpp::executors::SingleThreadedExecutor>(exec_options);
+
+    std::vector<std::string> remote_node_names;
+    for (size_t i = 0; i < number_of_nodes; ++i) {
+      auto remote_node = std::make_shared<rclcpp::Node>(
+        "my_remote_node_" + std::to_string(i), rclcpp::NodeOptions().context(remote_context));
+      remote_node->declare_parameter(param_name, 0);
+      remote_executor->add_node(remote_node);
+      remote_node_names.push_back(remote_node->get_fully_qualified_name());
+      remote_nodes.push_back(remote_node);
+    }
+    remote_thread = std::thread(&rclcpp::executors::SingleThreadedExecutor::spin, remote_executor);
+
+    rclcpp::init(0, nullptr);
+    node = std::make_shared<rclcpp::Node>("my_node");
+    executor = std::make_shared<rclcpp::executors::SingleThreadedExecutor>();
+    executor->add_node(node);
+    params_client = std::make_shared<rclcpp::MultiNodeParametersClient>(node, remote_node_names);
+    if (!params_client->wait_for_service(std::chrono::seconds(10))) {
+      state.SkipWithError("Client failed to become ready");
+    }
+  }
+
+  void TearDown(benchmark::State &)
+  {
+    params_client.reset();
+    executor.reset();
+    node.reset();
+    rclcpp::shutdown();
+
+    remote_executor->cancel();
+    remote_context->shutdown("Test is complete");
+    remote_thread.join();
+    remote_nodes.clear();
+    remote_executor.reset();
+    remote_context.reset();
+  }
+#ifdef __GNUC__
+#pragma GCC diagnostic pop
+#endif
+
+  const std::string param_name;
+
+protected:
+  rclcpp::Context::SharedPtr remote_context;
+  rclcpp::executors::SingleThreadedExecutor::SharedPtr remote_executor;
+  std::vector<rclcpp::Node::SharedPtr> remote_nodes;
+  std::thread remote_thread;
+
+  rclcpp::Node::SharedPtr node;
+  rclcpp::executors::SingleThreadedExecutor::SharedPtr executor;
+  rclcpp::MultiNodeParametersClient::SharedPtr params_client;
+};
+
+BENCHMARK_DEFINE_F(MultiNodeParameterClientTest, fan_out_get_parameters)(benchmark::State & state)
+{
+  for (auto _ : state) {
+    auto future = params_client->get_parameters({param_name});
+    if (rclcpp::FutureReturnCode::SUCCESS !=
+      executor->spin_until_future_complete(future, std::chrono::seconds(10)))
+    {
+      state.SkipWithError("Parameters were not received from every node");
+      break;
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK_REGISTER_F(MultiNodeParameterClientTest, fan_out_get_parameters)
+->ArgName("nodes")->Arg(1)->Arg(10)->Arg(100)->UseRealTime();
+
+BENCHMARK_DEFINE_F(MultiNodeParameterClientTest, fan_out_set_parameters)(benchmark::State & state)
+{
+  int64_t value = 0;
+  for (auto _ : state) {
+    auto future = params_client->set_parameters({rclcpp::Parameter(param_name, ++value)});
+    if (rclcpp::FutureReturnCode::SUCCESS !=
+      executor->spin_until_future_complete(future, std::chrono::seconds(10)))
+    {
+      state.SkipWithError("Parameters were not set on every node");
+      break;
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK_REGISTER_F(MultiNodeParameterClientTest, fan_out_set_parameters)
+->ArgName("nodes")->Arg(1)->Arg(10)->Arg(100)->UseRealTime();
@@ -0,0 +1,281 @@
+// Copyright 2021 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Serialization of messages, generic publications and subscriptions, and the
+// lookup of type supports by name.
+//
+// The argument of the benchmarks of sequences and of the generic publisher is
+// the number of bytes of the payload of the messages.
+
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "performance_test_fixture/performance_test_fixture.hpp"
+#include "rclcpp/rclcpp.hpp"
+#include "rclcpp/serialization.hpp"
+#include "rclcpp/typesupport_helpers.hpp"
+#include "test_msgs/msg/basic_types.hpp"
+#include "test_msgs/msg/strings.hpp"
+#include "test_msgs/msg/unbounded_sequences.hpp"
+
+using performance_test_fixture::PerformanceTest;
+using test_msgs::msg::BasicTypes;
+using test_msgs::msg::Strings;
+using test_msgs::msg::UnboundedSequences;
+
+constexpr char generic_topic_name[] = "generic_topic";
+constexpr char unbounded_sequences_type[] = "test_msgs/msg/UnboundedSequences";
+constexpr char typesupport_identifier[] = "rosidl_typesupport_cpp";
+
+class SerializationPerformanceTest : public PerformanceTest
+{
+public:
+  void SetUp(benchmark::State & state)
+  {
+    rclcpp::init(0, nullptr);
+    performance_test_fixture::PerformanceTest::SetUp(state);
+  }
+
+  void TearDown(benchmark::State & state)
+  {
+    performance_test_fixture::PerformanceTest::TearDown(state);
+    rclcpp::shutdown();
+  }
+
+protected:
+  static UnboundedSequences
+  make_sequences(benchmark::State & state)
+  {
+    UnboundedSequences message;
+    message.uint8_values.resize(static_cast<size_t>(state.range(0)));
+    return message;
+  }
+
+  /// Serialize the message into the same serialized message in each iteration.
+  template<typename MessageT>
+  void
+  serialize(benchmark::State & state, const MessageT & message)
+  {
+    rclcpp::Serialization<MessageT> serialization;
+    rclcpp::SerializedMessage serialized_message;
+    // Grow the buffer before measuring, as for the messages of a topic.
+    serialization.serialize_message(&message, &serialized_message);
+
+    reset_heap_counters();
+    for (auto _ : state) {
+      serialization.serialize_message(&message, &serialized_message);
+      benchmark::DoNotOptimize(serialized_message);
+      benchmark::ClobberMemory();
+    }
+    state.SetBytesProcessed(
+      state.iterations() * static_cast<int64_t>(serialized_message.size()));
+  }
+
+  /// Deserialize the serialization of the message into the same message in each iteration.
+  template<typename MessageT>
+  void
+  deserialize(benchmark::State & state, const MessageT & message)
+  {
+    rclcpp::Serialization<MessageT> serialization;
+    rclcpp::SerializedMessage serialized_message;
+    serialization.serialize_message(&message, &serialized_message);
+    MessageT deserialized_message;
+    serialization.deserialize_message(&serialized_message, &deserialized_message);
+
+    reset_heap_counters();
+    for (auto _ : state) {
+      serialization.deserialize_message(&serialized_message, &deserialized_message);
+      benchmark::DoNotOptimize(deserialized_message);
+      benchmark::ClobberMemory();
+    }
+    state.SetBytesProcessed(
+      state.iterations() * static_cast<int64_t>(serialized_message.size()));
+  }
+};
+
+BENCHMARK_F(SerializationPerformanceTest, serialize_basic_types)(benchmark::State & state)
+{
+  serialize(state, BasicTypes());
+}
+
+BENCHMARK_F(SerializationPerformanceTest, deserialize_basic_types)(benchmark::State & state)
+{
+  deserialize(state, BasicTypes());
+}
+
+BENCHMARK_F(SerializationPerformanceTest, serialize_strings)(benchmark::State & state)
+{
+  Strings message;
+  message.string_value = std::string(256, 'a');
+  serialize(state, message);
+}
+
+BENCHMARK_F(SerializationPerformanceTest, deserialize_strings)(benchmark::State & state)
+{
+  Strings message;
+  message.string_value = std::string(256, 'a');
+  deserialize(state, message);
+}
+
+BENCHMARK_DEFINE_F(SerializationPerformanceTest, serialize_sequences)(benchmark::State & state)
+{
+  serialize(state, make_sequences(state));
+}
+
+BENCHMARK_DEFINE_F(SerializationPerformanceTest, deserialize_sequences)(benchmark::State & state)
+{
+  deserialize(state, make_sequences(state));
+}
+
+BENCHMARK_REGISTER_F(SerializationPerformanceTest, serialize_sequences)
+->ArgName("bytes")->RangeMultiplier(64)->Range(64, 16 * 1024 * 1024);
+BENCHMARK_REGISTER_F(SerializationPerformanceTest, deserialize_sequences)
+->ArgName("bytes")->RangeMultiplier(64)->Range(64, 16 * 1024 * 1024);
+
+BENCHMARK_F(SerializationPerformanceTest, get_typesupport_library)(benchmark::State & state)
+{
+  reset_heap_counters();
+  for (auto _ : state) {
+    auto library = rclcpp::get_typesupport_library(
+      unbounded_sequences_type, typesupport_identifier);
+    benchmark::DoNotOptimize(library);
+    benchmark::ClobberMemory();
+  }
+}
+
+BENCHMARK_F(SerializationPerformanceTest, get_typesupport_handle)(benchmark::State & state)
+{
+  auto library = rclcpp::get_typesupport_library(
+    unbounded_sequences_type, typesupport_identifier);
+
+  reset_heap_counters();
+  for (auto _ : state) {
+    const rosidl_message_type_support_t * type_support = rclcpp::get_typesupport_handle(
+      unbounded_sequences_type, typesupport_identifier, *library);
+    benchmark::DoNotOptimize(type_support);
+    benchmark::ClobberMemory();
+  }
+}
+
+class GenericPubSubPerformanceTest : public PerformanceTest
+{
+public:
+  void SetUp(benchmark::State & state)
+  {
+    rclcpp::init(0, nullptr);
+    auto options = rclcpp::NodeOptions()
+      .start_parameter_services(false)
+      .start_parameter_event_publisher(false);
+    node = std::make_shared<rclcpp::Node>("generic_node", "ns", options);
+    publisher = node->create_generic_publisher(
+      generic_topic_name, unbounded_sequences_type, rclcpp::QoS(10));
+    subscription = node->create_generic_subscription(
+      generic_topic_name, unbounded_sequences_type, rclcpp::QoS(10),
+      [this](std::shared_ptr<rclcpp::SerializedMessage>) {
+        std::lock_guard<std::mutex> lock(received_mutex);
+        ++received_messages;
+        received_condition.notify_one();
+      });
+
+    // The message is serialized once, the generic publisher only sends its serialization.
+    UnboundedSequences message;
+    message.uint8_values.resize(static_cast<size_t>(state.range(0)));
+    rclcpp::Serialization<UnboundedSequences>().serialize_message(&message, &serialized_message);
+
+    executor = std::make_shared<rclcpp::executors::SingleThreadedExecutor>();
+    executor->add_node(node);
+    spin_thread = std::thread([this]() {executor->spin();});
+
+    performance_test_fixture::PerformanceTest::SetUp(state);
+  }
+
+  void TearDown(benchmark::State & state)
+  {
+    performance_test_fixture::PerformanceTest::TearDown(state);
+
+    executor->cancel();
+    spin_thread.join();
+    executor.reset();
+    subscription.reset();
+    publisher.reset();
+    node.reset();
+    rclcpp::shutdown();
+  }
+
+protected:
+  /// Publish the message and wait for the subscription to receive it.
+  bool
+  publish_and_wait()
+  {
+    size_t expected_messages = 0;
+    {
+      std::lock_guard<std::mutex> lock(received_mutex);
+      expected_messages = received_messages + 1;
+    }
+    publisher->publish(serialized_message);
+    std::unique_lock<std::mutex> lock(received_mutex);
+    return received_condition.wait_for(
+      lock, std::chrono::seconds(5),
+      [this, expected_messages]() {return received_messages >= expected_messages;});
+  }
+
+  std::shared_ptr<rclcpp::Node> node;
+  std::shared_ptr<rclcpp::GenericPublisher> publisher;
+  std::shared_ptr<rclcpp::GenericSubscription> subscription;
+  std::shared_ptr<rclcpp::Executor> executor;
+  std::thread spin_thread;
+  rclcpp::SerializedMessage serialized_message;
+
+  std::mutex received_mutex;
+  std::condition_variable received_condition;
+  size_t received_messages = 0;
+};
+
+BENCHMARK_DEFINE_F(GenericPubSubPerformanceTest, publish)(benchmark::State & state)
+{
+  reset_heap_counters();
+  for (auto _ : state) {
+    publisher->publish(serialized_message);
+  }
+  state.SetItemsProcessed(state.iterations());
+  state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(serialized_message.size()));
+}
+
+BENCHMARK_DEFINE_F(GenericPubSubPerformanceTest, round_trip)(benchmark::State & state)
+{
+  // Wait for the subscription to be matched before measuring.
+  if (!publish_and_wait()) {
+    state.SkipWithError("Message was not received");
+    return;
+  }
+
+  reset_heap_counters();
+  for (auto _ : state) {
+    if (!publish_and_wait()) {
+      state.SkipWithError("Message was not received");
+      break;
+    }
+  }
+  state.SetItemsProcessed(state.iterations());
+  state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(serialized_message.size()));
+}
+
+BENCHMARK_REGISTER_F(GenericPubSubPerformanceTest, publish)
+->ArgName("bytes")->RangeMultiplier(64)->Range(64, 4 * 1024 * 1024);
+BENCHMARK_REGISTER_F(GenericPubSubPerformanceTest, round_trip)
+->ArgName("bytes")->RangeMultiplier(64)->Range(64, 4 * 1024 * 1024)->UseRealTime();
@@ -0,0 +1,208 @@
+// Copyright 2021 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Round trip of requests from concurrent clients to a service, through the
+// executors and the intra-process or middleware communication.
+//
+// The arguments of each benchmark are:
+// - clients: the number of clients, each sending one request per iteration.
+// - multi_threaded: 0 for a SingleThreadedExecutor, 1 for a MultiThreadedExecutor.
+// - intra_process: 0 to go through the middleware, 1 for intra-process communication.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "performance_test_fixture/performance_test_fixture.hpp"
+#include "rclcpp/rclcpp.hpp"
+#include "test_msgs/srv/empty.hpp"
+
+using performance_test_fixture::PerformanceTest;
+using test_msgs::srv::Empty;
+
+constexpr char round_trip_service_name[] = "round_trip_service";
+// Latencies recorded at most, allocated before the measurement.
+constexpr size_t max_latency_samples = 100000;
+
+class ServiceRoundTripPerformanceTest : public PerformanceTest
+{
+public:
+  void SetUp(benchmark::State & state)
+  {
+    rclcpp::init(0, nullptr);
+    const auto number_of_clients = static_cast<size_t>(state.range(0));
+    const bool multi_threaded = state.range(1) != 0;
+    const bool intra_process = state.range(2) != 0;
+
+    auto options = rclcpp::NodeOptions()
+      .start_parameter_services(false)
+      .start_parameter_event_publisher(false)
+      .use_intra_process_comms(intra_process);
+    server_node = std::make_shared<rclcpp::Node>("server_node", "ns", options);
+    client_node = std::make_shared<rclcpp::Node>("client_node", "ns", options);
+
+    // With the multi-threaded executor, requests and responses may be handled concurrently.
+    auto group_type = multi_threaded ?
+      rclcpp::CallbackGroupType::Reentrant : rclcpp::CallbackGroupType::MutuallyExclusive;
+    auto server_group = server_node->create_callback_group(group_type);
+    auto client_group = client_node->create_callback_group(group_type);
+
+    service = server_node->create_service<Empty>(
+      round_trip_service_name,
+      [](const Empty::Request::SharedPtr, Empty::Response::SharedPtr) {},
+      rmw_qos_profile_services_default, server_group);
+    for (size_t i = 0; i < number_of_clients; ++i) {
+      auto client = client_node->create_client<Empty>(
+        round_trip_service_name, rmw_qos_profile_services_default, client_group);
+      if (!client->wait_for_service(std::chrono::seconds(5))) {
+        state.SkipWithError("Service was not available");
+      }
+      clients.push_back(client);
+    }
+    send_times.resize(number_of_clients);
+    latencies.reserve(max_latency_samples);
+    request = std::make_shared<Empty::Request>();
+
+    if (multi_threaded) {
+      executor = std::make_shared<rclcpp::executors::MultiThreadedExecutor>(
+        rclcpp::ExecutorOptions(), std::max<size_t>(2u, std::thread::hardware_concurrency()));
+    } else {
+      executor = std::make_shared<rclcpp::executors::SingleThreadedExecutor>();
+    }
+    executor->add_node(server_node);
+    executor->add_node(client_node);
+    spin_thread = std::thread([this]() {executor->spin();});
+
+    performance_test_fixture::PerformanceTest::SetUp(state);
+  }
+
+  void TearDown(benchmark::State & state)
+  {
+    performance_test_fixture::PerformanceTest::TearDown(state);
+
+    executor->cancel();
+    spin_thread.join();
+    executor.reset();
+    clients.clear();
+    service.reset();
+    client_node.reset();
+    server_node.reset();
+    latencies.clear();
+    rclcpp::shutdown();
+  }
+
+protected:
+  /// Send one request from each client and wait for all the responses.
+  bool
+  round_trip()
+  {
+    {
+      std::lock_guard<std::mutex> lock(responses_mutex);
+      pending_responses = clients.size();
+    }
+    for (size_t i = 0; i < clients.size(); ++i) {
+      send_times[i] = std::chrono::steady_clock::now();
+      clients[i]->async_send_request(
+        request,
+        [this, i](Empty::Response::SharedPtr) {
+          auto latency = std::chrono::steady_clock::now() - send_times[i];
+          std::lock_guard<std::mutex> lock(responses_mutex);
+          if (latencies.size() < max_latency_samples) {
+            latencies.push_back(latency);
+          }
+          if (--pending_responses == 0u) {
+            responses_condition.notify_one();
+          }
+        });
+    }
+    std::unique_lock<std::mutex> lock(responses_mutex);
+    return responses_condition.wait_for(
+      lock, std::chrono::seconds(5), [this]() {return pending_responses == 0u;});
+  }
+
+  /// Report the percentiles of the latencies, in microseconds.
+  void
+  report_latencies(benchmark::State & state)
+  {
+    if (latencies.empty()) {
+      return;
+    }
+    std::sort(latencies.begin(), latencies.end());
+    auto percentile = [this](double fraction) {
+        size_t index = static_cast<size_t>(fraction * static_cast<double>(latencies.size() - 1));
+        return std::chrono::duration<double, std::micro>(latencies[index]).count();
+      };
+    state.counters["latency_p50_us"] = percentile(0.5);
+    state.counters["latency_p90_us"] = percentile(0.9);
+    state.counters["latency_p99_us"] = percentile(0.99);
+    state.counters["latency_max_us"] = percentile(1.0);
+  }
+
+  std::shared_ptr<rclcpp::Node> server_node;
+  std::shared_ptr<rclcpp::Node> client_node;
+  rclcpp::Service<Empty>::SharedPtr service;
+  std::vector<rclcpp::Client<Empty>::SharedPtr> clients;
+  std::shared_ptr<rclcpp::Executor> executor;
+  std::thread spin_thread;
+  Empty::Request::SharedPtr request;
+
+  std::vector<std::chrono::steady_clock::time_point> send_times;
+  std::mutex responses_mutex;
+  std::condition_variable responses_condition;
+  size_t pending_responses = 0;
+  std::vector<std::chrono::steady_clock::duration> latencies;
+};
+
+BENCHMARK_DEFINE_F(ServiceRoundTripPerformanceTest, round_trip)(benchmark::State & state)
+{
+  // Warm up the communication before measuring.
+  if (!round_trip()) {
+    state.SkipWithError("Response was not received");
+    return;
+  }
+  latencies.clear();
+
+  reset_heap_counters();
+  for (auto _ : state) {
+    if (!round_trip()) {
+      state.SkipWithError("Response was not received");
+      break;
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(clients.size()));
+  report_latencies(state);
+}
+
+static void
+RoundTripArguments(benchmark::internal::Benchmark * benchmark)
+{
+  benchmark->ArgNames({"clients", "multi_threaded", "intra_process"});
+  for (int64_t clients : {1, 4, 16}) {
+    for (int64_t multi_threaded : {0, 1}) {
+      for (int64_t intra_process : {0, 1}) {
+        benchmark->Args({clients, multi_threaded, intra_process});
+      }
+    }
+  }
+}
+
+BENCHMARK_REGISTER_F(ServiceRoundTripPerformanceTest, round_trip)
+->Apply(RoundTripArguments)
+->UseRealTime();
@@ -0,0 +1,136 @@
+// Copyright 2021 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "rclcpp/allocator/arena.hpp"
+
+using rclcpp::allocator::Arena;
+using rclcpp::allocator::ArenaAllocator;
+
+TEST(TestArena, allocate) {
+  Arena arena(256);
+  EXPECT_EQ(256u, arena.get_capacity());
+  EXPECT_EQ(0u, arena.get_used_size());
+
+  void * first = arena.allocate(10, 1);
+  void * second = arena.allocate(8, 8);
+  EXPECT_TRUE(arena.contains(first));
+  EXPECT_TRUE(arena.contains(second));
+  EXPECT_EQ(0u, reinterpret_cast<uintptr_t>(second) % 8);
+  // Contiguous, but for the alignment.
+  EXPECT_EQ(static_cast<unsigned char *>(first) + 16, static_cast<unsigned char *>(second));
+  EXPECT_EQ(24u, arena.get_used_size());
+
+  // Deallocated memory of the arena is not reused.
+  arena.deallocate(first, 1);
+  EXPECT_NE(first, arena.allocate(10, 1));
+  EXPECT_EQ(0u, arena.get_fallback_count());
+}
+
+TEST(TestArena, exhausted) {
+  Arena arena(64);
+  void * pointer = arena.allocate(48);
+  EXPECT_TRUE(arena.contains(pointer));
+
+  void * fallback_pointer = arena.allocate(32);
+  ASSERT_NE(nullptr, fallback_pointer);
+  EXPECT_FALSE(arena.contains(fallback_pointer));
+  EXPECT_EQ(1u, arena.get_fallback_count());
+  arena.deallocate(fallback_pointer);
+
+  // What remains of the arena is still used.
+  EXPECT_TRUE(arena.contains(arena.allocate(16)));
+  EXPECT_EQ(64u, arena.get_used_size());
+}
+
+TEST(TestArena, rcl_allocator) {
+  Arena arena(1024);
+  rcl_allocator_t allocator = arena.get_rcl_allocator();
+  EXPECT_EQ(&arena, allocator.state);
+
+  auto text = static_cast<char *>(allocator.allocate(6, allocator.state));
+  ASSERT_NE(nullptr, text);
+  EXPECT_TRUE(arena.contains(text));
+  std::memcpy(text, "hello", 6);
+
+  // The content is kept when reallocated, and the memory taken from the arena.
+  text = static_cast<char *>(allocator.reallocate(text, 2048, allocator.state));
+  ASSERT_NE(nullptr, text);
+  EXPECT_FALSE(arena.contains(text));
+  EXPECT_STREQ("hello", text);
+  allocator.deallocate(text, allocator.state);
+
+  auto values = static_cast<int *>(allocator.zero_allocate(4, sizeof(int), allocator.state));
+  ASSERT_NE(nullptr, values);
+  for (size_t i = 0; i < 4; ++i) {
+    EXPECT_EQ(0, values[i]);
+  }
+  allocator.deallocate(values, allocator.state);
+  allocator.deallocate(nullptr, allocator.state);
+}
+
+TEST(TestArenaAllocator, containers) {
+  auto arena = std::make_shared<Arena>(4096);
+  ArenaAllocator<int> allocator(arena);
+  std::vector<int, ArenaAllocator<int>> values(allocator);
+  values.reserve(16);
+  values.assign(16, 42);
+  EXPECT_TRUE(arena->contains(values.data()));
+
+  // Rebound copies share the arena.
+  ArenaAllocator<double> other_allocator(allocator);
+  EXPECT_TRUE(other_allocator == allocator);
+  EXPECT_FALSE(other_allocator != allocator);
+  EXPECT_FALSE(ArenaAllocator<int>() == allocator);
+
+  auto shared_value = std::allocate_shared<double>(other_allocator, 1.0);
+  EXPECT_TRUE(arena->contains(shared_value.get()));
+
+  // Without an arena.
+  std::vector<int, ArenaAllocator<int>> other_values(16, 42);
+  EXPECT_FALSE(arena->contains(other_values.data()));
+}
+
+TEST(TestArena, concurrent_allocations) {
+  Arena arena(4 * 1000 * 16);
+  std::vector<std::thread> threads;
+  std::vector<std::vector<void *>> pointers(4);
+  for (size_t i = 0; i < 4; ++i) {
+    threads.emplace_back(
+      [&arena, &pointers, i]() {
+        for (size_t j = 0; j < 1000; ++j) {
+          pointers[i].push_back(arena.allocate(16));
+        }
+      });
+  }
+  for (auto & thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(0u, arena.get_fallback_count());
+  EXPECT_EQ(arena.get_capacity(), arena.get_used_size());
+  std::vector<void *> all_pointers;
+  for (const auto & thread_pointers : pointers) {
+    all_pointers.insert(all_pointers.end(), thread_pointers.begin(), thread_pointers.end());
+  }
+  std::sort(all_pointers.begin(), all_pointers.end());
+  EXPECT_EQ(all_pointers.end(), std::adjacent_find(all_pointers.begin(), all_pointers.end()));
+}
@@ -0,0 +1,127 @@
+// Copyright 2021 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "rclcpp/allocator/allocator_deleter.hpp"
+#include "rclcpp/allocator/message_pool_allocator.hpp"
+
+using rclcpp::allocator::MessagePoolAllocator;
+
+struct Message
+{
+  uint64_t data[4];
+};
+
+TEST(TestMessagePoolAllocator, allocate_from_pool) {
+  auto allocator = MessagePoolAllocator<Message>::for_message<Message>(2);
+  const auto & pool = allocator.get_pool();
+  EXPECT_EQ(2u, pool->get_block_count());
+  EXPECT_LE(sizeof(Message), pool->get_block_size());
+  EXPECT_EQ(2u, pool->get_number_of_free_blocks());
+
+  Message * first = allocator.allocate(1);
+  Message * second = allocator.allocate(1);
+  EXPECT_TRUE(pool->contains(first));
+  EXPECT_TRUE(pool->contains(second));
+  EXPECT_NE(first, second);
+  EXPECT_EQ(0u, pool->get_number_of_free_blocks());
+
+  // The pool is exhausted.
+  Message * third = allocator.allocate(1);
+  EXPECT_FALSE(pool->contains(third));
+  allocator.deallocate(third, 1);
+
+  // Blocks are recycled.
+  allocator.deallocate(first, 1);
+  EXPECT_EQ(1u, pool->get_number_of_free_blocks());
+  EXPECT_EQ(first, allocator.allocate(1));
+
+  allocator.deallocate(first, 1);
+  allocator.deallocate(second, 1);
+  EXPECT_EQ(2u, pool->get_number_of_free_blocks());
+}
+
+TEST(TestMessagePoolAllocator, fall_back) {
+  // Without a pool.
+  MessagePoolAllocator<Message> default_allocator;
+  EXPECT_EQ(0u, default_allocator.get_pool()->get_block_count());
+  Message * message = default_allocator.allocate(1);
+  ASSERT_TRUE(nullptr != message);
+  EXPECT_FALSE(default_allocator.get_pool()->contains(message));
+  default_allocator.deallocate(message, 1);
+
+  // Larger than the blocks.
+  MessagePoolAllocator<Message> allocator(sizeof(Message), 4);
+  Message * messages = allocator.allocate(2);
+  EXPECT_FALSE(allocator.get_pool()->contains(messages));
+  allocator.deallocate(messages, 2);
+
+  // Bytes, as allocated by rcl.
+  MessagePoolAllocator<char> byte_allocator(allocator);
+  char * bytes = byte_allocator.allocate(1);
+  EXPECT_FALSE(allocator.get_pool()->contains(bytes));
+  byte_allocator.deallocate(bytes, 1);
+  EXPECT_EQ(4u, allocator.get_pool()->get_number_of_free_blocks());
+}
+
+TEST(TestMessagePoolAllocator, rebind_shares_pool) {
+  MessagePoolAllocator<void> allocator(sizeof(Message), 4);
+  using MessageAllocator = std::allocator_traits<MessagePoolAllocator<void>>::rebind_alloc<Message>;
+  MessageAllocator message_allocator(allocator);
+  EXPECT_TRUE(message_allocator == allocator);
+  EXPECT_FALSE(message_allocator != allocator);
+  EXPECT_FALSE(message_allocator == MessagePoolAllocator<void>(sizeof(Message), 4));
+
+  // As the copies of the messages made by the intra-process manager.
+  using MessageDeleter = rclcpp::allocator::Deleter<MessageAllocator, Message>;
+  MessageDeleter deleter;
+  rclcpp::allocator::set_allocator_for_deleter(&deleter, &message_allocator);
+  using Traits = std::allocator_traits<MessageAllocator>;
+  Message * pointer = Traits::allocate(message_allocator, 1);
+  Traits::construct(message_allocator, pointer);
+  {
+    std::unique_ptr<Message, MessageDeleter> message(pointer, deleter);
+    EXPECT_TRUE(allocator.get_pool()->contains(message.get()));
+    EXPECT_EQ(3u, allocator.get_pool()->get_number_of_free_blocks());
+  }
+  EXPECT_EQ(4u, allocator.get_pool()->get_number_of_free_blocks());
+}
+
+TEST(TestMessagePoolAllocator, concurrent_use) {
+  MessagePoolAllocator<Message> allocator(sizeof(Message), 8);
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < 4; ++i) {
+    threads.emplace_back(
+      [allocator]() mutable {
+        for (size_t j = 0; j < 1000; ++j) {
+          Message * first = allocator.allocate(1);
+          Message * second = allocator.allocate(1);
+          first->data[0] = j;
+          second->data[0] = j;
+          allocator.deallocate(second, 1);
+          allocator.deallocate(first, 1);
+        }
+      });
+  }
+  for (auto & thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(8u, allocator.get_pool()->get_number_of_free_blocks());
+}
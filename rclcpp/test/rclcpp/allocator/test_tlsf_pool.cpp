@@ -0,0 +1,227 @@
+// Copyright 2021 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <list>
+#include <map>
+#include <memory>
+#include <new>
+#include <random>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "rclcpp/allocator/tlsf_allocator.hpp"
+#include "rclcpp/allocator/tlsf_pool.hpp"
+#include "rclcpp/memory_strategies.hpp"
+#include "rclcpp/rclcpp.hpp"
+
+using namespace std::chrono_literals;
+
+using rclcpp::allocator::TLSFAllocator;
+using rclcpp::allocator::TLSFPool;
+
+TEST(TestTLSFPool, construction) {
+  EXPECT_THROW(TLSFPool(16), std::invalid_argument);
+  TLSFPool pool(1024);
+  EXPECT_EQ(1024u, pool.get_pool_size());
+  EXPECT_EQ(0u, pool.get_used_size());
+}
+
+TEST(TestTLSFPool, allocate_deallocate) {
+  TLSFPool pool(64 * 1024);
+  void * first = pool.allocate(100);
+  void * second = pool.allocate(1);
+  ASSERT_NE(nullptr, first);
+  ASSERT_NE(nullptr, second);
+  EXPECT_TRUE(pool.contains(first));
+  EXPECT_TRUE(pool.contains(second));
+  EXPECT_EQ(0u, reinterpret_cast<uintptr_t>(first) % alignof(std::max_align_t));
+  EXPECT_EQ(0u, reinterpret_cast<uintptr_t>(second) % alignof(std::max_align_t));
+  EXPECT_LT(101u, pool.get_used_size());
+  std::memset(first, 1, 100);
+  std::memset(second, 2, 1);
+
+  // Freed blocks are reused.
+  pool.deallocate(first);
+  EXPECT_EQ(first, pool.allocate(100));
+  pool.deallocate(first);
+  pool.deallocate(second);
+  EXPECT_EQ(0u, pool.get_used_size());
+
+  // Null and foreign memory are ignored.
+  int value = 0;
+  pool.deallocate(nullptr);
+  pool.deallocate(&value);
+}
+
+TEST(TestTLSFPool, exhausted) {
+  TLSFPool pool(4096);
+  EXPECT_THROW(pool.allocate(4096), std::bad_alloc);
+  EXPECT_THROW(pool.allocate(static_cast<size_t>(-1)), std::bad_alloc);
+
+  std::vector<void *> blocks;
+  try {
+    while (true) {
+      blocks.push_back(pool.allocate(100));
+    }
+  } catch (const std::bad_alloc &) {
+  }
+  EXPECT_LT(20u, blocks.size());
+  for (void * block : blocks) {
+    pool.deallocate(block);
+  }
+  EXPECT_EQ(0u, pool.get_used_size());
+}
+
+TEST(TestTLSFPool, free_blocks_are_merged) {
+  TLSFPool pool(64 * 1024);
+  // The largest possible block, to learn how much a single allocation can take.
+  size_t largest = 64 * 1024;
+  void * block = nullptr;
+  while (nullptr == block) {
+    try {
+      block = pool.allocate(largest);
+    } catch (const std::bad_alloc &) {
+      largest -= 64;
+    }
+  }
+  pool.deallocate(block);
+
+  // Fragment the pool, then free the blocks in an arbitrary order.
+  std::vector<void *> blocks;
+  for (size_t i = 0; i < 100; ++i) {
+    blocks.push_back(pool.allocate(16 + (i % 7) * 48));
+  }
+  std::mt19937 generator(42);
+  std::shuffle(blocks.begin(), blocks.end(), generator);
+  for (void * fragment : blocks) {
+    pool.deallocate(fragment);
+  }
+
+  // The pool is a single free block again.
+  block = pool.allocate(largest);
+  EXPECT_NE(nullptr, block);
+  pool.deallocate(block);
+}
+
+TEST(TestTLSFPool, random_allocations) {
+  TLSFPool pool(1024 * 1024);
+  std::mt19937 generator(42);
+  std::uniform_int_distribution<size_t> sizes(1, 4096);
+  std::vector<std::pair<unsigned char *, size_t>> blocks;
+  for (size_t i = 0; i < 20000; ++i) {
+    if (blocks.empty() || generator() % 3 != 0) {
+      const size_t size = sizes(generator);
+      auto block = static_cast<unsigned char *>(pool.allocate(size));
+      std::memset(block, static_cast<int>(size & 0xff), size);
+      blocks.emplace_back(block, size);
+    } else {
+      const size_t index = generator() % blocks.size();
+      auto block = blocks[index];
+      // The content was not overwritten by another block.
+      for (size_t j = 0; j < block.second; ++j) {
+        ASSERT_EQ(block.second & 0xff, block.first[j]);
+      }
+      pool.deallocate(block.first);
+      blocks[index] = blocks.back();
+      blocks.pop_back();
+    }
+    if (blocks.size() > 200) {
+      pool.deallocate(blocks.back().first);
+      blocks.pop_back();
+    }
+  }
+  for (const auto & block : blocks) {
+    pool.deallocate(block.first);
+  }
+  EXPECT_EQ(0u, pool.get_used_size());
+}
+
+TEST(TestTLSFPool, concurrent_use) {
+  TLSFPool pool(1024 * 1024);
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < 4; ++i) {
+    threads.emplace_back(
+      [&pool, i]() {
+        for (size_t j = 0; j < 1000; ++j) {
+          auto block = static_cast<unsigned char *>(pool.allocate(64 * (i + 1)));
+          std::memset(block, 0, 64 * (i + 1));
+          pool.deallocate(block);
+        }
+      });
+  }
+  for (auto & thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(0u, pool.get_used_size());
+}
+
+TEST(TestTLSFAllocator, containers) {
+  auto pool = std::make_shared<TLSFPool>(1024 * 1024);
+  TLSFAllocator<int> allocator(pool);
+  {
+    std::vector<int, TLSFAllocator<int>> values(allocator);
+    values.assign(1000, 42);
+    EXPECT_TRUE(pool->contains(values.data()));
+
+    std::map<int, int, std::less<int>, TLSFAllocator<std::pair<const int, int>>> map(allocator);
+    for (int i = 0; i < 100; ++i) {
+      map[i] = i;
+    }
+    std::list<int, TLSFAllocator<int>> list(100, 1, allocator);
+    EXPECT_LT(1000 * sizeof(int), pool->get_used_size());
+  }
+  EXPECT_EQ(0u, pool->get_used_size());
+
+  TLSFAllocator<double> other_allocator(allocator);
+  EXPECT_TRUE(other_allocator == allocator);
+  EXPECT_FALSE(other_allocator != allocator);
+  TLSFAllocator<int> default_allocator;
+  EXPECT_EQ(TLSFPool::get_default_pool(), default_allocator.get_pool());
+  EXPECT_FALSE(default_allocator == allocator);
+}
+
+TEST(TestTLSFAllocator, realtime_memory_strategy) {
+  rclcpp::init(0, nullptr);
+  auto pool = std::make_shared<TLSFPool>();
+  rclcpp::ExecutorOptions options;
+  options.memory_strategy = rclcpp::memory_strategies::create_realtime_memory_strategy(pool);
+  ASSERT_NE(nullptr, options.memory_strategy);
+  EXPECT_NE(nullptr, rclcpp::memory_strategies::create_realtime_memory_strategy());
+
+  {
+    rclcpp::executors::SingleThreadedExecutor executor(options);
+    auto node = std::make_shared<rclcpp::Node>("test_realtime_memory_strategy");
+    bool called = false;
+    auto timer = node->create_wall_timer(1ms, [&called]() {called = true;});
+    executor.add_node(node);
+    const auto deadline = std::chrono::steady_clock::now() + 10s;
+    while (!called && std::chrono::steady_clock::now() < deadline) {
+      executor.spin_once(10ms);
+    }
+    EXPECT_TRUE(called);
+    // The handles collected by the memory strategy are in the pool.
+    EXPECT_LT(0u, pool->get_used_size());
+    executor.remove_node(node);
+  }
+  rclcpp::shutdown();
+}
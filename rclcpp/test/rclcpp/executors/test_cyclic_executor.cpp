@@ -0,0 +1,170 @@
+// Copyright 2021 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "rclcpp/executors/cyclic_executor.hpp"
+#include "rclcpp/rclcpp.hpp"
+
+#include "test_msgs/msg/basic_types.hpp"
+
+using namespace std::chrono_literals;
+using test_msgs::msg::BasicTypes;
+
+class TestCyclicExecutor : public ::testing::Test
+{
+public:
+  void SetUp()
+  {
+    rclcpp::init(0, nullptr);
+  }
+
+  void TearDown()
+  {
+    node.reset();
+    rclcpp::shutdown();
+  }
+
+  void initialize(const rclcpp::NodeOptions & node_options = rclcpp::NodeOptions())
+  {
+    node = std::make_shared<rclcpp::Node>("test_cyclic_executor", node_options);
+  }
+
+  rclcpp::Node::SharedPtr node;
+};
+
+TEST_F(TestCyclicExecutor, construction) {
+  initialize();
+  EXPECT_THROW((rclcpp::executors::CyclicExecutor(0ns)), std::invalid_argument);
+
+  rclcpp::executors::CyclicExecutor executor(10ms);
+  EXPECT_EQ(10ms, executor.get_cycle_time());
+  EXPECT_THROW(executor.add_node(node), std::runtime_error);
+  EXPECT_THROW(
+    executor.add_callback_group(
+      node->create_callback_group(rclcpp::CallbackGroupType::MutuallyExclusive),
+      node->get_node_base_interface()),
+    std::runtime_error);
+  EXPECT_THROW(executor.add_subscription_step(nullptr), std::invalid_argument);
+  EXPECT_THROW(executor.add_function_step(nullptr), std::invalid_argument);
+  EXPECT_THROW(executor.spin_all(0ns), std::invalid_argument);
+}
+
+TEST_F(TestCyclicExecutor, schedule) {
+  initialize();
+  std::vector<std::string> calls;
+  std::vector<int32_t> received;
+  auto subscription = node->create_subscription<BasicTypes>(
+    "topic", 10,
+    [&calls, &received](const BasicTypes & msg) {
+      calls.push_back("subscription");
+      received.push_back(msg.int32_value);
+    });
+  auto publisher = node->create_publisher<BasicTypes>("topic", 10);
+
+  rclcpp::executors::CyclicExecutor executor(1h);
+  executor.add_function_step([&calls]() {calls.push_back("before");});
+  executor.add_subscription_step(subscription);
+  executor.add_function_step([&calls]() {calls.push_back("after");});
+
+  // The steps run every cycle, the subscription only when a message was taken.
+  executor.spin_some();
+  EXPECT_EQ((std::vector<std::string>{"before", "after"}), calls);
+
+  BasicTypes msg;
+  auto start = std::chrono::steady_clock::now();
+  while (received.empty() && std::chrono::steady_clock::now() - start < 10s) {
+    msg.int32_value = 1;
+    publisher->publish(msg);
+    std::this_thread::sleep_for(10ms);
+    calls.clear();
+    executor.spin_some();
+  }
+  ASSERT_EQ(1u, received.size());
+  EXPECT_EQ((std::vector<std::string>{"before", "subscription", "after"}), calls);
+
+  // The latest message available at the start of a cycle is given to the callback.
+  received.clear();
+  for (int32_t value : {2, 3, 4}) {
+    msg.int32_value = value;
+    publisher->publish(msg);
+  }
+  start = std::chrono::steady_clock::now();
+  while ((received.empty() || received.back() != 4) &&
+    std::chrono::steady_clock::now() - start < 10s)
+  {
+    std::this_thread::sleep_for(10ms);
+    executor.spin_some();
+  }
+  ASSERT_FALSE(received.empty());
+  EXPECT_EQ(4, received.back());
+}
+
+TEST_F(TestCyclicExecutor, intra_process) {
+  initialize(rclcpp::NodeOptions().use_intra_process_comms(true));
+  std::vector<int32_t> received;
+  auto subscription = node->create_subscription<BasicTypes>(
+    "topic", 10, [&received](BasicTypes::ConstSharedPtr msg) {
+      received.push_back(msg->int32_value);
+    });
+  auto publisher = node->create_publisher<BasicTypes>("topic", 10);
+
+  rclcpp::executors::CyclicExecutor executor(1h);
+  executor.add_subscription_step(subscription);
+  BasicTypes msg;
+  msg.int32_value = 1;
+  publisher->publish(msg);
+  executor.spin_some();
+  EXPECT_EQ((std::vector<int32_t>{1}), received);
+}
+
+TEST_F(TestCyclicExecutor, statistics) {
+  rclcpp::executors::CyclicExecutor executor(5ms);
+  std::atomic_bool slow {true};
+  executor.add_function_step(
+    [&slow]() {
+      if (slow.exchange(false)) {
+        std::this_thread::sleep_for(20ms);
+      }
+    });
+
+  executor.spin_some();
+  auto statistics = executor.get_statistics();
+  EXPECT_EQ(1u, statistics.cycles);
+  EXPECT_EQ(1u, statistics.overruns);
+  EXPECT_LE(20ms, statistics.max_execution_time);
+
+  std::thread spin_thread([&executor]() {executor.spin();});
+  std::this_thread::sleep_for(50ms);
+  executor.cancel();
+  spin_thread.join();
+  statistics = executor.get_statistics();
+  EXPECT_LT(2u, statistics.cycles);
+
+  // Shutting down the context stops a spin waiting for the next cycle.
+  rclcpp::executors::CyclicExecutor slow_executor(1h);
+  spin_thread = std::thread([&slow_executor]() {slow_executor.spin();});
+  std::this_thread::sleep_for(50ms);
+  rclcpp::shutdown();
+  spin_thread.join();
+  EXPECT_EQ(1u, slow_executor.get_statistics().cycles);
+}
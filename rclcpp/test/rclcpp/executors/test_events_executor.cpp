@@ -0,0 +1,172 @@
+// Copyright 2021 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+
+#include "rclcpp/exceptions.hpp"
+#include "rclcpp/node.hpp"
+#include "rclcpp/rclcpp.hpp"
+#include "rclcpp/executors.hpp"
+
+#include "test_msgs/msg/empty.hpp"
+
+using namespace std::chrono_literals;
+
+class TestEventsExecutor : public ::testing::Test
+{
+public:
+  void SetUp()
+  {
+    rclcpp::init(0, nullptr);
+  }
+
+  void TearDown()
+  {
+    rclcpp::shutdown();
+  }
+};
+
+TEST(TestEventsQueue, push_pop) {
+  rclcpp::executors::EventsQueue queue;
+  EXPECT_TRUE(queue.empty());
+
+  rclcpp::executors::ExecutorEvent event;
+  EXPECT_FALSE(queue.pop(event));
+
+  int first = 0;
+  int second = 0;
+  queue.push({&first, rclcpp::executors::ExecutorEventType::TIMER_EVENT});
+  queue.push({&second, rclcpp::executors::ExecutorEventType::SUBSCRIPTION_EVENT});
+  EXPECT_EQ(2u, queue.size());
+
+  ASSERT_TRUE(queue.pop(event));
+  EXPECT_EQ(&first, event.entity_key);
+  EXPECT_EQ(rclcpp::executors::ExecutorEventType::TIMER_EVENT, event.type);
+  ASSERT_TRUE(queue.pop(event));
+  EXPECT_EQ(&second, event.entity_key);
+  EXPECT_EQ(rclcpp::executors::ExecutorEventType::SUBSCRIPTION_EVENT, event.type);
+  EXPECT_TRUE(queue.empty());
+
+  queue.push({&first, rclcpp::executors::ExecutorEventType::CLIENT_EVENT});
+  queue.clear();
+  EXPECT_TRUE(queue.empty());
+}
+
+TEST_F(TestEventsExecutor, remove_node_not_added) {
+  rclcpp::executors::EventsExecutor executor;
+  auto node = std::make_shared<rclcpp::Node>("node", "ns");
+  EXPECT_THROW(executor.remove_node(node, true), std::runtime_error);
+}
+
+TEST_F(TestEventsExecutor, spin_some_executes_ready_subscription) {
+  rclcpp::executors::EventsExecutor executor;
+  auto node = std::make_shared<rclcpp::Node>("node", "ns");
+
+  size_t callback_count = 0;
+  auto subscription = node->create_subscription<test_msgs::msg::Empty>(
+    "topic", rclcpp::QoS(10),
+    [&callback_count](test_msgs::msg::Empty::ConstSharedPtr) {callback_count++;});
+  auto publisher = node->create_publisher<test_msgs::msg::Empty>("topic", rclcpp::QoS(10));
+  executor.add_node(node);
+
+  auto start = std::chrono::steady_clock::now();
+  while (callback_count == 0 && (std::chrono::steady_clock::now() - start) < 10s) {
+    publisher->publish(test_msgs::msg::Empty());
+    executor.spin_some();
+    std::this_thread::sleep_for(1ms);
+  }
+  EXPECT_LT(0u, callback_count);
+}
+
+// Entities created after spin() started must be picked up without restarting the spin.
+TEST_F(TestEventsExecutor, entities_added_while_spinning) {
+  rclcpp::executors::EventsExecutor executor;
+  auto node = std::make_shared<rclcpp::Node>("node", "ns");
+  executor.add_node(node);
+
+  std::thread spinner([&executor]() {executor.spin();});
+  std::this_thread::sleep_for(10ms);
+
+  std::atomic_bool timer_completed {false};
+  auto timer = node->create_wall_timer(1ms, [&timer_completed]() {timer_completed = true;});
+
+  auto late_node = std::make_shared<rclcpp::Node>("late_node", "ns");
+  std::atomic_bool late_timer_completed {false};
+  auto late_timer = late_node->create_wall_timer(
+    1ms, [&late_timer_completed]() {late_timer_completed = true;});
+  executor.add_node(late_node);
+
+  auto start = std::chrono::steady_clock::now();
+  while ((!timer_completed || !late_timer_completed) &&
+    (std::chrono::steady_clock::now() - start) < 10s)
+  {
+    std::this_thread::sleep_for(1ms);
+  }
+  EXPECT_TRUE(timer_completed);
+  EXPECT_TRUE(late_timer_completed);
+
+  executor.cancel();
+  spinner.join();
+  executor.remove_node(late_node, true);
+  executor.remove_node(node, true);
+}
+
+// Steady timers run by the timers manager still execute their callbacks on the spinning thread.
+TEST_F(TestEventsExecutor, timers_manager) {
+  rclcpp::executors::EventsExecutor executor(rclcpp::ExecutorOptions(), true);
+  auto node = std::make_shared<rclcpp::Node>("node", "ns");
+
+  std::atomic_size_t timer_count {0};
+  std::thread::id timer_thread_id;
+  auto timer = node->create_wall_timer(
+    1ms, [&timer_count, &timer_thread_id]() {
+      timer_thread_id = std::this_thread::get_id();
+      timer_count++;
+    });
+  executor.add_node(node);
+
+  std::thread::id spinner_thread_id;
+  std::thread spinner([&executor, &spinner_thread_id]() {
+      spinner_thread_id = std::this_thread::get_id();
+      executor.spin();
+    });
+
+  auto start = std::chrono::steady_clock::now();
+  while (timer_count < 3u && (std::chrono::steady_clock::now() - start) < 10s) {
+    std::this_thread::sleep_for(1ms);
+  }
+  EXPECT_LE(3u, timer_count.load());
+
+  executor.cancel();
+  spinner.join();
+  EXPECT_EQ(spinner_thread_id, timer_thread_id);
+
+  // Without spin() running, the timers are waited for in the wait set again.
+  const size_t count_before_spin_some = timer_count.load();
+  start = std::chrono::steady_clock::now();
+  while (timer_count == count_before_spin_some &&
+    (std::chrono::steady_clock::now() - start) < 10s)
+  {
+    executor.spin_some();
+    std::this_thread::sleep_for(1ms);
+  }
+  EXPECT_LT(count_before_spin_some, timer_count.load());
+  executor.remove_node(node, true);
+}
@@ -0,0 +1,131 @@
+// Copyright 2021 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstdlib>
+#include <memory>
+#include <new>
+
+#include "rclcpp/rclcpp.hpp"
+#include "rclcpp/executors.hpp"
+
+#include "test_msgs/msg/empty.hpp"
+
+using namespace std::chrono_literals;
+
+// Only count the allocations of the thread under test, the middleware has threads of its own.
+static thread_local bool count_allocations = false;
+static thread_local size_t allocation_count = 0;
+
+void *
+operator new(std::size_t size)
+{
+  if (count_allocations) {
+    ++allocation_count;
+  }
+  void * ptr = std::malloc(size ? size : 1u);
+  if (!ptr) {
+    throw std::bad_alloc();
+  }
+  return ptr;
+}
+
+void
+operator delete(void * ptr) noexcept
+{
+  std::free(ptr);
+}
+
+void
+operator delete(void * ptr, std::size_t) noexcept
+{
+  std::free(ptr);
+}
+
+class TestExecutorAllocations : public ::testing::Test
+{
+public:
+  void SetUp()
+  {
+    rclcpp::init(0, nullptr);
+  }
+
+  void TearDown()
+  {
+    rclcpp::shutdown();
+  }
+};
+
+/*
+   Test that once the entities are collected, waiting for and executing timers does not allocate.
+ */
+TEST_F(TestExecutorAllocations, single_threaded_executor_timers) {
+  rclcpp::executors::SingleThreadedExecutor executor;
+  auto node = std::make_shared<rclcpp::Node>("test_executor_allocations");
+  size_t callback_count = 0;
+  auto timer = node->create_wall_timer(1ms, [&callback_count]() {callback_count++;});
+  auto other_timer = node->create_wall_timer(1ms, [&callback_count]() {callback_count++;});
+  executor.add_node(node);
+
+  // The first iterations collect the entities and size the wait set.
+  for (size_t i = 0; i < 10u; ++i) {
+    executor.spin_once(10ms);
+  }
+
+  const size_t initial_callback_count = callback_count;
+  count_allocations = true;
+  for (size_t i = 0; i < 100u; ++i) {
+    executor.spin_once(10ms);
+  }
+  count_allocations = false;
+
+  EXPECT_LT(initial_callback_count, callback_count);
+  EXPECT_EQ(0u, allocation_count);
+}
+
+/*
+   Test that taking and executing intra-process messages does not allocate.
+ */
+TEST_F(TestExecutorAllocations, single_threaded_executor_intra_process) {
+  rclcpp::executors::SingleThreadedExecutor executor;
+  auto node = std::make_shared<rclcpp::Node>(
+    "test_executor_allocations", rclcpp::NodeOptions().use_intra_process_comms(true));
+  size_t callback_count = 0;
+  auto subscription = node->create_subscription<test_msgs::msg::Empty>(
+    "test_executor_allocations_topic", 10,
+    [&callback_count](test_msgs::msg::Empty::UniquePtr) {callback_count++;});
+  auto publisher = node->create_publisher<test_msgs::msg::Empty>(
+    "test_executor_allocations_topic", 10);
+  executor.add_node(node);
+
+  // The first iterations collect the entities and size the wait set.
+  for (size_t i = 0; i < 10u; ++i) {
+    publisher->publish(std::make_unique<test_msgs::msg::Empty>());
+    executor.spin_once(10ms);
+  }
+
+  // Only the spinning is counted, publishing allocates the message.
+  const size_t initial_callback_count = callback_count;
+  for (size_t i = 0; i < 100u; ++i) {
+    publisher->publish(std::make_unique<test_msgs::msg::Empty>());
+    count_allocations = true;
+    executor.spin_once(10ms);
+    count_allocations = false;
+  }
+
+  EXPECT_LT(initial_callback_count, callback_count);
+  EXPECT_EQ(0u, allocation_count);
+}
@@ -21,6 +21,7 @@
 
 #include <algorithm>
 #include <chrono>
+#include <future>
 #include <limits>
 #include <memory>
 #include <string>
@@ -90,7 +91,9 @@ using ExecutorTypes =
   ::testing::Types<
   rclcpp::executors::SingleThreadedExecutor,
   rclcpp::executors::MultiThreadedExecutor,
-  rclcpp::executors::StaticSingleThreadedExecutor>;
+  rclcpp::executors::StaticSingleThreadedExecutor,
+  rclcpp::executors::StaticMultiThreadedExecutor,
+  rclcpp::executors::EventsExecutor>;
 
 class ExecutorTypeNames
 {
@@ -111,6 +114,14 @@ public:
       return "StaticSingleThreadedExecutor";
     }
 
+    if (std::is_same<T, rclcpp::executors::StaticMultiThreadedExecutor>()) {
+      return "StaticMultiThreadedExecutor";
+    }
+
+    if (std::is_same<T, rclcpp::executors::EventsExecutor>()) {
+      return "EventsExecutor";
+    }
+
     return "";
   }
 };
@@ -349,6 +360,41 @@ TYPED_TEST(TestExecutors, testSpinUntilFutureCompleteWithTimeout) {
   spinner.join();
 }
 
+// Check spin_until_future_complete returns as soon as it is woken after the future completes.
+TYPED_TEST(TestExecutors, testSpinUntilFutureCompleteWoken) {
+  using ExecutorType = TypeParam;
+  ExecutorType executor;
+  executor.add_node(this->node);
+
+  std::promise<void> promise;
+  std::shared_future<void> future = promise.get_future().share();
+  std::thread completer([&promise, &executor]() {
+      std::this_thread::sleep_for(10ms);
+      promise.set_value();
+      executor.wake();
+    });
+
+  // Nothing else wakes the wait before the timeout.
+  const auto start = std::chrono::steady_clock::now();
+  auto ret = executor.spin_until_future_complete(future, 10s);
+  EXPECT_EQ(rclcpp::FutureReturnCode::SUCCESS, ret);
+  EXPECT_GT(5s, std::chrono::steady_clock::now() - start);
+  completer.join();
+
+  // The promises of rclcpp wake all the executors awaiting a future.
+  std::promise<void> rclcpp_promise;
+  future = rclcpp_promise.get_future().share();
+  completer = std::thread([&rclcpp_promise]() {
+      std::this_thread::sleep_for(10ms);
+      rclcpp_promise.set_value();
+      rclcpp::detail::wake_future_waiters();
+    });
+  ret = executor.spin_until_future_complete(future, 10s);
+  EXPECT_EQ(rclcpp::FutureReturnCode::SUCCESS, ret);
+  EXPECT_GT(5s, std::chrono::steady_clock::now() - start);
+  completer.join();
+}
+
 class TestWaitable : public rclcpp::Waitable
 {
 public:
@@ -14,9 +14,15 @@
 
 #include <gtest/gtest.h>
 
+#include <atomic>
 #include <chrono>
 #include <string>
 #include <memory>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+#include <thread>
+#include <vector>
 
 #include "rclcpp/exceptions.hpp"
 #include "rclcpp/node.hpp"
@@ -97,3 +103,229 @@ TEST_F(TestMultiThreadedExecutor, timer_over_take) {
   executor.add_node(node);
   executor.spin();
 }
+
+using SchedulingMode = rclcpp::executors::MultiThreadedExecutor::SchedulingMode;
+
+/*
+   Check that a scheduling mode executes callbacks in parallel and respects
+   mutually exclusive callback groups.
+ */
+void
+check_scheduling_mode_parallelism(SchedulingMode scheduling_mode, const std::string & node_name)
+{
+  rclcpp::executors::MultiThreadedExecutor executor(
+    rclcpp::ExecutorOptions(), 4u, false, std::chrono::nanoseconds(-1), scheduling_mode);
+  EXPECT_EQ(scheduling_mode, executor.get_scheduling_mode());
+
+  std::shared_ptr<rclcpp::Node> node = std::make_shared<rclcpp::Node>(node_name);
+
+  auto reentrant_cbg = node->create_callback_group(rclcpp::CallbackGroupType::Reentrant);
+  auto exclusive_cbg = node->create_callback_group(
+    rclcpp::CallbackGroupType::MutuallyExclusive);
+
+  std::atomic_int reentrant_count {0};
+  std::atomic_int reentrant_in_callback {0};
+  std::atomic_int max_reentrant_in_callback {0};
+  std::atomic_int exclusive_count {0};
+  std::atomic_int exclusive_in_callback {0};
+  std::atomic_bool exclusive_overlapped {false};
+
+  auto reentrant_callback =
+    [&reentrant_count, &reentrant_in_callback, &max_reentrant_in_callback]() {
+      int in_callback = ++reentrant_in_callback;
+      int max_in_callback = max_reentrant_in_callback.load();
+      while (in_callback > max_in_callback &&
+        !max_reentrant_in_callback.compare_exchange_weak(max_in_callback, in_callback))
+      {
+      }
+      std::this_thread::sleep_for(20ms);
+      --reentrant_in_callback;
+      ++reentrant_count;
+    };
+  auto exclusive_callback = [&exclusive_count, &exclusive_in_callback, &exclusive_overlapped]() {
+      if (++exclusive_in_callback > 1) {
+        exclusive_overlapped = true;
+      }
+      std::this_thread::sleep_for(5ms);
+      --exclusive_in_callback;
+      ++exclusive_count;
+    };
+
+  std::vector<rclcpp::TimerBase::SharedPtr> timers;
+  for (size_t i = 0; i < 3u; ++i) {
+    timers.push_back(node->create_wall_timer(10ms, reentrant_callback, reentrant_cbg));
+    timers.push_back(node->create_wall_timer(1ms, exclusive_callback, exclusive_cbg));
+  }
+  executor.add_node(node);
+
+  std::thread spinner([&executor]() {executor.spin();});
+  auto start = std::chrono::steady_clock::now();
+  while ((reentrant_count < 20 || exclusive_count < 20) &&
+    (std::chrono::steady_clock::now() - start) < 10s)
+  {
+    std::this_thread::sleep_for(1ms);
+  }
+  executor.cancel();
+  spinner.join();
+
+  EXPECT_LE(20, reentrant_count.load());
+  EXPECT_LE(20, exclusive_count.load());
+  EXPECT_LT(1, max_reentrant_in_callback.load());
+  EXPECT_FALSE(exclusive_overlapped.load());
+}
+
+TEST_F(TestMultiThreadedExecutor, hand_off_scheduling_mode) {
+  check_scheduling_mode_parallelism(
+    SchedulingMode::HandOff, "test_multi_threaded_executor_hand_off");
+}
+
+TEST_F(TestMultiThreadedExecutor, work_stealing_scheduling_mode) {
+  check_scheduling_mode_parallelism(
+    SchedulingMode::WorkStealing, "test_multi_threaded_executor_work_stealing");
+}
+
+#ifdef __linux__
+/*
+   Test that the threads of the pool run with the CPU affinity of the options, and that the thread
+   which called spin() gets its own affinity back.
+ */
+TEST_F(TestMultiThreadedExecutor, thread_attributes) {
+  const auto initial_attributes = rclcpp::get_thread_attributes();
+  ASSERT_FALSE(initial_attributes.cpu_affinity.empty());
+  const std::vector<size_t> pinned_cpu {initial_attributes.cpu_affinity.back()};
+
+  rclcpp::ExecutorOptions options;
+  options.thread_attributes.cpu_affinity = pinned_cpu;
+  rclcpp::executors::MultiThreadedExecutor executor(options, 2u);
+
+  std::shared_ptr<rclcpp::Node> node =
+    std::make_shared<rclcpp::Node>("test_multi_threaded_executor_thread_attributes");
+  auto cbg = node->create_callback_group(rclcpp::CallbackGroupType::Reentrant);
+  std::atomic_int count {0};
+  std::atomic_bool unpinned_callback {false};
+  auto timer_callback = [&count, &unpinned_callback, &pinned_cpu]() {
+      if (rclcpp::get_thread_attributes().cpu_affinity != pinned_cpu) {
+        unpinned_callback = true;
+      }
+      count++;
+    };
+  auto timer = node->create_wall_timer(1ms, timer_callback, cbg);
+  executor.add_node(node);
+
+  std::vector<size_t> affinity_after_spin;
+  std::thread spinner([&executor, &affinity_after_spin]() {
+      executor.spin();
+      affinity_after_spin = rclcpp::get_thread_attributes().cpu_affinity;
+    });
+  auto start = std::chrono::steady_clock::now();
+  while (count < 20 && (std::chrono::steady_clock::now() - start) < 10s) {
+    std::this_thread::sleep_for(1ms);
+  }
+  executor.cancel();
+  spinner.join();
+
+  EXPECT_LE(20, count.load());
+  EXPECT_FALSE(unpinned_callback.load());
+  EXPECT_EQ(initial_attributes.cpu_affinity, affinity_after_spin);
+}
+#endif
+
+TEST_F(TestMultiThreadedExecutor, pin_callback_group_invalid_arguments) {
+  rclcpp::executors::MultiThreadedExecutor executor(rclcpp::ExecutorOptions(), 2u);
+  auto node = std::make_shared<rclcpp::Node>("test_multi_threaded_executor_pin_invalid");
+  auto cbg = node->create_callback_group(rclcpp::CallbackGroupType::Reentrant);
+
+  EXPECT_THROW(executor.pin_callback_group(nullptr, {0u}), std::invalid_argument);
+  EXPECT_THROW(executor.pin_callback_group(cbg, {2u}), std::invalid_argument);
+  EXPECT_TRUE(executor.get_callback_group_threads(cbg).empty());
+
+  executor.pin_callback_group(cbg, {1u});
+  EXPECT_EQ(std::vector<size_t>({1u}), executor.get_callback_group_threads(cbg));
+  executor.pin_callback_group(cbg, {});
+  EXPECT_TRUE(executor.get_callback_group_threads(cbg).empty());
+}
+
+TEST_F(TestMultiThreadedExecutor, pin_callback_group_to_numa_node) {
+  const std::vector<rclcpp::NumaNode> nodes = {{0u, {0u, 1u}}, {1u, {2u, 3u}}, {2u, {4u}}};
+  rclcpp::ExecutorOptions options;
+  options.worker_thread_attributes = rclcpp::make_numa_thread_attributes(4u, {nodes[0], nodes[1]});
+  rclcpp::executors::MultiThreadedExecutor executor(options, 4u);
+  auto node = std::make_shared<rclcpp::Node>("test_multi_threaded_executor_pin_numa");
+  auto cbg = node->create_callback_group(rclcpp::CallbackGroupType::Reentrant);
+
+  executor.pin_callback_group_to_numa_node(cbg, 1u, nodes);
+  EXPECT_EQ(std::vector<size_t>({2u, 3u}), executor.get_callback_group_threads(cbg));
+  executor.pin_callback_group_to_numa_node(cbg, 0u, nodes);
+  EXPECT_EQ(std::vector<size_t>({0u, 1u}), executor.get_callback_group_threads(cbg));
+
+  EXPECT_THROW(executor.pin_callback_group_to_numa_node(cbg, 2u, nodes), std::invalid_argument);
+  EXPECT_THROW(executor.pin_callback_group_to_numa_node(cbg, 3u, nodes), std::invalid_argument);
+  EXPECT_THROW(
+    executor.pin_callback_group_to_numa_node(nullptr, 0u, nodes), std::invalid_argument);
+  EXPECT_EQ(std::vector<size_t>({0u, 1u}), executor.get_callback_group_threads(cbg));
+}
+
+/*
+   Test that the callbacks of a pinned callback group always run on the same thread, while the
+   other callback groups still run on any thread.
+ */
+static void
+check_pin_callback_group(SchedulingMode scheduling_mode, const std::string & node_name)
+{
+  rclcpp::executors::MultiThreadedExecutor executor(
+    rclcpp::ExecutorOptions(), 3u, false, std::chrono::nanoseconds(-1), scheduling_mode);
+
+  std::shared_ptr<rclcpp::Node> node = std::make_shared<rclcpp::Node>(node_name);
+  auto pinned_cbg = node->create_callback_group(rclcpp::CallbackGroupType::Reentrant);
+  auto free_cbg = node->create_callback_group(rclcpp::CallbackGroupType::Reentrant);
+  executor.pin_callback_group(pinned_cbg, {0u});
+
+  std::mutex thread_ids_mutex;
+  std::set<std::thread::id> pinned_thread_ids;
+  std::atomic_int pinned_count {0};
+  std::atomic_int free_count {0};
+  auto pinned_callback = [&]() {
+      {
+        std::lock_guard<std::mutex> lock(thread_ids_mutex);
+        pinned_thread_ids.insert(std::this_thread::get_id());
+      }
+      pinned_count++;
+    };
+  auto free_callback = [&free_count]() {
+      std::this_thread::sleep_for(2ms);
+      free_count++;
+    };
+  std::vector<rclcpp::TimerBase::SharedPtr> timers;
+  for (size_t i = 0; i < 3u; ++i) {
+    timers.push_back(node->create_wall_timer(1ms, pinned_callback, pinned_cbg));
+    timers.push_back(node->create_wall_timer(1ms, free_callback, free_cbg));
+  }
+  executor.add_node(node);
+
+  std::thread spinner([&executor]() {executor.spin();});
+  auto start = std::chrono::steady_clock::now();
+  while ((pinned_count < 50 || free_count < 20) &&
+    (std::chrono::steady_clock::now() - start) < 10s)
+  {
+    std::this_thread::sleep_for(1ms);
+  }
+  executor.cancel();
+  spinner.join();
+
+  EXPECT_LE(50, pinned_count.load());
+  EXPECT_LE(20, free_count.load());
+  EXPECT_EQ(1u, pinned_thread_ids.size());
+}
+
+TEST_F(TestMultiThreadedExecutor, pin_callback_group_shared_wait) {
+  check_pin_callback_group(SchedulingMode::SharedWait, "test_multi_threaded_executor_pin_shared");
+}
+
+TEST_F(TestMultiThreadedExecutor, pin_callback_group_hand_off) {
+  check_pin_callback_group(SchedulingMode::HandOff, "test_multi_threaded_executor_pin_hand_off");
+}
+
+TEST_F(TestMultiThreadedExecutor, pin_callback_group_work_stealing) {
+  check_pin_callback_group(
+    SchedulingMode::WorkStealing, "test_multi_threaded_executor_pin_work_stealing");
+}
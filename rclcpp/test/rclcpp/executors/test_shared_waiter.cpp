@@ -0,0 +1,150 @@
+// Copyright 2021 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <memory>
+#include <thread>
+
+#include "rclcpp/executors/shared_waiter.hpp"
+#include "rclcpp/rclcpp.hpp"
+
+#include "test_msgs/msg/empty.hpp"
+
+using namespace std::chrono_literals;
+
+class TestSharedWaiter : public ::testing::Test
+{
+public:
+  void SetUp()
+  {
+    rclcpp::init(0, nullptr);
+    waiter = std::make_shared<rclcpp::executors::SharedWaiter>();
+    options.shared_waiter = waiter;
+  }
+
+  void TearDown()
+  {
+    rclcpp::shutdown();
+  }
+
+  rclcpp::executors::SharedWaiter::SharedPtr waiter;
+  rclcpp::ExecutorOptions options;
+};
+
+TEST_F(TestSharedWaiter, callbacks_run_in_the_threads_of_their_executors) {
+  auto timer_node = std::make_shared<rclcpp::Node>("timer_node");
+  auto subscription_node = std::make_shared<rclcpp::Node>("subscription_node");
+  rclcpp::executors::SingleThreadedExecutor timer_executor(options);
+  rclcpp::executors::SingleThreadedExecutor subscription_executor(options);
+  timer_executor.add_node(timer_node);
+  subscription_executor.add_node(subscription_node);
+
+  std::thread::id timer_thread_id;
+  std::thread::id subscription_thread_id;
+  std::atomic<size_t> timer_calls{0};
+  std::atomic<size_t> subscription_calls{0};
+  auto timer = timer_node->create_wall_timer(
+    1ms, [&]() {
+      timer_thread_id = std::this_thread::get_id();
+      ++timer_calls;
+    });
+  auto subscription = subscription_node->create_subscription<test_msgs::msg::Empty>(
+    "topic", 10, [&](test_msgs::msg::Empty::ConstSharedPtr) {
+      subscription_thread_id = std::this_thread::get_id();
+      ++subscription_calls;
+    });
+  auto publisher = timer_node->create_publisher<test_msgs::msg::Empty>("topic", 10);
+
+  std::thread timer_thread([&timer_executor]() {timer_executor.spin();});
+  std::thread subscription_thread([&subscription_executor]() {subscription_executor.spin();});
+  const auto timeout = std::chrono::steady_clock::now() + 10s;
+  while (
+    (timer_calls < 5 || subscription_calls < 5) && std::chrono::steady_clock::now() < timeout)
+  {
+    publisher->publish(test_msgs::msg::Empty());
+    std::this_thread::sleep_for(10ms);
+  }
+  timer_executor.cancel();
+  subscription_executor.cancel();
+  const std::thread::id timer_executor_thread_id = timer_thread.get_id();
+  const std::thread::id subscription_executor_thread_id = subscription_thread.get_id();
+  timer_thread.join();
+  subscription_thread.join();
+
+  EXPECT_GE(timer_calls, 5u);
+  EXPECT_GE(subscription_calls, 5u);
+  EXPECT_EQ(timer_executor_thread_id, timer_thread_id);
+  EXPECT_EQ(subscription_executor_thread_id, subscription_thread_id);
+  EXPECT_GT(waiter->get_wait_count(), 0u);
+}
+
+TEST_F(TestSharedWaiter, executors_without_ready_work_keep_waiting) {
+  auto busy_node = std::make_shared<rclcpp::Node>("busy_node");
+  auto idle_node = std::make_shared<rclcpp::Node>("idle_node");
+  rclcpp::executors::SingleThreadedExecutor busy_executor(options);
+  rclcpp::executors::SingleThreadedExecutor idle_executor(options);
+  busy_executor.add_node(busy_node);
+  idle_executor.add_node(idle_node);
+
+  std::atomic<size_t> busy_calls{0};
+  std::atomic<size_t> idle_calls{0};
+  auto busy_timer = busy_node->create_wall_timer(1ms, [&busy_calls]() {++busy_calls;});
+  auto idle_timer = idle_node->create_wall_timer(1h, [&idle_calls]() {++idle_calls;});
+
+  // The idle executor returns at its own timeout, whatever the busy executor is woken up for.
+  std::thread busy_thread([&busy_executor]() {busy_executor.spin();});
+  const auto start = std::chrono::steady_clock::now();
+  idle_executor.spin_once(100ms);
+  EXPECT_GE(std::chrono::steady_clock::now() - start, 100ms);
+  EXPECT_EQ(0u, idle_calls);
+
+  busy_executor.cancel();
+  busy_thread.join();
+  EXPECT_GT(busy_calls, 0u);
+}
+
+TEST_F(TestSharedWaiter, cancel_wakes_up_the_executor) {
+  auto node = std::make_shared<rclcpp::Node>("node");
+  rclcpp::executors::SingleThreadedExecutor executor(options);
+  executor.add_node(node);
+
+  std::thread thread([&executor]() {executor.spin();});
+  std::this_thread::sleep_for(50ms);
+  executor.cancel();
+  thread.join();
+  EXPECT_FALSE(executor.is_spinning());
+}
+
+TEST_F(TestSharedWaiter, spin_until_future_complete) {
+  auto node = std::make_shared<rclcpp::Node>("node");
+  rclcpp::executors::MultiThreadedExecutor executor(options, 2);
+  executor.add_node(node);
+
+  std::promise<void> promise;
+  std::atomic<bool> completed{false};
+  auto timer = node->create_wall_timer(
+    10ms, [&promise, &completed]() {
+      if (!completed.exchange(true)) {
+        promise.set_value();
+      }
+    });
+  EXPECT_EQ(
+    rclcpp::FutureReturnCode::SUCCESS,
+    executor.spin_until_future_complete(promise.get_future(), 10s));
+}
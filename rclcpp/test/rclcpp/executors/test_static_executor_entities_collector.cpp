@@ -309,6 +309,20 @@ TEST_F(TestStaticExecutorEntitiesCollector, add_remove_node_with_entities) {
     2u + expected_number_of_entities->waitables,
     entities_collector_->get_number_of_waitables());
 
+  // The entities are all in the default callback group, but for the executor's waitable.
+  auto default_group = node->get_node_base_interface()->get_default_callback_group();
+  for (size_t i = 0; i < entities_collector_->get_number_of_timers(); ++i) {
+    EXPECT_EQ(default_group, entities_collector_->get_timer_callback_group(i));
+  }
+  for (size_t i = 0; i < entities_collector_->get_number_of_services(); ++i) {
+    EXPECT_EQ(default_group, entities_collector_->get_service_callback_group(i));
+  }
+  const size_t number_of_waitables = entities_collector_->get_number_of_waitables();
+  for (size_t i = 0; i + 1 < number_of_waitables; ++i) {
+    EXPECT_EQ(default_group, entities_collector_->get_waitable_callback_group(i));
+  }
+  EXPECT_EQ(nullptr, entities_collector_->get_waitable_callback_group(number_of_waitables - 1));
+
   entities_collector_->remove_node(node->get_node_base_interface());
   entities_collector_->init(&wait_set, memory_strategy, &rcl_guard_condition);
   EXPECT_EQ(0u, entities_collector_->get_number_of_subscriptions());
@@ -0,0 +1,156 @@
+// Copyright 2021 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "rclcpp/executors.hpp"
+#include "rclcpp/node.hpp"
+#include "rclcpp/rclcpp.hpp"
+
+#include "test_msgs/msg/empty.hpp"
+
+using namespace std::chrono_literals;
+
+class TestStaticMultiThreadedExecutor : public ::testing::Test
+{
+public:
+  void SetUp()
+  {
+    rclcpp::init(0, nullptr);
+  }
+
+  void TearDown()
+  {
+    rclcpp::shutdown();
+  }
+};
+
+TEST_F(TestStaticMultiThreadedExecutor, number_of_threads) {
+  rclcpp::executors::StaticMultiThreadedExecutor executor(rclcpp::ExecutorOptions(), 3u);
+  EXPECT_EQ(3u, executor.get_number_of_threads());
+  rclcpp::executors::StaticMultiThreadedExecutor default_executor;
+  EXPECT_LE(1u, default_executor.get_number_of_threads());
+}
+
+/*
+   Check that the callbacks are executed in parallel and that mutually exclusive
+   callback groups are respected.
+ */
+TEST_F(TestStaticMultiThreadedExecutor, parallelism) {
+  rclcpp::executors::StaticMultiThreadedExecutor executor(rclcpp::ExecutorOptions(), 4u);
+  auto node = std::make_shared<rclcpp::Node>("test_static_multi_threaded_executor");
+
+  auto reentrant_cbg = node->create_callback_group(rclcpp::CallbackGroupType::Reentrant);
+  auto exclusive_cbg = node->create_callback_group(
+    rclcpp::CallbackGroupType::MutuallyExclusive);
+
+  std::atomic_int reentrant_count {0};
+  std::atomic_int reentrant_in_callback {0};
+  std::atomic_int max_reentrant_in_callback {0};
+  std::atomic_int exclusive_count {0};
+  std::atomic_int exclusive_in_callback {0};
+  std::atomic_bool exclusive_overlapped {false};
+
+  auto reentrant_callback =
+    [&reentrant_count, &reentrant_in_callback, &max_reentrant_in_callback]() {
+      int in_callback = ++reentrant_in_callback;
+      int max_in_callback = max_reentrant_in_callback.load();
+      while (in_callback > max_in_callback &&
+        !max_reentrant_in_callback.compare_exchange_weak(max_in_callback, in_callback))
+      {
+      }
+      std::this_thread::sleep_for(20ms);
+      --reentrant_in_callback;
+      ++reentrant_count;
+    };
+  auto exclusive_callback = [&exclusive_count, &exclusive_in_callback, &exclusive_overlapped]() {
+      if (++exclusive_in_callback > 1) {
+        exclusive_overlapped = true;
+      }
+      std::this_thread::sleep_for(5ms);
+      --exclusive_in_callback;
+      ++exclusive_count;
+    };
+
+  std::vector<rclcpp::TimerBase::SharedPtr> timers;
+  for (size_t i = 0; i < 3u; ++i) {
+    timers.push_back(node->create_wall_timer(10ms, reentrant_callback, reentrant_cbg));
+    timers.push_back(node->create_wall_timer(1ms, exclusive_callback, exclusive_cbg));
+  }
+  executor.add_node(node);
+
+  std::thread spinner([&executor]() {executor.spin();});
+  auto start = std::chrono::steady_clock::now();
+  while ((reentrant_count < 20 || exclusive_count < 20) &&
+    (std::chrono::steady_clock::now() - start) < 10s)
+  {
+    std::this_thread::sleep_for(1ms);
+  }
+  executor.cancel();
+  spinner.join();
+
+  EXPECT_LE(20, reentrant_count.load());
+  EXPECT_LE(20, exclusive_count.load());
+  EXPECT_LT(1, max_reentrant_in_callback.load());
+  EXPECT_FALSE(exclusive_overlapped.load());
+}
+
+/*
+   Check that the entities added while a mutually exclusive group is executing are
+   executed, and that the groups of the executing entities are kept.
+ */
+TEST_F(TestStaticMultiThreadedExecutor, add_entities_while_executing) {
+  rclcpp::executors::StaticMultiThreadedExecutor executor(rclcpp::ExecutorOptions(), 2u);
+  auto node = std::make_shared<rclcpp::Node>("test_static_multi_threaded_executor_add");
+
+  std::atomic_int slow_count {0};
+  auto slow_timer = node->create_wall_timer(
+    1ms, [&slow_count]() {
+      std::this_thread::sleep_for(20ms);
+      ++slow_count;
+    });
+  executor.add_node(node);
+
+  std::thread spinner([&executor]() {executor.spin();});
+  auto start = std::chrono::steady_clock::now();
+  while (slow_count < 1 && (std::chrono::steady_clock::now() - start) < 10s) {
+    std::this_thread::sleep_for(1ms);
+  }
+
+  std::atomic_int message_count {0};
+  auto subscription = node->create_subscription<test_msgs::msg::Empty>(
+    "static_multi_threaded_topic", 10,
+    [&message_count](test_msgs::msg::Empty::ConstSharedPtr) {++message_count;});
+  auto publisher = node->create_publisher<test_msgs::msg::Empty>(
+    "static_multi_threaded_topic", 10);
+  const int slow_count_before = slow_count.load();
+  start = std::chrono::steady_clock::now();
+  while ((message_count < 1 || slow_count < slow_count_before + 2) &&
+    (std::chrono::steady_clock::now() - start) < 10s)
+  {
+    publisher->publish(test_msgs::msg::Empty());
+    std::this_thread::sleep_for(5ms);
+  }
+  executor.cancel();
+  spinner.join();
+
+  EXPECT_LE(1, message_count.load());
+  EXPECT_LE(slow_count_before + 2, slow_count.load());
+}
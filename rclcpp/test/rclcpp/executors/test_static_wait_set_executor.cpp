@@ -0,0 +1,119 @@
+// Copyright 2021 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+
+#include "rclcpp/executors/static_wait_set_executor.hpp"
+#include "rclcpp/rclcpp.hpp"
+
+#include "test_msgs/msg/empty.hpp"
+#include "test_msgs/srv/empty.hpp"
+
+using namespace std::chrono_literals;
+
+using TestExecutor = rclcpp::executors::StaticWaitSetExecutor<1, 0, 1, 1, 1, 0>;
+
+class TestStaticWaitSetExecutor : public ::testing::Test
+{
+public:
+  void SetUp()
+  {
+    rclcpp::init(0, nullptr);
+    node = std::make_shared<rclcpp::Node>("test_static_wait_set_executor");
+  }
+
+  void TearDown()
+  {
+    node.reset();
+    rclcpp::shutdown();
+  }
+
+  rclcpp::Node::SharedPtr node;
+};
+
+TEST_F(TestStaticWaitSetExecutor, construction) {
+  EXPECT_NO_THROW((rclcpp::executors::StaticWaitSetExecutor<0, 0, 0, 0, 0, 0>()));
+  // Every entity has to be given.
+  EXPECT_THROW(TestExecutor(), std::invalid_argument);
+
+  rclcpp::executors::StaticWaitSetExecutor<0, 0, 0, 0, 0, 0> executor;
+  EXPECT_THROW(executor.add_node(node), std::runtime_error);
+  EXPECT_THROW(
+    executor.add_callback_group(
+      node->create_callback_group(rclcpp::CallbackGroupType::MutuallyExclusive),
+      node->get_node_base_interface()),
+    std::runtime_error);
+}
+
+TEST_F(TestStaticWaitSetExecutor, execute_entities) {
+  size_t message_count = 0;
+  size_t timer_count = 0;
+  bool response_received = false;
+  auto subscription = node->create_subscription<test_msgs::msg::Empty>(
+    "topic", 10, [&message_count](test_msgs::msg::Empty::ConstSharedPtr) {++message_count;});
+  auto publisher = node->create_publisher<test_msgs::msg::Empty>("topic", 10);
+  auto timer = node->create_wall_timer(1ms, [&timer_count]() {++timer_count;});
+  auto service = node->create_service<test_msgs::srv::Empty>(
+    "service",
+    [](
+      const test_msgs::srv::Empty::Request::SharedPtr,
+      test_msgs::srv::Empty::Response::SharedPtr) {});
+  auto client = node->create_client<test_msgs::srv::Empty>("service");
+
+  TestExecutor executor({subscription}, {}, {timer}, {client}, {service}, {});
+
+  // The timer keeps firing while waiting for the other entities.
+  auto start = std::chrono::steady_clock::now();
+  while (timer_count < 2u && std::chrono::steady_clock::now() - start < 10s) {
+    executor.spin_once(100ms);
+  }
+  EXPECT_LE(2u, timer_count);
+
+  start = std::chrono::steady_clock::now();
+  while (message_count == 0u && std::chrono::steady_clock::now() - start < 10s) {
+    publisher->publish(test_msgs::msg::Empty());
+    executor.spin_once(100ms);
+  }
+  EXPECT_EQ(1u, message_count);
+
+  ASSERT_TRUE(client->wait_for_service(10s));
+  auto future = client->async_send_request(
+    std::make_shared<test_msgs::srv::Empty::Request>(),
+    [&response_received](rclcpp::Client<test_msgs::srv::Empty>::SharedFuture) {
+      response_received = true;
+    });
+  EXPECT_EQ(
+    rclcpp::FutureReturnCode::SUCCESS, executor.spin_until_future_complete(future, 10s));
+  EXPECT_TRUE(response_received);
+}
+
+TEST_F(TestStaticWaitSetExecutor, cancel_and_shutdown) {
+  auto timer = node->create_wall_timer(1h, []() {});
+  rclcpp::executors::StaticWaitSetExecutor<0, 0, 1, 0, 0, 0> executor({}, {}, {timer});
+
+  std::thread spin_thread([&executor]() {executor.spin();});
+  std::this_thread::sleep_for(50ms);
+  executor.cancel();
+  spin_thread.join();
+
+  spin_thread = std::thread([&executor]() {executor.spin();});
+  std::this_thread::sleep_for(50ms);
+  rclcpp::shutdown();
+  spin_thread.join();
+}
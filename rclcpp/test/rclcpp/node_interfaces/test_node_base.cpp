@@ -14,10 +14,14 @@
 
 #include <gtest/gtest.h>
 
+#include <chrono>
 #include <memory>
 #include <string>
+#include <thread>
+#include <vector>
 
 #include "rcl/node_options.h"
+#include "rcl_interfaces/msg/log.hpp"
 #include "rclcpp/node.hpp"
 #include "rclcpp/node_interfaces/node_base.hpp"
 #include "rclcpp/rclcpp.hpp"
@@ -191,3 +195,95 @@ TEST_F(TestNodeBase, construct_destruct_rcl_guard_condition_fini_error) {
 
   EXPECT_NO_THROW(std::make_shared<rclcpp::Node>("node", "ns").reset());
 }
+
+TEST_F(TestNodeBase, batched_rosout) {
+  auto options = rclcpp::NodeOptions()
+    .rosout_batch_period(std::chrono::milliseconds(100))
+    .rosout_max_batch_size(3);
+  auto node = std::make_shared<rclcpp::Node>("batching_node", "ns", options);
+  auto listener = std::make_shared<rclcpp::Node>("listener", "ns");
+
+  std::vector<rcl_interfaces::msg::Log> logs;
+  auto subscription = listener->create_subscription<rcl_interfaces::msg::Log>(
+    "/rosout", rclcpp::RosoutQoS(),
+    [&logs](rcl_interfaces::msg::Log::ConstSharedPtr log) {
+      if (log->name == "ns.batching_node") {
+        logs.push_back(*log);
+      }
+    });
+  rclcpp::executors::SingleThreadedExecutor executor;
+  executor.add_node(listener);
+  auto spin_until_logs = [&](size_t count) {
+      auto end = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+      while (logs.size() < count && std::chrono::steady_clock::now() < end) {
+        executor.spin_some(std::chrono::milliseconds(10));
+      }
+    };
+  // Wait for the subscription to match the publisher.
+  auto end = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+  while (subscription->get_publisher_count() == 0u && std::chrono::steady_clock::now() < end) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+
+  // A full batch is published right away.
+  RCLCPP_INFO(node->get_logger(), "first");
+  RCLCPP_INFO(node->get_logger(), "second");
+  RCLCPP_INFO(node->get_logger(), "third");
+  spin_until_logs(1u);
+  ASSERT_EQ(1u, logs.size());
+  EXPECT_EQ("first\nsecond\nthird", logs[0].msg);
+  EXPECT_EQ(rcl_interfaces::msg::Log::INFO, logs[0].level);
+
+  // A record of another severity starts another batch, published after the period.
+  RCLCPP_INFO(node->get_logger(), "fourth");
+  RCLCPP_WARN(node->get_logger(), "fifth");
+  spin_until_logs(3u);
+  ASSERT_EQ(3u, logs.size());
+  EXPECT_EQ("fourth", logs[1].msg);
+  EXPECT_EQ("fifth", logs[2].msg);
+  EXPECT_EQ(rcl_interfaces::msg::Log::WARN, logs[2].level);
+}
+
+TEST_F(TestNodeBase, shared_rcl_node_handle) {
+  auto host = std::make_shared<rclcpp::Node>("host");
+  auto rcl_node_handle = host->get_node_base_interface()->get_shared_rcl_node_handle();
+  auto options = rclcpp::NodeOptions().shared_rcl_node_handle(rcl_node_handle);
+  auto node = std::make_shared<rclcpp::Node>("node", "ns", options);
+  auto other_node = std::make_shared<rclcpp::Node>("other_node", options);
+
+  auto node_base = node->get_node_base_interface();
+  EXPECT_EQ(rcl_node_handle, node_base->get_shared_rcl_node_handle());
+  EXPECT_EQ(rcl_node_handle, other_node->get_node_base_interface()->get_shared_rcl_node_handle());
+  EXPECT_STREQ("node", node_base->get_name());
+  EXPECT_STREQ("/ns", node_base->get_namespace());
+  EXPECT_STREQ("/ns/node", node_base->get_fully_qualified_name());
+  EXPECT_STREQ("/other_node", other_node->get_fully_qualified_name());
+  EXPECT_STREQ("ns.node", node->get_logger().get_name());
+  EXPECT_STREQ("other_node", other_node->get_logger().get_name());
+
+  // The names are expanded with the name of the node, not the one of the rcl node.
+  EXPECT_EQ("/ns/node/chatter", node_base->resolve_topic_or_service_name("~/chatter", false));
+  auto publisher = node->create_publisher<rcl_interfaces::msg::Log>("~/chatter", 10);
+  EXPECT_STREQ("/ns/node/chatter", publisher->get_topic_name());
+  auto subscription = node->create_subscription<rcl_interfaces::msg::Log>(
+    "chatter", 10, [](rcl_interfaces::msg::Log::ConstSharedPtr) {});
+  EXPECT_STREQ("/ns/chatter", subscription->get_topic_name());
+  // The parameter services of the nodes do not clash.
+  EXPECT_TRUE(node->has_parameter("use_sim_time"));
+  EXPECT_TRUE(other_node->has_parameter("use_sim_time"));
+
+  EXPECT_THROW(
+    std::make_shared<rclcpp::Node>("invalid_node?", options).reset(),
+    rclcpp::exceptions::InvalidNodeNameError);
+  EXPECT_THROW(
+    std::make_shared<rclcpp::Node>("node", "invalid_ns?", options).reset(),
+    rclcpp::exceptions::InvalidNamespaceError);
+
+  auto other_context = std::make_shared<rclcpp::Context>();
+  other_context->init(0, nullptr);
+  EXPECT_THROW(
+    std::make_shared<rclcpp::Node>(
+      "node", rclcpp::NodeOptions(options).context(other_context)).reset(),
+    std::invalid_argument);
+  other_context->shutdown("done");
+}
@@ -17,6 +17,7 @@
 #include <functional>
 #include <memory>
 #include <string>
+#include <thread>
 #include <utility>
 #include <vector>
 
@@ -322,6 +323,50 @@ TEST_F(TestNodeGraph, wait_for_graph_change)
     rclcpp::exceptions::EventNotRegisteredError);
 }
 
+TEST_F(TestNodeGraph, wait_for_graph_predicate)
+{
+  auto node_graph_interface = node()->get_node_graph_interface();
+  EXPECT_THROW(
+    node_graph_interface->wait_for_graph_predicate(nullptr, std::chrono::milliseconds(1)),
+    std::invalid_argument);
+  EXPECT_TRUE(node_graph_interface->wait_for_graph_predicate([]() {return true;}, {}));
+  EXPECT_FALSE(
+    node_graph_interface->wait_for_graph_predicate(
+      []() {return false;}, std::chrono::milliseconds(10)));
+
+  // The waiting thread is only woken up once the predicate holds.
+  auto publisher = node()->create_publisher<test_msgs::msg::Empty>("predicate_topic", 1);
+  EXPECT_TRUE(
+    node_graph_interface->wait_for_graph_predicate(
+      [this]() {return node_graph()->count_publishers("predicate_topic") == 1u;},
+      std::chrono::seconds(5)));
+  auto subscription = node()->create_subscription<test_msgs::msg::Empty>(
+    "predicate_topic", 1, [](test_msgs::msg::Empty::ConstSharedPtr) {});
+  EXPECT_TRUE(
+    node_graph_interface->wait_for_graph_predicate(
+      [this]() {return node_graph()->count_subscribers("predicate_topic") == 1u;},
+      std::chrono::seconds(5)));
+
+  // Exceptions thrown by the predicate, in the graph listener or not, reach the waiting thread.
+  size_t calls = 0;
+  rclcpp::Publisher<test_msgs::msg::Empty>::SharedPtr other_publisher;
+  std::thread graph_changer([this, &other_publisher]() {
+      std::this_thread::sleep_for(std::chrono::milliseconds(100));
+      other_publisher = node()->create_publisher<test_msgs::msg::Empty>("other_topic", 1);
+    });
+  EXPECT_THROW(
+    node_graph_interface->wait_for_graph_predicate(
+      [&calls]() -> bool {
+        if (++calls > 2) {
+          throw std::runtime_error("predicate failed");
+        }
+        return false;
+      },
+      std::chrono::seconds(5)),
+    std::runtime_error);
+  graph_changer.join();
+}
+
 TEST_F(TestNodeGraph, notify_graph_change_rcl_error)
 {
   auto mock = mocking_utils::patch_and_return(
@@ -465,3 +510,36 @@ TEST_F(TestNodeGraph, get_info_by_topic_endpoint_info_array_fini_error)
     node_graph()->get_publishers_info_by_topic("topic", false),
     rclcpp::exceptions::RCLError);
 }
+
+TEST_F(TestNodeGraph, graph_cache)
+{
+  auto options = rclcpp::NodeOptions().use_graph_cache(true);
+  auto cached_node = std::make_shared<rclcpp::Node>("cached_node", node_namespace, options);
+  auto cached_node_graph = cached_node->get_node_graph_interface();
+  // The node is watched by the graph listener to invalidate the cache.
+  EXPECT_LE(1u, cached_node_graph->count_graph_users());
+
+  EXPECT_EQ(0u, cached_node_graph->count_publishers("topic"));
+  const auto topic_names_and_types = cached_node_graph->get_topic_names_and_types();
+  {
+    // Repeated queries are answered by the cache, without calling rcl.
+    auto mock_count = mocking_utils::patch_and_return(
+      "lib:rclcpp", rcl_count_publishers, RCL_RET_ERROR);
+    auto mock_names_and_types = mocking_utils::patch_and_return(
+      "lib:rclcpp", rcl_get_topic_names_and_types, RCL_RET_ERROR);
+    EXPECT_EQ(0u, cached_node_graph->count_publishers("topic"));
+    EXPECT_EQ(topic_names_and_types, cached_node_graph->get_topic_names_and_types());
+  }
+
+  // A graph change invalidates the cache.
+  const rclcpp::QoS publisher_qos(1);
+  auto publisher = node()->create_publisher<test_msgs::msg::Empty>("topic", publisher_qos);
+  auto event = cached_node_graph->get_graph_event();
+  size_t tries = 0;
+  while (cached_node_graph->count_publishers("topic") == 0u && tries++ < 10) {
+    cached_node_graph->wait_for_graph_change(event, std::chrono::milliseconds(100));
+    event->check_and_clear();
+  }
+  EXPECT_EQ(1u, cached_node_graph->count_publishers("topic"));
+  EXPECT_EQ(1u, node_graph()->count_publishers("topic"));
+}
@@ -21,10 +21,14 @@
 #include <gtest/gtest.h>
 
 #include <algorithm>
+#include <chrono>
+#include <map>
 #include <memory>
 #include <string>
+#include <thread>
 #include <vector>
 
+#include "rclcpp/executors.hpp"
 #include "rclcpp/node.hpp"
 #include "rclcpp/node_interfaces/node_parameters.hpp"
 
@@ -113,6 +117,32 @@ TEST_F(TestNodeParameters, list_parameters)
     list_result4.names.end());
 }
 
+TEST_F(TestNodeParameters, list_parameters_overlapping_prefixes)
+{
+  for (const std::string & name : {"a", "a.b", "a.b.c", "a.d", "ab", "ab.c", "b.a"}) {
+    node_parameters->declare_parameter(name, rclcpp::ParameterValue(1));
+  }
+
+  // The parameters under several prefixes are listed once, sorted by name
+  auto list_result = node_parameters->list_parameters({"a.b", "a", "ab"}, 2u);
+  EXPECT_EQ(
+    std::vector<std::string>({"a", "a.b", "a.b.c", "a.d", "ab", "ab.c"}), list_result.names);
+  EXPECT_EQ(std::vector<std::string>({"a", "a.b", "ab"}), list_result.prefixes);
+
+  list_result = node_parameters->list_parameters({"a"}, 1u);
+  EXPECT_EQ(std::vector<std::string>({"a", "a.b", "a.d"}), list_result.names);
+
+  std::map<std::string, rclcpp::Parameter> parameters;
+  EXPECT_TRUE(node_parameters->get_parameters_by_prefix("a", parameters));
+  EXPECT_EQ(3u, parameters.size());
+  EXPECT_EQ(1u, parameters.count("b"));
+  EXPECT_EQ(1u, parameters.count("b.c"));
+  EXPECT_EQ(1u, parameters.count("d"));
+  parameters.clear();
+  EXPECT_FALSE(node_parameters->get_parameters_by_prefix("c", parameters));
+  EXPECT_TRUE(parameters.empty());
+}
+
 TEST_F(TestNodeParameters, parameter_overrides)
 {
   rclcpp::NodeOptions node_options;
@@ -170,6 +200,143 @@ TEST_F(TestNodeParameters, set_parameters) {
   EXPECT_TRUE(result[0].successful);
 }
 
+TEST_F(TestNodeParameters, declare_parameters) {
+  rcl_interfaces::msg::ParameterDescriptor read_only_descriptor;
+  read_only_descriptor.read_only = true;
+  auto handle = node->get_parameter_handle("batch_parameter_b");
+  auto values = node_parameters->declare_parameters(
+  {
+    {rclcpp::Parameter("batch_parameter_a", 1), rcl_interfaces::msg::ParameterDescriptor()},
+    {rclcpp::Parameter("batch_parameter_b", "value"), read_only_descriptor},
+  });
+  ASSERT_EQ(2u, values.size());
+  EXPECT_EQ(1, values[0].get<int64_t>());
+  EXPECT_EQ("value", values[1].get<std::string>());
+  EXPECT_TRUE(node->has_parameter("batch_parameter_a"));
+  EXPECT_TRUE(node->describe_parameter("batch_parameter_b").read_only);
+  EXPECT_EQ("value", handle->get_value<std::string>());
+
+  // A failure undeclares the parameters declared before it in the batch
+  EXPECT_THROW(
+    node_parameters->declare_parameters(
+  {
+    {rclcpp::Parameter("batch_parameter_c", 3), rcl_interfaces::msg::ParameterDescriptor()},
+    {rclcpp::Parameter("batch_parameter_a", 1), rcl_interfaces::msg::ParameterDescriptor()},
+  }),
+    rclcpp::exceptions::ParameterAlreadyDeclaredException);
+  EXPECT_FALSE(node->has_parameter("batch_parameter_c"));
+  EXPECT_TRUE(node->has_parameter("batch_parameter_a"));
+
+  EXPECT_THROW(
+    node_parameters->declare_parameters(
+  {
+    {rclcpp::Parameter("batch_parameter_d", 4), rcl_interfaces::msg::ParameterDescriptor()},
+    {rclcpp::Parameter("batch_parameter_d", 4), rcl_interfaces::msg::ParameterDescriptor()},
+  }),
+    rclcpp::exceptions::ParameterAlreadyDeclaredException);
+  EXPECT_FALSE(node->has_parameter("batch_parameter_d"));
+}
+
+TEST_F(TestNodeParameters, coalesced_parameter_events) {
+  rclcpp::NodeOptions options;
+  options.parameter_event_coalescing_period(std::chrono::milliseconds(100));
+  auto coalescing_node = std::make_shared<rclcpp::Node>("coalescing_node", "ns", options);
+
+  std::vector<rcl_interfaces::msg::ParameterEvent> events;
+  auto subscription = node->create_subscription<rcl_interfaces::msg::ParameterEvent>(
+    "/parameter_events", rclcpp::ParameterEventsQoS(),
+    [&events](rcl_interfaces::msg::ParameterEvent::UniquePtr event) {
+      if (event->node == "/ns/coalescing_node") {
+        events.push_back(*event);
+      }
+    });
+
+  coalescing_node->declare_parameter("coalesced_a", 1);
+  coalescing_node->declare_parameter("coalesced_b", 1);
+  coalescing_node->set_parameter(rclcpp::Parameter("coalesced_a", 2));
+  coalescing_node->set_parameter(rclcpp::Parameter("coalesced_a", 3));
+
+  rclcpp::executors::SingleThreadedExecutor executor;
+  executor.add_node(node);
+  const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+  while (events.empty() && std::chrono::steady_clock::now() < deadline) {
+    executor.spin_some(std::chrono::milliseconds(10));
+  }
+  // No other event follows
+  const auto end = std::chrono::steady_clock::now() + std::chrono::milliseconds(200);
+  while (std::chrono::steady_clock::now() < end) {
+    executor.spin_some(std::chrono::milliseconds(10));
+  }
+
+  ASSERT_EQ(1u, events.size());
+  ASSERT_EQ(2u, events[0].new_parameters.size());
+  EXPECT_TRUE(events[0].changed_parameters.empty());
+  EXPECT_EQ("coalesced_b", events[0].new_parameters[0].name);
+  EXPECT_EQ("coalesced_a", events[0].new_parameters[1].name);
+  EXPECT_EQ(3, events[0].new_parameters[1].value.integer_value);
+}
+
+TEST_F(TestNodeParameters, parameter_handle) {
+  // A handle of a parameter not declared yet has no value
+  auto handle = node->get_parameter_handle("handled_parameter");
+  ASSERT_NE(nullptr, handle);
+  EXPECT_EQ("handled_parameter", handle->get_name());
+  EXPECT_EQ(rclcpp::PARAMETER_NOT_SET, handle->get_type());
+
+  node->declare_parameter("handled_parameter", 1);
+  EXPECT_EQ(1, handle->get_value<int64_t>());
+  EXPECT_EQ(handle, node->get_parameter_handle("handled_parameter"));
+  EXPECT_THROW(handle->get_value<std::string>(), rclcpp::ParameterTypeException);
+
+  auto result = node->set_parameter(rclcpp::Parameter("handled_parameter", 2));
+  EXPECT_TRUE(result.successful);
+  EXPECT_EQ(2, handle->get_value<int64_t>());
+  EXPECT_EQ(rclcpp::Parameter("handled_parameter", 2), handle->get_parameter());
+
+  // Rejected values are not published
+  auto callback_handle = node->add_on_set_parameters_callback(
+    [](const std::vector<rclcpp::Parameter> &) {
+      rcl_interfaces::msg::SetParametersResult result;
+      result.successful = false;
+      return result;
+    });
+  result = node->set_parameter(rclcpp::Parameter("handled_parameter", 3));
+  EXPECT_FALSE(result.successful);
+  EXPECT_EQ(2, handle->get_value<int64_t>());
+  callback_handle.reset();
+
+  // Implicitly declared and undeclared parameters
+  auto dynamic_handle = node->get_parameter_handle("dynamic_parameter");
+  result = node->set_parameter(rclcpp::Parameter("dynamic_parameter", "value"));
+  EXPECT_TRUE(result.successful);
+  EXPECT_EQ("value", dynamic_handle->get_value<std::string>());
+  node->undeclare_parameter("dynamic_parameter");
+  EXPECT_EQ(rclcpp::PARAMETER_NOT_SET, dynamic_handle->get_type());
+
+  // Readers see the values set concurrently
+  const int64_t last_value = 1000;
+  std::thread reader(
+    [handle, last_value]() {
+      int64_t value = 0;
+      while (value != last_value) {
+        const int64_t previous_value = value;
+        value = handle->get_value<int64_t>();
+        EXPECT_GE(value, previous_value);
+      }
+    });
+  for (int64_t value = 3; value <= last_value; ++value) {
+    node->set_parameter(rclcpp::Parameter("handled_parameter", value));
+  }
+  reader.join();
+
+  rclcpp::NodeOptions options;
+  options.allow_undeclared_parameters(false);
+  auto strict_node = std::make_shared<rclcpp::Node>("strict_node", "ns", options);
+  EXPECT_THROW(
+    strict_node->get_parameter_handle("undeclared_parameter"),
+    rclcpp::exceptions::ParameterNotDeclaredException);
+}
+
 TEST_F(TestNodeParameters, add_remove_parameters_callback) {
   rcl_interfaces::msg::ParameterDescriptor bool_descriptor;
   bool_descriptor.name = "bool_parameter";
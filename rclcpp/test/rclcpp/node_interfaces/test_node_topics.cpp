@@ -168,4 +168,12 @@ TEST_F(TestNodeTopics, resolve_topic_name)
   EXPECT_THROW(
     node_topics->resolve_topic_name("this is not a valid name!~>", true),
     rclcpp::exceptions::RCLError);
+
+  // Resolved again from the cache of the node, apart from the invalid names.
+  EXPECT_EQ("/ns/bar", node_topics->resolve_topic_name("foo", false));
+  EXPECT_EQ("/ns/foo", node_topics->resolve_topic_name("foo", true));
+  EXPECT_EQ("/foo", node_topics->resolve_topic_name("/foo", true));
+  EXPECT_THROW(
+    node_topics->resolve_topic_name("this is not a valid name!~>", true),
+    rclcpp::exceptions::RCLError);
 }
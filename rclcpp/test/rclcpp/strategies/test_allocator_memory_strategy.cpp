@@ -914,3 +914,135 @@ TEST_F(TestAllocatorMemoryStrategy, get_next_waitable_out_of_scope) {
   allocator_memory_strategy()->get_next_waitable(result, weak_groups_to_nodes);
   EXPECT_EQ(nullptr, result.node_base);
 }
+
+TEST_F(TestAllocatorMemoryStrategy, restore_collected_handles_without_cache) {
+  EXPECT_FALSE(allocator_memory_strategy()->restore_collected_handles());
+  EXPECT_EQ(0u, allocator_memory_strategy()->number_of_ready_timers());
+}
+
+TEST_F(TestAllocatorMemoryStrategy, cache_and_restore_collected_handles) {
+  auto node = create_node_with_timer("timer_node");
+  WeakCallbackGroupsToNodesMap weak_groups_to_nodes;
+  node->for_each_callback_group(
+    [node, &weak_groups_to_nodes](rclcpp::CallbackGroup::SharedPtr group_ptr)
+    {
+      weak_groups_to_nodes.insert(
+        std::pair<rclcpp::CallbackGroup::WeakPtr,
+        rclcpp::node_interfaces::NodeBaseInterface::WeakPtr>(
+          group_ptr,
+          node->get_node_base_interface()));
+    });
+  allocator_memory_strategy()->collect_entities(weak_groups_to_nodes);
+  allocator_memory_strategy()->cache_collected_handles();
+  EXPECT_EQ(1u, allocator_memory_strategy()->number_of_ready_timers());
+
+  allocator_memory_strategy()->clear_handles();
+  EXPECT_EQ(0u, allocator_memory_strategy()->number_of_ready_timers());
+
+  // Handles can be restored as many times as needed without collecting again
+  for (size_t i = 0; i < 2u; ++i) {
+    EXPECT_TRUE(allocator_memory_strategy()->restore_collected_handles());
+    EXPECT_EQ(1u, allocator_memory_strategy()->number_of_ready_timers());
+  }
+}
+
+TEST_F(TestAllocatorMemoryStrategy, restore_collected_handles_entity_out_of_scope) {
+  auto node = create_node_with_disabled_callback_groups("node");
+  WeakCallbackGroupsToNodesMap weak_groups_to_nodes;
+  auto callback_group =
+    node->create_callback_group(
+    rclcpp::CallbackGroupType::MutuallyExclusive);
+  weak_groups_to_nodes.insert(
+    std::pair<rclcpp::CallbackGroup::WeakPtr,
+    rclcpp::node_interfaces::NodeBaseInterface::WeakPtr>(
+      callback_group,
+      node->get_node_base_interface()));
+  {
+    auto timer = node->create_wall_timer(
+      std::chrono::milliseconds(1), []() {}, callback_group);
+    allocator_memory_strategy()->collect_entities(weak_groups_to_nodes);
+    allocator_memory_strategy()->cache_collected_handles();
+    allocator_memory_strategy()->clear_handles();
+  }
+
+  // The cache does not keep the timer alive, so it can't be restored anymore
+  EXPECT_FALSE(allocator_memory_strategy()->restore_collected_handles());
+  EXPECT_EQ(0u, allocator_memory_strategy()->number_of_ready_timers());
+  EXPECT_FALSE(allocator_memory_strategy()->restore_collected_handles());
+}
+
+TEST_F(TestAllocatorMemoryStrategy, get_next_timer_indexed_group_removed) {
+  auto node = create_node_with_disabled_callback_groups("node");
+  auto callback_group =
+    node->create_callback_group(
+    rclcpp::CallbackGroupType::MutuallyExclusive);
+  auto timer = node->create_wall_timer(
+    std::chrono::milliseconds(1), []() {}, callback_group);
+  WeakCallbackGroupsToNodesMap weak_groups_to_nodes;
+  weak_groups_to_nodes.insert(
+    std::pair<rclcpp::CallbackGroup::WeakPtr,
+    rclcpp::node_interfaces::NodeBaseInterface::WeakPtr>(
+      callback_group,
+      node->get_node_base_interface()));
+
+  // The timer is found through the index built by the collection
+  allocator_memory_strategy()->collect_entities(weak_groups_to_nodes);
+  rclcpp::AnyExecutable result;
+  allocator_memory_strategy()->get_next_timer(result, weak_groups_to_nodes);
+  EXPECT_EQ(timer, result.timer);
+  EXPECT_EQ(callback_group, result.callback_group);
+  EXPECT_EQ(node->get_node_base_interface(), result.node_base);
+
+  // A group removed from the map since the collection is no longer valid
+  allocator_memory_strategy()->clear_handles();
+  allocator_memory_strategy()->collect_entities(weak_groups_to_nodes);
+  EXPECT_EQ(1u, allocator_memory_strategy()->number_of_ready_timers());
+  WeakCallbackGroupsToNodesMap empty_map;
+  rclcpp::AnyExecutable no_result;
+  allocator_memory_strategy()->get_next_timer(no_result, empty_map);
+  EXPECT_EQ(nullptr, no_result.timer);
+  EXPECT_EQ(0u, allocator_memory_strategy()->number_of_ready_timers());
+}
+
+TEST_F(TestAllocatorMemoryStrategy, remove_null_handles_keeps_ready_handles_in_order) {
+  auto node = create_node_with_disabled_callback_groups("node");
+  auto callback_group =
+    node->create_callback_group(
+    rclcpp::CallbackGroupType::MutuallyExclusive);
+  auto timer1 = node->create_wall_timer(
+    std::chrono::milliseconds(1), []() {}, callback_group);
+  auto timer2 = node->create_wall_timer(
+    std::chrono::milliseconds(1), []() {}, callback_group);
+  WeakCallbackGroupsToNodesMap weak_groups_to_nodes;
+  weak_groups_to_nodes.insert(
+    std::pair<rclcpp::CallbackGroup::WeakPtr,
+    rclcpp::node_interfaces::NodeBaseInterface::WeakPtr>(
+      callback_group,
+      node->get_node_base_interface()));
+  allocator_memory_strategy()->collect_entities(weak_groups_to_nodes);
+  EXPECT_EQ(2u, allocator_memory_strategy()->number_of_ready_timers());
+
+  rcl_wait_set_t wait_set = rcl_get_zero_initialized_wait_set();
+  ASSERT_EQ(
+    RCL_RET_OK,
+    rcl_wait_set_init(
+      &wait_set, 0, 0, 2, 0, 0, 0,
+      node->get_node_base_interface()->get_context()->get_rcl_context().get(),
+      rcl_get_default_allocator()));
+  RCPPUTILS_SCOPE_EXIT(
+  {
+    EXPECT_EQ(RCL_RET_OK, rcl_wait_set_fini(&wait_set));
+  });
+  ASSERT_TRUE(allocator_memory_strategy()->add_handles_to_wait_set(&wait_set));
+
+  // Only the second timer is ready
+  wait_set.timers[0] = nullptr;
+  allocator_memory_strategy()->remove_null_handles(&wait_set);
+  EXPECT_EQ(1u, allocator_memory_strategy()->number_of_ready_timers());
+
+  rclcpp::AnyExecutable result;
+  allocator_memory_strategy()->get_next_timer(result, weak_groups_to_nodes);
+  EXPECT_EQ(timer2, result.timer);
+  EXPECT_EQ(callback_group, result.callback_group);
+  EXPECT_EQ(0u, allocator_memory_strategy()->number_of_ready_timers());
+}
@@ -0,0 +1,129 @@
+// Copyright 2021 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "rclcpp/strategies/concurrent_message_pool_memory_strategy.hpp"
+#include "test_msgs/msg/unbounded_sequences.hpp"
+
+using rclcpp::strategies::concurrent_message_pool_memory_strategy::
+ConcurrentMessagePoolMemoryStrategy;
+using test_msgs::msg::UnboundedSequences;
+
+TEST(TestConcurrentMessagePoolMemoryStrategy, borrow_return) {
+  ConcurrentMessagePoolMemoryStrategy<UnboundedSequences, 2> strategy;
+  auto first = strategy.borrow_message();
+  auto second = strategy.borrow_message();
+  ASSERT_NE(nullptr, first);
+  ASSERT_NE(nullptr, second);
+  EXPECT_NE(first, second);
+  auto * first_pointer = first.get();
+
+  // Any returned message can be borrowed again, whatever the order.
+  strategy.return_message(first);
+  EXPECT_EQ(nullptr, first);
+  auto third = strategy.borrow_message();
+  EXPECT_EQ(first_pointer, third.get());
+
+  strategy.return_message(second);
+  strategy.return_message(third);
+}
+
+TEST(TestConcurrentMessagePoolMemoryStrategy, borrow_too_many) {
+  ConcurrentMessagePoolMemoryStrategy<UnboundedSequences, 1> strategy;
+  auto message = strategy.borrow_message();
+  // The pool is empty, the message is allocated.
+  auto allocated_message = strategy.borrow_message();
+  ASSERT_NE(nullptr, allocated_message);
+  EXPECT_NE(message, allocated_message);
+
+  strategy.return_message(allocated_message);
+  EXPECT_EQ(nullptr, allocated_message);
+  auto * pointer = message.get();
+  strategy.return_message(message);
+  EXPECT_EQ(pointer, strategy.borrow_message().get());
+}
+
+TEST(TestConcurrentMessagePoolMemoryStrategy, referenced_message_is_not_reused) {
+  ConcurrentMessagePoolMemoryStrategy<UnboundedSequences, 1> strategy;
+  auto message = strategy.borrow_message();
+  auto kept_message = message;
+  strategy.return_message(message);
+
+  auto other_message = strategy.borrow_message();
+  EXPECT_NE(kept_message, other_message);
+  strategy.return_message(other_message);
+
+  // Borrowed again once released.
+  auto * pointer = kept_message.get();
+  kept_message.reset();
+  EXPECT_EQ(pointer, strategy.borrow_message().get());
+}
+
+TEST(TestConcurrentMessagePoolMemoryStrategy, reserved_sequences) {
+  ConcurrentMessagePoolMemoryStrategy<UnboundedSequences, 2> strategy(
+    [](UnboundedSequences & message) {
+      message.int32_values.reserve(1024);
+    });
+  auto message = strategy.borrow_message();
+  EXPECT_GE(message->int32_values.capacity(), 1024u);
+  const auto * data = message->int32_values.data();
+
+  message->int32_values.resize(512);
+  strategy.return_message(message);
+  message = strategy.borrow_message();
+  // The message is not reset, the sequence keeps its memory.
+  EXPECT_EQ(data, message->int32_values.data());
+  strategy.return_message(message);
+}
+
+TEST(TestConcurrentMessagePoolMemoryStrategy, concurrent_borrow_return) {
+  constexpr size_t thread_count = 4;
+  auto strategy =
+    std::make_shared<ConcurrentMessagePoolMemoryStrategy<UnboundedSequences, thread_count>>();
+  std::atomic<size_t> errors(0);
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < thread_count; ++i) {
+    threads.emplace_back(
+      [strategy, &errors, i]() {
+        for (int32_t j = 0; j < 10000; ++j) {
+          auto message = strategy->borrow_message();
+          // Nobody else uses the message.
+          message->int32_values.assign(1, static_cast<int32_t>(i));
+          std::this_thread::yield();
+          if (message->int32_values.size() != 1 || message->int32_values[0] != int32_t(i)) {
+            ++errors;
+          }
+          strategy->return_message(message);
+        }
+      });
+  }
+  for (auto & thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(0u, errors.load());
+}
+
+TEST(TestConcurrentMessagePoolMemoryStrategy, message_outlives_strategy) {
+  auto strategy = std::make_shared<ConcurrentMessagePoolMemoryStrategy<UnboundedSequences, 1>>();
+  auto message = strategy->borrow_message();
+  strategy.reset();
+  message->int32_values.push_back(1);
+  EXPECT_EQ(1u, message->int32_values.size());
+}
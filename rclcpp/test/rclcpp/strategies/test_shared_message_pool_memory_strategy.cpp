@@ -0,0 +1,105 @@
+// Copyright 2021 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <atomic>
+#include <memory>
+#include <set>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "rclcpp/strategies/shared_message_pool_memory_strategy.hpp"
+#include "test_msgs/msg/unbounded_sequences.hpp"
+
+using rclcpp::strategies::shared_message_pool_memory_strategy::SharedMessagePoolMemoryStrategy;
+using test_msgs::msg::UnboundedSequences;
+
+TEST(TestSharedMessagePoolMemoryStrategy, construction) {
+  EXPECT_THROW(SharedMessagePoolMemoryStrategy<UnboundedSequences>(0), std::invalid_argument);
+  SharedMessagePoolMemoryStrategy<UnboundedSequences> strategy(3);
+  EXPECT_EQ(3u, strategy.get_pool_size());
+}
+
+TEST(TestSharedMessagePoolMemoryStrategy, borrow_return) {
+  SharedMessagePoolMemoryStrategy<UnboundedSequences> strategy(2);
+  auto first = strategy.borrow_message();
+  auto second = strategy.borrow_message();
+  ASSERT_NE(nullptr, first);
+  ASSERT_NE(nullptr, second);
+  EXPECT_NE(first, second);
+  std::set<UnboundedSequences *> pooled_messages{first.get(), second.get()};
+
+  // The pool is empty, the message is allocated.
+  auto allocated_message = strategy.borrow_message();
+  EXPECT_EQ(0u, pooled_messages.count(allocated_message.get()));
+  strategy.return_message(allocated_message);
+  EXPECT_EQ(nullptr, allocated_message);
+
+  // Returned messages are borrowed again.
+  strategy.return_message(first);
+  strategy.return_message(second);
+  for (size_t i = 0; i < 10; ++i) {
+    auto message = strategy.borrow_message();
+    EXPECT_EQ(1u, pooled_messages.count(message.get()));
+    strategy.return_message(message);
+  }
+}
+
+TEST(TestSharedMessagePoolMemoryStrategy, referenced_message_is_not_reused) {
+  SharedMessagePoolMemoryStrategy<UnboundedSequences> strategy(1);
+  auto message = strategy.borrow_message();
+  message->int32_values.reserve(100);
+  auto kept_message = message;
+  strategy.return_message(message);
+
+  auto other_message = strategy.borrow_message();
+  EXPECT_NE(kept_message, other_message);
+  strategy.return_message(other_message);
+
+  // Borrowed again once released, with the capacity of its sequences.
+  auto * pointer = kept_message.get();
+  kept_message.reset();
+  auto reused_message = strategy.borrow_message();
+  EXPECT_EQ(pointer, reused_message.get());
+  EXPECT_LE(100u, reused_message->int32_values.capacity());
+}
+
+TEST(TestSharedMessagePoolMemoryStrategy, concurrent_borrow_return) {
+  SharedMessagePoolMemoryStrategy<UnboundedSequences> strategy(4);
+  std::atomic<bool> shared_message{false};
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < 4; ++i) {
+    threads.emplace_back(
+      [&strategy, &shared_message, i]() {
+        for (int32_t j = 0; j < 1000; ++j) {
+          auto message = strategy.borrow_message();
+          message->int32_values.assign(1, static_cast<int32_t>(i) * 1000 + j);
+          std::this_thread::yield();
+          // No other thread borrowed the same message meanwhile.
+          if (message->int32_values.size() != 1 ||
+            message->int32_values[0] != static_cast<int32_t>(i) * 1000 + j)
+          {
+            shared_message = true;
+          }
+          strategy.return_message(message);
+        }
+      });
+  }
+  for (auto & thread : threads) {
+    thread.join();
+  }
+  EXPECT_FALSE(shared_message);
+}
@@ -0,0 +1,101 @@
+// Copyright 2021 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+
+#include "rclcpp/detail/adaptive_busy_poll.hpp"
+#include "rclcpp/rclcpp.hpp"
+
+using namespace std::chrono_literals;
+using rclcpp::detail::AdaptiveBusyPoll;
+
+TEST(TestAdaptiveBusyPoll, disabled) {
+  AdaptiveBusyPoll busy_poll;
+  EXPECT_FALSE(busy_poll.is_enabled());
+  EXPECT_EQ(0ns, busy_poll.get_budget());
+  busy_poll.record_wait(1us);
+  EXPECT_EQ(0ns, busy_poll.get_budget());
+
+  EXPECT_FALSE(AdaptiveBusyPoll(-1us).is_enabled());
+}
+
+TEST(TestAdaptiveBusyPoll, adapt_to_arrivals) {
+  AdaptiveBusyPoll busy_poll(10us);
+  EXPECT_TRUE(busy_poll.is_enabled());
+  EXPECT_EQ(10us, busy_poll.get_max_budget());
+  // The whole budget is polled until waits are measured.
+  EXPECT_EQ(10us, busy_poll.get_budget());
+
+  for (int i = 0; i < 100; ++i) {
+    busy_poll.record_wait(5us);
+  }
+  EXPECT_EQ(10us, busy_poll.get_budget());
+
+  // Work arriving twice later than the budget halves it.
+  for (int i = 0; i < 100; ++i) {
+    busy_poll.record_wait(20us);
+  }
+  EXPECT_NEAR(20000, busy_poll.get_average_wait().count(), 10);
+  EXPECT_NEAR(5000, busy_poll.get_budget().count(), 10);
+
+  // An idle executor stops polling.
+  for (int i = 0; i < 100; ++i) {
+    busy_poll.record_wait(1s);
+  }
+  EXPECT_EQ(0ns, busy_poll.get_budget());
+
+  // And polls again once work comes in quickly.
+  for (int i = 0; i < 200; ++i) {
+    busy_poll.record_wait(1us);
+  }
+  EXPECT_EQ(10us, busy_poll.get_budget());
+}
+
+TEST(TestAdaptiveBusyPoll, executor_option) {
+  rclcpp::init(0, nullptr);
+  {
+    rclcpp::ExecutorOptions options;
+    options.busy_poll_budget = 100us;
+    rclcpp::executors::SingleThreadedExecutor executor(options);
+    auto node = std::make_shared<rclcpp::Node>("test_adaptive_busy_poll");
+    std::atomic_int count {0};
+    auto timer = node->create_wall_timer(
+      1ms, [&count, &executor]() {
+        if (++count == 10) {
+          executor.cancel();
+        }
+      });
+    executor.add_node(node);
+    executor.spin();
+    EXPECT_EQ(10, count.load());
+  }
+  {
+    // The timeouts are still honored while polling.
+    rclcpp::ExecutorOptions options;
+    options.busy_poll_budget = 1ms;
+    rclcpp::executors::SingleThreadedExecutor executor(options);
+    auto node = std::make_shared<rclcpp::Node>("test_adaptive_busy_poll_timeout");
+    executor.add_node(node);
+    // Waking up for the node added first.
+    executor.spin_once(0ns);
+    auto start = std::chrono::steady_clock::now();
+    executor.spin_once(10ms);
+    EXPECT_LE(10ms, std::chrono::steady_clock::now() - start);
+  }
+  rclcpp::shutdown();
+}
@@ -15,6 +15,7 @@
 #include <gtest/gtest.h>
 
 #include <chrono>
+#include <cstdint>
 #include <map>
 #include <memory>
 #include <string>
@@ -297,3 +298,43 @@ TYPED_TEST(TestAddCallbackGroupsToExecutor, remove_callback_group)
     executor.remove_callback_group(cb_grp),
     std::exception);
 }
+
+/*
+ * Test that the version of the entities of a callback group changes with them.
+ */
+TEST_F(TestAddCallbackGroupsToExecutor, entities_version)
+{
+  auto node = std::make_shared<rclcpp::Node>("my_node", "/ns");
+  rclcpp::CallbackGroup::SharedPtr cb_grp = node->create_callback_group(
+    rclcpp::CallbackGroupType::MutuallyExclusive);
+  const uint64_t initial_version = cb_grp->get_entities_version();
+  EXPECT_EQ(initial_version, cb_grp->get_entities_version());
+
+  rclcpp::TimerBase::SharedPtr timer = node->create_wall_timer(2s, []() {}, cb_grp);
+  const uint64_t timer_version = cb_grp->get_entities_version();
+  EXPECT_NE(initial_version, timer_version);
+  EXPECT_EQ(
+    timer,
+    cb_grp->find_timer_ptrs_if(
+      [](const rclcpp::TimerBase::SharedPtr &) {return true;}));
+
+  auto waitable = std::make_shared<rclcpp::QOSEventHandlerGroup>();
+  node->get_node_waitables_interface()->add_waitable(waitable, cb_grp);
+  const uint64_t waitable_version = cb_grp->get_entities_version();
+  EXPECT_NE(timer_version, waitable_version);
+  node->get_node_waitables_interface()->remove_waitable(waitable, cb_grp);
+  EXPECT_NE(waitable_version, cb_grp->get_entities_version());
+  EXPECT_EQ(
+    nullptr,
+    cb_grp->find_waitable_ptrs_if(
+      [](const rclcpp::Waitable::SharedPtr &) {return true;}));
+
+  // Destroying an entity does not change the version, it is no longer found.
+  const uint64_t version = cb_grp->get_entities_version();
+  timer.reset();
+  EXPECT_EQ(version, cb_grp->get_entities_version());
+  EXPECT_EQ(
+    nullptr,
+    cb_grp->find_timer_ptrs_if(
+      [](const rclcpp::TimerBase::SharedPtr &) {return true;}));
+}
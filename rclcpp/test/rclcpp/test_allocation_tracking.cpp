@@ -0,0 +1,174 @@
+// Copyright 2021 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "rclcpp/allocation_tracking.hpp"
+#include "rclcpp/allocator/allocator_common.hpp"
+#include "rclcpp/rclcpp.hpp"
+
+// This test is the only source file of its program.
+#include "rclcpp/allocation_tracking_global_operator_new.hpp"
+
+using namespace std::chrono_literals;
+
+namespace allocation_tracking = rclcpp::allocation_tracking;
+
+class TestAllocationTracking : public ::testing::Test
+{
+protected:
+  void TearDown() override
+  {
+    allocation_tracking::disable();
+    allocation_tracking::reset();
+  }
+};
+
+const allocation_tracking::CallbackAllocations *
+find_callback(
+  const std::vector<allocation_tracking::CallbackAllocations> & allocations,
+  const std::string & callback)
+{
+  for (const auto & callback_allocations : allocations) {
+    if (callback_allocations.callback == callback) {
+      return &callback_allocations;
+    }
+  }
+  return nullptr;
+}
+
+TEST_F(TestAllocationTracking, disabled_by_default) {
+  EXPECT_FALSE(allocation_tracking::is_enabled());
+  {
+    allocation_tracking::CallbackScope scope("timer");
+    auto value = std::make_unique<int>(42);
+    (void)value;
+  }
+  EXPECT_EQ(0u, allocation_tracking::get_allocation_count());
+  EXPECT_TRUE(allocation_tracking::get_callback_allocations().empty());
+}
+
+TEST_F(TestAllocationTracking, only_callbacks_are_tracked) {
+  allocation_tracking::enable();
+  EXPECT_TRUE(allocation_tracking::is_enabled());
+  auto outside = std::make_unique<int>(1);
+  EXPECT_EQ(0u, allocation_tracking::get_allocation_count());
+  {
+    allocation_tracking::CallbackScope scope("subscription", "/chatter");
+    auto inside = std::make_unique<int>(2);
+    (void)inside;
+  }
+  EXPECT_EQ(1u, allocation_tracking::get_allocation_count());
+  auto allocations = allocation_tracking::get_callback_allocations();
+  ASSERT_EQ(1u, allocations.size());
+  EXPECT_EQ("subscription /chatter", allocations[0].callback);
+  EXPECT_EQ(1u, allocations[0].allocation_count);
+  EXPECT_EQ(sizeof(int), allocations[0].allocated_bytes);
+  EXPECT_TRUE(allocations[0].backtraces.empty());
+
+  allocation_tracking::reset();
+  EXPECT_EQ(0u, allocation_tracking::get_allocation_count());
+  EXPECT_TRUE(allocation_tracking::get_callback_allocations().empty());
+}
+
+TEST_F(TestAllocationTracking, nested_scopes) {
+  allocation_tracking::enable();
+  {
+    allocation_tracking::CallbackScope outer("service", "/add");
+    {
+      allocation_tracking::CallbackScope inner("timer");
+      auto value = std::make_unique<int>(1);
+      (void)value;
+    }
+    auto value = std::make_unique<double>(2.0);
+    (void)value;
+  }
+  auto allocations = allocation_tracking::get_callback_allocations();
+  ASSERT_EQ(2u, allocations.size());
+  auto service = find_callback(allocations, "service /add");
+  ASSERT_NE(nullptr, service);
+  EXPECT_EQ(sizeof(double), service->allocated_bytes);
+  auto timer = find_callback(allocations, "timer");
+  ASSERT_NE(nullptr, timer);
+  EXPECT_EQ(sizeof(int), timer->allocated_bytes);
+}
+
+TEST_F(TestAllocationTracking, backtraces) {
+  allocation_tracking::enable({true, 2});
+  {
+    allocation_tracking::CallbackScope scope("timer");
+    for (int i = 0; i < 4; ++i) {
+      auto value = std::make_unique<int>(i);
+      (void)value;
+    }
+  }
+  auto allocations = allocation_tracking::get_callback_allocations();
+  ASSERT_EQ(1u, allocations.size());
+  EXPECT_EQ(4u, allocations[0].allocation_count);
+  ASSERT_EQ(2u, allocations[0].backtraces.size());
+  if (!allocations[0].backtraces[0].empty()) {
+    EXPECT_FALSE(allocation_tracking::format_backtrace(allocations[0].backtraces[0]).empty());
+  }
+}
+
+TEST_F(TestAllocationTracking, rcl_allocator_is_tracked_once) {
+  std::allocator<char> allocator;
+  rcl_allocator_t rcl_allocator = rclcpp::allocator::get_rcl_allocator<char>(allocator);
+  allocation_tracking::enable();
+  {
+    allocation_tracking::CallbackScope scope("client", "/add");
+    void * pointer = rcl_allocator.allocate(64, rcl_allocator.state);
+    rcl_allocator.deallocate(pointer, rcl_allocator.state);
+  }
+  auto allocations = allocation_tracking::get_callback_allocations();
+  ASSERT_EQ(1u, allocations.size());
+  EXPECT_EQ(1u, allocations[0].allocation_count);
+  EXPECT_EQ(64u, allocations[0].allocated_bytes);
+}
+
+TEST_F(TestAllocationTracking, executor_callbacks) {
+  rclcpp::InitOptions init_options;
+  init_options.allocation_tracking({true, 0});
+  rclcpp::init(0, nullptr, init_options);
+  EXPECT_TRUE(allocation_tracking::is_enabled());
+  {
+    auto node = std::make_shared<rclcpp::Node>("test_allocation_tracking");
+    rclcpp::executors::SingleThreadedExecutor executor;
+    bool called = false;
+    std::unique_ptr<std::string> kept;
+    auto timer = node->create_wall_timer(
+      1ms, [&]() {
+        called = true;
+        kept = std::make_unique<std::string>("allocated in a callback");
+      });
+    executor.add_node(node);
+    const auto deadline = std::chrono::steady_clock::now() + 10s;
+    while (!called && std::chrono::steady_clock::now() < deadline) {
+      executor.spin_once(10ms);
+    }
+    EXPECT_TRUE(called);
+    executor.remove_node(node);
+  }
+  rclcpp::shutdown();
+
+  auto allocations = allocation_tracking::get_callback_allocations();
+  auto timer = find_callback(allocations, "timer");
+  ASSERT_NE(nullptr, timer);
+  EXPECT_LE(1u, timer->allocation_count);
+}
@@ -20,6 +20,7 @@
 #include <functional>
 #include <memory>
 #include <utility>
+#include <vector>
 
 #include "rclcpp/any_service_callback.hpp"
 #include "rclcpp/service.hpp"
@@ -107,3 +108,25 @@ TEST_F(TestAnyServiceCallback, set_and_dispatch_defered_with_service_handle) {
     EXPECT_EQ(nullptr, any_service_callback_.dispatch(nullptr, request_header_, request_)));
   EXPECT_EQ(callback_with_header_calls, 1);
 }
+
+TEST_F(TestAnyServiceCallback, set_and_dispatch_batch) {
+  int callback_calls = 0;
+  auto callback =
+    [&callback_calls](const std::vector<std::shared_ptr<test_msgs::srv::Empty::Request>> & requests,
+      std::vector<std::shared_ptr<test_msgs::srv::Empty::Response>> & responses) {
+      EXPECT_EQ(requests.size(), responses.size());
+      callback_calls++;
+    };
+
+  any_service_callback_.set(callback);
+  EXPECT_TRUE(any_service_callback_.is_batch_callback());
+  // A single request is given to the callback in a batch of one.
+  EXPECT_NO_THROW(
+    EXPECT_NE(nullptr, any_service_callback_.dispatch(nullptr, request_header_, request_)));
+  EXPECT_EQ(callback_calls, 1);
+
+  std::vector<std::shared_ptr<test_msgs::srv::Empty::Request>> requests{request_, request_};
+  std::vector<std::shared_ptr<test_msgs::srv::Empty::Response>> responses{response_, response_};
+  any_service_callback_.dispatch_batch(requests, responses);
+  EXPECT_EQ(callback_calls, 2);
+}
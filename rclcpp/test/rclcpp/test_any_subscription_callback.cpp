@@ -91,6 +91,23 @@ TEST_F(TestAnySubscriptionCallback, unset_dispatch_throw) {
     std::runtime_error);
 }
 
+TEST_F(TestAnySubscriptionCallback, use_take_shared_method) {
+  // Callbacks which only read the message share it.
+  any_subscription_callback_.set([](const test_msgs::msg::Empty &) {});
+  EXPECT_TRUE(any_subscription_callback_.use_take_shared_method());
+  any_subscription_callback_.set(
+    [](const test_msgs::msg::Empty &, const rclcpp::MessageInfo &) {});
+  EXPECT_TRUE(any_subscription_callback_.use_take_shared_method());
+  any_subscription_callback_.set([](std::shared_ptr<const test_msgs::msg::Empty>) {});
+  EXPECT_TRUE(any_subscription_callback_.use_take_shared_method());
+
+  // Callbacks which may modify the message own it.
+  any_subscription_callback_.set([](std::unique_ptr<test_msgs::msg::Empty>) {});
+  EXPECT_FALSE(any_subscription_callback_.use_take_shared_method());
+  any_subscription_callback_.set([](std::shared_ptr<test_msgs::msg::Empty>) {});
+  EXPECT_FALSE(any_subscription_callback_.use_take_shared_method());
+}
+
 //
 // Parameterized test to test across all callback types and dispatch types.
 //
@@ -620,3 +637,61 @@ INSTANTIATE_TEST_SUITE_P(
   ),
   format_parameter_with_ta
 );
+
+// Type adapter whose custom type wraps the ROS message instead of converting it.
+struct WrappedEmpty
+{
+  std::shared_ptr<const test_msgs::msg::Empty> ros_message;
+};
+
+template<>
+struct rclcpp::TypeAdapter<WrappedEmpty, test_msgs::msg::Empty>
+{
+  using is_specialized = std::true_type;
+  using custom_type = WrappedEmpty;
+  using ros_message_type = test_msgs::msg::Empty;
+
+  static
+  void
+  convert_to_ros_message(const custom_type &, ros_message_type &)
+  {}
+
+  static
+  void
+  convert_to_custom(const ros_message_type &, custom_type &)
+  {}
+
+  static
+  std::shared_ptr<const custom_type>
+  wrap_ros_message(std::shared_ptr<const ros_message_type> ros_message)
+  {
+    return std::make_shared<const custom_type>(custom_type{std::move(ros_message)});
+  }
+};
+
+using WrappingTA = rclcpp::TypeAdapter<WrappedEmpty, test_msgs::msg::Empty>;
+
+TEST_F(TestAnySubscriptionCallback, wrap_ros_message) {
+  const test_msgs::msg::Empty * received = nullptr;
+
+  rclcpp::AnySubscriptionCallback<WrappingTA> const_ref_callback;
+  const_ref_callback.set(
+    [&received](const WrappedEmpty & msg) {received = msg.ros_message.get();});
+  const_ref_callback.dispatch(msg_shared_ptr_, message_info_);
+  EXPECT_EQ(msg_shared_ptr_.get(), received);
+
+  received = nullptr;
+  rclcpp::AnySubscriptionCallback<WrappingTA> shared_const_callback;
+  shared_const_callback.set(
+    [&received](std::shared_ptr<const WrappedEmpty> msg) {received = msg->ros_message.get();});
+  shared_const_callback.dispatch_intra_process(msg_shared_ptr_, message_info_);
+  EXPECT_EQ(msg_shared_ptr_.get(), received);
+
+  // Callbacks which own the message still get a converted copy.
+  received = nullptr;
+  rclcpp::AnySubscriptionCallback<WrappingTA> unique_callback;
+  unique_callback.set(
+    [&received](std::unique_ptr<WrappedEmpty> msg) {received = msg->ros_message.get();});
+  unique_callback.dispatch(msg_shared_ptr_, message_info_);
+  EXPECT_EQ(nullptr, received);
+}
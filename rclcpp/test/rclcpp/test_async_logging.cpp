@@ -0,0 +1,116 @@
+// Copyright 2021 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "rclcpp/async_logging.hpp"
+#include "rclcpp/rclcpp.hpp"
+
+namespace async_logging = rclcpp::async_logging;
+
+TEST(TestAsyncLogging, disabled_by_default) {
+  rclcpp::InitOptions init_options;
+  EXPECT_FALSE(init_options.async_logging().enabled);
+
+  auto context = std::make_shared<rclcpp::Context>();
+  context->init(0, nullptr, init_options);
+  EXPECT_FALSE(async_logging::is_enabled());
+  RCLCPP_INFO(rclcpp::get_logger("test_async_logging"), "synchronous message");
+  // Nothing to do.
+  async_logging::flush();
+  context->shutdown("done");
+}
+
+TEST(TestAsyncLogging, invalid_options) {
+  rclcpp::InitOptions init_options;
+  async_logging::AsyncLoggingOptions options;
+  options.capacity = 0;
+  EXPECT_THROW(init_options.async_logging(options), std::invalid_argument);
+  options.capacity = 1;
+  options.max_message_size = 0;
+  EXPECT_THROW(init_options.async_logging(options), std::invalid_argument);
+}
+
+TEST(TestAsyncLogging, options_are_copied) {
+  async_logging::AsyncLoggingOptions options;
+  options.enabled = true;
+  options.capacity = 16;
+  options.overflow_policy = async_logging::OverflowPolicy::Block;
+  rclcpp::InitOptions init_options;
+  init_options.async_logging(options);
+
+  rclcpp::InitOptions copy(init_options);
+  EXPECT_TRUE(copy.async_logging().enabled);
+  EXPECT_EQ(16u, copy.async_logging().capacity);
+  EXPECT_EQ(async_logging::OverflowPolicy::Block, copy.async_logging().overflow_policy);
+
+  rclcpp::InitOptions assigned;
+  assigned = init_options;
+  EXPECT_TRUE(assigned.async_logging().enabled);
+}
+
+class TestAsyncLoggingEnabled : public ::testing::TestWithParam<async_logging::OverflowPolicy>
+{
+};
+
+TEST_P(TestAsyncLoggingEnabled, log_from_threads) {
+  async_logging::AsyncLoggingOptions options;
+  options.enabled = true;
+  // Small enough for the queue to overflow.
+  options.capacity = 4;
+  options.max_message_size = 16;
+  options.overflow_policy = GetParam();
+  rclcpp::InitOptions init_options;
+  init_options.async_logging(options);
+
+  auto context = std::make_shared<rclcpp::Context>();
+  context->init(0, nullptr, init_options);
+  ASSERT_TRUE(async_logging::is_enabled());
+
+  uint64_t dropped_count = async_logging::get_dropped_count();
+  auto logger = rclcpp::get_logger("test_async_logging");
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 4; ++i) {
+    threads.emplace_back(
+      [&logger, i]() {
+        for (int j = 0; j < 100; ++j) {
+          RCLCPP_INFO(logger, "thread %d message %d, long enough to be truncated", i, j);
+        }
+      });
+  }
+  for (auto & thread : threads) {
+    thread.join();
+  }
+  async_logging::flush();
+  if (async_logging::OverflowPolicy::Block == GetParam()) {
+    EXPECT_EQ(dropped_count, async_logging::get_dropped_count());
+  } else {
+    EXPECT_GE(async_logging::get_dropped_count(), dropped_count);
+  }
+
+  // The messages left are output by the shutdown.
+  RCLCPP_INFO(logger, "last message");
+  context->shutdown("done");
+  EXPECT_FALSE(async_logging::is_enabled());
+  RCLCPP_INFO(logger, "synchronous message");
+}
+
+INSTANTIATE_TEST_SUITE_P(
+  OverflowPolicies, TestAsyncLoggingEnabled,
+  ::testing::Values(async_logging::OverflowPolicy::Drop, async_logging::OverflowPolicy::Block));
@@ -0,0 +1,116 @@
+// Copyright 2021 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "rclcpp/detail/bounded_mpmc_queue.hpp"
+
+using rclcpp::detail::BoundedMPMCQueue;
+
+TEST(TestBoundedMPMCQueue, construct) {
+  EXPECT_THROW(BoundedMPMCQueue<int>(0u), std::invalid_argument);
+  EXPECT_EQ(1u, BoundedMPMCQueue<int>(1u).capacity());
+  EXPECT_EQ(8u, BoundedMPMCQueue<int>(5u).capacity());
+  EXPECT_EQ(8u, BoundedMPMCQueue<int>(8u).capacity());
+}
+
+TEST(TestBoundedMPMCQueue, push_pop) {
+  BoundedMPMCQueue<int> queue(2u);
+  EXPECT_TRUE(queue.empty());
+
+  int value = 0;
+  EXPECT_FALSE(queue.try_pop(value));
+
+  EXPECT_TRUE(queue.try_push(1));
+  EXPECT_TRUE(queue.try_push(2));
+  EXPECT_FALSE(queue.empty());
+
+  // The queue is full, the value is not consumed
+  EXPECT_FALSE(queue.try_push(3));
+
+  EXPECT_TRUE(queue.try_pop(value));
+  EXPECT_EQ(1, value);
+  EXPECT_TRUE(queue.try_push(3));
+  EXPECT_TRUE(queue.try_pop(value));
+  EXPECT_EQ(2, value);
+  EXPECT_TRUE(queue.try_pop(value));
+  EXPECT_EQ(3, value);
+  EXPECT_FALSE(queue.try_pop(value));
+  EXPECT_TRUE(queue.empty());
+}
+
+TEST(TestBoundedMPMCQueue, pop_releases_value) {
+  BoundedMPMCQueue<std::shared_ptr<int>> queue(4u);
+  auto value = std::make_shared<int>(42);
+  std::weak_ptr<int> weak_value = value;
+
+  auto pushed = value;
+  EXPECT_TRUE(queue.try_push(std::move(pushed)));
+  EXPECT_EQ(nullptr, pushed);
+  value.reset();
+  EXPECT_FALSE(weak_value.expired());
+
+  std::shared_ptr<int> popped;
+  EXPECT_TRUE(queue.try_pop(popped));
+  EXPECT_EQ(42, *popped);
+  popped.reset();
+  // The queue must not keep a copy of popped values
+  EXPECT_TRUE(weak_value.expired());
+}
+
+TEST(TestBoundedMPMCQueue, multiple_producers_and_consumers) {
+  constexpr size_t number_of_threads = 4u;
+  constexpr size_t values_per_producer = 10000u;
+  BoundedMPMCQueue<size_t> queue(64u);
+
+  std::atomic<size_t> sum {0u};
+  std::atomic<size_t> popped {0u};
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < number_of_threads; ++i) {
+    threads.emplace_back(
+      [&queue]() {
+        for (size_t value = 1u; value <= values_per_producer; ++value) {
+          while (!queue.try_push(std::move(value))) {
+            std::this_thread::yield();
+          }
+        }
+      });
+    threads.emplace_back(
+      [&queue, &sum, &popped]() {
+        size_t value = 0u;
+        while (popped.load() < number_of_threads * values_per_producer) {
+          if (queue.try_pop(value)) {
+            sum += value;
+            ++popped;
+          } else {
+            std::this_thread::yield();
+          }
+        }
+      });
+  }
+  for (auto & thread : threads) {
+    thread.join();
+  }
+
+  EXPECT_EQ(number_of_threads * values_per_producer, popped.load());
+  EXPECT_EQ(number_of_threads * values_per_producer * (values_per_producer + 1u) / 2u, sum.load());
+  EXPECT_TRUE(queue.empty());
+}
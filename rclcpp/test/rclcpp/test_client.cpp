@@ -154,6 +154,69 @@ TEST_F(TestClient, wait_for_service) {
   EXPECT_TRUE(client->service_is_ready());
 }
 
+TEST_F(TestClient, async_send_request_timeout) {
+  using Client = rclcpp::Client<test_msgs::srv::Empty>;
+  // No service answers the requests.
+  auto client = node->create_client<test_msgs::srv::Empty>("unanswered_service");
+  // The timer is only created for the requests sent with a timeout.
+  EXPECT_EQ(nullptr, client->get_request_timeout_timer());
+
+  auto request = std::make_shared<test_msgs::srv::Empty::Request>();
+  bool future_callback_called = false;
+  auto future = client->async_send_request(
+    request,
+    [&future_callback_called](Client::SharedFuture future) {
+      EXPECT_THROW(future.get(), rclcpp::exceptions::RequestTimeoutError);
+      future_callback_called = true;
+    },
+    std::chrono::milliseconds(10));
+  bool response_callback_called = false;
+  client->async_send_request(
+    request,
+    [&response_callback_called](Client::SharedResponse response) {
+      EXPECT_EQ(nullptr, response);
+      response_callback_called = true;
+    },
+    std::chrono::milliseconds(20));
+  ASSERT_NE(nullptr, client->get_request_timeout_timer());
+  EXPECT_FALSE(client->get_request_timeout_timer()->is_canceled());
+
+  auto start = std::chrono::steady_clock::now();
+  while (!(future_callback_called && response_callback_called) &&
+    (std::chrono::steady_clock::now() - start) < std::chrono::seconds(1))
+  {
+    rclcpp::spin_some(node);
+  }
+  EXPECT_TRUE(future_callback_called);
+  EXPECT_TRUE(response_callback_called);
+  ASSERT_EQ(std::future_status::ready, future.wait_for(std::chrono::seconds(0)));
+  EXPECT_THROW(future.get(), rclcpp::exceptions::RequestTimeoutError);
+  EXPECT_TRUE(client->get_request_timeout_timer()->is_canceled());
+}
+
+TEST_F(TestClient, max_pending_requests) {
+  using Client = rclcpp::Client<test_msgs::srv::Empty>;
+  auto client = node->create_client<test_msgs::srv::Empty>("unanswered_service");
+  EXPECT_EQ(0u, client->get_max_pending_requests());
+  client->set_max_pending_requests(1);
+  EXPECT_EQ(1u, client->get_max_pending_requests());
+
+  auto request = std::make_shared<test_msgs::srv::Empty::Request>();
+  client->async_send_request(request, [](Client::SharedFuture) {}, std::chrono::milliseconds(10));
+  EXPECT_THROW(
+    client->async_send_request(request, [](Client::SharedResponse) {}),
+    rclcpp::exceptions::TooManyPendingRequestsError);
+
+  // Once the request expired, it is no longer pending and another one can be sent.
+  auto start = std::chrono::steady_clock::now();
+  while (!client->get_request_timeout_timer()->is_canceled() &&
+    (std::chrono::steady_clock::now() - start) < std::chrono::seconds(1))
+  {
+    rclcpp::spin_some(node);
+  }
+  EXPECT_NO_THROW(client->async_send_request(request, [](Client::SharedResponse) {}));
+}
+
 /*
    Testing client construction and destruction for subnodes.
  */
@@ -267,6 +330,31 @@ TEST_F(TestClientWithServer, async_send_request_callback_with_request) {
   EXPECT_TRUE(received_response);
 }
 
+TEST_F(TestClientWithServer, async_send_request_response_callback) {
+  using SharedResponse = rclcpp::Client<test_msgs::srv::Empty>::SharedResponse;
+
+  auto client = node->create_client<test_msgs::srv::Empty>(service_name);
+  ASSERT_TRUE(client->wait_for_service(std::chrono::seconds(1)));
+
+  size_t received_responses = 0;
+  auto callback = [&received_responses](SharedResponse response) {
+      EXPECT_NE(nullptr, response);
+      ++received_responses;
+    };
+  auto request = std::make_shared<test_msgs::srv::Empty::Request>();
+  const int64_t first_sequence_number = client->async_send_request(request, callback);
+  const int64_t second_sequence_number = client->async_send_request(request, callback);
+  EXPECT_NE(first_sequence_number, second_sequence_number);
+
+  auto start = std::chrono::steady_clock::now();
+  while (received_responses < 2u &&
+    (std::chrono::steady_clock::now() - start) < std::chrono::seconds(1))
+  {
+    rclcpp::spin_some(node);
+  }
+  EXPECT_EQ(2u, received_responses);
+}
+
 TEST_F(TestClientWithServer, async_send_request_rcl_send_request_error) {
   // Checking rcl_send_request in rclcpp::Client::async_send_request()
   auto mock = mocking_utils::patch_and_return("lib:rclcpp", rcl_send_request, RCL_RET_ERROR);
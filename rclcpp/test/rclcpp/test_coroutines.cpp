@@ -0,0 +1,150 @@
+// Copyright 2021 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include "rclcpp/coroutines.hpp"
+#include "rclcpp/rclcpp.hpp"
+
+#include "test_msgs/msg/empty.hpp"
+#include "test_msgs/srv/basic_types.hpp"
+
+using namespace std::chrono_literals;
+
+#ifdef RCLCPP_HAS_COROUTINES
+
+class TestCoroutines : public ::testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    rclcpp::init(0, nullptr);
+    node = std::make_shared<rclcpp::Node>("test_coroutines_node", "/ns");
+    executor.add_node(node);
+  }
+
+  void TearDown() override
+  {
+    executor.remove_node(node);
+    node.reset();
+    rclcpp::shutdown();
+  }
+
+  void spin_until(const bool & done)
+  {
+    auto start = std::chrono::steady_clock::now();
+    while (!done && (std::chrono::steady_clock::now() - start) < 10s) {
+      executor.spin_once(10ms);
+    }
+  }
+
+  rclcpp::Node::SharedPtr node;
+  rclcpp::executors::SingleThreadedExecutor executor;
+};
+
+rclcpp::coroutines::Task
+sleep_twice(rclcpp::Node::SharedPtr node, std::thread::id & thread_id, bool & done)
+{
+  co_await rclcpp::coroutines::sleep_for(node, 1ms);
+  co_await rclcpp::coroutines::sleep_for(node, 1ms);
+  thread_id = std::this_thread::get_id();
+  done = true;
+}
+
+TEST_F(TestCoroutines, sleep_for) {
+  std::thread::id thread_id;
+  bool done = false;
+  auto start = std::chrono::steady_clock::now();
+  sleep_twice(node, thread_id, done);
+  EXPECT_FALSE(done);
+  spin_until(done);
+  ASSERT_TRUE(done);
+  EXPECT_LE(2ms, std::chrono::steady_clock::now() - start);
+  // Resumed by the executor.
+  EXPECT_EQ(std::this_thread::get_id(), thread_id);
+}
+
+using BasicTypes = test_msgs::srv::BasicTypes;
+
+rclcpp::coroutines::Task
+call_twice(rclcpp::Client<BasicTypes>::SharedPtr client, int64_t & sum, bool & done)
+{
+  for (int64_t i = 1; i <= 2; ++i) {
+    auto request = std::make_shared<BasicTypes::Request>();
+    request->int64_value = i;
+    auto response = co_await rclcpp::coroutines::async_send_request(client, request);
+    sum += response->int64_value;
+  }
+  done = true;
+}
+
+TEST_F(TestCoroutines, async_send_request) {
+  auto service = node->create_service<BasicTypes>(
+    "coroutine_service",
+    [](BasicTypes::Request::SharedPtr request, BasicTypes::Response::SharedPtr response) {
+      response->int64_value = request->int64_value * 10;
+    });
+  auto client = node->create_client<BasicTypes>("coroutine_service");
+  ASSERT_TRUE(client->wait_for_service(5s));
+
+  int64_t sum = 0;
+  bool done = false;
+  call_twice(client, sum, done);
+  spin_until(done);
+  ASSERT_TRUE(done);
+  EXPECT_EQ(30, sum);
+}
+
+rclcpp::coroutines::Task
+wait_for_two_messages(
+  rclcpp::Node::SharedPtr node, bool & received, bool & timed_out, bool & done)
+{
+  auto message = co_await rclcpp::coroutines::wait_for_message<test_msgs::msg::Empty>(
+    node, "coroutine_topic", 10s);
+  received = message != nullptr;
+  message = co_await rclcpp::coroutines::wait_for_message<test_msgs::msg::Empty>(
+    node, "no_coroutine_topic", 1ms);
+  timed_out = message == nullptr;
+  done = true;
+}
+
+TEST_F(TestCoroutines, wait_for_message) {
+  auto publisher = node->create_publisher<test_msgs::msg::Empty>("coroutine_topic", 10);
+  bool received = false;
+  bool timed_out = false;
+  bool done = false;
+  wait_for_two_messages(node, received, timed_out, done);
+  auto start = std::chrono::steady_clock::now();
+  while (!received && (std::chrono::steady_clock::now() - start) < 10s) {
+    publisher->publish(test_msgs::msg::Empty());
+    executor.spin_once(10ms);
+  }
+  spin_until(done);
+  ASSERT_TRUE(done);
+  EXPECT_TRUE(received);
+  EXPECT_TRUE(timed_out);
+}
+
+#else
+
+TEST(TestCoroutines, coroutines_not_available) {
+  GTEST_SKIP() << "coroutines are not enabled by the compiler";
+}
+
+#endif  // RCLCPP_HAS_COROUTINES
@@ -18,6 +18,7 @@
 #include <chrono>
 #include <limits>
 #include <string>
+#include <vector>
 
 #include "rcl/error_handling.h"
 #include "rcl/time.h"
@@ -321,3 +322,25 @@ TEST_F(TestDuration, test_some_exceptions) {
     test_duration = test_duration * (std::numeric_limits<double>::infinity()),
     std::runtime_error("abnormal scale in rclcpp::Duration"));
 }
+
+TEST_F(TestDuration, bulk_conversions) {
+  const std::vector<rcl_duration_value_t> nanoseconds = {
+    0, 1, -1, RCL_S_TO_NS(1), -RCL_S_TO_NS(1) - 1, RCL_S_TO_NS(1) + 500,
+    std::numeric_limits<rcl_duration_value_t>::max(),
+    std::numeric_limits<rcl_duration_value_t>::min(),
+  };
+  std::vector<builtin_interfaces::msg::Duration> messages(nanoseconds.size());
+  rclcpp::nanoseconds_to_durations(nanoseconds.data(), nanoseconds.size(), messages.data());
+  for (size_t i = 0; i < nanoseconds.size(); ++i) {
+    const builtin_interfaces::msg::Duration expected =
+      rclcpp::Duration::from_nanoseconds(nanoseconds[i]);
+    EXPECT_EQ(expected.sec, messages[i].sec) << i;
+    EXPECT_EQ(expected.nanosec, messages[i].nanosec) << i;
+  }
+
+  std::vector<rcl_duration_value_t> converted(messages.size());
+  rclcpp::durations_to_nanoseconds(messages.data(), messages.size(), converted.data());
+  for (size_t i = 0; i < messages.size(); ++i) {
+    EXPECT_EQ(rclcpp::Duration(messages[i]).nanoseconds(), converted[i]) << i;
+  }
+}
@@ -0,0 +1,177 @@
+// Copyright 2021 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "rclcpp/duration_histogram.hpp"
+#include "rclcpp/topic_statistics/duration_histogram_statistics.hpp"
+
+#include "statistics_msgs/msg/statistic_data_type.hpp"
+
+using namespace std::chrono_literals;
+
+using rclcpp::DurationHistogram;
+
+TEST(TestDurationHistogram, buckets) {
+  EXPECT_EQ(0u, DurationHistogram::get_bucket(-1ns));
+  EXPECT_EQ(0u, DurationHistogram::get_bucket(0ns));
+  EXPECT_EQ(1u, DurationHistogram::get_bucket(1ns));
+  EXPECT_EQ(7u, DurationHistogram::get_bucket(7ns));
+  EXPECT_EQ(8u, DurationHistogram::get_bucket(8ns));
+  EXPECT_EQ(15u, DurationHistogram::get_bucket(15ns));
+  EXPECT_EQ(16u, DurationHistogram::get_bucket(16ns));
+  EXPECT_EQ(16u, DurationHistogram::get_bucket(17ns));
+  EXPECT_EQ(17u, DurationHistogram::get_bucket(18ns));
+  EXPECT_EQ(
+    DurationHistogram::number_of_buckets - 1u,
+    DurationHistogram::get_bucket(std::chrono::nanoseconds::max()));
+  for (size_t bucket = 0; bucket + 1 < DurationHistogram::number_of_buckets; ++bucket) {
+    const auto upper_bound = DurationHistogram::get_bucket_upper_bound(bucket);
+    EXPECT_EQ(bucket, DurationHistogram::get_bucket(upper_bound - 1ns));
+    EXPECT_EQ(bucket + 1, DurationHistogram::get_bucket(upper_bound));
+  }
+}
+
+TEST(TestDurationHistogram, bucket_precision) {
+  for (auto duration : {10ns, 999ns, 1234567ns, std::chrono::nanoseconds(3s)}) {
+    const auto bucket = DurationHistogram::get_bucket(duration);
+    const auto upper_bound = DurationHistogram::get_bucket_upper_bound(bucket);
+    EXPECT_LT(duration, upper_bound);
+    EXPECT_LE(upper_bound.count(), duration.count() * 1.125 + 1.0);
+  }
+}
+
+TEST(TestDurationHistogram, record_and_reset) {
+  DurationHistogram histogram;
+  auto snapshot = histogram.get_snapshot();
+  EXPECT_EQ(0u, snapshot.count);
+  EXPECT_EQ(0ns, snapshot.get_percentile(50.0));
+
+  for (int i = 1; i <= 100; ++i) {
+    histogram.record(std::chrono::microseconds(i));
+  }
+  snapshot = histogram.get_snapshot();
+  EXPECT_EQ(100u, snapshot.count);
+  EXPECT_EQ(1us, snapshot.min);
+  EXPECT_EQ(100us, snapshot.max);
+  EXPECT_DOUBLE_EQ(50500.0, snapshot.mean);
+  EXPECT_NEAR(28866.07, snapshot.standard_deviation, 0.01);
+  // Percentiles are upper bounds of the buckets, within 12.5% of the durations.
+  EXPECT_LE(50us, snapshot.get_percentile(50.0));
+  EXPECT_GE(56250ns, snapshot.get_percentile(50.0));
+  EXPECT_LE(99us, snapshot.get_percentile(99.0));
+  EXPECT_EQ(100us, snapshot.get_percentile(100.0));
+
+  histogram.reset();
+  snapshot = histogram.get_snapshot();
+  EXPECT_EQ(0u, snapshot.count);
+  EXPECT_EQ(0ns, snapshot.max);
+}
+
+TEST(TestDurationHistogram, invalid_number_of_shards) {
+  EXPECT_THROW(DurationHistogram(0u), std::invalid_argument);
+}
+
+TEST(TestDurationHistogram, concurrent_records) {
+  DurationHistogram histogram(3u);
+  EXPECT_EQ(3u, histogram.get_number_of_shards());
+  EXPECT_LE(3u * DurationHistogram::number_of_buckets * 8u, histogram.get_allocated_memory_size());
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 4; ++i) {
+    threads.emplace_back(
+      [&histogram, i]() {
+        for (int j = 0; j < 10000; ++j) {
+          histogram.record(std::chrono::milliseconds(i + 1));
+        }
+      });
+  }
+  for (auto & thread : threads) {
+    thread.join();
+  }
+  const auto snapshot = histogram.get_snapshot();
+  EXPECT_EQ(40000u, snapshot.count);
+  for (int i = 0; i < 4; ++i) {
+    const auto bucket = DurationHistogram::get_bucket(std::chrono::milliseconds(i + 1));
+    EXPECT_EQ(10000u, snapshot.bucket_counts[bucket]);
+  }
+  EXPECT_EQ(1ms, snapshot.min);
+  EXPECT_EQ(4ms, snapshot.max);
+  EXPECT_DOUBLE_EQ(2.5e6, snapshot.mean);
+  EXPECT_NEAR(1118033.99, snapshot.standard_deviation, 0.01);
+}
+
+TEST(TestDurationHistogram, merge) {
+  DurationHistogram first;
+  DurationHistogram second;
+  DurationHistogram both;
+  for (int i = 1; i <= 10; ++i) {
+    first.record(std::chrono::microseconds(i));
+    both.record(std::chrono::microseconds(i));
+  }
+  for (int i = 100; i <= 150; ++i) {
+    second.record(std::chrono::microseconds(i));
+    both.record(std::chrono::microseconds(i));
+  }
+  auto merged = DurationHistogram::Snapshot();
+  merged.merge(first.get_snapshot());
+  merged.merge(DurationHistogram::Snapshot());
+  merged.merge(second.get_snapshot());
+
+  const auto expected = both.get_snapshot();
+  EXPECT_EQ(expected.bucket_counts, merged.bucket_counts);
+  EXPECT_EQ(expected.count, merged.count);
+  EXPECT_EQ(expected.min, merged.min);
+  EXPECT_EQ(expected.max, merged.max);
+  EXPECT_NEAR(expected.mean, merged.mean, 1e-6);
+  EXPECT_NEAR(expected.standard_deviation, merged.standard_deviation, 1e-3);
+}
+
+TEST(TestDurationHistogram, metrics_message) {
+  DurationHistogram histogram;
+  histogram.record(1ms);
+  histogram.record(3ms);
+  const auto message = rclcpp::topic_statistics::generate_duration_statistic_message(
+    "/node", "latency", rclcpp::Time(1, 0), rclcpp::Time(2, 0), histogram.get_snapshot());
+  EXPECT_EQ("/node", message.measurement_source_name);
+  EXPECT_EQ("latency", message.metrics_source);
+  EXPECT_EQ("ms", message.unit);
+  EXPECT_EQ(1, message.window_start.sec);
+  EXPECT_EQ(2, message.window_stop.sec);
+  for (const auto & point : message.statistics) {
+    switch (point.data_type) {
+      case statistics_msgs::msg::StatisticDataType::STATISTICS_DATA_TYPE_AVERAGE:
+        EXPECT_DOUBLE_EQ(2.0, point.data);
+        break;
+      case statistics_msgs::msg::StatisticDataType::STATISTICS_DATA_TYPE_MINIMUM:
+        EXPECT_DOUBLE_EQ(1.0, point.data);
+        break;
+      case statistics_msgs::msg::StatisticDataType::STATISTICS_DATA_TYPE_MAXIMUM:
+        EXPECT_DOUBLE_EQ(3.0, point.data);
+        break;
+      case statistics_msgs::msg::StatisticDataType::STATISTICS_DATA_TYPE_STDDEV:
+        EXPECT_DOUBLE_EQ(1.0, point.data);
+        break;
+      case statistics_msgs::msg::StatisticDataType::STATISTICS_DATA_TYPE_SAMPLE_COUNT:
+        EXPECT_DOUBLE_EQ(2.0, point.data);
+        break;
+      default:
+        FAIL() << "unexpected data type " << static_cast<int>(point.data_type);
+    }
+  }
+}
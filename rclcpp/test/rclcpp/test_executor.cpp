@@ -18,6 +18,8 @@
 #include <memory>
 #include <stdexcept>
 #include <string>
+#include <thread>
+#include <vector>
 
 #include "rclcpp/executor.hpp"
 #include "rclcpp/memory_strategy.hpp"
@@ -33,8 +35,8 @@
 class DummyExecutor : public rclcpp::Executor
 {
 public:
-  DummyExecutor()
-  : rclcpp::Executor()
+  explicit DummyExecutor(const rclcpp::ExecutorOptions & options = rclcpp::ExecutorOptions())
+  : rclcpp::Executor(options)
   {
   }
 
@@ -63,6 +65,16 @@ public:
   {
     return get_group_by_timer(timer);
   }
+
+  void local_wait_for_work(std::chrono::nanoseconds timeout)
+  {
+    wait_for_work(timeout);
+  }
+
+  size_t local_get_all_ready_executables(std::vector<rclcpp::AnyExecutable> & ready_executables)
+  {
+    return get_all_ready_executables(ready_executables);
+  }
 };
 
 class TestExecutor : public ::testing::Test
@@ -214,6 +226,40 @@ TEST_F(TestExecutor, remove_node_associated_with_different_executor) {
     std::runtime_error("Node needs to be associated with this executor."));
 }
 
+TEST_F(TestExecutor, add_remove_many_nodes) {
+  DummyExecutor dummy;
+  std::vector<rclcpp::Node::SharedPtr> nodes;
+  for (size_t i = 0; i < 50u; ++i) {
+    nodes.push_back(std::make_shared<rclcpp::Node>("node" + std::to_string(i), "ns"));
+    dummy.add_node(nodes.back()->get_node_base_interface(), false);
+  }
+  EXPECT_EQ(50u, dummy.get_all_callback_groups().size());
+
+  // A group added on its own stays in the executor when its node is removed
+  auto manual_group = nodes[0]->create_callback_group(
+    rclcpp::CallbackGroupType::MutuallyExclusive, false);
+  dummy.add_callback_group(manual_group, nodes[0]->get_node_base_interface(), false);
+  for (size_t i = 0; i < nodes.size(); i += 2) {
+    dummy.remove_node(nodes[i]->get_node_base_interface(), false);
+  }
+  EXPECT_EQ(26u, dummy.get_all_callback_groups().size());
+  EXPECT_EQ(1u, dummy.get_manually_added_callback_groups().size());
+  dummy.remove_node(nodes[1]->get_node_base_interface(), false);
+  RCLCPP_EXPECT_THROW_EQ(
+    dummy.remove_node(nodes[1]->get_node_base_interface(), false),
+    std::runtime_error("Node needs to be associated with an executor."));
+
+  // The removed nodes can be added again
+  dummy.add_node(nodes[0]->get_node_base_interface(), false);
+  for (size_t i = 3; i < nodes.size(); i += 2) {
+    dummy.remove_node(nodes[i]->get_node_base_interface(), false);
+  }
+  dummy.remove_callback_group(manual_group, false);
+  EXPECT_EQ(1u, dummy.get_all_callback_groups().size());
+  dummy.remove_node(nodes[0]->get_node_base_interface(), false);
+  EXPECT_TRUE(dummy.get_all_callback_groups().empty());
+}
+
 TEST_F(TestExecutor, spin_node_once_nanoseconds) {
   DummyExecutor dummy;
   auto node = std::make_shared<rclcpp::Node>("node", "ns");
@@ -389,6 +435,49 @@ TEST_F(TestExecutor, spin_some_fail_wait_set_resize) {
     std::runtime_error("Couldn't resize the wait set: error not set"));
 }
 
+TEST_F(TestExecutor, spin_some_reserved_wait_set_capacities) {
+  rclcpp::ExecutorOptions options;
+  EXPECT_TRUE(options.wait_set_capacities.empty());
+  options.wait_set_capacities.subscriptions = 10;
+  options.wait_set_capacities.guard_conditions = 10;
+  options.wait_set_capacities.timers = 10;
+  options.wait_set_capacities.clients = 10;
+  options.wait_set_capacities.services = 10;
+  options.wait_set_capacities.events = 10;
+  EXPECT_FALSE(options.wait_set_capacities.empty());
+  DummyExecutor dummy(options);
+  auto node = std::make_shared<rclcpp::Node>("node", "ns");
+  bool timer_fired = false;
+  auto timer =
+    node->create_wall_timer(std::chrono::milliseconds(1), [&]() {timer_fired = true;});
+
+  dummy.add_node(node);
+  // The reserved wait set is not resized.
+  auto mock = mocking_utils::patch_and_return("lib:rclcpp", rcl_wait_set_resize, RCL_RET_ERROR);
+  std::this_thread::sleep_for(std::chrono::milliseconds(2));
+  EXPECT_NO_THROW(dummy.spin_some(std::chrono::milliseconds(10)));
+  EXPECT_TRUE(timer_fired);
+}
+
+TEST_F(TestExecutor, spin_some_exceed_wait_set_capacities) {
+  rclcpp::ExecutorOptions options;
+  options.wait_set_capacities.subscriptions = 10;
+  options.wait_set_capacities.guard_conditions = 10;
+  options.wait_set_capacities.timers = 0;
+  options.wait_set_capacities.clients = 10;
+  options.wait_set_capacities.services = 10;
+  options.wait_set_capacities.events = 10;
+  DummyExecutor dummy(options);
+  auto node = std::make_shared<rclcpp::Node>("node", "ns");
+  auto timer =
+    node->create_wall_timer(std::chrono::milliseconds(1), [&]() {});
+
+  dummy.add_node(node);
+  RCLCPP_EXPECT_THROW_EQ(
+    dummy.spin_some(std::chrono::milliseconds(1)),
+    std::runtime_error("Couldn't fit 1 timers in the wait set, whose reserved capacity is 0"));
+}
+
 TEST_F(TestExecutor, spin_some_fail_add_handles_to_wait_set) {
   DummyExecutor dummy;
   auto node = std::make_shared<rclcpp::Node>("node", "ns");
@@ -556,3 +645,119 @@ TEST_F(TestExecutor, spin_until_future_complete_future_already_complete) {
     rclcpp::FutureReturnCode::SUCCESS,
     dummy.spin_until_future_complete(future, std::chrono::milliseconds(1)));
 }
+
+TEST_F(TestExecutor, get_all_ready_executables) {
+  DummyExecutor dummy;
+  auto node = std::make_shared<rclcpp::Node>("node", "ns");
+  auto reentrant_group = node->create_callback_group(rclcpp::CallbackGroupType::Reentrant);
+  auto exclusive_group =
+    node->create_callback_group(rclcpp::CallbackGroupType::MutuallyExclusive);
+
+  std::vector<rclcpp::TimerBase::SharedPtr> timers;
+  for (size_t i = 0; i < 3u; ++i) {
+    timers.push_back(
+      node->create_wall_timer(std::chrono::milliseconds(1), []() {}, reentrant_group));
+  }
+  for (size_t i = 0; i < 2u; ++i) {
+    timers.push_back(
+      node->create_wall_timer(std::chrono::milliseconds(1), []() {}, exclusive_group));
+  }
+  dummy.add_node(node);
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  dummy.local_wait_for_work(std::chrono::milliseconds(0));
+
+  // Only one executable of the mutually exclusive group can be taken at once
+  std::vector<rclcpp::AnyExecutable> ready_executables;
+  EXPECT_EQ(4u, dummy.local_get_all_ready_executables(ready_executables));
+  ASSERT_EQ(4u, ready_executables.size());
+  for (const auto & any_executable : ready_executables) {
+    EXPECT_NE(nullptr, any_executable.timer);
+  }
+  EXPECT_FALSE(exclusive_group->can_be_taken_from().load());
+
+  // Discarding the executables releases the mutually exclusive group for the remaining timer
+  ready_executables.clear();
+  EXPECT_TRUE(exclusive_group->can_be_taken_from().load());
+  EXPECT_EQ(1u, dummy.local_get_all_ready_executables(ready_executables));
+  EXPECT_EQ(0u, dummy.local_get_all_ready_executables(ready_executables));
+}
+
+TEST_F(TestExecutor, get_all_ready_executables_by_priority) {
+  DummyExecutor dummy;
+  auto node = std::make_shared<rclcpp::Node>("node", "ns");
+  auto low_priority_group =
+    node->create_callback_group(rclcpp::CallbackGroupType::Reentrant, true, -1);
+  auto high_priority_group =
+    node->create_callback_group(rclcpp::CallbackGroupType::Reentrant, true, 10);
+  EXPECT_EQ(-1, low_priority_group->priority());
+  EXPECT_EQ(10, high_priority_group->priority());
+  EXPECT_EQ(0, node->get_node_base_interface()->get_default_callback_group()->priority());
+
+  // Timers of the low priority group are created first, so they would be found first otherwise
+  std::vector<rclcpp::TimerBase::SharedPtr> timers;
+  for (size_t i = 0; i < 2u; ++i) {
+    timers.push_back(
+      node->create_wall_timer(std::chrono::milliseconds(1), []() {}, low_priority_group));
+  }
+  for (size_t i = 0; i < 2u; ++i) {
+    timers.push_back(
+      node->create_wall_timer(std::chrono::milliseconds(1), []() {}, high_priority_group));
+  }
+  dummy.add_node(node);
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  dummy.local_wait_for_work(std::chrono::milliseconds(0));
+
+  std::vector<rclcpp::AnyExecutable> ready_executables;
+  ASSERT_EQ(4u, dummy.local_get_all_ready_executables(ready_executables));
+  EXPECT_EQ(high_priority_group, ready_executables[0].callback_group);
+  EXPECT_EQ(high_priority_group, ready_executables[1].callback_group);
+  EXPECT_EQ(low_priority_group, ready_executables[2].callback_group);
+  EXPECT_EQ(low_priority_group, ready_executables[3].callback_group);
+}
+
+TEST_F(TestExecutor, get_all_ready_executables_earliest_deadline_first) {
+  rclcpp::ExecutorOptions options;
+  options.scheduling_policy = rclcpp::ExecutorSchedulingPolicy::EarliestDeadlineFirst;
+  DummyExecutor dummy(options);
+  auto node = std::make_shared<rclcpp::Node>("node", "ns");
+
+  // The slow timer is created first, so it would be found first otherwise
+  auto slow_timer = node->create_wall_timer(std::chrono::milliseconds(100), []() {});
+  auto fast_timer = node->create_wall_timer(std::chrono::milliseconds(1), []() {});
+  dummy.add_node(node);
+  std::this_thread::sleep_for(std::chrono::milliseconds(110));
+  dummy.local_wait_for_work(std::chrono::milliseconds(0));
+
+  // Both are ready, but the fast timer missed its deadline long ago
+  std::vector<rclcpp::AnyExecutable> ready_executables;
+  ASSERT_EQ(2u, dummy.local_get_all_ready_executables(ready_executables));
+  EXPECT_EQ(fast_timer, ready_executables[0].timer);
+  EXPECT_EQ(slow_timer, ready_executables[1].timer);
+}
+
+TEST_F(TestExecutor, spin_some_round_robin) {
+  rclcpp::ExecutorOptions options;
+  options.scheduling_policy = rclcpp::ExecutorSchedulingPolicy::RoundRobin;
+  DummyExecutor dummy(options);
+  auto node = std::make_shared<rclcpp::Node>("node", "ns");
+
+  // Both timers are always ready, and each spin only has the time to execute one of them
+  std::vector<int> calls;
+  auto first_timer = node->create_wall_timer(
+    std::chrono::milliseconds(1), [&calls]() {
+      calls.push_back(1);
+      std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    });
+  auto second_timer = node->create_wall_timer(
+    std::chrono::milliseconds(1), [&calls]() {
+      calls.push_back(2);
+      std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    });
+  dummy.add_node(node);
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+
+  for (size_t i = 0; i < 4u; ++i) {
+    dummy.spin_some(std::chrono::milliseconds(10));
+  }
+  EXPECT_EQ((std::vector<int>{1, 2, 1, 2}), calls);
+}
@@ -0,0 +1,146 @@
+// Copyright 2021 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <memory>
+#include <thread>
+
+#include "rclcpp/executor_statistics.hpp"
+#include "rclcpp/rclcpp.hpp"
+
+using namespace std::chrono_literals;
+
+class TestExecutorStatistics : public ::testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    rclcpp::init(0, nullptr);
+    node = std::make_shared<rclcpp::Node>("test_executor_statistics", "/ns");
+  }
+
+  void TearDown() override
+  {
+    node.reset();
+    rclcpp::shutdown();
+  }
+
+  rclcpp::Node::SharedPtr node;
+};
+
+TEST_F(TestExecutorStatistics, record_and_reset) {
+  rclcpp::ExecutorStatistics statistics;
+  auto group = node->create_callback_group(rclcpp::CallbackGroupType::MutuallyExclusive);
+  statistics.record_dispatch_latency(
+    node->get_node_base_interface()->get_default_callback_group(),
+    node->get_node_base_interface(), 1ms);
+  statistics.record_dispatch_latency(group, node->get_node_base_interface(), 2ms);
+  statistics.record_dispatch_latency(group, node->get_node_base_interface(), 4ms);
+  statistics.record_execution_duration(3ms);
+
+  EXPECT_EQ(3u, statistics.get_dispatch_latency().count);
+  EXPECT_EQ(4ms, statistics.get_dispatch_latency().max);
+  EXPECT_EQ(1u, statistics.get_execution_duration().count);
+  auto queueing_delays = statistics.get_callback_group_queueing_delays();
+  ASSERT_EQ(2u, queueing_delays.size());
+  const auto & default_group = queueing_delays[0].name < queueing_delays[1].name ?
+    queueing_delays[1] : queueing_delays[0];
+  const auto & other_group = queueing_delays[0].name < queueing_delays[1].name ?
+    queueing_delays[0] : queueing_delays[1];
+  EXPECT_EQ("/ns/test_executor_statistics/default_callback_group", default_group.name);
+  EXPECT_EQ(1u, default_group.queueing_delay.count);
+  EXPECT_EQ("/ns/test_executor_statistics/callback_group_1", other_group.name);
+  EXPECT_EQ(2u, other_group.queueing_delay.count);
+  EXPECT_EQ(2ms, other_group.queueing_delay.min);
+
+  statistics.reset();
+  EXPECT_EQ(0u, statistics.get_dispatch_latency().count);
+  EXPECT_EQ(0u, statistics.get_execution_duration().count);
+  EXPECT_TRUE(statistics.get_callback_group_queueing_delays().empty());
+}
+
+TEST_F(TestExecutorStatistics, executor) {
+  rclcpp::executors::SingleThreadedExecutor executor;
+  EXPECT_EQ(nullptr, executor.get_statistics());
+  auto statistics = executor.enable_statistics();
+  ASSERT_NE(nullptr, statistics);
+  EXPECT_EQ(statistics, executor.enable_statistics());
+  EXPECT_EQ(statistics, executor.get_statistics());
+
+  int calls = 0;
+  auto timer = node->create_wall_timer(
+    1ms, [&calls]() {
+      ++calls;
+      std::this_thread::sleep_for(2ms);
+    });
+  executor.add_node(node);
+  while (calls < 3) {
+    executor.spin_once(100ms);
+  }
+
+  EXPECT_LE(3u, statistics->get_execution_duration().count);
+  EXPECT_LE(2ms, statistics->get_execution_duration().min);
+  EXPECT_LE(3u, statistics->get_dispatch_latency().count);
+  auto queueing_delays = statistics->get_callback_group_queueing_delays();
+  ASSERT_EQ(1u, queueing_delays.size());
+  EXPECT_EQ("/ns/test_executor_statistics/default_callback_group", queueing_delays[0].name);
+  EXPECT_EQ(statistics->get_dispatch_latency().count, queueing_delays[0].queueing_delay.count);
+}
+
+TEST_F(TestExecutorStatistics, cpu_time) {
+  const auto thread_cpu_time = rclcpp::ExecutorStatistics::get_thread_cpu_time();
+  EXPECT_LT(0ns, thread_cpu_time);
+
+  rclcpp::executors::SingleThreadedExecutor executor;
+  auto statistics = executor.enable_statistics();
+  EXPECT_FALSE(statistics->accounts_cpu_time());
+  statistics->enable_cpu_time_accounting();
+  EXPECT_TRUE(statistics->accounts_cpu_time());
+
+  // One timer keeps the CPU busy, the other one sleeps for longer.
+  int busy_calls = 0;
+  int sleeping_calls = 0;
+  auto busy_timer = node->create_wall_timer(
+    1ms, [&busy_calls]() {
+      ++busy_calls;
+      const auto start = rclcpp::ExecutorStatistics::get_thread_cpu_time();
+      while (rclcpp::ExecutorStatistics::get_thread_cpu_time() - start < 2ms) {
+      }
+    });
+  auto sleeping_timer = node->create_wall_timer(
+    1ms, [&sleeping_calls]() {
+      ++sleeping_calls;
+      std::this_thread::sleep_for(5ms);
+    });
+  executor.add_node(node);
+  while (busy_calls < 3 || sleeping_calls < 3) {
+    executor.spin_once(100ms);
+  }
+
+  auto cpu_times = statistics->get_entity_cpu_times();
+  ASSERT_EQ(2u, cpu_times.size());
+  EXPECT_EQ(0u, cpu_times[0].name.find("/ns/test_executor_statistics/timer_"));
+  EXPECT_LE(static_cast<uint64_t>(busy_calls), cpu_times[0].executions);
+  EXPECT_LE(2ms, cpu_times[0].min);
+  EXPECT_LE(
+    cpu_times[0].min * static_cast<int64_t>(cpu_times[0].executions), cpu_times[0].total);
+  // Sleeping does not consume CPU time.
+  EXPECT_GT(5ms, cpu_times[1].max);
+  EXPECT_NE(cpu_times[0].name, cpu_times[1].name);
+
+  statistics->reset();
+  EXPECT_TRUE(statistics->get_entity_cpu_times().empty());
+}
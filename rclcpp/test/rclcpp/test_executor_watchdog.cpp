@@ -0,0 +1,90 @@
+// Copyright 2021 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+#include "rclcpp/executor_watchdog.hpp"
+#include "rclcpp/rclcpp.hpp"
+
+using namespace std::chrono_literals;
+
+class TestExecutorWatchdog : public ::testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    rclcpp::init(0, nullptr);
+    node = std::make_shared<rclcpp::Node>("test_executor_watchdog", "/ns");
+  }
+
+  void TearDown() override
+  {
+    node.reset();
+    rclcpp::shutdown();
+  }
+
+  rclcpp::Node::SharedPtr node;
+};
+
+TEST_F(TestExecutorWatchdog, describe_executable) {
+  rclcpp::AnyExecutable any_exec;
+  any_exec.timer = node->create_wall_timer(1h, []() {});
+  any_exec.callback_group = node->get_node_base_interface()->get_default_callback_group();
+  any_exec.node_base = node->get_node_base_interface();
+  const std::string description = rclcpp::describe_executable(any_exec);
+  EXPECT_EQ(0u, description.find("timer in mutually exclusive callback group"));
+  EXPECT_NE(std::string::npos, description.find("of node '/ns/test_executor_watchdog'"));
+}
+
+TEST_F(TestExecutorWatchdog, executor) {
+  EXPECT_THROW((rclcpp::ExecutorWatchdog(0ns)), std::invalid_argument);
+
+  rclcpp::executors::SingleThreadedExecutor executor;
+  EXPECT_EQ(nullptr, executor.get_watchdog());
+  auto watchdog = executor.enable_watchdog(20ms);
+  ASSERT_NE(nullptr, watchdog);
+  EXPECT_EQ(watchdog, executor.enable_watchdog(1s));
+  EXPECT_EQ(watchdog, executor.get_watchdog());
+  EXPECT_EQ(20ms, watchdog->get_threshold());
+
+  size_t fast_count = 0;
+  size_t slow_count = 0;
+  auto fast_timer = node->create_wall_timer(1ms, [&fast_count]() {++fast_count;});
+  executor.add_node(node);
+  auto start = std::chrono::steady_clock::now();
+  while (fast_count < 3u && std::chrono::steady_clock::now() - start < 10s) {
+    executor.spin_once(100ms);
+  }
+  EXPECT_EQ(0u, watchdog->get_stall_count());
+
+  fast_timer->cancel();
+  auto slow_timer = node->create_wall_timer(
+    1ms, [&slow_count]() {
+      ++slow_count;
+      std::this_thread::sleep_for(100ms);
+    });
+  start = std::chrono::steady_clock::now();
+  while (slow_count == 0u && std::chrono::steady_clock::now() - start < 10s) {
+    executor.spin_once(100ms);
+  }
+  slow_timer->cancel();
+  EXPECT_EQ(1u, watchdog->get_stall_count());
+  EXPECT_LE(100ms, watchdog->get_longest_stall());
+}
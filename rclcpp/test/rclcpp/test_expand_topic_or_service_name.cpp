@@ -36,6 +36,30 @@ TEST(TestExpandTopicOrServiceName, normal) {
   {
     ASSERT_EQ("/ns/chatter", expand_topic_or_service_name("chatter", "node", "/ns"));
   }
+  {
+    ASSERT_EQ("/chatter", expand_topic_or_service_name("/chatter", "node", "/ns"));
+    ASSERT_EQ("/ns/node/chatter", expand_topic_or_service_name("~/chatter", "node", "/ns"));
+    ASSERT_EQ("/node/chatter", expand_topic_or_service_name("/{node}/chatter", "node", "/ns"));
+  }
+}
+
+/*
+   Testing the validation of the fully qualified names, which are not expanded.
+ */
+TEST(TestExpandTopicOrServiceName, fully_qualified_exceptions) {
+  using rclcpp::expand_topic_or_service_name;
+  EXPECT_THROW(
+    expand_topic_or_service_name("/chatter", "invalid_node?", "/ns"),
+    rclcpp::exceptions::InvalidNodeNameError);
+  EXPECT_THROW(
+    expand_topic_or_service_name("/chatter", "node", "/invalid_ns?"),
+    rclcpp::exceptions::InvalidNamespaceError);
+  EXPECT_THROW(
+    expand_topic_or_service_name("/chatter/42invalid", "node", "/ns"),
+    rclcpp::exceptions::InvalidTopicNameError);
+  EXPECT_THROW(
+    expand_topic_or_service_name("/chatter//invalid", "node", "/ns", true),
+    rclcpp::exceptions::InvalidServiceNameError);
 }
 
 /*
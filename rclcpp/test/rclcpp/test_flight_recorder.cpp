@@ -0,0 +1,226 @@
+// Copyright 2021 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "rcpputils/filesystem_helper.hpp"
+
+#include "rclcpp/create_flight_recorder.hpp"
+#include "rclcpp/rclcpp.hpp"
+#include "rclcpp/serialization.hpp"
+#include "test_msgs/msg/basic_types.hpp"
+#include "test_msgs/msg/strings.hpp"
+
+using namespace std::chrono_literals;
+
+namespace
+{
+
+rcl_time_point_value_t
+now()
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+    std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+std::string
+temp_file_path(const std::string & name)
+{
+  return (rcpputils::fs::temp_directory_path() / name).string();
+}
+
+rclcpp::SerializedMessage
+serialize_strings(const std::string & value)
+{
+  test_msgs::msg::Strings message;
+  message.string_value = value;
+  rclcpp::SerializedMessage serialized_message;
+  rclcpp::Serialization<test_msgs::msg::Strings>().serialize_message(
+    &message, &serialized_message);
+  return serialized_message;
+}
+
+std::string
+deserialize_strings(const rclcpp::SerializedMessage & serialized_message)
+{
+  test_msgs::msg::Strings message;
+  rclcpp::Serialization<test_msgs::msg::Strings>().deserialize_message(
+    &serialized_message, &message);
+  return message.string_value;
+}
+
+const std::vector<rclcpp::FlightRecorderTopic> recorded_topics = {
+  {"/strings", "test_msgs/msg/Strings"}, {"/other_strings", "test_msgs/msg/Strings"}};
+
+}  // namespace
+
+TEST(TestFlightRecorder, construction_errors) {
+  rclcpp::FlightRecorderOptions options;
+  EXPECT_THROW(rclcpp::FlightRecorder({}, options), std::invalid_argument);
+  options.capacity = 16;
+  EXPECT_THROW(rclcpp::FlightRecorder(recorded_topics, options), std::invalid_argument);
+  options.capacity = 1024;
+  options.duration = 0s;
+  EXPECT_THROW(rclcpp::FlightRecorder(recorded_topics, options), std::invalid_argument);
+
+  rclcpp::FlightRecorder recorder(recorded_topics, rclcpp::FlightRecorderOptions());
+  auto serialized_message = serialize_strings("value");
+  EXPECT_THROW(
+    recorder.record(2u, serialized_message.get_rcl_serialized_message(), now()),
+    std::out_of_range);
+}
+
+TEST(TestFlightRecorder, overwrite_oldest_messages) {
+  rclcpp::FlightRecorderOptions options;
+  options.capacity = 1024;
+  rclcpp::FlightRecorder recorder(recorded_topics, options);
+
+  for (size_t i = 0; i < 100; ++i) {
+    auto serialized_message = serialize_strings("message " + std::to_string(i));
+    recorder.record(i % 2, serialized_message.get_rcl_serialized_message(), now());
+  }
+  EXPECT_EQ(100u, recorder.get_recorded_message_count());
+  EXPECT_EQ(0u, recorder.get_dropped_message_count());
+  const size_t number_of_messages = recorder.get_number_of_messages();
+  EXPECT_GT(number_of_messages, 0u);
+  EXPECT_LT(number_of_messages, 100u);
+
+  // Too large for the ring.
+  auto large_message = serialize_strings(std::string(2048, 'x'));
+  recorder.record(0, large_message.get_rcl_serialized_message(), now());
+  EXPECT_EQ(1u, recorder.get_dropped_message_count());
+  EXPECT_EQ(number_of_messages, recorder.get_number_of_messages());
+
+  const std::string dump_path = temp_file_path("test_flight_recorder_overwrite.bin");
+  EXPECT_EQ(number_of_messages, recorder.dump(dump_path));
+  const auto messages = rclcpp::FlightRecorder::read_recording(dump_path);
+  std::remove(dump_path.c_str());
+  ASSERT_EQ(number_of_messages, messages.size());
+  // The newest messages are kept, in order.
+  for (size_t i = 0; i < messages.size(); ++i) {
+    const size_t index = 100 - messages.size() + i;
+    EXPECT_EQ(recorded_topics[index % 2].name, messages[i].topic_name);
+    EXPECT_EQ("test_msgs/msg/Strings", messages[i].topic_type);
+    EXPECT_EQ(
+      "message " + std::to_string(index), deserialize_strings(messages[i].serialized_message));
+  }
+}
+
+TEST(TestFlightRecorder, dump_duration) {
+  rclcpp::FlightRecorderOptions options;
+  options.duration = 10s;
+  rclcpp::FlightRecorder recorder(recorded_topics, options);
+
+  auto old_message = serialize_strings("old");
+  recorder.record(0, old_message.get_rcl_serialized_message(), now() - std::chrono::nanoseconds(20s).count());
+  auto new_message = serialize_strings("new");
+  recorder.record(1, new_message.get_rcl_serialized_message(), now());
+  EXPECT_EQ(2u, recorder.get_number_of_messages());
+
+  const std::string dump_path = temp_file_path("test_flight_recorder_duration.bin");
+  EXPECT_EQ(1u, recorder.dump(dump_path));
+  const auto messages = rclcpp::FlightRecorder::read_recording(dump_path);
+  std::remove(dump_path.c_str());
+  ASSERT_EQ(1u, messages.size());
+  EXPECT_EQ("/other_strings", messages[0].topic_name);
+  EXPECT_EQ("new", deserialize_strings(messages[0].serialized_message));
+}
+
+TEST(TestFlightRecorder, invalid_recording) {
+  const std::string path = temp_file_path("test_flight_recorder_invalid.bin");
+  EXPECT_THROW(rclcpp::FlightRecorder::read_recording(path), std::runtime_error);
+  FILE * file = std::fopen(path.c_str(), "wb");
+  ASSERT_NE(nullptr, file);
+  std::fputs("not a recording, but long enough to hold the header of one", file);
+  std::fclose(file);
+  EXPECT_THROW(rclcpp::FlightRecorder::read_recording(path), std::runtime_error);
+  std::remove(path.c_str());
+}
+
+#ifndef _WIN32
+TEST(TestFlightRecorder, file_mapped_ring) {
+  rclcpp::FlightRecorderOptions options;
+  options.capacity = 4096;
+  options.file_path = temp_file_path("test_flight_recorder_ring.bin");
+  {
+    rclcpp::FlightRecorder recorder(recorded_topics, options);
+    for (size_t i = 0; i < 10; ++i) {
+      auto serialized_message = serialize_strings("message " + std::to_string(i));
+      recorder.record(0, serialized_message.get_rcl_serialized_message(), now());
+    }
+    // The file has the messages while recording, as it would after a crash.
+    EXPECT_EQ(10u, rclcpp::FlightRecorder::read_recording(options.file_path).size());
+  }
+  const auto messages = rclcpp::FlightRecorder::read_recording(options.file_path);
+  std::remove(options.file_path.c_str());
+  ASSERT_EQ(10u, messages.size());
+  EXPECT_EQ("message 0", deserialize_strings(messages.front().serialized_message));
+  EXPECT_EQ("message 9", deserialize_strings(messages.back().serialized_message));
+}
+#endif
+
+class TestCreateFlightRecorder : public ::testing::Test
+{
+protected:
+  void SetUp()
+  {
+    rclcpp::init(0, nullptr);
+  }
+
+  void TearDown()
+  {
+    rclcpp::shutdown();
+  }
+};
+
+TEST_F(TestCreateFlightRecorder, record_intra_process_publishers) {
+  auto node = std::make_shared<rclcpp::Node>(
+    "test_flight_recorder", rclcpp::NodeOptions().use_intra_process_comms(true));
+  auto recorder = rclcpp::create_flight_recorder(
+    node, {{"basic_types", "test_msgs/msg/BasicTypes"}}, rclcpp::QoS(10));
+  auto publisher = node->create_publisher<test_msgs::msg::BasicTypes>("basic_types", 10);
+
+  rclcpp::executors::SingleThreadedExecutor executor;
+  executor.add_node(node);
+  const auto end = std::chrono::steady_clock::now() + 5s;
+  int64_t value = 0;
+  while (recorder->get_number_of_messages() < 3u && std::chrono::steady_clock::now() < end) {
+    test_msgs::msg::BasicTypes message;
+    message.int64_value = ++value;
+    publisher->publish(message);
+    executor.spin_some(100ms);
+  }
+  ASSERT_GE(recorder->get_number_of_messages(), 3u);
+
+  const std::string dump_path = temp_file_path("test_flight_recorder_node.bin");
+  recorder->dump(dump_path);
+  const auto messages = rclcpp::FlightRecorder::read_recording(dump_path);
+  std::remove(dump_path.c_str());
+  ASSERT_GE(messages.size(), 3u);
+  EXPECT_EQ("basic_types", messages.back().topic_name);
+  test_msgs::msg::BasicTypes message;
+  rclcpp::Serialization<test_msgs::msg::BasicTypes>().deserialize_message(
+    &messages.back().serialized_message, &message);
+  EXPECT_GT(message.int64_value, 0);
+  EXPECT_LE(message.int64_value, value);
+}
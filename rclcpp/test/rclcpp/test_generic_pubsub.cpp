@@ -15,6 +15,7 @@
 
 #include <gmock/gmock.h>
 
+#include <algorithm>
 #include <future>
 #include <memory>
 #include <string>
@@ -194,3 +195,102 @@ TEST_F(RclcppGenericNodeFixture, generic_publisher_uses_qos)
   // It normally takes < 20ms, 5s chosen as "a very long time"
   ASSERT_TRUE(wait_for(connected, 5s));
 }
+
+TEST_F(RclcppGenericNodeFixture, publisher_and_subscriber_work_intra_process)
+{
+  using namespace std::chrono_literals;
+  std::string topic_name = "/string_topic_intra_process";
+  std::string type = "test_msgs/msg/Strings";
+
+  rclcpp::PublisherOptions publisher_options;
+  publisher_options.use_intra_process_comm = rclcpp::IntraProcessSetting::Enable;
+  auto publisher = node_->create_generic_publisher(
+    topic_name, type, rclcpp::QoS(10), publisher_options);
+
+  std::vector<std::string> messages;
+  rclcpp::SubscriptionOptions subscription_options;
+  subscription_options.use_intra_process_comm = rclcpp::IntraProcessSetting::Enable;
+  auto subscription = node_->create_generic_subscription(
+    topic_name, type, rclcpp::QoS(10),
+    [&messages](std::shared_ptr<rclcpp::SerializedMessage> message) {
+      test_msgs::msg::Strings string_message;
+      rclcpp::Serialization<test_msgs::msg::Strings> serializer;
+      serializer.deserialize_message(message.get(), &string_message);
+      messages.push_back(string_message.string_value);
+    },
+    subscription_options);
+
+  EXPECT_EQ(1u, publisher->get_intra_process_subscription_count());
+
+  publisher->publish(serialize_string_message("Hello World"));
+  publisher->publish(
+    std::make_shared<const rclcpp::SerializedMessage>(serialize_string_message("Hello again")));
+
+  ASSERT_TRUE(wait_for([&messages]() {return messages.size() >= 2u;}, 5s));
+  // The middleware copies of the messages received intra-process are ignored.
+  rclcpp::spin_some(node_);
+  EXPECT_THAT(messages, ElementsAre("Hello World", "Hello again"));
+}
+
+TEST_F(RclcppGenericNodeFixture, publish_and_receive_chunks_intra_process)
+{
+  using namespace std::chrono_literals;
+  std::string topic_name = "/string_topic_chunks";
+  std::string type = "test_msgs/msg/Strings";
+
+  rclcpp::PublisherOptions publisher_options;
+  publisher_options.use_intra_process_comm = rclcpp::IntraProcessSetting::Enable;
+  auto publisher = node_->create_generic_publisher(
+    topic_name, type, rclcpp::QoS(10), publisher_options);
+
+  std::vector<std::string> messages;
+  std::vector<uint8_t> received;
+  rclcpp::SubscriptionOptions subscription_options;
+  subscription_options.use_intra_process_comm = rclcpp::IntraProcessSetting::Enable;
+  auto subscription = node_->create_generic_subscription(
+    topic_name, type, rclcpp::QoS(10),
+    GenericSubscription::make_chunk_callback(
+      [&messages, &received](
+        const uint8_t * chunk, size_t size, size_t offset, size_t message_size) {
+        EXPECT_LE(size, 4u);
+        EXPECT_EQ(received.size(), offset);
+        received.insert(received.end(), chunk, chunk + size);
+        if (offset + size == message_size) {
+          rclcpp::SerializedMessage message(message_size);
+          std::copy(received.begin(), received.end(), message.get_rcl_serialized_message().buffer);
+          message.get_rcl_serialized_message().buffer_length = message_size;
+          test_msgs::msg::Strings string_message;
+          rclcpp::Serialization<test_msgs::msg::Strings>().deserialize_message(
+            &message, &string_message);
+          messages.push_back(string_message.string_value);
+          received.clear();
+        }
+      }, 4),
+    subscription_options);
+
+  const rclcpp::SerializedMessage chunked = serialize_string_message("Hello in chunks");
+  const auto & chunked_buffer = chunked.get_rcl_serialized_message();
+  size_t written = 0;
+  publisher->publish_chunks(
+    chunked.size(),
+    [&chunked_buffer, &written](uint8_t * chunk, size_t capacity) {
+      const size_t size = std::min<size_t>(3u, capacity);
+      std::copy(chunked_buffer.buffer + written, chunked_buffer.buffer + written + size, chunk);
+      written += size;
+      return size;
+    });
+  const rclcpp::SerializedMessage buffered = serialize_string_message("Hello from a buffer");
+  publisher->publish_buffer(buffered.get_rcl_serialized_message().buffer, buffered.size());
+
+  ASSERT_TRUE(wait_for([&messages]() {return messages.size() >= 2u;}, 5s));
+  rclcpp::spin_some(node_);
+  EXPECT_THAT(messages, ElementsAre("Hello in chunks", "Hello from a buffer"));
+
+  EXPECT_THROW(
+    publisher->publish_chunks(8u, [](uint8_t *, size_t) {return size_t(0);}),
+    std::runtime_error);
+  EXPECT_THROW(publisher->publish_buffer(nullptr, 0u), std::runtime_error);
+  EXPECT_THROW(
+    GenericSubscription::make_chunk_callback([](const uint8_t *, size_t, size_t, size_t) {}, 0u),
+    std::invalid_argument);
+}
@@ -0,0 +1,143 @@
+// Copyright 2021 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "rclcpp/rclcpp.hpp"
+#include "test_msgs/msg/empty.hpp"
+
+using namespace std::chrono_literals;
+
+class TestGraphChangeSubscription : public ::testing::Test
+{
+protected:
+  void SetUp()
+  {
+    rclcpp::init(0, nullptr);
+    node_ = std::make_shared<rclcpp::Node>("graph_watcher", "/ns");
+    executor_.add_node(node_);
+  }
+
+  void TearDown()
+  {
+    executor_.remove_node(node_);
+    node_.reset();
+    rclcpp::shutdown();
+  }
+
+  /// Spin until a change matching the predicate is received, or the timeout elapses.
+  template<typename PredicateT>
+  bool
+  spin_until_change(PredicateT predicate, std::chrono::nanoseconds timeout = 5s)
+  {
+    auto end = std::chrono::steady_clock::now() + timeout;
+    while (std::chrono::steady_clock::now() < end) {
+      executor_.spin_some(100ms);
+      if (std::any_of(changes_.begin(), changes_.end(), predicate)) {
+        return true;
+      }
+      std::this_thread::sleep_for(10ms);
+    }
+    return false;
+  }
+
+  rclcpp::Node::SharedPtr node_;
+  rclcpp::executors::SingleThreadedExecutor executor_;
+  std::vector<rclcpp::GraphChange> changes_;
+};
+
+TEST_F(TestGraphChangeSubscription, construction_errors) {
+  EXPECT_THROW(
+    rclcpp::GraphChangeSubscription(
+      nullptr, {}, true, [](const std::vector<rclcpp::GraphChange> &) {}),
+    std::invalid_argument);
+  EXPECT_THROW(
+    rclcpp::GraphChangeSubscription(node_->get_node_graph_interface(), {}, true, nullptr),
+    std::invalid_argument);
+}
+
+TEST_F(TestGraphChangeSubscription, endpoint_changes) {
+  auto subscription = rclcpp::create_graph_change_subscription(
+    node_, {"/ns/watched_topic"}, false,
+    [this](const std::vector<rclcpp::GraphChange> & changes) {
+      changes_.insert(changes_.end(), changes.begin(), changes.end());
+    });
+
+  auto other_node = std::make_shared<rclcpp::Node>("other_node", "/ns");
+  auto unwatched_publisher =
+    other_node->create_publisher<test_msgs::msg::Empty>("unwatched_topic", 10);
+  auto publisher = other_node->create_publisher<test_msgs::msg::Empty>("watched_topic", 10);
+
+  ASSERT_TRUE(
+    spin_until_change(
+      [](const rclcpp::GraphChange & change) {
+        return change.type == rclcpp::GraphChangeType::EndpointAdded;
+      }));
+  for (const auto & change : changes_) {
+    // Neither the other topic nor the node itself are watched.
+    ASSERT_EQ(rclcpp::GraphChangeType::EndpointAdded, change.type);
+    EXPECT_EQ("/ns/watched_topic", change.topic_name);
+    EXPECT_EQ("other_node", change.node_name);
+    EXPECT_EQ("/ns", change.node_namespace);
+    ASSERT_TRUE(change.endpoint_info.has_value());
+    EXPECT_EQ(rclcpp::EndpointType::Publisher, change.endpoint_info->endpoint_type());
+    EXPECT_EQ("test_msgs/msg/Empty", change.endpoint_info->topic_type());
+  }
+
+  changes_.clear();
+  publisher.reset();
+  EXPECT_TRUE(
+    spin_until_change(
+      [](const rclcpp::GraphChange & change) {
+        return change.type == rclcpp::GraphChangeType::EndpointRemoved &&
+        change.topic_name == "/ns/watched_topic";
+      }));
+}
+
+TEST_F(TestGraphChangeSubscription, node_changes) {
+  auto subscription = rclcpp::create_graph_change_subscription(
+    node_, {}, true,
+    [this](const std::vector<rclcpp::GraphChange> & changes) {
+      changes_.insert(changes_.end(), changes.begin(), changes.end());
+    });
+
+  auto other_node = std::make_shared<rclcpp::Node>("other_node", "/ns");
+  ASSERT_TRUE(
+    spin_until_change(
+      [](const rclcpp::GraphChange & change) {
+        return change.type == rclcpp::GraphChangeType::NodeAdded &&
+        change.node_name == "other_node" && change.node_namespace == "/ns";
+      }));
+  for (const auto & change : changes_) {
+    EXPECT_FALSE(change.endpoint_info.has_value());
+    EXPECT_TRUE(change.topic_name.empty());
+  }
+
+  changes_.clear();
+  other_node.reset();
+  EXPECT_TRUE(
+    spin_until_change(
+      [](const rclcpp::GraphChange & change) {
+        return change.type == rclcpp::GraphChangeType::NodeRemoved &&
+        change.node_name == "other_node";
+      }));
+}
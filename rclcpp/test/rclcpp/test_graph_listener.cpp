@@ -13,12 +13,17 @@
 // limitations under the License.
 
 #include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstdint>
 #include <memory>
+#include <thread>
 
 #include "rclcpp/contexts/default_context.hpp"
 #include "rclcpp/graph_listener.hpp"
 #include "rclcpp/node_interfaces/node_graph.hpp"
 #include "rclcpp/rclcpp.hpp"
+#include "test_msgs/msg/empty.hpp"
 
 #include "../mocking_utils/patch.hpp"
 #include "../utils/rclcpp_gtest_macros.hpp"
@@ -207,6 +212,40 @@ TEST_F(TestGraphListener, test_graph_listener_add_remove_node) {
   EXPECT_FALSE(graph_listener()->has_node(node_graph()));
 }
 
+/* The graph generation changes with the graph while a node is watched */
+TEST_F(TestGraphListener, graph_generation) {
+  using namespace std::chrono_literals;
+  auto wait_for_generation = [this](auto predicate) {
+      auto start = std::chrono::steady_clock::now();
+      while (!predicate(graph_listener()->get_graph_generation())) {
+        if (std::chrono::steady_clock::now() - start > 5s) {
+          return false;
+        }
+        std::this_thread::sleep_for(1ms);
+      }
+      return true;
+    };
+
+  // Not watching any node.
+  graph_listener()->start_if_not_started();
+  EXPECT_EQ(0u, graph_listener()->get_graph_generation());
+
+  // The event keeps the node watched.
+  auto graph_event = node_graph()->get_graph_event();
+  graph_listener()->add_node(node_graph());
+  ASSERT_TRUE(wait_for_generation([](uint64_t generation) {return generation != 0u;}));
+
+  const uint64_t generation = graph_listener()->get_graph_generation();
+  auto publisher = node()->create_publisher<test_msgs::msg::Empty>("graph_generation", 10);
+  EXPECT_TRUE(
+    wait_for_generation(
+      [generation](uint64_t new_generation) {return new_generation != generation;}));
+
+  graph_listener()->remove_node(node_graph());
+  graph_listener()->shutdown();
+  EXPECT_EQ(0u, graph_listener()->get_graph_generation());
+}
+
 /* Add/Remove node error usage */
 TEST_F(TestGraphListener, test_errors_graph_listener_add_remove_node) {
   // nullptrs tests
@@ -14,6 +14,7 @@
 
 #include <gtest/gtest.h>
 
+#include <chrono>
 #include <stdexcept>
 #include <string>
 #include <vector>
@@ -65,6 +66,58 @@ TEST(TestInitOptions, test_initialize_logging) {
   }
 }
 
+TEST(TestInitOptions, test_reusable_context) {
+  auto options = rclcpp::InitOptions();
+  EXPECT_FALSE(options.reusable_context());
+  options.reusable_context(true);
+  EXPECT_TRUE(options.reusable_context());
+  rclcpp::InitOptions copy(options);
+  EXPECT_TRUE(copy.reusable_context());
+  rclcpp::InitOptions assigned;
+  assigned = options;
+  EXPECT_TRUE(assigned.reusable_context());
+}
+
+TEST(TestInitOptions, test_sigint_shutdown_deadline) {
+  auto options = rclcpp::InitOptions();
+  EXPECT_EQ(std::chrono::nanoseconds::zero(), options.sigint_shutdown_deadline());
+  options.sigint_shutdown_deadline(std::chrono::seconds(2));
+  EXPECT_EQ(std::chrono::seconds(2), options.sigint_shutdown_deadline());
+  rclcpp::InitOptions copy(options);
+  EXPECT_EQ(std::chrono::seconds(2), copy.sigint_shutdown_deadline());
+  rclcpp::InitOptions assigned;
+  assigned = options;
+  EXPECT_EQ(std::chrono::seconds(2), assigned.sigint_shutdown_deadline());
+}
+
+TEST(TestInitOptions, test_startup_profiling) {
+  auto options = rclcpp::InitOptions();
+  EXPECT_FALSE(options.startup_profiling());
+
+  options.startup_profiling(true);
+  EXPECT_TRUE(options.startup_profiling());
+  rclcpp::InitOptions copy(options);
+  EXPECT_TRUE(copy.startup_profiling());
+  rclcpp::InitOptions assigned;
+  assigned = options;
+  EXPECT_TRUE(assigned.startup_profiling());
+}
+
+TEST(TestInitOptions, test_allocation_tracking) {
+  auto options = rclcpp::InitOptions();
+  EXPECT_FALSE(options.allocation_tracking().enabled);
+
+  options.allocation_tracking({true, 4});
+  EXPECT_TRUE(options.allocation_tracking().enabled);
+  EXPECT_EQ(4u, options.allocation_tracking().max_backtraces_per_callback);
+
+  auto options_copy = rclcpp::InitOptions(options);
+  EXPECT_TRUE(options_copy.allocation_tracking().enabled);
+  rclcpp::InitOptions options_assigned;
+  options_assigned = options;
+  EXPECT_EQ(4u, options_assigned.allocation_tracking().max_backtraces_per_callback);
+}
+
 TEST(TestInitOptions, test_domain_id) {
   rcl_allocator_t allocator = rcl_get_default_allocator();
   auto options = rclcpp::InitOptions(allocator);
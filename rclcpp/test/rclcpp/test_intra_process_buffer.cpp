@@ -13,8 +13,10 @@
 // limitations under the License.
 
 
+#include <cstdint>
 #include <memory>
 #include <utility>
+#include <vector>
 
 #include "gtest/gtest.h"
 
@@ -238,3 +240,90 @@ TEST(TestIntraProcessBuffer, unique_buffer_consume) {
   EXPECT_EQ(original_value, *popped_unique_msg);
   EXPECT_EQ(original_message_pointer, popped_message_pointer);
 }
+
+/*
+  Consume unique_ptr data from an intra-process buffer with an implementation that stores
+  shared_ptr, the content of the message is moved when nobody else shares it
+  - Request unique_ptr while the message is shared, a copy is expected
+  - Request unique_ptr once the message is not shared anymore, a move is expected
+ */
+TEST(TestIntraProcessBuffer, shared_buffer_consume_unique_copy_on_write) {
+  using MessageT = std::vector<int>;
+  using Alloc = std::allocator<void>;
+  using Deleter = std::default_delete<MessageT>;
+  using SharedMessageT = std::shared_ptr<const MessageT>;
+  using UniqueMessageT = std::unique_ptr<MessageT, Deleter>;
+  using SharedIntraProcessBufferT = rclcpp::experimental::buffers::TypedIntraProcessBuffer<
+    MessageT, Alloc, Deleter, SharedMessageT>;
+
+  auto buffer_impl =
+    std::make_unique<rclcpp::experimental::buffers::RingBufferImplementation<SharedMessageT>>(2);
+
+  SharedIntraProcessBufferT intra_process_buffer(std::move(buffer_impl));
+
+  auto original_shared_msg = std::make_shared<MessageT>(MessageT{1, 2, 3});
+  auto original_data_pointer = reinterpret_cast<std::uintptr_t>(original_shared_msg->data());
+
+  intra_process_buffer.add_shared(original_shared_msg);
+
+  UniqueMessageT popped_unique_msg = intra_process_buffer.consume_unique();
+
+  EXPECT_EQ(MessageT({1, 2, 3}), *original_shared_msg);
+  EXPECT_EQ(*original_shared_msg, *popped_unique_msg);
+  EXPECT_NE(original_data_pointer, reinterpret_cast<std::uintptr_t>(popped_unique_msg->data()));
+
+  intra_process_buffer.add_shared(std::move(original_shared_msg));
+
+  popped_unique_msg = intra_process_buffer.consume_unique();
+
+  EXPECT_EQ(MessageT({1, 2, 3}), *popped_unique_msg);
+  EXPECT_EQ(original_data_pointer, reinterpret_cast<std::uintptr_t>(popped_unique_msg->data()));
+}
+
+/*
+   Buffer storing the messages in the form they were added in
+  - Messages added unique are taken unique or shared without a copy
+  - Messages added shared are only copied if still shared when taken unique
+ */
+TEST(TestIntraProcessBuffer, stored_message_buffer) {
+  using MessageT = std::vector<int>;
+  using Alloc = std::allocator<void>;
+  using Deleter = std::default_delete<MessageT>;
+  using SharedMessageT = std::shared_ptr<const MessageT>;
+  using UniqueMessageT = std::unique_ptr<MessageT, Deleter>;
+  using StoredMessageT = rclcpp::experimental::buffers::IntraProcessMessage<MessageT, Deleter>;
+  using StoredIntraProcessBufferT = rclcpp::experimental::buffers::TypedIntraProcessBuffer<
+    MessageT, Alloc, Deleter, StoredMessageT>;
+
+  auto buffer_impl =
+    std::make_unique<rclcpp::experimental::buffers::RingBufferImplementation<StoredMessageT>>(2);
+
+  StoredIntraProcessBufferT intra_process_buffer(std::move(buffer_impl));
+
+  EXPECT_FALSE(intra_process_buffer.use_take_shared_method());
+  EXPECT_TRUE(intra_process_buffer.stores_shared_messages());
+
+  auto unique_msg = std::make_unique<MessageT>(MessageT{1, 2, 3});
+  auto original_message_pointer = reinterpret_cast<std::uintptr_t>(unique_msg.get());
+  intra_process_buffer.add_unique(std::move(unique_msg));
+  UniqueMessageT popped_unique_msg = intra_process_buffer.consume_unique();
+  EXPECT_EQ(original_message_pointer, reinterpret_cast<std::uintptr_t>(popped_unique_msg.get()));
+
+  intra_process_buffer.add_unique(std::move(popped_unique_msg));
+  SharedMessageT popped_shared_msg = intra_process_buffer.consume_shared();
+  EXPECT_EQ(original_message_pointer, reinterpret_cast<std::uintptr_t>(popped_shared_msg.get()));
+
+  // Still shared with popped_shared_msg, so copied.
+  auto original_data_pointer = reinterpret_cast<std::uintptr_t>(popped_shared_msg->data());
+  intra_process_buffer.add_shared(popped_shared_msg);
+  popped_unique_msg = intra_process_buffer.consume_unique();
+  EXPECT_EQ(*popped_shared_msg, *popped_unique_msg);
+  EXPECT_NE(original_data_pointer, reinterpret_cast<std::uintptr_t>(popped_unique_msg->data()));
+
+  // Released by the other owners before being taken, so moved.
+  intra_process_buffer.add_shared(std::move(popped_shared_msg));
+  popped_unique_msg = intra_process_buffer.consume_unique();
+  EXPECT_EQ(MessageT({1, 2, 3}), *popped_unique_msg);
+  EXPECT_EQ(original_data_pointer, reinterpret_cast<std::uintptr_t>(popped_unique_msg->data()));
+  EXPECT_FALSE(intra_process_buffer.has_data());
+}
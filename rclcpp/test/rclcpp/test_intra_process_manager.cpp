@@ -14,6 +14,7 @@
 
 #include <gmock/gmock.h>
 
+#include <atomic>
 #include <cstdint>
 #include <memory>
 #include <string>
@@ -22,6 +23,7 @@
 
 #define RCLCPP_BUILDING_LIBRARY 1
 #include "rclcpp/allocator/allocator_common.hpp"
+#include "rclcpp/experimental/subscription_intra_process_input.hpp"
 #include "rclcpp/macros.hpp"
 #include "rclcpp/qos.hpp"
 #include "rmw/types.h"
@@ -54,7 +56,8 @@ public:
 
   explicit PublisherBase(rclcpp::QoS qos = rclcpp::QoS(10))
   : qos_profile(qos),
-    topic_name("topic")
+    topic_name("topic"),
+    serialized(false)
   {}
 
   virtual ~PublisherBase()
@@ -79,6 +82,18 @@ public:
     return qos_profile;
   }
 
+  bool
+  is_serialized() const
+  {
+    return serialized;
+  }
+
+  const rmw_gid_t &
+  get_gid() const
+  {
+    return gid;
+  }
+
   bool
   operator==(const rmw_gid_t & gid) const
   {
@@ -95,8 +110,11 @@ public:
 
   rclcpp::QoS qos_profile;
   std::string topic_name;
+  bool serialized;
+  rmw_gid_t gid{};
   uint64_t intra_process_publisher_id_;
   IntraProcessManagerWeakPtr weak_ipm_;
+  std::atomic_size_t intra_process_subscription_count_{0};
 };
 
 template<typename T, typename Alloc = std::allocator<void>>
@@ -173,7 +191,7 @@ public:
   ConstMessageSharedPtr shared_msg;
   MessageUniquePtr unique_msg;
 
-  std::uintptr_t message_ptr;
+  std::uintptr_t message_ptr = 0;
 };
 
 }  // namespace mock
@@ -195,7 +213,7 @@ public:
   RCLCPP_SMART_PTR_ALIASES_ONLY(SubscriptionIntraProcessBase)
 
   explicit SubscriptionIntraProcessBase(rclcpp::QoS qos = rclcpp::QoS(10))
-  : qos_profile(qos), topic_name("topic")
+  : qos_profile(qos), topic_name("topic"), serialized(false)
   {}
 
   virtual ~SubscriptionIntraProcessBase() {}
@@ -203,12 +221,36 @@ public:
   virtual bool
   use_take_shared_method() const = 0;
 
+  bool
+  is_serialized() const
+  {
+    return serialized;
+  }
+
   QoS
   get_actual_qos()
   {
     return qos_profile;
   }
 
+  bool
+  records_message_info() const
+  {
+    return false;
+  }
+
+  bool
+  is_accepting_messages() const
+  {
+    return accepting_messages;
+  }
+
+  void
+  note_dropped_message()
+  {
+    ++dropped_messages;
+  }
+
   const char *
   get_topic_name()
   {
@@ -217,13 +259,18 @@ public:
 
   rclcpp::QoS qos_profile;
   const char * topic_name;
+  bool serialized;
+  bool accepting_messages = true;
+  size_t dropped_messages = 0;
 };
 
 template<
   typename MessageT,
   typename Alloc = std::allocator<void>,
   typename Deleter = std::default_delete<MessageT>>
-class SubscriptionIntraProcessBuffer : public SubscriptionIntraProcessBase
+class SubscriptionIntraProcessBuffer
+  : public SubscriptionIntraProcessBase,
+  public rclcpp::experimental::SubscriptionIntraProcessInput<MessageT, Alloc, Deleter>
 {
 public:
   RCLCPP_SMART_PTR_DEFINITIONS(SubscriptionIntraProcessBuffer)
@@ -235,13 +282,13 @@ public:
   }
 
   void
-  provide_intra_process_message(std::shared_ptr<const MessageT> msg)
+  provide_intra_process_message(std::shared_ptr<const MessageT> msg) override
   {
     buffer->add(msg);
   }
 
   void
-  provide_intra_process_message(std::unique_ptr<MessageT> msg)
+  provide_intra_process_message(std::unique_ptr<MessageT, Deleter> msg) override
   {
     buffer->add(std::move(msg));
   }
@@ -335,6 +382,32 @@ void Publisher<T, Alloc>::publish(MessageUniquePtr msg)
 }
 
 }  // namespace mock
+
+template<>
+struct TypeAdapter<std::string, rcl_interfaces::msg::Log>
+{
+  using is_specialized = std::true_type;
+  using custom_type = std::string;
+  using ros_message_type = rcl_interfaces::msg::Log;
+
+  static void
+  convert_to_ros_message(const custom_type & source, ros_message_type & destination)
+  {
+    ++number_of_conversions_to_ros_message;
+    destination.msg = source;
+  }
+
+  static void
+  convert_to_custom(const ros_message_type & source, custom_type & destination)
+  {
+    destination = source.msg;
+  }
+
+  static size_t number_of_conversions_to_ros_message;
+};
+
+size_t TypeAdapter<std::string, rcl_interfaces::msg::Log>::number_of_conversions_to_ros_message = 0;
+
 }  // namespace rclcpp
 
 /*
@@ -403,6 +476,137 @@ TEST(TestIntraProcessManager, add_pub_sub) {
   ASSERT_EQ(1u, p3_subs);
 }
 
+/*
+   This tests that the matching only involves the entities of the same topic:
+   - Publishers and subscriptions are added and removed on two topics, in any order.
+   - A topic left without any entity matches again the entities added to it later.
+ */
+TEST(TestIntraProcessManager, match_by_topic) {
+  using IntraProcessManagerT = rclcpp::experimental::IntraProcessManager;
+  using MessageT = rcl_interfaces::msg::Log;
+  using PublisherT = rclcpp::mock::Publisher<MessageT>;
+  using SubscriptionIntraProcessT = rclcpp::experimental::mock::SubscriptionIntraProcess<MessageT>;
+
+  auto ipm = std::make_shared<IntraProcessManagerT>();
+
+  auto p1 = std::make_shared<PublisherT>();
+  auto p2 = std::make_shared<PublisherT>();
+  p2->topic_name = "other_topic";
+  auto s1 = std::make_shared<SubscriptionIntraProcessT>();
+  auto s2 = std::make_shared<SubscriptionIntraProcessT>();
+  s2->topic_name = "other_topic";
+
+  auto s1_id = ipm->add_subscription(s1);
+  auto p1_id = ipm->add_publisher(p1);
+  auto p2_id = ipm->add_publisher(p2);
+  auto s2_id = ipm->add_subscription(s2);
+  EXPECT_EQ(1u, ipm->get_subscription_count(p1_id));
+  EXPECT_EQ(1u, ipm->get_subscription_count(p2_id));
+
+  ipm->remove_subscription(s2_id);
+  EXPECT_EQ(1u, ipm->get_subscription_count(p1_id));
+  EXPECT_EQ(0u, ipm->get_subscription_count(p2_id));
+
+  // The topic is empty once its last publisher is removed.
+  ipm->remove_publisher(p2_id);
+  p2_id = ipm->add_publisher(p2);
+  s2_id = ipm->add_subscription(s2);
+  EXPECT_EQ(1u, ipm->get_subscription_count(p2_id));
+
+  ipm->remove_subscription(s1_id);
+  ipm->remove_publisher(p1_id);
+  s1_id = ipm->add_subscription(s1);
+  p1_id = ipm->add_publisher(p1);
+  EXPECT_EQ(1u, ipm->get_subscription_count(p1_id));
+  EXPECT_EQ(1u, ipm->get_subscription_count(p2_id));
+
+  // Removing an id which is not indexed does nothing.
+  ipm->remove_subscription(42);
+  EXPECT_EQ(1u, ipm->get_subscription_count(p1_id));
+}
+
+/*
+   This tests the report of the matched publishers and subscriptions:
+   - Creates 2 publishers on different topics and 2 subscriptions to the first topic,
+     one taking shared messages and one taking their ownership.
+   - The connections are expected to be the pairs of the first publisher, sorted by ids.
+ */
+TEST(TestIntraProcessManager, get_connections) {
+  using IntraProcessManagerT = rclcpp::experimental::IntraProcessManager;
+  using MessageT = rcl_interfaces::msg::Log;
+  using PublisherT = rclcpp::mock::Publisher<MessageT>;
+  using SubscriptionIntraProcessT = rclcpp::experimental::mock::SubscriptionIntraProcess<MessageT>;
+
+  auto ipm = std::make_shared<IntraProcessManagerT>();
+  EXPECT_TRUE(ipm->get_connections().empty());
+
+  auto p1 = std::make_shared<PublisherT>();
+  auto p2 = std::make_shared<PublisherT>();
+  p2->topic_name = "different_topic_name";
+  auto s1 = std::make_shared<SubscriptionIntraProcessT>();
+  s1->take_shared_method = true;
+  auto s2 = std::make_shared<SubscriptionIntraProcessT>();
+  s2->take_shared_method = false;
+
+  auto p1_id = ipm->add_publisher(p1);
+  ipm->add_publisher(p2);
+  auto s1_id = ipm->add_subscription(s1);
+  auto s2_id = ipm->add_subscription(s2);
+
+  auto connections = ipm->get_connections();
+  ASSERT_EQ(2u, connections.size());
+  EXPECT_EQ("topic", connections[0].topic_name);
+  EXPECT_EQ(p1_id, connections[0].publisher_id);
+  EXPECT_EQ(s1_id, connections[0].subscription_id);
+  EXPECT_TRUE(connections[0].take_shared);
+  EXPECT_EQ("topic", connections[1].topic_name);
+  EXPECT_EQ(p1_id, connections[1].publisher_id);
+  EXPECT_EQ(s2_id, connections[1].subscription_id);
+  EXPECT_FALSE(connections[1].take_shared);
+
+  ipm->remove_subscription(s1_id);
+  connections = ipm->get_connections();
+  ASSERT_EQ(1u, connections.size());
+  EXPECT_EQ(s2_id, connections[0].subscription_id);
+}
+
+/*
+   This tests that serialized and typed entities of the same topic are not matched:
+   - Creates a serialized and a typed publisher, and a serialized and a typed subscription.
+   - Each publisher is expected to be matched only with the subscription of its kind.
+ */
+TEST(TestIntraProcessManager, serialized_pub_sub) {
+  using IntraProcessManagerT = rclcpp::experimental::IntraProcessManager;
+  using MessageT = rcl_interfaces::msg::Log;
+  using PublisherT = rclcpp::mock::Publisher<MessageT>;
+  using SubscriptionIntraProcessT = rclcpp::experimental::mock::SubscriptionIntraProcess<MessageT>;
+
+  auto ipm = std::make_shared<IntraProcessManagerT>();
+
+  auto typed_pub = std::make_shared<PublisherT>();
+  auto serialized_pub = std::make_shared<PublisherT>();
+  serialized_pub->serialized = true;
+
+  auto typed_sub = std::make_shared<SubscriptionIntraProcessT>();
+  auto serialized_sub = std::make_shared<SubscriptionIntraProcessT>();
+  serialized_sub->serialized = true;
+
+  auto typed_pub_id = ipm->add_publisher(typed_pub);
+  auto typed_sub_id = ipm->add_subscription(typed_sub);
+  auto serialized_sub_id = ipm->add_subscription(serialized_sub);
+  auto serialized_pub_id = ipm->add_publisher(serialized_pub);
+
+  ASSERT_EQ(1u, ipm->get_subscription_count(typed_pub_id));
+  ASSERT_EQ(1u, ipm->get_subscription_count(serialized_pub_id));
+
+  ipm->remove_subscription(serialized_sub_id);
+  ASSERT_EQ(1u, ipm->get_subscription_count(typed_pub_id));
+  ASSERT_EQ(0u, ipm->get_subscription_count(serialized_pub_id));
+
+  ipm->remove_subscription(typed_sub_id);
+  ASSERT_EQ(0u, ipm->get_subscription_count(typed_pub_id));
+}
+
 /*
    This tests the minimal usage of the class where there is a single subscription per publisher:
    - Publishes a unique_ptr message with a subscription requesting ownership.
@@ -456,6 +660,158 @@ TEST(TestIntraProcessManager, single_subscription) {
   ASSERT_EQ(original_message_pointer, received_message_pointer_2);
 }
 
+/*
+   This tests a publisher registered with its message type, which caches the typed subscriptions:
+   - Publishes a unique_ptr message with a subscription requesting ownership
+     and one not requesting it.
+   - The subscription requesting ownership receives the published message, the other a copy.
+   - Remove the subscription requesting ownership.
+   - Publishes a unique_ptr message, the remaining subscription receives it.
+ */
+TEST(TestIntraProcessManager, typed_publisher) {
+  using IntraProcessManagerT = rclcpp::experimental::IntraProcessManager;
+  using MessageT = rcl_interfaces::msg::Log;
+  using PublisherT = rclcpp::mock::Publisher<MessageT>;
+  using SubscriptionIntraProcessT = rclcpp::experimental::mock::SubscriptionIntraProcess<MessageT>;
+
+  auto ipm = std::make_shared<IntraProcessManagerT>();
+
+  auto p1 = std::make_shared<PublisherT>();
+  auto p1_id = ipm->add_publisher<MessageT>(p1);
+  p1->set_intra_process_manager(p1_id, ipm);
+
+  auto s1 = std::make_shared<SubscriptionIntraProcessT>();
+  s1->take_shared_method = false;
+  auto s1_id = ipm->add_subscription(s1);
+
+  auto s2 = std::make_shared<SubscriptionIntraProcessT>();
+  s2->take_shared_method = true;
+  auto s2_id = ipm->add_subscription(s2);
+  (void)s2_id;
+
+  ASSERT_EQ(2u, ipm->get_subscription_count(p1_id));
+
+  auto unique_msg = std::make_unique<MessageT>();
+  auto original_message_pointer = reinterpret_cast<std::uintptr_t>(unique_msg.get());
+  p1->publish(std::move(unique_msg));
+  auto received_message_pointer_1 = s1->pop();
+  auto received_message_pointer_2 = s2->pop();
+  ASSERT_EQ(original_message_pointer, received_message_pointer_1);
+  ASSERT_NE(original_message_pointer, received_message_pointer_2);
+  ASSERT_NE(0u, received_message_pointer_2);
+
+  ipm->remove_subscription(s1_id);
+  ASSERT_EQ(1u, ipm->get_subscription_count(p1_id));
+
+  unique_msg = std::make_unique<MessageT>();
+  original_message_pointer = reinterpret_cast<std::uintptr_t>(unique_msg.get());
+  p1->publish(std::move(unique_msg));
+  received_message_pointer_1 = s1->pop();
+  received_message_pointer_2 = s2->pop();
+  ASSERT_EQ(0u, received_message_pointer_1);
+  ASSERT_EQ(original_message_pointer, received_message_pointer_2);
+}
+
+/*
+   This tests publishing a message which is already shared, like a loaned message:
+   - Publishes a shared_ptr message with 2 subscriptions not requesting ownership.
+   - Both received messages are expected to be the same as the published one.
+   - Publishes a shared_ptr message with a subscription requesting ownership
+     and one not requesting it.
+   - The subscription not requesting ownership receives the published message, the other a copy.
+ */
+TEST(TestIntraProcessManager, publish_shared) {
+  using IntraProcessManagerT = rclcpp::experimental::IntraProcessManager;
+  using MessageT = rcl_interfaces::msg::Log;
+  using PublisherT = rclcpp::mock::Publisher<MessageT>;
+  using SubscriptionIntraProcessT = rclcpp::experimental::mock::SubscriptionIntraProcess<MessageT>;
+
+  auto ipm = std::make_shared<IntraProcessManagerT>();
+
+  auto p1 = std::make_shared<PublisherT>();
+  auto p1_id = ipm->add_publisher<MessageT>(p1);
+  p1->set_intra_process_manager(p1_id, ipm);
+
+  auto s1 = std::make_shared<SubscriptionIntraProcessT>();
+  s1->take_shared_method = true;
+  auto s1_id = ipm->add_subscription(s1);
+  (void)s1_id;
+
+  auto s2 = std::make_shared<SubscriptionIntraProcessT>();
+  s2->take_shared_method = true;
+  auto s2_id = ipm->add_subscription(s2);
+
+  std::shared_ptr<const MessageT> shared_msg = std::make_shared<MessageT>();
+  auto original_message_pointer = reinterpret_cast<std::uintptr_t>(shared_msg.get());
+  ipm->do_intra_process_publish_shared<MessageT>(p1_id, shared_msg, *p1->message_allocator_);
+  auto received_message_pointer_1 = s1->pop();
+  auto received_message_pointer_2 = s2->pop();
+  ASSERT_EQ(original_message_pointer, received_message_pointer_1);
+  ASSERT_EQ(original_message_pointer, received_message_pointer_2);
+
+  ipm->remove_subscription(s2_id);
+  auto s3 = std::make_shared<SubscriptionIntraProcessT>();
+  s3->take_shared_method = false;
+  auto s3_id = ipm->add_subscription(s3);
+  (void)s3_id;
+
+  shared_msg = std::make_shared<MessageT>();
+  original_message_pointer = reinterpret_cast<std::uintptr_t>(shared_msg.get());
+  ipm->do_intra_process_publish_shared<MessageT>(p1_id, shared_msg, *p1->message_allocator_);
+  received_message_pointer_1 = s1->pop();
+  auto received_message_pointer_3 = s3->pop();
+  ASSERT_EQ(original_message_pointer, received_message_pointer_1);
+  ASSERT_NE(original_message_pointer, received_message_pointer_3);
+  ASSERT_NE(0u, received_message_pointer_3);
+}
+
+/*
+   This tests publishing a batch of messages:
+   - Publishes 2 unique_ptr messages with a subscription requesting ownership.
+   - The subscription receives the last published message, the batch is moved from.
+   - Publishes 2 unique_ptr messages, asking for the shared messages.
+   - The subscription receives the last published message, the shared messages are copies.
+ */
+TEST(TestIntraProcessManager, publish_batch) {
+  using IntraProcessManagerT = rclcpp::experimental::IntraProcessManager;
+  using MessageT = rcl_interfaces::msg::Log;
+  using PublisherT = rclcpp::mock::Publisher<MessageT>;
+  using SubscriptionIntraProcessT = rclcpp::experimental::mock::SubscriptionIntraProcess<MessageT>;
+
+  auto ipm = std::make_shared<IntraProcessManagerT>();
+
+  auto p1 = std::make_shared<PublisherT>();
+  auto p1_id = ipm->add_publisher<MessageT>(p1);
+  p1->set_intra_process_manager(p1_id, ipm);
+
+  auto s1 = std::make_shared<SubscriptionIntraProcessT>();
+  s1->take_shared_method = false;
+  auto s1_id = ipm->add_subscription(s1);
+  (void)s1_id;
+
+  std::vector<std::unique_ptr<MessageT>> unique_msgs;
+  unique_msgs.push_back(std::make_unique<MessageT>());
+  unique_msgs.push_back(std::make_unique<MessageT>());
+  auto original_message_pointer = reinterpret_cast<std::uintptr_t>(unique_msgs.back().get());
+  ipm->do_intra_process_publish_batch<MessageT>(
+    p1_id, unique_msgs.begin(), unique_msgs.end(), *p1->message_allocator_);
+  ASSERT_EQ(original_message_pointer, s1->pop());
+  ASSERT_EQ(nullptr, unique_msgs[0]);
+  ASSERT_EQ(nullptr, unique_msgs[1]);
+
+  unique_msgs.clear();
+  unique_msgs.push_back(std::make_unique<MessageT>());
+  unique_msgs.push_back(std::make_unique<MessageT>());
+  original_message_pointer = reinterpret_cast<std::uintptr_t>(unique_msgs.back().get());
+  std::vector<std::shared_ptr<const MessageT>> shared_msgs;
+  ipm->do_intra_process_publish_batch<MessageT>(
+    p1_id, unique_msgs.begin(), unique_msgs.end(), *p1->message_allocator_, &shared_msgs);
+  ASSERT_EQ(2u, shared_msgs.size());
+  ASSERT_NE(nullptr, shared_msgs[0]);
+  ASSERT_EQ(original_message_pointer, s1->pop());
+  ASSERT_NE(original_message_pointer, reinterpret_cast<std::uintptr_t>(shared_msgs[1].get()));
+}
+
 /*
    This tests the usage of the class where there are multiple subscriptions of the same type:
    - Publishes a unique_ptr message with 2 subscriptions requesting ownership.
@@ -557,6 +913,75 @@ TEST(TestIntraProcessManager, multiple_subscriptions_same_type) {
   ASSERT_EQ(original_message_pointer, received_message_pointer_8);
 }
 
+/*
+   This tests the subscriptions which do not accept messages, e.g. as their buffer is full:
+   - Publishes a unique_ptr message with 2 subscriptions requesting ownership, the last one
+     not accepting messages.
+   - The first one is expected to receive the published message, without a copy for the other.
+   - Publishes a unique_ptr message with none of the subscriptions accepting messages.
+   - None of them is expected to receive a message.
+   - Publishes a shared_ptr message with 1 subscription requesting ownership, not accepting
+     messages, and 1 not requesting it.
+   - Only the one not requesting ownership is expected to receive the published message.
+ */
+TEST(TestIntraProcessManager, subscriptions_not_accepting_messages) {
+  using IntraProcessManagerT = rclcpp::experimental::IntraProcessManager;
+  using MessageT = rcl_interfaces::msg::Log;
+  using PublisherT = rclcpp::mock::Publisher<MessageT>;
+  using SubscriptionIntraProcessT = rclcpp::experimental::mock::SubscriptionIntraProcess<MessageT>;
+
+  auto ipm = std::make_shared<IntraProcessManagerT>();
+
+  auto p1 = std::make_shared<PublisherT>();
+  auto p1_id = ipm->add_publisher<MessageT>(p1);
+  p1->set_intra_process_manager(p1_id, ipm);
+
+  auto s1 = std::make_shared<SubscriptionIntraProcessT>();
+  s1->take_shared_method = false;
+  auto s1_id = ipm->add_subscription(s1);
+  (void)s1_id;
+
+  auto s2 = std::make_shared<SubscriptionIntraProcessT>();
+  s2->take_shared_method = false;
+  auto s2_id = ipm->add_subscription(s2);
+
+  EXPECT_EQ(2u, ipm->get_accepting_subscription_count(p1_id));
+  s2->accepting_messages = false;
+  EXPECT_EQ(1u, ipm->get_accepting_subscription_count(p1_id));
+
+  auto unique_msg = std::make_unique<MessageT>();
+  auto original_message_pointer = reinterpret_cast<std::uintptr_t>(unique_msg.get());
+  p1->publish(std::move(unique_msg));
+  ASSERT_EQ(original_message_pointer, s1->pop());
+  ASSERT_EQ(0u, s2->pop());
+  EXPECT_EQ(0u, s1->dropped_messages);
+  EXPECT_EQ(1u, s2->dropped_messages);
+
+  s1->accepting_messages = false;
+  EXPECT_EQ(0u, ipm->get_accepting_subscription_count(p1_id));
+  p1->publish(std::make_unique<MessageT>());
+  ASSERT_EQ(0u, s1->pop());
+  ASSERT_EQ(0u, s2->pop());
+  EXPECT_EQ(1u, s1->dropped_messages);
+  EXPECT_EQ(2u, s2->dropped_messages);
+
+  ipm->remove_subscription(s2_id);
+  auto s3 = std::make_shared<SubscriptionIntraProcessT>();
+  s3->take_shared_method = true;
+  auto s3_id = ipm->add_subscription(s3);
+  (void)s3_id;
+  EXPECT_EQ(1u, ipm->get_accepting_subscription_count(p1_id));
+
+  std::shared_ptr<const MessageT> shared_msg = std::make_shared<MessageT>();
+  original_message_pointer = reinterpret_cast<std::uintptr_t>(shared_msg.get());
+  ipm->do_intra_process_publish_shared<MessageT>(p1_id, shared_msg, *p1->message_allocator_);
+  ASSERT_EQ(0u, s1->pop());
+  ASSERT_EQ(original_message_pointer, s3->pop());
+  // Counted once, by the copies for the subscriptions requesting ownership.
+  EXPECT_EQ(2u, s1->dropped_messages);
+  EXPECT_EQ(0u, s3->dropped_messages);
+}
+
 /*
    This tests the usage of the class where there are multiple subscriptions of different types:
    - Publishes a unique_ptr message with 1 subscription requesting ownership and 1 not.
@@ -692,3 +1117,70 @@ TEST(TestIntraProcessManager, multiple_subscriptions_different_type) {
   EXPECT_EQ(original_message_pointer, received_message_pointer_10);
   EXPECT_NE(original_message_pointer, received_message_pointer_11);
 }
+
+/*
+   This tests publishing the custom type of a TypeAdapter:
+   - The subscriptions taking the custom type get the message without conversion
+   - The message is converted once for the subscriptions taking the ROS message
+   - The message is converted only if it is needed
+ */
+TEST(TestIntraProcessManager, type_adapted_publisher) {
+  using IntraProcessManagerT = rclcpp::experimental::IntraProcessManager;
+  using ROSMessageT = rcl_interfaces::msg::Log;
+  using StringTypeAdapter = rclcpp::TypeAdapter<std::string, ROSMessageT>;
+  using PublisherT = rclcpp::mock::Publisher<ROSMessageT>;
+  using CustomSubscriptionT = rclcpp::experimental::mock::SubscriptionIntraProcess<std::string>;
+  using ROSSubscriptionT = rclcpp::experimental::mock::SubscriptionIntraProcess<ROSMessageT>;
+
+  auto ipm = std::make_shared<IntraProcessManagerT>();
+  std::allocator<std::string> allocator;
+  std::allocator<ROSMessageT> ros_message_allocator;
+  std::default_delete<ROSMessageT> ros_message_deleter;
+
+  auto p1 = std::make_shared<PublisherT>();
+  auto p1_id = ipm->add_type_adapted_publisher<StringTypeAdapter>(p1);
+
+  auto s1 = std::make_shared<CustomSubscriptionT>();
+  s1->take_shared_method = false;
+  ipm->add_subscription(s1);
+
+  ASSERT_EQ(1u, ipm->get_subscription_count(p1_id));
+
+  StringTypeAdapter::number_of_conversions_to_ros_message = 0;
+  auto unique_msg = std::make_unique<std::string>("data");
+  auto original_message_pointer = reinterpret_cast<std::uintptr_t>(unique_msg.get());
+  auto ros_msg = ipm->do_intra_process_publish_type_adapted<StringTypeAdapter>(
+    p1_id, std::move(unique_msg), allocator, ros_message_allocator, ros_message_deleter, false);
+  EXPECT_EQ(nullptr, ros_msg);
+  EXPECT_EQ(0u, StringTypeAdapter::number_of_conversions_to_ros_message);
+  EXPECT_EQ(original_message_pointer, s1->pop());
+
+  unique_msg = std::make_unique<std::string>("data");
+  ros_msg = ipm->do_intra_process_publish_type_adapted<StringTypeAdapter>(
+    p1_id, std::move(unique_msg), allocator, ros_message_allocator, ros_message_deleter, true);
+  ASSERT_NE(nullptr, ros_msg);
+  EXPECT_EQ("data", ros_msg->msg);
+  EXPECT_EQ(1u, StringTypeAdapter::number_of_conversions_to_ros_message);
+  EXPECT_NE(0u, s1->pop());
+
+  auto s2 = std::make_shared<ROSSubscriptionT>();
+  s2->take_shared_method = true;
+  ipm->add_subscription(s2);
+  auto s3 = std::make_shared<ROSSubscriptionT>();
+  s3->take_shared_method = true;
+  ipm->add_subscription(s3);
+
+  ASSERT_EQ(3u, ipm->get_subscription_count(p1_id));
+
+  StringTypeAdapter::number_of_conversions_to_ros_message = 0;
+  unique_msg = std::make_unique<std::string>("data");
+  original_message_pointer = reinterpret_cast<std::uintptr_t>(unique_msg.get());
+  ros_msg = ipm->do_intra_process_publish_type_adapted<StringTypeAdapter>(
+    p1_id, std::move(unique_msg), allocator, ros_message_allocator, ros_message_deleter, false);
+  ASSERT_NE(nullptr, ros_msg);
+  EXPECT_EQ(1u, StringTypeAdapter::number_of_conversions_to_ros_message);
+  EXPECT_EQ(original_message_pointer, s1->pop());
+  auto ros_message_pointer = reinterpret_cast<std::uintptr_t>(ros_msg.get());
+  EXPECT_EQ(ros_message_pointer, s2->pop());
+  EXPECT_EQ(ros_message_pointer, s3->pop());
+}
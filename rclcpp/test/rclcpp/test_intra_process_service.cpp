@@ -0,0 +1,142 @@
+// Copyright 2017 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <memory>
+#include <string>
+
+#include "rclcpp/rclcpp.hpp"
+
+#include "test_msgs/srv/basic_types.hpp"
+#include "test_msgs/srv/empty.hpp"
+
+using namespace std::chrono_literals;
+
+using BasicTypes = test_msgs::srv::BasicTypes;
+
+class TestIntraProcessService : public ::testing::Test
+{
+protected:
+  static void SetUpTestCase()
+  {
+    rclcpp::init(0, nullptr);
+  }
+
+  static void TearDownTestCase()
+  {
+    rclcpp::shutdown();
+  }
+
+  void SetUp()
+  {
+    node = std::make_shared<rclcpp::Node>(
+      "my_node", "/ns", rclcpp::NodeOptions().use_intra_process_comms(true));
+  }
+
+  void TearDown()
+  {
+    node.reset();
+  }
+
+  rclcpp::Node::SharedPtr node;
+};
+
+/*
+   Testing that the request and the response are passed by pointer.
+ */
+TEST_F(TestIntraProcessService, request_and_response_by_pointer) {
+  const BasicTypes::Request * received_request = nullptr;
+  const BasicTypes::Response * sent_response = nullptr;
+  auto service = node->create_service<BasicTypes>(
+    "service",
+    [&received_request, &sent_response](
+      const std::shared_ptr<rmw_request_id_t> request_header,
+      const BasicTypes::Request::SharedPtr request,
+      BasicTypes::Response::SharedPtr response)
+    {
+      EXPECT_EQ(0u, request_header->writer_guid[0]);
+      received_request = request.get();
+      sent_response = response.get();
+      response->int64_value = request->int64_value + 1;
+    });
+  auto client = node->create_client<BasicTypes>("service");
+  ASSERT_NE(nullptr, service->get_intra_process_waitable());
+  ASSERT_NE(nullptr, client->get_intra_process_waitable());
+
+  auto request = std::make_shared<BasicTypes::Request>();
+  request->int64_value = 41;
+  auto future = client->async_send_request(request);
+  ASSERT_EQ(
+    rclcpp::FutureReturnCode::SUCCESS,
+    rclcpp::spin_until_future_complete(node, future, 5s));
+
+  auto response = future.get();
+  EXPECT_EQ(42, response->int64_value);
+  EXPECT_EQ(request.get(), received_request);
+  EXPECT_EQ(response.get(), sent_response);
+}
+
+TEST_F(TestIntraProcessService, deferred_response) {
+  std::shared_ptr<rmw_request_id_t> deferred_header;
+  rclcpp::Service<BasicTypes>::SharedPtr service = node->create_service<BasicTypes>(
+    "service",
+    [&deferred_header](
+      std::shared_ptr<rmw_request_id_t> request_header,
+      BasicTypes::Request::SharedPtr request)
+    {
+      (void)request;
+      deferred_header = request_header;
+    });
+  auto client = node->create_client<BasicTypes>("service");
+
+  auto future = client->async_send_request(std::make_shared<BasicTypes::Request>());
+  EXPECT_EQ(
+    rclcpp::FutureReturnCode::TIMEOUT,
+    rclcpp::spin_until_future_complete(node, future, 100ms));
+  ASSERT_NE(nullptr, deferred_header);
+
+  BasicTypes::Response response;
+  response.string_value = "deferred";
+  service->send_response(*deferred_header, response);
+  ASSERT_EQ(
+    rclcpp::FutureReturnCode::SUCCESS,
+    rclcpp::spin_until_future_complete(node, future, 5s));
+  EXPECT_EQ("deferred", future.get()->string_value);
+}
+
+/*
+   Testing that intra-process is only used when both ends enable it.
+ */
+TEST_F(TestIntraProcessService, disabled) {
+  auto service = node->create_service<test_msgs::srv::Empty>(
+    "service",
+    [](
+      const test_msgs::srv::Empty::Request::SharedPtr,
+      test_msgs::srv::Empty::Response::SharedPtr) {},
+    rmw_qos_profile_services_default,
+    nullptr,
+    rclcpp::IntraProcessSetting::Disable);
+  EXPECT_EQ(nullptr, service->get_intra_process_waitable());
+
+  auto client = node->create_client<test_msgs::srv::Empty>("service");
+  ASSERT_NE(nullptr, client->get_intra_process_waitable());
+  ASSERT_TRUE(client->wait_for_service(5s));
+
+  auto future = client->async_send_request(std::make_shared<test_msgs::srv::Empty::Request>());
+  EXPECT_EQ(
+    rclcpp::FutureReturnCode::SUCCESS,
+    rclcpp::spin_until_future_complete(node, future, 5s));
+}
@@ -175,3 +175,41 @@ TEST_F(TestLoanedMessage, construct_with_loaned_message_publisher) {
     EXPECT_NO_THROW(loaned_message.reset());
   }
 }
+
+TEST_F(TestLoanedMessage, pooled_fallback) {
+  auto node = std::make_shared<rclcpp::Node>("loaned_message_test_node");
+  rclcpp::PublisherOptions options;
+  options.loaned_message_pool_size = 1;
+  auto pub = node->create_publisher<MessageT>("loaned_message_test_topic", 1, options);
+  if (pub->can_loan_messages()) {
+    GTEST_SKIP() << "the middleware loans the messages, the pool is not used";
+  }
+
+  const MessageT * pooled_address = nullptr;
+  {
+    auto loaned_msg = pub->borrow_loaned_message();
+    ASSERT_TRUE(loaned_msg.is_valid());
+    pooled_address = &loaned_msg.get();
+    loaned_msg.get().int32_value = 42;
+    pub->publish(std::move(loaned_msg));
+  }
+
+  {
+    // The published message is reused, with the value it was last given.
+    auto loaned_msg = pub->borrow_loaned_message();
+    EXPECT_EQ(pooled_address, &loaned_msg.get());
+    EXPECT_EQ(42, loaned_msg.get().int32_value);
+
+    // All the messages of the pool are borrowed, a message is allocated.
+    auto other_loaned_msg = pub->borrow_loaned_message();
+    ASSERT_TRUE(other_loaned_msg.is_valid());
+    EXPECT_NE(pooled_address, &other_loaned_msg.get());
+
+    // A released message is reused once its deleter is called.
+    auto released_msg = loaned_msg.release();
+    EXPECT_EQ(pooled_address, released_msg.get());
+    released_msg.reset();
+  }
+  auto loaned_msg = pub->borrow_loaned_message();
+  EXPECT_EQ(pooled_address, &loaned_msg.get());
+}
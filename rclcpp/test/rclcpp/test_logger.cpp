@@ -160,6 +160,37 @@ TEST(TestLogger, set_level) {
   EXPECT_EQ(RCUTILS_RET_OK, rcutils_logging_shutdown());
 }
 
+TEST(TestLogger, cached_level) {
+  ASSERT_EQ(RCUTILS_RET_OK, rcutils_logging_initialize());
+  rclcpp::reset_logger_level_caches();
+
+  rclcpp::Logger logger = rclcpp::get_logger("test_cached_level");
+  rclcpp::Logger copy = logger;
+  rclcpp::Logger child = logger.get_child("child");
+  EXPECT_FALSE(logger.is_enabled_for(RCUTILS_LOG_SEVERITY_DEBUG));
+  EXPECT_TRUE(logger.is_enabled_for(RCUTILS_LOG_SEVERITY_INFO));
+  EXPECT_FALSE(child.is_enabled_for(RCUTILS_LOG_SEVERITY_DEBUG));
+
+  // Setting the level invalidates the caches of all the loggers, the descendants included.
+  logger.set_level(rclcpp::Logger::Level::Debug);
+  EXPECT_TRUE(logger.is_enabled_for(RCUTILS_LOG_SEVERITY_DEBUG));
+  EXPECT_TRUE(copy.is_enabled_for(RCUTILS_LOG_SEVERITY_DEBUG));
+  EXPECT_TRUE(child.is_enabled_for(RCUTILS_LOG_SEVERITY_DEBUG));
+
+  // Changes made through rcutils directly need the caches to be reset.
+  ASSERT_EQ(
+    RCUTILS_RET_OK,
+    rcutils_logging_set_logger_level("test_cached_level", RCUTILS_LOG_SEVERITY_ERROR));
+  EXPECT_TRUE(logger.is_enabled_for(RCUTILS_LOG_SEVERITY_DEBUG));
+  rclcpp::reset_logger_level_caches();
+  EXPECT_FALSE(logger.is_enabled_for(RCUTILS_LOG_SEVERITY_WARN));
+  EXPECT_TRUE(logger.is_enabled_for(RCUTILS_LOG_SEVERITY_ERROR));
+  EXPECT_FALSE(child.is_enabled_for(RCUTILS_LOG_SEVERITY_WARN));
+
+  EXPECT_EQ(RCUTILS_RET_OK, rcutils_logging_shutdown());
+  rclcpp::reset_logger_level_caches();
+}
+
 TEST(TestLogger, get_logging_directory) {
   ASSERT_EQ(true, rcutils_set_env("HOME", "/fake_home_dir"));
   ASSERT_EQ(true, rcutils_set_env("USERPROFILE", nullptr));
@@ -49,6 +49,7 @@ public:
     g_log_calls = 0;
     ASSERT_EQ(RCUTILS_RET_OK, rcutils_logging_initialize());
     rcutils_logging_set_default_logger_level(RCUTILS_LOG_SEVERITY_DEBUG);
+    rclcpp::reset_logger_level_caches();
 
     auto rcutils_logging_console_output_handler = [](
       const rcutils_log_location_t * location,
@@ -74,6 +75,7 @@ public:
     rcutils_logging_set_output_handler(this->previous_output_handler);
     ASSERT_EQ(RCUTILS_RET_OK, rcutils_logging_shutdown());
     EXPECT_FALSE(g_rcutils_logging_initialized);
+    rclcpp::reset_logger_level_caches();
   }
 };
 
@@ -0,0 +1,82 @@
+// Copyright 2021 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <string>
+
+#include "rclcpp/memory_footprint.hpp"
+#include "rclcpp/rclcpp.hpp"
+#include "test_msgs/msg/basic_types.hpp"
+
+class TestMemoryFootprint : public ::testing::Test
+{
+protected:
+  static void SetUpTestCase()
+  {
+    rclcpp::init(0, nullptr);
+  }
+
+  static void TearDownTestCase()
+  {
+    rclcpp::shutdown();
+  }
+};
+
+TEST_F(TestMemoryFootprint, empty_node) {
+  auto node = std::make_shared<rclcpp::Node>(
+    "test_memory_footprint_empty", "/ns", rclcpp::NodeOptions().use_intra_process_comms(false));
+  auto footprint = rclcpp::get_memory_footprint(*node->get_node_base_interface());
+  EXPECT_EQ("/ns/test_memory_footprint_empty", footprint.node_name);
+  EXPECT_TRUE(footprint.entities.empty());
+  EXPECT_EQ(0u, footprint.get_total_size());
+}
+
+TEST_F(TestMemoryFootprint, subscriptions_and_parameters) {
+  auto node = std::make_shared<rclcpp::Node>(
+    "test_memory_footprint", "/ns", rclcpp::NodeOptions().use_intra_process_comms(true));
+  node->declare_parameter("string_parameter", std::string(64, 'a'));
+
+  auto callback = [](test_msgs::msg::BasicTypes::ConstSharedPtr) {};
+  rclcpp::SubscriptionOptions options;
+  options.message_pool_size = 4;
+  auto pooled_subscription = node->create_subscription<test_msgs::msg::BasicTypes>(
+    "pooled_topic", rclcpp::QoS(10), callback, options);
+  (void)pooled_subscription;
+
+  auto footprint = rclcpp::get_memory_footprint(*node);
+  EXPECT_EQ("/ns/test_memory_footprint", footprint.node_name);
+  ASSERT_EQ(2u, footprint.entities.size());
+
+  const auto & subscription = footprint.entities[0];
+  EXPECT_EQ("subscription", subscription.kind);
+  EXPECT_EQ("/ns/pooled_topic", subscription.name);
+  EXPECT_EQ(4 * sizeof(test_msgs::msg::BasicTypes), subscription.message_pools);
+  EXPECT_GE(subscription.intra_process_buffers, 10 * sizeof(test_msgs::msg::BasicTypes));
+  EXPECT_EQ(0u, subscription.topic_statistics);
+
+  const auto & parameters = footprint.entities[1];
+  EXPECT_EQ("parameters", parameters.kind);
+  EXPECT_GT(parameters.parameters, 64u);
+
+  EXPECT_EQ(
+    subscription.get_total_size() + parameters.get_total_size(), footprint.get_total_size());
+
+  const std::string report = rclcpp::to_string(footprint);
+  EXPECT_EQ(0u, report.find("/ns/test_memory_footprint: "));
+  EXPECT_NE(std::string::npos, report.find("subscription /ns/pooled_topic"));
+  EXPECT_NE(std::string::npos, report.find("message pools"));
+  EXPECT_NE(std::string::npos, report.find("parameters"));
+}
@@ -0,0 +1,67 @@
+// Copyright 2021 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "rclcpp/detail/min_period_limiter.hpp"
+
+using namespace std::chrono_literals;
+
+using rclcpp::detail::MinPeriodLimiter;
+
+TEST(TestMinPeriodLimiter, disabled) {
+  MinPeriodLimiter limiter;
+  EXPECT_FALSE(limiter.is_enabled());
+  for (size_t i = 0; i < 3; ++i) {
+    EXPECT_TRUE(limiter.try_pass());
+  }
+}
+
+TEST(TestMinPeriodLimiter, one_event_per_period) {
+  MinPeriodLimiter limiter(50ms);
+  EXPECT_TRUE(limiter.is_enabled());
+  EXPECT_TRUE(limiter.try_pass());
+  EXPECT_FALSE(limiter.try_pass());
+  std::this_thread::sleep_for(60ms);
+  EXPECT_TRUE(limiter.try_pass());
+  EXPECT_FALSE(limiter.try_pass());
+
+  limiter.set_min_period(0ms);
+  EXPECT_TRUE(limiter.try_pass());
+}
+
+TEST(TestMinPeriodLimiter, concurrent_events) {
+  MinPeriodLimiter limiter(1h);
+  std::atomic<size_t> pass_count{0};
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < 4; ++i) {
+    threads.emplace_back(
+      [&limiter, &pass_count]() {
+        for (size_t j = 0; j < 1000; ++j) {
+          if (limiter.try_pass()) {
+            ++pass_count;
+          }
+        }
+      });
+  }
+  for (auto & thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(1u, pass_count.load());
+}
@@ -97,6 +97,31 @@ TEST_F(TestNode, construction_and_destruction) {
   }
 }
 
+TEST_F(TestNode, construction_with_arena) {
+  auto arena = std::make_shared<rclcpp::allocator::Arena>(1024 * 1024);
+  rclcpp::Publisher<test_msgs::msg::Empty,
+    rclcpp::allocator::ArenaAllocator<void>>::SharedPtr publisher;
+  {
+    auto node = std::make_shared<rclcpp::Node>(
+      "my_node", "/ns", rclcpp::NodeOptions().arena(arena));
+    EXPECT_EQ(arena, node->get_node_options().arena());
+    const size_t used_size = arena->get_used_size();
+    EXPECT_LT(0u, used_size);
+
+    rclcpp::PublisherOptionsWithAllocator<rclcpp::allocator::ArenaAllocator<void>> options;
+    options.allocator = std::make_shared<rclcpp::allocator::ArenaAllocator<void>>(
+      node->get_node_options().arena());
+    publisher = node->create_publisher<test_msgs::msg::Empty>("topic", 10, options);
+#ifndef _WIN32
+    // The rcl publisher is allocated from the arena too.
+    EXPECT_LT(used_size, arena->get_used_size());
+#endif
+  }
+  // The rcl node handle, still used by the publisher, keeps the arena alive.
+  arena.reset();
+  publisher.reset();
+}
+
 TEST_F(TestNode, get_name_and_namespace) {
   {
     auto node = std::make_shared<rclcpp::Node>("my_node", "/ns");
@@ -280,6 +305,26 @@ TEST_F(TestNode, subnode_construction_and_destruction) {
   }
 }
 
+TEST_F(TestNode, lazy_node_interfaces) {
+  auto options = rclcpp::NodeOptions()
+    .lazy_node_interfaces(true)
+    .parameter_overrides({{"parameter", 42}});
+  auto node = std::make_shared<rclcpp::Node>("my_node", "/ns", options);
+  auto subnode = node->create_sub_node("sub_ns");
+  // Created by the sub-node, and shared with it.
+  EXPECT_EQ(node->get_node_parameters_interface(), subnode->get_node_parameters_interface());
+  EXPECT_EQ(node->get_node_clock_interface(), subnode->get_node_clock_interface());
+  EXPECT_EQ(node->get_node_graph_interface(), subnode->get_node_graph_interface());
+  EXPECT_NE(nullptr, node->get_node_time_source_interface());
+  EXPECT_EQ(42, node->declare_parameter("parameter", 0));
+  EXPECT_TRUE(node->has_parameter("use_sim_time"));
+  EXPECT_EQ(node->get_clock()->get_clock_type(), RCL_ROS_TIME);
+
+  auto other_node = std::make_shared<rclcpp::Node>("my_other_node", "/ns", options);
+  EXPECT_NE(nullptr, other_node->get_clock());
+  EXPECT_TRUE(other_node->has_parameter("use_sim_time"));
+}
+
 TEST_F(TestNode, get_logger) {
   {
     auto node = std::make_shared<rclcpp::Node>("my_node");
@@ -870,6 +915,31 @@ TEST_F(TestNode, declare_parameter_with_cli_overrides) {
   }
 }
 
+TEST_F(TestNode, declare_parameter_with_global_overrides) {
+  const std::string parameters_filepath = (
+    test_resources_path / "test_parameters.yaml").string();
+  const char * const argv[] = {
+    "test_node", "--ros-args", "--params-file", parameters_filepath.c_str()};
+  auto context = std::make_shared<rclcpp::Context>();
+  context->init(4, argv);
+  RCPPUTILS_SCOPE_EXIT({context->shutdown("test finished");});
+
+  // The nodes of a context share the overrides of its global arguments, converted once
+  auto options = rclcpp::NodeOptions().context(context);
+  auto node = std::make_shared<rclcpp::Node>("test_declare_parameter_node", options);
+  auto other_node = std::make_shared<rclcpp::Node>("other_node", options);
+  EXPECT_EQ(21, node->declare_parameter("parameter_int", 0));
+  EXPECT_EQ(42, other_node->declare_parameter("parameter_int", 0));
+  EXPECT_TRUE(node->declare_parameter("parameter_bool", false));
+  EXPECT_TRUE(other_node->declare_parameter("parameter_bool", false));
+
+  // Local arguments still override them
+  auto local_node = std::make_shared<rclcpp::Node>(
+    "local_node",
+    rclcpp::NodeOptions(options).arguments({"--ros-args", "-p", "parameter_int:=7"}));
+  EXPECT_EQ(7, local_node->declare_parameter("parameter_int", 0));
+}
+
 TEST_F(TestNode, undeclare_parameter) {
   auto node = std::make_shared<rclcpp::Node>("test_undeclare_parameter_node"_unq);
   {
@@ -2927,3 +2997,59 @@ TEST_F(TestNode, static_and_dynamic_typing) {
 #endif
   }
 }
+
+/*
+   Testing the deferral of the entity notifications by a batch.
+ */
+TEST_F(TestNode, entity_creation_batch) {
+  auto node = std::make_shared<rclcpp::Node>("my_node", "/ns");
+  auto node_base = node->get_node_base_interface();
+  rcl_wait_set_t wait_set = rcl_get_zero_initialized_wait_set();
+  ASSERT_EQ(
+    RCL_RET_OK,
+    rcl_wait_set_init(
+      &wait_set, 0, 1, 0, 0, 0, 0, node_base->get_context()->get_rcl_context().get(),
+      rcl_get_default_allocator()));
+  RCPPUTILS_SCOPE_EXIT({EXPECT_EQ(RCL_RET_OK, rcl_wait_set_fini(&wait_set));});
+  // Return true if the node notified since the last call.
+  auto notified = [&wait_set, &node_base]() {
+      EXPECT_EQ(RCL_RET_OK, rcl_wait_set_clear(&wait_set));
+      EXPECT_EQ(
+        RCL_RET_OK,
+        rcl_wait_set_add_guard_condition(
+          &wait_set, node_base->get_notify_guard_condition(), nullptr));
+      return RCL_RET_OK == rcl_wait(&wait_set, 0) && nullptr != wait_set.guard_conditions[0];
+    };
+  // The entities created with the node notified.
+  notified();
+
+  std::vector<rclcpp::TimerBase::SharedPtr> timers;
+  {
+    auto batch = node->create_entity_creation_batch();
+    {
+      // Nested batches of the same node end with the outermost one.
+      rclcpp::EntityCreationBatch nested_batch(node_base);
+      timers.push_back(node->create_wall_timer(std::chrono::seconds(1), []() {}));
+    }
+    timers.push_back(node->create_wall_timer(std::chrono::seconds(1), []() {}));
+    auto publisher = node->create_publisher<test_msgs::msg::Empty>("topic", 10);
+    EXPECT_FALSE(notified());
+    batch.end();
+    EXPECT_TRUE(notified());
+    // Ending it again does nothing.
+    batch.end();
+    EXPECT_FALSE(notified());
+  }
+
+  // No notification is due when nothing was created.
+  {
+    rclcpp::EntityCreationBatch batch(node_base);
+  }
+  EXPECT_FALSE(notified());
+
+  // Without a batch, each entity notifies.
+  timers.push_back(node->create_wall_timer(std::chrono::seconds(1), []() {}));
+  EXPECT_TRUE(notified());
+
+  EXPECT_THROW(node_base->stop_deferring_entity_notifications(), std::logic_error);
+}
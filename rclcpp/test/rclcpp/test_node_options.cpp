@@ -14,12 +14,15 @@
 
 #include <gtest/gtest.h>
 
+#include <chrono>
 #include <memory>
+#include <stdexcept>
 #include <string>
 #include <vector>
 
 #include "rcl/allocator.h"
 #include "rcl/arguments.h"
+#include "rcl/node.h"
 #include "rcl/remap.h"
 
 #include "rclcpp/node_options.hpp"
@@ -292,6 +295,67 @@ TEST(TestNodeOptions, parameter_event_publisher_options) {
   EXPECT_FALSE(options.parameter_event_publisher_options().use_default_callbacks);
 }
 
+TEST(TestNodeOptions, parameter_event_coalescing_period) {
+  rclcpp::NodeOptions options;
+  EXPECT_EQ(std::chrono::nanoseconds(0), options.parameter_event_coalescing_period());
+  options.parameter_event_coalescing_period(std::chrono::milliseconds(10));
+  EXPECT_EQ(std::chrono::milliseconds(10), options.parameter_event_coalescing_period());
+  rclcpp::NodeOptions copied_options = options;
+  EXPECT_EQ(std::chrono::milliseconds(10), copied_options.parameter_event_coalescing_period());
+}
+
+TEST(TestNodeOptions, rosout_batching) {
+  rclcpp::NodeOptions options;
+  EXPECT_EQ(std::chrono::nanoseconds(0), options.rosout_batch_period());
+  EXPECT_EQ(64u, options.rosout_max_batch_size());
+  options.rosout_batch_period(std::chrono::milliseconds(10)).rosout_max_batch_size(8);
+  EXPECT_EQ(std::chrono::milliseconds(10), options.rosout_batch_period());
+  EXPECT_EQ(8u, options.rosout_max_batch_size());
+  // The rosout publisher of rcl is only disabled by the node base.
+  EXPECT_TRUE(options.get_rcl_node_options()->enable_rosout);
+  rclcpp::NodeOptions copied_options = options;
+  EXPECT_EQ(std::chrono::milliseconds(10), copied_options.rosout_batch_period());
+  EXPECT_EQ(8u, copied_options.rosout_max_batch_size());
+  EXPECT_THROW(options.rosout_max_batch_size(0), std::invalid_argument);
+}
+
+TEST(TestNodeOptions, use_graph_cache) {
+  rclcpp::NodeOptions options;
+  EXPECT_FALSE(options.use_graph_cache());
+  options.use_graph_cache(true);
+  EXPECT_TRUE(options.use_graph_cache());
+  rclcpp::NodeOptions copied_options = options;
+  EXPECT_TRUE(copied_options.use_graph_cache());
+}
+
+TEST(TestNodeOptions, lazy_node_interfaces) {
+  rclcpp::NodeOptions options;
+  EXPECT_FALSE(options.lazy_node_interfaces());
+  options.lazy_node_interfaces(true);
+  EXPECT_TRUE(options.lazy_node_interfaces());
+  rclcpp::NodeOptions copied_options = options;
+  EXPECT_TRUE(copied_options.lazy_node_interfaces());
+}
+
+TEST(TestNodeOptions, shared_rcl_node_handle) {
+  rclcpp::NodeOptions options;
+  EXPECT_EQ(nullptr, options.shared_rcl_node_handle());
+  auto rcl_node_handle = std::make_shared<rcl_node_t>(rcl_get_zero_initialized_node());
+  options.shared_rcl_node_handle(rcl_node_handle);
+  EXPECT_EQ(rcl_node_handle, options.shared_rcl_node_handle());
+  rclcpp::NodeOptions copied_options = options;
+  EXPECT_EQ(rcl_node_handle, copied_options.shared_rcl_node_handle());
+}
+
+TEST(TestNodeOptions, use_shared_clock_subscription) {
+  rclcpp::NodeOptions options;
+  EXPECT_FALSE(options.use_shared_clock_subscription());
+  options.use_shared_clock_subscription(true);
+  EXPECT_TRUE(options.use_shared_clock_subscription());
+  rclcpp::NodeOptions copied_options = options;
+  EXPECT_TRUE(copied_options.use_shared_clock_subscription());
+}
+
 TEST(TestNodeOptions, set_get_allocator) {
   rclcpp::NodeOptions options;
   EXPECT_NE(nullptr, options.allocator().allocate);
@@ -316,3 +380,25 @@ TEST(TestNodeOptions, set_get_allocator) {
   // Check invalid allocator
   EXPECT_THROW(options.get_rcl_node_options(), std::bad_alloc);
 }
+
+TEST(TestNodeOptions, set_get_arena) {
+  rclcpp::NodeOptions options;
+  EXPECT_EQ(nullptr, options.arena());
+
+  auto arena = std::make_shared<rclcpp::allocator::Arena>(64 * 1024);
+  options.arena(arena).arguments({"--ros-args", "-r", "__node:=some_node"});
+  EXPECT_EQ(arena, options.arena());
+  EXPECT_EQ(arena.get(), options.allocator().state);
+
+  // The rcl node options are allocated from the arena.
+  ASSERT_NE(nullptr, options.get_rcl_node_options());
+  EXPECT_LT(0u, arena->get_used_size());
+
+  rclcpp::NodeOptions copied_options = options;
+  EXPECT_EQ(arena, copied_options.arena());
+  EXPECT_EQ(arena.get(), copied_options.allocator().state);
+
+  options.arena(nullptr);
+  EXPECT_EQ(nullptr, options.arena());
+  EXPECT_EQ(rcl_get_default_allocator().allocate, options.allocator().allocate);
+}
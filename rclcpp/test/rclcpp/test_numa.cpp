@@ -0,0 +1,68 @@
+// Copyright 2021 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <gtest/gtest.h>
+
+#include <set>
+#include <stdexcept>
+#include <vector>
+
+#include "rclcpp/numa.hpp"
+
+TEST(TestNuma, parse_cpu_list) {
+  EXPECT_EQ(
+    std::vector<size_t>({0u, 1u, 2u, 3u, 8u, 10u, 11u}), rclcpp::parse_cpu_list("0-3,8,10-11\n"));
+  EXPECT_EQ(std::vector<size_t>({1u, 2u, 3u}), rclcpp::parse_cpu_list("3,1,1-2"));
+  EXPECT_TRUE(rclcpp::parse_cpu_list("").empty());
+  EXPECT_TRUE(rclcpp::parse_cpu_list(" \n").empty());
+
+  EXPECT_THROW(rclcpp::parse_cpu_list("1-"), std::invalid_argument);
+  EXPECT_THROW(rclcpp::parse_cpu_list("a"), std::invalid_argument);
+  EXPECT_THROW(rclcpp::parse_cpu_list("3-1"), std::invalid_argument);
+  EXPECT_THROW(rclcpp::parse_cpu_list("1,,2"), std::invalid_argument);
+  EXPECT_THROW(rclcpp::parse_cpu_list("0-99999999"), std::invalid_argument);
+}
+
+TEST(TestNuma, get_numa_nodes) {
+  const std::vector<rclcpp::NumaNode> nodes = rclcpp::get_numa_nodes();
+  ASSERT_FALSE(nodes.empty());
+  std::set<size_t> ids;
+  std::set<size_t> cpus;
+  for (const rclcpp::NumaNode & node : nodes) {
+    EXPECT_TRUE(ids.insert(node.id).second);
+    EXPECT_FALSE(node.cpus.empty());
+    for (size_t cpu : node.cpus) {
+      // A CPU belongs to a single node.
+      EXPECT_TRUE(cpus.insert(cpu).second);
+    }
+  }
+}
+
+TEST(TestNuma, make_numa_thread_attributes) {
+  const std::vector<rclcpp::NumaNode> nodes = {{0u, {0u, 1u}}, {1u, {2u, 3u}}};
+  const auto thread_attributes = rclcpp::make_numa_thread_attributes(5u, nodes);
+  ASSERT_EQ(5u, thread_attributes.size());
+  EXPECT_EQ(nodes[0].cpus, thread_attributes[0].cpu_affinity);
+  EXPECT_EQ(nodes[0].cpus, thread_attributes[2].cpu_affinity);
+  EXPECT_EQ(nodes[1].cpus, thread_attributes[3].cpu_affinity);
+  EXPECT_EQ(nodes[1].cpus, thread_attributes[4].cpu_affinity);
+  for (const auto & attributes : thread_attributes) {
+    EXPECT_EQ(rclcpp::ThreadSchedulingPolicy::Inherit, attributes.scheduling_policy);
+  }
+
+  EXPECT_TRUE(rclcpp::make_numa_thread_attributes(0u, nodes).empty());
+  EXPECT_THROW(rclcpp::make_numa_thread_attributes(2u, {}), std::invalid_argument);
+  EXPECT_THROW(rclcpp::make_numa_thread_attributes(2u, {{0u, {}}}), std::invalid_argument);
+}
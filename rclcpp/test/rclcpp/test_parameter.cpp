@@ -947,3 +947,28 @@ TEST_F(TestParameter, parameter_vector_stringification) {
     "\"string_param\": {\"type\": \"string\", \"value\": \"I'm a string\"}}",
     ss.str());
 }
+
+TEST_F(TestParameter, value_of_the_type_only) {
+  // The fields of the other types of a message are not kept.
+  rcl_interfaces::msg::ParameterValue message;
+  message.type = rcl_interfaces::msg::ParameterType::PARAMETER_INTEGER_ARRAY;
+  message.integer_array_value = {1, 2, 3};
+  message.string_value = "ignored";
+  message.double_array_value = {4.0};
+
+  rclcpp::ParameterValue value(message);
+  EXPECT_EQ(rclcpp::PARAMETER_INTEGER_ARRAY, value.get_type());
+  EXPECT_EQ((std::vector<int64_t>{1, 2, 3}), value.get<std::vector<int64_t>>());
+
+  rcl_interfaces::msg::ParameterValue value_message = value.to_value_msg();
+  EXPECT_EQ(rcl_interfaces::msg::ParameterType::PARAMETER_INTEGER_ARRAY, value_message.type);
+  EXPECT_EQ((std::vector<int64_t>{1, 2, 3}), value_message.integer_array_value);
+  EXPECT_TRUE(value_message.string_value.empty());
+  EXPECT_TRUE(value_message.double_array_value.empty());
+
+  // Values are equal when their types and the values of the types are.
+  message.string_value.clear();
+  message.double_array_value.clear();
+  EXPECT_EQ(value, rclcpp::ParameterValue(message));
+  EXPECT_NE(value, rclcpp::ParameterValue(std::vector<double>{1.0, 2.0, 3.0}));
+}
@@ -14,6 +14,7 @@
 
 #include <gtest/gtest.h>
 
+#include <algorithm>
 #include <chrono>
 #include <functional>
 #include <future>
@@ -948,3 +949,75 @@ TEST_F(TestParameterClient, sync_parameter_load_parameters) {
   auto list_parameters = synchronous_client->list_parameters({}, 3);
   ASSERT_EQ(list_parameters.names.size(), static_cast<uint64_t>(5));
 }
+
+/*
+  Coverage for the parameters client of several nodes
+ */
+TEST_F(TestParameterClient, multi_node_parameters) {
+  const std::string node_name = node->get_fully_qualified_name();
+  const std::string node_with_option_name = node_with_option->get_fully_qualified_name();
+  auto multi_node_client = std::make_shared<rclcpp::MultiNodeParametersClient>(
+    node, std::vector<std::string>{node_name, node_with_option_name, node_name});
+  EXPECT_EQ(
+    std::vector<std::string>({node_name, node_with_option_name}),
+    multi_node_client->get_remote_node_names());
+  rclcpp::executors::SingleThreadedExecutor executor;
+  executor.add_node(node);
+  executor.add_node(node_with_option);
+  ASSERT_TRUE(multi_node_client->wait_for_service(std::chrono::seconds(5)));
+  EXPECT_TRUE(multi_node_client->service_is_ready());
+
+  // A parameter is only returned by the node allowing undeclared parameters
+  auto get_future = multi_node_client->get_parameters({"foo"});
+  ASSERT_EQ(
+    rclcpp::FutureReturnCode::SUCCESS,
+    executor.spin_until_future_complete(get_future, std::chrono::seconds(5)));
+  auto parameters = get_future.get();
+  ASSERT_EQ(2u, parameters.size());
+  EXPECT_TRUE(parameters.at(node_name).empty());
+  ASSERT_EQ(1u, parameters.at(node_with_option_name).size());
+
+  // Different parameters of each node
+  auto set_future = multi_node_client->set_parameters(
+    rclcpp::MultiNodeParametersClient::ResultsByNode<std::vector<rclcpp::Parameter>>{
+    {node_with_option_name, {rclcpp::Parameter("foo", 1), rclcpp::Parameter("bar", 2)}}});
+  ASSERT_EQ(
+    rclcpp::FutureReturnCode::SUCCESS,
+    executor.spin_until_future_complete(set_future, std::chrono::seconds(5)));
+  auto set_results = set_future.get();
+  ASSERT_EQ(1u, set_results.size());
+  ASSERT_EQ(2u, set_results.at(node_with_option_name).size());
+  EXPECT_TRUE(set_results.at(node_with_option_name)[0].successful);
+  EXPECT_TRUE(set_results.at(node_with_option_name)[1].successful);
+
+  // The same parameters on all of the nodes
+  set_future = multi_node_client->set_parameters({rclcpp::Parameter("foo", 3)});
+  ASSERT_EQ(
+    rclcpp::FutureReturnCode::SUCCESS,
+    executor.spin_until_future_complete(set_future, std::chrono::seconds(5)));
+  set_results = set_future.get();
+  ASSERT_EQ(2u, set_results.size());
+  EXPECT_FALSE(set_results.at(node_name)[0].successful);
+  EXPECT_TRUE(set_results.at(node_with_option_name)[0].successful);
+
+  auto list_future = multi_node_client->list_parameters({}, 1);
+  ASSERT_EQ(
+    rclcpp::FutureReturnCode::SUCCESS,
+    executor.spin_until_future_complete(list_future, std::chrono::seconds(5)));
+  auto lists = list_future.get();
+  ASSERT_EQ(2u, lists.size());
+  const auto & names = lists.at(node_with_option_name).names;
+  EXPECT_NE(names.end(), std::find(names.begin(), names.end(), "bar"));
+
+  EXPECT_THROW(
+    multi_node_client->set_parameters(
+      rclcpp::MultiNodeParametersClient::ResultsByNode<std::vector<rclcpp::Parameter>>{
+    {"/unknown_node", {rclcpp::Parameter("foo", 1)}}}),
+    std::invalid_argument);
+
+  // Nothing to wait for without remote nodes
+  rclcpp::MultiNodeParametersClient empty_client(node, std::vector<std::string>{});
+  auto empty_future = empty_client.get_parameters({"foo"});
+  EXPECT_EQ(std::future_status::ready, empty_future.wait_for(std::chrono::seconds(0)));
+  EXPECT_TRUE(empty_future.get().empty());
+}
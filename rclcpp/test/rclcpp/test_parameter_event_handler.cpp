@@ -430,3 +430,27 @@ TEST_F(TestNode, LastInFirstCallForParameterEventCallbacks)
   param_handler->remove_parameter_event_callback(h2);
   EXPECT_EQ(param_handler->num_event_callbacks(), 0UL);
 }
+
+TEST_F(TestNode, ParameterCallbacksOfOtherNodes)
+{
+  size_t received{0};
+  auto cb = [&received](const rclcpp::Parameter &) {++received;};
+
+  auto h1 = param_handler->add_parameter_callback("my_int", cb);
+  auto h2 = param_handler->add_parameter_callback("my_int", cb);
+
+  // Events of nodes without parameter callbacks are not looked at
+  param_handler->test_event(diff_node_int);
+  param_handler->test_event(remote_node_string);
+  EXPECT_EQ(received, 0u);
+
+  // The callbacks of released handles are skipped, not the ones following them
+  h2.reset();
+  param_handler->test_event(multiple);
+  EXPECT_EQ(received, 1u);
+
+  param_handler->remove_parameter_callback(h1);
+  EXPECT_EQ(param_handler->num_parameter_callbacks(), 0UL);
+  param_handler->test_event(same_node_int);
+  EXPECT_EQ(received, 1u);
+}
@@ -0,0 +1,157 @@
+// Copyright 2021 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "rclcpp/rclcpp.hpp"
+#include "rclcpp/parameter_snapshot.hpp"
+
+#include "rcpputils/filesystem_helper.hpp"
+
+class TestParameterSnapshot : public ::testing::Test
+{
+protected:
+  static void SetUpTestCase()
+  {
+    rclcpp::init(0, nullptr);
+  }
+
+  static void TearDownTestCase()
+  {
+    rclcpp::shutdown();
+  }
+};
+
+static rclcpp::ParameterSnapshot
+make_snapshot()
+{
+  rclcpp::ParameterSnapshot snapshot;
+  rcl_interfaces::msg::ParameterDescriptor descriptor;
+  descriptor.name = "rate";
+  descriptor.type = rcl_interfaces::msg::ParameterType::PARAMETER_DOUBLE;
+  descriptor.description = "publishing rate";
+  rcl_interfaces::msg::FloatingPointRange range;
+  range.from_value = 0.0;
+  range.to_value = 100.0;
+  range.step = 0.5;
+  descriptor.floating_point_range.push_back(range);
+  snapshot.parameters.emplace_back(rclcpp::Parameter("rate", 10.5), descriptor);
+  descriptor = rcl_interfaces::msg::ParameterDescriptor();
+  descriptor.name = "frames";
+  descriptor.type = rcl_interfaces::msg::ParameterType::PARAMETER_STRING_ARRAY;
+  descriptor.read_only = true;
+  snapshot.parameters.emplace_back(
+    rclcpp::Parameter("frames", std::vector<std::string>{"map", "odom"}), descriptor);
+  snapshot.parameter_overrides["rate"] = rclcpp::ParameterValue(10.5);
+  snapshot.parameter_overrides["data"] =
+    rclcpp::ParameterValue(std::vector<uint8_t>{1, 2, 3});
+  return snapshot;
+}
+
+static void
+expect_equal(const rclcpp::ParameterSnapshot & a, const rclcpp::ParameterSnapshot & b)
+{
+  ASSERT_EQ(a.parameters.size(), b.parameters.size());
+  for (size_t i = 0; i < a.parameters.size(); ++i) {
+    EXPECT_EQ(a.parameters[i].first, b.parameters[i].first);
+    EXPECT_EQ(a.parameters[i].second, b.parameters[i].second);
+  }
+  EXPECT_EQ(a.parameter_overrides, b.parameter_overrides);
+}
+
+TEST_F(TestParameterSnapshot, serialize_round_trip) {
+  const rclcpp::ParameterSnapshot snapshot = make_snapshot();
+  const std::vector<uint8_t> data = rclcpp::serialize_parameter_snapshot(snapshot);
+  expect_equal(snapshot, rclcpp::deserialize_parameter_snapshot(data));
+
+  const std::string path =
+    (rcpputils::fs::temp_directory_path() / "test_parameter_snapshot.bin").string();
+  rclcpp::write_parameter_snapshot(path, snapshot);
+  expect_equal(snapshot, rclcpp::read_parameter_snapshot(path));
+  std::remove(path.c_str());
+}
+
+TEST_F(TestParameterSnapshot, invalid_data) {
+  EXPECT_THROW(rclcpp::deserialize_parameter_snapshot({}), std::runtime_error);
+  EXPECT_THROW(
+    rclcpp::deserialize_parameter_snapshot({'n', 'o', 't', ' ', 'a', ' ', 's', 'n', 'a', 'p'}),
+    std::runtime_error);
+
+  std::vector<uint8_t> data = rclcpp::serialize_parameter_snapshot(make_snapshot());
+  data.resize(data.size() - 1);
+  EXPECT_THROW(rclcpp::deserialize_parameter_snapshot(data), std::runtime_error);
+
+  EXPECT_THROW(
+    rclcpp::read_parameter_snapshot(
+      (rcpputils::fs::temp_directory_path() / "test_parameter_snapshot_missing.bin").string()),
+    std::runtime_error);
+}
+
+TEST_F(TestParameterSnapshot, node_restored_from_snapshot) {
+  rclcpp::NodeOptions options;
+  options.parameter_overrides({{"rate", 20.0}, {"unused", true}});
+  auto node = std::make_shared<rclcpp::Node>("node", "/ns", options);
+  EXPECT_EQ(20.0, node->declare_parameter("rate", 10.0));
+  EXPECT_EQ(3, node->declare_parameter("count", 3));
+  const rclcpp::ParameterSnapshot snapshot = node->get_parameter_snapshot();
+  // use_sim_time is declared by the node too.
+  ASSERT_EQ(3u, snapshot.parameters.size());
+  EXPECT_EQ(2u, snapshot.parameter_overrides.size());
+  node.reset();
+
+  // Overrides are taken from the snapshot rather than resolved again.
+  options = rclcpp::NodeOptions();
+  options.parameter_snapshot(std::make_shared<rclcpp::ParameterSnapshot>(snapshot));
+  node = std::make_shared<rclcpp::Node>("node", "/ns", options);
+  EXPECT_TRUE(node->has_parameter("rate"));
+  EXPECT_TRUE(node->has_parameter("count"));
+  EXPECT_EQ(2u, node->get_node_parameters_interface()->get_parameter_overrides().size());
+
+  size_t callback_calls = 0;
+  auto handle = node->add_on_set_parameters_callback(
+    [&callback_calls](const std::vector<rclcpp::Parameter> &) {
+      ++callback_calls;
+      rcl_interfaces::msg::SetParametersResult result;
+      result.successful = true;
+      return result;
+    });
+  EXPECT_EQ(20.0, node->declare_parameter("rate", 10.0));
+  EXPECT_EQ(3, node->declare_parameter("count", 4));
+  EXPECT_EQ(0u, callback_calls);
+  EXPECT_THROW(
+    node->declare_parameter("rate", 10.0), rclcpp::exceptions::ParameterAlreadyDeclaredException);
+
+  // An undeclared parameter is left out of the next snapshot.
+  node->undeclare_parameter("count");
+  EXPECT_EQ(2u, node->get_parameter_snapshot().parameters.size());
+}
+
+TEST_F(TestParameterSnapshot, type_changed_since_snapshot) {
+  auto node = std::make_shared<rclcpp::Node>("node", "/ns");
+  node->declare_parameter("mode", 1);
+  rclcpp::NodeOptions options;
+  options.parameter_snapshot(
+    std::make_shared<rclcpp::ParameterSnapshot>(node->get_parameter_snapshot()));
+  node = std::make_shared<rclcpp::Node>("node", "/ns", options);
+  EXPECT_EQ("fast", node->declare_parameter("mode", std::string("fast")));
+  EXPECT_EQ(
+    rclcpp::ParameterType::PARAMETER_STRING, node->get_parameter("mode").get_type());
+}
@@ -0,0 +1,77 @@
+// Copyright 2021 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+
+#include "rclcpp/detail/pending_request_ring.hpp"
+
+using rclcpp::detail::PendingRequestRing;
+
+TEST(TestPendingRequestRing, insert_and_take) {
+  PendingRequestRing<std::function<int()>> ring(4);
+  EXPECT_EQ(0u, ring.capacity());
+  std::function<int()> callback;
+  EXPECT_FALSE(ring.take(1, callback));
+
+  for (int64_t sequence_number = 1; sequence_number <= 3; ++sequence_number) {
+    ring.insert(sequence_number, [sequence_number]() {return static_cast<int>(sequence_number);});
+  }
+  EXPECT_EQ(3u, ring.size());
+  EXPECT_EQ(4u, ring.capacity());
+
+  ASSERT_TRUE(ring.take(2, callback));
+  EXPECT_EQ(2, callback());
+  EXPECT_FALSE(ring.take(2, callback));
+  // The slot of a request taken is reused by the request of the next round.
+  ring.insert(6, []() {return 6;});
+  ASSERT_TRUE(ring.take(6, callback));
+  EXPECT_EQ(6, callback());
+  EXPECT_FALSE(ring.take(5, callback));
+  EXPECT_EQ(2u, ring.size());
+  EXPECT_EQ(4u, ring.capacity());
+}
+
+TEST(TestPendingRequestRing, grows_when_full) {
+  PendingRequestRing<std::function<int()>> ring(2);
+  for (int64_t sequence_number = 0; sequence_number < 10; ++sequence_number) {
+    ring.insert(sequence_number, [sequence_number]() {return static_cast<int>(sequence_number);});
+  }
+  // Requests far apart which collide with the slots doubled.
+  ring.insert(1024, []() {return 1024;});
+  ring.insert(-1, []() {return -1;});
+  EXPECT_EQ(12u, ring.size());
+  EXPECT_LE(16u, ring.capacity());
+
+  std::function<int()> callback;
+  for (int64_t sequence_number : {1024, -1, 0, 5, 9}) {
+    ASSERT_TRUE(ring.take(sequence_number, callback));
+    EXPECT_EQ(sequence_number, callback());
+  }
+  EXPECT_EQ(7u, ring.size());
+}
+
+TEST(TestPendingRequestRing, releases_callback_when_taken) {
+  PendingRequestRing<std::function<void()>> ring;
+  auto captured = std::make_shared<int>(0);
+  ring.insert(1, [captured]() {});
+  EXPECT_EQ(2, captured.use_count());
+  std::function<void()> callback;
+  ASSERT_TRUE(ring.take(1, callback));
+  callback = nullptr;
+  EXPECT_EQ(1, captured.use_count());
+}
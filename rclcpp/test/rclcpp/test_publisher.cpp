@@ -181,15 +181,11 @@ static std::vector<TestParameters> invalid_qos_profiles()
 {
   std::vector<TestParameters> parameters;
 
-  parameters.reserve(2);
+  parameters.reserve(1);
   parameters.push_back(
     TestParameters(
       rclcpp::QoS(rclcpp::KeepLast(10)).transient_local(),
       "transient_local_qos"));
-  parameters.push_back(
-    TestParameters(
-      rclcpp::QoS(rclcpp::KeepAll()),
-      "keep_all_qos"));
 
   return parameters;
 }
@@ -393,9 +389,7 @@ TEST_F(TestPublisher, intra_process_publish_failures) {
   std::allocator<void> allocator;
   {
     rclcpp::LoanedMessage<test_msgs::msg::Empty> loaned_msg(*publisher, allocator);
-    RCLCPP_EXPECT_THROW_EQ(
-      publisher->publish(std::move(loaned_msg)),
-      std::runtime_error("storing loaned messages in intra process is not supported yet"));
+    EXPECT_NO_THROW(publisher->publish(std::move(loaned_msg)));
   }
 
   {
@@ -412,6 +406,290 @@ TEST_F(TestPublisher, intra_process_publish_failures) {
       "intraprocess communication is not allowed with a zero qos history depth value"));
 }
 
+TEST_F(TestPublisher, intra_process_loaned_message_publish) {
+  initialize();
+  rclcpp::PublisherOptionsWithAllocator<std::allocator<void>> pub_options;
+  pub_options.use_intra_process_comm = rclcpp::IntraProcessSetting::Enable;
+  auto publisher = node->create_publisher<test_msgs::msg::Empty>("topic", 10, pub_options);
+
+  rclcpp::SubscriptionOptionsWithAllocator<std::allocator<void>> sub_options;
+  sub_options.use_intra_process_comm = rclcpp::IntraProcessSetting::Enable;
+  const test_msgs::msg::Empty * received_msg = nullptr;
+  auto subscription = node->create_subscription<test_msgs::msg::Empty>(
+    "topic", 10,
+    [&received_msg](test_msgs::msg::Empty::ConstSharedPtr msg) {
+      received_msg = msg.get();
+    },
+    sub_options);
+  ASSERT_EQ(1u, publisher->get_intra_process_subscription_count());
+
+  std::allocator<void> allocator;
+  rclcpp::LoanedMessage<test_msgs::msg::Empty> loaned_msg(*publisher, allocator);
+  const test_msgs::msg::Empty * published_msg = &loaned_msg.get();
+  EXPECT_NO_THROW(publisher->publish(std::move(loaned_msg)));
+  EXPECT_FALSE(loaned_msg.is_valid());
+
+  rclcpp::executors::SingleThreadedExecutor executor;
+  executor.add_node(node);
+  executor.spin_some();
+
+  // The subscription received the loaned message itself, not a copy.
+  EXPECT_EQ(published_msg, received_msg);
+}
+
+TEST_F(TestPublisher, intra_process_publish_batch) {
+  initialize();
+  rclcpp::PublisherOptionsWithAllocator<std::allocator<void>> pub_options;
+  pub_options.use_intra_process_comm = rclcpp::IntraProcessSetting::Enable;
+  auto publisher = node->create_publisher<test_msgs::msg::Empty>("topic", 10, pub_options);
+
+  rclcpp::SubscriptionOptionsWithAllocator<std::allocator<void>> sub_options;
+  sub_options.use_intra_process_comm = rclcpp::IntraProcessSetting::Enable;
+  std::vector<std::unique_ptr<test_msgs::msg::Empty>> received_msgs;
+  auto subscription = node->create_subscription<test_msgs::msg::Empty>(
+    "topic", 10,
+    [&received_msgs](std::unique_ptr<test_msgs::msg::Empty> msg) {
+      received_msgs.push_back(std::move(msg));
+    },
+    sub_options);
+  ASSERT_EQ(1u, publisher->get_intra_process_subscription_count());
+
+  std::vector<std::unique_ptr<test_msgs::msg::Empty>> unique_msgs;
+  std::vector<const test_msgs::msg::Empty *> published_msgs;
+  for (size_t i = 0; i < 3; ++i) {
+    unique_msgs.push_back(std::make_unique<test_msgs::msg::Empty>());
+    published_msgs.push_back(unique_msgs.back().get());
+  }
+  EXPECT_NO_THROW(publisher->publish_batch(unique_msgs));
+  for (const auto & msg : unique_msgs) {
+    EXPECT_EQ(nullptr, msg);
+  }
+
+  std::vector<test_msgs::msg::Empty> msgs(2);
+  EXPECT_NO_THROW(publisher->publish_batch(msgs.begin(), msgs.end()));
+
+  rclcpp::executors::SingleThreadedExecutor executor;
+  executor.add_node(node);
+  executor.spin_all(std::chrono::seconds(1));
+
+  // The unique messages were given to the subscription, which requires ownership, in order.
+  ASSERT_EQ(5u, received_msgs.size());
+  for (size_t i = 0; i < 3; ++i) {
+    EXPECT_EQ(published_msgs[i], received_msgs[i].get());
+  }
+
+  unique_msgs.clear();
+  unique_msgs.push_back(std::make_unique<test_msgs::msg::Empty>());
+  unique_msgs.push_back(nullptr);
+  RCLCPP_EXPECT_THROW_EQ(
+    publisher->publish_batch(unique_msgs),
+    std::runtime_error("cannot publish msg which is a null pointer"));
+  // Nothing was published.
+  EXPECT_NE(nullptr, unique_msgs[0]);
+}
+
+TEST_F(TestPublisher, inter_process_publish_batch) {
+  initialize();
+  auto publisher = node->create_publisher<test_msgs::msg::Empty>("topic", 10);
+
+  std::vector<test_msgs::msg::Empty> msgs(3);
+  EXPECT_NO_THROW(publisher->publish_batch(msgs));
+  std::vector<std::unique_ptr<test_msgs::msg::Empty>> unique_msgs;
+  unique_msgs.push_back(std::make_unique<test_msgs::msg::Empty>());
+  EXPECT_NO_THROW(publisher->publish_batch(unique_msgs));
+
+  {
+    auto mock = mocking_utils::patch_and_return(
+      "lib:rclcpp", rcl_publish, RCL_RET_ERROR);
+    EXPECT_THROW(publisher->publish_batch(msgs), rclcpp::exceptions::RCLError);
+  }
+}
+
+TEST_F(TestPublisher, intra_process_publish_shared) {
+  initialize();
+  rclcpp::PublisherOptionsWithAllocator<std::allocator<void>> pub_options;
+  pub_options.use_intra_process_comm = rclcpp::IntraProcessSetting::Enable;
+  auto publisher = node->create_publisher<test_msgs::msg::Empty>("topic", 10, pub_options);
+
+  rclcpp::SubscriptionOptionsWithAllocator<std::allocator<void>> sub_options;
+  sub_options.use_intra_process_comm = rclcpp::IntraProcessSetting::Enable;
+  const test_msgs::msg::Empty * received_msg = nullptr;
+  auto subscription = node->create_subscription<test_msgs::msg::Empty>(
+    "topic", 10,
+    [&received_msg](test_msgs::msg::Empty::ConstSharedPtr msg) {
+      received_msg = msg.get();
+    },
+    sub_options);
+
+  auto shared_msg = std::make_shared<const test_msgs::msg::Empty>();
+  EXPECT_NO_THROW(publisher->publish(shared_msg));
+
+  rclcpp::executors::SingleThreadedExecutor executor;
+  executor.add_node(node);
+  executor.spin_some();
+
+  // The subscription received the published message itself, not a copy.
+  EXPECT_EQ(shared_msg.get(), received_msg);
+
+  RCLCPP_EXPECT_THROW_EQ(
+    publisher->publish(std::shared_ptr<const test_msgs::msg::Empty>()),
+    std::runtime_error("cannot publish msg which is a null pointer"));
+}
+
+TEST_F(TestPublisher, cache_serialized_message) {
+  initialize();
+  rclcpp::PublisherOptionsWithAllocator<std::allocator<void>> options;
+  options.cache_serialized_message = true;
+  auto publisher = node->create_publisher<test_msgs::msg::Empty>("topic", 10, options);
+
+  auto shared_msg = std::make_shared<const test_msgs::msg::Empty>();
+  EXPECT_NO_THROW(publisher->publish(shared_msg));
+  {
+    auto mock = mocking_utils::patch_and_return(
+      "lib:rclcpp", rmw_serialize, RMW_RET_ERROR);
+    // The same message is not serialized again.
+    EXPECT_NO_THROW(publisher->publish(shared_msg));
+    // Another message is.
+    EXPECT_THROW(
+      publisher->publish(std::make_shared<const test_msgs::msg::Empty>()),
+      rclcpp::exceptions::RCLError);
+  }
+
+  {
+    auto mock = mocking_utils::patch_and_return(
+      "lib:rclcpp", rcl_publish_serialized_message, RCL_RET_ERROR);
+    EXPECT_THROW(publisher->publish(shared_msg), rclcpp::exceptions::RCLError);
+  }
+}
+
+TEST_F(TestPublisher, publish_with_serialization) {
+  initialize();
+  rclcpp::PublisherOptionsWithAllocator<std::allocator<void>> pub_options;
+  pub_options.use_intra_process_comm = rclcpp::IntraProcessSetting::Enable;
+  auto publisher = node->create_publisher<test_msgs::msg::Empty>("topic", 10, pub_options);
+
+  rclcpp::SubscriptionOptionsWithAllocator<std::allocator<void>> sub_options;
+  sub_options.use_intra_process_comm = rclcpp::IntraProcessSetting::Enable;
+  size_t received_count = 0;
+  auto subscription = node->create_subscription<test_msgs::msg::Empty>(
+    "topic", 10,
+    [&received_count](test_msgs::msg::Empty::ConstSharedPtr) {
+      ++received_count;
+    },
+    sub_options);
+
+  test_msgs::msg::Empty msg;
+  rclcpp::SerializedMessage serialized_msg;
+  rclcpp::Serialization<test_msgs::msg::Empty>().serialize_message(&msg, &serialized_msg);
+  EXPECT_NO_THROW(publisher->publish(msg, serialized_msg));
+
+  rclcpp::executors::SingleThreadedExecutor executor;
+  executor.add_node(node);
+  executor.spin_some();
+  EXPECT_EQ(1u, received_count);
+}
+
+TEST_F(TestPublisher, throttling) {
+  initialize();
+  rclcpp::PublisherOptionsWithAllocator<std::allocator<void>> pub_options;
+  pub_options.use_intra_process_comm = rclcpp::IntraProcessSetting::Enable;
+  pub_options.throttling.keep_every_nth = 3;
+  auto publisher = node->create_publisher<test_msgs::msg::Empty>("topic", 10, pub_options);
+
+  rclcpp::SubscriptionOptionsWithAllocator<std::allocator<void>> sub_options;
+  sub_options.use_intra_process_comm = rclcpp::IntraProcessSetting::Enable;
+  size_t received_count = 0;
+  auto subscription = node->create_subscription<test_msgs::msg::Empty>(
+    "topic", 10,
+    [&received_count](test_msgs::msg::Empty::ConstSharedPtr) {
+      ++received_count;
+    },
+    sub_options);
+  rclcpp::executors::SingleThreadedExecutor executor;
+  executor.add_node(node);
+
+  // The first of every three messages is published, whichever way it is published.
+  test_msgs::msg::Empty msg;
+  for (size_t i = 0; i < 4; ++i) {
+    EXPECT_NO_THROW(publisher->publish(msg));
+  }
+  EXPECT_NO_THROW(publisher->publish(std::make_unique<test_msgs::msg::Empty>()));
+  EXPECT_NO_THROW(publisher->publish(std::make_shared<const test_msgs::msg::Empty>()));
+  std::vector<test_msgs::msg::Empty> msgs(3);
+  EXPECT_NO_THROW(publisher->publish_batch(msgs));
+  executor.spin_all(std::chrono::seconds(1));
+  EXPECT_EQ(3u, received_count);
+  EXPECT_EQ(6u, publisher->get_throttled_message_count());
+
+  // At most one message is published per period.
+  received_count = 0;
+  pub_options.throttling.keep_every_nth = 0;
+  pub_options.throttling.min_period = std::chrono::hours(1);
+  auto rate_publisher = node->create_publisher<test_msgs::msg::Empty>("topic", 10, pub_options);
+  for (size_t i = 0; i < 3; ++i) {
+    EXPECT_NO_THROW(rate_publisher->publish(msg));
+  }
+  executor.spin_all(std::chrono::seconds(1));
+  EXPECT_EQ(1u, received_count);
+  EXPECT_EQ(2u, rate_publisher->get_throttled_message_count());
+
+  {
+    // The dropped messages are not published to the middleware.
+    auto mock = mocking_utils::patch_and_return(
+      "lib:rclcpp", rcl_publish, RCL_RET_ERROR);
+    EXPECT_NO_THROW(rate_publisher->publish(msg));
+  }
+}
+
+TEST_F(TestPublisher, skip_publish_without_subscribers) {
+  initialize();
+  rclcpp::PublisherOptionsWithAllocator<std::allocator<void>> pub_options;
+  pub_options.use_intra_process_comm = rclcpp::IntraProcessSetting::Enable;
+  pub_options.skip_publish_without_subscribers = true;
+  auto publisher = node->create_publisher<test_msgs::msg::Empty>(
+    "skip_topic", 10, pub_options);
+  EXPECT_FALSE(publisher->has_subscribers());
+
+  {
+    // Nothing reaches the middleware while no subscription is matched.
+    auto mock = mocking_utils::patch_and_return(
+      "lib:rclcpp", rcl_publish, RCL_RET_ERROR);
+    test_msgs::msg::Empty msg;
+    EXPECT_NO_THROW(publisher->publish(msg));
+    EXPECT_NO_THROW(publisher->publish(std::make_unique<test_msgs::msg::Empty>()));
+    std::vector<test_msgs::msg::Empty> msgs(3);
+    EXPECT_NO_THROW(publisher->publish_batch(msgs));
+  }
+  EXPECT_EQ(0u, publisher->get_throttled_message_count());
+
+  rclcpp::SubscriptionOptionsWithAllocator<std::allocator<void>> sub_options;
+  sub_options.use_intra_process_comm = rclcpp::IntraProcessSetting::Enable;
+  size_t received_count = 0;
+  auto subscription = node->create_subscription<test_msgs::msg::Empty>(
+    "skip_topic", 10,
+    [&received_count](test_msgs::msg::Empty::ConstSharedPtr) {
+      ++received_count;
+    },
+    sub_options);
+  // The intra-process subscription is matched right away.
+  EXPECT_TRUE(publisher->has_subscribers());
+
+  publisher->publish(test_msgs::msg::Empty());
+  rclcpp::executors::SingleThreadedExecutor executor;
+  executor.add_node(node);
+  executor.spin_all(std::chrono::seconds(1));
+  EXPECT_EQ(1u, received_count);
+
+  // Transient local publishers keep the messages for the late joining subscriptions.
+  pub_options.use_intra_process_comm = rclcpp::IntraProcessSetting::Disable;
+  auto transient_local_publisher = node->create_publisher<test_msgs::msg::Empty>(
+    "skip_transient_local_topic", rclcpp::QoS(1).transient_local(), pub_options);
+  auto mock = mocking_utils::patch_and_return(
+    "lib:rclcpp", rcl_publish, RCL_RET_ERROR);
+  EXPECT_THROW(
+    transient_local_publisher->publish(test_msgs::msg::Empty()), rclcpp::exceptions::RCLError);
+}
+
 TEST_F(TestPublisher, inter_process_publish_failures) {
   initialize();
   rclcpp::PublisherOptionsWithAllocator<std::allocator<void>> options;
@@ -101,6 +101,7 @@ struct TypeAdapter<std::string, rclcpp::msg::String>
     const custom_type & source,
     ros_message_type & destination)
   {
+    ++number_of_conversions_to_ros_message;
     destination.data = source;
   }
 
@@ -111,8 +112,12 @@ struct TypeAdapter<std::string, rclcpp::msg::String>
   {
     destination = source.data;
   }
+
+  static size_t number_of_conversions_to_ros_message;
 };
 
+size_t TypeAdapter<std::string, rclcpp::msg::String>::number_of_conversions_to_ros_message = 0;
+
 // Throws in conversion
 template<>
 struct TypeAdapter<int, rclcpp::msg::String>
@@ -174,6 +179,9 @@ TEST_F(TestPublisher, conversion_exception_is_passed_up) {
     options.use_intra_process_comms(is_intra_process);
     initialize(options);
     auto pub = node->create_publisher<BadStringTypeAdapter>("topic_name", 1);
+    // Intra-process, the message is only converted for a subscription taking the ROS message.
+    auto sub = node->create_subscription<rclcpp::msg::String>(
+      "topic_name", 1, [](const rclcpp::msg::String &) {});
     EXPECT_THROW(pub->publish(1), std::runtime_error);
   }
 }
@@ -265,6 +273,89 @@ TEST_F(
   }
 }
 
+/*
+ * Testing that a type adapted message is not converted to the ROS message when it is only published
+ * intra-process to a subscription of the custom type.
+ */
+TEST_F(
+  CLASSNAME(test_intra_process_within_one_node, RMW_IMPLEMENTATION),
+  check_type_adapted_message_is_not_converted_intra_process) {
+  using StringTypeAdapter = rclcpp::TypeAdapter<std::string, rclcpp::msg::String>;
+  const std::string message_data = "Message Data";
+  const std::string topic_name = "topic_name";
+  int number_of_received_messages = 0;
+
+  auto callback =
+    [message_data, &number_of_received_messages](const std::string & msg) -> void
+    {
+      ++number_of_received_messages;
+      ASSERT_EQ(message_data, msg);
+    };
+
+  auto node = rclcpp::Node::make_shared(
+    "test_intra_process",
+    rclcpp::NodeOptions().use_intra_process_comms(true));
+  auto pub = node->create_publisher<StringTypeAdapter>(topic_name, 10);
+  auto sub = node->create_subscription<StringTypeAdapter>(topic_name, 10, callback);
+
+  StringTypeAdapter::number_of_conversions_to_ros_message = 0;
+  pub->publish(message_data);
+  pub->publish(std::make_unique<std::string>(message_data));
+
+  rclcpp::executors::SingleThreadedExecutor executor;
+  executor.add_node(node);
+  for (int i = 0; number_of_received_messages < 2 && i < g_max_loops; ++i) {
+    executor.spin_once(g_sleep_per_loop);
+  }
+  EXPECT_EQ(2, number_of_received_messages);
+  EXPECT_EQ(0u, StringTypeAdapter::number_of_conversions_to_ros_message);
+}
+
+/*
+ * Testing that a shared type adapted message is shared, without copy nor conversion, with the
+ * intra-process subscriptions of the custom type which do not require its ownership.
+ */
+TEST_F(
+  CLASSNAME(test_intra_process_within_one_node, RMW_IMPLEMENTATION),
+  check_shared_type_adapted_message_is_not_copied_intra_process) {
+  using StringTypeAdapter = rclcpp::TypeAdapter<std::string, rclcpp::msg::String>;
+  const std::string topic_name = "topic_name";
+  auto message = std::make_shared<const std::string>("Message Data");
+  const std::string * received_message = nullptr;
+  size_t number_of_owned_messages = 0;
+
+  auto node = rclcpp::Node::make_shared(
+    "test_intra_process",
+    rclcpp::NodeOptions().use_intra_process_comms(true));
+  auto pub = node->create_publisher<StringTypeAdapter>(topic_name, 10);
+  auto shared_sub = node->create_subscription<StringTypeAdapter>(
+    topic_name, 10,
+    [&received_message](std::shared_ptr<const std::string> msg) {
+      received_message = msg.get();
+    });
+  auto owning_sub = node->create_subscription<StringTypeAdapter>(
+    topic_name, 10,
+    [&message, &number_of_owned_messages](std::unique_ptr<std::string> msg) {
+      EXPECT_EQ(*message, *msg);
+      EXPECT_NE(message.get(), msg.get());
+      ++number_of_owned_messages;
+    });
+
+  StringTypeAdapter::number_of_conversions_to_ros_message = 0;
+  pub->publish(message);
+
+  rclcpp::executors::SingleThreadedExecutor executor;
+  executor.add_node(node);
+  for (int i = 0; (!received_message || number_of_owned_messages < 1) && i < g_max_loops; ++i) {
+    executor.spin_once(g_sleep_per_loop);
+  }
+  EXPECT_EQ(message.get(), received_message);
+  EXPECT_EQ(1u, number_of_owned_messages);
+  EXPECT_EQ(0u, StringTypeAdapter::number_of_conversions_to_ros_message);
+
+  EXPECT_THROW(pub->publish(std::shared_ptr<const std::string>()), std::runtime_error);
+}
+
 /*
  * Testing that publisher sends type adapted types and ROS message types with inter proccess communications.
  */
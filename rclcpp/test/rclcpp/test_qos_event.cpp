@@ -325,3 +325,66 @@ TEST_F(TestQosEvent, add_to_wait_set) {
     EXPECT_THROW(handler.add_to_wait_set(&wait_set), rclcpp::exceptions::RCLError);
   }
 }
+
+TEST_F(TestQosEvent, event_handler_group) {
+  auto publisher = node->create_publisher<test_msgs::msg::Empty>(topic_name, 10);
+  auto rcl_handle = publisher->get_publisher_handle();
+
+  size_t callbacks_executed = 0;
+  // This callback requires some type of parameter, but it could be anything
+  auto callback = [&callbacks_executed](int) {++callbacks_executed;};
+  using HandlerT = rclcpp::QOSEventHandler<decltype(callback), decltype(rcl_handle)>;
+  rcl_publisher_event_type_t event_type = RCL_PUBLISHER_OFFERED_DEADLINE_MISSED;
+  auto handler1 = std::make_shared<HandlerT>(
+    callback, rcl_publisher_event_init, rcl_handle, event_type);
+  auto handler2 = std::make_shared<HandlerT>(
+    callback, rcl_publisher_event_init, rcl_handle, event_type);
+
+  rclcpp::QOSEventHandlerGroup group;
+  EXPECT_THROW(group.add_event_handler(nullptr), std::invalid_argument);
+  group.add_event_handler(handler1);
+  group.add_event_handler(handler2);
+  EXPECT_EQ(2u, group.size());
+  EXPECT_EQ(2u, group.get_number_of_ready_events());
+
+  rcl_wait_set_t wait_set = rcl_get_zero_initialized_wait_set();
+  auto rcl_context = node->get_node_base_interface()->get_context()->get_rcl_context().get();
+  ASSERT_EQ(
+    RCL_RET_OK,
+    rcl_wait_set_init(&wait_set, 0, 0, 0, 0, 0, 2, rcl_context, rcl_get_default_allocator()));
+  EXPECT_TRUE(group.add_to_wait_set(&wait_set));
+  // Not waited on, the events are still in their slots as if they were ready.
+  EXPECT_TRUE(group.is_ready(&wait_set));
+  std::shared_ptr<void> data = group.take_data();
+  group.execute(data);
+  EXPECT_EQ(2u, callbacks_executed);
+  EXPECT_EQ(RCL_RET_OK, rcl_wait_set_fini(&wait_set));
+
+  // The event handlers which no longer exist are forgotten.
+  handler2.reset();
+  EXPECT_EQ(1u, group.get_number_of_ready_events());
+  EXPECT_EQ(1u, group.size());
+}
+
+TEST_F(TestQosEvent, one_waitable_per_callback_group) {
+  auto publisher1 = node->create_publisher<test_msgs::msg::Empty>(topic_name, 10);
+  auto publisher2 = node->create_publisher<test_msgs::msg::Empty>(topic_name, 10);
+  const size_t number_of_event_handlers =
+    publisher1->get_event_handlers().size() + publisher2->get_event_handlers().size();
+
+  size_t event_handler_groups = 0;
+  size_t event_handlers = 0;
+  node->get_node_base_interface()->get_default_callback_group()->find_waitable_ptrs_if(
+    [&](const rclcpp::Waitable::SharedPtr & waitable) {
+      // The event handlers are not added one by one.
+      EXPECT_EQ(nullptr, std::dynamic_pointer_cast<rclcpp::QOSEventHandlerBase>(waitable));
+      auto group = std::dynamic_pointer_cast<rclcpp::QOSEventHandlerGroup>(waitable);
+      if (group) {
+        ++event_handler_groups;
+        event_handlers += group->size();
+      }
+      return false;
+    });
+  EXPECT_EQ(number_of_event_handlers == 0u ? 0u : 1u, event_handler_groups);
+  EXPECT_EQ(number_of_event_handlers, event_handlers);
+}
@@ -25,6 +25,8 @@ TEST(TestQosOverridingOptions, test_overriding_options) {
       rclcpp::QosPolicyKind::History,
       rclcpp::QosPolicyKind::Depth,
       rclcpp::QosPolicyKind::Reliability));
+  EXPECT_TRUE(options.get_declare_parameters());
+  EXPECT_FALSE(options.set_declare_parameters(false).get_declare_parameters());
 }
 
 TEST(TestQosOverridingOptions, test_qos_policy_kind_to_cstr) {
@@ -210,6 +210,47 @@ TEST(TestQosParameters, declare_with_id) {
   rclcpp::shutdown();
 }
 
+TEST(TestQosParameters, overrides_without_declaring) {
+  rclcpp::init(0, nullptr);
+  auto node = std::make_shared<rclcpp::Node>(
+    "my_node", "/ns", rclcpp::NodeOptions().parameter_overrides(
+  {
+    rclcpp::Parameter(
+      "qos_overrides./my/fully/qualified/topic_name.publisher.reliability", "best_effort"),
+    rclcpp::Parameter(
+      "qos_overrides./my/fully/qualified/topic_name.publisher.depth", 20),
+    rclcpp::Parameter(
+      "qos_overrides./my/fully/qualified/wrong_type.subscription.depth", "20"),
+  }));
+
+  rclcpp::QoS qos{rclcpp::KeepLast{10}};
+  qos = rclcpp::detail::declare_qos_parameters(
+    rclcpp::QosOverridingOptions::with_default_policies().set_declare_parameters(false),
+    node,
+    "/my/fully/qualified/topic_name",
+    qos,
+    rclcpp::detail::PublisherQosParametersTraits{});
+  EXPECT_EQ(RMW_QOS_POLICY_HISTORY_KEEP_LAST, qos.get_rmw_qos_profile().history);
+  EXPECT_EQ(RMW_QOS_POLICY_RELIABILITY_BEST_EFFORT, qos.get_rmw_qos_profile().reliability);
+  EXPECT_EQ(20u, qos.get_rmw_qos_profile().depth);
+
+  std::map<std::string, rclcpp::Parameter> qos_params;
+  EXPECT_FALSE(
+    node->get_node_parameters_interface()->get_parameters_by_prefix(
+      "qos_overrides./my/fully/qualified/topic_name", qos_params));
+
+  EXPECT_THROW(
+    rclcpp::detail::declare_qos_parameters(
+      rclcpp::QosOverridingOptions::with_default_policies().set_declare_parameters(false),
+      node,
+      "/my/fully/qualified/wrong_type",
+      qos,
+      rclcpp::detail::SubscriptionQosParametersTraits{}),
+    rclcpp::exceptions::InvalidParameterTypeException);
+
+  rclcpp::shutdown();
+}
+
 TEST(TestQosParameters, declare_no_parameters_interface) {
   rclcpp::init(0, nullptr);
   auto node = std::make_shared<rclcpp::Node>("my_node", "/ns");
@@ -119,3 +119,64 @@ TEST(TestRate, from_double) {
     EXPECT_EQ(std::chrono::milliseconds(250), rate.period());
   }
 }
+
+TEST(TestRate, absolute_deadlines) {
+  auto period = std::chrono::milliseconds(20);
+  auto epsilon = std::chrono::milliseconds(5);
+
+  rclcpp::RateOptions options;
+  options.use_absolute_deadlines = true;
+  auto start = std::chrono::steady_clock::now();
+  rclcpp::WallRate r(period, options);
+  EXPECT_TRUE(r.get_options().use_absolute_deadlines);
+  for (int i = 1; i <= 5; ++i) {
+    ASSERT_TRUE(r.sleep());
+    auto delta = std::chrono::steady_clock::now() - start;
+    EXPECT_LE(i * period, delta);
+    EXPECT_GT(i * period + epsilon, delta);
+  }
+  EXPECT_EQ(0u, r.get_missed_cycles());
+
+  // Overrunning keeps the phase of the periods instead of restarting them.
+  rclcpp::sleep_for(period * 3 + period / 2);
+  ASSERT_FALSE(r.sleep());
+  EXPECT_EQ(3u, r.get_missed_cycles());
+  ASSERT_TRUE(r.sleep());
+  auto delta = std::chrono::steady_clock::now() - start;
+  EXPECT_LE(9 * period, delta);
+  EXPECT_GT(9 * period + epsilon, delta);
+}
+
+TEST(TestRate, spin_threshold) {
+  auto period = std::chrono::milliseconds(10);
+
+  rclcpp::RateOptions options;
+  options.spin_threshold = std::chrono::microseconds(50);
+  auto start = std::chrono::steady_clock::now();
+  rclcpp::WallRate r(period, options);
+  ASSERT_TRUE(r.sleep());
+  EXPECT_LE(period, std::chrono::steady_clock::now() - start);
+
+  options.use_absolute_deadlines = true;
+  start = std::chrono::steady_clock::now();
+  rclcpp::WallRate absolute_r(period, options);
+  ASSERT_TRUE(absolute_r.sleep());
+  EXPECT_LE(period, std::chrono::steady_clock::now() - start);
+}
+
+TEST(TestRate, missed_cycles) {
+  auto period = std::chrono::milliseconds(20);
+
+  rclcpp::WallRate r(period);
+  EXPECT_EQ(0u, r.get_missed_cycles());
+  rclcpp::sleep_for(period + period / 2);
+  ASSERT_FALSE(r.sleep());
+  EXPECT_EQ(1u, r.get_missed_cycles());
+  // The next period ends half a period after the previous call, two of them are missed.
+  rclcpp::sleep_for(period * 2);
+  ASSERT_FALSE(r.sleep());
+  EXPECT_EQ(3u, r.get_missed_cycles());
+  r.reset();
+  ASSERT_TRUE(r.sleep());
+  EXPECT_EQ(3u, r.get_missed_cycles());
+}
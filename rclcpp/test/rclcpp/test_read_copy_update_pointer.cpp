@@ -0,0 +1,138 @@
+// Copyright 2021 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "rclcpp/detail/read_copy_update_pointer.hpp"
+
+using rclcpp::detail::ReadCopyUpdatePointer;
+
+namespace
+{
+
+struct Snapshot
+{
+  Snapshot(int value, std::atomic<int> * destroyed_count)
+  : value(value), check(value), destroyed_count(destroyed_count)
+  {}
+
+  ~Snapshot()
+  {
+    // Make a use after deletion visible to the readers.
+    check = -1;
+    if (destroyed_count) {
+      destroyed_count->fetch_add(1);
+    }
+  }
+
+  int value;
+  volatile int check;
+  std::atomic<int> * destroyed_count;
+};
+
+}  // namespace
+
+TEST(TestReadCopyUpdatePointer, read_update) {
+  std::atomic<int> destroyed_count{0};
+  {
+    ReadCopyUpdatePointer<Snapshot> pointer(std::make_unique<Snapshot>(1, &destroyed_count));
+    {
+      auto snapshot = pointer.read();
+      EXPECT_EQ(1, snapshot->value);
+    }
+
+    pointer.update(std::make_unique<Snapshot>(2, &destroyed_count));
+    EXPECT_EQ(1, destroyed_count.load());
+    {
+      auto snapshot = pointer.read();
+      EXPECT_EQ(2, (*snapshot).value);
+      EXPECT_EQ(2, snapshot.get()->value);
+    }
+  }
+  EXPECT_EQ(2, destroyed_count.load());
+}
+
+/*
+   Testing that the previous snapshot outlives the guards reading it.
+ */
+TEST(TestReadCopyUpdatePointer, update_waits_for_readers) {
+  std::atomic<int> destroyed_count{0};
+  ReadCopyUpdatePointer<Snapshot> pointer(std::make_unique<Snapshot>(1, &destroyed_count));
+
+  std::atomic<bool> updated{false};
+  std::thread writer;
+  {
+    auto snapshot = pointer.read();
+    writer = std::thread(
+      [&pointer, &destroyed_count, &updated]() {
+        pointer.update(std::make_unique<Snapshot>(2, &destroyed_count));
+        updated = true;
+      });
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    EXPECT_FALSE(updated.load());
+    EXPECT_EQ(0, destroyed_count.load());
+    EXPECT_EQ(1, snapshot->check);
+
+    // A new reader is not kept waiting by the pending update.
+    auto new_snapshot = pointer.read();
+    EXPECT_EQ(2, new_snapshot->value);
+  }
+  writer.join();
+  EXPECT_TRUE(updated.load());
+  EXPECT_EQ(1, destroyed_count.load());
+}
+
+TEST(TestReadCopyUpdatePointer, concurrent_readers) {
+  constexpr int number_of_updates = 1000;
+  constexpr size_t number_of_readers = 4u;
+
+  std::atomic<int> destroyed_count{0};
+  ReadCopyUpdatePointer<Snapshot> pointer(std::make_unique<Snapshot>(0, &destroyed_count));
+
+  std::atomic<bool> done{false};
+  std::atomic<size_t> inconsistent_reads{0u};
+  std::vector<std::thread> readers;
+  for (size_t i = 0; i < number_of_readers; ++i) {
+    readers.emplace_back(
+      [&pointer, &done, &inconsistent_reads]() {
+        int last_value = 0;
+        while (!done.load()) {
+          auto snapshot = pointer.read();
+          if (snapshot->check != snapshot->value || snapshot->value < last_value) {
+            inconsistent_reads.fetch_add(1u);
+          }
+          last_value = snapshot->value;
+        }
+      });
+  }
+
+  for (int i = 1; i <= number_of_updates; ++i) {
+    pointer.update(std::make_unique<Snapshot>(i, &destroyed_count));
+  }
+  done = true;
+  for (auto & reader : readers) {
+    reader.join();
+  }
+
+  EXPECT_EQ(0u, inconsistent_reads.load());
+  EXPECT_EQ(number_of_updates, destroyed_count.load());
+  EXPECT_EQ(number_of_updates, pointer.read()->value);
+}
@@ -0,0 +1,100 @@
+// Copyright 2021 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "rclcpp/detail/ready_bitmap.hpp"
+
+using rclcpp::detail::ReadyBitmap;
+
+namespace
+{
+
+struct Entity
+{
+};
+
+std::vector<size_t>
+ready_indices(const ReadyBitmap & bitmap, size_t end)
+{
+  std::vector<size_t> indices;
+  bitmap.for_each(
+    end, [&indices](size_t i) {
+      indices.push_back(i);
+      return true;
+    });
+  return indices;
+}
+
+}  // namespace
+
+TEST(TestReadyBitmap, empty) {
+  ReadyBitmap bitmap;
+  EXPECT_EQ(0u, bitmap.size());
+  EXPECT_FALSE(bitmap.any());
+  EXPECT_TRUE(ready_indices(bitmap, 10u).empty());
+
+  bitmap.assign<const Entity>(nullptr, 0u);
+  EXPECT_FALSE(bitmap.any());
+}
+
+TEST(TestReadyBitmap, ready_slots) {
+  Entity entity;
+  std::vector<const Entity *> slots(200u, nullptr);
+  const std::vector<size_t> ready {0u, 5u, 63u, 64u, 130u, 199u};
+  for (size_t i : ready) {
+    slots[i] = &entity;
+  }
+
+  ReadyBitmap bitmap;
+  bitmap.assign(slots.data(), slots.size());
+  EXPECT_EQ(200u, bitmap.size());
+  EXPECT_EQ(ready, ready_indices(bitmap, slots.size()));
+  // The visit stops at the end, which may be past the size.
+  EXPECT_EQ(std::vector<size_t>({0u, 5u, 63u}), ready_indices(bitmap, 64u));
+  EXPECT_EQ(ready, ready_indices(bitmap, 1000u));
+
+  EXPECT_TRUE(bitmap.any());
+  EXPECT_TRUE(bitmap.any(199u));
+  EXPECT_TRUE(bitmap.any(131u));
+  EXPECT_TRUE(bitmap.any(65u));
+  EXPECT_FALSE(bitmap.any(200u));
+
+  // Reassigning forgets the previous slots.
+  slots.assign(70u, nullptr);
+  slots[66u] = &entity;
+  bitmap.assign(slots.data(), slots.size());
+  EXPECT_EQ(70u, bitmap.size());
+  EXPECT_EQ(std::vector<size_t>({66u}), ready_indices(bitmap, slots.size()));
+  EXPECT_FALSE(bitmap.any(67u));
+  EXPECT_TRUE(bitmap.any(66u));
+}
+
+TEST(TestReadyBitmap, stop_visit) {
+  Entity entity;
+  std::vector<const Entity *> slots(10u, &entity);
+  ReadyBitmap bitmap;
+  bitmap.assign(slots.data(), slots.size());
+
+  std::vector<size_t> indices;
+  EXPECT_FALSE(
+    bitmap.for_each(
+      slots.size(), [&indices](size_t i) {
+        indices.push_back(i);
+        return i < 2u;
+      }));
+  EXPECT_EQ(std::vector<size_t>({0u, 1u, 2u}), indices);
+}
@@ -0,0 +1,79 @@
+// Copyright 2021 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <utility>
+
+#include "rclcpp/detail/releasable_shared_message.hpp"
+
+using rclcpp::detail::make_releasable_shared_message;
+using rclcpp::detail::try_release_shared_message;
+
+namespace
+{
+
+struct CountingDeleter
+{
+  void
+  operator()(int * message)
+  {
+    ++*deletions;
+    delete message;
+  }
+
+  int * deletions;
+};
+
+}  // namespace
+
+TEST(TestReleasableSharedMessage, release_last_owner) {
+  int deletions = 0;
+  std::unique_ptr<int, CountingDeleter> message(new int(42), CountingDeleter{&deletions});
+  const int * address = message.get();
+
+  std::shared_ptr<const int> shared = make_releasable_shared_message(std::move(message));
+  std::shared_ptr<const int> other = shared;
+  // Still shared, it cannot be released.
+  EXPECT_EQ(nullptr, (try_release_shared_message<int, CountingDeleter>(shared)));
+  EXPECT_EQ(address, shared.get());
+
+  other.reset();
+  auto released = try_release_shared_message<int, CountingDeleter>(shared);
+  ASSERT_NE(nullptr, released);
+  EXPECT_EQ(nullptr, shared);
+  EXPECT_EQ(address, released.get());
+  EXPECT_EQ(42, *released);
+  EXPECT_EQ(0, deletions);
+
+  // The released message keeps the original deleter.
+  released.reset();
+  EXPECT_EQ(1, deletions);
+}
+
+TEST(TestReleasableSharedMessage, not_releasable) {
+  // Not shared by make_releasable_shared_message().
+  std::shared_ptr<const int> shared = std::make_shared<int>(42);
+  EXPECT_EQ(nullptr, (try_release_shared_message<int, std::default_delete<int>>(shared)));
+  EXPECT_NE(nullptr, shared);
+
+  // Shared with another deleter type.
+  int deletions = 0;
+  std::unique_ptr<int, CountingDeleter> message(new int(42), CountingDeleter{&deletions});
+  shared = make_releasable_shared_message(std::move(message));
+  EXPECT_EQ(nullptr, (try_release_shared_message<int, std::default_delete<int>>(shared)));
+  shared.reset();
+  EXPECT_EQ(1, deletions);
+}
@@ -13,13 +13,21 @@
 // limitations under the License.
 
 
+#include <atomic>
+#include <chrono>
 #include <memory>
+#include <thread>
 #include <utility>
+#include <vector>
 
 #include "gtest/gtest.h"
 
 #include "rclcpp/experimental/buffers/buffer_implementation_base.hpp"
+#include "rclcpp/experimental/buffers/keep_all_buffer_implementation.hpp"
+#include "rclcpp/experimental/buffers/lock_free_multi_producer_ring_buffer_implementation.hpp"
+#include "rclcpp/experimental/buffers/lock_free_ring_buffer_implementation.hpp"
 #include "rclcpp/experimental/buffers/ring_buffer_implementation.hpp"
+#include "rclcpp/experimental/buffers/statistics_buffer_implementation.hpp"
 
 /*
    Construtctor
@@ -79,3 +87,309 @@ TEST(TestRingBufferImplementation, basic_usage) {
   EXPECT_EQ(false, rb.has_data());
   EXPECT_EQ(false, rb.is_full());
 }
+
+/*
+   Same as basic_usage with the lock-free buffer, with a capacity which is not a power of two
+ */
+TEST(TestLockFreeRingBufferImplementation, basic_usage) {
+  EXPECT_THROW(
+    rclcpp::experimental::buffers::LockFreeRingBufferImplementation<char> rb(0),
+    std::invalid_argument);
+
+  rclcpp::experimental::buffers::LockFreeRingBufferImplementation<char> rb(3);
+
+  EXPECT_EQ(false, rb.has_data());
+  EXPECT_EQ(false, rb.is_full());
+  EXPECT_THROW(rb.dequeue(), std::runtime_error);
+
+  rb.enqueue('a');
+  rb.enqueue('b');
+  rb.enqueue('c');
+
+  EXPECT_EQ(true, rb.has_data());
+  EXPECT_EQ(true, rb.is_full());
+
+  rb.enqueue('d');
+
+  EXPECT_EQ(true, rb.is_full());
+  EXPECT_EQ('b', rb.dequeue());
+  EXPECT_EQ('c', rb.dequeue());
+  EXPECT_EQ(false, rb.is_full());
+  EXPECT_EQ('d', rb.dequeue());
+  EXPECT_EQ(false, rb.has_data());
+
+  rb.enqueue('e');
+  rb.clear();
+  EXPECT_EQ(false, rb.has_data());
+}
+
+/*
+   One thread enqueues while another one dequeues, the elements come out in order
+ */
+TEST(TestLockFreeRingBufferImplementation, concurrent_enqueue_dequeue) {
+  using UniqueIntPtr = std::unique_ptr<size_t>;
+  rclcpp::experimental::buffers::LockFreeRingBufferImplementation<UniqueIntPtr> rb(4);
+  constexpr size_t number_of_elements = 100000;
+
+  std::thread producer(
+    [&rb]() {
+      for (size_t i = 0; i < number_of_elements; ++i) {
+        rb.enqueue(std::make_unique<size_t>(i));
+      }
+    });
+
+  size_t last_value = 0;
+  size_t number_of_dequeued_elements = 0;
+  bool in_order = true;
+  bool done = false;
+  while (!done) {
+    if (!rb.has_data()) {
+      continue;
+    }
+    auto value = rb.dequeue();
+    in_order = in_order && (0u == number_of_dequeued_elements || *value > last_value);
+    last_value = *value;
+    number_of_dequeued_elements++;
+    done = last_value == number_of_elements - 1;
+  }
+  producer.join();
+
+  // Elements are dropped when the buffer is full, but never reordered nor duplicated.
+  EXPECT_TRUE(in_order);
+  EXPECT_LE(number_of_dequeued_elements, number_of_elements);
+  EXPECT_EQ(false, rb.has_data());
+}
+
+/*
+   Same as basic_usage with the lock-free multi-producer buffer
+ */
+TEST(TestLockFreeMultiProducerRingBufferImplementation, basic_usage) {
+  EXPECT_THROW(
+    rclcpp::experimental::buffers::LockFreeMultiProducerRingBufferImplementation<char> rb(0),
+    std::invalid_argument);
+
+  rclcpp::experimental::buffers::LockFreeMultiProducerRingBufferImplementation<char> rb(3);
+
+  EXPECT_EQ(false, rb.has_data());
+  EXPECT_THROW(rb.dequeue(), std::runtime_error);
+
+  rb.enqueue('a');
+  rb.enqueue('b');
+  rb.enqueue('c');
+  EXPECT_EQ(true, rb.is_full());
+
+  rb.enqueue('d');
+
+  EXPECT_EQ(true, rb.is_full());
+  EXPECT_EQ('b', rb.dequeue());
+  EXPECT_EQ(false, rb.is_full());
+  EXPECT_EQ('c', rb.dequeue());
+  EXPECT_EQ('d', rb.dequeue());
+  EXPECT_EQ(false, rb.has_data());
+}
+
+/*
+   Several threads enqueue while another one dequeues
+   - with a large enough buffer, no element is lost
+   - with a small buffer, elements of each thread still come out in order
+ */
+TEST(TestLockFreeMultiProducerRingBufferImplementation, concurrent_enqueue_dequeue) {
+  using Element = std::pair<size_t, size_t>;
+  constexpr size_t number_of_producers = 4;
+  constexpr size_t number_of_elements = 20000;
+
+  for (size_t capacity : {number_of_producers * number_of_elements, size_t(8)}) {
+    rclcpp::experimental::buffers::LockFreeMultiProducerRingBufferImplementation<Element> rb(
+      capacity);
+
+    std::vector<std::thread> producers;
+    for (size_t producer = 0; producer < number_of_producers; ++producer) {
+      producers.emplace_back(
+        [&rb, producer]() {
+          for (size_t i = 1; i <= number_of_elements; ++i) {
+            rb.enqueue(Element(producer, i));
+          }
+        });
+    }
+
+    // The last element of a thread may be dropped, stop once all threads are done.
+    std::atomic_bool producers_done{false};
+    std::vector<size_t> last_values(number_of_producers, 0);
+    size_t number_of_dequeued_elements = 0;
+    bool in_order = true;
+    std::thread consumer(
+      [&]() {
+        while (!producers_done.load() || rb.has_data()) {
+          if (!rb.has_data()) {
+            std::this_thread::yield();
+            continue;
+          }
+          const Element element = rb.dequeue();
+          in_order = in_order && element.second > last_values[element.first];
+          last_values[element.first] = element.second;
+          number_of_dequeued_elements++;
+        }
+      });
+    for (auto & producer : producers) {
+      producer.join();
+    }
+    producers_done.store(true);
+    consumer.join();
+
+    EXPECT_TRUE(in_order);
+    if (capacity >= number_of_producers * number_of_elements) {
+      EXPECT_EQ(number_of_producers * number_of_elements, number_of_dequeued_elements);
+    } else {
+      EXPECT_GE(number_of_producers * number_of_elements, number_of_dequeued_elements);
+    }
+    EXPECT_EQ(false, rb.has_data());
+  }
+}
+
+/*
+   Statistics of a buffer
+   - the buffers do not collect statistics by default
+   - enqueue over the capacity and check the drops and the high-water mark
+   - dequeue and check the time spent in the buffer
+ */
+TEST(TestRingBufferImplementation, statistics) {
+  using rclcpp::experimental::buffers::RingBufferImplementation;
+  using rclcpp::experimental::buffers::StatisticsBufferImplementation;
+
+  EXPECT_FALSE(RingBufferImplementation<char>(2).get_statistics().enabled);
+  EXPECT_THROW(
+    StatisticsBufferImplementation<char>(nullptr, 2),
+    std::invalid_argument);
+  EXPECT_THROW(
+    StatisticsBufferImplementation<char>(std::make_unique<RingBufferImplementation<char>>(2), 0),
+    std::invalid_argument);
+
+  StatisticsBufferImplementation<char> rb(std::make_unique<RingBufferImplementation<char>>(2), 2);
+  auto statistics = rb.get_statistics();
+  EXPECT_TRUE(statistics.enabled);
+  EXPECT_EQ(0u, statistics.enqueued_count);
+  EXPECT_EQ(0u, statistics.size);
+
+  rb.enqueue('a');
+  rb.enqueue('b');
+  rb.enqueue('c');
+  rb.enqueue('d');
+
+  statistics = rb.get_statistics();
+  EXPECT_EQ(4u, statistics.enqueued_count);
+  EXPECT_EQ(2u, statistics.dropped_count);
+  EXPECT_EQ(2u, statistics.size);
+  EXPECT_EQ(2u, statistics.high_water_mark);
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  EXPECT_EQ('c', rb.dequeue());
+  EXPECT_EQ('d', rb.dequeue());
+  EXPECT_FALSE(rb.has_data());
+  EXPECT_THROW(rb.dequeue(), std::runtime_error);
+
+  statistics = rb.get_statistics();
+  EXPECT_EQ(2u, statistics.dequeued_count);
+  EXPECT_EQ(0u, statistics.size);
+  EXPECT_EQ(2u, statistics.high_water_mark);
+  EXPECT_GE(statistics.max_time_in_queue, std::chrono::milliseconds(10));
+  EXPECT_GE(statistics.total_time_in_queue, 2 * std::chrono::milliseconds(10));
+
+  // The enqueue times keep following the elements after wrapping around.
+  rb.enqueue('e');
+  EXPECT_EQ('e', rb.dequeue());
+  statistics = rb.get_statistics();
+  EXPECT_EQ(5u, statistics.enqueued_count);
+  EXPECT_EQ(3u, statistics.dequeued_count);
+  EXPECT_EQ(2u, statistics.dropped_count);
+}
+
+/*
+   Keep all buffer
+   - grow the storage up to the maximum size, keeping the order of the elements
+   - apply each backpressure policy once full
+ */
+TEST(TestKeepAllBufferImplementation, grow_and_backpressure) {
+  using rclcpp::experimental::buffers::KeepAllBufferImplementation;
+
+  rclcpp::IntraProcessKeepAllOptions options;
+  options.max_messages = 0;
+  EXPECT_THROW(KeepAllBufferImplementation<int> kb(options), std::invalid_argument);
+  options.max_messages = 40;
+  options.max_blocking_time = std::chrono::nanoseconds(-1);
+  EXPECT_THROW(KeepAllBufferImplementation<int> kb(options), std::invalid_argument);
+  options.max_blocking_time = std::chrono::milliseconds(10);
+
+  options.backpressure = rclcpp::IntraProcessBackpressurePolicy::Fail;
+  KeepAllBufferImplementation<int> kb(options, true);
+  EXPECT_FALSE(kb.has_data());
+  EXPECT_GT(40u, kb.capacity());
+
+  // Wrap around the storage before it grows.
+  for (int i = 0; i < 10; ++i) {
+    kb.enqueue(i);
+    EXPECT_EQ(i, kb.dequeue());
+  }
+  for (int i = 0; i < 40; ++i) {
+    kb.enqueue(i);
+  }
+  EXPECT_EQ(40u, kb.size());
+  EXPECT_EQ(40u, kb.capacity());
+  EXPECT_THROW(kb.enqueue(40), rclcpp::exceptions::IntraProcessBufferFullError);
+  for (int i = 0; i < 40; ++i) {
+    EXPECT_EQ(i, kb.dequeue());
+  }
+  EXPECT_FALSE(kb.has_data());
+  EXPECT_THROW(kb.dequeue(), std::runtime_error);
+
+  auto statistics = kb.get_statistics();
+  EXPECT_TRUE(statistics.enabled);
+  EXPECT_EQ(50u, statistics.enqueued_count);
+  EXPECT_EQ(50u, statistics.dequeued_count);
+  EXPECT_EQ(0u, statistics.dropped_count);
+  EXPECT_EQ(40u, statistics.high_water_mark);
+
+  options.max_messages = 2;
+  options.backpressure = rclcpp::IntraProcessBackpressurePolicy::DropOldest;
+  KeepAllBufferImplementation<int> dropping(options, true);
+  dropping.enqueue(1);
+  dropping.enqueue(2);
+  dropping.enqueue(3);
+  EXPECT_EQ(1u, dropping.get_statistics().dropped_count);
+  EXPECT_EQ(2, dropping.dequeue());
+  EXPECT_EQ(3, dropping.dequeue());
+
+  options.backpressure = rclcpp::IntraProcessBackpressurePolicy::Block;
+  KeepAllBufferImplementation<int> blocking(options);
+  blocking.enqueue(1);
+  blocking.enqueue(2);
+  // Times out while nothing is dequeued.
+  EXPECT_THROW(blocking.enqueue(3), rclcpp::exceptions::IntraProcessBufferFullError);
+  EXPECT_EQ(2u, blocking.size());
+}
+
+/*
+   Keep all buffer with the Block policy
+   - a publisher blocked on the full buffer resumes once an element is dequeued
+ */
+TEST(TestKeepAllBufferImplementation, block_until_dequeued) {
+  using rclcpp::experimental::buffers::KeepAllBufferImplementation;
+
+  rclcpp::IntraProcessKeepAllOptions options;
+  options.max_messages = 1;
+  options.backpressure = rclcpp::IntraProcessBackpressurePolicy::Block;
+  options.max_blocking_time = std::chrono::seconds(10);
+  KeepAllBufferImplementation<int> kb(options);
+  kb.enqueue(1);
+
+  std::atomic<bool> enqueued{false};
+  std::thread publisher([&kb, &enqueued]() {
+      kb.enqueue(2);
+      enqueued = true;
+    });
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  EXPECT_FALSE(enqueued);
+  EXPECT_EQ(1, kb.dequeue());
+  publisher.join();
+  EXPECT_TRUE(enqueued);
+  EXPECT_EQ(2, kb.dequeue());
+}
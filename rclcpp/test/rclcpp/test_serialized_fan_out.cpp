@@ -0,0 +1,99 @@
+// Copyright 2021 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <string>
+
+#include "rclcpp/rclcpp.hpp"
+#include "rclcpp/serialized_fan_out.hpp"
+
+#include "test_msgs/msg/strings.hpp"
+
+class TestSerializedFanOut : public ::testing::Test
+{
+protected:
+  static void SetUpTestCase()
+  {
+    rclcpp::init(0, nullptr);
+  }
+
+  static void TearDownTestCase()
+  {
+    rclcpp::shutdown();
+  }
+
+  void SetUp()
+  {
+    node = std::make_shared<rclcpp::Node>(
+      "test_serialized_fan_out", "/ns", rclcpp::NodeOptions().use_intra_process_comms(true));
+  }
+
+  rclcpp::Node::SharedPtr node;
+};
+
+TEST_F(TestSerializedFanOut, publish) {
+  size_t raw_count = 0;
+  size_t relay_count = 0;
+  auto raw_subscription = node->create_subscription<test_msgs::msg::Strings>(
+    "raw", 10,
+    [&raw_count](test_msgs::msg::Strings::ConstSharedPtr msg) {
+      EXPECT_EQ("fan out", msg->string_value);
+      ++raw_count;
+    });
+  auto relay_subscription = node->create_generic_subscription(
+    "relay", "test_msgs/msg/Strings", 10,
+    [&relay_count](std::shared_ptr<rclcpp::SerializedMessage> serialized_msg) {
+      test_msgs::msg::Strings msg;
+      rclcpp::Serialization<test_msgs::msg::Strings>().deserialize_message(
+        serialized_msg.get(), &msg);
+      EXPECT_EQ("fan out", msg.string_value);
+      ++relay_count;
+    });
+
+  rclcpp::SerializedFanOut<test_msgs::msg::Strings> fan_out(64);
+  fan_out.add_publisher(node->create_publisher<test_msgs::msg::Strings>("raw", 10));
+  fan_out.add_publisher(
+    node->create_generic_publisher("relay", "test_msgs/msg/Strings", 10));
+  EXPECT_EQ(2u, fan_out.get_publisher_count());
+
+  test_msgs::msg::Strings msg;
+  msg.string_value = "fan out";
+  fan_out.publish(msg);
+
+  // The message was serialized once, into the buffer of the fan-out.
+  test_msgs::msg::Strings deserialized_msg;
+  rclcpp::Serialization<test_msgs::msg::Strings>().deserialize_message(
+    &fan_out.get_serialized_message(), &deserialized_msg);
+  EXPECT_EQ(msg, deserialized_msg);
+  EXPECT_GE(fan_out.get_serialized_message().capacity(), 64u);
+
+  rclcpp::executors::SingleThreadedExecutor executor;
+  executor.add_node(node);
+  executor.spin_all(std::chrono::seconds(1));
+  EXPECT_EQ(1u, raw_count);
+  EXPECT_EQ(1u, relay_count);
+}
+
+TEST_F(TestSerializedFanOut, null_publisher) {
+  rclcpp::SerializedFanOut<test_msgs::msg::Strings> fan_out;
+  EXPECT_THROW(
+    fan_out.add_publisher(rclcpp::Publisher<test_msgs::msg::Strings>::SharedPtr()),
+    std::invalid_argument);
+  EXPECT_THROW(
+    fan_out.add_publisher(rclcpp::GenericPublisher::SharedPtr()),
+    std::invalid_argument);
+  EXPECT_EQ(0u, fan_out.get_publisher_count());
+}
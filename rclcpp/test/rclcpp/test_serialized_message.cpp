@@ -18,6 +18,7 @@
 #include <memory>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "rclcpp/serialization.hpp"
 #include "rclcpp/serialized_message.hpp"
@@ -173,6 +174,47 @@ TEST(TestSerializedMessage, serialization) {
   }
 }
 
+TEST(TestSerializedMessage, serialization_into_buffer) {
+  using MessageT = test_msgs::msg::BasicTypes;
+
+  rclcpp::Serialization<MessageT> serializer;
+
+  auto basic_type_ros_msgs = get_messages_basic_types();
+  for (const auto & ros_msg : basic_type_ros_msgs) {
+    rclcpp::SerializedMessage serialized_msg;
+    serializer.serialize_message(ros_msg.get(), &serialized_msg);
+
+    const size_t serialized_size = serializer.get_serialized_size(ros_msg.get());
+    ASSERT_LE(serialized_msg.size(), serialized_size);
+
+    // Too small a buffer is left untouched and reports the capacity needed.
+    std::vector<uint8_t> buffer(serialized_msg.size() - 1, 0);
+    size_t required_size = 0;
+    EXPECT_EQ(
+      0u,
+      serializer.serialize_message(
+        ros_msg.get(), buffer.data(), buffer.size(), &required_size));
+    EXPECT_GT(required_size, buffer.size());
+
+    buffer.resize(required_size);
+    const size_t size = serializer.serialize_message(
+      ros_msg.get(), buffer.data(), buffer.size(), &required_size);
+    ASSERT_EQ(serialized_msg.size(), size);
+    EXPECT_EQ(size, required_size);
+    EXPECT_EQ(
+      0, std::memcmp(serialized_msg.get_rcl_serialized_message().buffer, buffer.data(), size));
+
+    // The serialized message keeps its capacity, the second serialization does not grow it.
+    const size_t capacity = serialized_msg.capacity();
+    serializer.serialize_message(ros_msg.get(), &serialized_msg);
+    EXPECT_EQ(capacity, serialized_msg.capacity());
+  }
+
+  MessageT ros_msg;
+  EXPECT_THROW(
+    serializer.serialize_message(&ros_msg, nullptr, 1u), rcpputils::IllegalStateException);
+}
+
 TEST(TestSerializedMessage, assignment_operators) {
   const std::string content = "Hello World";
   const auto content_size = content.size() + 1;  // accounting for null terminator
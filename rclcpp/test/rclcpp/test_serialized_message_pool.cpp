@@ -0,0 +1,131 @@
+// Copyright 2021 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "rclcpp/serialized_message_pool.hpp"
+
+using rclcpp::SerializedMessage;
+using rclcpp::SerializedMessagePool;
+
+namespace
+{
+
+// As taking a serialized message of this size does.
+void
+fill(SerializedMessage & serialized_message, size_t size)
+{
+  if (serialized_message.capacity() < size) {
+    serialized_message.reserve(size);
+  }
+  serialized_message.get_rcl_serialized_message().buffer_length = size;
+}
+
+}  // namespace
+
+TEST(TestSerializedMessagePool, reuse) {
+  SerializedMessagePool pool;
+  EXPECT_EQ(0u, pool.get_number_of_pooled_messages());
+
+  auto serialized_message = pool.borrow_serialized_message(100);
+  ASSERT_NE(nullptr, serialized_message);
+  EXPECT_EQ(100u, serialized_message->capacity());
+  fill(*serialized_message, 80);
+  auto * pointer = serialized_message.get();
+  pool.return_serialized_message(serialized_message);
+  EXPECT_EQ(nullptr, serialized_message);
+  EXPECT_EQ(1u, pool.get_number_of_pooled_messages());
+
+  // The same message is borrowed again, empty and with the capacity of the sizes.
+  serialized_message = pool.borrow_serialized_message();
+  EXPECT_EQ(pointer, serialized_message.get());
+  EXPECT_EQ(0u, serialized_message->size());
+  EXPECT_EQ(128u, pool.get_target_capacity());
+  EXPECT_EQ(128u, serialized_message->capacity());
+  EXPECT_EQ(0u, pool.get_number_of_pooled_messages());
+  pool.return_serialized_message(serialized_message);
+}
+
+TEST(TestSerializedMessagePool, capacity_follows_sizes) {
+  SerializedMessagePool pool;
+  EXPECT_EQ(0u, pool.get_target_capacity());
+
+  for (size_t i = 0; i < 200; ++i) {
+    auto serialized_message = pool.borrow_serialized_message();
+    fill(*serialized_message, 1000);
+    pool.return_serialized_message(serialized_message);
+  }
+  EXPECT_EQ(1024u, pool.get_target_capacity());
+
+  // New messages are created with the capacity.
+  std::vector<std::shared_ptr<SerializedMessage>> serialized_messages;
+  for (size_t i = 0; i < 2; ++i) {
+    serialized_messages.push_back(pool.borrow_serialized_message());
+  }
+  EXPECT_EQ(1024u, serialized_messages.back()->capacity());
+  EXPECT_EQ(2048u, pool.borrow_serialized_message(2048)->capacity());
+
+  // A rare large message does not change the capacity, nor is it kept.
+  fill(*serialized_messages.back(), 1024 * 1024);
+  pool.return_serialized_message(serialized_messages.back());
+  EXPECT_EQ(1024u, pool.get_target_capacity());
+  EXPECT_EQ(0u, pool.get_number_of_pooled_messages());
+  pool.return_serialized_message(serialized_messages.front());
+  EXPECT_EQ(1u, pool.get_number_of_pooled_messages());
+}
+
+TEST(TestSerializedMessagePool, messages_not_kept) {
+  SerializedMessagePool pool(1);
+
+  // Still referenced.
+  auto serialized_message = pool.borrow_serialized_message();
+  auto reference = serialized_message;
+  pool.return_serialized_message(serialized_message);
+  EXPECT_EQ(nullptr, serialized_message);
+  EXPECT_EQ(0u, pool.get_number_of_pooled_messages());
+
+  // The pool is full.
+  auto first = pool.borrow_serialized_message();
+  auto second = pool.borrow_serialized_message();
+  pool.return_serialized_message(first);
+  pool.return_serialized_message(second);
+  EXPECT_EQ(1u, pool.get_number_of_pooled_messages());
+
+  std::shared_ptr<SerializedMessage> null_message;
+  EXPECT_NO_THROW(pool.return_serialized_message(null_message));
+}
+
+TEST(TestSerializedMessagePool, concurrent_use) {
+  SerializedMessagePool pool(4);
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < 4; ++i) {
+    threads.emplace_back(
+      [&pool, i]() {
+        for (size_t j = 0; j < 1000; ++j) {
+          auto serialized_message = pool.borrow_serialized_message();
+          fill(*serialized_message, 100 * (i + 1));
+          pool.return_serialized_message(serialized_message);
+        }
+      });
+  }
+  for (auto & thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(512u, pool.get_target_capacity());
+  EXPECT_GE(4u, pool.get_number_of_pooled_messages());
+}
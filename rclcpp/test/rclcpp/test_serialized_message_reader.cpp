@@ -0,0 +1,140 @@
+// Copyright 2021 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include "rclcpp/serialization.hpp"
+#include "rclcpp/serialized_message.hpp"
+#include "rclcpp/serialized_message_reader.hpp"
+
+#include "rosidl_typesupport_cpp/message_type_support.hpp"
+
+#include "test_msgs/msg/basic_types.hpp"
+#include "test_msgs/msg/nested.hpp"
+#include "test_msgs/msg/strings.hpp"
+#include "test_msgs/msg/unbounded_sequences.hpp"
+
+template<typename MessageT>
+rclcpp::SerializedMessage
+serialize(const MessageT & msg)
+{
+  rclcpp::SerializedMessage serialized_msg;
+  rclcpp::Serialization<MessageT>().serialize_message(&msg, &serialized_msg);
+  return serialized_msg;
+}
+
+TEST(TestSerializedMessageReader, read_basic_types) {
+  test_msgs::msg::BasicTypes msg;
+  msg.bool_value = true;
+  msg.byte_value = 0x12;
+  msg.char_value = 'c';
+  msg.float32_value = 1.5f;
+  msg.float64_value = -2.25;
+  msg.int8_value = -8;
+  msg.uint8_value = 8;
+  msg.int16_value = -16;
+  msg.uint16_value = 16;
+  msg.int32_value = -32;
+  msg.uint32_value = 32;
+  msg.int64_value = -64;
+  msg.uint64_value = 64;
+  const auto serialized_msg = serialize(msg);
+
+  rclcpp::SerializedMessageReader reader("test_msgs/msg/BasicTypes");
+  EXPECT_TRUE(reader.read<bool>(serialized_msg, reader.get_field("bool_value")));
+  EXPECT_EQ(0x12, reader.read<uint8_t>(serialized_msg, reader.get_field("byte_value")));
+  EXPECT_EQ('c', reader.read<uint8_t>(serialized_msg, reader.get_field("char_value")));
+  EXPECT_EQ(1.5f, reader.read<float>(serialized_msg, reader.get_field("float32_value")));
+  EXPECT_EQ(-2.25, reader.read<double>(serialized_msg, reader.get_field("float64_value")));
+  EXPECT_EQ(-8, reader.read<int8_t>(serialized_msg, reader.get_field("int8_value")));
+  EXPECT_EQ(8u, reader.read<uint8_t>(serialized_msg, reader.get_field("uint8_value")));
+  EXPECT_EQ(-16, reader.read<int16_t>(serialized_msg, reader.get_field("int16_value")));
+  EXPECT_EQ(16u, reader.read<uint16_t>(serialized_msg, reader.get_field("uint16_value")));
+  EXPECT_EQ(-32, reader.read<int32_t>(serialized_msg, reader.get_field("int32_value")));
+  EXPECT_EQ(32u, reader.read<uint32_t>(serialized_msg, reader.get_field("uint32_value")));
+  EXPECT_EQ(-64, reader.read<int64_t>(serialized_msg, reader.get_field("int64_value")));
+  EXPECT_EQ(64u, reader.read<uint64_t>(serialized_msg, reader.get_field("uint64_value")));
+
+  // All the fields have a fixed size, so they all are read at a fixed offset.
+  EXPECT_TRUE(reader.get_field("uint64_value").has_fixed_offset);
+
+}
+
+TEST(TestSerializedMessageReader, read_nested_field) {
+  test_msgs::msg::Nested msg;
+  msg.basic_types_value.int32_value = 42;
+  const auto serialized_msg = serialize(msg);
+
+  rclcpp::SerializedMessageReader reader(
+    rosidl_typesupport_cpp::get_message_type_support_handle<test_msgs::msg::Nested>());
+  const auto field = reader.get_field("basic_types_value.int32_value");
+  EXPECT_EQ(42, reader.read<int32_t>(serialized_msg, field));
+}
+
+TEST(TestSerializedMessageReader, read_after_sequences) {
+  test_msgs::msg::UnboundedSequences msg;
+  msg.int32_values = {1, 2, 3};
+  msg.string_values = {"a", "bb"};
+  msg.alignment_check = 1234;
+  const auto serialized_msg = serialize(msg);
+
+  rclcpp::SerializedMessageReader reader("test_msgs/msg/UnboundedSequences");
+  const auto int32_values = reader.get_field("int32_values");
+  EXPECT_TRUE(int32_values.is_array);
+  EXPECT_EQ(3u, reader.get_size(serialized_msg, int32_values));
+  EXPECT_EQ(2u, reader.get_size(serialized_msg, reader.get_field("string_values")));
+
+  // The field follows sequences, whose size depends on the message.
+  const auto alignment_check = reader.get_field("alignment_check");
+  EXPECT_FALSE(alignment_check.has_fixed_offset);
+  EXPECT_EQ(1234, reader.read<int32_t>(serialized_msg, alignment_check));
+}
+
+TEST(TestSerializedMessageReader, read_string) {
+  test_msgs::msg::Strings msg;
+  msg.string_value = "lazy";
+  msg.bounded_string_value = "bounded";
+  const auto serialized_msg = serialize(msg);
+
+  rclcpp::SerializedMessageReader reader("test_msgs/msg/Strings");
+  EXPECT_EQ("lazy", reader.read<std::string>(serialized_msg, reader.get_field("string_value")));
+  EXPECT_EQ(
+    "bounded",
+    reader.read<std::string>(serialized_msg, reader.get_field("bounded_string_value")));
+}
+
+TEST(TestSerializedMessageReader, errors) {
+  const auto serialized_msg = serialize(test_msgs::msg::Nested());
+
+  rclcpp::SerializedMessageReader reader("test_msgs/msg/Nested");
+  EXPECT_THROW(reader.get_field("no_such_field"), std::invalid_argument);
+  EXPECT_THROW(reader.get_field("basic_types_value.no_such_field"), std::invalid_argument);
+  EXPECT_THROW(reader.get_field("basic_types_value.int32_value.x"), std::invalid_argument);
+  EXPECT_THROW(reader.get_field(""), std::invalid_argument);
+
+  const auto field = reader.get_field("basic_types_value.int32_value");
+  EXPECT_THROW(reader.read<int64_t>(serialized_msg, field), std::invalid_argument);
+  EXPECT_THROW(
+    reader.read<int32_t>(serialized_msg, reader.get_field("basic_types_value")),
+    std::invalid_argument);
+  EXPECT_THROW(reader.get_size(serialized_msg, field), std::invalid_argument);
+
+  rclcpp::SerializedMessage truncated_msg(serialized_msg);
+  truncated_msg.get_rcl_serialized_message().buffer_length = 6;
+  EXPECT_THROW(reader.read<int32_t>(truncated_msg, field), std::runtime_error);
+
+  EXPECT_THROW(rclcpp::SerializedMessageReader("test_msgs/msg/NoSuchType"), std::runtime_error);
+}
@@ -14,9 +14,12 @@
 
 #include <gtest/gtest.h>
 
+#include <set>
 #include <string>
 #include <memory>
+#include <thread>
 #include <utility>
+#include <vector>
 
 #include "rclcpp/exceptions.hpp"
 #include "rclcpp/rclcpp.hpp"
@@ -24,6 +27,7 @@
 #include "../mocking_utils/patch.hpp"
 
 #include "rcl_interfaces/srv/list_parameters.hpp"
+#include "test_msgs/srv/basic_types.hpp"
 #include "test_msgs/srv/empty.hpp"
 #include "test_msgs/srv/empty.h"
 
@@ -235,3 +239,137 @@ TEST_F(TestService, send_response) {
       rclcpp::exceptions::RCLError);
   }
 }
+
+TEST_F(TestService, deferred_response_from_another_thread) {
+  using test_msgs::srv::Empty;
+  using ServiceT = rclcpp::Service<Empty>;
+  std::vector<std::thread> workers;
+  auto callback =
+    [&workers](
+    std::shared_ptr<ServiceT> service,
+    std::shared_ptr<rmw_request_id_t> request_header,
+    const Empty::Request::SharedPtr)
+    {
+      // Return right away, the response is sent by a worker thread.
+      workers.emplace_back(
+        [service, request_header]() {
+          service->send_response(*request_header, std::make_shared<Empty::Response>());
+        });
+    };
+  auto server = node->create_service<Empty>("deferred_service", callback);
+  auto client = node->create_client<Empty>("deferred_service");
+  ASSERT_TRUE(client->wait_for_service(std::chrono::seconds(1)));
+
+  size_t received_responses = 0;
+  auto request = std::make_shared<Empty::Request>();
+  for (size_t i = 0; i < 3u; ++i) {
+    client->async_send_request(
+      request, [&received_responses](rclcpp::Client<Empty>::SharedFuture future) {
+        EXPECT_NE(nullptr, future.get());
+        ++received_responses;
+      });
+  }
+
+  auto start = std::chrono::steady_clock::now();
+  while (received_responses < 3u &&
+    (std::chrono::steady_clock::now() - start) < std::chrono::seconds(5))
+  {
+    rclcpp::spin_some(node);
+  }
+  for (auto & worker : workers) {
+    worker.join();
+  }
+  EXPECT_EQ(3u, received_responses);
+}
+
+TEST_F(TestService, batch_callback) {
+  using test_msgs::srv::Empty;
+  std::vector<size_t> batch_sizes;
+  auto callback =
+    [&batch_sizes](
+    const std::vector<Empty::Request::SharedPtr> & requests,
+    std::vector<Empty::Response::SharedPtr> & responses)
+    {
+      EXPECT_EQ(requests.size(), responses.size());
+      batch_sizes.push_back(requests.size());
+    };
+  auto server = node->create_service<Empty>("batch_service", callback);
+  EXPECT_EQ(1u, server->get_max_requests_per_execution());
+  EXPECT_THROW(server->set_max_requests_per_execution(0), std::invalid_argument);
+  server->set_max_requests_per_execution(4);
+  EXPECT_EQ(4u, server->get_max_requests_per_execution());
+
+  auto client = node->create_client<Empty>("batch_service");
+  ASSERT_TRUE(client->wait_for_service(std::chrono::seconds(1)));
+  size_t received_responses = 0;
+  auto request = std::make_shared<Empty::Request>();
+  for (size_t i = 0; i < 10u; ++i) {
+    client->async_send_request(
+      request, [&received_responses](rclcpp::Client<Empty>::SharedFuture future) {
+        EXPECT_NE(nullptr, future.get());
+        ++received_responses;
+      });
+  }
+
+  auto start = std::chrono::steady_clock::now();
+  while (received_responses < 10u &&
+    (std::chrono::steady_clock::now() - start) < std::chrono::seconds(5))
+  {
+    rclcpp::spin_some(node);
+  }
+  EXPECT_EQ(10u, received_responses);
+  size_t handled_requests = 0;
+  for (size_t batch_size : batch_sizes) {
+    EXPECT_LE(batch_size, 4u);
+    handled_requests += batch_size;
+  }
+  EXPECT_EQ(10u, handled_requests);
+}
+
+TEST_F(TestService, object_pools) {
+  using test_msgs::srv::BasicTypes;
+  std::set<const void *> requests;
+  std::set<const void *> responses;
+  auto callback =
+    [&requests, &responses](
+    const BasicTypes::Request::SharedPtr request, BasicTypes::Response::SharedPtr response) {
+      // The pooled responses are reset before being reused.
+      EXPECT_EQ(0, response->int32_value);
+      requests.insert(request.get());
+      responses.insert(response.get());
+      response->int32_value = request->int32_value + 1;
+    };
+  auto server = node->create_service<BasicTypes>("pooled_service", callback);
+  EXPECT_FALSE(server->has_object_pools());
+  EXPECT_THROW(server->enable_object_pools(0), std::invalid_argument);
+  server->enable_object_pools(2);
+  EXPECT_TRUE(server->has_object_pools());
+  EXPECT_THROW(server->enable_object_pools(2), std::runtime_error);
+
+  auto client = node->create_client<BasicTypes>("pooled_service");
+  client->enable_object_pools(2);
+  ASSERT_TRUE(client->wait_for_service(std::chrono::seconds(1)));
+  std::set<const void *> client_responses;
+  for (int32_t i = 0; i < 10; ++i) {
+    auto request = client->create_request();
+    EXPECT_EQ(0, request->int32_value);
+    request->int32_value = i;
+    bool received = false;
+    client->async_send_request(
+      request, [&](BasicTypes::Response::SharedPtr response) {
+        EXPECT_EQ(i + 1, response->int32_value);
+        client_responses.insert(response.get());
+        received = true;
+      });
+    request.reset();
+    auto start = std::chrono::steady_clock::now();
+    while (!received && (std::chrono::steady_clock::now() - start) < std::chrono::seconds(5)) {
+      rclcpp::spin_some(node);
+    }
+    ASSERT_TRUE(received);
+  }
+  // The objects dropped after each call are borrowed again for the next ones.
+  EXPECT_LE(requests.size(), 2u);
+  EXPECT_LE(responses.size(), 2u);
+  EXPECT_LE(client_responses.size(), 2u);
+}
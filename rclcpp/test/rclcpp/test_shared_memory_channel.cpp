@@ -0,0 +1,222 @@
+// Copyright 2021 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "rclcpp/experimental/shared_memory_channel.hpp"
+
+using namespace std::chrono_literals;
+
+using rclcpp::experimental::SharedMemoryChannel;
+
+#if !defined(_WIN32)
+
+class TestSharedMemoryChannel : public ::testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    topic_name = "/test_shared_memory_channel/" +
+      std::string(::testing::UnitTest::GetInstance()->current_test_info()->name());
+    std::memset(&gid, 0, sizeof(gid));
+    gid.data[0] = 42;
+  }
+
+  std::string topic_name;
+  size_t domain_id = 0;
+  rmw_gid_t gid;
+};
+
+TEST_F(TestSharedMemoryChannel, construction) {
+  EXPECT_THROW(SharedMemoryChannel(topic_name, domain_id, 0, 4), std::invalid_argument);
+  EXPECT_THROW(SharedMemoryChannel(topic_name, domain_id, 16, 0), std::invalid_argument);
+
+  auto channel = std::make_shared<SharedMemoryChannel>(topic_name, domain_id, 16, 4);
+  EXPECT_EQ(16u, channel->get_slot_size());
+  EXPECT_EQ(4u, channel->get_slot_count());
+  EXPECT_EQ(0u, channel->get_write_sequence());
+
+  // Opening the channel again maps the existing segment, whatever the sizes given.
+  auto other_channel = std::make_shared<SharedMemoryChannel>(topic_name, domain_id, 32, 8);
+  EXPECT_EQ(16u, other_channel->get_slot_size());
+  EXPECT_EQ(4u, other_channel->get_slot_count());
+
+  // Channels of other domains are independent.
+  SharedMemoryChannel channel_of_other_domain(topic_name, domain_id + 1, 32, 8);
+  EXPECT_EQ(32u, channel_of_other_domain.get_slot_size());
+  EXPECT_NE(
+    SharedMemoryChannel::get_segment_name(topic_name, domain_id),
+    SharedMemoryChannel::get_segment_name(topic_name, domain_id + 1));
+}
+
+TEST_F(TestSharedMemoryChannel, write_and_read) {
+  SharedMemoryChannel writer(topic_name, domain_id, 16, 4);
+  SharedMemoryChannel reader(topic_name, domain_id, 16, 4);
+
+  uint64_t sequence = reader.get_write_sequence();
+  std::vector<uint8_t> data;
+  uint8_t writer_gid[RMW_GID_STORAGE_SIZE];
+  uint64_t lost_count = 0;
+  EXPECT_FALSE(reader.read(sequence, data, writer_gid, lost_count));
+
+  const std::vector<uint8_t> message = {1, 2, 3, 4, 5};
+  writer.write(message.data(), message.size(), gid);
+  EXPECT_EQ(1u, reader.get_write_sequence());
+
+  ASSERT_TRUE(reader.read(sequence, data, writer_gid, lost_count));
+  EXPECT_EQ(message, data);
+  EXPECT_EQ(0, std::memcmp(writer_gid, gid.data, RMW_GID_STORAGE_SIZE));
+  EXPECT_EQ(1u, sequence);
+  EXPECT_EQ(0u, lost_count);
+  EXPECT_FALSE(reader.read(sequence, data, writer_gid, lost_count));
+
+  const std::vector<uint8_t> too_large(17, 0);
+  EXPECT_THROW(writer.write(too_large.data(), too_large.size(), gid), std::length_error);
+  EXPECT_EQ(1u, reader.get_write_sequence());
+}
+
+TEST_F(TestSharedMemoryChannel, overwritten_messages_are_lost) {
+  SharedMemoryChannel channel(topic_name, domain_id, 8, 4);
+
+  for (uint8_t i = 0; i < 10; ++i) {
+    channel.write(&i, 1, gid);
+  }
+
+  uint64_t sequence = 0;
+  std::vector<uint8_t> data;
+  uint8_t writer_gid[RMW_GID_STORAGE_SIZE];
+  uint64_t lost_count = 0;
+  std::vector<uint8_t> received;
+  while (channel.read(sequence, data, writer_gid, lost_count)) {
+    ASSERT_EQ(1u, data.size());
+    received.push_back(data[0]);
+  }
+  EXPECT_EQ(std::vector<uint8_t>({6, 7, 8, 9}), received);
+  EXPECT_EQ(6u, lost_count);
+  EXPECT_EQ(10u, sequence);
+}
+
+TEST_F(TestSharedMemoryChannel, writers) {
+  SharedMemoryChannel channel(topic_name, domain_id, 8, 4);
+  SharedMemoryChannel other_channel(topic_name, domain_id, 8, 4);
+
+  EXPECT_FALSE(other_channel.is_writer(gid));
+  channel.add_writer(gid);
+  EXPECT_TRUE(other_channel.is_writer(gid));
+
+  rmw_gid_t other_gid = gid;
+  other_gid.data[1] = 1;
+  EXPECT_FALSE(other_channel.is_writer(other_gid));
+
+  channel.remove_writer(gid);
+  EXPECT_FALSE(other_channel.is_writer(gid));
+}
+
+TEST_F(TestSharedMemoryChannel, readers) {
+  auto channel = std::make_shared<SharedMemoryChannel>(topic_name, domain_id, 8, 4);
+  auto other_channel = std::make_shared<SharedMemoryChannel>(topic_name, domain_id, 8, 4);
+  EXPECT_EQ(0u, channel->get_reader_count());
+
+  other_channel->add_reader();
+  EXPECT_EQ(1u, channel->get_reader_count());
+  // Adding the reader again only keeps it alive.
+  other_channel->add_reader();
+  EXPECT_EQ(1u, channel->get_reader_count());
+
+  channel->add_reader();
+  EXPECT_EQ(2u, other_channel->get_reader_count());
+
+  channel->remove_reader();
+  EXPECT_EQ(1u, other_channel->get_reader_count());
+
+  // Closing the channel removes its reader.
+  other_channel.reset();
+  EXPECT_EQ(0u, channel->get_reader_count());
+}
+
+TEST_F(TestSharedMemoryChannel, wait_for_notification) {
+  SharedMemoryChannel channel(topic_name, domain_id, 8, 4);
+
+  // Times out if nothing is written.
+  uint32_t notification = channel.get_notification();
+  auto start = std::chrono::steady_clock::now();
+  channel.wait_for_notification(notification, 10ms);
+  EXPECT_GE(std::chrono::steady_clock::now() - start, 10ms);
+
+  // Returns at once if a message was written since the notification was read.
+  const uint8_t byte = 0;
+  channel.write(&byte, 1, gid);
+  start = std::chrono::steady_clock::now();
+  channel.wait_for_notification(notification, 10s);
+  EXPECT_LT(std::chrono::steady_clock::now() - start, 5s);
+
+  // Wakes up on the next message.
+  notification = channel.get_notification();
+  std::thread writer_thread([&]() {
+      std::this_thread::sleep_for(10ms);
+      channel.write(&byte, 1, gid);
+    });
+  start = std::chrono::steady_clock::now();
+  channel.wait_for_notification(notification, 10s);
+  EXPECT_LT(std::chrono::steady_clock::now() - start, 5s);
+  EXPECT_NE(notification, channel.get_notification());
+  writer_thread.join();
+}
+
+TEST_F(TestSharedMemoryChannel, concurrent_writers) {
+  constexpr size_t messages_per_writer = 1000;
+  SharedMemoryChannel channel(topic_name, domain_id, sizeof(uint64_t), 4096);
+
+  std::vector<std::thread> writer_threads;
+  for (uint64_t writer = 0; writer < 4; ++writer) {
+    writer_threads.emplace_back(
+      [&, writer]() {
+        for (uint64_t i = 0; i < messages_per_writer; ++i) {
+          const uint64_t value = writer * messages_per_writer + i;
+          channel.write(reinterpret_cast<const uint8_t *>(&value), sizeof(value), gid);
+        }
+      });
+  }
+  for (auto & writer_thread : writer_threads) {
+    writer_thread.join();
+  }
+
+  uint64_t sequence = 0;
+  std::vector<uint8_t> data;
+  uint8_t writer_gid[RMW_GID_STORAGE_SIZE];
+  uint64_t lost_count = 0;
+  std::vector<bool> received(4 * messages_per_writer, false);
+  while (channel.read(sequence, data, writer_gid, lost_count)) {
+    ASSERT_EQ(sizeof(uint64_t), data.size());
+    uint64_t value;
+    std::memcpy(&value, data.data(), sizeof(value));
+    ASSERT_LT(value, received.size());
+    EXPECT_FALSE(received[value]);
+    received[value] = true;
+  }
+  EXPECT_EQ(0u, lost_count);
+  for (bool message_received : received) {
+    EXPECT_TRUE(message_received);
+  }
+}
+
+#endif
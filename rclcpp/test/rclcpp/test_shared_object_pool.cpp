@@ -0,0 +1,50 @@
+// Copyright 2021 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+#include "rclcpp/detail/shared_object_pool.hpp"
+
+using rclcpp::detail::SharedObjectPool;
+
+TEST(TestSharedObjectPool, construction) {
+  EXPECT_THROW(SharedObjectPool<int>(0), std::invalid_argument);
+  SharedObjectPool<int> pool(3);
+  EXPECT_EQ(3u, pool.size());
+}
+
+TEST(TestSharedObjectPool, reuse_dropped_objects) {
+  SharedObjectPool<std::string> pool(2);
+  auto first = pool.borrow();
+  std::string * first_address = first.get();
+  *first = "first";
+  auto second = pool.borrow();
+  EXPECT_NE(first_address, second.get());
+
+  // All the objects of the pool are referenced, a new one is allocated.
+  auto third = pool.borrow();
+  EXPECT_NE(first_address, third.get());
+  EXPECT_NE(second.get(), third.get());
+
+  // A dropped object is borrowed again, with the value given by its previous user.
+  first.reset();
+  third.reset();
+  auto reused = pool.borrow();
+  EXPECT_EQ(first_address, reused.get());
+  EXPECT_EQ("first", *reused);
+}
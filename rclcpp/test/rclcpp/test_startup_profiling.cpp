@@ -0,0 +1,141 @@
+// Copyright 2021 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "rclcpp/rclcpp.hpp"
+#include "rclcpp/startup_profiling.hpp"
+
+#include "test_msgs/msg/empty.hpp"
+#include "test_msgs/srv/empty.hpp"
+
+using namespace std::chrono_literals;
+
+namespace startup_profiling = rclcpp::startup_profiling;
+
+class TestStartupProfiling : public ::testing::Test
+{
+protected:
+  void TearDown() override
+  {
+    startup_profiling::disable();
+    startup_profiling::reset();
+  }
+};
+
+const startup_profiling::PhaseTimes *
+find_phase(const std::vector<startup_profiling::PhaseTimes> & phases, const std::string & phase)
+{
+  for (const auto & times : phases) {
+    if (times.phase == phase) {
+      return &times;
+    }
+  }
+  return nullptr;
+}
+
+TEST_F(TestStartupProfiling, disabled_by_default) {
+  EXPECT_FALSE(startup_profiling::is_enabled());
+  {
+    startup_profiling::ScopedPhase phase("node base", "/test");
+  }
+  EXPECT_TRUE(startup_profiling::get_phase_times().empty());
+  EXPECT_TRUE(startup_profiling::format_report().empty());
+}
+
+TEST_F(TestStartupProfiling, phases) {
+  startup_profiling::enable();
+  EXPECT_TRUE(startup_profiling::is_enabled());
+  {
+    startup_profiling::ScopedPhase phase("publisher", "/fast");
+  }
+  {
+    startup_profiling::ScopedPhase phase("publisher", "/slow");
+    std::this_thread::sleep_for(20ms);
+  }
+  {
+    startup_profiling::ScopedPhase phase("service");
+  }
+
+  auto phases = startup_profiling::get_phase_times();
+  ASSERT_EQ(2u, phases.size());
+  // The longest total first.
+  EXPECT_EQ("publisher", phases[0].phase);
+  EXPECT_EQ(2u, phases[0].count);
+  EXPECT_LE(20ms, phases[0].max);
+  EXPECT_LE(phases[0].max, phases[0].total);
+  EXPECT_EQ("/slow", phases[0].slowest);
+  EXPECT_EQ("service", phases[1].phase);
+  EXPECT_EQ(1u, phases[1].count);
+  EXPECT_TRUE(phases[1].slowest.empty());
+
+  auto report = startup_profiling::format_report();
+  EXPECT_EQ(0u, report.find("publisher: 2 in "));
+  EXPECT_NE(std::string::npos, report.find("(/slow)\nservice: 1 in "));
+
+  startup_profiling::disable();
+  {
+    startup_profiling::ScopedPhase phase("service");
+  }
+  EXPECT_EQ(1u, find_phase(startup_profiling::get_phase_times(), "service")->count);
+
+  startup_profiling::reset();
+  EXPECT_TRUE(startup_profiling::get_phase_times().empty());
+}
+
+TEST_F(TestStartupProfiling, node_startup) {
+  rclcpp::InitOptions init_options;
+  init_options.startup_profiling(true);
+  rclcpp::init(0, nullptr, init_options);
+  EXPECT_TRUE(startup_profiling::is_enabled());
+  {
+    auto node = std::make_shared<rclcpp::Node>("test_startup_profiling", "/ns");
+    auto publisher = node->create_publisher<test_msgs::msg::Empty>("/startup/topic", 10);
+    auto subscription = node->create_subscription<test_msgs::msg::Empty>(
+      "/startup/topic", 10, [](test_msgs::msg::Empty::ConstSharedPtr) {});
+    auto service = node->create_service<test_msgs::srv::Empty>(
+      "/startup/service",
+      [](
+        test_msgs::srv::Empty::Request::SharedPtr,
+        test_msgs::srv::Empty::Response::SharedPtr) {});
+    auto client = node->create_client<test_msgs::srv::Empty>("/startup/client");
+  }
+  rclcpp::shutdown();
+
+  auto phases = startup_profiling::get_phase_times();
+  auto context_init = find_phase(phases, "context init");
+  ASSERT_NE(nullptr, context_init);
+  EXPECT_EQ(1u, context_init->count);
+  auto node_base = find_phase(phases, "node base");
+  ASSERT_NE(nullptr, node_base);
+  EXPECT_EQ("test_startup_profiling", node_base->slowest);
+  auto parameter_overrides = find_phase(phases, "parameter overrides");
+  ASSERT_NE(nullptr, parameter_overrides);
+  EXPECT_EQ("/ns/test_startup_profiling", parameter_overrides->slowest);
+  ASSERT_NE(nullptr, find_phase(phases, "publisher"));
+  auto subscription = find_phase(phases, "subscription");
+  ASSERT_NE(nullptr, subscription);
+  EXPECT_EQ(1u, subscription->count);
+  EXPECT_EQ("/startup/topic", subscription->slowest);
+  ASSERT_NE(nullptr, find_phase(phases, "service"));
+  auto client = find_phase(phases, "client");
+  ASSERT_NE(nullptr, client);
+  EXPECT_EQ("/startup/client", client->slowest);
+}
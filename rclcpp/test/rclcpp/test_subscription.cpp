@@ -14,6 +14,7 @@
 
 #include <gtest/gtest.h>
 
+#include <array>
 #include <chrono>
 #include <functional>
 #include <memory>
@@ -21,12 +22,14 @@
 #include <thread>
 #include <vector>
 
+#include "rclcpp/direct_callback_subscription.hpp"
 #include "rclcpp/exceptions.hpp"
 #include "rclcpp/rclcpp.hpp"
 
 #include "../mocking_utils/patch.hpp"
 #include "../utils/rclcpp_gtest_macros.hpp"
 
+#include "test_msgs/msg/basic_types.hpp"
 #include "test_msgs/msg/empty.hpp"
 
 using namespace std::chrono_literals;
@@ -324,6 +327,77 @@ TEST_F(TestSubscription, take) {
   // TODO(wjwwood): figure out a good way to test the intra-process exclusion behavior.
 }
 
+/*
+   Testing take_batch.
+ */
+TEST_F(TestSubscription, take_batch) {
+  initialize();
+  using test_msgs::msg::Empty;
+  auto do_nothing = [](std::shared_ptr<const test_msgs::msg::Empty>) {FAIL();};
+  std::array<Empty, 4> messages;
+  std::array<rclcpp::MessageInfo, 4> message_infos;
+  {
+    auto sub = node->create_subscription<Empty>("~/test_take_batch", 10, do_nothing);
+    EXPECT_EQ(0u, sub->take_batch(messages.data(), message_infos.data(), messages.size()));
+    EXPECT_EQ(0u, sub->take_batch(messages.data(), message_infos.data(), 0));
+  }
+  // With intra-process enabled, the messages of the other publishers are taken one by one.
+  for (auto use_intra_process : {false, true}) {
+    rclcpp::SubscriptionOptions so;
+    so.use_intra_process_comm = use_intra_process ?
+      rclcpp::IntraProcessSetting::Enable : rclcpp::IntraProcessSetting::Disable;
+    auto sub = node->create_subscription<Empty>("~/test_take_batch", 10, do_nothing, so);
+    rclcpp::PublisherOptions po;
+    po.use_intra_process_comm = rclcpp::IntraProcessSetting::Disable;
+    auto pub = node->create_publisher<Empty>("~/test_take_batch", 10, po);
+    for (size_t i = 0; i < 6; ++i) {
+      pub->publish(Empty());
+    }
+    // At most the size of the array is taken at once.
+    size_t taken = 0;
+    auto start = std::chrono::steady_clock::now();
+    do {
+      const size_t batch_size =
+        sub->take_batch(messages.data(), message_infos.data(), messages.size());
+      EXPECT_LE(batch_size, messages.size());
+      taken += batch_size;
+      std::this_thread::sleep_for(10ms);
+    } while (taken < 6 && std::chrono::steady_clock::now() - start < 10s);
+    EXPECT_EQ(6u, taken);
+  }
+}
+
+TEST_F(TestSubscription, take_batch_sequence_unsupported) {
+  initialize();
+  using test_msgs::msg::Empty;
+  rclcpp::SubscriptionOptions so;
+  so.use_intra_process_comm = rclcpp::IntraProcessSetting::Disable;
+  auto sub = node->create_subscription<Empty>(
+    "~/test_take_batch", 10, [](std::shared_ptr<const Empty>) {}, so);
+  std::array<Empty, 2> messages;
+  std::array<rclcpp::MessageInfo, 2> message_infos;
+  auto mock = mocking_utils::patch_and_return(
+    "lib:rclcpp", rcl_take_sequence, RCL_RET_UNSUPPORTED);
+  // The messages are taken one by one instead.
+  EXPECT_EQ(0u, sub->take_batch(messages.data(), message_infos.data(), messages.size()));
+}
+
+TEST_F(TestSubscription, take_batch_error) {
+  initialize();
+  using test_msgs::msg::Empty;
+  rclcpp::SubscriptionOptions so;
+  so.use_intra_process_comm = rclcpp::IntraProcessSetting::Disable;
+  auto sub = node->create_subscription<Empty>(
+    "~/test_take_batch", 10, [](std::shared_ptr<const Empty>) {}, so);
+  std::array<Empty, 2> messages;
+  std::array<rclcpp::MessageInfo, 2> message_infos;
+  auto mock = mocking_utils::patch_and_return(
+    "lib:rclcpp", rcl_take_sequence, RCL_RET_ERROR);
+  EXPECT_THROW(
+    sub->take_batch(messages.data(), message_infos.data(), messages.size()),
+    rclcpp::exceptions::RCLError);
+}
+
 /*
    Testing take_serialized.
  */
@@ -440,6 +514,561 @@ TEST_F(TestSubscription, handle_loaned_message) {
   EXPECT_NO_THROW(sub->handle_loaned_message(&msg, message_info));
 }
 
+/*
+   Testing that the queued intraprocess messages are delivered in batches of the configured size
+ */
+TEST_F(TestSubscription, intra_process_max_batch_size) {
+  initialize(rclcpp::NodeOptions().use_intra_process_comms(true));
+  using test_msgs::msg::Empty;
+  auto publisher = node->create_publisher<Empty>("topic", 10);
+
+  for (size_t max_batch_size : {1u, 3u, 0u}) {
+    size_t callback_count = 0;
+    rclcpp::SubscriptionOptions options;
+    options.intra_process_max_batch_size = max_batch_size;
+    auto sub = node->create_subscription<Empty>(
+      "topic", 10,
+      [&callback_count](std::unique_ptr<Empty>) {++callback_count;},
+      options);
+    auto waitable = sub->get_intra_process_waitable();
+    ASSERT_NE(nullptr, waitable);
+
+    for (size_t i = 0; i < 5u; ++i) {
+      publisher->publish(std::make_unique<Empty>());
+    }
+    size_t executions = 0;
+    while (waitable->is_ready(nullptr)) {
+      std::shared_ptr<void> data = waitable->take_data();
+      waitable->execute(data);
+      ++executions;
+    }
+    EXPECT_EQ(5u, callback_count);
+    size_t expected_executions =
+      max_batch_size == 0 ? 1u : (5u + max_batch_size - 1) / max_batch_size;
+    EXPECT_EQ(expected_executions, executions) << "max_batch_size " << max_batch_size;
+  }
+}
+
+/*
+   Testing that a burst of intraprocess messages wakes a wait until all are taken
+ */
+TEST_F(TestSubscription, intra_process_coalesced_wakeups) {
+  initialize(rclcpp::NodeOptions().use_intra_process_comms(true));
+  using test_msgs::msg::Empty;
+  auto publisher = node->create_publisher<Empty>("topic", 10);
+  size_t callback_count = 0;
+  auto sub = node->create_subscription<Empty>(
+    "topic", 10, [&callback_count](Empty::ConstSharedPtr) {++callback_count;});
+  auto waitable = sub->get_intra_process_waitable();
+  ASSERT_NE(nullptr, waitable);
+  rclcpp::WaitSet wait_set;
+  wait_set.add_waitable(waitable);
+
+  for (size_t i = 0; i < 3u; ++i) {
+    publisher->publish(Empty());
+  }
+  // The guard condition is triggered once for the burst, and again while messages are left.
+  for (size_t i = 0; i < 3u; ++i) {
+    ASSERT_EQ(rclcpp::WaitResultKind::Ready, wait_set.wait(std::chrono::seconds(1)).kind());
+    std::shared_ptr<void> data = waitable->take_data();
+    waitable->execute(data);
+  }
+  EXPECT_EQ(3u, callback_count);
+  EXPECT_EQ(rclcpp::WaitResultKind::Timeout, wait_set.wait(std::chrono::milliseconds(0)).kind());
+
+  // The next message triggers it again.
+  publisher->publish(Empty());
+  ASSERT_EQ(rclcpp::WaitResultKind::Ready, wait_set.wait(std::chrono::seconds(1)).kind());
+  std::shared_ptr<void> data = waitable->take_data();
+  waitable->execute(data);
+  EXPECT_EQ(4u, callback_count);
+}
+
+/*
+   Testing that the origin of the intraprocess messages is given to the callback if requested
+ */
+TEST_F(TestSubscription, intra_process_message_info) {
+  initialize(rclcpp::NodeOptions().use_intra_process_comms(true));
+  using test_msgs::msg::Empty;
+  auto publisher = node->create_publisher<Empty>("topic", 10);
+
+  std::vector<rclcpp::MessageInfo> message_infos;
+  auto callback = [&message_infos](std::unique_ptr<Empty>, const rclcpp::MessageInfo & info) {
+      message_infos.push_back(info);
+    };
+  rclcpp::SubscriptionOptions options;
+  options.intra_process_max_batch_size = 0;
+  options.intra_process_message_info = true;
+  auto sub = node->create_subscription<Empty>("topic", 2, callback, options);
+  std::vector<rclcpp::MessageInfo> default_message_infos;
+  auto default_sub = node->create_subscription<Empty>(
+    "topic", 10,
+    [&default_message_infos](std::unique_ptr<Empty>, const rclcpp::MessageInfo & info) {
+      default_message_infos.push_back(info);
+    });
+
+  // The first message is dropped by the subscription with a depth of 2, along with its origin.
+  publisher->publish(std::make_unique<Empty>());
+  const auto after_first = std::chrono::duration_cast<std::chrono::nanoseconds>(
+    std::chrono::system_clock::now().time_since_epoch()).count();
+  publisher->publish(std::make_unique<Empty>());
+  publisher->publish(std::make_unique<Empty>());
+  for (const auto & subscription : {sub, default_sub}) {
+    auto waitable = subscription->get_intra_process_waitable();
+    ASSERT_NE(nullptr, waitable);
+    while (waitable->is_ready(nullptr)) {
+      std::shared_ptr<void> data = waitable->take_data();
+      waitable->execute(data);
+    }
+  }
+
+  ASSERT_EQ(2u, message_infos.size());
+  for (const auto & info : message_infos) {
+    const auto & rmw_info = info.get_rmw_message_info();
+    EXPECT_TRUE(rmw_info.from_intra_process);
+    EXPECT_TRUE(*publisher == &rmw_info.publisher_gid);
+    EXPECT_LE(after_first, rmw_info.source_timestamp);
+    EXPECT_LE(rmw_info.source_timestamp, rmw_info.received_timestamp);
+  }
+  EXPECT_LE(
+    message_infos[0].get_rmw_message_info().source_timestamp,
+    message_infos[1].get_rmw_message_info().source_timestamp);
+
+  ASSERT_EQ(3u, default_message_infos.size());
+  for (const auto & info : default_message_infos) {
+    const auto & rmw_info = info.get_rmw_message_info();
+    EXPECT_TRUE(rmw_info.from_intra_process);
+    EXPECT_EQ(0, rmw_info.source_timestamp);
+  }
+}
+
+/*
+   Testing that the messages are taken into the pool of the subscription and shared with callbacks
+ */
+TEST_F(TestSubscription, message_pool) {
+  initialize();
+  using test_msgs::msg::Empty;
+  std::shared_ptr<const Empty> kept_message;
+  rclcpp::SubscriptionOptions options;
+  options.use_intra_process_comm = rclcpp::IntraProcessSetting::Disable;
+  options.message_pool_size = 2;
+  auto sub = node->create_subscription<Empty>(
+    "topic", 10,
+    [&kept_message](std::shared_ptr<const Empty> message) {kept_message = message;},
+    options);
+
+  std::shared_ptr<void> message = sub->create_message();
+  void * pooled_message = message.get();
+  rclcpp::MessageInfo message_info;
+  sub->handle_message(message, message_info);
+  sub->return_message(message);
+  // The callback was given the pooled message, which is not reused while it keeps it.
+  EXPECT_EQ(pooled_message, kept_message.get());
+  std::shared_ptr<void> other_message = sub->create_message();
+  EXPECT_NE(pooled_message, other_message.get());
+  sub->return_message(other_message);
+  kept_message.reset();
+  std::vector<std::shared_ptr<void>> messages{sub->create_message(), sub->create_message()};
+  EXPECT_TRUE(pooled_message == messages[0].get() || pooled_message == messages[1].get());
+
+  // A custom memory strategy takes precedence over the pool.
+  struct CountingStrategy : rclcpp::message_memory_strategy::MessageMemoryStrategy<Empty>
+  {
+    std::shared_ptr<Empty> borrow_message() override
+    {
+      ++borrow_count;
+      return MessageMemoryStrategy<Empty>::borrow_message();
+    }
+
+    size_t borrow_count = 0;
+  };
+  auto strategy = std::make_shared<CountingStrategy>();
+  auto custom_sub = rclcpp::create_subscription<Empty>(
+    node, "topic", 10, [](std::shared_ptr<const Empty>) {}, options, strategy);
+  std::shared_ptr<void> custom_message = custom_sub->create_message();
+  custom_sub->return_message(custom_message);
+  EXPECT_EQ(1u, strategy->borrow_count);
+}
+
+TEST_F(TestSubscription, shared_memory_transport) {
+  initialize();
+  using test_msgs::msg::Empty;
+  rclcpp::PublisherOptions publisher_options;
+  publisher_options.shared_memory_transport.enabled = true;
+  auto publisher = node->create_publisher<Empty>("shared_memory_topic", 10, publisher_options);
+
+  size_t callback_count = 0;
+  rclcpp::SubscriptionOptions options;
+  options.shared_memory_transport.enabled = true;
+  auto sub = node->create_subscription<Empty>(
+    "shared_memory_topic", 10,
+    [&callback_count](Empty::ConstSharedPtr) {++callback_count;},
+    options);
+  auto waitable = sub->get_shared_memory_waitable();
+  if (sub->can_loan_messages()) {
+    // The middleware transport is used instead.
+    EXPECT_EQ(nullptr, waitable);
+    return;
+  }
+  ASSERT_NE(nullptr, waitable);
+  EXPECT_FALSE(waitable->is_ready(nullptr));
+
+  publisher->publish(Empty());
+  ASSERT_TRUE(waitable->is_ready(nullptr));
+  std::shared_ptr<void> data = waitable->take_data();
+  waitable->execute(data);
+  EXPECT_EQ(1u, callback_count);
+  EXPECT_FALSE(waitable->is_ready(nullptr));
+
+  // The copy of the message sent through the middleware, if any, is ignored.
+  rclcpp::spin_some(node);
+  EXPECT_EQ(1u, callback_count);
+}
+
+/*
+   Testing that the messages the content filter rejects are not given to the callback
+ */
+TEST_F(TestSubscription, content_filter) {
+  initialize(rclcpp::NodeOptions().use_intra_process_comms(true));
+  using test_msgs::msg::BasicTypes;
+  std::vector<int32_t> received;
+  auto callback = [&received](BasicTypes::ConstSharedPtr msg) {
+      received.push_back(msg->int32_value);
+    };
+  rclcpp::SubscriptionOptions options;
+  options.content_filter.set_message_filter<BasicTypes>(
+    [](const BasicTypes & msg) {return msg.int32_value > 0;});
+  auto sub = node->create_subscription<BasicTypes>("topic", 10, callback, options);
+  EXPECT_FALSE(sub->is_serialized());
+
+  BasicTypes msg;
+  rclcpp::MessageInfo message_info;
+  for (int32_t value : {-1, 1}) {
+    msg.int32_value = value;
+    std::shared_ptr<void> message = std::make_shared<BasicTypes>(msg);
+    sub->handle_message(message, message_info);
+    sub->handle_loaned_message(&msg, message_info);
+  }
+  EXPECT_EQ((std::vector<int32_t>{1, 1}), received);
+
+  // The messages of the intra-process publishers are filtered too.
+  received.clear();
+  auto publisher = node->create_publisher<BasicTypes>("topic", 10);
+  for (int32_t value : {2, -2, 3}) {
+    msg.int32_value = value;
+    publisher->publish(msg);
+  }
+  auto waitable = sub->get_intra_process_waitable();
+  ASSERT_NE(nullptr, waitable);
+  while (waitable->is_ready(nullptr)) {
+    std::shared_ptr<void> data = waitable->take_data();
+    waitable->execute(data);
+  }
+  EXPECT_EQ((std::vector<int32_t>{2, 3}), received);
+
+  // The messages are taken serialized and only the accepted ones are deserialized.
+  received.clear();
+  size_t serialized_filter_count = 0;
+  rclcpp::SubscriptionOptions serialized_options;
+  serialized_options.use_intra_process_comm = rclcpp::IntraProcessSetting::Disable;
+  serialized_options.content_filter.serialized_message_filter =
+    [&serialized_filter_count](const rclcpp::SerializedMessage &) {
+      return ++serialized_filter_count % 2 == 0;
+    };
+  auto serialized_sub = node->create_subscription<BasicTypes>(
+    "topic", 10, callback, serialized_options);
+  EXPECT_TRUE(serialized_sub->is_serialized());
+  rclcpp::Serialization<BasicTypes> serialization;
+  for (int32_t value : {4, 5}) {
+    msg.int32_value = value;
+    auto serialized_msg = std::make_shared<rclcpp::SerializedMessage>();
+    serialization.serialize_message(&msg, serialized_msg.get());
+    serialized_sub->handle_serialized_message(serialized_msg, message_info);
+  }
+  EXPECT_EQ(2u, serialized_filter_count);
+  EXPECT_EQ((std::vector<int32_t>{5}), received);
+
+  // The message filter has to take the messages of the subscription.
+  rclcpp::SubscriptionOptions invalid_options;
+  invalid_options.content_filter.set_message_filter<test_msgs::msg::Empty>(
+    [](const test_msgs::msg::Empty &) {return true;});
+  EXPECT_THROW(
+    node->create_subscription<BasicTypes>("topic", 10, callback, invalid_options),
+    std::invalid_argument);
+}
+
+/*
+   Testing that only the latest of the queued messages is given to the callback
+ */
+TEST_F(TestSubscription, take_latest_only) {
+  initialize(rclcpp::NodeOptions().use_intra_process_comms(true));
+  using test_msgs::msg::BasicTypes;
+  std::vector<int32_t> received;
+  rclcpp::SubscriptionOptions options;
+  options.take_latest_only = true;
+  auto sub = node->create_subscription<BasicTypes>(
+    "topic", 10,
+    [&received](std::unique_ptr<BasicTypes> msg) {received.push_back(msg->int32_value);},
+    options);
+  EXPECT_TRUE(sub->takes_latest_only());
+  auto publisher = node->create_publisher<BasicTypes>("topic", 10);
+
+  BasicTypes msg;
+  for (int32_t value : {1, 2, 3}) {
+    msg.int32_value = value;
+    publisher->publish(msg);
+  }
+  auto waitable = sub->get_intra_process_waitable();
+  ASSERT_NE(nullptr, waitable);
+  ASSERT_TRUE(waitable->is_ready(nullptr));
+  std::shared_ptr<void> data = waitable->take_data();
+  waitable->execute(data);
+  EXPECT_EQ((std::vector<int32_t>{3}), received);
+  EXPECT_FALSE(waitable->is_ready(nullptr));
+
+  // The messages of the middleware are coalesced too.
+  rclcpp::SubscriptionOptions inter_process_options;
+  inter_process_options.use_intra_process_comm = rclcpp::IntraProcessSetting::Disable;
+  inter_process_options.take_latest_only = true;
+  auto inter_process_sub = node->create_subscription<BasicTypes>(
+    "~/test_take_latest", 10, [](std::unique_ptr<BasicTypes>) {}, inter_process_options);
+  rclcpp::PublisherOptions publisher_options;
+  publisher_options.use_intra_process_comm = rclcpp::IntraProcessSetting::Disable;
+  auto inter_process_publisher = node->create_publisher<BasicTypes>(
+    "~/test_take_latest", 10, publisher_options);
+  for (int32_t value : {1, 2, 3}) {
+    msg.int32_value = value;
+    inter_process_publisher->publish(msg);
+  }
+  std::shared_ptr<void> message = inter_process_sub->create_message();
+  rclcpp::MessageInfo message_info;
+  int32_t latest_value = 0;
+  auto start = std::chrono::steady_clock::now();
+  do {
+    if (inter_process_sub->take_latest_type_erased(message, message_info)) {
+      latest_value = std::static_pointer_cast<BasicTypes>(message)->int32_value;
+    }
+    std::this_thread::sleep_for(10ms);
+  } while (latest_value != 3 && std::chrono::steady_clock::now() - start < 10s);
+  EXPECT_EQ(3, latest_value);
+  EXPECT_FALSE(inter_process_sub->take_latest_type_erased(message, message_info));
+  inter_process_sub->return_message(message);
+}
+
+/*
+   Testing the delivery of intra-process messages in the publishing thread
+ */
+TEST_F(TestSubscription, deliver_intra_process_inline) {
+  initialize(rclcpp::NodeOptions().use_intra_process_comms(true));
+  using test_msgs::msg::BasicTypes;
+  std::vector<int32_t> received;
+  rclcpp::Publisher<BasicTypes>::SharedPtr publisher;
+  rclcpp::SubscriptionOptions options;
+  options.deliver_intra_process_inline = true;
+  auto sub = node->create_subscription<BasicTypes>(
+    "topic", 10,
+    [&received, &publisher](BasicTypes::ConstSharedPtr msg) {
+      received.push_back(msg->int32_value);
+      if (msg->int32_value == 1) {
+        // Delivering it inline again would recurse, it is queued instead.
+        BasicTypes echo;
+        echo.int32_value = 2;
+        publisher->publish(echo);
+      }
+    },
+    options);
+  publisher = node->create_publisher<BasicTypes>("topic", 10);
+  auto waitable = sub->get_intra_process_waitable();
+  ASSERT_NE(nullptr, waitable);
+
+  BasicTypes msg;
+  msg.int32_value = 1;
+  publisher->publish(msg);
+  EXPECT_EQ((std::vector<int32_t>{1}), received);
+
+  ASSERT_TRUE(waitable->is_ready(nullptr));
+  std::shared_ptr<void> data = waitable->take_data();
+  waitable->execute(data);
+  EXPECT_EQ((std::vector<int32_t>{1, 2}), received);
+  EXPECT_FALSE(waitable->is_ready(nullptr));
+
+  msg.int32_value = 3;
+  publisher->publish(std::make_unique<BasicTypes>(msg));
+  EXPECT_EQ((std::vector<int32_t>{1, 2, 3}), received);
+  EXPECT_FALSE(waitable->is_ready(nullptr));
+}
+
+/*
+   Testing the backpressure of the intraprocess buffers of a keep all history
+ */
+TEST_F(TestSubscription, intra_process_keep_all) {
+  initialize(rclcpp::NodeOptions().use_intra_process_comms(true));
+  using test_msgs::msg::BasicTypes;
+  auto publisher = node->create_publisher<BasicTypes>("topic", rclcpp::QoS(rclcpp::KeepAll()));
+
+  for (auto backpressure : {
+      rclcpp::IntraProcessBackpressurePolicy::Fail,
+      rclcpp::IntraProcessBackpressurePolicy::Block,
+      rclcpp::IntraProcessBackpressurePolicy::DropOldest})
+  {
+    std::vector<int32_t> received;
+    rclcpp::SubscriptionOptions options;
+    options.intra_process_max_batch_size = 0;
+    options.intra_process_keep_all.max_messages = 20;
+    options.intra_process_keep_all.backpressure = backpressure;
+    options.intra_process_keep_all.max_blocking_time = 10ms;
+    auto sub = node->create_subscription<BasicTypes>(
+      "topic", rclcpp::QoS(rclcpp::KeepAll()),
+      [&received](std::unique_ptr<BasicTypes> msg) {received.push_back(msg->int32_value);},
+      options);
+    auto waitable = sub->get_intra_process_waitable();
+    ASSERT_NE(nullptr, waitable);
+
+    std::vector<int32_t> expected;
+    BasicTypes msg;
+    for (int32_t i = 0; i < 20; ++i) {
+      msg.int32_value = i;
+      publisher->publish(msg);
+      expected.push_back(i);
+    }
+    msg.int32_value = 20;
+    if (backpressure == rclcpp::IntraProcessBackpressurePolicy::DropOldest) {
+      publisher->publish(msg);
+      expected.erase(expected.begin());
+      expected.push_back(20);
+    } else {
+      EXPECT_THROW(publisher->publish(msg), rclcpp::exceptions::IntraProcessBufferFullError);
+    }
+
+    ASSERT_TRUE(waitable->is_ready(nullptr));
+    std::shared_ptr<void> data = waitable->take_data();
+    waitable->execute(data);
+    EXPECT_EQ(expected, received);
+    EXPECT_FALSE(waitable->is_ready(nullptr));
+  }
+
+  rclcpp::SubscriptionOptions options;
+  options.intra_process_keep_all.max_messages = 0;
+  EXPECT_THROW(
+    node->create_subscription<BasicTypes>(
+      "topic", rclcpp::QoS(rclcpp::KeepAll()), [](BasicTypes::ConstSharedPtr) {}, options),
+    std::invalid_argument);
+}
+
+/*
+   Testing the intraprocess messages dropped instead of the oldest ones when the buffer is full
+ */
+TEST_F(TestSubscription, intra_process_drop_new_when_full) {
+  initialize(rclcpp::NodeOptions().use_intra_process_comms(true));
+  using test_msgs::msg::BasicTypes;
+  std::vector<int32_t> received;
+  rclcpp::SubscriptionOptions options;
+  options.intra_process_max_batch_size = 0;
+  options.collect_intra_process_buffer_statistics = true;
+  options.intra_process_drop_new_when_full = true;
+  auto sub = node->create_subscription<BasicTypes>(
+    "topic", 2,
+    [&received](std::unique_ptr<BasicTypes> msg) {received.push_back(msg->int32_value);},
+    options);
+  auto other_sub = node->create_subscription<BasicTypes>(
+    "topic", 10, [](std::unique_ptr<BasicTypes>) {});
+  auto publisher = node->create_publisher<BasicTypes>("topic", 10);
+  auto waitable = std::dynamic_pointer_cast<rclcpp::experimental::SubscriptionIntraProcessBase>(
+    sub->get_intra_process_waitable());
+  ASSERT_NE(nullptr, waitable);
+  EXPECT_EQ(2u, publisher->get_intra_process_accepting_subscription_count());
+
+  BasicTypes msg;
+  for (int32_t value : {1, 2, 3}) {
+    msg.int32_value = value;
+    publisher->publish(msg);
+  }
+  EXPECT_FALSE(waitable->is_accepting_messages());
+  EXPECT_EQ(1u, publisher->get_intra_process_accepting_subscription_count());
+  EXPECT_EQ(1u, waitable->get_buffer_statistics().dropped_count);
+
+  ASSERT_TRUE(waitable->is_ready(nullptr));
+  std::shared_ptr<void> data = waitable->take_data();
+  waitable->execute(data);
+  EXPECT_EQ((std::vector<int32_t>{1, 2}), received);
+  EXPECT_TRUE(waitable->is_accepting_messages());
+  EXPECT_EQ(2u, publisher->get_intra_process_accepting_subscription_count());
+}
+
+/*
+   Testing that the callback is not called more often than the minimum period
+ */
+TEST_F(TestSubscription, min_callback_period) {
+  initialize();
+  using test_msgs::msg::Empty;
+  size_t callback_count = 0;
+  rclcpp::SubscriptionOptions options;
+  options.min_callback_period = std::chrono::hours(1);
+  auto sub = node->create_subscription<Empty>(
+    "topic", 10, [&callback_count](Empty::ConstSharedPtr) {++callback_count;}, options);
+
+  rclcpp::MessageInfo message_info;
+  for (size_t i = 0; i < 3; ++i) {
+    std::shared_ptr<void> message = std::make_shared<Empty>();
+    sub->handle_message(message, message_info);
+  }
+  EXPECT_EQ(1u, callback_count);
+}
+
+TEST_F(TestSubscription, direct_callback) {
+  initialize();
+  using test_msgs::msg::BasicTypes;
+  int32_t sum = 0;
+  auto callback = [&sum](const BasicTypes & msg, const rclcpp::MessageInfo &) {
+      sum += msg.int32_value;
+    };
+  auto sub = node->create_subscription<BasicTypes>("topic", 10, callback);
+  using DirectSubscription =
+    rclcpp::DirectCallbackSubscription<BasicTypes, decltype(callback)>;
+  ASSERT_NE(nullptr, std::dynamic_pointer_cast<DirectSubscription>(sub));
+
+  rclcpp::MessageInfo message_info;
+  for (int32_t i = 1; i <= 3; ++i) {
+    auto typed_message = std::make_shared<BasicTypes>();
+    typed_message->int32_value = i;
+    std::shared_ptr<void> message = typed_message;
+    sub->handle_message(message, message_info);
+  }
+  EXPECT_EQ(6, sum);
+}
+
+TEST_F(TestSubscription, reusable_message) {
+  initialize();
+  using test_msgs::msg::BasicTypes;
+  int32_t sum = 0;
+  auto sub = node->create_subscription<BasicTypes>(
+    "topic", 10, [&sum](const BasicTypes & msg) {sum += msg.int32_value;});
+
+  void * message = sub->borrow_reusable_message();
+  ASSERT_NE(nullptr, message);
+  // Another thread executing the subscription meanwhile allocates its message.
+  EXPECT_EQ(nullptr, sub->borrow_reusable_message());
+  rclcpp::MessageInfo message_info;
+  for (int32_t i = 1; i <= 3; ++i) {
+    static_cast<BasicTypes *>(message)->int32_value = i;
+    sub->handle_reusable_message(message, message_info);
+  }
+  EXPECT_EQ(6, sum);
+  sub->return_reusable_message();
+  EXPECT_EQ(message, sub->borrow_reusable_message());
+  sub->return_reusable_message();
+
+  // Callbacks which may keep the message get a new one every time.
+  auto shared_sub = node->create_subscription<BasicTypes>(
+    "topic", 10, [](BasicTypes::ConstSharedPtr) {});
+  EXPECT_EQ(nullptr, shared_sub->borrow_reusable_message());
+  rclcpp::SubscriptionOptions options;
+  options.take_latest_only = true;
+  auto latest_sub = node->create_subscription<BasicTypes>(
+    "topic", 10, [](const BasicTypes &) {}, options);
+  EXPECT_EQ(nullptr, latest_sub->borrow_reusable_message());
+}
+
 /*
    Testing subscription with intraprocess enabled and invalid QoS
  */
@@ -489,15 +1118,11 @@ static std::vector<TestParameters> invalid_qos_profiles()
 {
   std::vector<TestParameters> parameters;
 
-  parameters.reserve(3);
+  parameters.reserve(2);
   parameters.push_back(
     TestParameters(
       rclcpp::QoS(rclcpp::KeepLast(10)).transient_local(),
       "transient_local_qos"));
-  parameters.push_back(
-    TestParameters(
-      rclcpp::QoS(rclcpp::KeepAll()),
-      "keep_all_qos"));
 
   return parameters;
 }
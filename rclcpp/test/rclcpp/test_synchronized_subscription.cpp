@@ -0,0 +1,226 @@
+// Copyright 2021 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "rclcpp/rclcpp.hpp"
+#include "test_msgs/msg/basic_types.hpp"
+#include "test_msgs/msg/builtins.hpp"
+
+using namespace std::chrono_literals;
+
+namespace rclcpp
+{
+// The test messages have no header, stamp them with one of their fields.
+template<>
+struct MessageStampTraits<test_msgs::msg::BasicTypes>
+{
+  static int64_t
+  nanoseconds(const test_msgs::msg::BasicTypes & message)
+  {
+    return message.int64_value;
+  }
+};
+
+template<>
+struct MessageStampTraits<test_msgs::msg::Builtins>
+{
+  static int64_t
+  nanoseconds(const test_msgs::msg::Builtins & message)
+  {
+    return static_cast<int64_t>(message.time_value.sec) * 1000000000LL +
+           static_cast<int64_t>(message.time_value.nanosec);
+  }
+};
+}  // namespace rclcpp
+
+using SynchronizedSubscriptionT =
+  rclcpp::SynchronizedSubscription<test_msgs::msg::BasicTypes, test_msgs::msg::Builtins>;
+
+class TestSynchronizedSubscription : public ::testing::Test
+{
+protected:
+  void SetUp()
+  {
+    rclcpp::init(0, nullptr);
+    node_ = std::make_shared<rclcpp::Node>(
+      "test_synchronized_subscription", "/ns",
+      rclcpp::NodeOptions().use_intra_process_comms(true));
+    basic_publisher_ = node_->create_publisher<test_msgs::msg::BasicTypes>("basic", 10);
+    builtins_publisher_ = node_->create_publisher<test_msgs::msg::Builtins>("builtins", 10);
+    executor_.add_node(node_);
+  }
+
+  void TearDown()
+  {
+    executor_.remove_node(node_);
+    basic_publisher_.reset();
+    builtins_publisher_.reset();
+    node_.reset();
+    rclcpp::shutdown();
+  }
+
+  SynchronizedSubscriptionT::SharedPtr
+  create_synchronized_subscription(const rclcpp::SynchronizedSubscriptionOptions & options)
+  {
+    return rclcpp::create_synchronized_subscription<
+      test_msgs::msg::BasicTypes, test_msgs::msg::Builtins>(
+      node_, {"basic", "builtins"}, rclcpp::QoS(10),
+      [this](
+        const std::shared_ptr<const test_msgs::msg::BasicTypes> & basic,
+        const std::shared_ptr<const test_msgs::msg::Builtins> & builtins)
+      {
+        received_.emplace_back(basic, builtins);
+      },
+      options);
+  }
+
+  /// Publish a message stamped with the given time on the first topic, return its address.
+  const void *
+  publish_basic(int64_t stamp)
+  {
+    auto message = std::make_unique<test_msgs::msg::BasicTypes>();
+    message->int64_value = stamp;
+    const void * address = message.get();
+    basic_publisher_->publish(std::move(message));
+    return address;
+  }
+
+  /// Publish a message stamped with the given time on the second topic, return its address.
+  const void *
+  publish_builtins(int64_t stamp)
+  {
+    auto message = std::make_unique<test_msgs::msg::Builtins>();
+    message->time_value.sec = static_cast<int32_t>(stamp / 1000000000LL);
+    message->time_value.nanosec = static_cast<uint32_t>(stamp % 1000000000LL);
+    const void * address = message.get();
+    builtins_publisher_->publish(std::move(message));
+    return address;
+  }
+
+  /// Spin until the number of sets are received, or the timeout elapses.
+  bool
+  spin_until_received(size_t number_of_sets, std::chrono::nanoseconds timeout = 5s)
+  {
+    auto end = std::chrono::steady_clock::now() + timeout;
+    while (received_.size() < number_of_sets && std::chrono::steady_clock::now() < end) {
+      executor_.spin_some(100ms);
+    }
+    return received_.size() >= number_of_sets;
+  }
+
+  rclcpp::Node::SharedPtr node_;
+  rclcpp::Publisher<test_msgs::msg::BasicTypes>::SharedPtr basic_publisher_;
+  rclcpp::Publisher<test_msgs::msg::Builtins>::SharedPtr builtins_publisher_;
+  rclcpp::executors::SingleThreadedExecutor executor_;
+  std::vector<std::pair<
+      std::shared_ptr<const test_msgs::msg::BasicTypes>,
+      std::shared_ptr<const test_msgs::msg::Builtins>>> received_;
+};
+
+TEST_F(TestSynchronizedSubscription, construction_errors) {
+  auto callback = [](
+    const std::shared_ptr<const test_msgs::msg::BasicTypes> &,
+    const std::shared_ptr<const test_msgs::msg::Builtins> &) {};
+  rclcpp::SynchronizedSubscriptionOptions options;
+  EXPECT_THROW(
+    SynchronizedSubscriptionT(node_->get_node_base_interface()->get_context(), nullptr, options),
+    std::invalid_argument);
+
+  options.queue_size = 0;
+  EXPECT_THROW(create_synchronized_subscription(options), std::invalid_argument);
+
+  options.queue_size = 10;
+  options.policy = rclcpp::SynchronizationPolicy::ApproximateTime;
+  options.max_interval = -1ns;
+  EXPECT_THROW(
+    SynchronizedSubscriptionT(node_->get_node_base_interface()->get_context(), callback, options),
+    std::invalid_argument);
+}
+
+TEST_F(TestSynchronizedSubscription, exact_time_without_copies) {
+  auto subscription = create_synchronized_subscription(rclcpp::SynchronizedSubscriptionOptions());
+  ASSERT_EQ(1u, basic_publisher_->get_intra_process_subscription_count());
+  ASSERT_EQ(1u, builtins_publisher_->get_intra_process_subscription_count());
+
+  publish_basic(1);
+  const void * basic_2 = publish_basic(2);
+  const void * basic_3 = publish_basic(3);
+  const void * builtins_2 = publish_builtins(2);
+  const void * builtins_3 = publish_builtins(3);
+
+  ASSERT_TRUE(spin_until_received(2u));
+  ASSERT_EQ(2u, received_.size());
+  EXPECT_EQ(2, received_[0].first->int64_value);
+  EXPECT_EQ(2u, received_[0].second->time_value.nanosec);
+  EXPECT_EQ(3, received_[1].first->int64_value);
+  EXPECT_EQ(3u, received_[1].second->time_value.nanosec);
+  // The callback gets the published messages themselves.
+  EXPECT_EQ(basic_2, received_[0].first.get());
+  EXPECT_EQ(builtins_2, received_[0].second.get());
+  EXPECT_EQ(basic_3, received_[1].first.get());
+  EXPECT_EQ(builtins_3, received_[1].second.get());
+  // The message stamped 1 found no match.
+  EXPECT_EQ(1u, subscription->get_dropped_message_count());
+}
+
+TEST_F(TestSynchronizedSubscription, approximate_time) {
+  rclcpp::SynchronizedSubscriptionOptions options;
+  options.policy = rclcpp::SynchronizationPolicy::ApproximateTime;
+  options.max_interval = 3ms;
+  auto subscription = create_synchronized_subscription(options);
+
+  publish_basic(10000000);
+  publish_builtins(12000000);
+  publish_basic(20000000);
+  publish_builtins(26000000);
+  publish_basic(30000000);
+  publish_builtins(31000000);
+
+  ASSERT_TRUE(spin_until_received(2u));
+  executor_.spin_some(100ms);
+  ASSERT_EQ(2u, received_.size());
+  EXPECT_EQ(10000000, received_[0].first->int64_value);
+  EXPECT_EQ(12000000u, received_[0].second->time_value.nanosec);
+  EXPECT_EQ(30000000, received_[1].first->int64_value);
+  EXPECT_EQ(31000000u, received_[1].second->time_value.nanosec);
+  // The messages stamped 20ms and 26ms are too far apart to match.
+  EXPECT_EQ(2u, subscription->get_dropped_message_count());
+}
+
+TEST_F(TestSynchronizedSubscription, matched_sets_are_bounded) {
+  rclcpp::SynchronizedSubscriptionOptions options;
+  options.queue_size = 2;
+  auto subscription = create_synchronized_subscription(options);
+
+  for (int64_t stamp = 1; stamp <= 3; ++stamp) {
+    publish_basic(stamp);
+    publish_builtins(stamp);
+  }
+  ASSERT_TRUE(spin_until_received(2u));
+  executor_.spin_some(100ms);
+  // The oldest set was dropped as the executor did not take it in time.
+  ASSERT_EQ(2u, received_.size());
+  EXPECT_EQ(2, received_[0].first->int64_value);
+  EXPECT_EQ(3, received_[1].first->int64_value);
+  EXPECT_EQ(2u, subscription->get_dropped_message_count());
+}
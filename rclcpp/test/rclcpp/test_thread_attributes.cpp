@@ -0,0 +1,69 @@
+// Copyright 2021 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "rclcpp/thread_attributes.hpp"
+
+TEST(TestThreadAttributes, default_attributes) {
+  rclcpp::ThreadAttributes attributes;
+  EXPECT_TRUE(attributes.is_default());
+  EXPECT_NO_THROW(rclcpp::apply_thread_attributes(attributes));
+
+  attributes.priority = 10;
+  EXPECT_TRUE(attributes.is_default());
+  attributes.scheduling_policy = rclcpp::ThreadSchedulingPolicy::Other;
+  EXPECT_FALSE(attributes.is_default());
+}
+
+#ifdef __linux__
+TEST(TestThreadAttributes, scoped_cpu_affinity) {
+  const auto initial_attributes = rclcpp::get_thread_attributes();
+  ASSERT_FALSE(initial_attributes.cpu_affinity.empty());
+
+  rclcpp::ThreadAttributes attributes;
+  attributes.cpu_affinity = {initial_attributes.cpu_affinity.back()};
+  {
+    rclcpp::ScopedThreadAttributes scoped_attributes(attributes);
+    EXPECT_EQ(attributes.cpu_affinity, rclcpp::get_thread_attributes().cpu_affinity);
+  }
+  EXPECT_EQ(initial_attributes.cpu_affinity, rclcpp::get_thread_attributes().cpu_affinity);
+}
+
+TEST(TestThreadAttributes, invalid_cpu) {
+  rclcpp::ThreadAttributes attributes;
+  attributes.cpu_affinity = {static_cast<size_t>(CPU_SETSIZE)};
+  EXPECT_THROW(rclcpp::apply_thread_attributes(attributes), std::invalid_argument);
+  EXPECT_THROW(rclcpp::ScopedThreadAttributes{attributes}, std::invalid_argument);
+}
+#endif
+
+#ifndef _WIN32
+TEST(TestThreadAttributes, time_sharing_policy) {
+  // Switching to SCHED_OTHER never requires privileges.
+  std::thread thread([]() {
+      rclcpp::ThreadAttributes attributes;
+      attributes.scheduling_policy = rclcpp::ThreadSchedulingPolicy::Other;
+      rclcpp::apply_thread_attributes(attributes);
+      const auto current_attributes = rclcpp::get_thread_attributes();
+      EXPECT_EQ(rclcpp::ThreadSchedulingPolicy::Other, current_attributes.scheduling_policy);
+      EXPECT_EQ(0, current_attributes.priority);
+    });
+  thread.join();
+}
+#endif
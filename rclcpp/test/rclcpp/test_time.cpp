@@ -17,7 +17,10 @@
 #include <algorithm>
 #include <chrono>
 #include <limits>
+#include <mutex>
 #include <string>
+#include <thread>
+#include <vector>
 
 #include "rcl/error_handling.h"
 #include "rcl/time.h"
@@ -91,6 +94,20 @@ TEST_F(TestTime, time_sources) {
   EXPECT_NE(0u, steady_now.nanosec);
 }
 
+TEST_F(TestTime, now_matches_rcl) {
+  for (auto clock_type : {RCL_STEADY_TIME, RCL_SYSTEM_TIME, RCL_ROS_TIME}) {
+    rclcpp::Clock clock(clock_type);
+    rcl_time_point_value_t before = 0;
+    rcl_time_point_value_t after = 0;
+    ASSERT_EQ(RCL_RET_OK, rcl_clock_get_now(clock.get_clock_handle(), &before));
+    const rclcpp::Time now = clock.now();
+    ASSERT_EQ(RCL_RET_OK, rcl_clock_get_now(clock.get_clock_handle(), &after));
+    EXPECT_EQ(clock_type, now.get_clock_type());
+    EXPECT_LE(before, now.nanoseconds());
+    EXPECT_GE(after, now.nanoseconds());
+  }
+}
+
 static const int64_t HALF_SEC_IN_NS = 500 * 1000 * 1000;
 static const int64_t ONE_SEC_IN_NS = 1000 * 1000 * 1000;
 static const int64_t ONE_AND_HALF_SEC_IN_NS = 3 * HALF_SEC_IN_NS;
@@ -447,3 +464,104 @@ TEST_F(TestTime, test_overflow_underflow_throws) {
     test_time = rclcpp::Duration::from_nanoseconds(INT64_MIN) + rclcpp::Time(-1),
     std::underflow_error("addition leads to int64_t underflow"));
 }
+
+TEST_F(TestTime, sleep_until_invalid) {
+  rclcpp::Clock system_clock(RCL_SYSTEM_TIME);
+  // The clock type of until does not match.
+  EXPECT_THROW(
+    system_clock.sleep_until(rclcpp::Time(0, 0, RCL_STEADY_TIME)),
+    std::runtime_error);
+  // The context is not initialized.
+  auto context = std::make_shared<rclcpp::Context>();
+  EXPECT_THROW(
+    system_clock.sleep_until(system_clock.now(), context),
+    std::runtime_error);
+}
+
+TEST_F(TestTime, sleep_until_steady_and_system) {
+  for (auto clock_type : {RCL_STEADY_TIME, RCL_SYSTEM_TIME}) {
+    rclcpp::Clock clock(clock_type);
+    // In the past.
+    EXPECT_TRUE(clock.sleep_until(clock.now() - rclcpp::Duration(1s)));
+    const auto until = clock.now() + rclcpp::Duration(100ms);
+    EXPECT_TRUE(clock.sleep_until(until));
+    EXPECT_GE(clock.now(), until);
+    const auto start = clock.now();
+    EXPECT_TRUE(clock.sleep_for(rclcpp::Duration(50ms)));
+    EXPECT_GE(clock.now() - start, rclcpp::Duration(50ms));
+  }
+}
+
+TEST_F(TestTime, sleep_until_ros_time) {
+  rclcpp::Clock ros_clock(RCL_ROS_TIME);
+  ASSERT_EQ(RCL_RET_OK, rcl_enable_ros_time_override(ros_clock.get_clock_handle()));
+  ASSERT_EQ(RCL_RET_OK, rcl_set_ros_time_override(ros_clock.get_clock_handle(), 0));
+
+  // Only updates of the ROS time wake the sleep up.
+  std::thread advance_thread(
+    [&ros_clock]() {
+      for (int64_t i = 1; i <= 10; ++i) {
+        std::this_thread::sleep_for(10ms);
+        std::lock_guard<std::mutex> lock(ros_clock.get_clock_mutex());
+        rcl_set_ros_time_override(ros_clock.get_clock_handle(), RCUTILS_S_TO_NS(i));
+      }
+    });
+  EXPECT_TRUE(ros_clock.sleep_until(rclcpp::Time(5, 0, RCL_ROS_TIME)));
+  EXPECT_GE(ros_clock.now(), rclcpp::Time(5, 0, RCL_ROS_TIME));
+  advance_thread.join();
+
+  // Deactivating ROS time ends the sleep.
+  std::thread deactivate_thread(
+    [&ros_clock]() {
+      std::this_thread::sleep_for(50ms);
+      std::lock_guard<std::mutex> lock(ros_clock.get_clock_mutex());
+      rcl_disable_ros_time_override(ros_clock.get_clock_handle());
+    });
+  EXPECT_FALSE(ros_clock.sleep_until(rclcpp::Time(100, 0, RCL_ROS_TIME)));
+  deactivate_thread.join();
+}
+
+TEST_F(TestTime, sleep_until_shutdown) {
+  auto context = std::make_shared<rclcpp::Context>();
+  context->init(0, nullptr);
+  rclcpp::Clock ros_clock(RCL_ROS_TIME);
+  ASSERT_EQ(RCL_RET_OK, rcl_enable_ros_time_override(ros_clock.get_clock_handle()));
+
+  std::thread shutdown_thread(
+    [&context]() {
+      std::this_thread::sleep_for(50ms);
+      context->shutdown("test finished");
+    });
+  // The ROS time never advances, so only the shutdown ends the sleep.
+  EXPECT_FALSE(ros_clock.sleep_for(rclcpp::Duration(1s), context));
+  shutdown_thread.join();
+
+  rclcpp::Clock system_clock(RCL_SYSTEM_TIME);
+  EXPECT_THROW(
+    system_clock.sleep_for(rclcpp::Duration(1s), context),
+    std::runtime_error);
+}
+
+TEST_F(TestTime, bulk_conversions) {
+  const std::vector<rcl_time_point_value_t> nanoseconds = {
+    0, 1, RCL_S_TO_NS(1), RCL_S_TO_NS(1) + 500, RCL_S_TO_NS(1) - 1, -1, -RCL_S_TO_NS(2) - 3,
+  };
+  std::vector<builtin_interfaces::msg::Time> stamps(nanoseconds.size());
+  rclcpp::nanoseconds_to_stamps(nanoseconds.data(), nanoseconds.size(), stamps.data());
+  for (size_t i = 0; i < nanoseconds.size(); ++i) {
+    const builtin_interfaces::msg::Time expected = rclcpp::Time(nanoseconds[i]);
+    EXPECT_EQ(expected.sec, stamps[i].sec) << i;
+    EXPECT_EQ(expected.nanosec, stamps[i].nanosec) << i;
+  }
+
+  // Only the positive times can be converted back.
+  const size_t positive_count = 5u;
+  std::vector<rcl_time_point_value_t> converted(positive_count);
+  rclcpp::stamps_to_nanoseconds(stamps.data(), positive_count, converted.data());
+  for (size_t i = 0; i < positive_count; ++i) {
+    EXPECT_EQ(nanoseconds[i], converted[i]) << i;
+  }
+  RCLCPP_EXPECT_THROW_EQ(
+    rclcpp::stamps_to_nanoseconds(stamps.data(), stamps.size(), converted.data()),
+    std::runtime_error("cannot store a negative time point in rclcpp::Time"));
+}
@@ -19,6 +19,7 @@
 #include <limits>
 #include <memory>
 #include <string>
+#include <thread>
 
 #include "rcl/error_handling.h"
 #include "rcl/time.h"
@@ -742,3 +743,50 @@ TEST_F(TestTimeSource, check_sim_time_updated_in_callback_if_use_clock_thread) {
   // Node should have get out of timer callback
   ASSERT_FALSE(clock_thread_testing_node.GetIsCallbackFrozen());
 }
+
+TEST_F(TestTimeSource, shared_clock_subscription) {
+  // Nodes using the shared clock subscription get their time from a single
+  // "/clock" subscription of the context, without being spun.
+  auto options = rclcpp::NodeOptions()
+    .use_shared_clock_subscription(true)
+    .parameter_overrides({rclcpp::Parameter("use_sim_time", true)});
+  auto first_node = std::make_shared<rclcpp::Node>("first_shared_clock_node", options);
+  auto second_node = std::make_shared<rclcpp::Node>("second_shared_clock_node", options);
+  auto first_clock = first_node->get_clock();
+  auto second_clock = second_node->get_clock();
+  EXPECT_TRUE(first_clock->ros_time_is_active());
+  EXPECT_TRUE(second_clock->ros_time_is_active());
+
+  auto clock_pub = node->create_publisher<rosgraph_msgs::msg::Clock>("/clock", 10);
+  auto start = std::chrono::steady_clock::now();
+  while (clock_pub->get_subscription_count() == 0u &&
+    std::chrono::steady_clock::now() < start + 5s)
+  {
+    std::this_thread::sleep_for(10ms);
+  }
+  EXPECT_EQ(1u, clock_pub->get_subscription_count());
+
+  rosgraph_msgs::msg::Clock msg;
+  msg.clock.sec = 42;
+  const rclcpp::Time expected(42, 0, RCL_ROS_TIME);
+  start = std::chrono::steady_clock::now();
+  while ((first_clock->now() != expected || second_clock->now() != expected) &&
+    std::chrono::steady_clock::now() < start + 5s)
+  {
+    clock_pub->publish(msg);
+    std::this_thread::sleep_for(10ms);
+  }
+  EXPECT_EQ(expected, first_clock->now());
+  EXPECT_EQ(expected, second_clock->now());
+
+  // The shared subscription is destroyed with the last node using it.
+  first_node.reset();
+  second_node.reset();
+  start = std::chrono::steady_clock::now();
+  while (clock_pub->get_subscription_count() != 0u &&
+    std::chrono::steady_clock::now() < start + 5s)
+  {
+    std::this_thread::sleep_for(10ms);
+  }
+  EXPECT_EQ(0u, clock_pub->get_subscription_count());
+}
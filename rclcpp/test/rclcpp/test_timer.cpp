@@ -18,6 +18,8 @@
 #include <chrono>
 #include <exception>
 #include <memory>
+#include <mutex>
+#include <thread>
 #include <utility>
 
 #include "rcl/timer.h"
@@ -232,6 +234,78 @@ TEST_F(TestTimer, callback_with_period_zero) {
   EXPECT_TRUE(timer_ptr->is_ready());
 }
 
+TEST_F(TestTimer, ros_time_update_wakes_executor) {
+  // The timer of the fixture would cancel the executor.
+  timer->cancel();
+  auto ros_clock = std::make_shared<rclcpp::Clock>(RCL_ROS_TIME);
+  ASSERT_EQ(RCL_RET_OK, rcl_enable_ros_time_override(ros_clock->get_clock_handle()));
+  ASSERT_EQ(RCL_RET_OK, rcl_set_ros_time_override(ros_clock->get_clock_handle(), 0));
+  std::atomic<bool> has_ros_timer_run{false};
+  // The wait set would wait 10s of wall time for it, were it not woken up by the clock update.
+  auto ros_timer = rclcpp::create_timer(
+    test_node, ros_clock, rclcpp::Duration(10s),
+    [&has_ros_timer_run]() {
+      has_ros_timer_run.store(true);
+    });
+  std::thread spin_thread([this]() {executor->spin();});
+  std::this_thread::sleep_for(50ms);
+
+  {
+    std::lock_guard<std::mutex> lock(ros_clock->get_clock_mutex());
+    EXPECT_EQ(
+      RCL_RET_OK, rcl_set_ros_time_override(ros_clock->get_clock_handle(), RCUTILS_S_TO_NS(10)));
+  }
+  auto start = std::chrono::steady_clock::now();
+  while (!has_ros_timer_run.load() && std::chrono::steady_clock::now() - start < 2s) {
+    std::this_thread::sleep_for(1ms);
+  }
+  executor->cancel();
+  spin_thread.join();
+  EXPECT_TRUE(has_ros_timer_run.load());
+}
+
+TEST_F(TestTimer, is_ready_with_clock_snapshot)
+{
+  rclcpp::TimerClockSnapshot snapshot;
+  const int64_t now = snapshot.now(RCL_STEADY_TIME);
+  std::this_thread::sleep_for(1ms);
+  EXPECT_EQ(now, snapshot.now(RCL_STEADY_TIME));
+  EXPECT_THROW(snapshot.now(RCL_ROS_TIME), std::invalid_argument);
+
+  // The first check asks rcl and keeps the next call time.
+  EXPECT_FALSE(timer->is_ready(snapshot));
+  {
+    // Before the next call time, rcl is not asked again.
+    auto mock = mocking_utils::patch_and_return(
+      "lib:rclcpp", rcl_timer_get_time_until_next_call, RCL_RET_ERROR);
+    rclcpp::TimerClockSnapshot later_snapshot;
+    EXPECT_FALSE(timer->is_ready(later_snapshot));
+  }
+
+  std::this_thread::sleep_for(110ms);
+  snapshot = rclcpp::TimerClockSnapshot();
+  EXPECT_TRUE(timer->is_ready(snapshot));
+  EXPECT_TRUE(timer->call());
+  {
+    // The call moved the next call time a period later.
+    auto mock = mocking_utils::patch_and_return(
+      "lib:rclcpp", rcl_timer_get_time_until_next_call, RCL_RET_ERROR);
+    EXPECT_FALSE(timer->is_ready(snapshot));
+
+    timer->cancel();
+    std::this_thread::sleep_for(110ms);
+    snapshot = rclcpp::TimerClockSnapshot();
+    EXPECT_FALSE(timer->is_ready(snapshot));
+
+    // A reset drops the next call time, it is asked to rcl again.
+    timer->reset();
+    RCLCPP_EXPECT_THROW_EQ(
+      timer->is_ready(snapshot), std::runtime_error("Failed to check timer: error not set"));
+  }
+  EXPECT_FALSE(timer->is_ready(snapshot));
+  EXPECT_FALSE(has_timer_run.load());
+}
+
 /// Test internal failures using mocks
 TEST_F(TestTimer, test_failures_with_exceptions)
 {
@@ -0,0 +1,90 @@
+// Copyright 2021 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "rclcpp/rclcpp.hpp"
+#include "rclcpp/timer_statistics.hpp"
+
+using namespace std::chrono_literals;
+
+TEST(TestTimerStatistics, missed_periods) {
+  rclcpp::TimerStatistics statistics;
+  statistics.record_call(1ms, 0u);
+  statistics.record_call(35ms, 3u);
+  statistics.record_call(12ms, 1u);
+  statistics.record_callback_duration(2ms);
+  EXPECT_EQ(3u, statistics.get_wakeup_latency().count);
+  EXPECT_EQ(1u, statistics.get_callback_duration().count);
+  EXPECT_EQ(4u, statistics.get_missed_periods());
+  EXPECT_EQ(3u, statistics.get_max_missed_periods());
+
+  statistics.reset();
+  EXPECT_EQ(0u, statistics.get_wakeup_latency().count);
+  EXPECT_EQ(0u, statistics.get_missed_periods());
+  EXPECT_EQ(0u, statistics.get_max_missed_periods());
+}
+
+class TestTimerStatisticsWithNode : public ::testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    rclcpp::init(0, nullptr);
+  }
+
+  void TearDown() override
+  {
+    rclcpp::shutdown();
+  }
+};
+
+TEST_F(TestTimerStatisticsWithNode, timer_records_statistics) {
+  auto node = std::make_shared<rclcpp::Node>("test_timer_statistics_node");
+  rclcpp::executors::SingleThreadedExecutor executor;
+  size_t count = 0;
+  auto timer = node->create_wall_timer(
+    1ms, [&count]() {
+      count++;
+      std::this_thread::sleep_for(1ms);
+    });
+  EXPECT_EQ(nullptr, timer->get_statistics());
+  auto statistics = timer->enable_statistics();
+  ASSERT_NE(nullptr, statistics);
+  EXPECT_EQ(statistics, timer->enable_statistics());
+  EXPECT_EQ(statistics, timer->get_statistics());
+
+  // Call the timer late on purpose so that it misses periods.
+  std::this_thread::sleep_for(10ms);
+  executor.add_node(node);
+  auto start = std::chrono::steady_clock::now();
+  while (count < 3u && (std::chrono::steady_clock::now() - start) < 10s) {
+    executor.spin_once(10ms);
+  }
+  ASSERT_LE(3u, count);
+
+  const auto wakeup_latency = statistics->get_wakeup_latency();
+  EXPECT_EQ(count, wakeup_latency.count);
+  EXPECT_LE(9ms, wakeup_latency.max);
+  EXPECT_LE(8u, statistics->get_max_missed_periods());
+
+  const auto callback_duration = statistics->get_callback_duration();
+  EXPECT_EQ(count, callback_duration.count);
+  EXPECT_LE(1ms, callback_duration.min);
+}
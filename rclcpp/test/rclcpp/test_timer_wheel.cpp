@@ -0,0 +1,156 @@
+// Copyright 2021 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#include "rclcpp/detail/timer_wheel.hpp"
+
+using namespace std::chrono_literals;
+
+using rclcpp::detail::TimerWheel;
+using Clock = TimerWheel<int>::Clock;
+
+namespace
+{
+
+std::vector<int>
+pop_all_expired(TimerWheel<int> & wheel)
+{
+  std::vector<int> values;
+  for (auto handle = wheel.pop_expired(); TimerWheel<int>::invalid_handle != handle;
+    handle = wheel.pop_expired())
+  {
+    values.push_back(wheel.get(handle));
+    wheel.erase(handle);
+  }
+  std::sort(values.begin(), values.end());
+  return values;
+}
+
+}  // namespace
+
+TEST(TestTimerWheel, construct) {
+  EXPECT_THROW(TimerWheel<int>(0ns), std::invalid_argument);
+  EXPECT_THROW(TimerWheel<int>(-1ms), std::invalid_argument);
+
+  TimerWheel<int> wheel(1ms);
+  EXPECT_EQ(1ms, wheel.resolution());
+  EXPECT_TRUE(wheel.empty());
+  EXPECT_EQ(Clock::time_point::max(), wheel.next_expiry());
+  EXPECT_EQ(TimerWheel<int>::invalid_handle, wheel.pop_expired());
+}
+
+TEST(TestTimerWheel, expire_in_order) {
+  const auto start = Clock::now();
+  TimerWheel<int> wheel(1ms, start);
+  wheel.insert(3, start + 3ms);
+  wheel.insert(1, start + 1ms);
+  wheel.insert(100, start + 100ms);
+  wheel.insert(2, start + 1500us);
+  EXPECT_EQ(4u, wheel.size());
+  EXPECT_EQ(start + 1ms, wheel.next_expiry());
+
+  wheel.advance(start + 1ms);
+  EXPECT_EQ(std::vector<int>({1}), pop_all_expired(wheel));
+  // Deadlines are rounded up to the next tick.
+  wheel.advance(start + 1900us);
+  EXPECT_TRUE(pop_all_expired(wheel).empty());
+  wheel.advance(start + 3ms);
+  EXPECT_EQ(std::vector<int>({2, 3}), pop_all_expired(wheel));
+
+  // The next expiry of a value on an upper level is a lower bound.
+  EXPECT_GE(start + 100ms, wheel.next_expiry());
+  EXPECT_LT(start + 3ms, wheel.next_expiry());
+  wheel.advance(start + 99ms);
+  EXPECT_TRUE(pop_all_expired(wheel).empty());
+  EXPECT_EQ(start + 100ms, wheel.next_expiry());
+  wheel.advance(start + 100ms);
+  EXPECT_EQ(std::vector<int>({100}), pop_all_expired(wheel));
+  EXPECT_TRUE(wheel.empty());
+}
+
+TEST(TestTimerWheel, past_deadline_expires_immediately) {
+  const auto start = Clock::now();
+  TimerWheel<int> wheel(1ms, start);
+  wheel.advance(start + 10ms);
+  wheel.insert(1, start + 5ms);
+  EXPECT_EQ(start + 10ms, wheel.next_expiry());
+  EXPECT_EQ(std::vector<int>({1}), pop_all_expired(wheel));
+}
+
+TEST(TestTimerWheel, reschedule_and_erase) {
+  const auto start = Clock::now();
+  TimerWheel<int> wheel(1ms, start);
+  auto watchdog = wheel.insert(1, start + 10ms);
+  auto erased = wheel.insert(2, start + 10ms);
+  wheel.erase(erased);
+  EXPECT_EQ(1u, wheel.size());
+
+  // Keep pushing the watchdog back, it never expires.
+  for (int i = 1; i < 100; ++i) {
+    wheel.advance(start + std::chrono::milliseconds(i));
+    wheel.reschedule(watchdog, start + std::chrono::milliseconds(i + 10));
+    EXPECT_EQ(TimerWheel<int>::invalid_handle, wheel.pop_expired());
+  }
+  wheel.advance(start + 109ms);
+  auto expired = wheel.pop_expired();
+  ASSERT_EQ(watchdog, expired);
+
+  // An expired value stays in the wheel until it is rescheduled or erased.
+  EXPECT_EQ(1u, wheel.size());
+  wheel.reschedule(expired, start + 200ms);
+  wheel.advance(start + 200ms);
+  EXPECT_EQ(std::vector<int>({1}), pop_all_expired(wheel));
+
+  // Handles of erased values are reused.
+  EXPECT_EQ(watchdog, wheel.insert(3, start + 300ms));
+  wheel.clear();
+  EXPECT_TRUE(wheel.empty());
+  EXPECT_EQ(Clock::time_point::max(), wheel.next_expiry());
+}
+
+// Advancing over a long time must expire exactly what is due, across every level.
+TEST(TestTimerWheel, random_deadlines) {
+  const auto start = Clock::now();
+  TimerWheel<int> wheel(1us, start);
+  std::mt19937 generator(42);
+  std::uniform_int_distribution<int64_t> distribution(1, 1000000000);
+
+  std::vector<int64_t> deadlines;
+  for (int i = 0; i < 1000; ++i) {
+    deadlines.push_back(distribution(generator));
+    wheel.insert(i, start + std::chrono::microseconds(deadlines.back()));
+  }
+
+  std::vector<bool> expired(deadlines.size(), false);
+  int64_t now = 0;
+  while (!wheel.empty()) {
+    const auto next_expiry = wheel.next_expiry();
+    ASSERT_NE(Clock::time_point::max(), next_expiry);
+    now = std::chrono::duration_cast<std::chrono::microseconds>(next_expiry - start).count();
+    wheel.advance(next_expiry);
+    for (int value : pop_all_expired(wheel)) {
+      EXPECT_EQ(deadlines[value], now);
+      expired[value] = true;
+    }
+  }
+  EXPECT_TRUE(std::all_of(expired.begin(), expired.end(), [](bool value) {return value;}));
+}
@@ -0,0 +1,236 @@
+// Copyright 2021 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "rclcpp/experimental/timers_manager.hpp"
+#include "rclcpp/rclcpp.hpp"
+
+using namespace std::chrono_literals;
+
+using rclcpp::experimental::TimersManager;
+
+class TestTimersManager : public ::testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    rclcpp::init(0, nullptr);
+    node = std::make_shared<rclcpp::Node>("test_timers_manager_node");
+  }
+
+  void TearDown() override
+  {
+    node.reset();
+    rclcpp::shutdown();
+  }
+
+  template<typename PredicateT>
+  static bool
+  wait_for(PredicateT predicate, std::chrono::nanoseconds timeout = 10s)
+  {
+    auto start = std::chrono::steady_clock::now();
+    while (!predicate()) {
+      if (std::chrono::steady_clock::now() - start > timeout) {
+        return false;
+      }
+      std::this_thread::sleep_for(1ms);
+    }
+    return true;
+  }
+
+  rclcpp::Node::SharedPtr node;
+};
+
+TEST_F(TestTimersManager, add_remove_timers) {
+  TimersManager timers_manager;
+  EXPECT_THROW(timers_manager.add_timer(nullptr), std::invalid_argument);
+  EXPECT_EQ(std::chrono::nanoseconds::max(), timers_manager.get_head_timeout());
+
+  auto timer = node->create_wall_timer(1h, []() {});
+  auto other_timer = node->create_wall_timer(1h, []() {});
+  timers_manager.add_timer(timer);
+  timers_manager.add_timer(timer);
+  timers_manager.add_timer(other_timer);
+  EXPECT_EQ(2u, timers_manager.size());
+  EXPECT_LT(0s, timers_manager.get_head_timeout());
+
+  timers_manager.remove_timer(timer);
+  timers_manager.remove_timer(timer);
+  EXPECT_EQ(1u, timers_manager.size());
+
+  timers_manager.clear();
+  EXPECT_EQ(0u, timers_manager.size());
+}
+
+TEST_F(TestTimersManager, execute_ready_timers) {
+  TimersManager timers_manager;
+  size_t fast_count = 0;
+  size_t slow_count = 0;
+  auto fast_timer = node->create_wall_timer(1ms, [&fast_count]() {fast_count++;});
+  auto slow_timer = node->create_wall_timer(1h, [&slow_count]() {slow_count++;});
+  timers_manager.add_timer(slow_timer);
+  timers_manager.add_timer(fast_timer);
+  EXPECT_GE(1ms, timers_manager.get_head_timeout());
+
+  std::this_thread::sleep_for(5ms);
+  EXPECT_EQ(1u, timers_manager.execute_ready_timers());
+  EXPECT_EQ(1u, fast_count);
+  EXPECT_EQ(0u, slow_count);
+
+  // The timer was called, it is not ready again before its next period.
+  EXPECT_LT(0ms, fast_timer->time_until_trigger());
+}
+
+TEST_F(TestTimersManager, start_stop) {
+  TimersManager timers_manager;
+  std::atomic_size_t count{0};
+  auto timer = node->create_wall_timer(1ms, [&count]() {count++;});
+  timers_manager.add_timer(timer);
+
+  timers_manager.start();
+  EXPECT_TRUE(timers_manager.is_running());
+  EXPECT_THROW(timers_manager.start(), std::runtime_error);
+  EXPECT_THROW(timers_manager.execute_ready_timers(), std::runtime_error);
+  EXPECT_TRUE(wait_for([&count]() {return count.load() >= 3u;}));
+
+  timers_manager.stop();
+  EXPECT_FALSE(timers_manager.is_running());
+  const size_t count_after_stop = count.load();
+  std::this_thread::sleep_for(10ms);
+  EXPECT_EQ(count_after_stop, count.load());
+}
+
+// Adding a timer with an earlier deadline wakes the thread up before the current nearest one.
+TEST_F(TestTimersManager, add_timer_while_running) {
+  TimersManager timers_manager;
+  auto slow_timer = node->create_wall_timer(1h, []() {});
+  timers_manager.add_timer(slow_timer);
+  timers_manager.start();
+
+  std::atomic_bool fast_called{false};
+  auto fast_timer = node->create_wall_timer(1ms, [&fast_called]() {fast_called = true;});
+  timers_manager.add_timer(fast_timer);
+  EXPECT_TRUE(wait_for([&fast_called]() {return fast_called.load();}));
+}
+
+TEST_F(TestTimersManager, on_ready_callback) {
+  std::mutex ready_mutex;
+  std::vector<rclcpp::TimerBase::SharedPtr> ready_timers;
+  TimersManager timers_manager(
+    [&ready_mutex, &ready_timers](const rclcpp::TimerBase::SharedPtr & timer) {
+      std::lock_guard<std::mutex> lock(ready_mutex);
+      ready_timers.push_back(timer);
+    });
+
+  std::atomic_bool executed{false};
+  auto timer = node->create_wall_timer(1ms, [&executed]() {executed = true;});
+  timers_manager.add_timer(timer);
+  timers_manager.start();
+  EXPECT_TRUE(
+    wait_for(
+      [&ready_mutex, &ready_timers]() {
+        std::lock_guard<std::mutex> lock(ready_mutex);
+        return !ready_timers.empty();
+      }));
+  timers_manager.stop();
+
+  // Executing the callback is left to whoever received the timer.
+  EXPECT_FALSE(executed.load());
+  EXPECT_EQ(timer, ready_timers.front());
+}
+
+TEST_F(TestTimersManager, canceled_timer) {
+  TimersManager timers_manager;
+  size_t count = 0;
+  auto timer = node->create_wall_timer(1ms, [&count]() {count++;});
+  timer->cancel();
+  timers_manager.add_timer(timer);
+
+  std::this_thread::sleep_for(5ms);
+  EXPECT_EQ(0u, timers_manager.execute_ready_timers());
+  EXPECT_EQ(0u, count);
+  EXPECT_EQ(1u, timers_manager.size());
+
+  // A reset timer is picked up again once the canceled timers are checked.
+  timer->reset();
+  EXPECT_TRUE(
+    wait_for(
+      [&timers_manager, &count]() {
+        timers_manager.execute_ready_timers();
+        return count > 0u;
+      }));
+}
+
+TEST_F(TestTimersManager, destroyed_timer) {
+  TimersManager timers_manager;
+  size_t count = 0;
+  auto timer = node->create_wall_timer(1ms, [&count]() {count++;});
+  timers_manager.add_timer(timer);
+  timer.reset();
+  node.reset();
+
+  std::this_thread::sleep_for(5ms);
+  EXPECT_EQ(0u, timers_manager.execute_ready_timers());
+  EXPECT_EQ(0u, count);
+  EXPECT_EQ(0u, timers_manager.size());
+}
+
+TEST_F(TestTimersManager, timer_wheel) {
+  EXPECT_THROW(TimersManager(nullptr, -1ms), std::invalid_argument);
+
+  TimersManager timers_manager(nullptr, 1ms);
+  std::atomic_size_t count{0};
+  auto timer = node->create_wall_timer(2ms, [&count]() {count++;});
+  auto watchdog = node->create_wall_timer(1h, []() {});
+  timers_manager.add_timer(timer);
+  timers_manager.add_timer(timer);
+  timers_manager.add_timer(watchdog);
+  EXPECT_EQ(2u, timers_manager.size());
+
+  timers_manager.start();
+  EXPECT_TRUE(wait_for([&count]() {return count.load() >= 3u;}));
+  timers_manager.stop();
+
+  timers_manager.remove_timer(timer);
+  EXPECT_EQ(1u, timers_manager.size());
+  watchdog->reset();
+  EXPECT_EQ(0u, timers_manager.execute_ready_timers());
+}
+
+// A timer within its slack is called in the same wakeup as a timer which has to be called.
+TEST_F(TestTimersManager, coalesce_timers_with_slack) {
+  EXPECT_THROW(node->create_wall_timer(1ms, []() {}, nullptr, -1ms), std::invalid_argument);
+
+  TimersManager timers_manager;
+  auto first_timer = node->create_wall_timer(10ms, []() {}, nullptr, 5ms);
+  EXPECT_EQ(5ms, first_timer->get_slack());
+  std::this_thread::sleep_for(2ms);
+  auto second_timer = node->create_wall_timer(10ms, []() {}, nullptr, 5ms);
+  timers_manager.add_timer(first_timer);
+  timers_manager.add_timer(second_timer);
+
+  // The first call is only required once the slack of the first timer is used up.
+  EXPECT_LT(10ms, timers_manager.get_head_timeout());
+  EXPECT_TRUE(wait_for([&timers_manager]() {return timers_manager.get_head_timeout() <= 0ns;}));
+  EXPECT_EQ(2u, timers_manager.execute_ready_timers());
+}
@@ -75,3 +75,34 @@ TEST(TypesupportHelpersTest, returns_c_type_info_for_valid_library) {
     FAIL() << e.what();
   }
 }
+
+TEST(TypesupportHelpersTest, caches_library_and_handle) {
+  try {
+    auto library = rclcpp::get_typesupport_library(
+      "test_msgs/msg/BasicTypes", "rosidl_typesupport_cpp");
+    // The types of a package share the library.
+    EXPECT_EQ(
+      library,
+      rclcpp::get_typesupport_library("test_msgs/msg/Strings", "rosidl_typesupport_cpp"));
+
+    auto handle = rclcpp::get_typesupport_handle(
+      "test_msgs/msg/BasicTypes", "rosidl_typesupport_cpp", *library);
+    EXPECT_EQ(
+      handle,
+      rclcpp::get_typesupport_handle(
+        "test_msgs/msg/BasicTypes", "rosidl_typesupport_cpp", *library));
+    EXPECT_NE(
+      handle,
+      rclcpp::get_typesupport_handle(
+        "test_msgs/msg/Strings", "rosidl_typesupport_cpp", *library));
+  } catch (const std::runtime_error & e) {
+    FAIL() << e.what();
+  }
+}
+
+TEST(TypesupportHelpersTest, preload_typesupport) {
+  EXPECT_NO_THROW(rclcpp::preload_typesupport("test_msgs/msg/BasicTypes"));
+  EXPECT_NO_THROW(rclcpp::preload_typesupport("test_msgs/msg/Arrays"));
+  EXPECT_THROW(rclcpp::preload_typesupport("invalid/message"), std::runtime_error);
+  EXPECT_ANY_THROW(rclcpp::preload_typesupport("just_a_package_name"));
+}
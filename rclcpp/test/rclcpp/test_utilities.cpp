@@ -14,6 +14,9 @@
 
 #include <gtest/gtest.h>
 
+#include <chrono>
+#include <csignal>
+#include <future>
 #include <memory>
 #include <string>
 #include <vector>
@@ -23,6 +26,7 @@
 
 #include "rclcpp/contexts/default_context.hpp"
 #include "rclcpp/exceptions.hpp"
+#include "rclcpp/node.hpp"
 #include "rclcpp/utilities.hpp"
 
 #include "../mocking_utils/patch.hpp"
@@ -111,6 +115,67 @@ TEST(TestUtilities, multi_init) {
   EXPECT_FALSE(rclcpp::ok(context2));
 }
 
+TEST(TestUtilities, reusable_context) {
+  auto context = std::make_shared<rclcpp::contexts::DefaultContext>();
+  auto init_options = rclcpp::InitOptions().reusable_context(true);
+  context->init(0, nullptr, init_options);
+  uint64_t instance_id = rcl_context_get_instance_id(context->get_rcl_context().get());
+  bool shutdown_callback_called = false;
+  context->on_shutdown([&shutdown_callback_called]() {shutdown_callback_called = true;});
+
+  EXPECT_TRUE(rclcpp::shutdown(context, "first shutdown"));
+  EXPECT_FALSE(rclcpp::ok(context));
+  EXPECT_TRUE(shutdown_callback_called);
+  EXPECT_EQ("first shutdown", context->shutdown_reason());
+  EXPECT_FALSE(rclcpp::shutdown(context));
+
+  // The rcl context is reused, with the new arguments.
+  const char * const argv[] = {"process_name", "--ros-args", "-r", "__ns:=/reused"};
+  context->init(4, argv, init_options);
+  EXPECT_TRUE(rclcpp::ok(context));
+  EXPECT_EQ("", context->shutdown_reason());
+  EXPECT_EQ(instance_id, rcl_context_get_instance_id(context->get_rcl_context().get()));
+  {
+    auto node = std::make_shared<rclcpp::Node>(
+      "node", rclcpp::NodeOptions().context(context));
+    EXPECT_STREQ("/reused", node->get_namespace());
+  }
+  EXPECT_TRUE(rclcpp::shutdown(context));
+
+  // Without the flag, the kept rcl context is shutdown, and another one initialized.
+  context->init(0, nullptr);
+  EXPECT_TRUE(rclcpp::ok(context));
+  EXPECT_NE(instance_id, rcl_context_get_instance_id(context->get_rcl_context().get()));
+  EXPECT_TRUE(rclcpp::shutdown(context));
+  EXPECT_FALSE(rcl_context_is_valid(context->get_rcl_context().get()));
+}
+
+TEST(TestUtilities, sigint_shutdown_deadline) {
+  auto init_options = rclcpp::InitOptions().sigint_shutdown_deadline(std::chrono::seconds(10));
+  auto slow_context = std::make_shared<rclcpp::Context>();
+  slow_context->init(0, nullptr, init_options);
+  std::promise<void> release;
+  std::shared_future<void> released = release.get_future().share();
+  slow_context->add_on_shutdown_callback([released]() {released.wait();});
+  auto context = std::make_shared<rclcpp::Context>();
+  context->init(0, nullptr, init_options);
+  std::promise<void> shut_down;
+  context->add_on_shutdown_callback([&shut_down]() {shut_down.set_value();});
+
+  bool installed = rclcpp::install_signal_handlers();
+  std::raise(SIGINT);
+  // Shut down while the shutdown of the other context is blocked.
+  EXPECT_EQ(
+    std::future_status::ready,
+    shut_down.get_future().wait_for(std::chrono::seconds(5)));
+  release.set_value();
+  if (installed) {
+    rclcpp::uninstall_signal_handlers();
+  }
+  EXPECT_FALSE(slow_context->is_valid());
+  EXPECT_FALSE(context->is_valid());
+}
+
 TEST(TestUtilities, test_context_basic_access) {
   auto context1 = std::make_shared<rclcpp::contexts::DefaultContext>();
   EXPECT_NE(nullptr, context1->get_init_options().get_rcl_init_options());
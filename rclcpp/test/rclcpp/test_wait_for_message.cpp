@@ -14,8 +14,10 @@
 
 #include <gtest/gtest.h>
 
+#include <future>
 #include <memory>
 #include <string>
+#include <thread>
 #include <vector>
 
 #include "rclcpp/node.hpp"
@@ -72,3 +74,53 @@ TEST(TestUtilities, wait_for_message_indefinitely) {
 
   ASSERT_FALSE(received);
 }
+
+TEST(TestUtilities, message_waiter) {
+  rclcpp::init(0, nullptr);
+
+  auto node = std::make_shared<rclcpp::Node>("message_waiter_node");
+
+  using MsgT = test_msgs::msg::Strings;
+  auto pub = node->create_publisher<MsgT>("message_waiter_topic", 10);
+  rclcpp::MessageWaiter<MsgT> waiter(node, "message_waiter_topic");
+
+  MsgT out;
+  EXPECT_FALSE(waiter.wait_for_message(out, 10ms));
+
+  // The subscription is kept, the messages are received from one call to the next.
+  for (auto i = 0u; i < 3u; ++i) {
+    MsgT msg;
+    msg.string_value = "message " + std::to_string(i);
+    auto received = false;
+    for (auto attempt = 0u; attempt < 50u && !received; ++attempt) {
+      pub->publish(msg);
+      received = waiter.wait_for_message(out, 100ms);
+    }
+    ASSERT_TRUE(received);
+    EXPECT_EQ(msg.string_value, out.string_value);
+  }
+
+  // The latest message received between the calls is returned without waiting.
+  MsgT msg;
+  msg.string_value = "cached";
+  pub->publish(msg);
+  std::this_thread::sleep_for(100ms);
+  ASSERT_TRUE(waiter.wait_for_message(out, 0ms));
+  EXPECT_EQ("cached", out.string_value);
+
+  // It is dropped when waiting for the next message.
+  msg.string_value = "dropped";
+  pub->publish(msg);
+  std::this_thread::sleep_for(100ms);
+  out.string_value = "unchanged";
+  EXPECT_FALSE(waiter.wait_for_next_message(out, 10ms));
+  EXPECT_EQ("unchanged", out.string_value);
+
+  // Shutting down the context stops a wait.
+  auto wait = std::async(
+    [&]() {
+      return waiter.wait_for_next_message(out);
+    });
+  rclcpp::shutdown();
+  EXPECT_FALSE(wait.get());
+}
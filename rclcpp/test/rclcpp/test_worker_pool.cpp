@@ -0,0 +1,136 @@
+// Copyright 2021 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "rclcpp/rclcpp.hpp"
+#include "rclcpp/worker_pool.hpp"
+
+using namespace std::chrono_literals;
+
+TEST(TestWorkerPool, submit) {
+  rclcpp::WorkerPoolOptions options;
+  options.max_threads = 2;
+  rclcpp::WorkerPool pool(options);
+  EXPECT_EQ(2u, pool.get_max_threads());
+  EXPECT_EQ(0u, pool.get_number_of_threads());
+
+  std::future<int> result = pool.submit([]() {return 42;});
+  EXPECT_EQ(42, result.get());
+  std::future<void> failure = pool.submit([]() {throw std::runtime_error("failure");});
+  EXPECT_THROW(failure.get(), std::runtime_error);
+
+  // A function throwing without a future does not stop its thread.
+  pool.post([]() {throw std::runtime_error("logged");});
+  EXPECT_EQ(1, pool.submit([]() {return 1;}).get());
+}
+
+TEST(TestWorkerPool, bounded_number_of_threads) {
+  rclcpp::WorkerPoolOptions options;
+  options.max_threads = 3;
+  rclcpp::WorkerPool pool(options);
+
+  std::promise<void> release;
+  std::shared_future<void> released = release.get_future().share();
+  std::atomic<size_t> running {0};
+  std::vector<std::future<void>> futures;
+  for (size_t i = 0; i < 10; ++i) {
+    futures.push_back(
+      pool.submit(
+        [&running, released]() {
+          ++running;
+          released.wait();
+        }));
+  }
+  auto start = std::chrono::steady_clock::now();
+  while (running < 3u && std::chrono::steady_clock::now() - start < 10s) {
+    std::this_thread::sleep_for(1ms);
+  }
+  EXPECT_EQ(3u, running.load());
+  EXPECT_EQ(3u, pool.get_number_of_threads());
+  EXPECT_EQ(7u, pool.get_pending_count());
+
+  release.set_value();
+  for (auto & future : futures) {
+    future.get();
+  }
+  EXPECT_EQ(10u, running.load());
+  EXPECT_EQ(3u, pool.get_number_of_threads());
+}
+
+TEST(TestWorkerPool, shutdown) {
+  rclcpp::WorkerPoolOptions options;
+  options.max_threads = 1;
+  rclcpp::WorkerPool pool(options);
+
+  std::promise<void> started;
+  std::promise<void> release;
+  std::future<void> running = pool.submit(
+    [&started, &release]() {
+      started.set_value();
+      release.get_future().wait();
+    });
+  std::future<void> dropped = pool.submit([]() {});
+  started.get_future().wait();
+
+  std::thread releaser(
+    [&release]() {
+      std::this_thread::sleep_for(10ms);
+      release.set_value();
+    });
+  // Waits for the running function, dropping the other one.
+  pool.shutdown();
+  releaser.join();
+  EXPECT_TRUE(pool.is_shutdown());
+  EXPECT_EQ(0u, pool.get_number_of_threads());
+  EXPECT_NO_THROW(running.get());
+  EXPECT_THROW(dropped.get(), std::future_error);
+  EXPECT_THROW(pool.post([]() {}), std::runtime_error);
+  pool.shutdown();
+}
+
+TEST(TestWorkerPool, shutdown_from_worker) {
+  auto pool = std::make_shared<rclcpp::WorkerPool>();
+  std::future<void> future = pool->submit([&pool]() {pool->shutdown();});
+  EXPECT_NO_THROW(future.get());
+  EXPECT_TRUE(pool->is_shutdown());
+}
+
+TEST(TestWorkerPool, context_worker_pool) {
+  rclcpp::InitOptions init_options;
+  rclcpp::WorkerPoolOptions options;
+  options.max_threads = 2;
+  init_options.worker_pool(options);
+  auto context = std::make_shared<rclcpp::Context>();
+  EXPECT_THROW(context->get_worker_pool(), std::runtime_error);
+  context->init(0, nullptr, init_options);
+
+  rclcpp::WorkerPool::SharedPtr pool = context->get_worker_pool();
+  EXPECT_EQ(pool, context->get_worker_pool());
+  EXPECT_EQ(2u, pool->get_max_threads());
+  EXPECT_EQ(3, pool->submit([]() {return 3;}).get());
+
+  context->shutdown("test");
+  EXPECT_TRUE(pool->is_shutdown());
+  EXPECT_THROW(context->get_worker_pool(), std::runtime_error);
+}
@@ -0,0 +1,134 @@
+// Copyright 2021 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <future>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+#include "rclcpp/rclcpp.hpp"
+#include "rclcpp/topic_statistics/executor_topic_statistics.hpp"
+
+#include "statistics_msgs/msg/metrics_message.hpp"
+#include "statistics_msgs/msg/statistic_data_type.hpp"
+
+#include "test_topic_stats_utils.hpp"
+
+using namespace std::chrono_literals;
+
+using rclcpp::topic_statistics::ExecutorTopicStatistics;
+using statistics_msgs::msg::MetricsMessage;
+using statistics_msgs::msg::StatisticDataType;
+
+namespace
+{
+constexpr const char kTestExecutorNodeName[]{"test_executor_stats_node"};
+constexpr const char kTestExecutorStatsTopic[]{"/test_executor_stats_topic"};
+constexpr const std::chrono::seconds kTestTimeout{10};
+constexpr const uint64_t kNumExpectedWindows{2};
+// The dispatch latency, the execution duration and the queueing delay of the default group.
+constexpr const uint64_t kNumExpectedMessages{kNumExpectedWindows * 3};
+}  // namespace
+
+class TestExecutorTopicStatisticsFixture : public ::testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    rclcpp::init(0, nullptr);
+    node = std::make_shared<rclcpp::Node>(kTestExecutorNodeName);
+  }
+
+  void TearDown() override
+  {
+    node.reset();
+    rclcpp::shutdown();
+  }
+
+  rclcpp::Node::SharedPtr node;
+};
+
+TEST_F(TestExecutorTopicStatisticsFixture, test_invalid_arguments)
+{
+  rclcpp::executors::SingleThreadedExecutor executor;
+  auto publisher = node->create_publisher<MetricsMessage>(kTestExecutorStatsTopic, 10);
+  EXPECT_THROW(
+    ExecutorTopicStatistics(kTestExecutorNodeName, nullptr, publisher), std::invalid_argument);
+  EXPECT_THROW(
+    ExecutorTopicStatistics(kTestExecutorNodeName, &executor, nullptr), std::invalid_argument);
+}
+
+TEST_F(TestExecutorTopicStatisticsFixture, test_receive_executor_stats)
+{
+  rclcpp::executors::SingleThreadedExecutor executor;
+  auto timer = node->create_wall_timer(10ms, []() {});
+  auto executor_topic_stats = rclcpp::topic_statistics::create_executor_topic_statistics(
+    node, &executor, 200ms, kTestExecutorStatsTopic);
+  EXPECT_NE(nullptr, executor.get_statistics());
+
+  auto statistics_listener = std::make_shared<rclcpp::topic_statistics::MetricsMessageSubscriber>(
+    "test_receive_executor_stats_listener",
+    kTestExecutorStatsTopic,
+    kNumExpectedMessages);
+
+  // The listener is spun by another executor, so only the node is measured.
+  rclcpp::executors::SingleThreadedExecutor listener_executor;
+  listener_executor.add_node(statistics_listener);
+  executor.add_node(node);
+  const auto end = std::chrono::steady_clock::now() + kTestTimeout;
+  auto future = statistics_listener->GetFuture();
+  while (std::chrono::steady_clock::now() < end &&
+    future.wait_for(0s) != std::future_status::ready)
+  {
+    executor.spin_some();
+    listener_executor.spin_some();
+    std::this_thread::sleep_for(1ms);
+  }
+
+  const auto received_messages = statistics_listener->GetReceivedMessages();
+  ASSERT_EQ(kNumExpectedMessages, received_messages.size());
+
+  uint64_t dispatch_latency_count{0};
+  uint64_t execution_duration_count{0};
+  uint64_t queueing_delay_count{0};
+  for (const auto & msg : received_messages) {
+    EXPECT_EQ("ms", msg.unit);
+    if (msg.metrics_source == rclcpp::topic_statistics::kExecutorDispatchLatencyMetricName) {
+      dispatch_latency_count++;
+      EXPECT_EQ(kTestExecutorNodeName, msg.measurement_source_name);
+    } else if (
+      msg.metrics_source == rclcpp::topic_statistics::kExecutorExecutionDurationMetricName)
+    {
+      execution_duration_count++;
+      EXPECT_EQ(kTestExecutorNodeName, msg.measurement_source_name);
+    } else if (msg.metrics_source == rclcpp::topic_statistics::kExecutorQueueingDelayMetricName) {
+      queueing_delay_count++;
+      EXPECT_EQ(
+        std::string("/") + kTestExecutorNodeName + "/default_callback_group",
+        msg.measurement_source_name);
+    }
+    for (const auto & stats_point : msg.statistics) {
+      if (stats_point.data_type == StatisticDataType::STATISTICS_DATA_TYPE_SAMPLE_COUNT) {
+        EXPECT_LT(0, stats_point.data) << "unexpected sample count for " << msg.metrics_source;
+      }
+    }
+  }
+  EXPECT_EQ(kNumExpectedWindows, dispatch_latency_count);
+  EXPECT_EQ(kNumExpectedWindows, execution_duration_count);
+  EXPECT_EQ(kNumExpectedWindows, queueing_delay_count);
+}
@@ -85,8 +85,10 @@ class TestSubscriptionTopicStatistics : public SubscriptionTopicStatistics<Callb
 public:
   TestSubscriptionTopicStatistics(
     const std::string & node_name,
-    rclcpp::Publisher<statistics_msgs::msg::MetricsMessage>::SharedPtr publisher)
-  : SubscriptionTopicStatistics<CallbackMessageT>(node_name, publisher)
+    rclcpp::Publisher<statistics_msgs::msg::MetricsMessage>::SharedPtr publisher,
+    size_t message_sampling_interval = 1)
+  : SubscriptionTopicStatistics<CallbackMessageT>(
+      node_name, publisher, message_sampling_interval)
   {
   }
 
@@ -372,6 +374,39 @@ TEST(TestSubscriptionTopicStatistics, test_invalid_publish_period)
   rclcpp::shutdown();
 }
 
+/**
+ * Test an invalid argument is thrown for a bad input message sampling interval.
+ */
+TEST(TestSubscriptionTopicStatistics, test_invalid_message_sampling_interval)
+{
+  rclcpp::init(0 /* argc */, nullptr /* argv */);
+
+  auto node = std::make_shared<rclcpp::Node>("test_sampling_interval_node");
+
+  auto options = rclcpp::SubscriptionOptions();
+  options.topic_stats_options.state = rclcpp::TopicStatisticsState::Enable;
+  options.topic_stats_options.message_sampling_interval = 0;
+
+  auto callback = [](Empty::UniquePtr msg) {
+      (void) msg;
+    };
+
+  ASSERT_THROW(
+    (node->create_subscription<Empty, std::function<void(Empty::UniquePtr)>>(
+      "should_throw_invalid_arg",
+      rclcpp::QoS(rclcpp::KeepAll()),
+      callback,
+      options)), std::invalid_argument);
+
+  auto topic_stats_publisher = node->create_publisher<MetricsMessage>(
+    kTestTopicStatisticsTopic, 10);
+  ASSERT_THROW(
+    TestSubscriptionTopicStatistics<Empty>(node->get_name(), topic_stats_publisher, 0),
+    std::invalid_argument);
+
+  rclcpp::shutdown();
+}
+
 /**
  * Test that we can manually construct the subscription topic statistics utility class
  * without any errors and defaults to empty measurements.
@@ -403,6 +438,49 @@ TEST_F(TestSubscriptionTopicStatisticsFixture, test_manual_construction)
   }
 }
 
+/**
+ * Test that only one message out of the sampling interval is measured, and that the
+ * period measured is the period of the messages.
+ */
+TEST_F(TestSubscriptionTopicStatisticsFixture, test_message_sampling_interval)
+{
+  auto node = std::make_shared<rclcpp::Node>(kTestSubNodeName);
+  auto topic_stats_publisher = node->create_publisher<MetricsMessage>(
+    kTestTopicStatisticsTopic, 10);
+  auto sub_topic_stats = std::make_unique<TestSubscriptionTopicStatistics<MessageWithHeader>>(
+    node->get_name(), topic_stats_publisher, 2);
+
+  const rclcpp::Time start(1000, 0);
+  size_t sampled = 0;
+  for (int i = 0; i < 10; ++i) {
+    const rclcpp::Time now = start + rclcpp::Duration(std::chrono::milliseconds(10 * i));
+    MessageWithHeader msg;
+    msg.header.stamp = now - rclcpp::Duration(std::chrono::milliseconds(1));
+    if (sub_topic_stats->sample_next_message()) {
+      ++sampled;
+      sub_topic_stats->handle_message(msg, now);
+    }
+  }
+  EXPECT_EQ(5u, sampled);
+
+  const auto data = sub_topic_stats->get_current_collector_data();
+  ASSERT_EQ(2u, data.size());
+  // Message age
+  EXPECT_EQ(5u, data[0].sample_count);
+  EXPECT_DOUBLE_EQ(1.0, data[0].average);
+  EXPECT_DOUBLE_EQ(1.0, data[0].max);
+  // Message period, averaged over the messages which were not measured
+  EXPECT_EQ(4u, data[1].sample_count);
+  EXPECT_DOUBLE_EQ(10.0, data[1].average);
+  EXPECT_DOUBLE_EQ(10.0, data[1].min);
+  EXPECT_NEAR(0.0, data[1].standard_deviation, 1e-6);
+
+  sub_topic_stats->publish_message_and_reset_measurements();
+  for (const auto & reset_data : sub_topic_stats->get_current_collector_data()) {
+    EXPECT_EQ(kNoSamples, reset_data.sample_count);
+  }
+}
+
 /**
  * Publish messages that do not have a header timestamp, test that all statistics messages
  * were received, and verify the statistics message contents.
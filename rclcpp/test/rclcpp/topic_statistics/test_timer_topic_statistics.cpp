@@ -0,0 +1,115 @@
+// Copyright 2021 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+#include "rclcpp/rclcpp.hpp"
+#include "rclcpp/topic_statistics/timer_topic_statistics.hpp"
+
+#include "statistics_msgs/msg/metrics_message.hpp"
+#include "statistics_msgs/msg/statistic_data_type.hpp"
+
+#include "test_topic_stats_utils.hpp"
+
+using namespace std::chrono_literals;
+
+using rclcpp::topic_statistics::TimerTopicStatistics;
+using statistics_msgs::msg::MetricsMessage;
+using statistics_msgs::msg::StatisticDataType;
+
+namespace
+{
+constexpr const char kTestTimerNodeName[]{"test_timer_stats_node"};
+constexpr const char kTestTimerStatsTopic[]{"/test_timer_stats_topic"};
+constexpr const std::chrono::seconds kTestTimeout{10};
+constexpr const uint64_t kNumExpectedWindows{2};
+constexpr const uint64_t kNumExpectedMessages{kNumExpectedWindows * 3};
+}  // namespace
+
+class TestTimerTopicStatisticsFixture : public ::testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    rclcpp::init(0, nullptr);
+    node = std::make_shared<rclcpp::Node>(kTestTimerNodeName);
+  }
+
+  void TearDown() override
+  {
+    node.reset();
+    rclcpp::shutdown();
+  }
+
+  rclcpp::Node::SharedPtr node;
+};
+
+TEST_F(TestTimerTopicStatisticsFixture, test_invalid_arguments)
+{
+  auto timer = node->create_wall_timer(1h, []() {});
+  auto publisher = node->create_publisher<MetricsMessage>(kTestTimerStatsTopic, 10);
+  EXPECT_THROW(TimerTopicStatistics(kTestTimerNodeName, nullptr, publisher), std::invalid_argument);
+  EXPECT_THROW(TimerTopicStatistics(kTestTimerNodeName, timer, nullptr), std::invalid_argument);
+}
+
+TEST_F(TestTimerTopicStatisticsFixture, test_receive_timer_stats)
+{
+  auto timer = node->create_wall_timer(10ms, []() {});
+  auto timer_topic_stats = rclcpp::topic_statistics::create_timer_topic_statistics(
+    node, timer, 200ms, kTestTimerStatsTopic);
+  EXPECT_NE(nullptr, timer->get_statistics());
+
+  auto statistics_listener = std::make_shared<rclcpp::topic_statistics::MetricsMessageSubscriber>(
+    "test_receive_timer_stats_listener",
+    kTestTimerStatsTopic,
+    kNumExpectedMessages);
+
+  rclcpp::executors::SingleThreadedExecutor ex;
+  ex.add_node(node);
+  ex.add_node(statistics_listener);
+  ex.spin_until_future_complete(statistics_listener->GetFuture(), kTestTimeout);
+
+  const auto received_messages = statistics_listener->GetReceivedMessages();
+  ASSERT_EQ(kNumExpectedMessages, received_messages.size());
+
+  uint64_t wakeup_latency_count{0};
+  uint64_t callback_duration_count{0};
+  uint64_t missed_periods_count{0};
+  for (const auto & msg : received_messages) {
+    EXPECT_EQ(kTestTimerNodeName, msg.measurement_source_name);
+    if (msg.metrics_source == rclcpp::topic_statistics::kTimerWakeupLatencyMetricName) {
+      wakeup_latency_count++;
+      EXPECT_EQ("ms", msg.unit);
+    } else if (msg.metrics_source == rclcpp::topic_statistics::kTimerCallbackDurationMetricName) {
+      callback_duration_count++;
+      EXPECT_EQ("ms", msg.unit);
+    } else if (msg.metrics_source == rclcpp::topic_statistics::kTimerMissedPeriodsMetricName) {
+      missed_periods_count++;
+      EXPECT_EQ("count", msg.unit);
+    }
+    for (const auto & stats_point : msg.statistics) {
+      if (stats_point.data_type == StatisticDataType::STATISTICS_DATA_TYPE_SAMPLE_COUNT) {
+        EXPECT_LT(0, stats_point.data) << "unexpected sample count for " << msg.metrics_source;
+      }
+    }
+  }
+  EXPECT_EQ(kNumExpectedWindows, wakeup_latency_count);
+  EXPECT_EQ(kNumExpectedWindows, callback_duration_count);
+  EXPECT_EQ(kNumExpectedWindows, missed_periods_count);
+}
@@ -14,7 +14,9 @@
 
 #include <gtest/gtest.h>
 
+#include <chrono>
 #include <memory>
+#include <thread>
 #include <vector>
 
 #include "rclcpp/rclcpp.hpp"
@@ -304,3 +306,37 @@ TEST_F(TestThreadSafeStorage, wait_waitable) {
     EXPECT_EQ(rclcpp::WaitResultKind::Timeout, wait_result.kind());
   }
 }
+
+TEST_F(TestThreadSafeStorage, modify_without_interrupting) {
+  rclcpp::ThreadSafeWaitSet wait_set;
+  wait_set.set_interrupt_on_modification(false);
+
+  // The triggered guard condition is only waited on from the next wait.
+  auto guard_condition = std::make_shared<rclcpp::GuardCondition>();
+  guard_condition->trigger();
+  std::thread modifier([&wait_set, &guard_condition]() {
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+      wait_set.add_guard_condition(guard_condition);
+    });
+  EXPECT_EQ(
+    rclcpp::WaitResultKind::Timeout, wait_set.wait(std::chrono::milliseconds(100)).kind());
+  modifier.join();
+
+  {
+    auto wait_result = wait_set.wait(std::chrono::milliseconds(100));
+    EXPECT_EQ(rclcpp::WaitResultKind::Ready, wait_result.kind());
+    // The wait result in scope doesn't block the changes.
+    wait_set.remove_guard_condition(guard_condition);
+  }
+
+  // Interrupting on request makes the wait in progress wait on the changes.
+  guard_condition->trigger();
+  modifier = std::thread(
+    [&wait_set, &guard_condition]() {
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+      wait_set.add_guard_condition(guard_condition);
+      wait_set.interrupt_wait();
+    });
+  EXPECT_EQ(rclcpp::WaitResultKind::Ready, wait_set.wait(std::chrono::seconds(10)).kind());
+  modifier.join();
+}
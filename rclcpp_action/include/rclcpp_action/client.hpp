@@ -16,6 +16,11 @@
 #define RCLCPP_ACTION__CLIENT_HPP_
 
 #include <rclcpp/exceptions.hpp>
+#include <rclcpp/expand_topic_or_service_name.hpp>
+#include <rclcpp/experimental/client_intra_process.hpp>
+#include <rclcpp/experimental/client_intra_process_base.hpp>
+#include <rclcpp/experimental/service_intra_process.hpp>
+#include <rclcpp/experimental/service_intra_process_base.hpp>
 #include <rclcpp/macros.hpp>
 #include <rclcpp/node_interfaces/node_base_interface.hpp>
 #include <rclcpp/node_interfaces/node_logging_interface.hpp>
@@ -31,11 +36,12 @@
 #include <chrono>
 #include <functional>
 #include <future>
-#include <map>
 #include <memory>
 #include <mutex>
 #include <string>
+#include <unordered_map>
 #include <utility>
+#include <vector>
 
 #include "rclcpp_action/client_goal_handle.hpp"
 #include "rclcpp_action/exceptions.hpp"
@@ -78,6 +84,32 @@ public:
     );
   }
 
+  /// Deliver only the latest feedback of each goal when the client falls behind.
+  /**
+   * When more feedback was received than the client handled, all of it is
+   * taken at once and only the latest message of each goal is given to the
+   * feedback callback of the goal, the others are dropped.
+   * By default all the feedback is given to the feedback callbacks.
+   *
+   * \param[in] latest_feedback_only whether to drop the feedback superseded by a newer message.
+   */
+  RCLCPP_ACTION_PUBLIC
+  void
+  set_latest_feedback_only(bool latest_feedback_only);
+
+  /// Return whether only the latest feedback of each goal is delivered.
+  RCLCPP_ACTION_PUBLIC
+  bool
+  get_latest_feedback_only() const;
+
+  /// Return the waitables executing the responses of intra-process servers.
+  /**
+   * \return the waitables, which are empty unless intra-process communication is enabled.
+   */
+  RCLCPP_ACTION_PUBLIC
+  std::vector<rclcpp::Waitable::SharedPtr>
+  get_intra_process_waitables() const;
+
   // -------------
   // Waitables API
 
@@ -144,6 +176,20 @@ protected:
   bool
   wait_for_action_server_nanoseconds(std::chrono::nanoseconds timeout);
 
+  /// Register the clients through which intra-process servers give their responses.
+  /// \internal
+  RCLCPP_ACTION_PUBLIC
+  void
+  setup_intra_process(
+    std::vector<rclcpp::experimental::ClientIntraProcessBase::SharedPtr> clients,
+    rclcpp::Context::SharedPtr context);
+
+  /// Return the intra-process service registered with the given name, or null.
+  /// \internal
+  RCLCPP_ACTION_PUBLIC
+  rclcpp::experimental::ServiceIntraProcessBase::SharedPtr
+  find_intra_process_service(const std::string & service_name) const;
+
   // -----------------------------------------------------
   // API for communication between ClientBase and Client<>
   using ResponseCallback = std::function<void (std::shared_ptr<void> response)>;
@@ -158,6 +204,23 @@ protected:
   GoalUUID
   generate_goal_id();
 
+  // ClientBase will call these functions to give a request to an intra-process server, if
+  // there is one. They return false when the request is to be sent through the middleware.
+  /// \internal
+  virtual
+  bool
+  send_intra_process_goal_request(int64_t sequence_number, std::shared_ptr<void> request) = 0;
+
+  /// \internal
+  virtual
+  bool
+  send_intra_process_result_request(int64_t sequence_number, std::shared_ptr<void> request) = 0;
+
+  /// \internal
+  virtual
+  bool
+  send_intra_process_cancel_request(int64_t sequence_number, std::shared_ptr<void> request) = 0;
+
   /// \internal
   RCLCPP_ACTION_PUBLIC
   virtual
@@ -231,6 +294,12 @@ protected:
   void
   handle_feedback_message(std::shared_ptr<void> message) = 0;
 
+  /// Given a feedback message, return the UUID of the goal it belongs to.
+  /// \internal
+  virtual
+  GoalUUID
+  get_goal_id_from_feedback_message(void * message) const = 0;
+
   /// \internal
   virtual
   std::shared_ptr<void>
@@ -245,6 +314,10 @@ protected:
   // ---------------------------------------------------------
 
 private:
+  /// Take the feedback received after the first message, keeping the latest of each goal.
+  void
+  take_latest_feedback(std::vector<std::shared_ptr<void>> & feedback_messages);
+
   std::unique_ptr<ClientBaseImpl> pimpl_;
 };
 
@@ -259,7 +332,7 @@ private:
  *  - calling user callbacks.
  */
 template<typename ActionT>
-class Client : public ClientBase
+class Client : public ClientBase, public std::enable_shared_from_this<Client<ActionT>>
 {
 public:
   RCLCPP_SMART_PTR_DEFINITIONS_NOT_COPYABLE(Client<ActionT>)
@@ -423,6 +496,71 @@ private:
   {
   }
 
+  /// Give the requests to intra-process servers without the middleware.
+  /**
+   * The goal, cancel and result requests are then given by pointer to the
+   * server of the action in the same context, if it enabled intra-process
+   * communication as well, and so are the responses.
+   * The requests are sent through the middleware while there is no such server.
+   * The feedback and the status are still received through the middleware.
+   *
+   * This is called by rclcpp_action::create_client(), before the client is
+   * added to its callback group.
+   *
+   * \param[in] node_base the node of the client, whose context is used.
+   * \param[in] name the name of the action, as given to the constructor.
+   */
+  void
+  enable_intra_process(
+    rclcpp::node_interfaces::NodeBaseInterface::SharedPtr node_base,
+    const std::string & name)
+  {
+    const std::string action_name = rclcpp::expand_topic_or_service_name(
+      name, node_base->get_name(), node_base->get_namespace(), true);
+    auto context = node_base->get_context();
+    std::weak_ptr<Client> weak_this = this->shared_from_this();
+
+    goal_intra_process_.service_name = action_name + "/_action/send_goal";
+    goal_intra_process_.client = std::make_shared<typename GoalIntraProcess::ClientT>(
+      context,
+      [weak_this](
+        std::shared_ptr<rmw_request_id_t> response_header,
+        typename GoalIntraProcess::ClientT::SharedResponse response)
+      {
+        auto client = weak_this.lock();
+        if (client) {
+          client->handle_goal_response(*response_header, std::move(response));
+        }
+      });
+    result_intra_process_.service_name = action_name + "/_action/get_result";
+    result_intra_process_.client = std::make_shared<typename ResultIntraProcess::ClientT>(
+      context,
+      [weak_this](
+        std::shared_ptr<rmw_request_id_t> response_header,
+        typename ResultIntraProcess::ClientT::SharedResponse response)
+      {
+        auto client = weak_this.lock();
+        if (client) {
+          client->handle_result_response(*response_header, std::move(response));
+        }
+      });
+    cancel_intra_process_.service_name = action_name + "/_action/cancel_goal";
+    cancel_intra_process_.client = std::make_shared<typename CancelIntraProcess::ClientT>(
+      context,
+      [weak_this](
+        std::shared_ptr<rmw_request_id_t> response_header,
+        typename CancelIntraProcess::ClientT::SharedResponse response)
+      {
+        auto client = weak_this.lock();
+        if (client) {
+          client->handle_cancel_response(*response_header, std::move(response));
+        }
+      });
+    this->setup_intra_process(
+      {goal_intra_process_.client, result_intra_process_.client, cancel_intra_process_.client},
+      context);
+  }
+
   /// Send an action goal and asynchronously get the result.
   /**
    * If the goal is accepted by an action server, the returned future is set to a `ClientGoalHandle`.
@@ -622,6 +760,74 @@ private:
   }
 
 private:
+  /// Intra-process client of one of the services of the action, and the server it found.
+  template<typename ServiceT>
+  struct IntraProcessEndpoint
+  {
+    using ClientT = rclcpp::experimental::ClientIntraProcess<ServiceT>;
+    using ServiceIntraProcessT = rclcpp::experimental::ServiceIntraProcess<ServiceT>;
+
+    std::string service_name;
+    typename ClientT::SharedPtr client;
+    typename ServiceIntraProcessT::WeakPtr service;
+  };
+
+  using GoalIntraProcess = IntraProcessEndpoint<typename ActionT::Impl::SendGoalService>;
+  using ResultIntraProcess = IntraProcessEndpoint<typename ActionT::Impl::GetResultService>;
+  using CancelIntraProcess = IntraProcessEndpoint<typename ActionT::Impl::CancelGoalService>;
+
+  /// \internal
+  template<typename ServiceT>
+  bool
+  send_intra_process_request(
+    IntraProcessEndpoint<ServiceT> & endpoint,
+    int64_t sequence_number,
+    std::shared_ptr<void> request)
+  {
+    if (!endpoint.client) {
+      return false;
+    }
+    auto service = endpoint.service.lock();
+    if (!service) {
+      // The server may be created after the client, or created again.
+      service = std::dynamic_pointer_cast<
+        typename IntraProcessEndpoint<ServiceT>::ServiceIntraProcessT>(
+        this->find_intra_process_service(endpoint.service_name));
+      if (!service) {
+        return false;
+      }
+      endpoint.service = service;
+    }
+    service->store_intra_process_request(
+      sequence_number, std::static_pointer_cast<typename ServiceT::Request>(request),
+      endpoint.client);
+    return true;
+  }
+
+  /// \internal
+  bool
+  send_intra_process_goal_request(
+    int64_t sequence_number, std::shared_ptr<void> request) override
+  {
+    return send_intra_process_request(goal_intra_process_, sequence_number, std::move(request));
+  }
+
+  /// \internal
+  bool
+  send_intra_process_result_request(
+    int64_t sequence_number, std::shared_ptr<void> request) override
+  {
+    return send_intra_process_request(result_intra_process_, sequence_number, std::move(request));
+  }
+
+  /// \internal
+  bool
+  send_intra_process_cancel_request(
+    int64_t sequence_number, std::shared_ptr<void> request) override
+  {
+    return send_intra_process_request(cancel_intra_process_, sequence_number, std::move(request));
+  }
+
   /// \internal
   std::shared_ptr<void>
   create_goal_response() const override
@@ -662,26 +868,36 @@ private:
     typename FeedbackMessage::SharedPtr feedback_message =
       std::static_pointer_cast<FeedbackMessage>(message);
     const GoalUUID & goal_id = feedback_message->goal_id.uuid;
-    if (goal_handles_.count(goal_id) == 0) {
+    auto goal_handle_it = goal_handles_.find(goal_id);
+    if (goal_handle_it == goal_handles_.end()) {
       RCLCPP_DEBUG(
         this->get_logger(),
         "Received feedback for unknown goal. Ignoring...");
       return;
     }
-    typename GoalHandle::SharedPtr goal_handle = goal_handles_[goal_id].lock();
+    typename GoalHandle::SharedPtr goal_handle = goal_handle_it->second.lock();
     // Forget about the goal if there are no more user references
     if (!goal_handle) {
       RCLCPP_DEBUG(
         this->get_logger(),
         "Dropping weak reference to goal handle during feedback callback");
-      goal_handles_.erase(goal_id);
+      goal_handles_.erase(goal_handle_it);
       return;
     }
-    auto feedback = std::make_shared<Feedback>();
-    *feedback = feedback_message->feedback;
+    // Alias the feedback into the message, which is taken into again once it is released
+    auto feedback = std::shared_ptr<const Feedback>(
+      feedback_message, &feedback_message->feedback);
     goal_handle->call_feedback_callback(goal_handle, feedback);
   }
 
+  /// \internal
+  GoalUUID
+  get_goal_id_from_feedback_message(void * message) const override
+  {
+    using FeedbackMessage = typename ActionT::Impl::FeedbackMessage;
+    return static_cast<FeedbackMessage *>(message)->goal_id.uuid;
+  }
+
   /// \internal
   std::shared_ptr<void>
   create_status_message() const override
@@ -697,21 +913,29 @@ private:
     std::lock_guard<std::mutex> guard(goal_handles_mutex_);
     using GoalStatusMessage = typename ActionT::Impl::GoalStatusMessage;
     auto status_message = std::static_pointer_cast<GoalStatusMessage>(message);
+    // The status of a server lists the goals of all its clients; only look for the goals
+    // of this client, until all of them were found.
+    size_t goals_left = goal_handles_.size();
     for (const GoalStatus & status : status_message->status_list) {
+      if (0u == goals_left) {
+        break;
+      }
       const GoalUUID & goal_id = status.goal_info.goal_id.uuid;
-      if (goal_handles_.count(goal_id) == 0) {
+      auto goal_handle_it = goal_handles_.find(goal_id);
+      if (goal_handle_it == goal_handles_.end()) {
         RCLCPP_DEBUG(
           this->get_logger(),
           "Received status for unknown goal. Ignoring...");
         continue;
       }
-      typename GoalHandle::SharedPtr goal_handle = goal_handles_[goal_id].lock();
+      --goals_left;
+      typename GoalHandle::SharedPtr goal_handle = goal_handle_it->second.lock();
       // Forget about the goal if there are no more user references
       if (!goal_handle) {
         RCLCPP_DEBUG(
           this->get_logger(),
           "Dropping weak reference to goal handle during status callback");
-        goal_handles_.erase(goal_id);
+        goal_handles_.erase(goal_handle_it);
         continue;
       }
       goal_handle->set_status(status.status);
@@ -737,9 +961,18 @@ private:
           // Wrap the response in a struct with the fields a user cares about
           WrappedResult wrapped_result;
           using GoalResultResponse = typename ActionT::Impl::GetResultService::Response;
+          // Only a response taken from the middleware is owned by this callback alone;
+          // one from an intra-process server is shared with the results it keeps.
+          const bool owns_response = response.use_count() == 1;
           auto result_response = std::static_pointer_cast<GoalResultResponse>(response);
-          wrapped_result.result = std::make_shared<typename ActionT::Result>();
-          *wrapped_result.result = result_response->result;
+          if (owns_response) {
+            // Alias the result into the response instead of copying it
+            wrapped_result.result = std::shared_ptr<typename ActionT::Result>(
+              result_response, &result_response->result);
+          } else {
+            wrapped_result.result =
+              std::make_shared<typename ActionT::Result>(result_response->result);
+          }
           wrapped_result.goal_id = goal_handle->get_goal_id();
           wrapped_result.code = static_cast<ResultCode>(result_response->status);
           goal_handle->set_result(wrapped_result);
@@ -774,8 +1007,13 @@ private:
     return future;
   }
 
-  std::map<GoalUUID, typename GoalHandle::WeakPtr> goal_handles_;
+  std::unordered_map<GoalUUID, typename GoalHandle::WeakPtr> goal_handles_;
   std::mutex goal_handles_mutex_;
+
+  // Each is only used with the mutex of the pending requests of its service held.
+  GoalIntraProcess goal_intra_process_;
+  ResultIntraProcess result_intra_process_;
+  CancelIntraProcess cancel_intra_process_;
 };
 }  // namespace rclcpp_action
 
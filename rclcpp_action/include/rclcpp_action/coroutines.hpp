@@ -0,0 +1,192 @@
+// Copyright 2021 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP_ACTION__COROUTINES_HPP_
+#define RCLCPP_ACTION__COROUTINES_HPP_
+
+// Only available to the code compiled with coroutines enabled, see rclcpp/coroutines.hpp.
+#include <rclcpp/coroutines.hpp>
+
+#ifdef RCLCPP_HAS_COROUTINES
+
+#include <atomic>
+#include <chrono>
+#include <coroutine>
+#include <future>
+#include <memory>
+#include <utility>
+
+#include "rclcpp_action/client.hpp"
+
+namespace rclcpp_action
+{
+/// Awaitables of the action clients, for the coroutines of rclcpp::coroutines.
+/**
+ * The coroutines are resumed by the callbacks of the action client, on the
+ * executor thread executing its callback group.
+ */
+namespace coroutines
+{
+
+/// Awaitable acceptance of a goal, see async_send_goal().
+template<typename ActionT>
+class GoalResponseAwaiter
+{
+public:
+  using ClientT = rclcpp_action::Client<ActionT>;
+  using GoalHandle = typename ClientT::GoalHandle;
+
+  GoalResponseAwaiter(
+    typename ClientT::SharedPtr client,
+    const typename ClientT::Goal & goal,
+    const typename ClientT::SendGoalOptions & options)
+  : client_(std::move(client)), goal_(goal), options_(options)
+  {
+  }
+
+  bool
+  await_ready() const noexcept
+  {
+    return false;
+  }
+
+  void
+  await_suspend(std::coroutine_handle<> handle)
+  {
+    auto options = options_;
+    auto goal_response_callback = options.goal_response_callback;
+    // The goal response may be handled by another thread before this returns.
+    options.goal_response_callback =
+      typename ClientT::GoalResponseCallback::NewSignature(
+      [this, handle, goal_response_callback](typename GoalHandle::SharedPtr goal_handle) {
+        if (goal_response_callback) {
+          goal_response_callback(goal_handle);
+        }
+        goal_handle_ = std::move(goal_handle);
+        handle.resume();
+      });
+    client_->async_send_goal(goal_, options);
+  }
+
+  /// Return the handle of the goal, or nullptr if the goal was rejected.
+  typename GoalHandle::SharedPtr
+  await_resume()
+  {
+    return std::move(goal_handle_);
+  }
+
+private:
+  typename ClientT::SharedPtr client_;
+  typename ClientT::Goal goal_;
+  typename ClientT::SendGoalOptions options_;
+  typename GoalHandle::SharedPtr goal_handle_;
+};
+
+/// Send a goal, resuming the coroutine once it is accepted or rejected.
+/**
+ * \param[in] client the action client.
+ * \param[in] goal the goal.
+ * \param[in] options the callbacks of the goal, the goal response callback,
+ *   which must take the goal handle, is called before the coroutine is resumed.
+ */
+template<typename ActionT>
+GoalResponseAwaiter<ActionT>
+async_send_goal(
+  std::shared_ptr<rclcpp_action::Client<ActionT>> client,
+  const typename rclcpp_action::Client<ActionT>::Goal & goal,
+  const typename rclcpp_action::Client<ActionT>::SendGoalOptions & options =
+  typename rclcpp_action::Client<ActionT>::SendGoalOptions())
+{
+  return GoalResponseAwaiter<ActionT>(std::move(client), goal, options);
+}
+
+/// Awaitable result of a goal, see async_get_result().
+template<typename ActionT>
+class ResultAwaiter
+{
+public:
+  using ClientT = rclcpp_action::Client<ActionT>;
+  using GoalHandle = typename ClientT::GoalHandle;
+  using WrappedResult = typename ClientT::WrappedResult;
+
+  ResultAwaiter(typename ClientT::SharedPtr client, typename GoalHandle::SharedPtr goal_handle)
+  : client_(std::move(client)), goal_handle_(std::move(goal_handle))
+  {
+  }
+
+  bool
+  await_ready() const noexcept
+  {
+    return false;
+  }
+
+  bool
+  await_suspend(std::coroutine_handle<> handle)
+  {
+    // The result may already be known, then the callback is never called,
+    // otherwise it may be called by another thread before this returns.
+    auto resumed = std::make_shared<std::atomic<bool>>(false);
+    auto future = client_->async_get_result(
+      goal_handle_,
+      [this, handle, resumed](const WrappedResult & result) {
+        if (!resumed->exchange(true)) {
+          result_ = result;
+          handle.resume();
+        }
+      });
+    if (future.wait_for(std::chrono::seconds(0)) == std::future_status::ready &&
+      !resumed->exchange(true))
+    {
+      result_ = future.get();
+      return false;
+    }
+    return true;
+  }
+
+  /// Return the result of the goal.
+  WrappedResult
+  await_resume()
+  {
+    return std::move(result_);
+  }
+
+private:
+  typename ClientT::SharedPtr client_;
+  typename GoalHandle::SharedPtr goal_handle_;
+  WrappedResult result_;
+};
+
+/// Get the result of an accepted goal, resuming the coroutine once it is received.
+/**
+ * The result callback of the goal is replaced, see rclcpp_action::Client::async_get_result().
+ *
+ * \param[in] client the action client.
+ * \param[in] goal_handle the handle of the goal.
+ * \throws exceptions::UnknownGoalHandleError from the co_await if the goal is unknown.
+ */
+template<typename ActionT>
+ResultAwaiter<ActionT>
+async_get_result(
+  std::shared_ptr<rclcpp_action::Client<ActionT>> client,
+  typename rclcpp_action::ClientGoalHandle<ActionT>::SharedPtr goal_handle)
+{
+  return ResultAwaiter<ActionT>(std::move(client), std::move(goal_handle));
+}
+
+}  // namespace coroutines
+}  // namespace rclcpp_action
+
+#endif  // RCLCPP_HAS_COROUTINES
+
+#endif  // RCLCPP_ACTION__COROUTINES_HPP_
@@ -64,15 +64,21 @@ create_client(
       if (shared_node) {
         // API expects a shared pointer, give it one with a deleter that does nothing.
         std::shared_ptr<Client<ActionT>> fake_shared_ptr(ptr, [](Client<ActionT> *) {});
+        auto waitables = ptr->get_intra_process_waitables();
+        waitables.push_back(fake_shared_ptr);
 
         if (group_is_null) {
           // Was added to default group
-          shared_node->remove_waitable(fake_shared_ptr, nullptr);
+          for (auto & waitable : waitables) {
+            shared_node->remove_waitable(waitable, nullptr);
+          }
         } else {
           // Was added to a specific group
           auto shared_group = weak_group.lock();
           if (shared_group) {
-            shared_node->remove_waitable(fake_shared_ptr, shared_group);
+            for (auto & waitable : waitables) {
+              shared_node->remove_waitable(waitable, shared_group);
+            }
           }
         }
       }
@@ -88,6 +94,12 @@ create_client(
       options),
     deleter);
 
+  if (node_base_interface->get_use_intra_process_default()) {
+    action_client->enable_intra_process(node_base_interface, name);
+    for (auto & waitable : action_client->get_intra_process_waitables()) {
+      node_waitables_interface->add_waitable(waitable, group);
+    }
+  }
   node_waitables_interface->add_waitable(action_client, group);
   return action_client;
 }
@@ -0,0 +1,166 @@
+// Copyright 2021 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP_ACTION__GOAL_POOL_ALLOCATOR_HPP_
+#define RCLCPP_ACTION__GOAL_POOL_ALLOCATOR_HPP_
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <utility>
+#include <vector>
+
+namespace rclcpp_action
+{
+namespace detail
+{
+
+/// Blocks for the objects of a number of goals, allocated together and recycled.
+/**
+ * The size of the blocks is the size of the first allocation, which is the one
+ * of the object and its shared_ptr control block when used through
+ * std::allocate_shared().
+ * Taking and returning blocks is thread-safe and does not allocate memory
+ * once the blocks are allocated.
+ */
+class GoalPool
+{
+public:
+  explicit GoalPool(size_t block_count)
+  : block_count_(block_count)
+  {
+    free_blocks_.reserve(block_count_);
+  }
+
+  /// Return a free block of size bytes, or null if there is none.
+  void *
+  allocate(size_t size)
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (0u == block_size_ && 0u != block_count_) {
+      constexpr size_t alignment = alignof(std::max_align_t);
+      block_size_ = (size + alignment - 1) / alignment * alignment;
+      storage_.resize(block_count_ * block_size_ / alignment);
+      auto first = reinterpret_cast<unsigned char *>(storage_.data());
+      for (size_t i = block_count_; i > 0; --i) {
+        free_blocks_.push_back(first + (i - 1) * block_size_);
+      }
+    }
+    if (size > block_size_ || free_blocks_.empty()) {
+      return nullptr;
+    }
+    void * block = free_blocks_.back();
+    free_blocks_.pop_back();
+    return block;
+  }
+
+  /// Give back a block, return false if the memory is not a block of the pool.
+  bool
+  deallocate(void * pointer)
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto first = reinterpret_cast<unsigned char *>(storage_.data());
+    auto address = static_cast<unsigned char *>(pointer);
+    if (address < first || address >= first + block_count_ * block_size_) {
+      return false;
+    }
+    free_blocks_.push_back(pointer);
+    return true;
+  }
+
+  size_t
+  get_block_count() const
+  {
+    return block_count_;
+  }
+
+private:
+  const size_t block_count_;
+  size_t block_size_ = 0u;
+  std::vector<std::max_align_t> storage_;
+  std::vector<void *> free_blocks_;
+  std::mutex mutex_;
+};
+
+/// Allocator taking memory from a GoalPool, falling back to the global operator new.
+/**
+ * All the copies of an allocator, including the rebound ones, share its pool,
+ * which is kept alive by the objects allocated from it.
+ */
+template<typename T>
+class GoalPoolAllocator
+{
+public:
+  using value_type = T;
+
+  explicit GoalPoolAllocator(std::shared_ptr<GoalPool> pool)
+  : pool_(std::move(pool))
+  {}
+
+  template<typename U>
+  GoalPoolAllocator(const GoalPoolAllocator<U> & other) noexcept  // NOLINT
+  : pool_(other.get_pool())
+  {}
+
+  T *
+  allocate(size_t n)
+  {
+    void * pointer = nullptr;
+    if (alignof(T) <= alignof(std::max_align_t)) {
+      pointer = pool_->allocate(n * sizeof(T));
+    }
+    if (nullptr == pointer) {
+      pointer = ::operator new(n * sizeof(T));
+    }
+    return static_cast<T *>(pointer);
+  }
+
+  void
+  deallocate(T * pointer, size_t n)
+  {
+    (void)n;
+    if (!pool_->deallocate(pointer)) {
+      ::operator delete(pointer);
+    }
+  }
+
+  const std::shared_ptr<GoalPool> &
+  get_pool() const
+  {
+    return pool_;
+  }
+
+  template<typename U>
+  bool
+  operator==(const GoalPoolAllocator<U> & other) const
+  {
+    return pool_ == other.get_pool();
+  }
+
+  template<typename U>
+  bool
+  operator!=(const GoalPoolAllocator<U> & other) const
+  {
+    return pool_ != other.get_pool();
+  }
+
+private:
+  std::shared_ptr<GoalPool> pool_;
+};
+
+}  // namespace detail
+}  // namespace rclcpp_action
+
+#endif  // RCLCPP_ACTION__GOAL_POOL_ALLOCATOR_HPP_
@@ -18,18 +18,24 @@
 #include <rcl_action/action_server.h>
 #include <rosidl_runtime_c/action_type_support_struct.h>
 #include <rosidl_typesupport_cpp/action_type_support.hpp>
+#include <rclcpp/expand_topic_or_service_name.hpp>
+#include <rclcpp/experimental/service_intra_process.hpp>
+#include <rclcpp/experimental/service_intra_process_base.hpp>
 #include <rclcpp/node_interfaces/node_base_interface.hpp>
 #include <rclcpp/node_interfaces/node_clock_interface.hpp>
 #include <rclcpp/node_interfaces/node_logging_interface.hpp>
 #include <rclcpp/waitable.hpp>
 
+#include <chrono>
 #include <functional>
 #include <memory>
 #include <mutex>
 #include <string>
 #include <unordered_map>
 #include <utility>
+#include <vector>
 
+#include "rclcpp_action/goal_pool_allocator.hpp"
 #include "rclcpp_action/visibility_control.hpp"
 #include "rclcpp_action/server_goal_handle.hpp"
 #include "rclcpp_action/types.hpp"
@@ -131,6 +137,79 @@ public:
   // End Waitables API
   // -----------------
 
+  /// Coalesce the updates of the status of the goals over a period.
+  /**
+   * The status of all the goals is published whenever a goal changes state.
+   * With a period greater than 0, the changes happening within a period are
+   * published together, at most once per period and not at all while no goal
+   * changes state, so servers with many goals do not publish the whole status
+   * array on every transition.
+   * The period is measured with the steady clock.
+   * With a period of 0, the default, the status is published on every change.
+   *
+   * \param[in] period minimum time between two publications of the status.
+   * \throws std::invalid_argument if the period is negative.
+   */
+  RCLCPP_ACTION_PUBLIC
+  void
+  set_status_publish_period(std::chrono::nanoseconds period);
+
+  /// Return the period over which the updates of the status are coalesced.
+  RCLCPP_ACTION_PUBLIC
+  std::chrono::nanoseconds
+  get_status_publish_period() const;
+
+  /// Throttle the feedback of each goal to at most one message per period.
+  /**
+   * With a period greater than 0, the feedback published for a goal less than
+   * a period after its last published feedback is not published right away.
+   * The latest of these messages is kept, and is published by the next call
+   * after the period elapsed, or before the result when the goal reaches a
+   * terminal state; the messages it replaces are dropped.
+   * The period is measured with the steady clock.
+   * With a period of 0, the default, all the feedback is published.
+   *
+   * \param[in] period minimum time between two feedback messages of a goal.
+   * \throws std::invalid_argument if the period is negative.
+   */
+  RCLCPP_ACTION_PUBLIC
+  void
+  set_feedback_publish_period(std::chrono::nanoseconds period);
+
+  /// Return the minimum time between two feedback messages of a goal.
+  RCLCPP_ACTION_PUBLIC
+  std::chrono::nanoseconds
+  get_feedback_publish_period() const;
+
+  /// Preallocate the objects of a number of goals, so that accepting goals allocates less.
+  /**
+   * The goal handles given to the user and the ones of rcl_action are then
+   * allocated from pools of blocks for that many goals, given back when the
+   * goals are released, and the maps keeping the goals are reserved for that
+   * many goals.
+   * Goals beyond that number are allocated as before.
+   * Call it before the server accepts goals.
+   *
+   * \param[in] number_of_goals goals active at the same time to allocate for,
+   *   0 to stop pooling, the default.
+   */
+  RCLCPP_ACTION_PUBLIC
+  void
+  set_goal_pool_size(size_t number_of_goals);
+
+  /// Return the number of goals the objects of which are pooled.
+  RCLCPP_ACTION_PUBLIC
+  size_t
+  get_goal_pool_size() const;
+
+  /// Return the waitables executing the requests of intra-process clients.
+  /**
+   * \return the waitables, which are empty unless intra-process communication is enabled.
+   */
+  RCLCPP_ACTION_PUBLIC
+  std::vector<rclcpp::Waitable::SharedPtr>
+  get_intra_process_waitables() const;
+
 protected:
   RCLCPP_ACTION_PUBLIC
   ServerBase(
@@ -141,9 +220,65 @@ protected:
     const rosidl_action_type_support_t * type_support,
     const rcl_action_server_options_t & options);
 
+  /// Register the services through which intra-process clients send their requests.
+  /// \internal
+  RCLCPP_ACTION_PUBLIC
+  void
+  setup_intra_process(
+    std::vector<rclcpp::experimental::ServiceIntraProcessBase::SharedPtr> services,
+    rclcpp::Context::SharedPtr context);
+
+  /// Handle a goal request, taken from the middleware or given by an intra-process client.
+  /// \internal
+  RCLCPP_ACTION_PUBLIC
+  void
+  handle_goal_request(const rmw_request_id_t & request_header, std::shared_ptr<void> message);
+
+  /// Handle a cancel request, taken from the middleware or given by an intra-process client.
+  /// \internal
+  RCLCPP_ACTION_PUBLIC
+  void
+  handle_cancel_request(const rmw_request_id_t & request_header, std::shared_ptr<void> message);
+
+  /// Handle a result request, taken from the middleware or given by an intra-process client.
+  /// \internal
+  RCLCPP_ACTION_PUBLIC
+  void
+  handle_result_request(const rmw_request_id_t & request_header, std::shared_ptr<void> message);
+
   // -----------------------------------------------------
   // API for communication between ServerBase and Server<>
 
+  // ServerBase will call these functions to give the responses to the requests of intra-process
+  // clients, which the subclass passes to its typed intra-process services.
+  /// \internal
+  RCLCPP_ACTION_PUBLIC
+  virtual
+  void
+  send_intra_process_goal_response(
+    const rmw_request_id_t & request_header, std::shared_ptr<void> response) = 0;
+
+  /// \internal
+  RCLCPP_ACTION_PUBLIC
+  virtual
+  void
+  send_intra_process_cancel_response(
+    const rmw_request_id_t & request_header, std::shared_ptr<void> response) = 0;
+
+  /// \internal
+  RCLCPP_ACTION_PUBLIC
+  virtual
+  void
+  send_intra_process_result_response(
+    const rmw_request_id_t & request_header, std::shared_ptr<void> response) = 0;
+
+  /// Pool the goal handles of the derived server and reserve its map of goals.
+  /// \internal
+  RCLCPP_ACTION_PUBLIC
+  virtual
+  void
+  reserve_goal_handles(size_t number_of_goals) = 0;
+
   // ServerBase will call this function when a goal request is received.
   // The subclass should convert to the real type and call a user's callback.
   /// \internal
@@ -225,6 +360,12 @@ protected:
   void
   publish_feedback(std::shared_ptr<void> feedback_msg);
 
+  /// Publish the feedback of a goal, throttled to the feedback publish period.
+  /// \internal
+  RCLCPP_ACTION_PUBLIC
+  void
+  publish_feedback(const GoalUUID & uuid, std::shared_ptr<void> feedback_msg);
+
   // End API for communication between ServerBase and Server<>
   // ---------------------------------------------------------
 
@@ -253,6 +394,18 @@ private:
   void
   execute_check_expired_goals();
 
+  /// Publish the status changes coalesced since the status timer last fired
+  /// \internal
+  RCLCPP_ACTION_PUBLIC
+  void
+  execute_publish_coalesced_status();
+
+  /// Send a result response through the middleware or to an intra-process client
+  /// \internal
+  RCLCPP_ACTION_PUBLIC
+  void
+  send_result_response(const rmw_request_id_t & request_header, std::shared_ptr<void> response);
+
   /// Private implementation
   /// \internal
   std::unique_ptr<ServerBaseImpl> pimpl_;
@@ -333,10 +486,101 @@ public:
 
   virtual ~Server() = default;
 
+  /// Give the requests of intra-process clients to the server without the middleware.
+  /**
+   * The goal, cancel and result requests of the action clients of the same
+   * action in the same context, which enabled intra-process communication as
+   * well, are then given to the server by pointer, and so are the responses.
+   * The feedback and the status are still published through the middleware.
+   *
+   * This is called by rclcpp_action::create_server(), before the server is
+   * added to its callback group.
+   *
+   * \param[in] node_base the node of the server, whose context is used.
+   * \param[in] name the name of the action, as given to the constructor.
+   */
+  void
+  enable_intra_process(
+    rclcpp::node_interfaces::NodeBaseInterface::SharedPtr node_base,
+    const std::string & name)
+  {
+    const std::string action_name = rclcpp::expand_topic_or_service_name(
+      name, node_base->get_name(), node_base->get_namespace(), true);
+    auto context = node_base->get_context();
+    std::weak_ptr<Server> weak_this = this->shared_from_this();
+
+    goal_service_intra_process_ = std::make_shared<GoalServiceIntraProcess>(
+      context, action_name + "/_action/send_goal",
+      [weak_this](
+        std::shared_ptr<rmw_request_id_t> request_header,
+        typename GoalServiceIntraProcess::SharedRequest request)
+      {
+        auto server = weak_this.lock();
+        if (server) {
+          server->handle_goal_request(*request_header, std::move(request));
+        }
+      });
+    cancel_service_intra_process_ = std::make_shared<CancelServiceIntraProcess>(
+      context, action_name + "/_action/cancel_goal",
+      [weak_this](
+        std::shared_ptr<rmw_request_id_t> request_header,
+        typename CancelServiceIntraProcess::SharedRequest request)
+      {
+        auto server = weak_this.lock();
+        if (server) {
+          server->handle_cancel_request(*request_header, std::move(request));
+        }
+      });
+    result_service_intra_process_ = std::make_shared<ResultServiceIntraProcess>(
+      context, action_name + "/_action/get_result",
+      [weak_this](
+        std::shared_ptr<rmw_request_id_t> request_header,
+        typename ResultServiceIntraProcess::SharedRequest request)
+      {
+        auto server = weak_this.lock();
+        if (server) {
+          server->handle_result_request(*request_header, std::move(request));
+        }
+      });
+    this->setup_intra_process(
+      {goal_service_intra_process_, cancel_service_intra_process_, result_service_intra_process_},
+      context);
+  }
+
 protected:
   // -----------------------------------------------------
   // API for communication between ServerBase and Server<>
 
+  /// \internal
+  void
+  send_intra_process_goal_response(
+    const rmw_request_id_t & request_header, std::shared_ptr<void> response) override
+  {
+    goal_service_intra_process_->send_response(
+      request_header,
+      std::static_pointer_cast<typename ActionT::Impl::SendGoalService::Response>(response));
+  }
+
+  /// \internal
+  void
+  send_intra_process_cancel_response(
+    const rmw_request_id_t & request_header, std::shared_ptr<void> response) override
+  {
+    cancel_service_intra_process_->send_response(
+      request_header,
+      std::static_pointer_cast<typename ActionT::Impl::CancelGoalService::Response>(response));
+  }
+
+  /// \internal
+  void
+  send_intra_process_result_response(
+    const rmw_request_id_t & request_header, std::shared_ptr<void> response) override
+  {
+    result_service_intra_process_->send_response(
+      request_header,
+      std::static_pointer_cast<typename ActionT::Impl::GetResultService::Response>(response));
+  }
+
   /// \internal
   std::pair<GoalResponse, std::shared_ptr<void>>
   call_handle_goal_callback(GoalUUID & uuid, std::shared_ptr<void> message) override
@@ -422,21 +666,30 @@ protected:
       };
 
     std::function<void(std::shared_ptr<typename ActionT::Impl::FeedbackMessage>)> publish_feedback =
-      [weak_this](std::shared_ptr<typename ActionT::Impl::FeedbackMessage> feedback_msg)
+      [weak_this, uuid](std::shared_ptr<typename ActionT::Impl::FeedbackMessage> feedback_msg)
       {
         std::shared_ptr<Server<ActionT>> shared_this = weak_this.lock();
         if (!shared_this) {
           return;
         }
-        shared_this->publish_feedback(std::static_pointer_cast<void>(feedback_msg));
+        shared_this->publish_feedback(uuid, std::static_pointer_cast<void>(feedback_msg));
       };
 
     auto request = std::static_pointer_cast<
       const typename ActionT::Impl::SendGoalService::Request>(goal_request_message);
     auto goal = std::shared_ptr<const typename ActionT::Goal>(request, &request->goal);
-    goal_handle.reset(
-      new ServerGoalHandle<ActionT>(
-        rcl_goal_handle, uuid, goal, on_terminal_state, on_executing, publish_feedback));
+    auto pool = std::atomic_load(&goal_handle_pool_);
+    if (pool) {
+      goal_handle = std::allocate_shared<PooledGoalHandle>(
+        detail::GoalPoolAllocator<PooledGoalHandle>(pool),
+        std::move(rcl_goal_handle), uuid, std::move(goal), std::move(on_terminal_state),
+        std::move(on_executing), std::move(publish_feedback));
+    } else {
+      goal_handle.reset(
+        new ServerGoalHandle<ActionT>(
+          std::move(rcl_goal_handle), uuid, std::move(goal), std::move(on_terminal_state),
+          std::move(on_executing), std::move(publish_feedback)));
+    }
     {
       std::lock_guard<std::mutex> lock(goal_handles_mutex_);
       goal_handles_[uuid] = goal_handle;
@@ -444,6 +697,19 @@ protected:
     handle_accepted_(goal_handle);
   }
 
+  /// \internal
+  void
+  reserve_goal_handles(size_t number_of_goals) override
+  {
+    std::shared_ptr<detail::GoalPool> pool;
+    if (0u != number_of_goals) {
+      pool = std::make_shared<detail::GoalPool>(number_of_goals);
+    }
+    std::atomic_store(&goal_handle_pool_, pool);
+    std::lock_guard<std::mutex> lock(goal_handles_mutex_);
+    goal_handles_.reserve(number_of_goals);
+  }
+
   /// \internal
   GoalUUID
   get_goal_id_from_goal_request(void * message) override
@@ -487,15 +753,39 @@ protected:
   // ---------------------------------------------------------
 
 private:
+  using GoalServiceIntraProcess = rclcpp::experimental::ServiceIntraProcess<
+    typename ActionT::Impl::SendGoalService>;
+  using CancelServiceIntraProcess = rclcpp::experimental::ServiceIntraProcess<
+    typename ActionT::Impl::CancelGoalService>;
+  using ResultServiceIntraProcess = rclcpp::experimental::ServiceIntraProcess<
+    typename ActionT::Impl::GetResultService>;
+
   GoalCallback handle_goal_;
   CancelCallback handle_cancel_;
   AcceptedCallback handle_accepted_;
 
+  typename GoalServiceIntraProcess::SharedPtr goal_service_intra_process_;
+  typename CancelServiceIntraProcess::SharedPtr cancel_service_intra_process_;
+  typename ResultServiceIntraProcess::SharedPtr result_service_intra_process_;
+
   using GoalHandleWeakPtr = std::weak_ptr<ServerGoalHandle<ActionT>>;
   /// A map of goal id to goal handle weak pointers.
   /// This is used to provide a goal handle to handle_cancel.
   std::unordered_map<GoalUUID, GoalHandleWeakPtr> goal_handles_;
   std::mutex goal_handles_mutex_;
+
+  /// Goal handle constructible by std::allocate_shared(), to allocate it from a pool.
+  struct PooledGoalHandle : public ServerGoalHandle<ActionT>
+  {
+    template<typename ... Args>
+    explicit PooledGoalHandle(Args && ... args)
+    : ServerGoalHandle<ActionT>(std::forward<Args>(args)...)
+    {
+    }
+  };
+
+  // Blocks for the goal handles, while a goal pool size is set
+  std::shared_ptr<detail::GoalPool> goal_handle_pool_;
 };
 }  // namespace rclcpp_action
 #endif  // RCLCPP_ACTION__SERVER_HPP_
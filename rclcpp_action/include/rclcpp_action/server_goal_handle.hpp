@@ -23,6 +23,7 @@
 #include <functional>
 #include <memory>
 #include <mutex>
+#include <utility>
 
 #include "rclcpp_action/visibility_control.hpp"
 #include "rclcpp_action/types.hpp"
@@ -261,9 +262,9 @@ protected:
     std::function<void(const GoalUUID &)> on_executing,
     std::function<void(std::shared_ptr<typename ActionT::Impl::FeedbackMessage>)> publish_feedback
   )
-  : ServerGoalHandleBase(rcl_handle), goal_(goal), uuid_(uuid),
-    on_terminal_state_(on_terminal_state), on_executing_(on_executing),
-    publish_feedback_(publish_feedback)
+  : ServerGoalHandleBase(std::move(rcl_handle)), goal_(std::move(goal)), uuid_(uuid),
+    on_terminal_state_(std::move(on_terminal_state)), on_executing_(std::move(on_executing)),
+    publish_feedback_(std::move(publish_feedback))
   {
   }
 
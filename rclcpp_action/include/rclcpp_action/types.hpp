@@ -20,7 +20,6 @@
 #include <action_msgs/msg/goal_status.hpp>
 #include <action_msgs/msg/goal_info.hpp>
 
-#include <climits>
 #include <functional>
 #include <string>
 
@@ -68,14 +67,11 @@ struct hash<rclcpp_action::GoalUUID>
 {
   size_t operator()(const rclcpp_action::GoalUUID & uuid) const noexcept
   {
-    // TODO(sloretz) Use someone else's hash function and cite it
+    // Combine the bytes as boost::hash_combine does, so that every byte affects every bit.
+    // XOR-ing the bytes alone only gave 256 distinct hashes, colliding in hashed containers.
     size_t result = 0;
     for (size_t i = 0; i < uuid.size(); ++i) {
-      for (size_t b = 0; b < sizeof(size_t); ++b) {
-        size_t part = uuid[i];
-        part <<= CHAR_BIT * b;
-        result ^= part;
-      }
+      result ^= static_cast<size_t>(uuid[i]) + 0x9e3779b9 + (result << 6) + (result >> 2);
     }
     return result;
   }
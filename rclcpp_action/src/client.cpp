@@ -14,20 +14,51 @@
 
 #include <rcl_action/action_client.h>
 #include <rcl_action/wait.h>
+#include <rclcpp/detail/resolve_rcl_entity_name.hpp>
+#include <rclcpp/experimental/intra_process_manager.hpp>
 #include <rclcpp/node_interfaces/node_base_interface.hpp>
 #include <rclcpp/node_interfaces/node_logging_interface.hpp>
 
 #include <algorithm>
+#include <atomic>
 #include <map>
 #include <memory>
 #include <random>
 #include <string>
 #include <tuple>
 #include <utility>
+#include <vector>
 
 #include "rclcpp_action/client.hpp"
 #include "rclcpp_action/exceptions.hpp"
 
+namespace
+{
+/// Return true if nothing but the given pointer refers to the buffer, so it can be taken into.
+template<typename T>
+bool
+is_reusable(const std::shared_ptr<T> & buffer)
+{
+  if (!buffer || buffer.use_count() != 1) {
+    return false;
+  }
+  // Synchronize with the release of the other references, possibly by another thread.
+  std::atomic_thread_fence(std::memory_order_acquire);
+  return true;
+}
+
+/// Return the buffer if it can be reused, or replace it with a new one.
+template<typename T, typename CreateT>
+std::shared_ptr<T>
+reuse_or_create(std::shared_ptr<T> & buffer, CreateT && create)
+{
+  if (!is_reusable(buffer)) {
+    buffer = create();
+  }
+  return buffer;
+}
+}  // namespace
+
 namespace rclcpp_action
 {
 
@@ -67,9 +98,11 @@ public:
         delete client;
       });
     *client_handle = rcl_action_get_zero_initialized_client();
+    const std::string rcl_action_name =
+      rclcpp::detail::resolve_rcl_entity_name(*node_base, action_name, false);
     rcl_ret_t ret = rcl_action_client_init(
       client_handle.get(), node_handle.get(), type_support,
-      action_name.c_str(), &client_options);
+      rcl_action_name.c_str(), &client_options);
     if (RCL_RET_OK != ret) {
       rclcpp::exceptions::throw_from_rcl_error(
         ret, "could not initialize rcl action client");
@@ -100,6 +133,31 @@ public:
   bool is_cancel_response_ready{false};
   bool is_result_response_ready{false};
 
+  std::atomic<bool> latest_feedback_only{false};
+  // Feedback messages taken at most at once, so a fast server cannot stall the executor
+  static constexpr size_t max_feedback_messages_taken = 64;
+
+  // Buffers of the takes, reused once the executor and the user callbacks released them.
+  // Result and cancel responses are handed to the user, so only their envelope is reused.
+  using FeedbackData = std::tuple<rcl_ret_t, std::vector<std::shared_ptr<void>>>;
+  using StatusData = std::tuple<rcl_ret_t, std::shared_ptr<void>>;
+  using ResponseData = std::tuple<rcl_ret_t, rmw_request_id_t, std::shared_ptr<void>>;
+  std::shared_ptr<FeedbackData> feedback_data;
+  std::shared_ptr<StatusData> status_data;
+  std::shared_ptr<ResponseData> goal_response_data;
+  std::shared_ptr<ResponseData> result_response_data;
+  std::shared_ptr<ResponseData> cancel_response_data;
+  // Up to max_feedback_messages_taken feedback messages, for the latest of each goal
+  std::vector<std::shared_ptr<void>> feedback_messages;
+  std::shared_ptr<void> status_message;
+  std::shared_ptr<void> goal_response;
+
+  // Clients receiving the responses of intra-process servers, when enabled
+  std::vector<rclcpp::experimental::ClientIntraProcessBase::SharedPtr> intra_process_clients;
+  std::weak_ptr<rclcpp::experimental::IntraProcessManager> weak_ipm;
+  // Intra-process requests have negative sequence numbers, never used by the middleware
+  std::atomic<int64_t> intra_process_sequence_number{0};
+
   rclcpp::Context::SharedPtr context_;
   rclcpp::node_interfaces::NodeGraphInterface::WeakPtr node_graph_;
   // node_handle must be destroyed after client_handle to prevent memory leak
@@ -120,6 +178,23 @@ public:
 
   std::independent_bits_engine<
     std::default_random_engine, 8, unsigned int> random_bytes_generator;
+
+  /// Return a feedback message no longer referred to, or a new one if none is.
+  template<typename CreateT>
+  std::shared_ptr<void>
+  get_feedback_message(CreateT && create)
+  {
+    for (const auto & feedback_message : feedback_messages) {
+      if (is_reusable(feedback_message)) {
+        return feedback_message;
+      }
+    }
+    std::shared_ptr<void> feedback_message = create();
+    if (feedback_messages.size() < max_feedback_messages_taken) {
+      feedback_messages.push_back(feedback_message);
+    }
+    return feedback_message;
+  }
 };
 
 ClientBase::ClientBase(
@@ -162,58 +237,15 @@ ClientBase::action_server_is_ready() const
 bool
 ClientBase::wait_for_action_server_nanoseconds(std::chrono::nanoseconds timeout)
 {
-  auto start = std::chrono::steady_clock::now();
-  // make an event to reuse, rather than create a new one each time
   auto node_ptr = pimpl_->node_graph_.lock();
   if (!node_ptr) {
     throw rclcpp::exceptions::InvalidNodeError();
   }
-  // check to see if the server is ready immediately
-  if (this->action_server_is_ready()) {
-    return true;
-  }
-  auto event = node_ptr->get_graph_event();
-  if (timeout == std::chrono::nanoseconds(0)) {
-    // check was non-blocking, return immediately
-    return false;
-  }
-  // update the time even on the first loop to account for time spent in the first call
-  // to this->server_is_ready()
-  std::chrono::nanoseconds time_to_wait =
-    timeout > std::chrono::nanoseconds(0) ?
-    timeout - (std::chrono::steady_clock::now() - start) :
-    std::chrono::nanoseconds::max();
-  if (time_to_wait < std::chrono::nanoseconds(0)) {
-    // Do not allow the time_to_wait to become negative when timeout was originally positive.
-    // Setting time_to_wait to 0 will allow one non-blocking wait because of the do-while.
-    time_to_wait = std::chrono::nanoseconds(0);
-  }
-  do {
-    if (!rclcpp::ok(this->pimpl_->context_)) {
-      return false;
-    }
-    // Limit each wait to 100ms to workaround an issue specific to the Connext RMW implementation.
-    // A race condition means that graph changes for services becoming available may trigger the
-    // wait set to wake up, but then not be reported as ready immediately after the wake up
-    // (see https://github.com/ros2/rmw_connext/issues/201)
-    // If no other graph events occur, the wait set will not be triggered again until the timeout
-    // has been reached, despite the service being available, so we artificially limit the wait
-    // time to limit the delay.
-    node_ptr->wait_for_graph_change(
-      event, std::min(time_to_wait, std::chrono::nanoseconds(RCL_MS_TO_NS(100))));
-    // Because of the aforementioned race condition, we check if the service is ready even if the
-    // graph event wasn't triggered.
-    event->check_and_clear();
-    if (this->action_server_is_ready()) {
-      return true;
-    }
-    // server is not ready, loop if there is time left
-    if (timeout > std::chrono::nanoseconds(0)) {
-      time_to_wait = timeout - (std::chrono::steady_clock::now() - start);
-    }
-    // if timeout is negative, time_to_wait will never reach zero
-  } while (time_to_wait > std::chrono::nanoseconds(0));
-  return false;  // timeout exceeded while waiting for the server to be ready
+  // The graph listener checks whether the server is ready on each graph change, so that this
+  // thread is only woken up once it is, instead of on every change of the graph.
+  return node_ptr->wait_for_graph_predicate(
+    [this]() {return this->action_server_is_ready();},
+    timeout);
 }
 
 rclcpp::Logger
@@ -301,11 +333,13 @@ void
 ClientBase::send_goal_request(std::shared_ptr<void> request, ResponseCallback callback)
 {
   std::unique_lock<std::mutex> guard(pimpl_->goal_requests_mutex);
-  int64_t sequence_number;
-  rcl_ret_t ret = rcl_action_send_goal_request(
-    pimpl_->client_handle.get(), request.get(), &sequence_number);
-  if (RCL_RET_OK != ret) {
-    rclcpp::exceptions::throw_from_rcl_error(ret, "failed to send goal request");
+  int64_t sequence_number = pimpl_->intra_process_sequence_number.fetch_sub(1) - 1;
+  if (!send_intra_process_goal_request(sequence_number, request)) {
+    rcl_ret_t ret = rcl_action_send_goal_request(
+      pimpl_->client_handle.get(), request.get(), &sequence_number);
+    if (RCL_RET_OK != ret) {
+      rclcpp::exceptions::throw_from_rcl_error(ret, "failed to send goal request");
+    }
   }
   assert(pimpl_->pending_goal_responses.count(sequence_number) == 0);
   pimpl_->pending_goal_responses[sequence_number] = callback;
@@ -322,7 +356,7 @@ ClientBase::handle_result_response(
     RCLCPP_ERROR(pimpl_->logger, "unknown result response, ignoring...");
     return;
   }
-  pimpl_->pending_result_responses[sequence_number](response);
+  pimpl_->pending_result_responses[sequence_number](std::move(response));
   pimpl_->pending_result_responses.erase(sequence_number);
 }
 
@@ -330,11 +364,13 @@ void
 ClientBase::send_result_request(std::shared_ptr<void> request, ResponseCallback callback)
 {
   std::lock_guard<std::mutex> guard(pimpl_->result_requests_mutex);
-  int64_t sequence_number;
-  rcl_ret_t ret = rcl_action_send_result_request(
-    pimpl_->client_handle.get(), request.get(), &sequence_number);
-  if (RCL_RET_OK != ret) {
-    rclcpp::exceptions::throw_from_rcl_error(ret, "failed to send result request");
+  int64_t sequence_number = pimpl_->intra_process_sequence_number.fetch_sub(1) - 1;
+  if (!send_intra_process_result_request(sequence_number, request)) {
+    rcl_ret_t ret = rcl_action_send_result_request(
+      pimpl_->client_handle.get(), request.get(), &sequence_number);
+    if (RCL_RET_OK != ret) {
+      rclcpp::exceptions::throw_from_rcl_error(ret, "failed to send result request");
+    }
   }
   assert(pimpl_->pending_result_responses.count(sequence_number) == 0);
   pimpl_->pending_result_responses[sequence_number] = callback;
@@ -359,11 +395,13 @@ void
 ClientBase::send_cancel_request(std::shared_ptr<void> request, ResponseCallback callback)
 {
   std::lock_guard<std::mutex> guard(pimpl_->cancel_requests_mutex);
-  int64_t sequence_number;
-  rcl_ret_t ret = rcl_action_send_cancel_request(
-    pimpl_->client_handle.get(), request.get(), &sequence_number);
-  if (RCL_RET_OK != ret) {
-    rclcpp::exceptions::throw_from_rcl_error(ret, "failed to send cancel request");
+  int64_t sequence_number = pimpl_->intra_process_sequence_number.fetch_sub(1) - 1;
+  if (!send_intra_process_cancel_request(sequence_number, request)) {
+    rcl_ret_t ret = rcl_action_send_cancel_request(
+      pimpl_->client_handle.get(), request.get(), &sequence_number);
+    if (RCL_RET_OK != ret) {
+      rclcpp::exceptions::throw_from_rcl_error(ret, "failed to send cancel request");
+    }
   }
   assert(pimpl_->pending_cancel_responses.count(sequence_number) == 0);
   pimpl_->pending_cancel_responses[sequence_number] = callback;
@@ -383,47 +421,135 @@ ClientBase::generate_goal_id()
   return goal_id;
 }
 
+std::vector<rclcpp::Waitable::SharedPtr>
+ClientBase::get_intra_process_waitables() const
+{
+  return std::vector<rclcpp::Waitable::SharedPtr>(
+    pimpl_->intra_process_clients.begin(), pimpl_->intra_process_clients.end());
+}
+
+void
+ClientBase::setup_intra_process(
+  std::vector<rclcpp::experimental::ClientIntraProcessBase::SharedPtr> clients,
+  rclcpp::Context::SharedPtr context)
+{
+  using rclcpp::experimental::IntraProcessManager;
+  pimpl_->weak_ipm = context->get_sub_context<IntraProcessManager>();
+  pimpl_->intra_process_clients = std::move(clients);
+}
+
+rclcpp::experimental::ServiceIntraProcessBase::SharedPtr
+ClientBase::find_intra_process_service(const std::string & service_name) const
+{
+  auto ipm = pimpl_->weak_ipm.lock();
+  if (!ipm) {
+    return nullptr;
+  }
+  return ipm->find_service_intra_process(service_name);
+}
+
+void
+ClientBase::set_latest_feedback_only(bool latest_feedback_only)
+{
+  pimpl_->latest_feedback_only.store(latest_feedback_only);
+}
+
+bool
+ClientBase::get_latest_feedback_only() const
+{
+  return pimpl_->latest_feedback_only.load();
+}
+
+void
+ClientBase::take_latest_feedback(std::vector<std::shared_ptr<void>> & feedback_messages)
+{
+  std::vector<GoalUUID> goal_ids;
+  goal_ids.push_back(get_goal_id_from_feedback_message(feedback_messages.front().get()));
+  for (size_t taken = 1; taken < pimpl_->max_feedback_messages_taken; ++taken) {
+    std::shared_ptr<void> feedback_message = pimpl_->get_feedback_message(
+      [this]() {return this->create_feedback_message();});
+    rcl_ret_t ret = rcl_action_take_feedback(
+      pimpl_->client_handle.get(), feedback_message.get());
+    if (RCL_RET_ACTION_CLIENT_TAKE_FAILED == ret) {
+      rcl_reset_error();
+      break;
+    } else if (RCL_RET_OK != ret) {
+      rclcpp::exceptions::throw_from_rcl_error(ret, "error taking feedback");
+    }
+    // A newer message of a goal replaces the one already taken.
+    GoalUUID goal_id = get_goal_id_from_feedback_message(feedback_message.get());
+    auto it = std::find(goal_ids.begin(), goal_ids.end(), goal_id);
+    if (it != goal_ids.end()) {
+      feedback_messages[it - goal_ids.begin()] = std::move(feedback_message);
+    } else {
+      goal_ids.push_back(goal_id);
+      feedback_messages.push_back(std::move(feedback_message));
+    }
+  }
+}
+
 std::shared_ptr<void>
 ClientBase::take_data()
 {
   if (pimpl_->is_feedback_ready) {
-    std::shared_ptr<void> feedback_message = this->create_feedback_message();
+    auto data = reuse_or_create(
+      pimpl_->feedback_data, []() {return std::make_shared<ClientBaseImpl::FeedbackData>();});
+    // Release the messages of the previous take, so they can be taken into again
+    std::vector<std::shared_ptr<void>> & feedback_messages = std::get<1>(*data);
+    feedback_messages.clear();
+    std::shared_ptr<void> feedback_message = pimpl_->get_feedback_message(
+      [this]() {return this->create_feedback_message();});
     rcl_ret_t ret = rcl_action_take_feedback(
       pimpl_->client_handle.get(), feedback_message.get());
-    return std::static_pointer_cast<void>(
-      std::make_shared<std::tuple<rcl_ret_t, std::shared_ptr<void>>>(
-        ret, feedback_message));
+    if (RCL_RET_OK == ret) {
+      feedback_messages.push_back(std::move(feedback_message));
+      if (pimpl_->latest_feedback_only.load()) {
+        take_latest_feedback(feedback_messages);
+      }
+    }
+    std::get<0>(*data) = ret;
+    return std::static_pointer_cast<void>(data);
   } else if (pimpl_->is_status_ready) {
-    std::shared_ptr<void> status_message = this->create_status_message();
+    auto data = reuse_or_create(
+      pimpl_->status_data, []() {return std::make_shared<ClientBaseImpl::StatusData>();});
+    std::get<1>(*data).reset();
+    std::shared_ptr<void> status_message = reuse_or_create(
+      pimpl_->status_message, [this]() {return this->create_status_message();});
     rcl_ret_t ret = rcl_action_take_status(
       pimpl_->client_handle.get(), status_message.get());
-    return std::static_pointer_cast<void>(
-      std::make_shared<std::tuple<rcl_ret_t, std::shared_ptr<void>>>(
-        ret, status_message));
+    *data = std::make_tuple(ret, std::move(status_message));
+    return std::static_pointer_cast<void>(data);
   } else if (pimpl_->is_goal_response_ready) {
+    auto data = reuse_or_create(
+      pimpl_->goal_response_data, []() {return std::make_shared<ClientBaseImpl::ResponseData>();});
+    std::get<2>(*data).reset();
     rmw_request_id_t response_header;
-    std::shared_ptr<void> goal_response = this->create_goal_response();
+    std::shared_ptr<void> goal_response = reuse_or_create(
+      pimpl_->goal_response, [this]() {return this->create_goal_response();});
     rcl_ret_t ret = rcl_action_take_goal_response(
       pimpl_->client_handle.get(), &response_header, goal_response.get());
-    return std::static_pointer_cast<void>(
-      std::make_shared<std::tuple<rcl_ret_t, rmw_request_id_t, std::shared_ptr<void>>>(
-        ret, response_header, goal_response));
+    *data = std::make_tuple(ret, response_header, std::move(goal_response));
+    return std::static_pointer_cast<void>(data);
   } else if (pimpl_->is_result_response_ready) {
+    auto data = reuse_or_create(
+      pimpl_->result_response_data,
+      []() {return std::make_shared<ClientBaseImpl::ResponseData>();});
     rmw_request_id_t response_header;
     std::shared_ptr<void> result_response = this->create_result_response();
     rcl_ret_t ret = rcl_action_take_result_response(
       pimpl_->client_handle.get(), &response_header, result_response.get());
-    return std::static_pointer_cast<void>(
-      std::make_shared<std::tuple<rcl_ret_t, rmw_request_id_t, std::shared_ptr<void>>>(
-        ret, response_header, result_response));
+    *data = std::make_tuple(ret, response_header, std::move(result_response));
+    return std::static_pointer_cast<void>(data);
   } else if (pimpl_->is_cancel_response_ready) {
+    auto data = reuse_or_create(
+      pimpl_->cancel_response_data,
+      []() {return std::make_shared<ClientBaseImpl::ResponseData>();});
     rmw_request_id_t response_header;
     std::shared_ptr<void> cancel_response = this->create_cancel_response();
     rcl_ret_t ret = rcl_action_take_cancel_response(
       pimpl_->client_handle.get(), &response_header, cancel_response.get());
-    return std::static_pointer_cast<void>(
-      std::make_shared<std::tuple<rcl_ret_t, rmw_request_id_t, std::shared_ptr<void>>>(
-        ret, response_header, cancel_response));
+    *data = std::make_tuple(ret, response_header, std::move(cancel_response));
+    return std::static_pointer_cast<void>(data);
   } else {
     throw std::runtime_error("Taking data from action client but nothing is ready");
   }
@@ -437,12 +563,14 @@ ClientBase::execute(std::shared_ptr<void> & data)
   }
 
   if (pimpl_->is_feedback_ready) {
-    auto shared_ptr = std::static_pointer_cast<std::tuple<rcl_ret_t, std::shared_ptr<void>>>(data);
+    auto shared_ptr = std::static_pointer_cast<
+      std::tuple<rcl_ret_t, std::vector<std::shared_ptr<void>>>>(data);
     auto ret = std::get<0>(*shared_ptr);
     pimpl_->is_feedback_ready = false;
     if (RCL_RET_OK == ret) {
-      auto feedback_message = std::get<1>(*shared_ptr);
-      this->handle_feedback_message(feedback_message);
+      for (auto & feedback_message : std::get<1>(*shared_ptr)) {
+        this->handle_feedback_message(feedback_message);
+      }
     } else if (RCL_RET_ACTION_CLIENT_TAKE_FAILED != ret) {
       rclcpp::exceptions::throw_from_rcl_error(ret, "error taking feedback");
     }
@@ -475,8 +603,9 @@ ClientBase::execute(std::shared_ptr<void> & data)
     pimpl_->is_result_response_ready = false;
     if (RCL_RET_OK == ret) {
       auto response_header = std::get<1>(*shared_ptr);
-      auto result_response = std::get<2>(*shared_ptr);
-      this->handle_result_response(response_header, result_response);
+      // Hand the response over, so the result callback can alias the result instead of copying it
+      auto result_response = std::move(std::get<2>(*shared_ptr));
+      this->handle_result_response(response_header, std::move(result_response));
     } else if (RCL_RET_ACTION_CLIENT_TAKE_FAILED != ret) {
       rclcpp::exceptions::throw_from_rcl_error(ret, "error taking result response");
     }
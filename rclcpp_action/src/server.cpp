@@ -12,6 +12,8 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <rcl/guard_condition.h>
+#include <rcl/timer.h>
 #include <rcl_action/action_server.h>
 #include <rcl_action/wait.h>
 
@@ -19,11 +21,18 @@
 
 #include <action_msgs/msg/goal_status_array.hpp>
 #include <action_msgs/srv/cancel_goal.hpp>
+#include <rclcpp/detail/resolve_rcl_entity_name.hpp>
 #include <rclcpp/exceptions.hpp>
+#include <rclcpp/experimental/intra_process_manager.hpp>
 #include <rclcpp_action/server.hpp>
 
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <iterator>
 #include <memory>
 #include <mutex>
+#include <stdexcept>
 #include <string>
 #include <tuple>
 #include <unordered_map>
@@ -33,6 +42,64 @@
 using rclcpp_action::ServerBase;
 using rclcpp_action::GoalUUID;
 
+namespace
+{
+/// Return true if the request was given by an intra-process client.
+bool
+is_intra_process_request(const rmw_request_id_t & request_header)
+{
+  return std::all_of(
+    std::begin(request_header.writer_guid), std::end(request_header.writer_guid),
+    [](int8_t byte) {return 0 == byte;});
+}
+
+void
+finalize_goal_handle(rcl_action_goal_handle_t * goal_handle)
+{
+  rcl_ret_t ret = rcl_action_goal_handle_fini(goal_handle);
+  if (RCL_RET_OK != ret) {
+    RCLCPP_DEBUG(
+      rclcpp::get_logger("rclcpp_action"),
+      "failed to fini rcl_action_goal_handle_t in deleter");
+  }
+}
+
+/// rcl goal handle finalized with its owner, so that it can be made by std::allocate_shared().
+struct OwnedGoalHandle
+{
+  ~OwnedGoalHandle()
+  {
+    finalize_goal_handle(&goal_handle);
+  }
+
+  rcl_action_goal_handle_t goal_handle = rcl_action_get_zero_initialized_goal_handle();
+};
+
+/// Return true if nothing but the given pointer refers to the buffer, so it can be taken into.
+template<typename T>
+bool
+is_reusable(const std::shared_ptr<T> & buffer)
+{
+  if (!buffer || buffer.use_count() != 1) {
+    return false;
+  }
+  // Synchronize with the release of the other references, possibly by another thread.
+  std::atomic_thread_fence(std::memory_order_acquire);
+  return true;
+}
+
+/// Return the buffer if it can be reused, or replace it with a new one.
+template<typename T, typename CreateT>
+std::shared_ptr<T>
+reuse_or_create(std::shared_ptr<T> & buffer, CreateT && create)
+{
+  if (!is_reusable(buffer)) {
+    buffer = create();
+  }
+  return buffer;
+}
+}  // namespace
+
 namespace rclcpp_action
 {
 class ServerBaseImpl
@@ -65,15 +132,88 @@ public:
   std::atomic<bool> result_request_ready_{false};
   std::atomic<bool> goal_expired_{false};
 
-  // Lock for unordered_maps
-  std::recursive_mutex unordered_map_mutex_;
+  // The bookkeeping of a share of the goals, so that the goals handled by different
+  // threads rarely wait for each other.
+  struct GoalShard
+  {
+    // Lock for the unordered_maps of the shard
+    std::mutex mutex_;
+
+    // Results to be kept until the goal expires after reaching a terminal state
+    std::unordered_map<GoalUUID, std::shared_ptr<void>> goal_results_;
+    // Requests for results are kept until a result becomes available
+    std::unordered_map<GoalUUID, std::vector<rmw_request_id_t>> result_requests_;
+    // rcl goal handles are kept so api to send result doesn't try to access freed memory
+    std::unordered_map<GoalUUID, std::shared_ptr<rcl_action_goal_handle_t>> goal_handles_;
+    // Throttling of the feedback of the goals, while a feedback publish period is set
+    struct FeedbackThrottle
+    {
+      std::chrono::steady_clock::time_point last_published_;
+      // Latest feedback not published yet
+      std::shared_ptr<void> pending_;
+    };
+    std::unordered_map<GoalUUID, FeedbackThrottle> feedback_throttles_;
+  };
 
-  // Results to be kept until the goal expires after reaching a terminal state
-  std::unordered_map<GoalUUID, std::shared_ptr<void>> goal_results_;
-  // Requests for results are kept until a result becomes available
-  std::unordered_map<GoalUUID, std::vector<rmw_request_id_t>> result_requests_;
-  // rcl goal handles are kept so api to send result doesn't try to access freed memory
-  std::unordered_map<GoalUUID, std::shared_ptr<rcl_action_goal_handle_t>> goal_handles_;
+  static constexpr size_t num_goal_shards_ = 16;
+  std::array<GoalShard, num_goal_shards_> goal_shards_;
+
+  size_t
+  get_goal_shard_index(const GoalUUID & uuid) const
+  {
+    return std::hash<GoalUUID>()(uuid) % num_goal_shards_;
+  }
+
+  GoalShard &
+  get_goal_shard(const GoalUUID & uuid)
+  {
+    return goal_shards_[get_goal_shard_index(uuid)];
+  }
+
+  // Node of the server, to wake up the executor when the status timer is started
+  std::weak_ptr<rclcpp::node_interfaces::NodeBaseInterface> node_base_;
+
+  // Timer publishing the coalesced status updates, created with the first period set
+  std::shared_ptr<rcl_timer_t> status_timer_;
+  size_t status_timer_index_ = 0;
+  std::atomic<bool> status_timer_ready_{false};
+  std::atomic<int64_t> status_publish_period_{0};
+  // Whether a goal changed state since the status was last published
+  std::atomic<bool> status_changed_{false};
+
+  std::atomic<int64_t> feedback_publish_period_{0};
+
+  // Blocks for the rcl goal handles, while a goal pool size is set
+  std::shared_ptr<detail::GoalPool> goal_handle_pool_;
+  std::atomic<size_t> goal_pool_size_{0};
+
+  // Buffers of the takes, reused once the executor and the user callbacks released them
+  using GoalRequestData =
+    std::tuple<rcl_ret_t, rcl_action_goal_info_t, rmw_request_id_t, std::shared_ptr<void>>;
+  using CancelRequestData =
+    std::tuple<rcl_ret_t, std::shared_ptr<action_msgs::srv::CancelGoal::Request>,
+      rmw_request_id_t>;
+  using ResultRequestData = std::tuple<rcl_ret_t, std::shared_ptr<void>, rmw_request_id_t>;
+  std::shared_ptr<GoalRequestData> goal_request_data_;
+  std::shared_ptr<CancelRequestData> cancel_request_data_;
+  std::shared_ptr<ResultRequestData> result_request_data_;
+  std::shared_ptr<void> goal_request_;
+  std::shared_ptr<action_msgs::srv::CancelGoal::Request> cancel_request_;
+  std::shared_ptr<void> result_request_;
+
+  // Services executing the requests of intra-process clients, when enabled
+  std::vector<rclcpp::experimental::ServiceIntraProcessBase::SharedPtr> intra_process_services_;
+  std::vector<uint64_t> intra_process_service_ids_;
+  std::weak_ptr<rclcpp::experimental::IntraProcessManager> weak_ipm_;
+
+  void
+  publish_status_array();
+
+  void
+  create_status_timer(std::chrono::nanoseconds period);
+
+  void
+  start_status_timer();
 
   rclcpp::Logger logger_;
 };
@@ -90,6 +230,8 @@ ServerBase::ServerBase(
 : pimpl_(new ServerBaseImpl(
       node_clock->get_clock(), node_logging->get_logger().get_child("rclcpp_action")))
 {
+  pimpl_->node_base_ = node_base;
+
   auto deleter = [node_base](rcl_action_server_t * ptr)
     {
       if (nullptr != ptr) {
@@ -110,8 +252,9 @@ ServerBase::ServerBase(
   rcl_node_t * rcl_node = node_base->get_rcl_node_handle();
   rcl_clock_t * rcl_clock = pimpl_->clock_->get_clock_handle();
 
+  const std::string rcl_name = rclcpp::detail::resolve_rcl_entity_name(*node_base, name, false);
   rcl_ret_t ret = rcl_action_server_init(
-    pimpl_->action_server_.get(), rcl_node, rcl_clock, type_support, name.c_str(), &options);
+    pimpl_->action_server_.get(), rcl_node, rcl_clock, type_support, rcl_name.c_str(), &options);
 
   if (RCL_RET_OK != ret) {
     rclcpp::exceptions::throw_from_rcl_error(ret);
@@ -132,6 +275,33 @@ ServerBase::ServerBase(
 
 ServerBase::~ServerBase()
 {
+  auto ipm = pimpl_->weak_ipm_.lock();
+  if (ipm) {
+    for (uint64_t service_id : pimpl_->intra_process_service_ids_) {
+      ipm->remove_service(service_id);
+    }
+  }
+}
+
+std::vector<rclcpp::Waitable::SharedPtr>
+ServerBase::get_intra_process_waitables() const
+{
+  return std::vector<rclcpp::Waitable::SharedPtr>(
+    pimpl_->intra_process_services_.begin(), pimpl_->intra_process_services_.end());
+}
+
+void
+ServerBase::setup_intra_process(
+  std::vector<rclcpp::experimental::ServiceIntraProcessBase::SharedPtr> services,
+  rclcpp::Context::SharedPtr context)
+{
+  using rclcpp::experimental::IntraProcessManager;
+  auto ipm = context->get_sub_context<IntraProcessManager>();
+  for (const auto & service : services) {
+    pimpl_->intra_process_service_ids_.push_back(ipm->add_service(service));
+  }
+  pimpl_->weak_ipm_ = ipm;
+  pimpl_->intra_process_services_ = std::move(services);
 }
 
 size_t
@@ -143,7 +313,8 @@ ServerBase::get_number_of_ready_subscriptions()
 size_t
 ServerBase::get_number_of_ready_timers()
 {
-  return pimpl_->num_timers_;
+  std::lock_guard<std::recursive_mutex> lock(pimpl_->action_server_reentrant_mutex_);
+  return pimpl_->num_timers_ + (pimpl_->status_timer_ ? 1u : 0u);
 }
 
 size_t
@@ -170,6 +341,19 @@ ServerBase::add_to_wait_set(rcl_wait_set_t * wait_set)
   std::lock_guard<std::recursive_mutex> lock(pimpl_->action_server_reentrant_mutex_);
   rcl_ret_t ret = rcl_action_wait_set_add_action_server(
     wait_set, pimpl_->action_server_.get(), NULL);
+  if (RCL_RET_OK != ret) {
+    return false;
+  }
+  if (pimpl_->status_timer_) {
+    ret = rcl_wait_set_add_timer(
+      wait_set, pimpl_->status_timer_.get(), &pimpl_->status_timer_index_);
+    if (RCL_RET_WAIT_SET_FULL == ret) {
+      // The timer was created after the wait set was sized, it is waited for the next time.
+      rcl_reset_error();
+      pimpl_->status_timer_index_ = wait_set->size_of_timers;
+      return true;
+    }
+  }
   return RCL_RET_OK == ret;
 }
 
@@ -190,6 +374,10 @@ ServerBase::is_ready(rcl_wait_set_t * wait_set)
       &cancel_request_ready,
       &result_request_ready,
       &goal_expired);
+
+    const size_t index = pimpl_->status_timer_index_;
+    pimpl_->status_timer_ready_ = pimpl_->status_timer_ && index < wait_set->size_of_timers &&
+      wait_set->timers[index] == pimpl_->status_timer_.get();
   }
 
   pimpl_->goal_request_ready_ = goal_request_ready;
@@ -204,7 +392,8 @@ ServerBase::is_ready(rcl_wait_set_t * wait_set)
   return pimpl_->goal_request_ready_.load() ||
          pimpl_->cancel_request_ready_.load() ||
          pimpl_->result_request_ready_.load() ||
-         pimpl_->goal_expired_.load();
+         pimpl_->goal_expired_.load() ||
+         pimpl_->status_timer_ready_.load();
 }
 
 std::shared_ptr<void>
@@ -217,48 +406,58 @@ ServerBase::take_data()
 
     std::lock_guard<std::recursive_mutex> lock(pimpl_->action_server_reentrant_mutex_);
 
-    std::shared_ptr<void> message = create_goal_request();
+    auto data = reuse_or_create(
+      pimpl_->goal_request_data_,
+      []() {return std::make_shared<ServerBaseImpl::GoalRequestData>();});
+    // Release the message of the previous take, so it can be taken into again
+    std::get<3>(*data).reset();
+    // Accepted goals keep their request, which is then not reused
+    std::shared_ptr<void> message = reuse_or_create(
+      pimpl_->goal_request_, [this]() {return create_goal_request();});
     ret = rcl_action_take_goal_request(
       pimpl_->action_server_.get(),
       &request_header,
       message.get());
 
-    return std::static_pointer_cast<void>(
-      std::make_shared
-      <std::tuple<rcl_ret_t, rcl_action_goal_info_t, rmw_request_id_t, std::shared_ptr<void>>>(
-        ret,
-        goal_info,
-        request_header, message));
+    *data = std::make_tuple(ret, goal_info, request_header, std::move(message));
+    return std::static_pointer_cast<void>(data);
   } else if (pimpl_->cancel_request_ready_.load()) {
     rcl_ret_t ret;
     rmw_request_id_t request_header;
 
-    // Initialize cancel request
-    auto request = std::make_shared<action_msgs::srv::CancelGoal::Request>();
-
     std::lock_guard<std::recursive_mutex> lock(pimpl_->action_server_reentrant_mutex_);
+
+    auto data = reuse_or_create(
+      pimpl_->cancel_request_data_,
+      []() {return std::make_shared<ServerBaseImpl::CancelRequestData>();});
+    std::get<1>(*data).reset();
+    auto request = reuse_or_create(
+      pimpl_->cancel_request_,
+      []() {return std::make_shared<action_msgs::srv::CancelGoal::Request>();});
     ret = rcl_action_take_cancel_request(
       pimpl_->action_server_.get(),
       &request_header,
       request.get());
 
-    return std::static_pointer_cast<void>(
-      std::make_shared
-      <std::tuple<rcl_ret_t, std::shared_ptr<action_msgs::srv::CancelGoal::Request>,
-      rmw_request_id_t>>(ret, request, request_header));
+    *data = std::make_tuple(ret, std::move(request), request_header);
+    return std::static_pointer_cast<void>(data);
   } else if (pimpl_->result_request_ready_.load()) {
     rcl_ret_t ret;
     // Get the result request message
     rmw_request_id_t request_header;
-    std::shared_ptr<void> result_request = create_result_request();
     std::lock_guard<std::recursive_mutex> lock(pimpl_->action_server_reentrant_mutex_);
+    auto data = reuse_or_create(
+      pimpl_->result_request_data_,
+      []() {return std::make_shared<ServerBaseImpl::ResultRequestData>();});
+    std::get<1>(*data).reset();
+    std::shared_ptr<void> result_request = reuse_or_create(
+      pimpl_->result_request_, [this]() {return create_result_request();});
     ret = rcl_action_take_result_request(
       pimpl_->action_server_.get(), &request_header, result_request.get());
 
-    return std::static_pointer_cast<void>(
-      std::make_shared<std::tuple<rcl_ret_t, std::shared_ptr<void>, rmw_request_id_t>>(
-        ret, result_request, request_header));
-  } else if (pimpl_->goal_expired_.load()) {
+    *data = std::make_tuple(ret, std::move(result_request), request_header);
+    return std::static_pointer_cast<void>(data);
+  } else if (pimpl_->goal_expired_.load() || pimpl_->status_timer_ready_.load()) {
     return nullptr;
   } else {
     throw std::runtime_error("Taking data from action server but nothing is ready");
@@ -268,7 +467,7 @@ ServerBase::take_data()
 void
 ServerBase::execute(std::shared_ptr<void> & data)
 {
-  if (!data && !pimpl_->goal_expired_.load()) {
+  if (!data && !pimpl_->goal_expired_.load() && !pimpl_->status_timer_ready_.load()) {
     throw std::runtime_error("'data' is empty");
   }
 
@@ -280,6 +479,8 @@ ServerBase::execute(std::shared_ptr<void> & data)
     execute_result_request_received(data);
   } else if (pimpl_->goal_expired_.load()) {
     execute_check_expired_goals();
+  } else if (pimpl_->status_timer_ready_.load()) {
+    execute_publish_coalesced_status();
   } else {
     throw std::runtime_error("Executing action server but nothing is ready");
   }
@@ -299,7 +500,6 @@ ServerBase::execute_goal_request_received(std::shared_ptr<void> & data)
   } else if (RCL_RET_OK != ret) {
     rclcpp::exceptions::throw_from_rcl_error(ret);
   }
-  rcl_action_goal_info_t goal_info = std::get<1>(*shared_ptr);
   rmw_request_id_t request_header = std::get<2>(*shared_ptr);
   std::shared_ptr<void> message = std::get<3>(*shared_ptr);
 
@@ -308,22 +508,33 @@ ServerBase::execute_goal_request_received(std::shared_ptr<void> & data)
     return;
   }
 
+  handle_goal_request(request_header, std::move(message));
+  data.reset();
+}
+
+void
+ServerBase::handle_goal_request(
+  const rmw_request_id_t & request_header, std::shared_ptr<void> message)
+{
+  rcl_ret_t ret;
+  rcl_action_goal_info_t goal_info = rcl_action_get_zero_initialized_goal_info();
   GoalUUID uuid = get_goal_id_from_goal_request(message.get());
   convert(uuid, &goal_info);
 
   // Call user's callback, getting the user's response and a ros message to send back
   auto response_pair = call_handle_goal_callback(uuid, message);
 
-  {
+  if (is_intra_process_request(request_header)) {
+    send_intra_process_goal_response(request_header, response_pair.second);
+  } else {
     std::lock_guard<std::recursive_mutex> lock(pimpl_->action_server_reentrant_mutex_);
     ret = rcl_action_send_goal_response(
       pimpl_->action_server_.get(),
       &request_header,
       response_pair.second.get());
-  }
-
-  if (RCL_RET_OK != ret) {
-    rclcpp::exceptions::throw_from_rcl_error(ret);
+    if (RCL_RET_OK != ret) {
+      rclcpp::exceptions::throw_from_rcl_error(ret);
+    }
   }
 
   const auto status = response_pair.first;
@@ -335,12 +546,7 @@ ServerBase::execute_goal_request_received(std::shared_ptr<void> & data)
     auto deleter = [](rcl_action_goal_handle_t * ptr)
       {
         if (nullptr != ptr) {
-          rcl_ret_t fail_ret = rcl_action_goal_handle_fini(ptr);
-          if (RCL_RET_OK != fail_ret) {
-            RCLCPP_DEBUG(
-              rclcpp::get_logger("rclcpp_action"),
-              "failed to fini rcl_action_goal_handle_t in deleter");
-          }
+          finalize_goal_handle(ptr);
           delete ptr;
         }
       };
@@ -353,13 +559,22 @@ ServerBase::execute_goal_request_received(std::shared_ptr<void> & data)
       throw std::runtime_error("Failed to accept new goal\n");
     }
 
-    std::shared_ptr<rcl_action_goal_handle_t> handle(new rcl_action_goal_handle_t, deleter);
+    std::shared_ptr<rcl_action_goal_handle_t> handle;
+    auto pool = std::atomic_load(&pimpl_->goal_handle_pool_);
+    if (pool) {
+      auto owner = std::allocate_shared<OwnedGoalHandle>(
+        detail::GoalPoolAllocator<OwnedGoalHandle>(pool));
+      handle = std::shared_ptr<rcl_action_goal_handle_t>(owner, &owner->goal_handle);
+    } else {
+      handle.reset(new rcl_action_goal_handle_t, deleter);
+    }
     // Copy out goal handle since action server storage disappears when it is fini'd
     *handle = *rcl_handle;
 
     {
-      std::lock_guard<std::recursive_mutex> lock(pimpl_->unordered_map_mutex_);
-      pimpl_->goal_handles_[uuid] = handle;
+      auto & shard = pimpl_->get_goal_shard(uuid);
+      std::lock_guard<std::mutex> lock(shard.mutex_);
+      shard.goal_handles_[uuid] = handle;
     }
 
     if (GoalResponse::ACCEPT_AND_EXECUTE == status) {
@@ -375,7 +590,6 @@ ServerBase::execute_goal_request_received(std::shared_ptr<void> & data)
     // Tell user to start executing action
     call_goal_accepted_callback(handle, uuid, message);
   }
-  data.reset();
 }
 
 void
@@ -395,6 +609,15 @@ ServerBase::execute_cancel_request_received(std::shared_ptr<void> & data)
   }
   auto request = std::get<1>(*shared_ptr);
   auto request_header = std::get<2>(*shared_ptr);
+  handle_cancel_request(request_header, std::move(request));
+  data.reset();
+}
+
+void
+ServerBase::handle_cancel_request(
+  const rmw_request_id_t & request_header, std::shared_ptr<void> message)
+{
+  auto request = std::static_pointer_cast<action_msgs::srv::CancelGoal::Request>(message);
 
   // Convert c++ message to C message
   rcl_action_cancel_request_t cancel_request = rcl_action_get_zero_initialized_cancel_request();
@@ -405,6 +628,7 @@ ServerBase::execute_cancel_request_received(std::shared_ptr<void> & data)
   // Get a list of goal info that should be attempted to be cancelled
   rcl_action_cancel_response_t cancel_response = rcl_action_get_zero_initialized_cancel_response();
 
+  rcl_ret_t ret;
   {
     std::lock_guard<std::recursive_mutex> lock(pimpl_->action_server_reentrant_mutex_);
     ret = rcl_action_process_cancel_request(
@@ -455,6 +679,11 @@ ServerBase::execute_cancel_request_received(std::shared_ptr<void> & data)
     publish_status();
   }
 
+  if (is_intra_process_request(request_header)) {
+    send_intra_process_cancel_response(request_header, response);
+    return;
+  }
+
   {
     std::lock_guard<std::recursive_mutex> lock(pimpl_->action_server_reentrant_mutex_);
     ret = rcl_action_send_cancel_response(
@@ -464,7 +693,6 @@ ServerBase::execute_cancel_request_received(std::shared_ptr<void> & data)
   if (RCL_RET_OK != ret) {
     rclcpp::exceptions::throw_from_rcl_error(ret);
   }
-  data.reset();
 }
 
 void
@@ -485,6 +713,14 @@ ServerBase::execute_result_request_received(std::shared_ptr<void> & data)
   auto request_header = std::get<2>(*shared_ptr);
 
   pimpl_->result_request_ready_ = false;
+  handle_result_request(request_header, std::move(result_request));
+  data.reset();
+}
+
+void
+ServerBase::handle_result_request(
+  const rmw_request_id_t & request_header, std::shared_ptr<void> result_request)
+{
   std::shared_ptr<void> result_response;
 
   // check if the goal exists
@@ -501,92 +737,269 @@ ServerBase::execute_result_request_received(std::shared_ptr<void> & data)
     result_response = create_result_response(action_msgs::msg::GoalStatus::STATUS_UNKNOWN);
   } else {
     // Goal exists, check if a result is already available
-    std::lock_guard<std::recursive_mutex> lock(pimpl_->unordered_map_mutex_);
-    auto iter = pimpl_->goal_results_.find(uuid);
-    if (iter != pimpl_->goal_results_.end()) {
+    auto & shard = pimpl_->get_goal_shard(uuid);
+    std::lock_guard<std::mutex> lock(shard.mutex_);
+    auto iter = shard.goal_results_.find(uuid);
+    if (iter != shard.goal_results_.end()) {
       result_response = iter->second;
     } else {
       // Store the request so it can be responded to later
-      pimpl_->result_requests_[uuid].push_back(request_header);
+      shard.result_requests_[uuid].push_back(request_header);
     }
   }
 
   if (result_response) {
     // Send the result now
-    std::lock_guard<std::recursive_mutex> lock(pimpl_->action_server_reentrant_mutex_);
-    rcl_ret_t rcl_ret = rcl_action_send_result_response(
-      pimpl_->action_server_.get(), &request_header, result_response.get());
-    if (RCL_RET_OK != rcl_ret) {
-      rclcpp::exceptions::throw_from_rcl_error(rcl_ret);
-    }
+    send_result_response(request_header, result_response);
+  }
+}
+
+void
+ServerBase::send_result_response(
+  const rmw_request_id_t & request_header, std::shared_ptr<void> result_response)
+{
+  if (is_intra_process_request(request_header)) {
+    send_intra_process_result_response(request_header, std::move(result_response));
+    return;
+  }
+  std::lock_guard<std::recursive_mutex> lock(pimpl_->action_server_reentrant_mutex_);
+  rcl_ret_t rcl_ret = rcl_action_send_result_response(
+    pimpl_->action_server_.get(), &request_header, result_response.get());
+  if (RCL_RET_OK != rcl_ret) {
+    rclcpp::exceptions::throw_from_rcl_error(rcl_ret);
   }
-  data.reset();
 }
 
 void
 ServerBase::execute_check_expired_goals()
 {
-  // Allocate expecting only one goal to expire at a time
-  rcl_action_goal_info_t expired_goals[1];
-  size_t num_expired = 1;
+  // Room for all the goals of the C action server, which may expire together
+  std::vector<rcl_action_goal_info_t> expired_goals;
+  size_t num_expired = 0;
 
-  // Loop in case more than 1 goal expired
-  while (num_expired > 0u) {
+  // Loop in case more goals expired than there was room for
+  do {
     rcl_ret_t ret;
     {
       std::lock_guard<std::recursive_mutex> lock(pimpl_->action_server_reentrant_mutex_);
-      ret = rcl_action_expire_goals(pimpl_->action_server_.get(), expired_goals, 1, &num_expired);
+      rcl_action_goal_handle_t ** goal_handles = NULL;
+      size_t num_goals = 0;
+      ret = rcl_action_server_get_goal_handles(
+        pimpl_->action_server_.get(), &goal_handles, &num_goals);
+      if (RCL_RET_OK == ret) {
+        expired_goals.resize(std::max<size_t>(num_goals, 1u));
+        ret = rcl_action_expire_goals(
+          pimpl_->action_server_.get(), expired_goals.data(), expired_goals.size(), &num_expired);
+      }
     }
     if (RCL_RET_OK != ret) {
       rclcpp::exceptions::throw_from_rcl_error(ret);
-    } else if (num_expired) {
-      // A goal expired!
+    }
+
+    // Sort the expired goals by shard, to sweep each shard once
+    std::vector<std::pair<size_t, GoalUUID>> expired_uuids;
+    expired_uuids.reserve(num_expired);
+    for (size_t i = 0; i < num_expired; ++i) {
       GoalUUID uuid;
-      convert(expired_goals[0], &uuid);
+      convert(expired_goals[i], &uuid);
       RCLCPP_DEBUG(pimpl_->logger_, "Expired goal %s", to_string(uuid).c_str());
-      std::lock_guard<std::recursive_mutex> lock(pimpl_->unordered_map_mutex_);
-      pimpl_->goal_results_.erase(uuid);
-      pimpl_->result_requests_.erase(uuid);
-      pimpl_->goal_handles_.erase(uuid);
+      expired_uuids.emplace_back(pimpl_->get_goal_shard_index(uuid), uuid);
     }
-  }
+    std::sort(
+      expired_uuids.begin(), expired_uuids.end(),
+      [](const auto & a, const auto & b) {return a.first < b.first;});
+
+    auto it = expired_uuids.begin();
+    while (it != expired_uuids.end()) {
+      auto & shard = pimpl_->goal_shards_[it->first];
+      std::lock_guard<std::mutex> lock(shard.mutex_);
+      const size_t shard_index = it->first;
+      for (; it != expired_uuids.end() && it->first == shard_index; ++it) {
+        shard.goal_results_.erase(it->second);
+        shard.result_requests_.erase(it->second);
+        shard.goal_handles_.erase(it->second);
+        shard.feedback_throttles_.erase(it->second);
+      }
+    }
+  } while (num_expired > 0u && num_expired == expired_goals.size());
 }
 
 void
 ServerBase::publish_status()
 {
-  rcl_ret_t ret;
+  if (0 == pimpl_->status_publish_period_.load()) {
+    pimpl_->publish_status_array();
+    return;
+  }
+  // The status timer publishes the changes, and is stopped when it finds none.
+  pimpl_->status_changed_.store(true);
+  pimpl_->start_status_timer();
+}
 
-  // We need to hold the lock across this entire method because
-  // rcl_action_server_get_goal_handles() returns an internal pointer to the
-  // goal data.
+void
+ServerBase::execute_publish_coalesced_status()
+{
+  rcl_ret_t ret = rcl_timer_call(pimpl_->status_timer_.get());
+  if (RCL_RET_TIMER_CANCELED == ret) {
+    rcl_reset_error();
+    return;
+  } else if (RCL_RET_OK != ret) {
+    rclcpp::exceptions::throw_from_rcl_error(ret);
+  }
+  if (pimpl_->status_changed_.exchange(false)) {
+    pimpl_->publish_status_array();
+    return;
+  }
+  ret = rcl_timer_cancel(pimpl_->status_timer_.get());
+  if (RCL_RET_OK != ret) {
+    rclcpp::exceptions::throw_from_rcl_error(ret);
+  }
+  // A goal may have changed state after the check but before the timer was stopped.
+  if (pimpl_->status_changed_.load()) {
+    pimpl_->start_status_timer();
+  }
+}
+
+void
+rclcpp_action::ServerBaseImpl::start_status_timer()
+{
+  bool canceled = false;
+  rcl_ret_t ret = rcl_timer_is_canceled(status_timer_.get(), &canceled);
+  if (RCL_RET_OK != ret) {
+    rclcpp::exceptions::throw_from_rcl_error(ret);
+  }
+  if (!canceled) {
+    return;
+  }
+  // Resetting the timer makes its period start now, and uncancels it.
+  ret = rcl_timer_reset(status_timer_.get());
+  if (RCL_RET_OK != ret) {
+    rclcpp::exceptions::throw_from_rcl_error(ret);
+  }
+  // The executor may be waiting without the timer, for as long as it was stopped.
+  auto node_base = node_base_.lock();
+  if (!node_base) {
+    return;
+  }
+  auto notify_guard_condition_lock = node_base->acquire_notify_guard_condition_lock();
+  ret = rcl_trigger_guard_condition(node_base->get_notify_guard_condition());
+  if (RCL_RET_OK != ret) {
+    rclcpp::exceptions::throw_from_rcl_error(ret);
+  }
+}
+
+void
+ServerBase::set_status_publish_period(std::chrono::nanoseconds period)
+{
+  if (period < std::chrono::nanoseconds(0)) {
+    throw std::invalid_argument("the status publish period cannot be negative");
+  }
   std::lock_guard<std::recursive_mutex> lock(pimpl_->action_server_reentrant_mutex_);
+  if (period > std::chrono::nanoseconds(0)) {
+    if (!pimpl_->status_timer_) {
+      pimpl_->create_status_timer(period);
+    } else {
+      int64_t old_period = 0;
+      rcl_ret_t ret = rcl_timer_exchange_period(
+        pimpl_->status_timer_.get(), period.count(), &old_period);
+      if (RCL_RET_OK != ret) {
+        rclcpp::exceptions::throw_from_rcl_error(ret);
+      }
+    }
+  }
+  pimpl_->status_publish_period_.store(period.count());
+  // The changes waiting for the timer are published now that they are no longer coalesced.
+  if (0 == period.count() && pimpl_->status_changed_.exchange(false)) {
+    pimpl_->publish_status_array();
+  }
+}
 
-  // Get all goal handles known to C action server
-  rcl_action_goal_handle_t ** goal_handles = NULL;
-  size_t num_goals = 0;
-  ret = rcl_action_server_get_goal_handles(
-    pimpl_->action_server_.get(), &goal_handles, &num_goals);
+std::chrono::nanoseconds
+ServerBase::get_status_publish_period() const
+{
+  return std::chrono::nanoseconds(pimpl_->status_publish_period_.load());
+}
 
+void
+rclcpp_action::ServerBaseImpl::create_status_timer(std::chrono::nanoseconds period)
+{
+  auto node_base = node_base_.lock();
+  if (!node_base) {
+    throw std::runtime_error("cannot create the status timer, node is gone");
+  }
+  // The coalescing period is not affected by the time source of the node.
+  auto clock = std::make_shared<rclcpp::Clock>(RCL_STEADY_TIME);
+  auto rcl_context = node_base->get_context()->get_rcl_context();
+  std::shared_ptr<rcl_timer_t> timer(
+    new rcl_timer_t, [clock, rcl_context](rcl_timer_t * timer) mutable
+    {
+      {
+        std::lock_guard<std::mutex> clock_guard(clock->get_clock_mutex());
+        if (RCL_RET_OK != rcl_timer_fini(timer)) {
+          RCLCPP_DEBUG(
+            rclcpp::get_logger("rclcpp_action"),
+            "failed to fini the status timer in deleter");
+          rcl_reset_error();
+        }
+      }
+      delete timer;
+      // Finalize the timer before the clock and the context it uses
+      clock.reset();
+      rcl_context.reset();
+    });
+  *timer = rcl_get_zero_initialized_timer();
+  {
+    std::lock_guard<std::mutex> clock_guard(clock->get_clock_mutex());
+    rcl_ret_t ret = rcl_timer_init(
+      timer.get(), clock->get_clock_handle(), rcl_context.get(), period.count(), nullptr,
+      rcl_get_default_allocator());
+    if (RCL_RET_OK != ret) {
+      rclcpp::exceptions::throw_from_rcl_error(ret);
+    }
+  }
+  // The timer is started by the first change of the state of a goal.
+  rcl_ret_t ret = rcl_timer_cancel(timer.get());
   if (RCL_RET_OK != ret) {
     rclcpp::exceptions::throw_from_rcl_error(ret);
   }
+  status_timer_ = std::move(timer);
+}
 
-  auto status_msg = std::make_shared<action_msgs::msg::GoalStatusArray>();
-  status_msg->status_list.reserve(num_goals);
-  // Populate a c++ status message with the goals and their statuses
+void
+rclcpp_action::ServerBaseImpl::publish_status_array()
+{
+  rcl_ret_t ret;
+  size_t num_goals = 0;
   rcl_action_goal_status_array_t c_status_array =
     rcl_action_get_zero_initialized_goal_status_array();
-  ret = rcl_action_get_goal_status_array(pimpl_->action_server_.get(), &c_status_array);
-  if (RCL_RET_OK != ret) {
-    rclcpp::exceptions::throw_from_rcl_error(ret);
+  {
+    // The lock is only held while the goal data of the C action server is read,
+    // the status array is a copy of it which is converted and published unlocked.
+    std::lock_guard<std::recursive_mutex> lock(action_server_reentrant_mutex_);
+
+    // Get all goal handles known to C action server
+    rcl_action_goal_handle_t ** goal_handles = NULL;
+    ret = rcl_action_server_get_goal_handles(
+      action_server_.get(), &goal_handles, &num_goals);
+
+    if (RCL_RET_OK != ret) {
+      rclcpp::exceptions::throw_from_rcl_error(ret);
+    }
+
+    ret = rcl_action_get_goal_status_array(action_server_.get(), &c_status_array);
+    if (RCL_RET_OK != ret) {
+      rclcpp::exceptions::throw_from_rcl_error(ret);
+    }
   }
 
+  auto status_msg = std::make_shared<action_msgs::msg::GoalStatusArray>();
+  status_msg->status_list.reserve(num_goals);
+
   RCPPUTILS_SCOPE_EXIT(
   {
     ret = rcl_action_goal_status_array_fini(&c_status_array);
     if (RCL_RET_OK != ret) {
-      RCLCPP_ERROR(pimpl_->logger_, "Failed to fini status array message");
+      RCLCPP_ERROR(logger_, "Failed to fini status array message");
     }
   });
 
@@ -604,7 +1017,7 @@ ServerBase::publish_status()
   }
 
   // Publish the message through the status publisher
-  ret = rcl_action_publish_status(pimpl_->action_server_.get(), status_msg.get());
+  ret = rcl_action_publish_status(action_server_.get(), status_msg.get());
 
   if (RCL_RET_OK != ret) {
     rclcpp::exceptions::throw_from_rcl_error(ret);
@@ -627,34 +1040,41 @@ ServerBase::publish_result(const GoalUUID & uuid, std::shared_ptr<void> result_m
     throw std::runtime_error("Asked to publish result for goal that does not exist");
   }
 
+  // The latest feedback held back by the throttling is published before the result.
+  std::shared_ptr<void> pending_feedback;
   {
-    /**
-    * NOTE: There is a potential deadlock issue if both unordered_map_mutex_ and
-    * action_server_reentrant_mutex_ locked in other block scopes. Unless using
-    * std::scoped_lock, locking order must be consistent with the current.
-    *
-    * Current locking order:
-    *
-    *   1. unordered_map_mutex_
-    *   2. action_server_reentrant_mutex_
-    *
-    */
-    std::lock_guard<std::recursive_mutex> unordered_map_lock(pimpl_->unordered_map_mutex_);
-    pimpl_->goal_results_[uuid] = result_msg;
-
-    // if there are clients who already asked for the result, send it to them
-    auto iter = pimpl_->result_requests_.find(uuid);
-    if (iter != pimpl_->result_requests_.end()) {
-      std::lock_guard<std::recursive_mutex> lock(pimpl_->action_server_reentrant_mutex_);
-      for (auto & request_header : iter->second) {
-        rcl_ret_t ret = rcl_action_send_result_response(
-          pimpl_->action_server_.get(), &request_header, result_msg.get());
-        if (RCL_RET_OK != ret) {
-          rclcpp::exceptions::throw_from_rcl_error(ret);
-        }
-      }
+    auto & shard = pimpl_->get_goal_shard(uuid);
+    std::lock_guard<std::mutex> lock(shard.mutex_);
+    auto iter = shard.feedback_throttles_.find(uuid);
+    if (iter != shard.feedback_throttles_.end()) {
+      pending_feedback = std::move(iter->second.pending_);
+      shard.feedback_throttles_.erase(iter);
+    }
+  }
+  if (pending_feedback) {
+    publish_feedback(pending_feedback);
+  }
+
+  // The requests received from now on find the result, and the ones received before
+  // are taken out to be answered without holding the lock of the goal shard, so the
+  // two locks are never held together.
+  std::vector<rmw_request_id_t> result_requests;
+  {
+    auto & shard = pimpl_->get_goal_shard(uuid);
+    std::lock_guard<std::mutex> lock(shard.mutex_);
+    shard.goal_results_[uuid] = result_msg;
+
+    auto iter = shard.result_requests_.find(uuid);
+    if (iter != shard.result_requests_.end()) {
+      result_requests = std::move(iter->second);
+      shard.result_requests_.erase(iter);
     }
   }
+
+  // if there are clients who already asked for the result, send it to them
+  for (auto & request_header : result_requests) {
+    send_result_response(request_header, result_msg);
+  }
 }
 
 void
@@ -670,9 +1090,75 @@ ServerBase::notify_goal_terminal_state()
 void
 ServerBase::publish_feedback(std::shared_ptr<void> feedback_msg)
 {
-  std::lock_guard<std::recursive_mutex> lock(pimpl_->action_server_reentrant_mutex_);
+  // Publishing only uses the feedback publisher of the C action server, which is
+  // thread-safe, so the feedback of the goals executed by other threads does not
+  // wait for the executor handling requests.
   rcl_ret_t ret = rcl_action_publish_feedback(pimpl_->action_server_.get(), feedback_msg.get());
   if (RCL_RET_OK != ret) {
     rclcpp::exceptions::throw_from_rcl_error(ret, "Failed to publish feedback");
   }
 }
+
+void
+ServerBase::publish_feedback(const GoalUUID & uuid, std::shared_ptr<void> feedback_msg)
+{
+  const std::chrono::nanoseconds period(pimpl_->feedback_publish_period_.load());
+  if (period.count() > 0) {
+    const auto now = std::chrono::steady_clock::now();
+    auto & shard = pimpl_->get_goal_shard(uuid);
+    std::lock_guard<std::mutex> lock(shard.mutex_);
+    auto inserted = shard.feedback_throttles_.emplace(
+      uuid, ServerBaseImpl::GoalShard::FeedbackThrottle());
+    auto & throttle = inserted.first->second;
+    if (!inserted.second && now - throttle.last_published_ < period) {
+      throttle.pending_ = std::move(feedback_msg);
+      return;
+    }
+    throttle.last_published_ = now;
+    throttle.pending_.reset();
+  }
+  publish_feedback(std::move(feedback_msg));
+}
+
+void
+ServerBase::set_feedback_publish_period(std::chrono::nanoseconds period)
+{
+  if (period < std::chrono::nanoseconds(0)) {
+    throw std::invalid_argument("the feedback publish period cannot be negative");
+  }
+  pimpl_->feedback_publish_period_.store(period.count());
+}
+
+std::chrono::nanoseconds
+ServerBase::get_feedback_publish_period() const
+{
+  return std::chrono::nanoseconds(pimpl_->feedback_publish_period_.load());
+}
+
+void
+ServerBase::set_goal_pool_size(size_t number_of_goals)
+{
+  std::shared_ptr<detail::GoalPool> pool;
+  if (0u != number_of_goals) {
+    pool = std::make_shared<detail::GoalPool>(number_of_goals);
+  }
+  std::atomic_store(&pimpl_->goal_handle_pool_, pool);
+  pimpl_->goal_pool_size_ = number_of_goals;
+
+  // Goals spread evenly over the shards, as their ids are random
+  const size_t goals_per_shard =
+    (number_of_goals + ServerBaseImpl::num_goal_shards_ - 1) / ServerBaseImpl::num_goal_shards_;
+  for (auto & shard : pimpl_->goal_shards_) {
+    std::lock_guard<std::mutex> lock(shard.mutex_);
+    shard.goal_results_.reserve(goals_per_shard);
+    shard.result_requests_.reserve(goals_per_shard);
+    shard.goal_handles_.reserve(goals_per_shard);
+  }
+  reserve_goal_handles(number_of_goals);
+}
+
+size_t
+ServerBase::get_goal_pool_size() const
+{
+  return pimpl_->goal_pool_size_.load();
+}
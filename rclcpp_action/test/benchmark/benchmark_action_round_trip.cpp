@@ -0,0 +1,306 @@
+// Copyright 2021 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Round trips between an action client and server on different nodes, through
+// an executor and the intra-process or middleware communication, while the
+// server has a number of other goals active.
+//
+// The arguments of each benchmark are:
+// - active_goals: the number of goals accepted and kept active by the server
+//   before the measurement, which are in every status array and in the goal tables.
+// - intra_process: 0 to go through the middleware, 1 for intra-process communication.
+
+#include <chrono>
+#include <memory>
+#include <vector>
+
+#include "performance_test_fixture/performance_test_fixture.hpp"
+#include "rclcpp_action/rclcpp_action.hpp"
+#include "rclcpp/rclcpp.hpp"
+#include "test_msgs/action/fibonacci.hpp"
+
+using performance_test_fixture::PerformanceTest;
+
+using Fibonacci = test_msgs::action::Fibonacci;
+using ServerGoalHandle = rclcpp_action::ServerGoalHandle<Fibonacci>;
+using ClientGoalHandle = rclcpp_action::ClientGoalHandle<Fibonacci>;
+using GoalUUID = rclcpp_action::GoalUUID;
+
+constexpr char round_trip_action_name[] = "round_trip";
+constexpr auto round_trip_timeout = std::chrono::seconds(5);
+// Feedback messages published at once, not more than the depth of the feedback topic
+constexpr size_t feedback_burst_size = 10;
+
+namespace
+{
+
+Fibonacci::Goal
+make_goal(int order)
+{
+  Fibonacci::Goal goal;
+  goal.order = order;
+  return goal;
+}
+
+}  // namespace
+
+class ActionRoundTripPerformanceTest : public PerformanceTest
+{
+public:
+  void SetUp(benchmark::State & state)
+  {
+    rclcpp::init(0, nullptr);
+    const auto number_of_active_goals = static_cast<size_t>(state.range(0));
+    const bool intra_process = state.range(1) != 0;
+
+    auto options = rclcpp::NodeOptions()
+      .start_parameter_services(false)
+      .start_parameter_event_publisher(false)
+      .use_intra_process_comms(intra_process);
+    server_node = std::make_shared<rclcpp::Node>("server_node", "ns", options);
+    client_node = std::make_shared<rclcpp::Node>("client_node", "ns", options);
+
+    // Goals of order 0 are kept active, the others are completed right away.
+    action_server = rclcpp_action::create_server<Fibonacci>(
+      server_node, round_trip_action_name,
+      [](const GoalUUID &, std::shared_ptr<const Fibonacci::Goal>) {
+        return rclcpp_action::GoalResponse::ACCEPT_AND_EXECUTE;
+      },
+      [](std::shared_ptr<ServerGoalHandle>) {
+        return rclcpp_action::CancelResponse::ACCEPT;
+      },
+      [this](std::shared_ptr<ServerGoalHandle> goal_handle) {
+        if (goal_handle->get_goal()->order == 0) {
+          active_goal_handles.push_back(goal_handle);
+        } else if (goal_handle->get_goal()->order == 1) {
+          goal_handle->succeed(std::make_shared<Fibonacci::Result>());
+        } else {
+          measured_goal_handle = goal_handle;
+        }
+      });
+    action_client = rclcpp_action::create_client<Fibonacci>(
+      client_node, round_trip_action_name);
+
+    executor = std::make_shared<rclcpp::executors::SingleThreadedExecutor>();
+    executor->add_node(server_node);
+    executor->add_node(client_node);
+
+    if (!action_client->wait_for_action_server(round_trip_timeout)) {
+      state.SkipWithError("Action server was not available");
+    }
+    const auto active_goal = make_goal(0);
+    for (size_t i = 0; i < number_of_active_goals; ++i) {
+      if (!send_goal(active_goal)) {
+        state.SkipWithError("Active goal was not accepted");
+        break;
+      }
+    }
+
+    performance_test_fixture::PerformanceTest::SetUp(state);
+  }
+
+  void TearDown(benchmark::State & state)
+  {
+    performance_test_fixture::PerformanceTest::TearDown(state);
+
+    // Ensure proper sequencing of destruction
+    for (auto & goal_handle : active_goal_handles) {
+      goal_handle->abort(std::make_shared<Fibonacci::Result>());
+    }
+    active_goal_handles.clear();
+    client_goal_handles.clear();
+    measured_goal_handle.reset();
+    executor.reset();
+    action_client.reset();
+    action_server.reset();
+    client_node.reset();
+    server_node.reset();
+    rclcpp::shutdown();
+  }
+
+protected:
+  /// Send a goal and wait for it to be accepted, return the goal handle or null.
+  ClientGoalHandle::SharedPtr
+  send_goal(const Fibonacci::Goal & goal)
+  {
+    auto future_goal_handle = action_client->async_send_goal(goal);
+    if (rclcpp::FutureReturnCode::SUCCESS !=
+      executor->spin_until_future_complete(future_goal_handle, round_trip_timeout))
+    {
+      return nullptr;
+    }
+    auto goal_handle = future_goal_handle.get();
+    if (goal_handle) {
+      client_goal_handles.push_back(goal_handle);
+    }
+    return goal_handle;
+  }
+
+  std::shared_ptr<rclcpp::Node> server_node;
+  std::shared_ptr<rclcpp::Node> client_node;
+  std::shared_ptr<rclcpp_action::Server<Fibonacci>> action_server;
+  std::shared_ptr<rclcpp_action::Client<Fibonacci>> action_client;
+  std::shared_ptr<rclcpp::Executor> executor;
+
+  std::vector<std::shared_ptr<ServerGoalHandle>> active_goal_handles;
+  std::vector<ClientGoalHandle::SharedPtr> client_goal_handles;
+  std::shared_ptr<ServerGoalHandle> measured_goal_handle;
+};
+
+BENCHMARK_DEFINE_F(ActionRoundTripPerformanceTest, goal_to_accept)(benchmark::State & state)
+{
+  const auto goal = make_goal(1);
+
+  reset_heap_counters();
+  for (auto _ : state) {
+    // Time from sending the goal to receiving the response accepting it
+    auto future_goal_handle = action_client->async_send_goal(goal);
+    if (rclcpp::FutureReturnCode::SUCCESS !=
+      executor->spin_until_future_complete(future_goal_handle, round_trip_timeout))
+    {
+      state.SkipWithError("Goal was not accepted");
+      break;
+    }
+  }
+}
+
+BENCHMARK_DEFINE_F(ActionRoundTripPerformanceTest, goal_to_result)(benchmark::State & state)
+{
+  const auto goal = make_goal(1);
+
+  reset_heap_counters();
+  for (auto _ : state) {
+    // Time from sending the goal to receiving its result, the server succeeding when accepting it
+    auto future_goal_handle = action_client->async_send_goal(goal);
+    if (rclcpp::FutureReturnCode::SUCCESS !=
+      executor->spin_until_future_complete(future_goal_handle, round_trip_timeout))
+    {
+      state.SkipWithError("Goal was not accepted");
+      break;
+    }
+    auto future_result = action_client->async_get_result(future_goal_handle.get());
+    if (rclcpp::FutureReturnCode::SUCCESS !=
+      executor->spin_until_future_complete(future_result, round_trip_timeout))
+    {
+      state.SkipWithError("Result was not received");
+      break;
+    }
+    if (rclcpp_action::ResultCode::SUCCEEDED != future_result.get().code) {
+      state.SkipWithError("Goal did not succeed");
+      break;
+    }
+  }
+}
+
+BENCHMARK_DEFINE_F(ActionRoundTripPerformanceTest, cancel_goal)(benchmark::State & state)
+{
+  const auto goal = make_goal(2);
+
+  reset_heap_counters();
+  for (auto _ : state) {
+    state.PauseTiming();
+    auto goal_handle = send_goal(goal);
+    if (!goal_handle) {
+      state.SkipWithError("Goal was not accepted");
+      break;
+    }
+    state.ResumeTiming();
+
+    auto future_cancel = action_client->async_cancel_goal(goal_handle);
+    if (rclcpp::FutureReturnCode::SUCCESS !=
+      executor->spin_until_future_complete(future_cancel, round_trip_timeout))
+    {
+      state.SkipWithError("Cancel response was not received");
+      break;
+    }
+
+    state.PauseTiming();
+    if (future_cancel.get()->goals_canceling.size() != 1u) {
+      state.SkipWithError("Goal was not canceled");
+      break;
+    }
+    // Terminate the goal, so that the goal tables only hold the active goals
+    measured_goal_handle->canceled(std::make_shared<Fibonacci::Result>());
+    measured_goal_handle.reset();
+    client_goal_handles.pop_back();
+    state.ResumeTiming();
+  }
+}
+
+BENCHMARK_DEFINE_F(ActionRoundTripPerformanceTest, feedback)(benchmark::State & state)
+{
+  size_t received_feedback = 0;
+  auto send_goal_options = rclcpp_action::Client<Fibonacci>::SendGoalOptions();
+  send_goal_options.feedback_callback =
+    [&received_feedback](ClientGoalHandle::SharedPtr, std::shared_ptr<const Fibonacci::Feedback>)
+    {
+      ++received_feedback;
+    };
+  auto future_goal_handle = action_client->async_send_goal(make_goal(2), send_goal_options);
+  if (rclcpp::FutureReturnCode::SUCCESS !=
+    executor->spin_until_future_complete(future_goal_handle, round_trip_timeout))
+  {
+    state.SkipWithError("Goal was not accepted");
+    return;
+  }
+  client_goal_handles.push_back(future_goal_handle.get());
+  auto feedback = std::make_shared<Fibonacci::Feedback>();
+  feedback->sequence = {0, 1, 1, 2, 3, 5, 8, 13};
+
+  reset_heap_counters();
+  for (auto _ : state) {
+    // Time from publishing a burst of feedback to receiving all of it
+    received_feedback = 0;
+    for (size_t i = 0; i < feedback_burst_size; ++i) {
+      measured_goal_handle->publish_feedback(feedback);
+    }
+    const auto deadline = std::chrono::steady_clock::now() + round_trip_timeout;
+    while (received_feedback < feedback_burst_size && std::chrono::steady_clock::now() < deadline) {
+      executor->spin_once(round_trip_timeout);
+    }
+    if (received_feedback < feedback_burst_size) {
+      state.SkipWithError("Feedback was not received");
+      break;
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(feedback_burst_size));
+  measured_goal_handle->succeed(std::make_shared<Fibonacci::Result>());
+}
+
+static void
+RoundTripArguments(benchmark::internal::Benchmark * benchmark)
+{
+  benchmark->ArgNames({"active_goals", "intra_process"});
+  for (int64_t active_goals : {0, 1, 10, 100, 1000}) {
+    for (int64_t intra_process : {0, 1}) {
+      benchmark->Args({active_goals, intra_process});
+    }
+  }
+}
+
+BENCHMARK_REGISTER_F(ActionRoundTripPerformanceTest, goal_to_accept)
+->Apply(RoundTripArguments)
+->UseRealTime();
+
+BENCHMARK_REGISTER_F(ActionRoundTripPerformanceTest, goal_to_result)
+->Apply(RoundTripArguments)
+->UseRealTime();
+
+BENCHMARK_REGISTER_F(ActionRoundTripPerformanceTest, cancel_goal)
+->Apply(RoundTripArguments)
+->UseRealTime();
+
+BENCHMARK_REGISTER_F(ActionRoundTripPerformanceTest, feedback)
+->Apply(RoundTripArguments)
+->UseRealTime();
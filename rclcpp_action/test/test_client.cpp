@@ -36,6 +36,7 @@
 #include <future>
 #include <map>
 #include <memory>
+#include <set>
 #include <string>
 #include <utility>
 #include <thread>
@@ -628,6 +629,75 @@ TEST_F(TestClientAgainstServer, async_send_goal_with_feedback_callback_wait_for_
   EXPECT_EQ(5, feedback_count);
 }
 
+TEST_F(TestClientAgainstServer, async_send_goal_reuses_released_feedback)
+{
+  auto action_client = rclcpp_action::create_client<ActionType>(client_node, action_name);
+  ASSERT_TRUE(action_client->wait_for_action_server(WAIT_FOR_SERVER_TIMEOUT));
+
+  ActionGoal goal;
+  goal.order = 4;
+  int feedback_count = 0;
+  std::set<const ActionFeedback *> feedback_addresses;
+  auto send_goal_ops = rclcpp_action::Client<ActionType>::SendGoalOptions();
+  send_goal_ops.feedback_callback =
+    [&feedback_count, &feedback_addresses](
+    typename ActionGoalHandle::SharedPtr goal_handle,
+    const std::shared_ptr<const ActionFeedback> feedback)
+    {
+      (void)goal_handle;
+      feedback_addresses.insert(feedback.get());
+      feedback_count++;
+    };
+  auto future_goal_handle = action_client->async_send_goal(goal, send_goal_ops);
+  dual_spin_until_future_complete(future_goal_handle);
+  auto goal_handle = future_goal_handle.get();
+  auto future_result = action_client->async_get_result(goal_handle);
+  dual_spin_until_future_complete(future_result);
+  auto wrapped_result = future_result.get();
+
+  ASSERT_EQ(5u, wrapped_result.result->sequence.size());
+  EXPECT_EQ(5, feedback_count);
+  // The feedback not kept by the callback is taken into again, instead of a new message
+  EXPECT_LT(feedback_addresses.size(), static_cast<size_t>(feedback_count));
+}
+
+TEST_F(TestClientAgainstServer, async_send_goal_with_latest_feedback_only)
+{
+  auto action_client = rclcpp_action::create_client<ActionType>(client_node, action_name);
+  ASSERT_TRUE(action_client->wait_for_action_server(WAIT_FOR_SERVER_TIMEOUT));
+  EXPECT_FALSE(action_client->get_latest_feedback_only());
+  action_client->set_latest_feedback_only(true);
+  EXPECT_TRUE(action_client->get_latest_feedback_only());
+
+  ActionGoal goal;
+  goal.order = 4;
+  int feedback_count = 0;
+  std::shared_ptr<const ActionFeedback> last_feedback;
+  auto send_goal_ops = rclcpp_action::Client<ActionType>::SendGoalOptions();
+  send_goal_ops.feedback_callback =
+    [&feedback_count, &last_feedback](
+    typename ActionGoalHandle::SharedPtr goal_handle,
+    const std::shared_ptr<const ActionFeedback> feedback)
+    {
+      (void)goal_handle;
+      last_feedback = feedback;
+      feedback_count++;
+    };
+  auto future_goal_handle = action_client->async_send_goal(goal, send_goal_ops);
+  dual_spin_until_future_complete(future_goal_handle);
+  auto goal_handle = future_goal_handle.get();
+  auto future_result = action_client->async_get_result(goal_handle);
+  dual_spin_until_future_complete(future_result);
+  auto wrapped_result = future_result.get();
+
+  ASSERT_EQ(5u, wrapped_result.result->sequence.size());
+  // The feedback superseded while the client was behind may be dropped, never the latest
+  EXPECT_LE(1, feedback_count);
+  EXPECT_GE(5, feedback_count);
+  ASSERT_TRUE(last_feedback);
+  EXPECT_EQ(wrapped_result.result->sequence, last_feedback->sequence);
+}
+
 TEST_F(TestClientAgainstServer, async_send_goal_with_result_callback_wait_for_result)
 {
   auto action_client = rclcpp_action::create_client<ActionType>(client_node, action_name);
@@ -21,10 +21,12 @@
 #include <gtest/gtest.h>
 
 #include <memory>
+#include <thread>
 #include <vector>
 
 #include "rcl_action/action_server.h"
 #include "rcl_action/wait.h"
+#include "rclcpp_action/create_client.hpp"
 #include "rclcpp_action/create_server.hpp"
 #include "rclcpp_action/server.hpp"
 #include "./mocking_utils/patch.hpp"
@@ -516,6 +518,71 @@ TEST_F(TestServer, publish_status_accepted)
   }
 }
 
+TEST_F(TestServer, publish_status_coalesced)
+{
+  auto node = std::make_shared<rclcpp::Node>(
+    "status_coalesced_node", "/rclcpp_action/status_coalesced");
+  const GoalUUID uuid{{1, 2, 3, 4, 5, 6, 7, 8, 9, 100, 110, 120, 13, 14, 15, 17}};
+
+  auto handle_goal = [](
+    const GoalUUID &, std::shared_ptr<const Fibonacci::Goal>)
+    {
+      return rclcpp_action::GoalResponse::ACCEPT_AND_EXECUTE;
+    };
+
+  using GoalHandle = rclcpp_action::ServerGoalHandle<Fibonacci>;
+
+  auto handle_cancel = [](std::shared_ptr<GoalHandle>)
+    {
+      return rclcpp_action::CancelResponse::REJECT;
+    };
+
+  std::shared_ptr<GoalHandle> received_handle;
+  auto handle_accepted = [&received_handle](std::shared_ptr<GoalHandle> handle)
+    {
+      received_handle = handle;
+    };
+
+  auto as = rclcpp_action::create_server<Fibonacci>(
+    node, "fibonacci",
+    handle_goal,
+    handle_cancel,
+    handle_accepted);
+
+  EXPECT_EQ(std::chrono::nanoseconds(0), as->get_status_publish_period());
+  EXPECT_THROW(
+    as->set_status_publish_period(std::chrono::nanoseconds(-1)), std::invalid_argument);
+  as->set_status_publish_period(std::chrono::seconds(1));
+  EXPECT_EQ(std::chrono::seconds(1), as->get_status_publish_period());
+
+  // Subscribe to status messages
+  std::vector<action_msgs::msg::GoalStatusArray::SharedPtr> received_msgs;
+  auto subscriber = node->create_subscription<action_msgs::msg::GoalStatusArray>(
+    "fibonacci/_action/status", 10,
+    [&received_msgs](action_msgs::msg::GoalStatusArray::SharedPtr list)
+    {
+      received_msgs.push_back(list);
+    });
+
+  send_goal_request(node, uuid);
+  ASSERT_TRUE(received_handle);
+  // Accepted, executing and succeeded are published together
+  received_handle->succeed(std::make_shared<Fibonacci::Result>());
+
+  // 10 seconds
+  const size_t max_tries = 10 * 1000 / 100;
+  for (size_t retry = 0; retry < max_tries && received_msgs.empty(); ++retry) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    rclcpp::spin_some(node);
+  }
+
+  ASSERT_EQ(1u, received_msgs.size());
+  ASSERT_EQ(1u, received_msgs[0]->status_list.size());
+  EXPECT_EQ(uuid, received_msgs[0]->status_list.at(0).goal_info.goal_id.uuid);
+  EXPECT_EQ(
+    action_msgs::msg::GoalStatus::STATUS_SUCCEEDED, received_msgs[0]->status_list.at(0).status);
+}
+
 TEST_F(TestServer, publish_status_canceling)
 {
   auto node = std::make_shared<rclcpp::Node>("status_cancel_node", "/rclcpp_action/status_cancel");
@@ -689,6 +756,64 @@ TEST_F(TestServer, publish_status_succeeded)
   EXPECT_EQ(uuid, msg->status_list.at(0).goal_info.goal_id.uuid);
 }
 
+TEST_F(TestServer, goal_pool)
+{
+  auto node = std::make_shared<rclcpp::Node>("goal_pool", "/rclcpp_action/goal_pool");
+
+  auto handle_goal = [](
+    const GoalUUID &, std::shared_ptr<const Fibonacci::Goal>)
+    {
+      return rclcpp_action::GoalResponse::ACCEPT_AND_EXECUTE;
+    };
+
+  using GoalHandle = rclcpp_action::ServerGoalHandle<Fibonacci>;
+
+  auto handle_cancel = [](std::shared_ptr<GoalHandle>)
+    {
+      return rclcpp_action::CancelResponse::REJECT;
+    };
+
+  std::vector<std::shared_ptr<GoalHandle>> received_handles;
+  auto handle_accepted = [&received_handles](std::shared_ptr<GoalHandle> handle)
+    {
+      received_handles.push_back(handle);
+    };
+
+  auto as = rclcpp_action::create_server<Fibonacci>(
+    node, "fibonacci",
+    handle_goal,
+    handle_cancel,
+    handle_accepted);
+  EXPECT_EQ(0u, as->get_goal_pool_size());
+  as->set_goal_pool_size(2u);
+  EXPECT_EQ(2u, as->get_goal_pool_size());
+
+  // Goals beyond the size of the pool are allocated as well
+  for (uint8_t i = 1; i <= 3; ++i) {
+    send_goal_request(node, GoalUUID{{i, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16}});
+  }
+  ASSERT_EQ(3u, received_handles.size());
+  EXPECT_NE(received_handles[0], received_handles[1]);
+  EXPECT_NE(received_handles[1], received_handles[2]);
+
+  // The handle of a released goal is reused by the next goal
+  const GoalHandle * released_handle = received_handles[0].get();
+  received_handles[0]->succeed(std::make_shared<Fibonacci::Result>());
+  received_handles.erase(received_handles.begin());
+  send_goal_request(node, GoalUUID{{4, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16}});
+  ASSERT_EQ(3u, received_handles.size());
+  EXPECT_EQ(released_handle, received_handles.back().get());
+  EXPECT_EQ(
+    GoalUUID({{4, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16}}),
+    received_handles.back()->get_goal_id());
+
+  for (auto & handle : received_handles) {
+    handle->succeed(std::make_shared<Fibonacci::Result>());
+  }
+  as->set_goal_pool_size(0u);
+  EXPECT_EQ(0u, as->get_goal_pool_size());
+}
+
 TEST_F(TestServer, publish_status_aborted)
 {
   auto node = std::make_shared<rclcpp::Node>("status_aborted", "/rclcpp_action/status_aborted");
@@ -804,6 +929,207 @@ TEST_F(TestServer, publish_feedback)
   ASSERT_EQ(sent_message->sequence, msg->feedback.sequence);
 }
 
+TEST_F(TestServer, publish_feedback_throttled)
+{
+  auto node = std::make_shared<rclcpp::Node>(
+    "pub_feedback_throttled", "/rclcpp_action/pub_feedback_throttled");
+  const GoalUUID uuid{{1, 20, 30, 4, 5, 6, 70, 8, 9, 1, 11, 120, 13, 14, 15, 161}};
+
+  auto handle_goal = [](
+    const GoalUUID &, std::shared_ptr<const Fibonacci::Goal>)
+    {
+      return rclcpp_action::GoalResponse::ACCEPT_AND_EXECUTE;
+    };
+
+  using GoalHandle = rclcpp_action::ServerGoalHandle<Fibonacci>;
+
+  auto handle_cancel = [](std::shared_ptr<GoalHandle>)
+    {
+      return rclcpp_action::CancelResponse::REJECT;
+    };
+
+  std::shared_ptr<GoalHandle> received_handle;
+  auto handle_accepted = [&received_handle](std::shared_ptr<GoalHandle> handle)
+    {
+      received_handle = handle;
+    };
+
+  auto as = rclcpp_action::create_server<Fibonacci>(
+    node, "fibonacci",
+    handle_goal,
+    handle_cancel,
+    handle_accepted);
+
+  EXPECT_EQ(std::chrono::nanoseconds(0), as->get_feedback_publish_period());
+  EXPECT_THROW(
+    as->set_feedback_publish_period(std::chrono::nanoseconds(-1)), std::invalid_argument);
+  as->set_feedback_publish_period(std::chrono::seconds(60));
+  EXPECT_EQ(std::chrono::seconds(60), as->get_feedback_publish_period());
+
+  // Subscribe to feedback messages
+  using FeedbackT = Fibonacci::Impl::FeedbackMessage;
+  std::vector<FeedbackT::SharedPtr> received_msgs;
+  auto subscriber = node->create_subscription<FeedbackT>(
+    "fibonacci/_action/feedback", 10, [&received_msgs](FeedbackT::SharedPtr msg)
+    {
+      received_msgs.push_back(msg);
+    });
+
+  send_goal_request(node, uuid);
+
+  // The first feedback is published, the second is replaced by the third
+  for (int32_t i = 1; i <= 3; ++i) {
+    auto sent_message = std::make_shared<Fibonacci::Feedback>();
+    sent_message->sequence = {i};
+    received_handle->publish_feedback(sent_message);
+  }
+  // The latest feedback is published before the result
+  received_handle->succeed(std::make_shared<Fibonacci::Result>());
+
+  // 10 seconds
+  const size_t max_tries = 10 * 1000 / 100;
+  for (size_t retry = 0; retry < max_tries && received_msgs.size() < 2u; ++retry) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    rclcpp::spin_some(node);
+  }
+
+  ASSERT_EQ(2u, received_msgs.size());
+  EXPECT_EQ(std::vector<int32_t>({1}), received_msgs[0]->feedback.sequence);
+  EXPECT_EQ(std::vector<int32_t>({3}), received_msgs[1]->feedback.sequence);
+}
+
+TEST_F(TestServer, intra_process_goal_and_result)
+{
+  auto node = std::make_shared<rclcpp::Node>(
+    "intra_process_action", "/rclcpp_action/intra_process_action",
+    rclcpp::NodeOptions().use_intra_process_comms(true));
+
+  using GoalHandle = rclcpp_action::ServerGoalHandle<Fibonacci>;
+  std::shared_ptr<GoalHandle> received_handle;
+  auto as = rclcpp_action::create_server<Fibonacci>(
+    node, "fibonacci",
+    [](const GoalUUID &, std::shared_ptr<const Fibonacci::Goal>) {
+      return rclcpp_action::GoalResponse::ACCEPT_AND_EXECUTE;
+    },
+    [](std::shared_ptr<GoalHandle>) {
+      return rclcpp_action::CancelResponse::ACCEPT;
+    },
+    [&received_handle](std::shared_ptr<GoalHandle> handle) {
+      received_handle = handle;
+    });
+  auto ac = rclcpp_action::create_client<Fibonacci>(node, "fibonacci");
+  EXPECT_EQ(3u, as->get_intra_process_waitables().size());
+  EXPECT_EQ(3u, ac->get_intra_process_waitables().size());
+
+  // The responses do not go through the middleware
+  auto goal_mock = mocking_utils::patch_and_return(
+    "lib:rclcpp_action", rcl_action_send_goal_response, RCL_RET_ERROR);
+  auto result_mock = mocking_utils::patch_and_return(
+    "lib:rclcpp_action", rcl_action_send_result_response, RCL_RET_ERROR);
+  auto cancel_mock = mocking_utils::patch_and_return(
+    "lib:rclcpp_action", rcl_action_send_cancel_response, RCL_RET_ERROR);
+
+  auto goal = Fibonacci::Goal();
+  goal.order = 3;
+  auto goal_handle_future = ac->async_send_goal(goal);
+  ASSERT_EQ(
+    rclcpp::FutureReturnCode::SUCCESS,
+    rclcpp::spin_until_future_complete(node, goal_handle_future, std::chrono::seconds(10)));
+  auto goal_handle = goal_handle_future.get();
+  ASSERT_TRUE(goal_handle);
+  ASSERT_TRUE(received_handle);
+  EXPECT_EQ(received_handle->get_goal_id(), goal_handle->get_goal_id());
+
+  auto result_future = ac->async_get_result(goal_handle);
+  auto result = std::make_shared<Fibonacci::Result>();
+  result->sequence = {0, 1, 1, 2};
+  received_handle->succeed(result);
+  ASSERT_EQ(
+    rclcpp::FutureReturnCode::SUCCESS,
+    rclcpp::spin_until_future_complete(node, result_future, std::chrono::seconds(10)));
+  auto wrapped_result = result_future.get();
+  EXPECT_EQ(rclcpp_action::ResultCode::SUCCEEDED, wrapped_result.code);
+  EXPECT_EQ(result->sequence, wrapped_result.result->sequence);
+
+  auto cancel_future = ac->async_cancel_all_goals();
+  ASSERT_EQ(
+    rclcpp::FutureReturnCode::SUCCESS,
+    rclcpp::spin_until_future_complete(node, cancel_future, std::chrono::seconds(10)));
+  EXPECT_TRUE(cancel_future.get()->goals_canceling.empty());
+}
+
+TEST_F(TestServer, publish_feedback_from_threads)
+{
+  auto node = std::make_shared<rclcpp::Node>(
+    "pub_feedback_threads", "/rclcpp_action/pub_feedback_threads");
+  const GoalUUID uuid1{{1, 21, 30, 4, 5, 6, 70, 8, 9, 1, 11, 120, 13, 14, 15, 160}};
+  const GoalUUID uuid2{{2, 21, 30, 4, 5, 6, 70, 8, 9, 1, 11, 120, 13, 14, 15, 160}};
+
+  auto handle_goal = [](
+    const GoalUUID &, std::shared_ptr<const Fibonacci::Goal>)
+    {
+      return rclcpp_action::GoalResponse::ACCEPT_AND_EXECUTE;
+    };
+
+  using GoalHandle = rclcpp_action::ServerGoalHandle<Fibonacci>;
+
+  auto handle_cancel = [](std::shared_ptr<GoalHandle>)
+    {
+      return rclcpp_action::CancelResponse::REJECT;
+    };
+
+  std::vector<std::shared_ptr<GoalHandle>> received_handles;
+  auto handle_accepted = [&received_handles](std::shared_ptr<GoalHandle> handle)
+    {
+      received_handles.push_back(handle);
+    };
+
+  auto as = rclcpp_action::create_server<Fibonacci>(
+    node, "fibonacci",
+    handle_goal,
+    handle_cancel,
+    handle_accepted);
+  (void)as;
+
+  using FeedbackT = Fibonacci::Impl::FeedbackMessage;
+  size_t received_msgs = 0;
+  auto subscriber = node->create_subscription<FeedbackT>(
+    "fibonacci/_action/feedback", 10, [&received_msgs](FeedbackT::SharedPtr)
+    {
+      ++received_msgs;
+    });
+
+  send_goal_request(node, uuid1);
+  ASSERT_EQ(1u, received_handles.size());
+  auto handle = received_handles.front();
+
+  // Publish feedback from worker threads while the executor accepts another goal.
+  std::vector<std::thread> workers;
+  for (size_t i = 0; i < 4u; ++i) {
+    workers.emplace_back(
+      [handle]() {
+        auto feedback = std::make_shared<Fibonacci::Feedback>();
+        feedback->sequence = {1, 1, 2, 3, 5};
+        for (size_t j = 0; j < 25u; ++j) {
+          handle->publish_feedback(feedback);
+        }
+      });
+  }
+  send_goal_request(node, uuid2);
+  for (auto & worker : workers) {
+    worker.join();
+  }
+  EXPECT_EQ(2u, received_handles.size());
+
+  // 10 seconds
+  const size_t max_tries = 10 * 1000 / 100;
+  for (size_t retry = 0; retry < max_tries && received_msgs < 1u; ++retry) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    rclcpp::spin_some(node);
+  }
+  EXPECT_LE(1u, received_msgs);
+}
+
 TEST_F(TestServer, get_result)
 {
   auto node = std::make_shared<rclcpp::Node>("get_result", "/rclcpp_action/get_result");
@@ -14,7 +14,10 @@
 
 #include <gtest/gtest.h>
 
+#include <functional>
 #include <limits>
+#include <unordered_set>
+
 #include "rclcpp_action/types.hpp"
 
 TEST(TestActionTypes, goal_uuid_to_string) {
@@ -59,3 +62,24 @@ TEST(TestActionTypes, rcl_action_goal_info_to_goal_uuid) {
     EXPECT_EQ(goal_info.goal_id.uuid[i], goal_id[i]);
   }
 }
+
+TEST(TestActionTypes, goal_uuid_hash) {
+  std::hash<rclcpp_action::GoalUUID> hash;
+  rclcpp_action::GoalUUID goal_id{};
+  goal_id[0] = 1u;
+  goal_id[1] = 2u;
+  rclcpp_action::GoalUUID swapped_goal_id{};
+  swapped_goal_id[0] = 2u;
+  swapped_goal_id[1] = 1u;
+  EXPECT_EQ(hash(goal_id), hash(rclcpp_action::GoalUUID(goal_id)));
+  EXPECT_NE(hash(goal_id), hash(swapped_goal_id));
+
+  // Goal ids counting up must not collide, so that they spread in hashed containers
+  std::unordered_set<size_t> hashes;
+  for (uint16_t i = 0; i < 1000u; ++i) {
+    goal_id[0] = static_cast<uint8_t>(i & 0xff);
+    goal_id[1] = static_cast<uint8_t>(i >> 8);
+    hashes.insert(hash(goal_id));
+  }
+  EXPECT_EQ(1000u, hashes.size());
+}
@@ -15,8 +15,11 @@
 /** \mainpage rclcpp_components: Package containing tools for dynamically loadable components.
  *
  * - ComponentManager: Node to manage components. It has the services to load, unload and list
- *   current components.
+ *   current components, and to report the memory they use and the time they took to start.
  *   - rclcpp_components/component_manager.hpp)
+ * - ComponentManagerIsolated: ComponentManager spinning each component, or group of components,
+ *   on an executor and a thread of its own.
+ *   - rclcpp_components/component_manager_isolated.hpp)
  * - Node factory: The NodeFactory interface is used by the class loader to instantiate components.
  *   - rclcpp_components/node_factory.hpp)
  *   - It allows for classes not derived from `rclcpp::Node` to be used as components.
@@ -41,9 +44,17 @@
 #ifndef RCLCPP_COMPONENTS__COMPONENT_MANAGER_HPP__
 #define RCLCPP_COMPONENTS__COMPONENT_MANAGER_HPP__
 
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
 #include <map>
 #include <memory>
+#include <mutex>
+#include <set>
 #include <string>
+#include <thread>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
@@ -52,12 +63,15 @@
 #include "composition_interfaces/srv/list_nodes.hpp"
 
 #include "rclcpp/executor.hpp"
+#include "rclcpp/memory_footprint.hpp"
 #include "rclcpp/node_options.hpp"
 #include "rclcpp/rclcpp.hpp"
 
 #include "rclcpp_components/node_factory.hpp"
 #include "rclcpp_components/visibility_control.hpp"
 
+#include "std_srvs/srv/trigger.hpp"
+
 namespace class_loader
 {
 class ClassLoader;
@@ -81,6 +95,9 @@ public:
   using LoadNode = composition_interfaces::srv::LoadNode;
   using UnloadNode = composition_interfaces::srv::UnloadNode;
   using ListNodes = composition_interfaces::srv::ListNodes;
+  using ReportMemoryFootprint = std_srvs::srv::Trigger;
+  using ReportIntraProcess = std_srvs::srv::Trigger;
+  using ReportStartupProfile = std_srvs::srv::Trigger;
 
   /// Represents a component resource.
   /**
@@ -90,8 +107,31 @@ public:
 
   /// Default constructor
   /**
-   * Initializes the component manager. It creates the services: load node, unload node
-   * and list nodes.
+   * Initializes the component manager. It creates the services: load node, unload node,
+   * list nodes, report memory footprint, report intra-process and report startup profile.
+   *
+   * The `use_intra_process_comms` parameter, false by default, sets whether the loaded
+   * components use intra-process communication when their request has no
+   * `use_intra_process_comms` extra argument.
+   *
+   * The `start_parameter_services` and `start_parameter_event_publisher`
+   * parameters, true by default, set whether the loaded components create the
+   * six parameter services and the parameter event publisher, when their
+   * request has no extra argument of the same name.
+   * Each of them is a middleware entity taking part in discovery, which a large
+   * container may not need for every component.
+   *
+   * With the `load_threads` parameter set to a number greater than 0, the load
+   * node requests are handled by that many threads instead of the executor, so
+   * that independent components are constructed in parallel.
+   * Each component is added to the executor, and its response sent, once it is
+   * constructed.
+   *
+   * The `preload_components` parameter lists the components whose libraries
+   * and factories preload() opens, as `<package_name>/<plugin_name>` entries,
+   * and the `preload_typesupports` parameter the message types whose type
+   * support libraries it opens, like `std_msgs/msg/String`.
+   * Both are empty by default, and can be given in a parameters file.
    *
    * \param executor the executor which will spin the node.
    * \param node_name the name of the node that the data originates from.
@@ -108,6 +148,36 @@ public:
   RCLCPP_COMPONENTS_PUBLIC
   virtual ~ComponentManager();
 
+  /// Set the executor which spins the loaded nodes
+  /**
+   * It allows the executor to be created from the parameters of the component manager.
+   * It must be set before components are loaded.
+   *
+   * \param executor the executor which will spin the node and the loaded nodes.
+   */
+  RCLCPP_COMPONENTS_PUBLIC
+  void
+  set_executor(const std::weak_ptr<rclcpp::Executor> executor);
+
+  /// Open the libraries of the components and of the types to preload, in parallel.
+  /**
+   * Loading a component otherwise opens its library the first time, and
+   * creating its entities the type support libraries of their types, which
+   * makes the first load of each plugin slow and its duration unpredictable.
+   * The components and types listed by the `preload_components` and
+   * `preload_typesupports` parameters are opened by the calling thread along
+   * with the threads of the worker pool of the context, see
+   * rclcpp::Context::get_worker_pool(), and this function returns once they
+   * all were, so that the component containers call it before they start to spin.
+   * The entries which cannot be preloaded are logged and skipped, their load
+   * node requests then fail as usual.
+   *
+   * \return the number of entries which were preloaded.
+   */
+  RCLCPP_COMPONENTS_PUBLIC
+  size_t
+  preload();
+
   /// Return a list of valid loadable components in a given package.
   /**
    * \param package_name name of the package
@@ -130,6 +200,14 @@ public:
   virtual std::shared_ptr<rclcpp_components::NodeFactory>
   create_component_factory(const ComponentResource & resource);
 
+  /// Return the approximate memory used by the loaded nodes.
+  /**
+   * \return the memory footprint of each loaded node, by unique identifier.
+   */
+  RCLCPP_COMPONENTS_PUBLIC
+  virtual std::map<uint64_t, rclcpp::NodeMemoryFootprint>
+  get_memory_footprints();
+
 protected:
   /// Create node options for loaded component
   /**
@@ -231,16 +309,151 @@ protected:
     on_list_nodes(request_header, request, response);
   }
 
+  /// Service callback to report the approximate memory used by the nodes in the component
+  /**
+   * The message of the response has the sizes of the entities of each node,
+   * followed by the size of the memory strategy of the executor.
+   *
+   * \param request_header unused
+   * \param request unused
+   * \param response true on the success field and the report on the message field
+   */
+  RCLCPP_COMPONENTS_PUBLIC
+  virtual void
+  on_report_memory_footprint(
+    const std::shared_ptr<rmw_request_id_t> request_header,
+    const std::shared_ptr<ReportMemoryFootprint::Request> request,
+    std::shared_ptr<ReportMemoryFootprint::Response> response);
+
+  /// Service callback to report the publishers and subscriptions communicating intra-process
+  /**
+   * The message of the response has a line for each publisher and subscription pair matched
+   * intra-process in the process, with their topic and whether the subscription shares the
+   * messages or takes their ownership.
+   *
+   * \param request_header unused
+   * \param request unused
+   * \param response true on the success field and the report on the message field
+   */
+  RCLCPP_COMPONENTS_PUBLIC
+  virtual void
+  on_report_intra_process(
+    const std::shared_ptr<rmw_request_id_t> request_header,
+    const std::shared_ptr<ReportIntraProcess::Request> request,
+    std::shared_ptr<ReportIntraProcess::Response> response);
+
+  /// Service callback to report the time spent in the phases of the startup of the process
+  /**
+   * The message of the response has a line for each phase measured by
+   * rclcpp::startup_profiling, like the loads of the components and the
+   * creations of their entities, the longest total first.
+   * It is empty unless the profiling was enabled, see
+   * rclcpp::InitOptions::startup_profiling().
+   *
+   * \param request_header unused
+   * \param request unused
+   * \param response true on the success field and the report on the message field
+   */
+  RCLCPP_COMPONENTS_PUBLIC
+  virtual void
+  on_report_startup_profile(
+    const std::shared_ptr<rmw_request_id_t> request_header,
+    const std::shared_ptr<ReportStartupProfile::Request> request,
+    std::shared_ptr<ReportStartupProfile::Response> response);
+
+  /// Add a loaded node to the executor which spins it
+  /**
+   * By default the node is added to the executor of the component manager.
+   *
+   * \param node_id unique identifier of the node
+   * \param node the loaded node
+   * \param request the request which loaded the node, with its extra arguments
+   * \throws ComponentManagerException if the node could not be added, it is then unloaded.
+   */
+  RCLCPP_COMPONENTS_PUBLIC
+  virtual void
+  add_node_to_executor(
+    uint64_t node_id,
+    rclcpp::node_interfaces::NodeBaseInterface::SharedPtr node,
+    const std::shared_ptr<LoadNode::Request> request);
+
+  /// Remove a node being unloaded from the executor which spins it
+  /**
+   * \param node_id unique identifier of the node
+   * \param node the node being unloaded
+   */
+  RCLCPP_COMPONENTS_PUBLIC
+  virtual void
+  remove_node_from_executor(
+    uint64_t node_id,
+    rclcpp::node_interfaces::NodeBaseInterface::SharedPtr node);
+
+  /// Stop and join the threads handling the load node requests, if any
+  /**
+   * Derived classes overriding add_node_to_executor() call it first on destruction.
+   */
+  RCLCPP_COMPONENTS_PUBLIC
+  void
+  stop_load_threads();
+
 private:
+  /// Return the resources of a plugin, from the index of the resources of its package.
+  /**
+   * The resources of a package are looked up and indexed by plugin name once,
+   * and again when the plugin is not in the index, so that packages installed
+   * since are found.
+   */
+  std::vector<ComponentResource>
+  find_component_resources(const std::string & package_name, const std::string & plugin_name);
+
+  /// Create the factory of a component to preload, given as `<package_name>/<plugin_name>`.
+  /**
+   * \return true if the factory was created.
+   */
+  bool
+  preload_component(const std::string & component);
+
+  /// Return the factory of a resource, created once.
+  std::shared_ptr<rclcpp_components::NodeFactory>
+  get_component_factory(const ComponentResource & resource);
+
+  /// Handle the load node requests queued for the load threads, until they are stopped.
+  void
+  run_load_requests();
+
   std::weak_ptr<rclcpp::Executor> executor_;
 
-  uint64_t unique_id_ {1};
+  std::atomic<uint64_t> unique_id_ {1};
   std::map<std::string, std::unique_ptr<class_loader::ClassLoader>> loaders_;
+  std::mutex loaders_mutex_;
+  // Libraries being opened without the lock, by another thread, and their end
+  std::set<std::string> loading_libraries_;
+  std::condition_variable loaders_condition_;
   std::map<uint64_t, rclcpp_components::NodeInstanceWrapper> node_wrappers_;
+  std::mutex node_wrappers_mutex_;
+  // Resources of each package, by plugin name
+  std::unordered_map<
+    std::string, std::unordered_map<std::string, std::vector<ComponentResource>>>
+  component_resources_;
+  std::mutex component_resources_mutex_;
+  // Factories of the resources, by library path and class name, destroyed before their loaders
+  std::unordered_map<std::string, std::shared_ptr<rclcpp_components::NodeFactory>>
+  component_factories_;
+  std::mutex component_factories_mutex_;
+
+  // Threads handling the load node requests, when the load_threads parameter is set
+  std::vector<std::thread> load_threads_;
+  std::deque<std::function<void()>> load_requests_;
+  std::mutex load_requests_mutex_;
+  std::condition_variable load_requests_condition_;
+  bool stop_loading_ {false};
 
   rclcpp::Service<LoadNode>::SharedPtr loadNode_srv_;
   rclcpp::Service<UnloadNode>::SharedPtr unloadNode_srv_;
   rclcpp::Service<ListNodes>::SharedPtr listNodes_srv_;
+  rclcpp::Service<ReportMemoryFootprint>::SharedPtr reportMemoryFootprint_srv_;
+  rclcpp::Service<ReportIntraProcess>::SharedPtr reportIntraProcess_srv_;
+  rclcpp::Service<ReportStartupProfile>::SharedPtr reportStartupProfile_srv_;
 };
 
 }  // namespace rclcpp_components
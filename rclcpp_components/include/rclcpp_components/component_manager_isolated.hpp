@@ -0,0 +1,285 @@
+// Copyright 2021 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP_COMPONENTS__COMPONENT_MANAGER_ISOLATED_HPP__
+#define RCLCPP_COMPONENTS__COMPONENT_MANAGER_ISOLATED_HPP__
+
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "rclcpp/executors.hpp"
+#include "rclcpp/thread_attributes.hpp"
+
+#include "rclcpp_components/component_manager.hpp"
+
+namespace rclcpp_components
+{
+
+/// ComponentManager which spins each component, or group of components, on its own executor.
+/**
+ * Each loaded node is added to a dedicated executor of type ExecutorT, spun by a thread of its
+ * own, so that a component blocking in its callbacks does not delay the others.
+ * The nodes still share the process, and so the intra-process communication.
+ *
+ * The executor of a node is selected with these extra arguments of the load node request:
+ * - `executor_group` (string): nodes loaded with the same group share an executor and its
+ *   thread, a node without a group gets an executor of its own.
+ * - `executor_cpu_affinity` (integer array): indices of the CPUs the thread may run on.
+ * - `executor_scheduling_policy` (string): `inherit` (the default), `other`, `fifo` or
+ *   `round_robin`.
+ * - `executor_priority` (integer): priority of the thread with the `fifo` and `round_robin`
+ *   policies.
+ *
+ * The thread attributes of a group are given by the node which creates it, the other nodes of
+ * the group may not give different ones.
+ * The executor of a group is stopped once its last node is unloaded.
+ */
+template<typename ExecutorT = rclcpp::executors::SingleThreadedExecutor>
+class ComponentManagerIsolated : public rclcpp_components::ComponentManager
+{
+public:
+  using rclcpp_components::ComponentManager::ComponentManager;
+
+  ~ComponentManagerIsolated()
+  {
+    // The load threads call add_node_to_executor()
+    stop_load_threads();
+    std::lock_guard<std::mutex> lock(executor_groups_mutex_);
+    for (auto & node_group : node_groups_) {
+      stop_executor(*node_group.second);
+    }
+    // Leave the nodes unassociated, for the base class not to remove them from its executor
+    for (auto & node_group : node_groups_) {
+      auto & group = *node_group.second;
+      group.executor->remove_node(group.nodes.at(node_group.first), false);
+    }
+  }
+
+protected:
+  /// Add the node to the executor of its group, which is created if needed
+  /**
+   * \throws ComponentManagerException if an extra argument is invalid, or if the thread
+   *   attributes could not be applied.
+   */
+  void
+  add_node_to_executor(
+    uint64_t node_id,
+    rclcpp::node_interfaces::NodeBaseInterface::SharedPtr node,
+    const std::shared_ptr<LoadNode::Request> request) override
+  {
+    std::string group_name;
+    bool has_attributes = false;
+    rclcpp::ThreadAttributes attributes;
+    for (const auto & a : request->extra_arguments) {
+      const rclcpp::Parameter extra_argument = rclcpp::Parameter::from_parameter_msg(a);
+      const std::string & name = extra_argument.get_name();
+      const auto type = extra_argument.get_type();
+      if (name == "executor_group") {
+        if (type != rclcpp::ParameterType::PARAMETER_STRING) {
+          throw ComponentManagerException(
+                  "Extra component argument 'executor_group' must be a string");
+        }
+        group_name = extra_argument.get_value<std::string>();
+      } else if (name == "executor_cpu_affinity") {
+        if (type != rclcpp::ParameterType::PARAMETER_INTEGER_ARRAY) {
+          throw ComponentManagerException(
+                  "Extra component argument 'executor_cpu_affinity' must be an integer array");
+        }
+        for (int64_t cpu : extra_argument.get_value<std::vector<int64_t>>()) {
+          if (cpu < 0) {
+            throw ComponentManagerException(
+                    "Extra component argument 'executor_cpu_affinity' must not be negative");
+          }
+          attributes.cpu_affinity.push_back(static_cast<size_t>(cpu));
+        }
+        has_attributes = true;
+      } else if (name == "executor_scheduling_policy") {
+        if (type != rclcpp::ParameterType::PARAMETER_STRING) {
+          throw ComponentManagerException(
+                  "Extra component argument 'executor_scheduling_policy' must be a string");
+        }
+        attributes.scheduling_policy =
+          to_scheduling_policy(extra_argument.get_value<std::string>());
+        has_attributes = true;
+      } else if (name == "executor_priority") {
+        if (type != rclcpp::ParameterType::PARAMETER_INTEGER) {
+          throw ComponentManagerException(
+                  "Extra component argument 'executor_priority' must be an integer");
+        }
+        attributes.priority = static_cast<int>(extra_argument.get_value<int64_t>());
+        has_attributes = true;
+      }
+    }
+
+    std::lock_guard<std::mutex> lock(executor_groups_mutex_);
+    std::shared_ptr<ExecutorGroup> group;
+    if (!group_name.empty()) {
+      auto it = named_groups_.find(group_name);
+      if (it != named_groups_.end()) {
+        group = it->second;
+        if (has_attributes && !same_attributes(group->attributes, attributes)) {
+          throw ComponentManagerException(
+                  "Executor group '" + group_name + "' has different thread attributes");
+        }
+      }
+    }
+    if (group) {
+      group->executor->add_node(node, true);
+    } else {
+      group = std::make_shared<ExecutorGroup>();
+      group->name = group_name;
+      group->attributes = attributes;
+      group->executor = std::make_shared<ExecutorT>();
+      group->executor->add_node(node, true);
+      try {
+        start_executor(*group);
+      } catch (...) {
+        group->executor->remove_node(node, false);
+        throw;
+      }
+      if (!group_name.empty()) {
+        named_groups_.emplace(group_name, group);
+      }
+    }
+    group->nodes.emplace(node_id, node);
+    node_groups_.emplace(node_id, group);
+  }
+
+  /// Remove the node from the executor of its group, which is stopped if it has no node left
+  void
+  remove_node_from_executor(
+    uint64_t node_id,
+    rclcpp::node_interfaces::NodeBaseInterface::SharedPtr node) override
+  {
+    std::lock_guard<std::mutex> lock(executor_groups_mutex_);
+    auto it = node_groups_.find(node_id);
+    if (it == node_groups_.end()) {
+      return;
+    }
+    auto group = std::move(it->second);
+    node_groups_.erase(it);
+    group->nodes.erase(node_id);
+    group->executor->remove_node(node);
+    if (group->nodes.empty()) {
+      stop_executor(*group);
+      if (!group->name.empty()) {
+        named_groups_.erase(group->name);
+      }
+    }
+  }
+
+private:
+  /// An executor, the thread spinning it and the nodes it spins.
+  struct ExecutorGroup
+  {
+    std::string name;
+    rclcpp::ThreadAttributes attributes;
+    std::shared_ptr<ExecutorT> executor;
+    std::thread thread;
+    std::atomic_bool finished {false};
+    std::map<uint64_t, rclcpp::node_interfaces::NodeBaseInterface::SharedPtr> nodes;
+  };
+
+  static rclcpp::ThreadSchedulingPolicy
+  to_scheduling_policy(const std::string & policy)
+  {
+    if (policy == "inherit") {
+      return rclcpp::ThreadSchedulingPolicy::Inherit;
+    } else if (policy == "other") {
+      return rclcpp::ThreadSchedulingPolicy::Other;
+    } else if (policy == "fifo") {
+      return rclcpp::ThreadSchedulingPolicy::Fifo;
+    } else if (policy == "round_robin") {
+      return rclcpp::ThreadSchedulingPolicy::RoundRobin;
+    }
+    throw ComponentManagerException("Unknown executor scheduling policy '" + policy + "'");
+  }
+
+  static bool
+  same_attributes(const rclcpp::ThreadAttributes & a, const rclcpp::ThreadAttributes & b)
+  {
+    return a.cpu_affinity == b.cpu_affinity &&
+           a.scheduling_policy == b.scheduling_policy &&
+           a.priority == b.priority;
+  }
+
+  /// Start the thread of a group, once its attributes are applied to it.
+  void
+  start_executor(ExecutorGroup & group)
+  {
+    std::promise<void> started;
+    auto started_future = started.get_future();
+    auto logger = get_logger();
+    group.thread = std::thread(
+      [&group, logger, started = std::move(started)]() mutable {
+        try {
+          rclcpp::apply_thread_attributes(group.attributes);
+        } catch (...) {
+          started.set_exception(std::current_exception());
+          group.finished.store(true);
+          return;
+        }
+        started.set_value();
+        try {
+          group.executor->spin();
+        } catch (const std::exception & ex) {
+          RCLCPP_ERROR(logger, "Executor of a component stopped: %s", ex.what());
+        }
+        group.finished.store(true);
+      });
+    try {
+      started_future.get();
+    } catch (const std::exception & ex) {
+      group.thread.join();
+      throw ComponentManagerException(
+              "Failed to apply the thread attributes of the executor: " + std::string(ex.what()));
+    }
+  }
+
+  /// Cancel the executor of a group and join its thread.
+  void
+  stop_executor(ExecutorGroup & group)
+  {
+    if (!group.thread.joinable()) {
+      return;
+    }
+    // Canceling the executor before it spins would have no effect, and the thread starts
+    // to spin right after applying its attributes.
+    while (!group.executor->is_spinning() && !group.finished.load()) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    group.executor->cancel();
+    group.thread.join();
+  }
+
+  // Groups by name, the nodes without a group are only in node_groups_
+  std::unordered_map<std::string, std::shared_ptr<ExecutorGroup>> named_groups_;
+  // Group of each node, by unique identifier
+  std::unordered_map<uint64_t, std::shared_ptr<ExecutorGroup>> node_groups_;
+  std::mutex executor_groups_mutex_;
+};
+
+}  // namespace rclcpp_components
+
+#endif  // RCLCPP_COMPONENTS__COMPONENT_MANAGER_ISOLATED_HPP__
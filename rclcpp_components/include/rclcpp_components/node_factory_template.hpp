@@ -45,7 +45,10 @@ public:
     auto node = std::make_shared<NodeT>(options);
 
     return NodeInstanceWrapper(
-      node, std::bind(&NodeT::get_node_base_interface, node));
+      node, std::bind(&NodeT::get_node_base_interface, node),
+      [](const std::shared_ptr<void> & node_instance) {
+        return rclcpp::get_memory_footprint(*std::static_pointer_cast<NodeT>(node_instance));
+      });
   }
 };
 }  // namespace rclcpp_components
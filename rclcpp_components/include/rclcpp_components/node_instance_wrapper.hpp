@@ -18,6 +18,7 @@
 #include <functional>
 #include <memory>
 
+#include "rclcpp/memory_footprint.hpp"
 #include "rclcpp/node_interfaces/node_base_interface.hpp"
 
 namespace rclcpp_components
@@ -28,6 +29,8 @@ class NodeInstanceWrapper
 public:
   using NodeBaseInterfaceGetter = std::function<
     rclcpp::node_interfaces::NodeBaseInterface::SharedPtr(const std::shared_ptr<void> &)>;
+  using MemoryFootprintGetter = std::function<
+    rclcpp::NodeMemoryFootprint(const std::shared_ptr<void> &)>;
 
   NodeInstanceWrapper()
   : node_instance_(nullptr)
@@ -39,6 +42,14 @@ public:
   : node_instance_(node_instance), node_base_interface_getter_(node_base_interface_getter)
   {}
 
+  NodeInstanceWrapper(
+    std::shared_ptr<void> node_instance,
+    NodeBaseInterfaceGetter node_base_interface_getter,
+    MemoryFootprintGetter memory_footprint_getter)
+  : node_instance_(node_instance), node_base_interface_getter_(node_base_interface_getter),
+    memory_footprint_getter_(memory_footprint_getter)
+  {}
+
   /// Get a type-erased pointer to the original Node instance
   /**
    * This is only for debugging and special cases.
@@ -62,9 +73,26 @@ public:
     return node_base_interface_getter_(node_instance_);
   }
 
+  /// Get the approximate memory used by the entities of the encapsulated Node instance.
+  /**
+   * The parameters are only accounted for if the wrapper was given a memory
+   * footprint getter, as NodeFactoryTemplate does.
+   *
+   * \return Memory footprint of the encapsulated Node instance.
+   */
+  rclcpp::NodeMemoryFootprint
+  get_memory_footprint()
+  {
+    if (memory_footprint_getter_) {
+      return memory_footprint_getter_(node_instance_);
+    }
+    return rclcpp::get_memory_footprint(*get_node_base_interface());
+  }
+
 private:
   std::shared_ptr<void> node_instance_;
   NodeBaseInterfaceGetter node_base_interface_getter_;
+  MemoryFootprintGetter memory_footprint_getter_;
 };
 }  // namespace rclcpp_components
 
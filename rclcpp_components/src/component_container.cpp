@@ -24,6 +24,7 @@ int main(int argc, char * argv[])
   rclcpp::init(argc, argv);
   auto exec = std::make_shared<rclcpp::executors::SingleThreadedExecutor>();
   auto node = std::make_shared<rclcpp_components::ComponentManager>(exec);
+  node->preload();
   exec->add_node(node);
   exec->spin();
 }
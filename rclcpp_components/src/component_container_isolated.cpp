@@ -0,0 +1,48 @@
+// Copyright 2021 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "rclcpp/rclcpp.hpp"
+
+#include "rclcpp_components/component_manager_isolated.hpp"
+
+int main(int argc, char * argv[])
+{
+  /// Component container with an executor and a thread for each component or group of them.
+  rclcpp::init(argc, argv);
+  // The components get multi-threaded executors with --use_multi_threaded_executor.
+  bool use_multi_threaded_executor = false;
+  for (const auto & arg : rclcpp::remove_ros_arguments(argc, argv)) {
+    if (arg == "--use_multi_threaded_executor") {
+      use_multi_threaded_executor = true;
+    }
+  }
+  auto exec = std::make_shared<rclcpp::executors::SingleThreadedExecutor>();
+  std::shared_ptr<rclcpp_components::ComponentManager> node;
+  if (use_multi_threaded_executor) {
+    using ComponentManagerIsolated = rclcpp_components::ComponentManagerIsolated<
+      rclcpp::executors::MultiThreadedExecutor>;
+    node = std::make_shared<ComponentManagerIsolated>(exec);
+  } else {
+    using ComponentManagerIsolated = rclcpp_components::ComponentManagerIsolated<
+      rclcpp::executors::SingleThreadedExecutor>;
+    node = std::make_shared<ComponentManagerIsolated>(exec);
+  }
+  node->preload();
+  exec->add_node(node);
+  exec->spin();
+}
@@ -13,6 +13,7 @@
 // limitations under the License.
 
 #include <memory>
+#include <string>
 
 #include "rclcpp/rclcpp.hpp"
 
@@ -21,9 +22,45 @@
 int main(int argc, char * argv[])
 {
   /// Component container with a multi-threaded executor.
+  /**
+   * The executor is configured with the parameters of the component manager:
+   * - `executor_type` (string): `multi_threaded` (the default), `single_threaded`,
+   *   `static_single_threaded` or `events`.
+   * - `thread_num` (integer): number of threads of the multi-threaded executor, 0 (the default)
+   *   for the number of CPUs.
+   * - `yield_before_execute` (bool): whether the threads of the multi-threaded executor yield
+   *   before executing a callback.
+   */
   rclcpp::init(argc, argv);
-  auto exec = std::make_shared<rclcpp::executors::MultiThreadedExecutor>();
-  auto node = std::make_shared<rclcpp_components::ComponentManager>(exec);
+  auto node = std::make_shared<rclcpp_components::ComponentManager>(
+    std::weak_ptr<rclcpp::Executor>());
+  const auto executor_type = node->declare_parameter<std::string>(
+    "executor_type", "multi_threaded");
+  const auto thread_num = node->declare_parameter<int64_t>("thread_num", 0);
+  const auto yield_before_execute = node->declare_parameter<bool>(
+    "yield_before_execute", false);
+
+  std::shared_ptr<rclcpp::Executor> exec;
+  if (executor_type == "multi_threaded") {
+    if (thread_num < 0) {
+      RCLCPP_FATAL(node->get_logger(), "Parameter 'thread_num' must not be negative");
+      return 1;
+    }
+    exec = std::make_shared<rclcpp::executors::MultiThreadedExecutor>(
+      rclcpp::ExecutorOptions(), static_cast<size_t>(thread_num), yield_before_execute);
+  } else if (executor_type == "single_threaded") {
+    exec = std::make_shared<rclcpp::executors::SingleThreadedExecutor>();
+  } else if (executor_type == "static_single_threaded") {
+    exec = std::make_shared<rclcpp::executors::StaticSingleThreadedExecutor>();
+  } else if (executor_type == "events") {
+    exec = std::make_shared<rclcpp::executors::EventsExecutor>();
+  } else {
+    RCLCPP_FATAL(
+      node->get_logger(), "Unknown executor type '%s'", executor_type.c_str());
+    return 1;
+  }
+  node->set_executor(exec);
+  node->preload();
   exec->add_node(node);
   exec->spin();
 }
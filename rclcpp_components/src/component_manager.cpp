@@ -14,14 +14,26 @@
 
 #include "rclcpp_components/component_manager.hpp"
 
+#include <algorithm>
+#include <atomic>
 #include <functional>
+#include <future>
+#include <map>
 #include <memory>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
 #include <string>
+#include <thread>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
 #include "ament_index_cpp/get_resource.hpp"
 #include "class_loader/class_loader.hpp"
+#include "rclcpp/experimental/intra_process_manager.hpp"
+#include "rclcpp/startup_profiling.hpp"
+#include "rclcpp/typesupport_helpers.hpp"
 #include "rcpputils/filesystem_helper.hpp"
 #include "rcpputils/split.hpp"
 
@@ -37,27 +49,214 @@ ComponentManager::ComponentManager(
 : Node(std::move(node_name), node_options),
   executor_(executor)
 {
-  loadNode_srv_ = create_service<LoadNode>(
-    "~/_container/load_node",
-    std::bind(&ComponentManager::on_load_node, this, _1, _2, _3));
+  declare_parameter<bool>("use_intra_process_comms", false);
+  declare_parameter<bool>("start_parameter_services", true);
+  declare_parameter<bool>("start_parameter_event_publisher", true);
+  declare_parameter<std::vector<std::string>>("preload_components", std::vector<std::string>());
+  declare_parameter<std::vector<std::string>>("preload_typesupports", std::vector<std::string>());
+  const auto number_of_load_threads = declare_parameter<int64_t>("load_threads", 0);
+  if (number_of_load_threads > 0) {
+    // Reply to the requests once the load threads handled them
+    loadNode_srv_ = create_service<LoadNode>(
+      "~/_container/load_node",
+      [this](
+        std::shared_ptr<rclcpp::Service<LoadNode>> service,
+        std::shared_ptr<rmw_request_id_t> request_header,
+        std::shared_ptr<LoadNode::Request> request)
+      {
+        std::lock_guard<std::mutex> lock(load_requests_mutex_);
+        load_requests_.emplace_back(
+          [this, service, request_header, request]() {
+            auto response = std::make_shared<LoadNode::Response>();
+            try {
+              on_load_node(request_header, request, response);
+            } catch (const std::exception & ex) {
+              // Without the executor to report it, turn the error into a failed response
+              RCLCPP_ERROR(get_logger(), "Failed to load node: %s", ex.what());
+              response->error_message = ex.what();
+              response->success = false;
+            }
+            service->send_response(*request_header, response);
+          });
+        load_requests_condition_.notify_one();
+      });
+    for (int64_t i = 0; i < number_of_load_threads; ++i) {
+      load_threads_.emplace_back(&ComponentManager::run_load_requests, this);
+    }
+  } else {
+    loadNode_srv_ = create_service<LoadNode>(
+      "~/_container/load_node",
+      std::bind(&ComponentManager::on_load_node, this, _1, _2, _3));
+  }
   unloadNode_srv_ = create_service<UnloadNode>(
     "~/_container/unload_node",
     std::bind(&ComponentManager::on_unload_node, this, _1, _2, _3));
   listNodes_srv_ = create_service<ListNodes>(
     "~/_container/list_nodes",
     std::bind(&ComponentManager::on_list_nodes, this, _1, _2, _3));
+  reportMemoryFootprint_srv_ = create_service<ReportMemoryFootprint>(
+    "~/_container/report_memory_footprint",
+    std::bind(&ComponentManager::on_report_memory_footprint, this, _1, _2, _3));
+  reportIntraProcess_srv_ = create_service<ReportIntraProcess>(
+    "~/_container/report_intra_process",
+    std::bind(&ComponentManager::on_report_intra_process, this, _1, _2, _3));
+  reportStartupProfile_srv_ = create_service<ReportStartupProfile>(
+    "~/_container/report_startup_profile",
+    std::bind(&ComponentManager::on_report_startup_profile, this, _1, _2, _3));
 }
 
 ComponentManager::~ComponentManager()
 {
+  stop_load_threads();
+
+  std::lock_guard<std::mutex> lock(node_wrappers_mutex_);
   if (node_wrappers_.size()) {
     RCLCPP_DEBUG(get_logger(), "Removing components from executor");
     if (auto exec = executor_.lock()) {
       for (auto & wrapper : node_wrappers_) {
-        exec->remove_node(wrapper.second.get_node_base_interface());
+        // Derived managers have already removed the nodes from their own executors
+        auto node = wrapper.second.get_node_base_interface();
+        if (node->get_associated_with_executor_atomic().load()) {
+          exec->remove_node(node);
+        }
+      }
+    }
+  }
+}
+
+void
+ComponentManager::set_executor(const std::weak_ptr<rclcpp::Executor> executor)
+{
+  executor_ = executor;
+}
+
+void
+ComponentManager::stop_load_threads()
+{
+  {
+    std::lock_guard<std::mutex> lock(load_requests_mutex_);
+    stop_loading_ = true;
+  }
+  load_requests_condition_.notify_all();
+  for (auto & load_thread : load_threads_) {
+    load_thread.join();
+  }
+  load_threads_.clear();
+}
+
+void
+ComponentManager::run_load_requests()
+{
+  while (true) {
+    std::function<void()> load_request;
+    {
+      std::unique_lock<std::mutex> lock(load_requests_mutex_);
+      load_requests_condition_.wait(
+        lock, [this]() {return stop_loading_ || !load_requests_.empty();});
+      if (stop_loading_) {
+        return;
+      }
+      load_request = std::move(load_requests_.front());
+      load_requests_.pop_front();
+    }
+    load_request();
+  }
+}
+
+size_t
+ComponentManager::preload()
+{
+  std::vector<std::function<bool()>> entries;
+  for (const auto & component : get_parameter("preload_components").as_string_array()) {
+    entries.emplace_back([this, component]() {return preload_component(component);});
+  }
+  for (const auto & type : get_parameter("preload_typesupports").as_string_array()) {
+    entries.emplace_back(
+      [this, type]() {
+        rclcpp::startup_profiling::ScopedPhase profiled_phase("typesupport preload", type.c_str());
+        try {
+          rclcpp::preload_typesupport(type);
+          return true;
+        } catch (const std::exception & ex) {
+          RCLCPP_WARN(
+            get_logger(), "Failed to preload the type support of '%s': %s", type.c_str(),
+            ex.what());
+          return false;
+        }
+      });
+  }
+  if (entries.empty()) {
+    return 0;
+  }
+
+  std::atomic<size_t> next_entry {0};
+  std::atomic<size_t> preloaded {0};
+  auto preload_entries = [&entries, &next_entry, &preloaded]() {
+      for (size_t i = next_entry++; i < entries.size(); i = next_entry++) {
+        if (entries[i]()) {
+          ++preloaded;
+        }
       }
+    };
+  // Helped by the worker pool of the context, the entries the helpers do not
+  // get to, e.g. if the pool is shut down, are preloaded by this thread.
+  std::vector<std::future<void>> helpers;
+  try {
+    auto worker_pool = get_node_base_interface()->get_context()->get_worker_pool();
+    const size_t number_of_helpers =
+      std::min(entries.size(), worker_pool->get_max_threads() + 1) - 1;
+    for (size_t i = 0; i < number_of_helpers; ++i) {
+      helpers.push_back(worker_pool->submit(preload_entries));
     }
+  } catch (const std::runtime_error & ex) {
+    RCLCPP_WARN(get_logger(), "Preloading without the worker pool: %s", ex.what());
+  }
+  preload_entries();
+  for (auto & helper : helpers) {
+    helper.wait();
+  }
+  RCLCPP_INFO(
+    get_logger(), "Preloaded %zu of %zu components and type supports", preloaded.load(),
+    entries.size());
+  return preloaded;
+}
+
+bool
+ComponentManager::preload_component(const std::string & component)
+{
+  const auto separator = component.find('/');
+  if (separator == std::string::npos || separator == 0 || separator == component.size() - 1) {
+    RCLCPP_WARN(
+      get_logger(), "Invalid component to preload '%s', expected <package_name>/<plugin_name>",
+      component.c_str());
+    return false;
+  }
+  rclcpp::startup_profiling::ScopedPhase profiled_phase("component preload", component.c_str());
+  try {
+    const auto resources = find_component_resources(
+      component.substr(0, separator), component.substr(separator + 1));
+    for (const auto & resource : resources) {
+      if (get_component_factory(resource)) {
+        return true;
+      }
+    }
+    RCLCPP_WARN(get_logger(), "Failed to find the component to preload '%s'", component.c_str());
+  } catch (const std::exception & ex) {
+    RCLCPP_WARN(
+      get_logger(), "Failed to preload the component '%s': %s", component.c_str(), ex.what());
+  }
+  return false;
+}
+
+std::map<uint64_t, rclcpp::NodeMemoryFootprint>
+ComponentManager::get_memory_footprints()
+{
+  std::lock_guard<std::mutex> lock(node_wrappers_mutex_);
+  std::map<uint64_t, rclcpp::NodeMemoryFootprint> footprints;
+  for (auto & wrapper : node_wrappers_) {
+    footprints.emplace(wrapper.first, wrapper.second.get_memory_footprint());
   }
+  return footprints;
 }
 
 std::vector<ComponentManager::ComponentResource>
@@ -90,6 +289,53 @@ ComponentManager::get_component_resources(
   return resources;
 }
 
+std::vector<ComponentManager::ComponentResource>
+ComponentManager::find_component_resources(
+  const std::string & package_name, const std::string & plugin_name)
+{
+  {
+    std::lock_guard<std::mutex> lock(component_resources_mutex_);
+    auto package_it = component_resources_.find(package_name);
+    if (package_it != component_resources_.end()) {
+      auto plugin_it = package_it->second.find(plugin_name);
+      if (plugin_it != package_it->second.end()) {
+        return plugin_it->second;
+      }
+    }
+  }
+  std::unordered_map<std::string, std::vector<ComponentResource>> plugin_resources;
+  for (auto & resource : get_component_resources(package_name)) {
+    plugin_resources[resource.first].push_back(std::move(resource));
+  }
+  std::vector<ComponentResource> resources;
+  auto plugin_it = plugin_resources.find(plugin_name);
+  if (plugin_it != plugin_resources.end()) {
+    resources = plugin_it->second;
+  }
+  std::lock_guard<std::mutex> lock(component_resources_mutex_);
+  component_resources_[package_name] = std::move(plugin_resources);
+  return resources;
+}
+
+std::shared_ptr<rclcpp_components::NodeFactory>
+ComponentManager::get_component_factory(const ComponentResource & resource)
+{
+  const std::string key = resource.second + ":" + resource.first;
+  {
+    std::lock_guard<std::mutex> lock(component_factories_mutex_);
+    auto it = component_factories_.find(key);
+    if (it != component_factories_.end()) {
+      return it->second;
+    }
+  }
+  auto factory = create_component_factory(resource);
+  if (factory) {
+    std::lock_guard<std::mutex> lock(component_factories_mutex_);
+    component_factories_.emplace(key, factory);
+  }
+  return factory;
+}
+
 std::shared_ptr<rclcpp_components::NodeFactory>
 ComponentManager::create_component_factory(const ComponentResource & resource)
 {
@@ -97,18 +343,32 @@ ComponentManager::create_component_factory(const ComponentResource & resource)
   std::string class_name = resource.first;
   std::string fq_class_name = "rclcpp_components::NodeFactoryTemplate<" + class_name + ">";
 
-  class_loader::ClassLoader * loader;
+  std::unique_lock<std::mutex> lock(loaders_mutex_);
+  // A library is opened once, without the lock, so that different libraries open in parallel.
+  loaders_condition_.wait(
+    lock, [this, &library_path]() {return loading_libraries_.count(library_path) == 0;});
   if (loaders_.find(library_path) == loaders_.end()) {
     RCLCPP_INFO(get_logger(), "Load Library: %s", library_path.c_str());
+    loading_libraries_.insert(library_path);
+    lock.unlock();
+    std::unique_ptr<class_loader::ClassLoader> new_loader;
+    std::string error;
     try {
-      loaders_[library_path] = std::make_unique<class_loader::ClassLoader>(library_path);
+      new_loader = std::make_unique<class_loader::ClassLoader>(library_path);
     } catch (const std::exception & ex) {
-      throw ComponentManagerException("Failed to load library: " + std::string(ex.what()));
+      error = "Failed to load library: " + std::string(ex.what());
     } catch (...) {
-      throw ComponentManagerException("Failed to load library");
+      error = "Failed to load library";
     }
+    lock.lock();
+    loading_libraries_.erase(library_path);
+    loaders_condition_.notify_all();
+    if (!new_loader) {
+      throw ComponentManagerException(error);
+    }
+    loaders_[library_path] = std::move(new_loader);
   }
-  loader = loaders_[library_path].get();
+  class_loader::ClassLoader * loader = loaders_[library_path].get();
 
   auto classes = loader->getAvailableClasses<rclcpp_components::NodeFactory>();
   for (const auto & clazz : classes) {
@@ -150,16 +410,31 @@ ComponentManager::create_node_options(const std::shared_ptr<LoadNode::Request> r
   auto options = rclcpp::NodeOptions()
     .use_global_arguments(false)
     .parameter_overrides(parameters)
-    .arguments(remap_rules);
+    .arguments(remap_rules)
+    .use_intra_process_comms(get_parameter("use_intra_process_comms").as_bool())
+    .start_parameter_services(get_parameter("start_parameter_services").as_bool())
+    .start_parameter_event_publisher(
+    get_parameter("start_parameter_event_publisher").as_bool());
 
   for (const auto & a : request->extra_arguments) {
     const rclcpp::Parameter extra_argument = rclcpp::Parameter::from_parameter_msg(a);
-    if (extra_argument.get_name() == "use_intra_process_comms") {
-      if (extra_argument.get_type() != rclcpp::ParameterType::PARAMETER_BOOL) {
-        throw ComponentManagerException(
-                "Extra component argument 'use_intra_process_comms' must be a boolean");
-      }
-      options.use_intra_process_comms(extra_argument.get_value<bool>());
+    const std::string & name = extra_argument.get_name();
+    if (name != "use_intra_process_comms" && name != "start_parameter_services" &&
+      name != "start_parameter_event_publisher")
+    {
+      continue;
+    }
+    if (extra_argument.get_type() != rclcpp::ParameterType::PARAMETER_BOOL) {
+      throw ComponentManagerException(
+              "Extra component argument '" + name + "' must be a boolean");
+    }
+    const bool value = extra_argument.get_value<bool>();
+    if (name == "use_intra_process_comms") {
+      options.use_intra_process_comms(value);
+    } else if (name == "start_parameter_services") {
+      options.start_parameter_services(value);
+    } else {
+      options.start_parameter_event_publisher(value);
     }
   }
 
@@ -174,14 +449,13 @@ ComponentManager::on_load_node(
 {
   (void) request_header;
 
+  rclcpp::startup_profiling::ScopedPhase profiled_phase(
+    "component load", request->plugin_name.c_str());
   try {
-    auto resources = get_component_resources(request->package_name);
+    auto resources = find_component_resources(request->package_name, request->plugin_name);
 
     for (const auto & resource : resources) {
-      if (resource.first != request->plugin_name) {
-        continue;
-      }
-      auto factory = create_component_factory(resource);
+      auto factory = get_component_factory(resource);
 
       if (factory == nullptr) {
         continue;
@@ -201,8 +475,9 @@ ComponentManager::on_load_node(
         throw std::overflow_error("exhausted the unique ids for components in this process");
       }
 
+      rclcpp_components::NodeInstanceWrapper node_wrapper;
       try {
-        node_wrappers_[node_id] = factory->create_node_instance(options);
+        node_wrapper = factory->create_node_instance(options);
       } catch (const std::exception & ex) {
         // In the case that the component constructor throws an exception,
         // rethrow into the following catch block.
@@ -214,9 +489,17 @@ ComponentManager::on_load_node(
         throw ComponentManagerException("Component constructor threw an exception");
       }
 
-      auto node = node_wrappers_[node_id].get_node_base_interface();
-      if (auto exec = executor_.lock()) {
-        exec->add_node(node, true);
+      auto node = node_wrapper.get_node_base_interface();
+      {
+        std::lock_guard<std::mutex> lock(node_wrappers_mutex_);
+        node_wrappers_[node_id] = std::move(node_wrapper);
+      }
+      try {
+        add_node_to_executor(node_id, node, request);
+      } catch (...) {
+        std::lock_guard<std::mutex> lock(node_wrappers_mutex_);
+        node_wrappers_.erase(node_id);
+        throw;
       }
       response->full_node_name = node->get_fully_qualified_name();
       response->unique_id = node_id;
@@ -244,6 +527,7 @@ ComponentManager::on_unload_node(
 {
   (void) request_header;
 
+  std::lock_guard<std::mutex> lock(node_wrappers_mutex_);
   auto wrapper = node_wrappers_.find(request->unique_id);
 
   if (wrapper == node_wrappers_.end()) {
@@ -253,9 +537,7 @@ ComponentManager::on_unload_node(
     response->error_message = ss.str();
     RCLCPP_WARN(get_logger(), "%s", ss.str().c_str());
   } else {
-    if (auto exec = executor_.lock()) {
-      exec->remove_node(wrapper->second.get_node_base_interface());
-    }
+    remove_node_from_executor(wrapper->first, wrapper->second.get_node_base_interface());
     node_wrappers_.erase(wrapper);
     response->success = true;
   }
@@ -270,6 +552,7 @@ ComponentManager::on_list_nodes(
   (void) request_header;
   (void) request;
 
+  std::lock_guard<std::mutex> lock(node_wrappers_mutex_);
   for (auto & wrapper : node_wrappers_) {
     response->unique_ids.push_back(wrapper.first);
     response->full_node_names.push_back(
@@ -277,4 +560,84 @@ ComponentManager::on_list_nodes(
   }
 }
 
+void
+ComponentManager::on_report_memory_footprint(
+  const std::shared_ptr<rmw_request_id_t> request_header,
+  const std::shared_ptr<ReportMemoryFootprint::Request> request,
+  std::shared_ptr<ReportMemoryFootprint::Response> response)
+{
+  (void) request_header;
+  (void) request;
+
+  std::ostringstream report;
+  for (const auto & footprint : get_memory_footprints()) {
+    report << "[" << footprint.first << "] " << rclcpp::to_string(footprint.second) << "\n";
+  }
+  if (auto exec = executor_.lock()) {
+    report << "executor memory strategy: " << exec->get_memory_strategy_size() << " bytes\n";
+  }
+  response->success = true;
+  response->message = report.str();
+}
+
+void
+ComponentManager::on_report_intra_process(
+  const std::shared_ptr<rmw_request_id_t> request_header,
+  const std::shared_ptr<ReportIntraProcess::Request> request,
+  std::shared_ptr<ReportIntraProcess::Response> response)
+{
+  (void) request_header;
+  (void) request;
+
+  auto ipm = get_node_base_interface()->get_context()->get_sub_context<
+    rclcpp::experimental::IntraProcessManager>();
+  std::ostringstream report;
+  for (const auto & connection : ipm->get_connections()) {
+    report << connection.topic_name << ": publisher " << connection.publisher_id <<
+      " -> subscription " << connection.subscription_id <<
+      (connection.take_shared ? " (shared)\n" : " (owned)\n");
+  }
+  response->success = true;
+  response->message = report.str();
+}
+
+void
+ComponentManager::on_report_startup_profile(
+  const std::shared_ptr<rmw_request_id_t> request_header,
+  const std::shared_ptr<ReportStartupProfile::Request> request,
+  std::shared_ptr<ReportStartupProfile::Response> response)
+{
+  (void) request_header;
+  (void) request;
+
+  response->success = true;
+  response->message = rclcpp::startup_profiling::format_report();
+}
+
+void
+ComponentManager::add_node_to_executor(
+  uint64_t node_id,
+  rclcpp::node_interfaces::NodeBaseInterface::SharedPtr node,
+  const std::shared_ptr<LoadNode::Request> request)
+{
+  (void) node_id;
+  (void) request;
+
+  if (auto exec = executor_.lock()) {
+    exec->add_node(node, true);
+  }
+}
+
+void
+ComponentManager::remove_node_from_executor(
+  uint64_t node_id,
+  rclcpp::node_interfaces::NodeBaseInterface::SharedPtr node)
+{
+  (void) node_id;
+
+  if (auto exec = executor_.lock()) {
+    exec->remove_node(node);
+  }
+}
+
 }  // namespace rclcpp_components
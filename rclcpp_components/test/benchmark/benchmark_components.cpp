@@ -16,12 +16,48 @@
 
 #include <rcutils/logging.h>
 
+#ifdef __linux__
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
 #include <memory>
 #include <string>
 #include <vector>
 
 #include "rclcpp_components/component_manager.hpp"
 
+namespace
+{
+
+/// Return the resident memory of the process in kilobytes, 0 where it is not known.
+double
+get_resident_memory_kb()
+{
+#ifdef __linux__
+  std::ifstream statm("/proc/self/statm");
+  size_t size = 0;
+  size_t resident = 0;
+  if (statm >> size >> resident) {
+    return static_cast<double>(resident) * static_cast<double>(sysconf(_SC_PAGESIZE)) / 1024.0;
+  }
+#endif
+  return 0.0;
+}
+
+/// Component manager whose nodes are loaded and unloaded without going through its services.
+class BenchmarkComponentManager : public rclcpp_components::ComponentManager
+{
+public:
+  using rclcpp_components::ComponentManager::ComponentManager;
+  using rclcpp_components::ComponentManager::on_load_node;
+  using rclcpp_components::ComponentManager::on_unload_node;
+};
+
+}  // namespace
+
 class ComponentTest : public benchmark::Fixture
 {
 public:
@@ -37,6 +73,7 @@ public:
   void SetUp(benchmark::State &) override
   {
     rcutils_logging_set_default_logger_level(RCUTILS_LOG_SEVERITY_WARN);
+    rclcpp::reset_logger_level_caches();
 
     context = std::make_shared<rclcpp::Context>();
     context->init(0, nullptr, rclcpp::InitOptions().auto_initialize_logging(false));
@@ -46,7 +83,7 @@ public:
 
     executor = std::make_shared<rclcpp::executors::SingleThreadedExecutor>(exec_options);
 
-    manager = std::make_shared<rclcpp_components::ComponentManager>(
+    manager = std::make_shared<BenchmarkComponentManager>(
       executor, component_manager_name, rclcpp::NodeOptions().context(context));
     executor->add_node(manager);
   }
@@ -68,7 +105,7 @@ public:
 protected:
   rclcpp::Context::SharedPtr context;
   rclcpp::executors::SingleThreadedExecutor::SharedPtr executor;
-  std::shared_ptr<rclcpp_components::ComponentManager> manager;
+  std::shared_ptr<BenchmarkComponentManager> manager;
 };
 
 BENCHMARK_F(ComponentTest, get_component_resources)(benchmark::State & state)
@@ -119,3 +156,61 @@ BENCHMARK_F(ComponentTest, create_node_instance)(benchmark::State & state)
     benchmark::ClobberMemory();
   }
 }
+
+BENCHMARK_DEFINE_F(ComponentTest, load_components)(benchmark::State & state)
+{
+  using LoadNode = rclcpp_components::ComponentManager::LoadNode;
+  using UnloadNode = rclcpp_components::ComponentManager::UnloadNode;
+  const auto number_of_components = static_cast<size_t>(state.range(0));
+  std::vector<uint64_t> unique_ids;
+  unique_ids.reserve(number_of_components);
+  auto load_request = std::make_shared<LoadNode::Request>();
+  load_request->package_name = "rclcpp_components";
+  load_request->plugin_name = "test_rclcpp_components::TestComponentFoo";
+  auto unload_request = std::make_shared<UnloadNode::Request>();
+  auto unload_response = std::make_shared<UnloadNode::Response>();
+
+  double max_resident_growth_kb = 0.0;
+  std::chrono::steady_clock::duration total_time{0};
+  for (auto _ : state) {
+    const double resident_before_kb = get_resident_memory_kb();
+    const auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < number_of_components; ++i) {
+      load_request->node_name = "component_" + std::to_string(i);
+      auto load_response = std::make_shared<LoadNode::Response>();
+      manager->on_load_node(nullptr, load_request, load_response);
+      if (!load_response->success) {
+        state.SkipWithError("Component was not loaded");
+        break;
+      }
+      unique_ids.push_back(load_response->unique_id);
+    }
+    total_time += std::chrono::steady_clock::now() - start;
+    max_resident_growth_kb =
+      std::max(max_resident_growth_kb, get_resident_memory_kb() - resident_before_kb);
+
+    // Ensure unloading the components is not counted toward timing
+    state.PauseTiming();
+    for (uint64_t unique_id : unique_ids) {
+      unload_request->unique_id = unique_id;
+      manager->on_unload_node(nullptr, unload_request, unload_response);
+    }
+    unique_ids.clear();
+    state.ResumeTiming();
+  }
+
+  state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(number_of_components));
+  state.counters["time_per_component_us"] =
+    std::chrono::duration<double, std::micro>(total_time).count() /
+    (static_cast<double>(state.iterations()) * static_cast<double>(number_of_components));
+  state.counters["resident_kb_per_component"] =
+    max_resident_growth_kb / static_cast<double>(number_of_components);
+}
+
+BENCHMARK_REGISTER_F(ComponentTest, load_components)
+->ArgName("components")
+->Arg(10)
+->Arg(100)
+->Arg(1000)
+->Unit(benchmark::kMillisecond)
+->UseRealTime();
@@ -15,6 +15,8 @@
 #include <gtest/gtest.h>
 
 #include <memory>
+#include <string>
+#include <vector>
 
 #include "rclcpp_components/component_manager.hpp"
 
@@ -95,3 +97,32 @@ TEST_F(TestComponentManager, create_component_factory_invalid)
     auto resources = manager->get_component_resources("invalid_rclcpp_components"),
     rclcpp_components::ComponentManagerException);
 }
+
+TEST_F(TestComponentManager, preload)
+{
+  auto exec = std::make_shared<rclcpp::executors::SingleThreadedExecutor>();
+  auto manager = std::make_shared<rclcpp_components::ComponentManager>(exec);
+  EXPECT_EQ(0u, manager->preload());
+
+  const std::vector<std::string> components = {
+    "rclcpp_components/test_rclcpp_components::TestComponentFoo",
+    "rclcpp_components/test_rclcpp_components::TestComponentBar",
+    "rclcpp_components/test_rclcpp_components::TestComponentInvalid",
+    "invalid_package/test_rclcpp_components::TestComponentFoo",
+    "no_plugin_name",
+  };
+  const std::vector<std::string> types = {"std_msgs/msg/String", "invalid_package/msg/Invalid"};
+  auto preloading_manager = std::make_shared<rclcpp_components::ComponentManager>(
+    exec, "PreloadingComponentManager",
+    rclcpp::NodeOptions()
+    .start_parameter_services(false)
+    .start_parameter_event_publisher(false)
+    .parameter_overrides(
+      {
+        rclcpp::Parameter("preload_components", components),
+        rclcpp::Parameter("preload_typesupports", types),
+      }));
+  EXPECT_EQ(3u, preloading_manager->preload());
+  // Preloading again reuses the libraries which are already open.
+  EXPECT_EQ(3u, preloading_manager->preload());
+}
@@ -15,13 +15,23 @@
 #include <gtest/gtest.h>
 
 #include <memory>
+#include <set>
 #include <string>
+#include <vector>
 
 #include "composition_interfaces/srv/load_node.hpp"
 #include "composition_interfaces/srv/unload_node.hpp"
 #include "composition_interfaces/srv/list_nodes.hpp"
 
+#include "rcl_interfaces/msg/log.hpp"
+#include "rcl_interfaces/srv/list_parameters.hpp"
+
+#include "rclcpp/startup_profiling.hpp"
+
 #include "rclcpp_components/component_manager.hpp"
+#include "rclcpp_components/component_manager_isolated.hpp"
+
+#include "std_srvs/srv/trigger.hpp"
 
 using namespace std::chrono_literals;
 
@@ -307,4 +317,382 @@ TEST_F(TestComponentManager, components_api)
       EXPECT_EQ(result_unique_ids[4], 6u);
     }
   }
+  {
+    auto client = node->create_client<std_srvs::srv::Trigger>(
+      "/ComponentManager/_container/report_memory_footprint");
+
+    if (!client->wait_for_service(20s)) {
+      ASSERT_TRUE(false) << "service not available after waiting";
+    }
+
+    {
+      auto request = std::make_shared<std_srvs::srv::Trigger::Request>();
+      auto result = client->async_send_request(request);
+      auto ret = exec->spin_until_future_complete(result, 5s);  // Wait for the result.
+      EXPECT_EQ(ret, rclcpp::FutureReturnCode::SUCCESS);
+      EXPECT_EQ(result.get()->success, true);
+      auto report = result.get()->message;
+      EXPECT_EQ(report.find("/test_component_foo"), std::string::npos);
+      EXPECT_NE(report.find("[2] /test_component_bar"), std::string::npos);
+      EXPECT_NE(report.find("[6] /test_component_intra_process"), std::string::npos);
+      EXPECT_NE(report.find("executor memory strategy"), std::string::npos);
+    }
+  }
+}
+
+TEST_F(TestComponentManager, components_api_load_threads)
+{
+  auto exec = std::make_shared<rclcpp::executors::SingleThreadedExecutor>();
+  auto node = rclcpp::Node::make_shared("test_component_manager_load_threads");
+  auto manager = std::make_shared<rclcpp_components::ComponentManager>(
+    exec, "ParallelComponentManager",
+    rclcpp::NodeOptions()
+    .start_parameter_services(false)
+    .start_parameter_event_publisher(false)
+    .parameter_overrides({rclcpp::Parameter("load_threads", 2)}));
+
+  exec->add_node(manager);
+  exec->add_node(node);
+
+  auto composition_client = node->create_client<composition_interfaces::srv::LoadNode>(
+    "/ParallelComponentManager/_container/load_node");
+
+  if (!composition_client->wait_for_service(20s)) {
+    ASSERT_TRUE(false) << "service not available after waiting";
+  }
+
+  // Send all the requests before waiting for their responses, so they are handled in parallel
+  const std::vector<std::string> node_names = {
+    "test_component_parallel_0", "test_component_parallel_1",
+    "test_component_parallel_2", "test_component_parallel_3"};
+  std::vector<rclcpp::Client<composition_interfaces::srv::LoadNode>::SharedFuture> results;
+  for (const auto & node_name : node_names) {
+    auto request = std::make_shared<composition_interfaces::srv::LoadNode::Request>();
+    request->package_name = "rclcpp_components";
+    request->plugin_name = "test_rclcpp_components::TestComponentFoo";
+    request->node_name = node_name;
+    results.push_back(composition_client->async_send_request(request));
+  }
+  {
+    // A failing request is answered as well
+    auto request = std::make_shared<composition_interfaces::srv::LoadNode::Request>();
+    request->package_name = "rclcpp_components";
+    request->plugin_name = "test_rclcpp_components::TestComponent";
+    results.push_back(composition_client->async_send_request(request));
+  }
+
+  std::set<uint64_t> unique_ids;
+  std::set<std::string> full_node_names;
+  for (size_t i = 0; i < node_names.size(); ++i) {
+    auto ret = exec->spin_until_future_complete(results[i], 5s);  // Wait for the result.
+    ASSERT_EQ(ret, rclcpp::FutureReturnCode::SUCCESS);
+    EXPECT_EQ(results[i].get()->success, true);
+    EXPECT_EQ(results[i].get()->error_message, "");
+    unique_ids.insert(results[i].get()->unique_id);
+    full_node_names.insert(results[i].get()->full_node_name);
+  }
+  EXPECT_EQ(unique_ids, std::set<uint64_t>({1u, 2u, 3u, 4u}));
+  for (const auto & node_name : node_names) {
+    EXPECT_EQ(full_node_names.count("/" + node_name), 1u);
+  }
+  {
+    auto ret = exec->spin_until_future_complete(results.back(), 5s);  // Wait for the result.
+    ASSERT_EQ(ret, rclcpp::FutureReturnCode::SUCCESS);
+    EXPECT_EQ(results.back().get()->success, false);
+    EXPECT_EQ(
+      results.back().get()->error_message,
+      "Failed to find class with the requested plugin name.");
+  }
+
+  {
+    auto client = node->create_client<composition_interfaces::srv::ListNodes>(
+      "/ParallelComponentManager/_container/list_nodes");
+
+    if (!client->wait_for_service(20s)) {
+      ASSERT_TRUE(false) << "service not available after waiting";
+    }
+
+    auto request = std::make_shared<composition_interfaces::srv::ListNodes::Request>();
+    auto result = client->async_send_request(request);
+    auto ret = exec->spin_until_future_complete(result, 5s);  // Wait for the result.
+    EXPECT_EQ(ret, rclcpp::FutureReturnCode::SUCCESS);
+    EXPECT_EQ(result.get()->full_node_names.size(), node_names.size());
+  }
+}
+
+TEST_F(TestComponentManager, components_api_intra_process)
+{
+  auto exec = std::make_shared<rclcpp::executors::SingleThreadedExecutor>();
+  auto node = rclcpp::Node::make_shared(
+    "test_component_manager_intra_process", rclcpp::NodeOptions().use_intra_process_comms(true));
+  auto manager = std::make_shared<rclcpp_components::ComponentManager>(
+    exec, "IntraProcessComponentManager",
+    rclcpp::NodeOptions()
+    .start_parameter_services(false)
+    .start_parameter_event_publisher(false)
+    .parameter_overrides({rclcpp::Parameter("use_intra_process_comms", true)}));
+
+  exec->add_node(manager);
+  exec->add_node(node);
+
+  auto publisher = node->create_publisher<rcl_interfaces::msg::Log>("chatter", 10);
+  auto subscription = node->create_subscription<rcl_interfaces::msg::Log>(
+    "chatter", 10, [](std::unique_ptr<rcl_interfaces::msg::Log>) {});
+
+  {
+    auto client = node->create_client<composition_interfaces::srv::LoadNode>(
+      "/IntraProcessComponentManager/_container/load_node");
+
+    if (!client->wait_for_service(20s)) {
+      ASSERT_TRUE(false) << "service not available after waiting";
+    }
+
+    // The component uses intra-process communication without extra argument
+    auto request = std::make_shared<composition_interfaces::srv::LoadNode::Request>();
+    request->package_name = "rclcpp_components";
+    request->plugin_name = "test_rclcpp_components::TestComponentFoo";
+    auto result = client->async_send_request(request);
+    auto ret = exec->spin_until_future_complete(result, 5s);  // Wait for the result.
+    EXPECT_EQ(ret, rclcpp::FutureReturnCode::SUCCESS);
+    EXPECT_EQ(result.get()->success, true);
+  }
+
+  {
+    auto client = node->create_client<std_srvs::srv::Trigger>(
+      "/IntraProcessComponentManager/_container/report_intra_process");
+
+    if (!client->wait_for_service(20s)) {
+      ASSERT_TRUE(false) << "service not available after waiting";
+    }
+
+    auto request = std::make_shared<std_srvs::srv::Trigger::Request>();
+    auto result = client->async_send_request(request);
+    auto ret = exec->spin_until_future_complete(result, 5s);  // Wait for the result.
+    EXPECT_EQ(ret, rclcpp::FutureReturnCode::SUCCESS);
+    EXPECT_EQ(result.get()->success, true);
+    auto report = result.get()->message;
+    EXPECT_NE(report.find("/chatter: publisher "), std::string::npos);
+    EXPECT_NE(report.find(" (owned)"), std::string::npos);
+  }
+}
+
+TEST_F(TestComponentManager, components_api_startup_profile)
+{
+  rclcpp::startup_profiling::enable();
+  auto exec = std::make_shared<rclcpp::executors::SingleThreadedExecutor>();
+  auto node = rclcpp::Node::make_shared("test_component_manager_startup_profile");
+  auto manager = std::make_shared<rclcpp_components::ComponentManager>(
+    exec, "StartupProfileComponentManager");
+
+  exec->add_node(manager);
+  exec->add_node(node);
+
+  {
+    auto client = node->create_client<composition_interfaces::srv::LoadNode>(
+      "/StartupProfileComponentManager/_container/load_node");
+
+    if (!client->wait_for_service(20s)) {
+      ASSERT_TRUE(false) << "service not available after waiting";
+    }
+
+    auto request = std::make_shared<composition_interfaces::srv::LoadNode::Request>();
+    request->package_name = "rclcpp_components";
+    request->plugin_name = "test_rclcpp_components::TestComponentFoo";
+    auto result = client->async_send_request(request);
+    auto ret = exec->spin_until_future_complete(result, 5s);  // Wait for the result.
+    EXPECT_EQ(ret, rclcpp::FutureReturnCode::SUCCESS);
+    EXPECT_EQ(result.get()->success, true);
+  }
+
+  {
+    auto client = node->create_client<std_srvs::srv::Trigger>(
+      "/StartupProfileComponentManager/_container/report_startup_profile");
+
+    if (!client->wait_for_service(20s)) {
+      ASSERT_TRUE(false) << "service not available after waiting";
+    }
+
+    auto request = std::make_shared<std_srvs::srv::Trigger::Request>();
+    auto result = client->async_send_request(request);
+    auto ret = exec->spin_until_future_complete(result, 5s);  // Wait for the result.
+    EXPECT_EQ(ret, rclcpp::FutureReturnCode::SUCCESS);
+    EXPECT_EQ(result.get()->success, true);
+    auto report = result.get()->message;
+    EXPECT_NE(report.find("component load: 1 in "), std::string::npos);
+    EXPECT_NE(report.find("(test_rclcpp_components::TestComponentFoo)"), std::string::npos);
+    EXPECT_NE(report.find("node base: "), std::string::npos);
+    EXPECT_NE(report.find("service: "), std::string::npos);
+  }
+  rclcpp::startup_profiling::disable();
+  rclcpp::startup_profiling::reset();
+}
+
+TEST_F(TestComponentManager, components_api_parameter_services)
+{
+  using LoadNode = composition_interfaces::srv::LoadNode;
+  auto exec = std::make_shared<rclcpp::executors::SingleThreadedExecutor>();
+  auto node = rclcpp::Node::make_shared("test_component_manager_parameter_services");
+  auto manager = std::make_shared<rclcpp_components::ComponentManager>(
+    exec, "ParameterServicesComponentManager",
+    rclcpp::NodeOptions()
+    .start_parameter_services(false)
+    .start_parameter_event_publisher(false)
+    .parameter_overrides({rclcpp::Parameter("start_parameter_services", false)}));
+
+  exec->add_node(manager);
+  exec->add_node(node);
+
+  auto client = node->create_client<LoadNode>(
+    "/ParameterServicesComponentManager/_container/load_node");
+  if (!client->wait_for_service(20s)) {
+    ASSERT_TRUE(false) << "service not available after waiting";
+  }
+
+  auto load = [&](const std::string & node_name, std::vector<rclcpp::Parameter> extra_arguments) {
+      auto request = std::make_shared<LoadNode::Request>();
+      request->package_name = "rclcpp_components";
+      request->plugin_name = "test_rclcpp_components::TestComponentFoo";
+      request->node_name = node_name;
+      for (const auto & extra_argument : extra_arguments) {
+        request->extra_arguments.push_back(extra_argument.to_parameter_msg());
+      }
+      auto result = client->async_send_request(request);
+      auto ret = exec->spin_until_future_complete(result, 5s);  // Wait for the result.
+      EXPECT_EQ(ret, rclcpp::FutureReturnCode::SUCCESS);
+      EXPECT_EQ(result.get()->success, true);
+    };
+  load("without_parameter_services", {});
+  load("with_parameter_services", {rclcpp::Parameter("start_parameter_services", true)});
+
+  // Once the services of the second component are discovered, the first one has none
+  auto parameters_client = node->create_client<rcl_interfaces::srv::ListParameters>(
+    "/with_parameter_services/list_parameters");
+  EXPECT_TRUE(parameters_client->wait_for_service(20s));
+  auto service_names = node->get_service_names_and_types();
+  EXPECT_EQ(0u, service_names.count("/without_parameter_services/list_parameters"));
+  EXPECT_EQ(1u, service_names.count("/with_parameter_services/list_parameters"));
+
+  {
+    auto request = std::make_shared<LoadNode::Request>();
+    request->package_name = "rclcpp_components";
+    request->plugin_name = "test_rclcpp_components::TestComponentFoo";
+    request->extra_arguments.push_back(
+      rclcpp::Parameter("start_parameter_services", "true").to_parameter_msg());
+    auto result = client->async_send_request(request);
+    auto ret = exec->spin_until_future_complete(result, 5s);  // Wait for the result.
+    EXPECT_EQ(ret, rclcpp::FutureReturnCode::SUCCESS);
+    EXPECT_EQ(result.get()->success, false);
+    EXPECT_EQ(
+      result.get()->error_message,
+      "Extra component argument 'start_parameter_services' must be a boolean");
+  }
+}
+
+TEST_F(TestComponentManager, components_api_isolated)
+{
+  using LoadNode = composition_interfaces::srv::LoadNode;
+  auto exec = std::make_shared<rclcpp::executors::SingleThreadedExecutor>();
+  auto node = rclcpp::Node::make_shared("test_component_manager_isolated");
+  auto manager = std::make_shared<rclcpp_components::ComponentManagerIsolated<>>(
+    exec, "IsolatedComponentManager");
+
+  exec->add_node(manager);
+  exec->add_node(node);
+
+  auto composition_client = node->create_client<LoadNode>(
+    "/IsolatedComponentManager/_container/load_node");
+
+  if (!composition_client->wait_for_service(20s)) {
+    ASSERT_TRUE(false) << "service not available after waiting";
+  }
+
+  auto load_node =
+    [&](const std::string & plugin_name, const std::vector<rclcpp::Parameter> & extra_arguments)
+    {
+      auto request = std::make_shared<LoadNode::Request>();
+      request->package_name = "rclcpp_components";
+      request->plugin_name = plugin_name;
+      for (const auto & extra_argument : extra_arguments) {
+        request->extra_arguments.push_back(extra_argument.to_parameter_msg());
+      }
+      auto result = composition_client->async_send_request(request);
+      auto ret = exec->spin_until_future_complete(result, 5s);  // Wait for the result.
+      EXPECT_EQ(ret, rclcpp::FutureReturnCode::SUCCESS);
+      return result.get();
+    };
+
+  // Foo and Bar share an executor, NoNode has its own
+  auto response = load_node(
+    "test_rclcpp_components::TestComponentFoo",
+    {rclcpp::Parameter("executor_group", "foo_and_bar")});
+  EXPECT_EQ(response->success, true);
+  EXPECT_EQ(response->error_message, "");
+  EXPECT_EQ(response->unique_id, 1u);
+  response = load_node(
+    "test_rclcpp_components::TestComponentBar",
+    {rclcpp::Parameter("executor_group", "foo_and_bar")});
+  EXPECT_EQ(response->success, true);
+  EXPECT_EQ(response->unique_id, 2u);
+  response = load_node("test_rclcpp_components::TestComponentNoNode", {});
+  EXPECT_EQ(response->success, true);
+  EXPECT_EQ(response->unique_id, 3u);
+
+  response = load_node(
+    "test_rclcpp_components::TestComponentFoo", {rclcpp::Parameter("executor_group", 5)});
+  EXPECT_EQ(response->success, false);
+  EXPECT_EQ(
+    response->error_message, "Extra component argument 'executor_group' must be a string");
+  response = load_node(
+    "test_rclcpp_components::TestComponentFoo",
+    {rclcpp::Parameter("executor_scheduling_policy", "unknown")});
+  EXPECT_EQ(response->success, false);
+  EXPECT_EQ(response->error_message, "Unknown executor scheduling policy 'unknown'");
+
+  // The loaded nodes are spun by their own executors, and so answer their parameter services
+  for (const std::string & node_name : {"test_component_foo", "test_component_no_node"}) {
+    auto client = node->create_client<rcl_interfaces::srv::ListParameters>(
+      "/" + node_name + "/list_parameters");
+    if (!client->wait_for_service(20s)) {
+      ASSERT_TRUE(false) << "service not available after waiting";
+    }
+    auto result = client->async_send_request(
+      std::make_shared<rcl_interfaces::srv::ListParameters::Request>());
+    auto ret = exec->spin_until_future_complete(result, 5s);  // Wait for the result.
+    EXPECT_EQ(ret, rclcpp::FutureReturnCode::SUCCESS);
+  }
+
+  {
+    auto client = node->create_client<composition_interfaces::srv::UnloadNode>(
+      "/IsolatedComponentManager/_container/unload_node");
+
+    if (!client->wait_for_service(20s)) {
+      ASSERT_TRUE(false) << "service not available after waiting";
+    }
+
+    // Unloading the last node of a group stops its executor
+    for (uint64_t unique_id : {1u, 2u}) {
+      auto request = std::make_shared<composition_interfaces::srv::UnloadNode::Request>();
+      request->unique_id = unique_id;
+      auto result = client->async_send_request(request);
+      auto ret = exec->spin_until_future_complete(result, 5s);  // Wait for the result.
+      EXPECT_EQ(ret, rclcpp::FutureReturnCode::SUCCESS);
+      EXPECT_EQ(result.get()->success, true);
+    }
+  }
+
+  {
+    auto client = node->create_client<composition_interfaces::srv::ListNodes>(
+      "/IsolatedComponentManager/_container/list_nodes");
+
+    if (!client->wait_for_service(20s)) {
+      ASSERT_TRUE(false) << "service not available after waiting";
+    }
+
+    auto request = std::make_shared<composition_interfaces::srv::ListNodes::Request>();
+    auto result = client->async_send_request(request);
+    auto ret = exec->spin_until_future_complete(result, 5s);  // Wait for the result.
+    EXPECT_EQ(ret, rclcpp::FutureReturnCode::SUCCESS);
+    ASSERT_EQ(result.get()->full_node_names.size(), 1u);
+    EXPECT_EQ(result.get()->full_node_names[0], "/test_component_no_node");
+  }
 }
@@ -27,6 +27,8 @@
  *   - rclcpp_lifecycle/publisher.hpp
  * - Lifecycle node: An optional interface class for life cycle node implementations.
  *   - rclcpp_lifecycle/lifecycle_node.hpp
+ * - Transition of several lifecycle nodes of a process in dependency order.
+ *   - rclcpp_lifecycle/transition_nodes.hpp
  *
  * Some useful internal abstractions and utilities:
  * - Macros for controlling symbol visibility on the library
@@ -59,6 +61,7 @@
 #include "rclcpp/event.hpp"
 #include "rclcpp/generic_publisher.hpp"
 #include "rclcpp/generic_subscription.hpp"
+#include "rclcpp/intra_process_setting.hpp"
 #include "rclcpp/logger.hpp"
 #include "rclcpp/macros.hpp"
 #include "rclcpp/message_memory_strategy.hpp"
@@ -143,6 +146,7 @@ public:
    * \param[in] namespace_ Namespace of the node.
    * \param[in] options Additional options to control creation of the node.
    * \param[in] enable_communication_interface Deciding whether the communication interface of the underlying rcl_lifecycle_node shall be enabled.
+   * \throws std::invalid_argument if the options set a shared rcl node handle.
    */
   RCLCPP_LIFECYCLE_PUBLIC
   LifecycleNode(
@@ -184,13 +188,16 @@ public:
    * \param[in] automatically_add_to_executor_with_node A boolean that
    *   determines whether a callback group is automatically added to an executor
    *   with the node with which it is associated.
+   * \param[in] priority scheduling priority of the callback group, the ready
+   *   entities of groups with a higher priority are executed first.
    * \return a callback group
    */
   RCLCPP_LIFECYCLE_PUBLIC
   rclcpp::CallbackGroup::SharedPtr
   create_callback_group(
     rclcpp::CallbackGroupType group_type,
-    bool automatically_add_to_executor_with_node = true);
+    bool automatically_add_to_executor_with_node = true,
+    int priority = 0);
 
   /// Iterate over the callback groups in the node, calling func on each valid one.
   RCLCPP_LIFECYCLE_PUBLIC
@@ -247,13 +254,16 @@ public:
    * \param[in] period Time interval between triggers of the callback.
    * \param[in] callback User-defined callback function.
    * \param[in] group Callback group to execute this timer's callback in.
+   * \param[in] slack How late the timer may fire so that it is coalesced with other timers,
+   *   see rclcpp::TimerBase::get_slack().
    */
   template<typename DurationRepT = int64_t, typename DurationT = std::milli, typename CallbackT>
   typename rclcpp::WallTimer<CallbackT>::SharedPtr
   create_wall_timer(
     std::chrono::duration<DurationRepT, DurationT> period,
     CallbackT callback,
-    rclcpp::CallbackGroup::SharedPtr group = nullptr);
+    rclcpp::CallbackGroup::SharedPtr group = nullptr,
+    std::chrono::nanoseconds slack = std::chrono::nanoseconds(0));
 
   /// Create and return a Client.
   /**
@@ -264,7 +274,8 @@ public:
   create_client(
     const std::string & service_name,
     const rmw_qos_profile_t & qos_profile = rmw_qos_profile_services_default,
-    rclcpp::CallbackGroup::SharedPtr group = nullptr);
+    rclcpp::CallbackGroup::SharedPtr group = nullptr,
+    rclcpp::IntraProcessSetting use_intra_process_comm = rclcpp::IntraProcessSetting::NodeDefault);
 
   /// Create and return a Service.
   /**
@@ -276,7 +287,8 @@ public:
     const std::string & service_name,
     CallbackT && callback,
     const rmw_qos_profile_t & qos_profile = rmw_qos_profile_services_default,
-    rclcpp::CallbackGroup::SharedPtr group = nullptr);
+    rclcpp::CallbackGroup::SharedPtr group = nullptr,
+    rclcpp::IntraProcessSetting use_intra_process_comm = rclcpp::IntraProcessSetting::NodeDefault);
 
   /// Create and return a GenericPublisher.
   /**
@@ -445,6 +457,22 @@ public:
   rclcpp::Parameter
   get_parameter(const std::string & name) const;
 
+  /// Return a handle reading the value of a parameter without locking.
+  /**
+   * \sa rclcpp::Node::get_parameter_handle
+   */
+  RCLCPP_LIFECYCLE_PUBLIC
+  rclcpp::ParameterHandle::SharedPtr
+  get_parameter_handle(const std::string & name);
+
+  /// Return the declared parameters and the parameter overrides of the node.
+  /**
+   * \sa rclcpp::Node::get_parameter_snapshot
+   */
+  RCLCPP_LIFECYCLE_PUBLIC
+  rclcpp::ParameterSnapshot
+  get_parameter_snapshot() const;
+
   /// Get the value of a parameter by the given name, and return true if it was set.
   /**
    * \sa rclcpp::Node::get_parameter
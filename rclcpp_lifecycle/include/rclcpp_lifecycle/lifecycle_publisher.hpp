@@ -15,6 +15,8 @@
 #ifndef RCLCPP_LIFECYCLE__LIFECYCLE_PUBLISHER_HPP_
 #define RCLCPP_LIFECYCLE__LIFECYCLE_PUBLISHER_HPP_
 
+#include <atomic>
+#include <cstdint>
 #include <memory>
 #include <string>
 #include <utility>
@@ -45,6 +47,11 @@ public:
 /// brief child class of rclcpp Publisher class.
 /**
  * Overrides all publisher functions to check for enabled/disabled state.
+ *
+ * The messages published while the publisher is not activated are dropped and
+ * counted.
+ * A warning is logged for the first of them after each deactivation, unless
+ * the publisher is set to drop them silently.
  */
 template<typename MessageT, typename Alloc = std::allocator<void>>
 class LifecyclePublisher : public LifecyclePublisherInterface,
@@ -64,7 +71,6 @@ public:
     const rclcpp::QoS & qos,
     const rclcpp::PublisherOptionsWithAllocator<Alloc> & options)
   : rclcpp::Publisher<MessageT, Alloc>(node_base, topic, qos, options),
-    enabled_(false),
     logger_(rclcpp::get_logger("LifecyclePublisher"))
   {
   }
@@ -80,12 +86,8 @@ public:
   virtual void
   publish(std::unique_ptr<MessageT, MessageDeleter> msg)
   {
-    if (!enabled_) {
-      RCLCPP_WARN(
-        logger_,
-        "Trying to publish message on the topic '%s', but the publisher is not activated",
-        this->get_topic_name());
-
+    if (!enabled_.load(std::memory_order_relaxed)) {
+      drop_message();
       return;
     }
     rclcpp::Publisher<MessageT, Alloc>::publish(std::move(msg));
@@ -100,12 +102,8 @@ public:
   virtual void
   publish(const MessageT & msg)
   {
-    if (!enabled_) {
-      RCLCPP_WARN(
-        logger_,
-        "Trying to publish message on the topic '%s', but the publisher is not activated",
-        this->get_topic_name());
-
+    if (!enabled_.load(std::memory_order_relaxed)) {
+      drop_message();
       return;
     }
     rclcpp::Publisher<MessageT, Alloc>::publish(msg);
@@ -114,23 +112,57 @@ public:
   virtual void
   on_activate()
   {
-    enabled_ = true;
+    enabled_.store(true, std::memory_order_relaxed);
   }
 
   virtual void
   on_deactivate()
   {
-    enabled_ = false;
+    should_log_.store(true, std::memory_order_relaxed);
+    enabled_.store(false, std::memory_order_relaxed);
   }
 
   virtual bool
   is_activated()
   {
-    return enabled_;
+    return enabled_.load(std::memory_order_relaxed);
+  }
+
+  /// Set whether the messages published while not activated are dropped without a warning.
+  void
+  set_drop_silently(bool drop_silently)
+  {
+    drop_silently_.store(drop_silently, std::memory_order_relaxed);
+  }
+
+  /// Return the number of messages dropped because the publisher was not activated.
+  uint64_t
+  get_dropped_message_count() const
+  {
+    return dropped_message_count_.load(std::memory_order_relaxed);
   }
 
 private:
-  bool enabled_ = false;
+  /// Count a message published while not activated, and warn about the first one.
+  void
+  drop_message()
+  {
+    dropped_message_count_.fetch_add(1, std::memory_order_relaxed);
+    if (drop_silently_.load(std::memory_order_relaxed) ||
+      !should_log_.exchange(false, std::memory_order_relaxed))
+    {
+      return;
+    }
+    RCLCPP_WARN(
+      logger_,
+      "Trying to publish message on the topic '%s', but the publisher is not activated",
+      this->get_topic_name());
+  }
+
+  std::atomic<bool> enabled_{false};
+  std::atomic<bool> should_log_{true};
+  std::atomic<bool> drop_silently_{false};
+  std::atomic<uint64_t> dropped_message_count_{0};
   rclcpp::Logger logger_;
 };
 
@@ -0,0 +1,80 @@
+// Copyright 2021 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP_LIFECYCLE__TRANSITION_NODES_HPP_
+#define RCLCPP_LIFECYCLE__TRANSITION_NODES_HPP_
+
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "rclcpp_lifecycle/lifecycle_node.hpp"
+#include "rclcpp_lifecycle/node_interfaces/lifecycle_node_interface.hpp"
+#include "rclcpp_lifecycle/state.hpp"
+#include "rclcpp_lifecycle/visibility_control.h"
+
+namespace rclcpp_lifecycle
+{
+
+/// Outcome of the transition of one of the nodes given to transition_nodes().
+struct NodeTransitionResult
+{
+  /// Whether the transition was triggered and its callback returned SUCCESS.
+  bool success = false;
+
+  /// Whether the transition was not triggered, because a node it depends on did not succeed.
+  bool skipped = false;
+
+  /// Return code of the transition callback, ERROR if the transition was invalid or skipped.
+  node_interfaces::LifecycleNodeInterface::CallbackReturn callback_return =
+    node_interfaces::LifecycleNodeInterface::CallbackReturn::ERROR;
+
+  /// State of the node once done.
+  State state;
+};
+
+/// Trigger the same transition of several lifecycle nodes of this process.
+/**
+ * The transitions are triggered directly, without going through the change_state service of
+ * the nodes.
+ * A node is transitioned once all the nodes it depends on did so successfully, and nodes which
+ * do not depend on each other are transitioned in parallel.
+ * If the transition of a node fails, the nodes depending on it, directly or not, are skipped.
+ *
+ * The dependencies usually describe the bring up order; pass them reversed to tear nodes down.
+ *
+ * \param[in] nodes the nodes to transition, identified by their fully qualified names.
+ * \param[in] transition_id id of the transition to trigger, e.g.
+ *   lifecycle_msgs::msg::Transition::TRANSITION_CONFIGURE.
+ * \param[in] dependencies for the fully qualified name of a node, the fully qualified names of
+ *   the nodes which have to be transitioned before it.
+ * \param[in] max_threads maximum number of nodes transitioned at the same time, or 0 to use
+ *   the number of hardware threads.
+ * \return the outcome of the transition of each node, by fully qualified name.
+ * \throws std::invalid_argument if two nodes have the same name, if a dependency is not one of
+ *   the nodes, or if the dependencies are cyclic.
+ */
+RCLCPP_LIFECYCLE_PUBLIC
+std::map<std::string, NodeTransitionResult>
+transition_nodes(
+  const std::vector<LifecycleNode::SharedPtr> & nodes,
+  uint8_t transition_id,
+  const std::map<std::string, std::vector<std::string>> & dependencies = {},
+  size_t max_threads = 0);
+
+}  // namespace rclcpp_lifecycle
+
+#endif  // RCLCPP_LIFECYCLE__TRANSITION_NODES_HPP_
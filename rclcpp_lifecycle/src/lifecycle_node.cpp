@@ -17,6 +17,7 @@
 #include <string>
 #include <map>
 #include <memory>
+#include <stdexcept>
 #include <vector>
 #include <utility>
 
@@ -67,8 +68,12 @@ LifecycleNode::LifecycleNode(
       options.context(),
       *(options.get_rcl_node_options()),
       options.use_intra_process_comms(),
-      options.enable_topic_statistics())),
-  node_graph_(new rclcpp::node_interfaces::NodeGraph(node_base_.get())),
+      options.enable_topic_statistics(),
+      options.arena(),
+      options.rosout_batch_period(),
+      options.rosout_max_batch_size())),
+  node_graph_(new rclcpp::node_interfaces::NodeGraph(
+      node_base_.get(), options.use_graph_cache())),
   node_logging_(new rclcpp::node_interfaces::NodeLogging(node_base_.get())),
   node_timers_(new rclcpp::node_interfaces::NodeTimers(node_base_.get())),
   node_topics_(new rclcpp::node_interfaces::NodeTopics(node_base_.get(), node_timers_.get())),
@@ -92,7 +97,9 @@ LifecycleNode::LifecycleNode(
       options.parameter_event_qos(),
       options.parameter_event_publisher_options(),
       options.allow_undeclared_parameters(),
-      options.automatically_declare_parameters_from_overrides()
+      options.automatically_declare_parameters_from_overrides(),
+      options.parameter_event_coalescing_period(),
+      options.parameter_snapshot()
     )),
   node_time_source_(new rclcpp::node_interfaces::NodeTimeSource(
       node_base_,
@@ -103,12 +110,17 @@ LifecycleNode::LifecycleNode(
       node_clock_,
       node_parameters_,
       options.clock_qos(),
-      options.use_clock_thread()
+      options.use_clock_thread(),
+      options.use_shared_clock_subscription()
     )),
   node_waitables_(new rclcpp::node_interfaces::NodeWaitables(node_base_.get())),
   node_options_(options),
   impl_(new LifecycleNodeInterfaceImpl(node_base_, node_services_))
 {
+  if (options.shared_rcl_node_handle()) {
+    // The services of the state machine are created by rcl, with the name of the rcl node.
+    throw std::invalid_argument("a lifecycle node cannot share the rcl node handle of a node");
+  }
   impl_->init(enable_communication_interface);
 
   register_on_configure(
@@ -166,9 +178,11 @@ LifecycleNode::get_logger() const
 rclcpp::CallbackGroup::SharedPtr
 LifecycleNode::create_callback_group(
   rclcpp::CallbackGroupType group_type,
-  bool automatically_add_to_executor_with_node)
+  bool automatically_add_to_executor_with_node,
+  int priority)
 {
-  return node_base_->create_callback_group(group_type, automatically_add_to_executor_with_node);
+  return node_base_->create_callback_group(
+    group_type, automatically_add_to_executor_with_node, priority);
 }
 
 const rclcpp::ParameterValue &
@@ -259,6 +273,18 @@ LifecycleNode::get_parameter(const std::string & name) const
   return node_parameters_->get_parameter(name);
 }
 
+rclcpp::ParameterHandle::SharedPtr
+LifecycleNode::get_parameter_handle(const std::string & name)
+{
+  return node_parameters_->get_parameter_handle(name);
+}
+
+rclcpp::ParameterSnapshot
+LifecycleNode::get_parameter_snapshot() const
+{
+  return node_parameters_->get_parameter_snapshot();
+}
+
 bool
 LifecycleNode::get_parameter(
   const std::string & name,
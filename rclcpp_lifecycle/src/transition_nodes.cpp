@@ -0,0 +1,200 @@
+// Copyright 2021 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "rclcpp_lifecycle/transition_nodes.hpp"
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace rclcpp_lifecycle
+{
+
+namespace
+{
+
+using CallbackReturn = node_interfaces::LifecycleNodeInterface::CallbackReturn;
+
+struct PendingNode
+{
+  LifecycleNode::SharedPtr node;
+  std::vector<size_t> dependents;
+  size_t remaining_dependencies = 0;
+  bool dependency_failed = false;
+  NodeTransitionResult result;
+};
+
+/// Check that the dependencies can be satisfied, without transitioning any node.
+void
+check_acyclic(const std::vector<PendingNode> & pending)
+{
+  std::vector<size_t> remaining(pending.size());
+  std::vector<size_t> ready;
+  for (size_t i = 0; i < pending.size(); ++i) {
+    remaining[i] = pending[i].remaining_dependencies;
+    if (remaining[i] == 0) {
+      ready.push_back(i);
+    }
+  }
+  size_t visited = 0;
+  while (!ready.empty()) {
+    size_t index = ready.back();
+    ready.pop_back();
+    ++visited;
+    for (size_t dependent : pending[index].dependents) {
+      if (--remaining[dependent] == 0) {
+        ready.push_back(dependent);
+      }
+    }
+  }
+  if (visited != pending.size()) {
+    throw std::invalid_argument("the dependencies between the lifecycle nodes are cyclic");
+  }
+}
+
+}  // namespace
+
+std::map<std::string, NodeTransitionResult>
+transition_nodes(
+  const std::vector<LifecycleNode::SharedPtr> & nodes,
+  uint8_t transition_id,
+  const std::map<std::string, std::vector<std::string>> & dependencies,
+  size_t max_threads)
+{
+  std::vector<PendingNode> pending(nodes.size());
+  std::map<std::string, size_t> indices;
+  for (size_t i = 0; i < nodes.size(); ++i) {
+    if (!nodes[i]) {
+      throw std::invalid_argument("the lifecycle nodes to transition cannot be null");
+    }
+    pending[i].node = nodes[i];
+    if (!indices.emplace(nodes[i]->get_fully_qualified_name(), i).second) {
+      throw std::invalid_argument(
+              std::string("lifecycle node '") + nodes[i]->get_fully_qualified_name() +
+              "' is given more than once");
+    }
+  }
+  for (const auto & node_dependencies : dependencies) {
+    auto node_it = indices.find(node_dependencies.first);
+    if (node_it == indices.end()) {
+      throw std::invalid_argument(
+              "dependencies given for '" + node_dependencies.first +
+              "', which is not one of the lifecycle nodes");
+    }
+    for (const auto & dependency : node_dependencies.second) {
+      auto dependency_it = indices.find(dependency);
+      if (dependency_it == indices.end()) {
+        throw std::invalid_argument(
+                "lifecycle node '" + node_dependencies.first + "' depends on '" + dependency +
+                "', which is not one of the lifecycle nodes");
+      }
+      pending[dependency_it->second].dependents.push_back(node_it->second);
+      ++pending[node_it->second].remaining_dependencies;
+    }
+  }
+  check_acyclic(pending);
+
+  std::mutex mutex;
+  std::condition_variable ready_cv;
+  std::deque<size_t> ready;
+  size_t finished = 0;
+  std::exception_ptr first_exception;
+  for (size_t i = 0; i < pending.size(); ++i) {
+    if (pending[i].remaining_dependencies == 0) {
+      ready.push_back(i);
+    }
+  }
+
+  auto worker =
+    [&]() {
+      std::unique_lock<std::mutex> lock(mutex);
+      while (true) {
+        ready_cv.wait(lock, [&]() {return !ready.empty() || finished == pending.size();});
+        if (ready.empty()) {
+          return;
+        }
+        PendingNode & current = pending[ready.front()];
+        ready.pop_front();
+
+        // Each node is only ever handled by one worker, so its transition runs unlocked.
+        if (current.dependency_failed) {
+          current.result.skipped = true;
+          current.result.state = current.node->get_current_state();
+        } else {
+          lock.unlock();
+          CallbackReturn callback_return = CallbackReturn::ERROR;
+          std::exception_ptr exception;
+          try {
+            current.result.state = current.node->trigger_transition(transition_id, callback_return);
+          } catch (...) {
+            exception = std::current_exception();
+          }
+          lock.lock();
+          if (exception) {
+            if (!first_exception) {
+              first_exception = exception;
+            }
+          } else {
+            current.result.callback_return = callback_return;
+            current.result.success = callback_return == CallbackReturn::SUCCESS;
+          }
+        }
+
+        for (size_t dependent : current.dependents) {
+          if (!current.result.success) {
+            pending[dependent].dependency_failed = true;
+          }
+          if (--pending[dependent].remaining_dependencies == 0) {
+            ready.push_back(dependent);
+          }
+        }
+        ++finished;
+        ready_cv.notify_all();
+      }
+    };
+
+  size_t thread_count = max_threads ? max_threads : std::thread::hardware_concurrency();
+  thread_count = std::min(std::max<size_t>(thread_count, 1), pending.size());
+  if (thread_count > 1) {
+    std::vector<std::thread> threads;
+    threads.reserve(thread_count - 1);
+    for (size_t i = 1; i < thread_count; ++i) {
+      threads.emplace_back(worker);
+    }
+    worker();
+    for (auto & thread : threads) {
+      thread.join();
+    }
+  } else if (thread_count == 1) {
+    worker();
+  }
+
+  if (first_exception) {
+    std::rethrow_exception(first_exception);
+  }
+  std::map<std::string, NodeTransitionResult> results;
+  for (auto & current : pending) {
+    results.emplace(current.node->get_fully_qualified_name(), std::move(current.result));
+  }
+  return results;
+}
+
+}  // namespace rclcpp_lifecycle
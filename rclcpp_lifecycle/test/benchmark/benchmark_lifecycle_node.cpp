@@ -16,8 +16,11 @@
 
 #include <memory>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "lifecycle_msgs/msg/state.hpp"
+#include "lifecycle_msgs/msg/transition.hpp"
 #include "performance_test_fixture/performance_test_fixture.hpp"
 #include "rclcpp/rclcpp.hpp"
 #include "rclcpp_lifecycle/lifecycle_node.hpp"
@@ -70,6 +73,49 @@ BENCHMARK_F(BenchmarkLifecycleNodeConstruction, destroy_lifecycle_node)(benchmar
   }
 }
 
+// Bring up of many lifecycle nodes, as in the startup of a large system: each one is
+// constructed, configured and activated.
+BENCHMARK_DEFINE_F(BenchmarkLifecycleNodeConstruction, bring_up_lifecycle_nodes)(
+  benchmark::State & state)
+{
+  const auto number_of_nodes = static_cast<size_t>(state.range(0));
+  std::vector<std::shared_ptr<rclcpp_lifecycle::LifecycleNode>> nodes;
+  nodes.reserve(number_of_nodes);
+
+  reset_heap_counters();
+  for (auto _ : state) {
+    for (size_t i = 0; i < number_of_nodes; ++i) {
+      auto node = std::make_shared<rclcpp_lifecycle::LifecycleNode>(
+        "node_" + std::to_string(i), "ns");
+      const auto & inactive =
+        node->trigger_transition(lifecycle_msgs::msg::Transition::TRANSITION_CONFIGURE);
+      if (inactive.id() != lifecycle_msgs::msg::State::PRIMARY_STATE_INACTIVE) {
+        state.SkipWithError("Transition to configured state failed");
+      }
+      const auto & active =
+        node->trigger_transition(lifecycle_msgs::msg::Transition::TRANSITION_ACTIVATE);
+      if (active.id() != lifecycle_msgs::msg::State::PRIMARY_STATE_ACTIVE) {
+        state.SkipWithError("Transition to active state failed");
+      }
+      nodes.push_back(std::move(node));
+    }
+    PERFORMANCE_TEST_FIXTURE_PAUSE_MEASUREMENTS(
+      state,
+    {
+      nodes.clear();
+    });
+  }
+  state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(number_of_nodes));
+}
+
+BENCHMARK_REGISTER_F(BenchmarkLifecycleNodeConstruction, bring_up_lifecycle_nodes)
+->ArgName("nodes")
+->Arg(10)
+->Arg(100)
+->Arg(1000)
+->Unit(benchmark::kMillisecond)
+->UseRealTime();
+
 class BenchmarkLifecycleNode : public performance_test_fixture::PerformanceTest
 {
 public:
@@ -232,6 +232,15 @@ TEST_F(TestDefaultStateMachine, empty_initializer) {
   EXPECT_EQ(State::PRIMARY_STATE_UNCONFIGURED, test_node->get_current_state().id());
 }
 
+TEST_F(TestDefaultStateMachine, shared_rcl_node_handle) {
+  auto host = std::make_shared<rclcpp::Node>("host");
+  auto options = rclcpp::NodeOptions().shared_rcl_node_handle(
+    host->get_node_base_interface()->get_shared_rcl_node_handle());
+  EXPECT_THROW(
+    std::make_shared<rclcpp_lifecycle::LifecycleNode>("testnode", options).reset(),
+    std::invalid_argument);
+}
+
 TEST_F(TestDefaultStateMachine, empty_initializer_rcl_errors) {
   {
     auto patch = mocking_utils::inject_on_return(
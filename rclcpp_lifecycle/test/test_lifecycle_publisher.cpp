@@ -102,3 +102,22 @@ TEST_F(TestLifecyclePublisher, publish) {
     EXPECT_NO_THROW(node_->publisher()->publish(std::move(msg_ptr)));
   }
 }
+
+TEST_F(TestLifecyclePublisher, dropped_messages) {
+  auto publisher = node_->publisher();
+  publisher->on_deactivate();
+  EXPECT_EQ(0u, publisher->get_dropped_message_count());
+  publisher->publish(test_msgs::msg::Empty());
+  publisher->publish(std::make_unique<test_msgs::msg::Empty>());
+  EXPECT_EQ(2u, publisher->get_dropped_message_count());
+
+  publisher->set_drop_silently(true);
+  publisher->on_deactivate();
+  publisher->publish(test_msgs::msg::Empty());
+  EXPECT_EQ(3u, publisher->get_dropped_message_count());
+
+  // Published messages are not counted
+  publisher->on_activate();
+  publisher->publish(test_msgs::msg::Empty());
+  EXPECT_EQ(3u, publisher->get_dropped_message_count());
+}
@@ -0,0 +1,177 @@
+// Copyright 2021 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "lifecycle_msgs/msg/state.hpp"
+#include "lifecycle_msgs/msg/transition.hpp"
+
+#include "rclcpp/rclcpp.hpp"
+#include "rclcpp_lifecycle/lifecycle_node.hpp"
+#include "rclcpp_lifecycle/transition_nodes.hpp"
+
+using lifecycle_msgs::msg::State;
+using lifecycle_msgs::msg::Transition;
+using rclcpp_lifecycle::node_interfaces::LifecycleNodeInterface;
+
+class TestTransitionNodes : public ::testing::Test
+{
+protected:
+  static void SetUpTestCase()
+  {
+    rclcpp::init(0, nullptr);
+  }
+
+  static void TearDownTestCase()
+  {
+    rclcpp::shutdown();
+  }
+};
+
+class RecordingLifecycleNode : public rclcpp_lifecycle::LifecycleNode
+{
+public:
+  RecordingLifecycleNode(
+    const std::string & node_name,
+    std::vector<std::string> & configured,
+    std::mutex & configured_mutex,
+    bool fail_configure = false)
+  : rclcpp_lifecycle::LifecycleNode(node_name),
+    configured_(configured),
+    configured_mutex_(configured_mutex),
+    fail_configure_(fail_configure)
+  {}
+
+protected:
+  LifecycleNodeInterface::CallbackReturn
+  on_configure(const rclcpp_lifecycle::State &) override
+  {
+    std::lock_guard<std::mutex> lock(configured_mutex_);
+    configured_.push_back(get_fully_qualified_name());
+    return fail_configure_ ?
+           LifecycleNodeInterface::CallbackReturn::FAILURE :
+           LifecycleNodeInterface::CallbackReturn::SUCCESS;
+  }
+
+private:
+  std::vector<std::string> & configured_;
+  std::mutex & configured_mutex_;
+  bool fail_configure_;
+};
+
+TEST_F(TestTransitionNodes, dependency_order) {
+  std::vector<std::string> configured;
+  std::mutex configured_mutex;
+  std::vector<rclcpp_lifecycle::LifecycleNode::SharedPtr> nodes;
+  for (const char * name : {"node_c", "node_b", "node_a", "node_d"}) {
+    nodes.push_back(std::make_shared<RecordingLifecycleNode>(name, configured, configured_mutex));
+  }
+
+  auto results = rclcpp_lifecycle::transition_nodes(
+    nodes, Transition::TRANSITION_CONFIGURE,
+    {{"/node_b", {"/node_a"}}, {"/node_c", {"/node_a", "/node_b"}}}, 4);
+
+  ASSERT_EQ(4u, results.size());
+  for (const auto & node : nodes) {
+    const auto & result = results.at(node->get_fully_qualified_name());
+    EXPECT_TRUE(result.success);
+    EXPECT_FALSE(result.skipped);
+    EXPECT_EQ(LifecycleNodeInterface::CallbackReturn::SUCCESS, result.callback_return);
+    EXPECT_EQ(State::PRIMARY_STATE_INACTIVE, result.state.id());
+    EXPECT_EQ(State::PRIMARY_STATE_INACTIVE, node->get_current_state().id());
+  }
+  ASSERT_EQ(4u, configured.size());
+  auto position = [&configured](const std::string & name) {
+      return std::find(configured.begin(), configured.end(), name) - configured.begin();
+    };
+  EXPECT_LT(position("/node_a"), position("/node_b"));
+  EXPECT_LT(position("/node_b"), position("/node_c"));
+
+  results = rclcpp_lifecycle::transition_nodes(nodes, Transition::TRANSITION_ACTIVATE);
+  for (const auto & node : nodes) {
+    EXPECT_TRUE(results.at(node->get_fully_qualified_name()).success);
+    EXPECT_EQ(State::PRIMARY_STATE_ACTIVE, node->get_current_state().id());
+  }
+}
+
+TEST_F(TestTransitionNodes, failed_dependency) {
+  std::vector<std::string> configured;
+  std::mutex configured_mutex;
+  std::vector<rclcpp_lifecycle::LifecycleNode::SharedPtr> nodes {
+    std::make_shared<RecordingLifecycleNode>("node_a", configured, configured_mutex, true),
+    std::make_shared<RecordingLifecycleNode>("node_b", configured, configured_mutex),
+    std::make_shared<RecordingLifecycleNode>("node_c", configured, configured_mutex),
+    std::make_shared<RecordingLifecycleNode>("node_d", configured, configured_mutex),
+  };
+
+  auto results = rclcpp_lifecycle::transition_nodes(
+    nodes, Transition::TRANSITION_CONFIGURE,
+    {{"/node_b", {"/node_a"}}, {"/node_c", {"/node_b"}}}, 1);
+
+  EXPECT_FALSE(results.at("/node_a").success);
+  EXPECT_FALSE(results.at("/node_a").skipped);
+  EXPECT_EQ(LifecycleNodeInterface::CallbackReturn::FAILURE, results.at("/node_a").callback_return);
+  EXPECT_EQ(State::PRIMARY_STATE_UNCONFIGURED, results.at("/node_a").state.id());
+  for (const char * name : {"/node_b", "/node_c"}) {
+    EXPECT_FALSE(results.at(name).success);
+    EXPECT_TRUE(results.at(name).skipped);
+    EXPECT_EQ(State::PRIMARY_STATE_UNCONFIGURED, results.at(name).state.id());
+  }
+  EXPECT_TRUE(results.at("/node_d").success);
+  EXPECT_EQ((std::vector<std::string>{"/node_a", "/node_d"}), configured);
+
+  // An invalid transition fails without throwing.
+  results = rclcpp_lifecycle::transition_nodes(nodes, Transition::TRANSITION_CLEANUP);
+  EXPECT_FALSE(results.at("/node_a").success);
+  EXPECT_TRUE(results.at("/node_d").success);
+}
+
+TEST_F(TestTransitionNodes, invalid_dependencies) {
+  std::vector<std::string> configured;
+  std::mutex configured_mutex;
+  std::vector<rclcpp_lifecycle::LifecycleNode::SharedPtr> nodes {
+    std::make_shared<RecordingLifecycleNode>("node_a", configured, configured_mutex),
+    std::make_shared<RecordingLifecycleNode>("node_b", configured, configured_mutex),
+  };
+
+  EXPECT_THROW(
+    rclcpp_lifecycle::transition_nodes(
+      nodes, Transition::TRANSITION_CONFIGURE,
+      {{"/node_a", {"/node_b"}}, {"/node_b", {"/node_a"}}}),
+    std::invalid_argument);
+  EXPECT_THROW(
+    rclcpp_lifecycle::transition_nodes(
+      nodes, Transition::TRANSITION_CONFIGURE, {{"/node_a", {"/unknown"}}}),
+    std::invalid_argument);
+  EXPECT_THROW(
+    rclcpp_lifecycle::transition_nodes(
+      nodes, Transition::TRANSITION_CONFIGURE, {{"/unknown", {"/node_a"}}}),
+    std::invalid_argument);
+  nodes.push_back(nodes.front());
+  EXPECT_THROW(
+    rclcpp_lifecycle::transition_nodes(nodes, Transition::TRANSITION_CONFIGURE),
+    std::invalid_argument);
+
+  // Nothing was transitioned.
+  EXPECT_TRUE(configured.empty());
+  EXPECT_EQ(State::PRIMARY_STATE_UNCONFIGURED, nodes.front()->get_current_state().id());
+}